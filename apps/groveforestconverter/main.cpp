@@ -0,0 +1,58 @@
+/**
+ * groveforestconverter: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include <grove/features/interface/RGBDPatchFeatureCalculator.h>
+#include <grove/forests/DecisionForestFactory.tpp>
+#include <grove/forests/cpu/DecisionForest_CPU.tpp>
+#include <grove/forests/interface/DecisionForest.tpp>
+using namespace grove;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct can be used to save a forest (with any number of trees) to a file in the binary format.
+ */
+struct BinaryForestSaver
+{
+  /** The path to the file to which to save the forest. */
+  std::string filename;
+
+  explicit BinaryForestSaver(const std::string& filename_)
+  : filename(filename_)
+  {}
+
+  template <int TreeCount>
+  void operator()(const boost::shared_ptr<DecisionForest<RGBDPatchDescriptor,TreeCount> >& forest) const
+  {
+    forest->save_structure_to_binary_file(filename);
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+int main(int argc, char *argv[])
+try
+{
+  if(argc != 3)
+  {
+    std::cerr << "Usage: groveforestconverter <input forest file> <output binary forest file>\n";
+    return EXIT_FAILURE;
+  }
+
+  // Load the forest (in either the text or the binary format), and then save it in the binary format.
+  BinaryForestSaver saver(argv[2]);
+  DynamicDecisionForestFactory<RGBDPatchDescriptor>::make_forest(argv[1], ITMLib::ITMLibSettings::DEVICE_CPU, saver);
+
+  std::cout << "Saved the forest to: " << argv[2] << '\n';
+  return EXIT_SUCCESS;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,14 @@
+/**
+ * groveperf: CUDAInstantiations.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <grove/keypoints/Keypoint3DColour.h>
+#include <grove/reservoirs/cuda/ExampleReservoirs_CUDA.tcu>
+using namespace grove;
+
+template class ExampleReservoirs_CUDA<Keypoint3DColour>;
+template void ExampleReservoirs_CUDA<Keypoint3DColour>::add_examples_sub<5>(
+  const ExampleReservoirs_CUDA<Keypoint3DColour>::ExampleImage_CPtr& examples,
+  const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,5> > >& reservoirIndices
+);
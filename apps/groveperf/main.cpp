@@ -0,0 +1,612 @@
+/**
+ * groveperf: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/function.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include <ORUtils/FileUtils.h>
+
+#include <grove/features/FeatureCalculatorFactory.h>
+#include <grove/forests/DecisionForestFactory.tpp>
+#include <grove/forests/cpu/DecisionForest_CPU.tpp>
+#include <grove/forests/interface/DecisionForest.tpp>
+#include <grove/reservoirs/ExampleReservoirsFactory.tpp>
+#include <grove/reservoirs/cpu/ExampleReservoirs_CPU.tpp>
+#include <grove/reservoirs/interface/ExampleReservoirs.tpp>
+using namespace grove;
+
+#include <itmx/base/DeviceUtil.h>
+#include <itmx/base/MemoryBlockFactory.h>
+using namespace itmx;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+#include <tvgutil/timing/PerformanceBaseline.h>
+using namespace tvgutil;
+
+using namespace ITMLib;
+
+//#################### NAMESPACE ALIASES ####################
+
+namespace bf = boost::filesystem;
+namespace po = boost::program_options;
+
+//#################### TYPEDEFS ####################
+
+// Note: The forests used for relocalisation all have 5 trees, so this is the only tree count we benchmark.
+typedef DecisionForest<RGBDPatchDescriptor,5> Forest;
+typedef boost::shared_ptr<Forest> Forest_Ptr;
+typedef ExampleReservoirs<Keypoint3DColour> Reservoirs;
+typedef boost::shared_ptr<Reservoirs> Reservoirs_Ptr;
+
+typedef boost::chrono::steady_clock Clock;
+
+//#################### TYPES ####################
+
+struct CommandLineArguments
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  // User-specifiable arguments
+  std::string baselineDir;
+  std::vector<std::string> deviceNames;
+  std::string depthImageFilename;
+  std::string forestFilename;
+  int forestDepth;
+  size_t iterationCount;
+  std::string layoutName;
+  bool recordBaseline;
+  uint32_t reservoirCapacity;
+  std::string rgbImageFilename;
+  unsigned int seed;
+  std::vector<std::string> sizeSpecifiers;
+  double tolerance;
+};
+
+/**
+ * \brief An instance of this struct contains the result of benchmarking a single kernel on a particular device and input size.
+ */
+struct BenchmarkResult
+{
+  std::string device;
+  std::string input;
+  std::string kernel;
+  double meanMs;
+  double throughput;
+  std::string unit;
+};
+
+/**
+ * \brief An instance of this struct contains an RGB-D input on which to benchmark the kernels.
+ */
+struct RGBDInput
+{
+  ITMFloatImage_Ptr depthImage;
+  Vector4f intrinsics;
+  std::string name;
+  ITMUChar4Image_Ptr rgbImage;
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Compares the results of the benchmarks with the baselines recorded for the current machine, or records them as the new baselines.
+ *
+ * \param results The results of the benchmarks.
+ * \param args    The program's command-line arguments.
+ * \return        true, if none of the kernels has become slower than its baseline, or false otherwise.
+ */
+bool check_baseline(const std::vector<BenchmarkResult>& results, const CommandLineArguments& args)
+{
+  std::vector<PerformanceBaseline::Measurement> measurements;
+  for(size_t i = 0, size = results.size(); i < size; ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    measurements.push_back(PerformanceBaseline::Measurement(r.kernel + ',' + r.device + ',' + r.input + ',' + args.layoutName, r.meanMs));
+  }
+
+  const std::string baselineFilename = PerformanceBaseline::get_machine_baseline_path(args.baselineDir);
+  PerformanceBaseline baseline(args.tolerance);
+  baseline.load(baselineFilename);
+
+  // Note: The report is written to std::cerr so as not to interfere with the CSV written to std::cout.
+  if(args.recordBaseline)
+  {
+    // Note: Loading the existing baselines first preserves those for any kernels, devices or inputs not benchmarked in this run.
+    for(size_t i = 0, size = measurements.size(); i < size; ++i)
+    {
+      baseline.set_baseline_ms(measurements[i].key, measurements[i].measuredMs);
+    }
+
+    bf::create_directories(args.baselineDir);
+    baseline.save(baselineFilename);
+    std::cerr << "Recorded " << measurements.size() << " baseline(s) in " << baselineFilename << '\n';
+    return true;
+  }
+  else return baseline.check(measurements, std::cerr);
+}
+
+/**
+ * \brief Measures the mean time (in milliseconds) taken to run a kernel.
+ *
+ * The kernel is run once beforehand to warm up any caches and allocate any outputs, and we wait for the device
+ * to finish after each run, so that the time measured is that of the whole kernel rather than just its launch.
+ *
+ * \param kernel          The kernel.
+ * \param deviceType      The device on which the kernel runs.
+ * \param iterationCount  The number of times to run the kernel.
+ * \return                The mean time taken to run the kernel.
+ */
+double time_kernel(const boost::function<void()>& kernel, ITMLibSettings::DeviceType deviceType, size_t iterationCount)
+{
+  kernel();
+  DeviceUtil::synchronise(deviceType);
+
+  const Clock::time_point t0 = Clock::now();
+  for(size_t i = 0; i < iterationCount; ++i)
+  {
+    kernel();
+    DeviceUtil::synchronise(deviceType);
+  }
+  const Clock::time_point t1 = Clock::now();
+
+  return boost::chrono::duration<double,boost::milli>(t1 - t0).count() / iterationCount;
+}
+
+/**
+ * \brief Makes an image of the specified type, allocated on the device currently set in the memory block factory.
+ *
+ * \param size  The size of the image.
+ * \return      The image.
+ */
+template <typename T>
+boost::shared_ptr<ORUtils::Image<T> > make_image(const Vector2i& size)
+{
+  return MemoryBlockFactory::instance().make_image<T>(size, "groveperf");
+}
+
+/**
+ * \brief Loads a recorded RGB-D input from disk.
+ *
+ * \param rgbImageFilename    The path to the colour image (a PPM).
+ * \param depthImageFilename  The path to the depth image (a 16-bit PGM, in millimetres).
+ * \return                    The input.
+ * \throws std::runtime_error If either image cannot be loaded, or they have different sizes.
+ */
+RGBDInput load_input(const std::string& rgbImageFilename, const std::string& depthImageFilename)
+{
+  ITMShortImage_Ptr rawDepthImage(new ITMShortImage(Vector2i(0, 0), true, false));
+  ITMUChar4Image_Ptr rgbImage(new ITMUChar4Image(Vector2i(0, 0), true, false));
+  if(!ReadImageFromFile(rawDepthImage.get(), depthImageFilename.c_str())) throw std::runtime_error("Error: Could not read depth image " + depthImageFilename);
+  if(!ReadImageFromFile(rgbImage.get(), rgbImageFilename.c_str())) throw std::runtime_error("Error: Could not read RGB image " + rgbImageFilename);
+  if(rawDepthImage->noDims != rgbImage->noDims) throw std::runtime_error("Error: The recorded depth and RGB images must have the same size");
+
+  const Vector2i size = rgbImage->noDims;
+
+  RGBDInput input;
+  input.depthImage = make_image<float>(size);
+  input.intrinsics = Vector4f(585.0f * size.x / 640, 585.0f * size.y / 480, size.x / 2.0f, size.y / 2.0f);
+  input.name = bf::path(rgbImageFilename).filename().string();
+  input.rgbImage = make_image<Vector4u>(size);
+
+  const short *rawDepth = rawDepthImage->GetData(MEMORYDEVICE_CPU);
+  float *depth = input.depthImage->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, pixelCount = size.x * size.y; i < pixelCount; ++i)
+  {
+    depth[i] = rawDepth[i] > 0 ? rawDepth[i] / 1000.0f : -1.0f;
+  }
+
+  input.rgbImage->SetFrom(rgbImage.get(), ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU);
+  input.depthImage->UpdateDeviceFromHost();
+  input.rgbImage->UpdateDeviceFromHost();
+  return input;
+}
+
+/**
+ * \brief Makes a synthetic RGB-D input of the specified size.
+ *
+ * The depth image shows an undulating slanted surface with a few holes, and the colour image shows a random blocky
+ * texture, so that the features vary across the image in a way that is repeatable for a given seed.
+ *
+ * \param size  The size of the input.
+ * \param seed  The seed for the random number generator.
+ * \return      The input.
+ */
+RGBDInput make_synthetic_input(const Vector2i& size, unsigned int seed)
+{
+  RandomNumberGenerator rng(seed);
+
+  RGBDInput input;
+  input.depthImage = make_image<float>(size);
+  input.intrinsics = Vector4f(585.0f * size.x / 640, 585.0f * size.y / 480, size.x / 2.0f, size.y / 2.0f);
+  input.name = "synthetic";
+  input.rgbImage = make_image<Vector4u>(size);
+
+  float *depth = input.depthImage->GetData(MEMORYDEVICE_CPU);
+  Vector4u *rgb = input.rgbImage->GetData(MEMORYDEVICE_CPU);
+
+  // Generate a random colour for each 8x8 block of the colour image.
+  const int blockSize = 8;
+  const int blocksPerRow = (size.x + blockSize - 1) / blockSize;
+  const int blocksPerColumn = (size.y + blockSize - 1) / blockSize;
+  std::vector<Vector4u> blockColours(blocksPerRow * blocksPerColumn);
+  for(size_t i = 0, blockCount = blockColours.size(); i < blockCount; ++i)
+  {
+    blockColours[i] = Vector4u(
+      static_cast<unsigned char>(rng.generate_int_from_uniform(0, 255)),
+      static_cast<unsigned char>(rng.generate_int_from_uniform(0, 255)),
+      static_cast<unsigned char>(rng.generate_int_from_uniform(0, 255)),
+      255
+    );
+  }
+
+  for(int y = 0; y < size.y; ++y)
+  {
+    for(int x = 0; x < size.x; ++x)
+    {
+      const int i = y * size.x + x;
+      const float u = static_cast<float>(x) / size.x, v = static_cast<float>(y) / size.y;
+      const bool hole = rng.generate_real_from_uniform(0.0f, 1.0f) < 0.05f;
+      depth[i] = hole ? -1.0f : 1.0f + u + 0.2f * sinf(10.0f * u) * cosf(8.0f * v);
+      rgb[i] = blockColours[(y / blockSize) * blocksPerRow + x / blockSize];
+    }
+  }
+
+  input.depthImage->UpdateDeviceFromHost();
+  input.rgbImage->UpdateDeviceFromHost();
+  return input;
+}
+
+/**
+ * \brief Writes a synthetic forest of complete binary trees to a file in the text format read by DecisionForest.
+ *
+ * The features and thresholds of the branch nodes are drawn from distributions that mimic those of the pre-trained office forest.
+ *
+ * \param filename  The path to the file.
+ * \param depth     The depth of each tree (a tree of depth d has 2^d leaves).
+ * \param seed      The seed for the random number generator.
+ * \throws std::runtime_error If the file cannot be written.
+ */
+void write_synthetic_forest(const std::string& filename, int depth, unsigned int seed)
+{
+  std::ofstream fs(filename.c_str());
+  if(!fs) throw std::runtime_error("Error: Could not open " + filename + " for writing");
+
+  RandomNumberGenerator rng(seed);
+  const int treeCount = Forest::TREE_COUNT;
+  const int leafCount = 1 << depth;
+  const int nodeCount = 2 * leafCount - 1;
+
+  fs << treeCount << '\n';
+  for(int i = 0; i < treeCount; ++i) fs << nodeCount << ' ' << leafCount << '\n';
+
+  // Note: The nodes of each tree are numbered breadth-first, so the left child of node n is node 2n+1.
+  for(int i = 0; i < treeCount; ++i)
+  {
+    int nextLeafIdx = 0;
+    for(int n = 0; n < nodeCount; ++n)
+    {
+      if(n >= leafCount - 1)
+      {
+        fs << "-1 " << nextLeafIdx++ << " 0 0\n";
+      }
+      else if(rng.generate_real_from_uniform(0.0f, 1.0f) < 0.3886f)
+      {
+        fs << 2 * n + 1 << " -1 " << rng.generate_int_from_uniform(0, 127) << ' ' << rng.generate_from_gaussian(20.09f, 947.24f) << '\n';
+      }
+      else
+      {
+        fs << 2 * n + 1 << " -1 " << rng.generate_int_from_uniform(128, 255) << ' ' << rng.generate_from_gaussian(-2.85f, 72.98f) << '\n';
+      }
+    }
+  }
+
+  if(!fs) throw std::runtime_error("Error: Could not write a synthetic forest to " + filename);
+}
+
+/**
+ * \brief Benchmarks the grove kernels on a particular device and input.
+ *
+ * \param deviceType  The device on which to run the kernels.
+ * \param deviceName  The name of the device.
+ * \param input       The input.
+ * \param forest      The forest to use to find the leaves.
+ * \param args        The program's command-line arguments.
+ * \param results     The vector to which to append the results.
+ */
+void run_benchmarks(ITMLibSettings::DeviceType deviceType, const std::string& deviceName, const RGBDInput& input,
+                    const Forest_Ptr& forest, const CommandLineArguments& args, std::vector<BenchmarkResult>& results)
+{
+  const Vector2i& size = input.rgbImage->noDims;
+  const double pixelCount = static_cast<double>(size.x) * size.y;
+  const std::string inputName = input.name + "@" + boost::lexical_cast<std::string>(size.x) + "x" + boost::lexical_cast<std::string>(size.y);
+
+  Matrix4f identity;
+  identity.setIdentity();
+
+  BenchmarkResult result;
+  result.device = deviceName;
+  result.input = inputName;
+
+  // Benchmark the computation of the keypoints and features.
+  DA_RGBDPatchFeatureCalculator_Ptr featureCalculator = FeatureCalculatorFactory::make_da_rgbd_patch_feature_calculator(deviceType);
+  Keypoint3DColourImage_Ptr keypointsImage = make_image<Keypoint3DColour>(size);
+  RGBDPatchDescriptorImage_Ptr descriptorsImage = make_image<RGBDPatchDescriptor>(size);
+
+  void (DA_RGBDPatchFeatureCalculator::*computeFeatures)(const ITMUChar4Image*, const ITMFloatImage*, const Vector4f&, Keypoint3DColourImage*, RGBDPatchDescriptorImage*) const
+    = &DA_RGBDPatchFeatureCalculator::compute_keypoints_and_features;
+
+  result.kernel = "compute_keypoints_and_features";
+  result.meanMs = time_kernel(
+    boost::bind(computeFeatures, featureCalculator.get(), input.rgbImage.get(), input.depthImage.get(), input.intrinsics, keypointsImage.get(), descriptorsImage.get()),
+    deviceType, args.iterationCount
+  );
+  result.throughput = pixelCount / (result.meanMs / 1000.0);
+  result.unit = "pixels/s";
+  results.push_back(result);
+
+  // Benchmark the computation of the features for only the valid keypoints, as done by the relocaliser. Note that the
+  // throughput of this is measured in descriptors rather than pixels, since only the valid keypoints have descriptors.
+  ITMIntMemoryBlock_Ptr keypointIndices = MemoryBlockFactory::instance().make_block<int>(0, "groveperf");
+  const uint32_t validKeypointCount = featureCalculator->compute_sparse_keypoints_and_features(
+    input.rgbImage.get(), input.depthImage.get(), identity, input.intrinsics, keypointsImage.get(), descriptorsImage.get(), keypointIndices.get()
+  );
+
+  result.kernel = "compute_sparse_keypoints_and_features";
+  result.meanMs = time_kernel(
+    boost::bind(
+      &DA_RGBDPatchFeatureCalculator::compute_sparse_keypoints_and_features, featureCalculator.get(), input.rgbImage.get(), input.depthImage.get(),
+      identity, input.intrinsics, keypointsImage.get(), descriptorsImage.get(), keypointIndices.get()
+    ),
+    deviceType, args.iterationCount
+  );
+  result.throughput = validKeypointCount / (result.meanMs / 1000.0);
+  result.unit = "descriptors/s";
+  results.push_back(result);
+
+  // Benchmark the computation of the quantised features, which are used to reduce the bandwidth needed by the forest.
+  QuantisedDA_RGBDPatchFeatureCalculator_Ptr quantisedFeatureCalculator = FeatureCalculatorFactory::make_quantised_da_rgbd_patch_feature_calculator(deviceType);
+  QuantisedRGBDPatchDescriptorImage_Ptr quantisedDescriptorsImage = make_image<QuantisedRGBDPatchDescriptor>(size);
+
+  void (QuantisedDA_RGBDPatchFeatureCalculator::*computeQuantisedFeatures)(const ITMUChar4Image*, const ITMFloatImage*, const Vector4f&, Keypoint3DColourImage*, QuantisedRGBDPatchDescriptorImage*) const
+    = &QuantisedDA_RGBDPatchFeatureCalculator::compute_keypoints_and_features;
+
+  result.kernel = "compute_keypoints_and_features (quantised)";
+  result.meanMs = time_kernel(
+    boost::bind(computeQuantisedFeatures, quantisedFeatureCalculator.get(), input.rgbImage.get(), input.depthImage.get(), input.intrinsics, keypointsImage.get(), quantisedDescriptorsImage.get()),
+    deviceType, args.iterationCount
+  );
+  result.throughput = pixelCount / (result.meanMs / 1000.0);
+  result.unit = "pixels/s";
+  results.push_back(result);
+
+  // Recompute the unquantised features, so that the forest and reservoirs are benchmarked on the keypoints that go with them.
+  featureCalculator->compute_keypoints_and_features(input.rgbImage.get(), input.depthImage.get(), input.intrinsics, keypointsImage.get(), descriptorsImage.get());
+  DeviceUtil::synchronise(deviceType);
+
+  // Benchmark finding the leaves of the forest.
+  const Vector2i& descriptorsSize = descriptorsImage->noDims;
+  const double descriptorCount = static_cast<double>(descriptorsSize.x) * descriptorsSize.y;
+  Forest::LeafIndicesImage_Ptr leafIndices = make_image<Forest::LeafIndices>(descriptorsSize);
+
+  void (Forest::*findLeaves)(const Forest::DescriptorImage_CPtr&, Forest::LeafIndicesImage_Ptr&) const = &Forest::find_leaves;
+
+  result.kernel = "find_leaves";
+  result.meanMs = time_kernel(
+    boost::bind(findLeaves, forest.get(), Forest::DescriptorImage_CPtr(descriptorsImage), boost::ref(leafIndices)),
+    deviceType, args.iterationCount
+  );
+  result.throughput = descriptorCount / (result.meanMs / 1000.0);
+  result.unit = "descriptors/s";
+  results.push_back(result);
+
+  // Benchmark adding the keypoints to the reservoirs associated with their leaves. Note that after the first few
+  // iterations, the reservoirs are full, so this measures the steady state, in which examples randomly replace others.
+  Reservoirs_Ptr reservoirs = ExampleReservoirsFactory<Keypoint3DColour>::make_reservoirs(forest->get_nb_leaves(), args.reservoirCapacity, deviceType, args.seed);
+
+  void (Reservoirs::*addExamples)(const Reservoirs::ExampleImage_CPtr&, const Forest::LeafIndicesImage_Ptr&) = &Reservoirs::add_examples<Forest::TREE_COUNT>;
+
+  result.kernel = "add_examples";
+  result.meanMs = time_kernel(
+    boost::bind(addExamples, reservoirs.get(), Reservoirs::ExampleImage_CPtr(keypointsImage), leafIndices),
+    deviceType, args.iterationCount
+  );
+  result.throughput = descriptorCount / (result.meanMs / 1000.0);
+  result.unit = "examples/s";
+  results.push_back(result);
+
+  // On the CPU, also benchmark adding the keypoints to the reservoirs directly (with atomics on the shared reservoir counters),
+  // rather than via the thread-local buckets of pending insertions, so that the two approaches can be compared.
+  if(deviceType == ITMLibSettings::DEVICE_CPU)
+  {
+    Reservoirs_Ptr directReservoirs = ExampleReservoirsFactory<Keypoint3DColour>::make_reservoirs(
+      forest->get_nb_leaves(), args.reservoirCapacity, deviceType, args.seed, false, false
+    );
+
+    result.kernel = "add_examples_direct";
+    result.meanMs = time_kernel(
+      boost::bind(addExamples, directReservoirs.get(), Reservoirs::ExampleImage_CPtr(keypointsImage), leafIndices),
+      deviceType, args.iterationCount
+    );
+    result.throughput = descriptorCount / (result.meanMs / 1000.0);
+    result.unit = "examples/s";
+    results.push_back(result);
+  }
+}
+
+/**
+ * \brief Parses a forest node layout name as specified on the command line.
+ *
+ * \param layoutName              The name of the layout.
+ * \return                        The corresponding layout.
+ * \throws std::invalid_argument  If the name does not correspond to a known layout.
+ */
+DecisionForestNodeLayout parse_layout(const std::string& layoutName)
+{
+  if(layoutName == "interleaved") return INTERLEAVED_LAYOUT;
+  else if(layoutName == "breadthfirst") return BREADTH_FIRST_LAYOUT;
+  else if(layoutName == "blocked") return BLOCKED_LAYOUT;
+  else throw std::invalid_argument("Error: Unknown forest node layout: " + layoutName);
+}
+
+/**
+ * \brief Parses a size specifier of the form <width>x<height>.
+ *
+ * \param sizeSpecifier           The size specifier.
+ * \return                        The size.
+ * \throws std::invalid_argument  If the size specifier is invalid.
+ */
+Vector2i parse_size(const std::string& sizeSpecifier)
+{
+  Vector2i size;
+  char separator;
+  std::istringstream is(sizeSpecifier);
+  if(!(is >> size.x >> separator >> size.y) || separator != 'x' || size.x <= 0 || size.y <= 0)
+  {
+    throw std::invalid_argument("Error: Invalid size specifier: " + sizeSpecifier);
+  }
+  return size;
+}
+
+/**
+ * \brief Parses any command-line arguments passed in by the user.
+ *
+ * \param argc  The command-line argument count.
+ * \param argv  The raw command-line arguments.
+ * \param args  The parsed command-line arguments.
+ * \return      true, if the program should continue after parsing the command-line arguments, or false otherwise.
+ */
+bool parse_command_line(int argc, char *argv[], CommandLineArguments& args)
+{
+  po::options_description options("Options");
+  options.add_options()
+    ("help", "produce help message")
+    ("baselineDir", po::value<std::string>(&args.baselineDir)->default_value(""), "directory containing the per-machine baselines against which to check the timings")
+    ("depthImage", po::value<std::string>(&args.depthImageFilename)->default_value(""), "recorded depth image (a 16-bit PGM in millimetres) on which to benchmark")
+    ("device", po::value<std::vector<std::string> >(&args.deviceNames)->multitoken(), "device(s) on which to benchmark (cpu|cuda, defaults to all available)")
+    ("forest", po::value<std::string>(&args.forestFilename)->default_value(""), "forest with which to benchmark (defaults to a synthetic forest)")
+    ("forestDepth", po::value<int>(&args.forestDepth)->default_value(12), "depth of the trees in the synthetic forest")
+    ("iterations,n", po::value<size_t>(&args.iterationCount)->default_value(50), "number of times to run each kernel")
+    ("layout", po::value<std::string>(&args.layoutName)->default_value("interleaved"), "forest node layout (interleaved|breadthfirst|blocked)")
+    ("recordBaseline", po::bool_switch(&args.recordBaseline), "record the timings as the baselines for this machine rather than checking them")
+    ("reservoirCapacity", po::value<uint32_t>(&args.reservoirCapacity)->default_value(1024), "capacity of each example reservoir")
+    ("rgbImage", po::value<std::string>(&args.rgbImageFilename)->default_value(""), "recorded RGB image (a PPM) on which to benchmark")
+    ("seed", po::value<unsigned int>(&args.seed)->default_value(12345), "seed for the synthetic inputs, forest and reservoirs")
+    ("size", po::value<std::vector<std::string> >(&args.sizeSpecifiers)->multitoken(), "size(s) of the synthetic inputs (e.g. 640x480, defaults to 320x240 and 640x480)")
+    ("tolerance", po::value<double>(&args.tolerance)->default_value(0.15), "fraction by which a timing must exceed its baseline to count as a slowdown")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, options), vm);
+  po::notify(vm);
+
+  if(vm.count("help"))
+  {
+    std::cout << options << '\n';
+    return false;
+  }
+
+  if((args.rgbImageFilename == "") != (args.depthImageFilename == ""))
+  {
+    throw std::invalid_argument("Error: Either both or neither of --rgbImage and --depthImage must be specified");
+  }
+
+  if(args.forestDepth < 1 || args.forestDepth > 20) throw std::invalid_argument("Error: The synthetic forest depth must be in the range [1,20]");
+  if(args.iterationCount == 0) throw std::invalid_argument("Error: The number of iterations must be at least 1");
+  if(args.recordBaseline && args.baselineDir == "") throw std::invalid_argument("Error: --recordBaseline requires --baselineDir");
+
+  if(args.deviceNames.empty())
+  {
+    args.deviceNames.push_back("cpu");
+#ifdef WITH_CUDA
+    args.deviceNames.push_back("cuda");
+#endif
+  }
+
+  if(args.sizeSpecifiers.empty())
+  {
+    args.sizeSpecifiers.push_back("320x240");
+    args.sizeSpecifiers.push_back("640x480");
+  }
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  CommandLineArguments args;
+  if(!parse_command_line(argc, argv, args)) return EXIT_SUCCESS;
+
+  const DecisionForestNodeLayout layout = parse_layout(args.layoutName);
+
+  // If no forest was specified, generate a synthetic one.
+  std::string forestFilename = args.forestFilename;
+  bf::path syntheticForestPath;
+  if(forestFilename == "")
+  {
+    syntheticForestPath = bf::temp_directory_path() / bf::unique_path("groveperf-%%%%-%%%%.txt");
+    forestFilename = syntheticForestPath.string();
+    write_synthetic_forest(forestFilename, args.forestDepth, args.seed);
+  }
+
+  std::vector<BenchmarkResult> results;
+  for(size_t i = 0, deviceCount = args.deviceNames.size(); i < deviceCount; ++i)
+  {
+    const std::string& deviceName = args.deviceNames[i];
+    ITMLibSettings::DeviceType deviceType;
+    if(deviceName == "cpu") deviceType = ITMLibSettings::DEVICE_CPU;
+    else if(deviceName == "cuda") deviceType = ITMLibSettings::DEVICE_CUDA;
+    else throw std::invalid_argument("Error: Unknown device: " + deviceName);
+
+    // Note: The memory block factory must be told which device to use before any of the images are made.
+    MemoryBlockFactory::instance().set_device_type(deviceType);
+    Forest_Ptr forest = DecisionForestFactory<RGBDPatchDescriptor,Forest::TREE_COUNT>::make_forest(forestFilename, deviceType, layout);
+
+    // Benchmark the kernels on the recorded input (if any), and on synthetic inputs of each of the specified sizes.
+    if(args.rgbImageFilename != "")
+    {
+      run_benchmarks(deviceType, deviceName, load_input(args.rgbImageFilename, args.depthImageFilename), forest, args, results);
+    }
+
+    for(size_t j = 0, sizeCount = args.sizeSpecifiers.size(); j < sizeCount; ++j)
+    {
+      run_benchmarks(deviceType, deviceName, make_synthetic_input(parse_size(args.sizeSpecifiers[j]), args.seed), forest, args, results);
+    }
+  }
+
+  if(!syntheticForestPath.empty()) bf::remove(syntheticForestPath);
+
+  // Output the results as CSV, so that they can easily be compared across commits.
+  std::cout << "kernel,device,input,layout,mean_ms,throughput,unit\n";
+  std::cout << std::fixed << std::setprecision(3);
+  for(size_t i = 0, size = results.size(); i < size; ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    std::cout << r.kernel << ',' << r.device << ',' << r.input << ',' << args.layoutName << ',' << r.meanMs << ',' << r.throughput << ',' << r.unit << '\n';
+  }
+
+  // If requested, check the timings against the baselines for this machine, and fail if any of the kernels has slowed down.
+  if(args.baselineDir != "" && !check_baseline(results, args)) return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,610 @@
+/**
+ * kernelperf: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/function.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+using boost::assign::map_list_of;
+
+#include <ITMLib/Core/ITMDenseMapper.h>
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+using namespace ITMLib;
+
+#ifdef WITH_CUDA
+#include <ORUtils/CUDADefines.h>
+#endif
+
+#include <itmx/base/DeviceUtil.h>
+#include <itmx/base/ITMImagePtrTypes.h>
+using namespace itmx;
+
+#include <rafl/core/RandomForest.h>
+#include <rafl/decisionfunctions/DecisionFunctionGeneratorFactory.h>
+using namespace rafl;
+
+#include <spaint/features/FeatureCalculatorFactory.h>
+#include <spaint/imagesources/AsyncImageSourceEngine.h>
+#include <spaint/propagation/LabelPropagatorFactory.h>
+#include <spaint/randomforest/ForestUtil.h>
+#include <spaint/randomforest/SpaintDecisionFunctionGenerator.h>
+#include <spaint/sampling/VoxelSamplerFactory.h>
+#include <spaint/util/SpaintVoxelScene.h>
+using namespace spaint;
+
+#include <tvgutil/timing/PerformanceBaseline.h>
+using namespace tvgutil;
+
+//#################### NAMESPACE ALIASES ####################
+
+namespace bf = boost::filesystem;
+namespace po = boost::program_options;
+
+//#################### TYPEDEFS ####################
+
+typedef boost::chrono::steady_clock Clock;
+typedef RandomForest<SpaintVoxel::Label> RF;
+
+//#################### CONSTANTS ####################
+
+// Note: These match the settings used by the semantic segmentation component, so that the kernels are benchmarked on representative inputs.
+const size_t BIN_COUNT = 36;
+const size_t MAX_LABEL_COUNT = 10;
+const size_t MAX_VOXELS_PER_LABEL = 128;
+const size_t PATCH_SIZE = 13;
+const size_t TREE_COUNT = 5;
+
+//#################### TYPES ####################
+
+struct CommandLineArguments
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  // User-specifiable arguments
+  std::string baselineDir;
+  std::vector<std::string> deviceNames;
+  size_t frameCount;
+  size_t iterationCount;
+  bool recordBaseline;
+  unsigned int seed;
+  size_t splitBudget;
+  double tolerance;
+};
+
+/**
+ * \brief An instance of this struct contains the result of benchmarking a single kernel on a particular device.
+ */
+struct BenchmarkResult
+{
+  std::string device;
+  std::string kernel;
+  double meanMs;
+  double throughput;
+  std::string unit;
+};
+
+/**
+ * \brief An instance of this class yields a fixed number of copies of a synthetic RGB-D image.
+ *
+ * This allows the throughput of the asynchronous image source to be measured without it being limited by the disk.
+ */
+class SyntheticImageSourceEngine : public InputSource::ImageSourceEngine
+{
+  //~~~~~~~~~~~~~~~~~~~~ PRIVATE VARIABLES ~~~~~~~~~~~~~~~~~~~~
+private:
+  /** The synthetic depth image. */
+  ITMShortImage m_depthImage;
+
+  /** The number of images that have yet to be yielded. */
+  size_t m_remainingFrameCount;
+
+  /** The synthetic RGB image. */
+  ITMUChar4Image m_rgbImage;
+
+  //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
+public:
+  /**
+   * \brief Constructs a synthetic image source engine.
+   *
+   * \param imgSize     The size of the images to yield.
+   * \param frameCount  The number of images to yield.
+   */
+  SyntheticImageSourceEngine(const Vector2i& imgSize, size_t frameCount)
+  : m_depthImage(imgSize, true, false), m_remainingFrameCount(frameCount), m_rgbImage(imgSize, true, false)
+  {
+    short *depth = m_depthImage.GetData(MEMORYDEVICE_CPU);
+    Vector4u *rgb = m_rgbImage.GetData(MEMORYDEVICE_CPU);
+    for(int i = 0, size = static_cast<int>(m_rgbImage.dataSize); i < size; ++i)
+    {
+      depth[i] = static_cast<short>(1000 + i % 1000);
+      rgb[i] = Vector4u(static_cast<uchar>(i), static_cast<uchar>(i / 3), static_cast<uchar>(i / 7), 255);
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+public:
+  /** Override */
+  virtual ITMRGBDCalib getCalib() const
+  {
+    return ITMRGBDCalib();
+  }
+
+  /** Override */
+  virtual Vector2i getDepthImageSize() const
+  {
+    return m_depthImage.noDims;
+  }
+
+  /** Override */
+  virtual void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+  {
+    rgb->SetFrom(&m_rgbImage, ITMUChar4Image::CPU_TO_CPU);
+    rawDepth->SetFrom(&m_depthImage, ITMShortImage::CPU_TO_CPU);
+    --m_remainingFrameCount;
+  }
+
+  /** Override */
+  virtual Vector2i getRGBImageSize() const
+  {
+    return m_rgbImage.noDims;
+  }
+
+  /** Override */
+  virtual bool hasMoreImages() const
+  {
+    return m_remainingFrameCount > 0;
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Compares the results of the benchmarks with the baselines recorded for the current machine, or records them as the new baselines.
+ *
+ * \param results The results of the benchmarks.
+ * \param args    The program's command-line arguments.
+ * \return        true, if none of the kernels has become slower than its baseline, or false otherwise.
+ */
+bool check_baseline(const std::vector<BenchmarkResult>& results, const CommandLineArguments& args)
+{
+  std::vector<PerformanceBaseline::Measurement> measurements;
+  for(size_t i = 0, size = results.size(); i < size; ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    measurements.push_back(PerformanceBaseline::Measurement(r.kernel + ',' + r.device, r.meanMs));
+  }
+
+  const std::string baselineFilename = PerformanceBaseline::get_machine_baseline_path(args.baselineDir);
+  PerformanceBaseline baseline(args.tolerance);
+  baseline.load(baselineFilename);
+
+  // Note: The report is written to std::cerr so as not to interfere with the CSV written to std::cout.
+  if(args.recordBaseline)
+  {
+    // Note: Loading the existing baselines first preserves those for any kernels or devices not benchmarked in this run.
+    for(size_t i = 0, size = measurements.size(); i < size; ++i)
+    {
+      baseline.set_baseline_ms(measurements[i].key, measurements[i].measuredMs);
+    }
+
+    bf::create_directories(args.baselineDir);
+    baseline.save(baselineFilename);
+    std::cerr << "Recorded " << measurements.size() << " baseline(s) in " << baselineFilename << '\n';
+    return true;
+  }
+  else return baseline.check(measurements, std::cerr);
+}
+
+/**
+ * \brief Copies the contents of a scene on the CPU into a scene on the GPU.
+ *
+ * Only the parts of the scene that are read by the kernels being benchmarked (the hash table, voxels and labels) are copied.
+ *
+ * \param cpuScene  The scene on the CPU.
+ * \param cudaScene The scene on the GPU.
+ */
+void copy_scene_to_cuda(SpaintVoxelScene& cpuScene, SpaintVoxelScene& cudaScene)
+{
+#ifdef WITH_CUDA
+  ORcudaSafeCall(cudaMemcpy(cudaScene.index.GetEntries(), cpuScene.index.GetEntries(), ITMVoxelBlockHash::noTotalEntries * sizeof(ITMHashEntry), cudaMemcpyHostToDevice));
+  ORcudaSafeCall(cudaMemcpy(cudaScene.localVBA.GetVoxelBlocks(), cpuScene.localVBA.GetVoxelBlocks(), cpuScene.localVBA.allocatedSize * sizeof(SpaintVoxel), cudaMemcpyHostToDevice));
+
+  if(cpuScene.get_label_data())
+  {
+    ORcudaSafeCall(cudaMemcpy(cudaScene.get_label_data(), cpuScene.get_label_data(), cpuScene.localVBA.allocatedSize * sizeof(SpaintVoxel::PackedLabel), cudaMemcpyHostToDevice));
+  }
+#else
+  throw std::runtime_error("Error: Cannot copy a scene to the GPU in a build without CUDA support");
+#endif
+}
+
+/**
+ * \brief Fills a freshly-reset scene on the CPU with a synthetic, textured and labelled floor plane.
+ *
+ * The plane covers the voxels with x in [-64,64) and z in [0,128), and lies at y = 0. Its voxels are labelled in stripes
+ * of labels 1 to 3, with an unlabelled stripe into which the labels can be propagated.
+ *
+ * \param scene The scene.
+ */
+void fill_plane(SpaintVoxelScene& scene)
+{
+  ITMHashEntry *hashTable = scene.index.GetEntries();
+  SpaintVoxel *voxelBlocks = scene.localVBA.GetVoxelBlocks();
+  SpaintVoxel::PackedLabel *labelData = scene.get_label_data();
+  int *allocationList = scene.localVBA.GetAllocationList();
+
+  // Allocate a 16x2x16 slab of voxel blocks straddling the plane y = 0 (skipping any blocks whose hash entries collide).
+  for(int bz = 0; bz < 16; ++bz)
+  {
+    for(int by = -1; by <= 0; ++by)
+    {
+      for(int bx = -8; bx < 8; ++bx)
+      {
+        Vector3s blockPos(bx, by, bz);
+        ITMHashEntry& entry = hashTable[hashIndex(blockPos)];
+        if(entry.ptr >= -1) continue;
+
+        entry.pos = blockPos;
+        entry.ptr = allocationList[scene.localVBA.lastFreeBlockId--];
+        entry.offset = 0;
+
+        // Fill in the voxels so that the surface lies at y = 0, and colour them with a checkerboard so that the patches have a dominant orientation.
+        for(int z = 0; z < SDF_BLOCK_SIZE; ++z)
+        {
+          for(int y = 0; y < SDF_BLOCK_SIZE; ++y)
+          {
+            for(int x = 0; x < SDF_BLOCK_SIZE; ++x)
+            {
+              const int wx = bx * SDF_BLOCK_SIZE + x, wy = by * SDF_BLOCK_SIZE + y, wz = bz * SDF_BLOCK_SIZE + z;
+              const int voxelAddress = entry.ptr * SDF_BLOCK_SIZE3 + (z * SDF_BLOCK_SIZE + y) * SDF_BLOCK_SIZE + x;
+              SpaintVoxel& voxel = voxelBlocks[voxelAddress];
+              voxel.sdf = SpaintVoxel::floatToValue(CLAMP(wy / 4.0f, -1.0f, 1.0f));
+              voxel.w_depth = 1;
+#ifndef USE_LOW_POWER_MODE
+              voxel.clr = (((wx + 64) / 3 + wz / 5) % 2) ? Vector3u(200, 80, 40) : Vector3u(30, 160, 220);
+              voxel.w_color = 1;
+#endif
+              get_voxel_label(voxelAddress, voxelBlocks, labelData) = SpaintVoxel::PackedLabel(static_cast<SpaintVoxel::Label>((wx + 64) / 32), SpaintVoxel::LG_USER);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * \brief Makes a synthetic raycast result that views the floor plane created by fill_plane from above.
+ *
+ * \param imgSize The size of the raycast result.
+ * \return        The raycast result (on the CPU, and on the GPU if available).
+ */
+ITMFloat4Image_Ptr make_raycast_result(const Vector2i& imgSize)
+{
+#ifdef WITH_CUDA
+  ITMFloat4Image_Ptr raycastResult(new ITMFloat4Image(imgSize, true, true));
+#else
+  ITMFloat4Image_Ptr raycastResult(new ITMFloat4Image(imgSize, true, false));
+#endif
+
+  // Note: The points in a raycast result are expressed in voxel coordinates.
+  Vector4f *points = raycastResult->GetData(MEMORYDEVICE_CPU);
+  for(int y = 0; y < imgSize.y; ++y)
+  {
+    for(int x = 0; x < imgSize.x; ++x)
+    {
+      points[y * imgSize.x + x] = Vector4f(x * 128.0f / imgSize.x - 64.0f, 0.0f, y * 128.0f / imgSize.y, 1.0f);
+    }
+  }
+
+#ifdef WITH_CUDA
+  raycastResult->UpdateDeviceFromHost();
+#endif
+
+  return raycastResult;
+}
+
+/**
+ * \brief Makes the settings for the random forest, matching those with which spaintgui trains its forest.
+ *
+ * \param seed  The seed for the random number generator.
+ * \return      The settings.
+ */
+RF::DT::Settings make_forest_settings(unsigned int seed)
+{
+  const std::map<std::string,std::string> properties = map_list_of
+    ("candidateCount", "128")
+    ("decisionFunctionGeneratorParams", boost::lexical_cast<std::string>(PATCH_SIZE))
+    ("decisionFunctionGeneratorType", SpaintDecisionFunctionGenerator::get_static_type())
+    ("gainThreshold", "0.0")
+    ("maxClassSize", "10000")
+    ("maxTreeHeight", "20")
+    ("randomSeed", boost::lexical_cast<std::string>(seed))
+    ("seenExamplesThreshold", "512")
+    ("splittabilityThreshold", "0.5")
+    ("usePMFReweighting", "1");
+
+  return RF::DT::Settings(properties);
+}
+
+/**
+ * \brief Reads all of the images from an asynchronous image source that wraps a synthetic image source.
+ *
+ * \param imgSize     The size of the images.
+ * \param frameCount  The number of images to read.
+ */
+void read_async_frames(const Vector2i& imgSize, size_t frameCount)
+{
+  AsyncImageSourceEngine engine(new SyntheticImageSourceEngine(imgSize, frameCount));
+  ITMUChar4Image rgb(imgSize, true, false);
+  ITMShortImage rawDepth(imgSize, true, false);
+  while(engine.hasMoreImages()) engine.getImages(&rgb, &rawDepth);
+}
+
+/**
+ * \brief Measures the mean time (in milliseconds) taken to run a kernel.
+ *
+ * The kernel is run once beforehand to warm up any caches and allocate any outputs, and we wait for the device
+ * to finish after each run, so that the time measured is that of the whole kernel rather than just its launch.
+ *
+ * \param kernel          The kernel.
+ * \param deviceType      The device on which the kernel runs.
+ * \param iterationCount  The number of times to run the kernel.
+ * \return                The mean time taken to run the kernel.
+ */
+double time_kernel(const boost::function<void()>& kernel, ITMLibSettings::DeviceType deviceType, size_t iterationCount)
+{
+  kernel();
+  DeviceUtil::synchronise(deviceType);
+
+  const Clock::time_point t0 = Clock::now();
+  for(size_t i = 0; i < iterationCount; ++i)
+  {
+    kernel();
+    DeviceUtil::synchronise(deviceType);
+  }
+  const Clock::time_point t1 = Clock::now();
+
+  return boost::chrono::duration<double,boost::milli>(t1 - t0).count() / iterationCount;
+}
+
+/**
+ * \brief Trains a fresh random forest on a set of examples, as done by a single step of spaintgui's trainer.
+ *
+ * \param examples    The examples.
+ * \param splitBudget The maximum number of nodes to split.
+ * \param seed        The seed for the random number generator.
+ */
+void train_forest(const ExampleMatrix<SpaintVoxel::Label>& examples, size_t splitBudget, unsigned int seed)
+{
+  RF forest(TREE_COUNT, make_forest_settings(seed));
+  forest.add_examples(examples);
+  forest.train(splitBudget);
+}
+
+/**
+ * \brief Runs the benchmarks for all of the kernels on the specified device.
+ *
+ * \param deviceType  The device on which to run the kernels.
+ * \param deviceName  The name of the device (for output purposes).
+ * \param cpuScene    The synthetic scene (on the CPU).
+ * \param args        The program's command-line arguments.
+ * \param results     The vector to which to append the results.
+ */
+void run_benchmarks(ITMLibSettings::DeviceType deviceType, const std::string& deviceName, SpaintVoxelScene& cpuScene,
+                    const CommandLineArguments& args, std::vector<BenchmarkResult>& results)
+{
+  ITMLibSettings settings;
+  settings.deviceType = deviceType;
+  ITMDenseMapper<SpaintVoxel,ITMVoxelIndex> mapper(&settings);
+  const MemoryDeviceType memoryType = deviceType == ITMLibSettings::DEVICE_CUDA ? MEMORYDEVICE_CUDA : MEMORYDEVICE_CPU;
+  const bool allocateCUDA = deviceType == ITMLibSettings::DEVICE_CUDA;
+
+  // Make a copy of the synthetic scene on the device.
+  boost::shared_ptr<SpaintVoxelScene> deviceScene;
+  SpaintVoxelScene *scene = &cpuScene;
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+    deviceScene.reset(new SpaintVoxelScene(&settings.sceneParams, false, memoryType));
+    mapper.ResetScene(deviceScene.get());
+    copy_scene_to_cuda(cpuScene, *deviceScene);
+    scene = deviceScene.get();
+  }
+
+  const Vector2i raycastResultSize(640, 480);
+  ITMFloat4Image_Ptr raycastResult = make_raycast_result(raycastResultSize);
+  const int pixelCount = raycastResultSize.x * raycastResultSize.y;
+
+  BenchmarkResult result;
+  result.device = deviceName;
+
+  // Benchmark sampling voxels for each label in use, as done when gathering training examples.
+  PerLabelVoxelSampler_CPtr sampler = VoxelSamplerFactory::make_per_label_sampler(MAX_LABEL_COUNT, MAX_VOXELS_PER_LABEL, pixelCount, args.seed, deviceType);
+  ORUtils::MemoryBlock<bool> labelMaskMB(MAX_LABEL_COUNT, true, allocateCUDA);
+  for(size_t i = 0; i < MAX_LABEL_COUNT; ++i) labelMaskMB.GetData(MEMORYDEVICE_CPU)[i] = i >= 1 && i <= 3;
+  labelMaskMB.UpdateDeviceFromHost();
+  ORUtils::MemoryBlock<Vector3s> sampledVoxelLocationsMB(MAX_LABEL_COUNT * MAX_VOXELS_PER_LABEL, true, allocateCUDA);
+  ORUtils::MemoryBlock<unsigned int> voxelCountsForLabelsMB(MAX_LABEL_COUNT, true, allocateCUDA);
+
+  result.kernel = "per_label_voxel_sampling";
+  result.meanMs = time_kernel(
+    boost::bind(&PerLabelVoxelSampler::sample_voxels, sampler.get(), raycastResult.get(), scene, boost::cref(labelMaskMB), boost::ref(sampledVoxelLocationsMB), boost::ref(voxelCountsForLabelsMB)),
+    deviceType, args.iterationCount
+  );
+  result.throughput = pixelCount / (result.meanMs / 1000.0);
+  result.unit = "pixels/s";
+  results.push_back(result);
+
+  // Benchmark calculating the VOP features for the sampled voxels.
+  FeatureCalculator_CPtr featureCalculator = FeatureCalculatorFactory::make_vop_feature_calculator(
+    MAX_LABEL_COUNT * MAX_VOXELS_PER_LABEL, PATCH_SIZE, 0.01f / settings.sceneParams.voxelSize, BIN_COUNT, deviceType
+  );
+  ORUtils::MemoryBlock<float> featuresMB(MAX_LABEL_COUNT * MAX_VOXELS_PER_LABEL * featureCalculator->get_feature_count(), true, allocateCUDA);
+
+  result.kernel = "vop_features";
+  result.meanMs = time_kernel(
+    boost::bind(&FeatureCalculator::calculate_features, featureCalculator.get(), boost::cref(sampledVoxelLocationsMB), scene, boost::ref(featuresMB)),
+    deviceType, args.iterationCount
+  );
+  result.throughput = sampledVoxelLocationsMB.dataSize / (result.meanMs / 1000.0);
+  result.unit = "voxels/s";
+  results.push_back(result);
+
+  // Benchmark a single training step of the random forest on the resulting examples. Note that the forest is always
+  // trained on the CPU, so this is only benchmarked once, but the examples are made on each device for simplicity.
+  if(deviceType == ITMLibSettings::DEVICE_CPU)
+  {
+    const ExampleMatrix<SpaintVoxel::Label> examples = ForestUtil::make_examples<SpaintVoxel::Label>(
+      featuresMB, voxelCountsForLabelsMB, featureCalculator->get_feature_count(), MAX_VOXELS_PER_LABEL, MAX_LABEL_COUNT
+    );
+
+    result.kernel = "rafl_train";
+    result.meanMs = time_kernel(boost::bind(&train_forest, boost::cref(examples), args.splitBudget, args.seed), deviceType, args.iterationCount);
+    result.throughput = examples.size() / (result.meanMs / 1000.0);
+    result.unit = "examples/s";
+    results.push_back(result);
+  }
+
+  // Benchmark propagating a label across the plane. Note that this modifies the scene, but since the propagation
+  // considers every pixel in the raycast result regardless of the labels involved, its cost is roughly constant.
+  LabelPropagator_CPtr labelPropagator = LabelPropagatorFactory::make_label_propagator(pixelCount, deviceType);
+
+  result.kernel = "label_propagation";
+  result.meanMs = time_kernel(
+    boost::bind(&LabelPropagator::propagate_label, labelPropagator.get(), SpaintVoxel::Label(1), raycastResult.get(), scene),
+    deviceType, args.iterationCount
+  );
+  result.throughput = pixelCount / (result.meanMs / 1000.0);
+  result.unit = "pixels/s";
+  results.push_back(result);
+
+  // Restore the labels in the CPU scene, so that the benchmarks on the next device start from the same input.
+  if(deviceType == ITMLibSettings::DEVICE_CPU)
+  {
+    mapper.ResetScene(&cpuScene);
+    fill_plane(cpuScene);
+  }
+}
+
+/**
+ * \brief Parses any command-line arguments passed in by the user.
+ *
+ * \param argc  The command-line argument count.
+ * \param argv  The raw command-line arguments.
+ * \param args  The parsed command-line arguments.
+ * \return      true, if the program should continue after parsing the command-line arguments, or false otherwise.
+ */
+bool parse_command_line(int argc, char *argv[], CommandLineArguments& args)
+{
+  po::options_description options("Options");
+  options.add_options()
+    ("help", "produce help message")
+    ("baselineDir", po::value<std::string>(&args.baselineDir)->default_value(""), "directory containing the per-machine baselines against which to check the timings")
+    ("device", po::value<std::vector<std::string> >(&args.deviceNames)->multitoken(), "device(s) on which to benchmark (cpu|cuda, defaults to all available)")
+    ("frames", po::value<size_t>(&args.frameCount)->default_value(200), "number of frames to read through the asynchronous image source")
+    ("iterations,n", po::value<size_t>(&args.iterationCount)->default_value(20), "number of times to run each kernel")
+    ("recordBaseline", po::bool_switch(&args.recordBaseline), "record the timings as the baselines for this machine rather than checking them")
+    ("seed", po::value<unsigned int>(&args.seed)->default_value(12345), "seed for the samplers and the forest")
+    ("splitBudget", po::value<size_t>(&args.splitBudget)->default_value(100), "maximum number of nodes to split in each training step of the forest")
+    ("tolerance", po::value<double>(&args.tolerance)->default_value(0.15), "fraction by which a timing must exceed its baseline to count as a slowdown")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, options), vm);
+  po::notify(vm);
+
+  if(vm.count("help"))
+  {
+    std::cout << options << '\n';
+    return false;
+  }
+
+  if(args.frameCount == 0) throw std::invalid_argument("Error: The number of frames must be at least 1");
+  if(args.iterationCount == 0) throw std::invalid_argument("Error: The number of iterations must be at least 1");
+  if(args.recordBaseline && args.baselineDir == "") throw std::invalid_argument("Error: --recordBaseline requires --baselineDir");
+
+  if(args.deviceNames.empty())
+  {
+    args.deviceNames.push_back("cpu");
+#ifdef WITH_CUDA
+    args.deviceNames.push_back("cuda");
+#endif
+  }
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  CommandLineArguments args;
+  if(!parse_command_line(argc, argv, args)) return EXIT_SUCCESS;
+
+  // Register the decision function generator used by spaintgui's forest.
+  DecisionFunctionGeneratorFactory<SpaintVoxel::Label>::instance().register_maker(
+    SpaintDecisionFunctionGenerator::get_static_type(),
+    &SpaintDecisionFunctionGenerator::maker
+  );
+
+  // Make the synthetic scene on which to benchmark the voxel kernels.
+  ITMLibSettings cpuSettings;
+  cpuSettings.deviceType = ITMLibSettings::DEVICE_CPU;
+  SpaintVoxelScene cpuScene(&cpuSettings.sceneParams, false, MEMORYDEVICE_CPU);
+  ITMDenseMapper<SpaintVoxel,ITMVoxelIndex> cpuMapper(&cpuSettings);
+  cpuMapper.ResetScene(&cpuScene);
+  fill_plane(cpuScene);
+
+  std::vector<BenchmarkResult> results;
+  for(size_t i = 0, deviceCount = args.deviceNames.size(); i < deviceCount; ++i)
+  {
+    const std::string& deviceName = args.deviceNames[i];
+    ITMLibSettings::DeviceType deviceType;
+    if(deviceName == "cpu") deviceType = ITMLibSettings::DEVICE_CPU;
+    else if(deviceName == "cuda") deviceType = ITMLibSettings::DEVICE_CUDA;
+    else throw std::invalid_argument("Error: Unknown device: " + deviceName);
+
+    run_benchmarks(deviceType, deviceName, cpuScene, args, results);
+  }
+
+  // Benchmark the throughput of the asynchronous image source, which does not depend on the device.
+  const Vector2i imgSize(640, 480);
+  BenchmarkResult result;
+  result.device = "host";
+  result.kernel = "async_image_source";
+  result.meanMs = time_kernel(boost::bind(&read_async_frames, imgSize, args.frameCount), ITMLibSettings::DEVICE_CPU, args.iterationCount);
+  result.throughput = args.frameCount / (result.meanMs / 1000.0);
+  result.unit = "frames/s";
+  results.push_back(result);
+
+  // Output the results as CSV, so that they can easily be compared across commits.
+  std::cout << "kernel,device,mean_ms,throughput,unit\n";
+  std::cout << std::fixed << std::setprecision(3);
+  for(size_t i = 0, size = results.size(); i < size; ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    std::cout << r.kernel << ',' << r.device << ',' << r.meanMs << ',' << r.throughput << ',' << r.unit << '\n';
+  }
+
+  // If requested, check the timings against the baselines for this machine, and fail if any of the kernels has slowed down.
+  if(args.baselineDir != "" && !check_baseline(results, args)) return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,47 @@
+/**
+ * perfmerge: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <evaluation/core/PerformanceLog.h>
+using namespace evaluation;
+
+//#################### FUNCTIONS ####################
+
+int main(int argc, char *argv[])
+try
+{
+  if(argc < 3)
+  {
+    std::cerr << "Usage: perfmerge <output file> <log file> [<log file> ...]\n";
+    return EXIT_FAILURE;
+  }
+
+  // Merge the performance logs (e.g. from the different shards of a raflperf or touchtrain parameter sweep) into a single table.
+  std::vector<std::string> logPaths(argv + 2, argv + argc);
+  PerformanceTable results = PerformanceLog::merge(logPaths);
+
+  // Output the performance table to the screen.
+  results.output(std::cout);
+
+  // Output the performance table to the results file.
+  const std::string outputPath = argv[1];
+  std::ofstream resultsFile(outputPath.c_str());
+  if(!resultsFile)
+  {
+    std::cerr << "Error: Could not open '" << outputPath << "' for writing\n";
+    return EXIT_FAILURE;
+  }
+
+  results.output(resultsFile);
+  return 0;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -3,23 +3,31 @@
  * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
  */
 
+#include <fstream>
+
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
 using boost::assign::list_of;
 using boost::assign::map_list_of;
 
 #include <evaluation/core/ParamSetUtil.h>
+#include <evaluation/core/PerformanceLog.h>
 #include <evaluation/core/PerformanceTable.h>
 #include <evaluation/splitgenerators/CrossValidationSplitGenerator.h>
 #include <evaluation/splitgenerators/RandomPermutationAndDivisionSplitGenerator.h>
 #include <evaluation/util/CartesianProductParameterSetGenerator.h>
 using namespace evaluation;
 
+#include <rafl/examples/ChunkedExampleWriter.h>
 #include <rafl/examples/ExampleUtil.h>
 #include <rafl/examples/UnitCircleExampleGenerator.h>
 using namespace rafl;
 
 #include <raflevaluation/RandomForestEvaluator.h>
+#include <raflevaluation/StreamingRandomForestEvaluator.h>
 using namespace raflevaluation;
 
 #include <tvgutil/timing/Timer.h>
@@ -33,25 +41,95 @@ typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
 
 //#################### FUNCTIONS ####################
 
-int main(int argc, char *argv[])
+/**
+ * \brief Converts a text file of examples (in the format read by ExampleUtil::load_examples) into a chunked example file.
+ *
+ * The text file is read one line at a time, so this can be used to convert files that are too large to be loaded into memory.
+ *
+ * \param inputPath           The path to the text file.
+ * \param outputPath          The path to the chunked example file to write.
+ * \param chunkSize           The maximum number of examples in each chunk.
+ * \throws std::runtime_error If the text file cannot be read or contains no examples, or the chunked example file cannot be written.
+ */
+void convert_examples(const std::string& inputPath, const std::string& outputPath, size_t chunkSize)
 {
-#if WITH_OPENMP
-  omp_set_nested(1);
-#endif
+  typedef boost::char_separator<char> sep;
+  typedef boost::tokenizer<sep> tokenizer;
+
+  std::ifstream fs(inputPath.c_str());
+  if(!fs) throw std::runtime_error("Error: '" + inputPath + "' could not be opened");
+
+  // Note: The writer is created when the first example is read, since that determines the number of features in each descriptor.
+  boost::shared_ptr<ChunkedExampleWriter<Label> > writer;
+  std::vector<float> features;
+  size_t exampleCount = 0;
+
+  std::string line;
+  while(std::getline(fs, line))
+  {
+    tokenizer tok(line.begin(), line.end(), sep(", \r"));
+    std::vector<std::string> words(tok.begin(), tok.end());
+    if(words.empty()) continue;
+
+    features.clear();
+    for(size_t j = 0; j + 1 < words.size(); ++j)
+    {
+      features.push_back(boost::lexical_cast<float>(words[j]));
+    }
+
+    const Label label = boost::lexical_cast<Label>(words.back());
+    if(!writer) writer.reset(new ChunkedExampleWriter<Label>(outputPath, features.size(), chunkSize));
+    writer->add_example(features.empty() ? NULL : &features[0], features.size(), label);
+    ++exampleCount;
+  }
+
+  if(!writer) throw std::runtime_error("Error: '" + inputPath + "' does not contain any examples");
+  writer->close();
+
+  std::cout << "Converted " << exampleCount << " examples from '" << inputPath << "' to '" << outputPath << "'\n";
+}
 
+int main(int argc, char *argv[])
+try
+{
   const unsigned int seed = 12345;
 
-  if(argc != 1 && argc != 4)
+  // Separate the options from the positional arguments.
+  std::vector<std::string> args;
+  std::string logPath, shardSpec;
+  bool convert = false;
+  size_t chunkSize = 65536;
+  for(int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if(arg == "--chunkSize" && i + 1 < argc) chunkSize = boost::lexical_cast<size_t>(argv[++i]);
+    else if(arg == "--convert") convert = true;
+    else if(arg == "--log" && i + 1 < argc) logPath = argv[++i];
+    else if(arg == "--shard" && i + 1 < argc) shardSpec = argv[++i];
+    else args.push_back(arg);
+  }
+
+  if(convert ? args.size() != 2 : (args.size() != 0 && args.size() != 3))
   {
-    std::cerr << "Usage: raflperf [<training set file> <test set file> <output path>]\n";
+    std::cerr << "Usage: raflperf [--shard <i>/<n>] [--log <log file>] [<training set file> <test set file> <output path>]\n"
+              << "       raflperf --convert [--chunkSize <n>] <examples file> <chunked example file>\n";
     return EXIT_FAILURE;
   }
 
+  // If requested, convert a text file of examples into a chunked example file, which can then be used to evaluate the forest
+  // without loading all of the examples into memory.
+  if(convert)
+  {
+    convert_examples(args[0], args[1], chunkSize);
+    return 0;
+  }
+
   std::vector<Example_CPtr> examples;
   std::vector<ParamSet> params;
-  std::string outputResultPath;
+  std::string outputResultPath, testingSetPath, trainingSetPath;
+  bool streaming = false;
 
-  if(argc == 1)
+  if(args.empty())
   {
 #define CLASS_IMBALANCE_TEST
 
@@ -97,20 +175,37 @@ int main(int argc, char *argv[])
 
     outputResultPath = "UnitCircleExampleGenerator-Results.txt";
   }
-  else if(argc == 4)
+  else
   {
-    std::string trainingSetPath = argv[1];
-    std::string testingSetPath = argv[2];
-    outputResultPath = argv[3];
+    trainingSetPath = args[0];
+    testingSetPath = args[1];
+    outputResultPath = args[2];
 
     std::cout << "Training set: " << trainingSetPath << '\n';
     std::cout << "Testing set: " << testingSetPath << '\n';
 
-    examples = ExampleUtil::load_examples<Label>(trainingSetPath);
-    std::vector<Example_CPtr> testingExamples = ExampleUtil::load_examples<Label>(testingSetPath);
-
-    examples.insert(examples.end(), testingExamples.begin(), testingExamples.end());
-    std::cout << "Number of examples = " << examples.size() << '\n';
+    // If the example sets are stored in chunked example files, stream them rather than loading them into memory. In that case,
+    // the forest is trained on the training set and tested on the test set, rather than on random splits of the combined sets.
+    const bool chunkedTrainingSet = ChunkedExampleFile::is_chunked_example_file(trainingSetPath);
+    const bool chunkedTestingSet = ChunkedExampleFile::is_chunked_example_file(testingSetPath);
+    if(chunkedTrainingSet != chunkedTestingSet)
+    {
+      throw std::runtime_error("Error: The training and test sets must either both or neither be stored in chunked example files");
+    }
+
+    streaming = chunkedTrainingSet;
+    if(streaming)
+    {
+      std::cout << "Streaming the examples from chunked example files\n";
+    }
+    else
+    {
+      examples = ExampleUtil::load_examples<Label>(trainingSetPath);
+      std::vector<Example_CPtr> testingExamples = ExampleUtil::load_examples<Label>(testingSetPath);
+
+      examples.insert(examples.end(), testingExamples.begin(), testingExamples.end());
+      std::cout << "Number of examples = " << examples.size() << '\n';
+    }
 
     // Generate the parameter sets with which to test the random forest.
     params = CartesianProductParameterSetGenerator()
@@ -129,6 +224,26 @@ int main(int argc, char *argv[])
       .generate_param_sets();
   }
 
+  // If requested, restrict the sweep to a single shard of the parameter sets, so that it can be spread across several processes.
+  if(!shardSpec.empty())
+  {
+    params = ParamSetUtil::select_shard(params, shardSpec);
+    std::cout << "Evaluating shard " << shardSpec << " (" << params.size() << " parameter sets)\n";
+  }
+
+  // Open the log to which to append the results for each parameter set as soon as they are available. If the log
+  // already exists (e.g. because a previous run crashed), the parameter sets it contains will not be re-evaluated.
+  // The logs for the different shards of a sweep can be combined into a single table using perfmerge.
+  if(logPath.empty())
+  {
+    logPath = outputResultPath;
+    if(!shardSpec.empty()) logPath += "-shard" + boost::replace_all_copy(shardSpec, "/", "of");
+    logPath += ".log";
+  }
+
+  PerformanceLog log(logPath);
+  std::cout << "Result log: " << logPath << " (" << log.get_entries().size() << " existing entries)\n";
+
   // Register the relevant decision function generators with the factory.
   DecisionFunctionGeneratorFactory<Label>::instance().register_rafl_makers();
 
@@ -150,8 +265,26 @@ int main(int argc, char *argv[])
   boost::shared_ptr<RandomForestEvaluator<Label> > evaluator;
   for(size_t n = 0, size = params.size(); n < size; ++n)
   {
-    evaluator.reset(new RandomForestEvaluator<Label>(splitGenerator, params[n]));
-    PerformanceResult result = evaluator->evaluate(examples);
+    // If the results for this parameter set are already in the log, reuse them rather than re-evaluating the forest.
+    const PerformanceResult *loggedResult = log.find_result(params[n]);
+    if(loggedResult)
+    {
+      results.record_performance(params[n], *loggedResult);
+      continue;
+    }
+
+    PerformanceResult result;
+    if(streaming)
+    {
+      result = StreamingRandomForestEvaluator<Label>(params[n]).evaluate(trainingSetPath, testingSetPath);
+    }
+    else
+    {
+      evaluator.reset(new RandomForestEvaluator<Label>(splitGenerator, params[n]));
+      result = evaluator->evaluate(examples);
+    }
+
+    log.record_performance(params[n], result);
     results.record_performance(params[n], result);
   }
 
@@ -177,3 +310,8 @@ int main(int argc, char *argv[])
 
   return 0;
 }
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
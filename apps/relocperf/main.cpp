@@ -0,0 +1,538 @@
+/**
+ * relocperf: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include <InputSource/ImageSourceEngine.h>
+
+#include <ITMLib/Core/ITMDenseMapper.h>
+#include <ITMLib/Engines/LowLevel/ITMLowLevelEngineFactory.h>
+#include <ITMLib/Engines/ViewBuilding/ITMViewBuilderFactory.h>
+#include <ITMLib/Objects/Misc/ITMIMUCalibrator.h>
+#include <ITMLib/Objects/RenderStates/ITMRenderStateFactory.h>
+
+#ifdef WITH_GROVE
+#include <grove/relocalisation/ScoreRelocaliserFactory.h>
+#endif
+
+#include <itmx/base/DeviceUtil.h>
+#include <itmx/base/MemoryBlockFactory.h>
+#include <itmx/persistence/PosePersister.h>
+#include <itmx/relocalisation/CascadeRelocaliser.h>
+#include <itmx/relocalisation/FernRelocaliser.h>
+#include <itmx/relocalisation/ICPRefiningRelocaliser.h>
+
+#include <spaint/trackers/TrackerFactory.h>
+#include <spaint/util/SpaintVoxelScene.h>
+#include <spaint/visualisation/VisualiserFactory.h>
+
+#include <tvgutil/persistence/JSONUtil.h>
+#include <tvgutil/timing/ProfilingScope.h>
+#include <tvgutil/timing/TimeUtil.h>
+
+using namespace InputSource;
+using namespace ITMLib;
+
+using namespace itmx;
+using namespace spaint;
+using namespace tvgutil;
+
+//#################### NAMESPACE ALIASES ####################
+
+namespace bf = boost::filesystem;
+namespace po = boost::program_options;
+
+//#################### TYPEDEFS ####################
+
+typedef ITMDenseMapper<SpaintVoxel,ITMVoxelIndex> DenseMapper;
+typedef boost::shared_ptr<DenseMapper> DenseMapper_Ptr;
+typedef ICPRefiningRelocaliser<SpaintVoxel,ITMVoxelIndex> Refiner;
+typedef boost::shared_ptr<Refiner> Refiner_Ptr;
+
+//#################### TYPES ####################
+
+struct CommandLineArguments
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  // User-specifiable arguments
+  std::string forestFilename;
+  size_t hypothesisCount;
+  size_t maxTestFrameCount;
+  size_t maxTrainFrameCount;
+  std::string outputFilename;
+  std::string relocaliserType;
+  std::string testSequenceDir;
+  std::string trainSequenceDir;
+  size_t warmupFrameCount;
+};
+
+/**
+ * \brief An instance of this struct contains the accuracy statistics for one of the poses produced by the relocaliser
+ *        (either the pose from the inner relocaliser, or the refined pose) at a particular error threshold.
+ */
+struct AccuracyCounts
+{
+  size_t innerSuccessCount;
+  size_t refinedSuccessCount;
+};
+
+/**
+ * \brief An instance of this struct represents an error threshold at which to evaluate the relocalised poses.
+ */
+struct ErrorThreshold
+{
+  double rotationDegrees;
+  double translationMetres;
+};
+
+/**
+ * \brief An instance of this struct allows the frames of an RGB-D sequence with ground-truth poses to be read in turn.
+ *
+ * The sequence is expected to be stored in the format used by spaintgui's sequence recorder (rgbm%06i.ppm, depthm%06i.pgm),
+ * together with its calibration (calib.txt) and a camera -> world pose for each frame (posem%06i.txt).
+ */
+struct Sequence
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  /** The directory containing the sequence. */
+  bf::path dir;
+
+  /** The index of the next frame to be read. */
+  size_t frameIndex;
+
+  /** The raw depth image for the most recent frame. */
+  ITMShortImage_Ptr rawDepthImage;
+
+  /** The reader used to read the images. */
+  boost::shared_ptr<ImageFileReader<ImageMaskPathGenerator> > reader;
+
+  /** The colour image for the most recent frame. */
+  ITMUChar4Image_Ptr rgbImage;
+
+  /** The view containing the images for the most recent frame (with the depth image converted to metres). */
+  View_Ptr view;
+
+  /** The view builder used to make the views. */
+  ViewBuilder_Ptr viewBuilder;
+
+  //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Opens the sequence in the specified directory.
+   *
+   * \param dir_        The directory containing the sequence.
+   * \param deviceType  The device on which the views should be built.
+   */
+  Sequence(const bf::path& dir_, ITMLibSettings::DeviceType deviceType)
+  : dir(dir_), frameIndex(0)
+  {
+    const std::string calibrationFilename = (dir / "calib.txt").string();
+    const std::string depthImageMask = (dir / "depthm%06i.pgm").string();
+    const std::string rgbImageMask = (dir / "rgbm%06i.ppm").string();
+    ImageMaskPathGenerator pathGenerator(rgbImageMask.c_str(), depthImageMask.c_str());
+    reader.reset(new ImageFileReader<ImageMaskPathGenerator>(calibrationFilename.c_str(), pathGenerator, 0));
+
+    const bool useGPU = deviceType == ITMLibSettings::DEVICE_CUDA;
+    rawDepthImage.reset(new ITMShortImage(reader->getDepthImageSize(), true, useGPU));
+    rgbImage.reset(new ITMUChar4Image(reader->getRGBImageSize(), true, useGPU));
+    view.reset(new ITMView(reader->getCalib(), reader->getRGBImageSize(), reader->getDepthImageSize(), useGPU));
+    viewBuilder.reset(ITMViewBuilderFactory::MakeViewBuilder(reader->getCalib(), deviceType));
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Gets the intrinsic parameters of the depth camera.
+   *
+   * \return  The intrinsic parameters of the depth camera.
+   */
+  Vector4f depth_intrinsics() const
+  {
+    return view->calib.intrinsics_d.projectionParamsSimple.all;
+  }
+
+  /**
+   * \brief Attempts to read the next frame of the sequence into the view.
+   *
+   * \param gtPose  A location into which to store the ground-truth camera -> world pose of the frame (if it has one).
+   * \return        true, if there was another frame to read, or false otherwise.
+   */
+  bool read_frame(boost::optional<Matrix4f>& gtPose)
+  {
+    if(!reader->hasMoreImages()) return false;
+
+    reader->getImages(rgbImage.get(), rawDepthImage.get());
+    ITMView *newView = view.get();
+    viewBuilder->UpdateView(&newView, rgbImage.get(), rawDepthImage.get(), false);
+
+    const bf::path posePath = dir / (boost::format("posem%06i.txt") % frameIndex).str();
+    if(bf::exists(posePath)) gtPose = PosePersister::load_pose(posePath.string());
+    else gtPose.reset();
+
+    ++frameIndex;
+    return true;
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Computes the errors between an estimated camera -> world pose and the corresponding ground-truth pose.
+ *
+ * \param estimatedPose       The estimated pose.
+ * \param gtPose              The ground-truth pose.
+ * \param rotationDegrees     A location into which to store the angle (in degrees) of the rotation between the two poses.
+ * \param translationMetres   A location into which to store the distance (in metres) between the positions of the two cameras.
+ */
+void compute_pose_errors(const Matrix4f& estimatedPose, const Matrix4f& gtPose, double& rotationDegrees, double& translationMetres)
+{
+  // Note: The trace of R_gt^T * R_est is the sum of the elementwise products of the two rotation matrices.
+  double trace = 0.0;
+  for(int x = 0; x < 3; ++x)
+  {
+    for(int y = 0; y < 3; ++y)
+    {
+      trace += gtPose(x,y) * estimatedPose(x,y);
+    }
+  }
+
+  const double cosAngle = std::min(std::max((trace - 1.0) / 2.0, -1.0), 1.0);
+  rotationDegrees = acos(cosAngle) * 180.0 / M_PI;
+
+  const double dx = estimatedPose(3,0) - gtPose(3,0), dy = estimatedPose(3,1) - gtPose(3,1), dz = estimatedPose(3,2) - gtPose(3,2);
+  translationMetres = sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/**
+ * \brief Gets the error thresholds at which to evaluate the relocalised poses.
+ *
+ * \return  The error thresholds at which to evaluate the relocalised poses (the 5cm/5 degree threshold is the standard one for 7-Scenes).
+ */
+std::vector<ErrorThreshold> get_error_thresholds()
+{
+  static const double thresholds[][2] = { { 2.0, 0.02 }, { 5.0, 0.05 }, { 10.0, 0.10 } };
+  std::vector<ErrorThreshold> result;
+  for(size_t i = 0, size = sizeof(thresholds) / sizeof(thresholds[0]); i < size; ++i)
+  {
+    ErrorThreshold threshold;
+    threshold.rotationDegrees = thresholds[i][0];
+    threshold.translationMetres = thresholds[i][1];
+    result.push_back(threshold);
+  }
+  return result;
+}
+
+/**
+ * \brief Makes a relocaliser whose results are to be refined.
+ *
+ * \param type                    The type of relocaliser to make (ferns|forest).
+ * \param args                    The program's command-line arguments.
+ * \param settings                The application settings.
+ * \return                        The relocaliser.
+ * \throws std::invalid_argument  If the relocaliser type is not supported.
+ */
+Relocaliser_Ptr make_inner_relocaliser(const std::string& type, const CommandLineArguments& args, const Settings_CPtr& settings)
+{
+  if(type == "ferns")
+  {
+    // Note: Since every frame is relocalised, we always try to add keyframes, as SLAMComponent does when relocalising every frame.
+    return Relocaliser_Ptr(new FernRelocaliser(
+      settings->sceneParams.viewFrustum_min,
+      settings->sceneParams.viewFrustum_max,
+      FernRelocaliser::get_default_harvesting_threshold(),
+      FernRelocaliser::get_default_num_ferns(),
+      FernRelocaliser::get_default_num_decisions_per_fern(),
+      settings->deviceType,
+      FernRelocaliser::ALWAYS_TRY_ADD
+    ));
+  }
+#ifdef WITH_GROVE
+  else if(type == "forest")
+  {
+    if(args.forestFilename == "") throw std::invalid_argument("Error: The forest relocaliser requires a forest (see --forest)");
+    return grove::ScoreRelocaliserFactory::make_score_relocaliser(args.forestFilename, settings);
+  }
+#endif
+  else throw std::invalid_argument("Error: Unknown relocaliser type: " + type);
+}
+
+/**
+ * \brief Parses any command-line arguments passed in by the user.
+ *
+ * \param argc  The command-line argument count.
+ * \param argv  The raw command-line arguments.
+ * \param args  The parsed command-line arguments.
+ * \return      true, if the program should continue after parsing the command-line arguments, or false otherwise.
+ */
+bool parse_command_line(int argc, char *argv[], CommandLineArguments& args)
+{
+  po::options_description options("Options");
+  options.add_options()
+    ("help", "produce help message")
+    ("forest,f", po::value<std::string>(&args.forestFilename)->default_value(""), "forest filename (for the forest relocaliser)")
+    ("hypotheses", po::value<size_t>(&args.hypothesisCount)->default_value(1), "maximum number of pose hypotheses to refine using ICP")
+    ("maxTestFrames", po::value<size_t>(&args.maxTestFrameCount)->default_value(0), "maximum number of testing frames to relocalise (0 means all of them)")
+    ("maxTrainFrames", po::value<size_t>(&args.maxTrainFrameCount)->default_value(0), "maximum number of training frames to use (0 means all of them)")
+    ("output,o", po::value<std::string>(&args.outputFilename)->default_value(""), "file to which to write the results (defaults to stdout)")
+    ("relocaliserType,r", po::value<std::string>(&args.relocaliserType)->default_value("ferns"), "relocaliser type (ferns|forest|cascade)")
+    ("test", po::value<std::string>(&args.testSequenceDir), "directory containing the testing sequence")
+    ("train", po::value<std::string>(&args.trainSequenceDir), "directory containing the training sequence")
+    ("warmupFrames,w", po::value<size_t>(&args.warmupFrameCount)->default_value(5), "number of testing frames to relocalise before starting to measure the latencies")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, options), vm);
+  po::notify(vm);
+
+  if(vm.count("help") || args.trainSequenceDir == "" || args.testSequenceDir == "")
+  {
+    std::cout << "Usage: relocperf --train <sequence dir> --test <sequence dir> [options]\n\n" << options << '\n';
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * \brief Writes the results of a benchmark run to a stream as JSON.
+ *
+ * \param os                The stream.
+ * \param args              The program's command-line arguments.
+ * \param settings          The application settings.
+ * \param trainFrameCount   The number of frames on which the relocaliser was trained.
+ * \param testFrameCount    The number of frames (with ground-truth poses) that were relocalised.
+ * \param goodCount         The number of relocalisations whose refined pose the relocaliser considered to be good.
+ * \param thresholds        The error thresholds at which the relocalised poses were evaluated.
+ * \param accuracyCounts    The number of successful relocalisations at each threshold.
+ * \param cascade           The relocaliser cascade that was evaluated (if any).
+ */
+void write_results(std::ostream& os, const CommandLineArguments& args, const Settings_CPtr& settings, size_t trainFrameCount, size_t testFrameCount,
+                   size_t goodCount, const std::vector<ErrorThreshold>& thresholds, const std::vector<AccuracyCounts>& accuracyCounts,
+                   const CascadeRelocaliser_CPtr& cascade)
+{
+  const double denominator = testFrameCount > 0 ? static_cast<double>(testFrameCount) : 1.0;
+  os << std::fixed << std::setprecision(3);
+
+  os << "{\n"
+     << "  \"timestamp\": \"" << TimeUtil::get_iso_timestamp() << "\",\n"
+     << "  \"config\": {\n"
+     << "    \"trainSequence\": \"" << JSONUtil::escape_string(args.trainSequenceDir) << "\",\n"
+     << "    \"testSequence\": \"" << JSONUtil::escape_string(args.testSequenceDir) << "\",\n"
+     << "    \"relocaliserType\": \"" << args.relocaliserType << "\",\n"
+     << "    \"hypotheses\": " << args.hypothesisCount << ",\n"
+     << "    \"deviceType\": \"" << (settings->deviceType == ITMLibSettings::DEVICE_CUDA ? "cuda" : "cpu") << "\",\n"
+     << "    \"warmupFrames\": " << args.warmupFrameCount << "\n"
+     << "  },\n"
+     << "  \"trainFrames\": " << trainFrameCount << ",\n"
+     << "  \"testFrames\": " << testFrameCount << ",\n"
+     << "  \"goodRate\": " << goodCount / denominator << ",\n";
+
+  os << "  \"successRates\": [";
+  for(size_t i = 0, size = thresholds.size(); i < size; ++i)
+  {
+    os << (i > 0 ? ",\n" : "\n")
+       << "    {\"rotationDegrees\": " << thresholds[i].rotationDegrees << ", \"translationMetres\": " << thresholds[i].translationMetres
+       << ", \"inner\": " << accuracyCounts[i].innerSuccessCount / denominator << ", \"refined\": " << accuracyCounts[i].refinedSuccessCount / denominator << '}';
+  }
+  os << "\n  ],\n";
+
+  if(cascade)
+  {
+    os << "  \"cascadeStages\": [";
+    const std::vector<CascadeRelocaliser::StageStats>& cascadeStats = cascade->get_stage_stats();
+    for(size_t i = 0, size = cascadeStats.size(); i < size; ++i)
+    {
+      const CascadeRelocaliser::StageStats& s = cascadeStats[i];
+      os << (i > 0 ? ",\n" : "\n")
+         << "    {\"name\": \"" << JSONUtil::escape_string(s.name) << "\", \"attempts\": " << s.attemptCount << ", \"hits\": " << s.hitCount
+         << ", \"meanMs\": " << (s.attemptCount > 0 ? s.totalMilliseconds / s.attemptCount : 0.0) << '}';
+    }
+    os << "\n  ],\n";
+  }
+
+  os << "  \"stages\": [";
+  const std::vector<Profiler::StageStats> stageStats = Profiler::instance().get_stage_stats();
+  for(size_t i = 0, size = stageStats.size(); i < size; ++i)
+  {
+    const Profiler::StageStats& s = stageStats[i];
+    os << (i > 0 ? ",\n" : "\n")
+       << "    {\"name\": \"" << JSONUtil::escape_string(s.name) << "\", \"count\": " << s.count << ", \"meanMs\": " << s.meanMs
+       << ", \"p50Ms\": " << s.p50Ms << ", \"p95Ms\": " << s.p95Ms << ", \"p99Ms\": " << s.p99Ms << '}';
+  }
+  os << "\n  ]\n}\n";
+}
+
+int main(int argc, char *argv[])
+try
+{
+  // Parse the command-line arguments.
+  CommandLineArguments args;
+  if(!parse_command_line(argc, argv, args)) return 0;
+
+  // Construct the settings object.
+  Settings_Ptr settings(new Settings);
+  settings->trackerConfig = NULL;
+  MemoryBlockFactory::instance().set_device_type(settings->deviceType);
+  const MemoryDeviceType memoryType = settings->GetMemoryType();
+
+  // Open the sequences. Note that the images in the two sequences must have the same sizes, since the refinement is set up for them in advance.
+  Sequence trainSequence(args.trainSequenceDir, settings->deviceType);
+  Sequence testSequence(args.testSequenceDir, settings->deviceType);
+  const Vector2i depthImageSize = testSequence.reader->getDepthImageSize();
+  const Vector2i rgbImageSize = testSequence.reader->getRGBImageSize();
+  if(trainSequence.reader->getDepthImageSize() != depthImageSize || trainSequence.reader->getRGBImageSize() != rgbImageSize)
+  {
+    throw std::runtime_error("Error: The training and testing sequences must have images of the same sizes");
+  }
+
+  // Set up the voxel scene against which the relocalised poses will be refined, and the mapper used to fuse the training frames into it.
+  SpaintVoxelScene_Ptr voxelScene(new SpaintVoxelScene(&settings->sceneParams, settings->swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED, memoryType));
+  DenseMapper_Ptr denseVoxelMapper(new DenseMapper(settings.get()));
+  denseVoxelMapper->ResetScene(voxelScene.get());
+
+  // Set up the relocaliser, refining its results using the same ICP tracker as SLAMComponent. If a cascade is requested, then (as in
+  // SLAMComponent) its stages are the fern relocaliser, followed by the forest relocaliser (if a forest was specified), each of which
+  // refines its own results. Note that this means that only the refined poses are available for the cascade.
+  LowLevelEngine_CPtr lowLevelEngine(ITMLowLevelEngineFactory::MakeLowLevelEngine(settings->deviceType));
+  IMUCalibrator_Ptr imuCalibrator(new ITMIMUCalibrator_iPad);
+  FallibleTracker *dummy;
+  Tracker_Ptr tracker = TrackerFactory::make_tracker_from_string("<tracker type='infinitam'/>", false, rgbImageSize, depthImageSize, lowLevelEngine, imuCalibrator, settings, dummy);
+
+  std::vector<std::string> stageNames, stageTypes;
+  if(args.relocaliserType == "cascade")
+  {
+    stageNames.push_back("Ferns");
+    stageTypes.push_back("ferns");
+    if(args.forestFilename != "")
+    {
+      stageNames.push_back("Forest");
+      stageTypes.push_back("forest");
+    }
+  }
+  else stageTypes.push_back(args.relocaliserType);
+
+  std::vector<Refiner_Ptr> refiners;
+  for(size_t i = 0, size = stageTypes.size(); i < size; ++i)
+  {
+    refiners.push_back(Refiner_Ptr(new Refiner(
+      make_inner_relocaliser(stageTypes[i], args, settings), tracker, rgbImageSize, depthImageSize, testSequence.reader->getCalib(),
+      voxelScene, denseVoxelMapper, settings, VisualiserFactory::make_occupancy_guided_visualisation_engine(settings->deviceType), args.hypothesisCount
+    )));
+  }
+
+  CascadeRelocaliser_Ptr cascade;
+  Relocaliser_Ptr relocaliser = refiners[0];
+  if(!stageNames.empty())
+  {
+    cascade.reset(new CascadeRelocaliser);
+    const bool persistent = true;
+    cascade->add_stage(stageNames[0], refiners[0], persistent);
+    for(size_t i = 1, size = refiners.size(); i < size; ++i) cascade->add_stage(stageNames[i], refiners[i]);
+    relocaliser = cascade;
+  }
+
+  // Fuse each training frame into the scene from its ground-truth pose, and train the relocaliser on it. The profiler is left disabled
+  // whilst training, so that only the timings of the relocalisation stages are recorded (the training itself is not on the critical path).
+  TrackingState_Ptr trackingState(new ITMTrackingState(depthImageSize, memoryType));
+  VoxelRenderState_Ptr renderState(ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(depthImageSize, voxelScene->sceneParams, memoryType));
+  boost::optional<Matrix4f> gtPose;
+  size_t trainFrameCount = 0;
+  while((args.maxTrainFrameCount == 0 || trainFrameCount < args.maxTrainFrameCount) && trainSequence.read_frame(gtPose))
+  {
+    if(!gtPose) throw std::runtime_error("Error: Training frame " + boost::lexical_cast<std::string>(trainSequence.frameIndex - 1) + " has no pose");
+
+    trackingState->pose_d->SetInvM(*gtPose);
+    denseVoxelMapper->ProcessFrame(trainSequence.view.get(), trackingState.get(), voxelScene.get(), renderState.get());
+    relocaliser->train(trainSequence.view->rgb, trainSequence.view->depth, trainSequence.depth_intrinsics(), *trackingState->pose_d);
+    ++trainFrameCount;
+  }
+
+  relocaliser->update();
+  DeviceUtil::synchronise(settings->deviceType);
+  std::cerr << "Trained on " << trainFrameCount << " frames\n";
+
+  // Relocalise each testing frame that has a ground-truth pose, and compare both the pose from the inner relocaliser and the refined pose
+  // with it. We wait for each relocalisation to finish before stopping its timer, so that the latency covers any asynchronous GPU work.
+  Profiler& profiler = Profiler::instance();
+  profiler.set_thread_name("Main");
+  profiler.set_window_size(1000000);
+  profiler.set_max_trace_size(0);
+  profiler.set_enabled(true);
+
+  const std::vector<ErrorThreshold> thresholds = get_error_thresholds();
+  std::vector<AccuracyCounts> accuracyCounts(thresholds.size());
+  for(size_t i = 0, size = accuracyCounts.size(); i < size; ++i)
+  {
+    accuracyCounts[i].innerSuccessCount = accuracyCounts[i].refinedSuccessCount = 0;
+  }
+
+  size_t goodCount = 0, testFrameCount = 0;
+  while((args.maxTestFrameCount == 0 || testFrameCount < args.maxTestFrameCount) && testSequence.read_frame(gtPose))
+  {
+    if(!gtPose) continue;
+
+    // Discard the timings of the warm-up frames (the accuracy of the warm-up frames is still evaluated, since it does not depend on caching).
+    if(testFrameCount == args.warmupFrameCount) profiler.reset();
+
+    boost::optional<ORUtils::SE3Pose> innerPose;
+    boost::optional<Relocaliser::Result> result;
+    {
+      ProfilingScope relocaliseScope("RelocPerf.Relocalise");
+      if(cascade) result = cascade->relocalise(testSequence.view->rgb, testSequence.view->depth, testSequence.depth_intrinsics());
+      else result = refiners[0]->relocalise(testSequence.view->rgb, testSequence.view->depth, testSequence.depth_intrinsics(), innerPose);
+      DeviceUtil::synchronise(settings->deviceType);
+    }
+
+    if(result && result->quality == Relocaliser::RELOCALISATION_GOOD) ++goodCount;
+
+    for(size_t i = 0, size = thresholds.size(); i < size; ++i)
+    {
+      double rotationDegrees, translationMetres;
+      if(innerPose)
+      {
+        compute_pose_errors(innerPose->GetInvM(), *gtPose, rotationDegrees, translationMetres);
+        if(rotationDegrees <= thresholds[i].rotationDegrees && translationMetres <= thresholds[i].translationMetres) ++accuracyCounts[i].innerSuccessCount;
+      }
+
+      if(result)
+      {
+        compute_pose_errors(result->pose.GetInvM(), *gtPose, rotationDegrees, translationMetres);
+        if(rotationDegrees <= thresholds[i].rotationDegrees && translationMetres <= thresholds[i].translationMetres) ++accuracyCounts[i].refinedSuccessCount;
+      }
+    }
+
+    ++testFrameCount;
+  }
+
+  // Write the results.
+  if(args.outputFilename != "")
+  {
+    std::ofstream fs(args.outputFilename.c_str());
+    if(!fs) throw std::runtime_error("Error: Could not open " + args.outputFilename + " for writing");
+    write_results(fs, args, settings, trainFrameCount, testFrameCount, goodCount, thresholds, accuracyCounts, cascade);
+  }
+  else write_results(std::cout, args, settings, trainFrameCount, testFrameCount, goodCount, thresholds, accuracyCounts, cascade);
+
+  return 0;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
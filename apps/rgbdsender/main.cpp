@@ -0,0 +1,97 @@
+/**
+ * rgbdsender: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <InputSource/ImageSourceEngine.h>
+#ifdef WITH_OPENNI
+#include <InputSource/OpenNIEngine.h>
+#endif
+using namespace InputSource;
+
+#include <itmx/remote/RGBDStreamSender.h>
+using namespace itmx;
+
+//#################### CONSTANTS ####################
+
+/** The rate (in frames per second) at which to send the frames of a disk sequence. */
+const int DISK_SEQUENCE_FPS = 30;
+
+//#################### FUNCTIONS ####################
+
+int main(int argc, char *argv[])
+try
+{
+  if(argc != 4 && argc != 6)
+  {
+    std::cerr << "Usage: rgbdsender <host> <port> <calibration file> [<RGB image mask> <depth image mask>]\n";
+    return EXIT_FAILURE;
+  }
+
+  // Read the calibration, so that it can be sent to the receiver in the handshake.
+  const std::string calibFilename = argv[3];
+  std::ifstream calibStream(calibFilename.c_str());
+  if(!calibStream)
+  {
+    std::cerr << "Error: Could not open calibration file " << calibFilename << '\n';
+    return EXIT_FAILURE;
+  }
+  const std::string calibText((std::istreambuf_iterator<char>(calibStream)), std::istreambuf_iterator<char>());
+
+  // Make the image source from which to read the frames (a disk sequence if masks were specified, or a camera otherwise).
+  boost::scoped_ptr<ImageSourceEngine> imageSource;
+  const bool fromDisk = argc == 6;
+  if(fromDisk)
+  {
+    ImageMaskPathGenerator pathGenerator(argv[4], argv[5]);
+    imageSource.reset(new ImageFileReader<ImageMaskPathGenerator>(calibFilename.c_str(), pathGenerator));
+  }
+  else
+  {
+#ifdef WITH_OPENNI
+    imageSource.reset(new OpenNIEngine(calibFilename.c_str()));
+#else
+    std::cerr << "Error: Cannot read from a camera without OpenNI support\n";
+    return EXIT_FAILURE;
+#endif
+  }
+
+  ITMUChar4Image rgbImage(imageSource->getRGBImageSize(), true, false);
+  ITMShortImage depthImage(imageSource->getDepthImageSize(), true, false);
+
+  // Send each frame in turn. A camera paces the frames itself, but a disk sequence must be paced manually, since
+  // otherwise almost all of its frames would be dropped.
+  RGBDStreamSender sender(argv[1], argv[2], calibText, rgbImage.noDims, depthImage.noDims);
+  std::cout << "Connected to " << argv[1] << ':' << argv[2] << '\n';
+
+  const boost::chrono::microseconds framePeriod(1000000 / DISK_SEQUENCE_FPS);
+  boost::chrono::steady_clock::time_point nextFrameTime = boost::chrono::steady_clock::now();
+  size_t frameCount = 0;
+  for(; imageSource->hasMoreImages(); ++frameCount)
+  {
+    imageSource->getImages(&rgbImage, &depthImage);
+    sender.send_frame(&rgbImage, &depthImage);
+
+    if(fromDisk)
+    {
+      nextFrameTime += framePeriod;
+      boost::this_thread::sleep_until(nextFrameTime);
+    }
+  }
+
+  std::cout << "Submitted " << frameCount << " frames (" << sender.get_dropped_frame_count() << " dropped before sending)\n";
+  return EXIT_SUCCESS;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
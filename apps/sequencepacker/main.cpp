@@ -0,0 +1,75 @@
+/**
+ * sequencepacker: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+namespace bf = boost::filesystem;
+
+#include <InputSource/ImageSourceEngine.h>
+using namespace InputSource;
+
+#include <itmx/persistence/PackedSequenceWriter.h>
+#include <itmx/persistence/PosePersister.h>
+using namespace itmx;
+
+//#################### FUNCTIONS ####################
+
+int main(int argc, char *argv[])
+try
+{
+  if(argc != 3)
+  {
+    std::cerr << "Usage: sequencepacker <sequence directory> <output packed sequence file>\n";
+    return EXIT_FAILURE;
+  }
+
+  // Read the calibration for the sequence, so that it can be embedded in the packed sequence.
+  const bf::path dir = argv[1];
+  const bf::path calibPath = dir / "calib.txt";
+  std::ifstream calibStream(calibPath.string().c_str());
+  if(!calibStream)
+  {
+    std::cerr << "Error: Could not open calibration file " << calibPath << '\n';
+    return EXIT_FAILURE;
+  }
+  const std::string calibText((std::istreambuf_iterator<char>(calibStream)), std::istreambuf_iterator<char>());
+
+  // Read each frame of the sequence in turn (together with its pose, if available), and write it to the packed sequence.
+  ImageMaskPathGenerator pathGenerator((dir / "rgbm%06i.ppm").string().c_str(), (dir / "depthm%06i.pgm").string().c_str());
+  ImageFileReader<ImageMaskPathGenerator> reader(calibPath.string().c_str(), pathGenerator);
+  ITMUChar4Image rgbImage(reader.getRGBImageSize(), true, false);
+  ITMShortImage depthImage(reader.getDepthImageSize(), true, false);
+
+  PackedSequenceWriter writer(argv[2], calibText);
+  size_t frameCount = 0, poseCount = 0;
+  for(; reader.hasMoreImages(); ++frameCount)
+  {
+    reader.getImages(&rgbImage, &depthImage);
+
+    boost::optional<Matrix4f> pose;
+    const bf::path posePath = dir / (boost::format("posem%06i.txt") % frameCount).str();
+    if(bf::exists(posePath))
+    {
+      pose = PosePersister::load_pose(posePath.string());
+      ++poseCount;
+    }
+
+    writer.write_frame(&rgbImage, &depthImage, pose);
+  }
+  writer.close();
+
+  std::cout << "Packed " << frameCount << " frames (" << poseCount << " with poses) into: " << argv[2] << '\n';
+  return EXIT_SUCCESS;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
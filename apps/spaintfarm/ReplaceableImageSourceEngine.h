@@ -0,0 +1,91 @@
+/**
+ * spaintfarm: ReplaceableImageSourceEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINTFARM_REPLACEABLEIMAGESOURCEENGINE
+#define H_SPAINTFARM_REPLACEABLEIMAGESOURCEENGINE
+
+#include <boost/shared_ptr.hpp>
+
+#include <InputSource/ImageSourceEngine.h>
+
+#include <spaint/imagesources/FrameTimestampSource.h>
+
+/**
+ * \brief An instance of this class forwards to an image source that can be replaced once it has run out of images.
+ *
+ * This allows a pipeline that was constructed to read from one sequence to be reused to process another (provided
+ * that the two sequences have the same image sizes and calibration, since the pipeline reads these on construction).
+ */
+class ReplaceableImageSourceEngine : public InputSource::ImageSourceEngine, public spaint::FrameTimestampSource
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The image source to which to forward. */
+  boost::shared_ptr<InputSource::ImageSourceEngine> m_subengine;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a replaceable image source engine.
+   *
+   * \param subengine The image source to which to forward initially (the engine takes ownership of it).
+   */
+  explicit ReplaceableImageSourceEngine(InputSource::ImageSourceEngine *subengine)
+  : m_subengine(subengine)
+  {}
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual ITMLib::ITMRGBDCalib getCalib() const
+  {
+    return m_subengine->getCalib();
+  }
+
+  /** Override */
+  virtual Vector2i getDepthImageSize() const
+  {
+    return m_subengine->getDepthImageSize();
+  }
+
+  /** Override */
+  virtual void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+  {
+    m_subengine->getImages(rgb, rawDepth);
+  }
+
+  /** Override */
+  virtual Vector2i getRGBImageSize() const
+  {
+    return m_subengine->getRGBImageSize();
+  }
+
+  /** Override */
+  virtual spaint::FrameTimestamps get_frame_timestamps() const
+  {
+    const spaint::FrameTimestampSource *timestampSource = dynamic_cast<const spaint::FrameTimestampSource*>(m_subengine.get());
+    return timestampSource ? timestampSource->get_frame_timestamps() : spaint::FrameTimestamps();
+  }
+
+  /** Override */
+  virtual bool hasMoreImages() const
+  {
+    return m_subengine->hasMoreImages();
+  }
+
+  /**
+   * \brief Replaces the image source to which to forward.
+   *
+   * \note  This must only be called when the pipeline is not reading from the engine (e.g. once it has run out of images).
+   *
+   * \param subengine The new image source to which to forward (the engine takes ownership of it).
+   */
+  void set_subengine(InputSource::ImageSourceEngine *subengine)
+  {
+    m_subengine.reset(subengine);
+  }
+};
+
+#endif
@@ -0,0 +1,558 @@
+/**
+ * spaintfarm: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+#include <boost/thread.hpp>
+
+#ifdef WITH_CUDA
+#include <ORUtils/CUDADefines.h>
+#endif
+
+#include <InputSource/ImageSourceEngine.h>
+
+#include <itmx/base/DeviceUtil.h>
+#include <itmx/base/MemoryBlockFactory.h>
+#include <itmx/persistence/PackedSequenceUtil.h>
+#include <itmx/persistence/TrajectoryWriter.h>
+
+#include <spaint/imagesources/AsyncImageSourceEngine.h>
+#include <spaint/imagesources/PackedSequenceImageSourceEngine.h>
+
+#include <tvgutil/filesystem/PathFinder.h>
+#include <tvgutil/persistence/JSONUtil.h>
+
+#include "core/SemanticPipeline.h"
+#include "core/SLAMPipeline.h"
+
+#include "ReplaceableImageSourceEngine.h"
+
+using namespace InputSource;
+using namespace ITMLib;
+
+using namespace itmx;
+using namespace spaint;
+using namespace tvgutil;
+
+//#################### NAMESPACE ALIASES ####################
+
+namespace bf = boost::filesystem;
+namespace po = boost::program_options;
+
+//#################### TYPES ####################
+
+struct CommandLineArguments
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  // User-specifiable arguments
+  std::string configFilename;
+  std::vector<int> devices;
+  std::string jobsFilename;
+  bool mapSurfels;
+  std::string mode;
+  bool noRelocaliser;
+  std::string outputDir;
+  std::string pipelineType;
+  std::string trackerConfig;
+  bool trackSurfels;
+
+  // Internal arguments (passed to the worker processes by the coordinator)
+  bool worker;
+  int workerDevice;
+};
+
+/**
+ * \brief An instance of this struct represents a job, i.e. a disk sequence to process with a particular configuration.
+ */
+struct Job
+{
+  /** The file from which to read any additional settings for the job (empty if there are none). */
+  std::string configFilename;
+
+  /** The sequence specifier (a sequence name, directory or packed sequence file). */
+  std::string sequenceSpecifier;
+
+  /** A tag that uniquely identifies the job within the jobs file (used to name its output directory). */
+  std::string tag;
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Adds any unregistered options in a set of parsed options to a settings object.
+ *
+ * \param parsedOptions The set of parsed options.
+ * \param settings      The settings object.
+ */
+void add_unregistered_options_to_settings(const po::parsed_options& parsedOptions, const Settings_Ptr& settings)
+{
+  for(size_t i = 0, optionCount = parsedOptions.options.size(); i < optionCount; ++i)
+  {
+    const po::basic_option<char>& option = parsedOptions.options[i];
+    if(option.unregistered)
+    {
+      // Add all the specified values for the option in the correct order.
+      for(size_t j = 0, valueCount = option.value.size(); j < valueCount; ++j)
+      {
+        settings->add_value(option.string_key, option.value[j]);
+      }
+    }
+  }
+}
+
+/**
+ * \brief Determines whether or not two image sources produce images of the same sizes with the same calibration.
+ *
+ * A pipeline reads the image sizes and calibration of its image source on construction, so it can only be reused
+ * to process a new sequence if these are the same as those of the sequence for which it was constructed.
+ *
+ * \param lhs The first image source.
+ * \param rhs The second image source.
+ * \return    true, if the two image sources produce images of the same sizes with the same calibration, or false otherwise.
+ */
+bool calibrations_match(const ImageSourceEngine& lhs, const ImageSourceEngine& rhs)
+{
+  if(lhs.getDepthImageSize() != rhs.getDepthImageSize() || lhs.getRGBImageSize() != rhs.getRGBImageSize()) return false;
+
+  const ITMRGBDCalib lhsCalib = lhs.getCalib(), rhsCalib = rhs.getCalib();
+  return lhsCalib.intrinsics_d.projectionParamsSimple.all == rhsCalib.intrinsics_d.projectionParamsSimple.all
+      && lhsCalib.intrinsics_rgb.projectionParamsSimple.all == rhsCalib.intrinsics_rgb.projectionParamsSimple.all
+      && lhsCalib.trafo_rgb_to_depth.calib == rhsCalib.trafo_rgb_to_depth.calib
+      && lhsCalib.disparityCalib.GetType() == rhsCalib.disparityCalib.GetType()
+      && lhsCalib.disparityCalib.GetParams() == rhsCalib.disparityCalib.GetParams();
+}
+
+/**
+ * \brief Loads the jobs to run from a jobs file.
+ *
+ * Each non-empty line of the file (other than comments, which start with #) specifies a job, in the form
+ * "<sequence specifier> [<config file>]". Jobs without a config file of their own use the default one (if any).
+ *
+ * \param filename                The name of the jobs file.
+ * \param defaultConfigFilename   The config file to use for jobs that do not specify one (may be empty).
+ * \return                        The jobs.
+ * \throws std::runtime_error     If the jobs file could not be read.
+ */
+std::vector<Job> load_jobs(const std::string& filename, const std::string& defaultConfigFilename)
+{
+  std::ifstream fs(filename.c_str());
+  if(!fs) throw std::runtime_error("Error: Could not open jobs file " + filename);
+
+  std::vector<Job> jobs;
+  std::string line;
+  while(std::getline(fs, line))
+  {
+    std::istringstream ss(line);
+    Job job;
+    if(!(ss >> job.sequenceSpecifier) || job.sequenceSpecifier[0] == '#') continue;
+    if(!(ss >> job.configFilename)) job.configFilename = defaultConfigFilename;
+
+    // Note: The tag includes the index of the job, since the same sequence may be processed with several different configurations.
+    job.tag = (boost::format("%04d-%s") % jobs.size() % bf::path(job.sequenceSpecifier).stem().string()).str();
+    jobs.push_back(job);
+  }
+
+  return jobs;
+}
+
+/**
+ * \brief Makes an image source engine that replays the specified disk sequence.
+ *
+ * \param sequenceSpecifier The sequence specifier (a sequence name, directory or packed sequence file).
+ * \return                  The image source engine.
+ */
+ImageSourceEngine *make_disk_subengine(const std::string& sequenceSpecifier)
+{
+  const bf::path location = bf::exists(sequenceSpecifier)
+    ? bf::path(sequenceSpecifier)
+    : find_subdir_from_executable("sequences") / sequenceSpecifier;
+
+  ImageSourceEngine *diskSubengine = NULL;
+  if(PackedSequenceUtil::is_packed_sequence(location.string()))
+  {
+    // Note: Packed sequences contain their own calibration.
+    diskSubengine = new PackedSequenceImageSourceEngine(location.string(), 0);
+  }
+  else
+  {
+    const std::string calibrationFilename = (location / "calib.txt").string();
+    const std::string depthImageMask = (location / "depthm%06i.pgm").string();
+    const std::string rgbImageMask = (location / "rgbm%06i.ppm").string();
+    ImageMaskPathGenerator pathGenerator(rgbImageMask.c_str(), depthImageMask.c_str());
+    diskSubengine = new ImageFileReader<ImageMaskPathGenerator>(calibrationFilename.c_str(), pathGenerator, 0);
+  }
+
+  // Note: The prefetch buffer is not pinned, since the view builder uploads the images from the host anyway.
+  return new AsyncImageSourceEngine(diskSubengine, 60, false);
+}
+
+/**
+ * \brief Makes the settings with which to construct a pipeline for the specified job.
+ *
+ * \param args  The program's command-line arguments.
+ * \param job   The job.
+ * \return      The settings.
+ */
+Settings_Ptr make_settings(const CommandLineArguments& args, const Job& job)
+{
+  // Note that we do not use the tracker configuration string in the InfiniTAM settings.
+  Settings_Ptr settings(new Settings);
+  settings->trackerConfig = NULL;
+  if(!args.noRelocaliser) settings->behaviourOnFailure = ITMLibSettings::FAILUREMODE_RELOCALISE;
+
+  // Add any settings from the job's config file. As in spaintgui, these are options of the form "Component.name = value".
+  if(job.configFilename != "")
+  {
+    po::options_description noOptions;
+    add_unregistered_options_to_settings(po::parse_config_file<char>(job.configFilename.c_str(), noOptions, true), settings);
+  }
+
+  settings->add_value("experimentTag", job.tag);
+  return settings;
+}
+
+/**
+ * \brief Makes a pipeline of the type specified on the command line.
+ *
+ * \param args                  The program's command-line arguments.
+ * \param settings              The settings for the pipeline.
+ * \param imageSourceEngine     The image source engine from which the pipeline should read its images.
+ * \return                      The pipeline.
+ * \throws std::invalid_argument If the pipeline type is not supported.
+ */
+MultiScenePipeline_Ptr make_pipeline(const CommandLineArguments& args, const Settings_Ptr& settings, const CompositeImageSourceEngine_Ptr& imageSourceEngine)
+{
+  const std::string resourcesDir = find_subdir_from_executable("resources").string();
+  const SLAMComponent::MappingMode mappingMode = args.mapSurfels ? SLAMComponent::MAP_BOTH : SLAMComponent::MAP_VOXELS_ONLY;
+  const SLAMComponent::TrackingMode trackingMode = args.trackSurfels ? SLAMComponent::TRACK_SURFELS : SLAMComponent::TRACK_VOXELS;
+
+  if(args.pipelineType == "slam")
+  {
+    return MultiScenePipeline_Ptr(new SLAMPipeline(settings, resourcesDir, imageSourceEngine, args.trackerConfig, mappingMode, trackingMode));
+  }
+  else if(args.pipelineType == "semantic")
+  {
+    const size_t maxLabelCount = 10;
+    const unsigned int seed = 12345;
+    return MultiScenePipeline_Ptr(new SemanticPipeline(settings, resourcesDir, maxLabelCount, imageSourceEngine, seed, args.trackerConfig, mappingMode, trackingMode));
+  }
+  else throw std::invalid_argument("Error: Unknown pipeline type: " + args.pipelineType);
+}
+
+/**
+ * \brief Makes the command with which the coordinator can launch a worker process for the specified device.
+ *
+ * \param args    The program's command-line arguments.
+ * \param device  The CUDA device on which the worker should run (or -1 for the default device).
+ * \return        The command.
+ */
+std::string make_worker_command(const CommandLineArguments& args, int device)
+{
+  std::ostringstream oss;
+  oss << '"' << find_executable().string() << "\" --worker --workerDevice " << device
+      << " --jobs \"" << args.jobsFilename << "\" --outputDir \"" << args.outputDir << '"'
+      << " --mode " << args.mode << " --pipelineType " << args.pipelineType << " --trackerConfig \"" << args.trackerConfig << '"';
+  if(args.configFilename != "") oss << " --configFile \"" << args.configFilename << '"';
+  if(args.mapSurfels) oss << " --mapSurfels";
+  if(args.noRelocaliser) oss << " --noRelocaliser";
+  if(args.trackSurfels) oss << " --trackSurfels";
+  return oss.str();
+}
+
+/**
+ * \brief Parses a pipeline mode name as specified on the command line.
+ *
+ * \param mode                    The name of the mode.
+ * \return                        The corresponding pipeline mode.
+ * \throws std::invalid_argument  If the name does not correspond to a supported mode.
+ */
+MultiScenePipeline::Mode parse_mode(const std::string& mode)
+{
+  if(mode == "normal") return MultiScenePipeline::MODE_NORMAL;
+  else if(mode == "prediction") return MultiScenePipeline::MODE_PREDICTION;
+  else if(mode == "propagation") return MultiScenePipeline::MODE_PROPAGATION;
+  else if(mode == "smoothing") return MultiScenePipeline::MODE_SMOOTHING;
+  else if(mode == "trainandpredict") return MultiScenePipeline::MODE_TRAIN_AND_PREDICT;
+  else if(mode == "training") return MultiScenePipeline::MODE_TRAINING;
+  else throw std::invalid_argument("Error: Unknown pipeline mode: " + mode);
+}
+
+/**
+ * \brief Parses any command-line arguments passed in by the user.
+ *
+ * \param argc  The command-line argument count.
+ * \param argv  The raw command-line arguments.
+ * \param args  The parsed command-line arguments.
+ * \return      true, if the program should continue after parsing the command-line arguments, or false otherwise.
+ */
+bool parse_command_line(int argc, char *argv[], CommandLineArguments& args)
+{
+  po::options_description options("Options");
+  options.add_options()
+    ("help", "produce help message")
+    ("configFile,f", po::value<std::string>(&args.configFilename)->default_value(""), "settings filename for jobs that do not specify their own")
+    ("devices,g", po::value<std::vector<int> >(&args.devices)->multitoken(), "CUDA devices on which to run workers (defaults to all of them)")
+    ("jobs,j", po::value<std::string>(&args.jobsFilename), "jobs filename (one \"<sequence> [<config file>]\" per line)")
+    ("mapSurfels", po::bool_switch(&args.mapSurfels), "enable surfel mapping")
+    ("mode,m", po::value<std::string>(&args.mode)->default_value("normal"), "pipeline mode (normal|prediction|propagation|smoothing|trainandpredict|training)")
+    ("noRelocaliser", po::bool_switch(&args.noRelocaliser), "don't use the relocaliser")
+    ("outputDir,o", po::value<std::string>(&args.outputDir)->default_value("farm"), "directory in which to write the results of the jobs")
+    ("pipelineType", po::value<std::string>(&args.pipelineType)->default_value("slam"), "pipeline type (slam|semantic)")
+    ("trackerConfig", po::value<std::string>(&args.trackerConfig)->default_value("<tracker type='infinitam'/>"), "tracker configuration")
+    ("trackSurfels", po::bool_switch(&args.trackSurfels), "enable surfel mapping and tracking")
+  ;
+
+  po::options_description internalOptions;
+  internalOptions.add_options()
+    ("worker", po::bool_switch(&args.worker), "")
+    ("workerDevice", po::value<int>(&args.workerDevice)->default_value(-1), "")
+  ;
+
+  po::options_description allOptions;
+  allOptions.add(options).add(internalOptions);
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, allOptions), vm);
+  po::notify(vm);
+
+  if(vm.count("help") || args.jobsFilename == "")
+  {
+    std::cout << "Usage: spaintfarm -j <jobs file> [options]\n\n" << options << '\n';
+    return false;
+  }
+
+  // If the user wants to enable surfel tracking, make sure that surfel mapping is also enabled.
+  if(args.trackSurfels) args.mapSurfels = true;
+
+  return true;
+}
+
+/**
+ * \brief Runs a worker process on the specified command line, and records its exit code.
+ *
+ * \param command   The command line.
+ * \param exitCode  A variable into which to write the exit code.
+ */
+void run_worker_process(const std::string& command, int& exitCode)
+{
+  exitCode = std::system(command.c_str());
+}
+
+/**
+ * \brief Writes the results of a job to a stream as JSON.
+ *
+ * \param os                    The stream.
+ * \param job                   The job.
+ * \param device                The CUDA device on which the job was run (or -1 for the default device).
+ * \param reusedPipeline        Whether or not the job was run on a pipeline that had been reused from an earlier job.
+ * \param setupSeconds          The time taken to construct (or reset) the pipeline for the job (in seconds).
+ * \param elapsedSeconds        The time taken to process the sequence (in seconds).
+ * \param frameCount            The number of frames processed.
+ * \param trackingFailureCount  The number of frames for which tracking failed.
+ */
+void write_results(std::ostream& os, const Job& job, int device, bool reusedPipeline, double setupSeconds, double elapsedSeconds,
+                   size_t frameCount, size_t trackingFailureCount)
+{
+  os << std::fixed << std::setprecision(3);
+  os << "{\n"
+     << "  \"sequence\": \"" << JSONUtil::escape_string(job.sequenceSpecifier) << "\",\n"
+     << "  \"configFile\": \"" << JSONUtil::escape_string(job.configFilename) << "\",\n"
+     << "  \"device\": " << device << ",\n"
+     << "  \"reusedPipeline\": " << (reusedPipeline ? "true" : "false") << ",\n"
+     << "  \"setupSeconds\": " << setupSeconds << ",\n"
+     << "  \"elapsedSeconds\": " << elapsedSeconds << ",\n"
+     << "  \"frames\": " << frameCount << ",\n"
+     << "  \"throughputFps\": " << (elapsedSeconds > 0.0 ? frameCount / elapsedSeconds : 0.0) << ",\n"
+     << "  \"trackingFailures\": " << trackingFailureCount << '\n'
+     << "}\n";
+}
+
+/**
+ * \brief Runs a worker, which repeatedly claims the next unclaimed job and runs it, until there are no jobs left.
+ *
+ * A job is claimed by creating its output directory, which only one worker can succeed in doing, so several workers can
+ * work through the same jobs file without any other coordination (and jobs completed by an earlier run are skipped).
+ * The worker keeps its pipeline (and anything it has loaded, e.g. a relocalisation forest) between jobs, and just resets
+ * the scene, unless a job needs a different configuration, image size or calibration from the one before it.
+ *
+ * \param args    The program's command-line arguments.
+ * \param jobs    The jobs.
+ * \param device  The CUDA device on which to run the jobs (or -1 for the default device).
+ * \return        true, if every job that the worker claimed succeeded, or false otherwise.
+ */
+bool run_worker(const CommandLineArguments& args, const std::vector<Job>& jobs, int device)
+{
+#ifdef WITH_CUDA
+  if(device >= 0) ORcudaSafeCall(cudaSetDevice(device));
+#endif
+
+  const std::string workerName = device >= 0 ? "[spaintfarm:gpu" + boost::lexical_cast<std::string>(device) + "] " : "[spaintfarm] ";
+  const ITMLibSettings::DeviceType deviceType = Settings().deviceType;
+  MemoryBlockFactory::instance().set_device_type(deviceType);
+
+  const std::string sceneID = Model::get_world_scene_id();
+  MultiScenePipeline_Ptr pipeline;
+  std::string pipelineConfigFilename;
+  ReplaceableImageSourceEngine *pipelineSource = NULL; // owned by the pipeline's composite image source engine
+  bool succeeded = true;
+
+  for(size_t i = 0, jobCount = jobs.size(); i < jobCount; ++i)
+  {
+    const Job& job = jobs[i];
+    const bf::path jobDir = bf::path(args.outputDir) / job.tag;
+    if(!bf::create_directory(jobDir)) continue;
+
+    std::cout << workerName << "Running job " << job.tag << '\n';
+
+    try
+    {
+      // Construct the image source for the job's sequence, and then either point the existing pipeline at it and reset the scene,
+      // or (if the existing pipeline cannot be reused) construct a new pipeline. The old pipeline is destroyed first, so that its
+      // device memory is released before any is allocated for the new one.
+      const boost::chrono::steady_clock::time_point setupStart = boost::chrono::steady_clock::now();
+      ImageSourceEngine *subengine = make_disk_subengine(job.sequenceSpecifier);
+      const bool reusedPipeline = pipeline && job.configFilename == pipelineConfigFilename && calibrations_match(*pipelineSource, *subengine);
+      if(reusedPipeline)
+      {
+        pipelineSource->set_subengine(subengine);
+        pipeline->reset_scene(sceneID);
+        pipeline->reset_forest(sceneID);
+      }
+      else
+      {
+        pipeline.reset();
+        pipelineSource = new ReplaceableImageSourceEngine(subengine);
+        CompositeImageSourceEngine_Ptr imageSourceEngine(new CompositeImageSourceEngine);
+        imageSourceEngine->addSubengine(pipelineSource);
+        pipeline = make_pipeline(args, make_settings(args, job), imageSourceEngine);
+        pipeline->set_mode(parse_mode(args.mode));
+        pipelineConfigFilename = job.configFilename;
+      }
+      const double setupSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - setupStart).count();
+
+      // Process the sequence, saving the camera pose (as a camera -> world transformation) and the tracking result for each frame.
+      // The poses are appended to a single trajectory file (timestamped with the frame indices) rather than saved to a file per frame,
+      // so that long evaluation runs don't fill the output directory with vast numbers of tiny files.
+      TrajectoryWriter trajectoryWriter(jobDir / "trajectory.txt");
+      std::ofstream trackingFile((jobDir / "tracking.txt").string().c_str());
+      size_t frameCount = 0, trackingFailureCount = 0;
+      const boost::chrono::steady_clock::time_point processingStart = boost::chrono::steady_clock::now();
+
+      while(pipeline->run_main_section())
+      {
+        const SLAMState_Ptr& slamState = pipeline->get_model()->get_slam_state(sceneID);
+        pipeline->run_mode_specific_section(sceneID, slamState->get_live_voxel_render_state());
+
+        trajectoryWriter.write_pose(static_cast<double>(frameCount), slamState->get_pose().GetInvM());
+
+        const ITMTrackingState::TrackingResult trackingResult = slamState->get_tracking_state()->trackerResult;
+        trackingFile << frameCount << ' ' << trackingResult << '\n';
+        if(trackingResult == ITMTrackingState::TRACKING_FAILED) ++trackingFailureCount;
+
+        ++frameCount;
+      }
+
+      DeviceUtil::synchronise(deviceType);
+      const double elapsedSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - processingStart).count();
+
+      std::ofstream resultsFile((jobDir / "result.json").string().c_str());
+      write_results(resultsFile, job, device, reusedPipeline, setupSeconds, elapsedSeconds, frameCount, trackingFailureCount);
+
+      std::cout << workerName << "Finished job " << job.tag << " (" << frameCount << " frames in " << elapsedSeconds << "s)\n";
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << workerName << "Warning: Job " << job.tag << " failed: " << e.what() << '\n';
+      std::ofstream errorFile((jobDir / "error.txt").string().c_str());
+      errorFile << e.what() << '\n';
+
+      // The pipeline may have been left in an inconsistent state, so we construct a new one for the next job.
+      pipeline.reset();
+      pipelineSource = NULL;
+      succeeded = false;
+    }
+  }
+
+  return succeeded;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  // Parse the command-line arguments.
+  CommandLineArguments args;
+  if(!parse_command_line(argc, argv, args)) return 0;
+
+  const std::vector<Job> jobs = load_jobs(args.jobsFilename, args.configFilename);
+  bf::create_directories(args.outputDir);
+
+  // If this is a worker process, run the jobs it can claim and exit.
+  if(args.worker) return run_worker(args, jobs, args.workerDevice) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+  // Determine the devices on which to run workers. If none were specified, we use every CUDA device (if any).
+  std::vector<int> devices = args.devices;
+#ifdef WITH_CUDA
+  if(devices.empty() && Settings().deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+    int deviceCount = 0;
+    ORcudaSafeCall(cudaGetDeviceCount(&deviceCount));
+    for(int device = 0; device < deviceCount; ++device) devices.push_back(device);
+  }
+#endif
+  if(devices.empty()) devices.push_back(-1);
+
+  std::cout << "[spaintfarm] Running " << jobs.size() << " jobs on " << devices.size() << " worker(s)\n";
+
+  // Run the workers. A single worker is run in this process; otherwise, each worker is run in a separate process, since
+  // much of the pipeline (e.g. the memory block factory) is process-wide and assumes a single device.
+  bool succeeded = true;
+  if(devices.size() == 1)
+  {
+    succeeded = run_worker(args, jobs, devices[0]);
+  }
+  else
+  {
+    std::vector<int> exitCodes(devices.size(), EXIT_FAILURE);
+    boost::thread_group workerThreads;
+    for(size_t i = 0, size = devices.size(); i < size; ++i)
+    {
+      workerThreads.create_thread(boost::bind(&run_worker_process, make_worker_command(args, devices[i]), boost::ref(exitCodes[i])));
+    }
+    workerThreads.join_all();
+
+    for(size_t i = 0, size = exitCodes.size(); i < size; ++i)
+    {
+      if(exitCodes[i] != EXIT_SUCCESS) succeeded = false;
+    }
+  }
+
+  // Summarise the results of the jobs (including any that were completed by an earlier run).
+  size_t completedCount = 0, failedCount = 0;
+  for(size_t i = 0, jobCount = jobs.size(); i < jobCount; ++i)
+  {
+    const bf::path jobDir = bf::path(args.outputDir) / jobs[i].tag;
+    if(bf::exists(jobDir / "result.json")) ++completedCount;
+    else if(bf::exists(jobDir / "error.txt")) ++failedCount;
+  }
+
+  std::cout << "[spaintfarm] " << completedCount << " of " << jobs.size() << " jobs completed, " << failedCount << " failed\n";
+  return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -7,6 +7,7 @@
 using namespace tvginput;
 
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
 
 #include <boost/format.hpp>
@@ -15,22 +16,38 @@ using namespace tvginput;
 #include <boost/assign/list_of.hpp>
 using boost::assign::map_list_of;
 
-#include <ITMLib/Engines/Meshing/ITMMeshingEngineFactory.h>
 #include <ITMLib/Objects/Camera/ITMCalibIO.h>
 using namespace ITMLib;
 
+#ifdef WITH_OPENCV
+#include <opencv2/highgui/highgui.hpp>
+#endif
+
+#include <itmx/base/MemoryBlockFactory.h>
+#include <itmx/persistence/ArchiveRecordingSink.h>
+#include <itmx/persistence/EncoderRecordingSink.h>
+#include <itmx/persistence/FileRecordingSink.h>
 #include <itmx/persistence/ImagePersister.h>
+#include <itmx/persistence/PackedSequenceRecordingSink.h>
 #include <itmx/persistence/PosePersister.h>
+#include <itmx/remote/RemoteViewServer.h>
 using namespace itmx;
 
 #include <rigging/MoveableCamera.h>
 using namespace rigging;
 
+#include <spaint/meshing/LabelledMeshingEngineFactory.h>
 #include <spaint/ogl/WrappedGL.h>
+#include <spaint/pointclouds/SurfacePointExtractorFactory.h>
+#include <spaint/swapping/LabelSnapshotterFactory.h>
+#include <spaint/swapping/VoxelSceneArchiveFactory.h>
 using namespace spaint;
 
 #include <tvgutil/commands/NoOpCommand.h>
 #include <tvgutil/filesystem/PathFinder.h>
+#include <tvgutil/misc/ThreadPool.h>
+#include <tvgutil/timing/KernelMetricsCollector.h>
+#include <tvgutil/timing/ProfilingScope.h>
 #include <tvgutil/timing/TimeUtil.h>
 using namespace tvgutil;
 
@@ -43,29 +60,48 @@ using namespace tvgutil;
 
 //#################### CONSTRUCTORS ####################
 
-Application::Application(const MultiScenePipeline_Ptr& pipeline, bool renderFiducials)
+Application::Application(const MultiScenePipeline_Ptr& pipeline, bool renderFiducials, bool headless)
 : m_activeSubwindowIndex(0),
   m_batchModeEnabled(false),
   m_commandManager(10),
+  m_headless(headless),
+  m_meshExportBlocksPerFrame(0),
   m_pauseBetweenFrames(true),
   m_paused(true),
   m_pipeline(pipeline),
   m_renderFiducials(renderFiducials),
+  m_saveMeshOnExit(false),
+  m_saveSceneOnExit(false),
   m_usePoseMirroring(true),
   m_voiceCommandStream("localhost", "23984")
 {
+  setup_label_snapshots();
   setup_labels();
   setup_meshing();
+  setup_profiling();
+
+  // If we're running headless, there is nothing to render, so avoid creating a window (and an OpenGL context).
+  if(m_headless) return;
 
   const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
   int subwindowConfigurationIndex = settings->get_first_value<int>("subwindowConfigurationIndex");
   switch_to_windowed_renderer(subwindowConfigurationIndex);
+
+  // If requested, stream the sub-windows to any remote viewers that connect, and accept their input.
+  const int remoteViewPort = settings->get_first_value<int>("Application.remoteViewPort", 0);
+  if(remoteViewPort != 0)
+  {
+    const std::string codec = settings->get_first_value<std::string>("Application.remoteViewCodec", "png");
+    m_remoteViewServer.reset(new RemoteViewServer(static_cast<unsigned short>(remoteViewPort), codec == "rgb" ? RemoteViewServer::VC_RGB : RemoteViewServer::VC_PNG));
+  }
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 bool Application::run()
 {
+  if(m_headless) return run_headless();
+
   for(;;)
   {
     // Check to see if the user wants to quit the application, and quit if necessary. Note that if we
@@ -75,6 +111,13 @@ bool Application::run()
     if(m_batchModeEnabled) { if(eventQuit) return false; }
     else                   { if(eventQuit || escQuit) break; }
 
+    // Resolve the timings of any GPU stages from previous frames that have now finished, and plot them if requested.
+    Profiler::instance().update();
+#ifdef WITH_OPENCV
+    update_profiling_plots();
+#endif
+    ProfilingScope frameScope("Application.Frame");
+
     // Take action as relevant based on the current input state.
     process_input();
 
@@ -90,7 +133,11 @@ bool Application::run()
         if(m_frameDebugHook) m_frameDebugHook(m_pipeline->get_model());
 
         // If we're currently recording the sequence, save the frame to disk.
-        if(m_sequencePathGenerator) save_sequence_frame();
+        if(m_sequencePathGenerator)
+        {
+          ProfilingScope ioScope("Application.SaveSequenceFrame");
+          save_sequence_frame();
+        }
       }
       else if(m_batchModeEnabled)
       {
@@ -102,19 +149,50 @@ bool Application::run()
     // Render the scene.
     m_renderer->render(m_fracWindowPos, m_renderFiducials);
 
+    // If any remote viewers are watching, send them the sub-windows that have just been rendered.
+    if(m_remoteViewServer)
+    {
+      ProfilingScope ioScope("Application.PublishRemoteViews");
+      publish_remote_views();
+    }
+
     // If the application is unpaused, run the mode-specific section of the pipeline for the active scene.
     if(!m_paused) m_pipeline->run_mode_specific_section(get_active_scene_id(), get_monocular_render_state());
 
     // If we're currently recording a video, save the next frame of it to disk.
-    if(m_videoPathGenerator) save_video_frame();
+    if(m_videoPathGenerator)
+    {
+      ProfilingScope ioScope("Application.SaveVideoFrame");
+      save_video_frame(m_renderer->capture_video_frame());
+    }
+
+    // If a mesh of the scene is being exported in the background, mesh the next few voxel blocks.
+    if(m_meshExporter && m_meshExporter->is_meshing())
+    {
+      ProfilingScope ioScope("Application.ExportMesh");
+      m_meshExporter->update(m_pipeline->get_model()->get_slam_state(get_main_scene_id())->get_voxel_scene().get(), m_meshExportBlocksPerFrame);
+    }
+
+    // If the labels of the main scene are being snapshotted, start a new snapshot if one is due.
+    if(m_labelSnapshotter)
+    {
+      ProfilingScope ioScope("Application.SnapshotLabels");
+      m_labelSnapshotter->update(m_pipeline->get_model()->get_slam_state(get_main_scene_id())->get_voxel_scene().get());
+    }
 
     // If desired, pause at the end of each frame for debugging purposes.
     if(m_pauseBetweenFrames) m_paused = true;
   }
 
-  // If desired, save a mesh of the scene before the application terminates.
-  if(m_saveMeshOnExit) save_mesh();
+  // If desired, save a mesh and/or an archive of the scene before the application terminates. If a mesh of the
+  // scene is still being exported in the background, we finish exporting it first (saving a mesh does this anyway).
+  if(m_saveMeshOnExit) save_mesh(false);
+  else if(m_meshExporter) m_meshExporter->finish(m_pipeline->get_model()->get_slam_state(get_main_scene_id())->get_voxel_scene().get());
+  if(m_pointCloudExporter) m_pointCloudExporter->finish();
+  if(m_saveSceneOnExit) save_scene();
+  if(m_labelSnapshotter) m_labelSnapshotter->finish(m_pipeline->get_model()->get_slam_state(get_main_scene_id())->get_voxel_scene().get());
 
+  export_profiling_results();
   return true;
 }
 
@@ -134,6 +212,11 @@ void Application::set_save_mesh_on_exit(bool saveMeshOnExit)
   m_saveMeshOnExit = saveMeshOnExit;
 }
 
+void Application::set_save_scene_on_exit(bool saveSceneOnExit)
+{
+  m_saveSceneOnExit = saveSceneOnExit;
+}
+
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
 boost::filesystem::path Application::resources_dir()
@@ -143,6 +226,62 @@ boost::filesystem::path Application::resources_dir()
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+void Application::apply_subwindow_update_policies(const SubwindowConfiguration_Ptr& config) const
+{
+  const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
+
+  for(size_t j = 0, subwindowCount = config->subwindow_count(); j < subwindowCount; ++j)
+  {
+    const std::string prefix = "Subwindow" + boost::lexical_cast<std::string>(j) + ".";
+    const std::string policyName = settings->get_first_value<std::string>(prefix + "updatePolicy", "everyFrame");
+    const int updateInterval = settings->get_first_value<int>(prefix + "updateInterval", 1);
+
+    Subwindow::UpdatePolicy updatePolicy;
+    if(policyName == "everyFrame") updatePolicy = Subwindow::UP_EVERY_FRAME;
+    else if(policyName == "everyNFrames") updatePolicy = Subwindow::UP_EVERY_N_FRAMES;
+    else if(policyName == "onChange") updatePolicy = Subwindow::UP_ON_CHANGE;
+    else throw std::invalid_argument("Error: Unknown update policy '" + policyName + "' for sub-window " + boost::lexical_cast<std::string>(j));
+
+    config->subwindow(j).set_update_policy(updatePolicy, updateInterval);
+  }
+}
+
+void Application::export_profiling_results() const
+{
+  // Resolve the timings of any GPU stages that have not yet been resolved.
+  Profiler& profiler = Profiler::instance();
+  profiler.update();
+
+  if(m_profilingCSVPath != "")
+  {
+    std::cout << "[spaint] Exporting profiling results to " << m_profilingCSVPath << '\n';
+    profiler.export_csv(m_profilingCSVPath);
+  }
+
+  if(m_profilingTracePath != "")
+  {
+    std::cout << "[spaint] Exporting a profiling trace to " << m_profilingTracePath << '\n';
+    profiler.export_chrome_trace(m_profilingTracePath);
+  }
+
+  if(m_profilingKernelMetricsPath != "")
+  {
+    KernelMetricsCollector& collector = KernelMetricsCollector::instance();
+    collector.stop();
+    std::cout << "[spaint] Exporting kernel metrics to " << m_profilingKernelMetricsPath << '\n';
+    collector.export_csv(m_profilingKernelMetricsPath);
+  }
+
+  // Report the memory occupied by the memory blocks that are still alive, grouped by the components that own them.
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  const std::vector<MemoryBlockFactory::MemoryUsage> usages = mbf.get_memory_usage();
+  std::cout << "[spaint] Memory block usage (" << mbf.get_total_memory_usage() << "):\n";
+  for(size_t i = 0, size = usages.size(); i < size; ++i)
+  {
+    std::cout << "  " << usages[i] << '\n';
+  }
+}
+
 const std::string& Application::get_active_scene_id() const
 {
   return get_active_subwindow().get_scene_id();
@@ -158,6 +297,11 @@ const Subwindow& Application::get_active_subwindow() const
   return m_renderer->get_subwindow_configuration()->subwindow(m_activeSubwindowIndex);
 }
 
+std::string Application::get_main_scene_id() const
+{
+  return m_renderer ? m_renderer->get_subwindow_configuration()->subwindow(0).get_scene_id() : Model::get_world_scene_id();
+}
+
 VoxelRenderState_CPtr Application::get_monocular_render_state() const
 {
   const Subwindow& subwindow = get_active_subwindow();
@@ -185,6 +329,8 @@ SubwindowConfiguration_Ptr Application::get_subwindow_configuration(size_t i) co
     m_subwindowConfigurations[i] = SubwindowConfiguration::make_default(
       i, m_pipeline->get_model()->get_slam_state(Model::get_world_scene_id())->get_depth_image_size(), m_pipeline->get_type()
     );
+
+    if(m_subwindowConfigurations[i]) apply_subwindow_update_policies(m_subwindowConfigurations[i]);
   }
 
   return m_subwindowConfigurations[i];
@@ -200,6 +346,14 @@ void Application::handle_key_down(const SDL_Keysym& keysym)
     m_usePoseMirroring = !m_usePoseMirroring;
   }
 
+  // If the T key is pressed on its own, toggle whether or not the profiler's timings are rendered over the top of the scene.
+  // If left shift + T is pressed, save a Chrome trace of the profiler's recent samples.
+  if(keysym.sym == KEYCODE_t)
+  {
+    if(m_inputState.key_down(KEYCODE_LSHIFT)) save_profiling_trace();
+    else m_renderer->set_profiling_overlay_enabled(!m_renderer->get_profiling_overlay_enabled());
+  }
+
   // If the semi-colon key is pressed, toggle whether or not median filtering is used when rendering the scene raycast.
   if(keysym.sym == KEYCODE_SEMICOLON)
   {
@@ -210,8 +364,13 @@ void Application::handle_key_down(const SDL_Keysym& keysym)
   // If right shift + / is pressed, toggle video recording.
   if(keysym.sym == SDLK_SLASH)
   {
-    if(m_inputState.key_down(KEYCODE_LSHIFT)) toggle_recording("sequence", m_sequencePathGenerator);
-    else if(m_inputState.key_down(KEYCODE_RSHIFT)) toggle_recording("video", m_videoPathGenerator);
+    if(m_inputState.key_down(KEYCODE_LSHIFT)) toggle_recording("sequence", m_sequencePathGenerator, m_sequenceSink);
+    else if(m_inputState.key_down(KEYCODE_RSHIFT))
+    {
+      // If we're about to stop recording a video, first save the final frame (which is still being captured).
+      if(m_videoPathGenerator) save_video_frame(m_renderer->finish_video_capture());
+      toggle_recording("video", m_videoPathGenerator, m_videoSink);
+    }
     else save_screenshot();
   }
 
@@ -245,6 +404,15 @@ void Application::handle_key_down(const SDL_Keysym& keysym)
     m_pipeline->toggle_segmentation_output();
   }
 
+  // If the X key is pressed on its own, start exporting a mesh of the scene in the background.
+  // If left shift + X is pressed, export a labelled point cloud of the surface voxels of the scene.
+  if(keysym.sym == KEYCODE_x)
+  {
+    if(m_inputState.key_down(KEYCODE_LSHIFT)) save_point_cloud();
+    else if(m_meshExporter && m_meshExporter->is_meshing()) std::cout << "[spaint] A mesh of the scene is already being exported\n";
+    else save_mesh(true);
+  }
+
   // If left control + R is pressed, reset the active scene.
   if(keysym.sym == KEYCODE_r && m_inputState.key_down(KEYCODE_LCTRL))
   {
@@ -293,6 +461,8 @@ void Application::handle_key_down(const SDL_Keysym& keysym)
               << "F = Toggle Fusion\n"
               << "O = Toggle Segmentation Output\n"
               << "P = Toggle Pose Mirroring\n"
+              << "X = Export Mesh (In Background)\n"
+              << "LShift + X = Export Labelled Point Cloud\n"
               << "Up = Look Down\n"
               << "Down = Look Up\n"
               << "Left = Turn Left\n"
@@ -340,6 +510,8 @@ void Application::handle_key_down(const SDL_Keysym& keysym)
               << "RCtrl + Backspace = Clear Current Label\n"
               << "RCtrl + RShift + Backspace = Reset Classifier (Clear Labels and Forest)\n"
               << "; = Toggle Median Filtering\n"
+              << "T = Toggle Profiling Overlay\n"
+              << "LShift + T = Save Profiling Trace\n"
               << "/ = Save Screenshot\n"
               << "LShift + / = Toggle Sequence Recording\n"
               << "RShift + / = Toggle Video Recording\n";
@@ -392,6 +564,46 @@ void Application::handle_mousebutton_up(const SDL_MouseButtonEvent& e)
   }
 }
 
+RecordingSink_Ptr Application::make_recording_sink(const std::string& type, const boost::filesystem::path& baseDir) const
+{
+  const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
+  const std::string sinkType = settings->get_first_value<std::string>("Application." + type + "Sink", "files");
+  const size_t maxQueueSize = settings->get_first_value<size_t>("Application.recordingQueueSize", 16);
+
+  if(sinkType == "archive")
+  {
+    return RecordingSink_Ptr(new ArchiveRecordingSink(baseDir / (type + ".sptarch"), maxQueueSize));
+  }
+  else if(sinkType == "encoder" && type == "video")
+  {
+    const std::string codec = settings->get_first_value<std::string>("Application.videoCodec", "h264_nvenc");
+    const int frameRate = settings->get_first_value<int>("Application.videoFrameRate", 30);
+    return RecordingSink_Ptr(new EncoderRecordingSink(baseDir / "video.mp4", codec, frameRate, maxQueueSize));
+  }
+  else if(sinkType == "packed" && type == "sequence")
+  {
+    // Embed the calibration of the scene being recorded in the packed sequence.
+    const std::string sceneID = get_main_scene_id();
+    std::ostringstream calib;
+    writeRGBDCalib(calib, m_pipeline->get_model()->get_slam_state(sceneID)->get_view()->calib);
+    return RecordingSink_Ptr(new PackedSequenceRecordingSink(baseDir / "sequence.spseq", calib.str(), maxQueueSize));
+  }
+  else if(sinkType == "files")
+  {
+    // By default, any PNG images are compressed quickly rather than compactly, so that the sink can keep up with the frame rate.
+    const std::string pngCompression = settings->get_first_value<std::string>("Application.pngCompression", "fast");
+    ImagePersister::PNGCompressionLevel pngCompressionLevel;
+    if(pngCompression == "none") pngCompressionLevel = ImagePersister::PCL_NONE;
+    else if(pngCompression == "fast") pngCompressionLevel = ImagePersister::PCL_FAST;
+    else if(pngCompression == "default") pngCompressionLevel = ImagePersister::PCL_DEFAULT;
+    else throw std::runtime_error("Error: Unsupported PNG compression level: " + pngCompression);
+
+    if(type == "sequence") return RecordingSink_Ptr(new FileRecordingSink(baseDir, "rgbm%06i.ppm", "depthm%06i.pgm", maxQueueSize, pngCompressionLevel));
+    else return RecordingSink_Ptr(new FileRecordingSink(baseDir, "%06i.png", "", maxQueueSize, pngCompressionLevel));
+  }
+  else throw std::runtime_error("Error: Unsupported " + type + " sink type: " + sinkType);
+}
+
 void Application::process_camera_input()
 {
   // Allow the user to change the camera mode of the active sub-window.
@@ -526,6 +738,8 @@ void Application::process_fiducial_input()
 
 void Application::process_input()
 {
+  if(m_remoteViewServer) process_remote_input();
+
   process_camera_input();
   process_renderer_input();
 
@@ -687,6 +901,43 @@ void Application::process_renderer_input()
   }
 }
 
+void Application::process_remote_input()
+{
+  SubwindowConfiguration_CPtr config = m_renderer->get_subwindow_configuration();
+  const std::vector<RemoteViewServer::InputEvent> events = m_remoteViewServer->take_input_events();
+  for(size_t i = 0, size = events.size(); i < size; ++i)
+  {
+    // Ignore any events for sub-windows that do not exist (e.g. because the sub-window configuration has just changed).
+    const RemoteViewServer::InputEvent& e = events[i];
+    if(e.viewIndex >= config->subwindow_count()) continue;
+
+    const bool isMouseButton = e.code >= MOUSE_BUTTON_LEFT && e.code < MOUSE_BUTTON_LAST;
+    switch(e.type)
+    {
+      case RemoteViewServer::IET_KEY_DOWN:
+        m_inputState.press_key(static_cast<Keycode>(e.code));
+        break;
+      case RemoteViewServer::IET_KEY_UP:
+        m_inputState.release_key(static_cast<Keycode>(e.code));
+        break;
+      case RemoteViewServer::IET_MOUSE_BUTTON_DOWN:
+        if(!isMouseButton) break;
+        m_activeSubwindowIndex = e.viewIndex;
+        m_inputState.press_mouse_button(static_cast<MouseButton>(e.code), e.fracPos.x, e.fracPos.y);
+        break;
+      case RemoteViewServer::IET_MOUSE_BUTTON_UP:
+        if(isMouseButton) m_inputState.release_mouse_button(static_cast<MouseButton>(e.code));
+        break;
+      case RemoteViewServer::IET_MOUSE_MOVE:
+        m_activeSubwindowIndex = e.viewIndex;
+        m_inputState.set_mouse_position(e.fracPos.x, e.fracPos.y);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
 void Application::process_voice_input()
 {
   // If we are not connected to a voice command server, early out.
@@ -726,32 +977,150 @@ void Application::process_voice_input()
   }
 }
 
-void Application::save_mesh() const
+void Application::publish_remote_views() const
 {
-  if(!m_meshingEngine) return;
+  // If nobody is watching, avoid the cost of capturing the sub-windows.
+  if(m_remoteViewServer->get_viewer_count() == 0) return;
+
+  SubwindowConfiguration_CPtr config = m_renderer->get_subwindow_configuration();
+  for(size_t i = 0, count = config->subwindow_count(); i < count; ++i)
+  {
+    m_remoteViewServer->publish_view(i, m_renderer->capture_subwindow_image(i));
+  }
+}
+
+bool Application::run_headless()
+{
+  const std::string sceneID = get_main_scene_id();
+
+  // Process frames until the image source runs out. There are no sub-windows, so the mode-specific section
+  // of the pipeline is run using the render state from the live camera (as for a sub-window that follows it).
+  while(m_pipeline->run_main_section())
+  {
+    if(m_frameDebugHook) m_frameDebugHook(m_pipeline->get_model());
+    m_pipeline->run_mode_specific_section(sceneID, m_pipeline->get_model()->get_slam_state(sceneID)->get_live_voxel_render_state());
+    if(m_labelSnapshotter) m_labelSnapshotter->update(m_pipeline->get_model()->get_slam_state(sceneID)->get_voxel_scene().get());
+    Profiler::instance().update();
+  }
+
+  if(m_saveMeshOnExit) save_mesh(false);
+  if(m_pointCloudExporter) m_pointCloudExporter->finish();
+  if(m_saveSceneOnExit) save_scene();
+  if(m_labelSnapshotter) m_labelSnapshotter->finish(m_pipeline->get_model()->get_slam_state(sceneID)->get_voxel_scene().get());
+
+  export_profiling_results();
+  return true;
+}
 
+void Application::save_mesh(bool inBackground)
+{
   Model_CPtr model = m_pipeline->get_model();
   const Settings_CPtr& settings = model->get_settings();
 
-  const Subwindow& mainSubwindow = m_renderer->get_subwindow_configuration()->subwindow(0);
-  const std::string& sceneID = mainSubwindow.get_scene_id();
+  const std::string sceneID = get_main_scene_id();
   SpaintVoxelScene_CPtr scene = model->get_slam_state(sceneID)->get_voxel_scene();
 
-  // Construct the mesh.
-  Mesh_Ptr mesh(new ITMMesh(settings->GetMemoryType()));
-  m_meshingEngine->MeshScene(mesh.get(), scene.get());
+  // If we haven't already done so, construct the mesh exporter.
+  if(!m_meshExporter)
+  {
+    LabelledMeshingEngine_Ptr meshingEngine = LabelledMeshingEngineFactory::make_labelled_meshing_engine(settings->deviceType);
+    m_meshExporter.reset(new MeshExporter(meshingEngine, model->get_label_manager()));
+  }
 
   // Find the meshes directory and make sure that it exists.
   boost::filesystem::path meshesSubdir = find_subdir_from_executable("meshes");
   boost::filesystem::create_directories(meshesSubdir);
 
   // Determine the filename to use for the mesh, based on either the experiment tag (if specified) or the current timestamp (otherwise).
-  const std::string meshFilename = settings->get_first_value<std::string>("experimentTag", "spaint-" + TimeUtil::get_iso_timestamp()) + ".stl";
+  const std::string meshFilename = settings->get_first_value<std::string>("experimentTag", "spaint-" + TimeUtil::get_iso_timestamp()) + ".ply";
   const boost::filesystem::path meshPath = meshesSubdir / meshFilename;
 
-  // Save the mesh to disk.
+  // Save the mesh to disk. If we're exporting it in the background, the voxel blocks are meshed a few at a time in the main loop.
   std::cout << "Saving mesh to: " << meshPath << '\n';
-  mesh->WriteSTL(meshPath.string().c_str());
+  m_meshExporter->start(meshPath.string(), scene.get());
+  if(!inBackground) m_meshExporter->finish(scene.get());
+}
+
+void Application::save_point_cloud()
+{
+  Model_CPtr model = m_pipeline->get_model();
+  const Settings_CPtr& settings = model->get_settings();
+  SpaintVoxelScene_CPtr scene = model->get_slam_state(get_main_scene_id())->get_voxel_scene();
+
+  // If we haven't already done so, construct the point cloud exporter.
+  if(!m_pointCloudExporter)
+  {
+    SurfacePointExtractor_CPtr extractor = SurfacePointExtractorFactory::make_surface_point_extractor(settings->deviceType);
+    m_pointCloudExporter.reset(new PointCloudExporter(extractor, model->get_label_manager()));
+  }
+
+  // Find the point clouds directory and make sure that it exists.
+  boost::filesystem::path pointCloudsSubdir = find_subdir_from_executable("pointclouds");
+  boost::filesystem::create_directories(pointCloudsSubdir);
+
+  // Determine the filename to use for the point cloud, based on either the experiment tag (if specified) or the current timestamp (otherwise).
+  const std::string pointCloudFilename = settings->get_first_value<std::string>("experimentTag", "spaint-" + TimeUtil::get_iso_timestamp()) + ".sppc";
+  const boost::filesystem::path pointCloudPath = pointCloudsSubdir / pointCloudFilename;
+
+  // Extract the point cloud, and start writing it to disk in the background.
+  std::cout << "Saving point cloud to: " << pointCloudPath << '\n';
+  m_pointCloudExporter->start(pointCloudPath.string(), scene.get());
+}
+
+void Application::save_scene()
+{
+  const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
+  const std::string sceneID = get_main_scene_id();
+  const SLAMState_Ptr& slamState = m_pipeline->get_model()->get_slam_state(sceneID);
+
+  // Find the scenes directory and make sure that it exists.
+  boost::filesystem::path scenesSubdir = find_subdir_from_executable("scenes");
+  boost::filesystem::create_directories(scenesSubdir);
+
+  // Determine the filename to use for the archive, based on either the experiment tag (if specified) or the current timestamp (otherwise).
+  const std::string sceneFilename = settings->get_first_value<std::string>("experimentTag", "spaint-" + TimeUtil::get_iso_timestamp()) + ".spscene";
+  const boost::filesystem::path scenePath = scenesSubdir / sceneFilename;
+
+  // Save the archive to disk. If the scene is still being loaded lazily from an archive, we use that archive to save it,
+  // so that the parts of the scene that have not yet been loaded are saved as well.
+  VoxelSceneArchive_Ptr sceneArchive = slamState->get_voxel_scene_archive();
+  if(!sceneArchive) sceneArchive = VoxelSceneArchiveFactory::make_voxel_scene_archive(settings->deviceType);
+
+  std::cout << "Saving scene to: " << scenePath << '\n';
+  sceneArchive->save(scenePath.string(), slamState->get_voxel_scene().get());
+
+  // Save the relocaliser alongside the scene (if it supports it), so that a later session that loads the scene can relocalise against it straight away.
+  const std::string relocaliserPath = VoxelSceneArchive::get_relocaliser_path(scenePath.string());
+  try
+  {
+    std::cout << "Saving relocaliser to: " << relocaliserPath << '\n';
+    m_pipeline->get_model()->get_relocaliser(sceneID)->save_to_disk(relocaliserPath);
+  }
+  catch(std::exception& e)
+  {
+    std::cerr << "Warning: Could not save the relocaliser alongside the scene: " << e.what() << '\n';
+  }
+
+  // Saving the scene may have loaded the parts of it that had not yet been loaded from its archive.
+  slamState->notify_voxel_scene_changed();
+}
+
+void Application::save_profiling_trace() const
+{
+  if(!Profiler::instance().is_enabled())
+  {
+    std::cout << "[spaint] Cannot save a profiling trace: the profiler is disabled (set Profiler.enabled or pass --traceFile)\n";
+    return;
+  }
+
+  // Resolve the timings of any GPU stages that have not yet been resolved.
+  Profiler::instance().update();
+
+  boost::filesystem::path p = m_profilingTracePath != "" ? boost::filesystem::path(m_profilingTracePath)
+                                                         : find_subdir_from_executable("profiles") / ("spaint-" + TimeUtil::get_iso_timestamp() + ".json");
+  if(p.has_parent_path()) boost::filesystem::create_directories(p.parent_path());
+  std::cout << "[spaint] Saving profiling trace to " << p << "...\n";
+  Profiler::instance().export_chrome_trace(p.string());
 }
 
 void Application::save_screenshot() const
@@ -764,8 +1133,7 @@ void Application::save_screenshot() const
 
 void Application::save_sequence_frame()
 {
-  const Subwindow& mainSubwindow = m_renderer->get_subwindow_configuration()->subwindow(0);
-  const std::string& sceneID = mainSubwindow.get_scene_id();
+  const std::string sceneID = get_main_scene_id();
 
   // If the RGBD calibration hasn't already been saved, save it now.
   SLAMState_CPtr slamState = m_pipeline->get_model()->get_slam_state(sceneID);
@@ -775,20 +1143,39 @@ void Application::save_sequence_frame()
     writeRGBDCalib(calibrationFile.string().c_str(), slamState->get_view()->calib);
   }
 
-  // Save the current input images.
-  ImagePersister::save_image_on_thread(slamState->get_input_raw_depth_image_copy(), m_sequencePathGenerator->make_path("depthm%06i.pgm"));
-  ImagePersister::save_image_on_thread(slamState->get_input_rgb_image_copy(), m_sequencePathGenerator->make_path("rgbm%06i.ppm"));
+  // Save the current input images (this blocks if the sink has fallen too far behind).
+  // Sinks that can store poses (e.g. packed sequences) embed the inverse pose (i.e. the camera -> world transformation) alongside the images.
+  const Matrix4f invPose = slamState->get_pose().GetInvM();
+  m_sequenceSink->push_frame(slamState->get_input_rgb_image_copy(), slamState->get_input_raw_depth_image_copy(), invPose);
 
-  // Save the inverse pose (i.e. the camera -> world transformation).
-  PosePersister::save_pose_on_thread(slamState->get_pose().GetInvM(), m_sequencePathGenerator->make_path("posem%06i.txt"));
+  // Also save the inverse pose to a separate file, so that the sequence can be used with the Disk tracker.
+  PosePersister::save_pose_on_thread(invPose, m_sequencePathGenerator->make_path("posem%06i.txt"));
 
   m_sequencePathGenerator->increment_index();
 }
 
-void Application::save_video_frame()
+void Application::save_video_frame(const ITMUChar4Image_CPtr& frame)
+{
+  // Frames are captured asynchronously, so there won't be a frame to save when recording has only just started.
+  if(frame) m_videoSink->push_frame(frame);
+}
+
+void Application::setup_label_snapshots()
 {
-  m_videoPathGenerator->increment_index();
-  ImagePersister::save_image_on_thread(m_renderer->capture_screenshot(), m_videoPathGenerator->make_path("%06i.png"));
+  const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
+  const double interval = settings->get_first_value<double>("Application.labelSnapshotInterval", 0.0);
+  if(interval <= 0.0) return;
+
+  // Find the scenes directory and make sure that it exists.
+  boost::filesystem::path scenesSubdir = find_subdir_from_executable("scenes");
+  boost::filesystem::create_directories(scenesSubdir);
+
+  // Determine the filename to use for the label log, based on either the experiment tag (if specified) or the current timestamp (otherwise).
+  const std::string logFilename = settings->get_first_value<std::string>("experimentTag", "spaint-" + TimeUtil::get_iso_timestamp()) + ".splabels";
+  const boost::filesystem::path logPath = scenesSubdir / logFilename;
+
+  std::cout << "Snapshotting labels every " << interval << "s to: " << logPath << '\n';
+  m_labelSnapshotter = LabelSnapshotterFactory::make_label_snapshotter(settings->deviceType, logPath.string(), interval);
 }
 
 void Application::setup_labels()
@@ -832,10 +1219,62 @@ void Application::setup_labels()
 void Application::setup_meshing()
 {
   const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
-  if(settings->createMeshingEngine || m_saveMeshOnExit)
+  m_meshExportBlocksPerFrame = settings->get_first_value<int>("Application.meshExportBlocksPerFrame", 2 * LabelledMeshingEngine::MAX_BATCH_BLOCK_COUNT);
+}
+
+void Application::setup_profiling()
+{
+  const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
+  m_profilingCSVPath = settings->get_first_value<std::string>("Profiler.csvPath", "");
+  m_profilingTracePath = settings->get_first_value<std::string>("Profiler.tracePath", "");
+
+  // Note: The profiler is disabled by default, in which case timing a stage costs no more than checking a flag.
+  Profiler& profiler = Profiler::instance();
+  profiler.set_thread_name("Main");
+  profiler.set_max_trace_size(settings->get_first_value<size_t>("Profiler.maxTraceSize", 100000));
+  profiler.set_window_size(settings->get_first_value<size_t>("Profiler.windowSize", 300));
+
+  // If requested, plot the stage timings and memory usage live (this needs the profiler to be enabled, so it implies it).
+  const bool livePlot = settings->get_first_value<bool>("Profiler.livePlot", false);
+  if(livePlot)
+  {
+#ifdef WITH_OPENCV
+    m_profilingMemoryPlot.reset(new tvgplot::LivePlotWindow("spaint memory usage", "MB"));
+    m_profilingTimingPlot.reset(new tvgplot::LivePlotWindow("spaint stage timings", "ms"));
+#else
+    std::cerr << "Warning: Cannot plot the profiling results live, since spaint was built without OpenCV support\n";
+#endif
+  }
+
+  // If requested, also collect per-kernel metrics under the profiler's stages via CUPTI. By default, these are written
+  // alongside the trace (if any). Like the live plots, this needs the profiler to be enabled, so it implies it.
+  bool kernelMetrics = settings->get_first_value<bool>("Profiler.kernelMetrics", false);
+  if(kernelMetrics)
   {
-    m_meshingEngine.reset(ITMMeshingEngineFactory::MakeMeshingEngine<SpaintVoxel,ITMVoxelBlockHash>(settings->deviceType));
+    const std::string defaultKernelMetricsPath = m_profilingTracePath != "" ? m_profilingTracePath + ".kernels.csv" : "";
+    m_profilingKernelMetricsPath = settings->get_first_value<std::string>("Profiler.kernelMetricsPath", defaultKernelMetricsPath);
+    if(m_profilingKernelMetricsPath == "")
+    {
+      std::cerr << "Warning: Cannot collect kernel metrics, since neither Profiler.kernelMetricsPath nor Profiler.tracePath is set\n";
+      kernelMetrics = false;
+    }
   }
+
+  if(kernelMetrics)
+  {
+    try
+    {
+      KernelMetricsCollector::instance().start(settings->get_first_value<size_t>("Profiler.kernelMetricsSampleInterval", 10));
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << "Warning: Cannot collect kernel metrics: " << e.what() << '\n';
+      m_profilingKernelMetricsPath = "";
+      kernelMetrics = false;
+    }
+  }
+
+  profiler.set_enabled(livePlot || kernelMetrics || settings->get_first_value<bool>("Profiler.enabled", false));
 }
 
 #ifdef WITH_OVR
@@ -861,17 +1300,57 @@ void Application::switch_to_windowed_renderer(size_t subwindowConfigurationIndex
   m_renderer.reset(new WindowedRenderer("Semantic Paint", m_pipeline->get_model(), subwindowConfiguration, windowViewportSize));
 }
 
-void Application::toggle_recording(const std::string& type, boost::optional<tvgutil::SequentialPathGenerator>& pathGenerator)
+void Application::toggle_recording(const std::string& type, boost::optional<tvgutil::SequentialPathGenerator>& pathGenerator, RecordingSink_Ptr& sink)
 {
   if(pathGenerator)
   {
+    // Note that destroying the sink waits for any frames that have not yet been written.
     pathGenerator.reset();
+    sink.reset();
     std::cout << "[spaint] Stopped saving " << type << ".\n";
+    std::cout << "[spaint] Background task statistics: " << ThreadPool::instance().get_stats() << '\n';
   }
   else
   {
-    pathGenerator.reset(SequentialPathGenerator(find_subdir_from_executable(type + "s") / TimeUtil::get_iso_timestamp()));
-    boost::filesystem::create_directories(pathGenerator->get_base_dir());
+    const boost::filesystem::path baseDir = find_subdir_from_executable(type + "s") / TimeUtil::get_iso_timestamp();
+    boost::filesystem::create_directories(baseDir);
+    sink = make_recording_sink(type, baseDir);
+    pathGenerator.reset(SequentialPathGenerator(baseDir));
     std::cout << "[spaint] Started saving " << type << " to " << pathGenerator->get_base_dir() << "...\n";
   }
 }
+
+#ifdef WITH_OPENCV
+void Application::update_profiling_plots()
+{
+  if(!m_profilingTimingPlot) return;
+
+  // Plot the most recent timing of each stage that has been timed since the plots were last updated.
+  const std::vector<Profiler::StageStats> stageStats = Profiler::instance().get_stage_stats();
+  std::vector<std::pair<std::string,double> > timingSamples;
+  for(size_t i = 0, size = stageStats.size(); i < size; ++i)
+  {
+    const Profiler::StageStats& stats = stageStats[i];
+    const std::string name = stats.device == Profiler::DEVICE_GPU ? stats.name + " (GPU)" : stats.name;
+    size_t& plottedCount = m_profilingPlottedStageCounts[name];
+    if(stats.count != plottedCount) timingSamples.push_back(std::make_pair(name, stats.lastMs));
+    plottedCount = stats.count;
+  }
+
+  m_profilingTimingPlot->add_samples(timingSamples);
+  m_profilingTimingPlot->refresh();
+
+  // Plot the total memory occupied by the memory blocks on each device.
+  const MemoryBlockFactory::MemoryUsage usage = MemoryBlockFactory::instance().get_total_memory_usage();
+  const double bytesPerMB = 1024.0 * 1024.0;
+  std::vector<std::pair<std::string,double> > memorySamples;
+  memorySamples.push_back(std::make_pair("CPU", usage.cpuBytes / bytesPerMB));
+  memorySamples.push_back(std::make_pair("GPU", usage.gpuBytes / bytesPerMB));
+
+  m_profilingMemoryPlot->add_samples(memorySamples);
+  m_profilingMemoryPlot->refresh();
+
+  // Give OpenCV a chance to show the updated plots.
+  cv::waitKey(1);
+}
+#endif
@@ -24,10 +24,19 @@
 
 #include <SDL.h>
 
-#include <ITMLib/Engines/Meshing/Interface/ITMMeshingEngine.h>
+#include <itmx/persistence/RecordingSink.h>
+#include <itmx/remote/RemoteViewServer.h>
+
+#include <spaint/meshing/MeshExporter.h>
+#include <spaint/pointclouds/PointCloudExporter.h>
+#include <spaint/swapping/interface/LabelSnapshotter.h>
 
 #include <tvginput/InputState.h>
 
+#ifdef WITH_OPENCV
+#include <tvgplot/LivePlotWindow.h>
+#endif
+
 #include <tvgutil/commands/CommandManager.h>
 #include <tvgutil/filesystem/SequentialPathGenerator.h>
 
@@ -45,9 +54,6 @@ class Application
 {
   //#################### TYPEDEFS ####################
 private:
-  typedef boost::shared_ptr<ITMLib::ITMMesh> Mesh_Ptr;
-  typedef ITMLib::ITMMeshingEngine<spaint::SpaintVoxel,ITMVoxelIndex> MeshingEngine;
-  typedef boost::shared_ptr<MeshingEngine> MeshingEngine_Ptr;
   typedef boost::shared_ptr<Renderer> Renderer_Ptr;
 
 public:
@@ -70,11 +76,20 @@ private:
   /** The debug hook function (if any) to call after processing each frame. */
   FrameDebugHook m_frameDebugHook;
 
+  /** Whether or not the application is running headless (i.e. without a window, a renderer or any user input). */
+  bool m_headless;
+
   /** The current state of the keyboard and mouse. */
   tvginput::InputState m_inputState;
 
-  /** The meshing engine. */
-  MeshingEngine_Ptr m_meshingEngine;
+  /** The label snapshotter (if any) used to periodically save the labels of the main scene, so that they can be recovered after a crash. */
+  spaint::LabelSnapshotter_Ptr m_labelSnapshotter;
+
+  /** The maximum number of voxel blocks to mesh per frame when exporting a mesh of the scene in the background. */
+  int m_meshExportBlocksPerFrame;
+
+  /** The mesh exporter (created when a mesh of the scene is first saved). */
+  spaint::MeshExporter_Ptr m_meshExporter;
 
   /** Whether or not to pause between frames (for debugging purposes). */
   bool m_pauseBetweenFrames;
@@ -85,6 +100,32 @@ private:
   /** The multi-scene pipeline that the application should use. */
   MultiScenePipeline_Ptr m_pipeline;
 
+  /** The point cloud exporter (created when a point cloud of the scene is first saved). */
+  spaint::PointCloudExporter_Ptr m_pointCloudExporter;
+
+  /** The path (if any) to which to export the profiler's samples in CSV format when the application terminates. */
+  std::string m_profilingCSVPath;
+
+  /** The path (if any) to which to export the per-kernel metrics collected via CUPTI when the application terminates. */
+  std::string m_profilingKernelMetricsPath;
+
+#ifdef WITH_OPENCV
+  /** The window (if any) in which to plot the memory occupied by the memory blocks live. */
+  boost::shared_ptr<tvgplot::LivePlotWindow> m_profilingMemoryPlot;
+
+  /** The number of times each stage had been timed when the stage timings were last plotted (used to leave gaps for stages that did not run). */
+  std::map<std::string,size_t> m_profilingPlottedStageCounts;
+
+  /** The window (if any) in which to plot the most recent timings of the profiled stages live. */
+  boost::shared_ptr<tvgplot::LivePlotWindow> m_profilingTimingPlot;
+#endif
+
+  /** The path (if any) to which to export the profiler's samples in Chrome trace format when the application terminates. */
+  std::string m_profilingTracePath;
+
+  /** The server (if any) used to stream the sub-windows to remote viewers, and to receive their input. */
+  itmx::RemoteViewServer_Ptr m_remoteViewServer;
+
   /** The current renderer. */
   Renderer_Ptr m_renderer;
 
@@ -94,9 +135,15 @@ private:
   /** Whether or not to save a mesh of the scene on exiting the application. */
   bool m_saveMeshOnExit;
 
+  /** Whether or not to save an archive of the scene on exiting the application. */
+  bool m_saveSceneOnExit;
+
   /** The path generator for the current sequence recording (if any). */
   boost::optional<tvgutil::SequentialPathGenerator> m_sequencePathGenerator;
 
+  /** The sink to which the images of the current sequence recording (if any) are written. */
+  itmx::RecordingSink_Ptr m_sequenceSink;
+
   /** A set of sub-window configurations that the user can switch between as desired. */
   mutable std::vector<SubwindowConfiguration_Ptr> m_subwindowConfigurations;
 
@@ -106,6 +153,9 @@ private:
   /** The path generator for the current video recording (if any). */
   boost::optional<tvgutil::SequentialPathGenerator> m_videoPathGenerator;
 
+  /** The sink to which the frames of the current video recording (if any) are written. */
+  itmx::RecordingSink_Ptr m_videoSink;
+
   /** The stream of commands being sent from the voice command server. */
   boost::asio::ip::tcp::iostream m_voiceCommandStream;
 
@@ -116,8 +166,10 @@ public:
    *
    * \param pipeline        The multi-scene pipeline that the application should use.
    * \param renderFiducials Whether or not to render the fiducials (if any) that have been detected in the 3D scene.
+   * \param headless        Whether or not to run headless, i.e. to process the frames as fast as possible without creating
+   *                        a window or an OpenGL context (in which case SDL does not need to be initialised).
    */
-  Application(const MultiScenePipeline_Ptr& pipeline, bool renderFiducials = false);
+  Application(const MultiScenePipeline_Ptr& pipeline, bool renderFiducials = false, bool headless = false);
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -149,6 +201,13 @@ public:
    */
   void set_save_mesh_on_exit(bool saveMeshOnExit);
 
+  /**
+   * \brief Sets whether or not to save an archive of the scene on exiting the application.
+   *
+   * \param saveSceneOnExit  Whether or not to save an archive of the scene on exiting the application.
+   */
+  void set_save_scene_on_exit(bool saveSceneOnExit);
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -160,6 +219,22 @@ public:
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Applies any update policies specified in the settings to the sub-windows in the specified sub-window configuration.
+   *
+   * The policy for sub-window j is read from "Subwindow<j>.updatePolicy" (one of "everyFrame", "everyNFrames" or "onChange"),
+   * and the interval used by "everyNFrames" from "Subwindow<j>.updateInterval".
+   *
+   * \param config                 The sub-window configuration.
+   * \throws std::invalid_argument  If an unknown update policy or an invalid update interval is specified.
+   */
+  void apply_subwindow_update_policies(const SubwindowConfiguration_Ptr& config) const;
+
+  /**
+   * \brief Exports the profiler's samples to any paths specified in the settings, and reports the memory occupied by the live memory blocks.
+   */
+  void export_profiling_results() const;
+
   /**
    * \brief Gets the scene ID for the active sub-window.
    *
@@ -181,6 +256,13 @@ private:
    */
   const Subwindow& get_active_subwindow() const;
 
+  /**
+   * \brief Gets the ID of the scene shown in the main sub-window (or of the world scene, if the application is running headless).
+   *
+   * \return  The ID of the scene shown in the main sub-window (or of the world scene, if the application is running headless).
+   */
+  std::string get_main_scene_id() const;
+
   /**
    * \brief Gets the current monocular render state.
    *
@@ -226,6 +308,21 @@ private:
    */
   void handle_mousebutton_up(const SDL_MouseButtonEvent& e);
 
+  /**
+   * \brief Makes a sink to which to write the frames of a sequence or video recording.
+   *
+   * The kind of sink is chosen by the Application.sequenceSink or Application.videoSink setting, which can be
+   * "files" (one image file per image, the default), "archive" (a single lossless archive) or, for sequences only,
+   * "packed" (a single packed sequence file that embeds the calibration and poses and can be replayed directly)
+   * or, for videos only, "encoder" (a single video file encoded by ffmpeg with the codec specified by Application.videoCodec).
+   *
+   * \param type                The type of recording (sequence or video).
+   * \param baseDir             The directory into which to write the recording.
+   * \return                    The sink.
+   * \throws std::runtime_error If the kind of sink specified in the settings is not supported for the type of recording.
+   */
+  itmx::RecordingSink_Ptr make_recording_sink(const std::string& type, const boost::filesystem::path& baseDir) const;
+
   /**
    * \brief Processes user input that deals with the camera.
    */
@@ -268,15 +365,56 @@ private:
    */
   void process_renderer_input();
 
+  /**
+   * \brief Applies any input events that have been received from remote viewers to the input state.
+   *
+   * Each remote viewer interacts with the sub-window in which its events occurred, exactly as if the events had come from the
+   * local mouse and keyboard (all viewers share the same input state, so they take turns rather than interacting at once).
+   */
+  void process_remote_input();
+
   /**
    * \brief Processes voice input from the user.
    */
   void process_voice_input();
 
   /**
-   * \brief Saves a mesh of the scene to disk.
+   * \brief Publishes the latest image of each sub-window to any remote viewers.
+   */
+  void publish_remote_views() const;
+
+  /**
+   * \brief Runs the application headless, processing every frame from the image source without rendering or handling user input.
+   *
+   * \return  true, if the application terminated successfully, or false otherwise.
    */
-  void save_mesh() const;
+  bool run_headless();
+
+  /**
+   * \brief Saves a mesh of the scene to disk (as a binary PLY file with per-vertex colours and semantic labels).
+   *
+   * \param inBackground  Whether to export the mesh in the background, a few voxel blocks per frame, rather than waiting for it to be saved.
+   */
+  void save_mesh(bool inBackground);
+
+  /**
+   * \brief Saves a labelled point cloud of the surface voxels of the scene to disk (as a columnar binary file, see PointCloudExporter).
+   *
+   * The point cloud is extracted immediately, but written to disk in the background.
+   */
+  void save_point_cloud();
+
+  /**
+   * \brief Saves a Chrome trace of the profiler's recent samples to disk.
+   *
+   * The trace is saved to the path specified by Profiler.tracePath, if any, or to a time-stamped file in the profiles directory otherwise.
+   */
+  void save_profiling_trace() const;
+
+  /**
+   * \brief Saves an archive of the scene to disk (from which it can later be reloaded by setting SLAMComponent.sceneArchive).
+   */
+  void save_scene();
 
   /**
    * \brief Saves a screenshot to disk.
@@ -290,8 +428,15 @@ private:
 
   /**
    * \brief Saves the next frame of the video being recorded to disk.
+   *
+   * \param frame The frame to save (if NULL, nothing is saved).
+   */
+  void save_video_frame(const ITMUChar4Image_CPtr& frame);
+
+  /**
+   * \brief Sets up the periodic snapshotting of the main scene's labels (if requested).
    */
-  void save_video_frame();
+  void setup_label_snapshots();
 
   /**
    * \brief Sets up the semantic labels with which the user can label the scene.
@@ -299,10 +444,15 @@ private:
   void setup_labels();
 
   /**
-   * \brief Sets up the meshing engine if required.
+   * \brief Sets up the settings used when exporting meshes of the scene.
    */
   void setup_meshing();
 
+  /**
+   * \brief Sets up the profiler used to time the stages of the application, based on the settings.
+   */
+  void setup_profiling();
+
 #ifdef WITH_OVR
   /**
    * \brief Switches to a Rift renderer.
@@ -324,8 +474,18 @@ private:
    *
    * \param type          The type or recording (sequence or video).
    * \param pathGenerator The path generator associated with that type of recording.
+   * \param sink          The sink associated with that type of recording.
    */
-  void toggle_recording(const std::string& type, boost::optional<tvgutil::SequentialPathGenerator>& pathGenerator);
+  void toggle_recording(const std::string& type, boost::optional<tvgutil::SequentialPathGenerator>& pathGenerator, itmx::RecordingSink_Ptr& sink);
+
+#ifdef WITH_OPENCV
+  /**
+   * \brief Adds the latest stage timings and memory usage to the live profiling plots (if any), and shows them.
+   *
+   * Only the stages that have been timed since the plots were last updated get new samples, so stages that run rarely show up as isolated segments.
+   */
+  void update_profiling_plots();
+#endif
 };
 
 #endif
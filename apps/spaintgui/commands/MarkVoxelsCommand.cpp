@@ -16,8 +16,8 @@ MarkVoxelsCommand::MarkVoxelsCommand(const std::string& sceneID, const boost::sh
 : Command(get_static_description()),
   m_label(label),
   m_model(model),
-  m_oldVoxelLabelsMB(MemoryBlockFactory::instance().make_block<SpaintVoxel::PackedLabel>(voxelLocationsMB->dataSize)),
   m_sceneID(sceneID),
+  m_voxelCount(voxelLocationsMB->dataSize),
   m_voxelLocationsMB(voxelLocationsMB)
 {}
 
@@ -25,12 +25,52 @@ MarkVoxelsCommand::MarkVoxelsCommand(const std::string& sceneID, const boost::sh
 
 void MarkVoxelsCommand::execute() const
 {
-  m_model->mark_voxels(m_sceneID, m_voxelLocationsMB, m_label, NORMAL_MARKING, m_oldVoxelLabelsMB);
+  // Get the locations of the voxels to mark. The first time the command is executed, these are the ones we were
+  // given when the command was constructed; thereafter, they have to be restored from the undo log.
+  boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > voxelLocationsMB = m_voxelLocationsMB ? m_voxelLocationsMB : restore_voxel_locations();
+
+  // Mark the voxels, recording their old labels in a temporary memory block.
+  Model::PackedLabels_Ptr oldVoxelLabelsMB = MemoryBlockFactory::instance().make_block<SpaintVoxel::PackedLabel>(m_voxelCount, "MarkVoxelsCommand");
+  m_model->mark_voxels(m_sceneID, voxelLocationsMB, m_label, NORMAL_MARKING, oldVoxelLabelsMB);
+
+  // Run-length encode the old labels into the undo log.
+  oldVoxelLabelsMB->UpdateHostFromDevice();
+  const SpaintVoxel::PackedLabel *oldVoxelLabels = oldVoxelLabelsMB->GetData(MEMORYDEVICE_CPU);
+  m_oldVoxelLabels.clear();
+  m_oldVoxelLabels.append(oldVoxelLabels, oldVoxelLabels + m_voxelCount);
+  m_oldVoxelLabels.shrink_to_fit();
+
+  // If this is the first time the command has been executed, also encode the voxel locations into the undo log. Note
+  // that this has the useful side-effect of decoupling the command from the selection it was given, which may be
+  // overwritten by the selector on subsequent frames.
+  if(m_voxelLocationsMB)
+  {
+    m_voxelLocationsMB->UpdateHostFromDevice();
+    const Vector3s *voxelLocations = m_voxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+    Vector3s prevLocation(0, 0, 0);
+    for(size_t i = 0; i < m_voxelCount; ++i)
+    {
+      m_voxelLocationDeltas.push_back(voxelLocations[i] - prevLocation);
+      prevLocation = voxelLocations[i];
+    }
+    m_voxelLocationDeltas.shrink_to_fit();
+
+    // Release our reference to the selection so that its memory can be reclaimed.
+    m_voxelLocationsMB.reset();
+  }
 }
 
 void MarkVoxelsCommand::undo() const
 {
-  m_model->mark_voxels(m_sceneID, m_voxelLocationsMB, m_oldVoxelLabelsMB, FORCED_MARKING);
+  boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > voxelLocationsMB = restore_voxel_locations();
+
+  // Decode the old labels from the undo log and make them available on the device.
+  Model::PackedLabels_Ptr oldVoxelLabelsMB = MemoryBlockFactory::instance().make_block<SpaintVoxel::PackedLabel>(m_voxelCount, "MarkVoxelsCommand");
+  m_oldVoxelLabels.decode(oldVoxelLabelsMB->GetData(MEMORYDEVICE_CPU));
+  oldVoxelLabelsMB->UpdateDeviceFromHost();
+
+  // Restore the old labels.
+  m_model->mark_voxels(m_sceneID, voxelLocationsMB, oldVoxelLabelsMB, FORCED_MARKING);
 }
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
@@ -39,3 +79,21 @@ std::string MarkVoxelsCommand::get_static_description()
 {
   return "Mark Voxels";
 }
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > MarkVoxelsCommand::restore_voxel_locations() const
+{
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > voxelLocationsMB = MemoryBlockFactory::instance().make_block<Vector3s>(m_voxelCount, "MarkVoxelsCommand");
+
+  // Decode the deltas and then accumulate them to recover the voxel locations.
+  Vector3s *voxelLocations = voxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+  m_voxelLocationDeltas.decode(voxelLocations);
+  for(size_t i = 1; i < m_voxelCount; ++i)
+  {
+    voxelLocations[i] += voxelLocations[i - 1];
+  }
+
+  voxelLocationsMB->UpdateDeviceFromHost();
+  return voxelLocationsMB;
+}
@@ -7,11 +7,17 @@
 #define H_SPAINTGUI_MARKVOXELSCOMMAND
 
 #include <tvgutil/commands/Command.h>
+#include <tvgutil/containers/RunLengthSequence.h>
 
 #include "../core/Model.h"
 
 /**
  * \brief An instance of this class represents a command that can be used to mark voxels in a scene.
+ *
+ * To keep the undo history small, the command does not hold on to any device memory once it has been executed.
+ * Instead, it keeps a compact undo log on the host: the voxel locations are stored as run-length encoded deltas
+ * (brush selections tend to consist of long runs of adjacent voxels), and the old labels are run-length encoded
+ * (they tend to consist of long runs of the same label). The log is decoded and uploaded again on undo/redo.
  */
 class MarkVoxelsCommand : public tvgutil::Command
 {
@@ -23,14 +29,20 @@ private:
   /** The spaint model. */
   Model_Ptr m_model;
 
-  /** A memory block into which to store the old labels of the voxels being marked. */
-  boost::shared_ptr<ORUtils::MemoryBlock<spaint::SpaintVoxel::PackedLabel> > m_oldVoxelLabelsMB;
+  /** The run-length encoded old labels of the voxels being marked (valid once the command has been executed). */
+  mutable tvgutil::RunLengthSequence<spaint::SpaintVoxel::PackedLabel> m_oldVoxelLabels;
 
   /** The ID of the scene in which to mark voxels. */
   std::string m_sceneID;
 
-  /** The locations of the voxels in the scene to mark. */
-  boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > m_voxelLocationsMB;
+  /** The number of voxels to mark. */
+  size_t m_voxelCount;
+
+  /** The run-length encoded differences between successive voxel locations (valid once the command has been executed). */
+  mutable tvgutil::RunLengthSequence<Vector3s> m_voxelLocationDeltas;
+
+  /** The locations of the voxels in the scene to mark (only held until the command is first executed). */
+  mutable boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > m_voxelLocationsMB;
 
   //#################### CONSTRUCTORS ####################
 public:
@@ -53,6 +65,15 @@ public:
   /** Override */
   virtual void undo() const;
 
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Decodes the voxel locations from the undo log into a new memory block and makes them available on the device.
+   *
+   * \return  A memory block containing the voxel locations.
+   */
+  boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > restore_voxel_locations() const;
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
   /**
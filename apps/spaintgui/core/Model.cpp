@@ -8,13 +8,13 @@ using namespace ORUtils;
 using namespace tvginput;
 
 #include <ITMLib/Engines/Visualisation/ITMSurfelVisualisationEngineFactory.h>
-#include <ITMLib/Engines/Visualisation/ITMVisualisationEngineFactory.h>
 using namespace ITMLib;
 
 #include <spaint/markers/VoxelMarkerFactory.h>
 #include <spaint/selectiontransformers/SelectionTransformerFactory.h>
 #include <spaint/selectors/NullSelector.h>
 #include <spaint/selectors/PickingSelector.h>
+#include <spaint/visualisation/VisualiserFactory.h>
 using namespace spaint;
 
 #ifdef WITH_LEAP
@@ -35,7 +35,7 @@ Model::Model(const Settings_CPtr& settings, const std::string& resourcesDir, siz
   m_settings(settings),
   m_surfelVisualisationEngine(ITMSurfelVisualisationEngineFactory<SpaintSurfel>::make_surfel_visualisation_engine(settings->deviceType)),
   m_voxelMarker(VoxelMarkerFactory::make_voxel_marker(settings->deviceType)),
-  m_voxelVisualisationEngine(ITMVisualisationEngineFactory::MakeVisualisationEngine<SpaintVoxel,ITMVoxelIndex>(settings->deviceType))
+  m_voxelVisualisationEngine(VisualiserFactory::make_occupancy_guided_visualisation_engine(settings->deviceType))
 {
   // Set up the selection transformer.
   const int initialSelectionRadius = 2;
@@ -49,8 +49,7 @@ Model::Model(const Settings_CPtr& settings, const std::string& resourcesDir, siz
 
 void Model::clear_labels(const std::string& sceneID, ClearingSettings settings)
 {
-  ITMLocalVBA<SpaintVoxel>& localVBA = get_slam_state(sceneID)->get_voxel_scene()->localVBA;
-  m_voxelMarker->clear_labels(localVBA.GetVoxelBlocks(), localVBA.allocatedSize, settings);
+  m_voxelMarker->clear_labels(get_slam_state(sceneID)->get_voxel_scene().get(), settings);
 }
 
 const LabelManager_Ptr& Model::get_label_manager()
@@ -156,6 +155,23 @@ void Model::update_selector(const InputState& inputState, const SLAMState_CPtr&
 #endif
   }
 
+  // Allow the user to switch between different selection transformers.
+  if(inputState.key_down(KEYCODE_u))
+  {
+    if(inputState.key_down(KEYCODE_1))
+    {
+      const int initialSelectionRadius = 2;
+      m_selectionTransformer = SelectionTransformerFactory::make_voxel_to_cube(initialSelectionRadius, m_settings->deviceType);
+    }
+    else if(inputState.key_down(KEYCODE_2))
+    {
+      // Note: The surface brush only selects voxels that are close to the surface, so it remains cheap even for large radii.
+      const int initialSelectionRadius = 10;
+      const float maxSDF = 0.5f;
+      m_selectionTransformer = SelectionTransformerFactory::make_voxel_to_surface(initialSelectionRadius, maxSDF, slamState->get_voxel_scene(), m_settings->deviceType);
+    }
+  }
+
   // Update the current selection transformer (if any).
   if(m_selectionTransformer) m_selectionTransformer->update(inputState);
 
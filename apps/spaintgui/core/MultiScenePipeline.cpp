@@ -8,15 +8,145 @@ using namespace InputSource;
 using namespace ITMLib;
 using namespace spaint;
 
+#include <stdexcept>
+
 #include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 #include <tvgutil/containers/MapUtil.h>
+#include <tvgutil/timing/ProfilingScope.h>
 using namespace tvgutil;
 
+//#################### LOCAL TYPES ####################
+
+namespace {
+
+/**
+ * \brief An instance of this struct can be used to signal that the pose of a scene has been finalised for the current frame.
+ */
+struct PoseLatch
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  /** A condition variable used to wait for the pose to be finalised. */
+  boost::condition_variable finalisedCondition;
+
+  /** Whether or not the pose has been finalised. */
+  bool isFinalised;
+
+  /** The mutex used to protect isFinalised. */
+  boost::mutex mutex;
+
+  //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
+
+  PoseLatch()
+  : isFinalised(false)
+  {}
+
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Signals that the pose has been finalised (this may safely be called more than once).
+   */
+  void finalise()
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+      isFinalised = true;
+    }
+    finalisedCondition.notify_all();
+  }
+
+  /**
+   * \brief Waits until the pose has been finalised.
+   */
+  void wait()
+  {
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while(!isFinalised) finalisedCondition.wait(lock);
+  }
+};
+
+typedef boost::shared_ptr<PoseLatch> PoseLatch_Ptr;
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Gets the name under which the profiler should record the mode-specific section of the pipeline when it is run in the specified mode.
+ *
+ * \param mode The mode.
+ * \return     The name under which the profiler should record the mode-specific section of the pipeline.
+ */
+const char *get_mode_stage_name(MultiScenePipeline::Mode mode)
+{
+  switch(mode)
+  {
+    case MultiScenePipeline::MODE_FEATURE_INSPECTION:    return "Pipeline.FeatureInspection";
+    case MultiScenePipeline::MODE_PREDICTION:            return "Pipeline.Prediction";
+    case MultiScenePipeline::MODE_PROPAGATION:           return "Pipeline.Propagation";
+    case MultiScenePipeline::MODE_SEGMENTATION:          return "Pipeline.Segmentation";
+    case MultiScenePipeline::MODE_SEGMENTATION_TRAINING: return "Pipeline.SegmentationTraining";
+    case MultiScenePipeline::MODE_SMOOTHING:             return "Pipeline.Smoothing";
+    case MultiScenePipeline::MODE_TRAIN_AND_PREDICT:     return "Pipeline.TrainAndPredict";
+    case MultiScenePipeline::MODE_TRAINING:              return "Pipeline.Training";
+    default:                                             return "Pipeline.Normal";
+  }
+}
+
+/**
+ * \brief Processes the next frame (if any) for the specified scene.
+ *
+ * \param slamComponent The SLAM component for the scene.
+ * \param latch         The latch to release once the scene's pose will no longer change.
+ * \param result        A location into which to write whether or not a frame was processed.
+ * \param error         A location into which to write the message of any exception that was thrown.
+ */
+void process_scene(const SLAMComponent_Ptr& slamComponent, const PoseLatch_Ptr& latch, char& result, std::string& error)
+{
+  try
+  {
+    result = slamComponent->process_frame();
+  }
+  catch(std::exception& e)
+  {
+    error = e.what();
+  }
+
+  // Make sure that any scenes that mirror this one are released even if no frame was processed.
+  latch->finalise();
+}
+
+/**
+ * \brief Returns a copy of the specified pose.
+ *
+ * \param pose  The pose.
+ * \return      A copy of the pose.
+ */
+ORUtils::SE3Pose return_pose_copy(const ORUtils::SE3Pose& pose)
+{
+  return pose;
+}
+
+/**
+ * \brief Waits until the pose of the specified scene has been finalised for the current frame, and then returns it.
+ *
+ * \param latch     The latch that will be released once the scene's pose has been finalised.
+ * \param slamState The SLAM state of the scene.
+ * \return          The scene's pose.
+ */
+ORUtils::SE3Pose wait_for_pose(const PoseLatch_Ptr& latch, const SLAMState_CPtr& slamState)
+{
+  latch->wait();
+  return slamState->get_pose();
+}
+
+}
+
 //#################### CONSTRUCTORS ####################
 
 MultiScenePipeline::MultiScenePipeline(const std::string& type, const Settings_Ptr& settings, const std::string& resourcesDir, size_t maxLabelCount)
-: m_mode(MODE_NORMAL), m_type(type)
+: m_mode(MODE_NORMAL), m_type(type),
+  m_processScenesInParallel(settings->get_first_value<bool>("MultiScenePipeline.processScenesInParallel", false))
 {
   // Make sure that we're not trying to run on the GPU if CUDA support isn't enabled.
 #ifndef WITH_CUDA
@@ -74,6 +204,9 @@ void MultiScenePipeline::reset_scene(const std::string& sceneID)
 
 bool MultiScenePipeline::run_main_section()
 {
+  // Note: The scenes that share a voxel scene allocate voxel blocks in it as they are processed, so we process them sequentially.
+  if(m_processScenesInParallel && m_slamComponents.size() > 1 && m_sharedVoxelScenes.empty()) return run_main_section_in_parallel();
+
   bool result = true;
   for(std::map<std::string,SLAMComponent_Ptr>::const_iterator it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it)
   {
@@ -82,11 +215,17 @@ bool MultiScenePipeline::run_main_section()
       if(it->first == Model::get_world_scene_id()) result = false;
     }
   }
+
+  flush_shared_voxel_scenes();
   return result;
 }
 
 void MultiScenePipeline::run_mode_specific_section(const std::string& sceneID, const VoxelRenderState_CPtr& renderState)
 {
+  // Time the mode-specific section on both the CPU and (if relevant) the GPU, recording the result under the name of the current mode.
+  const bool timeGPU = m_model->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA;
+  ProfilingScope profilingScope(get_mode_stage_name(m_mode), timeGPU);
+
   switch(m_mode)
   {
     case MODE_FEATURE_INSPECTION:
@@ -108,15 +247,10 @@ void MultiScenePipeline::run_mode_specific_section(const std::string& sceneID, c
       MapUtil::call_if_found(m_smoothingComponents, sceneID, boost::bind(&SmoothingComponent::run, _1, renderState));
       break;
     case MODE_TRAIN_AND_PREDICT:
-    {
-      static bool trainThisFrame = false;
-      trainThisFrame = !trainThisFrame;
-
-      if(trainThisFrame) MapUtil::call_if_found(m_semanticSegmentationComponents, sceneID, boost::bind(&SemanticSegmentationComponent::run_training, _1, renderState));
-      else MapUtil::call_if_found(m_semanticSegmentationComponents, sceneID, boost::bind(&SemanticSegmentationComponent::run_prediction, _1, renderState));
-
+      // Note: The forest is trained on a background thread, so we can afford to both train and predict every frame.
+      MapUtil::call_if_found(m_semanticSegmentationComponents, sceneID, boost::bind(&SemanticSegmentationComponent::run_training, _1, renderState));
+      MapUtil::call_if_found(m_semanticSegmentationComponents, sceneID, boost::bind(&SemanticSegmentationComponent::run_prediction, _1, renderState));
       break;
-    }
     case MODE_TRAINING:
       MapUtil::call_if_found(m_semanticSegmentationComponents, sceneID, boost::bind(&SemanticSegmentationComponent::run_training, _1, renderState));
       break;
@@ -135,7 +269,127 @@ void MultiScenePipeline::set_fusion_enabled(const std::string& sceneID, bool fus
   MapUtil::lookup(m_slamComponents, sceneID)->set_fusion_enabled(fusionEnabled);
 }
 
+void MultiScenePipeline::share_voxel_scene(const std::vector<std::string>& sceneIDs)
+{
+  if(sceneIDs.size() < 2) throw std::invalid_argument("Error: At least two scenes are needed to share a voxel scene");
+
+  // Make a fuser for the voxel scene of the first scene. Each scene can add one frame to it per pipeline frame.
+  const SLAMState_Ptr& firstSLAMState = m_model->get_slam_state(sceneIDs[0]);
+  SharedVoxelFuser_Ptr fuser(new SharedVoxelFuser(
+    firstSLAMState->get_voxel_scene(),
+    static_cast<int>(sceneIDs.size()),
+    firstSLAMState->get_input_raw_depth_image()->noDims,
+    firstSLAMState->get_input_rgb_image()->noDims,
+    m_model->get_settings()->deviceType
+  ));
+
+  // Make each of the scenes fuse its frames into the shared voxel scene via the fuser.
+  for(size_t i = 0, size = sceneIDs.size(); i < size; ++i)
+  {
+    MapUtil::lookup(m_slamComponents, sceneIDs[i])->set_shared_voxel_fuser(fuser);
+  }
+
+  m_sharedVoxelScenes.push_back(std::make_pair(fuser, sceneIDs));
+}
+
 void MultiScenePipeline::toggle_segmentation_output()
 {
   MapUtil::call_if_found(m_objectSegmentationComponents, Model::get_world_scene_id(), boost::bind(&ObjectSegmentationComponent::toggle_output, _1));
 }
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MultiScenePipeline::flush_shared_voxel_scenes()
+{
+  const bool timeGPU = m_model->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA;
+  for(size_t i = 0, size = m_sharedVoxelScenes.size(); i < size; ++i)
+  {
+    const SharedVoxelScene& sharedVoxelScene = m_sharedVoxelScenes[i];
+
+    int frameCount;
+    {
+      ProfilingScope profilingScope("Pipeline.FuseSharedScene", timeGPU);
+      frameCount = sharedVoxelScene.first->flush();
+    }
+
+    // If any frames were fused, let each of the scenes that share the voxel scene know that its geometry has changed.
+    if(frameCount == 0) continue;
+
+    const std::vector<std::string>& sceneIDs = sharedVoxelScene.second;
+    for(size_t j = 0, sceneCount = sceneIDs.size(); j < sceneCount; ++j)
+    {
+      m_model->get_slam_state(sceneIDs[j])->notify_voxel_scene_changed();
+    }
+  }
+}
+
+bool MultiScenePipeline::run_main_section_in_parallel()
+{
+  typedef std::map<std::string,SLAMComponent_Ptr>::const_iterator Iter;
+
+  // Make a latch for each scene, which the scene's SLAM component will release as soon as its pose has been finalised.
+  std::map<std::string,PoseLatch_Ptr> latches;
+  for(Iter it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it)
+  {
+    PoseLatch_Ptr latch(new PoseLatch);
+    latches[it->first] = latch;
+    it->second->set_pose_finalised_hook(boost::bind(&PoseLatch::finalise, latch));
+  }
+
+  // For each scene that mirrors the pose of another, arrange for it to get the pose it would have got sequentially:
+  // if its source scene is processed before it, it must wait for the source's pose for the current frame; if not,
+  // it must use the source's pose from the previous frame, which we copy now, before any of the scenes are processed.
+  for(Iter it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it)
+  {
+    const std::string& mirrorSceneID = it->second->get_mirror_scene_id();
+    if(mirrorSceneID == "") continue;
+
+    SLAMState_CPtr mirrorSLAMState = m_model->get_slam_state(mirrorSceneID);
+    std::map<std::string,PoseLatch_Ptr>::const_iterator jt = latches.find(mirrorSceneID);
+    if(jt != latches.end() && jt->first < it->first)
+    {
+      it->second->set_mirror_pose_provider(boost::bind(&wait_for_pose, jt->second, mirrorSLAMState));
+    }
+    else
+    {
+      it->second->set_mirror_pose_provider(boost::bind(&return_pose_copy, mirrorSLAMState->get_pose()));
+    }
+  }
+
+  // Process the scenes concurrently: the first on the current thread, and each of the others on a thread of its own.
+  // Note that a scene can only ever wait for a scene that precedes it in the map, so this cannot deadlock.
+  const size_t sceneCount = m_slamComponents.size();
+  std::vector<char> results(sceneCount, false);
+  std::vector<std::string> errors(sceneCount);
+  boost::thread_group threads;
+
+  size_t i = 0;
+  for(Iter it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it, ++i)
+  {
+    if(i == 0) continue;
+    threads.create_thread(boost::bind(&process_scene, it->second, latches[it->first], boost::ref(results[i]), boost::ref(errors[i])));
+  }
+
+  process_scene(m_slamComponents.begin()->second, latches[m_slamComponents.begin()->first], results[0], errors[0]);
+
+  // Wait for all of the scenes to finish before returning, since the caller will render them next.
+  threads.join_all();
+
+  // Remove the hooks, so that they do not refer to the latches after they have been destroyed.
+  for(Iter it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it)
+  {
+    it->second->set_mirror_pose_provider(boost::function<ORUtils::SE3Pose()>());
+    it->second->set_pose_finalised_hook(boost::function<void()>());
+  }
+
+  // Rethrow the first error (if any) on this thread, and check whether a new frame was available for the world scene.
+  bool result = true;
+  i = 0;
+  for(Iter it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it, ++i)
+  {
+    if(errors[i] != "") throw std::runtime_error(errors[i]);
+    if(!results[i] && it->first == Model::get_world_scene_id()) result = false;
+  }
+
+  return result;
+}
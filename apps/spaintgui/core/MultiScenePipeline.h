@@ -19,6 +19,10 @@
  */
 class MultiScenePipeline
 {
+  //#################### TYPEDEFS ####################
+private:
+  typedef std::pair<spaint::SharedVoxelFuser_Ptr,std::vector<std::string> > SharedVoxelScene;
+
   //#################### ENUMERATIONS ####################
 public:
   /**
@@ -47,7 +51,7 @@ public:
     /** In smoothing mode, voxel labels are filled in based on the labels of neighbouring voxels. */
     MODE_SMOOTHING,
 
-    /** In train-and-predict mode, we alternate training and prediction to achieve a pleasing interactive effect. */
+    /** In train-and-predict mode, we train and predict every frame (the forest is trained on a background thread) to achieve a pleasing interactive effect. */
     MODE_TRAIN_AND_PREDICT,
 
     /** In training mode, a random forest is trained using voxels sampled from the current raycast. */
@@ -80,6 +84,14 @@ protected:
   /** The pipeline type. */
   std::string m_type;
 
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** Whether or not to process the frames for the individual scenes concurrently, each on its own thread. */
+  bool m_processScenesInParallel;
+
+  /** The voxel scenes (if any) that are shared between several scenes, together with the fusers used for them and the IDs of the scenes that share them. */
+  std::vector<SharedVoxelScene> m_sharedVoxelScenes;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -163,7 +175,9 @@ public:
   /**
    * \brief Runs the main section of the multi-scene pipeline.
    *
-   * This involves processing the next frame (if any) for each individual scene.
+   * This involves processing the next frame (if any) for each individual scene. If parallel scene processing is enabled,
+   * the scenes are processed concurrently, and this only returns once all of them have finished (so that rendering is safe).
+   * Once all of the scenes have been processed, the frames for any voxel scenes that are shared are fused into them.
    *
    * \return  true, if a new frame was available for the world scene, or false otherwise.
    */
@@ -196,10 +210,39 @@ public:
    */
   void set_fusion_enabled(const std::string& sceneID, bool fusionEnabled);
 
+  /**
+   * \brief Makes the specified scenes share a single voxel scene, into which each of their frames is fused.
+   *
+   * The voxel scene of the first of the specified scenes is shared, and the others' voxel scenes are discarded. The frames of all
+   * of the scenes are fused together, in a single batched pass, once all of the scenes have been processed. Note that the scenes
+   * that share a voxel scene are always processed sequentially, even if parallel scene processing is enabled.
+   *
+   * \param sceneIDs                The IDs of the scenes that are to share a voxel scene.
+   * \throws std::invalid_argument  If fewer than two scenes are specified.
+   */
+  void share_voxel_scene(const std::vector<std::string>& sceneIDs);
+
   /**
    * \brief Toggles whether or not the world scene's object segmentation component (if any) should write to its output pipe.
    */
   void toggle_segmentation_output();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Fuses the frames that have been processed for the scenes that share voxel scenes into the shared voxel scenes.
+   */
+  void flush_shared_voxel_scenes();
+
+  /**
+   * \brief Processes the next frame (if any) for each individual scene concurrently, each on its own thread.
+   *
+   * Any scene whose pose is mirrored from another scene obtains the pose that it would have obtained had
+   * the scenes been processed sequentially, so the results are identical to those of run_main_section.
+   *
+   * \return  true, if a new frame was available for the world scene, or false otherwise.
+   */
+  bool run_main_section_in_parallel();
 };
 
 //#################### TYPEDEFS ####################
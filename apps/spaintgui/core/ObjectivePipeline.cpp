@@ -58,10 +58,11 @@ void ObjectivePipeline::set_mode(Mode mode)
 #endif
   }
 
-  // If we are switching out of segmentation mode, stop recording the segmentation video
-  // and clear the input mask and segmentation image.
+  // If we are switching out of segmentation mode, discard the results of any frame that is still being segmented asynchronously,
+  // stop recording the segmentation video and clear the input mask and segmentation image.
   if(m_mode == MODE_SEGMENTATION && mode != MODE_SEGMENTATION)
   {
+    MapUtil::call_if_found(m_objectSegmentationComponents, Model::get_world_scene_id(), boost::bind(&ObjectSegmentationComponent::cancel_segmentation, _1));
     segmentationPathGenerator.reset();
     m_model->get_slam_state(Model::get_world_scene_id())->set_input_mask(ITMUCharImage_Ptr());
     m_model->set_segmentation_image(Model::get_world_scene_id(), ITMUChar4Image_CPtr());
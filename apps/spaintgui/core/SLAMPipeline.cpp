@@ -6,6 +6,10 @@
 #include "SLAMPipeline.h"
 using namespace spaint;
 
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
 //#################### CONSTRUCTORS ####################
 
 SLAMPipeline::SLAMPipeline(const Settings_Ptr& settings, const std::string& resourcesDir,
@@ -21,6 +25,30 @@ SLAMPipeline::SLAMPipeline(const Settings_Ptr& settings, const std::string& reso
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+void SLAMPipeline::fuse_sensors(const std::vector<CompositeImageSourceEngine_Ptr>& imageSourceEngines, const std::vector<std::string>& trackerConfigs,
+                                SLAMComponent::MappingMode mappingMode, SLAMComponent::TrackingMode trackingMode)
+{
+  if(imageSourceEngines.size() != trackerConfigs.size())
+  {
+    throw std::invalid_argument("Error: Each additional sensor needs both an image source engine and a tracker configuration");
+  }
+
+  if(imageSourceEngines.empty()) return;
+
+  // Add a scene for each additional sensor.
+  const std::string worldSceneID = Model::get_world_scene_id();
+  std::vector<std::string> sceneIDs(1, worldSceneID);
+  for(size_t i = 0, size = imageSourceEngines.size(); i < size; ++i)
+  {
+    const std::string sceneID = worldSceneID + "Sensor" + boost::lexical_cast<std::string>(i + 1);
+    m_slamComponents[sceneID].reset(new SLAMComponent(m_model, sceneID, imageSourceEngines[i], trackerConfigs[i], mappingMode, trackingMode));
+    sceneIDs.push_back(sceneID);
+  }
+
+  // Make all of the scenes share the world scene's voxel scene.
+  share_voxel_scene(sceneIDs);
+}
+
 void SLAMPipeline::set_mode(Mode mode)
 {
   // The only supported mode.
@@ -26,6 +26,22 @@ public:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Adds scenes for some additional sensors, and fuses their frames into the world scene alongside those of the main image source.
+   *
+   * The scene for the i'th additional sensor has the ID "WorldSensor<i>" (counting from 1). Each sensor is tracked independently,
+   * against the shared scene, so the trackers must produce poses in a common coordinate system (e.g. by reading them from disk).
+   *
+   * \param imageSourceEngines      The engines used to provide the images from the additional sensors.
+   * \param trackerConfigs          The tracker configurations to use for the additional sensors.
+   * \param mappingMode             The mapping mode to use for the additional sensors.
+   * \param trackingMode            The tracking mode to use for the additional sensors.
+   * \throws std::invalid_argument  If the numbers of image source engines and tracker configurations differ.
+   */
+  void fuse_sensors(const std::vector<CompositeImageSourceEngine_Ptr>& imageSourceEngines, const std::vector<std::string>& trackerConfigs,
+                    spaint::SLAMComponent::MappingMode mappingMode = spaint::SLAMComponent::MAP_VOXELS_ONLY,
+                    spaint::SLAMComponent::TrackingMode trackingMode = spaint::SLAMComponent::TRACK_VOXELS);
+
   /** Override */
   virtual void set_mode(Mode mode);
 };
@@ -6,9 +6,7 @@
 #include "SemanticPipeline.h"
 using namespace spaint;
 
-#ifdef WITH_OPENCV
-#include <spaint/ocv/OpenCVUtil.h>
-#endif
+#include <boost/bind.hpp>
 
 //#################### CONSTRUCTORS ####################
 
@@ -23,19 +21,23 @@ SemanticPipeline::SemanticPipeline(const Settings_Ptr& settings, const std::stri
   m_propagationComponents[sceneID].reset(new PropagationComponent(m_model, sceneID));
   m_semanticSegmentationComponents[sceneID].reset(new SemanticSegmentationComponent(m_model, sceneID, seed));
   m_smoothingComponents[sceneID].reset(new SmoothingComponent(m_model, sceneID));
+
+  // Let the semantic segmentation component know whenever fusion updates the scene (so that it can invalidate any cached features).
+  m_slamComponents[sceneID]->set_fusion_hook(boost::bind(&SemanticSegmentationComponent::handle_fusion, m_semanticSegmentationComponents[sceneID].get()));
+
+  // Likewise, let it know whenever the scene is defragmented (since that moves the voxel blocks whose features it may have cached).
+  m_slamComponents[sceneID]->set_defragmentation_hook(boost::bind(&SemanticSegmentationComponent::handle_defragmentation, m_semanticSegmentationComponents[sceneID].get()));
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void SemanticPipeline::set_mode(Mode mode)
 {
-#ifdef WITH_OPENCV
-  // If we are switching out of feature inspection mode, destroy the feature inspection window.
+  // If we are switching out of feature inspection mode, clear the feature inspection image.
   if(m_mode == MODE_FEATURE_INSPECTION && mode != MODE_FEATURE_INSPECTION)
   {
-    cv::destroyAllWindows();
+    m_model->set_feature_inspection_image(Model::get_world_scene_id(), ITMUChar4Image_CPtr());
   }
-#endif
 
   switch(mode)
   {
@@ -7,9 +7,14 @@
 #include <iostream>
 #include <string>
 
+#include <boost/bind.hpp>
 #include <boost/program_options.hpp>
 #include <boost/tokenizer.hpp>
 
+#ifdef WITH_OPENMP
+  #include <omp.h>
+#endif
+
 // Note: This must appear before anything that could include SDL.h, since it includes boost/asio.hpp, a header that has a WinSock conflict with SDL.h.
 #include "Application.h"
 
@@ -17,6 +22,10 @@
   #include <arrayfire.h>
 #endif
 
+#ifdef WITH_CUDA
+  #include <ORUtils/CUDADefines.h>
+#endif
+
 #include <InputSource/OpenNIEngine.h>
 #ifdef WITH_REALSENSE
 #include <InputSource/RealSenseEngine.h>
@@ -35,10 +44,20 @@
 #endif
 
 #include <itmx/base/MemoryBlockFactory.h>
+#include <itmx/persistence/PackedSequenceUtil.h>
 
 #include <spaint/imagesources/AsyncImageSourceEngine.h>
+#include <spaint/imagesources/ImageFileSequenceSource.h>
+#include <spaint/imagesources/PackedSequenceImageSourceEngine.h>
+#include <spaint/imagesources/ParallelImageSourceEngine.h>
+#include <spaint/imagesources/RGBDStreamImageSourceEngine.h>
+#include <spaint/imagesources/SwappingCompositeImageSourceEngine.h>
 
 #include <tvgutil/filesystem/PathFinder.h>
+#include <tvgutil/misc/AffinityUtil.h>
+#include <tvgutil/misc/TaskGroup.h>
+#include <tvgutil/misc/TaskScheduler.h>
+#include <tvgutil/misc/ThreadPool.h>
 
 #include "core/ObjectivePipeline.h"
 #include "core/SemanticPipeline.h"
@@ -63,30 +82,49 @@ struct CommandLineArguments
   //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
 
   // User-specifiable arguments
+  std::string affinityGrabber;
+  std::string affinityMain;
+  std::string affinityOpenMP;
+  std::string affinityPool;
   bool batch;
   std::string calibrationFilename;
   bool cameraAfterDisk;
+  size_t decoderThreadCount;
   std::vector<std::string> depthImageMasks;
   bool detectFiducials;
+  bool deterministic;
   std::string experimentTag;
+  bool fuseSequences;
+  bool headless;
   int initialFrameNumber;
+  bool latestCameraFrame;
   std::string leapFiducialID;
   bool mapSurfels;
   bool noRelocaliser;
   std::string openNIDeviceURI;
+  bool pinPrefetchBuffer;
   std::string pipelineType;
+  size_t poolThreadCount;
   size_t prefetchBufferCapacity;
   bool renderFiducials;
   std::vector<std::string> rgbImageMasks;
   bool saveMeshOnExit;
+  bool saveSceneOnExit;
+  unsigned int seed;
   std::vector<std::string> sequenceSpecifiers;
   std::vector<std::string> sequenceTypes;
+  unsigned short streamPort;
   std::string subwindowConfigurationIndex;
+  std::string traceFile;
   std::vector<std::string> trackerSpecifiers;
   bool trackObject;
   bool trackSurfels;
 
   // Derived arguments
+  std::vector<int> grabberCpus;
+  std::vector<int> mainCpus;
+  std::vector<int> openMPCpus;
+  std::vector<int> poolCpus;
   std::vector<bf::path> sequenceDirs;
 
   //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
@@ -100,29 +138,50 @@ struct CommandLineArguments
   {
     #define ADD_SETTING(arg) settings->add_value(#arg, boost::lexical_cast<std::string>(arg))
     #define ADD_SETTINGS(arg) for(size_t i = 0; i < arg.size(); ++i) { settings->add_value(#arg, boost::lexical_cast<std::string>(arg[i])); }
+      ADD_SETTING(affinityGrabber);
+      ADD_SETTING(affinityMain);
+      ADD_SETTING(affinityOpenMP);
+      ADD_SETTING(affinityPool);
       ADD_SETTING(batch);
       ADD_SETTING(calibrationFilename);
+      ADD_SETTING(decoderThreadCount);
       ADD_SETTINGS(depthImageMasks);
       ADD_SETTING(detectFiducials);
+      ADD_SETTING(deterministic);
       ADD_SETTING(experimentTag);
+      ADD_SETTING(fuseSequences);
+      ADD_SETTING(headless);
       ADD_SETTING(initialFrameNumber);
+      ADD_SETTING(latestCameraFrame);
       ADD_SETTING(leapFiducialID);
       ADD_SETTING(mapSurfels);
       ADD_SETTING(noRelocaliser);
       ADD_SETTING(openNIDeviceURI);
+      ADD_SETTING(pinPrefetchBuffer);
       ADD_SETTING(pipelineType);
+      ADD_SETTING(poolThreadCount);
       ADD_SETTING(prefetchBufferCapacity);
       ADD_SETTING(renderFiducials);
       ADD_SETTINGS(rgbImageMasks);
       ADD_SETTING(saveMeshOnExit);
+      ADD_SETTING(saveSceneOnExit);
+      ADD_SETTING(seed);
       ADD_SETTINGS(sequenceSpecifiers);
       ADD_SETTINGS(sequenceTypes);
+      ADD_SETTING(streamPort);
       ADD_SETTING(subwindowConfigurationIndex);
       ADD_SETTINGS(trackerSpecifiers);
       ADD_SETTING(trackObject);
       ADD_SETTING(trackSurfels);
     #undef ADD_SETTINGS
     #undef ADD_SETTING
+
+    // If a trace file has been specified, enable the profiler so that there is something to write to it.
+    if(traceFile != "")
+    {
+      settings->add_value("Profiler.enabled", "1");
+      settings->add_value("Profiler.tracePath", traceFile);
+    }
   }
 };
 
@@ -168,9 +227,50 @@ ImageSourceEngine *check_camera_subengine(ImageSourceEngine *cameraSubengine)
   else return cameraSubengine;
 }
 
+/**
+ * \brief Configures the CPU affinities of the main thread, the OpenMP team and the global thread pools.
+ *
+ * \param args  The program's command-line arguments.
+ */
+void configure_thread_affinities(const CommandLineArguments& args)
+{
+  ThreadPool::set_default_affinity(args.poolCpus);
+  ThreadPool::set_default_thread_count(args.poolThreadCount);
+  TaskScheduler::set_default_affinity(args.poolCpus);
+
+#ifdef WITH_OPENMP
+  // Note: The OpenMP team is created (and pinned) before the main thread is restricted, so that its threads don't inherit the
+  //       main thread's affinity. We skip the OpenMP master thread, since that is the main thread itself.
+  if(!args.openMPCpus.empty())
+  {
+    #pragma omp parallel
+    {
+      if(omp_get_thread_num() != 0) AffinityUtil::set_current_thread_affinity(args.openMPCpus, "OpenMP worker");
+    }
+  }
+#endif
+
+  AffinityUtil::set_current_thread_affinity(args.mainCpus, "main");
+}
+
+#ifdef WITH_CUDA
+/**
+ * \brief Initialises the CUDA runtime's context on the current device.
+ *
+ * The context would otherwise be created implicitly by the first CUDA call the pipeline makes. Creating it explicitly
+ * allows it to be created in parallel with the other start-up work, which can shorten the time to the first frame.
+ */
+void initialise_cuda_context()
+{
+  ORcudaSafeCall(cudaFree(0));
+}
+#endif
+
 /**
  * \brief Attempts to make a camera subengine to read images from any suitable camera that is attached.
  *
+ * If a stream port was specified, the "camera" is a remote one whose images are streamed to us over the network.
+ *
  * \param args  The program's command-line arguments.
  * \return      The camera subengine, if a suitable camera is attached, or NULL otherwise.
  */
@@ -178,6 +278,13 @@ ImageSourceEngine *make_camera_subengine(const CommandLineArguments& args)
 {
   ImageSourceEngine *cameraSubengine = NULL;
 
+  // Note: Streamed frames are already buffered one deep on arrival, so wrapping them in a prefetch buffer would only add latency.
+  if(args.streamPort != 0)
+  {
+    std::cout << "[spaint] Receiving images from a remote RGB-D stream on port " << args.streamPort << '\n';
+    return new RGBDStreamImageSourceEngine(args.streamPort);
+  }
+
 #ifdef WITH_OPENNI
   // Probe for an OpenNI camera.
   if(cameraSubengine == NULL)
@@ -203,9 +310,148 @@ ImageSourceEngine *make_camera_subengine(const CommandLineArguments& args)
   }
 #endif
 
+  // If requested, grab frames from the camera on a separate thread, keeping only the newest one, so that processing always
+  // runs on current data and the latency does not grow if processing falls behind the camera.
+  if(cameraSubengine != NULL && args.latestCameraFrame)
+  {
+    cameraSubengine = new AsyncImageSourceEngine(cameraSubengine, 0, false, AsyncImageSourceEngine::BUFFER_LATEST, args.grabberCpus, args.mainCpus);
+  }
+
   return cameraSubengine;
 }
 
+/**
+ * \brief Makes a subengine to read images from the specified disk sequence.
+ *
+ * \param args      The program's command-line arguments.
+ * \param settings  The settings for the application.
+ * \param i         The index of the disk sequence.
+ * \return          The disk subengine.
+ */
+ImageSourceEngine *make_disk_subengine(const CommandLineArguments& args, const Settings_CPtr& settings, size_t i)
+{
+  const std::string& depthImageMask = args.depthImageMasks[i];
+  const std::string& rgbImageMask = args.rgbImageMasks[i];
+
+  ImageSourceEngine *diskSubengine = NULL;
+  if(PackedSequenceUtil::is_packed_sequence(depthImageMask))
+  {
+    // Note: Packed sequences contain their own calibration, so the calibration file is not used.
+    std::cout << "[spaint] Reading images from packed sequence: " << depthImageMask << '\n';
+    diskSubengine = new PackedSequenceImageSourceEngine(depthImageMask, args.initialFrameNumber);
+  }
+  else if(args.decoderThreadCount > 1)
+  {
+    // Note: Decoding compressed image files can be slower than processing them, so we decode several frames at once.
+    std::cout << "[spaint] Reading images from disk using " << args.decoderThreadCount << " decoder threads: " << rgbImageMask << ' ' << depthImageMask << '\n';
+    RandomAccessImageSource_CPtr source(new ImageFileSequenceSource(args.calibrationFilename, rgbImageMask, depthImageMask, args.initialFrameNumber));
+    diskSubengine = new ParallelImageSourceEngine(source, args.initialFrameNumber, args.decoderThreadCount);
+  }
+  else
+  {
+    std::cout << "[spaint] Reading images from disk: " << rgbImageMask << ' ' << depthImageMask << '\n';
+    ImageMaskPathGenerator pathGenerator(rgbImageMask.c_str(), depthImageMask.c_str());
+    diskSubengine = new ImageFileReader<ImageMaskPathGenerator>(args.calibrationFilename.c_str(), pathGenerator, args.initialFrameNumber);
+  }
+
+  return new AsyncImageSourceEngine(
+    diskSubengine,
+    args.prefetchBufferCapacity,
+    args.pinPrefetchBuffer && settings->deviceType == ITMLibSettings::DEVICE_CUDA,
+    AsyncImageSourceEngine::BUFFER_FIFO,
+    args.grabberCpus,
+    args.mainCpus
+  );
+}
+
+/**
+ * \brief Makes the image source engines from which the pipeline will read its images.
+ *
+ * \note  This can take a while (e.g. opening a camera or a packed sequence), so it is run in parallel with the rest of the start-up work.
+ *
+ * \param args                      The program's command-line arguments.
+ * \param settings                  The settings for the application.
+ * \param imageSourceEngine         A variable into which to write the image source engine for the world scene.
+ * \param fusedImageSourceEngines   A variable into which to write the image source engines for any additional sensors whose frames
+ *                                  are to be fused into the world scene (one per disk sequence after the first, if fusing sequences).
+ */
+void make_image_source_engines(const CommandLineArguments& args, const Settings_CPtr& settings, CompositeImageSourceEngine_Ptr& imageSourceEngine,
+                               std::vector<CompositeImageSourceEngine_Ptr>& fusedImageSourceEngines)
+{
+  // Note: We use swapping composites, so that the SLAM components can take the images from the asynchronous subengines without copying them.
+  SwappingCompositeImageSourceEngine_Ptr mainImageSourceEngine(new SwappingCompositeImageSourceEngine);
+
+  // Add a subengine for each disk sequence specified. If we're fusing the sequences, each sequence after the first is
+  // read by a separate engine, so that it can be treated as coming from a separate sensor.
+  for(size_t i = 0; i < args.depthImageMasks.size(); ++i)
+  {
+    if(args.fuseSequences && i > 0)
+    {
+      SwappingCompositeImageSourceEngine_Ptr fusedImageSourceEngine(new SwappingCompositeImageSourceEngine);
+      fusedImageSourceEngine->add_subengine(make_disk_subengine(args, settings, i));
+      fusedImageSourceEngines.push_back(fusedImageSourceEngine);
+    }
+    else mainImageSourceEngine->add_subengine(make_disk_subengine(args, settings, i));
+  }
+
+  // If no disk sequences were specified, or we want to switch to the camera once all the disk sequences finish, add a camera subengine.
+  if(args.depthImageMasks.empty() || args.cameraAfterDisk)
+  {
+    ImageSourceEngine *cameraSubengine = make_camera_subengine(args);
+    if(cameraSubengine != NULL) mainImageSourceEngine->add_subengine(cameraSubengine);
+  }
+
+  imageSourceEngine = mainImageSourceEngine;
+}
+
+/**
+ * \brief Makes the configuration of the tracker to use for the specified sequence, based on any tracker specifier passed in for it on the command line.
+ *
+ * \param args  The parsed command-line arguments.
+ * \param i     The index of the sequence.
+ * \return      The tracker configuration for the sequence.
+ */
+std::string make_single_tracker_config(const CommandLineArguments& args, size_t i)
+{
+  std::string result;
+
+  // Look to see if the user specified an explicit tracker specifier for the sequence on the command line; if not, use a default tracker specifier.
+  const std::string trackerSpecifier = i < args.trackerSpecifiers.size() ? args.trackerSpecifiers[i] : "InfiniTAM";
+
+  // Separate the tracker specifier into chunks.
+  typedef boost::char_separator<char> sep;
+  typedef boost::tokenizer<sep> tokenizer;
+
+  tokenizer tok(trackerSpecifier.begin(), trackerSpecifier.end(), sep("+"));
+  std::vector<std::string> chunks(tok.begin(), tok.end());
+
+  // Make a tracker configuration based on the specifier chunks. If more than one chunk is involved, bundle the subsidiary trackers into a refining composite.
+  size_t chunkCount = chunks.size();
+  if(chunkCount > 1) result += "<tracker type='composite'>";
+
+  for(size_t j = 0; j < chunkCount; ++j)
+  {
+    if(chunks[j] == "InfiniTAM")
+    {
+      result += "<tracker type='infinitam'/>";
+    }
+    else if(chunks[j] == "Disk")
+    {
+      const std::string poseFileMask = (args.sequenceDirs[i] / "posem%06i.txt").string();
+      result += "<tracker type='infinitam'><params>type=file,mask=" + poseFileMask + "</params></tracker>";
+    }
+    else
+    {
+      result += "<tracker type='import'><params>builtin:" + chunks[j] + "</params></tracker>";
+    }
+  }
+
+  // If more than one chunk was involved, add the necessary closing tag for the refining composite.
+  if(chunkCount > 1) result += "</tracker>";
+
+  return result;
+}
+
 /**
  * \brief Makes the overall tracker configuration based on any tracker specifiers that were passed in on the command line.
  *
@@ -216,50 +462,18 @@ std::string make_tracker_config(CommandLineArguments& args)
 {
   std::string result;
 
-  // Determine the number of different trackers that will be needed.
-  size_t trackerCount = args.sequenceSpecifiers.size();
+  // Determine the number of different trackers that will be needed. If we're fusing the sequences, only the first sequence
+  // is processed by the world scene (the others are each tracked separately, by the scenes for the additional sensors).
+  size_t trackerCount = args.fuseSequences ? 1 : args.sequenceSpecifiers.size();
   if(trackerCount == 0 || args.cameraAfterDisk) ++trackerCount;
 
   // If more than one tracker is needed, make the overall tracker a composite.
   if(trackerCount > 1) result += "<tracker type='composite' policy='sequential'>";
 
-  // For each tracker that is needed:
+  // Add a tracker configuration for each tracker that is needed.
   for(size_t i = 0; i < trackerCount; ++i)
   {
-    // Look to see if the user specified an explicit tracker specifier for it on the command line; if not, use a default tracker specifier.
-    const std::string trackerSpecifier = i < args.trackerSpecifiers.size() ? args.trackerSpecifiers[i] : "InfiniTAM";
-
-    // Separate the tracker specifier into chunks.
-    typedef boost::char_separator<char> sep;
-    typedef boost::tokenizer<sep> tokenizer;
-
-    tokenizer tok(trackerSpecifier.begin(), trackerSpecifier.end(), sep("+"));
-    std::vector<std::string> chunks(tok.begin(), tok.end());
-
-    // Add a tracker configuration based on the specifier chunks to the overall tracker configuration.
-    // If more than one chunk is involved, bundle the subsidiary trackers into a refining composite.
-    size_t chunkCount = chunks.size();
-    if(chunkCount > 1) result += "<tracker type='composite'>";
-
-    for(size_t i = 0; i < chunkCount; ++i)
-    {
-      if(chunks[i] == "InfiniTAM")
-      {
-        result += "<tracker type='infinitam'/>";
-      }
-      else if(chunks[i] == "Disk")
-      {
-        const std::string poseFileMask = (args.sequenceDirs[i] / "posem%06i.txt").string();
-        result += "<tracker type='infinitam'><params>type=file,mask=" + poseFileMask + "</params></tracker>";
-      }
-      else
-      {
-        result += "<tracker type='import'><params>builtin:" + chunks[i] + "</params></tracker>";
-      }
-    }
-
-    // If more than one chunk was involved, add the necessary closing tag for the refining composite.
-    if(chunkCount > 1) result += "</tracker>";
+    result += make_single_tracker_config(args, i);
   }
 
   // If more than one tracker was needed, add the necessary closing tag for the overall composite.
@@ -268,6 +482,7 @@ std::string make_tracker_config(CommandLineArguments& args)
   return result;
 }
 
+
 /**
  * \brief Post-process the program's command-line arguments and add them to the application settings.
  *
@@ -290,16 +505,26 @@ bool postprocess_arguments(CommandLineArguments& args, const Settings_Ptr& setti
     // Determine the sequence type.
     const std::string sequenceType = i < args.sequenceTypes.size() ? args.sequenceTypes[i] : "sequence";
 
-    // Determine the directory containing the sequence and record it for later use.
+    // Determine the location of the sequence (either a directory of images or a packed sequence file).
     const std::string& sequenceSpecifier = args.sequenceSpecifiers[i];
-    const bf::path dir = bf::is_directory(sequenceSpecifier)
-      ? sequenceSpecifier
+    const bf::path location = bf::exists(sequenceSpecifier)
+      ? bf::path(sequenceSpecifier)
       : find_subdir_from_executable(sequenceType + "s") / sequenceSpecifier;
-    args.sequenceDirs.push_back(dir);
 
-    // Set the depth / RGB image masks.
-    args.depthImageMasks.push_back((dir / "depthm%06i.pgm").string());
-    args.rgbImageMasks.push_back((dir / "rgbm%06i.ppm").string());
+    if(PackedSequenceUtil::is_packed_sequence(location.string()))
+    {
+      // A packed sequence file contains all of the images, so use its path as both masks, and record its directory for later use.
+      args.sequenceDirs.push_back(location.parent_path());
+      args.depthImageMasks.push_back(location.string());
+      args.rgbImageMasks.push_back(location.string());
+    }
+    else
+    {
+      // Record the directory containing the sequence for later use, and set the depth / RGB image masks.
+      args.sequenceDirs.push_back(location);
+      args.depthImageMasks.push_back((location / "depthm%06i.pgm").string());
+      args.rgbImageMasks.push_back((location / "rgbm%06i.ppm").string());
+    }
   }
 
   // If the user hasn't explicitly specified a calibration file, try to find one in the first sequence directory (if it exists).
@@ -312,6 +537,22 @@ bool postprocess_arguments(CommandLineArguments& args, const Settings_Ptr& setti
     }
   }
 
+  // If the user wants to fuse the disk sequences, make sure that doing so makes sense.
+  if(args.fuseSequences)
+  {
+    if(args.depthImageMasks.size() < 2)
+    {
+      std::cout << "Error: At least two disk sequences must be specified in order to fuse them.\n";
+      return false;
+    }
+
+    if(args.cameraAfterDisk || args.pipelineType != "slam")
+    {
+      std::cout << "Error: Disk sequences can only be fused using the slam pipeline, and without switching to the camera afterwards.\n";
+      return false;
+    }
+  }
+
   // If the user wants to enable surfel tracking, make sure that surfel mapping is also enabled.
   if(args.trackSurfels) args.mapSurfels = true;
 
@@ -322,6 +563,12 @@ bool postprocess_arguments(CommandLineArguments& args, const Settings_Ptr& setti
     args.detectFiducials = true;
   }
 
+  // Parse the CPU sets for the different thread roles.
+  args.grabberCpus = AffinityUtil::parse_cpu_list(args.affinityGrabber);
+  args.mainCpus = AffinityUtil::parse_cpu_list(args.affinityMain);
+  args.openMPCpus = AffinityUtil::parse_cpu_list(args.affinityOpenMP);
+  args.poolCpus = AffinityUtil::parse_cpu_list(args.affinityPool);
+
   // Add the post-processed arguments to the application settings.
   args.add_to_settings(settings);
 
@@ -348,27 +595,37 @@ bool parse_command_line(int argc, char *argv[], CommandLineArguments& args, cons
     ("cameraAfterDisk", po::bool_switch(&args.cameraAfterDisk), "switch to the camera after a disk sequence")
     ("configFile,f", po::value<std::string>(), "additional parameters filename")
     ("detectFiducials", po::bool_switch(&args.detectFiducials), "enable fiducial detection")
+    ("deterministic", po::bool_switch(&args.deterministic), "derive every random seed from the root seed and disable timing-dependent behaviour, so that repeated runs do identical work")
     ("experimentTag", po::value<std::string>(&args.experimentTag)->default_value(""), "experiment tag")
+    ("headless", po::bool_switch(&args.headless), "process the input as fast as possible, without a window, rendering or user input (implies batch mode)")
     ("leapFiducialID", po::value<std::string>(&args.leapFiducialID)->default_value(""), "the ID of the fiducial to use for the Leap Motion")
     ("mapSurfels", po::bool_switch(&args.mapSurfels), "enable surfel mapping")
     ("noRelocaliser", po::bool_switch(&args.noRelocaliser), "don't use the relocaliser")
     ("pipelineType", po::value<std::string>(&args.pipelineType)->default_value("semantic"), "pipeline type")
     ("renderFiducials", po::bool_switch(&args.renderFiducials), "enable fiducial rendering")
     ("saveMeshOnExit", po::bool_switch(&args.saveMeshOnExit), "save a mesh of the scene on exiting the application")
+    ("saveSceneOnExit", po::bool_switch(&args.saveSceneOnExit), "save an archive of the scene on exiting the application")
+    ("seed", po::value<unsigned int>(&args.seed)->default_value(12345), "the root random seed")
     ("subwindowConfigurationIndex", po::value<std::string>(&args.subwindowConfigurationIndex)->default_value("1"), "subwindow configuration index")
+    ("traceFile", po::value<std::string>(&args.traceFile)->default_value(""), "enable profiling and write a Chrome trace of the frame timelines to the specified file on exit")
     ("trackerSpecifier,t", po::value<std::vector<std::string> >(&args.trackerSpecifiers)->multitoken(), "tracker specifier")
     ("trackSurfels", po::bool_switch(&args.trackSurfels), "enable surfel mapping and tracking")
   ;
 
   po::options_description cameraOptions("Camera options");
   cameraOptions.add_options()
+    ("latestCameraFrame", po::bool_switch(&args.latestCameraFrame), "grab camera frames on a separate thread and only ever process the newest one, dropping any stale frames")
+    ("streamPort", po::value<unsigned short>(&args.streamPort)->default_value(0), "port on which to receive images from a remote RGB-D stream sender instead of a local camera (0 = disabled)")
     ("uri,u", po::value<std::string>(&args.openNIDeviceURI)->default_value("Default"), "OpenNI device URI")
   ;
 
   po::options_description diskSequenceOptions("Disk sequence options");
   diskSequenceOptions.add_options()
+    ("decoderThreads", po::value<size_t>(&args.decoderThreadCount)->default_value(1), "number of threads to use to decode disk sequence images (image files only)")
     ("depthMask,d", po::value<std::vector<std::string> >(&args.depthImageMasks)->multitoken(), "depth image mask")
+    ("fuseSequences", po::bool_switch(&args.fuseSequences), "treat the disk sequences as coming from separate sensors observing the same scene, and fuse them into a single shared scene (slam pipeline only)")
     ("initialFrame,n", po::value<int>(&args.initialFrameNumber)->default_value(0), "initial frame number")
+    ("pinPrefetchBuffer", po::bool_switch(&args.pinPrefetchBuffer), "store the prefetch buffer in pinned memory and upload frames to the GPU asynchronously (only useful to consumers that read the uploaded device images)")
     ("prefetchBufferCapacity,b", po::value<size_t>(&args.prefetchBufferCapacity)->default_value(60), "capacity of the prefetch buffer")
     ("rgbMask,r", po::value<std::vector<std::string> >(&args.rgbImageMasks)->multitoken(), "RGB image mask")
     ("sequenceSpecifier,s", po::value<std::vector<std::string> >(&args.sequenceSpecifiers)->multitoken(), "sequence specifier")
@@ -380,11 +637,21 @@ bool parse_command_line(int argc, char *argv[], CommandLineArguments& args, cons
     ("trackObject", po::bool_switch(&args.trackObject), "track the object")
   ;
 
+  po::options_description threadingOptions("Threading options");
+  threadingOptions.add_options()
+    ("affinityGrabber", po::value<std::string>(&args.affinityGrabber)->default_value(""), "CPUs on which to run the image grabber threads, e.g. 0-3,8 (empty = any)")
+    ("affinityMain", po::value<std::string>(&args.affinityMain)->default_value(""), "CPUs on which to run the main thread, and near which to allocate the prefetch buffers (empty = any)")
+    ("affinityOpenMP", po::value<std::string>(&args.affinityOpenMP)->default_value(""), "CPUs on which to run the OpenMP worker threads (empty = any)")
+    ("affinityPool", po::value<std::string>(&args.affinityPool)->default_value(""), "CPUs on which to run the thread pool and task scheduler workers (empty = any)")
+    ("poolThreads", po::value<size_t>(&args.poolThreadCount)->default_value(0), "number of thread pool workers (0 = one per CPU in the pool's affinity, or the hardware concurrency)")
+  ;
+
   po::options_description options;
   options.add(genericOptions);
   options.add(cameraOptions);
   options.add(diskSequenceOptions);
   options.add(objectivePipelineOptions);
+  options.add(threadingOptions);
 
   // Parse the command line.
   po::variables_map vm;
@@ -449,49 +716,45 @@ try
     return 0;
   }
 
-  // Initialise SDL.
-  if(SDL_Init(SDL_INIT_VIDEO) < 0)
+  if(args.cameraAfterDisk || !args.noRelocaliser) settings->behaviourOnFailure = ITMLibSettings::FAILUREMODE_RELOCALISE;
+
+  // Set up the thread affinities. This must happen before any other threads are started, since threads inherit the affinity
+  // of the thread that creates them.
+  configure_thread_affinities(args);
+
+  // Pass the device type and (optional) device memory budget to the memory block factory.
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  mbf.set_device_type(settings->deviceType);
+  mbf.set_device_memory_budget(settings->get_first_value<size_t>("MemoryBlockFactory.deviceBudgetMB", 0) * 1024 * 1024);
+
+  // Start constructing the image source engine (which can involve opening a camera or a sequence) and, if we're running in CUDA mode,
+  // initialising the CUDA context in the background, since neither depends on the initialisation of the windowing system below.
+  CompositeImageSourceEngine_Ptr imageSourceEngine;
+  std::vector<CompositeImageSourceEngine_Ptr> fusedImageSourceEngines;
+  TaskGroup startupTasks;
+  startupTasks.run(boost::bind(&make_image_source_engines, boost::cref(args), settings, boost::ref(imageSourceEngine), boost::ref(fusedImageSourceEngines)));
+#ifdef WITH_CUDA
+  if(settings->deviceType == ITMLibSettings::DEVICE_CUDA) startupTasks.run(&initialise_cuda_context);
+#endif
+
+  // Initialise SDL, GLUT and the Rift SDK (if available). None of these are needed if we're running headless.
+  // Note that these are initialised on the main thread, since SDL's video subsystem must be.
+  if(!args.headless)
   {
-    quit("Error: Failed to initialise SDL.");
-  }
+    if(SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+      quit("Error: Failed to initialise SDL.");
+    }
 
 #ifdef WITH_GLUT
-  // Initialise GLUT (used for text rendering only).
-  glutInit(&argc, argv);
+    // Initialise GLUT (used for text rendering only).
+    glutInit(&argc, argv);
 #endif
 
 #ifdef WITH_OVR
-  // If we built with Rift support, initialise the Rift SDK.
-  ovr_Initialize();
+    // If we built with Rift support, initialise the Rift SDK.
+    ovr_Initialize();
 #endif
-
-  if(args.cameraAfterDisk || !args.noRelocaliser) settings->behaviourOnFailure = ITMLibSettings::FAILUREMODE_RELOCALISE;
-
-  // Pass the device type to the memory block factory.
-  MemoryBlockFactory::instance().set_device_type(settings->deviceType);
-
-  // Construct the image source engine.
-  boost::shared_ptr<CompositeImageSourceEngine> imageSourceEngine(new CompositeImageSourceEngine);
-
-  // Add a subengine for each disk sequence specified.
-  for(size_t i = 0; i < args.depthImageMasks.size(); ++i)
-  {
-    const std::string& depthImageMask = args.depthImageMasks[i];
-    const std::string& rgbImageMask = args.rgbImageMasks[i];
-
-    std::cout << "[spaint] Reading images from disk: " << rgbImageMask << ' ' << depthImageMask << '\n';
-    ImageMaskPathGenerator pathGenerator(rgbImageMask.c_str(), depthImageMask.c_str());
-    imageSourceEngine->addSubengine(new AsyncImageSourceEngine(
-      new ImageFileReader<ImageMaskPathGenerator>(args.calibrationFilename.c_str(), pathGenerator, args.initialFrameNumber),
-      args.prefetchBufferCapacity
-    ));
-  }
-
-  // If no disk sequences were specified, or we want to switch to the camera once all the disk sequences finish, add a camera subengine.
-  if(args.depthImageMasks.empty() || args.cameraAfterDisk)
-  {
-    ImageSourceEngine *cameraSubengine = make_camera_subengine(args);
-    if(cameraSubengine != NULL) imageSourceEngine->addSubengine(cameraSubengine);
   }
 
   // Construct the fiducial detector (if any).
@@ -500,6 +763,9 @@ try
   fiducialDetector.reset(new ArUcoFiducialDetector(settings));
 #endif
 
+  // Wait for the image source engine to be ready (and the CUDA context to be initialised), since the pipeline needs both.
+  startupTasks.wait();
+
   // Construct the pipeline.
   const size_t maxLabelCount = 10;
   SLAMComponent::MappingMode mappingMode = args.mapSurfels ? SLAMComponent::MAP_BOTH : SLAMComponent::MAP_VOXELS_ONLY;
@@ -508,7 +774,7 @@ try
   MultiScenePipeline_Ptr pipeline;
   if(args.pipelineType == "slam")
   {
-    pipeline.reset(new SLAMPipeline(
+    boost::shared_ptr<SLAMPipeline> slamPipeline(new SLAMPipeline(
       settings,
       Application::resources_dir().string(),
       imageSourceEngine,
@@ -518,16 +784,29 @@ try
       fiducialDetector,
       args.detectFiducials
     ));
+
+    // If we're fusing the disk sequences, add a scene for each additional sensor, and fuse its frames into the world scene.
+    if(args.fuseSequences)
+    {
+      std::vector<std::string> fusedTrackerConfigs;
+      for(size_t i = 1, count = args.depthImageMasks.size(); i < count; ++i)
+      {
+        fusedTrackerConfigs.push_back(make_single_tracker_config(args, i));
+      }
+
+      slamPipeline->fuse_sensors(fusedImageSourceEngines, fusedTrackerConfigs, mappingMode, trackingMode);
+    }
+
+    pipeline = slamPipeline;
   }
   else if(args.pipelineType == "semantic")
   {
-    const unsigned int seed = 12345;
     pipeline.reset(new SemanticPipeline(
       settings,
       Application::resources_dir().string(),
       maxLabelCount,
       imageSourceEngine,
-      seed,
+      args.seed,
       make_tracker_config(args),
       mappingMode,
       trackingMode,
@@ -558,18 +837,22 @@ try
 #endif
 
   // Configure and run the application.
-  Application app(pipeline, args.renderFiducials);
-  app.set_batch_mode_enabled(args.batch);
+  Application app(pipeline, args.renderFiducials, args.headless);
+  app.set_batch_mode_enabled(args.batch || args.headless);
   app.set_save_mesh_on_exit(args.saveMeshOnExit);
+  app.set_save_scene_on_exit(args.saveSceneOnExit);
   bool runSucceeded = app.run();
 
+  if(!args.headless)
+  {
 #ifdef WITH_OVR
-  // If we built with Rift support, shut down the Rift SDK.
-  ovr_Shutdown();
+    // If we built with Rift support, shut down the Rift SDK.
+    ovr_Shutdown();
 #endif
 
-  // Shut down SDL.
-  SDL_Quit();
+    // Shut down SDL.
+    SDL_Quit();
+  }
 
   return runSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,103 @@
+/**
+ * spaintgui: AsyncScreenCapturer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#include "AsyncScreenCapturer.h"
+
+#include <cstring>
+
+//#################### CONSTRUCTORS ####################
+
+AsyncScreenCapturer::AsyncScreenCapturer()
+: m_currentBuffer(0)
+{
+  glGenBuffers(BUFFER_COUNT, m_bufferIDs);
+  for(int i = 0; i < BUFFER_COUNT; ++i)
+  {
+    m_bufferSizes[i] = Vector2i(0, 0);
+    m_pending[i] = false;
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+AsyncScreenCapturer::~AsyncScreenCapturer()
+{
+  glDeleteBuffers(BUFFER_COUNT, m_bufferIDs);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMUChar4Image_CPtr AsyncScreenCapturer::capture(const Vector2i& size)
+{
+  // Start reading the frame buffer into the current pixel buffer object, (re)allocating its storage if the size has changed.
+  // Since the destination is a buffer object, glReadPixels returns without waiting for the transfer to complete.
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_bufferIDs[m_currentBuffer]);
+  if(size != m_bufferSizes[m_currentBuffer])
+  {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size.x * size.y * sizeof(Vector4u), NULL, GL_STREAM_READ);
+    m_bufferSizes[m_currentBuffer] = size;
+  }
+  glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  m_pending[m_currentBuffer] = true;
+
+  // Retrieve the frame that was read back into the other pixel buffer object on the previous call (if any).
+  const int previousBuffer = (m_currentBuffer + 1) % BUFFER_COUNT;
+  ITMUChar4Image_CPtr frame = m_pending[previousBuffer] ? retrieve_frame(previousBuffer) : ITMUChar4Image_CPtr();
+
+  m_currentBuffer = previousBuffer;
+  return frame;
+}
+
+ITMUChar4Image_CPtr AsyncScreenCapturer::finish()
+{
+  // The frame still being read back (if any) is the one in the buffer we read into last, i.e. the one before the current buffer.
+  const int lastBuffer = (m_currentBuffer + BUFFER_COUNT - 1) % BUFFER_COUNT;
+  return m_pending[lastBuffer] ? retrieve_frame(lastBuffer) : ITMUChar4Image_CPtr();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+ITMUChar4Image_Ptr AsyncScreenCapturer::acquire_image(const Vector2i& size)
+{
+  // Look for an image that is only referenced by the pool (e.g. one that has already been saved to disk).
+  for(size_t i = 0, count = m_imagePool.size(); i < count; ++i)
+  {
+    if(m_imagePool[i].unique())
+    {
+      m_imagePool[i]->ChangeDims(size);
+      return m_imagePool[i];
+    }
+  }
+
+  // If there isn't one, add a new image to the pool.
+  m_imagePool.push_back(ITMUChar4Image_Ptr(new ITMUChar4Image(size, true, false)));
+  return m_imagePool.back();
+}
+
+ITMUChar4Image_CPtr AsyncScreenCapturer::retrieve_frame(int bufferIndex)
+{
+  const Vector2i& size = m_bufferSizes[bufferIndex];
+  ITMUChar4Image_Ptr image = acquire_image(size);
+
+  // Map the pixel buffer object into CPU memory and copy its rows into the image in reverse order,
+  // since OpenGL stores the frame buffer bottom-up. This flips the frame without a separate pass.
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_bufferIDs[bufferIndex]);
+  const Vector4u *src = static_cast<const Vector4u*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+  if(src)
+  {
+    Vector4u *dest = image->GetData(MEMORYDEVICE_CPU);
+    const size_t rowBytes = size.x * sizeof(Vector4u);
+    for(int y = 0; y < size.y; ++y)
+    {
+      memcpy(dest + y * size.x, src + (size.y - 1 - y) * size.x, rowBytes);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  m_pending[bufferIndex] = false;
+  return src ? image : ITMUChar4Image_CPtr();
+}
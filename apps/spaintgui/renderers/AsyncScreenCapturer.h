@@ -0,0 +1,110 @@
+/**
+ * spaintgui: AsyncScreenCapturer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#ifndef H_SPAINTGUI_ASYNCSCREENCAPTURER
+#define H_SPAINTGUI_ASYNCSCREENCAPTURER
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+#include <spaint/ogl/WrappedGL.h>
+
+/**
+ * \brief An instance of this class can be used to capture a sequence of images of the OpenGL frame buffer without stalling the pipeline.
+ *
+ * Each frame is read back into one of a pair of pixel buffer objects, and is only mapped into CPU memory when the next frame
+ * is captured, by which time the transfer has normally completed. The captured images therefore lag the frame buffer by one frame.
+ * The captured images are drawn from a pool and are only reused once nothing else holds a reference to them.
+ *
+ * Note that a capturer must be constructed and destroyed whilst the OpenGL context from which it reads is current.
+ */
+class AsyncScreenCapturer
+{
+  //#################### CONSTANTS ####################
+private:
+  /** The number of pixel buffer objects between which the readbacks alternate. */
+  static const int BUFFER_COUNT = 2;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The IDs of the pixel buffer objects. */
+  GLuint m_bufferIDs[BUFFER_COUNT];
+
+  /** The sizes of the frames most recently read back into each of the pixel buffer objects. */
+  Vector2i m_bufferSizes[BUFFER_COUNT];
+
+  /** The index of the pixel buffer object into which to read the next frame. */
+  int m_currentBuffer;
+
+  /** The pool of images into which the captured frames are copied. */
+  std::vector<ITMUChar4Image_Ptr> m_imagePool;
+
+  /** Whether or not each of the pixel buffer objects contains a frame that has not yet been retrieved. */
+  bool m_pending[BUFFER_COUNT];
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an asynchronous screen capturer.
+   */
+  AsyncScreenCapturer();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the capturer.
+   */
+  ~AsyncScreenCapturer();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  AsyncScreenCapturer(const AsyncScreenCapturer&);
+  AsyncScreenCapturer& operator=(const AsyncScreenCapturer&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Starts reading back the current contents of the frame buffer, and retrieves the frame that was captured on the previous call (if any).
+   *
+   * \param size  The size of the region (starting at the bottom-left of the frame buffer) to capture.
+   * \return      The previously captured frame (correctly oriented), or NULL if there is no such frame.
+   */
+  ITMUChar4Image_CPtr capture(const Vector2i& size);
+
+  /**
+   * \brief Retrieves the frame (if any) that is still being read back, waiting for the transfer to complete if necessary.
+   *
+   * \return  The frame (correctly oriented), or NULL if there is no such frame.
+   */
+  ITMUChar4Image_CPtr finish();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets an image of the specified size from the pool that is not currently in use, adding one to the pool if necessary.
+   *
+   * \param size  The size of the image.
+   * \return      The image.
+   */
+  ITMUChar4Image_Ptr acquire_image(const Vector2i& size);
+
+  /**
+   * \brief Copies the frame in the specified pixel buffer object into an image from the pool.
+   *
+   * \param bufferIndex The index of the pixel buffer object.
+   * \return            The image.
+   */
+  ITMUChar4Image_CPtr retrieve_frame(int bufferIndex);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<AsyncScreenCapturer> AsyncScreenCapturer_Ptr;
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * spaintgui: InteropTexture.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#include "InteropTexture.h"
+
+#include <cuda_gl_interop.h>
+
+#include <ORUtils/CUDADefines.h>
+
+//#################### CONSTRUCTORS ####################
+
+InteropTexture::InteropTexture()
+: m_internalFormat(GL_RGBA), m_resource(NULL), m_size(0, 0)
+{
+  glGenTextures(1, &m_textureID);
+}
+
+//#################### DESTRUCTOR ####################
+
+InteropTexture::~InteropTexture()
+{
+  unregister();
+  glDeleteTextures(1, &m_textureID);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+GLuint InteropTexture::get_id() const
+{
+  return m_textureID;
+}
+
+void InteropTexture::upload(const ITMUChar4Image *image)
+{
+  upload_data(image->GetData(MEMORYDEVICE_CUDA), image->noDims, sizeof(Vector4u), GL_RGBA, GL_RGBA, GL_LINEAR);
+}
+
+void InteropTexture::upload(const ITMUShortImage *image)
+{
+  upload_data(image->GetData(MEMORYDEVICE_CUDA), image->noDims, sizeof(ushort), GL_LUMINANCE8_ALPHA8, GL_LUMINANCE_ALPHA, GL_NEAREST);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void InteropTexture::unregister()
+{
+  if(m_resource)
+  {
+    ORcudaSafeCall(cudaGraphicsUnregisterResource(m_resource));
+    m_resource = NULL;
+  }
+}
+
+void InteropTexture::upload_data(const void *data, const Vector2i& size, size_t bytesPerPixel, GLint internalFormat, GLenum format, GLint filter)
+{
+  // If the image is not the same size or format as the texture, reallocate the texture's storage and register it with CUDA.
+  if(size != m_size || internalFormat != m_internalFormat || !m_resource)
+  {
+    unregister();
+
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size.x, size.y, 0, format, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    ORcudaSafeCall(cudaGraphicsGLRegisterImage(&m_resource, m_textureID, GL_TEXTURE_2D, cudaGraphicsRegisterFlagsWriteDiscard));
+    m_internalFormat = internalFormat;
+    m_size = size;
+  }
+
+  // Map the texture into CUDA's address space and copy the image into it on the GPU.
+  const size_t rowBytes = size.x * bytesPerPixel;
+  cudaArray *textureArray;
+  ORcudaSafeCall(cudaGraphicsMapResources(1, &m_resource));
+  ORcudaSafeCall(cudaGraphicsSubResourceGetMappedArray(&textureArray, m_resource, 0, 0));
+  ORcudaSafeCall(cudaMemcpy2DToArray(textureArray, 0, 0, data, rowBytes, rowBytes, size.y, cudaMemcpyDeviceToDevice));
+  ORcudaSafeCall(cudaGraphicsUnmapResources(1, &m_resource));
+}
@@ -0,0 +1,112 @@
+/**
+ * spaintgui: InteropTexture.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#ifndef H_SPAINTGUI_INTEROPTEXTURE
+#define H_SPAINTGUI_INTEROPTEXTURE
+
+#include <boost/shared_ptr.hpp>
+
+#include <cuda_runtime.h>
+
+#include <ITMLib/Utils/ITMImageTypes.h>
+
+#include <spaint/ogl/WrappedGL.h>
+
+/**
+ * \brief An instance of this class wraps an OpenGL texture that is registered with CUDA, so that images
+ *        that reside on the GPU can be copied into it directly, without a round trip via the CPU.
+ *
+ * The texture's storage is (re)allocated and (re)registered whenever the size or format of the uploaded image changes.
+ * Since the storage must not be reallocated behind CUDA's back, the texture should only be written to via upload.
+ *
+ * Note that an interop texture must be constructed and destroyed whilst the OpenGL context in which it is used is current.
+ */
+class InteropTexture
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The internal format of the texture's storage (e.g. GL_RGBA). */
+  GLint m_internalFormat;
+
+  /** The CUDA graphics resource corresponding to the texture (if it has been registered). */
+  cudaGraphicsResource *m_resource;
+
+  /** The size of the texture's storage. */
+  Vector2i m_size;
+
+  /** The ID of the OpenGL texture. */
+  GLuint m_textureID;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an interop texture.
+   */
+  InteropTexture();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the interop texture.
+   */
+  ~InteropTexture();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  InteropTexture(const InteropTexture&);
+  InteropTexture& operator=(const InteropTexture&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the ID of the OpenGL texture.
+   *
+   * \return  The ID of the OpenGL texture.
+   */
+  GLuint get_id() const;
+
+  /**
+   * \brief Copies the GPU memory of the specified image into the texture.
+   *
+   * \param image The image (its data must be up-to-date on the GPU).
+   */
+  void upload(const ITMUChar4Image *image);
+
+  /**
+   * \brief Copies the GPU memory of the specified compact semantic image into the texture.
+   *
+   * The texture stores the low byte of each pixel (the label) in its luminance channel and the high byte (the intensity) in its alpha
+   * channel, and uses nearest-neighbour filtering, so that it can be drawn using a palette shader (see spaint::SemanticPaletteShader).
+   *
+   * \param image The image (its data must be up-to-date on the GPU).
+   */
+  void upload(const ITMUShortImage *image);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Unregisters the texture from CUDA (if it is currently registered).
+   */
+  void unregister();
+
+  /**
+   * \brief Copies the specified GPU memory into the texture, (re)allocating the texture's storage first if necessary.
+   *
+   * \param data            The GPU memory to copy.
+   * \param size            The size of the image stored in the GPU memory.
+   * \param bytesPerPixel   The number of bytes per pixel of the image.
+   * \param internalFormat  The internal format to use for the texture's storage.
+   * \param format          The format of the image's pixels.
+   * \param filter          The filter to use when magnifying or minifying the texture.
+   */
+  void upload_data(const void *data, const Vector2i& size, size_t bytesPerPixel, GLint internalFormat, GLenum format, GLint filter);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<InteropTexture> InteropTexture_Ptr;
+
+#endif
@@ -4,20 +4,33 @@
  */
 
 #include "Renderer.h"
+
+#include <iostream>
+#include <sstream>
+
+#include <boost/bind.hpp>
+
+#include <ITMLib/Objects/RenderStates/ITMRenderStateFactory.h>
 using namespace ITMLib;
 using namespace ORUtils;
 using namespace rigging;
 
+#include <itmx/base/MemoryBlockFactory.h>
+
+#include <spaint/imageprocessing/MedianFiltererFactory.h>
 #include <spaint/ogl/CameraRenderer.h>
 #include <spaint/ogl/QuadricRenderer.h>
 #include <spaint/selectiontransformers/interface/VoxelToCubeSelectionTransformer.h>
+#include <spaint/selectiontransformers/interface/VoxelToSurfaceSelectionTransformer.h>
 #include <spaint/selectors/PickingSelector.h>
 #include <spaint/util/CameraFactory.h>
 #include <spaint/util/CameraPoseConverter.h>
 using namespace spaint;
 
+#include <tvgutil/timing/ProfilingScope.h>
+using namespace tvgutil;
+
 #ifdef WITH_ARRAYFIRE
-#include <spaint/imageprocessing/MedianFilterer.h>
 #include <spaint/selectors/TouchSelector.h>
 #endif
 
@@ -55,14 +68,18 @@ public:
   virtual void visit(const LeapSelector& selector) const
   {
     // Render the camera representing the Leap Motion controller's coordinate frame.
-    CameraRenderer::render_camera(selector.get_camera(), CameraRenderer::AXES_XYZ, 0.1f);
+    const Camera& leapCam = selector.get_camera();
+    CameraRenderer::render_cameras(std::vector<SimpleCamera>(1, SimpleCamera(leapCam.p(), leapCam.n(), leapCam.v())), *m_base->m_cameraAxesMesh, 0.1f);
 
     // Get the most recent frame of data from the Leap Motion. If it's invalid or does not contain precisely one hand, early out.
     const Leap::Frame& frame = selector.get_frame();
     if(!frame.isValid() || frame.hands().count() != 1) return;
 
-    // Render the virtual hand.
+    // Render the virtual hand. To avoid rebinding the meshes for each bone, we first collect all of the bones
+    // and joints, and then render all of the bones (as cylinders) followed by all of the joints (as spheres).
     const Leap::Hand& hand = frame.hands()[0];
+    std::vector<Eigen::Vector3f> boneStarts, boneEnds;
+    std::vector<float> boneRadii, jointRadii;
     for(int fingerIndex = 0, fingerCount = hand.fingers().count(); fingerIndex < fingerCount; ++fingerIndex)
     {
       const Leap::Finger& finger = hand.fingers()[fingerIndex];
@@ -71,21 +88,19 @@ public:
       for(int boneIndex = 0; boneIndex < boneCount; ++boneIndex)
       {
         const Leap::Bone& bone = finger.bone(Leap::Bone::Type(boneIndex));
-
-        glColor3f(0.8f, 0.8f, 0.8f);
-        QuadricRenderer::render_cylinder(
-          selector.from_leap_position(bone.prevJoint()),
-          selector.from_leap_position(bone.nextJoint()),
-          LeapSelector::from_leap_size(bone.width() * 0.5f),
-          LeapSelector::from_leap_size(bone.width() * 0.5f),
-          10
-        );
-
-        glColor3f(1.0f, 0.0f, 0.0f);
-        QuadricRenderer::render_sphere(selector.from_leap_position(bone.nextJoint()), LeapSelector::from_leap_size(bone.width() * 0.7f), 10, 10);
+        boneStarts.push_back(selector.from_leap_position(bone.prevJoint()));
+        boneEnds.push_back(selector.from_leap_position(bone.nextJoint()));
+        boneRadii.push_back(LeapSelector::from_leap_size(bone.width() * 0.5f));
+        jointRadii.push_back(LeapSelector::from_leap_size(bone.width() * 0.7f));
       }
     }
 
+    glColor3f(0.8f, 0.8f, 0.8f);
+    QuadricRenderer::render_cylinders(*m_base->m_cylinderMesh, boneStarts, boneEnds, boneRadii);
+
+    glColor3f(1.0f, 0.0f, 0.0f);
+    QuadricRenderer::render_spheres(*m_base->m_sphereMesh, boneEnds, jointRadii);
+
     // If the selector is in point mode and the user is pointing at a valid voxel in the world,
     // draw a line between the tip of the virtual index finger and the voxel in question.
     if(selector.get_mode() == LeapSelector::MODE_POINT && selector.get_position())
@@ -109,7 +124,7 @@ public:
     boost::optional<Eigen::Vector3f> pickPoint = selector.get_position();
     if(!pickPoint) return;
 
-    render_orb(*pickPoint, m_selectionRadius * m_base->m_model->get_settings()->sceneParams.voxelSize);
+    render_orbs(std::vector<Eigen::Vector3f>(1, *pickPoint), m_selectionRadius * m_base->m_model->get_settings()->sceneParams.voxelSize);
   }
 
 #ifdef WITH_ARRAYFIRE
@@ -122,11 +137,7 @@ public:
     // Render the points at which the user is touching the scene.
     const int selectionRadius = 1;
     std::vector<Eigen::Vector3f> touchPoints = selector.get_positions();
-
-    for(size_t i = 0, size = touchPoints.size(); i < size; ++i)
-    {
-      render_orb(touchPoints[i], selectionRadius * m_base->m_model->get_settings()->sceneParams.voxelSize);
-    }
+    render_orbs(touchPoints, selectionRadius * m_base->m_model->get_settings()->sceneParams.voxelSize);
 
     // Render a rotating, coloured orb at the top-right of the viewport to indicate the current semantic label.
     const Vector2i& depthImageSize = m_base->m_model->get_slam_state(Model::get_world_scene_id())->get_depth_image_size();
@@ -147,7 +158,7 @@ public:
 
       glPushAttrib(GL_LINE_WIDTH);
       glLineWidth(2.0f);
-        render_orb(labelOrbPos, labelOrbRadius);
+        render_orbs(std::vector<Eigen::Vector3f>(1, labelOrbPos), labelOrbRadius);
       glPopAttrib();
     m_base->end_2d();
   }
@@ -159,19 +170,25 @@ public:
     m_selectionRadius = transformer.get_radius();
   }
 
+  /** Override */
+  virtual void visit(const VoxelToSurfaceSelectionTransformer& transformer) const
+  {
+    m_selectionRadius = transformer.get_radius();
+  }
+
   //~~~~~~~~~~~~~~~~~~~~ PRIVATE MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
 private:
   /**
-   * \brief Renders an orb with a colour denoting the current semantic label.
+   * \brief Renders a set of orbs with a colour denoting the current semantic label.
    *
-   * \param centre  The position of the centre of the orb.
-   * \param radius  The radius of the orb.
+   * \param centres The positions of the centres of the orbs.
+   * \param radius  The radius of each orb.
    */
-  void render_orb(const Eigen::Vector3f& centre, double radius) const
+  void render_orbs(const std::vector<Eigen::Vector3f>& centres, double radius) const
   {
     glColor3f(m_colour.r, m_colour.g, m_colour.b);
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    QuadricRenderer::render_sphere(centre, radius, 10, 10);
+    QuadricRenderer::render_spheres(*m_base->m_sphereMesh, centres, std::vector<float>(centres.size(), static_cast<float>(radius)));
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
   }
 };
@@ -179,11 +196,38 @@ private:
 //#################### CONSTRUCTORS ####################
 
 Renderer::Renderer(const Model_CPtr& model, const SubwindowConfiguration_Ptr& subwindowConfiguration, const Vector2i& windowViewportSize)
-: m_medianFilteringEnabled(true),
+: m_adaptiveRenderingFactor(1),
+  m_medianFilteringEnabled(true),
   m_model(model),
+  m_profilingOverlayEnabled(false),
   m_subwindowConfiguration(subwindowConfiguration),
+  m_useCUDAGLInterop(false),
+  m_useCompactSemanticTransport(false),
   m_windowViewportSize(windowViewportSize)
 {
+  // Determine whether or not to copy scene visualisations directly from the GPU into OpenGL. This is only possible
+  // in CUDA mode, and is disabled when debugging pixel values, since that relies on the images being on the CPU.
+  const Settings_CPtr& settings = m_model->get_settings();
+#if defined(WITH_CUDA) && !(WITH_GLUT && USE_PIXEL_DEBUGGING)
+  m_useCUDAGLInterop = settings->deviceType == ITMLibSettings::DEVICE_CUDA && settings->get_first_value<bool>("Renderer.useCUDAGLInterop", false);
+#endif
+
+  // Determine whether or not to send semantic visualisations to OpenGL in compact form, and look up their label colours in a fragment shader.
+  // As with CUDA-GL interop, this is disabled when debugging pixel values, since that relies on the images containing colours.
+#if !(WITH_GLUT && USE_PIXEL_DEBUGGING)
+  m_useCompactSemanticTransport = settings->get_first_value<bool>("Renderer.useCompactSemanticTransport", false);
+#endif
+
+  // Determine the factor (if any) by which to reduce the resolution at which free-camera sub-windows are rendered whilst their cameras are moving.
+  m_adaptiveRenderingFactor = settings->get_first_value<int>("Renderer.adaptiveRenderingFactor", 1);
+  if(m_adaptiveRenderingFactor < 1) throw std::runtime_error("Error: The adaptive rendering factor must be at least 1");
+
+#ifndef USE_LOW_POWER_MODE
+  // Set up the median filterer with which to postprocess the scene raycast (median filtering is disabled in low-power mode).
+  const unsigned int kernelWidth = 3;
+  m_medianFilterer = MedianFiltererFactory::make_median_filterer(kernelWidth, settings->deviceType);
+#endif
+
   // Reset the camera for each sub-window.
   for(size_t i = 0, subwindowCount = m_subwindowConfiguration->subwindow_count(); i < subwindowCount; ++i)
   {
@@ -199,9 +243,10 @@ Renderer::~Renderer() {}
 
 ITMUChar4Image_CPtr Renderer::capture_screenshot() const
 {
-  // Read the pixel data from video memory into an image.
+  // Read the pixel data from video memory into an image (leased from the memory block factory's pool, since we may be capturing every frame).
   const int width = m_windowViewportSize.width, height = m_windowViewportSize.height;
-  ITMUChar4Image_Ptr screenshotImage(new ITMUChar4Image(Vector2i(width, height), true, false));
+  const bool cpuOnly = true;
+  ITMUChar4Image_Ptr screenshotImage = itmx::MemoryBlockFactory::instance().make_pooled_image<Vector4u>(Vector2i(width, height), "Renderer.Screenshot", cpuOnly);
   Vector4u *pixelData = screenshotImage->GetData(MEMORYDEVICE_CPU);
   glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixelData);
 
@@ -218,17 +263,61 @@ ITMUChar4Image_CPtr Renderer::capture_screenshot() const
   return screenshotImage;
 }
 
+ITMUChar4Image_CPtr Renderer::capture_subwindow_image(size_t subwindowIndex) const
+{
+  const Subwindow& subwindow = m_subwindowConfiguration->subwindow(subwindowIndex);
+  const bool cpuOnly = true;
+
+  // If the image was sent to OpenGL as a compact semantic image, the sub-window's colour image will be stale, so expand the compact image instead.
+  const boost::optional<Subwindow::UpdateInfo>& lastUpdate = subwindow.get_last_update();
+  if(lastUpdate && lastUpdate->compactSemantic)
+  {
+    ITMUShortImage_CPtr compactImage = subwindow.get_compact_semantic_image();
+    if(uses_cuda_gl_interop(subwindow)) compactImage->UpdateHostFromDevice();
+
+    ITMUChar4Image_Ptr copy = itmx::MemoryBlockFactory::instance().make_pooled_image<Vector4u>(compactImage->noDims, "Renderer.SubwindowCapture", cpuOnly);
+    m_model->get_visualisation_generator()->expand_compact_semantic_image(compactImage, copy);
+    return copy;
+  }
+
+  ITMUChar4Image_CPtr image = subwindow.get_image();
+
+  // If the image was copied straight from the GPU into OpenGL, its CPU copy will be stale, so bring it up to date first.
+  if(uses_cuda_gl_interop(subwindow)) image->UpdateHostFromDevice();
+
+  // Copy the image (into an image leased from the memory block factory's pool, since we may be capturing every frame),
+  // so that the caller can hold onto it whilst the sub-window's own image is overwritten by subsequent frames.
+  ITMUChar4Image_Ptr copy = itmx::MemoryBlockFactory::instance().make_pooled_image<Vector4u>(image->noDims, "Renderer.SubwindowCapture", cpuOnly);
+  copy->SetFrom(image.get(), ITMUChar4Image::CPU_TO_CPU);
+  return copy;
+}
+
+ITMUChar4Image_CPtr Renderer::capture_video_frame() const
+{
+  return m_videoCapturer->capture(m_windowViewportSize);
+}
+
 Vector2f Renderer::compute_fractional_window_position(int x, int y) const
 {
   const Vector2f windowViewportSize = get_window_viewport_size().toFloat();
   return Vector2f(x / (windowViewportSize.x - 1), y / (windowViewportSize.y - 1));
 }
 
+ITMUChar4Image_CPtr Renderer::finish_video_capture() const
+{
+  return m_videoCapturer->finish();
+}
+
 bool Renderer::get_median_filtering_enabled() const
 {
   return m_medianFilteringEnabled;
 }
 
+bool Renderer::get_profiling_overlay_enabled() const
+{
+  return m_profilingOverlayEnabled;
+}
+
 const SubwindowConfiguration_Ptr& Renderer::get_subwindow_configuration()
 {
   return m_subwindowConfiguration;
@@ -244,6 +333,11 @@ void Renderer::set_median_filtering_enabled(bool medianFilteringEnabled)
   m_medianFilteringEnabled = medianFilteringEnabled;
 }
 
+void Renderer::set_profiling_overlay_enabled(bool profilingOverlayEnabled)
+{
+  m_profilingOverlayEnabled = profilingOverlayEnabled;
+}
+
 //#################### PROTECTED MEMBER FUNCTIONS ####################
 
 void Renderer::begin_2d()
@@ -262,9 +356,27 @@ void Renderer::begin_2d()
   glDepthMask(false);
 }
 
+void Renderer::clear_voxel_raycast_cache() const
+{
+  m_voxelRaycastCache.clear();
+}
+
 void Renderer::destroy_common()
 {
   glDeleteTextures(1, &m_textureID);
+  if(!m_subwindowTextureIDs.empty()) glDeleteTextures(static_cast<GLsizei>(m_subwindowTextureIDs.size()), &m_subwindowTextureIDs[0]);
+  m_subwindowTextureIDs.clear();
+  m_videoCapturer.reset();
+
+  m_cameraAxesMesh.reset();
+  m_cylinderMesh.reset();
+  m_semanticPaletteShader.reset();
+  m_sphereMesh.reset();
+
+#ifdef WITH_CUDA
+  m_featureInspectionInteropTexture.reset();
+  m_subwindowInteropTextures.clear();
+#endif
 }
 
 void Renderer::end_2d()
@@ -295,12 +407,108 @@ const Vector2i& Renderer::get_window_viewport_size() const
 
 void Renderer::initialise_common()
 {
-  // Set up a texture in which to temporarily store scene visualisations and the touch image when rendering.
+  // Set up a texture in which to temporarily store overlays (e.g. the touch image) when rendering.
   glGenTextures(1, &m_textureID);
+
+  // Set up a texture for each sub-window in which to store its image. Since any textures that contained the sub-windows'
+  // images before (e.g. those of a previous renderer) no longer exist, make sure that the images are regenerated.
+  const size_t subwindowCount = m_subwindowConfiguration->subwindow_count();
+  m_subwindowTextureIDs.resize(subwindowCount);
+  if(subwindowCount > 0) glGenTextures(static_cast<GLsizei>(subwindowCount), &m_subwindowTextureIDs[0]);
+  for(size_t i = 0; i < subwindowCount; ++i)
+  {
+    m_subwindowConfiguration->subwindow(i).reset_last_update();
+  }
+
+  // Set up the pixel buffer objects used to capture the frames of videos.
+  m_videoCapturer.reset(new AsyncScreenCapturer);
+
+  // Set up the cached meshes used to render cameras, selectors and the Leap hand. Since these live in buffer
+  // objects belonging to the OpenGL context, they must be created (and destroyed) along with it.
+  m_cameraAxesMesh = CameraRenderer::make_axes_mesh(CameraRenderer::AXES_XYZ);
+  m_cylinderMesh = QuadricRenderer::make_cylinder_mesh(10);
+  m_sphereMesh = QuadricRenderer::make_sphere_mesh(10, 10);
+
+  // If we're sending semantic visualisations to OpenGL in compact form, set up the shader used to look up their label colours.
+  // Like the meshes, this belongs to the OpenGL context. If shaders are not supported, fall back to sending colour images.
+  if(m_useCompactSemanticTransport)
+  {
+#ifdef WITH_GLEW
+    if(!GLEW_VERSION_2_0)
+    {
+      std::cerr << "Warning: Cannot send semantic visualisations to OpenGL in compact form, since shaders are not supported\n";
+    }
+    else
+#endif
+    {
+      m_semanticPaletteShader.reset(new SemanticPaletteShader(m_model->get_label_manager()->get_max_label_count()));
+    }
+  }
+
+  // If we're copying scene visualisations directly from the GPU, also set up a texture for each sub-window that is registered with CUDA.
+#ifdef WITH_CUDA
+  if(m_useCUDAGLInterop)
+  {
+    m_featureInspectionInteropTexture.reset(new InteropTexture);
+    m_subwindowInteropTextures.resize(subwindowCount);
+    for(size_t i = 0; i < subwindowCount; ++i)
+    {
+      m_subwindowInteropTextures[i].reset(new InteropTexture);
+    }
+  }
+#endif
+}
+
+void Renderer::prepare_stereo_voxel_raycasts(const std::string& leftCameraName, const std::string& rightCameraName) const
+{
+  clear_voxel_raycast_cache();
+
+  for(size_t subwindowIndex = 0, count = m_subwindowConfiguration->subwindow_count(); subwindowIndex < count; ++subwindowIndex)
+  {
+    Subwindow& subwindow = m_subwindowConfiguration->subwindow(subwindowIndex);
+
+    // If the sub-window does not show a voxel visualisation of a scene whose reconstruction has started, skip it.
+    const std::string& sceneID = subwindow.get_scene_id();
+    SLAMState_CPtr slamState = m_model->get_slam_state(sceneID);
+    if(!slamState->get_view() || !shows_voxel_scene(subwindow)) continue;
+
+    // Determine the poses of the two eyes. If there is already a raycast that can be reused for either of them,
+    // skip the sub-window (each eye will then be handled normally when the sub-window is rendered).
+    const SE3Pose leftPose = compute_render_pose(subwindow, leftCameraName);
+    const SE3Pose rightPose = compute_render_pose(subwindow, rightCameraName);
+    if(has_up_to_date_voxel_raycast(subwindow, 0, leftPose) || has_up_to_date_voxel_raycast(subwindow, 1, rightPose) ||
+       find_cached_voxel_raycast(sceneID, leftPose) || find_cached_voxel_raycast(sceneID, rightPose))
+    {
+      continue;
+    }
+
+    // Raycast the scene from both eyes in a single pass, at full resolution.
+    const SpaintVoxelScene_CPtr voxelScene = slamState->get_voxel_scene();
+    const View_CPtr view = slamState->get_view();
+    use_voxel_render_state_of_size(subwindow, 0, view->depth->noDims, voxelScene);
+    use_voxel_render_state_of_size(subwindow, 1, view->depth->noDims, voxelScene);
+    m_model->get_visualisation_generator()->raycast_voxel_scene_stereo(
+      voxelScene, leftPose, rightPose, view, subwindow.get_voxel_render_state(0), subwindow.get_voxel_render_state(1)
+    );
+
+    // Cache the raycasts so that they will be shaded (rather than recomputed) when the eyes are rendered.
+    const SE3Pose poses[] = { leftPose, rightPose };
+    for(int viewIndex = 0; viewIndex < 2; ++viewIndex)
+    {
+      CachedVoxelRaycast cachedRaycast;
+      cachedRaycast.pose = poses[viewIndex];
+      cachedRaycast.renderState = subwindow.get_voxel_render_state(viewIndex);
+      cachedRaycast.sceneID = sceneID;
+      m_voxelRaycastCache.push_back(cachedRaycast);
+    }
+  }
 }
 
 void Renderer::render_scene(const Vector2f& fracWindowPos, bool renderFiducials, int viewIndex, const std::string& secondaryCameraName) const
 {
+  const bool timeGPU = m_model->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA;
+  ProfilingScope profilingScope("Renderer.RenderScene", timeGPU);
+
   // Set the viewport for the window.
   const Vector2i& windowViewportSize = get_window_viewport_size();
   glViewport(0, 0, windowViewportSize.width, windowViewportSize.height);
@@ -325,26 +533,34 @@ void Renderer::render_scene(const Vector2f& fracWindowPos, bool renderFiducials,
     int height = (int)ROUND(subwindow.height() * windowViewportSize.height);
     glViewport(left, top, width, height);
 
-    // If the sub-window is in follow mode, update its camera.
-    if(subwindow.get_camera_mode() == Subwindow::CM_FOLLOW)
-    {
-      ORUtils::SE3Pose livePose = m_model->get_slam_state(subwindow.get_scene_id())->get_pose();
-      subwindow.get_camera()->set_from(CameraPoseConverter::pose_to_camera(livePose));
-    }
-
     // Determine the pose from which to render.
-    Camera_CPtr camera = secondaryCameraName == "" ? subwindow.get_camera() : subwindow.get_camera()->get_secondary_camera(secondaryCameraName);
-    ORUtils::SE3Pose pose = CameraPoseConverter::camera_to_pose(*camera);
+    ORUtils::SE3Pose pose = compute_render_pose(subwindow, secondaryCameraName);
 
     // Render the reconstructed scene, then render a synthetic scene over the top of it.
-    render_reconstructed_scene(sceneID, pose, subwindow, viewIndex);
+    {
+      ProfilingScope subwindowScope("Renderer.RenderReconstructedScene", timeGPU);
+      render_reconstructed_scene(sceneID, pose, subwindow, subwindowIndex, viewIndex);
+    }
     render_synthetic_scene(sceneID, pose, subwindow.get_camera_mode(), renderFiducials);
 
+    // If the features of a voxel in the sub-window's scene are being inspected, render the feature inspection image over the top.
+    const ITMUChar4Image_CPtr featureInspectionImage = m_model->get_feature_inspection_image(sceneID);
+    if(featureInspectionImage) render_feature_inspection_overlay(featureInspectionImage, width, height);
+
 #if WITH_GLUT && USE_PIXEL_DEBUGGING
     // Render the value of the pixel to which the user is pointing (for debugging purposes).
     render_pixel_value(fracWindowPos, subwindow);
 #endif
   }
+
+#ifdef WITH_GLUT
+  // If requested, render the profiler's timings over the top of the whole window.
+  if(m_profilingOverlayEnabled)
+  {
+    glViewport(0, 0, windowViewportSize.width, windowViewportSize.height);
+    render_profiling_overlay();
+  }
+#endif
 }
 
 void Renderer::set_window(const SDL_Window_Ptr& window)
@@ -366,10 +582,49 @@ void Renderer::set_window(const SDL_Window_Ptr& window)
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+SE3Pose Renderer::compute_render_pose(Subwindow& subwindow, const std::string& secondaryCameraName) const
+{
+  // If the sub-window is in follow mode, update its camera.
+  if(subwindow.get_camera_mode() == Subwindow::CM_FOLLOW)
+  {
+    ORUtils::SE3Pose livePose = m_model->get_slam_state(subwindow.get_scene_id())->get_pose();
+    subwindow.get_camera()->set_from(CameraPoseConverter::pose_to_camera(livePose));
+  }
+
+  // Determine the pose from which to render.
+  Camera_CPtr camera = secondaryCameraName == "" ? subwindow.get_camera() : subwindow.get_camera()->get_secondary_camera(secondaryCameraName);
+  return CameraPoseConverter::camera_to_pose(*camera);
+}
+
+VoxelRenderState_CPtr Renderer::find_cached_voxel_raycast(const std::string& sceneID, const SE3Pose& pose) const
+{
+  // Look for a raycast of the scene from the same pose that has already been computed for another sub-window.
+  for(size_t i = 0, size = m_voxelRaycastCache.size(); i < size; ++i)
+  {
+    const CachedVoxelRaycast& cachedRaycast = m_voxelRaycastCache[i];
+    if(cachedRaycast.sceneID == sceneID && poses_match(cachedRaycast.pose, pose)) return cachedRaycast.renderState;
+  }
+
+  // Failing that, check whether the raycast that was computed from the live camera pose to prepare for tracking can be used.
+  SLAMState_CPtr slamState = m_model->get_slam_state(sceneID);
+  const boost::optional<SE3Pose>& liveVoxelRaycastPose = slamState->get_live_voxel_raycast_pose();
+  if(liveVoxelRaycastPose && poses_match(*liveVoxelRaycastPose, pose))
+  {
+    CachedVoxelRaycast cachedRaycast;
+    cachedRaycast.pose = *liveVoxelRaycastPose;
+    cachedRaycast.renderState = slamState->get_live_voxel_render_state();
+    cachedRaycast.sceneID = sceneID;
+    m_voxelRaycastCache.push_back(cachedRaycast);
+    return cachedRaycast.renderState;
+  }
+
+  return VoxelRenderState_CPtr();
+}
+
 void Renderer::generate_visualisation(const ITMUChar4Image_Ptr& output, const SpaintVoxelScene_CPtr& voxelScene, const SpaintSurfelScene_CPtr& surfelScene,
-                                      VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState, const ORUtils::SE3Pose& pose, const View_CPtr& view,
-                                      VisualisationGenerator::VisualisationType visualisationType, bool surfelFlag,
-                                      const boost::optional<VisualisationGenerator::Postprocessor>& postprocessor) const
+                                      VoxelRenderState_Ptr& voxelRenderState, const VoxelRenderState_CPtr& cachedVoxelRaycast, SurfelRenderState_Ptr& surfelRenderState,
+                                      const ORUtils::SE3Pose& pose, const View_CPtr& view, VisualisationGenerator::VisualisationType visualisationType, bool surfelFlag,
+                                      const boost::optional<VisualisationGenerator::Postprocessor>& postprocessor, bool copyToHost) const
 {
   VisualisationGenerator_CPtr visualisationGenerator = m_model->get_visualisation_generator();
 
@@ -382,12 +637,123 @@ void Renderer::generate_visualisation(const ITMUChar4Image_Ptr& output, const Sp
       visualisationGenerator->get_depth_input(output, view);
       break;
     default:
-      if(surfelFlag) visualisationGenerator->generate_surfel_visualisation(output, surfelScene, pose, view, surfelRenderState, visualisationType);
-      else visualisationGenerator->generate_voxel_visualisation(output, voxelScene, pose, view, voxelRenderState, visualisationType, postprocessor);
+      if(surfelFlag) visualisationGenerator->generate_surfel_visualisation(output, surfelScene, pose, view, surfelRenderState, visualisationType, copyToHost);
+      else if(voxelScene)
+      {
+        // Raycast the scene (reusing an existing raycast from the same pose if possible), and then shade the raycast.
+        visualisationGenerator->raycast_voxel_scene(voxelScene, pose, view, voxelRenderState, cachedVoxelRaycast);
+        visualisationGenerator->shade_voxel_raycast(output, voxelScene, pose, view, voxelRenderState, visualisationType, postprocessor, copyToHost);
+      }
+      else output->Clear();
       break;
   }
 }
 
+GLuint Renderer::get_subwindow_texture_id(size_t subwindowIndex, bool useInterop) const
+{
+#ifdef WITH_CUDA
+  if(useInterop) return m_subwindowInteropTextures[subwindowIndex]->get_id();
+#endif
+  return m_subwindowTextureIDs[subwindowIndex];
+}
+
+bool Renderer::has_up_to_date_voxel_raycast(Subwindow& subwindow, int viewIndex, const SE3Pose& pose) const
+{
+  const boost::optional<Subwindow::VoxelRaycastInfo>& lastVoxelRaycast = subwindow.get_last_voxel_raycast(viewIndex);
+  const VoxelRenderState_Ptr& renderState = subwindow.get_voxel_render_state(viewIndex);
+  SLAMState_CPtr slamState = m_model->get_slam_state(subwindow.get_scene_id());
+
+  return lastVoxelRaycast && poses_match(lastVoxelRaycast->pose, pose) &&
+         lastVoxelRaycast->sceneVersion == slamState->get_voxel_scene_version() &&
+         renderState && renderState->raycastResult->noDims == slamState->get_view()->depth->noDims;
+}
+
+bool Renderer::needs_update(const Subwindow& subwindow, const Subwindow::UpdateInfo& updateInfo) const
+{
+  // If the sub-window's texture does not contain a complete image of the right kind for the view being rendered, it must be regenerated
+  // (note that this is always the case when several views are rendered into the same sub-window, e.g. one for each eye of a headset).
+  const boost::optional<Subwindow::UpdateInfo>& lastUpdate = subwindow.get_last_update();
+  if(!lastUpdate || !lastUpdate->complete || lastUpdate->viewIndex != updateInfo.viewIndex || lastUpdate->type != updateInfo.type ||
+     lastUpdate->surfelFlag != updateInfo.surfelFlag || lastUpdate->medianFiltered != updateInfo.medianFiltered ||
+     lastUpdate->compactSemantic != updateInfo.compactSemantic)
+  {
+    return true;
+  }
+
+  switch(subwindow.get_update_policy())
+  {
+    case Subwindow::UP_EVERY_N_FRAMES:
+      return subwindow.get_frames_since_last_update() + 1 >= subwindow.get_update_interval();
+    case Subwindow::UP_ON_CHANGE:
+      // The input visualisations only change when a new input frame arrives, whereas the scene visualisations change
+      // whenever the camera moves or the scene changes.
+      if(updateInfo.type == VisualisationGenerator::VT_INPUT_COLOUR || updateInfo.type == VisualisationGenerator::VT_INPUT_DEPTH)
+      {
+        return updateInfo.inputTime != lastUpdate->inputTime;
+      }
+
+      return !poses_match(lastUpdate->pose, updateInfo.pose) ||
+             lastUpdate->voxelSceneVersion != updateInfo.voxelSceneVersion ||
+             lastUpdate->voxelVersion != updateInfo.voxelVersion;
+    default:
+      return true;
+  }
+}
+
+bool Renderer::poses_match(const SE3Pose& lhs, const SE3Pose& rhs)
+{
+  // Note: The poses of sub-windows in follow mode are converted to cameras and back, so we allow for a small amount of rounding error.
+  const float tolerance = 1e-5f;
+  const Matrix4f& lhsM = lhs.GetM();
+  const Matrix4f& rhsM = rhs.GetM();
+  for(int i = 0; i < 16; ++i)
+  {
+    if(fabs(lhsM.m[i] - rhsM.m[i]) > tolerance) return false;
+  }
+  return true;
+}
+
+void Renderer::render_feature_inspection_overlay(const ITMUChar4Image_CPtr& featureInspectionImage, int subwindowWidth, int subwindowHeight) const
+{
+  // Copy the feature inspection image to a texture. If CUDA-GL interop is enabled, this can be done directly on the GPU.
+  // Otherwise, if the image is on the GPU, we copy it into a persistent CPU image first (this is cheap, since it is tiny).
+  GLuint textureID = m_textureID;
+#ifdef WITH_CUDA
+  if(m_useCUDAGLInterop)
+  {
+    m_featureInspectionInteropTexture->upload(featureInspectionImage.get());
+    textureID = m_featureInspectionInteropTexture->get_id();
+    glBindTexture(GL_TEXTURE_2D, textureID);
+  }
+  else
+#endif
+  {
+    const Vector4u *pixelData = featureInspectionImage->GetData(MEMORYDEVICE_CPU);
+#ifdef WITH_CUDA
+    if(m_model->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA)
+    {
+      if(!m_featureInspectionHostImage) m_featureInspectionHostImage.reset(new ITMUChar4Image(featureInspectionImage->noDims, true, false));
+      m_featureInspectionHostImage->SetFrom(featureInspectionImage.get(), ITMUChar4Image::CUDA_TO_CPU);
+      pixelData = m_featureInspectionHostImage->GetData(MEMORYDEVICE_CPU);
+    }
+#endif
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, featureInspectionImage->noDims.x, featureInspectionImage->noDims.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixelData);
+  }
+
+  // Use nearest-neighbour filtering, so that the individual pixels of the (heavily magnified) patch remain distinct.
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+  // Render a quad textured with the image in a square occupying the top-left corner of the sub-window.
+  const double sizeFraction = 0.25;
+  begin_2d();
+    glScaled(sizeFraction * subwindowHeight / subwindowWidth, sizeFraction, 1.0);
+    render_textured_quad(textureID);
+  end_2d();
+}
+
 void Renderer::render_overlay(const ITMUChar4Image_CPtr& overlay) const
 {
   // Copy the overlay to a texture.
@@ -409,6 +775,57 @@ void Renderer::render_overlay(const ITMUChar4Image_CPtr& overlay) const
   glDisable(GL_BLEND);
 }
 
+#ifdef WITH_GLUT
+void Renderer::render_profiling_overlay() const
+{
+  const Profiler& profiler = Profiler::instance();
+  const std::vector<Profiler::StageStats> stats = profiler.get_stage_stats();
+
+  begin_2d();
+
+  if(!profiler.is_enabled())
+  {
+    render_text("Profiling disabled (set Profiler.enabled to true)", Vector3f(1.0f, 1.0f, 0.0f), Vector2f(0.025f, 0.05f), GLUT_BITMAP_HELVETICA_12);
+  }
+
+  // Render one line of text per stage, in the order in which the stages were first timed.
+  const float lineHeight = 0.025f;
+  for(size_t i = 0, size = stats.size(); i < size; ++i)
+  {
+    std::ostringstream oss;
+    oss << stats[i];
+    const Vector3f colour = stats[i].device == Profiler::DEVICE_GPU ? Vector3f(0.0f, 1.0f, 0.0f) : Vector3f(1.0f, 1.0f, 1.0f);
+    render_text(oss.str(), colour, Vector2f(0.025f, 0.05f + (i + 1) * lineHeight), GLUT_BITMAP_HELVETICA_12);
+  }
+
+  // Render the memory occupied by the memory blocks made by the memory block factory, in total and for the largest consumers.
+  const itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
+  std::vector<itmx::MemoryBlockFactory::MemoryUsage> usages = mbf.get_memory_usage();
+  const size_t maxUsageCount = 5;
+  if(usages.size() > maxUsageCount) usages.resize(maxUsageCount);
+  usages.insert(usages.begin(), mbf.get_total_memory_usage());
+
+  for(size_t i = 0, size = usages.size(); i < size; ++i)
+  {
+    std::ostringstream oss;
+    oss << usages[i];
+    render_text(oss.str(), Vector3f(0.0f, 1.0f, 1.0f), Vector2f(0.025f, 0.05f + (stats.size() + i + 2) * lineHeight), GLUT_BITMAP_HELVETICA_12);
+  }
+
+  // Render the current values of any gauges (e.g. the work budgets chosen by adaptive components).
+  const std::vector<std::pair<std::string,double> > gauges = profiler.get_gauges();
+  const size_t firstGaugeLine = stats.size() + usages.size() + 3;
+  for(size_t i = 0, size = gauges.size(); i < size; ++i)
+  {
+    std::ostringstream oss;
+    oss << gauges[i].first << ": " << gauges[i].second;
+    render_text(oss.str(), Vector3f(1.0f, 0.5f, 0.0f), Vector2f(0.025f, 0.05f + (firstGaugeLine + i) * lineHeight), GLUT_BITMAP_HELVETICA_12);
+  }
+
+  end_2d();
+}
+#endif
+
 #if WITH_GLUT && USE_PIXEL_DEBUGGING
 void Renderer::render_pixel_value(const Vector2f& fracWindowPos, const Subwindow& subwindow) const
 {
@@ -429,41 +846,42 @@ void Renderer::render_pixel_value(const Vector2f& fracWindowPos, const Subwindow
 }
 #endif
 
-void Renderer::render_reconstructed_scene(const std::string& sceneID, const SE3Pose& pose, Subwindow& subwindow, int viewIndex) const
+void Renderer::render_reconstructed_scene(const std::string& sceneID, const SE3Pose& pose, Subwindow& subwindow, size_t subwindowIndex, int viewIndex) const
 {
-  // Set up any post-processing that needs to be applied to the rendering result.
-  // FIXME: At present, median filtering breaks in CPU mode, so we prevent it from running, but we should investigate why.
-  static boost::optional<VisualisationGenerator::Postprocessor> postprocessor = boost::none;
-  if(!m_medianFilteringEnabled && postprocessor)
-  {
-    postprocessor.reset();
-  }
-  else if(m_medianFilteringEnabled && !postprocessor && m_model->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA)
+  // Record the circumstances in which the sub-window's image would be regenerated.
+  SLAMState_CPtr slamState = m_model->get_slam_state(sceneID);
+  SpaintVoxelScene_CPtr voxelScene = slamState->get_voxel_scene();
+  Subwindow::UpdateInfo updateInfo;
+  updateInfo.compactSemantic = uses_compact_semantic_transport(subwindow);
+  updateInfo.complete = true;
+  updateInfo.inputTime = slamState->get_input_timestamps().hostReceiveTime;
+  updateInfo.medianFiltered = m_medianFilteringEnabled && m_medianFilterer;
+  updateInfo.pose = pose;
+  updateInfo.surfelFlag = subwindow.get_surfel_flag();
+  updateInfo.type = subwindow.get_type();
+  updateInfo.viewIndex = viewIndex;
+  updateInfo.voxelSceneVersion = slamState->get_voxel_scene_version();
+  updateInfo.voxelVersion = voxelScene ? voxelScene->get_version() : 0;
+
+  // Regenerate the sub-window's image if its update policy requires it (otherwise, its texture still contains the image from its last update).
+  if(needs_update(subwindow, updateInfo))
   {
-#if defined(WITH_ARRAYFIRE) && !defined(USE_LOW_POWER_MODE)
-    const unsigned int kernelWidth = 3;
-    postprocessor = MedianFilterer(kernelWidth, m_model->get_settings()->deviceType);
-#endif
+    updateInfo.complete = update_subwindow_texture(sceneID, pose, subwindow, subwindowIndex, viewIndex);
+    subwindow.set_last_update(updateInfo);
   }
+  else subwindow.skip_update();
 
-  // Generate the subwindow image.
-  const ITMUChar4Image_Ptr& image = subwindow.get_image();
-  SLAMState_CPtr slamState = m_model->get_slam_state(sceneID);
-  generate_visualisation(
-    image, slamState->get_voxel_scene(), slamState->get_surfel_scene(),
-    subwindow.get_voxel_render_state(viewIndex), subwindow.get_surfel_render_state(viewIndex),
-    pose, slamState->get_view(), subwindow.get_type(), subwindow.get_surfel_flag(), postprocessor
-  );
-
-  // Copy the raycasted scene to a texture.
-  glBindTexture(GL_TEXTURE_2D, m_textureID);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->noDims.x, image->noDims.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image->GetData(MEMORYDEVICE_CPU));
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-  // Render a quad textured with the subwindow image.
+  // Render a quad textured with the subwindow image. If the image is a compact semantic one, look up its label colours as it is drawn
+  // (since the colours are only applied here, any changes to them are visible immediately, without regenerating the image).
+  const GLuint textureID = get_subwindow_texture_id(subwindowIndex, uses_cuda_gl_interop(subwindow));
   begin_2d();
-    render_textured_quad(m_textureID);
+  if(updateInfo.compactSemantic)
+  {
+    m_semanticPaletteShader->bind(m_model->get_label_manager()->get_label_colours());
+    render_textured_quad(textureID);
+    m_semanticPaletteShader->unbind();
+  }
+  else render_textured_quad(textureID);
   end_2d();
 }
 
@@ -487,7 +905,7 @@ void Renderer::render_synthetic_scene(const std::string& sceneID, const SE3Pose&
 
       // Render the default camera.
       static SimpleCamera defaultCam = *CameraFactory::make_default_camera();
-      CameraRenderer::render_camera(defaultCam);
+      CameraRenderer::render_cameras(std::vector<SimpleCamera>(1, defaultCam), *m_cameraAxesMesh);
 
       // Render the current selector to show how we're interacting with the scene.
       Vector3u labelColour = m_model->get_label_manager()->get_label_colour(m_model->get_semantic_label());
@@ -497,19 +915,23 @@ void Renderer::render_synthetic_scene(const std::string& sceneID, const SE3Pose&
       if(transformer) transformer->accept(selectorRenderer);
       m_model->get_selector()->accept(selectorRenderer);
 
-      // If we're rendering fiducials, render any that have been detected.
+      // If we're rendering fiducials, render any that have been detected (all at once, so that the meshes are only bound once).
       if(renderFiducials)
       {
+        std::vector<SimpleCamera> fiducialCams;
+        std::vector<Vector3f> fiducialColours;
         const std::map<std::string,Fiducial_Ptr>& fiducials = slamState->get_fiducials();
         for(std::map<std::string,Fiducial_Ptr>::const_iterator it = fiducials.begin(), iend = fiducials.end(); it != iend; ++it)
         {
           float confidence = it->second->confidence();
           if(confidence < Fiducial::stable_confidence()) continue;
 
-          SimpleCamera cam = CameraPoseConverter::pose_to_camera(it->second->pose());
+          fiducialCams.push_back(CameraPoseConverter::pose_to_camera(it->second->pose()));
           float c = CLAMP(confidence / Fiducial::stable_confidence(), 0.0f, 1.0f);
-          CameraRenderer::render_camera(cam, CameraRenderer::AXES_XYZ, 0.1f, Vector3f(c, c, 0.0f));
+          fiducialColours.push_back(Vector3f(c, c, 0.0f));
         }
+
+        CameraRenderer::render_cameras(fiducialCams, *m_cameraAxesMesh, 0.1f, m_sphereMesh, fiducialColours);
       }
 
       // If the camera for the subwindow is in follow mode, render any overlay image generated during object segmentation.
@@ -573,3 +995,174 @@ void Renderer::set_projection_matrix(const ITMIntrinsics& intrinsics, int width,
   glLoadIdentity();
   glFrustum(leftVal, rightVal, bottomVal, topVal, nearVal, farVal);
 }
+
+bool Renderer::shows_voxel_scene(const Subwindow& subwindow) const
+{
+  const VisualisationGenerator::VisualisationType type = subwindow.get_type();
+  return m_model->get_slam_state(subwindow.get_scene_id())->get_voxel_scene() && !subwindow.get_surfel_flag() &&
+         type != VisualisationGenerator::VT_INPUT_COLOUR && type != VisualisationGenerator::VT_INPUT_DEPTH;
+}
+
+bool Renderer::update_subwindow_texture(const std::string& sceneID, const SE3Pose& pose, Subwindow& subwindow, size_t subwindowIndex, int viewIndex) const
+{
+  // Set up any post-processing that needs to be applied to the rendering result.
+  boost::optional<VisualisationGenerator::Postprocessor> postprocessor;
+  if(m_medianFilteringEnabled && m_medianFilterer)
+  {
+    postprocessor = boost::bind(&MedianFilterer::operator(), m_medianFilterer, _1, _2);
+  }
+
+  // Determine whether the subwindow image can be copied directly from the GPU into OpenGL, and whether it should be sent in compact form.
+  const VisualisationGenerator::VisualisationType visualisationType = subwindow.get_type();
+  const bool useInterop = uses_cuda_gl_interop(subwindow);
+  const bool useCompactTransport = uses_compact_semantic_transport(subwindow);
+
+  // If the subwindow shows a voxel visualisation of the scene, decide whether an existing raycast of the scene can be reused,
+  // and at what resolution to raycast the scene if not.
+  SLAMState_CPtr slamState = m_model->get_slam_state(sceneID);
+  const bool isVoxelSceneVisualisation = shows_voxel_scene(subwindow);
+  const size_t voxelSceneVersion = slamState->get_voxel_scene_version();
+  VoxelRenderState_Ptr& voxelRenderState = subwindow.get_voxel_render_state(viewIndex);
+  boost::optional<Subwindow::VoxelRaycastInfo>& lastVoxelRaycast = subwindow.get_last_voxel_raycast(viewIndex);
+  VoxelRenderState_CPtr cachedVoxelRaycast;
+  bool foundCachedVoxelRaycast = false;
+
+  if(isVoxelSceneVisualisation)
+  {
+    const Vector2i& fullSize = slamState->get_view()->depth->noDims;
+    Vector2i raycastSize = fullSize;
+
+    // First, look for a raycast of the scene from the same pose that has already been computed during the current frame.
+    cachedVoxelRaycast = find_cached_voxel_raycast(sceneID, pose);
+    foundCachedVoxelRaycast = cachedVoxelRaycast.get() != NULL;
+
+    // Failing that, if the sub-window has a free camera, check whether the camera has moved since the scene was last raycast for it.
+    if(!foundCachedVoxelRaycast && subwindow.get_camera_mode() == Subwindow::CM_FREE)
+    {
+      const bool cameraMoved = !lastVoxelRaycast || !poses_match(lastVoxelRaycast->pose, pose);
+      if(cameraMoved)
+      {
+        // If the camera is moving, render the scene at a reduced resolution if adaptive rendering is enabled.
+        raycastSize = fullSize / m_adaptiveRenderingFactor;
+      }
+      else if(has_up_to_date_voxel_raycast(subwindow, viewIndex, pose))
+      {
+        // If the camera is still and the existing full-resolution raycast is up to date, it just needs to be shaded again
+        // (the shading reads the voxels afresh, so any changes to their labels will still be visible).
+        cachedVoxelRaycast = voxelRenderState;
+      }
+    }
+
+    if(!cachedVoxelRaycast || foundCachedVoxelRaycast) use_voxel_render_state_of_size(subwindow, viewIndex, raycastSize, slamState->get_voxel_scene());
+  }
+
+  // Generate the subwindow image (as a compact semantic image, if appropriate, in which case the raycast is shaded directly into it).
+  const ITMUChar4Image_Ptr& image = subwindow.get_image();
+  if(useCompactTransport)
+  {
+    VisualisationGenerator_CPtr visualisationGenerator = m_model->get_visualisation_generator();
+    visualisationGenerator->raycast_voxel_scene(slamState->get_voxel_scene(), pose, slamState->get_view(), voxelRenderState, cachedVoxelRaycast);
+    visualisationGenerator->shade_voxel_raycast_compact(
+      subwindow.get_compact_semantic_image(), slamState->get_voxel_scene(), pose, voxelRenderState, visualisationType, !useInterop
+    );
+  }
+  else
+  {
+    generate_visualisation(
+      image, slamState->get_voxel_scene(), slamState->get_surfel_scene(),
+      voxelRenderState, cachedVoxelRaycast, subwindow.get_surfel_render_state(viewIndex),
+      pose, slamState->get_view(), visualisationType, subwindow.get_surfel_flag(), postprocessor, !useInterop
+    );
+  }
+
+  if(isVoxelSceneVisualisation && voxelRenderState)
+  {
+    // Record the circumstances in which the scene was raycast for the subwindow.
+    Subwindow::VoxelRaycastInfo raycastInfo;
+    raycastInfo.pose = pose;
+    raycastInfo.sceneVersion = voxelSceneVersion;
+    lastVoxelRaycast = raycastInfo;
+
+    // If the raycast is at full resolution and was not already in the cache, add it, so that any other
+    // subwindows rendering the scene from the same pose during the current frame can reuse it.
+    if(!foundCachedVoxelRaycast && voxelRenderState->raycastResult->noDims == slamState->get_view()->depth->noDims)
+    {
+      CachedVoxelRaycast cachedRaycast;
+      cachedRaycast.pose = pose;
+      cachedRaycast.renderState = voxelRenderState;
+      cachedRaycast.sceneID = sceneID;
+      m_voxelRaycastCache.push_back(cachedRaycast);
+    }
+  }
+
+  // Copy the generated image to the sub-window's texture.
+  const GLuint textureID = get_subwindow_texture_id(subwindowIndex, useInterop);
+#ifdef WITH_CUDA
+  if(useInterop)
+  {
+    if(useCompactTransport) m_subwindowInteropTextures[subwindowIndex]->upload(subwindow.get_compact_semantic_image().get());
+    else m_subwindowInteropTextures[subwindowIndex]->upload(image.get());
+  }
+  else
+#endif
+  {
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    if(useCompactTransport)
+    {
+      // Upload the labels into the luminance channel and the intensities into the alpha channel (see spaint::pack_compact_semantic_pixel).
+      // Note that the rows of a compact image need not be a multiple of four bytes long, and that its labels must not be interpolated.
+      const ITMUShortImage_Ptr& compactImage = subwindow.get_compact_semantic_image();
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+      glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_LUMINANCE8_ALPHA8, compactImage->noDims.x, compactImage->noDims.y, 0,
+        GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, compactImage->GetData(MEMORYDEVICE_CPU)
+      );
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    }
+    else
+    {
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->noDims.x, image->noDims.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image->GetData(MEMORYDEVICE_CPU));
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    }
+  }
+
+  // Note: Only voxel visualisations can be rendered at a reduced resolution.
+  return !isVoxelSceneVisualisation || !voxelRenderState || voxelRenderState->raycastResult->noDims == slamState->get_view()->depth->noDims;
+}
+
+void Renderer::use_voxel_render_state_of_size(Subwindow& subwindow, int viewIndex, const Vector2i& size, const SpaintVoxelScene_CPtr& voxelScene) const
+{
+  VoxelRenderState_Ptr& renderState = subwindow.get_voxel_render_state(viewIndex);
+  if(renderState && renderState->raycastResult->noDims == size) return;
+
+  // Swap the current voxel render state with the spare one, since that may well be of the right size (e.g. if
+  // the sub-window is switching back from rendering at a reduced resolution). If not, create a new one.
+  VoxelRenderState_Ptr& spareRenderState = subwindow.get_spare_voxel_render_state(viewIndex);
+  std::swap(renderState, spareRenderState);
+  if(!renderState || renderState->raycastResult->noDims != size)
+  {
+    renderState.reset(ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(size, voxelScene->sceneParams, m_model->get_settings()->GetMemoryType()));
+  }
+
+  // The new render state does not contain a raycast for the sub-window yet.
+  subwindow.get_last_voxel_raycast(viewIndex).reset();
+}
+
+bool Renderer::uses_compact_semantic_transport(const Subwindow& subwindow) const
+{
+  // Note: Compact semantic images are not median filtered (filtering their labels would be meaningless), so to avoid
+  //       changing what the sub-window looks like, they are only used when median filtering is not being applied.
+  return m_semanticPaletteShader && shows_voxel_scene(subwindow) &&
+         VisualisationGenerator::supports_compact_semantic_visualisation(subwindow.get_type()) &&
+         !(m_medianFilteringEnabled && m_medianFilterer);
+}
+
+bool Renderer::uses_cuda_gl_interop(const Subwindow& subwindow) const
+{
+  // Note: The input visualisations are generated on the CPU, so they can never be copied directly from the GPU.
+  const VisualisationGenerator::VisualisationType type = subwindow.get_type();
+  return m_useCUDAGLInterop && type != VisualisationGenerator::VT_INPUT_COLOUR && type != VisualisationGenerator::VT_INPUT_DEPTH;
+}
@@ -19,9 +19,18 @@
 
 #include <rigging/MoveableCamera.h>
 
+#include <spaint/imageprocessing/interface/MedianFilterer.h>
+#include <spaint/ogl/SemanticPaletteShader.h>
+#include <spaint/ogl/VertexBufferMesh.h>
+
+#include "AsyncScreenCapturer.h"
 #include "../core/Model.h"
 #include "../subwindows/SubwindowConfiguration.h"
 
+#ifdef WITH_CUDA
+#include "InteropTexture.h"
+#endif
+
 /**
  * \brief An instance of a class deriving from this one can be used to render the spaint scene to a given target.
  */
@@ -32,23 +41,102 @@ protected:
   typedef boost::shared_ptr<void> SDL_GLContext_Ptr;
   typedef boost::shared_ptr<SDL_Window> SDL_Window_Ptr;
 
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct records a raycast of a voxel scene that has been computed during the current frame.
+   *
+   * Note that the intrinsics and image size used for the raycast are those of the scene's current view, so they are
+   * implied by the scene ID and do not need to be recorded explicitly.
+   */
+  struct CachedVoxelRaycast
+  {
+    /** The pose from which the scene was raycast. */
+    ORUtils::SE3Pose pose;
+
+    /** The render state containing the raycast. */
+    VoxelRenderState_CPtr renderState;
+
+    /** The ID of the scene that was raycast. */
+    std::string sceneID;
+  };
+
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The factor by which to reduce the resolution at which free-camera sub-windows are rendered whilst their cameras are moving (1 disables this). */
+  int m_adaptiveRenderingFactor;
+
+  /** The cached mesh used to render the axes of cameras (e.g. the default camera and any fiducials). */
+  spaint::VertexBufferMesh_CPtr m_cameraAxesMesh;
+
+  /** A CPU copy of the feature inspection image, used to upload it to a texture if CUDA-GL interop is disabled (allocated on first use). */
+  mutable ITMUChar4Image_Ptr m_featureInspectionHostImage;
+
+#ifdef WITH_CUDA
+  /** The texture (if any) that is registered with CUDA, into which the feature inspection image can be copied directly from the GPU. */
+  InteropTexture_Ptr m_featureInspectionInteropTexture;
+#endif
+
   /** The OpenGL context for the window. */
   SDL_GLContext_Ptr m_context;
 
+  /** The cached unit cylinder mesh used to render the bones of the Leap hand. */
+  spaint::VertexBufferMesh_CPtr m_cylinderMesh;
+
   /** A flag indicating whether or not to use median filtering when rendering the scene raycast. */
   bool m_medianFilteringEnabled;
 
+  /** The median filterer (if any) with which to postprocess the scene raycast. */
+  spaint::MedianFilterer_CPtr m_medianFilterer;
+
   /** The spaint model. */
   Model_CPtr m_model;
 
+  /** A flag indicating whether or not to render the profiler's timings over the top of the scene. */
+  bool m_profilingOverlayEnabled;
+
+  /** The shader (if any) used to look up the label colours of compact semantic images as they are drawn. */
+  spaint::SemanticPaletteShader_Ptr m_semanticPaletteShader;
+
+  /** The cached unit sphere mesh used to render selector orbs, the joints of the Leap hand and the bodies of fiducials. */
+  spaint::VertexBufferMesh_CPtr m_sphereMesh;
+
   /** The sub-window configuration to use for visualising the scene. */
   SubwindowConfiguration_Ptr m_subwindowConfiguration;
 
-  /** The ID of a texture in which to temporarily store the scene raycast and touch image when rendering. */
+#ifdef WITH_CUDA
+  /** The textures (if any) for the sub-windows that are registered with CUDA, into which scene visualisations can be copied directly from the GPU. */
+  std::vector<InteropTexture_Ptr> m_subwindowInteropTextures;
+#endif
+
+  /**
+   * The IDs of the textures in which the sub-window images are stored when rendering (one for each sub-window). Each sub-window has
+   * its own texture, so that a sub-window whose image is reused from an earlier frame can simply be drawn again.
+   */
+  std::vector<GLuint> m_subwindowTextureIDs;
+
+  /** The ID of a texture in which to temporarily store overlays (e.g. the touch image) when rendering. */
   GLuint m_textureID;
 
+  /**
+   * Whether or not to copy scene visualisations directly from the GPU into an OpenGL texture, rather than via the CPU.
+   * Note that if this is enabled, the CPU copies of the sub-window images for scene visualisations are not kept up-to-date.
+   */
+  bool m_useCUDAGLInterop;
+
+  /**
+   * Whether or not to send semantic visualisations to OpenGL as compact images containing labels and intensities, and look up their
+   * label colours in a fragment shader, rather than sending them as colour images. Note that if this is enabled, the sub-window images
+   * for such visualisations are not kept up-to-date (the compact images are expanded into colours on demand instead).
+   */
+  bool m_useCompactSemanticTransport;
+
+  /** The capturer used to read back the frames of videos being recorded without stalling the renderer. */
+  AsyncScreenCapturer_Ptr m_videoCapturer;
+
+  /** The voxel raycasts that have been computed so far during the current frame (these are shared between sub-windows that render the same scene from the same pose). */
+  mutable std::vector<CachedVoxelRaycast> m_voxelRaycastCache;
+
   /** The window into which to render. */
   SDL_Window_Ptr m_window;
 
@@ -109,6 +197,26 @@ public:
    */
   ITMUChar4Image_CPtr capture_screenshot() const;
 
+  /**
+   * \brief Captures a copy (on the CPU) of the image that was most recently rendered for the specified sub-window.
+   *
+   * Unlike capture_screenshot, this reads the image from the visualisation that was generated for the sub-window rather
+   * than from the window, so it does not need an OpenGL read-back, and is not affected by anything drawn over the top.
+   *
+   * \param subwindowIndex  The index of the sub-window.
+   * \return                The copy of the sub-window's image.
+   */
+  ITMUChar4Image_CPtr capture_subwindow_image(size_t subwindowIndex) const;
+
+  /**
+   * \brief Starts capturing the current contents of the window as the next frame of a video, and returns the previous frame (if any).
+   *
+   * Unlike capture_screenshot, this does not wait for the contents of the window to be read back, so the frames lag it by one.
+   *
+   * \return  The previously captured frame, or NULL if there is no such frame.
+   */
+  ITMUChar4Image_CPtr capture_video_frame() const;
+
   /**
    * \brief Computes the fractional position of point (x,y) in the window.
    *
@@ -118,6 +226,13 @@ public:
    */
   Vector2f compute_fractional_window_position(int x, int y) const;
 
+  /**
+   * \brief Finishes capturing the frames of a video, and returns the frame (if any) that had not yet been returned by capture_video_frame.
+   *
+   * \return  The final frame of the video, or NULL if there is no such frame.
+   */
+  ITMUChar4Image_CPtr finish_video_capture() const;
+
   /**
    * \brief Gets whether or not to use median filtering when rendering the scene raycast.
    *
@@ -125,6 +240,13 @@ public:
    */
   bool get_median_filtering_enabled() const;
 
+  /**
+   * \brief Gets whether or not to render the profiler's timings over the top of the scene.
+   *
+   * \return  A flag indicating whether or not to render the profiler's timings over the top of the scene.
+   */
+  bool get_profiling_overlay_enabled() const;
+
   /**
    * \brief Gets the renderer's sub-window configuration.
    *
@@ -146,6 +268,13 @@ public:
    */
   void set_median_filtering_enabled(bool medianFilteringEnabled);
 
+  /**
+   * \brief Sets whether or not to render the profiler's timings over the top of the scene.
+   *
+   * \param profilingOverlayEnabled A flag indicating whether or not to render the profiler's timings over the top of the scene.
+   */
+  void set_profiling_overlay_enabled(bool profilingOverlayEnabled);
+
   //#################### PROTECTED MEMBER FUNCTIONS ####################
 protected:
   /**
@@ -153,6 +282,13 @@ protected:
    */
   static void begin_2d();
 
+  /**
+   * \brief Discards any voxel raycasts that have been cached during the previous frame.
+   *
+   * This should be called at the start of each frame, since the scenes may have changed since the raycasts were computed.
+   */
+  void clear_voxel_raycast_cache() const;
+
   /**
    * \brief Destroys the temporary image and texture used for visualising the scene.
    */
@@ -189,6 +325,19 @@ protected:
    */
   void initialise_common();
 
+  /**
+   * \brief Raycasts the scenes shown in the sub-windows from the poses of both eyes of a stereo camera in a single pass,
+   *        ready for them to be shaded when the sub-windows are rendered for each eye.
+   *
+   * This clears the voxel raycast cache (see clear_voxel_raycast_cache) before filling it with the stereo raycasts.
+   * The raycasts for the left and right eyes are stored in the voxel render states for views 0 and 1 of each sub-window.
+   * Sub-windows for which a raycast for either eye can already be reused are skipped.
+   *
+   * \param leftCameraName  The name of the secondary camera from which to get the pose of the left eye.
+   * \param rightCameraName The name of the secondary camera from which to get the pose of the right eye.
+   */
+  void prepare_stereo_voxel_raycasts(const std::string& leftCameraName, const std::string& rightCameraName) const;
+
   /**
    * \brief Renders both the reconstructed scene and the synthetic scene.
    *
@@ -208,6 +357,36 @@ protected:
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Computes the pose from which to render a sub-window, first updating the sub-window's camera if it is in follow mode.
+   *
+   * \param subwindow           The sub-window.
+   * \param secondaryCameraName The name of the secondary camera from which to get the pose (if any).
+   * \return                    The pose from which to render the sub-window.
+   */
+  ORUtils::SE3Pose compute_render_pose(Subwindow& subwindow, const std::string& secondaryCameraName) const;
+
+  /**
+   * \brief Finds an up-to-date raycast (if any) of the specified voxel scene from the specified pose.
+   *
+   * This can either be a raycast that has already been computed for another sub-window during the current frame,
+   * or the raycast from the live camera pose that was computed to prepare for tracking.
+   *
+   * \param sceneID The ID of the scene.
+   * \param pose    The pose.
+   * \return        A render state containing the raycast, if one was found, or NULL otherwise.
+   */
+  VoxelRenderState_CPtr find_cached_voxel_raycast(const std::string& sceneID, const ORUtils::SE3Pose& pose) const;
+
+  /**
+   * \brief Gets the ID of the texture in which the image of the specified sub-window is stored.
+   *
+   * \param subwindowIndex  The index of the sub-window.
+   * \param useInterop      Whether or not to get the sub-window's texture that is registered with CUDA, rather than its ordinary one.
+   * \return                The ID of the texture.
+   */
+  GLuint get_subwindow_texture_id(size_t subwindowIndex, bool useInterop) const;
+
   /**
    * \brief Generates a visualisation of the scene.
    *
@@ -215,17 +394,60 @@ private:
    * \param voxelScene        The voxel version of the scene to visualise.
    * \param surfelScene       The surfel version of the scene to visualise.
    * \param voxelRenderState  The voxel render state to use for intermediate storage (if relevant).
+   * \param cachedVoxelRaycast A render state (if any) containing an up-to-date raycast of the voxel scene from the same pose, which can be shaded instead of ray marching the scene again.
    * \param surfelRenderState The surfel render state to use for intermediate storage (if relevant).
    * \param pose              The pose from which to visualise the scene (if relevant).
    * \param view              The current view of the scene.
    * \param visualisationType The type of visualisation to generate.
    * \param surfelFlag        Whether or not to render a surfel visualisation rather than a voxel one.
    * \param postprocessor     An optional function with which to postprocess the visualisation before returning it.
+   * \param copyToHost        Whether or not to make a scene visualisation accessible on the CPU (input visualisations are always generated on the CPU).
    */
   void generate_visualisation(const ITMUChar4Image_Ptr& output, const spaint::SpaintVoxelScene_CPtr& voxelScene, const spaint::SpaintSurfelScene_CPtr& surfelScene,
-                              VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState, const ORUtils::SE3Pose& pose, const View_CPtr& view,
-                              spaint::VisualisationGenerator::VisualisationType visualisationType, bool surfelFlag,
-                              const boost::optional<spaint::VisualisationGenerator::Postprocessor>& postprocessor) const;
+                              VoxelRenderState_Ptr& voxelRenderState, const VoxelRenderState_CPtr& cachedVoxelRaycast, SurfelRenderState_Ptr& surfelRenderState,
+                              const ORUtils::SE3Pose& pose, const View_CPtr& view, spaint::VisualisationGenerator::VisualisationType visualisationType, bool surfelFlag,
+                              const boost::optional<spaint::VisualisationGenerator::Postprocessor>& postprocessor, bool copyToHost) const;
+
+  /**
+   * \brief Determines whether or not the voxel render state for the specified view of a sub-window already contains
+   *        an up-to-date, full-resolution raycast of the sub-window's scene from the specified pose.
+   *
+   * \param subwindow The sub-window.
+   * \param viewIndex The index of the free camera view for the sub-window.
+   * \param pose      The pose.
+   * \return          true, if the render state contains such a raycast, or false otherwise.
+   */
+  bool has_up_to_date_voxel_raycast(Subwindow& subwindow, int viewIndex, const ORUtils::SE3Pose& pose) const;
+
+  /**
+   * \brief Decides whether or not the specified sub-window's image needs to be regenerated for the current frame, based on its update policy.
+   *
+   * \param subwindow   The sub-window.
+   * \param updateInfo  The circumstances in which the image would be regenerated (the completeness of the image is ignored).
+   * \return            true, if the image needs to be regenerated, or false if the image from the sub-window's last update can be reused.
+   */
+  bool needs_update(const Subwindow& subwindow, const Subwindow::UpdateInfo& updateInfo) const;
+
+  /**
+   * \brief Determines whether or not two poses are (to within a small tolerance) the same.
+   *
+   * \param lhs The first pose.
+   * \param rhs The second pose.
+   * \return    true, if the two poses are the same, or false otherwise.
+   */
+  static bool poses_match(const ORUtils::SE3Pose& lhs, const ORUtils::SE3Pose& rhs);
+
+  /**
+   * \brief Renders the feature inspection image as a square overlay in the top-left corner of the current sub-window.
+   *
+   * The image is copied straight from the GPU into a texture if CUDA-GL interop is enabled, so that inspecting the
+   * features of the scene does not require any round trips via the CPU.
+   *
+   * \param featureInspectionImage The feature inspection image.
+   * \param subwindowWidth         The width of the current sub-window's viewport (in pixels).
+   * \param subwindowHeight        The height of the current sub-window's viewport (in pixels).
+   */
+  void render_feature_inspection_overlay(const ITMUChar4Image_CPtr& featureInspectionImage, int subwindowWidth, int subwindowHeight) const;
 
   /**
    * \brief Renders a semi-transparent colour overlay over the existing scene.
@@ -234,6 +456,13 @@ private:
    */
   void render_overlay(const ITMUChar4Image_CPtr& overlay) const;
 
+#ifdef WITH_GLUT
+  /**
+   * \brief Renders the profiler's statistics for the stages that have been timed over the top of the scene.
+   */
+  void render_profiling_overlay() const;
+#endif
+
 #if WITH_GLUT && USE_PIXEL_DEBUGGING
   /**
    * \brief Renders the value of a pixel in the specified sub-window.
@@ -247,12 +476,15 @@ private:
   /**
    * \brief Renders the specified reconstructed scene into a sub-window.
    *
-   * \param sceneID   The scene ID.
-   * \param pose      The camera pose.
-   * \param subwindow The sub-window into which to render.
-   * \param viewIndex The index of the free camera view for the sub-window.
+   * The sub-window's image is only regenerated if its update policy requires it: if not, the image from its last update is drawn again.
+   *
+   * \param sceneID         The scene ID.
+   * \param pose            The camera pose.
+   * \param subwindow       The sub-window into which to render.
+   * \param subwindowIndex  The index of the sub-window.
+   * \param viewIndex       The index of the free camera view for the sub-window.
    */
-  void render_reconstructed_scene(const std::string& sceneID, const ORUtils::SE3Pose& pose, Subwindow& subwindow, int viewIndex) const;
+  void render_reconstructed_scene(const std::string& sceneID, const ORUtils::SE3Pose& pose, Subwindow& subwindow, size_t subwindowIndex, int viewIndex) const;
 
   /**
    * \brief Renders a synthetic scene to augment what actually exists in the real world.
@@ -292,6 +524,54 @@ private:
    */
   static void set_projection_matrix(const ITMLib::ITMIntrinsics& intrinsics, int width, int height);
 
+  /**
+   * \brief Determines whether or not the specified sub-window shows a voxel visualisation of its scene.
+   *
+   * \param subwindow The sub-window.
+   * \return          true, if the sub-window shows a voxel visualisation of its scene, or false otherwise.
+   */
+  bool shows_voxel_scene(const Subwindow& subwindow) const;
+
+  /**
+   * \brief Regenerates the specified sub-window's image, and copies it into the sub-window's texture.
+   *
+   * \param sceneID         The scene ID.
+   * \param pose            The camera pose.
+   * \param subwindow       The sub-window.
+   * \param subwindowIndex  The index of the sub-window.
+   * \param viewIndex       The index of the free camera view for the sub-window.
+   * \return                true, if the image was fully rendered, or false if it was rendered at a reduced resolution.
+   */
+  bool update_subwindow_texture(const std::string& sceneID, const ORUtils::SE3Pose& pose, Subwindow& subwindow, size_t subwindowIndex, int viewIndex) const;
+
+  /**
+   * \brief Makes sure that the voxel render state for the specified free camera view of a sub-window is of the specified size.
+   *
+   * \param subwindow   The sub-window.
+   * \param viewIndex   The index of the free camera view for the sub-window.
+   * \param size        The size that the voxel render state should have.
+   * \param voxelScene  The voxel scene that the sub-window is rendering.
+   */
+  void use_voxel_render_state_of_size(Subwindow& subwindow, int viewIndex, const Vector2i& size, const spaint::SpaintVoxelScene_CPtr& voxelScene) const;
+
+  /**
+   * \brief Determines whether or not the image for the specified sub-window is sent to OpenGL as a compact semantic image
+   *        (in which case the sub-window's colour image is not kept up to date).
+   *
+   * \param subwindow The sub-window.
+   * \return          true, if the image for the sub-window is sent to OpenGL as a compact semantic image, or false otherwise.
+   */
+  bool uses_compact_semantic_transport(const Subwindow& subwindow) const;
+
+  /**
+   * \brief Determines whether or not the image for the specified sub-window is copied directly from the GPU into OpenGL
+   *        (in which case its CPU copy is not kept up to date).
+   *
+   * \param subwindow The sub-window.
+   * \return          true, if the image for the sub-window is copied directly from the GPU into OpenGL, or false otherwise.
+   */
+  bool uses_cuda_gl_interop(const Subwindow& subwindow) const;
+
   //#################### FRIENDS ####################
 
   friend class SelectorRenderer;
@@ -152,8 +152,9 @@ void RiftRenderer::render(const Vector2f& fracWindowPos, bool renderFiducials) c
   // Start the frame.
   ovrHmd_BeginFrame(m_hmd, 0);
 
-  // Render the scene into OpenGL textures from the left and right eye poses.
+  // Raycast the scene from both eye poses in a single pass, and then render the scene into OpenGL textures from each eye pose in turn.
   const std::string secondaryCameraNames[] = { "left", "right" };
+  prepare_stereo_voxel_raycasts(secondaryCameraNames[ovrEye_Left], secondaryCameraNames[ovrEye_Right]);
   for(int i = 0; i < ovrEye_Count; ++i)
   {
     glBindFramebuffer(GL_FRAMEBUFFER, m_eyeFrameBuffers[i]->get_id());
@@ -68,6 +68,7 @@ void WindowedRenderer::render(const Vector2f& fracWindowPos, bool renderFiducial
 #endif
 
   // Render the scene.
+  clear_voxel_raycast_cache();
   render_scene(fracWindowPos, renderFiducials);
 
   // Swap the front and back buffers.
@@ -6,6 +6,8 @@
 #include "Subwindow.h"
 using namespace rigging;
 
+#include <stdexcept>
+
 #include <spaint/util/CameraFactory.h>
 using namespace spaint;
 
@@ -17,11 +19,14 @@ using namespace tvgutil;
 Subwindow::Subwindow(const Vector2f& topLeft, const Vector2f& bottomRight, const std::string& sceneID, VisualisationGenerator::VisualisationType type, const Vector2i& imgSize)
 : m_bottomRight(bottomRight),
   m_cameraMode(CM_FOLLOW),
+  m_framesSinceLastUpdate(0),
   m_image(new ITMUChar4Image(imgSize, true, true)),
   m_sceneID(sceneID),
   m_surfelFlag(false),
   m_topLeft(topLeft),
-  m_type(type)
+  m_type(type),
+  m_updateInterval(1),
+  m_updatePolicy(UP_EVERY_FRAME)
 {
   reset_camera();
 }
@@ -43,6 +48,22 @@ Subwindow::CameraMode Subwindow::get_camera_mode() const
   return m_cameraMode;
 }
 
+const ITMUShortImage_Ptr& Subwindow::get_compact_semantic_image()
+{
+  if(!m_compactSemanticImage) m_compactSemanticImage.reset(new ITMUShortImage(m_image->noDims, true, true));
+  return m_compactSemanticImage;
+}
+
+ITMUShortImage_CPtr Subwindow::get_compact_semantic_image() const
+{
+  return m_compactSemanticImage;
+}
+
+int Subwindow::get_frames_since_last_update() const
+{
+  return m_framesSinceLastUpdate;
+}
+
 const ITMUChar4Image_Ptr& Subwindow::get_image()
 {
   return m_image;
@@ -53,11 +74,26 @@ ITMUChar4Image_CPtr Subwindow::get_image() const
   return m_image;
 }
 
+const boost::optional<Subwindow::UpdateInfo>& Subwindow::get_last_update() const
+{
+  return m_lastUpdate;
+}
+
+boost::optional<Subwindow::VoxelRaycastInfo>& Subwindow::get_last_voxel_raycast(int viewIndex)
+{
+  return m_lastVoxelRaycasts[viewIndex];
+}
+
 const std::string& Subwindow::get_scene_id() const
 {
   return m_sceneID;
 }
 
+VoxelRenderState_Ptr& Subwindow::get_spare_voxel_render_state(int viewIndex)
+{
+  return m_spareVoxelRenderStates[viewIndex];
+}
+
 bool Subwindow::get_surfel_flag() const
 {
   return m_surfelFlag;
@@ -78,6 +114,16 @@ VisualisationGenerator::VisualisationType Subwindow::get_type() const
   return m_type;
 }
 
+int Subwindow::get_update_interval() const
+{
+  return m_updateInterval;
+}
+
+Subwindow::UpdatePolicy Subwindow::get_update_policy() const
+{
+  return m_updatePolicy;
+}
+
 VoxelRenderState_Ptr& Subwindow::get_voxel_render_state(int viewIndex)
 {
   return m_voxelRenderStates[viewIndex];
@@ -98,11 +144,23 @@ void Subwindow::reset_camera()
   m_camera = CameraFactory::make_default_camera<CompositeCamera>();
 }
 
+void Subwindow::reset_last_update()
+{
+  m_lastUpdate.reset();
+  m_framesSinceLastUpdate = 0;
+}
+
 void Subwindow::set_camera_mode(CameraMode cameraMode)
 {
   m_cameraMode = cameraMode;
 }
 
+void Subwindow::set_last_update(const UpdateInfo& updateInfo)
+{
+  m_lastUpdate = updateInfo;
+  m_framesSinceLastUpdate = 0;
+}
+
 void Subwindow::set_surfel_flag(bool surfelFlag)
 {
   m_surfelFlag = surfelFlag;
@@ -113,6 +171,19 @@ void Subwindow::set_type(VisualisationGenerator::VisualisationType type)
   m_type = type;
 }
 
+void Subwindow::set_update_policy(UpdatePolicy updatePolicy, int updateInterval)
+{
+  if(updateInterval < 1) throw std::invalid_argument("Error: The update interval of a sub-window must be at least 1");
+
+  m_updatePolicy = updatePolicy;
+  m_updateInterval = updateInterval;
+}
+
+void Subwindow::skip_update()
+{
+  ++m_framesSinceLastUpdate;
+}
+
 const Vector2f& Subwindow::top_left() const
 {
   return m_topLeft;
@@ -8,6 +8,7 @@
 
 #include <rigging/CompositeCamera.h>
 
+#include <spaint/imagesources/FrameTimestamps.h>
 #include <spaint/visualisation/VisualisationGenerator.h>
 
 /**
@@ -30,6 +31,73 @@ public:
     CM_FREE
   };
 
+  /**
+   * \brief An enumeration containing the possible policies for deciding when to regenerate the sub-window's image.
+   *
+   * Whenever the image is not regenerated, the image from the most recent update is simply drawn again.
+   */
+  enum UpdatePolicy
+  {
+    /** A policy that regenerates the image every frame. */
+    UP_EVERY_FRAME,
+
+    /** A policy that regenerates the image every N frames (where N is the sub-window's update interval). */
+    UP_EVERY_N_FRAMES,
+
+    /** A policy that regenerates the image only when what it shows may have changed (e.g. the camera has moved or the scene has changed). */
+    UP_ON_CHANGE
+  };
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct records the circumstances in which the sub-window's image was last regenerated.
+   */
+  struct UpdateInfo
+  {
+    /** Whether or not the image was a compact semantic image (containing labels and intensities rather than colours). */
+    bool compactSemantic;
+
+    /** Whether or not the image was fully rendered (rather than, e.g., rendered at a reduced resolution whilst the camera was moving). */
+    bool complete;
+
+    /** The time at which the input frame that was current when the image was regenerated was received. */
+    spaint::FrameTimestamps::Clock::time_point inputTime;
+
+    /** Whether or not the image was median filtered. */
+    bool medianFiltered;
+
+    /** The pose from which the image was rendered. */
+    ORUtils::SE3Pose pose;
+
+    /** Whether or not the image showed a surfel visualisation rather than a voxel one. */
+    bool surfelFlag;
+
+    /** The type of scene visualisation that the image showed. */
+    spaint::VisualisationGenerator::VisualisationType type;
+
+    /** The index of the free camera view for which the image was rendered. */
+    int viewIndex;
+
+    /** The version of the voxel scene that the SLAM state reported (this changes whenever frames are fused or the scene is reset or replaced). */
+    size_t voxelSceneVersion;
+
+    /** The version of the voxel scene itself (this also changes whenever any of its voxels are relabelled). */
+    unsigned int voxelVersion;
+  };
+
+  /**
+   * \brief An instance of this struct records the circumstances in which a voxel render state for the sub-window was last raycast.
+   */
+  struct VoxelRaycastInfo
+  {
+    /** The pose from which the scene was raycast. */
+    ORUtils::SE3Pose pose;
+
+    /** The version of the voxel scene that was raycast. */
+    size_t sceneVersion;
+  };
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The location of the bottom-right of the sub-window (each component is expressed as a fraction in the range [0,1]). */
@@ -41,15 +109,33 @@ private:
   /** The current camera mode. */
   CameraMode m_cameraMode;
 
+  /** The image in which to store a compact semantic visualisation of the scene for the sub-window (allocated on first use). */
+  ITMUShortImage_Ptr m_compactSemanticImage;
+
+  /** The number of frames for which the sub-window's image has been reused since it was last regenerated. */
+  int m_framesSinceLastUpdate;
+
   /** The image in which to store the scene visualisation for the sub-window. */
   ITMUChar4Image_Ptr m_image;
 
+  /** The circumstances in which the sub-window's image was last regenerated (if it has been). */
+  boost::optional<UpdateInfo> m_lastUpdate;
+
+  /** The circumstances in which the voxel render state(s) for the free camera view(s) were last raycast (if they have been). */
+  std::map<int,boost::optional<VoxelRaycastInfo> > m_lastVoxelRaycasts;
+
   /** The ID of the scene to render in the sub-window. */
   std::string m_sceneID;
 
   /** A flag indicating whether or not to render a surfel visualisation rather than a voxel one. */
   bool m_surfelFlag;
 
+  /**
+   * The spare voxel render state(s) for the free camera view(s). When a free camera view switches between rendering
+   * the scene at full and reduced resolution, its current voxel render state is swapped with its spare one.
+   */
+  std::map<int,VoxelRenderState_Ptr> m_spareVoxelRenderStates;
+
   /** The surfel render state(s) for the free camera view(s). */
   std::map<int,SurfelRenderState_Ptr> m_surfelRenderStates;
 
@@ -59,6 +145,12 @@ private:
   /** The type of scene visualisation to render in the sub-window. */
   spaint::VisualisationGenerator::VisualisationType m_type;
 
+  /** The number of frames between regenerations of the sub-window's image (only used by the UP_EVERY_N_FRAMES policy). */
+  int m_updateInterval;
+
+  /** The policy used to decide when to regenerate the sub-window's image. */
+  UpdatePolicy m_updatePolicy;
+
   /** The voxel render state(s) for the free camera view(s). */
   std::map<int,VoxelRenderState_Ptr> m_voxelRenderStates;
 
@@ -98,6 +190,27 @@ public:
    */
   CameraMode get_camera_mode() const;
 
+  /**
+   * \brief Gets the image in which to store a compact semantic visualisation of the scene for the sub-window (allocating it if necessary).
+   *
+   * \return  The image in which to store a compact semantic visualisation of the scene for the sub-window.
+   */
+  const ITMUShortImage_Ptr& get_compact_semantic_image();
+
+  /**
+   * \brief Gets the image in which to store a compact semantic visualisation of the scene for the sub-window.
+   *
+   * \return  The image in which to store a compact semantic visualisation of the scene for the sub-window (NULL, if it has never been used).
+   */
+  ITMUShortImage_CPtr get_compact_semantic_image() const;
+
+  /**
+   * \brief Gets the number of frames for which the sub-window's image has been reused since it was last regenerated.
+   *
+   * \return  The number of frames for which the sub-window's image has been reused since it was last regenerated.
+   */
+  int get_frames_since_last_update() const;
+
   /**
    * \brief Gets the image in which to store the scene visualisation for the sub-window.
    *
@@ -112,6 +225,21 @@ public:
    */
   ITMUChar4Image_CPtr get_image() const;
 
+  /**
+   * \brief Gets the circumstances in which the sub-window's image was last regenerated (if it has been).
+   *
+   * \return The circumstances in which the sub-window's image was last regenerated (if it has been).
+   */
+  const boost::optional<UpdateInfo>& get_last_update() const;
+
+  /**
+   * \brief Gets the circumstances in which the voxel render state for the specified free camera view was last raycast (if it has been).
+   *
+   * \param viewIndex The index of the free camera view.
+   * \return          The circumstances in which the voxel render state for the view was last raycast (if it has been).
+   */
+  boost::optional<VoxelRaycastInfo>& get_last_voxel_raycast(int viewIndex = 0);
+
   /**
    * \brief Gets the ID of the scene to render in the sub-window.
    *
@@ -119,6 +247,13 @@ public:
    */
   const std::string& get_scene_id() const;
 
+  /**
+   * \brief Gets the spare voxel render state for the specified free camera view (see m_spareVoxelRenderStates).
+   *
+   * \param viewIndex The index of the free camera view.
+   */
+  VoxelRenderState_Ptr& get_spare_voxel_render_state(int viewIndex = 0);
+
   /**
    * \brief Gets a flag indicating whether or not to render a surfel visualisation rather than a voxel one.
    *
@@ -147,6 +282,20 @@ public:
    */
   spaint::VisualisationGenerator::VisualisationType get_type() const;
 
+  /**
+   * \brief Gets the number of frames between regenerations of the sub-window's image (only used by the UP_EVERY_N_FRAMES policy).
+   *
+   * \return  The number of frames between regenerations of the sub-window's image.
+   */
+  int get_update_interval() const;
+
+  /**
+   * \brief Gets the policy used to decide when to regenerate the sub-window's image.
+   *
+   * \return  The policy used to decide when to regenerate the sub-window's image.
+   */
+  UpdatePolicy get_update_policy() const;
+
   /**
    * \brief Gets the voxel render state for the specified free camera view.
    *
@@ -175,6 +324,13 @@ public:
    */
   void reset_camera();
 
+  /**
+   * \brief Forgets the circumstances in which the sub-window's image was last regenerated, so that it will be regenerated next time it is rendered.
+   *
+   * This must be called whenever the image is no longer available to be drawn again (e.g. when the texture into which it was copied is destroyed).
+   */
+  void reset_last_update();
+
   /**
    * \brief Sets the current camera mode.
    *
@@ -182,6 +338,13 @@ public:
    */
   void set_camera_mode(CameraMode cameraMode);
 
+  /**
+   * \brief Records that the sub-window's image has been regenerated.
+   *
+   * \param updateInfo  The circumstances in which the image was regenerated.
+   */
+  void set_last_update(const UpdateInfo& updateInfo);
+
   /**
    * \brief Sets a flag indicating whether or not to render a surfel visualisation rather than a voxel one.
    *
@@ -196,6 +359,20 @@ public:
    */
   void set_type(spaint::VisualisationGenerator::VisualisationType type);
 
+  /**
+   * \brief Sets the policy used to decide when to regenerate the sub-window's image.
+   *
+   * \param updatePolicy    The policy used to decide when to regenerate the sub-window's image.
+   * \param updateInterval  The number of frames between regenerations of the sub-window's image (only used by the UP_EVERY_N_FRAMES policy).
+   * \throws std::invalid_argument If the update interval is less than 1.
+   */
+  void set_update_policy(UpdatePolicy updatePolicy, int updateInterval = 1);
+
+  /**
+   * \brief Records that the sub-window's image has been reused for a frame rather than being regenerated.
+   */
+  void skip_update();
+
   /**
    * \brief Gets the location of the top-left of the sub-window (each component is expressed as a fraction in the range [0,1]).
    *
@@ -0,0 +1,414 @@
+/**
+ * spaintperf: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#ifdef WITH_CUDA
+#include <ORUtils/CUDADefines.h>
+#endif
+
+#include <InputSource/ImageSourceEngine.h>
+
+#include <itmx/base/DeviceUtil.h>
+#include <itmx/base/MemoryBlockFactory.h>
+#include <itmx/persistence/PackedSequenceUtil.h>
+
+#include <spaint/imagesources/AsyncImageSourceEngine.h>
+#include <spaint/imagesources/PackedSequenceImageSourceEngine.h>
+#include <spaint/imagesources/SwappingCompositeImageSourceEngine.h>
+
+#include <tvgutil/filesystem/PathFinder.h>
+#include <tvgutil/persistence/JSONUtil.h>
+#include <tvgutil/timing/Profiler.h>
+#include <tvgutil/timing/TimeUtil.h>
+
+#include "core/SemanticPipeline.h"
+#include "core/SLAMPipeline.h"
+
+using namespace InputSource;
+using namespace ITMLib;
+
+using namespace itmx;
+using namespace spaint;
+using namespace tvgutil;
+
+//#################### NAMESPACE ALIASES ####################
+
+namespace bf = boost::filesystem;
+namespace po = boost::program_options;
+
+//#################### TYPES ####################
+
+struct CommandLineArguments
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  // User-specifiable arguments
+  std::string calibrationFilename;
+  std::string mode;
+  bool mapSurfels;
+  size_t maxFrameCount;
+  bool noRelocaliser;
+  std::string outputFilename;
+  std::string pipelineType;
+  std::string sequenceSpecifier;
+  std::string traceFilename;
+  bool trackSurfels;
+  size_t warmupFrameCount;
+};
+
+/**
+ * \brief An instance of this struct contains summary statistics about a set of durations.
+ */
+struct DurationStats
+{
+  double maxMs;
+  double meanMs;
+  double p50Ms;
+  double p90Ms;
+  double p99Ms;
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Computes the specified percentile of a sorted set of values using the nearest-rank method (as the profiler does).
+ *
+ * \param sortedValues  The sorted values (must be non-empty).
+ * \param percentile    The percentile to compute (in the range [0,100]).
+ * \return              The percentile.
+ */
+double nearest_rank_percentile(const std::vector<double>& sortedValues, double percentile)
+{
+  size_t rank = static_cast<size_t>(percentile / 100.0 * sortedValues.size() + 0.999999);
+  if(rank < 1) rank = 1;
+  if(rank > sortedValues.size()) rank = sortedValues.size();
+  return sortedValues[rank - 1];
+}
+
+/**
+ * \brief Computes summary statistics about a set of durations.
+ *
+ * \param durationsMs The durations (in milliseconds), which must be non-empty.
+ * \return            The summary statistics.
+ */
+DurationStats compute_duration_stats(std::vector<double> durationsMs)
+{
+  std::sort(durationsMs.begin(), durationsMs.end());
+
+  double totalMs = 0.0;
+  for(size_t i = 0, size = durationsMs.size(); i < size; ++i) totalMs += durationsMs[i];
+
+  DurationStats stats;
+  stats.maxMs = durationsMs.back();
+  stats.meanMs = totalMs / durationsMs.size();
+  stats.p50Ms = nearest_rank_percentile(durationsMs, 50.0);
+  stats.p90Ms = nearest_rank_percentile(durationsMs, 90.0);
+  stats.p99Ms = nearest_rank_percentile(durationsMs, 99.0);
+  return stats;
+}
+
+/**
+ * \brief Makes the image source engine that replays the sequence specified on the command line.
+ *
+ * \param args  The program's command-line arguments.
+ * \return      The image source engine.
+ */
+CompositeImageSourceEngine_Ptr make_image_source_engine(const CommandLineArguments& args)
+{
+  const bf::path location = bf::exists(args.sequenceSpecifier)
+    ? bf::path(args.sequenceSpecifier)
+    : find_subdir_from_executable("sequences") / args.sequenceSpecifier;
+
+  ImageSourceEngine *diskSubengine = NULL;
+  if(PackedSequenceUtil::is_packed_sequence(location.string()))
+  {
+    // Note: Packed sequences contain their own calibration, so the calibration file is not used.
+    diskSubengine = new PackedSequenceImageSourceEngine(location.string(), 0);
+  }
+  else
+  {
+    // If the user hasn't explicitly specified a calibration file, use the one in the sequence directory.
+    const std::string calibrationFilename = args.calibrationFilename != "" ? args.calibrationFilename : (location / "calib.txt").string();
+    const std::string depthImageMask = (location / "depthm%06i.pgm").string();
+    const std::string rgbImageMask = (location / "rgbm%06i.ppm").string();
+    ImageMaskPathGenerator pathGenerator(rgbImageMask.c_str(), depthImageMask.c_str());
+    diskSubengine = new ImageFileReader<ImageMaskPathGenerator>(calibrationFilename.c_str(), pathGenerator, 0);
+  }
+
+  // Note: The sequence is prefetched exactly as it is in spaintgui by default, so that the benchmark measures the same pipeline.
+  //       The prefetch buffer is not pinned, since the view builder uploads the images from the host anyway.
+  SwappingCompositeImageSourceEngine_Ptr imageSourceEngine(new SwappingCompositeImageSourceEngine);
+  imageSourceEngine->add_subengine(new AsyncImageSourceEngine(diskSubengine, 60, false));
+  return imageSourceEngine;
+}
+
+/**
+ * \brief Parses a pipeline mode name as specified on the command line.
+ *
+ * \param mode                    The name of the mode.
+ * \return                        The corresponding pipeline mode.
+ * \throws std::invalid_argument  If the name does not correspond to a supported mode.
+ */
+MultiScenePipeline::Mode parse_mode(const std::string& mode)
+{
+  if(mode == "normal") return MultiScenePipeline::MODE_NORMAL;
+  else if(mode == "prediction") return MultiScenePipeline::MODE_PREDICTION;
+  else if(mode == "propagation") return MultiScenePipeline::MODE_PROPAGATION;
+  else if(mode == "smoothing") return MultiScenePipeline::MODE_SMOOTHING;
+  else if(mode == "trainandpredict") return MultiScenePipeline::MODE_TRAIN_AND_PREDICT;
+  else if(mode == "training") return MultiScenePipeline::MODE_TRAINING;
+  else throw std::invalid_argument("Error: Unknown pipeline mode: " + mode);
+}
+
+/**
+ * \brief Parses any command-line arguments passed in by the user.
+ *
+ * \param argc  The command-line argument count.
+ * \param argv  The raw command-line arguments.
+ * \param args  The parsed command-line arguments.
+ * \return      true, if the program should continue after parsing the command-line arguments, or false otherwise.
+ */
+bool parse_command_line(int argc, char *argv[], CommandLineArguments& args)
+{
+  po::options_description options("Options");
+  options.add_options()
+    ("help", "produce help message")
+    ("calib,c", po::value<std::string>(&args.calibrationFilename)->default_value(""), "calibration filename (defaults to calib.txt in the sequence directory)")
+    ("mapSurfels", po::bool_switch(&args.mapSurfels), "enable surfel mapping")
+    ("maxFrames,n", po::value<size_t>(&args.maxFrameCount)->default_value(0), "maximum number of frames to measure after the warm-up (0 means the rest of the sequence)")
+    ("mode,m", po::value<std::string>(&args.mode)->default_value("normal"), "pipeline mode (normal|prediction|propagation|smoothing|trainandpredict|training)")
+    ("noRelocaliser", po::bool_switch(&args.noRelocaliser), "don't use the relocaliser")
+    ("output,o", po::value<std::string>(&args.outputFilename)->default_value(""), "file to which to write the results (defaults to stdout)")
+    ("pipelineType", po::value<std::string>(&args.pipelineType)->default_value("slam"), "pipeline type (slam|semantic)")
+    ("sequenceSpecifier,s", po::value<std::string>(&args.sequenceSpecifier), "sequence specifier (a sequence name, directory or packed sequence file)")
+    ("traceFile", po::value<std::string>(&args.traceFilename)->default_value(""), "file to which to write a Chrome trace of the measured frames")
+    ("trackSurfels", po::bool_switch(&args.trackSurfels), "enable surfel mapping and tracking")
+    ("warmupFrames,w", po::value<size_t>(&args.warmupFrameCount)->default_value(10), "number of frames to process before starting to measure")
+  ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, options), vm);
+  po::notify(vm);
+
+  if(vm.count("help") || args.sequenceSpecifier == "")
+  {
+    std::cout << "Usage: spaintperf -s <sequence> [options]\n\n" << options << '\n';
+    return false;
+  }
+
+  // If the user wants to enable surfel tracking, make sure that surfel mapping is also enabled.
+  if(args.trackSurfels) args.mapSurfels = true;
+
+  return true;
+}
+
+/**
+ * \brief Writes the results of a benchmark run to a stream as JSON.
+ *
+ * \param os                    The stream.
+ * \param args                  The program's command-line arguments.
+ * \param settings              The application settings.
+ * \param elapsedSeconds        The wall-clock time taken to process the measured frames (in seconds).
+ * \param frameDurationsMs      The end-to-end latencies of the measured frames (in milliseconds).
+ * \param peakDeviceMemoryMB    The peak amount of device memory in use whilst measuring (in MB), or a negative value if unknown.
+ * \param deviceAllocationCount The number of device allocations made by the memory block factory whilst measuring.
+ * \param sceneOccupancy        How much of the voxel scene's storage was in use at the end of the run.
+ */
+void write_results(std::ostream& os, const CommandLineArguments& args, const Settings_CPtr& settings, double elapsedSeconds, const std::vector<double>& frameDurationsMs,
+                   double peakDeviceMemoryMB, size_t deviceAllocationCount, const SpaintVoxelScene::Occupancy& sceneOccupancy)
+{
+  const size_t frameCount = frameDurationsMs.size();
+  os << std::fixed << std::setprecision(3);
+
+  os << "{\n"
+     << "  \"timestamp\": \"" << TimeUtil::get_iso_timestamp() << "\",\n"
+     << "  \"config\": {\n"
+     << "    \"sequence\": \"" << JSONUtil::escape_string(args.sequenceSpecifier) << "\",\n"
+     << "    \"pipelineType\": \"" << args.pipelineType << "\",\n"
+     << "    \"mode\": \"" << args.mode << "\",\n"
+     << "    \"deviceType\": \"" << (settings->deviceType == ITMLibSettings::DEVICE_CUDA ? "cuda" : "cpu") << "\",\n"
+     << "    \"mapping\": \"" << (args.mapSurfels ? "voxels+surfels" : "voxels") << "\",\n"
+     << "    \"tracking\": \"" << (args.trackSurfels ? "surfels" : "voxels") << "\",\n"
+     << "    \"relocalisation\": " << (args.noRelocaliser ? "false" : "true") << ",\n"
+     << "    \"warmupFrames\": " << args.warmupFrameCount << ",\n"
+     << "    \"voxelBytes\": " << sizeof(SpaintVoxel) << ",\n"
+     << "    \"voxelColour\": " << (SpaintVoxel::hasColorInformation ? "true" : "false") << ",\n"
+#ifdef USE_LABEL_VOLUME
+     << "    \"labelVolume\": true\n"
+#else
+     << "    \"labelVolume\": false\n"
+#endif
+     << "  },\n"
+     << "  \"frames\": " << frameCount << ",\n"
+     << "  \"elapsedSeconds\": " << elapsedSeconds << ",\n"
+     << "  \"throughputFps\": " << (elapsedSeconds > 0.0 ? frameCount / elapsedSeconds : 0.0) << ",\n";
+
+  if(peakDeviceMemoryMB >= 0.0) os << "  \"peakDeviceMemoryMB\": " << peakDeviceMemoryMB << ",\n";
+  else os << "  \"peakDeviceMemoryMB\": null,\n";
+
+  // Note: In steady state, this should be zero, since per-frame temporaries are leased from the memory block factory's pool.
+  os << "  \"deviceAllocations\": " << deviceAllocationCount << ",\n";
+
+  // Report the size of the voxel scene's storage, so that runs with different voxel layouts (e.g. with and without colour) can be compared.
+  const size_t bytesPerBlock = SDF_BLOCK_SIZE3 * (sizeof(SpaintVoxel)
+#ifdef USE_LABEL_VOLUME
+    + sizeof(SpaintVoxel::PackedLabel)
+#endif
+  );
+  os << "  \"voxelScene\": {\"blockCapacity\": " << sceneOccupancy.blockCapacity << ", \"allocatedBlocks\": " << sceneOccupancy.allocatedBlockCount
+     << ", \"usedExcessEntries\": " << sceneOccupancy.usedExcessEntryCount << ", \"storageBytes\": " << sceneOccupancy.blockCapacity * bytesPerBlock
+     << ", \"allocatedBytes\": " << sceneOccupancy.allocatedBlockCount * bytesPerBlock << "},\n";
+
+  if(!frameDurationsMs.empty())
+  {
+    const DurationStats stats = compute_duration_stats(frameDurationsMs);
+    os << "  \"endToEnd\": {\"meanMs\": " << stats.meanMs << ", \"p50Ms\": " << stats.p50Ms << ", \"p90Ms\": " << stats.p90Ms
+       << ", \"p99Ms\": " << stats.p99Ms << ", \"maxMs\": " << stats.maxMs << "},\n";
+  }
+  else os << "  \"endToEnd\": null,\n";
+
+  os << "  \"stages\": [";
+  const std::vector<Profiler::StageStats> stageStats = Profiler::instance().get_stage_stats();
+  for(size_t i = 0, size = stageStats.size(); i < size; ++i)
+  {
+    const Profiler::StageStats& s = stageStats[i];
+    os << (i > 0 ? ",\n" : "\n")
+       << "    {\"name\": \"" << JSONUtil::escape_string(s.name) << "\", \"device\": \"" << (s.device == Profiler::DEVICE_GPU ? "gpu" : "cpu") << "\""
+       << ", \"count\": " << s.count << ", \"meanMs\": " << s.meanMs << ", \"p50Ms\": " << s.p50Ms
+       << ", \"p90Ms\": " << s.p90Ms << ", \"p99Ms\": " << s.p99Ms << '}';
+  }
+  os << "\n  ],\n";
+
+  os << "  \"memoryBlocks\": [";
+  const std::vector<MemoryBlockFactory::MemoryUsage> usages = MemoryBlockFactory::instance().get_memory_usage();
+  for(size_t i = 0, size = usages.size(); i < size; ++i)
+  {
+    const MemoryBlockFactory::MemoryUsage& u = usages[i];
+    os << (i > 0 ? ",\n" : "\n")
+       << "    {\"tag\": \"" << JSONUtil::escape_string(u.tag) << "\", \"blocks\": " << u.blockCount
+       << ", \"cpuBytes\": " << u.cpuBytes << ", \"gpuBytes\": " << u.gpuBytes << '}';
+  }
+  os << "\n  ]\n}\n";
+}
+
+int main(int argc, char *argv[])
+try
+{
+  // Parse the command-line arguments.
+  CommandLineArguments args;
+  if(!parse_command_line(argc, argv, args)) return 0;
+
+  // Construct the settings object. Note that we do not use the tracker configuration string in the InfiniTAM settings.
+  Settings_Ptr settings(new Settings);
+  settings->trackerConfig = NULL;
+  if(!args.noRelocaliser) settings->behaviourOnFailure = ITMLibSettings::FAILUREMODE_RELOCALISE;
+  MemoryBlockFactory::instance().set_device_type(settings->deviceType);
+
+  // Enable the profiler, keeping every duration from the measured frames so that the percentiles cover the whole run.
+  // We only keep a trace if one was requested, since it is not needed for the statistics.
+  Profiler& profiler = Profiler::instance();
+  profiler.set_thread_name("Main");
+  profiler.set_window_size(1000000);
+  profiler.set_max_trace_size(args.traceFilename != "" ? 1000000 : 0);
+  profiler.set_enabled(true);
+
+  // Construct the pipeline.
+  CompositeImageSourceEngine_Ptr imageSourceEngine = make_image_source_engine(args);
+  const std::string resourcesDir = find_subdir_from_executable("resources").string();
+  const std::string trackerConfig = "<tracker type='infinitam'/>";
+  const SLAMComponent::MappingMode mappingMode = args.mapSurfels ? SLAMComponent::MAP_BOTH : SLAMComponent::MAP_VOXELS_ONLY;
+  const SLAMComponent::TrackingMode trackingMode = args.trackSurfels ? SLAMComponent::TRACK_SURFELS : SLAMComponent::TRACK_VOXELS;
+
+  MultiScenePipeline_Ptr pipeline;
+  if(args.pipelineType == "slam")
+  {
+    pipeline.reset(new SLAMPipeline(settings, resourcesDir, imageSourceEngine, trackerConfig, mappingMode, trackingMode));
+  }
+  else if(args.pipelineType == "semantic")
+  {
+    const size_t maxLabelCount = 10;
+    const unsigned int seed = 12345;
+    pipeline.reset(new SemanticPipeline(settings, resourcesDir, maxLabelCount, imageSourceEngine, seed, trackerConfig, mappingMode, trackingMode));
+  }
+  else throw std::invalid_argument("Error: Unknown pipeline type: " + args.pipelineType);
+
+  pipeline->set_mode(parse_mode(args.mode));
+
+  // Replay the sequence through the pipeline, headless. Since SLAM is asynchronous on the GPU, we wait for each frame to
+  // finish before timing it, so that the end-to-end latencies are those of the whole frame rather than just its launches.
+  const std::string sceneID = Model::get_world_scene_id();
+  std::vector<double> frameDurationsMs;
+  double peakDeviceMemoryMB = -1.0;
+  Profiler::Clock::time_point measurementStart = Profiler::Clock::now();
+  size_t deviceAllocationCountAtStart = MemoryBlockFactory::instance().get_device_allocation_count();
+  size_t frameIndex = 0;
+
+  for(;; ++frameIndex)
+  {
+    if(frameIndex == args.warmupFrameCount)
+    {
+      // Discard any timings that were recorded during the warm-up.
+      profiler.update();
+      profiler.reset();
+      measurementStart = Profiler::Clock::now();
+      deviceAllocationCountAtStart = MemoryBlockFactory::instance().get_device_allocation_count();
+    }
+
+    if(args.maxFrameCount > 0 && frameIndex == args.warmupFrameCount + args.maxFrameCount) break;
+
+    const Profiler::Clock::time_point frameStart = Profiler::Clock::now();
+    if(!pipeline->run_main_section()) break;
+    pipeline->run_mode_specific_section(sceneID, pipeline->get_model()->get_slam_state(sceneID)->get_live_voxel_render_state());
+    DeviceUtil::synchronise(settings->deviceType);
+    const Profiler::Clock::time_point frameEnd = Profiler::Clock::now();
+
+    profiler.update();
+    if(frameIndex < args.warmupFrameCount) continue;
+
+    frameDurationsMs.push_back(boost::chrono::duration<double,boost::milli>(frameEnd - frameStart).count());
+
+#ifdef WITH_CUDA
+    // Note: This is the memory in use on the whole device, which includes that used by any other processes.
+    if(settings->deviceType == ITMLibSettings::DEVICE_CUDA)
+    {
+      size_t freeBytes, totalBytes;
+      ORcudaSafeCall(cudaMemGetInfo(&freeBytes, &totalBytes));
+      peakDeviceMemoryMB = std::max(peakDeviceMemoryMB, (totalBytes - freeBytes) / (1024.0 * 1024.0));
+    }
+#endif
+  }
+
+  const double elapsedSeconds = boost::chrono::duration<double>(Profiler::Clock::now() - measurementStart).count();
+  const size_t deviceAllocationCount = MemoryBlockFactory::instance().get_device_allocation_count() - deviceAllocationCountAtStart;
+  const SpaintVoxelScene::Occupancy sceneOccupancy = pipeline->get_model()->get_slam_state(sceneID)->get_voxel_scene()->get_occupancy();
+
+  // Write the results.
+  if(args.outputFilename != "")
+  {
+    std::ofstream fs(args.outputFilename.c_str());
+    if(!fs) throw std::runtime_error("Error: Could not open " + args.outputFilename + " for writing");
+    write_results(fs, args, settings, elapsedSeconds, frameDurationsMs, peakDeviceMemoryMB, deviceAllocationCount, sceneOccupancy);
+  }
+  else write_results(std::cout, args, settings, elapsedSeconds, frameDurationsMs, peakDeviceMemoryMB, deviceAllocationCount, sceneOccupancy);
+
+  if(args.traceFilename != "") profiler.export_chrome_trace(args.traceFilename);
+
+  return 0;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+/**
+ * touchtrain: DescriptorCache.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TOUCHTRAIN_DESCRIPTORCACHE
+#define H_TOUCHTRAIN_DESCRIPTORCACHE
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <rafl/examples/Example.h>
+
+#include "LabelledPath.h"
+
+/**
+ * \brief An instance of an instantiation of this class template represents a packed binary file containing the labelled
+ *        descriptors computed from the images in a touchtrain dataset.
+ *
+ * Computing the descriptors requires every image in the dataset to be loaded and decoded, which dominates the start-up time of
+ * a parameter sweep. The cache allows this to be done once: subsequent runs memory-map the file and read the descriptors from it.
+ *
+ * The file consists of the 8-byte signature "TTDESC01", followed by a 64-bit fingerprint of the labelled image paths from which
+ * the descriptors were computed (see compute_fingerprint), the number of examples (as a 32-bit integer) and the size of each
+ * descriptor (as a 32-bit integer). A record for each example follows: its label (as a 32-bit integer) and its descriptor
+ * (as an array of floats). All values are stored in the byte order of the machine that wrote the file.
+ */
+template <typename Label>
+class DescriptorCache
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef boost::shared_ptr<const rafl::Example<Label> > Example_CPtr;
+
+  //#################### PRIVATE STATIC CONSTANTS ####################
+private:
+  /** The size (in bytes) of the header of the file. */
+  static const size_t HEADER_SIZE = 24;
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Computes a fingerprint of a set of labelled image paths, which changes if any of the paths, labels or images does.
+   *
+   * The sizes and modification times of the images are included so that the cache is invalidated if an image is replaced.
+   *
+   * \param labelledImagePaths  The labelled image paths.
+   * \return                    The fingerprint.
+   */
+  static boost::uint64_t compute_fingerprint(const std::vector<LabelledPath<Label> >& labelledImagePaths)
+  {
+    size_t seed = 0;
+    for(size_t i = 0, size = labelledImagePaths.size(); i < size; ++i)
+    {
+      const LabelledPath<Label>& labelledPath = labelledImagePaths[i];
+      boost::hash_combine(seed, labelledPath.path);
+      boost::hash_combine(seed, labelledPath.label);
+
+      boost::system::error_code ec;
+      boost::hash_combine(seed, boost::filesystem::file_size(labelledPath.path, ec));
+      boost::hash_combine(seed, boost::filesystem::last_write_time(labelledPath.path, ec));
+    }
+    return static_cast<boost::uint64_t>(seed);
+  }
+
+  /**
+   * \brief Attempts to load a set of examples from a descriptor cache file.
+   *
+   * \param path                The path to the file.
+   * \param fingerprint         The fingerprint of the labelled image paths from which the cached descriptors must have been computed.
+   * \param examples            A vector into which to write the examples (if the file is loaded).
+   * \return                    true, if the file existed and matched the fingerprint, or false otherwise (in which case it should be rebuilt).
+   * \throws std::runtime_error If the file exists and matches the fingerprint, but is truncated.
+   */
+  static bool load(const std::string& path, boost::uint64_t fingerprint, std::vector<Example_CPtr>& examples)
+  {
+    if(!boost::filesystem::exists(path)) return false;
+
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+      file.open(path);
+    }
+    catch(std::exception&)
+    {
+      return false;
+    }
+
+    const char *data = file.data();
+    if(file.size() < HEADER_SIZE || memcmp(data, signature(), 8) != 0) return false;
+    if(read<boost::uint64_t>(data + 8) != fingerprint) return false;
+
+    const size_t exampleCount = read<boost::uint32_t>(data + 16);
+    const size_t descriptorSize = read<boost::uint32_t>(data + 20);
+    const size_t recordSize = sizeof(boost::int32_t) + descriptorSize * sizeof(float);
+    if(file.size() != HEADER_SIZE + exampleCount * recordSize)
+    {
+      throw std::runtime_error("Error: The descriptor cache '" + path + "' is truncated - delete it to rebuild it");
+    }
+
+    examples.resize(exampleCount);
+    for(size_t i = 0; i < exampleCount; ++i)
+    {
+      const char *record = data + HEADER_SIZE + i * recordSize;
+      const float *descriptorData = reinterpret_cast<const float*>(record + sizeof(boost::int32_t));
+      rafl::Descriptor_CPtr descriptor(new rafl::Descriptor(descriptorData, descriptorData + descriptorSize));
+      examples[i].reset(new rafl::Example<Label>(descriptor, static_cast<Label>(read<boost::int32_t>(record))));
+    }
+
+    return true;
+  }
+
+  /**
+   * \brief Saves a set of examples to a descriptor cache file.
+   *
+   * \param path                The path to the file.
+   * \param fingerprint         The fingerprint of the labelled image paths from which the descriptors were computed.
+   * \param examples            The examples (whose descriptors must all have the same size).
+   * \throws std::runtime_error If the file cannot be written, or the descriptors have different sizes.
+   */
+  static void save(const std::string& path, boost::uint64_t fingerprint, const std::vector<Example_CPtr>& examples)
+  {
+    const boost::uint32_t exampleCount = static_cast<boost::uint32_t>(examples.size());
+    const boost::uint32_t descriptorSize = examples.empty() ? 0 : static_cast<boost::uint32_t>(examples[0]->get_descriptor()->size());
+
+    // Write the file under a temporary name and then rename it, so that a partially-written cache is never loaded.
+    const std::string tempPath = path + ".tmp";
+    {
+      std::ofstream fs(tempPath.c_str(), std::ios::binary);
+      if(!fs) throw std::runtime_error("Error: Could not open " + tempPath + " for writing");
+
+      fs.write(signature(), 8);
+      write(fs, fingerprint);
+      write(fs, exampleCount);
+      write(fs, descriptorSize);
+
+      for(size_t i = 0; i < exampleCount; ++i)
+      {
+        const rafl::Descriptor& descriptor = *examples[i]->get_descriptor();
+        if(descriptor.size() != descriptorSize) throw std::runtime_error("Error: Cannot cache descriptors of different sizes");
+        write(fs, static_cast<boost::int32_t>(examples[i]->get_label()));
+        if(descriptorSize > 0) fs.write(reinterpret_cast<const char*>(&descriptor[0]), descriptorSize * sizeof(float));
+      }
+
+      if(!fs) throw std::runtime_error("Error: Could not write the descriptor cache to " + tempPath);
+    }
+
+    boost::filesystem::rename(tempPath, path);
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Reads a value from a (possibly unaligned) location in a memory-mapped file.
+   *
+   * \param p The location.
+   * \return  The value.
+   */
+  template <typename T>
+  static T read(const char *p)
+  {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+  }
+
+  /**
+   * \brief Gets the signature at the start of a descriptor cache file.
+   *
+   * \return  The signature at the start of a descriptor cache file.
+   */
+  static const char *signature()
+  {
+    return "TTDESC01";
+  }
+
+  /**
+   * \brief Writes a value to a binary stream.
+   *
+   * \param os    The stream.
+   * \param value The value.
+   */
+  template <typename T>
+  static void write(std::ostream& os, const T& value)
+  {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+};
+
+#endif
@@ -3,15 +3,18 @@
  * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
  */
 
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/assign/list_of.hpp>
 using boost::assign::list_of;
 
 #include <evaluation/core/ParamSetUtil.h>
+#include <evaluation/core/PerformanceLog.h>
 #include <evaluation/core/PerformanceTable.h>
 #include <evaluation/splitgenerators/CrossValidationSplitGenerator.h>
 #include <evaluation/util/CartesianProductParameterSetGenerator.h>
 using namespace evaluation;
 
+#include <rafl/core/CompiledRandomForest.h>
 #include <rafl/decisionfunctions/DecisionFunctionGeneratorFactory.h>
 using namespace rafl;
 
@@ -26,6 +29,7 @@ using namespace spaint;
 #include <tvgutil/timing/TimeUtil.h>
 using namespace tvgutil;
 
+#include "DescriptorCache.h"
 #include "LabelledPath.h"
 #include "TouchTrainDataset.h"
 
@@ -42,17 +46,22 @@ typedef boost::shared_ptr<RF> RF_Ptr;
 /**
  * \brief Generates an array of examples given an array of labelled image paths.
  *
+ * The images are loaded and their descriptors calculated in parallel, since this is dominated by the cost of decoding the images.
+ *
  * \param labelledImagePaths  The labelled image paths.
  * \return                    The examples.
  */
 std::vector<boost::shared_ptr<const Example<Label> > > generate_examples(const std::vector<LabelledPath<Label> >& labelledImagePaths)
 {
-  const size_t labelledImagePathCount = labelledImagePaths.size();
+  const int labelledImagePathCount = static_cast<int>(labelledImagePaths.size());
 
   typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
   std::vector<Example_CPtr> examples(labelledImagePathCount);
 
-  for(size_t i = 0; i < labelledImagePathCount; ++i)
+#ifdef WITH_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < labelledImagePathCount; ++i)
   {
     af::array img = af::loadImage(labelledImagePaths[i].path.c_str());
     Descriptor_CPtr descriptor = TouchDescriptorCalculator::calculate_histogram_descriptor(img);
@@ -62,11 +71,59 @@ std::vector<boost::shared_ptr<const Example<Label> > > generate_examples(const s
   return examples;
 }
 
+/**
+ * \brief Gets the examples for an array of labelled image paths, either from a descriptor cache or by generating them.
+ *
+ * If the cache does not exist, or was built from a different set of images, the examples are generated and the cache is rebuilt.
+ *
+ * \param labelledImagePaths  The labelled image paths.
+ * \param cachePath           The path to the descriptor cache.
+ * \return                    The examples.
+ */
+std::vector<boost::shared_ptr<const Example<Label> > > get_examples(const std::vector<LabelledPath<Label> >& labelledImagePaths, const std::string& cachePath)
+{
+  std::vector<Example_CPtr> examples;
+  const boost::uint64_t fingerprint = DescriptorCache<Label>::compute_fingerprint(labelledImagePaths);
+  if(DescriptorCache<Label>::load(cachePath, fingerprint, examples))
+  {
+    std::cout << "[touchtrain] Loaded the examples from the descriptor cache: " << cachePath << '\n';
+    return examples;
+  }
+
+  std::cout << "[touchtrain] Generating examples...\n";
+  examples = generate_examples(labelledImagePaths);
+
+  try
+  {
+    DescriptorCache<Label>::save(cachePath, fingerprint, examples);
+    std::cout << "[touchtrain] Saved the examples to the descriptor cache: " << cachePath << '\n';
+  }
+  catch(std::exception& e)
+  {
+    std::cerr << "Warning: Could not save the descriptor cache (" << e.what() << ")\n";
+  }
+
+  return examples;
+}
+
 int main(int argc, char *argv[])
+try
 {
-  if(argc != 2)
+  // Separate the options from the positional arguments.
+  std::vector<std::string> args;
+  std::string cachePath, logPath, shardSpec;
+  for(int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if(arg == "--cache" && i + 1 < argc) cachePath = argv[++i];
+    else if(arg == "--log" && i + 1 < argc) logPath = argv[++i];
+    else if(arg == "--shard" && i + 1 < argc) shardSpec = argv[++i];
+    else args.push_back(arg);
+  }
+
+  if(args.size() != 1)
   {
-    std::cerr << "Usage: touchtrain [<touch training set path>]\n";
+    std::cerr << "Usage: touchtrain [--shard <i>/<n>] [--log <log file>] [--cache <descriptor cache file>] <touch training set path>\n";
     return EXIT_FAILURE;
   }
 
@@ -74,12 +131,13 @@ int main(int argc, char *argv[])
   omp_set_nested(1);
 #endif
 
-  TouchTrainDataset<Label> dataset(argv[1], list_of(2)(3)(4)(5));
+  TouchTrainDataset<Label> dataset(args[0], list_of(2)(3)(4)(5));
   std::cout << "[touchtrain] Training set root: " << dataset.get_root_directory() << '\n';
 
-  // Generate the examples with which to train the random forest.
-  std::cout << "[touchtrain] Generating examples...\n";
-  std::vector<Example_CPtr> examples = generate_examples(dataset.get_training_image_paths());
+  // Get the examples with which to train the random forest. These are cached in the dataset's root directory (unless
+  // another cache file is specified), so that the images only need to be decoded the first time the dataset is used.
+  if(cachePath.empty()) cachePath = dataset.get_root_directory() + "/descriptorcache.bin";
+  std::vector<Example_CPtr> examples = get_examples(dataset.get_training_image_paths(), cachePath);
   std::cout << "[touchtrain] Number of examples = " << examples.size() << '\n';
 
   // Generate the parameter sets with which to test the random forest.
@@ -101,6 +159,25 @@ int main(int argc, char *argv[])
     .add_param("usePMFReweighting", list_of<bool>(false)(true))
     .generate_param_sets();
 
+  // If requested, restrict the sweep to a single shard of the parameter sets, so that it can be spread across several processes.
+  if(!shardSpec.empty())
+  {
+    params = ParamSetUtil::select_shard(params, shardSpec);
+    std::cout << "[touchtrain] Evaluating shard " << shardSpec << " (" << params.size() << " parameter sets)\n";
+  }
+
+  // Open the log to which to append the results for each parameter set as soon as they are available. If the log
+  // already exists (e.g. because a previous run crashed), the parameter sets it contains will not be re-evaluated.
+  if(logPath.empty())
+  {
+    logPath = dataset.get_cross_validation_results_directory() + "/crossvalidationlog";
+    if(!shardSpec.empty()) logPath += "-shard" + boost::replace_all_copy(shardSpec, "/", "of");
+    logPath += ".txt";
+  }
+
+  PerformanceLog log(logPath);
+  std::cout << "[touchtrain] Result log: " << logPath << " (" << log.get_entries().size() << " existing entries)\n";
+
   // Register the relevant decision function generators with the factory.
   DecisionFunctionGeneratorFactory<Label>::instance().register_rafl_makers();
 
@@ -117,8 +194,17 @@ int main(int argc, char *argv[])
   boost::shared_ptr<RandomForestEvaluator<Label> > evaluator;
   for(size_t n = 0, size = params.size(); n < size; ++n)
   {
+    // If the results for this parameter set are already in the log, reuse them rather than re-evaluating the forest.
+    const PerformanceResult *loggedResult = log.find_result(params[n]);
+    if(loggedResult)
+    {
+      results.record_performance(params[n], *loggedResult);
+      continue;
+    }
+
     evaluator.reset(new RandomForestEvaluator<Label>(splitGenerator, params[n]));
     PerformanceResult result = evaluator->evaluate(examples);
+    log.record_performance(params[n], result);
     results.record_performance(params[n], result);
   }
 
@@ -138,6 +224,14 @@ int main(int argc, char *argv[])
   if(resultsFile) results.output(resultsFile);
   else std::cout << "[touchtrain] Warning could not open file for writing...\n";
 
+  // If we only evaluated one shard of the sweep, the best parameters can only be chosen once the logs for all
+  // of the shards have been merged (using perfmerge), so stop here.
+  if(!shardSpec.empty())
+  {
+    std::cout << "[touchtrain] Not training a final forest, since only shard " << shardSpec << " was evaluated\n";
+    return 0;
+  }
+
   // Train a forest with the best parameters selected during cross-validation.
   std::cout << "[touchtrain] Training the forest with the best parameters selected during cross-validation...\n";
   ParamSet bestParams = results.find_best_param_set("Accuracy");
@@ -154,5 +248,15 @@ int main(int argc, char *argv[])
   std::cout << "[touchtrain] Saving the forest to: " << forestPath << "\n";
   SerializationUtil::save_text(forestPath, *randomForest);
 
+  // Also save a compiled (inference-only) version of the forest, which is much smaller and faster to load.
+  std::string compiledForestPath = dataset.get_models_directory() + "/randomForest-" + timestamp + ".crf";
+  std::cout << "[touchtrain] Saving the compiled forest to: " << compiledForestPath << "\n";
+  CompiledRandomForest<Label>(*randomForest).save(compiledForestPath);
+
   return 0;
 }
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
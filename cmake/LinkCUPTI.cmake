@@ -0,0 +1,7 @@
+###################
+# LinkCUPTI.cmake #
+###################
+
+IF(WITH_CUPTI)
+  TARGET_LINK_LIBRARIES(${targetname} ${CUPTI_LIBRARY} ${CUDA_CUDA_LIBRARY})
+ENDIF()
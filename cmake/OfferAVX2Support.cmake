@@ -0,0 +1,15 @@
+##########################
+# OfferAVX2Support.cmake #
+##########################
+
+OPTION(WITH_AVX2 "Build with AVX2 support?" OFF)
+
+IF(WITH_AVX2)
+  IF(MSVC_IDE)
+    SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /arch:AVX2")
+  ELSE()
+    SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2")
+  ENDIF()
+
+  ADD_DEFINITIONS(-DWITH_AVX2)
+ENDIF()
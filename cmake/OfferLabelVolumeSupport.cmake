@@ -0,0 +1,9 @@
+##################################
+# OfferLabelVolumeSupport.cmake #
+##################################
+
+OPTION(USE_LABEL_VOLUME "Store the semantic labels of the voxels in a separate label volume?" OFF)
+
+IF(USE_LABEL_VOLUME)
+  ADD_DEFINITIONS(-DUSE_LABEL_VOLUME)
+ENDIF()
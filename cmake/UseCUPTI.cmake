@@ -0,0 +1,18 @@
+##################
+# UseCUPTI.cmake #
+##################
+
+IF(WITH_CUDA)
+  OPTION(WITH_CUPTI "Build with CUPTI kernel metrics support?" OFF)
+ELSE()
+  SET(WITH_CUPTI OFF CACHE BOOL "Build with CUPTI kernel metrics support?" FORCE)
+ENDIF()
+
+IF(WITH_CUPTI)
+  FIND_PATH(CUPTI_INCLUDE_DIR cupti.h HINTS "${CUDA_TOOLKIT_ROOT_DIR}/extras/CUPTI/include")
+  FIND_LIBRARY(CUPTI_LIBRARY cupti HINTS "${CUDA_TOOLKIT_ROOT_DIR}/extras/CUPTI/lib64" "${CUDA_TOOLKIT_ROOT_DIR}/extras/CUPTI/lib" "${CUDA_TOOLKIT_ROOT_DIR}/extras/CUPTI/libx64")
+
+  INCLUDE_DIRECTORIES(${CUPTI_INCLUDE_DIR})
+
+  ADD_DEFINITIONS(-DWITH_CUPTI)
+ENDIF()
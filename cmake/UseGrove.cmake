@@ -3,6 +3,8 @@
 ##################
 
 IF(BUILD_GROVE)
+  INCLUDE(${PROJECT_SOURCE_DIR}/cmake/OfferAVX2Support.cmake)
+
   INCLUDE_DIRECTORIES(${PROJECT_SOURCE_DIR}/modules/grove/include)
   INCLUDE_DIRECTORIES(${PROJECT_SOURCE_DIR}/modules/tvgutil/include)
 
@@ -6,6 +6,10 @@
 #ifndef H_EVALUATION_LEARNEREVALUATOR
 #define H_EVALUATION_LEARNEREVALUATOR
 
+#include <boost/bind.hpp>
+
+#include <tvgutil/misc/ParallelUtil.h>
+
 #include "../splitgenerators/SplitGenerator.h"
 
 namespace evaluation {
@@ -58,11 +62,16 @@ protected:
   /**
    * \brief Evaluates the learner on the specified split of examples.
    *
-   * \param examples  The examples on which to evaluate the learner.
-   * \param split     The way in which the examples should be split into training and validation sets.
-   * \return          The results of evaluating the learner on the specified split.
+   * Since the splits are evaluated concurrently, implementations must be safe to call concurrently for different splits.
+   * Any randomness used by an implementation should be derived deterministically from the split index, so that the
+   * results of the evaluation do not depend on the order in which the splits happen to be evaluated.
+   *
+   * \param examples    The examples on which to evaluate the learner.
+   * \param split       The way in which the examples should be split into training and validation sets.
+   * \param splitIndex  The index of the split in the list of splits being evaluated.
+   * \return            The results of evaluating the learner on the specified split.
    */
-  virtual Result evaluate_on_split(const std::vector<Example_CPtr>& examples, const SplitGenerator::Split& split) const = 0;
+  virtual Result evaluate_on_split(const std::vector<Example_CPtr>& examples, const SplitGenerator::Split& split, size_t splitIndex) const = 0;
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -74,25 +83,33 @@ public:
    */
   Result evaluate(const std::vector<Example_CPtr>& examples) const
   {
-    std::vector<Result> results;
     std::vector<SplitGenerator::Split> splits = m_splitGenerator->generate_splits(examples.size());
     int size = static_cast<int>(splits.size());
 
-#ifdef WITH_OPENMP
-    #pragma omp parallel for
-#endif
-    for(int i = 0; i < size; ++i)
-    {
-      Result evaluationResult = evaluate_on_split(examples, splits[i]);
-
-#ifdef WITH_OPENMP
-      #pragma omp critical
-#endif
-      results.push_back(evaluationResult);
-    }
+    // Evaluate the learner on the splits in parallel. Each split writes its results into its own element of the
+    // results array, so no synchronisation is needed, and the results are always averaged in split order.
+    std::vector<Result> results(size);
+    tvgutil::ParallelUtil::parallel_for(0, size, boost::bind(
+      &LearnerEvaluator::evaluate_split, this, _1, boost::cref(examples), boost::cref(splits), boost::ref(results)
+    ));
 
     return average_results(results);
   }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Evaluates the learner on one of the splits of a set of examples.
+   *
+   * \param i         The index of the split.
+   * \param examples  The examples on which to evaluate the learner.
+   * \param splits    The splits of the examples.
+   * \param results   The array into whose i'th element to write the results of evaluating the learner on the split.
+   */
+  void evaluate_split(int i, const std::vector<Example_CPtr>& examples, const std::vector<SplitGenerator::Split>& splits, std::vector<Result>& results) const
+  {
+    results[i] = evaluate_on_split(examples, splits[i], static_cast<size_t>(i));
+  }
 };
 
 }
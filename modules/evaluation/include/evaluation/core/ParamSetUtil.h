@@ -8,6 +8,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace evaluation {
 
@@ -29,6 +30,20 @@ struct ParamSetUtil
    * \return          A string representation of the parameter set.
    */
   static std::string param_set_to_string(const ParamSet& paramSet);
+
+  /**
+   * \brief Selects the subset of a list of parameter sets that belongs to a particular shard.
+   *
+   * The parameter sets are dealt out to the shards in a round-robin fashion, so shard i of n contains
+   * the parameter sets whose indices are congruent to i modulo n. This allows a parameter sweep to be
+   * spread across several processes (or machines), each of which evaluates a different shard.
+   *
+   * \param paramSets   The parameter sets.
+   * \param shardSpec   A shard specification of the form "i/n", where n is the number of shards and i (in [0,n)) is the shard to select.
+   * \return            The parameter sets in the specified shard.
+   * \throws std::runtime_error If the shard specification is invalid.
+   */
+  static std::vector<ParamSet> select_shard(const std::vector<ParamSet>& paramSets, const std::string& shardSpec);
 };
 
 }
@@ -0,0 +1,114 @@
+/**
+ * evaluation: PerformanceLog.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_EVALUATION_PERFORMANCELOG
+#define H_EVALUATION_PERFORMANCELOG
+
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include "PerformanceTable.h"
+
+namespace evaluation {
+
+/**
+ * \brief An instance of this class represents an append-only log of the performance results obtained for various different sets of parameters.
+ *
+ * Each result is appended to the log file (and flushed) as soon as it is recorded, so that a long-running parameter sweep
+ * that crashes or is killed can be resumed by skipping the parameter sets that are already in the log. The logs from the
+ * different shards of a sweep can later be merged into a single performance table.
+ *
+ * Each line of the log contains one entry, as a tab-separated list of fields: the number of parameters, followed by
+ * the name and value of each parameter, followed by the number of measures, followed by the name, sample count, mean
+ * and standard deviation of each measure. A truncated final line (e.g. as a result of a crash) is ignored on loading.
+ */
+class PerformanceLog
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef std::pair<ParamSet,PerformanceResult> Entry;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The entries in the log. */
+  std::vector<Entry> m_entries;
+
+  /** The stream used to append entries to the log file. */
+  std::ofstream m_fs;
+
+  /** The path to the log file. */
+  std::string m_path;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Opens a performance log, loading any entries that have already been written to it.
+   *
+   * If the log file does not exist, it will be created.
+   *
+   * \param path  The path to the log file.
+   * \throws std::runtime_error If the log file cannot be opened, or contains a malformed entry (other than a truncated final line).
+   */
+  explicit PerformanceLog(const std::string& path);
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  PerformanceLog(const PerformanceLog&);
+  PerformanceLog& operator=(const PerformanceLog&);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Loads the entries from a performance log file.
+   *
+   * \param path  The path to the log file.
+   * \return      The entries in the log file.
+   * \throws std::runtime_error If the log file cannot be read, or contains a malformed entry (other than a truncated final line).
+   */
+  static std::vector<Entry> load_entries(const std::string& path);
+
+  /**
+   * \brief Merges the entries from several performance log files into a single performance table.
+   *
+   * If the same parameter set occurs more than once, only the first occurrence is used.
+   *
+   * \param paths The paths to the log files.
+   * \return      The merged performance table.
+   * \throws std::runtime_error If any of the log files cannot be read, or contains a malformed entry.
+   */
+  static PerformanceTable merge(const std::vector<std::string>& paths);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Looks up the performance result (if any) that has been recorded in the log for the specified parameter set.
+   *
+   * \param params  The parameter set.
+   * \return        A pointer to the recorded result, if any, or NULL otherwise.
+   */
+  const PerformanceResult *find_result(const ParamSet& params) const;
+
+  /**
+   * \brief Gets the entries in the log.
+   *
+   * \return  The entries in the log.
+   */
+  const std::vector<Entry>& get_entries() const;
+
+  /**
+   * \brief Records the performance of the algorithm when run with the specified set of parameters, and appends it to the log file.
+   *
+   * \param params  The parameters that were used when running the algorithm.
+   * \param result  The performance result for the algorithm when run with that set of parameters.
+   * \throws std::runtime_error If the entry cannot be written to the log file.
+   */
+  void record_performance(const ParamSet& params, const PerformanceResult& result);
+};
+
+}
+
+#endif
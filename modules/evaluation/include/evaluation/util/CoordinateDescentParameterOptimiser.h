@@ -6,8 +6,11 @@
 #ifndef H_EVALUATION_COORDINATEDESCENTPARAMETEROPTIMISER
 #define H_EVALUATION_COORDINATEDESCENTPARAMETEROPTIMISER
 
+#include <map>
+
 #include <boost/function.hpp>
 #include <boost/spirit/home/support/detail/hold_any.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <tvgutil/numbers/RandomNumberGenerator.h>
 
@@ -17,15 +20,26 @@ namespace evaluation {
 
 /**
  * \brief An instance of this class uses coordinate descent with random restarts to find a parameter set with as low a cost as possible.
+ *
+ * The random restarts, and the candidate values along each coordinate, are evaluated in parallel on the task scheduler,
+ * and the costs of parameter sets that have already been evaluated are memoised. All random choices are made up-front
+ * on the calling thread, so the result of the optimisation is the same as if it had been performed sequentially.
  */
 class CoordinateDescentParameterOptimiser
 {
   //#################### TYPEDEFS ####################
 private:
   typedef boost::function<float(const ParamSet&)> CostFunction;
+  typedef std::pair<std::vector<size_t>,float> Descent;
 
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The memoised costs of the parameter sets evaluated so far, keyed by their parameter value indices. */
+  mutable std::map<std::vector<size_t>,float> m_costCache;
+
+  /** The mutex used to synchronise access to the cost cache. */
+  mutable boost::mutex m_costCacheMutex;
+
   /** The cost function to use to evaluate the different parameter sets. */
   CostFunction m_costFunction;
 
@@ -43,7 +57,7 @@ public:
   /**
    * \brief Constructs a coordinate descent parameter optimiser.
    *
-   * \param costFunction  The cost function to use to evaluate the different parameter sets.
+   * \param costFunction  The cost function to use to evaluate the different parameter sets (must be safe to call concurrently).
    * \param epochCount    The number of epochs for which coordinate descent should be run.
    * \param seed          The seed for the random number generator.
    */
@@ -88,11 +102,22 @@ private:
    * \brief Computes the cost associated with setting the parameters being optimised to the values denoted by the
    *        specified parameter value indices.
    *
+   * The cost of each distinct set of parameter value indices is memoised, so that it is only computed once.
+   *
    * \param valueIndices  A set of parameter value indices, denoting particular settings for the parameters.
    * \return              The cost associated with setting the parameters being optimised to the denoted values.
    */
   float compute_cost(const std::vector<size_t>& valueIndices) const;
 
+  /**
+   * \brief Computes the cost associated with one of a number of sets of parameter value indices.
+   *
+   * \param i                 The index of the set of parameter value indices whose cost should be computed.
+   * \param valueIndicesSets  The sets of parameter value indices.
+   * \param costs             The array into whose i'th element to write the cost.
+   */
+  void compute_cost_for(int i, const std::vector<std::vector<size_t> >& valueIndicesSets, std::vector<float>& costs) const;
+
   /**
    * \brief Generates a random set of parameter value indices, denoting particular settings for the parameters.
    *
@@ -113,9 +138,21 @@ private:
    *        in order to minimise the associated cost.
    *
    * \param initialValueIndices The initial set of parameter value indices.
+   * \param startingParamIndex  The index of the first parameter to optimise.
    * \return                    An optimised set of parameter value indices and the associated cost.
    */
-  std::pair<std::vector<size_t>,float> perform_coordinate_descent(const std::vector<size_t>& initialValueIndices) const;
+  Descent perform_coordinate_descent(const std::vector<size_t>& initialValueIndices, size_t startingParamIndex) const;
+
+  /**
+   * \brief Performs the coordinate descent for one of the epochs of the optimisation.
+   *
+   * \param i                     The index of the epoch.
+   * \param initialValueIndices   The initial sets of parameter value indices for the epochs.
+   * \param startingParamIndices  The indices of the first parameters to optimise for the epochs.
+   * \param descents              The array into whose i'th element to write the result of the coordinate descent.
+   */
+  void perform_epoch(int i, const std::vector<std::vector<size_t> >& initialValueIndices, const std::vector<size_t>& startingParamIndices,
+                     std::vector<Descent>& descents) const;
 };
 
 }
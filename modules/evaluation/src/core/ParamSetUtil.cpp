@@ -6,6 +6,9 @@
 #include "core/ParamSetUtil.h"
 
 #include <iostream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
 
 namespace evaluation {
 
@@ -24,4 +27,34 @@ std::string ParamSetUtil::param_set_to_string(const ParamSet& params)
   return paramString;
 }
 
+std::vector<ParamSet> ParamSetUtil::select_shard(const std::vector<ParamSet>& paramSets, const std::string& shardSpec)
+{
+  // Parse the shard specification.
+  size_t shardIndex = 0, shardCount = 0;
+  size_t slashPos = shardSpec.find('/');
+  try
+  {
+    if(slashPos == std::string::npos) throw boost::bad_lexical_cast();
+    shardIndex = boost::lexical_cast<size_t>(shardSpec.substr(0, slashPos));
+    shardCount = boost::lexical_cast<size_t>(shardSpec.substr(slashPos + 1));
+  }
+  catch(boost::bad_lexical_cast&)
+  {
+    throw std::runtime_error("Error: Invalid shard specification '" + shardSpec + "' (expected i/n)");
+  }
+
+  if(shardCount == 0 || shardIndex >= shardCount)
+  {
+    throw std::runtime_error("Error: Invalid shard specification '" + shardSpec + "' (the shard index must be in [0,n))");
+  }
+
+  // Select the parameter sets in the shard.
+  std::vector<ParamSet> shard;
+  for(size_t i = shardIndex, size = paramSets.size(); i < size; i += shardCount)
+  {
+    shard.push_back(paramSets[i]);
+  }
+  return shard;
+}
+
 }
@@ -0,0 +1,235 @@
+/**
+ * evaluation: PerformanceLog.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "core/PerformanceLog.h"
+
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace evaluation {
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Converts a performance log entry to a line of tab-separated fields.
+ *
+ * \param params  The parameter set for the entry.
+ * \param result  The performance result for the entry.
+ * \return        The line (including the trailing newline).
+ * \throws std::runtime_error If any of the parameter names, values or measure names contains a tab or newline.
+ */
+static std::string entry_to_line(const ParamSet& params, const PerformanceResult& result)
+{
+  std::vector<std::string> fields;
+  fields.push_back(boost::lexical_cast<std::string>(params.size()));
+  for(ParamSet::const_iterator it = params.begin(), iend = params.end(); it != iend; ++it)
+  {
+    fields.push_back(it->first);
+    fields.push_back(it->second);
+  }
+
+  fields.push_back(boost::lexical_cast<std::string>(result.size()));
+  for(PerformanceResult::const_iterator it = result.begin(), iend = result.end(); it != iend; ++it)
+  {
+    fields.push_back(it->first);
+    fields.push_back(boost::lexical_cast<std::string>(it->second.get_sample_count()));
+    fields.push_back(boost::lexical_cast<std::string>(it->second.get_mean()));
+    fields.push_back(boost::lexical_cast<std::string>(it->second.get_std_dev()));
+  }
+
+  std::string line;
+  for(size_t i = 0, size = fields.size(); i < size; ++i)
+  {
+    if(fields[i].find_first_of("\t\r\n") != std::string::npos)
+    {
+      throw std::runtime_error("Error: Cannot write '" + fields[i] + "' to a performance log, since it contains a tab or newline");
+    }
+
+    if(i > 0) line += '\t';
+    line += fields[i];
+  }
+
+  return line + '\n';
+}
+
+/**
+ * \brief Attempts to parse a line of tab-separated fields as a performance log entry.
+ *
+ * \param line  The line (without its trailing newline).
+ * \param entry A place in which to store the entry.
+ * \return      true, if the line was successfully parsed, or false otherwise.
+ */
+static bool parse_line(const std::string& line, PerformanceLog::Entry& entry)
+{
+  // Split the line into fields (note that fields may be empty, e.g. for parameters whose value is the empty string).
+  std::vector<std::string> fields;
+  size_t start = 0;
+  for(;;)
+  {
+    size_t tabPos = line.find('\t', start);
+    fields.push_back(line.substr(start, tabPos == std::string::npos ? std::string::npos : tabPos - start));
+    if(tabPos == std::string::npos) break;
+    start = tabPos + 1;
+  }
+
+  try
+  {
+    size_t f = 0;
+
+    // Read the parameters.
+    size_t paramCount = boost::lexical_cast<size_t>(fields.at(f++));
+    for(size_t i = 0; i < paramCount; ++i)
+    {
+      const std::string& param = fields.at(f++);
+      entry.first[param] = fields.at(f++);
+    }
+
+    // Read the measures.
+    size_t measureCount = boost::lexical_cast<size_t>(fields.at(f++));
+    for(size_t i = 0; i < measureCount; ++i)
+    {
+      const std::string& measureName = fields.at(f++);
+      size_t sampleCount = boost::lexical_cast<size_t>(fields.at(f++));
+      float mean = boost::lexical_cast<float>(fields.at(f++));
+      float stdDev = boost::lexical_cast<float>(fields.at(f++));
+      entry.second.insert(std::make_pair(measureName, PerformanceMeasure(sampleCount, mean, stdDev)));
+    }
+
+    // Check that the entire line was used.
+    return f == fields.size();
+  }
+  catch(std::exception&)
+  {
+    return false;
+  }
+}
+
+/**
+ * \brief Reads the entries from a performance log file.
+ *
+ * \param path    The path to the log file.
+ * \param entries A place in which to store the entries.
+ * \return        The length (in bytes) of the part of the file that contains complete lines.
+ * \throws std::runtime_error If the log file cannot be read, or contains a malformed entry (other than a truncated final line).
+ */
+static boost::uintmax_t read_log(const std::string& path, std::vector<PerformanceLog::Entry>& entries)
+{
+  std::ifstream fs(path.c_str(), std::ios::binary);
+  if(!fs) throw std::runtime_error("Error: Could not open performance log '" + path + "' for reading");
+
+  boost::uintmax_t validLength = 0;
+  std::string line;
+  for(size_t lineIndex = 1; std::getline(fs, line); ++lineIndex)
+  {
+    // If the line is not terminated by a newline, it was only partially written, so ignore it.
+    if(fs.eof()) break;
+
+    validLength += line.length() + 1;
+    if(line.empty()) continue;
+
+    PerformanceLog::Entry entry;
+    if(!parse_line(line, entry))
+    {
+      throw std::runtime_error("Error: Malformed entry on line " + boost::lexical_cast<std::string>(lineIndex) + " of performance log '" + path + "'");
+    }
+
+    entries.push_back(entry);
+  }
+
+  return validLength;
+}
+
+//#################### CONSTRUCTORS ####################
+
+PerformanceLog::PerformanceLog(const std::string& path)
+: m_path(path)
+{
+  if(boost::filesystem::exists(path))
+  {
+    // Load the existing entries, and discard any partially-written line at the end of the file,
+    // so that the next entry we append starts on a line of its own.
+    boost::uintmax_t validLength = read_log(path, m_entries);
+    if(validLength != boost::filesystem::file_size(path)) boost::filesystem::resize_file(path, validLength);
+  }
+
+  m_fs.open(path.c_str(), std::ios::app);
+  if(!m_fs) throw std::runtime_error("Error: Could not open performance log '" + path + "' for writing");
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+std::vector<PerformanceLog::Entry> PerformanceLog::load_entries(const std::string& path)
+{
+  std::vector<Entry> entries;
+  read_log(path, entries);
+  return entries;
+}
+
+PerformanceTable PerformanceLog::merge(const std::vector<std::string>& paths)
+{
+  std::vector<Entry> entries;
+  std::set<ParamSet> seenParamSets;
+  std::set<std::string> measureNames;
+
+  for(size_t i = 0, pathCount = paths.size(); i < pathCount; ++i)
+  {
+    std::vector<Entry> logEntries = load_entries(paths[i]);
+    for(size_t j = 0, entryCount = logEntries.size(); j < entryCount; ++j)
+    {
+      const Entry& entry = logEntries[j];
+      if(!seenParamSets.insert(entry.first).second) continue;
+
+      for(PerformanceResult::const_iterator it = entry.second.begin(), iend = entry.second.end(); it != iend; ++it)
+      {
+        measureNames.insert(it->first);
+      }
+
+      entries.push_back(entry);
+    }
+  }
+
+  PerformanceTable table(std::vector<std::string>(measureNames.begin(), measureNames.end()));
+  for(size_t i = 0, size = entries.size(); i < size; ++i)
+  {
+    table.record_performance(entries[i].first, entries[i].second);
+  }
+
+  return table;
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+const PerformanceResult *PerformanceLog::find_result(const ParamSet& params) const
+{
+  for(size_t i = 0, size = m_entries.size(); i < size; ++i)
+  {
+    if(m_entries[i].first == params) return &m_entries[i].second;
+  }
+
+  return NULL;
+}
+
+const std::vector<PerformanceLog::Entry>& PerformanceLog::get_entries() const
+{
+  return m_entries;
+}
+
+void PerformanceLog::record_performance(const ParamSet& params, const PerformanceResult& result)
+{
+  std::string line = entry_to_line(params, result);
+
+  // Write and flush the entry straight away, so that it survives if the process later crashes.
+  m_fs << line;
+  m_fs.flush();
+  if(!m_fs) throw std::runtime_error("Error: Could not write to performance log '" + m_path + "'");
+
+  m_entries.push_back(std::make_pair(params, result));
+}
+
+}
@@ -39,6 +39,9 @@ const ParamSet& PerformanceTable::find_best_param_set(const std::string& measure
 
 void PerformanceTable::output(std::ostream& os, const std::string& delimiter) const
 {
+  // If no results have been recorded (e.g. for an empty shard of a parameter sweep), there is nothing to output.
+  if(m_results.empty()) return;
+
   // Output the titles for the parameter columns.
   os << "ParameterString" << delimiter;
   const ParamSet& firstSet = m_results[0].first;
@@ -8,10 +8,14 @@
 #include <limits>
 
 #include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 using boost::assign::list_of;
 using boost::spirit::hold_any;
 
+#include <tvgutil/misc/ParallelUtil.h>
+using namespace tvgutil;
+
 namespace evaluation {
 
 //#################### CONSTRUCTORS ####################
@@ -30,25 +34,34 @@ CoordinateDescentParameterOptimiser& CoordinateDescentParameterOptimiser::add_pa
 
 ParamSet CoordinateDescentParameterOptimiser::optimise_for_parameters(float *bestCost) const
 {
-  std::vector<size_t> bestValueIndicesAllTime;
-  float bestCostAllTime = std::numeric_limits<float>::max();
-
-  // For each epoch:
+  // Randomly generate an initial set of parameter value indices and a starting parameter for each epoch. This is done
+  // up-front (and in the same order as it would be done if the epochs were run one after the other), so that the result
+  // of the optimisation does not depend on the order in which the epochs are scheduled.
+  size_t paramCount = m_paramValues.size();
+  std::vector<std::vector<size_t> > initialValueIndices(m_epochCount);
+  std::vector<size_t> startingParamIndices(m_epochCount);
   for(size_t i = 0; i < m_epochCount; ++i)
   {
-    // Randomly generate an initial set of parameter value indices.
-    std::vector<size_t> initialValueIndices = generate_random_value_indices();
+    initialValueIndices[i] = generate_random_value_indices();
+    startingParamIndices[i] = m_rng.generate_int_from_uniform(0, static_cast<int>(paramCount) - 1);
+  }
 
-    // Optimise the initial set of parameter value indices using coordinate descent.
-    std::vector<size_t> optimisedValueIndices;
-    float optimisedCost;
-    boost::tie(optimisedValueIndices, optimisedCost) = perform_coordinate_descent(initialValueIndices);
+  // Optimise the initial sets of parameter value indices using coordinate descent, running the epochs in parallel.
+  std::vector<Descent> descents(m_epochCount);
+  ParallelUtil::parallel_for(0, static_cast<int>(m_epochCount), boost::bind(
+    &CoordinateDescentParameterOptimiser::perform_epoch, this, _1, boost::cref(initialValueIndices), boost::cref(startingParamIndices), boost::ref(descents)
+  ));
 
+  // Find the best parameter value indices over all of the epochs.
+  std::vector<size_t> bestValueIndicesAllTime;
+  float bestCostAllTime = std::numeric_limits<float>::max();
+  for(size_t i = 0; i < m_epochCount; ++i)
+  {
     // If the optimised cost is the best we've seen so far, update the best cost and best parameter value indices.
-    if(optimisedCost < bestCostAllTime)
+    if(descents[i].second < bestCostAllTime)
     {
-      bestCostAllTime = optimisedCost;
-      bestValueIndicesAllTime = optimisedValueIndices;
+      bestCostAllTime = descents[i].second;
+      bestValueIndicesAllTime = descents[i].first;
     }
   }
 
@@ -61,7 +74,25 @@ ParamSet CoordinateDescentParameterOptimiser::optimise_for_parameters(float *bes
 
 float CoordinateDescentParameterOptimiser::compute_cost(const std::vector<size_t>& valueIndices) const
 {
-  return m_costFunction(make_param_set(valueIndices));
+  // If the cost for these parameter value indices has already been computed, return it.
+  {
+    boost::lock_guard<boost::mutex> lock(m_costCacheMutex);
+    std::map<std::vector<size_t>,float>::const_iterator it = m_costCache.find(valueIndices);
+    if(it != m_costCache.end()) return it->second;
+  }
+
+  // Otherwise, compute it (without holding the lock, so that other costs can be computed concurrently) and cache it.
+  // Note that in the rare case that two threads need the same uncached cost at the same time, both will compute it.
+  float cost = m_costFunction(make_param_set(valueIndices));
+
+  boost::lock_guard<boost::mutex> lock(m_costCacheMutex);
+  m_costCache.insert(std::make_pair(valueIndices, cost));
+  return cost;
+}
+
+void CoordinateDescentParameterOptimiser::compute_cost_for(int i, const std::vector<std::vector<size_t> >& valueIndicesSets, std::vector<float>& costs) const
+{
+  costs[i] = compute_cost(valueIndicesSets[i]);
 }
 
 std::vector<size_t> CoordinateDescentParameterOptimiser::generate_random_value_indices() const
@@ -86,7 +117,8 @@ ParamSet CoordinateDescentParameterOptimiser::make_param_set(const std::vector<s
   return paramSet;
 }
 
-std::pair<std::vector<size_t>,float> CoordinateDescentParameterOptimiser::perform_coordinate_descent(const std::vector<size_t>& initialValueIndices) const
+CoordinateDescentParameterOptimiser::Descent
+CoordinateDescentParameterOptimiser::perform_coordinate_descent(const std::vector<size_t>& initialValueIndices, size_t startingParamIndex) const
 {
   // Invariant: currentCost = compute_cost(currentValueIndices)
 
@@ -96,36 +128,41 @@ std::pair<std::vector<size_t>,float> CoordinateDescentParameterOptimiser::perfor
   bestValueIndices = currentValueIndices = initialValueIndices;
   bestCost = currentCost = compute_cost(currentValueIndices);
 
-  // Pick the first parameter to optimise. The parameters will be optimised one-by-one, starting from this parameter.
+  // For each parameter, starting from the specified one:
   size_t paramCount = m_paramValues.size();
-  int startingParamIndex = m_rng.generate_int_from_uniform(0, static_cast<int>(paramCount) - 1);
-
-  // For each parameter, starting from the one just chosen:
   for(size_t k = 0; k < paramCount; ++k)
   {
     size_t paramIndex = (startingParamIndex + k) % paramCount;
 
     // Check how many possible values the parameter can take. If there's only one possibility, the parameter can be skipped.
-    int valueCount = static_cast<int>(m_paramValues[paramIndex].second.size());
+    size_t valueCount = m_paramValues[paramIndex].second.size();
     if(valueCount == 1) continue;
 
-    // Record the parameter value for which we already have the corresponding cost so that we can avoid re-evaluating it.
+    // Make the parameter value indices for each possible new value that the parameter can take. The current value
+    // is skipped, since we already know its cost.
     size_t originalValueIndex = currentValueIndices[paramIndex];
-
-    // For each possible new value that the parameter can take:
-    std::vector<size_t> newValueIndices = currentValueIndices;
+    std::vector<std::vector<size_t> > newValueIndicesSets;
     for(size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex)
     {
-      // If we already know that the cost for the new value is no better than the cost for the current value, skip it.
       if(valueIndex == originalValueIndex) continue;
+      newValueIndicesSets.push_back(currentValueIndices);
+      newValueIndicesSets.back()[paramIndex] = valueIndex;
+    }
+
+    // Compute the costs for the new values in parallel.
+    int newValueCount = static_cast<int>(newValueIndicesSets.size());
+    std::vector<float> newCosts(newValueCount);
+    ParallelUtil::parallel_for(0, newValueCount, boost::bind(
+      &CoordinateDescentParameterOptimiser::compute_cost_for, this, _1, boost::cref(newValueIndicesSets), boost::ref(newCosts)
+    ));
 
-      // Compute the cost for the new value. If it's better than the cost for the current value, update the current value.
-      newValueIndices[paramIndex] = valueIndex;
-      float newCost = compute_cost(newValueIndices);
-      if(newCost < currentCost)
+    // Update the current value to the first new value whose cost is lowest, provided it's better than the cost for the current value.
+    for(int i = 0; i < newValueCount; ++i)
+    {
+      if(newCosts[i] < currentCost)
       {
-        currentValueIndices[paramIndex] = valueIndex;
-        currentCost = newCost;
+        currentValueIndices = newValueIndicesSets[i];
+        currentCost = newCosts[i];
       }
     }
 
@@ -140,4 +177,10 @@ std::pair<std::vector<size_t>,float> CoordinateDescentParameterOptimiser::perfor
   return std::make_pair(bestValueIndices, bestCost);
 }
 
+void CoordinateDescentParameterOptimiser::perform_epoch(int i, const std::vector<std::vector<size_t> >& initialValueIndices,
+                                                         const std::vector<size_t>& startingParamIndices, std::vector<Descent>& descents) const
+{
+  descents[i] = perform_coordinate_descent(initialValueIndices[i], startingParamIndices[i]);
+}
+
 }
@@ -0,0 +1,38 @@
+/**
+ * grove: ExampleClustererFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_EXAMPLECLUSTERERFACTORY
+#define H_GROVE_EXAMPLECLUSTERERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/ExampleClusterer.h"
+
+namespace grove {
+
+/**
+ * \brief This struct can be used to construct example clusterers.
+ */
+struct ExampleClustererFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes an example clusterer.
+   *
+   * \param deviceType      The device on which the example clusterer should operate.
+   * \param sigma           The standard deviation of the Gaussian kernel used to compute the example densities.
+   * \param tau             The maximum distance between an example and its parent.
+   * \param maxClusterCount The maximum number of clusters (modes) to retain for each reservoir.
+   * \param minClusterSize  The minimum number of examples in a cluster for it to be retained.
+   * \return                The example clusterer.
+   */
+  static ExampleClusterer_Ptr make_example_clusterer(ITMLib::ITMLibSettings::DeviceType deviceType, float sigma, float tau,
+                                                     uint32_t maxClusterCount, uint32_t minClusterSize);
+};
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * grove: ExampleClusterer_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_EXAMPLECLUSTERER_CPU
+#define H_GROVE_EXAMPLECLUSTERER_CPU
+
+#include "../interface/ExampleClusterer.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of this class can be used to find the modes of the distributions of the examples stored in a set of example reservoirs using the CPU.
+ */
+class ExampleClusterer_CPU : public ExampleClusterer
+{
+  //#################### PRIVATE MEMBER VARIABLES ####################
+private:
+  /** The positions of the examples in the batch being clustered, packed contiguously (reservoirCapacity entries per reservoir). */
+  ITMFloat3MemoryBlock_Ptr m_positions;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an example clusterer.
+   *
+   * \param sigma           The standard deviation of the Gaussian kernel used to compute the example densities.
+   * \param tau             The maximum distance between an example and its parent.
+   * \param maxClusterCount The maximum number of clusters (modes) to retain for each reservoir.
+   * \param minClusterSize  The minimum number of examples in a cluster for it to be retained.
+   */
+  ExampleClusterer_CPU(float sigma, float tau, uint32_t maxClusterCount, uint32_t minClusterSize);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void compute_densities(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                 const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount);
+
+  /** Override */
+  virtual void compute_modes(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                             const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions);
+
+  /** Override */
+  virtual void identify_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                 const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount);
+
+  /** Override */
+  virtual void link_neighbours(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                               const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount);
+
+  /** Override */
+  virtual void select_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                               const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions);
+};
+
+}
+
+#endif
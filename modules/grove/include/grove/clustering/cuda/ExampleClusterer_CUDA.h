@@ -0,0 +1,65 @@
+/**
+ * grove: ExampleClusterer_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_EXAMPLECLUSTERER_CUDA
+#define H_GROVE_EXAMPLECLUSTERER_CUDA
+
+#include "../interface/ExampleClusterer.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of this class can be used to find the modes of the distributions of the examples stored in a set of example reservoirs using CUDA.
+ */
+class ExampleClusterer_CUDA : public ExampleClusterer
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an example clusterer.
+   *
+   * \param sigma           The standard deviation of the Gaussian kernel used to compute the example densities.
+   * \param tau             The maximum distance between an example and its parent.
+   * \param maxClusterCount The maximum number of clusters (modes) to retain for each reservoir.
+   * \param minClusterSize  The minimum number of examples in a cluster for it to be retained.
+   */
+  ExampleClusterer_CUDA(float sigma, float tau, uint32_t maxClusterCount, uint32_t minClusterSize);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void compute_densities(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                 const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount);
+
+  /** Override */
+  virtual void compute_modes(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                             const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions);
+
+  /** Override */
+  virtual void identify_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                 const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount);
+
+  /** Override */
+  virtual void link_neighbours(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                               const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount);
+
+  /** Override */
+  virtual void select_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                               const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions);
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Checks that the shared memory needed by a kernel that processes a whole reservoir per block is available.
+   *
+   * \param sharedMemorySize         The amount of shared memory needed (in bytes).
+   * \throws std::invalid_argument   If the amount of shared memory needed is greater than the amount available to a block.
+   */
+  static void check_shared_memory_size(size_t sharedMemorySize);
+};
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * grove: ExampleClusterer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_EXAMPLECLUSTERER
+#define H_GROVE_EXAMPLECLUSTERER
+
+#include <itmx/base/ITMMemoryBlockPtrTypes.h>
+
+#include "../../keypoints/CompactKeypoint3DColour.h"
+#include "../../relocalisation/base/ScorePrediction.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to find the modes of the distributions of the examples
+ *        stored in a set of example reservoirs, in order to turn the contents of those reservoirs into score predictions.
+ *
+ * The examples in each reservoir are clustered independently using "really quick shift": the density of examples around each
+ * example is computed using a Gaussian kernel, each example is linked to its nearest neighbour of higher density (provided that
+ * such a neighbour lies within a radius of tau), and each tree in the resulting forest is treated as a cluster. The largest of
+ * these clusters are then used to compute the modes. All of the reservoirs in a batch are clustered in parallel.
+ */
+class ExampleClusterer
+{
+  //#################### PROTECTED MEMBER VARIABLES ####################
+protected:
+  /** The size of the cluster rooted at each example in the batch (only the entries for the cluster roots are non-zero). */
+  ITMIntMemoryBlock_Ptr m_clusterSizes;
+
+  /** The density of examples around each example in the batch. */
+  ITMFloatMemoryBlock_Ptr m_densities;
+
+  /** The maximum number of clusters (modes) to retain for each reservoir. */
+  uint32_t m_maxClusterCount;
+
+  /** The minimum number of examples in a cluster for it to be retained. */
+  uint32_t m_minClusterSize;
+
+  /** The parent of each example in the batch (an example that is its own parent is the root of a cluster). */
+  ITMIntMemoryBlock_Ptr m_parents;
+
+  /** The cluster root of each example in the batch. */
+  ITMIntMemoryBlock_Ptr m_roots;
+
+  /** The roots of the clusters selected for each reservoir in the batch (m_maxClusterCount entries per reservoir). */
+  ITMIntMemoryBlock_Ptr m_selectedClusters;
+
+  /** The standard deviation of the Gaussian kernel used to compute the example densities. */
+  float m_sigma;
+
+  /** The maximum distance between an example and its parent. */
+  float m_tau;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs an example clusterer.
+   *
+   * \param sigma                   The standard deviation of the Gaussian kernel used to compute the example densities.
+   * \param tau                     The maximum distance between an example and its parent.
+   * \param maxClusterCount         The maximum number of clusters (modes) to retain for each reservoir.
+   * \param minClusterSize          The minimum number of examples in a cluster for it to be retained.
+   *
+   * \throws std::invalid_argument  If maxClusterCount is zero or greater than SCORE_MAX_MODES.
+   */
+  ExampleClusterer(float sigma, float tau, uint32_t maxClusterCount, uint32_t minClusterSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the example clusterer.
+   */
+  virtual ~ExampleClusterer();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the density of examples around each example in the batch.
+   *
+   * \param examples          The example reservoirs.
+   * \param reservoirSizes    The current size of each reservoir.
+   * \param reservoirIndices  The indices of the reservoirs in the batch.
+   * \param reservoirCount    The number of reservoirs in the batch.
+   */
+  virtual void compute_densities(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                 const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount) = 0;
+
+  /**
+   * \brief Computes the modes corresponding to the selected clusters, and writes them into the predictions for the reservoirs.
+   *
+   * \param examples          The example reservoirs.
+   * \param reservoirSizes    The current size of each reservoir.
+   * \param reservoirIndices  The indices of the reservoirs in the batch.
+   * \param reservoirCount    The number of reservoirs in the batch.
+   * \param predictions       The predictions for all of the reservoirs.
+   */
+  virtual void compute_modes(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                             const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions) = 0;
+
+  /**
+   * \brief Finds the cluster root of each example in the batch, and computes the size of each cluster.
+   *
+   * \param examples          The example reservoirs.
+   * \param reservoirSizes    The current size of each reservoir.
+   * \param reservoirIndices  The indices of the reservoirs in the batch.
+   * \param reservoirCount    The number of reservoirs in the batch.
+   */
+  virtual void identify_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                 const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount) = 0;
+
+  /**
+   * \brief Links each example in the batch to its nearest neighbour of higher density.
+   *
+   * \param examples          The example reservoirs.
+   * \param reservoirSizes    The current size of each reservoir.
+   * \param reservoirIndices  The indices of the reservoirs in the batch.
+   * \param reservoirCount    The number of reservoirs in the batch.
+   */
+  virtual void link_neighbours(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                               const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount) = 0;
+
+  /**
+   * \brief Selects the largest clusters for each reservoir in the batch, and sets the sizes of the corresponding predictions.
+   *
+   * \param examples          The example reservoirs.
+   * \param reservoirSizes    The current size of each reservoir.
+   * \param reservoirIndices  The indices of the reservoirs in the batch.
+   * \param reservoirCount    The number of reservoirs in the batch.
+   * \param predictions       The predictions for all of the reservoirs.
+   */
+  virtual void select_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                               const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Clusters the examples in a batch of reservoirs, and replaces the predictions for those reservoirs with the resulting modes.
+   *
+   * \param examples          The example reservoirs: an image in which each row stores the examples of one reservoir.
+   * \param reservoirSizes    The current size of each reservoir.
+   * \param reservoirIndices  A memory block whose first reservoirCount elements are the indices of the reservoirs to cluster.
+   * \param reservoirCount    The number of reservoirs to cluster.
+   * \param predictions       A memory block containing a prediction for each reservoir. Only the predictions for the reservoirs
+   *                          in the batch are modified.
+   */
+  void cluster_reservoirs(const CompactKeypoint3DColourImage_CPtr& examples, const ITMIntMemoryBlock_CPtr& reservoirSizes,
+                          const ITMIntMemoryBlock_CPtr& reservoirIndices, uint32_t reservoirCount, const ScorePredictionsBlock_Ptr& predictions);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<ExampleClusterer> ExampleClusterer_Ptr;
+typedef boost::shared_ptr<const ExampleClusterer> ExampleClusterer_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,271 @@
+/**
+ * grove: ExampleClusterer_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_EXAMPLECLUSTERER_SHARED
+#define H_GROVE_EXAMPLECLUSTERER_SHARED
+
+#include <ORUtils/PlatformIndependence.h>
+
+#include "../../keypoints/CompactKeypoint3DColour.h"
+#include "../../relocalisation/base/ScorePrediction.h"
+
+namespace grove {
+
+/**
+ * \brief Computes the density of the examples in a reservoir around one of them, using a Gaussian kernel.
+ *
+ * \param exampleIdx          The index of the example within its reservoir.
+ * \param positions           The positions of the examples in the reservoir (stored contiguously).
+ * \param reservoirSize       The number of examples in the reservoir.
+ * \param minusInvTwoSigmaSq  -1 / (2 * sigma^2), where sigma is the standard deviation of the Gaussian kernel.
+ * \return                    The density of the examples around the specified example.
+ */
+_CPU_AND_GPU_CODE_
+inline float compute_density(int exampleIdx, const Vector3f *positions, int reservoirSize, float minusInvTwoSigmaSq)
+{
+  const Vector3f position = positions[exampleIdx];
+
+  float density = 0.0f;
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    const Vector3f diff = positions[i] - position;
+    density += expf(dot(diff, diff) * minusInvTwoSigmaSq);
+  }
+
+  return density;
+}
+
+/**
+ * \brief Finds the parent of an example in its reservoir, namely its nearest neighbour of higher density (if one exists within a radius of tau).
+ *
+ * Linking each example to its parent builds a forest in which each tree corresponds to a cluster of the examples ("quick shift").
+ * Ties in density are broken using the example indices, so that the links can never form a cycle.
+ *
+ * \param exampleIdx    The index of the example within its reservoir.
+ * \param positions     The positions of the examples in the reservoir (stored contiguously).
+ * \param densities     The densities of the examples in the reservoir (stored contiguously).
+ * \param reservoirSize The number of examples in the reservoir.
+ * \param tauSq         The square of the maximum distance between an example and its parent.
+ * \return              The index of the example's parent (or of the example itself, if it is a root).
+ */
+_CPU_AND_GPU_CODE_
+inline int find_parent(int exampleIdx, const Vector3f *positions, const float *densities, int reservoirSize, float tauSq)
+{
+  const Vector3f position = positions[exampleIdx];
+  const float density = densities[exampleIdx];
+
+  int parent = exampleIdx;
+  float bestDistSq = tauSq;
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    const float otherDensity = densities[i];
+    if(otherDensity < density || (otherDensity == density && i >= exampleIdx)) continue;
+
+    const Vector3f diff = positions[i] - position;
+    const float distSq = dot(diff, diff);
+    if(distSq < bestDistSq)
+    {
+      parent = i;
+      bestDistSq = distSq;
+    }
+  }
+
+  return parent;
+}
+
+/**
+ * \brief Copies the position of an example in a reservoir into a contiguous array of positions for the batch being clustered.
+ *
+ * Clustering only needs the example positions, which are repeatedly scanned, so packing them tightly improves locality.
+ *
+ * \param batchIdx          The index of the reservoir within the batch being clustered.
+ * \param exampleIdx        The index of the example within its reservoir.
+ * \param examples          The example reservoirs: an image in which each row stores up to reservoirCapacity examples.
+ * \param reservoirSizes    The current size of each reservoir.
+ * \param reservoirIndices  The indices of the reservoirs in the batch being clustered.
+ * \param reservoirCapacity The capacity (maximum size) of each reservoir.
+ * \param positions         An array in which to store the position of each example in the batch (reservoirCapacity entries per reservoir).
+ */
+_CPU_AND_GPU_CODE_
+inline void gather_position(int batchIdx, int exampleIdx, const CompactKeypoint3DColour *examples, const int *reservoirSizes, const int *reservoirIndices,
+                            int reservoirCapacity, Vector3f *positions)
+{
+  const int reservoirIdx = reservoirIndices[batchIdx];
+  if(exampleIdx >= reservoirSizes[reservoirIdx]) return;
+
+  positions[batchIdx * reservoirCapacity + exampleIdx] = get_position(examples[reservoirIdx * reservoirCapacity + exampleIdx]);
+}
+
+/**
+ * \brief Finds the root of the cluster containing an example, and increments the size of that cluster.
+ *
+ * \param batchIdx          The index of the reservoir within the batch being clustered.
+ * \param exampleIdx        The index of the example within its reservoir.
+ * \param reservoirSizes    The current size of each reservoir.
+ * \param reservoirIndices  The indices of the reservoirs in the batch being clustered.
+ * \param reservoirCapacity The capacity (maximum size) of each reservoir.
+ * \param parents           The parent of each example in the batch.
+ * \param roots             An array in which to store the cluster root of each example in the batch.
+ * \param clusterSizes      The size of the cluster rooted at each example in the batch (must be zero-initialised).
+ */
+_CPU_AND_GPU_CODE_
+inline void identify_cluster(int batchIdx, int exampleIdx, const int *reservoirSizes, const int *reservoirIndices, int reservoirCapacity,
+                             const int *parents, int *roots, int *clusterSizes)
+{
+  const int reservoirIdx = reservoirIndices[batchIdx];
+  if(exampleIdx >= reservoirSizes[reservoirIdx]) return;
+
+  const int offset = batchIdx * reservoirCapacity;
+  int root = exampleIdx;
+  for(int parent = parents[offset + root]; parent != root; parent = parents[offset + root])
+  {
+    root = parent;
+  }
+
+  roots[offset + exampleIdx] = root;
+
+#ifdef __CUDACC__
+  atomicAdd(&clusterSizes[offset + root], 1);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp atomic
+  #endif
+  ++clusterSizes[offset + root];
+#endif
+}
+
+/**
+ * \brief Selects the largest clusters (up to maxClusterCount of them, each containing at least minClusterSize examples) in a reservoir.
+ *
+ * The selected cluster roots are stored in decreasing order of cluster size, and the size of the reservoir's prediction is set
+ * to the number of clusters selected (the modes themselves are filled in by compute_mode).
+ *
+ * \param batchIdx          The index of the reservoir within the batch being clustered.
+ * \param reservoirSizes    The current size of each reservoir.
+ * \param reservoirIndices  The indices of the reservoirs in the batch being clustered.
+ * \param reservoirCapacity The capacity (maximum size) of each reservoir.
+ * \param clusterSizes      The size of the cluster rooted at each example in the batch.
+ * \param maxClusterCount   The maximum number of clusters to select (at most SCORE_MAX_MODES).
+ * \param minClusterSize    The minimum number of examples in a cluster for it to be selected.
+ * \param selectedClusters  An array in which to store the roots of the selected clusters (maxClusterCount entries per reservoir).
+ * \param predictions       The predictions for all of the reservoirs.
+ */
+_CPU_AND_GPU_CODE_
+inline void select_clusters_for_reservoir(int batchIdx, const int *reservoirSizes, const int *reservoirIndices, int reservoirCapacity, const int *clusterSizes,
+                                          int maxClusterCount, int minClusterSize, int *selectedClusters, ScorePrediction *predictions)
+{
+  const int reservoirIdx = reservoirIndices[batchIdx];
+  const int reservoirSize = reservoirSizes[reservoirIdx];
+  const int *reservoirClusterSizes = clusterSizes + batchIdx * reservoirCapacity;
+  int *reservoirSelectedClusters = selectedClusters + batchIdx * maxClusterCount;
+
+  // Maintain a list of the largest clusters found so far, in decreasing order of size, using an insertion sort.
+  int selectedCount = 0;
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    const int clusterSize = reservoirClusterSizes[i];
+    if(clusterSize < minClusterSize) continue;
+
+    int j = selectedCount < maxClusterCount ? selectedCount++ : maxClusterCount;
+    while(j > 0 && reservoirClusterSizes[reservoirSelectedClusters[j - 1]] < clusterSize)
+    {
+      if(j < maxClusterCount) reservoirSelectedClusters[j] = reservoirSelectedClusters[j - 1];
+      --j;
+    }
+
+    if(j < maxClusterCount) reservoirSelectedClusters[j] = i;
+  }
+
+  predictions[reservoirIdx].size = selectedCount;
+}
+
+/**
+ * \brief Computes the mode corresponding to one of the clusters selected for a reservoir.
+ *
+ * \param batchIdx          The index of the reservoir within the batch being clustered.
+ * \param clusterIdx        The index of the cluster within the reservoir's selected clusters.
+ * \param examples          The example reservoirs.
+ * \param reservoirSizes    The current size of each reservoir.
+ * \param reservoirIndices  The indices of the reservoirs in the batch being clustered.
+ * \param reservoirCapacity The capacity (maximum size) of each reservoir.
+ * \param roots             The cluster root of each example in the batch.
+ * \param maxClusterCount   The maximum number of clusters selected for each reservoir.
+ * \param selectedClusters  The roots of the selected clusters.
+ * \param predictions       The predictions for all of the reservoirs.
+ */
+_CPU_AND_GPU_CODE_
+inline void compute_mode(int batchIdx, int clusterIdx, const CompactKeypoint3DColour *examples, const int *reservoirSizes, const int *reservoirIndices,
+                         int reservoirCapacity, const int *roots, int maxClusterCount, const int *selectedClusters, ScorePrediction *predictions)
+{
+  const int reservoirIdx = reservoirIndices[batchIdx];
+  ScorePrediction& prediction = predictions[reservoirIdx];
+  if(clusterIdx >= prediction.size) return;
+
+  const CompactKeypoint3DColour *reservoir = examples + reservoirIdx * reservoirCapacity;
+  const int *reservoirRoots = roots + batchIdx * reservoirCapacity;
+  const int root = selectedClusters[batchIdx * maxClusterCount + clusterIdx];
+  const int reservoirSize = reservoirSizes[reservoirIdx];
+
+  // Accumulate the first and second moments of the positions, and the mean colour, of the examples in the cluster.
+  Vector3f colourSum(0.0f, 0.0f, 0.0f), positionSum(0.0f, 0.0f, 0.0f);
+  float sxx = 0.0f, sxy = 0.0f, sxz = 0.0f, syy = 0.0f, syz = 0.0f, szz = 0.0f;
+  int count = 0;
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    if(reservoirRoots[i] != root) continue;
+
+    const Vector3f p = get_position(reservoir[i]);
+    const Vector3u c = get_colour(reservoir[i]);
+    colourSum += Vector3f(c.x, c.y, c.z);
+    positionSum += p;
+    sxx += p.x * p.x; sxy += p.x * p.y; sxz += p.x * p.z;
+    syy += p.y * p.y; syz += p.y * p.z; szz += p.z * p.z;
+    ++count;
+  }
+
+  const float invCount = 1.0f / count;
+  const Vector3f mean = positionSum * invCount;
+
+  // Compute the covariance of the positions. We add a small amount to the diagonal to keep the covariance
+  // invertible when the examples are (almost) coplanar, e.g. because they all lie on a flat surface.
+  const float regulariser = 1e-4f;
+  const float cxx = sxx * invCount - mean.x * mean.x + regulariser;
+  const float cxy = sxy * invCount - mean.x * mean.y;
+  const float cxz = sxz * invCount - mean.x * mean.z;
+  const float cyy = syy * invCount - mean.y * mean.y + regulariser;
+  const float cyz = syz * invCount - mean.y * mean.z;
+  const float czz = szz * invCount - mean.z * mean.z + regulariser;
+
+  // Invert the (symmetric) covariance matrix using its cofactors. Since both the matrix and its inverse are
+  // symmetric, the storage order of the elements in the Matrix3f does not matter.
+  const float a00 = cyy * czz - cyz * cyz;
+  const float a01 = cxz * cyz - cxy * czz;
+  const float a02 = cxy * cyz - cxz * cyy;
+  const float a11 = cxx * czz - cxz * cxz;
+  const float a12 = cxy * cxz - cxx * cyz;
+  const float a22 = cxx * cyy - cxy * cxy;
+  const float determinant = cxx * a00 + cxy * a01 + cxz * a02;
+  const float invDeterminant = 1.0f / determinant;
+
+  Mode3DColour& mode = prediction.elts[clusterIdx];
+  mode.colour = Vector3u(
+    static_cast<unsigned char>(colourSum.x * invCount + 0.5f),
+    static_cast<unsigned char>(colourSum.y * invCount + 0.5f),
+    static_cast<unsigned char>(colourSum.z * invCount + 0.5f)
+  );
+  mode.determinant = determinant;
+  mode.position = mean;
+  mode.positionInvCovariance.m[0] = a00 * invDeterminant;
+  mode.positionInvCovariance.m[1] = mode.positionInvCovariance.m[3] = a01 * invDeterminant;
+  mode.positionInvCovariance.m[2] = mode.positionInvCovariance.m[6] = a02 * invDeterminant;
+  mode.positionInvCovariance.m[4] = a11 * invDeterminant;
+  mode.positionInvCovariance.m[5] = mode.positionInvCovariance.m[7] = a12 * invDeterminant;
+  mode.positionInvCovariance.m[8] = a22 * invDeterminant;
+  mode.supportCount = count;
+}
+
+}
+
+#endif
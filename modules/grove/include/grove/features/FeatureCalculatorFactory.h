@@ -52,6 +52,16 @@ struct FeatureCalculatorFactory
    */
   static DA_RGBDPatchFeatureCalculator_Ptr make_da_rgbd_patch_feature_calculator(ITMLib::ITMLibSettings::DeviceType deviceType);
 
+  /**
+   * \brief Makes a DA-RGBD patch feature calculator that stores its features as int16_t rather than float.
+   *
+   * The features computed are the same as those computed by the calculator returned by make_da_rgbd_patch_feature_calculator,
+   * except that they are rounded to the nearest integer. The descriptors are half the size.
+   *
+   * \param deviceType The device on which the feature calculator should operate.
+   */
+  static QuantisedDA_RGBDPatchFeatureCalculator_Ptr make_quantised_da_rgbd_patch_feature_calculator(ITMLib::ITMLibSettings::DeviceType deviceType);
+
   /**
    * \brief Makes an RGB patch feature calculator.
    *
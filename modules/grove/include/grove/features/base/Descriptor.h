@@ -6,16 +6,28 @@
 #ifndef H_GROVE_DESCRIPTOR
 #define H_GROVE_DESCRIPTOR
 
+#include <stdint.h>
+
 namespace grove {
 
 /**
- * \brief An instance of an instantiation of this struct template represents a fixed-length, floating-point feature descriptor.
+ * \brief An instance of an instantiation of this struct template represents a fixed-length feature descriptor.
+ *
+ * By default, the features are stored as floats. Descriptors whose features are known to lie in a limited range
+ * (e.g. the depth and colour differences computed by RGBDPatchFeatureCalculator) can instead store them in a
+ * narrower type such as int16_t, which substantially reduces the memory bandwidth needed to compute and evaluate them.
  *
  * \tparam N The length of the descriptor.
+ * \tparam T The type used to store the descriptor's features.
  */
-template <int N>
+template <int N, typename T = float>
 struct Descriptor
 {
+  //#################### TYPEDEFS ####################
+
+  /** The type used to store the descriptor's features. */
+  typedef T FeatureType;
+
   //#################### CONSTANTS ####################
 
   /** The length of the descriptor. */
@@ -24,7 +36,7 @@ struct Descriptor
   //#################### PUBLIC VARIABLES ####################
 
   /** The descriptor's features are stored in this array. */
-  float data[FEATURE_COUNT];
+  T data[FEATURE_COUNT];
 };
 
 }
@@ -63,6 +63,32 @@ public:
                                               const Matrix4f& cameraPose, const Vector4f& intrinsics,
                                               KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage) const;
 
+  /** Override */
+  virtual uint32_t compute_sparse_keypoints_and_features(const ITMUChar4Image *rgbImage, const ITMFloatImage *depthImage,
+                                                         const Matrix4f& cameraPose, const Vector4f& intrinsics,
+                                                         KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage,
+                                                         ORUtils::MemoryBlock<int> *keypointIndices) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the depth and colour features (as appropriate) for the keypoint at the specified position in the keypoints image.
+   *
+   * \param xyOut        The coordinates of the keypoint in the keypoints image.
+   * \param xyDepth      The coordinates of the keypoint's pixel in the depth image.
+   * \param xyRgb        The coordinates of the keypoint's pixel in the colour image.
+   * \param outSize      The size of the keypoints and descriptors images.
+   * \param depths       A pointer to the depth image (may be NULL).
+   * \param depthSize    The size of the depth image.
+   * \param rgb          A pointer to the colour image (may be NULL).
+   * \param rgbSize      The size of the colour image.
+   * \param keypoints    A pointer to the keypoints image.
+   * \param descriptors  A pointer to the descriptors image, into which to write the features.
+   */
+  void compute_features(const Vector2i& xyOut, const Vector2i& xyDepth, const Vector2i& xyRgb, const Vector2i& outSize,
+                        const float *depths, const Vector2i& depthSize, const Vector4u *rgb, const Vector2i& rgbSize,
+                        const KeypointType *keypoints, DescriptorType *descriptors) const;
+
   //#################### FRIENDS ####################
 
   friend struct FeatureCalculatorFactory;
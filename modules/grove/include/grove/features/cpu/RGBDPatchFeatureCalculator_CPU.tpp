@@ -29,12 +29,9 @@ void RGBDPatchFeatureCalculator_CPU<KeypointType,DescriptorType>::compute_keypoi
                                                                                                  const Matrix4f& cameraPose, const Vector4f& intrinsics,
                                                                                                  KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage) const
 {
-  const Vector4i *depthOffsets = this->m_depthOffsets->GetData(MEMORYDEVICE_CPU);
   const float *depths = depthImage ? depthImage->GetData(MEMORYDEVICE_CPU) : NULL;
   const Vector2i& depthSize = depthImage->noDims;
   const Vector4u *rgb = rgbImage ? rgbImage->GetData(MEMORYDEVICE_CPU): NULL;
-  const uchar *rgbChannels = this->m_rgbChannels->GetData(MEMORYDEVICE_CPU);
-  const Vector4i *rgbOffsets = this->m_rgbOffsets->GetData(MEMORYDEVICE_CPU);
   const Vector2i& rgbSize = rgbImage->noDims;
 
   // Check that the input images are valid and compute the output dimensions.
@@ -63,47 +60,126 @@ void RGBDPatchFeatureCalculator_CPU<KeypointType,DescriptorType>::compute_keypoi
       // Compute the keypoint for the pixel.
       compute_keypoint(xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, cameraPose, intrinsics, keypoints);
 
-      // If there is a depth image available and any depth features need to be computed for the keypoint, compute them.
-      if(depths && this->m_depthFeatureCount > 0)
-      {
-        if(this->m_depthDifferenceType == PAIRWISE_DIFFERENCE)
-        {
-          compute_depth_features<PAIRWISE_DIFFERENCE>(
-            xyDepth, xyOut, depthSize, outSize, depths, depthOffsets, keypoints,
-            this->m_depthFeatureCount, this->m_depthFeatureOffset,
-            this->m_normaliseDepth, descriptors
-          );
-        }
-        else
-        {
-          compute_depth_features<CENTRAL_DIFFERENCE>(
-            xyDepth, xyOut, depthSize, outSize, depths, depthOffsets, keypoints,
-            this->m_depthFeatureCount, this->m_depthFeatureOffset,
-            this->m_normaliseDepth, descriptors
-          );
-        }
-      }
-
-      // If there is a colour image available and any colour features need to be computed for the keypoint, compute them.
-      if(rgb && this->m_rgbFeatureCount > 0)
-      {
-        if(this->m_rgbDifferenceType == PAIRWISE_DIFFERENCE)
-        {
-          compute_colour_features<PAIRWISE_DIFFERENCE>(
-            xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, rgbOffsets, rgbChannels,
-            keypoints, this->m_rgbFeatureCount, this->m_rgbFeatureOffset,
-            this->m_normaliseRgb, descriptors
-          );
-        }
-        else
-        {
-          compute_colour_features<CENTRAL_DIFFERENCE>(
-            xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, rgbOffsets, rgbChannels,
-            keypoints, this->m_rgbFeatureCount, this->m_rgbFeatureOffset,
-            this->m_normaliseRgb, descriptors
-          );
-        }
-      }
+      // Compute the features for the keypoint.
+      compute_features(xyOut, xyDepth, xyRgb, outSize, depths, depthSize, rgb, rgbSize, keypoints, descriptors);
+    }
+  }
+}
+
+template <typename KeypointType, typename DescriptorType>
+uint32_t RGBDPatchFeatureCalculator_CPU<KeypointType,DescriptorType>::compute_sparse_keypoints_and_features(const ITMUChar4Image *rgbImage, const ITMFloatImage *depthImage,
+                                                                                                            const Matrix4f& cameraPose, const Vector4f& intrinsics,
+                                                                                                            KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage,
+                                                                                                            ORUtils::MemoryBlock<int> *keypointIndices) const
+{
+  const float *depths = depthImage ? depthImage->GetData(MEMORYDEVICE_CPU) : NULL;
+  const Vector2i& depthSize = depthImage->noDims;
+  const Vector4u *rgb = rgbImage ? rgbImage->GetData(MEMORYDEVICE_CPU): NULL;
+  const Vector2i& rgbSize = rgbImage->noDims;
+
+  // Check that the input images are valid and compute the output dimensions.
+  const Vector2i outSize = this->compute_output_dims(rgbImage, depthImage);
+  const int keypointCount = outSize.width * outSize.height;
+
+  // Ensure the output images are the right size, and that the keypoint indices block is large enough.
+  keypointsImage->ChangeDims(outSize);
+  descriptorsImage->ChangeDims(outSize);
+  if(keypointIndices->dataSize < static_cast<size_t>(keypointCount)) keypointIndices->Resize(keypointCount);
+
+  KeypointType *keypoints = keypointsImage->GetData(MEMORYDEVICE_CPU);
+  DescriptorType *descriptors = descriptorsImage->GetData(MEMORYDEVICE_CPU);
+  int *keypointIndicesPtr = keypointIndices->GetData(MEMORYDEVICE_CPU);
+
+  // Compute the keypoint for each pixel in the RGBD image.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int yOut = 0; yOut < outSize.height; ++yOut)
+  {
+    for(int xOut = 0; xOut < outSize.width; ++xOut)
+    {
+      const Vector2i xyOut(xOut, yOut);
+      const Vector2i xyDepth = map_pixel_coordinates(xyOut, outSize, depthSize);
+      const Vector2i xyRgb = map_pixel_coordinates(xyOut, outSize, rgbSize);
+      compute_keypoint(xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, cameraPose, intrinsics, keypoints);
+    }
+  }
+
+  // Compact the raster indices of the valid keypoints into a list (this is a sequential prefix sum over their validity flags).
+  int validKeypointCount = 0;
+  for(int i = 0; i < keypointCount; ++i)
+  {
+    if(keypoints[i].valid) keypointIndicesPtr[validKeypointCount++] = i;
+  }
+
+  // Compute the features for each valid keypoint.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < validKeypointCount; ++i)
+  {
+    const int rasterIdx = keypointIndicesPtr[i];
+    const Vector2i xyOut(rasterIdx % outSize.width, rasterIdx / outSize.width);
+    const Vector2i xyDepth = map_pixel_coordinates(xyOut, outSize, depthSize);
+    const Vector2i xyRgb = map_pixel_coordinates(xyOut, outSize, rgbSize);
+    compute_features(xyOut, xyDepth, xyRgb, outSize, depths, depthSize, rgb, rgbSize, keypoints, descriptors);
+  }
+
+  return static_cast<uint32_t>(validKeypointCount);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+template <typename KeypointType, typename DescriptorType>
+void RGBDPatchFeatureCalculator_CPU<KeypointType,DescriptorType>::compute_features(const Vector2i& xyOut, const Vector2i& xyDepth,
+                                                                                   const Vector2i& xyRgb, const Vector2i& outSize,
+                                                                                   const float *depths, const Vector2i& depthSize,
+                                                                                   const Vector4u *rgb, const Vector2i& rgbSize,
+                                                                                   const KeypointType *keypoints, DescriptorType *descriptors) const
+{
+  const Vector4i *depthOffsets = this->m_depthOffsets->GetData(MEMORYDEVICE_CPU);
+  const uchar *rgbChannels = this->m_rgbChannels->GetData(MEMORYDEVICE_CPU);
+  const Vector4i *rgbOffsets = this->m_rgbOffsets->GetData(MEMORYDEVICE_CPU);
+
+  // If there is a depth image available and any depth features need to be computed for the keypoint, compute them.
+  if(depths && this->m_depthFeatureCount > 0)
+  {
+    if(this->m_depthDifferenceType == PAIRWISE_DIFFERENCE)
+    {
+      compute_depth_features<PAIRWISE_DIFFERENCE>(
+        xyDepth, xyOut, depthSize, outSize, depths, depthOffsets, keypoints,
+        this->m_depthFeatureCount, this->m_depthFeatureOffset,
+        this->m_normaliseDepth, descriptors
+      );
+    }
+    else
+    {
+      compute_depth_features<CENTRAL_DIFFERENCE>(
+        xyDepth, xyOut, depthSize, outSize, depths, depthOffsets, keypoints,
+        this->m_depthFeatureCount, this->m_depthFeatureOffset,
+        this->m_normaliseDepth, descriptors
+      );
+    }
+  }
+
+  // If there is a colour image available and any colour features need to be computed for the keypoint, compute them.
+  if(rgb && this->m_rgbFeatureCount > 0)
+  {
+    if(this->m_rgbDifferenceType == PAIRWISE_DIFFERENCE)
+    {
+      compute_colour_features<PAIRWISE_DIFFERENCE>(
+        xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, rgbOffsets, rgbChannels,
+        keypoints, this->m_rgbFeatureCount, this->m_rgbFeatureOffset,
+        this->m_normaliseRgb, descriptors
+      );
+    }
+    else
+    {
+      compute_colour_features<CENTRAL_DIFFERENCE>(
+        xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, rgbOffsets, rgbChannels,
+        keypoints, this->m_rgbFeatureCount, this->m_rgbFeatureOffset,
+        this->m_normaliseRgb, descriptors
+      );
     }
   }
 }
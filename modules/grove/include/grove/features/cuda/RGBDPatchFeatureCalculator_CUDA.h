@@ -30,6 +30,14 @@ public:
   using typename Base::DescriptorsImage;
   using typename Base::KeypointsImage;
 
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block used to store the exclusive prefix sum of the keypoint validity flags when compacting the valid keypoints. */
+  mutable ITMIntMemoryBlock_Ptr m_keypointPrefixSums;
+
+  /** A memory block used to store the validity flags (0 or 1) of the keypoints when compacting the valid keypoints. */
+  mutable ITMIntMemoryBlock_Ptr m_keypointValidity;
+
   //#################### CONSTRUCTORS ####################
 private:
   /**
@@ -63,6 +71,19 @@ public:
                                               const Matrix4f& cameraPose, const Vector4f& intrinsics,
                                               KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage) const;
 
+  /** Override */
+  virtual uint32_t compute_sparse_keypoints_and_features(const ITMUChar4Image *rgbImage, const ITMFloatImage *depthImage,
+                                                         const Matrix4f& cameraPose, const Vector4f& intrinsics,
+                                                         KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage,
+                                                         ORUtils::MemoryBlock<int> *keypointIndices) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Copies the tables specifying the depth and colour features to be computed into constant memory.
+   */
+  void upload_feature_tables() const;
+
   //#################### FRIENDS ####################
 
   friend struct FeatureCalculatorFactory;
@@ -149,6 +149,29 @@ public:
                                               const Matrix4f& cameraPose, const Vector4f& intrinsics,
                                               KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage) const = 0;
 
+  /**
+   * \brief Extracts keypoints from an RGBD image and computes feature descriptors only for the keypoints that are valid.
+   *
+   * This behaves like compute_keypoints_and_features, except that once the keypoints have been computed, a compacted list
+   * of the raster indices of the valid keypoints is built (using a prefix sum over their validity flags), and descriptors
+   * are then only computed for the keypoints in that list. The descriptors of invalid keypoints are left untouched. This
+   * saves a lot of work on images with large invalid regions, and the list can then be passed to DecisionForest::find_leaves.
+   *
+   * \param rgbImage         The colour image.
+   * \param depthImage       The depth image.
+   * \param cameraPose       A transformation from the camera's reference frame to the world reference frame.
+   * \param intrinsics       The intrinsic parameters of the depth camera.
+   * \param keypointsImage   The output image that will contain the extracted keypoints. Will be resized as necessary.
+   * \param descriptorsImage The output image that will contain the feature descriptors of the valid keypoints.
+   * \param keypointIndices  A memory block into whose first N elements the raster indices of the N valid keypoints
+   *                         will be written (in increasing order). Will be enlarged as necessary.
+   * \return                 The number of valid keypoints.
+   */
+  virtual uint32_t compute_sparse_keypoints_and_features(const ITMUChar4Image *rgbImage, const ITMFloatImage *depthImage,
+                                                         const Matrix4f& cameraPose, const Vector4f& intrinsics,
+                                                         KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage,
+                                                         ORUtils::MemoryBlock<int> *keypointIndices) const = 0;
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -241,6 +264,16 @@ typedef RGBDPatchFeatureCalculator<Keypoint3DColour,RGBDPatchDescriptor> DA_RGBD
 typedef boost::shared_ptr<DA_RGBDPatchFeatureCalculator> DA_RGBDPatchFeatureCalculator_Ptr;
 typedef boost::shared_ptr<const DA_RGBDPatchFeatureCalculator> DA_RGBDPatchFeatureCalculator_CPtr;
 
+typedef Descriptor<256,int16_t> QuantisedRGBDPatchDescriptor;
+
+typedef ORUtils::Image<QuantisedRGBDPatchDescriptor> QuantisedRGBDPatchDescriptorImage;
+typedef boost::shared_ptr<QuantisedRGBDPatchDescriptorImage> QuantisedRGBDPatchDescriptorImage_Ptr;
+typedef boost::shared_ptr<const QuantisedRGBDPatchDescriptorImage> QuantisedRGBDPatchDescriptorImage_CPtr;
+
+typedef RGBDPatchFeatureCalculator<Keypoint3DColour,QuantisedRGBDPatchDescriptor> QuantisedDA_RGBDPatchFeatureCalculator;
+typedef boost::shared_ptr<QuantisedDA_RGBDPatchFeatureCalculator> QuantisedDA_RGBDPatchFeatureCalculator_Ptr;
+typedef boost::shared_ptr<const QuantisedDA_RGBDPatchFeatureCalculator> QuantisedDA_RGBDPatchFeatureCalculator_CPtr;
+
 }
 
 #endif
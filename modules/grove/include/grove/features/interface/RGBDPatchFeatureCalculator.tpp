@@ -44,9 +44,9 @@ RGBDPatchFeatureCalculator<KeypointType,DescriptorType>::RGBDPatchFeatureCalcula
 
   // Set up the memory blocks used to specify the features.
   const itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
-  m_depthOffsets = mbf.make_block<Vector4i>(m_depthFeatureCount);
-  m_rgbChannels = mbf.make_block<uchar>(m_rgbFeatureCount);
-  m_rgbOffsets = mbf.make_block<Vector4i>(m_rgbFeatureCount);
+  m_depthOffsets = mbf.make_block<Vector4i>(m_depthFeatureCount, "RGBDPatchFeatureCalculator");
+  m_rgbChannels = mbf.make_block<uchar>(m_rgbFeatureCount, "RGBDPatchFeatureCalculator");
+  m_rgbOffsets = mbf.make_block<Vector4i>(m_rgbFeatureCount, "RGBDPatchFeatureCalculator");
 
   // Set up the features.
   setup_depth_features();
@@ -16,6 +16,78 @@
 
 namespace grove {
 
+/**
+ * \brief Converts a computed feature value to the type used to store the features in a descriptor.
+ *
+ * \param value The feature value.
+ * \return      The feature value, converted to the specified type.
+ */
+template <typename FeatureType>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline FeatureType make_feature(float value);
+
+/**
+ * \brief Converts a computed feature value to a float (i.e. leaves it unchanged).
+ */
+template <>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline float make_feature(float value)
+{
+  return value;
+}
+
+/**
+ * \brief Converts a computed feature value to an int16_t.
+ *
+ * The value is rounded to the nearest integer and saturated to the range of an int16_t. Colour differences are integral
+ * and lie in [-255,255], and depth differences (in millimetres) lie well within the representable range for any depth
+ * camera we support, so this only loses the sub-millimetre part of the depth features.
+ */
+template <>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline int16_t make_feature(float value)
+{
+  return static_cast<int16_t>(roundf(clamp(value, -32768.0f, 32767.0f)));
+}
+
+/**
+ * \brief Reads a channel of a pixel in a colour image, via the read-only data cache when running on a suitable GPU.
+ *
+ * The secondary points used to compute the features of neighbouring pixels are scattered, but overlap heavily,
+ * so routing the reads through the read-only (texture) cache avoids refetching the same lines from global memory.
+ *
+ * \param rgb       A pointer to the colour image.
+ * \param rasterIdx The raster index of the pixel.
+ * \param channel   The channel to read.
+ * \return          The value of the specified channel of the pixel.
+ */
+_CPU_AND_GPU_CODE_
+inline uchar load_colour_channel(const Vector4u *rgb, int rasterIdx, int channel)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 350
+  return __ldg(reinterpret_cast<const unsigned char*>(rgb + rasterIdx) + channel);
+#else
+  return rgb[rasterIdx][channel];
+#endif
+}
+
+/**
+ * \brief Reads a pixel in a depth image, via the read-only data cache when running on a suitable GPU (see load_colour_channel).
+ *
+ * \param depths    A pointer to the depth image.
+ * \param rasterIdx The raster index of the pixel.
+ * \return          The depth of the pixel.
+ */
+_CPU_AND_GPU_CODE_
+inline float load_depth(const float *depths, int rasterIdx)
+{
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 350
+  return __ldg(depths + rasterIdx);
+#else
+  return depths[rasterIdx];
+#endif
+}
+
 /**
  * \brief Calculates the raster position(s) of the secondary point(s) to use when computing a feature.
  *
@@ -120,9 +192,12 @@ inline void compute_colour_features(const Vector2i& xyDepth, const Vector2i& xyR
   const Vector2f trainRgbSize(640.0f, 480.0f);
   const Vector2f offsetRatio(rgbSize.x / trainRgbSize.x, rgbSize.y / trainRgbSize.y);
 
+  // Look up the colour of the input pixel (this is needed for every feature if we're computing central differences).
+  const int rasterIdxRgb = xyRgb.y * rgbSize.width + xyRgb.x;
+  const Vector4u centralColour = rgb[rasterIdxRgb];
+
   // Compute the features and fill in the descriptor.
   DescriptorType& descriptor = descriptors[rasterIdxOut];
-  const int rasterIdxRgb = xyRgb.y * rgbSize.width + xyRgb.x;
   for(uint32_t featIdx = 0; featIdx < rgbFeatureCount; ++featIdx)
   {
     const int channel = rgbChannels[featIdx];
@@ -142,12 +217,12 @@ inline void compute_colour_features(const Vector2i& xyDepth, const Vector2i& xyR
     if(DifferenceType == PAIRWISE_DIFFERENCE)
     {
       // This is the "correct" definition, but the SCoRe Forests code uses the other one.
-      descriptor.data[rgbFeatureOffset + featIdx] = static_cast<float>(rgb[raster1][channel] - rgb[raster2][channel]);
+      descriptor.data[rgbFeatureOffset + featIdx] = make_feature<typename DescriptorType::FeatureType>(static_cast<float>(load_colour_channel(rgb, raster1, channel) - load_colour_channel(rgb, raster2, channel)));
     }
     else
     {
       // This is the definition used in the SCoRe Forests code.
-      descriptor.data[rgbFeatureOffset + featIdx] = static_cast<float>(rgb[raster1][channel] - rgb[rasterIdxRgb][channel]);
+      descriptor.data[rgbFeatureOffset + featIdx] = make_feature<typename DescriptorType::FeatureType>(static_cast<float>(load_colour_channel(rgb, raster1, channel) - centralColour[channel]));
     }
   }
 }
@@ -192,14 +267,14 @@ inline void compute_depth_features(const Vector2i& xyDepth, const Vector2i& xyOu
     calculate_secondary_points<DifferenceType>(xyDepth, offsets, depthSize, normalise, depth, raster1, raster2);
 
     // Convert the depth of the first secondary point to millimetres.
-    const float depth1Mm = fmaxf(depths[raster1] * 1000.f, 0.0f);  // we use max because InfiniTAM sometimes has invalid depths stored as -1
+    const float depth1Mm = fmaxf(load_depth(depths, raster1) * 1000.f, 0.0f);  // we use max because InfiniTAM sometimes has invalid depths stored as -1
 
     // Compute the feature and write it into the descriptor.
     if(DifferenceType == PAIRWISE_DIFFERENCE)
     {
       // This is the "correct" definition, but the SCoRe Forests code uses the other one.
-      const float depth2Mm = fmaxf(depths[raster2] * 1000.0f, 0.0f);
-      descriptor.data[depthFeatureOffset + featIdx] = depth1Mm - depth2Mm;
+      const float depth2Mm = fmaxf(load_depth(depths, raster2) * 1000.0f, 0.0f);
+      descriptor.data[depthFeatureOffset + featIdx] = make_feature<typename DescriptorType::FeatureType>(depth1Mm - depth2Mm);
     }
     else
     {
@@ -207,7 +282,7 @@ inline void compute_depth_features(const Vector2i& xyDepth, const Vector2i& xyOu
       const float depthMm = depth * 1000.0f;
 
       // This is the definition used in the SCoRe Forests code.
-      descriptor.data[depthFeatureOffset + featIdx] = depth1Mm - depthMm;
+      descriptor.data[depthFeatureOffset + featIdx] = make_feature<typename DescriptorType::FeatureType>(depth1Mm - depthMm);
     }
   }
 }
@@ -15,7 +15,8 @@ namespace grove {
 /**
  * \brief This struct can be used to construct decision forests.
  *
- * \tparam DescriptorType The type of descriptor used to find the leaves. Must have a floating-point member array named "data".
+ * \tparam DescriptorType The type of descriptor used to find the leaves. Must have a member array named "data" whose elements are
+ *                        comparable to float thresholds, and a FeatureType typedef giving their type (see Descriptor).
  * \tparam TreeCount      The number of trees in the forest. Fixed at compilation time to allow the definition of a data type
  *                        representing the leaf indices.
  */
@@ -34,11 +35,13 @@ struct DecisionForestFactory
    *
    * \param filename   The path to the file containing the forest.
    * \param deviceType The device on which the decision forest should operate.
+   * \param nodeLayout The layout to use for the nodes of the forest in memory.
    * \return           The constructed forest.
    *
    * \throws std::runtime_error If the forest cannot be loaded.
    */
-  static Forest_Ptr make_forest(const std::string& filename, ITMLib::ITMLibSettings::DeviceType deviceType);
+  static Forest_Ptr make_forest(const std::string& filename, ITMLib::ITMLibSettings::DeviceType deviceType,
+                                DecisionForestNodeLayout nodeLayout = INTERLEAVED_LAYOUT);
 
 #ifdef WITH_SCOREFORESTS
   /**
@@ -54,6 +57,57 @@ struct DecisionForestFactory
 #endif
 };
 
+/**
+ * \brief This struct can be used to construct decision forests whose tree counts are only known at runtime.
+ *
+ * The number of trees in a DecisionForest is a template parameter, so that the per-tree loops used to find the leaves can be
+ * fully unrolled. To avoid having to build a separate binary for each tree count, this factory reads the number of trees from
+ * the forest file and dispatches to the DecisionForestFactory specialisation for that number (any number in [1,MAX_TREE_COUNT]
+ * is supported). Since the type of the forest depends on its tree count, the constructed forest is passed to a visitor, which
+ * must provide a function call operator template of the form:
+ *
+ *   template <int TreeCount> void operator()(const boost::shared_ptr<DecisionForest<DescriptorType,TreeCount> >& forest);
+ *
+ * \note When CUDA is used, DecisionForest_CUDA must have been instantiated for each supported tree count (see DecisionForest_CUDA.cu).
+ *
+ * \tparam DescriptorType The type of descriptor used to find the leaves (see DecisionForestFactory).
+ */
+template <typename DescriptorType>
+struct DynamicDecisionForestFactory
+{
+  //#################### ENUMERATIONS ####################
+
+  /** The maximum number of trees in a forest that can be constructed by this factory. */
+  enum { MAX_TREE_COUNT = 8 };
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Constructs a decision forest by loading the branching structure of a pre-trained forest from a file on disk,
+   *        and passes it to the specified visitor.
+   *
+   * \param filename   The path to the file containing the forest.
+   * \param deviceType The device on which the decision forest should operate.
+   * \param visitor    The visitor to which to pass the constructed forest.
+   * \param nodeLayout The layout to use for the nodes of the forest in memory.
+   *
+   * \throws std::runtime_error If the forest cannot be loaded, or contains an unsupported number of trees.
+   */
+  template <typename Visitor>
+  static void make_forest(const std::string& filename, ITMLib::ITMLibSettings::DeviceType deviceType, Visitor& visitor,
+                          DecisionForestNodeLayout nodeLayout = INTERLEAVED_LAYOUT);
+
+  /**
+   * \brief Reads the number of trees in the forest stored in a file on disk (in either the text or the binary format).
+   *
+   * \param filename The path to the file containing the forest.
+   * \return         The number of trees in the forest.
+   *
+   * \throws std::runtime_error If the number of trees cannot be read from the file.
+   */
+  static uint32_t read_tree_count(const std::string& filename);
+};
+
 }
 
 #endif
@@ -5,6 +5,10 @@
 
 #include "DecisionForestFactory.h"
 
+#include <fstream>
+
+#include <boost/lexical_cast.hpp>
+
 #include "cpu/DecisionForest_CPU.h"
 
 #ifdef WITH_CUDA
@@ -17,21 +21,22 @@ namespace grove {
 
 template <typename DescriptorType, int TreeCount>
 typename DecisionForestFactory<DescriptorType,TreeCount>::Forest_Ptr
-DecisionForestFactory<DescriptorType,TreeCount>::make_forest(const std::string& filename, ITMLib::ITMLibSettings::DeviceType deviceType)
+DecisionForestFactory<DescriptorType,TreeCount>::make_forest(const std::string& filename, ITMLib::ITMLibSettings::DeviceType deviceType,
+                                                             DecisionForestNodeLayout nodeLayout)
 {
   Forest_Ptr forest;
 
   if(deviceType == ITMLib::ITMLibSettings::DEVICE_CUDA)
   {
 #ifdef WITH_CUDA
-    forest.reset(new DecisionForest_CUDA<DescriptorType,TreeCount>(filename));
+    forest.reset(new DecisionForest_CUDA<DescriptorType,TreeCount>(filename, nodeLayout));
 #else
     throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
 #endif
   }
   else
   {
-    forest.reset(new DecisionForest_CPU<DescriptorType,TreeCount>(filename));
+    forest.reset(new DecisionForest_CPU<DescriptorType,TreeCount>(filename, nodeLayout));
   }
 
   return forest;
@@ -61,4 +66,57 @@ DecisionForestFactory<DescriptorType,TreeCount>::make_forest(const EnsembleLearn
 }
 #endif
 
+template <typename DescriptorType>
+template <typename Visitor>
+void DynamicDecisionForestFactory<DescriptorType>::make_forest(const std::string& filename, ITMLib::ITMLibSettings::DeviceType deviceType,
+                                                               Visitor& visitor, DecisionForestNodeLayout nodeLayout)
+{
+  // Dispatch to the forest type for the number of trees in the file. Each case instantiates the forest code (and in particular
+  // the unrolled per-tree loops used to find the leaves) for a specific number of trees.
+#define DISPATCH_TREE_COUNT(n) case n: visitor(DecisionForestFactory<DescriptorType,n>::make_forest(filename, deviceType, nodeLayout)); break
+
+  const uint32_t treeCount = read_tree_count(filename);
+  switch(treeCount)
+  {
+    DISPATCH_TREE_COUNT(1);
+    DISPATCH_TREE_COUNT(2);
+    DISPATCH_TREE_COUNT(3);
+    DISPATCH_TREE_COUNT(4);
+    DISPATCH_TREE_COUNT(5);
+    DISPATCH_TREE_COUNT(6);
+    DISPATCH_TREE_COUNT(7);
+    DISPATCH_TREE_COUNT(8);
+    default:
+      throw std::runtime_error(
+        "Error: Forests with " + boost::lexical_cast<std::string>(treeCount) + " trees are not supported (the maximum is " +
+        boost::lexical_cast<std::string>(static_cast<int>(MAX_TREE_COUNT)) + ")"
+      );
+  }
+
+#undef DISPATCH_TREE_COUNT
+}
+
+template <typename DescriptorType>
+uint32_t DynamicDecisionForestFactory<DescriptorType>::read_tree_count(const std::string& filename)
+{
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  if(!in) throw std::runtime_error("Couldn't load a forest from: " + filename);
+
+  // If the file is in the binary format, the number of trees follows the magic number and the version (see DecisionForest).
+  char magic[4];
+  if(in.read(magic, sizeof(magic)) && std::string(magic, sizeof(magic)) == "GRVF")
+  {
+    uint32_t header[2];
+    if(!in.read(reinterpret_cast<char*>(header), sizeof(header))) throw std::runtime_error("Not a binary forest file: " + filename);
+    return header[1];
+  }
+
+  // Otherwise, the number of trees is the first value in the text file.
+  in.clear();
+  in.seekg(0);
+  uint32_t treeCount;
+  if(!(in >> treeCount)) throw std::runtime_error("Couldn't read the number of trees from: " + filename);
+  return treeCount;
+}
+
 }
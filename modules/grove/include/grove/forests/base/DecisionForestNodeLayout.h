@@ -0,0 +1,41 @@
+/**
+ * grove: DecisionForestNodeLayout.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_DECISIONFORESTNODELAYOUT
+#define H_GROVE_DECISIONFORESTNODELAYOUT
+
+namespace grove {
+
+/**
+ * \brief The values of this enumeration can be used to specify how the nodes of a decision forest are laid out in memory.
+ *
+ * In all cases, the two children of a branch node are stored next to each other, so only the index of the left child is needed.
+ */
+enum DecisionForestNodeLayout
+{
+  /**
+   * The nodes of all the trees are interleaved, i.e. node n of tree t is stored at index n * nbTrees + t.
+   * This is the layout described in "Implementing Decision Trees and Forests on a GPU" (Toby Sharp, 2008),
+   * and the one used by the forest files.
+   */
+  INTERLEAVED_LAYOUT,
+
+  /**
+   * The nodes of each tree are stored contiguously, in breadth-first order. The top few levels of each tree
+   * thus occupy only a handful of cache lines.
+   */
+  BREADTH_FIRST_LAYOUT,
+
+  /**
+   * The nodes of each tree are stored contiguously, grouped into small blocks of subtrees (each of which spans
+   * a few levels and fits in a few cache lines), so that every step of a traversal that stays within a block
+   * hits memory that has already been fetched.
+   */
+  BLOCKED_LAYOUT
+};
+
+}
+
+#endif
@@ -17,7 +17,8 @@ namespace grove {
  * \note  Training is not performed by this class. We use the node indexing technique described in:
  *        "Implementing Decision Trees and Forests on a GPU" (Toby Sharp, 2008).
  *
- * \tparam DescriptorType The type of descriptor used to find the leaves. Must have a floating-point member array named "data".
+ * \tparam DescriptorType The type of descriptor used to find the leaves. Must have a member array named "data" whose elements are
+ *                        comparable to float thresholds, and a FeatureType typedef giving their type (see Descriptor).
  * \tparam TreeCount      The number of trees in the forest. Fixed at compilation time to allow the definition of a data type
  *                        representing the leaf indices.
  */
@@ -43,11 +44,12 @@ public:
   /**
    * \brief Loads the branching structure of a pre-trained decision forest from a file on disk.
    *
-   * \param filename The path to the file containing the forest.
+   * \param filename   The path to the file containing the forest.
+   * \param nodeLayout The layout to use for the nodes of the forest in memory.
    *
    * \throws std::runtime_error If the forest cannot be loaded.
    */
-  explicit DecisionForest_CPU(const std::string& filename);
+  explicit DecisionForest_CPU(const std::string& filename, DecisionForestNodeLayout nodeLayout = INTERLEAVED_LAYOUT);
 
 #ifdef WITH_SCOREFORESTS
   /**
@@ -64,6 +66,30 @@ public:
 public:
   /** Override */
   virtual void find_leaves(const DescriptorImage_CPtr& descriptors, LeafIndicesImage_Ptr& leafIndices) const;
+
+  /** Override */
+  virtual void find_leaves(const DescriptorImage_CPtr& descriptors, const ITMIntMemoryBlock_CPtr& descriptorIndices, uint32_t descriptorCount,
+                           LeafIndicesImage_Ptr& leafIndices) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+#ifdef WITH_AVX2
+  /**
+   * \brief Finds the leaf indices associated with a batch of 8 descriptors using AVX2.
+   *
+   * The 8 descriptors are walked down each tree in lockstep, using gathers to fetch the node parameters
+   * and the descriptor features. The results are identical to those of compute_leaf_indices.
+   *
+   * \param rasterIndices The raster indices of the 8 descriptors in the batch.
+   * \param descriptors   The descriptors image.
+   * \param nodeImage     The forest indexing structure.
+   * \param nodeStride    The distance (in nodes) between consecutive nodes of a tree in the forest indexing structure.
+   * \param treeStride    The distance (in nodes) between the roots of consecutive trees in the forest indexing structure.
+   * \param leafIndices   An image in which to store the leaf indices computed for the descriptors.
+   */
+  static void compute_leaf_indices_avx2(const int *rasterIndices, const DescriptorType *descriptors, const NodeEntry *nodeImage,
+                                        int nodeStride, int treeStride, LeafIndices *leafIndices);
+#endif
 };
 
 }
@@ -5,6 +5,12 @@
 
 #include "DecisionForest_CPU.h"
 
+#ifdef WITH_AVX2
+#include <immintrin.h>
+
+#include <boost/type_traits/is_same.hpp>
+#endif
+
 #include "../shared/DecisionForest_Shared.h"
 
 namespace grove {
@@ -12,8 +18,8 @@ namespace grove {
 //#################### CONSTRUCTORS ####################
 
 template <typename DescriptorType, int TreeCount>
-DecisionForest_CPU<DescriptorType,TreeCount>::DecisionForest_CPU(const std::string& filename)
-: Base(filename)
+DecisionForest_CPU<DescriptorType,TreeCount>::DecisionForest_CPU(const std::string& filename, DecisionForestNodeLayout nodeLayout)
+: Base(filename, nodeLayout)
 {}
 
 #ifdef WITH_SCOREFORESTS
@@ -36,17 +42,139 @@ void DecisionForest_CPU<DescriptorType,TreeCount>::find_leaves(const DescriptorI
   const DescriptorType *descriptorsPtr = descriptors->GetData(MEMORYDEVICE_CPU);
   const NodeEntry *nodeImage = this->m_nodeImage->GetData(MEMORYDEVICE_CPU);
   LeafIndices *leafIndicesPtr = leafIndices->GetData(MEMORYDEVICE_CPU);
+  const int nodeStride = this->get_node_stride();
+  const int treeStride = this->get_tree_stride();
 
 #ifdef WITH_OPENMP
 #pragma omp parallel for
 #endif
   for(int y = 0; y < imgSize.y; ++y)
   {
-    for(int x = 0; x < imgSize.x; ++x)
+    int x = 0;
+
+#ifdef WITH_AVX2
+    // Process as much of the row as possible in batches of 8 descriptors (if the descriptors store their features as floats).
+    const int batchEnd = boost::is_same<typename DescriptorType::FeatureType,float>::value ? imgSize.x - 7 : 0;
+    for(; x < batchEnd; x += 8)
+    {
+      int rasterIndices[8];
+      for(int i = 0; i < 8; ++i) rasterIndices[i] = y * imgSize.x + x + i;
+      compute_leaf_indices_avx2(rasterIndices, descriptorsPtr, nodeImage, nodeStride, treeStride, leafIndicesPtr);
+    }
+#endif
+
+    // Process any remaining descriptors one at a time.
+    for(; x < imgSize.x; ++x)
+    {
+      compute_leaf_indices(x, y, descriptorsPtr, imgSize, nodeImage, nodeStride, treeStride, leafIndicesPtr);
+    }
+  }
+}
+
+template <typename DescriptorType, int TreeCount>
+void DecisionForest_CPU<DescriptorType,TreeCount>::find_leaves(const DescriptorImage_CPtr& descriptors, const ITMIntMemoryBlock_CPtr& descriptorIndices,
+                                                               uint32_t descriptorCount, LeafIndicesImage_Ptr& leafIndices) const
+{
+  // Ensure that the leaf indices image is the same size as the descriptors image.
+  const Vector2i imgSize = descriptors->noDims;
+  leafIndices->ChangeDims(imgSize);
+
+  // Compute the leaf indices associated with each of the specified descriptors.
+  const DescriptorType *descriptorsPtr = descriptors->GetData(MEMORYDEVICE_CPU);
+  const int *descriptorIndicesPtr = descriptorIndices->GetData(MEMORYDEVICE_CPU);
+  const NodeEntry *nodeImage = this->m_nodeImage->GetData(MEMORYDEVICE_CPU);
+  LeafIndices *leafIndicesPtr = leafIndices->GetData(MEMORYDEVICE_CPU);
+  const int nodeStride = this->get_node_stride();
+  const int treeStride = this->get_tree_stride();
+  const int count = static_cast<int>(descriptorCount);
+
+#ifdef WITH_AVX2
+  // Process as many of the descriptors as possible in batches of 8 (if the descriptors store their features as floats).
+  const int batchCount = boost::is_same<typename DescriptorType::FeatureType,float>::value ? count / 8 : 0;
+
+#ifdef WITH_OPENMP
+#pragma omp parallel for
+#endif
+  for(int batchIdx = 0; batchIdx < batchCount; ++batchIdx)
+  {
+    compute_leaf_indices_avx2(descriptorIndicesPtr + batchIdx * 8, descriptorsPtr, nodeImage, nodeStride, treeStride, leafIndicesPtr);
+  }
+
+  const int firstRemainingIdx = batchCount * 8;
+#else
+  const int firstRemainingIdx = 0;
+#endif
+
+  // Process any remaining descriptors one at a time.
+#ifdef WITH_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = firstRemainingIdx; i < count; ++i)
+  {
+    const int rasterIdx = descriptorIndicesPtr[i];
+    compute_leaf_indices(rasterIdx % imgSize.x, rasterIdx / imgSize.x, descriptorsPtr, imgSize, nodeImage, nodeStride, treeStride, leafIndicesPtr);
+  }
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+#ifdef WITH_AVX2
+template <typename DescriptorType, int TreeCount>
+void DecisionForest_CPU<DescriptorType,TreeCount>::compute_leaf_indices_avx2(const int *rasterIndices, const DescriptorType *descriptors, const NodeEntry *nodeImage,
+                                                                             int nodeStride, int treeStride, LeafIndices *leafIndices)
+{
+  // Note: The gathers treat the descriptors and the nodes as arrays of 32-bit words. Each node consists of four words
+  //       (featureIdx, featureThreshold, leafIdx and leftChildIdx, in that order), and each descriptor of an array of floats.
+  const int nodeWordCount = sizeof(NodeEntry) / sizeof(int);
+  const int descriptorWordCount = sizeof(DescriptorType) / sizeof(float);
+  const int *nodeWords = reinterpret_cast<const int*>(nodeImage);
+  const float *descriptorWords = reinterpret_cast<const float*>(descriptors);
+
+  // Compute the offsets of the descriptors in the batch.
+  const __m256i rasterIndicesV = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rasterIndices));
+  const __m256i descriptorOffsets = _mm256_mullo_epi32(rasterIndicesV, _mm256_set1_epi32(descriptorWordCount));
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i nodeStrideWords = _mm256_set1_epi32(nodeStride * nodeWordCount);
+
+  // For each tree in the forest:
+  for(int treeIdx = 0; treeIdx < TreeCount; ++treeIdx)
+  {
+    // Start all of the descriptors from the root node.
+    const __m256i treeOffset = _mm256_set1_epi32(treeIdx * treeStride * nodeWordCount);
+    __m256i nodeOffsets = treeOffset;
+    __m256i leafIdx = _mm256_i32gather_epi32(nodeWords + 2, nodeOffsets, 4);
+
+    // Each lane remains active until its descriptor reaches a leaf (i.e. until leafIdx >= 0).
+    __m256i active = _mm256_cmpgt_epi32(zero, leafIdx);
+
+    while(!_mm256_testz_si256(active, active))
     {
-      compute_leaf_indices(x, y, descriptorsPtr, imgSize, nodeImage, leafIndicesPtr);
+      // Fetch the parameters of the current node for each active lane.
+      const __m256i featureIdx = _mm256_mask_i32gather_epi32(zero, nodeWords, nodeOffsets, active, 4);
+      const __m256 featureThreshold = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), reinterpret_cast<const float*>(nodeWords + 1), nodeOffsets, _mm256_castsi256_ps(active), 4);
+      const __m256i leftChildIdx = _mm256_mask_i32gather_epi32(zero, nodeWords + 3, nodeOffsets, active, 4);
+
+      // Fetch the features and descend to either the left or right subtree. Note that the comparison yields -1 for true.
+      const __m256 features = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), descriptorWords, _mm256_add_epi32(descriptorOffsets, featureIdx), _mm256_castsi256_ps(active), 4);
+      const __m256i goRight = _mm256_castps_si256(_mm256_cmp_ps(features, featureThreshold, _CMP_GT_OQ));
+      const __m256i childIdx = _mm256_sub_epi32(leftChildIdx, goRight);
+
+      // Move the active lanes to their children and check whether they have reached a leaf.
+      nodeOffsets = _mm256_blendv_epi8(nodeOffsets, _mm256_add_epi32(treeOffset, _mm256_mullo_epi32(childIdx, nodeStrideWords)), active);
+      leafIdx = _mm256_mask_i32gather_epi32(leafIdx, nodeWords + 2, nodeOffsets, active, 4);
+      active = _mm256_and_si256(active, _mm256_cmpgt_epi32(zero, leafIdx));
+    }
+
+    // Write the indices of the leaves that have been reached into the leaf indices image.
+    int leaves[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(leaves), leafIdx);
+    for(int i = 0; i < 8; ++i)
+    {
+      leafIndices[rasterIndices[i]][treeIdx] = leaves[i];
     }
   }
 }
+#endif
 
 }
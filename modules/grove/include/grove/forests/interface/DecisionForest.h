@@ -12,6 +12,10 @@
 
 #include <ORUtils/Image.h>
 
+#include <itmx/base/ITMMemoryBlockPtrTypes.h>
+
+#include "../base/DecisionForestNodeLayout.h"
+
 //#################### FORWARD DECLARATIONS ####################
 
 #ifdef WITH_SCOREFORESTS
@@ -28,7 +32,8 @@ namespace grove {
  * \note  Training is not performed by this class. We use the node indexing technique described in
  *        "Implementing Decision Trees and Forests on a GPU" (Toby Sharp, 2008).
  *
- * \tparam DescriptorType The type of descriptor used to find the leaves. Must have a floating-point member array named "data".
+ * \tparam DescriptorType The type of descriptor used to find the leaves. Must have a member array named "data" whose elements are
+ *                        comparable to float thresholds, and a FeatureType typedef giving their type (see Descriptor).
  * \tparam TreeCount      The number of trees in the forest. Fixed at compilation time to allow the definition of a data type
  *                        representing the leaf indices.
  */
@@ -39,6 +44,9 @@ class DecisionForest
 public:
   // Expose the tree count to client code.
   enum { TREE_COUNT = TreeCount };
+private:
+  // The version of the binary file format written by save_structure_to_binary_file.
+  enum { BINARY_FORMAT_VERSION = 1 };
 
   //#################### NESTED TYPES ####################
 public:
@@ -96,7 +104,13 @@ protected:
   /** The total number of leaves in the forest. */
   uint32_t m_nbTotalLeaves;
 
-  /** An image storing the indexing structure of the forest. See the paper by Toby Sharp for details. */
+  /** The layout of the nodes in the node image. */
+  DecisionForestNodeLayout m_nodeLayout;
+
+  /**
+   * An image storing the indexing structure of the forest. See the paper by Toby Sharp for details. Its size is always
+   * nbTrees * maxNbNodes, but the way in which the nodes are laid out within it depends on m_nodeLayout.
+   */
   NodeImage_Ptr m_nodeImage;
 
   //#################### CONSTRUCTORS ####################
@@ -109,11 +123,12 @@ protected:
   /**
    * \brief Loads the branching structure of a pre-trained decision forest from a file on disk.
    *
-   * \param filename The path to the file containing the forest.
+   * \param filename   The path to the file containing the forest.
+   * \param nodeLayout The layout to use for the nodes of the forest in memory.
    *
    * \throws std::runtime_error If the forest cannot be loaded.
    */
-  explicit DecisionForest(const std::string& filename);
+  explicit DecisionForest(const std::string& filename, DecisionForestNodeLayout nodeLayout = INTERLEAVED_LAYOUT);
 
 #ifdef WITH_SCOREFORESTS
   /**
@@ -143,6 +158,20 @@ public:
    */
   virtual void find_leaves(const DescriptorImage_CPtr& descriptors, LeafIndicesImage_Ptr& leafIndices) const = 0;
 
+  /**
+   * \brief Given an image filled with descriptors, evaluates the forest only for the descriptors at the specified raster indices,
+   *        and returns the leaf indices associated with each such descriptor (one per tree).
+   *
+   * \param descriptors       An image in which each pixel contains a descriptor.
+   * \param descriptorIndices A memory block whose first descriptorCount elements are the raster indices of the descriptors to evaluate
+   *                          (e.g. as computed by RGBDPatchFeatureCalculator::compute_sparse_keypoints_and_features).
+   * \param descriptorCount   The number of descriptors to evaluate.
+   * \param leafIndices       An image (of the same size as descriptors) in which to store the leaf indices computed for the evaluated
+   *                          descriptors. The entries corresponding to the other descriptors are left untouched.
+   */
+  virtual void find_leaves(const DescriptorImage_CPtr& descriptors, const ITMIntMemoryBlock_CPtr& descriptorIndices, uint32_t descriptorCount,
+                           LeafIndicesImage_Ptr& leafIndices) const = 0;
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -179,9 +208,19 @@ public:
    */
   uint32_t get_nb_trees() const;
 
+  /**
+   * \brief Gets the layout of the nodes of the forest in memory.
+   *
+   * \return The layout of the nodes of the forest in memory.
+   */
+  DecisionForestNodeLayout get_node_layout() const;
+
   /**
    * \brief Loads the branching structure of a pre-trained decision forest from a file on disk.
    *
+   * \note If the file starts with the binary magic number, it is loaded via load_structure_from_binary_file;
+   *       otherwise, it is parsed as a text file.
+   *
    * \param filename  The path to the file containing the forest.
    *
    * \throws std::runtime_error If the forest cannot be loaded.
@@ -202,6 +241,40 @@ public:
    */
   void load_structure_from_file(const std::string& filename);
 
+  /**
+   * \brief Loads the branching structure of a pre-trained decision forest from a binary file on disk.
+   *
+   * The file is memory-mapped and its node array is copied into the node image in a single block,
+   * so the loading time does not depend on parsing the individual nodes.
+   *
+   * \param filename  The path to the file containing the forest.
+   *
+   * \throws std::runtime_error If the forest cannot be loaded.
+   *
+   * \note File format (binary mode, native endianness, all fields are 32-bit unsigned integers unless stated otherwise):
+   *
+   * magic ("GRVF", 4 bytes)
+   * version
+   * nbTrees
+   * maxNbNodes
+   * sizeof(NodeEntry)
+   * tree1_nbNodes ... treeN_nbNodes
+   * tree1_nbLeaves ... treeN_nbLeaves
+   * the node image (maxNbNodes * nbTrees NodeEntry structs, interleaved as node0_tree1 ... node0_treeN node1_tree1 ...)
+   */
+  void load_structure_from_binary_file(const std::string& filename);
+
+  /**
+   * \brief Saves the branching structure of the decision forest to a binary file on disk.
+   *
+   * \note See load_structure_from_binary_file for details of the file format.
+   *
+   * \param filename  The path to the file to which to save the forest.
+   *
+   * \throws std::runtime_error If the forest cannot be saved.
+   */
+  void save_structure_to_binary_file(const std::string& filename) const;
+
   /**
    * \brief Saves the branching structure of the decision forest to a file on disk.
    *
@@ -211,8 +284,53 @@ public:
    */
   void save_structure_to_file(const std::string& filename) const;
 
+  /**
+   * \brief Changes the layout of the nodes of the forest in memory.
+   *
+   * \note The nodes may be renumbered as a result, but the leaf indices (and thus the results of find_leaves) are unaffected.
+   *
+   * \param nodeLayout The new layout to use for the nodes of the forest in memory.
+   *
+   * \throws std::runtime_error If the forest contains nodes that are not reachable from the roots of their trees.
+   */
+  void set_node_layout(DecisionForestNodeLayout nodeLayout);
+
+  //#################### PROTECTED MEMBER FUNCTIONS ####################
+protected:
+  /**
+   * \brief Gets the distance (in nodes) between consecutive nodes of a tree in the node image.
+   *
+   * \return The distance (in nodes) between consecutive nodes of a tree in the node image.
+   */
+  int get_node_stride() const;
+
+  /**
+   * \brief Gets the distance (in nodes) between the roots of consecutive trees in the node image.
+   *
+   * \return The distance (in nodes) between the roots of consecutive trees in the node image.
+   */
+  int get_tree_stride() const;
+
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Copies the nodes of the forest from a buffer in one layout to a buffer in another layout, renumbering them as necessary.
+   *
+   * \param srcNodes   The source buffer (of size nbTrees * maxNbNodes).
+   * \param srcLayout  The layout of the nodes in the source buffer.
+   * \param dstNodes   The destination buffer (of size nbTrees * maxNbNodes).
+   * \param dstLayout  The layout in which to store the nodes in the destination buffer.
+   */
+  void copy_nodes(const NodeEntry *srcNodes, DecisionForestNodeLayout srcLayout, NodeEntry *dstNodes, DecisionForestNodeLayout dstLayout) const;
+
+  /**
+   * \brief Rearranges the nodes in the node image (on the CPU only) from one layout to another.
+   *
+   * \param srcLayout  The current layout of the nodes in the node image.
+   * \param dstLayout  The layout into which to rearrange them.
+   */
+  void relayout_nodes(DecisionForestNodeLayout srcLayout, DecisionForestNodeLayout dstLayout);
+
 #ifdef WITH_SCOREFORESTS
   /**
    * \brief Converts a single node from a tree that was pre-trained with ScoreForests.
@@ -233,6 +351,27 @@ private:
   int convert_node(const Learner *learner, uint32_t nodeIdx, uint32_t treeIdx, uint32_t nbTrees, uint32_t outputIdx,
                    uint32_t outputFirstFreeIdx, NodeEntry *outputNodes, uint32_t& outputNbLeaves);
 #endif
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the order in which the nodes of a tree should be stored in the specified layout.
+   *
+   * \param treeNodes  The nodes of the tree, indexed as in the current layout.
+   * \param nodeLayout The layout for which we want to compute the node order.
+   * \return           The indices of the nodes in the current layout, in the order in which they should be stored.
+   *
+   * \throws std::runtime_error If the tree contains nodes that are not reachable from its root.
+   */
+  static std::vector<uint32_t> compute_node_order(const std::vector<NodeEntry>& treeNodes, DecisionForestNodeLayout nodeLayout);
+
+  /**
+   * \brief Determines whether or not the specified file contains a forest in the binary format.
+   *
+   * \param filename The path to the file.
+   * \return         true, if the file starts with the binary magic number, or false otherwise.
+   */
+  static bool is_binary_file(const std::string& filename);
 };
 
 }
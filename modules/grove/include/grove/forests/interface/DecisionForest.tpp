@@ -5,8 +5,13 @@
 
 #include "DecisionForest.h"
 
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <limits>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/lexical_cast.hpp>
 
 #ifdef WITH_SCOREFORESTS
@@ -26,11 +31,12 @@ namespace grove {
 
 template <typename DescriptorType, int TreeCount>
 DecisionForest<DescriptorType,TreeCount>::DecisionForest()
-: m_nbTotalLeaves(0)
+: m_nbTotalLeaves(0), m_nodeLayout(INTERLEAVED_LAYOUT)
 {}
 
 template <typename DescriptorType, int TreeCount>
-DecisionForest<DescriptorType,TreeCount>::DecisionForest(const std::string& filename)
+DecisionForest<DescriptorType,TreeCount>::DecisionForest(const std::string& filename, DecisionForestNodeLayout nodeLayout)
+: m_nbTotalLeaves(0), m_nodeLayout(nodeLayout)
 {
   load_structure_from_file(filename);
 }
@@ -38,6 +44,7 @@ DecisionForest<DescriptorType,TreeCount>::DecisionForest(const std::string& file
 #ifdef WITH_SCOREFORESTS
 template <typename DescriptorType, int TreeCount>
 DecisionForest<DescriptorType, TreeCount>::DecisionForest(const EnsembleLearner& pretrainedForest)
+: m_nbTotalLeaves(0), m_nodeLayout(INTERLEAVED_LAYOUT)
 {
   // Convert list of nodes into an appropriate image.
   const uint32_t nbTrees = pretrainedForest.GetNbTrees();
@@ -50,7 +57,7 @@ DecisionForest<DescriptorType, TreeCount>::DecisionForest(const EnsembleLearner&
 
   // Allocate the texture to store the nodes.
   const itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
-  m_nodeImage = mbf.make_image<NodeEntry>(Vector2i(nbTrees, maxNbNodes));
+  m_nodeImage = mbf.make_image<NodeEntry>(Vector2i(nbTrees, maxNbNodes), "DecisionForest");
   m_nodeImage->Clear();
 
   // Fill the nodes.
@@ -125,9 +132,22 @@ uint32_t DecisionForest<DescriptorType,TreeCount>::get_nb_trees() const
   return TREE_COUNT;
 }
 
+template <typename DescriptorType, int TreeCount>
+DecisionForestNodeLayout DecisionForest<DescriptorType,TreeCount>::get_node_layout() const
+{
+  return m_nodeLayout;
+}
+
 template <typename DescriptorType, int TreeCount>
 void DecisionForest<DescriptorType,TreeCount>::load_structure_from_file(const std::string& filename)
 {
+  // If the file contains a forest in the binary format, load it directly.
+  if(is_binary_file(filename))
+  {
+    load_structure_from_binary_file(filename);
+    return;
+  }
+
   // Clear the current forest.
   m_nodeImage.reset();
   m_nbNodesPerTree.clear();
@@ -175,7 +195,7 @@ void DecisionForest<DescriptorType,TreeCount>::load_structure_from_file(const st
 
   // Allocate and clear the node image.
   const itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
-  m_nodeImage = mbf.make_image<NodeEntry>(Vector2i(nbTrees, maxNbNodes));
+  m_nodeImage = mbf.make_image<NodeEntry>(Vector2i(nbTrees, maxNbNodes), "DecisionForest");
   m_nodeImage->Clear();
 
 #if RANDOM_FEATURES
@@ -237,10 +257,138 @@ void DecisionForest<DescriptorType,TreeCount>::load_structure_from_file(const st
     }
   }
 
+  // Rearrange the nodes into the desired layout (the file always uses the interleaved one).
+  if(m_nodeLayout != INTERLEAVED_LAYOUT) relayout_nodes(INTERLEAVED_LAYOUT, m_nodeLayout);
+
   // Ensure that the node image is available on the GPU (if we're using it).
   m_nodeImage->UpdateDeviceFromHost();
 }
 
+template <typename DescriptorType, int TreeCount>
+void DecisionForest<DescriptorType,TreeCount>::load_structure_from_binary_file(const std::string& filename)
+{
+  // Clear the current forest.
+  m_nodeImage.reset();
+  m_nbNodesPerTree.clear();
+  m_nbLeavesPerTree.clear();
+  m_nbTotalLeaves = 0;
+
+  // Map the file into memory.
+  boost::interprocess::mapped_region region;
+  try
+  {
+    boost::interprocess::file_mapping mapping(filename.c_str(), boost::interprocess::read_only);
+    boost::interprocess::mapped_region(mapping, boost::interprocess::read_only).swap(region);
+  }
+  catch(boost::interprocess::interprocess_exception&)
+  {
+    throw std::runtime_error("Couldn't load a forest from: " + filename);
+  }
+
+  const char *data = static_cast<const char*>(region.get_address());
+  const size_t fileSize = region.get_size();
+
+  // Read and check the header (version, nbTrees, maxNbNodes, sizeof(NodeEntry)).
+  const size_t magicSize = 4;
+  uint32_t header[4];
+  if(fileSize < magicSize + sizeof(header) || std::string(data, magicSize) != "GRVF")
+  {
+    throw std::runtime_error("Not a binary forest file: " + filename);
+  }
+
+  memcpy(header, data + magicSize, sizeof(header));
+  const uint32_t version = header[0], nbTrees = header[1], maxNbNodes = header[2], nodeEntrySize = header[3];
+
+  if(version != BINARY_FORMAT_VERSION)
+  {
+    throw std::runtime_error("Unsupported binary forest version: " + boost::lexical_cast<std::string>(version));
+  }
+
+  if(nodeEntrySize != sizeof(NodeEntry))
+  {
+    throw std::runtime_error("The node entries in the binary forest file have an unexpected size: " + boost::lexical_cast<std::string>(nodeEntrySize));
+  }
+
+  // Check that the number of trees is the same as the template instantiation.
+  if(nbTrees != get_nb_trees())
+  {
+    throw std::runtime_error(
+      "Number of trees of the loaded forest is incorrect. Should be " +
+      boost::lexical_cast<std::string>(get_nb_trees()) + " - Read: " +
+      boost::lexical_cast<std::string>(nbTrees)
+    );
+  }
+
+  // Check that the file has exactly the expected size.
+  const size_t countsOffset = magicSize + sizeof(header);
+  const size_t nodesOffset = countsOffset + 2 * nbTrees * sizeof(uint32_t);
+  const size_t nodesSize = static_cast<size_t>(maxNbNodes) * nbTrees * sizeof(NodeEntry);
+  if(fileSize != nodesOffset + nodesSize)
+  {
+    throw std::runtime_error("The binary forest file has an unexpected size: " + filename);
+  }
+
+  // Read the number of nodes and leaves in each tree.
+  m_nbNodesPerTree.resize(nbTrees);
+  m_nbLeavesPerTree.resize(nbTrees);
+  memcpy(&m_nbNodesPerTree[0], data + countsOffset, nbTrees * sizeof(uint32_t));
+  memcpy(&m_nbLeavesPerTree[0], data + countsOffset + nbTrees * sizeof(uint32_t), nbTrees * sizeof(uint32_t));
+
+  for(uint32_t i = 0; i < nbTrees; ++i)
+  {
+    if(m_nbNodesPerTree[i] > maxNbNodes) throw std::runtime_error("Error reading the dimensions of tree: " + boost::lexical_cast<std::string>(i));
+    m_nbTotalLeaves += m_nbLeavesPerTree[i];
+  }
+
+  std::cout << "Loading a forest with " << nbTrees << " trees.\n";
+  for(uint32_t i = 0; i < nbTrees; ++i)
+  {
+    std::cout << "\tTree " << i << ": " << m_nbNodesPerTree[i] << " nodes and " << m_nbLeavesPerTree[i] << " leaves.\n";
+  }
+
+  // Allocate the node image and fill it with the interleaved nodes in a single copy.
+  const itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
+  m_nodeImage = mbf.make_image<NodeEntry>(Vector2i(nbTrees, maxNbNodes), "DecisionForest");
+  memcpy(m_nodeImage->GetData(MEMORYDEVICE_CPU), data + nodesOffset, nodesSize);
+
+  // Rearrange the nodes into the desired layout (the file always uses the interleaved one).
+  if(m_nodeLayout != INTERLEAVED_LAYOUT) relayout_nodes(INTERLEAVED_LAYOUT, m_nodeLayout);
+
+  // Ensure that the node image is available on the GPU (if we're using it).
+  m_nodeImage->UpdateDeviceFromHost();
+}
+
+template <typename DescriptorType, int TreeCount>
+void DecisionForest<DescriptorType,TreeCount>::save_structure_to_binary_file(const std::string& filename) const
+{
+  std::ofstream out(filename.c_str(), std::ios::binary);
+
+  // Write the header.
+  const uint32_t nbTrees = get_nb_trees();
+  const uint32_t maxNbNodes = static_cast<uint32_t>(m_nodeImage->noDims.y);
+  const uint32_t header[4] = { BINARY_FORMAT_VERSION, nbTrees, maxNbNodes, sizeof(NodeEntry) };
+  out.write("GRVF", 4);
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  // Write the number of nodes in each tree, followed by the number of leaves in each tree.
+  out.write(reinterpret_cast<const char*>(&m_nbNodesPerTree[0]), nbTrees * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(&m_nbLeavesPerTree[0]), nbTrees * sizeof(uint32_t));
+
+  // Write the node image, converting it to the interleaved layout first if necessary.
+  const NodeEntry *forestNodes = m_nodeImage->GetData(MEMORYDEVICE_CPU);
+  std::vector<NodeEntry> interleavedNodes;
+  if(m_nodeLayout != INTERLEAVED_LAYOUT)
+  {
+    interleavedNodes.resize(m_nodeImage->dataSize);
+    copy_nodes(forestNodes, m_nodeLayout, &interleavedNodes[0], INTERLEAVED_LAYOUT);
+    forestNodes = &interleavedNodes[0];
+  }
+
+  out.write(reinterpret_cast<const char*>(forestNodes), m_nodeImage->dataSize * sizeof(NodeEntry));
+
+  if(!out) throw std::runtime_error("Error saving the forest to a file: " + filename);
+}
+
 template <typename DescriptorType, int TreeCount>
 void DecisionForest<DescriptorType,TreeCount>::save_structure_to_file(const std::string& filename) const
 {
@@ -258,11 +406,12 @@ void DecisionForest<DescriptorType,TreeCount>::save_structure_to_file(const std:
 
   // Then, for each tree, dump its nodes.
   const NodeEntry *forestNodes = m_nodeImage->GetData(MEMORYDEVICE_CPU);
+  const int nodeStride = get_node_stride(), treeStride = get_tree_stride();
   for(uint32_t treeIdx = 0; treeIdx < nbTrees; ++treeIdx)
   {
     for(uint32_t nodeIdx = 0; nodeIdx < m_nbNodesPerTree[treeIdx]; ++nodeIdx)
     {
-      const NodeEntry& node = forestNodes[nodeIdx * nbTrees + treeIdx];
+      const NodeEntry& node = forestNodes[treeIdx * treeStride + nodeIdx * nodeStride];
       out << node.leftChildIdx << ' ' << node.leafIdx << ' ' << node.featureIdx << ' ' << std::setprecision(7) << node.featureThreshold << '\n';
     }
   }
@@ -270,8 +419,180 @@ void DecisionForest<DescriptorType,TreeCount>::save_structure_to_file(const std:
   if(!out) throw std::runtime_error("Error saving the forest to a file: " + filename);
 }
 
+template <typename DescriptorType, int TreeCount>
+void DecisionForest<DescriptorType,TreeCount>::set_node_layout(DecisionForestNodeLayout nodeLayout)
+{
+  if(nodeLayout == m_nodeLayout) return;
+
+  if(m_nodeImage)
+  {
+    relayout_nodes(m_nodeLayout, nodeLayout);
+    m_nodeImage->UpdateDeviceFromHost();
+  }
+
+  m_nodeLayout = nodeLayout;
+}
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
+
+template <typename DescriptorType, int TreeCount>
+int DecisionForest<DescriptorType,TreeCount>::get_node_stride() const
+{
+  return m_nodeLayout == INTERLEAVED_LAYOUT ? static_cast<int>(get_nb_trees()) : 1;
+}
+
+template <typename DescriptorType, int TreeCount>
+int DecisionForest<DescriptorType,TreeCount>::get_tree_stride() const
+{
+  return m_nodeLayout == INTERLEAVED_LAYOUT ? 1 : m_nodeImage->noDims.y;
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+template <typename DescriptorType, int TreeCount>
+std::vector<uint32_t> DecisionForest<DescriptorType,TreeCount>::compute_node_order(const std::vector<NodeEntry>& treeNodes, DecisionForestNodeLayout nodeLayout)
+{
+  const uint32_t nbNodes = static_cast<uint32_t>(treeNodes.size());
+  std::vector<uint32_t> order;
+  order.reserve(nbNodes);
+
+  // In the interleaved layout, we simply keep the nodes in their current order.
+  if(nodeLayout == INTERLEAVED_LAYOUT)
+  {
+    for(uint32_t i = 0; i < nbNodes; ++i) order.push_back(i);
+    return order;
+  }
+
+  // Otherwise, we lay out the tree as a sequence of blocks, each of which is stored in breadth-first order. The root block
+  // spans blockDepth + 1 levels (15 nodes = 240 bytes for a depth of 3); every other block is rooted at a pair of siblings
+  // and spans blockDepth levels (14 nodes = 224 bytes), so that each block fits in four 64-byte cache lines. A breadth-first
+  // layout is just a blocked layout with a single (unbounded) block.
+  const uint32_t blockDepth = nodeLayout == BLOCKED_LAYOUT ? 3 : std::numeric_limits<uint32_t>::max();
+
+  std::deque<uint32_t> blockRoots;
+  std::vector<uint32_t> level(1, 0), nextLevel;
+  uint32_t levelsLeft = blockDepth;
+  if(nbNodes > 0) order.push_back(0);
+  else level.clear();
+
+  while(!level.empty())
+  {
+    // Add the remaining levels of the current block to the order.
+    for(uint32_t d = 0; d < levelsLeft && !level.empty(); ++d)
+    {
+      nextLevel.clear();
+      for(size_t i = 0, size = level.size(); i < size; ++i)
+      {
+        const int leftChildIdx = treeNodes[level[i]].leftChildIdx;
+        if(leftChildIdx < 0) continue;
+
+        if(static_cast<uint32_t>(leftChildIdx) + 1 >= nbNodes || order.size() + 2 > nbNodes)
+        {
+          throw std::runtime_error("The tree does not have a valid structure");
+        }
+
+        order.push_back(leftChildIdx);
+        order.push_back(leftChildIdx + 1);
+        nextLevel.push_back(leftChildIdx);
+        nextLevel.push_back(leftChildIdx + 1);
+      }
+      level.swap(nextLevel);
+    }
+
+    // The children of the nodes in the bottom level of the block become the roots of new blocks.
+    for(size_t i = 0, size = level.size(); i < size; ++i)
+    {
+      const int leftChildIdx = treeNodes[level[i]].leftChildIdx;
+      if(leftChildIdx >= 0) blockRoots.push_back(leftChildIdx);
+    }
+
+    // Start the next block (if any).
+    level.clear();
+    if(!blockRoots.empty())
+    {
+      const uint32_t leftChildIdx = blockRoots.front();
+      blockRoots.pop_front();
+
+      if(leftChildIdx + 1 >= nbNodes || order.size() + 2 > nbNodes)
+      {
+        throw std::runtime_error("The tree does not have a valid structure");
+      }
+
+      order.push_back(leftChildIdx);
+      order.push_back(leftChildIdx + 1);
+      level.push_back(leftChildIdx);
+      level.push_back(leftChildIdx + 1);
+      levelsLeft = blockDepth - 1;
+    }
+  }
+
+  if(order.size() != nbNodes) throw std::runtime_error("The tree contains nodes that are not reachable from its root");
+
+  return order;
+}
+
+template <typename DescriptorType, int TreeCount>
+bool DecisionForest<DescriptorType,TreeCount>::is_binary_file(const std::string& filename)
+{
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  char magic[4];
+  return in.read(magic, sizeof(magic)) && std::string(magic, sizeof(magic)) == "GRVF";
+}
+
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+template <typename DescriptorType, int TreeCount>
+void DecisionForest<DescriptorType,TreeCount>::copy_nodes(const NodeEntry *srcNodes, DecisionForestNodeLayout srcLayout,
+                                                         NodeEntry *dstNodes, DecisionForestNodeLayout dstLayout) const
+{
+  const uint32_t nbTrees = get_nb_trees();
+  const int maxNbNodes = m_nodeImage->noDims.y;
+  const int srcNodeStride = srcLayout == INTERLEAVED_LAYOUT ? nbTrees : 1;
+  const int srcTreeStride = srcLayout == INTERLEAVED_LAYOUT ? 1 : maxNbNodes;
+  const int dstNodeStride = dstLayout == INTERLEAVED_LAYOUT ? nbTrees : 1;
+  const int dstTreeStride = dstLayout == INTERLEAVED_LAYOUT ? 1 : maxNbNodes;
+
+  // Clear the destination buffer (so that the unused entries are zero, as in a freshly-loaded forest).
+  memset(dstNodes, 0, m_nodeImage->dataSize * sizeof(NodeEntry));
+
+  std::vector<NodeEntry> treeNodes;
+  std::vector<int> newNodeIndices;
+  for(uint32_t treeIdx = 0; treeIdx < nbTrees; ++treeIdx)
+  {
+    // Gather the nodes of the tree.
+    const uint32_t nbNodes = m_nbNodesPerTree[treeIdx];
+    treeNodes.resize(nbNodes);
+    for(uint32_t nodeIdx = 0; nodeIdx < nbNodes; ++nodeIdx)
+    {
+      treeNodes[nodeIdx] = srcNodes[treeIdx * srcTreeStride + nodeIdx * srcNodeStride];
+    }
+
+    // Determine the order in which they should be stored in the destination layout, and renumber them accordingly.
+    const std::vector<uint32_t> order = compute_node_order(treeNodes, dstLayout);
+    newNodeIndices.assign(nbNodes, -1);
+    for(uint32_t i = 0; i < nbNodes; ++i)
+    {
+      if(newNodeIndices[order[i]] != -1) throw std::runtime_error("The tree does not have a valid structure");
+      newNodeIndices[order[i]] = i;
+    }
+
+    for(uint32_t i = 0; i < nbNodes; ++i)
+    {
+      NodeEntry node = treeNodes[order[i]];
+      if(node.leftChildIdx >= 0) node.leftChildIdx = newNodeIndices[node.leftChildIdx];
+      dstNodes[treeIdx * dstTreeStride + i * dstNodeStride] = node;
+    }
+  }
+}
+
+template <typename DescriptorType, int TreeCount>
+void DecisionForest<DescriptorType,TreeCount>::relayout_nodes(DecisionForestNodeLayout srcLayout, DecisionForestNodeLayout dstLayout)
+{
+  NodeEntry *forestNodes = m_nodeImage->GetData(MEMORYDEVICE_CPU);
+  const std::vector<NodeEntry> srcNodes(forestNodes, forestNodes + m_nodeImage->dataSize);
+  copy_nodes(&srcNodes[0], srcLayout, forestNodes, dstLayout);
+}
+
 #ifdef WITH_SCOREFORESTS
 template <typename DescriptorType, int TreeCount>
 int DecisionForest<DescriptorType,TreeCount>::convert_node(const Learner *tree, uint32_t nodeIdx, uint32_t treeIdx, uint32_t nbTrees, uint32_t outputIdx,
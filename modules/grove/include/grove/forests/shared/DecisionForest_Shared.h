@@ -18,12 +18,14 @@ namespace grove {
  * \param descriptors The descriptors image.
  * \param imgSize     The size of the descriptors and leaf indices images.
  * \param nodeImage   The forest indexing structure.
+ * \param nodeStride  The distance (in nodes) between consecutive nodes of a tree in the forest indexing structure.
+ * \param treeStride  The distance (in nodes) between the roots of consecutive trees in the forest indexing structure.
  * \param leafIndices An image in which to store the leaf indices computed for the descriptor.
  */
 template <typename NodeType, typename DescriptorType, int TreeCount>
 _CPU_AND_GPU_CODE_TEMPLATE_
-inline void compute_leaf_indices(int x, int y, const DescriptorType *descriptors, Vector2i imgSize,
-                                 const NodeType *nodeImage, ORUtils::VectorX<int,TreeCount> *leafIndices)
+inline void compute_leaf_indices(int x, int y, const DescriptorType *descriptors, Vector2i imgSize, const NodeType *nodeImage,
+                                 int nodeStride, int treeStride, ORUtils::VectorX<int,TreeCount> *leafIndices)
 {
   // Look up the descriptor whose leaf indices we want to compute.
   const int rasterIdx = y * imgSize.width + x;
@@ -33,17 +35,18 @@ inline void compute_leaf_indices(int x, int y, const DescriptorType *descriptors
   for(int treeIdx = 0; treeIdx < TreeCount; ++treeIdx)
   {
     // Start from the root node and iteratively walk down the tree until a leaf is reached.
+    const NodeType *treeNodes = nodeImage + treeIdx * treeStride;
     uint32_t currentNodeIdx = 0;
-    NodeType node = nodeImage[currentNodeIdx * TreeCount + treeIdx];
+    NodeType node = treeNodes[currentNodeIdx * nodeStride];
 
     // Note: This is for clarity: we could (if desired) test node.leafIdx directly in the while condition.
     bool isLeaf = node.leafIdx >= 0;
 
     while(!isLeaf)
     {
-      // Descend to either the left or right subtree.
+      // Descend to either the left or right subtree. Note that quantised features (e.g. int16_t) are promoted to float for the comparison.
       currentNodeIdx = node.leftChildIdx + static_cast<int>(currentDescriptor.data[node.featureIdx] > node.featureThreshold);
-      node = nodeImage[currentNodeIdx * TreeCount + treeIdx];
+      node = treeNodes[currentNodeIdx * nodeStride];
       isLeaf = node.leafIdx >= 0;
     }
 
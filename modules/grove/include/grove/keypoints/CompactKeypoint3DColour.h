@@ -0,0 +1,151 @@
+/**
+ * grove: CompactKeypoint3DColour.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_COMPACTKEYPOINT3DCOLOUR
+#define H_GROVE_COMPACTKEYPOINT3DCOLOUR
+
+#include <cmath>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ORUtils/Image.h>
+#include <ORUtils/PlatformIndependence.h>
+
+#include "Keypoint3DColour.h"
+
+namespace grove {
+
+//#################### CONSTANTS ####################
+
+/** The value of the x coordinate of a compact keypoint that is used to denote an invalid keypoint. */
+#define COMPACT_KEYPOINT_INVALID_COORD (-32768)
+
+/** The number of quantisation steps per metre used for the positions of compact keypoints (i.e. positions are stored to the nearest millimetre). */
+#define COMPACT_KEYPOINT_STEPS_PER_METRE 1000.0f
+
+/**
+ * \brief An instance of this struct represents a 3D keypoint with an associated colour, compressed to half the size of a Keypoint3DColour.
+ *
+ * The position is quantised to the nearest millimetre relative to the world origin, and stored in 16-bit integers, so positions up to
+ * 32.767m away from the origin along each axis can be represented (which easily covers the scenes we reconstruct, since the origin is
+ * the initial camera position). The colour is packed into 16 bits in RGB565 format, and the validity flag is folded into a sentinel
+ * value of the x coordinate, giving instances of size 3 * 2 + 2 = 8 (rather than 16 for a Keypoint3DColour). This allows twice as
+ * many examples to be stored in the same amount of memory without any significant loss of accuracy: the quantisation error of the
+ * positions is much smaller than the bandwidth used when clustering them.
+ */
+struct CompactKeypoint3DColour
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The keypoint's position in space, in millimetres (the x coordinate is COMPACT_KEYPOINT_INVALID_COORD if the keypoint is invalid). */
+  short position[3];
+
+  /** The keypoint's colour, packed in RGB565 format. */
+  unsigned short colour;
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Compresses a keypoint.
+ *
+ * \note Positions that are too far from the origin to be represented are clamped to the representable range.
+ *
+ * \param keypoint  The keypoint to compress.
+ * \return          The compressed keypoint.
+ */
+_CPU_AND_GPU_CODE_
+inline CompactKeypoint3DColour compress_keypoint(const Keypoint3DColour& keypoint)
+{
+  CompactKeypoint3DColour result;
+
+  if(keypoint.valid)
+  {
+    for(int i = 0; i < 3; ++i)
+    {
+      const float quantised = roundf(keypoint.position[i] * COMPACT_KEYPOINT_STEPS_PER_METRE);
+      result.position[i] = static_cast<short>(fminf(fmaxf(quantised, -32767.0f), 32767.0f));
+    }
+  }
+  else
+  {
+    result.position[0] = COMPACT_KEYPOINT_INVALID_COORD;
+    result.position[1] = result.position[2] = 0;
+  }
+
+  const Vector3u& c = keypoint.colour;
+  result.colour = static_cast<unsigned short>(((c.x >> 3) << 11) | ((c.y >> 2) << 5) | (c.z >> 3));
+
+  return result;
+}
+
+/**
+ * \brief Gets the colour of a compressed keypoint.
+ *
+ * \param keypoint  The compressed keypoint.
+ * \return          The colour of the keypoint.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector3u get_colour(const CompactKeypoint3DColour& keypoint)
+{
+  // Replicate the high bits of each channel into its low bits, so that the full range [0,255] is recovered.
+  const unsigned int r = (keypoint.colour >> 11) & 0x1f, g = (keypoint.colour >> 5) & 0x3f, b = keypoint.colour & 0x1f;
+  return Vector3u(
+    static_cast<unsigned char>((r << 3) | (r >> 2)),
+    static_cast<unsigned char>((g << 2) | (g >> 4)),
+    static_cast<unsigned char>((b << 3) | (b >> 2))
+  );
+}
+
+/**
+ * \brief Gets the position of a compressed keypoint.
+ *
+ * \param keypoint  The compressed keypoint.
+ * \return          The position of the keypoint (in metres).
+ */
+_CPU_AND_GPU_CODE_
+inline Vector3f get_position(const CompactKeypoint3DColour& keypoint)
+{
+  const float metresPerStep = 1.0f / COMPACT_KEYPOINT_STEPS_PER_METRE;
+  return Vector3f(keypoint.position[0] * metresPerStep, keypoint.position[1] * metresPerStep, keypoint.position[2] * metresPerStep);
+}
+
+/**
+ * \brief Determines whether or not a compressed keypoint is valid.
+ *
+ * \param keypoint  The compressed keypoint.
+ * \return          true, if the keypoint is valid, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_valid(const CompactKeypoint3DColour& keypoint)
+{
+  return keypoint.position[0] != COMPACT_KEYPOINT_INVALID_COORD;
+}
+
+/**
+ * \brief Decompresses a keypoint.
+ *
+ * \param keypoint  The compressed keypoint.
+ * \return          The decompressed keypoint.
+ */
+_CPU_AND_GPU_CODE_
+inline Keypoint3DColour decompress_keypoint(const CompactKeypoint3DColour& keypoint)
+{
+  Keypoint3DColour result;
+  result.position = get_position(keypoint);
+  result.colour = get_colour(keypoint);
+  result.valid = is_valid(keypoint);
+  return result;
+}
+
+//#################### TYPEDEFS ####################
+
+typedef ORUtils::Image<CompactKeypoint3DColour> CompactKeypoint3DColourImage;
+typedef boost::shared_ptr<CompactKeypoint3DColourImage> CompactKeypoint3DColourImage_Ptr;
+typedef boost::shared_ptr<const CompactKeypoint3DColourImage> CompactKeypoint3DColourImage_CPtr;
+
+}
+
+#endif
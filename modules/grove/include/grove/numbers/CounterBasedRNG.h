@@ -0,0 +1,189 @@
+/**
+ * grove: CounterBasedRNG.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_COUNTERBASEDRNG
+#define H_GROVE_COUNTERBASEDRNG
+
+#include <cmath>
+
+#include <stdint.h>
+
+#include <ORUtils/PlatformIndependence.h>
+
+namespace grove {
+
+/**
+ * \brief An instance of this class can be used to generate random numbers in shared code without any persistent state.
+ *
+ * The numbers are generated using the Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers:
+ * As Easy as 1, 2, 3", SC 2011), which maps a (key, counter) pair to four pseudo-random 32-bit integers by applying
+ * ten rounds of a simple bijection. Each generator is fully determined by the (seed, stream, frame) triple from which
+ * it is constructed, so a thread can construct one on the fly (e.g. from its pixel index and the index of the current
+ * frame) rather than loading and storing a persistent state. Since the generation is pure integer arithmetic, the CPU
+ * and CUDA implementations of an algorithm that use it produce exactly the same stream of random integers.
+ */
+class CounterBasedRNG
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The counter for the next block of four outputs. */
+  uint32_t m_counter[4];
+
+  /** The key (derived from the seed). */
+  uint32_t m_key[2];
+
+  /** The index of the next unused output in m_outputs (4 if there are none). */
+  int m_outputIdx;
+
+  /** The most recently generated block of outputs. */
+  uint32_t m_outputs[4];
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a counter-based random number generator.
+   *
+   * Generators constructed with different (seed, streamIdx, frameIdx) triples produce independent streams.
+   *
+   * \param seed      The seed for the generator.
+   * \param streamIdx The index of the stream to generate (e.g. the index of the pixel being processed).
+   * \param frameIdx  The index of the frame (or other sequence) in which the stream is being generated.
+   */
+  _CPU_AND_GPU_CODE_
+  CounterBasedRNG(uint32_t seed, uint32_t streamIdx, uint32_t frameIdx)
+  : m_outputIdx(4)
+  {
+    m_counter[0] = streamIdx;
+    m_counter[1] = frameIdx;
+    m_counter[2] = 0;
+    m_counter[3] = 0;
+    m_key[0] = seed;
+    m_key[1] = 0;
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Generates a random number from a 1D Gaussian distribution with the specified parameters.
+   *
+   * \param mean  The mean of the Gaussian distribution.
+   * \param sigma The standard deviation of the Gaussian distribution.
+   * \return      The generated number.
+   */
+  _CPU_AND_GPU_CODE_
+  inline float generate_from_gaussian(float mean, float sigma)
+  {
+    // Use the Box-Muller transform. Note that u1 lies in ]0,1], so its logarithm is always defined.
+    const float u1 = (static_cast<float>(next_uint() >> 8) + 1.0f) * (1.0f / 16777216.0f);
+    const float u2 = static_cast<float>(next_uint() >> 8) * (1.0f / 16777216.0f);
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2) * sigma + mean;
+  }
+
+  /**
+   * \brief Generates a random integer from a uniform distribution over the specified (closed) range.
+   *
+   * For example, generate_int_from_uniform(3,5) returns an integer in the range [3,5].
+   *
+   * \param lower The lower bound of the range.
+   * \param upper The upper bound of the range.
+   * \return      The generated integer.
+   */
+  _CPU_AND_GPU_CODE_
+  inline int generate_int_from_uniform(int lower, int upper)
+  {
+    // Scale a random 32-bit integer into the range using a fixed-point multiplication (this avoids the bias of the modulo operator).
+    const uint32_t rangeSize = static_cast<uint32_t>(upper - lower) + 1;
+    const uint32_t offset = mulhi(next_uint(), rangeSize);
+    return lower + static_cast<int>(offset);
+  }
+
+  /**
+   * \brief Generates a random real number from a uniform distribution over the specified (closed) range.
+   *
+   * \param lower The lower bound of the range.
+   * \param upper The upper bound of the range.
+   * \return      The generated real number.
+   */
+  _CPU_AND_GPU_CODE_
+  inline float generate_real_from_uniform(float lower, float upper)
+  {
+    // Use the top 24 bits of a random integer, since that is all the precision a float has.
+    const float generated = static_cast<float>(next_uint() >> 8) * (1.0f / 16777215.0f);
+    return generated * (upper - lower) + lower;
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the high 32 bits of the 64-bit product of two 32-bit integers.
+   */
+  _CPU_AND_GPU_CODE_
+  static inline uint32_t mulhi(uint32_t a, uint32_t b)
+  {
+#ifdef __CUDA_ARCH__
+    return __umulhi(a, b);
+#else
+    return static_cast<uint32_t>((static_cast<unsigned long long>(a) * b) >> 32);
+#endif
+  }
+
+  /**
+   * \brief Gets the next random 32-bit integer, generating a new block of outputs if necessary.
+   */
+  _CPU_AND_GPU_CODE_
+  inline uint32_t next_uint()
+  {
+    if(m_outputIdx == 4)
+    {
+      philox4x32_10(m_counter, m_key, m_outputs);
+      m_outputIdx = 0;
+
+      // Advance to the next block. The first two words of the counter identify the stream, so only the last two are used here.
+      if(++m_counter[2] == 0) ++m_counter[3];
+    }
+
+    return m_outputs[m_outputIdx++];
+  }
+
+  /**
+   * \brief Applies the Philox4x32-10 bijection to the specified counter and key.
+   *
+   * \param counter The counter.
+   * \param key     The key.
+   * \param outputs An array into which to write the four outputs.
+   */
+  _CPU_AND_GPU_CODE_
+  static inline void philox4x32_10(const uint32_t *counter, const uint32_t *key, uint32_t *outputs)
+  {
+    const uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+    const uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for(int round = 0; round < 10; ++round)
+    {
+      const uint32_t hi0 = mulhi(M0, c0), lo0 = M0 * c0;
+      const uint32_t hi1 = mulhi(M1, c2), lo1 = M1 * c2;
+
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+
+      k0 += W0;
+      k1 += W1;
+    }
+
+    outputs[0] = c0;
+    outputs[1] = c1;
+    outputs[2] = c2;
+    outputs[3] = c3;
+  }
+};
+
+}
+
+#endif
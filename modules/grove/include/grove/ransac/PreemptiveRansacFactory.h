@@ -0,0 +1,43 @@
+/**
+ * grove: PreemptiveRansacFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_PREEMPTIVERANSACFACTORY
+#define H_GROVE_PREEMPTIVERANSACFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/PreemptiveRansac.h"
+
+namespace grove {
+
+/**
+ * \brief This struct can be used to construct preemptive RANSAC pose estimators.
+ */
+struct PreemptiveRansacFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a preemptive RANSAC pose estimator.
+   *
+   * \param deviceType                              The device on which the pose estimator should operate.
+   * \param maxCandidateCount                       The maximum number of pose candidates to generate.
+   * \param maxAttemptsPerCandidate                 The maximum number of attempts to make when generating each pose candidate.
+   * \param batchSize                               The number of pixels against which the candidates are evaluated in each iteration.
+   * \param minSquaredDistanceBetweenSampledPoints  The minimum squared distance between the camera points used to generate a candidate.
+   * \param maxTranslationError                     The maximum permitted discrepancy between the triangles used to generate a candidate.
+   * \param useAllModes                             Whether to sample from all of the modes of each pixel's prediction.
+   * \param rngSeed                                 The seed for the random number generators.
+   * \return                                        The pose estimator.
+   */
+  static PreemptiveRansac_Ptr make_preemptive_ransac(ITMLib::ITMLibSettings::DeviceType deviceType, uint32_t maxCandidateCount,
+                                                     uint32_t maxAttemptsPerCandidate, uint32_t batchSize,
+                                                     float minSquaredDistanceBetweenSampledPoints, float maxTranslationError, bool useAllModes,
+                                                     uint32_t rngSeed = 42);
+};
+
+}
+
+#endif
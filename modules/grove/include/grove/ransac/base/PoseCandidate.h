@@ -0,0 +1,32 @@
+/**
+ * grove: PoseCandidate.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_POSECANDIDATE
+#define H_GROVE_POSECANDIDATE
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace grove {
+
+/**
+ * \brief An instance of this struct represents a candidate camera pose that has been hypothesised by a RANSAC-based pose estimator.
+ */
+struct PoseCandidate
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** A transformation from the camera's reference frame to the world reference frame. */
+  Matrix4f cameraPose;
+
+  /** The energy of the candidate (lower is better), summed over the inlier pixels against which it has been evaluated. */
+  float energy;
+
+  /** A flag indicating whether or not the candidate is valid (i.e. whether or not it was successfully generated). */
+  bool valid;
+};
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * grove: PreemptiveRansac_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_PREEMPTIVERANSAC_CUDA
+#define H_GROVE_PREEMPTIVERANSAC_CUDA
+
+#include "../interface/PreemptiveRansac.h"
+#include "../../numbers/CUDARNG.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of this class can be used to estimate a camera pose using preemptive RANSAC on CUDA.
+ */
+class PreemptiveRansac_CUDA : public PreemptiveRansac
+{
+  //#################### PRIVATE MEMBER VARIABLES ####################
+private:
+  /** A set of random number generators (one for each pose candidate or sampled pixel, whichever there are more of). */
+  CUDARNGMemoryBlock_Ptr m_rngs;
+
+  /** A memory block in which to count the pose candidates that were successfully generated. */
+  ITMIntMemoryBlock_Ptr m_validCandidateCount;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a preemptive RANSAC pose estimator.
+   *
+   * \param maxCandidateCount                       The maximum number of pose candidates to generate.
+   * \param maxAttemptsPerCandidate                 The maximum number of attempts to make when generating each pose candidate.
+   * \param batchSize                               The number of pixels against which the candidates are evaluated in each iteration.
+   * \param minSquaredDistanceBetweenSampledPoints  The minimum squared distance between the camera points used to generate a candidate.
+   * \param maxTranslationError                     The maximum permitted discrepancy between the triangles used to generate a candidate.
+   * \param useAllModes                             Whether to sample from all of the modes of each pixel's prediction.
+   * \param rngSeed                                 The seed for the random number generators.
+   *
+   * \throws std::invalid_argument If maxCandidateCount is too large for the candidates to be ranked within a single block.
+   */
+  PreemptiveRansac_CUDA(uint32_t maxCandidateCount, uint32_t maxAttemptsPerCandidate, uint32_t batchSize,
+                        float minSquaredDistanceBetweenSampledPoints, float maxTranslationError, bool useAllModes, uint32_t rngSeed = 42);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void compute_candidate_energies(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions,
+                                          uint32_t survivingCandidateCount);
+
+  /** Override */
+  virtual uint32_t find_valid_candidates();
+
+  /** Override */
+  virtual void generate_pose_candidates(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions);
+
+  /** Override */
+  virtual void reinit_rngs();
+
+  /** Override */
+  virtual void sample_inliers(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions);
+
+  /** Override */
+  virtual void sort_surviving_candidates(uint32_t survivingCandidateCount);
+};
+
+}
+
+#endif
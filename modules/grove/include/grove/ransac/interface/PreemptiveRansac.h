@@ -0,0 +1,168 @@
+/**
+ * grove: PreemptiveRansac.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_PREEMPTIVERANSAC
+#define H_GROVE_PREEMPTIVERANSAC
+
+#include <vector>
+
+#include <itmx/base/ITMMemoryBlockPtrTypes.h>
+
+#include "../base/PoseCandidate.h"
+#include "../../keypoints/Keypoint3DColour.h"
+#include "../../relocalisation/base/ScorePrediction.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to estimate a camera pose from a set of keypoints
+ *        (in camera coordinates) and their predicted positions in world coordinates, using preemptive RANSAC.
+ *
+ * A fixed number of pose candidates is first generated in parallel, each from three randomly-chosen keypoints and a randomly-chosen mode
+ * of each of their predictions (see estimate_rigid_transform). The surviving candidates are then repeatedly evaluated against a new batch
+ * of randomly-sampled pixels, and the worse half of them is culled, until no more than the desired number of candidates remains. Since
+ * the candidates are only ever evaluated against a small number of pixels, the overall cost is independent of the size of the scene.
+ *
+ * All of the rounds are run on the device on which the estimator operates: only the surviving candidates are copied back at the end.
+ * Note that the candidates are not refined further here: clients that need accurate poses are expected to refine them against the
+ * scene itself (e.g. using ICPRefiningRelocaliser).
+ */
+class PreemptiveRansac
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef ORUtils::MemoryBlock<PoseCandidate> PoseCandidateMemoryBlock;
+  typedef boost::shared_ptr<PoseCandidateMemoryBlock> PoseCandidateMemoryBlock_Ptr;
+
+  //#################### PROTECTED MEMBER VARIABLES ####################
+protected:
+  /** The number of pixels against which the surviving candidates are evaluated in each iteration. */
+  uint32_t m_batchSize;
+
+  /** The raster indices of the pixels in the current batch (-1 denotes a failed sample). */
+  ITMIntMemoryBlock_Ptr m_inlierRasterIndices;
+
+  /** The maximum number of attempts to make when generating each pose candidate. */
+  uint32_t m_maxAttemptsPerCandidate;
+
+  /** The maximum number of pose candidates to generate. */
+  uint32_t m_maxCandidateCount;
+
+  /** The maximum permitted discrepancy (in metres) between the camera and world triangles used to generate a candidate. */
+  float m_maxTranslationError;
+
+  /** The minimum squared distance (in square metres) between the camera points used to generate a candidate. */
+  float m_minSquaredDistanceBetweenSampledPoints;
+
+  /** The pose candidates. */
+  PoseCandidateMemoryBlock_Ptr m_poseCandidates;
+
+  /** The seed for the random number generators. */
+  uint32_t m_rngSeed;
+
+  /** The indices of the pose candidates that are still in contention (ranked in increasing order of energy after each round). */
+  ITMIntMemoryBlock_Ptr m_survivingCandidateIndices;
+
+  /** Whether to sample from all of the modes of each pixel's prediction when generating candidates (rather than just the largest). */
+  bool m_useAllModes;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a preemptive RANSAC pose estimator.
+   *
+   * \param maxCandidateCount                       The maximum number of pose candidates to generate.
+   * \param maxAttemptsPerCandidate                 The maximum number of attempts to make when generating each pose candidate.
+   * \param batchSize                               The number of pixels against which the candidates are evaluated in each iteration.
+   * \param minSquaredDistanceBetweenSampledPoints  The minimum squared distance between the camera points used to generate a candidate.
+   * \param maxTranslationError                     The maximum permitted discrepancy between the triangles used to generate a candidate.
+   * \param useAllModes                             Whether to sample from all of the modes of each pixel's prediction.
+   * \param rngSeed                                 The seed for the random number generators.
+   */
+  PreemptiveRansac(uint32_t maxCandidateCount, uint32_t maxAttemptsPerCandidate, uint32_t batchSize,
+                   float minSquaredDistanceBetweenSampledPoints, float maxTranslationError, bool useAllModes, uint32_t rngSeed);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the preemptive RANSAC pose estimator.
+   */
+  virtual ~PreemptiveRansac();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Evaluates the surviving pose candidates against a batch of sampled pixels, adding the pixels' energies to the candidates' energies.
+   *
+   * \param keypoints               The keypoints (in camera coordinates).
+   * \param predictions             The predictions for the keypoints.
+   * \param survivingCandidateCount The number of candidates in m_survivingCandidateIndices.
+   */
+  virtual void compute_candidate_energies(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions,
+                                          uint32_t survivingCandidateCount) = 0;
+
+  /**
+   * \brief Writes the indices of the pose candidates that were successfully generated into m_survivingCandidateIndices.
+   *
+   * \return The number of pose candidates that were successfully generated.
+   */
+  virtual uint32_t find_valid_candidates() = 0;
+
+  /**
+   * \brief Generates m_maxCandidateCount pose candidates into m_poseCandidates.
+   *
+   * \param keypoints   The keypoints (in camera coordinates).
+   * \param predictions The predictions for the keypoints.
+   */
+  virtual void generate_pose_candidates(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions) = 0;
+
+  /**
+   * \brief Reinitialises the random number generators using m_rngSeed.
+   */
+  virtual void reinit_rngs() = 0;
+
+  /**
+   * \brief Samples a batch of m_batchSize pixels that have both valid keypoints and non-empty predictions into m_inlierRasterIndices.
+   *
+   * \param keypoints   The keypoints (in camera coordinates).
+   * \param predictions The predictions for the keypoints.
+   */
+  virtual void sample_inliers(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions) = 0;
+
+  /**
+   * \brief Ranks the surviving pose candidates in m_survivingCandidateIndices in increasing order of energy (see pose_candidate_precedes).
+   *
+   * \param survivingCandidateCount The number of candidates in m_survivingCandidateIndices.
+   */
+  virtual void sort_surviving_candidates(uint32_t survivingCandidateCount) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Estimates the camera pose from a set of keypoints and their predicted positions in world coordinates.
+   *
+   * \param keypoints         The keypoints (in camera coordinates).
+   * \param predictions       The predictions for the keypoints (an empty prediction denotes a keypoint for which nothing was predicted).
+   * \param maxResultCount    The maximum number of pose candidates to return.
+   * \return                  The best pose candidates (at most maxResultCount of them), in increasing order of energy. The energy of
+   *                          each candidate is normalised to be the mean energy per evaluated pixel, and lies in [0,1].
+   */
+  std::vector<PoseCandidate> estimate_poses(const Keypoint3DColourImage_CPtr& keypoints, const ScorePredictionsImage_CPtr& predictions,
+                                            size_t maxResultCount);
+
+  /**
+   * \brief Resets the random number generators, so that subsequent pose estimates are reproducible.
+   */
+  void reset();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<PreemptiveRansac> PreemptiveRansac_Ptr;
+typedef boost::shared_ptr<const PreemptiveRansac> PreemptiveRansac_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,349 @@
+/**
+ * grove: PreemptiveRansac_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_PREEMPTIVERANSAC_SHARED
+#define H_GROVE_PREEMPTIVERANSAC_SHARED
+
+#include <ORUtils/PlatformIndependence.h>
+
+#include "../base/PoseCandidate.h"
+#include "../../keypoints/Keypoint3DColour.h"
+#include "../../relocalisation/base/ScorePrediction.h"
+
+namespace grove {
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of attempts to make when sampling a pixel with a valid keypoint and a non-empty prediction. */
+#define PREEMPTIVE_RANSAC_MAX_PIXEL_SAMPLING_TRIES 100
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Computes the eigenvalues and eigenvectors of a symmetric 4x4 matrix using cyclic Jacobi rotations.
+ *
+ * \param a             The matrix (destroyed by the computation).
+ * \param eigenvalues   An array into which to write the eigenvalues (in no particular order).
+ * \param eigenvectors  A matrix into whose columns to write the corresponding (unit) eigenvectors.
+ */
+_CPU_AND_GPU_CODE_
+inline void compute_symmetric_eigen_decomposition(float a[4][4], float eigenvalues[4], float eigenvectors[4][4])
+{
+  for(int i = 0; i < 4; ++i)
+  {
+    for(int j = 0; j < 4; ++j) eigenvectors[i][j] = i == j ? 1.0f : 0.0f;
+  }
+
+  for(int sweep = 0; sweep < 16; ++sweep)
+  {
+    float offDiagonal = 0.0f;
+    for(int p = 0; p < 3; ++p)
+    {
+      for(int q = p + 1; q < 4; ++q) offDiagonal += a[p][q] * a[p][q];
+    }
+
+    if(offDiagonal < 1e-30f) break;
+
+    for(int p = 0; p < 3; ++p)
+    {
+      for(int q = p + 1; q < 4; ++q)
+      {
+        if(fabsf(a[p][q]) < 1e-30f) continue;
+
+        // Compute the rotation that zeroes a[p][q].
+        const float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+        const float t = (theta >= 0.0f ? 1.0f : -1.0f) / (fabsf(theta) + sqrtf(theta * theta + 1.0f));
+        const float c = 1.0f / sqrtf(t * t + 1.0f);
+        const float s = t * c;
+
+        // Apply it to both sides of the matrix, and accumulate it into the eigenvectors.
+        for(int k = 0; k < 4; ++k)
+        {
+          const float akp = a[k][p], akq = a[k][q];
+          a[k][p] = c * akp - s * akq;
+          a[k][q] = s * akp + c * akq;
+        }
+
+        for(int k = 0; k < 4; ++k)
+        {
+          const float apk = a[p][k], aqk = a[q][k];
+          a[p][k] = c * apk - s * aqk;
+          a[q][k] = s * apk + c * aqk;
+        }
+
+        for(int k = 0; k < 4; ++k)
+        {
+          const float vkp = eigenvectors[k][p], vkq = eigenvectors[k][q];
+          eigenvectors[k][p] = c * vkp - s * vkq;
+          eigenvectors[k][q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+
+  for(int i = 0; i < 4; ++i) eigenvalues[i] = a[i][i];
+}
+
+/**
+ * \brief Estimates the rigid transformation that best maps three points in camera coordinates onto three corresponding
+ *        points in world coordinates (in the least-squares sense), as per the Kabsch algorithm.
+ *
+ * Rather than computing the singular value decomposition of the cross-covariance matrix H, which is awkward on the device,
+ * we solve the same least-squares problem using Horn's quaternion formulation: the optimal rotation is given by the unit
+ * eigenvector corresponding to the largest eigenvalue of a symmetric 4x4 matrix built from H. This needs only a small
+ * Jacobi eigen-solver, is well-conditioned in single precision, and always yields a proper rotation (no reflections).
+ *
+ * \param cameraPoints  The points in camera coordinates.
+ * \param worldPoints   The corresponding points in world coordinates.
+ * \param cameraPose    A matrix into which to write the estimated transformation from camera coordinates to world coordinates.
+ * \return              true, if the transformation could be estimated, or false if the points were degenerate (e.g. collinear).
+ */
+_CPU_AND_GPU_CODE_
+inline bool estimate_rigid_transform(const Vector3f cameraPoints[3], const Vector3f worldPoints[3], Matrix4f& cameraPose)
+{
+  const Vector3f cameraCentroid = (cameraPoints[0] + cameraPoints[1] + cameraPoints[2]) / 3.0f;
+  const Vector3f worldCentroid = (worldPoints[0] + worldPoints[1] + worldPoints[2]) / 3.0f;
+
+  // Compute the cross-covariance matrix H = sum_i (c_i - c) (w_i - w)^T.
+  float h[3][3] = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+  for(int i = 0; i < 3; ++i)
+  {
+    const Vector3f c = cameraPoints[i] - cameraCentroid;
+    const Vector3f w = worldPoints[i] - worldCentroid;
+    for(int r = 0; r < 3; ++r)
+    {
+      for(int col = 0; col < 3; ++col) h[r][col] += c[r] * w[col];
+    }
+  }
+
+  // Build Horn's symmetric 4x4 matrix from H, and find its eigen-decomposition.
+  float n[4][4];
+  n[0][0] = h[0][0] + h[1][1] + h[2][2];
+  n[1][1] = h[0][0] - h[1][1] - h[2][2];
+  n[2][2] = -h[0][0] + h[1][1] - h[2][2];
+  n[3][3] = -h[0][0] - h[1][1] + h[2][2];
+  n[0][1] = n[1][0] = h[1][2] - h[2][1];
+  n[0][2] = n[2][0] = h[2][0] - h[0][2];
+  n[0][3] = n[3][0] = h[0][1] - h[1][0];
+  n[1][2] = n[2][1] = h[0][1] + h[1][0];
+  n[1][3] = n[3][1] = h[2][0] + h[0][2];
+  n[2][3] = n[3][2] = h[1][2] + h[2][1];
+
+  float eigenvalues[4], eigenvectors[4][4];
+  compute_symmetric_eigen_decomposition(n, eigenvalues, eigenvectors);
+
+  // Find the largest eigenvalue. If it is not well separated from the others, the rotation is not uniquely determined
+  // (e.g. because the points are collinear), so early out.
+  int best = 0;
+  for(int i = 1; i < 4; ++i)
+  {
+    if(eigenvalues[i] > eigenvalues[best]) best = i;
+  }
+
+  float secondBest = -1e30f;
+  for(int i = 0; i < 4; ++i)
+  {
+    if(i != best && eigenvalues[i] > secondBest) secondBest = eigenvalues[i];
+  }
+
+  if(eigenvalues[best] - secondBest < 1e-4f * fabsf(eigenvalues[best]) + 1e-12f) return false;
+
+  // Convert the corresponding unit quaternion into a rotation matrix.
+  const float qw = eigenvectors[0][best], qx = eigenvectors[1][best], qy = eigenvectors[2][best], qz = eigenvectors[3][best];
+  float rot[3][3];
+  rot[0][0] = qw * qw + qx * qx - qy * qy - qz * qz;
+  rot[0][1] = 2.0f * (qx * qy - qw * qz);
+  rot[0][2] = 2.0f * (qx * qz + qw * qy);
+  rot[1][0] = 2.0f * (qx * qy + qw * qz);
+  rot[1][1] = qw * qw - qx * qx + qy * qy - qz * qz;
+  rot[1][2] = 2.0f * (qy * qz - qw * qx);
+  rot[2][0] = 2.0f * (qx * qz - qw * qy);
+  rot[2][1] = 2.0f * (qy * qz + qw * qx);
+  rot[2][2] = qw * qw - qx * qx - qy * qy + qz * qz;
+
+  // Compute t = w - R c, and write the transformation into the (column-major) output matrix.
+  for(int r = 0; r < 3; ++r)
+  {
+    for(int col = 0; col < 3; ++col) cameraPose.m[col * 4 + r] = rot[r][col];
+    cameraPose.m[12 + r] = worldCentroid[r] - (rot[r][0] * cameraCentroid.x + rot[r][1] * cameraCentroid.y + rot[r][2] * cameraCentroid.z);
+    cameraPose.m[r * 4 + 3] = 0.0f;
+  }
+  cameraPose.m[15] = 1.0f;
+
+  return true;
+}
+
+/**
+ * \brief Attempts to sample a pixel that has both a valid keypoint and a non-empty prediction.
+ *
+ * \param keypoints     The keypoints (in camera coordinates).
+ * \param predictions   The predictions for the keypoints.
+ * \param pixelCount    The number of pixels in the keypoints and predictions images.
+ * \param rng           The random number generator to use.
+ * \return              The raster index of the sampled pixel, or -1 if no suitable pixel was found.
+ */
+template <typename RNGType>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline int sample_valid_pixel(const Keypoint3DColour *keypoints, const ScorePrediction *predictions, int pixelCount, RNGType& rng)
+{
+  for(int i = 0; i < PREEMPTIVE_RANSAC_MAX_PIXEL_SAMPLING_TRIES; ++i)
+  {
+    const int rasterIdx = rng.generate_int_from_uniform(0, pixelCount - 1);
+    if(keypoints[rasterIdx].valid && predictions[rasterIdx].size > 0) return rasterIdx;
+  }
+
+  return -1;
+}
+
+//#################### MAIN FUNCTIONS ####################
+
+/**
+ * \brief Computes the energy of a pixel with respect to a pose candidate.
+ *
+ * The energy is 1 - exp(-d^2 / 2), where d is the Mahalanobis distance between the pixel's keypoint (transformed into world
+ * coordinates using the candidate pose) and the closest mode in the pixel's prediction. It thus lies in [0,1], with lower
+ * values being better, and is robust to outliers: a pixel whose prediction is completely wrong can only contribute 1.
+ *
+ * \param cameraPose  The candidate pose (a transformation from camera coordinates to world coordinates).
+ * \param keypoints   The keypoints (in camera coordinates).
+ * \param predictions The predictions for the keypoints.
+ * \param rasterIdx   The raster index of the pixel (-1 denotes a failed sample, which is scored as an outlier).
+ * \return            The energy of the pixel.
+ */
+_CPU_AND_GPU_CODE_
+inline float compute_pixel_energy(const Matrix4f& cameraPose, const Keypoint3DColour *keypoints, const ScorePrediction *predictions, int rasterIdx)
+{
+  if(rasterIdx < 0) return 1.0f;
+
+  const Vector3f p = keypoints[rasterIdx].position;
+  const Vector3f worldPos = (cameraPose * Vector4f(p.x, p.y, p.z, 1.0f)).toVector3();
+  const ScorePrediction& prediction = predictions[rasterIdx];
+
+  float bestLikelihood = 0.0f;
+  for(int i = 0; i < prediction.size; ++i)
+  {
+    const Mode3DColour& mode = prediction.elts[i];
+    const Vector3f diff = worldPos - mode.position;
+    const Vector3f transformedDiff = mode.positionInvCovariance * diff;
+    const float mahalanobisSq = dot(diff, transformedDiff);
+    const float likelihood = expf(-0.5f * mahalanobisSq);
+    if(likelihood > bestLikelihood) bestLikelihood = likelihood;
+  }
+
+  return 1.0f - bestLikelihood;
+}
+
+/**
+ * \brief Evaluates a pose candidate against a batch of sampled pixels, adding the pixels' energies to the candidate's energy.
+ *
+ * \param candidate           The pose candidate.
+ * \param keypoints           The keypoints (in camera coordinates).
+ * \param predictions         The predictions for the keypoints.
+ * \param inlierRasterIndices The raster indices of the sampled pixels.
+ * \param inlierCount         The number of sampled pixels.
+ */
+_CPU_AND_GPU_CODE_
+inline void evaluate_pose_candidate(PoseCandidate& candidate, const Keypoint3DColour *keypoints, const ScorePrediction *predictions,
+                                    const int *inlierRasterIndices, int inlierCount)
+{
+  float energy = 0.0f;
+  for(int i = 0; i < inlierCount; ++i)
+  {
+    energy += compute_pixel_energy(candidate.cameraPose, keypoints, predictions, inlierRasterIndices[i]);
+  }
+
+  candidate.energy += energy;
+}
+
+/**
+ * \brief Determines whether one pose candidate should be ranked ahead of another.
+ *
+ * Candidates with lower energies are ranked first. Ties are broken using the candidate indices, so that the ranking does not
+ * depend on the order in which the candidates were found to be valid (which is not deterministic on the GPU).
+ *
+ * \param energyA  The energy of the first candidate.
+ * \param indexA   The index of the first candidate.
+ * \param energyB  The energy of the second candidate.
+ * \param indexB   The index of the second candidate.
+ * \return         true, if the first candidate should be ranked ahead of the second, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool pose_candidate_precedes(float energyA, int indexA, float energyB, int indexB)
+{
+  return energyA < energyB || (energyA == energyB && indexA < indexB);
+}
+
+/**
+ * \brief Attempts to generate a pose candidate from three randomly-chosen pixels and their predicted world coordinates.
+ *
+ * \param keypoints                     The keypoints (in camera coordinates).
+ * \param predictions                   The predictions for the keypoints.
+ * \param pixelCount                    The number of pixels in the keypoints and predictions images.
+ * \param rng                           The random number generator to use.
+ * \param maxTries                      The maximum number of attempts to make.
+ * \param useAllModes                   Whether to sample from all of the modes of each pixel's prediction (rather than just the largest).
+ * \param minSquaredDistance            The minimum squared distance between the three sampled points (in camera coordinates).
+ * \param maxTranslationError           The maximum permitted discrepancy (in metres) between corresponding distances, and between the
+ *                                      transformed camera points and their predicted positions.
+ * \param candidate                     The pose candidate to generate (its valid flag is set to indicate success).
+ */
+template <typename RNGType>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline void generate_pose_candidate(const Keypoint3DColour *keypoints, const ScorePrediction *predictions, int pixelCount, RNGType& rng,
+                                    int maxTries, bool useAllModes, float minSquaredDistance, float maxTranslationError, PoseCandidate& candidate)
+{
+  candidate.energy = 0.0f;
+  candidate.valid = false;
+
+  for(int tryIdx = 0; tryIdx < maxTries; ++tryIdx)
+  {
+    Vector3f cameraPoints[3], worldPoints[3];
+    bool ok = true;
+
+    // Sample three pixels, and a mode of each of their predictions, checking that the triangles they form in the two coordinate
+    // systems are consistent as we go, so that we can discard most bad samples before performing any expensive computations.
+    for(int i = 0; i < 3 && ok; ++i)
+    {
+      const int rasterIdx = sample_valid_pixel(keypoints, predictions, pixelCount, rng);
+      if(rasterIdx < 0) return;
+
+      const ScorePrediction& prediction = predictions[rasterIdx];
+      const int modeIdx = useAllModes ? rng.generate_int_from_uniform(0, prediction.size - 1) : 0;
+      cameraPoints[i] = keypoints[rasterIdx].position;
+      worldPoints[i] = prediction.elts[modeIdx].position;
+
+      for(int j = 0; j < i && ok; ++j)
+      {
+        const Vector3f cameraDiff = cameraPoints[i] - cameraPoints[j];
+        const float cameraDistSq = dot(cameraDiff, cameraDiff);
+        if(cameraDistSq < minSquaredDistance) ok = false;
+
+        const Vector3f worldDiff = worldPoints[i] - worldPoints[j];
+        if(fabsf(sqrtf(cameraDistSq) - sqrtf(dot(worldDiff, worldDiff))) > maxTranslationError) ok = false;
+      }
+    }
+
+    if(!ok || !estimate_rigid_transform(cameraPoints, worldPoints, candidate.cameraPose)) continue;
+
+    // Check that the estimated pose maps each camera point sufficiently close to its predicted position.
+    const float maxTranslationErrorSq = maxTranslationError * maxTranslationError;
+    for(int i = 0; i < 3 && ok; ++i)
+    {
+      const Vector3f p = cameraPoints[i];
+      const Vector3f diff = (candidate.cameraPose * Vector4f(p.x, p.y, p.z, 1.0f)).toVector3() - worldPoints[i];
+      if(dot(diff, diff) > maxTranslationErrorSq) ok = false;
+    }
+
+    if(ok)
+    {
+      candidate.valid = true;
+      return;
+    }
+  }
+}
+
+}
+
+#endif
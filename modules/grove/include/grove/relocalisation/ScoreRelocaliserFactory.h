@@ -0,0 +1,34 @@
+/**
+ * grove: ScoreRelocaliserFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_SCORERELOCALISERFACTORY
+#define H_GROVE_SCORERELOCALISERFACTORY
+
+#include "interface/ScoreRelocaliser.h"
+
+namespace grove {
+
+/**
+ * \brief This struct can be used to construct scene coordinate regression relocalisers.
+ */
+struct ScoreRelocaliserFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a scene coordinate regression relocaliser.
+   *
+   * \param forestFilename  The path to the file containing the pre-trained forest.
+   * \param settings        The settings used to configure the relocaliser (these also specify the device on which it should operate).
+   * \return                The relocaliser.
+   *
+   * \throws std::runtime_error If the forest cannot be loaded.
+   */
+  static ScoreRelocaliser_Ptr make_score_relocaliser(const std::string& forestFilename, const itmx::Settings_CPtr& settings);
+};
+
+}
+
+#endif
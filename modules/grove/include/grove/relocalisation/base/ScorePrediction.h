@@ -0,0 +1,63 @@
+/**
+ * grove: ScorePrediction.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_SCOREPREDICTION
+#define H_GROVE_SCOREPREDICTION
+
+#include <boost/shared_ptr.hpp>
+
+#include <ITMLib/Utils/ITMMath.h>
+
+#include <ORUtils/Image.h>
+
+#include "../../util/Array.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of this struct represents a mode of the distribution of the 3D positions (in world coordinates)
+ *        and colours of the examples that have been stored for a leaf of a scene coordinate regression forest.
+ */
+struct Mode3DColour
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The mean colour of the examples in the mode. */
+  Vector3u colour;
+
+  /** The determinant of the (regularised) covariance matrix of the example positions. */
+  float determinant;
+
+  /** The mean position of the examples in the mode. */
+  Vector3f position;
+
+  /** The inverse of the (regularised) covariance matrix of the example positions. */
+  Matrix3f positionInvCovariance;
+
+  /** The number of examples in the mode. */
+  int supportCount;
+};
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of modes that can be stored in a prediction. */
+#define SCORE_MAX_MODES 10
+
+//#################### TYPEDEFS ####################
+
+/** A prediction: the modes for a leaf (or the merged modes for a pixel), in decreasing order of support. */
+typedef Array<Mode3DColour,SCORE_MAX_MODES> ScorePrediction;
+
+typedef ORUtils::MemoryBlock<ScorePrediction> ScorePredictionsBlock;
+typedef boost::shared_ptr<ScorePredictionsBlock> ScorePredictionsBlock_Ptr;
+typedef boost::shared_ptr<const ScorePredictionsBlock> ScorePredictionsBlock_CPtr;
+
+typedef ORUtils::Image<ScorePrediction> ScorePredictionsImage;
+typedef boost::shared_ptr<ScorePredictionsImage> ScorePredictionsImage_Ptr;
+typedef boost::shared_ptr<const ScorePredictionsImage> ScorePredictionsImage_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * grove: ScoreRelocaliser_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_SCORERELOCALISER_CUDA
+#define H_GROVE_SCORERELOCALISER_CUDA
+
+#include "../interface/ScoreRelocaliser.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of this class can be used to relocalise a camera in a 3D scene using scene coordinate regression with CUDA.
+ */
+class ScoreRelocaliser_CUDA : public ScoreRelocaliser
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a scene coordinate regression relocaliser that operates using CUDA.
+   *
+   * \param forestFilename  The path to the file containing the pre-trained forest.
+   * \param settings        The settings used to configure the relocaliser.
+   *
+   * \throws std::runtime_error If the forest cannot be loaded.
+   */
+  ScoreRelocaliser_CUDA(const std::string& forestFilename, const itmx::Settings_CPtr& settings);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void merge_predictions_for_keypoints() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,189 @@
+/**
+ * grove: ScoreRelocaliser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_SCORERELOCALISER
+#define H_GROVE_SCORERELOCALISER
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <itmx/base/ITMObjectPtrTypes.h>
+#include <itmx/relocalisation/Relocaliser.h>
+
+#include "../base/ScorePrediction.h"
+#include "../../clustering/interface/ExampleClusterer.h"
+#include "../../features/interface/RGBDPatchFeatureCalculator.h"
+#include "../../forests/interface/DecisionForest.h"
+#include "../../ransac/interface/PreemptiveRansac.h"
+#include "../../reservoirs/interface/ExampleReservoirs.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to relocalise a camera in a 3D scene using scene coordinate regression.
+ *
+ * A pre-trained decision forest is used to map keypoints in the input images to leaves, each of which is associated with a reservoir of
+ * examples (keypoints in world coordinates) that is filled online during training. The examples in each reservoir are clustered to find
+ * the modes of their distribution, which then serve as the leaf's predictions of the world coordinates of the keypoints that reach it.
+ * To relocalise, the predictions of the leaves reached by each keypoint in the input images are merged, and a camera pose is estimated
+ * from the resulting correspondences using preemptive RANSAC.
+ *
+ * Note that only the reservoirs that have changed since they were last clustered are re-clustered, and at most a fixed number of them
+ * in each call to update(), so that the cost of keeping the predictions up to date is bounded per frame.
+ *
+ * Optionally, relocalisation can be performed coarse-to-fine: a first attempt is made using keypoints sampled on a coarser grid than
+ * the one used for training, and the full-resolution pass is only run if that attempt does not yield a good pose. The descriptors
+ * themselves are unaffected by the grid spacing (they are always computed from the full-resolution images), so the same forest and
+ * predictions can be used at both resolutions.
+ *
+ * The contents of the relocaliser (the reservoirs and the leaf predictions) can be saved to disk and loaded again later. The forest
+ * itself is not saved, so the contents must be loaded into a relocaliser that uses the same pre-trained forest as they were saved from.
+ */
+class ScoreRelocaliser : public itmx::Relocaliser
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef DecisionForest<RGBDPatchDescriptor,5> Forest;
+  typedef boost::shared_ptr<Forest> Forest_Ptr;
+  typedef ExampleReservoirs<Keypoint3DColour> Reservoirs;
+  typedef boost::shared_ptr<Reservoirs> Reservoirs_Ptr;
+
+  //#################### PROTECTED MEMBER VARIABLES ####################
+protected:
+  /** The clusterer used to find the modes of the examples in the reservoirs. */
+  ExampleClusterer_Ptr m_clusterer;
+
+  /** The feature calculator used for the coarse relocalisation pass (if any), which samples keypoints on a coarser grid than m_featureCalculator. */
+  DA_RGBDPatchFeatureCalculator_Ptr m_coarseFeatureCalculator;
+
+  /** The feature descriptors computed for the keypoints in the current images. */
+  mutable RGBDPatchDescriptorImage_Ptr m_descriptorsImage;
+
+  /** Whether or not the relocaliser is running in deterministic mode (in which its results do not depend on thread scheduling). */
+  bool m_deterministic;
+
+  /** A memory block into which to fetch the indices of the reservoirs that have changed since the last update. */
+  ITMIntMemoryBlock_Ptr m_dirtyReservoirIndices;
+
+  /** The feature calculator used to extract keypoints and descriptors from the input images. */
+  DA_RGBDPatchFeatureCalculator_Ptr m_featureCalculator;
+
+  /** The decision forest used to map the keypoints to leaves. */
+  Forest_Ptr m_forest;
+
+  /** The raster indices of the valid keypoints in the current images. */
+  mutable ITMIntMemoryBlock_Ptr m_keypointIndices;
+
+  /** The keypoints extracted from the current images. */
+  mutable Keypoint3DColourImage_Ptr m_keypointsImage;
+
+  /** The indices of the leaves reached by the keypoints in the current images. */
+  mutable Forest::LeafIndicesImage_Ptr m_leafIndicesImage;
+
+  /** The predictions associated with the leaves of the forest (one per reservoir). */
+  ScorePredictionsBlock_Ptr m_leafPredictions;
+
+  /** The maximum (mean per-pixel) RANSAC energy for which a relocalisation is deemed to be good. */
+  float m_maxGoodPoseEnergy;
+
+  /** The maximum number of reservoirs to cluster in each call to update(). */
+  uint32_t m_maxReservoirsToClusterPerUpdate;
+
+  /** Flags indicating which of the reservoirs are currently awaiting clustering. */
+  std::vector<bool> m_pendingReservoirFlags;
+
+  /** The indices of the reservoirs that are awaiting clustering, in the order in which they changed. */
+  std::deque<int> m_pendingReservoirs;
+
+  /** The merged predictions for the keypoints in the current images. */
+  mutable ScorePredictionsImage_Ptr m_predictionsImage;
+
+  /** The preemptive RANSAC instance used to estimate the camera pose from the predictions. */
+  PreemptiveRansac_Ptr m_ransac;
+
+  /** The reservoirs in which to store the examples for each leaf of the forest. */
+  Reservoirs_Ptr m_reservoirs;
+
+  /** A memory block into which to write the indices of the reservoirs to be clustered in the current update. */
+  ITMIntMemoryBlock_Ptr m_reservoirsToCluster;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a scene coordinate regression relocaliser.
+   *
+   * \param forestFilename  The path to the file containing the pre-trained forest.
+   * \param settings        The settings used to configure the relocaliser.
+   *
+   * \throws std::runtime_error If the forest cannot be loaded.
+   */
+  ScoreRelocaliser(const std::string& forestFilename, const itmx::Settings_CPtr& settings);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the relocaliser.
+   */
+  virtual ~ScoreRelocaliser();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Merges the predictions of the leaves reached by each valid keypoint in m_keypointsImage into m_predictionsImage.
+   *
+   * The prediction of each invalid keypoint is left empty.
+   */
+  virtual void merge_predictions_for_keypoints() const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void load_from_disk(const std::string& path);
+
+  /** Override */
+  virtual boost::optional<Result> relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage, const Vector4f& depthIntrinsics) const;
+
+  /** Override */
+  virtual std::vector<Result> relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                    const Vector4f& depthIntrinsics, size_t maxCandidateCount) const;
+
+  /** Override */
+  virtual void reset();
+
+  /** Override */
+  virtual void save_to_disk(const std::string& path) const;
+
+  /** Override */
+  virtual void train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                     const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose);
+
+  /** Override */
+  virtual void update();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Attempts to estimate the camera pose using keypoints and descriptors computed by the specified feature calculator.
+   *
+   * \param featureCalculator The feature calculator to use.
+   * \param colourImage       The colour image.
+   * \param depthImage        The depth image.
+   * \param depthIntrinsics   The intrinsic parameters of the depth sensor.
+   * \param maxCandidateCount The maximum number of candidate poses to return.
+   * \return                  The candidate poses (at most maxCandidateCount of them), best first.
+   */
+  std::vector<Result> estimate_pose_candidates(const DA_RGBDPatchFeatureCalculator_Ptr& featureCalculator, const ITMUChar4Image *colourImage,
+                                               const ITMFloatImage *depthImage, const Vector4f& depthIntrinsics, size_t maxCandidateCount) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<ScoreRelocaliser> ScoreRelocaliser_Ptr;
+typedef boost::shared_ptr<const ScoreRelocaliser> ScoreRelocaliser_CPtr;
+
+}
+
+#endif
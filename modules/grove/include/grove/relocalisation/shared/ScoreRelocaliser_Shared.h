@@ -0,0 +1,59 @@
+/**
+ * grove: ScoreRelocaliser_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_SCORERELOCALISER_SHARED
+#define H_GROVE_SCORERELOCALISER_SHARED
+
+#include <ORUtils/PlatformIndependence.h>
+
+#include "../base/ScorePrediction.h"
+#include "../../keypoints/Keypoint3DColour.h"
+
+namespace grove {
+
+/**
+ * \brief Merges the predictions of the leaves reached by a keypoint into a single prediction for the keypoint.
+ *
+ * The modes of all of the leaves are pooled, and the ones with the most support are retained (in decreasing order of support).
+ * The prediction for an invalid keypoint is left empty.
+ *
+ * \param rasterIdx         The raster index of the keypoint.
+ * \param keypoints         The keypoints.
+ * \param leafIndices       The indices of the leaves reached by each keypoint (one per tree).
+ * \param leafPredictions   The predictions associated with the leaves of the forest.
+ * \param predictions       An image in which to store the merged prediction for each keypoint.
+ */
+template <int TREE_COUNT>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline void merge_predictions_for_keypoint(int rasterIdx, const Keypoint3DColour *keypoints, const ORUtils::VectorX<int,TREE_COUNT> *leafIndices,
+                                           const ScorePrediction *leafPredictions, ScorePrediction *predictions)
+{
+  ScorePrediction& prediction = predictions[rasterIdx];
+  prediction.size = 0;
+  if(!keypoints[rasterIdx].valid) return;
+
+  for(int treeIdx = 0; treeIdx < TREE_COUNT; ++treeIdx)
+  {
+    const ScorePrediction& leafPrediction = leafPredictions[leafIndices[rasterIdx].v[treeIdx]];
+    for(int modeIdx = 0; modeIdx < leafPrediction.size; ++modeIdx)
+    {
+      const Mode3DColour& mode = leafPrediction.elts[modeIdx];
+
+      // Insert the mode into the (sorted) prediction, dropping the least-supported mode if the prediction is already full.
+      int i = prediction.size < ScorePrediction::Capacity ? prediction.size++ : ScorePrediction::Capacity;
+      while(i > 0 && prediction.elts[i - 1].supportCount < mode.supportCount)
+      {
+        if(i < ScorePrediction::Capacity) prediction.elts[i] = prediction.elts[i - 1];
+        --i;
+      }
+
+      if(i < ScorePrediction::Capacity) prediction.elts[i] = mode;
+    }
+  }
+}
+
+}
+
+#endif
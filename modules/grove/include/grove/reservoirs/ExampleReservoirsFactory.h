@@ -32,8 +32,11 @@ struct ExampleReservoirsFactory
    * \param reservoirCapacity The capacity (maximum size) of each reservoir.
    * \param deviceType        The device on which the example reservoirs should be stored.
    * \param rngSeed           The seed for the random number generator.
+   * \param deterministic     Whether or not the contents of the reservoirs should be independent of thread scheduling (only supported on the CPU).
+   * \param bufferedInsertion Whether or not to add examples to the reservoirs via thread-local buckets of pending insertions (CPU only; ignored on the GPU).
    */
-  static Reservoirs_Ptr make_reservoirs(uint32_t reservoirCount, uint32_t reservoirCapacity, ITMLib::ITMLibSettings::DeviceType deviceType, uint32_t rngSeed = 42);
+  static Reservoirs_Ptr make_reservoirs(uint32_t reservoirCount, uint32_t reservoirCapacity, ITMLib::ITMLibSettings::DeviceType deviceType,
+                                        uint32_t rngSeed = 42, bool deterministic = false, bool bufferedInsertion = true);
 };
 
 }
@@ -5,6 +5,8 @@
 
 #include "reservoirs/ExampleReservoirsFactory.h"
 
+#include <iostream>
+
 #include "reservoirs/cpu/ExampleReservoirs_CPU.h"
 
 #ifdef WITH_CUDA
@@ -17,13 +19,21 @@ namespace grove {
 
 template <typename ExampleType>
 typename ExampleReservoirsFactory<ExampleType>::Reservoirs_Ptr
-ExampleReservoirsFactory<ExampleType>::make_reservoirs(uint32_t reservoirCount, uint32_t reservoirCapacity, ITMLib::ITMLibSettings::DeviceType deviceType, uint32_t rngSeed)
+ExampleReservoirsFactory<ExampleType>::make_reservoirs(uint32_t reservoirCount, uint32_t reservoirCapacity, ITMLib::ITMLibSettings::DeviceType deviceType,
+                                                       uint32_t rngSeed, bool deterministic, bool bufferedInsertion)
 {
   Reservoirs_Ptr reservoir;
 
   if (deviceType == ITMLib::ITMLibSettings::DEVICE_CUDA)
   {
 #ifdef WITH_CUDA
+    // Note: On the GPU, the order in which the examples claim the slots in each reservoir is determined by the hardware's scheduling of
+    //       the atomic increments, and serialising them would make the reservoirs unusably slow, so deterministic mode cannot be honoured.
+    if(deterministic)
+    {
+      std::cerr << "Warning: The contents of the CUDA example reservoirs depend on thread scheduling; use the CPU for fully deterministic runs\n";
+    }
+
     reservoir.reset(new ExampleReservoirs_CUDA<ExampleType>(reservoirCount, reservoirCapacity, rngSeed));
 #else
     throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
@@ -31,7 +41,7 @@ ExampleReservoirsFactory<ExampleType>::make_reservoirs(uint32_t reservoirCount,
   }
   else
   {
-    reservoir.reset(new ExampleReservoirs_CPU<ExampleType>(reservoirCount, reservoirCapacity, rngSeed));
+    reservoir.reset(new ExampleReservoirs_CPU<ExampleType>(reservoirCount, reservoirCapacity, rngSeed, deterministic, bufferedInsertion));
   }
 
   return reservoir;
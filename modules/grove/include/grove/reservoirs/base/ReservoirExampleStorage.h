@@ -0,0 +1,67 @@
+/**
+ * grove: ReservoirExampleStorage.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_RESERVOIREXAMPLESTORAGE
+#define H_GROVE_RESERVOIREXAMPLESTORAGE
+
+#include <ORUtils/PlatformIndependence.h>
+
+#include "../../keypoints/CompactKeypoint3DColour.h"
+
+namespace grove {
+
+/**
+ * \brief An instantiation of this struct template specifies how examples of a particular type are stored in example reservoirs.
+ *
+ * By default, examples are stored exactly as they are added. The template can be specialised to store a more compact encoding
+ * of the examples instead, so that more of them can be kept in the same amount of memory.
+ *
+ * \tparam ExampleType  The type of example added to the reservoirs.
+ */
+template <typename ExampleType>
+struct ReservoirExampleStorage
+{
+  //#################### TYPEDEFS ####################
+
+  /** The type used to store the examples in the reservoirs. */
+  typedef ExampleType StoredType;
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Converts an example into the form in which it is stored in the reservoirs.
+   *
+   * \param example The example.
+   * \return        The example, in the form in which it is stored in the reservoirs.
+   */
+  _CPU_AND_GPU_CODE_
+  static inline StoredType store(const ExampleType& example)
+  {
+    return example;
+  }
+};
+
+/**
+ * \brief Specifies that 3D keypoints are stored in the reservoirs in compressed form (see CompactKeypoint3DColour).
+ */
+template <>
+struct ReservoirExampleStorage<Keypoint3DColour>
+{
+  //#################### TYPEDEFS ####################
+
+  typedef CompactKeypoint3DColour StoredType;
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  _CPU_AND_GPU_CODE_
+  static inline StoredType store(const Keypoint3DColour& example)
+  {
+    return compress_keypoint(example);
+  }
+};
+
+}
+
+#endif
@@ -6,14 +6,23 @@
 #ifndef H_GROVE_EXAMPLERESERVOIRS_CPU
 #define H_GROVE_EXAMPLERESERVOIRS_CPU
 
+#include <vector>
+
 #include "../interface/ExampleReservoirs.h"
-#include "../../numbers/CPURNG.h"
+#include "../../numbers/CounterBasedRNG.h"
 
 namespace grove {
 
 /**
  * \brief An instance of this class can be used to store a number of examples in a set of fixed-size reservoirs using the CPU.
  *
+ * By default, examples are added to the reservoirs in two passes when OpenMP is available. In the first pass, each thread buckets
+ * the insertions for its share of the examples by the thread that owns the target reservoir (reservoirs are assigned to owners by
+ * taking their indices modulo the thread count). In the second pass, each thread performs reservoir sampling for the insertions into
+ * the reservoirs it owns, so that the counters of each reservoir are only ever touched by a single thread. This avoids the cache-line
+ * ping-pong that results when many threads increment the counters of the same (hot) reservoirs directly. Each insertion draws its
+ * random numbers from its own stream, so the sampling remains statistically equivalent to the direct approach.
+ *
  * \param ExampleType The type of example stored in the reservoirs. Must have a member named "valid", convertible to bool.
  */
 template <typename ExampleType>
@@ -25,10 +34,33 @@ public:
   using typename Base::ExampleImage_CPtr;
   using typename Base::Visitor;
 
-  //#################### PRIVATE MEMBER VARIABLES ####################
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents an insertion of an example into a reservoir that is waiting to be performed by the reservoir's owner.
+   */
+  struct PendingInsertion
+  {
+    /** The raster index of the example in the example image. */
+    int exampleIdx;
+
+    /** The index of the reservoir within the example's reservoir indices. */
+    int indexInExample;
+
+    /** The index of the reservoir. */
+    int reservoirIdx;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
 private:
-  /** A set of random number generators (used when adding examples). */
-  CPURNGMemoryBlock_Ptr m_rngs;
+  /** Whether or not to add the examples to the reservoirs in two passes, via thread-local buckets of pending insertions (only used if OpenMP is available). */
+  bool m_bufferedInsertion;
+
+  /** Whether or not to add the examples to the reservoirs serially, in raster order, so that their contents do not depend on thread scheduling. */
+  bool m_deterministic;
+
+  /** The buckets of pending insertions, indexed by producer thread * thread count + owner thread (reused between calls to avoid reallocating them). */
+  std::vector<std::vector<PendingInsertion> > m_pendingInsertions;
 
   //#################### CONSTRUCTORS ####################
 public:
@@ -38,13 +70,15 @@ public:
    * \param reservoirCount    The number of reservoirs to create.
    * \param reservoirCapacity The capacity of each reservoir.
    * \param rngSeed           The seed for the random number generator.
+   * \param deterministic     Whether or not to add the examples to the reservoirs serially, in raster order, so that their contents do not depend on thread scheduling.
+   * \param bufferedInsertion Whether or not to add the examples to the reservoirs in two passes, via thread-local buckets of pending insertions (ignored in deterministic mode).
    */
-  ExampleReservoirs_CPU(uint32_t reservoirCount, uint32_t reservoirCapacity, uint32_t rngSeed = 42);
+  ExampleReservoirs_CPU(uint32_t reservoirCount, uint32_t reservoirCapacity, uint32_t rngSeed = 42, bool deterministic = false, bool bufferedInsertion = true);
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
-  virtual void reset();
+  virtual uint32_t fetch_dirty_reservoirs(const ITMIntMemoryBlock_Ptr& dirtyReservoirIndices);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
@@ -56,9 +90,14 @@ private:
   void add_examples_sub(const ExampleImage_CPtr& examples, const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,ReservoirIndexCount> > >& reservoirIndices);
 
   /**
-   * \brief Reinitialises the random number generators using known seeds.
+   * \brief Adds examples to the reservoirs in two passes, first bucketing the insertions by the thread that owns each target reservoir,
+   *        and then performing the insertions into each reservoir on its owner thread.
+   *
+   * \param examples         The examples to add to the reservoirs.
+   * \param reservoirIndices The indices of the reservoirs to which to add each example.
    */
-  void reinit_rngs();
+  template <int ReservoirIndexCount>
+  void add_examples_buffered(const ExampleImage_CPtr& examples, const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,ReservoirIndexCount> > >& reservoirIndices);
 
   //#################### FRIENDS ####################
 
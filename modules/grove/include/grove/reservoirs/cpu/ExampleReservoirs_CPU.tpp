@@ -5,7 +5,9 @@
 
 #include "ExampleReservoirs_CPU.h"
 
-#include <itmx/base/MemoryBlockFactory.h>
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 #include "../shared/ExampleReservoirs_Shared.h"
 
@@ -14,8 +16,9 @@ namespace grove {
 //#################### CONSTRUCTORS ####################
 
 template <typename ExampleType>
-ExampleReservoirs_CPU<ExampleType>::ExampleReservoirs_CPU(uint32_t reservoirCount, uint32_t reservoirCapacity, uint32_t rngSeed)
-: ExampleReservoirs<ExampleType>(reservoirCount, reservoirCapacity, rngSeed)
+ExampleReservoirs_CPU<ExampleType>::ExampleReservoirs_CPU(uint32_t reservoirCount, uint32_t reservoirCapacity, uint32_t rngSeed, bool deterministic,
+                                                          bool bufferedInsertion)
+: ExampleReservoirs<ExampleType>(reservoirCount, reservoirCapacity, rngSeed), m_bufferedInsertion(bufferedInsertion), m_deterministic(deterministic)
 {
   reset();
 }
@@ -23,10 +26,27 @@ ExampleReservoirs_CPU<ExampleType>::ExampleReservoirs_CPU(uint32_t reservoirCoun
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 template <typename ExampleType>
-void ExampleReservoirs_CPU<ExampleType>::reset()
+uint32_t ExampleReservoirs_CPU<ExampleType>::fetch_dirty_reservoirs(const ITMIntMemoryBlock_Ptr& dirtyReservoirIndices)
 {
-  ExampleReservoirs<ExampleType>::reset();
-  reinit_rngs();
+  int *dirtyReservoirCount = this->m_dirtyReservoirCount->GetData(MEMORYDEVICE_CPU);
+  int *dirtyReservoirFlags = this->m_dirtyReservoirFlags->GetData(MEMORYDEVICE_CPU);
+  const int *dirtyReservoirs = this->m_dirtyReservoirs->GetData(MEMORYDEVICE_CPU);
+  const int count = *dirtyReservoirCount;
+
+  // Make sure that the output memory block is large enough to hold the dirty reservoir indices.
+  if(dirtyReservoirIndices->dataSize < static_cast<size_t>(count)) dirtyReservoirIndices->Resize(count);
+  int *dirtyReservoirIndicesPtr = dirtyReservoirIndices->GetData(MEMORYDEVICE_CPU);
+
+  // Copy the dirty reservoir indices into the output memory block, and mark the corresponding reservoirs as clean.
+  for(int i = 0; i < count; ++i)
+  {
+    const int reservoirIdx = dirtyReservoirs[i];
+    dirtyReservoirIndicesPtr[i] = reservoirIdx;
+    dirtyReservoirFlags[reservoirIdx] = 0;
+  }
+
+  *dirtyReservoirCount = 0;
+  return static_cast<uint32_t>(count);
 }
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
@@ -39,28 +59,107 @@ void ExampleReservoirs_CPU<ExampleType>::accept(const Visitor& visitor)
 
 template <typename ExampleType>
 template <int ReservoirIndexCount>
-void ExampleReservoirs_CPU<ExampleType>::add_examples_sub(const ExampleImage_CPtr& examples, const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,ReservoirIndexCount> > >& reservoirIndices)
+void ExampleReservoirs_CPU<ExampleType>::add_examples_buffered(const ExampleImage_CPtr& examples, const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,ReservoirIndexCount> > >& reservoirIndices)
 {
-  const Vector2i imgSize = examples->noDims;
-  const size_t exampleCount = imgSize.width * imgSize.height;
+#ifdef WITH_OPENMP
+  const int exampleCount = static_cast<int>(examples->dataSize);
+  const ExampleType *examplesPtr = examples->GetData(MEMORYDEVICE_CPU);
+  int *reservoirAddCalls = this->m_reservoirAddCalls->GetData(MEMORYDEVICE_CPU);
+  const ORUtils::VectorX<int,ReservoirIndexCount> *reservoirIndicesPtr = reservoirIndices->GetData(MEMORYDEVICE_CPU);
+  int *reservoirSizes = this->m_reservoirSizes->GetData(MEMORYDEVICE_CPU);
+  typename Base::StoredExampleType *reservoirs = this->m_reservoirs->GetData(MEMORYDEVICE_CPU);
+  int *dirtyReservoirCount = this->m_dirtyReservoirCount->GetData(MEMORYDEVICE_CPU);
+  int *dirtyReservoirFlags = this->m_dirtyReservoirFlags->GetData(MEMORYDEVICE_CPU);
+  int *dirtyReservoirs = this->m_dirtyReservoirs->GetData(MEMORYDEVICE_CPU);
+
+  // Make sure that there is a bucket for every pair of threads that might be used.
+  const int maxThreadCount = omp_get_max_threads();
+  if(m_pendingInsertions.size() < static_cast<size_t>(maxThreadCount * maxThreadCount))
+  {
+    m_pendingInsertions.resize(maxThreadCount * maxThreadCount);
+  }
+
+  #pragma omp parallel
+  {
+    // Note: The runtime may give us fewer threads than the maximum, so we use the actual number to assign reservoirs to owners.
+    const int threadCount = omp_get_num_threads();
+    const int ownerIdx = omp_get_thread_num();
+
+    std::vector<PendingInsertion> *buckets = &m_pendingInsertions[ownerIdx * threadCount];
+    for(int i = 0; i < threadCount; ++i) buckets[i].clear();
+
+    // Pass 1: Bucket the insertions for this thread's share of the examples by the thread that owns the target reservoir.
+    #pragma omp for schedule(static)
+    for(int exampleIdx = 0; exampleIdx < exampleCount; ++exampleIdx)
+    {
+      if(!examplesPtr[exampleIdx].valid) continue;
+
+      const int *exampleReservoirIndices = reservoirIndicesPtr[exampleIdx].v;
+      for(int i = 0; i < ReservoirIndexCount; ++i)
+      {
+        PendingInsertion insertion;
+        insertion.exampleIdx = exampleIdx;
+        insertion.indexInExample = i;
+        insertion.reservoirIdx = exampleReservoirIndices[i];
+        buckets[insertion.reservoirIdx % threadCount].push_back(insertion);
+      }
+    }
+
+    // Note: There is an implicit barrier at the end of the loop above, so all of the buckets are complete at this point.
 
-  // Check that we have enough random number generators and reallocate them if not.
-  if(m_rngs->dataSize < exampleCount)
+    // Pass 2: Perform the insertions into the reservoirs owned by this thread. Since no other thread touches the counters of these
+    //         reservoirs, the atomics in add_example_to_reservoirs are uncontended. Each insertion generates its random numbers from
+    //         its own stream, since the insertions for the same example may now be performed by different threads.
+    for(int producerIdx = 0; producerIdx < threadCount; ++producerIdx)
+    {
+      const std::vector<PendingInsertion>& bucket = m_pendingInsertions[producerIdx * threadCount + ownerIdx];
+      for(size_t j = 0, size = bucket.size(); j < size; ++j)
+      {
+        const PendingInsertion& insertion = bucket[j];
+        const uint32_t streamIdx = static_cast<uint32_t>(insertion.exampleIdx * ReservoirIndexCount + insertion.indexInExample);
+        CounterBasedRNG rng(this->m_rngSeed, streamIdx, this->m_addExamplesCallCount);
+
+        add_example_to_reservoirs(
+          examplesPtr[insertion.exampleIdx], &insertion.reservoirIdx, 1, reservoirs,
+          reservoirSizes, reservoirAddCalls, this->m_reservoirCapacity, rng,
+          dirtyReservoirFlags, dirtyReservoirs, dirtyReservoirCount
+        );
+      }
+    }
+  }
+#else
+  // Without OpenMP, there is no contention to avoid, so just add the examples directly.
+  add_examples_sub(examples, reservoirIndices);
+#endif
+}
+
+template <typename ExampleType>
+template <int ReservoirIndexCount>
+void ExampleReservoirs_CPU<ExampleType>::add_examples_sub(const ExampleImage_CPtr& examples, const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,ReservoirIndexCount> > >& reservoirIndices)
+{
+#ifdef WITH_OPENMP
+  // Unless we're in deterministic mode, add the examples via thread-local buckets if requested, to avoid contention on the reservoir counters.
+  if(m_bufferedInsertion && !m_deterministic)
   {
-    m_rngs->Resize(exampleCount);
-    reinit_rngs();
+    add_examples_buffered(examples, reservoirIndices);
+    return;
   }
+#endif
 
+  const Vector2i imgSize = examples->noDims;
   const ExampleType *examplesPtr = examples->GetData(MEMORYDEVICE_CPU);
   int *reservoirAddCalls = this->m_reservoirAddCalls->GetData(MEMORYDEVICE_CPU);
   const ORUtils::VectorX<int,ReservoirIndexCount> *reservoirIndicesPtr = reservoirIndices->GetData(MEMORYDEVICE_CPU);
   int *reservoirSizes = this->m_reservoirSizes->GetData(MEMORYDEVICE_CPU);
-  ExampleType *reservoirs = this->m_reservoirs->GetData(MEMORYDEVICE_CPU);
-  CPURNG *rngs = m_rngs->GetData(MEMORYDEVICE_CPU);
+  typename Base::StoredExampleType *reservoirs = this->m_reservoirs->GetData(MEMORYDEVICE_CPU);
+  int *dirtyReservoirCount = this->m_dirtyReservoirCount->GetData(MEMORYDEVICE_CPU);
+  int *dirtyReservoirFlags = this->m_dirtyReservoirFlags->GetData(MEMORYDEVICE_CPU);
+  int *dirtyReservoirs = this->m_dirtyReservoirs->GetData(MEMORYDEVICE_CPU);
 
-  // Add each example to the relevant reservoirs.
+  // Add each example to the relevant reservoirs. Note that when this is done in parallel, the order in which the examples
+  // claim the slots in each reservoir depends on thread scheduling, so in deterministic mode we add them serially instead.
 #ifdef WITH_OPENMP
-#pragma omp parallel for
+#pragma omp parallel for if(!m_deterministic)
 #endif
   for (int y = 0; y < imgSize.height; ++y)
   {
@@ -68,31 +167,17 @@ void ExampleReservoirs_CPU<ExampleType>::add_examples_sub(const ExampleImage_CPt
     {
       const int linearIdx = y * imgSize.x + x;
 
+      // Generate the random numbers for this example from its raster index and the index of the current call, so that no
+      // persistent generator state is needed (and the random numbers match those used by the CUDA implementation).
+      CounterBasedRNG rng(this->m_rngSeed, static_cast<uint32_t>(linearIdx), this->m_addExamplesCallCount);
+
       add_example_to_reservoirs(
         examplesPtr[linearIdx], reservoirIndicesPtr[linearIdx].v, ReservoirIndexCount, reservoirs,
-        reservoirSizes, reservoirAddCalls, this->m_reservoirCapacity, rngs[linearIdx]
+        reservoirSizes, reservoirAddCalls, this->m_reservoirCapacity, rng,
+        dirtyReservoirFlags, dirtyReservoirs, dirtyReservoirCount
       );
     }
   }
 }
 
-template <typename ExampleType>
-void ExampleReservoirs_CPU<ExampleType>::reinit_rngs()
-{
-  // If the memory block that will hold the random number generators hasn't yet been created, create it.
-  if(!m_rngs)
-  {
-    itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
-    m_rngs = mbf.make_block<CPURNG>();
-  }
-
-  // Reinitialise each random number generator based on the specified seed.
-  CPURNG *rngs = m_rngs->GetData(MEMORYDEVICE_CPU);
-  const uint32_t rngCount = static_cast<uint32_t>(m_rngs->dataSize);
-  for(uint32_t i = 0; i < rngCount; ++i)
-  {
-    rngs[i].reset(this->m_rngSeed + i);
-  }
-}
-
 }
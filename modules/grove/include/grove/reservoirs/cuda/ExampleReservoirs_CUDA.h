@@ -7,7 +7,7 @@
 #define H_GROVE_EXAMPLERESERVOIRS_CUDA
 
 #include "../interface/ExampleReservoirs.h"
-#include "../../numbers/CUDARNG.h"
+#include "../../numbers/CounterBasedRNG.h"
 
 namespace grove {
 
@@ -25,11 +25,6 @@ public:
   using typename Base::ExampleImage_CPtr;
   using typename Base::Visitor;
 
-  //#################### PRIVATE MEMBER VARIABLES ####################
-private:
-  /** A set of random number generators (used when adding examples). */
-  CUDARNGMemoryBlock_Ptr m_rngs;
-
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -44,7 +39,7 @@ public:
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
-  virtual void reset();
+  virtual uint32_t fetch_dirty_reservoirs(const ITMIntMemoryBlock_Ptr& dirtyReservoirIndices);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
@@ -55,11 +50,6 @@ private:
   template <int ReservoirIndexCount>
   void add_examples_sub(const ExampleImage_CPtr& examples, const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,ReservoirIndexCount> > >& reservoirIndices);
 
-  /**
-   * \brief Reinitialises the random number generators using known seeds.
-   */
-  void reinit_rngs();
-
   //#################### FRIENDS ####################
 
   friend class ExampleReservoirs<ExampleType>;
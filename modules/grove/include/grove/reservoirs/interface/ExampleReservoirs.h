@@ -6,9 +6,13 @@
 #ifndef H_GROVE_EXAMPLERESERVOIRS
 #define H_GROVE_EXAMPLERESERVOIRS
 
+#include <vector>
+
 #include <itmx/base/ITMImagePtrTypes.h>
 #include <itmx/base/ITMMemoryBlockPtrTypes.h>
 
+#include "../base/ReservoirExampleStorage.h"
+
 namespace grove {
 
 //#################### FORWARD DECLARATIONS ####################
@@ -19,7 +23,8 @@ template <typename ExampleType> class ExampleReservoirs_CUDA;
 /**
  * \brief An instance of a class deriving from this one can be used to store a number of examples in a set of fixed-size reservoirs.
  *
- * \tparam ExampleType  The type of example stored in the reservoirs. Must have a member named "valid", convertible to bool.
+ * \tparam ExampleType  The type of example stored in the reservoirs. Must have a member named "valid", convertible to bool. The examples
+ *                      are stored in the form specified by ReservoirExampleStorage<ExampleType>, which may be more compact.
  */
 template <typename ExampleType>
 class ExampleReservoirs
@@ -30,7 +35,8 @@ public:
   typedef boost::shared_ptr<ExampleImage> ExampleImage_Ptr;
   typedef boost::shared_ptr<const ExampleImage> ExampleImage_CPtr;
 
-  typedef ORUtils::Image<ExampleType> ReservoirsImage;
+  typedef typename ReservoirExampleStorage<ExampleType>::StoredType StoredExampleType;
+  typedef ORUtils::Image<StoredExampleType> ReservoirsImage;
   typedef boost::shared_ptr<ReservoirsImage> ReservoirsImage_Ptr;
   typedef boost::shared_ptr<const ReservoirsImage> ReservoirsImage_CPtr;
 
@@ -62,6 +68,18 @@ private:
 
   //#################### PROTECTED MEMBER VARIABLES ####################
 protected:
+  /** The number of times add_examples has been called since the reservoirs were last reset (used to seed the random number generators). */
+  uint32_t m_addExamplesCallCount;
+
+  /** The number of reservoirs in m_dirtyReservoirs (a single-element block, so that it can be updated atomically on the device). */
+  ITMIntMemoryBlock_Ptr m_dirtyReservoirCount;
+
+  /** A flag for each reservoir indicating whether or not it has been modified since the dirty reservoirs were last fetched. */
+  ITMIntMemoryBlock_Ptr m_dirtyReservoirFlags;
+
+  /** The indices of the reservoirs that have been modified since the dirty reservoirs were last fetched (only the first m_dirtyReservoirCount are valid). */
+  ITMIntMemoryBlock_Ptr m_dirtyReservoirs;
+
   /** The capacity (maximum size) of each reservoir. */
   uint32_t m_reservoirCapacity;
 
@@ -98,6 +116,23 @@ public:
    */
   virtual ~ExampleReservoirs();
 
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Fetches the indices of the reservoirs that have been modified since the last call to this function
+   *        (or since the reservoirs were last reset), and marks all of the reservoirs as clean.
+   *
+   * A reservoir is modified whenever an example is stored in it, either because it was not yet full or because the
+   * new example replaced an existing one. This allows clients to update any per-reservoir models incrementally,
+   * rather than having to rescan all of the reservoirs after each call to add_examples.
+   *
+   * \param dirtyReservoirIndices A memory block into whose first N elements the indices of the N dirty reservoirs will be
+   *                              written (in no particular order). Written on the device on which the reservoirs are
+   *                              stored. Will be enlarged as necessary.
+   * \return                      The number of dirty reservoirs.
+   */
+  virtual uint32_t fetch_dirty_reservoirs(const ITMIntMemoryBlock_Ptr& dirtyReservoirIndices) = 0;
+
   //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
 private:
   /**
@@ -132,6 +167,18 @@ public:
   template <int ReservoirIndexCount>
   void add_examples(const ExampleImage_CPtr& examples, const boost::shared_ptr<ORUtils::Image<ORUtils::VectorX<int,ReservoirIndexCount> > >& reservoirIndices);
 
+  /**
+   * \brief Gets the contents of the reservoirs, e.g. so that they can be saved to disk.
+   *
+   * \param reservoirs            A vector into which to write the examples in the reservoirs (get_reservoir_capacity() for each reservoir,
+   *                              of which only the first reservoirSizes[reservoirIdx] are valid).
+   * \param reservoirSizes        A vector into which to write the current size of each reservoir.
+   * \param reservoirAddCalls     A vector into which to write the number of times the insertion of an example has been attempted for each reservoir.
+   * \param addExamplesCallCount  A variable into which to write the number of times add_examples has been called since the reservoirs were last reset.
+   */
+  void get_contents(std::vector<StoredExampleType>& reservoirs, std::vector<int>& reservoirSizes,
+                    std::vector<int>& reservoirAddCalls, uint32_t& addExamplesCallCount) const;
+
   /**
    * \brief Gets the capacity of each reservoir.
    *
@@ -146,6 +193,7 @@ public:
    *
    * \note These are stored in an image in which each row corresponds to a reservoir. Each row can store up to
    *       get_reservoir_capacity() examples, but only the first get_reservoir_sizes()[rowIdx] are valid.
+   *       The examples are stored in the form specified by ReservoirExampleStorage<ExampleType>.
    *
    * \return The example reservoirs.
    */
@@ -169,6 +217,21 @@ public:
    * \brief Clears the reservoirs, discards all examples and reinitialises the random number generator.
    */
   virtual void reset();
+
+  /**
+   * \brief Replaces the contents of the reservoirs, e.g. with contents that were previously saved to disk (see get_contents).
+   *
+   * The add-call counts are restored as well as the examples, so that any examples added subsequently are processed using exactly the
+   * same random numbers as they would have been if the reservoirs had never been saved. All of the reservoirs are marked as clean.
+   *
+   * \param reservoirs              The examples to store in the reservoirs (get_reservoir_capacity() for each reservoir).
+   * \param reservoirSizes          The size of each reservoir.
+   * \param reservoirAddCalls       The number of times the insertion of an example has been attempted for each reservoir.
+   * \param addExamplesCallCount    The number of times add_examples has been called since the reservoirs were last reset.
+   * \throws std::invalid_argument  If the number of examples, sizes or add calls does not match the shape of the reservoirs.
+   */
+  void set_contents(const std::vector<StoredExampleType>& reservoirs, const std::vector<int>& reservoirSizes,
+                    const std::vector<int>& reservoirAddCalls, uint32_t addExamplesCallCount);
 };
 
 }
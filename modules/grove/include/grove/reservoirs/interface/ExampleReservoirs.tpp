@@ -5,6 +5,9 @@
 
 #include "ExampleReservoirs.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <itmx/base/MemoryBlockFactory.h>
 
 namespace grove {
@@ -13,14 +16,19 @@ namespace grove {
 
 template <typename ExampleType>
 ExampleReservoirs<ExampleType>::ExampleReservoirs(uint32_t reservoirCount, uint32_t reservoirCapacity, uint32_t rngSeed)
-: m_reservoirCapacity(reservoirCapacity), m_reservoirCount(reservoirCount), m_rngSeed(rngSeed)
+: m_addExamplesCallCount(0), m_reservoirCapacity(reservoirCapacity), m_reservoirCount(reservoirCount), m_rngSeed(rngSeed)
 {
   itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
 
   // One row per reservoir, width equal to the capacity.
-  m_reservoirs = mbf.make_image<ExampleType>(Vector2i(reservoirCapacity, reservoirCount));
-  m_reservoirAddCalls = mbf.make_block<int>(reservoirCount);
-  m_reservoirSizes = mbf.make_block<int>(reservoirCount);
+  m_reservoirs = mbf.make_image<StoredExampleType>(Vector2i(reservoirCapacity, reservoirCount), "ExampleReservoirs");
+  m_reservoirAddCalls = mbf.make_block<int>(reservoirCount, "ExampleReservoirs");
+  m_reservoirSizes = mbf.make_block<int>(reservoirCount, "ExampleReservoirs");
+
+  // Each reservoir can appear in the dirty list at most once.
+  m_dirtyReservoirCount = mbf.make_block<int>(1, "ExampleReservoirs");
+  m_dirtyReservoirFlags = mbf.make_block<int>(reservoirCount, "ExampleReservoirs");
+  m_dirtyReservoirs = mbf.make_block<int>(reservoirCount, "ExampleReservoirs");
 }
 
 //#################### DESTRUCTOR ####################
@@ -42,6 +50,9 @@ void ExampleReservoirs<ExampleType>::add_examples(const ExampleImage_CPtr& examp
   }
 
   accept(AddExamplesCaller<ReservoirIndexCount>(examples, reservoirIndices));
+
+  // Make sure that the examples added in the next call are processed using different random numbers.
+  ++m_addExamplesCallCount;
 }
 
 template <typename ExampleType>
@@ -52,6 +63,25 @@ void ExampleReservoirs<ExampleType>::add_examples(const ExampleImage_CPtr& examp
   add_examples(examples, reservoirIndicesConst);
 }
 
+template <typename ExampleType>
+void ExampleReservoirs<ExampleType>::get_contents(std::vector<StoredExampleType>& reservoirs, std::vector<int>& reservoirSizes,
+                                                 std::vector<int>& reservoirAddCalls, uint32_t& addExamplesCallCount) const
+{
+  m_reservoirs->UpdateHostFromDevice();
+  const StoredExampleType *reservoirsData = m_reservoirs->GetData(MEMORYDEVICE_CPU);
+  reservoirs.assign(reservoirsData, reservoirsData + static_cast<size_t>(m_reservoirCount) * m_reservoirCapacity);
+
+  m_reservoirSizes->UpdateHostFromDevice();
+  const int *reservoirSizesData = m_reservoirSizes->GetData(MEMORYDEVICE_CPU);
+  reservoirSizes.assign(reservoirSizesData, reservoirSizesData + m_reservoirCount);
+
+  m_reservoirAddCalls->UpdateHostFromDevice();
+  const int *reservoirAddCallsData = m_reservoirAddCalls->GetData(MEMORYDEVICE_CPU);
+  reservoirAddCalls.assign(reservoirAddCallsData, reservoirAddCallsData + m_reservoirCount);
+
+  addExamplesCallCount = m_addExamplesCallCount;
+}
+
 template <typename ExampleType>
 uint32_t ExampleReservoirs<ExampleType>::get_reservoir_capacity() const
 {
@@ -59,7 +89,7 @@ uint32_t ExampleReservoirs<ExampleType>::get_reservoir_capacity() const
 }
 
 template <typename ExampleType>
-typename ExampleReservoirs<ExampleType>::ExampleImage_CPtr ExampleReservoirs<ExampleType>::get_reservoirs() const
+typename ExampleReservoirs<ExampleType>::ReservoirsImage_CPtr ExampleReservoirs<ExampleType>::get_reservoirs() const
 {
   return m_reservoirs;
 }
@@ -79,9 +109,44 @@ ITMIntMemoryBlock_CPtr ExampleReservoirs<ExampleType>::get_reservoir_sizes() con
 template <typename ExampleType>
 void ExampleReservoirs<ExampleType>::reset()
 {
+  m_addExamplesCallCount = 0;
+
   // Note: There is no need to clear m_reservoirs - it is sufficient to simply reset the size of each reservoir to 0.
   m_reservoirAddCalls->Clear();
   m_reservoirSizes->Clear();
+
+  // Similarly, there is no need to clear m_dirtyReservoirs - it is sufficient to reset the dirty count and flags.
+  m_dirtyReservoirCount->Clear();
+  m_dirtyReservoirFlags->Clear();
+}
+
+template <typename ExampleType>
+void ExampleReservoirs<ExampleType>::set_contents(const std::vector<StoredExampleType>& reservoirs, const std::vector<int>& reservoirSizes,
+                                                 const std::vector<int>& reservoirAddCalls, uint32_t addExamplesCallCount)
+{
+  if(reservoirs.size() != static_cast<size_t>(m_reservoirCount) * m_reservoirCapacity)
+  {
+    throw std::invalid_argument("Error: The number of examples does not match the shape of the reservoirs");
+  }
+
+  if(reservoirSizes.size() != m_reservoirCount || reservoirAddCalls.size() != m_reservoirCount)
+  {
+    throw std::invalid_argument("Error: The number of reservoir sizes or add calls does not match the number of reservoirs");
+  }
+
+  // Start from a clean state, so that none of the reservoirs are marked as dirty.
+  reset();
+
+  std::copy(reservoirs.begin(), reservoirs.end(), m_reservoirs->GetData(MEMORYDEVICE_CPU));
+  m_reservoirs->UpdateDeviceFromHost();
+
+  std::copy(reservoirSizes.begin(), reservoirSizes.end(), m_reservoirSizes->GetData(MEMORYDEVICE_CPU));
+  m_reservoirSizes->UpdateDeviceFromHost();
+
+  std::copy(reservoirAddCalls.begin(), reservoirAddCalls.end(), m_reservoirAddCalls->GetData(MEMORYDEVICE_CPU));
+  m_reservoirAddCalls->UpdateDeviceFromHost();
+
+  m_addExamplesCallCount = addExamplesCallCount;
 }
 
 }
@@ -8,10 +8,52 @@
 
 #include <ORUtils/PlatformIndependence.h>
 
+#include "../base/ReservoirExampleStorage.h"
+#include "../../util/WarpAggregatedAtomics.h"
+
 #define ALWAYS_ADD_EXAMPLES 0
 
 namespace grove {
 
+/**
+ * \brief Marks a reservoir as dirty, appending it to the list of dirty reservoirs if it was not already dirty.
+ *
+ * \param reservoirIdx        The index of the reservoir to mark as dirty.
+ * \param dirtyReservoirFlags A flag for each reservoir indicating whether or not it is dirty.
+ * \param dirtyReservoirs     The list of dirty reservoirs.
+ * \param dirtyReservoirCount The number of reservoirs in the list of dirty reservoirs.
+ */
+_CPU_AND_GPU_CODE_
+inline void mark_reservoir_dirty(int reservoirIdx, int *dirtyReservoirFlags, int *dirtyReservoirs, int *dirtyReservoirCount)
+{
+  int wasDirty = 0;
+  int dirtyIdx = 0;
+
+#ifdef __CUDACC__
+  // Avoid the atomics altogether in the common case in which the reservoir is already dirty.
+  if(dirtyReservoirFlags[reservoirIdx]) return;
+
+  wasDirty = atomicExch(&dirtyReservoirFlags[reservoirIdx], 1);
+  if(!wasDirty) dirtyIdx = atomicAdd(dirtyReservoirCount, 1);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp atomic capture
+  #endif
+  { wasDirty = dirtyReservoirFlags[reservoirIdx]; dirtyReservoirFlags[reservoirIdx] = 1; }
+
+  if(!wasDirty)
+  {
+  #ifdef WITH_OPENMP
+    #pragma omp atomic capture
+  #endif
+    dirtyIdx = (*dirtyReservoirCount)++;
+  }
+#endif
+
+  // If this was the call that made the reservoir dirty, append the reservoir to the list of dirty reservoirs.
+  if(!wasDirty) dirtyReservoirs[dirtyIdx] = reservoirIdx;
+}
+
 /**
  * \brief Attempts to add an example to some reservoirs.
  *
@@ -19,26 +61,34 @@ namespace grove {
  * reservoir is not full, then the example is added. Otherwise, if ALWAYS_ADD_EXAMPLES
  * is 1, a randomly-selected existing example is discarded and replaced by the current
  * example. If ALWAYS_ADD_EXAMPLES is 0, then an additional random decision is made as
- * to *whether* to replace an existing example.
+ * to *whether* to replace an existing example. Each reservoir in which the example
+ * is actually stored is marked as dirty.
  *
  * \param example             The example to attempt to add to the reservoirs.
  * \param reservoirIndices    The indices of the reservoirs to which to attempt to add the example.
  * \param reservoirIndexCount The number of reservoirs to which to attempt to add the example.
- * \param reservoirs          The example reservoirs: an image in which each row allows the storage of up to reservoirCapacity examples.
+ * \param reservoirs          The example reservoirs: an image in which each row allows the storage of up to reservoirCapacity examples
+ *                            (in the form specified by ReservoirExampleStorage<ExampleType>).
  * \param reservoirSizes      The current size of each reservoir.
  * \param reservoirAddCalls   The number of times the insertion of an example has been attempted for each reservoir.
  * \param reservoirCapacity   The capacity (maximum size) of each reservoir.
  * \param randomGenerator     A random number generator.
+ * \param dirtyReservoirFlags A flag for each reservoir indicating whether or not it is dirty.
+ * \param dirtyReservoirs     The list of dirty reservoirs.
+ * \param dirtyReservoirCount The number of reservoirs in the list of dirty reservoirs.
  */
 template <typename ExampleType, typename RNGType>
 _CPU_AND_GPU_CODE_TEMPLATE_
 inline void add_example_to_reservoirs(const ExampleType& example, const int *reservoirIndices, uint32_t reservoirIndexCount,
-                                      ExampleType *reservoirs, int *reservoirSizes, int *reservoirAddCalls, uint32_t reservoirCapacity,
-                                      RNGType& randomGenerator)
+                                      typename ReservoirExampleStorage<ExampleType>::StoredType *reservoirs, int *reservoirSizes, int *reservoirAddCalls, uint32_t reservoirCapacity,
+                                      RNGType& randomGenerator, int *dirtyReservoirFlags, int *dirtyReservoirs, int *dirtyReservoirCount)
 {
   // If the example is invalid, early out.
   if(!example.valid) return;
 
+  // Convert the example into the form in which it is stored in the reservoirs.
+  const typename ReservoirExampleStorage<ExampleType>::StoredType storedExample = ReservoirExampleStorage<ExampleType>::store(example);
+
   // Try to add the example to each specified reservoir.
   for(uint32_t i = 0; i < reservoirIndexCount; ++i)
   {
@@ -52,7 +102,10 @@ inline void add_example_to_reservoirs(const ExampleType& example, const int *res
     uint32_t oldAddCallsCount = 0;
 
 #ifdef __CUDACC__
-    oldAddCallsCount = atomicAdd(&reservoirAddCalls[reservoirIdx], 1);
+    // Note: In scenes in which many pixels fall into the same leaf, the threads in a warp will often be adding examples to
+    //       the same reservoir, so we aggregate the increments to avoid serialising their atomics. The threads still each
+    //       receive a distinct old count, so the reservoir sampling behaves exactly as it would with separate atomics.
+    oldAddCallsCount = warp_aggregated_increment(&reservoirAddCalls[reservoirIdx], reservoirIdx);
 #else
   #ifdef WITH_OPENMP
     #pragma omp atomic capture
@@ -65,7 +118,7 @@ inline void add_example_to_reservoirs(const ExampleType& example, const int *res
     if(oldAddCallsCount < reservoirCapacity)
     {
       // Store the example in the reservoir.
-      reservoirs[reservoirStartIdx + oldAddCallsCount] = example;
+      reservoirs[reservoirStartIdx + oldAddCallsCount] = storedExample;
 
       // Increment the reservoir's size. Note that it is not strictly necessary to
       // maintain the reservoir sizes separately, since we can obtain the same
@@ -73,13 +126,15 @@ inline void add_example_to_reservoirs(const ExampleType& example, const int *res
       // capacity, but writing it this way is much clearer and the cost in efficiency
       // is limited in practice.
 #ifdef __CUDACC__
-      atomicAdd(&reservoirSizes[reservoirIdx], 1);
+      warp_aggregated_increment(&reservoirSizes[reservoirIdx], reservoirIdx);
 #else
     #ifdef WITH_OPENMP
       #pragma omp atomic
     #endif
       ++reservoirSizes[reservoirIdx];
 #endif
+
+      mark_reservoir_dirty(reservoirIdx, dirtyReservoirFlags, dirtyReservoirs, dirtyReservoirCount);
     }
     else
     {
@@ -94,7 +149,8 @@ inline void add_example_to_reservoirs(const ExampleType& example, const int *res
       // If the random offset corresponds to an example in the reservoir, replace that with the new example.
       if(randomOffset < reservoirCapacity)
       {
-        reservoirs[reservoirStartIdx + randomOffset] = example;
+        reservoirs[reservoirStartIdx + randomOffset] = storedExample;
+        mark_reservoir_dirty(reservoirIdx, dirtyReservoirFlags, dirtyReservoirs, dirtyReservoirCount);
       }
     }
   }
@@ -0,0 +1,73 @@
+/**
+ * grove: WarpAggregatedAtomics.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_GROVE_WARPAGGREGATEDATOMICS
+#define H_GROVE_WARPAGGREGATEDATOMICS
+
+#ifdef __CUDACC__
+
+namespace grove {
+
+/**
+ * \brief Atomically increments a counter in global memory, aggregating the increments made by the active threads in the warp.
+ *
+ * The active threads in the warp are grouped by key (threads that pass the same key must pass the same counter), and a single
+ * atomicAdd is then issued for each group by its lowest lane, after which the old value is broadcast to the rest of the group.
+ * Each thread receives the value that the counter would have had just before its own increment, exactly as if it had called
+ * atomicAdd(counter, 1) itself, so the set of values handed out is unchanged. When many threads in a warp hit the same counter
+ * (e.g. many pixels falling into the same leaf), this avoids the serialisation of their atomics.
+ *
+ * \param counter The counter to increment.
+ * \param key     A key identifying the counter (e.g. its index in an array of counters).
+ * \return        The value of the counter before this thread's increment.
+ */
+__device__
+inline int warp_aggregated_increment(int *counter, int key)
+{
+  const unsigned int activeMask = __activemask();
+  const int laneIdx = (threadIdx.x + threadIdx.y * blockDim.x + threadIdx.z * blockDim.x * blockDim.y) & (warpSize - 1);
+  const unsigned int lowerLanesMask = (1u << laneIdx) - 1;
+
+#if __CUDA_ARCH__ >= 700
+  // Find the active threads that have the same key as this one, and elect the lowest of them as the leader of the group.
+  const unsigned int groupMask = __match_any_sync(activeMask, key);
+  const int leaderLaneIdx = __ffs(groupMask) - 1;
+
+  // Let the leader increment the counter on behalf of the whole group, and broadcast the old value to the rest of the group.
+  int base = 0;
+  if(laneIdx == leaderLaneIdx) base = atomicAdd(counter, __popc(groupMask));
+  base = __shfl_sync(groupMask, base, leaderLaneIdx);
+
+  // Hand out consecutive values to the threads in the group, in lane order.
+  return base + __popc(groupMask & lowerLanesMask);
+#else
+  // Without __match_any_sync, we repeatedly pick the lowest remaining lane as a leader and serve all of the threads that share its key.
+  // Note that all of the active threads take part in every iteration, so that the warp-level primitives can use the original mask.
+  unsigned int remainingMask = activeMask;
+  int result = 0;
+
+  while(remainingMask)
+  {
+    const int leaderLaneIdx = __ffs(remainingMask) - 1;
+    const int leaderKey = __shfl_sync(activeMask, key, leaderLaneIdx);
+    const unsigned int groupMask = __ballot_sync(activeMask, key == leaderKey) & remainingMask;
+
+    int base = 0;
+    if(laneIdx == leaderLaneIdx) base = atomicAdd(counter, __popc(groupMask));
+    base = __shfl_sync(activeMask, base, leaderLaneIdx);
+
+    if(groupMask & (1u << laneIdx)) result = base + __popc(groupMask & lowerLanesMask);
+    remainingMask &= ~groupMask;
+  }
+
+  return result;
+#endif
+}
+
+}
+
+#endif
+
+#endif
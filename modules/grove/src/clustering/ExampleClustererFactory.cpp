@@ -0,0 +1,40 @@
+/**
+ * grove: ExampleClustererFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "clustering/ExampleClustererFactory.h"
+using namespace ITMLib;
+
+#include "clustering/cpu/ExampleClusterer_CPU.h"
+
+#ifdef WITH_CUDA
+#include "clustering/cuda/ExampleClusterer_CUDA.h"
+#endif
+
+namespace grove {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+ExampleClusterer_Ptr ExampleClustererFactory::make_example_clusterer(ITMLibSettings::DeviceType deviceType, float sigma, float tau,
+                                                                     uint32_t maxClusterCount, uint32_t minClusterSize)
+{
+  ExampleClusterer_Ptr clusterer;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    clusterer.reset(new ExampleClusterer_CUDA(sigma, tau, maxClusterCount, minClusterSize));
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    clusterer.reset(new ExampleClusterer_CPU(sigma, tau, maxClusterCount, minClusterSize));
+  }
+
+  return clusterer;
+}
+
+}
@@ -0,0 +1,156 @@
+/**
+ * grove: ExampleClusterer_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "clustering/cpu/ExampleClusterer_CPU.h"
+
+#include <itmx/base/MemoryBlockFactory.h>
+
+#include "clustering/shared/ExampleClusterer_Shared.h"
+
+namespace grove {
+
+//#################### CONSTRUCTORS ####################
+
+ExampleClusterer_CPU::ExampleClusterer_CPU(float sigma, float tau, uint32_t maxClusterCount, uint32_t minClusterSize)
+: ExampleClusterer(sigma, tau, maxClusterCount, minClusterSize),
+  m_positions(itmx::MemoryBlockFactory::instance().make_block<Vector3f>())
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ExampleClusterer_CPU::compute_densities(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                             const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount)
+{
+  const int reservoirCapacity = examples.noDims.width;
+  const int exampleCount = static_cast<int>(reservoirCount) * reservoirCapacity;
+  if(m_positions->dataSize < static_cast<size_t>(exampleCount)) m_positions->Resize(exampleCount);
+
+  float *densities = m_densities->GetData(MEMORYDEVICE_CPU);
+  const CompactKeypoint3DColour *examplesPtr = examples.GetData(MEMORYDEVICE_CPU);
+  const float minusInvTwoSigmaSq = -1.0f / (2.0f * m_sigma * m_sigma);
+  Vector3f *positions = m_positions->GetData(MEMORYDEVICE_CPU);
+  const int *reservoirIndicesPtr = reservoirIndices.GetData(MEMORYDEVICE_CPU);
+  const int *reservoirSizesPtr = reservoirSizes.GetData(MEMORYDEVICE_CPU);
+
+  // Pack the positions of the examples in each reservoir contiguously, since they are scanned repeatedly by this stage and the next.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < exampleCount; ++i)
+  {
+    gather_position(i / reservoirCapacity, i % reservoirCapacity, examplesPtr, reservoirSizesPtr, reservoirIndicesPtr, reservoirCapacity, positions);
+  }
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < exampleCount; ++i)
+  {
+    const int batchIdx = i / reservoirCapacity;
+    const int exampleIdx = i % reservoirCapacity;
+    const int reservoirSize = reservoirSizesPtr[reservoirIndicesPtr[batchIdx]];
+    if(exampleIdx < reservoirSize)
+    {
+      densities[i] = compute_density(exampleIdx, positions + batchIdx * reservoirCapacity, reservoirSize, minusInvTwoSigmaSq);
+    }
+  }
+}
+
+void ExampleClusterer_CPU::compute_modes(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                         const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions)
+{
+  const int maxClusterCount = static_cast<int>(m_maxClusterCount);
+  const int modeCount = static_cast<int>(reservoirCount) * maxClusterCount;
+  const CompactKeypoint3DColour *examplesPtr = examples.GetData(MEMORYDEVICE_CPU);
+  ScorePrediction *predictionsPtr = predictions.GetData(MEMORYDEVICE_CPU);
+  const int reservoirCapacity = examples.noDims.width;
+  const int *reservoirIndicesPtr = reservoirIndices.GetData(MEMORYDEVICE_CPU);
+  const int *reservoirSizesPtr = reservoirSizes.GetData(MEMORYDEVICE_CPU);
+  const int *roots = m_roots->GetData(MEMORYDEVICE_CPU);
+  const int *selectedClusters = m_selectedClusters->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < modeCount; ++i)
+  {
+    compute_mode(
+      i / maxClusterCount, i % maxClusterCount, examplesPtr, reservoirSizesPtr, reservoirIndicesPtr,
+      reservoirCapacity, roots, maxClusterCount, selectedClusters, predictionsPtr
+    );
+  }
+}
+
+void ExampleClusterer_CPU::identify_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                             const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount)
+{
+  int *clusterSizes = m_clusterSizes->GetData(MEMORYDEVICE_CPU);
+  const int reservoirCapacity = examples.noDims.width;
+  const int exampleCount = static_cast<int>(reservoirCount) * reservoirCapacity;
+  const int *parents = m_parents->GetData(MEMORYDEVICE_CPU);
+  const int *reservoirIndicesPtr = reservoirIndices.GetData(MEMORYDEVICE_CPU);
+  const int *reservoirSizesPtr = reservoirSizes.GetData(MEMORYDEVICE_CPU);
+  int *roots = m_roots->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < exampleCount; ++i)
+  {
+    identify_cluster(i / reservoirCapacity, i % reservoirCapacity, reservoirSizesPtr, reservoirIndicesPtr, reservoirCapacity, parents, roots, clusterSizes);
+  }
+}
+
+void ExampleClusterer_CPU::link_neighbours(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                           const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount)
+{
+  const float *densities = m_densities->GetData(MEMORYDEVICE_CPU);
+  const int reservoirCapacity = examples.noDims.width;
+  const int exampleCount = static_cast<int>(reservoirCount) * reservoirCapacity;
+  int *parents = m_parents->GetData(MEMORYDEVICE_CPU);
+  const Vector3f *positions = m_positions->GetData(MEMORYDEVICE_CPU);
+  const int *reservoirIndicesPtr = reservoirIndices.GetData(MEMORYDEVICE_CPU);
+  const int *reservoirSizesPtr = reservoirSizes.GetData(MEMORYDEVICE_CPU);
+  const float tauSq = m_tau * m_tau;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < exampleCount; ++i)
+  {
+    const int batchIdx = i / reservoirCapacity;
+    const int exampleIdx = i % reservoirCapacity;
+    const int reservoirSize = reservoirSizesPtr[reservoirIndicesPtr[batchIdx]];
+    if(exampleIdx < reservoirSize)
+    {
+      const int offset = batchIdx * reservoirCapacity;
+      parents[i] = find_parent(exampleIdx, positions + offset, densities + offset, reservoirSize, tauSq);
+    }
+  }
+}
+
+void ExampleClusterer_CPU::select_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                           const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions)
+{
+  const int *clusterSizes = m_clusterSizes->GetData(MEMORYDEVICE_CPU);
+  ScorePrediction *predictionsPtr = predictions.GetData(MEMORYDEVICE_CPU);
+  const int reservoirCapacity = examples.noDims.width;
+  const int *reservoirIndicesPtr = reservoirIndices.GetData(MEMORYDEVICE_CPU);
+  const int *reservoirSizesPtr = reservoirSizes.GetData(MEMORYDEVICE_CPU);
+  int *selectedClusters = m_selectedClusters->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int batchIdx = 0; batchIdx < static_cast<int>(reservoirCount); ++batchIdx)
+  {
+    select_clusters_for_reservoir(
+      batchIdx, reservoirSizesPtr, reservoirIndicesPtr, reservoirCapacity, clusterSizes,
+      static_cast<int>(m_maxClusterCount), static_cast<int>(m_minClusterSize), selectedClusters, predictionsPtr
+    );
+  }
+}
+
+}
@@ -0,0 +1,222 @@
+/**
+ * grove: ExampleClusterer_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "clustering/cuda/ExampleClusterer_CUDA.h"
+
+#include <stdexcept>
+
+#include <ORUtils/CUDADefines.h>
+
+#include "clustering/shared/ExampleClusterer_Shared.h"
+
+namespace grove {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_compute_densities(const CompactKeypoint3DColour *examples, const int *reservoirSizes, const int *reservoirIndices,
+                                     int reservoirCapacity, float minusInvTwoSigmaSq, float *densities)
+{
+  // Note: Each block processes one reservoir, whose example positions are first packed into shared memory.
+  extern __shared__ float sharedMemory[];
+  Vector3f *positions = reinterpret_cast<Vector3f*>(sharedMemory);
+
+  const int batchIdx = blockIdx.x;
+  const int reservoirIdx = reservoirIndices[batchIdx];
+  const int reservoirSize = reservoirSizes[reservoirIdx];
+  const CompactKeypoint3DColour *reservoir = examples + reservoirIdx * reservoirCapacity;
+
+  for(int exampleIdx = threadIdx.x; exampleIdx < reservoirSize; exampleIdx += blockDim.x)
+  {
+    positions[exampleIdx] = get_position(reservoir[exampleIdx]);
+  }
+
+  __syncthreads();
+
+  for(int exampleIdx = threadIdx.x; exampleIdx < reservoirSize; exampleIdx += blockDim.x)
+  {
+    densities[batchIdx * reservoirCapacity + exampleIdx] = compute_density(exampleIdx, positions, reservoirSize, minusInvTwoSigmaSq);
+  }
+}
+
+__global__ void ck_compute_modes(const CompactKeypoint3DColour *examples, const int *reservoirSizes, const int *reservoirIndices, int reservoirCapacity,
+                                 const int *roots, int maxClusterCount, const int *selectedClusters, ScorePrediction *predictions)
+{
+  compute_mode(blockIdx.x, threadIdx.x, examples, reservoirSizes, reservoirIndices, reservoirCapacity, roots, maxClusterCount, selectedClusters, predictions);
+}
+
+__global__ void ck_identify_clusters(const int *reservoirSizes, const int *reservoirIndices, int reservoirCapacity, const int *parents, int *roots, int *clusterSizes)
+{
+  const int exampleIdx = threadIdx.x + blockIdx.x * blockDim.x;
+  if(exampleIdx < reservoirCapacity)
+  {
+    identify_cluster(blockIdx.y, exampleIdx, reservoirSizes, reservoirIndices, reservoirCapacity, parents, roots, clusterSizes);
+  }
+}
+
+__global__ void ck_link_neighbours(const CompactKeypoint3DColour *examples, const int *reservoirSizes, const int *reservoirIndices, int reservoirCapacity,
+                                   const float *densities, float tauSq, int *parents)
+{
+  // Note: Each block processes one reservoir, whose example positions and densities are first packed into shared memory.
+  extern __shared__ float sharedMemory[];
+  Vector3f *positions = reinterpret_cast<Vector3f*>(sharedMemory);
+  float *reservoirDensities = sharedMemory + 3 * reservoirCapacity;
+
+  const int batchIdx = blockIdx.x;
+  const int reservoirIdx = reservoirIndices[batchIdx];
+  const int reservoirSize = reservoirSizes[reservoirIdx];
+  const int offset = batchIdx * reservoirCapacity;
+  const CompactKeypoint3DColour *reservoir = examples + reservoirIdx * reservoirCapacity;
+
+  for(int exampleIdx = threadIdx.x; exampleIdx < reservoirSize; exampleIdx += blockDim.x)
+  {
+    positions[exampleIdx] = get_position(reservoir[exampleIdx]);
+    reservoirDensities[exampleIdx] = densities[offset + exampleIdx];
+  }
+
+  __syncthreads();
+
+  for(int exampleIdx = threadIdx.x; exampleIdx < reservoirSize; exampleIdx += blockDim.x)
+  {
+    parents[offset + exampleIdx] = find_parent(exampleIdx, positions, reservoirDensities, reservoirSize, tauSq);
+  }
+}
+
+__global__ void ck_select_clusters(const int *reservoirSizes, const int *reservoirIndices, int reservoirCount, int reservoirCapacity, const int *clusterSizes,
+                                   int maxClusterCount, int minClusterSize, int *selectedClusters, ScorePrediction *predictions)
+{
+  const int batchIdx = threadIdx.x + blockIdx.x * blockDim.x;
+  if(batchIdx < reservoirCount)
+  {
+    select_clusters_for_reservoir(
+      batchIdx, reservoirSizes, reservoirIndices, reservoirCapacity, clusterSizes, maxClusterCount, minClusterSize, selectedClusters, predictions
+    );
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+ExampleClusterer_CUDA::ExampleClusterer_CUDA(float sigma, float tau, uint32_t maxClusterCount, uint32_t minClusterSize)
+: ExampleClusterer(sigma, tau, maxClusterCount, minClusterSize)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ExampleClusterer_CUDA::compute_densities(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                              const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount)
+{
+  const int reservoirCapacity = examples.noDims.width;
+  const size_t sharedMemorySize = reservoirCapacity * sizeof(Vector3f);
+  check_shared_memory_size(sharedMemorySize);
+
+  // Note: We use one block per reservoir.
+  dim3 blockSize(256);
+  dim3 gridSize(reservoirCount);
+
+  ck_compute_densities<<<gridSize,blockSize,sharedMemorySize>>>(
+    examples.GetData(MEMORYDEVICE_CUDA),
+    reservoirSizes.GetData(MEMORYDEVICE_CUDA),
+    reservoirIndices.GetData(MEMORYDEVICE_CUDA),
+    reservoirCapacity,
+    -1.0f / (2.0f * m_sigma * m_sigma),
+    m_densities->GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+void ExampleClusterer_CUDA::compute_modes(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                          const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions)
+{
+  // Note: We use one block per reservoir and one thread per selected cluster.
+  dim3 blockSize(m_maxClusterCount);
+  dim3 gridSize(reservoirCount);
+
+  ck_compute_modes<<<gridSize,blockSize>>>(
+    examples.GetData(MEMORYDEVICE_CUDA),
+    reservoirSizes.GetData(MEMORYDEVICE_CUDA),
+    reservoirIndices.GetData(MEMORYDEVICE_CUDA),
+    examples.noDims.width,
+    m_roots->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_maxClusterCount),
+    m_selectedClusters->GetData(MEMORYDEVICE_CUDA),
+    predictions.GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+void ExampleClusterer_CUDA::identify_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                              const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount)
+{
+  const int reservoirCapacity = examples.noDims.width;
+
+  dim3 blockSize(256);
+  dim3 gridSize((reservoirCapacity + blockSize.x - 1) / blockSize.x, reservoirCount);
+
+  ck_identify_clusters<<<gridSize,blockSize>>>(
+    reservoirSizes.GetData(MEMORYDEVICE_CUDA),
+    reservoirIndices.GetData(MEMORYDEVICE_CUDA),
+    reservoirCapacity,
+    m_parents->GetData(MEMORYDEVICE_CUDA),
+    m_roots->GetData(MEMORYDEVICE_CUDA),
+    m_clusterSizes->GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+void ExampleClusterer_CUDA::link_neighbours(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                            const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount)
+{
+  const int reservoirCapacity = examples.noDims.width;
+  const size_t sharedMemorySize = reservoirCapacity * (sizeof(Vector3f) + sizeof(float));
+  check_shared_memory_size(sharedMemorySize);
+
+  // Note: We use one block per reservoir.
+  dim3 blockSize(256);
+  dim3 gridSize(reservoirCount);
+
+  ck_link_neighbours<<<gridSize,blockSize,sharedMemorySize>>>(
+    examples.GetData(MEMORYDEVICE_CUDA),
+    reservoirSizes.GetData(MEMORYDEVICE_CUDA),
+    reservoirIndices.GetData(MEMORYDEVICE_CUDA),
+    reservoirCapacity,
+    m_densities->GetData(MEMORYDEVICE_CUDA),
+    m_tau * m_tau,
+    m_parents->GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+void ExampleClusterer_CUDA::select_clusters(const CompactKeypoint3DColourImage& examples, const ORUtils::MemoryBlock<int>& reservoirSizes,
+                                            const ORUtils::MemoryBlock<int>& reservoirIndices, uint32_t reservoirCount, ScorePredictionsBlock& predictions)
+{
+  dim3 blockSize(256);
+  dim3 gridSize((reservoirCount + blockSize.x - 1) / blockSize.x);
+
+  ck_select_clusters<<<gridSize,blockSize>>>(
+    reservoirSizes.GetData(MEMORYDEVICE_CUDA),
+    reservoirIndices.GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(reservoirCount),
+    examples.noDims.width,
+    m_clusterSizes->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_maxClusterCount),
+    static_cast<int>(m_minClusterSize),
+    m_selectedClusters->GetData(MEMORYDEVICE_CUDA),
+    predictions.GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+void ExampleClusterer_CUDA::check_shared_memory_size(size_t sharedMemorySize)
+{
+  // The kernels that process a whole reservoir per block keep its example positions in shared memory, which limits the reservoir capacity.
+  static const size_t maxSharedMemorySize = 48 * 1024;
+  if(sharedMemorySize > maxSharedMemorySize)
+  {
+    throw std::invalid_argument("Error: The reservoirs are too large to be clustered by the CUDA example clusterer");
+  }
+}
+
+}
@@ -0,0 +1,69 @@
+/**
+ * grove: ExampleClusterer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "clustering/interface/ExampleClusterer.h"
+
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+
+namespace grove {
+
+//#################### CONSTRUCTORS ####################
+
+ExampleClusterer::ExampleClusterer(float sigma, float tau, uint32_t maxClusterCount, uint32_t minClusterSize)
+: m_maxClusterCount(maxClusterCount), m_minClusterSize(minClusterSize), m_sigma(sigma), m_tau(tau)
+{
+  if(maxClusterCount == 0 || maxClusterCount > SCORE_MAX_MODES)
+  {
+    throw std::invalid_argument("Error: The maximum number of clusters per reservoir must be between 1 and SCORE_MAX_MODES");
+  }
+
+  // Note: The scratch memory blocks are sized lazily, since they depend on the size of the batches being clustered.
+  itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
+  m_clusterSizes = mbf.make_block<int>();
+  m_densities = mbf.make_block<float>();
+  m_parents = mbf.make_block<int>();
+  m_roots = mbf.make_block<int>();
+  m_selectedClusters = mbf.make_block<int>();
+}
+
+//#################### DESTRUCTOR ####################
+
+ExampleClusterer::~ExampleClusterer() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ExampleClusterer::cluster_reservoirs(const CompactKeypoint3DColourImage_CPtr& examples, const ITMIntMemoryBlock_CPtr& reservoirSizes,
+                                          const ITMIntMemoryBlock_CPtr& reservoirIndices, uint32_t reservoirCount, const ScorePredictionsBlock_Ptr& predictions)
+{
+  // If there are no reservoirs to cluster, early out (this also avoids launching kernels with zero threads).
+  if(reservoirCount == 0) return;
+
+  // Make sure that the scratch memory blocks are large enough for the batch.
+  const size_t exampleCount = reservoirCount * static_cast<size_t>(examples->noDims.width);
+  if(m_densities->dataSize < exampleCount)
+  {
+    m_clusterSizes->Resize(exampleCount);
+    m_densities->Resize(exampleCount);
+    m_parents->Resize(exampleCount);
+    m_roots->Resize(exampleCount);
+  }
+
+  const size_t selectedClusterCount = reservoirCount * static_cast<size_t>(m_maxClusterCount);
+  if(m_selectedClusters->dataSize < selectedClusterCount) m_selectedClusters->Resize(selectedClusterCount);
+
+  // The cluster sizes are accumulated atomically, so they must start at zero.
+  m_clusterSizes->Clear();
+
+  // Run the stages of the clustering in turn.
+  compute_densities(*examples, *reservoirSizes, *reservoirIndices, reservoirCount);
+  link_neighbours(*examples, *reservoirSizes, *reservoirIndices, reservoirCount);
+  identify_clusters(*examples, *reservoirSizes, *reservoirIndices, reservoirCount);
+  select_clusters(*examples, *reservoirSizes, *reservoirIndices, reservoirCount, *predictions);
+  compute_modes(*examples, *reservoirSizes, *reservoirIndices, reservoirCount, *predictions);
+}
+
+}
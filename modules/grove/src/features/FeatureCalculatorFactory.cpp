@@ -35,6 +35,25 @@ DA_RGBDPatchFeatureCalculator_Ptr FeatureCalculatorFactory::make_da_rgbd_patch_f
   );
 }
 
+QuantisedDA_RGBDPatchFeatureCalculator_Ptr FeatureCalculatorFactory::make_quantised_da_rgbd_patch_feature_calculator(ITMLibSettings::DeviceType deviceType)
+{
+  bool depthAdaptive = true;
+  RGBDPatchFeatureDifferenceType differenceType = CENTRAL_DIFFERENCE;
+  const uint32_t depthMinRadius = 1;       // as per Julien's code (was 2 / 2)
+  const uint32_t depthMaxRadius = 130 / 2; // as per Julien's code
+  const uint32_t depthFeatureCount = 128;
+  const uint32_t depthFeatureOffset = 0;
+  const uint32_t rgbMinRadius = 2;         // as per Julien's code
+  const uint32_t rgbMaxRadius = 130;       // as per Julien's code
+  const uint32_t rgbFeatureCount = 128;
+  const uint32_t rgbFeatureOffset = 128;
+
+  return make_custom_patch_feature_calculator<Keypoint3DColour,QuantisedRGBDPatchDescriptor>(
+    deviceType, depthAdaptive, differenceType, depthFeatureCount, depthFeatureOffset, depthMinRadius, depthMaxRadius,
+    differenceType, rgbFeatureCount, rgbFeatureOffset, rgbMinRadius, rgbMaxRadius
+  );
+}
+
 RGBPatchFeatureCalculator_Ptr FeatureCalculatorFactory::make_rgb_patch_feature_calculator(ITMLibSettings::DeviceType deviceType)
 {
   bool depthAdaptive = false;
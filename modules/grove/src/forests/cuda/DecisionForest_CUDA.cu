@@ -0,0 +1,34 @@
+/**
+ * grove: DecisionForest_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "forests/cuda/DecisionForest_CUDA.tcu"
+
+#include "features/interface/RGBDPatchFeatureCalculator.h"
+
+namespace grove {
+
+//#################### EXPLICIT INSTANTIATIONS ####################
+
+// Note: The CUDA forests must be instantiated here (since they can only be compiled by nvcc) for every descriptor type and
+//       tree count that DynamicDecisionForestFactory supports. If DynamicDecisionForestFactory::MAX_TREE_COUNT changes, update this list.
+template class DecisionForest_CUDA<RGBDPatchDescriptor,1>;
+template class DecisionForest_CUDA<RGBDPatchDescriptor,2>;
+template class DecisionForest_CUDA<RGBDPatchDescriptor,3>;
+template class DecisionForest_CUDA<RGBDPatchDescriptor,4>;
+template class DecisionForest_CUDA<RGBDPatchDescriptor,5>;
+template class DecisionForest_CUDA<RGBDPatchDescriptor,6>;
+template class DecisionForest_CUDA<RGBDPatchDescriptor,7>;
+template class DecisionForest_CUDA<RGBDPatchDescriptor,8>;
+
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,1>;
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,2>;
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,3>;
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,4>;
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,5>;
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,6>;
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,7>;
+template class DecisionForest_CUDA<QuantisedRGBDPatchDescriptor,8>;
+
+}
@@ -0,0 +1,46 @@
+/**
+ * grove: PreemptiveRansacFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "ransac/PreemptiveRansacFactory.h"
+using namespace ITMLib;
+
+#include "ransac/cpu/PreemptiveRansac_CPU.h"
+
+#ifdef WITH_CUDA
+#include "ransac/cuda/PreemptiveRansac_CUDA.h"
+#endif
+
+namespace grove {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+PreemptiveRansac_Ptr PreemptiveRansacFactory::make_preemptive_ransac(ITMLibSettings::DeviceType deviceType, uint32_t maxCandidateCount,
+                                                                     uint32_t maxAttemptsPerCandidate, uint32_t batchSize,
+                                                                     float minSquaredDistanceBetweenSampledPoints, float maxTranslationError, bool useAllModes,
+                                                                     uint32_t rngSeed)
+{
+  PreemptiveRansac_Ptr ransac;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    ransac.reset(new PreemptiveRansac_CUDA(
+      maxCandidateCount, maxAttemptsPerCandidate, batchSize, minSquaredDistanceBetweenSampledPoints, maxTranslationError, useAllModes, rngSeed
+    ));
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    ransac.reset(new PreemptiveRansac_CPU(
+      maxCandidateCount, maxAttemptsPerCandidate, batchSize, minSquaredDistanceBetweenSampledPoints, maxTranslationError, useAllModes, rngSeed
+    ));
+  }
+
+  return ransac;
+}
+
+}
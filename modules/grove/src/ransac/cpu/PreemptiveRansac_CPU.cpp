@@ -0,0 +1,139 @@
+/**
+ * grove: PreemptiveRansac_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "ransac/cpu/PreemptiveRansac_CPU.h"
+
+#include <algorithm>
+
+#include <itmx/base/MemoryBlockFactory.h>
+
+#include "ransac/shared/PreemptiveRansac_Shared.h"
+
+namespace {
+
+//#################### LOCAL TYPES ####################
+
+/**
+ * \brief A comparator that ranks the indices of pose candidates by the candidates' energies (see pose_candidate_precedes).
+ */
+struct CandidateIndexComparator
+{
+  const grove::PoseCandidate *m_poseCandidates;
+
+  explicit CandidateIndexComparator(const grove::PoseCandidate *poseCandidates)
+  : m_poseCandidates(poseCandidates)
+  {}
+
+  bool operator()(int lhs, int rhs) const
+  {
+    return grove::pose_candidate_precedes(m_poseCandidates[lhs].energy, lhs, m_poseCandidates[rhs].energy, rhs);
+  }
+};
+
+}
+
+namespace grove {
+
+//#################### CONSTRUCTORS ####################
+
+PreemptiveRansac_CPU::PreemptiveRansac_CPU(uint32_t maxCandidateCount, uint32_t maxAttemptsPerCandidate, uint32_t batchSize,
+                                           float minSquaredDistanceBetweenSampledPoints, float maxTranslationError, bool useAllModes, uint32_t rngSeed)
+: PreemptiveRansac(maxCandidateCount, maxAttemptsPerCandidate, batchSize, minSquaredDistanceBetweenSampledPoints, maxTranslationError, useAllModes, rngSeed)
+{
+  itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
+  m_rngs = mbf.make_block<CPURNG>(std::max(maxCandidateCount, batchSize));
+  reinit_rngs();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void PreemptiveRansac_CPU::compute_candidate_energies(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions,
+                                                      uint32_t survivingCandidateCount)
+{
+  const int *inlierRasterIndices = m_inlierRasterIndices->GetData(MEMORYDEVICE_CPU);
+  const Keypoint3DColour *keypointsPtr = keypoints.GetData(MEMORYDEVICE_CPU);
+  PoseCandidate *poseCandidates = m_poseCandidates->GetData(MEMORYDEVICE_CPU);
+  const ScorePrediction *predictionsPtr = predictions.GetData(MEMORYDEVICE_CPU);
+  const int *survivingCandidateIndices = m_survivingCandidateIndices->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < static_cast<int>(survivingCandidateCount); ++i)
+  {
+    evaluate_pose_candidate(poseCandidates[survivingCandidateIndices[i]], keypointsPtr, predictionsPtr, inlierRasterIndices, static_cast<int>(m_batchSize));
+  }
+}
+
+uint32_t PreemptiveRansac_CPU::find_valid_candidates()
+{
+  const PoseCandidate *poseCandidates = m_poseCandidates->GetData(MEMORYDEVICE_CPU);
+  int *survivingCandidateIndices = m_survivingCandidateIndices->GetData(MEMORYDEVICE_CPU);
+
+  uint32_t validCandidateCount = 0;
+  for(int i = 0; i < static_cast<int>(m_maxCandidateCount); ++i)
+  {
+    if(poseCandidates[i].valid) survivingCandidateIndices[validCandidateCount++] = i;
+  }
+
+  return validCandidateCount;
+}
+
+void PreemptiveRansac_CPU::generate_pose_candidates(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions)
+{
+  const Keypoint3DColour *keypointsPtr = keypoints.GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(keypoints.dataSize);
+  PoseCandidate *poseCandidates = m_poseCandidates->GetData(MEMORYDEVICE_CPU);
+  const ScorePrediction *predictionsPtr = predictions.GetData(MEMORYDEVICE_CPU);
+  CPURNG *rngs = m_rngs->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < static_cast<int>(m_maxCandidateCount); ++i)
+  {
+    generate_pose_candidate(
+      keypointsPtr, predictionsPtr, pixelCount, rngs[i], static_cast<int>(m_maxAttemptsPerCandidate),
+      m_useAllModes, m_minSquaredDistanceBetweenSampledPoints, m_maxTranslationError, poseCandidates[i]
+    );
+  }
+}
+
+void PreemptiveRansac_CPU::reinit_rngs()
+{
+  CPURNG *rngs = m_rngs->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0; i < m_rngs->dataSize; ++i)
+  {
+    rngs[i].reset(m_rngSeed + static_cast<unsigned int>(i));
+  }
+}
+
+void PreemptiveRansac_CPU::sample_inliers(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions)
+{
+  int *inlierRasterIndices = m_inlierRasterIndices->GetData(MEMORYDEVICE_CPU);
+  const Keypoint3DColour *keypointsPtr = keypoints.GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(keypoints.dataSize);
+  const ScorePrediction *predictionsPtr = predictions.GetData(MEMORYDEVICE_CPU);
+  CPURNG *rngs = m_rngs->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < static_cast<int>(m_batchSize); ++i)
+  {
+    inlierRasterIndices[i] = sample_valid_pixel(keypointsPtr, predictionsPtr, pixelCount, rngs[i]);
+  }
+}
+
+void PreemptiveRansac_CPU::sort_surviving_candidates(uint32_t survivingCandidateCount)
+{
+  int *survivingCandidateIndices = m_survivingCandidateIndices->GetData(MEMORYDEVICE_CPU);
+  std::sort(
+    survivingCandidateIndices, survivingCandidateIndices + survivingCandidateCount,
+    CandidateIndexComparator(m_poseCandidates->GetData(MEMORYDEVICE_CPU))
+  );
+}
+
+}
@@ -0,0 +1,283 @@
+/**
+ * grove: PreemptiveRansac_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "ransac/cuda/PreemptiveRansac_CUDA.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <stdexcept>
+
+#include <ORUtils/CUDADefines.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+
+#include "ransac/shared/PreemptiveRansac_Shared.h"
+#include "util/WarpAggregatedAtomics.h"
+
+namespace grove {
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of pose candidates that can be ranked by ck_sort_surviving_candidates (which runs within a single block). */
+#define PREEMPTIVE_RANSAC_MAX_SORTABLE_CANDIDATES 4096
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_compute_candidate_energies(PoseCandidate *poseCandidates, const int *survivingCandidateIndices, const Keypoint3DColour *keypoints,
+                                              const ScorePrediction *predictions, const int *inlierRasterIndices, int inlierCount)
+{
+  // Note: Each block evaluates one candidate, and each thread accumulates the energies of a strided subset of the inliers.
+  __shared__ float warpEnergies[32];
+
+  PoseCandidate& candidate = poseCandidates[survivingCandidateIndices[blockIdx.x]];
+  const Matrix4f cameraPose = candidate.cameraPose;
+
+  float energy = 0.0f;
+  for(int i = threadIdx.x; i < inlierCount; i += blockDim.x)
+  {
+    energy += compute_pixel_energy(cameraPose, keypoints, predictions, inlierRasterIndices[i]);
+  }
+
+  // Sum the energies within each warp using shuffles (the block size is a multiple of the warp size, so all of the lanes are active).
+  for(int offset = warpSize / 2; offset > 0; offset /= 2)
+  {
+    energy += __shfl_down_sync(0xffffffff, energy, offset);
+  }
+
+  const int laneIdx = threadIdx.x & (warpSize - 1);
+  const int warpIdx = threadIdx.x / warpSize;
+  if(laneIdx == 0) warpEnergies[warpIdx] = energy;
+
+  __syncthreads();
+
+  // Sum the per-warp totals in a fixed order (rather than using atomics), so that the energies are deterministic.
+  if(threadIdx.x == 0)
+  {
+    float blockEnergy = 0.0f;
+    for(int i = 0, warpCount = blockDim.x / warpSize; i < warpCount; ++i)
+    {
+      blockEnergy += warpEnergies[i];
+    }
+
+    candidate.energy += blockEnergy;
+  }
+}
+
+__global__ void ck_find_valid_candidates(const PoseCandidate *poseCandidates, int candidateCount, int *survivingCandidateIndices, int *validCandidateCount)
+{
+  const int tid = threadIdx.x + blockIdx.x * blockDim.x;
+  if(tid < candidateCount && poseCandidates[tid].valid)
+  {
+    survivingCandidateIndices[warp_aggregated_increment(validCandidateCount, 0)] = tid;
+  }
+}
+
+__global__ void ck_generate_pose_candidates(const Keypoint3DColour *keypoints, const ScorePrediction *predictions, int pixelCount, CUDARNG *rngs,
+                                            int candidateCount, int maxAttemptsPerCandidate, bool useAllModes, float minSquaredDistanceBetweenSampledPoints,
+                                            float maxTranslationError, PoseCandidate *poseCandidates)
+{
+  const int tid = threadIdx.x + blockIdx.x * blockDim.x;
+  if(tid < candidateCount)
+  {
+    generate_pose_candidate(
+      keypoints, predictions, pixelCount, rngs[tid], maxAttemptsPerCandidate, useAllModes,
+      minSquaredDistanceBetweenSampledPoints, maxTranslationError, poseCandidates[tid]
+    );
+  }
+}
+
+__global__ void ck_sample_inliers(const Keypoint3DColour *keypoints, const ScorePrediction *predictions, int pixelCount, CUDARNG *rngs,
+                                  int inlierCount, int *inlierRasterIndices)
+{
+  const int tid = threadIdx.x + blockIdx.x * blockDim.x;
+  if(tid < inlierCount)
+  {
+    inlierRasterIndices[tid] = sample_valid_pixel(keypoints, predictions, pixelCount, rngs[tid]);
+  }
+}
+
+__global__ void ck_sort_surviving_candidates(const PoseCandidate *poseCandidates, int *survivingCandidateIndices, int survivingCandidateCount, int paddedCount)
+{
+  // Note: The candidates are ranked by a single block using a bitonic sort in shared memory. The list is padded to a power of two
+  //       with dummy entries that are ranked after all of the real candidates.
+  extern __shared__ float sharedMemory[];
+  float *energies = sharedMemory;
+  int *indices = reinterpret_cast<int*>(sharedMemory + paddedCount);
+
+  for(int i = threadIdx.x; i < paddedCount; i += blockDim.x)
+  {
+    if(i < survivingCandidateCount)
+    {
+      const int candidateIdx = survivingCandidateIndices[i];
+      energies[i] = poseCandidates[candidateIdx].energy;
+      indices[i] = candidateIdx;
+    }
+    else
+    {
+      energies[i] = FLT_MAX;
+      indices[i] = INT_MAX;
+    }
+  }
+
+  __syncthreads();
+
+  for(int k = 2; k <= paddedCount; k *= 2)
+  {
+    for(int j = k / 2; j > 0; j /= 2)
+    {
+      for(int i = threadIdx.x; i < paddedCount; i += blockDim.x)
+      {
+        const int partner = i ^ j;
+        if(partner > i)
+        {
+          const bool ascending = (i & k) == 0;
+          const bool swap = ascending ? pose_candidate_precedes(energies[partner], indices[partner], energies[i], indices[i])
+                                      : pose_candidate_precedes(energies[i], indices[i], energies[partner], indices[partner]);
+          if(swap)
+          {
+            const float energy = energies[i];
+            energies[i] = energies[partner];
+            energies[partner] = energy;
+
+            const int index = indices[i];
+            indices[i] = indices[partner];
+            indices[partner] = index;
+          }
+        }
+      }
+
+      __syncthreads();
+    }
+  }
+
+  for(int i = threadIdx.x; i < survivingCandidateCount; i += blockDim.x)
+  {
+    survivingCandidateIndices[i] = indices[i];
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+PreemptiveRansac_CUDA::PreemptiveRansac_CUDA(uint32_t maxCandidateCount, uint32_t maxAttemptsPerCandidate, uint32_t batchSize,
+                                             float minSquaredDistanceBetweenSampledPoints, float maxTranslationError, bool useAllModes, uint32_t rngSeed)
+: PreemptiveRansac(maxCandidateCount, maxAttemptsPerCandidate, batchSize, minSquaredDistanceBetweenSampledPoints, maxTranslationError, useAllModes, rngSeed)
+{
+  if(maxCandidateCount > PREEMPTIVE_RANSAC_MAX_SORTABLE_CANDIDATES)
+  {
+    throw std::invalid_argument("Error: Too many pose candidates for the CUDA implementation of preemptive RANSAC");
+  }
+
+  itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
+  m_rngs = mbf.make_block<CUDARNG>(std::max(maxCandidateCount, batchSize));
+  m_validCandidateCount = mbf.make_block<int>(1);
+  reinit_rngs();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void PreemptiveRansac_CUDA::compute_candidate_energies(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions,
+                                                       uint32_t survivingCandidateCount)
+{
+  // Note: We use one block per surviving candidate (the block size must be a multiple of the warp size).
+  dim3 blockSize(128);
+  dim3 gridSize(survivingCandidateCount);
+
+  ck_compute_candidate_energies<<<gridSize,blockSize>>>(
+    m_poseCandidates->GetData(MEMORYDEVICE_CUDA),
+    m_survivingCandidateIndices->GetData(MEMORYDEVICE_CUDA),
+    keypoints.GetData(MEMORYDEVICE_CUDA),
+    predictions.GetData(MEMORYDEVICE_CUDA),
+    m_inlierRasterIndices->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_batchSize)
+  );
+  ORcudaKernelCheck;
+}
+
+uint32_t PreemptiveRansac_CUDA::find_valid_candidates()
+{
+  m_validCandidateCount->Clear();
+
+  dim3 blockSize(256);
+  dim3 gridSize((m_maxCandidateCount + blockSize.x - 1) / blockSize.x);
+
+  ck_find_valid_candidates<<<gridSize,blockSize>>>(
+    m_poseCandidates->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_maxCandidateCount),
+    m_survivingCandidateIndices->GetData(MEMORYDEVICE_CUDA),
+    m_validCandidateCount->GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+
+  m_validCandidateCount->UpdateHostFromDevice();
+  return static_cast<uint32_t>(*m_validCandidateCount->GetData(MEMORYDEVICE_CPU));
+}
+
+void PreemptiveRansac_CUDA::generate_pose_candidates(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions)
+{
+  dim3 blockSize(128);
+  dim3 gridSize((m_maxCandidateCount + blockSize.x - 1) / blockSize.x);
+
+  ck_generate_pose_candidates<<<gridSize,blockSize>>>(
+    keypoints.GetData(MEMORYDEVICE_CUDA),
+    predictions.GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(keypoints.dataSize),
+    m_rngs->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_maxCandidateCount),
+    static_cast<int>(m_maxAttemptsPerCandidate),
+    m_useAllModes,
+    m_minSquaredDistanceBetweenSampledPoints,
+    m_maxTranslationError,
+    m_poseCandidates->GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+void PreemptiveRansac_CUDA::reinit_rngs()
+{
+  const uint32_t rngCount = static_cast<uint32_t>(m_rngs->dataSize);
+
+  dim3 blockSize(256);
+  dim3 gridSize((rngCount + blockSize.x - 1) / blockSize.x);
+
+  ck_reinit_rngs<<<gridSize,blockSize>>>(m_rngs->GetData(MEMORYDEVICE_CUDA), rngCount, m_rngSeed);
+  ORcudaKernelCheck;
+}
+
+void PreemptiveRansac_CUDA::sample_inliers(const Keypoint3DColourImage& keypoints, const ScorePredictionsImage& predictions)
+{
+  dim3 blockSize(256);
+  dim3 gridSize((m_batchSize + blockSize.x - 1) / blockSize.x);
+
+  ck_sample_inliers<<<gridSize,blockSize>>>(
+    keypoints.GetData(MEMORYDEVICE_CUDA),
+    predictions.GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(keypoints.dataSize),
+    m_rngs->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_batchSize),
+    m_inlierRasterIndices->GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+void PreemptiveRansac_CUDA::sort_surviving_candidates(uint32_t survivingCandidateCount)
+{
+  int paddedCount = 1;
+  while(paddedCount < static_cast<int>(survivingCandidateCount)) paddedCount *= 2;
+
+  dim3 blockSize(512);
+  dim3 gridSize(1);
+  const size_t sharedMemorySize = paddedCount * (sizeof(float) + sizeof(int));
+
+  ck_sort_surviving_candidates<<<gridSize,blockSize,sharedMemorySize>>>(
+    m_poseCandidates->GetData(MEMORYDEVICE_CUDA),
+    m_survivingCandidateIndices->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(survivingCandidateCount),
+    paddedCount
+  );
+  ORcudaKernelCheck;
+}
+
+}
@@ -0,0 +1,89 @@
+/**
+ * grove: PreemptiveRansac.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "ransac/interface/PreemptiveRansac.h"
+
+#include <algorithm>
+
+#include <itmx/base/MemoryBlockFactory.h>
+
+namespace grove {
+
+//#################### CONSTRUCTORS ####################
+
+PreemptiveRansac::PreemptiveRansac(uint32_t maxCandidateCount, uint32_t maxAttemptsPerCandidate, uint32_t batchSize,
+                                   float minSquaredDistanceBetweenSampledPoints, float maxTranslationError, bool useAllModes, uint32_t rngSeed)
+: m_batchSize(batchSize),
+  m_maxAttemptsPerCandidate(maxAttemptsPerCandidate),
+  m_maxCandidateCount(maxCandidateCount),
+  m_maxTranslationError(maxTranslationError),
+  m_minSquaredDistanceBetweenSampledPoints(minSquaredDistanceBetweenSampledPoints),
+  m_rngSeed(rngSeed),
+  m_useAllModes(useAllModes)
+{
+  itmx::MemoryBlockFactory& mbf = itmx::MemoryBlockFactory::instance();
+  m_inlierRasterIndices = mbf.make_block<int>(batchSize);
+  m_poseCandidates = mbf.make_block<PoseCandidate>(maxCandidateCount);
+  m_survivingCandidateIndices = mbf.make_block<int>(maxCandidateCount);
+}
+
+//#################### DESTRUCTOR ####################
+
+PreemptiveRansac::~PreemptiveRansac() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+std::vector<PoseCandidate> PreemptiveRansac::estimate_poses(const Keypoint3DColourImage_CPtr& keypoints, const ScorePredictionsImage_CPtr& predictions,
+                                                            size_t maxResultCount)
+{
+  std::vector<PoseCandidate> result;
+  if(maxResultCount == 0) return result;
+
+  // Generate the pose candidates, and make a list of the ones that were successfully generated.
+  generate_pose_candidates(*keypoints, *predictions);
+  size_t survivingCandidateCount = find_valid_candidates();
+
+  // If no candidates could be generated, early out.
+  if(survivingCandidateCount == 0) return result;
+
+  // Repeatedly evaluate the surviving candidates against a new batch of pixels, and cull the worse half of them, until no more
+  // than the desired number of candidates remains. Note that we always evaluate the candidates against at least one batch,
+  // so that the energies of the candidates we return are meaningful, and that the final candidates are all evaluated against
+  // exactly the same pixels, so that their energies are directly comparable. Since the candidates are ranked in place, culling
+  // them just involves shortening the list, so nothing needs to be transferred between the host and the device until the end.
+  uint32_t evaluatedPixelCount = 0;
+  for(;;)
+  {
+    sample_inliers(*keypoints, *predictions);
+    compute_candidate_energies(*keypoints, *predictions, static_cast<uint32_t>(survivingCandidateCount));
+    evaluatedPixelCount += m_batchSize;
+    sort_surviving_candidates(static_cast<uint32_t>(survivingCandidateCount));
+
+    if(survivingCandidateCount <= maxResultCount) break;
+    survivingCandidateCount = std::max(maxResultCount, (survivingCandidateCount + 1) / 2);
+  }
+
+  // Return the surviving candidates, with their energies normalised by the number of pixels against which they were evaluated.
+  m_poseCandidates->UpdateHostFromDevice();
+  m_survivingCandidateIndices->UpdateHostFromDevice();
+
+  const PoseCandidate *poseCandidates = m_poseCandidates->GetData(MEMORYDEVICE_CPU);
+  const int *survivingCandidateIndices = m_survivingCandidateIndices->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0; i < survivingCandidateCount; ++i)
+  {
+    PoseCandidate candidate = poseCandidates[survivingCandidateIndices[i]];
+    candidate.energy /= evaluatedPixelCount;
+    result.push_back(candidate);
+  }
+
+  return result;
+}
+
+void PreemptiveRansac::reset()
+{
+  reinit_rngs();
+}
+
+}
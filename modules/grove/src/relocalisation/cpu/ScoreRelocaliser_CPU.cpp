@@ -0,0 +1,38 @@
+/**
+ * grove: ScoreRelocaliser_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/cpu/ScoreRelocaliser_CPU.h"
+using namespace itmx;
+
+#include "relocalisation/shared/ScoreRelocaliser_Shared.h"
+
+namespace grove {
+
+//#################### CONSTRUCTORS ####################
+
+ScoreRelocaliser_CPU::ScoreRelocaliser_CPU(const std::string& forestFilename, const Settings_CPtr& settings)
+: ScoreRelocaliser(forestFilename, settings)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ScoreRelocaliser_CPU::merge_predictions_for_keypoints() const
+{
+  const Keypoint3DColour *keypoints = m_keypointsImage->GetData(MEMORYDEVICE_CPU);
+  const Forest::LeafIndices *leafIndices = m_leafIndicesImage->GetData(MEMORYDEVICE_CPU);
+  const ScorePrediction *leafPredictions = m_leafPredictions->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(m_keypointsImage->dataSize);
+  ScorePrediction *predictions = m_predictionsImage->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int rasterIdx = 0; rasterIdx < pixelCount; ++rasterIdx)
+  {
+    merge_predictions_for_keypoint<Forest::TREE_COUNT>(rasterIdx, keypoints, leafIndices, leafPredictions, predictions);
+  }
+}
+
+}
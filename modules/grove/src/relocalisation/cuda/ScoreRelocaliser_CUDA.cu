@@ -0,0 +1,63 @@
+/**
+ * grove: ScoreRelocaliser_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/cuda/ScoreRelocaliser_CUDA.h"
+using namespace itmx;
+
+#include <ORUtils/CUDADefines.h>
+
+#include "relocalisation/shared/ScoreRelocaliser_Shared.h"
+#include "reservoirs/cuda/ExampleReservoirs_CUDA.tcu"
+
+namespace grove {
+
+//#################### EXPLICIT INSTANTIATIONS ####################
+
+// Note: The CUDA version of the reservoirs used by the relocaliser (see ScoreRelocaliser.cpp) must be instantiated here, since it can
+//       only be compiled by nvcc. The CUDA forests are instantiated in DecisionForest_CUDA.cu.
+template class ExampleReservoirs_CUDA<Keypoint3DColour>;
+template void ExampleReservoirs_CUDA<Keypoint3DColour>::add_examples_sub<5>(
+  const ExampleReservoirs_CUDA<Keypoint3DColour>::ExampleImage_CPtr& examples,
+  const boost::shared_ptr<const ORUtils::Image<ORUtils::VectorX<int,5> > >& reservoirIndices
+);
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_merge_predictions_for_keypoints(const Keypoint3DColour *keypoints, const ScoreRelocaliser::Forest::LeafIndices *leafIndices,
+                                                   const ScorePrediction *leafPredictions, int pixelCount, ScorePrediction *predictions)
+{
+  const int rasterIdx = threadIdx.x + blockIdx.x * blockDim.x;
+  if(rasterIdx < pixelCount)
+  {
+    merge_predictions_for_keypoint<ScoreRelocaliser::Forest::TREE_COUNT>(rasterIdx, keypoints, leafIndices, leafPredictions, predictions);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+ScoreRelocaliser_CUDA::ScoreRelocaliser_CUDA(const std::string& forestFilename, const Settings_CPtr& settings)
+: ScoreRelocaliser(forestFilename, settings)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ScoreRelocaliser_CUDA::merge_predictions_for_keypoints() const
+{
+  const int pixelCount = static_cast<int>(m_keypointsImage->dataSize);
+
+  dim3 blockSize(256);
+  dim3 gridSize((pixelCount + blockSize.x - 1) / blockSize.x);
+
+  ck_merge_predictions_for_keypoints<<<gridSize,blockSize>>>(
+    m_keypointsImage->GetData(MEMORYDEVICE_CUDA),
+    m_leafIndicesImage->GetData(MEMORYDEVICE_CUDA),
+    m_leafPredictions->GetData(MEMORYDEVICE_CUDA),
+    pixelCount,
+    m_predictionsImage->GetData(MEMORYDEVICE_CUDA)
+  );
+  ORcudaKernelCheck;
+}
+
+}
@@ -0,0 +1,353 @@
+/**
+ * grove: ScoreRelocaliser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/interface/ScoreRelocaliser.h"
+using namespace ITMLib;
+using namespace itmx;
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <itmx/base/MemoryBlockFactory.h>
+
+#include <tvgutil/numbers/SeedUtil.h>
+#include <tvgutil/persistence/BinaryBufferUtil.h>
+using namespace tvgutil;
+
+#include "clustering/ExampleClustererFactory.h"
+#include "features/FeatureCalculatorFactory.h"
+#include "forests/DecisionForestFactory.tpp"
+#include "forests/cpu/DecisionForest_CPU.tpp"
+#include "forests/interface/DecisionForest.tpp"
+#include "ransac/PreemptiveRansacFactory.h"
+#include "reservoirs/ExampleReservoirsFactory.tpp"
+#include "reservoirs/cpu/ExampleReservoirs_CPU.tpp"
+#include "reservoirs/interface/ExampleReservoirs.tpp"
+
+namespace {
+
+//#################### CONSTANTS ####################
+
+/** The signature at the start of a score relocaliser file. */
+const char *SIGNATURE = "SPTSCR01";
+
+/** The size (in bytes) of the signature at the start of a score relocaliser file. */
+const size_t SIGNATURE_SIZE = 8;
+
+}
+
+namespace grove {
+
+//#################### CONSTRUCTORS ####################
+
+ScoreRelocaliser::ScoreRelocaliser(const std::string& forestFilename, const Settings_CPtr& settings)
+{
+  const ITMLibSettings::DeviceType deviceType = settings->deviceType;
+
+  // Look up the parameters of the relocaliser.
+  static const std::string settingsNamespace = "ScoreRelocaliser.";
+  const bool bufferedReservoirInsertion = settings->get_first_value<bool>(settingsNamespace + "bufferedReservoirInsertion", true);
+  const float clustererSigma = settings->get_first_value<float>(settingsNamespace + "clustererSigma", 0.1f);
+  const float clustererTau = settings->get_first_value<float>(settingsNamespace + "clustererTau", 0.05f);
+  const uint32_t coarseFeatureStep = settings->get_first_value<uint32_t>(settingsNamespace + "coarseFeatureStep", 0);
+  const uint32_t featureStep = settings->get_first_value<uint32_t>(settingsNamespace + "featureStep", 4);
+  const uint32_t maxClusterCount = settings->get_first_value<uint32_t>(settingsNamespace + "maxClusterCount", SCORE_MAX_MODES);
+  const uint32_t minClusterSize = settings->get_first_value<uint32_t>(settingsNamespace + "minClusterSize", 20);
+  const uint32_t reservoirCapacity = settings->get_first_value<uint32_t>(settingsNamespace + "reservoirCapacity", 1024);
+  m_maxGoodPoseEnergy = settings->get_first_value<float>(settingsNamespace + "maxGoodPoseEnergy", 0.75f);
+  m_maxReservoirsToClusterPerUpdate = settings->get_first_value<uint32_t>(settingsNamespace + "maxReservoirsToClusterPerUpdate", 256);
+
+  const uint32_t ransacBatchSize = settings->get_first_value<uint32_t>(settingsNamespace + "ransacBatchSize", 500);
+  const uint32_t ransacMaxAttemptsPerCandidate = settings->get_first_value<uint32_t>(settingsNamespace + "ransacMaxAttemptsPerCandidate", 1000);
+  const uint32_t ransacMaxCandidateCount = settings->get_first_value<uint32_t>(settingsNamespace + "ransacMaxCandidateCount", 1024);
+  const float ransacMaxTranslationError = settings->get_first_value<float>(settingsNamespace + "ransacMaxTranslationError", 0.05f);
+  const float ransacMinSquaredDistance = settings->get_first_value<float>(settingsNamespace + "ransacMinSquaredDistanceBetweenSampledPoints", 0.3f * 0.3f);
+  const bool ransacUseAllModes = settings->get_first_value<bool>(settingsNamespace + "ransacUseAllModes", true);
+
+  // In deterministic mode, derive the seeds for the reservoirs and RANSAC from the global root seed.
+  m_deterministic = SeedUtil::is_deterministic(*settings);
+  const uint32_t ransacSeed = SeedUtil::get_deterministic_seed(*settings, settingsNamespace + "ransac").get_value_or(42);
+  const uint32_t reservoirSeed = SeedUtil::get_deterministic_seed(*settings, settingsNamespace + "reservoirs").get_value_or(42);
+
+  // Set up the components of the pipeline.
+  m_featureCalculator = FeatureCalculatorFactory::make_da_rgbd_patch_feature_calculator(deviceType);
+  m_featureCalculator->set_feature_step(featureStep);
+
+  // If requested, set up a second feature calculator to use for coarse-to-fine relocalisation. We only do this
+  // if the coarse step is actually larger than the normal one, since otherwise it would have no benefit.
+  if(coarseFeatureStep > featureStep)
+  {
+    m_coarseFeatureCalculator = FeatureCalculatorFactory::make_da_rgbd_patch_feature_calculator(deviceType);
+    m_coarseFeatureCalculator->set_feature_step(coarseFeatureStep);
+  }
+
+  m_forest = DecisionForestFactory<RGBDPatchDescriptor,5>::make_forest(forestFilename, deviceType);
+  m_reservoirs = ExampleReservoirsFactory<Keypoint3DColour>::make_reservoirs(
+    m_forest->get_nb_leaves(), reservoirCapacity, deviceType, reservoirSeed, m_deterministic, bufferedReservoirInsertion
+  );
+  m_clusterer = ExampleClustererFactory::make_example_clusterer(deviceType, clustererSigma, clustererTau, maxClusterCount, minClusterSize);
+  m_ransac = PreemptiveRansacFactory::make_preemptive_ransac(
+    deviceType, ransacMaxCandidateCount, ransacMaxAttemptsPerCandidate, ransacBatchSize,
+    ransacMinSquaredDistance, ransacMaxTranslationError, ransacUseAllModes, ransacSeed
+  );
+
+  // Allocate the images and memory blocks used during training and relocalisation. The images are resized as necessary.
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  const uint32_t reservoirCount = m_reservoirs->get_reservoir_count();
+  m_descriptorsImage = mbf.make_image<RGBDPatchDescriptor>(Vector2i(0, 0), "ScoreRelocaliser");
+  m_dirtyReservoirIndices = mbf.make_block<int>(reservoirCount, "ScoreRelocaliser");
+  m_keypointIndices = mbf.make_block<int>(0, "ScoreRelocaliser");
+  m_keypointsImage = mbf.make_image<Keypoint3DColour>(Vector2i(0, 0), "ScoreRelocaliser");
+  m_leafIndicesImage = mbf.make_image<Forest::LeafIndices>(Vector2i(0, 0), "ScoreRelocaliser");
+  m_leafPredictions = mbf.make_block<ScorePrediction>(reservoirCount, "ScoreRelocaliser");
+  m_predictionsImage = mbf.make_image<ScorePrediction>(Vector2i(0, 0), "ScoreRelocaliser");
+  m_reservoirsToCluster = mbf.make_block<int>(m_maxReservoirsToClusterPerUpdate, "ScoreRelocaliser");
+
+  // Start with no predictions and no reservoirs awaiting clustering.
+  m_leafPredictions->Clear();
+  m_pendingReservoirFlags.resize(reservoirCount, false);
+}
+
+//#################### DESTRUCTOR ####################
+
+ScoreRelocaliser::~ScoreRelocaliser() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ScoreRelocaliser::load_from_disk(const std::string& path)
+{
+  // Memory-map the file, so that only the bytes we actually need are read in.
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(path);
+  }
+  catch(std::exception&)
+  {
+    throw std::runtime_error("Error: Could not open score relocaliser file " + path);
+  }
+
+  const unsigned char *data = reinterpret_cast<const unsigned char*>(file.data());
+  const unsigned char *end = data + file.size();
+  const std::runtime_error corruptError("Error: Score relocaliser file " + path + " is corrupt");
+
+  // Check the header, and make sure that the saved reservoirs have the same shape as ours.
+  if(file.size() < SIGNATURE_SIZE || memcmp(data, SIGNATURE, SIGNATURE_SIZE) != 0)
+  {
+    throw std::runtime_error("Error: " + path + " is not a score relocaliser file");
+  }
+
+  const unsigned char *p = data + SIGNATURE_SIZE;
+  uint32_t header[3];
+  if(!BinaryBufferUtil::read_values(p, end, header, 3)) throw corruptError;
+
+  const uint32_t reservoirCount = header[0], reservoirCapacity = header[1], addExamplesCallCount = header[2];
+  if(reservoirCount != m_reservoirs->get_reservoir_count() || reservoirCapacity != m_reservoirs->get_reservoir_capacity())
+  {
+    throw std::runtime_error("Error: Score relocaliser file " + path + " was saved from a relocaliser with a different forest or reservoir capacity");
+  }
+
+  // Read in the reservoirs and the leaf predictions.
+  std::vector<Reservoirs::StoredExampleType> reservoirs(static_cast<size_t>(reservoirCount) * reservoirCapacity);
+  std::vector<int> reservoirSizes(reservoirCount), reservoirAddCalls(reservoirCount);
+  std::vector<ScorePrediction> leafPredictions(reservoirCount);
+  if(!BinaryBufferUtil::read_values(p, end, reservoirs.empty() ? NULL : &reservoirs[0], reservoirs.size()) ||
+     !BinaryBufferUtil::read_values(p, end, reservoirSizes.empty() ? NULL : &reservoirSizes[0], reservoirSizes.size()) ||
+     !BinaryBufferUtil::read_values(p, end, reservoirAddCalls.empty() ? NULL : &reservoirAddCalls[0], reservoirAddCalls.size()) ||
+     !BinaryBufferUtil::read_values(p, end, leafPredictions.empty() ? NULL : &leafPredictions[0], leafPredictions.size()) ||
+     p != end)
+  {
+    throw corruptError;
+  }
+
+  for(uint32_t i = 0; i < reservoirCount; ++i)
+  {
+    if(reservoirSizes[i] < 0 || static_cast<uint32_t>(reservoirSizes[i]) > reservoirCapacity) throw corruptError;
+  }
+
+  // Replace the contents of the relocaliser. The leaf predictions are restored as well as the reservoirs, so that the
+  // relocaliser can be used straight away, rather than only once all of the reservoirs have been clustered again.
+  reset();
+  m_reservoirs->set_contents(reservoirs, reservoirSizes, reservoirAddCalls, addExamplesCallCount);
+
+  if(reservoirCount > 0)
+  {
+    std::copy(leafPredictions.begin(), leafPredictions.end(), m_leafPredictions->GetData(MEMORYDEVICE_CPU));
+    m_leafPredictions->UpdateDeviceFromHost();
+  }
+
+  // Any reservoirs that had changed since they were last clustered were not recorded when the contents were saved, so queue
+  // all of the non-empty reservoirs for clustering. Until they are clustered, the restored predictions are used instead.
+  for(uint32_t i = 0; i < reservoirCount; ++i)
+  {
+    if(reservoirSizes[i] > 0)
+    {
+      m_pendingReservoirFlags[i] = true;
+      m_pendingReservoirs.push_back(static_cast<int>(i));
+    }
+  }
+}
+
+boost::optional<Relocaliser::Result> ScoreRelocaliser::relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                                  const Vector4f& depthIntrinsics) const
+{
+  std::vector<Result> results = relocalise_candidates(colourImage, depthImage, depthIntrinsics, 1);
+  if(results.empty()) return boost::none;
+  else return results[0];
+}
+
+std::vector<Relocaliser::Result> ScoreRelocaliser::relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                                         const Vector4f& depthIntrinsics, size_t maxCandidateCount) const
+{
+  // If coarse-to-fine relocalisation is enabled, first try to relocalise using the coarse keypoints. If that produces a good pose,
+  // we can avoid the full-resolution pass entirely. Otherwise, we fall back to it, so the worst-case accuracy is unaffected.
+  if(m_coarseFeatureCalculator)
+  {
+    std::vector<Result> results = estimate_pose_candidates(m_coarseFeatureCalculator, colourImage, depthImage, depthIntrinsics, maxCandidateCount);
+    if(!results.empty() && results[0].quality == RELOCALISATION_GOOD) return results;
+  }
+
+  return estimate_pose_candidates(m_featureCalculator, colourImage, depthImage, depthIntrinsics, maxCandidateCount);
+}
+
+void ScoreRelocaliser::reset()
+{
+  m_reservoirs->reset();
+  m_leafPredictions->Clear();
+  m_pendingReservoirs.clear();
+  std::fill(m_pendingReservoirFlags.begin(), m_pendingReservoirFlags.end(), false);
+  m_ransac->reset();
+}
+
+void ScoreRelocaliser::save_to_disk(const std::string& path) const
+{
+  std::vector<Reservoirs::StoredExampleType> reservoirs;
+  std::vector<int> reservoirSizes, reservoirAddCalls;
+  uint32_t addExamplesCallCount;
+  m_reservoirs->get_contents(reservoirs, reservoirSizes, reservoirAddCalls, addExamplesCallCount);
+
+  // Write the header (the signature, followed by the shape of the reservoirs and the number of calls to add_examples).
+  std::vector<unsigned char> buffer(SIGNATURE, SIGNATURE + SIGNATURE_SIZE);
+  const uint32_t header[] = { m_reservoirs->get_reservoir_count(), m_reservoirs->get_reservoir_capacity(), addExamplesCallCount };
+  BinaryBufferUtil::append_values(header, 3, buffer);
+
+  // Write the reservoirs and the leaf predictions.
+  m_leafPredictions->UpdateHostFromDevice();
+  BinaryBufferUtil::append_values(reservoirs.empty() ? NULL : &reservoirs[0], reservoirs.size(), buffer);
+  BinaryBufferUtil::append_values(reservoirSizes.empty() ? NULL : &reservoirSizes[0], reservoirSizes.size(), buffer);
+  BinaryBufferUtil::append_values(reservoirAddCalls.empty() ? NULL : &reservoirAddCalls[0], reservoirAddCalls.size(), buffer);
+  BinaryBufferUtil::append_values(m_leafPredictions->GetData(MEMORYDEVICE_CPU), m_reservoirs->get_reservoir_count(), buffer);
+
+  std::ofstream fs(path.c_str(), std::ios::binary);
+  if(!fs || !fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size()))
+  {
+    throw std::runtime_error("Error: Could not write score relocaliser file " + path);
+  }
+}
+
+void ScoreRelocaliser::train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                             const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose)
+{
+  // Extract keypoints (in world coordinates) and descriptors from the images. Note that the pose we are given
+  // is a transformation from world coordinates to camera coordinates, so we need to pass in its inverse.
+  const uint32_t keypointCount = m_featureCalculator->compute_sparse_keypoints_and_features(
+    colourImage, depthImage, cameraPose.GetInvM(), depthIntrinsics, m_keypointsImage.get(), m_descriptorsImage.get(), m_keypointIndices.get()
+  );
+
+  if(keypointCount == 0) return;
+
+  // Find the leaves reached by the valid keypoints, and add the keypoints to the corresponding reservoirs
+  // (invalid keypoints are skipped by the reservoirs, so their leaf indices do not need to be valid).
+  m_forest->find_leaves(m_descriptorsImage, m_keypointIndices, keypointCount, m_leafIndicesImage);
+  m_reservoirs->add_examples(m_keypointsImage, m_leafIndicesImage);
+}
+
+void ScoreRelocaliser::update()
+{
+  // Add any reservoirs that have changed since the last update to the back of the queue of reservoirs awaiting clustering
+  // (unless they are already in it, in which case they will be clustered when they reach the front).
+  const uint32_t dirtyReservoirCount = m_reservoirs->fetch_dirty_reservoirs(m_dirtyReservoirIndices);
+  if(dirtyReservoirCount > 0)
+  {
+    m_dirtyReservoirIndices->UpdateHostFromDevice();
+    int *dirtyReservoirIndices = m_dirtyReservoirIndices->GetData(MEMORYDEVICE_CPU);
+
+    // The order in which the dirty reservoirs are fetched depends on thread scheduling, so in deterministic mode
+    // we sort them to make sure that they are always clustered in the same order.
+    if(m_deterministic) std::sort(dirtyReservoirIndices, dirtyReservoirIndices + dirtyReservoirCount);
+
+    for(uint32_t i = 0; i < dirtyReservoirCount; ++i)
+    {
+      const int reservoirIdx = dirtyReservoirIndices[i];
+      if(!m_pendingReservoirFlags[reservoirIdx])
+      {
+        m_pendingReservoirFlags[reservoirIdx] = true;
+        m_pendingReservoirs.push_back(reservoirIdx);
+      }
+    }
+  }
+
+  // Cluster the reservoirs at the front of the queue, up to the per-update limit, to refresh their predictions.
+  const uint32_t reservoirCount = static_cast<uint32_t>(std::min<size_t>(m_pendingReservoirs.size(), m_maxReservoirsToClusterPerUpdate));
+  if(reservoirCount == 0) return;
+
+  int *reservoirsToCluster = m_reservoirsToCluster->GetData(MEMORYDEVICE_CPU);
+  for(uint32_t i = 0; i < reservoirCount; ++i)
+  {
+    const int reservoirIdx = m_pendingReservoirs.front();
+    m_pendingReservoirs.pop_front();
+    m_pendingReservoirFlags[reservoirIdx] = false;
+    reservoirsToCluster[i] = reservoirIdx;
+  }
+  m_reservoirsToCluster->UpdateDeviceFromHost();
+
+  m_clusterer->cluster_reservoirs(
+    m_reservoirs->get_reservoirs(), m_reservoirs->get_reservoir_sizes(), m_reservoirsToCluster, reservoirCount, m_leafPredictions
+  );
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+std::vector<Relocaliser::Result> ScoreRelocaliser::estimate_pose_candidates(const DA_RGBDPatchFeatureCalculator_Ptr& featureCalculator,
+                                                                            const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                                            const Vector4f& depthIntrinsics, size_t maxCandidateCount) const
+{
+  std::vector<Result> results;
+
+  // Extract keypoints (in camera coordinates) and descriptors from the images, and find the leaves that they reach.
+  Matrix4f identity;
+  identity.setIdentity();
+  const uint32_t keypointCount = featureCalculator->compute_sparse_keypoints_and_features(
+    colourImage, depthImage, identity, depthIntrinsics, m_keypointsImage.get(), m_descriptorsImage.get(), m_keypointIndices.get()
+  );
+
+  // If there are too few valid keypoints to generate a pose candidate, early out.
+  if(keypointCount < 3) return results;
+
+  m_forest->find_leaves(m_descriptorsImage, m_keypointIndices, keypointCount, m_leafIndicesImage);
+
+  // Merge the predictions of the leaves reached by each keypoint.
+  m_predictionsImage->ChangeDims(m_keypointsImage->noDims, false);
+  merge_predictions_for_keypoints();
+
+  // Estimate the camera pose using preemptive RANSAC. Note that the candidate poses are transformations from camera
+  // coordinates to world coordinates, whereas the relocaliser's results are expected to be the other way round.
+  const std::vector<PoseCandidate> candidates = m_ransac->estimate_poses(m_keypointsImage, m_predictionsImage, maxCandidateCount);
+  for(size_t i = 0, size = candidates.size(); i < size; ++i)
+  {
+    Result result;
+    result.pose.SetInvM(candidates[i].cameraPose);
+    result.quality = candidates[i].energy <= m_maxGoodPoseEnergy ? RELOCALISATION_GOOD : RELOCALISATION_POOR;
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+}
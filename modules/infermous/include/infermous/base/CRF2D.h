@@ -73,6 +73,16 @@ public:
     return m_height;
   }
 
+  /**
+   * \brief Gets the grid of marginal probabilities.
+   *
+   * \return  The grid of marginal probabilities.
+   */
+  const ProbabilitiesGrid& get_marginals() const
+  {
+    return *m_marginals;
+  }
+
   /**
    * \brief Gets the marginal probabilities for the specified location.
    *
@@ -94,6 +104,16 @@ public:
     return m_pairwisePotentialCalculator;
   }
 
+  /**
+   * \brief Gets the grid of unary probabilities.
+   *
+   * \return  The grid of unary probabilities.
+   */
+  const ProbabilitiesGrid& get_unaries() const
+  {
+    return *m_unaries;
+  }
+
   /**
    * \brief Gets the unary probabilities for the specified location.
    *
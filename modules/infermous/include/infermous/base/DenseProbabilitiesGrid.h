@@ -0,0 +1,279 @@
+/**
+ * infermous: DenseProbabilitiesGrid.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_INFERMOUS_DENSEPROBABILITIESGRID
+#define H_INFERMOUS_DENSEPROBABILITIESGRID
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "Grids.h"
+
+namespace infermous {
+
+/**
+ * \brief An instance of an instantiation of this class template represents a 2D grid of label probabilities that are stored densely.
+ *
+ * The probabilities are stored in a contiguous [height][width][labelCount] array of floats, together with a mapping between
+ * the labels and their indices in the innermost dimension. Unlike a ProbabilitiesGrid, in which each pixel has its own map,
+ * this can be processed efficiently (and in parallel) on both the CPU and the GPU.
+ */
+template <typename Label>
+class DenseProbabilitiesGrid
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The height of the grid. */
+  int m_height;
+
+  /** A map from labels to their indices in the innermost dimension of the grid. */
+  std::map<Label,int> m_labelIndices;
+
+  /** The labels whose probabilities are stored in the grid, in index order. */
+  std::vector<Label> m_labels;
+
+  /** The probabilities, stored in row-major order, with the probabilities for each pixel stored contiguously. */
+  std::vector<float> m_values;
+
+  /** The width of the grid. */
+  int m_width;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a dense probabilities grid for the labels that appear anywhere in the specified (sparse) probabilities grid.
+   *
+   * The grid is initialised with the probabilities from the sparse grid. Labels that do not appear for a given pixel
+   * in the sparse grid are given a probability of zero for that pixel.
+   *
+   * \param grid  The sparse probabilities grid.
+   */
+  explicit DenseProbabilitiesGrid(const ProbabilitiesGrid<Label>& grid)
+  : m_height(static_cast<int>(grid.rows())), m_width(static_cast<int>(grid.cols()))
+  {
+    // Find all of the labels that appear in the sparse grid, and assign them indices in ascending label order.
+    std::set<Label> labels;
+    for(int y = 0; y < m_height; ++y)
+    {
+      for(int x = 0; x < m_width; ++x)
+      {
+        const std::map<Label,float>& probabilities = grid(y, x);
+        for(typename std::map<Label,float>::const_iterator it = probabilities.begin(), iend = probabilities.end(); it != iend; ++it)
+        {
+          labels.insert(it->first);
+        }
+      }
+    }
+
+    for(typename std::set<Label>::const_iterator it = labels.begin(), iend = labels.end(); it != iend; ++it)
+    {
+      m_labelIndices.insert(std::make_pair(*it, static_cast<int>(m_labels.size())));
+      m_labels.push_back(*it);
+    }
+
+    m_values.resize(m_height * m_width * m_labels.size());
+    load(grid);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the index of the specified label in the innermost dimension of the grid, if any.
+   *
+   * \param label The label.
+   * \return      The index of the label, if it is stored in the grid, or -1 otherwise.
+   */
+  int find_label_index(const Label& label) const
+  {
+    typename std::map<Label,int>::const_iterator it = m_labelIndices.find(label);
+    return it != m_labelIndices.end() ? it->second : -1;
+  }
+
+  /**
+   * \brief Gets the probabilities for all of the pixels in the grid.
+   *
+   * \return  A pointer to the contiguous [height][width][labelCount] array of probabilities.
+   */
+  float *get_data()
+  {
+    return m_values.empty() ? NULL : &m_values[0];
+  }
+
+  /**
+   * \brief Gets the probabilities for all of the pixels in the grid.
+   *
+   * \return  A pointer to the contiguous [height][width][labelCount] array of probabilities.
+   */
+  const float *get_data() const
+  {
+    return m_values.empty() ? NULL : &m_values[0];
+  }
+
+  /**
+   * \brief Gets the height of the grid.
+   *
+   * \return  The height of the grid.
+   */
+  int get_height() const
+  {
+    return m_height;
+  }
+
+  /**
+   * \brief Gets the number of labels whose probabilities are stored for each pixel.
+   *
+   * \return  The number of labels whose probabilities are stored for each pixel.
+   */
+  int get_label_count() const
+  {
+    return static_cast<int>(m_labels.size());
+  }
+
+  /**
+   * \brief Gets the labels whose probabilities are stored in the grid.
+   *
+   * \return  The labels whose probabilities are stored in the grid, in index order.
+   */
+  const std::vector<Label>& get_labels() const
+  {
+    return m_labels;
+  }
+
+  /**
+   * \brief Gets the width of the grid.
+   *
+   * \return  The width of the grid.
+   */
+  int get_width() const
+  {
+    return m_width;
+  }
+
+  /**
+   * \brief Replaces the probabilities in the grid with those from the specified (sparse) probabilities grid.
+   *
+   * \param grid                    The sparse probabilities grid.
+   * \throws std::invalid_argument  If the sparse grid has a different size or contains labels that are not stored in the grid.
+   */
+  void load(const ProbabilitiesGrid<Label>& grid)
+  {
+    if(grid.rows() != m_height || grid.cols() != m_width) throw std::invalid_argument("Error: The probabilities grids have different sizes");
+
+    if(m_labels.empty()) return;
+
+    std::fill(m_values.begin(), m_values.end(), 0.0f);
+    for(int y = 0; y < m_height; ++y)
+    {
+      for(int x = 0; x < m_width; ++x)
+      {
+        float *values = (*this)(y, x);
+        const std::map<Label,float>& probabilities = grid(y, x);
+        for(typename std::map<Label,float>::const_iterator it = probabilities.begin(), iend = probabilities.end(); it != iend; ++it)
+        {
+          int k = find_label_index(it->first);
+          if(k == -1) throw std::invalid_argument("Error: The probabilities grid contains a label that is not stored in the dense grid");
+          values[k] = it->second;
+        }
+      }
+    }
+  }
+
+  /**
+   * \brief Makes a dense array of potentials -log(p) from the probabilities in the specified (sparse) probabilities grid.
+   *
+   * Labels that do not appear for a given pixel in the sparse grid are given an infinite potential for that pixel.
+   *
+   * \param grid                    The sparse probabilities grid.
+   * \return                        The potentials, stored in the same [height][width][labelCount] layout as the grid's probabilities.
+   * \throws std::invalid_argument  If the sparse grid has a different size or contains labels that are not stored in the grid.
+   */
+  std::vector<float> make_potentials(const ProbabilitiesGrid<Label>& grid) const
+  {
+    if(grid.rows() != m_height || grid.cols() != m_width) throw std::invalid_argument("Error: The probabilities grids have different sizes");
+
+    const int labelCount = get_label_count();
+    std::vector<float> potentials(m_values.size(), std::numeric_limits<float>::infinity());
+    if(labelCount == 0) return potentials;
+
+    for(int y = 0; y < m_height; ++y)
+    {
+      for(int x = 0; x < m_width; ++x)
+      {
+        float *pixelPotentials = &potentials[0] + (y * m_width + x) * labelCount;
+        const std::map<Label,float>& probabilities = grid(y, x);
+        for(typename std::map<Label,float>::const_iterator it = probabilities.begin(), iend = probabilities.end(); it != iend; ++it)
+        {
+          int k = find_label_index(it->first);
+          if(k == -1) throw std::invalid_argument("Error: The probabilities grid contains a label that is not stored in the dense grid");
+          pixelPotentials[k] = -logf(it->second);
+        }
+      }
+    }
+
+    return potentials;
+  }
+
+  /**
+   * \brief Writes the probabilities in the grid into the specified (sparse) probabilities grid.
+   *
+   * Only the probabilities of those labels that appear for each pixel in the specified reference grid are written.
+   *
+   * \param reference               The sparse grid specifying the labels to write for each pixel.
+   * \param grid                    The sparse grid into which to write the probabilities (this must have the same size as the reference grid).
+   * \throws std::invalid_argument  If the reference grid has a different size or contains labels that are not stored in the grid.
+   */
+  void save(const ProbabilitiesGrid<Label>& reference, ProbabilitiesGrid<Label>& grid) const
+  {
+    if(reference.rows() != m_height || reference.cols() != m_width) throw std::invalid_argument("Error: The probabilities grids have different sizes");
+
+    for(int y = 0; y < m_height; ++y)
+    {
+      for(int x = 0; x < m_width; ++x)
+      {
+        const std::map<Label,float>& labels = reference(y, x);
+        std::map<Label,float>& probabilities = grid(y, x);
+        for(typename std::map<Label,float>::const_iterator it = labels.begin(), iend = labels.end(); it != iend; ++it)
+        {
+          int k = find_label_index(it->first);
+          if(k == -1) throw std::invalid_argument("Error: The probabilities grid contains a label that is not stored in the dense grid");
+          probabilities[it->first] = (*this)(y, x)[k];
+        }
+      }
+    }
+  }
+
+  /**
+   * \brief Gets the probabilities for the specified pixel.
+   *
+   * \param y The y coordinate of the pixel.
+   * \param x The x coordinate of the pixel.
+   * \return  A pointer to the probabilities for the pixel (one per label, in index order).
+   */
+  float *operator()(int y, int x)
+  {
+    return &m_values[(y * m_width + x) * m_labels.size()];
+  }
+
+  /**
+   * \brief Gets the probabilities for the specified pixel.
+   *
+   * \param y The y coordinate of the pixel.
+   * \param x The x coordinate of the pixel.
+   * \return  A pointer to the probabilities for the pixel (one per label, in index order).
+   */
+  const float *operator()(int y, int x) const
+  {
+    return &m_values[(y * m_width + x) * m_labels.size()];
+  }
+};
+
+}
+
+#endif
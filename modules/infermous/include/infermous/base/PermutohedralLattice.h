@@ -0,0 +1,85 @@
+/**
+ * infermous: PermutohedralLattice.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_INFERMOUS_PERMUTOHEDRALLATTICE
+#define H_INFERMOUS_PERMUTOHEDRALLATTICE
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace infermous {
+
+/**
+ * \brief An instance of this class can be used to perform fast high-dimensional Gaussian filtering using a permutohedral lattice.
+ *
+ * Given a set of points with (suitably scaled) feature vectors f_i, filtering a set of values v_i computes (approximately)
+ * v'_i = \sum_j exp(-|f_i - f_j|^2 / 2) * v_j in time that is linear in the number of points. The points are "splatted"
+ * onto the vertices of the enclosing simplices of a permutohedral lattice, the lattice is blurred along each of its axes,
+ * and the result is "sliced" back out at the points. See "Fast High-Dimensional Filtering Using the Permutohedral Lattice"
+ * (Adams et al., Eurographics 2010) for details.
+ *
+ * The lattice is built once for a given set of features, and can then be used to filter many sets of values.
+ */
+class PermutohedralLattice
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The barycentric weights of the lattice vertices that enclose each point ((d+1) per point). */
+  std::vector<float> m_barycentricWeights;
+
+  /** The indices of the two neighbours of each lattice vertex along each of the d+1 lattice axes (-1 if absent). */
+  std::vector<int> m_blurNeighbours;
+
+  /** The dimensionality of the feature space (d). */
+  int m_featureDims;
+
+  /** The number of points. */
+  int m_pointCount;
+
+  /** The number of lattice vertices onto which the points have been splatted. */
+  int m_vertexCount;
+
+  /** The indices of the lattice vertices that enclose each point ((d+1) per point). */
+  std::vector<int> m_vertexIndices;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a permutohedral lattice for the specified set of points.
+   *
+   * \param features                The (pre-scaled) feature vectors of the points, stored contiguously (featureDims per point).
+   * \param featureDims             The dimensionality of the feature space.
+   * \throws std::invalid_argument  If featureDims is not positive, or the number of features is not a multiple of it.
+   */
+  PermutohedralLattice(const std::vector<float>& features, int featureDims);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Filters a set of values using the lattice.
+   *
+   * \param in        The values to filter, stored contiguously (valueDims per point).
+   * \param valueDims The number of values for each point.
+   * \param out       An array into which to write the filtered values (valueDims per point). This may not alias in.
+   */
+  void filter(const float *in, int valueDims, float *out) const;
+
+  /**
+   * \brief Gets the number of points.
+   *
+   * \return  The number of points.
+   */
+  int get_point_count() const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<PermutohedralLattice> PermutohedralLattice_Ptr;
+typedef boost::shared_ptr<const PermutohedralLattice> PermutohedralLattice_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,265 @@
+/**
+ * infermous: DenseCRFInferenceEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_INFERMOUS_DENSECRFINFERENCEENGINE
+#define H_INFERMOUS_DENSECRFINFERENCEENGINE
+
+#include <stdexcept>
+#include <vector>
+
+#include "../base/CRF2D.h"
+#include "../base/DenseProbabilitiesGrid.h"
+#include "../base/PermutohedralLattice.h"
+#include "shared/MeanFieldInferenceEngine_Shared.h"
+
+namespace infermous {
+
+/**
+ * \brief An instance of an instantiation of this class template can be used to run mean-field inference on a fully-connected 2D CRF.
+ *
+ * Unlike MeanFieldInferenceEngine, which only considers a fixed local neighbourhood around each pixel, this connects every
+ * pair of pixels i and j in the CRF, with a pairwise potential of the form phi_ij(L,L') = mu(L,L') * k(f_i,f_j), where
+ * mu(L,L') is given by the CRF's pairwise potential calculator and k is a weighted sum of two Gaussian kernels:
+ *
+ * - a bilateral (appearance) kernel over the positions and colours of the pixels, which encourages nearby pixels with
+ *   similar colours to take the same label;
+ * - a spatial (smoothness) kernel over the positions of the pixels alone, which removes small isolated regions.
+ *
+ * See "Efficient Inference in Fully Connected CRFs with Gaussian Edge Potentials" (Kraehenbuehl and Koltun, NIPS 2011).
+ * The messages that each pixel receives are computed by Gaussian filtering using permutohedral lattices, which makes
+ * the cost of each iteration roughly linear in the number of pixels. As in that paper's implementation, the messages
+ * are normalised by the total kernel weight at each pixel, and include the negligible contribution from the pixel itself.
+ */
+template <typename Label>
+class DenseCRFInferenceEngine
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef infermous::CRF2D_Ptr<Label> CRF2D_Ptr;
+  typedef infermous::CRF2D_CPtr<Label> CRF2D_CPtr;
+  typedef infermous::ProbabilitiesGrid<Label> ProbabilitiesGrid;
+  typedef infermous::ProbabilitiesGrid_Ptr<Label> ProbabilitiesGrid_Ptr;
+
+private:
+  typedef boost::shared_ptr<DenseProbabilitiesGrid<Label> > DenseProbabilitiesGrid_Ptr;
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct can be used to provide the settings needed to configure a dense CRF inference engine.
+   */
+  struct Settings
+  {
+    //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+    /** The standard deviation of the colour part of the bilateral kernel (in the units of the colours). */
+    float bilateralColourStdDev;
+
+    /** The standard deviation of the positional part of the bilateral kernel (in pixels). */
+    float bilateralSpatialStdDev;
+
+    /** The weight of the bilateral kernel. */
+    float bilateralWeight;
+
+    /** The standard deviation of the spatial kernel (in pixels). */
+    float spatialStdDev;
+
+    /** The weight of the spatial kernel. */
+    float spatialWeight;
+
+    //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
+
+    /**
+     * \brief Constructs a set of settings with the defaults used by Kraehenbuehl and Koltun (for colours in the range [0,255]).
+     */
+    Settings()
+    : bilateralColourStdDev(13.0f), bilateralSpatialStdDev(80.0f), bilateralWeight(10.0f), spatialStdDev(3.0f), spatialWeight(3.0f)
+    {}
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The lattice used to compute the messages for the bilateral kernel. */
+  PermutohedralLattice_CPtr m_bilateralLattice;
+
+  /** The reciprocals of the total weights of the bilateral kernel at each pixel. */
+  std::vector<float> m_bilateralNormalisers;
+
+  /** The CRF on which the inference engine works. */
+  CRF2D_Ptr m_crf;
+
+  /** The marginal probabilities, stored densely. */
+  DenseProbabilitiesGrid_Ptr m_denseMarginals;
+
+  /** A dense grid of updated marginal probabilities that will be swapped with m_denseMarginals at the end of each iteration. */
+  DenseProbabilitiesGrid_Ptr m_denseNewMarginals;
+
+  /** A grid of updated marginal probabilities that will be swapped with the grid in the CRF at the end of each call to update_crf. */
+  ProbabilitiesGrid_Ptr m_newMarginals;
+
+  /** The label compatibilities mu(L,L'), stored as a row-major labelCount x labelCount matrix. */
+  std::vector<float> m_pairwisePotentials;
+
+  /** The settings for the inference engine. */
+  Settings m_settings;
+
+  /** The lattice used to compute the messages for the spatial kernel. */
+  PermutohedralLattice_CPtr m_spatialLattice;
+
+  /** The reciprocals of the total weights of the spatial kernel at each pixel. */
+  std::vector<float> m_spatialNormalisers;
+
+  /** The unary potentials phi_i(L) = -log(psi_i(L)), stored densely (infinity for labels that a pixel cannot take). */
+  std::vector<float> m_unaryPotentials;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a dense CRF inference engine.
+   *
+   * \param crf                     The CRF on which the inference engine works.
+   * \param colours                 The colours of the pixels in the image over which the CRF is defined, in row-major order.
+   * \param settings                The settings for the inference engine.
+   * \throws std::invalid_argument  If the number of colours is not equal to the number of pixels in the CRF.
+   */
+  DenseCRFInferenceEngine(const CRF2D_Ptr& crf, const std::vector<Eigen::Vector3f>& colours, const Settings& settings = Settings())
+  : m_crf(crf),
+    m_denseMarginals(new DenseProbabilitiesGrid<Label>(crf->get_unaries())),
+    m_newMarginals(new ProbabilitiesGrid(crf->get_height(), crf->get_width())),
+    m_settings(settings)
+  {
+    const int width = crf->get_width(), height = crf->get_height();
+    if(static_cast<int>(colours.size()) != width * height)
+    {
+      throw std::invalid_argument("Error: The number of colours must be equal to the number of pixels in the CRF");
+    }
+
+    m_denseNewMarginals.reset(new DenseProbabilitiesGrid<Label>(*m_denseMarginals));
+
+    // Precompute the label compatibilities for every pair of labels.
+    const int labelCount = m_denseMarginals->get_label_count();
+    const std::vector<Label>& labels = m_denseMarginals->get_labels();
+    PairwisePotentialCalculator_CPtr<Label> pairwisePotentialCalculator = crf->get_pairwise_potential_calculator();
+    m_pairwisePotentials.resize(labelCount * labelCount);
+    for(int i = 0; i < labelCount; ++i)
+    {
+      for(int j = 0; j < labelCount; ++j)
+      {
+        m_pairwisePotentials[i * labelCount + j] = pairwisePotentialCalculator->calculate_potential(labels[i], labels[j]);
+      }
+    }
+
+    // Precompute the unary potentials for every pixel.
+    m_unaryPotentials = m_denseMarginals->make_potentials(crf->get_unaries());
+
+    // Build the lattices for the two kernels, scaling the features so that each kernel has unit standard deviation.
+    std::vector<float> bilateralFeatures, spatialFeatures;
+    bilateralFeatures.reserve(width * height * 5);
+    spatialFeatures.reserve(width * height * 2);
+    for(int y = 0; y < height; ++y)
+    {
+      for(int x = 0; x < width; ++x)
+      {
+        const Eigen::Vector3f& colour = colours[y * width + x];
+        bilateralFeatures.push_back(x / settings.bilateralSpatialStdDev);
+        bilateralFeatures.push_back(y / settings.bilateralSpatialStdDev);
+        for(int k = 0; k < 3; ++k) bilateralFeatures.push_back(colour[k] / settings.bilateralColourStdDev);
+
+        spatialFeatures.push_back(x / settings.spatialStdDev);
+        spatialFeatures.push_back(y / settings.spatialStdDev);
+      }
+    }
+
+    m_bilateralLattice.reset(new PermutohedralLattice(bilateralFeatures, 5));
+    m_spatialLattice.reset(new PermutohedralLattice(spatialFeatures, 2));
+    m_bilateralNormalisers = compute_normalisers(*m_bilateralLattice);
+    m_spatialNormalisers = compute_normalisers(*m_spatialLattice);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the CRF on which the inference engine works.
+   *
+   * \return  The CRF on which the inference engine works.
+   */
+  CRF2D_CPtr get_crf() const
+  {
+    return m_crf;
+  }
+
+  /**
+   * \brief Updates the CRF on which the inference engine works.
+   *
+   * \param iterations  The number of update iterations to run.
+   */
+  void update_crf(size_t iterations)
+  {
+    const int labelCount = m_denseMarginals->get_label_count();
+    const int pixelCount = m_crf->get_width() * m_crf->get_height();
+    if(iterations == 0 || labelCount == 0 || pixelCount == 0) return;
+
+    // Convert the current marginals in the CRF to dense form.
+    m_denseMarginals->load(m_crf->get_marginals());
+
+    std::vector<float> bilateralMessages(pixelCount * labelCount), spatialMessages(pixelCount * labelCount);
+    for(size_t i = 0; i < iterations; ++i)
+    {
+      // Compute the messages that each pixel receives from all of the other pixels by filtering the marginals.
+      m_bilateralLattice->filter(m_denseMarginals->get_data(), labelCount, &bilateralMessages[0]);
+      m_spatialLattice->filter(m_denseMarginals->get_data(), labelCount, &spatialMessages[0]);
+
+      // Combine the messages from the two kernels and compute the updated marginals.
+      float *newMarginals = m_denseNewMarginals->get_data();
+
+#ifdef WITH_OPENMP
+      #pragma omp parallel for
+#endif
+      for(int p = 0; p < pixelCount; ++p)
+      {
+        const float bilateralScale = m_settings.bilateralWeight * m_bilateralNormalisers[p];
+        const float spatialScale = m_settings.spatialWeight * m_spatialNormalisers[p];
+        float *m_i = &bilateralMessages[p * labelCount];
+        const float *s_i = &spatialMessages[p * labelCount];
+        for(int k = 0; k < labelCount; ++k) m_i[k] = bilateralScale * m_i[k] + spatialScale * s_i[k];
+
+        compute_updated_probabilities(labelCount, &m_unaryPotentials[p * labelCount], m_i, &m_pairwisePotentials[0], newMarginals + p * labelCount);
+      }
+
+      std::swap(m_denseMarginals, m_denseNewMarginals);
+    }
+
+    // Convert the updated marginals back to sparse form and swap them into the CRF.
+    m_denseMarginals->save(m_crf->get_unaries(), *m_newMarginals);
+    m_crf->swap_marginals(m_newMarginals);
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the reciprocals of the total weights of the kernel represented by the specified lattice at each pixel.
+   *
+   * \param lattice The lattice.
+   * \return        The reciprocals of the total kernel weights at each pixel.
+   */
+  static std::vector<float> compute_normalisers(const PermutohedralLattice& lattice)
+  {
+    const int pointCount = lattice.get_point_count();
+    std::vector<float> ones(pointCount, 1.0f), normalisers(pointCount);
+    if(pointCount == 0) return normalisers;
+
+    lattice.filter(&ones[0], 1, &normalisers[0]);
+    for(int i = 0; i < pointCount; ++i)
+    {
+      normalisers[i] = normalisers[i] > 0.0f ? 1.0f / normalisers[i] : 0.0f;
+    }
+
+    return normalisers;
+  }
+};
+
+}
+
+#endif
@@ -6,14 +6,31 @@
 #ifndef H_INFERMOUS_MEANFIELDINFERENCEENGINE
 #define H_INFERMOUS_MEANFIELDINFERENCEENGINE
 
+#include <stdexcept>
 #include <vector>
 
 #include "../base/CRF2D.h"
+#include "../base/DenseProbabilitiesGrid.h"
+#include "shared/MeanFieldInferenceEngine_Shared.h"
+
+#ifdef WITH_CUDA
+#include "cuda/MeanFieldUpdater_CUDA.h"
+#endif
 
 namespace infermous {
 
 /**
  * \brief An instance of an instantiation of this class template can be used to run mean-field inference on a 2D CRF.
+ *
+ * Internally, the engine works on dense [height][width][labelCount] arrays of potentials and probabilities rather than
+ * on the per-pixel maps stored in the CRF. The marginals are converted to dense form at the start of each call to
+ * update_crf, updated in parallel (using OpenMP on the CPU, or optionally CUDA) for the specified number of iterations,
+ * and then converted back and swapped into the CRF.
+ *
+ * When the engine is run on each frame of a video, consecutive CRFs tend to be highly correlated. In that case, the marginals
+ * of a new CRF can be warm-started from the converged marginals of the previous frame (see warm_start), and the CRF can then
+ * be updated only until its marginals stop changing (see update_crf_until_converged), which typically takes far fewer
+ * iterations than starting from the unaries each time.
  */
 template <typename Label>
 class MeanFieldInferenceEngine
@@ -25,34 +42,92 @@ public:
   typedef infermous::ProbabilitiesGrid<Label> ProbabilitiesGrid;
   typedef infermous::ProbabilitiesGrid_Ptr<Label> ProbabilitiesGrid_Ptr;
 
+private:
+  typedef boost::shared_ptr<DenseProbabilitiesGrid<Label> > DenseProbabilitiesGrid_Ptr;
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The CRF on which the mean-field inference engine works. */
   CRF2D_Ptr m_crf;
 
-  /** A list of offsets used to specify the neighbours of each pixel. */
-  std::vector<Eigen::Vector2i> m_neighbourOffsets;
+#ifdef WITH_CUDA
+  /** The CUDA-based updater to use (if any). */
+  MeanFieldUpdater_CUDA_Ptr m_cudaUpdater;
+#endif
+
+  /** The marginal probabilities, stored densely. */
+  DenseProbabilitiesGrid_Ptr m_denseMarginals;
+
+  /** A dense grid of updated marginal probabilities that will be swapped with m_denseMarginals at the end of each iteration. */
+  DenseProbabilitiesGrid_Ptr m_denseNewMarginals;
+
+  /** The offsets used to specify the neighbours of each pixel, stored as consecutive (x,y) pairs. */
+  std::vector<int> m_neighbourOffsets;
 
-  /** A grid of updated marginal probabilities that will be swapped with the grid in the CRF at the end of each time step. */
+  /** A grid of updated marginal probabilities that will be swapped with the grid in the CRF at the end of each call to update_crf. */
   ProbabilitiesGrid_Ptr m_newMarginals;
 
-  /** The pairwise potential calculator. */
-  PairwisePotentialCalculator_CPtr<Label> m_pairwisePotentialCalculator;
+  /** The pairwise potentials phi_ij(L,L'), stored as a row-major labelCount x labelCount matrix. */
+  std::vector<float> m_pairwisePotentials;
+
+  /** The unary potentials phi_i(L) = -log(psi_i(L)), stored densely (infinity for labels that a pixel cannot take). */
+  std::vector<float> m_unaryPotentials;
 
   //#################### CONSTRUCTORS ####################
 public:
   /**
    * \brief Constructs a mean-field inference engine.
    *
-   * \param crf               The CRF on which the mean-field inference engine works.
-   * \param neighbourOffsets  A list of offsets used to specify the neighbours of each pixel.
+   * \param crf                   The CRF on which the mean-field inference engine works.
+   * \param neighbourOffsets      A list of offsets used to specify the neighbours of each pixel.
+   * \param useCUDA               Whether or not to run the updates using CUDA.
+   * \throws std::runtime_error   If the CRF has more than MEANFIELD_MAX_LABEL_COUNT labels, or if CUDA is requested but not available.
    */
-  MeanFieldInferenceEngine(const CRF2D_Ptr& crf, const std::vector<Eigen::Vector2i>& neighbourOffsets)
+  MeanFieldInferenceEngine(const CRF2D_Ptr& crf, const std::vector<Eigen::Vector2i>& neighbourOffsets, bool useCUDA = false)
   : m_crf(crf),
-    m_neighbourOffsets(neighbourOffsets),
-    m_newMarginals(new ProbabilitiesGrid(crf->get_height(), crf->get_width())),
-    m_pairwisePotentialCalculator(crf->get_pairwise_potential_calculator())
-  {}
+    m_denseMarginals(new DenseProbabilitiesGrid<Label>(crf->get_unaries())),
+    m_newMarginals(new ProbabilitiesGrid(crf->get_height(), crf->get_width()))
+  {
+    const int labelCount = m_denseMarginals->get_label_count();
+    if(labelCount > MEANFIELD_MAX_LABEL_COUNT)
+    {
+      throw std::runtime_error("Error: The mean-field inference engine cannot handle CRFs with more than MEANFIELD_MAX_LABEL_COUNT labels");
+    }
+
+    m_denseNewMarginals.reset(new DenseProbabilitiesGrid<Label>(*m_denseMarginals));
+
+    // Flatten the neighbour offsets.
+    for(std::vector<Eigen::Vector2i>::const_iterator it = neighbourOffsets.begin(), iend = neighbourOffsets.end(); it != iend; ++it)
+    {
+      m_neighbourOffsets.push_back(it->x());
+      m_neighbourOffsets.push_back(it->y());
+    }
+
+    // Precompute the pairwise potentials for every pair of labels.
+    const std::vector<Label>& labels = m_denseMarginals->get_labels();
+    PairwisePotentialCalculator_CPtr<Label> pairwisePotentialCalculator = crf->get_pairwise_potential_calculator();
+    m_pairwisePotentials.resize(labelCount * labelCount);
+    for(int i = 0; i < labelCount; ++i)
+    {
+      for(int j = 0; j < labelCount; ++j)
+      {
+        m_pairwisePotentials[i * labelCount + j] = pairwisePotentialCalculator->calculate_potential(labels[i], labels[j]);
+      }
+    }
+
+    // Precompute the unary potentials for every pixel. Labels that do not appear in a pixel's unaries are given an
+    // infinite potential, so that (as with the original sparse formulation) they are never assigned any probability.
+    m_unaryPotentials = m_denseMarginals->make_potentials(crf->get_unaries());
+
+    if(useCUDA)
+    {
+#ifdef WITH_CUDA
+      m_cudaUpdater.reset(new MeanFieldUpdater_CUDA(crf->get_width(), crf->get_height(), labelCount, m_unaryPotentials, m_pairwisePotentials, m_neighbourOffsets));
+#else
+      throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+    }
+  }
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -73,93 +148,183 @@ public:
    */
   void update_crf(size_t iterations)
   {
-    for(size_t i = 0; i < iterations; ++i)
+    run_updates(iterations, -1.0f);
+  }
+
+  /**
+   * \brief Updates the CRF on which the mean-field inference engine works until its marginals converge.
+   *
+   * The marginals are deemed to have converged once no marginal probability of any pixel changes by more than
+   * the specified threshold in a single iteration.
+   *
+   * \param maxIterations         The maximum number of update iterations to run.
+   * \param convergenceThreshold  The per-pixel convergence threshold (must be non-negative).
+   * \return                      The number of update iterations that were actually run.
+   * \throws std::invalid_argument If the convergence threshold is negative.
+   */
+  size_t update_crf_until_converged(size_t maxIterations, float convergenceThreshold)
+  {
+    if(convergenceThreshold < 0.0f) throw std::invalid_argument("Error: The convergence threshold for mean-field inference must be non-negative");
+    return run_updates(maxIterations, convergenceThreshold);
+  }
+
+  /**
+   * \brief Initialises the marginals of the CRF from the converged marginals of a previous frame, warped into the current view.
+   *
+   * The correspondences are supplied by the caller (e.g. by projecting the current raycast result into the previous view
+   * using the pose delta between the two frames), so that the engine itself does not need to know anything about cameras.
+   * Each pixel with a valid correspondence takes the previous marginals of its corresponding pixel, restricted to the labels
+   * that appear in its own unaries and renormalised. Pixels without a valid correspondence (or whose corresponding marginals
+   * give no probability to any of their labels) keep their existing marginals.
+   *
+   * \param previousMarginals     The converged marginals from the previous frame.
+   * \param correspondences       A grid of the same size as the CRF specifying, for each pixel, the (x,y) location of the
+   *                              corresponding pixel in the previous frame (locations outside the previous grid are ignored).
+   * \throws std::invalid_argument If the correspondences grid has a different size from the CRF.
+   */
+  void warm_start(const ProbabilitiesGrid& previousMarginals, const Grid<Eigen::Vector2i>& correspondences)
+  {
+    const int width = m_crf->get_width(), height = m_crf->get_height();
+    if(correspondences.rows() != height || correspondences.cols() != width)
+    {
+      throw std::invalid_argument("Error: The correspondences grid must have the same size as the CRF");
+    }
+
+    const int previousWidth = static_cast<int>(previousMarginals.cols()), previousHeight = static_cast<int>(previousMarginals.rows());
+    const ProbabilitiesGrid& unaries = m_crf->get_unaries();
+    const ProbabilitiesGrid& marginals = m_crf->get_marginals();
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int y = 0; y < height; ++y)
     {
-      for(int y = 0, height = m_crf->get_height(); y < height; ++y)
+      for(int x = 0; x < width; ++x)
       {
-        for(int x = 0, width = m_crf->get_width(); x < width; ++x)
+        std::map<Label,float>& newMarginals = (*m_newMarginals)(y, x);
+        newMarginals = marginals(y, x);
+
+        const Eigen::Vector2i& loc = correspondences(y, x);
+        if(loc.x() < 0 || loc.x() >= previousWidth || loc.y() < 0 || loc.y() >= previousHeight) continue;
+
+        const std::map<Label,float>& previous = previousMarginals(loc.y(), loc.x());
+        const std::map<Label,float>& labels = unaries(y, x);
+        float sum = 0.0f;
+        for(typename std::map<Label,float>::const_iterator it = labels.begin(), iend = labels.end(); it != iend; ++it)
         {
-          compute_updated_pixel(Eigen::Vector2i(x, y));
+          typename std::map<Label,float>::const_iterator jt = previous.find(it->first);
+          if(jt != previous.end()) sum += jt->second;
         }
-      }
 
-      // Swap the new marginals into the CRF.
-      m_crf->swap_marginals(m_newMarginals);
+        if(sum <= 0.0f) continue;
+
+        for(typename std::map<Label,float>::const_iterator it = labels.begin(), iend = labels.end(); it != iend; ++it)
+        {
+          typename std::map<Label,float>::const_iterator jt = previous.find(it->first);
+          newMarginals[it->first] = jt != previous.end() ? jt->second / sum : 0.0f;
+        }
+      }
     }
+
+    m_crf->swap_marginals(m_newMarginals);
   }
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /**
-   * \brief Computes the value of M_i(L), for pixel i and label L.
+   * \brief Counts the number of pixels whose marginals have not yet converged.
    *
-   * See p.6 of the original SemanticPaint paper for details - essentially, this is the new marginal potential (not the probability!) for the pixel.
+   * This compares m_denseMarginals (the marginals after the most recent iteration) with m_denseNewMarginals (the marginals before it).
    *
-   * \param i       The location of the pixel.
-   * \param L       The label.
-   * \param phi_i_L The unary potential, phi_i(L), for the specified pixel and label (we pass this in to avoid having to recalculate it).
-   * \return        The value of M_i(L) for the specified pixel and label.
+   * \param convergenceThreshold  The per-pixel convergence threshold.
+   * \return                      The number of pixels whose marginals have not yet converged.
    */
-  float compute_M_i_L(const Eigen::Vector2i& i, const Label& L, float phi_i_L) const
+  int count_unconverged_pixels(float convergenceThreshold) const
   {
-    float result = phi_i_L;
+    const int pixelCount = m_crf->get_width() * m_crf->get_height();
+    const int labelCount = m_denseMarginals->get_label_count();
+    if(labelCount == 0) return 0;
+
+    const float *marginals = m_denseNewMarginals->get_data();
+    const float *newMarginals = m_denseMarginals->get_data();
 
-    // Note that we have reordered the sums presented in the paper so as to iterate over the neighbours first.
-    // This makes no difference to the result, but allows us to avoid lookups of Q_j^{t-1}(L').
-    for(std::vector<Eigen::Vector2i>::const_iterator nt = m_neighbourOffsets.begin(), nend = m_neighbourOffsets.end(); nt != nend; ++nt)
+    int unconvergedCount = 0;
+#ifdef WITH_OPENMP
+    #pragma omp parallel for reduction(+:unconvergedCount)
+#endif
+    for(int i = 0; i < pixelCount; ++i)
     {
-      // Calculate the location of the possible neighbour and check whether or not it is within the CRF. If not, skip it.
-      Eigen::Vector2i j = i + *nt;
-      if(!m_crf->within_bounds(j)) continue;
+      if(!has_pixel_converged(i, labelCount, marginals, newMarginals, convergenceThreshold)) ++unconvergedCount;
+    }
 
-      // Calculate \sum_{L'} (Q_j^{t-1}(L') * phi_ij(L,L')).
-      const std::map<Label,float>& Q_j = m_crf->get_marginals_at(j);
-      for(typename std::map<Label,float>::const_iterator kt = Q_j.begin(), kend = Q_j.end(); kt != kend; ++kt)
+    return unconvergedCount;
+  }
+
+  /**
+   * \brief Computes the updated versions of all of the pixels in the CRF, writing them into m_denseNewMarginals.
+   */
+  void compute_updated_pixels()
+  {
+    const int width = m_crf->get_width(), height = m_crf->get_height();
+    const int labelCount = m_denseMarginals->get_label_count();
+    if(labelCount == 0) return;
+
+    const float *unaryPotentials = &m_unaryPotentials[0];
+    const float *marginals = m_denseMarginals->get_data();
+    const float *pairwisePotentials = &m_pairwisePotentials[0];
+    const int *neighbourOffsets = m_neighbourOffsets.empty() ? NULL : &m_neighbourOffsets[0];
+    const int neighbourCount = static_cast<int>(m_neighbourOffsets.size() / 2);
+    float *newMarginals = m_denseNewMarginals->get_data();
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int y = 0; y < height; ++y)
+    {
+      for(int x = 0; x < width; ++x)
       {
-        const Label& LDash = kt->first;
-        float Q_j_LDash = kt->second;
-        float phi_i_j_L_LDash = m_pairwisePotentialCalculator->calculate_potential(L, LDash);
-        result += Q_j_LDash * phi_i_j_L_LDash;
+        compute_updated_pixel(x, y, width, height, labelCount, unaryPotentials, marginals, pairwisePotentials, neighbourOffsets, neighbourCount, newMarginals);
       }
     }
-
-    return result;
   }
 
   /**
-   * \brief Computes the updated version of the specified pixel in the CRF.
+   * \brief Runs update iterations on the CRF, either for a fixed number of iterations or until its marginals converge.
    *
-   * \param i The location of the pixel whose updated version we want to compute.
+   * \param maxIterations         The maximum number of update iterations to run.
+   * \param convergenceThreshold  The per-pixel convergence threshold (or a negative value to always run maxIterations iterations).
+   * \return                      The number of update iterations that were actually run.
    */
-  void compute_updated_pixel(const Eigen::Vector2i& i)
+  size_t run_updates(size_t maxIterations, float convergenceThreshold)
   {
-    // Get the unary probabilities for the pixel.
-    const std::map<Label,float>& psi_i = m_crf->get_unaries_at(i);
-
-    // Calculate the unnormalised new probabilities for the pixel, together with the normalisation constant.
-    // (In other words, compute e^-M_i(L) for every L, and Z_i, as per the original SemanticPaint paper.)
-    std::map<Label,float> oneOverE_M_i;
-    float Z_i = 0.0f;
-    for(typename std::map<Label,float>::const_iterator kt = psi_i.begin(), kend = psi_i.end(); kt != kend; ++kt)
-    {
-      const Label& L = kt->first;
-      float psi_i_L = kt->second;
-      float phi_i_L = -logf(psi_i_L);
-      float oneOverE_M_i_L = expf(-compute_M_i_L(i, L, phi_i_L));
-      oneOverE_M_i[L] = oneOverE_M_i_L;
-      Z_i += oneOverE_M_i_L;
-    }
+    if(maxIterations == 0) return 0;
+
+    // Convert the current marginals in the CRF to dense form.
+    m_denseMarginals->load(m_crf->get_marginals());
 
-    // Calculate the normalised new probabilities for the pixel by dividing through by the normalisation constant.
-    // (In other words, compute Q_i^t(L) = 1/Z_i * e^-M_i(L), as per the paper.)
-    float oneOverZ_i = 1.0f / Z_i;
-    std::map<Label,float>& Q_i = (*m_newMarginals)(i.y(), i.x());
-    for(typename std::map<Label,float>::const_iterator kt = oneOverE_M_i.begin(), kend = oneOverE_M_i.end(); kt != kend; ++kt)
+    // Run the update iterations.
+    size_t iterations = 0;
+#ifdef WITH_CUDA
+    if(m_cudaUpdater) iterations = m_cudaUpdater->run(m_denseMarginals->get_data(), maxIterations, convergenceThreshold);
+    else
+#endif
     {
-      const Label& L = kt->first;
-      float oneOverE_M_i_L = kt->second;
-      Q_i[L] = oneOverZ_i * oneOverE_M_i_L;
+      while(iterations < maxIterations)
+      {
+        compute_updated_pixels();
+        std::swap(m_denseMarginals, m_denseNewMarginals);
+        ++iterations;
+
+        if(convergenceThreshold >= 0.0f && count_unconverged_pixels(convergenceThreshold) == 0) break;
+      }
     }
+
+    // Convert the updated marginals back to sparse form and swap them into the CRF. Note that (as in the original
+    // sparse formulation) each pixel only has marginals for the labels that appear in its unaries.
+    m_denseMarginals->save(m_crf->get_unaries(), *m_newMarginals);
+    m_crf->swap_marginals(m_newMarginals);
+
+    return iterations;
   }
 };
 
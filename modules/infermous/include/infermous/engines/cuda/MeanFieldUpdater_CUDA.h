@@ -0,0 +1,103 @@
+/**
+ * infermous: MeanFieldUpdater_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_INFERMOUS_MEANFIELDUPDATER_CUDA
+#define H_INFERMOUS_MEANFIELDUPDATER_CUDA
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace infermous {
+
+/**
+ * \brief An instance of this class can be used to run mean-field update iterations on a densely-stored 2D CRF using CUDA.
+ *
+ * The unary potentials, pairwise potentials and neighbour offsets are uploaded to the GPU once, on construction.
+ * Each call to run then uploads the current marginals, runs the requested number of iterations entirely on the GPU
+ * (double-buffering the marginals in device memory), and downloads the result.
+ */
+class MeanFieldUpdater_CUDA
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The height of the CRF. */
+  int m_height;
+
+  /** The number of labels. */
+  int m_labelCount;
+
+  /** The marginal probabilities (on the GPU). */
+  float *m_marginals;
+
+  /** The offsets specifying the neighbours of each pixel, stored as consecutive (x,y) pairs (on the GPU). */
+  int *m_neighbourOffsets;
+
+  /** The number of neighbour offsets. */
+  int m_neighbourCount;
+
+  /** The buffer into which to write the updated marginal probabilities (on the GPU). */
+  float *m_newMarginals;
+
+  /** The pairwise potentials, stored as a row-major labelCount x labelCount matrix (on the GPU). */
+  float *m_pairwisePotentials;
+
+  /** The unary potentials (on the GPU). */
+  float *m_unaryPotentials;
+
+  /** A counter used to count the pixels whose marginals have not yet converged (on the GPU). */
+  int *m_unconvergedCount;
+
+  /** The width of the CRF. */
+  int m_width;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based mean-field updater.
+   *
+   * \param width               The width of the CRF.
+   * \param height              The height of the CRF.
+   * \param labelCount          The number of labels.
+   * \param unaryPotentials     The unary potentials, stored densely as a [height][width][labelCount] array.
+   * \param pairwisePotentials  The pairwise potentials, stored as a row-major labelCount x labelCount matrix.
+   * \param neighbourOffsets    The offsets specifying the neighbours of each pixel, stored as consecutive (x,y) pairs.
+   */
+  MeanFieldUpdater_CUDA(int width, int height, int labelCount, const std::vector<float>& unaryPotentials,
+                        const std::vector<float>& pairwisePotentials, const std::vector<int>& neighbourOffsets);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the CUDA-based mean-field updater.
+   */
+  ~MeanFieldUpdater_CUDA();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  MeanFieldUpdater_CUDA(const MeanFieldUpdater_CUDA&);
+  MeanFieldUpdater_CUDA& operator=(const MeanFieldUpdater_CUDA&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Runs mean-field update iterations, either for a fixed number of iterations or until the marginals converge.
+   *
+   * \param marginals             The densely-stored [height][width][labelCount] marginal probabilities, which will be updated in place.
+   * \param maxIterations         The maximum number of update iterations to run.
+   * \param convergenceThreshold  The per-pixel convergence threshold (or a negative value to always run maxIterations iterations).
+   * \return                      The number of update iterations that were actually run.
+   */
+  size_t run(float *marginals, size_t maxIterations, float convergenceThreshold = -1.0f);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<MeanFieldUpdater_CUDA> MeanFieldUpdater_CUDA_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * infermous: MeanFieldInferenceEngine_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_INFERMOUS_MEANFIELDINFERENCEENGINE_SHARED
+#define H_INFERMOUS_MEANFIELDINFERENCEENGINE_SHARED
+
+#include <cmath>
+
+#if defined(__CUDACC__)
+  #define _INFERMOUS_CPU_AND_GPU_CODE_ __device__ __host__
+#else
+  #define _INFERMOUS_CPU_AND_GPU_CODE_
+#endif
+
+namespace infermous {
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of labels that the dense mean-field update can handle. */
+enum { MEANFIELD_MAX_LABEL_COUNT = 64 };
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not the marginal probabilities for the specified pixel in a densely-stored 2D CRF have converged.
+ *
+ * A pixel is deemed to have converged if none of its marginal probabilities changed by more than the specified threshold
+ * during the most recent update iteration.
+ *
+ * \param pixelIndex            The (row-major) index of the pixel.
+ * \param labelCount            The number of labels.
+ * \param marginals             The marginal probabilities Q^{t-1} from before the update, stored densely.
+ * \param newMarginals          The marginal probabilities Q^t from after the update, stored densely.
+ * \param convergenceThreshold  The maximum amount by which any of the pixel's marginal probabilities may have changed.
+ * \return                      true, if the pixel has converged, or false otherwise.
+ */
+_INFERMOUS_CPU_AND_GPU_CODE_
+inline bool has_pixel_converged(int pixelIndex, int labelCount, const float *marginals, const float *newMarginals, float convergenceThreshold)
+{
+  const float *Q_old = marginals + pixelIndex * labelCount;
+  const float *Q_new = newMarginals + pixelIndex * labelCount;
+  for(int k = 0; k < labelCount; ++k)
+  {
+    if(fabsf(Q_new[k] - Q_old[k]) > convergenceThreshold) return false;
+  }
+  return true;
+}
+
+/**
+ * \brief Computes the updated marginal probabilities for a pixel in a CRF from the messages it has received from other pixels.
+ *
+ * This computes Q_i^t(L) = 1/Z_i * e^-M_i(L), where M_i(L) = phi_i(L) + \sum_{L'} phi_ij(L,L') * m_i(L'), and where
+ * m_i(L') is the (weighted) sum of the previous marginal probabilities for label L' over the pixels that affect pixel i.
+ *
+ * \param labelCount          The number of labels.
+ * \param phi_i               The unary potentials for the pixel (infinity for labels the pixel cannot take).
+ * \param m_i                 The messages received by the pixel (one per label).
+ * \param pairwisePotentials  The pairwise potentials phi_ij(L,L'), stored as a row-major labelCount x labelCount matrix.
+ * \param Q_i                 An array into which to write the updated marginal probabilities for the pixel.
+ */
+_INFERMOUS_CPU_AND_GPU_CODE_
+inline void compute_updated_probabilities(int labelCount, const float *phi_i, const float *m_i, const float *pairwisePotentials, float *Q_i)
+{
+  // Calculate the unnormalised new probabilities for the pixel, together with the normalisation constant.
+  // (In other words, compute e^-M_i(L) for every L, and Z_i, as per the original SemanticPaint paper.)
+  // Labels that the pixel cannot take have an infinite unary potential, and so get a probability of zero.
+  float Z_i = 0.0f;
+  for(int L = 0; L < labelCount; ++L)
+  {
+    float M_i_L = phi_i[L];
+    const float *phi_ij_L = pairwisePotentials + L * labelCount;
+    for(int k = 0; k < labelCount; ++k) M_i_L += phi_ij_L[k] * m_i[k];
+
+    Q_i[L] = expf(-M_i_L);
+    Z_i += Q_i[L];
+  }
+
+  // Calculate the normalised new probabilities for the pixel by dividing through by the normalisation constant.
+  // (In other words, compute Q_i^t(L) = 1/Z_i * e^-M_i(L), as per the paper.)
+  if(Z_i > 0.0f)
+  {
+    const float oneOverZ_i = 1.0f / Z_i;
+    for(int L = 0; L < labelCount; ++L) Q_i[L] *= oneOverZ_i;
+  }
+}
+
+/**
+ * \brief Computes the updated marginal probabilities for the specified pixel in a densely-stored 2D CRF.
+ *
+ * This computes Q_i^t(L) = 1/Z_i * e^-M_i(L), where M_i(L) = phi_i(L) + \sum_j \sum_{L'} Q_j^{t-1}(L') * phi_ij(L,L'),
+ * as per p.6 of the original SemanticPaint paper. Note that we first sum the marginals of the neighbours of the pixel
+ * for each label, and then multiply the resulting vector by the matrix of pairwise potentials. This makes no difference
+ * to the result, but requires only O(|N| * |L| + |L|^2) operations per pixel, rather than O(|N| * |L|^2).
+ *
+ * \param x                   The x coordinate of the pixel.
+ * \param y                   The y coordinate of the pixel.
+ * \param width               The width of the CRF.
+ * \param height              The height of the CRF.
+ * \param labelCount          The number of labels (at most MEANFIELD_MAX_LABEL_COUNT).
+ * \param unaryPotentials     The unary potentials phi_i(L) = -log(psi_i(L)), stored densely (infinity for labels a pixel cannot take).
+ * \param marginals           The marginal probabilities Q^{t-1}, stored densely.
+ * \param pairwisePotentials  The pairwise potentials phi_ij(L,L'), stored as a row-major labelCount x labelCount matrix.
+ * \param neighbourOffsets    The offsets specifying the neighbours of each pixel, stored as consecutive (x,y) pairs.
+ * \param neighbourCount      The number of neighbour offsets.
+ * \param newMarginals        The densely-stored grid into which to write the updated marginal probabilities Q^t.
+ */
+_INFERMOUS_CPU_AND_GPU_CODE_
+inline void compute_updated_pixel(int x, int y, int width, int height, int labelCount, const float *unaryPotentials, const float *marginals,
+                                  const float *pairwisePotentials, const int *neighbourOffsets, int neighbourCount, float *newMarginals)
+{
+  const int pixelOffset = (y * width + x) * labelCount;
+
+  // Calculate \sum_j Q_j^{t-1}(L') for each L'.
+  float neighbourSums[MEANFIELD_MAX_LABEL_COUNT];
+  for(int k = 0; k < labelCount; ++k) neighbourSums[k] = 0.0f;
+
+  for(int n = 0; n < neighbourCount; ++n)
+  {
+    // Calculate the location of the possible neighbour and check whether or not it is within the CRF. If not, skip it.
+    const int jx = x + neighbourOffsets[2 * n], jy = y + neighbourOffsets[2 * n + 1];
+    if(jx < 0 || jx >= width || jy < 0 || jy >= height) continue;
+
+    const float *Q_j = marginals + (jy * width + jx) * labelCount;
+    for(int k = 0; k < labelCount; ++k) neighbourSums[k] += Q_j[k];
+  }
+
+  compute_updated_probabilities(labelCount, unaryPotentials + pixelOffset, neighbourSums, pairwisePotentials, newMarginals + pixelOffset);
+}
+
+}
+
+#endif
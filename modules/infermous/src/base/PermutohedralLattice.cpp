@@ -0,0 +1,340 @@
+/**
+ * infermous: PermutohedralLattice.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "base/PermutohedralLattice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace infermous {
+
+//#################### HELPER CLASSES ####################
+
+namespace {
+
+/**
+ * \brief An instance of this class can be used to assign consecutive indices to the (integer) keys of permutohedral lattice vertices.
+ *
+ * Since the coordinates of a lattice vertex sum to zero, only the first d of its d+1 coordinates are stored.
+ */
+class VertexHashTable
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The size of each key. */
+  int m_keySize;
+
+  /** The keys of the vertices, stored contiguously in index order. */
+  std::vector<short> m_keys;
+
+  /** The open-addressing hash table, each of whose entries contains either a vertex index or -1. */
+  std::vector<int> m_table;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  VertexHashTable(int keySize, size_t expectedSize)
+  : m_keySize(keySize)
+  {
+    size_t capacity = 16;
+    while(capacity < 2 * expectedSize) capacity *= 2;
+    m_table.resize(capacity, -1);
+    m_keys.reserve(expectedSize * keySize);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Finds the index of the vertex with the specified key, optionally adding it if it is not yet present.
+   *
+   * \param key     The key.
+   * \param create  Whether or not to add the vertex if it is not yet present.
+   * \return        The index of the vertex, or -1 if it is not present and create is false.
+   */
+  int find(const short *key, bool create)
+  {
+    if(create && 2 * size() >= m_table.size()) grow();
+
+    const size_t mask = m_table.size() - 1;
+    for(size_t h = hash(key) & mask;; h = (h + 1) & mask)
+    {
+      int& entry = m_table[h];
+      if(entry == -1)
+      {
+        if(!create) return -1;
+        entry = static_cast<int>(size());
+        m_keys.insert(m_keys.end(), key, key + m_keySize);
+        return entry;
+      }
+
+      if(std::equal(key, key + m_keySize, &m_keys[entry * m_keySize])) return entry;
+    }
+  }
+
+  /**
+   * \brief Gets the key of the specified vertex.
+   *
+   * \param i The index of the vertex.
+   * \return  The key of the vertex.
+   */
+  const short *get_key(int i) const
+  {
+    return &m_keys[i * m_keySize];
+  }
+
+  /**
+   * \brief Gets the number of vertices in the table.
+   *
+   * \return  The number of vertices in the table.
+   */
+  size_t size() const
+  {
+    return m_keys.size() / m_keySize;
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Doubles the capacity of the table and reinserts the existing vertices.
+   */
+  void grow()
+  {
+    m_table.assign(m_table.size() * 2, -1);
+    const size_t mask = m_table.size() - 1;
+    for(int i = 0, count = static_cast<int>(size()); i < count; ++i)
+    {
+      size_t h = hash(get_key(i)) & mask;
+      while(m_table[h] != -1) h = (h + 1) & mask;
+      m_table[h] = i;
+    }
+  }
+
+  /**
+   * \brief Hashes the specified key.
+   *
+   * \param key The key.
+   * \return    The hash of the key.
+   */
+  size_t hash(const short *key) const
+  {
+    size_t result = 0;
+    for(int i = 0; i < m_keySize; ++i)
+    {
+      result += key[i];
+      result *= 2531011;
+    }
+    return result;
+  }
+};
+
+}
+
+//#################### CONSTRUCTORS ####################
+
+PermutohedralLattice::PermutohedralLattice(const std::vector<float>& features, int featureDims)
+: m_featureDims(featureDims)
+{
+  if(featureDims <= 0 || features.size() % featureDims != 0)
+  {
+    throw std::invalid_argument("Error: The features of a permutohedral lattice must consist of a positive number of dimensions per point");
+  }
+
+  const int d = featureDims;
+  m_pointCount = static_cast<int>(features.size() / d);
+
+  // Compute the scale factors needed to embed the (scaled) features in the hyperplane H_d, such that a Gaussian
+  // with unit standard deviation in feature space corresponds to the blur performed on the lattice.
+  std::vector<float> scaleFactors(d);
+  const float invStdDev = sqrtf(2.0f / 3.0f) * (d + 1);
+  for(int i = 0; i < d; ++i)
+  {
+    scaleFactors[i] = invStdDev / sqrtf(static_cast<float>((i + 1) * (i + 2)));
+  }
+
+  // Compute the canonical simplex (see p.4 of the Adams et al. paper).
+  std::vector<int> canonical((d + 1) * (d + 1));
+  for(int i = 0; i <= d; ++i)
+  {
+    for(int j = 0; j <= d - i; ++j) canonical[i * (d + 1) + j] = i;
+    for(int j = d - i + 1; j <= d; ++j) canonical[i * (d + 1) + j] = i - (d + 1);
+  }
+
+  // Splat each point onto the vertices of its enclosing simplex, recording the vertices' indices and the point's barycentric weights.
+  VertexHashTable hashTable(d, m_pointCount * (d + 1));
+  m_barycentricWeights.resize(m_pointCount * (d + 1));
+  m_vertexIndices.resize(m_pointCount * (d + 1));
+
+  std::vector<float> elevated(d + 1), barycentric(d + 2);
+  std::vector<int> rank(d + 1), rem0(d + 1);
+  std::vector<short> key(d + 1);
+  for(int p = 0; p < m_pointCount; ++p)
+  {
+    const float *f = &features[p * d];
+
+    // Elevate the point into H_d.
+    float sum = 0.0f;
+    for(int j = d; j > 0; --j)
+    {
+      const float cf = f[j - 1] * scaleFactors[j - 1];
+      elevated[j] = sum - j * cf;
+      sum += cf;
+    }
+    elevated[0] = sum;
+
+    // Find the closest remainder-0 vertex by rounding.
+    int coordSum = 0;
+    for(int i = 0; i <= d; ++i)
+    {
+      const int rd = static_cast<int>(floorf(elevated[i] / (d + 1) + 0.5f));
+      rem0[i] = rd * (d + 1);
+      coordSum += rd;
+    }
+
+    // Find the simplex containing the point by ranking the differences between its coordinates and those of the vertex.
+    std::fill(rank.begin(), rank.end(), 0);
+    for(int i = 0; i < d; ++i)
+    {
+      const float di = elevated[i] - rem0[i];
+      for(int j = i + 1; j <= d; ++j)
+      {
+        if(di < elevated[j] - rem0[j]) ++rank[i];
+        else ++rank[j];
+      }
+    }
+
+    // If the coordinates of the vertex do not sum to zero, bring it back onto the hyperplane.
+    for(int i = 0; i <= d; ++i)
+    {
+      rank[i] += coordSum;
+      if(rank[i] < 0)
+      {
+        rank[i] += d + 1;
+        rem0[i] += d + 1;
+      }
+      else if(rank[i] > d)
+      {
+        rank[i] -= d + 1;
+        rem0[i] -= d + 1;
+      }
+    }
+
+    // Compute the barycentric coordinates of the point within the simplex (see p.10 of the paper).
+    std::fill(barycentric.begin(), barycentric.end(), 0.0f);
+    for(int i = 0; i <= d; ++i)
+    {
+      const float v = (elevated[i] - rem0[i]) / (d + 1);
+      barycentric[d - rank[i]] += v;
+      barycentric[d - rank[i] + 1] -= v;
+    }
+    barycentric[0] += 1.0f + barycentric[d + 1];
+
+    // Look up (or add) each vertex of the simplex.
+    for(int remainder = 0; remainder <= d; ++remainder)
+    {
+      for(int i = 0; i < d; ++i)
+      {
+        key[i] = static_cast<short>(rem0[i] + canonical[remainder * (d + 1) + rank[i]]);
+      }
+
+      m_vertexIndices[p * (d + 1) + remainder] = hashTable.find(&key[0], true);
+      m_barycentricWeights[p * (d + 1) + remainder] = barycentric[remainder];
+    }
+  }
+
+  m_vertexCount = static_cast<int>(hashTable.size());
+
+  // Find the neighbours of each vertex along each lattice axis. Moving along axis j changes coordinate j by d
+  // and every other coordinate by -1 (or vice versa). Vertices onto which no point has been splatted are absent.
+  m_blurNeighbours.resize((d + 1) * m_vertexCount * 2);
+  std::vector<short> n1(d + 1), n2(d + 1);
+  for(int j = 0; j <= d; ++j)
+  {
+    for(int i = 0; i < m_vertexCount; ++i)
+    {
+      const short *k = hashTable.get_key(i);
+      for(int l = 0; l < d; ++l)
+      {
+        n1[l] = k[l] - 1;
+        n2[l] = k[l] + 1;
+      }
+
+      if(j < d)
+      {
+        n1[j] = k[j] + d;
+        n2[j] = k[j] - d;
+      }
+
+      m_blurNeighbours[(j * m_vertexCount + i) * 2] = hashTable.find(&n1[0], false);
+      m_blurNeighbours[(j * m_vertexCount + i) * 2 + 1] = hashTable.find(&n2[0], false);
+    }
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void PermutohedralLattice::filter(const float *in, int valueDims, float *out) const
+{
+  const int d = m_featureDims;
+
+  // Note that entry 0 of each buffer is a sentinel that always contains zeros, and represents an absent vertex.
+  std::vector<float> values((m_vertexCount + 1) * valueDims, 0.0f), newValues((m_vertexCount + 1) * valueDims, 0.0f);
+
+  // Splat the values onto the lattice.
+  for(int p = 0; p < m_pointCount; ++p)
+  {
+    const float *v = in + p * valueDims;
+    for(int j = 0; j <= d; ++j)
+    {
+      float *dest = &values[(m_vertexIndices[p * (d + 1) + j] + 1) * valueDims];
+      const float w = m_barycentricWeights[p * (d + 1) + j];
+      for(int k = 0; k < valueDims; ++k) dest[k] += w * v[k];
+    }
+  }
+
+  // Blur the values along each lattice axis in turn, using a [1 2 1] / 2 kernel.
+  for(int j = 0; j <= d; ++j)
+  {
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int i = 0; i < m_vertexCount; ++i)
+    {
+      const float *oldVal = &values[(i + 1) * valueDims];
+      const float *n1Val = &values[(m_blurNeighbours[(j * m_vertexCount + i) * 2] + 1) * valueDims];
+      const float *n2Val = &values[(m_blurNeighbours[(j * m_vertexCount + i) * 2 + 1] + 1) * valueDims];
+      float *newVal = &newValues[(i + 1) * valueDims];
+      for(int k = 0; k < valueDims; ++k) newVal[k] = oldVal[k] + 0.5f * (n1Val[k] + n2Val[k]);
+    }
+
+    values.swap(newValues);
+  }
+
+  // Slice the blurred values back out at the points. The scaling constant alpha compensates for the
+  // fact that the blur kernel's weights sum to more than one (see the Adams et al. paper).
+  const float alpha = 1.0f / (1.0f + powf(2.0f, static_cast<float>(-d)));
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int p = 0; p < m_pointCount; ++p)
+  {
+    float *v = out + p * valueDims;
+    for(int k = 0; k < valueDims; ++k) v[k] = 0.0f;
+
+    for(int j = 0; j <= d; ++j)
+    {
+      const float *src = &values[(m_vertexIndices[p * (d + 1) + j] + 1) * valueDims];
+      const float w = m_barycentricWeights[p * (d + 1) + j] * alpha;
+      for(int k = 0; k < valueDims; ++k) v[k] += w * src[k];
+    }
+  }
+}
+
+int PermutohedralLattice::get_point_count() const
+{
+  return m_pointCount;
+}
+
+}
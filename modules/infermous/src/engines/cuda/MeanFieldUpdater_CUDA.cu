@@ -0,0 +1,159 @@
+/**
+ * infermous: MeanFieldUpdater_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "engines/cuda/MeanFieldUpdater_CUDA.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "engines/shared/MeanFieldInferenceEngine_Shared.h"
+
+namespace infermous {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_compute_updated_pixels(int width, int height, int labelCount, const float *unaryPotentials, const float *marginals,
+                                          const float *pairwisePotentials, const int *neighbourOffsets, int neighbourCount, float *newMarginals)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < width * height)
+  {
+    compute_updated_pixel(tid % width, tid / width, width, height, labelCount, unaryPotentials, marginals, pairwisePotentials, neighbourOffsets, neighbourCount, newMarginals);
+  }
+}
+
+__global__ void ck_count_unconverged_pixels(int pixelCount, int labelCount, const float *marginals, const float *newMarginals,
+                                            float convergenceThreshold, int *unconvergedCount)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < pixelCount && !has_pixel_converged(tid, labelCount, marginals, newMarginals, convergenceThreshold))
+  {
+    atomicAdd(unconvergedCount, 1);
+  }
+}
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Allocates a buffer on the GPU and fills it with the contents of the specified vector.
+ *
+ * \param v                   The vector.
+ * \return                    The GPU buffer (or NULL, if the vector is empty).
+ * \throws std::runtime_error If the buffer could not be allocated or filled.
+ */
+template <typename T>
+static T *upload_vector(const std::vector<T>& v)
+{
+  if(v.empty()) return NULL;
+
+  T *result = NULL;
+  if(cudaMalloc(&result, v.size() * sizeof(T)) != cudaSuccess || cudaMemcpy(result, &v[0], v.size() * sizeof(T), cudaMemcpyHostToDevice) != cudaSuccess)
+  {
+    cudaFree(result);
+    throw std::runtime_error("Error: Could not upload the mean-field inference data to the GPU");
+  }
+
+  return result;
+}
+
+//#################### CONSTRUCTORS ####################
+
+MeanFieldUpdater_CUDA::MeanFieldUpdater_CUDA(int width, int height, int labelCount, const std::vector<float>& unaryPotentials,
+                                             const std::vector<float>& pairwisePotentials, const std::vector<int>& neighbourOffsets)
+: m_height(height),
+  m_labelCount(labelCount),
+  m_marginals(NULL),
+  m_neighbourOffsets(NULL),
+  m_neighbourCount(static_cast<int>(neighbourOffsets.size() / 2)),
+  m_newMarginals(NULL),
+  m_pairwisePotentials(NULL),
+  m_unaryPotentials(NULL),
+  m_unconvergedCount(NULL),
+  m_width(width)
+{
+  try
+  {
+    m_neighbourOffsets = upload_vector(neighbourOffsets);
+    m_pairwisePotentials = upload_vector(pairwisePotentials);
+    m_unaryPotentials = upload_vector(unaryPotentials);
+
+    const size_t size = unaryPotentials.size() * sizeof(float);
+    if(size > 0 && (cudaMalloc(&m_marginals, size) != cudaSuccess || cudaMalloc(&m_newMarginals, size) != cudaSuccess ||
+                    cudaMalloc(&m_unconvergedCount, sizeof(int)) != cudaSuccess))
+    {
+      throw std::runtime_error("Error: Could not allocate the mean-field inference buffers on the GPU");
+    }
+  }
+  catch(...)
+  {
+    // Since the destructor will not be called if construction fails, free any buffers that were allocated before rethrowing.
+    cudaFree(m_marginals);
+    cudaFree(m_neighbourOffsets);
+    cudaFree(m_newMarginals);
+    cudaFree(m_pairwisePotentials);
+    cudaFree(m_unaryPotentials);
+    cudaFree(m_unconvergedCount);
+    throw;
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+MeanFieldUpdater_CUDA::~MeanFieldUpdater_CUDA()
+{
+  cudaFree(m_marginals);
+  cudaFree(m_neighbourOffsets);
+  cudaFree(m_newMarginals);
+  cudaFree(m_pairwisePotentials);
+  cudaFree(m_unaryPotentials);
+  cudaFree(m_unconvergedCount);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t MeanFieldUpdater_CUDA::run(float *marginals, size_t maxIterations, float convergenceThreshold)
+{
+  const int pixelCount = m_width * m_height;
+  if(maxIterations == 0 || pixelCount == 0 || m_labelCount == 0) return 0;
+
+  const size_t size = pixelCount * m_labelCount * sizeof(float);
+  cudaMemcpy(m_marginals, marginals, size, cudaMemcpyHostToDevice);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  size_t iterations = 0;
+  while(iterations < maxIterations)
+  {
+    ck_compute_updated_pixels<<<numBlocks,threadsPerBlock>>>(
+      m_width, m_height, m_labelCount,
+      m_unaryPotentials,
+      m_marginals,
+      m_pairwisePotentials,
+      m_neighbourOffsets,
+      m_neighbourCount,
+      m_newMarginals
+    );
+
+    std::swap(m_marginals, m_newMarginals);
+    ++iterations;
+
+    // If we're running until convergence, count the pixels that changed by more than the threshold (only a single
+    // integer needs to be copied back to the host), and stop if there aren't any.
+    if(convergenceThreshold >= 0.0f)
+    {
+      int unconvergedCount = 0;
+      cudaMemset(m_unconvergedCount, 0, sizeof(int));
+      ck_count_unconverged_pixels<<<numBlocks,threadsPerBlock>>>(pixelCount, m_labelCount, m_newMarginals, m_marginals, convergenceThreshold, m_unconvergedCount);
+      cudaMemcpy(&unconvergedCount, m_unconvergedCount, sizeof(int), cudaMemcpyDeviceToHost);
+      if(unconvergedCount == 0) break;
+    }
+  }
+
+  cudaMemcpy(marginals, m_marginals, size, cudaMemcpyDeviceToHost);
+  return iterations;
+}
+
+}
@@ -0,0 +1,32 @@
+/**
+ * itmx: DeviceUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_DEVICEUTIL
+#define H_ITMX_DEVICEUTIL
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+namespace itmx {
+
+/**
+ * \brief This struct provides utility functions for working with the devices on which computations are run.
+ */
+struct DeviceUtil
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Waits for any work that has been queued on the specified device to finish.
+   *
+   * This is a no-op for the CPU, and for the GPU if the code has been built without CUDA support.
+   *
+   * \param deviceType  The device type.
+   */
+  static void synchronise(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
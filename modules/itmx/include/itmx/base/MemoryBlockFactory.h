@@ -6,6 +6,11 @@
 #ifndef H_ITMX_MEMORYBLOCKFACTORY
 #define H_ITMX_MEMORYBLOCKFACTORY
 
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
 
 #include <ITMLib/Utils/ITMLibSettings.h>
@@ -17,14 +22,123 @@ namespace itmx {
 
 /**
  * \brief An instance of this class can be used to make memory blocks.
+ *
+ * The factory keeps track of the memory blocks it has made that are still alive, so that the amount of memory
+ * they occupy on the CPU and GPU can be queried, grouped by the tags with which the blocks were made (normally
+ * the name of the component that owns them). Optionally, a budget can be set for the amount of GPU memory the
+ * blocks may occupy, in which case an attempt to make a block that would exceed it will throw an exception that
+ * names the offending tag, rather than allowing the GPU to run out of memory at some less convenient point.
+ *
+ * Note that only the memory blocks made by the factory are tracked (e.g. the memory allocated by InfiniTAM for
+ * its scenes is not), and that the budget is only enforced when a block is made, not when it is later resized.
+ *
+ * The factory can also lease out pooled memory blocks and images, which are intended for temporaries that would
+ * otherwise be made afresh on each call (e.g. once per frame). Their storage is rounded up to a power-of-two size
+ * class, and when the last reference to a leased block is dropped, the storage is returned to the pool rather
+ * than being freed, so that once the pool has warmed up, no further device allocations need to be made. A leased
+ * block must not be resized by its user (if it is, its storage will simply be freed rather than being pooled).
  */
 class MemoryBlockFactory
 {
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct describes the memory occupied by a group of live memory blocks.
+   */
+  struct MemoryUsage
+  {
+    /** The number of blocks in the group. */
+    size_t blockCount;
+
+    /** The number of bytes occupied by the blocks on the CPU. */
+    size_t cpuBytes;
+
+    /** The number of bytes occupied by the blocks on the GPU. */
+    size_t gpuBytes;
+
+    /** The tag with which the blocks in the group were made. */
+    std::string tag;
+  };
+
+private:
+  /**
+   * \brief An instance of this struct is used to unregister memory blocks from the factory when they are destroyed.
+   */
+  struct BlockDeleter
+  {
+    template <typename B>
+    void operator()(B *block) const
+    {
+      MemoryBlockFactory::instance().unregister_block(block);
+      delete block;
+    }
+  };
+
+  friend struct BlockDeleter;
+
+  /**
+   * \brief An instance of this struct identifies a set of interchangeable pooled storage blocks.
+   */
+  struct PoolKey
+  {
+    /** The number of elements that each storage block can hold. */
+    size_t capacity;
+
+    /** Whether or not the storage blocks are allocated on the GPU (as well as the CPU). */
+    bool onGPU;
+
+    /** The (implementation-defined) name of the element type of the storage blocks. */
+    std::string typeName;
+
+    bool operator<(const PoolKey& rhs) const
+    {
+      if(capacity != rhs.capacity) return capacity < rhs.capacity;
+      if(onGPU != rhs.onGPU) return onGPU < rhs.onGPU;
+      return typeName < rhs.typeName;
+    }
+  };
+
+  /**
+   * \brief An instance of this struct is used to return the storage of a leased memory block to the pool when the lease ends.
+   */
+  template <typename T>
+  struct LeaseReturner
+  {
+    /** The address of the storage's CPU data at the start of the lease (used to detect whether it was reallocated during the lease). */
+    const T *cpuData;
+
+    /** The key of the pool from which the storage was leased. */
+    PoolKey key;
+
+    /** The storage. */
+    boost::shared_ptr<ORUtils::Image<T> > storage;
+
+    LeaseReturner(const PoolKey& key_, const boost::shared_ptr<ORUtils::Image<T> >& storage_)
+    : cpuData(storage_->GetData(MEMORYDEVICE_CPU)), key(key_), storage(storage_)
+    {}
+
+    void operator()(ORUtils::Image<T> *) const
+    {
+      // The storage can only be reused if the user did not cause it to be reallocated.
+      const bool reusable = storage->GetData(MEMORYDEVICE_CPU) == cpuData && storage->dataSize <= key.capacity;
+      if(reusable) storage->dataSize = key.capacity;
+      MemoryBlockFactory::instance().return_to_pool(key, storage, reusable);
+    }
+  };
+
+  template <typename T> friend struct LeaseReturner;
+
+  /** The registry of live memory blocks (defined in the .cpp file to avoid exposing the threading headers to nvcc). */
+  struct Registry;
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The type of device on which the memory blocks will primarily be used. */
   ITMLib::ITMLibSettings::DeviceType m_deviceType;
 
+  /** The registry of live memory blocks. */
+  boost::shared_ptr<Registry> m_registry;
+
   //#################### SINGLETON IMPLEMENTATION ####################
 private:
   /**
@@ -42,32 +156,133 @@ public:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Frees the storage of any pooled memory blocks that are not currently leased.
+   */
+  void clear_pool();
+
+  /**
+   * \brief Gets the budget for the amount of GPU memory that the live memory blocks may occupy.
+   *
+   * \return  The budget (in bytes), or 0 if there is no budget.
+   */
+  size_t get_device_memory_budget() const;
+
+  /**
+   * \brief Gets the number of memory blocks the factory has allocated on the GPU since it was created.
+   *
+   * This can be used to check that the code that runs on every frame does not allocate any device memory once the pool has warmed up.
+   *
+   * \return The number of memory blocks the factory has allocated on the GPU since it was created.
+   */
+  size_t get_device_allocation_count() const;
+
+  /**
+   * \brief Gets the number of memory blocks the factory has freed on the GPU since it was created.
+   *
+   * \return The number of memory blocks the factory has freed on the GPU since it was created.
+   */
+  size_t get_device_free_count() const;
+
+  /**
+   * \brief Gets the memory occupied by the live memory blocks, grouped by tag.
+   *
+   * The groups are sorted in descending order of the amount of GPU memory they occupy (and then of the amount of CPU memory).
+   *
+   * \return  The memory occupied by the live memory blocks, grouped by tag.
+   */
+  std::vector<MemoryUsage> get_memory_usage() const;
+
+  /**
+   * \brief Gets the total memory occupied by the live memory blocks.
+   *
+   * \return  The total memory occupied by the live memory blocks.
+   */
+  MemoryUsage get_total_memory_usage() const;
+
   /**
    * \brief Makes a memory block of the specified type and size.
    *
-   * \param dataSize  The size of the memory block to make.
-   * \return          The memory block.
+   * \param dataSize            The size of the memory block to make.
+   * \param tag                 The tag with which to group the memory block when reporting memory usage.
+   * \return                    The memory block.
+   * \throws std::runtime_error If the memory block would cause the device memory budget to be exceeded.
    */
   template <typename T>
-  boost::shared_ptr<ORUtils::MemoryBlock<T> > make_block(size_t dataSize = 0) const
+  boost::shared_ptr<ORUtils::MemoryBlock<T> > make_block(size_t dataSize = 0, const std::string& tag = "") const
   {
     bool allocateGPU = m_deviceType == ITMLib::ITMLibSettings::DEVICE_CUDA;
-    return boost::shared_ptr<ORUtils::MemoryBlock<T> >(new ORUtils::MemoryBlock<T>(dataSize, true, allocateGPU));
+    if(allocateGPU) check_device_memory_budget(dataSize * sizeof(T), tag);
+    boost::shared_ptr<ORUtils::MemoryBlock<T> > block(new ORUtils::MemoryBlock<T>(dataSize, true, allocateGPU), BlockDeleter());
+    register_block(block.get(), &block->dataSize, sizeof(T), allocateGPU, tag);
+    return block;
   }
 
   /**
    * \brief Makes an image of the specified type and size.
    *
-   * \param size  The size of the image to make.
-   * \return      The image.
+   * \param size                The size of the image to make.
+   * \param tag                 The tag with which to group the image when reporting memory usage.
+   * \return                    The image.
+   * \throws std::runtime_error If the image would cause the device memory budget to be exceeded.
    */
   template <typename T>
-  boost::shared_ptr<ORUtils::Image<T> > make_image(const ORUtils::Vector2<int> size = ORUtils::Vector2<int>(0, 0)) const
+  boost::shared_ptr<ORUtils::Image<T> > make_image(const ORUtils::Vector2<int> size = ORUtils::Vector2<int>(0, 0), const std::string& tag = "") const
   {
-    bool allocateGPU = m_deviceType == ITMLib::ITMLibSettings::DEVICE_CUDA;
-    return boost::shared_ptr<ORUtils::Image<T> >(new ORUtils::Image<T>(size, true, allocateGPU));
+    return make_image_on<T>(size, m_deviceType == ITMLib::ITMLibSettings::DEVICE_CUDA, tag);
   }
 
+  /**
+   * \brief Leases a pooled memory block of the specified type and size.
+   *
+   * The lease ends (and the block's storage is returned to the pool) when the last reference to the block is dropped.
+   *
+   * \param dataSize            The size of the memory block to lease.
+   * \param tag                 The tag with which to group the memory block when reporting memory usage.
+   * \param cpuOnly             Whether or not to lease a block that is only allocated on the CPU, regardless of the factory's device type.
+   * \return                    The memory block.
+   * \throws std::runtime_error If new storage is needed for the memory block, and it would cause the device memory budget to be exceeded.
+   */
+  template <typename T>
+  boost::shared_ptr<ORUtils::MemoryBlock<T> > make_pooled_block(size_t dataSize, const std::string& tag = "", bool cpuOnly = false) const
+  {
+    return make_pooled_image<T>(ORUtils::Vector2<int>(static_cast<int>(dataSize), 1), tag, cpuOnly);
+  }
+
+  /**
+   * \brief Leases a pooled image of the specified type and size.
+   *
+   * The lease ends (and the image's storage is returned to the pool) when the last reference to the image is dropped.
+   *
+   * \param size                The size of the image to lease.
+   * \param tag                 The tag with which to group the image when reporting memory usage.
+   * \param cpuOnly             Whether or not to lease an image that is only allocated on the CPU, regardless of the factory's device type.
+   * \return                    The image.
+   * \throws std::runtime_error If new storage is needed for the image, and it would cause the device memory budget to be exceeded.
+   */
+  template <typename T>
+  boost::shared_ptr<ORUtils::Image<T> > make_pooled_image(const ORUtils::Vector2<int>& size, const std::string& tag = "", bool cpuOnly = false) const
+  {
+    const bool allocateGPU = !cpuOnly && m_deviceType == ITMLib::ITMLibSettings::DEVICE_CUDA;
+    const PoolKey key = make_pool_key(static_cast<size_t>(size.x) * size.y, allocateGPU, typeid(T).name());
+
+    // Reuse some existing storage from the pool if possible, or make some new storage if not.
+    boost::shared_ptr<ORUtils::Image<T> > storage = boost::static_pointer_cast<ORUtils::Image<T> >(take_from_pool(key, tag));
+    if(!storage) storage = make_image_on<T>(ORUtils::Vector2<int>(static_cast<int>(key.capacity), 1), allocateGPU, tag);
+
+    // Shrink the storage to the requested size (this does not cause it to be reallocated, since it has at least the requested capacity).
+    storage->ChangeDims(size, false);
+
+    return boost::shared_ptr<ORUtils::Image<T> >(storage.get(), LeaseReturner<T>(key, storage));
+  }
+
+  /**
+   * \brief Sets a budget for the amount of GPU memory that the live memory blocks may occupy.
+   *
+   * \param budget  The budget (in bytes), or 0 for no budget.
+   */
+  void set_device_memory_budget(size_t budget);
+
   /**
    * \brief Sets the type of device on which the memory blocks made by the factory will primarily be used.
    *
@@ -77,8 +292,96 @@ public:
    * \param deviceType  The type of device on which the memory blocks made by the factory will primarily be used.
    */
   void set_device_type(ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Checks that making a memory block with the specified tag that occupies the specified amount of GPU memory would not exceed the device memory budget.
+   *
+   * \param gpuBytes            The number of bytes the memory block would occupy on the GPU.
+   * \param tag                 The tag with which the memory block would be made.
+   * \throws std::runtime_error If the memory block would cause the device memory budget to be exceeded.
+   */
+  void check_device_memory_budget(size_t gpuBytes, const std::string& tag) const;
+
+  /**
+   * \brief Makes an image of the specified type and size, on the CPU and (optionally) the GPU.
+   *
+   * \param size                The size of the image to make.
+   * \param allocateGPU         Whether or not to allocate the image on the GPU (as well as the CPU).
+   * \param tag                 The tag with which to group the image when reporting memory usage.
+   * \return                    The image.
+   * \throws std::runtime_error If the image would cause the device memory budget to be exceeded.
+   */
+  template <typename T>
+  boost::shared_ptr<ORUtils::Image<T> > make_image_on(const ORUtils::Vector2<int>& size, bool allocateGPU, const std::string& tag) const
+  {
+    if(allocateGPU) check_device_memory_budget(static_cast<size_t>(size.x) * size.y * sizeof(T), tag);
+    boost::shared_ptr<ORUtils::Image<T> > image(new ORUtils::Image<T>(size, true, allocateGPU), BlockDeleter());
+    register_block(image.get(), &image->dataSize, sizeof(T), allocateGPU, tag);
+    return image;
+  }
+
+  /**
+   * \brief Makes the key of the pool from which to lease storage for a memory block with the specified properties.
+   *
+   * \param dataSize    The number of elements the memory block needs to hold.
+   * \param onGPU       Whether or not the memory block needs to be allocated on the GPU (as well as the CPU).
+   * \param typeName    The (implementation-defined) name of the memory block's element type.
+   * \return            The key of the pool from which to lease storage for the memory block.
+   */
+  static PoolKey make_pool_key(size_t dataSize, bool onGPU, const std::string& typeName);
+
+  /**
+   * \brief Registers a newly-made memory block so that the memory it occupies can be tracked.
+   *
+   * The size of the block is read from its dataSize field whenever the memory usage is queried, so that any resizing is taken into account.
+   *
+   * \param block       The memory block.
+   * \param dataSize    A pointer to the memory block's dataSize field.
+   * \param elementSize The size (in bytes) of each element of the memory block.
+   * \param onGPU       Whether or not the memory block is allocated on the GPU (as well as the CPU).
+   * \param tag         The tag with which the memory block was made.
+   */
+  void register_block(const void *block, const size_t *dataSize, size_t elementSize, bool onGPU, const std::string& tag) const;
+
+  /**
+   * \brief Returns the storage of a leased memory block to the pool from which it was leased.
+   *
+   * \param key         The key of the pool from which the storage was leased.
+   * \param storage     The storage.
+   * \param reusable    Whether or not the storage can be reused (if not, or if the pool is full, the storage is released instead).
+   */
+  void return_to_pool(const PoolKey& key, const boost::shared_ptr<void>& storage, bool reusable) const;
+
+  /**
+   * \brief Attempts to take some storage from the specified pool.
+   *
+   * \param key The key of the pool.
+   * \param tag The tag of the memory block that will use the storage.
+   * \return    The storage, or NULL if the pool is empty.
+   */
+  boost::shared_ptr<void> take_from_pool(const PoolKey& key, const std::string& tag) const;
+
+  /**
+   * \brief Unregisters a memory block that is about to be destroyed.
+   *
+   * \param block The memory block.
+   */
+  void unregister_block(const void *block) const;
 };
 
+//#################### STREAM OPERATORS ####################
+
+/**
+ * \brief Outputs the specified memory usage to a stream.
+ *
+ * \param os    The stream to which to output the memory usage.
+ * \param usage The memory usage to output.
+ * \return      The stream.
+ */
+std::ostream& operator<<(std::ostream& os, const MemoryBlockFactory::MemoryUsage& usage);
+
 }
 
 #endif
@@ -0,0 +1,154 @@
+/**
+ * itmx: DualQuaternionBatch.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_DUALQUATERNIONBATCH
+#define H_ITMX_DUALQUATERNIONBATCH
+
+#include <vector>
+
+#include "DualQuaternion.h"
+#include "shared/DualQuaternionBatch_Shared.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of an instantiation of this class template represents a batch of dual quaternions, stored in structure-of-arrays form.
+ *
+ * Each of the eight scalar components of the dual quaternions is stored in its own contiguous column, so that operations that
+ * process many dual quaternions at once (see DualQuaternionBatchUtil) can be vectorised by the compiler, and so that the columns
+ * can be copied across to the GPU as they are.
+ */
+template <typename T>
+class DualQuaternionBatch
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The columns containing the dual parts of the w^, x^, y^ and z^ components. */
+  std::vector<T> m_wd, m_xd, m_yd, m_zd;
+
+  /** The columns containing the real parts of the w^, x^, y^ and z^ components. */
+  std::vector<T> m_wr, m_xr, m_yr, m_zr;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a batch of dual quaternions.
+   *
+   * \param size  The initial number of dual quaternions in the batch (each of which is initially zero).
+   */
+  explicit DualQuaternionBatch(size_t size = 0)
+  {
+    resize(size);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the component columns of the batch.
+   *
+   * \return  The component columns of the batch (valid until the batch is next resized).
+   */
+  DualQuaternionColumns<T> columns()
+  {
+    DualQuaternionColumns<T> result;
+    result.wd = data_of(m_wd); result.xd = data_of(m_xd); result.yd = data_of(m_yd); result.zd = data_of(m_zd);
+    result.wr = data_of(m_wr); result.xr = data_of(m_xr); result.yr = data_of(m_yr); result.zr = data_of(m_zr);
+    return result;
+  }
+
+  /**
+   * \brief Gets the component columns of the batch.
+   *
+   * \note  The columns must not be written to.
+   *
+   * \return  The component columns of the batch (valid until the batch is next resized).
+   */
+  DualQuaternionColumns<T> columns() const
+  {
+    return const_cast<DualQuaternionBatch<T>*>(this)->columns();
+  }
+
+  /**
+   * \brief Gets the specified dual quaternion in the batch.
+   *
+   * \param i The index of the dual quaternion.
+   * \return  The dual quaternion.
+   */
+  DualQuaternion<T> get(size_t i) const
+  {
+    return DualQuaternion<T>(
+      DualNumber<T>(m_wr[i], m_wd[i]),
+      DualNumber<T>(m_xr[i], m_xd[i]),
+      DualNumber<T>(m_yr[i], m_yd[i]),
+      DualNumber<T>(m_zr[i], m_zd[i])
+    );
+  }
+
+  /**
+   * \brief Adds a dual quaternion to the end of the batch.
+   *
+   * \param dq  The dual quaternion.
+   */
+  void push_back(const DualQuaternion<T>& dq)
+  {
+    resize(size() + 1);
+    set(size() - 1, dq);
+  }
+
+  /**
+   * \brief Resizes the batch.
+   *
+   * \param size  The new number of dual quaternions in the batch (any new dual quaternions are initially zero).
+   */
+  void resize(size_t size)
+  {
+    m_wd.resize(size); m_xd.resize(size); m_yd.resize(size); m_zd.resize(size);
+    m_wr.resize(size); m_xr.resize(size); m_yr.resize(size); m_zr.resize(size);
+  }
+
+  /**
+   * \brief Sets the specified dual quaternion in the batch.
+   *
+   * \param i   The index of the dual quaternion.
+   * \param dq  The new value of the dual quaternion.
+   */
+  void set(size_t i, const DualQuaternion<T>& dq)
+  {
+    m_wd[i] = dq.w.d; m_xd[i] = dq.x.d; m_yd[i] = dq.y.d; m_zd[i] = dq.z.d;
+    m_wr[i] = dq.w.r; m_xr[i] = dq.x.r; m_yr[i] = dq.y.r; m_zr[i] = dq.z.r;
+  }
+
+  /**
+   * \brief Gets the number of dual quaternions in the batch.
+   *
+   * \return  The number of dual quaternions in the batch.
+   */
+  size_t size() const
+  {
+    return m_wr.size();
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets a pointer to the data in the specified column.
+   *
+   * \param column  The column.
+   * \return        A pointer to the data in the column, or NULL if the column is empty.
+   */
+  static T *data_of(std::vector<T>& column)
+  {
+    return column.empty() ? NULL : &column[0];
+  }
+};
+
+//#################### TYPEDEFS ####################
+
+typedef DualQuaternionBatch<double> DualQuatBatchd;
+typedef DualQuaternionBatch<float> DualQuatBatchf;
+
+}
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * itmx: DualQuaternionBatchUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_DUALQUATERNIONBATCHUTIL
+#define H_ITMX_DUALQUATERNIONBATCHUTIL
+
+#include <stdexcept>
+#include <vector>
+
+#include "DualQuaternionBatch.h"
+
+namespace itmx {
+
+/**
+ * \brief This struct provides utility functions that interpolate, blend and smooth whole batches of rigid-body transforms on the CPU.
+ *
+ * Batches are stored in structure-of-arrays form (see DualQuaternionBatch). The blending loops run directly over the component
+ * columns, so that the compiler can vectorise them, and the element-wise operations are parallelised with OpenMP when the batches
+ * are large enough to make that worthwhile. See DualQuaternionBatchUtil_CUDA for the equivalent operations on the GPU.
+ *
+ * Unlike DualQuaternion::sclerp and DualQuaternion::linear_blend, these functions always take the shorter path between two transforms
+ * (q^ and -q^ represent the same transform), and cope with pure translations.
+ */
+struct DualQuaternionBatchUtil
+{
+  //#################### CONSTANTS ####################
+
+  /** The minimum number of elements in a batch for element-wise operations to be parallelised. */
+  enum { MIN_PARALLEL_BATCH_SIZE = 256 };
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Calculates the average of a batch of unit dual quaternions.
+   *
+   * \param dqs                     The dual quaternions.
+   * \return                        The average of the dual quaternions.
+   * \throws std::invalid_argument  If the batch is empty.
+   */
+  template <typename T>
+  static DualQuaternion<T> average(const DualQuaternionBatch<T>& dqs)
+  {
+    return blend(dqs, std::vector<T>(dqs.size(), static_cast<T>(1)));
+  }
+
+  /**
+   * \brief Performs a weighted linear blend of a batch of unit dual quaternions.
+   *
+   * Each dual quaternion is first aligned with the hemisphere of the first one, and the result is normalised
+   * to ensure that it is another unit dual quaternion.
+   *
+   * \param dqs                     The dual quaternions.
+   * \param weights                 The corresponding (non-negative) weights.
+   * \return                        The result of blending the dual quaternions.
+   * \throws std::invalid_argument  If the batch is empty, or the number of weights does not match the number of dual quaternions.
+   */
+  template <typename T>
+  static DualQuaternion<T> blend(const DualQuaternionBatch<T>& dqs, const std::vector<T>& weights)
+  {
+    if(dqs.size() == 0) throw std::invalid_argument("Error: Cannot blend an empty batch of dual quaternions");
+    if(weights.size() != dqs.size()) throw std::invalid_argument("Error: The number of weights must match the number of dual quaternions being blended");
+
+    const DualQuaternionColumns<T> c = dqs.columns();
+    const T *weightsPtr = &weights[0];
+    const int count = static_cast<int>(dqs.size());
+    const T wr0 = c.wr[0], xr0 = c.xr[0], yr0 = c.yr[0], zr0 = c.zr[0];
+
+    T wr = 0, xr = 0, yr = 0, zr = 0, wd = 0, xd = 0, yd = 0, zd = 0;
+#if defined(WITH_OPENMP) && _OPENMP >= 201307
+    #pragma omp simd reduction(+:wr,xr,yr,zr,wd,xd,yd,zd)
+#endif
+    for(int i = 0; i < count; ++i)
+    {
+      const T alignment = c.wr[i] * wr0 + c.xr[i] * xr0 + c.yr[i] * yr0 + c.zr[i] * zr0;
+      const T k = alignment < 0 ? -weightsPtr[i] : weightsPtr[i];
+      wr += k * c.wr[i]; xr += k * c.xr[i]; yr += k * c.yr[i]; zr += k * c.zr[i];
+      wd += k * c.wd[i]; xd += k * c.xd[i]; yd += k * c.yd[i]; zd += k * c.zd[i];
+    }
+
+    DualQuaternionElement<T> acc;
+    acc.r[0] = wr; acc.r[1] = xr; acc.r[2] = yr; acc.r[3] = zr;
+    acc.d[0] = wd; acc.d[1] = xd; acc.d[2] = yd; acc.d[3] = zd;
+    return to_dual_quaternion(normalise_element(acc));
+  }
+
+  /**
+   * \brief Resamples a trajectory of unit dual quaternions at the specified query times, using ScLERP between the samples either side of each query time.
+   *
+   * This can be used to align poses from sources with different timestamps (e.g. a tracker and a camera). Query times before
+   * the first sample or after the last sample are clamped to the ends of the trajectory.
+   *
+   * \param sampleTimes             The times of the samples (in ascending order).
+   * \param samples                 The samples.
+   * \param queryTimes              The query times.
+   * \param result                  A batch into which to write the resampled dual quaternions (one per query time).
+   * \throws std::invalid_argument  If there are no samples, or the number of sample times does not match the number of samples.
+   */
+  template <typename T>
+  static void resample(const std::vector<T>& sampleTimes, const DualQuaternionBatch<T>& samples, const std::vector<T>& queryTimes, DualQuaternionBatch<T>& result)
+  {
+    if(samples.size() == 0) throw std::invalid_argument("Error: Cannot resample an empty trajectory");
+    if(sampleTimes.size() != samples.size()) throw std::invalid_argument("Error: The number of sample times must match the number of samples");
+
+    result.resize(queryTimes.size());
+
+    const DualQuaternionColumns<T> samplesC = samples.columns(), resultC = result.columns();
+    const T *sampleTimesPtr = &sampleTimes[0];
+    const int sampleCount = static_cast<int>(samples.size());
+    const int queryCount = static_cast<int>(queryTimes.size());
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for if(queryCount >= MIN_PARALLEL_BATCH_SIZE)
+#endif
+    for(int i = 0; i < queryCount; ++i)
+    {
+      store_element(resample_trajectory(sampleTimesPtr, samplesC, sampleCount, queryTimes[i]), i, resultC);
+    }
+  }
+
+  /**
+   * \brief Interpolates between corresponding pairs of unit dual quaternions in two batches using ScLERP.
+   *
+   * \param lhs                     The first batch.
+   * \param rhs                     The second batch.
+   * \param ts                      The interpolation parameter for each pair (each in the range [0,1]).
+   * \param result                  A batch into which to write the interpolated dual quaternions.
+   * \throws std::invalid_argument  If the batches and interpolation parameters are not all the same size.
+   */
+  template <typename T>
+  static void sclerp(const DualQuaternionBatch<T>& lhs, const DualQuaternionBatch<T>& rhs, const std::vector<T>& ts, DualQuaternionBatch<T>& result)
+  {
+    if(rhs.size() != lhs.size() || ts.size() != lhs.size())
+    {
+      throw std::invalid_argument("Error: The batches of dual quaternions and interpolation parameters must all be the same size");
+    }
+
+    result.resize(lhs.size());
+
+    const DualQuaternionColumns<T> lhsC = lhs.columns(), rhsC = rhs.columns(), resultC = result.columns();
+    const int count = static_cast<int>(lhs.size());
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for if(count >= MIN_PARALLEL_BATCH_SIZE)
+#endif
+    for(int i = 0; i < count; ++i)
+    {
+      store_element(sclerp_elements(load_element(i, lhsC), load_element(i, rhsC), ts[i]), i, resultC);
+    }
+  }
+
+  /**
+   * \brief Smooths a trajectory of unit dual quaternions by blending each sample with the samples around it using Gaussian weights.
+   *
+   * \param samples The samples.
+   * \param radius  The number of samples either side of each sample to blend with it (the standard deviation of the Gaussian is half this).
+   * \param result  A batch into which to write the smoothed samples (must not be the same as the input batch).
+   */
+  template <typename T>
+  static void smooth(const DualQuaternionBatch<T>& samples, int radius, DualQuaternionBatch<T>& result)
+  {
+    result.resize(samples.size());
+
+    const DualQuaternionColumns<T> samplesC = samples.columns(), resultC = result.columns();
+    const int count = static_cast<int>(samples.size());
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for if(count >= MIN_PARALLEL_BATCH_SIZE)
+#endif
+    for(int i = 0; i < count; ++i)
+    {
+      store_element(smooth_trajectory_sample(i, samplesC, count, radius), i, resultC);
+    }
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Converts a dual quaternion element to a dual quaternion.
+   *
+   * \param q The dual quaternion element.
+   * \return  The corresponding dual quaternion.
+   */
+  template <typename T>
+  static DualQuaternion<T> to_dual_quaternion(const DualQuaternionElement<T>& q)
+  {
+    return DualQuaternion<T>(
+      DualNumber<T>(q.r[0], q.d[0]),
+      DualNumber<T>(q.r[1], q.d[1]),
+      DualNumber<T>(q.r[2], q.d[2]),
+      DualNumber<T>(q.r[3], q.d[3])
+    );
+  }
+};
+
+}
+
+#endif
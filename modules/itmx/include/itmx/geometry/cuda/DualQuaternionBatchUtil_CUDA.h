@@ -0,0 +1,62 @@
+/**
+ * itmx: DualQuaternionBatchUtil_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_DUALQUATERNIONBATCHUTIL_CUDA
+#define H_ITMX_DUALQUATERNIONBATCHUTIL_CUDA
+
+#include "../shared/DualQuaternionBatch_Shared.h"
+
+namespace itmx {
+
+/**
+ * \brief This struct provides utility functions that interpolate and smooth whole batches of rigid-body transforms using CUDA.
+ *
+ * These are the GPU equivalents of the corresponding functions in DualQuaternionBatchUtil. All of the columns, times and
+ * interpolation parameters passed to them must be in device memory, and the batches must be stored in structure-of-arrays
+ * form exactly as in DualQuaternionBatch (so that a batch can be copied across to the GPU one column at a time).
+ */
+struct DualQuaternionBatchUtil_CUDA
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Resamples a trajectory of unit dual quaternions at the specified query times, using ScLERP between the samples either side of each query time.
+   *
+   * \param sampleTimes The times of the samples (in ascending order).
+   * \param samples     The samples.
+   * \param sampleCount The number of samples (must be at least 1).
+   * \param queryTimes  The query times.
+   * \param queryCount  The number of query times.
+   * \param result      The columns into which to write the resampled dual quaternions (one per query time).
+   */
+  static void resample(const float *sampleTimes, const DualQuaternionColumns<float>& samples, int sampleCount,
+                       const float *queryTimes, int queryCount, const DualQuaternionColumns<float>& result);
+
+  /**
+   * \brief Interpolates between corresponding pairs of unit dual quaternions in two batches using ScLERP.
+   *
+   * \param lhs     The first batch.
+   * \param rhs     The second batch.
+   * \param ts      The interpolation parameter for each pair (each in the range [0,1]).
+   * \param count   The number of pairs.
+   * \param result  The columns into which to write the interpolated dual quaternions.
+   */
+  static void sclerp(const DualQuaternionColumns<float>& lhs, const DualQuaternionColumns<float>& rhs, const float *ts, int count,
+                     const DualQuaternionColumns<float>& result);
+
+  /**
+   * \brief Smooths a trajectory of unit dual quaternions by blending each sample with the samples around it using Gaussian weights.
+   *
+   * \param samples     The samples.
+   * \param sampleCount The number of samples.
+   * \param radius      The number of samples either side of each sample to blend with it (the standard deviation of the Gaussian is half this).
+   * \param result      The columns into which to write the smoothed samples (must not alias the samples).
+   */
+  static void smooth(const DualQuaternionColumns<float>& samples, int sampleCount, int radius, const DualQuaternionColumns<float>& result);
+};
+
+}
+
+#endif
@@ -0,0 +1,352 @@
+/**
+ * itmx: DualQuaternionBatch_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_DUALQUATERNIONBATCH_SHARED
+#define H_ITMX_DUALQUATERNIONBATCH_SHARED
+
+#include <cmath>
+
+#include <ORUtils/PlatformIndependence.h>
+
+namespace itmx {
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of an instantiation of this struct template holds pointers to the component columns of a batch of dual quaternions.
+ *
+ * Column i of each array describes the same dual quaternion q^_i = w^ + x^.i + y^.j + z^.k, where each of w^, x^, y^ and z^ is
+ * a dual number whose real and dual parts are stored in the corresponding r and d columns.
+ */
+template <typename T>
+struct DualQuaternionColumns
+{
+  /** The dual parts of the w^, x^, y^ and z^ components. */
+  T *wd, *xd, *yd, *zd;
+
+  /** The real parts of the w^, x^, y^ and z^ components. */
+  T *wr, *xr, *yr, *zr;
+};
+
+/**
+ * \brief An instance of an instantiation of this struct template holds the components of a single dual quaternion in a form that can be used on the GPU.
+ *
+ * The components are stored in the order w, x, y, z.
+ */
+template <typename T>
+struct DualQuaternionElement
+{
+  /** The dual part of the dual quaternion. */
+  T d[4];
+
+  /** The real part of the dual quaternion. */
+  T r[4];
+};
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Multiplies two quaternions together.
+ *
+ * \param p   The first quaternion (w, x, y, z).
+ * \param q   The second quaternion (w, x, y, z).
+ * \param out An array into which to write the product p * q (must not alias either operand).
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline void multiply_quaternions(const T *p, const T *q, T *out)
+{
+  out[0] = p[0]*q[0] - p[1]*q[1] - p[2]*q[2] - p[3]*q[3];
+  out[1] = p[0]*q[1] + p[1]*q[0] + p[2]*q[3] - p[3]*q[2];
+  out[2] = p[0]*q[2] - p[1]*q[3] + p[2]*q[0] + p[3]*q[1];
+  out[3] = p[0]*q[3] + p[1]*q[2] - p[2]*q[1] + p[3]*q[0];
+}
+
+/**
+ * \brief Adds a weighted dual quaternion to an accumulator, negating it first if necessary so that its real part lies in the same hemisphere as that of a reference.
+ *
+ * Since q^ and -q^ represent the same rigid-body transform, aligning the inputs in this way stops antipodal pairs from cancelling each other out.
+ *
+ * \param q       The dual quaternion.
+ * \param weight  The weight with which to add it (must be non-negative).
+ * \param ref     The reference dual quaternion.
+ * \param acc     The accumulator.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline void accumulate_aligned_element(const DualQuaternionElement<T>& q, T weight, const DualQuaternionElement<T>& ref, DualQuaternionElement<T>& acc)
+{
+  const T alignment = q.r[0]*ref.r[0] + q.r[1]*ref.r[1] + q.r[2]*ref.r[2] + q.r[3]*ref.r[3];
+  const T k = alignment < 0 ? -weight : weight;
+  for(int i = 0; i < 4; ++i)
+  {
+    acc.r[i] += k * q.r[i];
+    acc.d[i] += k * q.d[i];
+  }
+}
+
+/**
+ * \brief Calculates the conjugate of a dual quaternion.
+ *
+ * \param q The dual quaternion.
+ * \return  The conjugate of the dual quaternion.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> conjugate_element(const DualQuaternionElement<T>& q)
+{
+  DualQuaternionElement<T> result;
+  result.r[0] = q.r[0]; result.r[1] = -q.r[1]; result.r[2] = -q.r[2]; result.r[3] = -q.r[3];
+  result.d[0] = q.d[0]; result.d[1] = -q.d[1]; result.d[2] = -q.d[2]; result.d[3] = -q.d[3];
+  return result;
+}
+
+/**
+ * \brief Loads the specified dual quaternion from a batch.
+ *
+ * \param i       The index of the dual quaternion in the batch.
+ * \param columns The component columns of the batch.
+ * \return        The dual quaternion.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> load_element(int i, const DualQuaternionColumns<T>& columns)
+{
+  DualQuaternionElement<T> q;
+  q.r[0] = columns.wr[i]; q.r[1] = columns.xr[i]; q.r[2] = columns.yr[i]; q.r[3] = columns.zr[i];
+  q.d[0] = columns.wd[i]; q.d[1] = columns.xd[i]; q.d[2] = columns.yd[i]; q.d[3] = columns.zd[i];
+  return q;
+}
+
+/**
+ * \brief Multiplies two dual quaternions together.
+ *
+ * \param p The first operand.
+ * \param q The second operand.
+ * \return  The result of the operation.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> multiply_elements(const DualQuaternionElement<T>& p, const DualQuaternionElement<T>& q)
+{
+  // (pr + e.pd)(qr + e.qd) = pr.qr + e.(pr.qd + pd.qr), since e^2 = 0.
+  DualQuaternionElement<T> result;
+  T rd[4], dr[4];
+  multiply_quaternions(p.r, q.r, result.r);
+  multiply_quaternions(p.r, q.d, rd);
+  multiply_quaternions(p.d, q.r, dr);
+  for(int i = 0; i < 4; ++i) result.d[i] = rd[i] + dr[i];
+  return result;
+}
+
+/**
+ * \brief Calculates a normalised version of a dual quaternion.
+ *
+ * \param q The dual quaternion (its real part must be non-zero).
+ * \return  A normalised version of the dual quaternion.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> normalise_element(const DualQuaternionElement<T>& q)
+{
+  // The norm of q^ is the dual number |qr| + e.(qr.qd / |qr|), whose inverse is 1/|qr| - e.(qr.qd / |qr|^3).
+  const T realDot = q.r[0]*q.r[0] + q.r[1]*q.r[1] + q.r[2]*q.r[2] + q.r[3]*q.r[3];
+  const T mixedDot = q.r[0]*q.d[0] + q.r[1]*q.d[1] + q.r[2]*q.d[2] + q.r[3]*q.d[3];
+  const T invNorm = 1 / sqrt(realDot);
+  const T k = mixedDot / realDot;
+
+  DualQuaternionElement<T> result;
+  for(int i = 0; i < 4; ++i)
+  {
+    result.r[i] = q.r[i] * invNorm;
+    result.d[i] = (q.d[i] - q.r[i] * k) * invNorm;
+  }
+  return result;
+}
+
+/**
+ * \brief Raises a unit dual quaternion to the specified power, via its screw representation.
+ *
+ * Unlike DualQuaternion::pow, this also handles (near-)pure translations, whose screw axis is undefined.
+ *
+ * \param q         The unit dual quaternion.
+ * \param exponent  The exponent.
+ * \return          The result of raising the dual quaternion to the specified power.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> pow_element(const DualQuaternionElement<T>& q, T exponent)
+{
+  DualQuaternionElement<T> result;
+
+  const T vrLengthSquared = q.r[1]*q.r[1] + q.r[2]*q.r[2] + q.r[3]*q.r[3];
+  if(vrLengthSquared < static_cast<T>(1e-12))
+  {
+    // The dual quaternion is a pure translation 1 + e.qd (up to sign), so raising it to a power simply scales its dual part.
+    const T sign = q.r[0] < 0 ? static_cast<T>(-1) : static_cast<T>(1);
+    result.r[0] = 1; result.r[1] = result.r[2] = result.r[3] = 0;
+    for(int i = 0; i < 4; ++i) result.d[i] = sign * exponent * q.d[i];
+    return result;
+  }
+
+  // See "Dual-Quaternions: From Classical Mechanics to Computer Graphics and Beyond" by Ben Kenwright.
+  const T invVrLength = 1 / sqrt(vrLengthSquared);
+  const T wr = q.r[0] < -1 ? -1 : q.r[0] > 1 ? 1 : q.r[0];
+  const T wd = q.d[0];
+
+  const T screwPitch = -2 * wd * invVrLength;
+
+  T direction[3], moment[3];
+  for(int i = 0; i < 3; ++i)
+  {
+    direction[i] = q.r[i+1] * invVrLength;
+    moment[i] = (q.d[i+1] - direction[i] * (screwPitch * wr / 2)) * invVrLength;
+  }
+
+  // Scale the screw angle and pitch by the exponent, and convert the screw back to a dual quaternion.
+  const T angle = 2 * acos(wr) * exponent;
+  const T pitch = screwPitch * exponent;
+
+  const T c = cos(angle / 2), s = sin(angle / 2);
+  result.r[0] = c;
+  result.d[0] = -pitch * s / 2;
+  for(int i = 0; i < 3; ++i)
+  {
+    result.r[i+1] = direction[i] * s;
+    result.d[i+1] = moment[i] * s + pitch * direction[i] * c / 2;
+  }
+  return result;
+}
+
+/**
+ * \brief Interpolates between two unit dual quaternions using the ScLERP approach, taking the shorter path between them.
+ *
+ * \param lhs The first dual quaternion.
+ * \param rhs The second dual quaternion.
+ * \param t   The interpolation parameter (in the range [0,1]).
+ * \return    The interpolated dual quaternion.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> sclerp_elements(const DualQuaternionElement<T>& lhs, const DualQuaternionElement<T>& rhs, T t)
+{
+  if(t == 0) return lhs;
+
+  DualQuaternionElement<T> delta = multiply_elements(conjugate_element(lhs), rhs);
+  if(delta.r[0] < 0)
+  {
+    for(int i = 0; i < 4; ++i)
+    {
+      delta.r[i] = -delta.r[i];
+      delta.d[i] = -delta.d[i];
+    }
+  }
+
+  return multiply_elements(lhs, pow_element(delta, t));
+}
+
+/**
+ * \brief Stores a dual quaternion into a batch.
+ *
+ * \param q       The dual quaternion.
+ * \param i       The index in the batch at which to store it.
+ * \param columns The component columns of the batch.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline void store_element(const DualQuaternionElement<T>& q, int i, const DualQuaternionColumns<T>& columns)
+{
+  columns.wr[i] = q.r[0]; columns.xr[i] = q.r[1]; columns.yr[i] = q.r[2]; columns.zr[i] = q.r[3];
+  columns.wd[i] = q.d[0]; columns.xd[i] = q.d[1]; columns.yd[i] = q.d[2]; columns.zd[i] = q.d[3];
+}
+
+/**
+ * \brief Finds the pair of samples of a trajectory between which the specified query time lies.
+ *
+ * \param sampleTimes The times of the samples (in ascending order).
+ * \param sampleCount The number of samples (must be at least 1).
+ * \param queryTime   The query time.
+ * \param t           A location into which to write the interpolation parameter between the two samples (in the range [0,1]).
+ * \return            The index of the first sample of the pair (the second is the one after it, or the same one if the query time is out of range).
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline int find_bracketing_samples(const T *sampleTimes, int sampleCount, T queryTime, T& t)
+{
+  t = 0;
+  if(queryTime <= sampleTimes[0]) return 0;
+  if(queryTime >= sampleTimes[sampleCount - 1]) return sampleCount - 1;
+
+  // Find the last sample whose time is at most the query time.
+  int lo = 0, hi = sampleCount - 1;
+  while(hi - lo > 1)
+  {
+    const int mid = (lo + hi) / 2;
+    if(sampleTimes[mid] <= queryTime) lo = mid;
+    else hi = mid;
+  }
+
+  const T interval = sampleTimes[hi] - sampleTimes[lo];
+  if(interval > 0) t = (queryTime - sampleTimes[lo]) / interval;
+  return lo;
+}
+
+/**
+ * \brief Resamples a trajectory at the specified query time, by interpolating between the samples either side of it using ScLERP.
+ *
+ * Query times before the first sample or after the last sample are clamped to the ends of the trajectory.
+ *
+ * \param sampleTimes The times of the samples (in ascending order).
+ * \param samples     The component columns of the samples.
+ * \param sampleCount The number of samples (must be at least 1).
+ * \param queryTime   The query time.
+ * \return            The resampled dual quaternion.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> resample_trajectory(const T *sampleTimes, const DualQuaternionColumns<T>& samples, int sampleCount, T queryTime)
+{
+  T t;
+  const int i = find_bracketing_samples(sampleTimes, sampleCount, queryTime, t);
+  const DualQuaternionElement<T> lhs = load_element(i, samples);
+  return t > 0 ? sclerp_elements(lhs, load_element(i + 1, samples), t) : lhs;
+}
+
+/**
+ * \brief Smooths the specified sample of a trajectory by blending it with the samples around it using Gaussian weights.
+ *
+ * \param i           The index of the sample to smooth.
+ * \param samples     The component columns of the samples.
+ * \param sampleCount The number of samples.
+ * \param radius      The number of samples either side of the sample to blend with it (the standard deviation of the Gaussian is half this).
+ * \return            The smoothed sample.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_
+inline DualQuaternionElement<T> smooth_trajectory_sample(int i, const DualQuaternionColumns<T>& samples, int sampleCount, int radius)
+{
+  const DualQuaternionElement<T> ref = load_element(i, samples);
+  if(radius <= 0) return ref;
+
+  const T sigma = static_cast<T>(radius) / 2;
+  const T invTwoSigmaSquared = 1 / (2 * sigma * sigma);
+
+  DualQuaternionElement<T> acc;
+  for(int k = 0; k < 4; ++k) acc.r[k] = acc.d[k] = 0;
+
+  const int first = i - radius < 0 ? 0 : i - radius;
+  const int last = i + radius >= sampleCount ? sampleCount - 1 : i + radius;
+  for(int j = first; j <= last; ++j)
+  {
+    const T offset = static_cast<T>(j - i);
+    accumulate_aligned_element(load_element(j, samples), static_cast<T>(exp(-offset * offset * invTwoSigmaSquared)), ref, acc);
+  }
+
+  return normalise_element(acc);
+}
+
+}
+
+#endif
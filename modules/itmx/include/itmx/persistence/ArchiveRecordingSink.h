@@ -0,0 +1,77 @@
+/**
+ * itmx: ArchiveRecordingSink.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_ARCHIVERECORDINGSINK
+#define H_ITMX_ARCHIVERECORDINGSINK
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "RecordingSink.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to write the recorded frames losslessly into a single chunked archive file.
+ *
+ * The archive starts with the 8-byte signature "SPTARCH1". Each image is then stored as a chunk that consists of a 4-byte tag
+ * ("RGBA" for an RGB image, or "DPTH" for a depth image), followed by the index of the frame, the width and the height of the
+ * image (each as a 32-bit little-endian integer), followed by the raw pixel data in host byte order (4 bytes per pixel for RGB images, or 2 bytes
+ * per pixel for depth images). Since no compression is performed, writing a frame costs little more than the disk bandwidth.
+ */
+class ArchiveRecordingSink : public RecordingSink
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The index of the next frame to be written. */
+  int m_frameIndex;
+
+  /** The stream to the archive file. */
+  std::ofstream m_fs;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an archive recording sink.
+   *
+   * \param path                The path to the archive file.
+   * \param maxQueueSize        The maximum number of frames that can be waiting to be written.
+   * \throws std::runtime_error If the archive file could not be opened.
+   */
+  ArchiveRecordingSink(const boost::filesystem::path& path, size_t maxQueueSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the sink, waiting for any frames that are still in the queue to be written.
+   */
+  ~ArchiveRecordingSink();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose);
+
+  /**
+   * \brief Writes an image to the archive as a chunk.
+   *
+   * \param tag   The tag identifying the type of the chunk.
+   * \param image The image to write.
+   */
+  template <typename T>
+  void write_chunk(const char *tag, const ORUtils::Image<T>& image);
+
+  /**
+   * \brief Writes a 32-bit integer to the archive in little-endian order.
+   *
+   * \param value The integer to write.
+   */
+  void write_int(int value);
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * itmx: EncoderRecordingSink.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_ENCODERRECORDINGSINK
+#define H_ITMX_ENCODERRECORDINGSINK
+
+#include <cstdio>
+
+#include <boost/filesystem.hpp>
+
+#include "RecordingSink.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to stream the RGB images of the recorded frames into a single video file.
+ *
+ * The frames are piped as raw RGBA data into an external ffmpeg process, which must be on the path. This makes it possible
+ * to use any codec that ffmpeg supports, including hardware-accelerated ones such as h264_nvenc or hevc_nvenc, without
+ * linking against a video library. Since the size of the video is fixed when the encoder is started, any frame whose
+ * RGB image is not the same size as that of the first frame is rejected. The depth images (if any) are ignored.
+ */
+class EncoderRecordingSink : public RecordingSink
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The name of the ffmpeg codec with which to encode the video (e.g. "h264_nvenc"). */
+  std::string m_codec;
+
+  /** The frame rate of the video. */
+  int m_frameRate;
+
+  /** The size of the video (determined by the first frame). */
+  Vector2i m_frameSize;
+
+  /** The path to the video file. */
+  boost::filesystem::path m_path;
+
+  /** The pipe to the encoder process (if it has been started). */
+  FILE *m_pipe;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an encoder recording sink.
+   *
+   * \param path          The path to the video file.
+   * \param codec         The name of the ffmpeg codec with which to encode the video.
+   * \param frameRate     The frame rate of the video.
+   * \param maxQueueSize  The maximum number of frames that can be waiting to be written.
+   */
+  EncoderRecordingSink(const boost::filesystem::path& path, const std::string& codec, int frameRate, size_t maxQueueSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the sink, waiting for any frames that are still in the queue to be encoded and then for the encoder to finish.
+   */
+  ~EncoderRecordingSink();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Starts the encoder process.
+   *
+   * \param frameSize           The size of the video.
+   * \throws std::runtime_error If the encoder process could not be started.
+   */
+  void start_encoder(const Vector2i& frameSize);
+
+  /** Override */
+  virtual void write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose);
+};
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * itmx: FileRecordingSink.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_FILERECORDINGSINK
+#define H_ITMX_FILERECORDINGSINK
+
+#include <tvgutil/filesystem/SequentialPathGenerator.h>
+
+#include "ImagePersister.h"
+#include "RecordingSink.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to write each recorded frame to a separate set of numbered image files.
+ *
+ * This produces a sequence that can be read back directly by InfiniTAM's image file readers, at the cost of one file per image.
+ */
+class FileRecordingSink : public RecordingSink
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The pattern to use when constructing the paths of the depth images (e.g. "depthm%06i.pgm"). */
+  std::string m_depthPattern;
+
+  /** The path generator used to number the files. */
+  tvgutil::SequentialPathGenerator m_pathGenerator;
+
+  /** The level of compression to use for any images that are saved in PNG format. */
+  ImagePersister::PNGCompressionLevel m_pngCompressionLevel;
+
+  /** The pattern to use when constructing the paths of the RGB images (e.g. "rgbm%06i.ppm"). */
+  std::string m_rgbPattern;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a file recording sink.
+   *
+   * \param baseDir             The directory into which to write the files.
+   * \param rgbPattern          The pattern to use when constructing the paths of the RGB images.
+   * \param depthPattern        The pattern to use when constructing the paths of the depth images.
+   * \param maxQueueSize        The maximum number of frames that can be waiting to be written.
+   * \param pngCompressionLevel The level of compression to use for any images that are saved in PNG format.
+   */
+  FileRecordingSink(const boost::filesystem::path& baseDir, const std::string& rgbPattern, const std::string& depthPattern, size_t maxQueueSize,
+                    ImagePersister::PNGCompressionLevel pngCompressionLevel = ImagePersister::PCL_FAST);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the sink, waiting for any frames that are still in the queue to be written.
+   */
+  ~FileRecordingSink();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose);
+};
+
+}
+
+#endif
@@ -35,6 +35,21 @@ public:
     IFT_UNKNOWN
   };
 
+  /**
+   * \brief The values of this enumeration represent the supported levels of compression for PNG images.
+   */
+  enum PNGCompressionLevel
+  {
+    /** Store the image data without compressing it (fastest, but produces the largest files). */
+    PCL_NONE,
+
+    /** Compress the image data, favouring speed over file size (e.g. for recording sequences). */
+    PCL_FAST,
+
+    /** Compress the image data using the default settings, which produce smaller files at a greater cost. */
+    PCL_DEFAULT
+  };
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -47,15 +62,31 @@ public:
    */
   static ITMUChar4Image_Ptr load_rgba_image(const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
 
+  /**
+   * \brief Attempts to load a short image (e.g. a depth image) from a file.
+   *
+   * Only 16-bit greyscale PNG files (as written by save_image) are currently supported.
+   *
+   * \param path                The path to the file from which to load the image.
+   * \param fileType            The image file type.
+   * \return                    The loaded image.
+   * \throws std::runtime_error If the image could not be loaded.
+   */
+  static ITMShortImage_Ptr load_short_image(const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
+
   /**
    * \brief Attempts to save a short image to a file.
    *
+   * Short images are saved in PNG files as 16-bit greyscale images, which (unlike PGM files) are losslessly compressed.
+   *
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use (if the image is saved in PNG format).
    * \throws std::runtime_error If the image could not be saved.
    */
-  static void save_image(const ITMShortImage_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
+  static void save_image(const ITMShortImage_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN,
+                         PNGCompressionLevel compressionLevel = PCL_DEFAULT);
 
   /**
    * \brief Attempts to save an RGBA image to a file.
@@ -63,9 +94,11 @@ public:
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use (if the image is saved in PNG format).
    * \throws std::runtime_error If the image could not be saved.
    */
-  static void save_image(const ITMUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
+  static void save_image(const ITMUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN,
+                         PNGCompressionLevel compressionLevel = PCL_DEFAULT);
 
   /**
    * \brief Attempts to save an image to a file on a separate thread.
@@ -75,12 +108,14 @@ public:
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use (if the image is saved in PNG format).
    * \throws std::runtime_error If the image could not be saved.
    */
   template <typename T>
-  static void save_image_on_thread(const boost::shared_ptr<ORUtils::Image<T> >& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN)
+  static void save_image_on_thread(const boost::shared_ptr<ORUtils::Image<T> >& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN,
+                                   PNGCompressionLevel compressionLevel = PCL_DEFAULT)
   {
-    save_image_on_thread(boost::shared_ptr<const ORUtils::Image<T> >(image), path, fileType);
+    save_image_on_thread(boost::shared_ptr<const ORUtils::Image<T> >(image), path, fileType, compressionLevel);
   }
 
   /**
@@ -89,13 +124,15 @@ public:
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use (if the image is saved in PNG format).
    * \throws std::runtime_error If the image could not be saved.
    */
   template <typename T>
-  static void save_image_on_thread(const boost::shared_ptr<const ORUtils::Image<T> >& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN)
+  static void save_image_on_thread(const boost::shared_ptr<const ORUtils::Image<T> >& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN,
+                                   PNGCompressionLevel compressionLevel = PCL_DEFAULT)
   {
-    void (*p)(const boost::shared_ptr<const ORUtils::Image<T> >&, const std::string&, ImageFileType) = &save_image;
-    tvgutil::ThreadPool::instance().post_task(boost::bind(p, image, path, fileType));
+    void (*p)(const boost::shared_ptr<const ORUtils::Image<T> >&, const std::string&, ImageFileType, PNGCompressionLevel) = &save_image;
+    tvgutil::ThreadPool::instance().post_task(boost::bind(p, image, path, fileType, compressionLevel));
   }
 
   /**
@@ -106,12 +143,14 @@ public:
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use (if the image is saved in PNG format).
    * \throws std::runtime_error If the image could not be saved.
    */
   template <typename T>
-  static void save_image_on_thread(const boost::shared_ptr<ORUtils::Image<T> >& image, const boost::filesystem::path& path, ImageFileType fileType = IFT_UNKNOWN)
+  static void save_image_on_thread(const boost::shared_ptr<ORUtils::Image<T> >& image, const boost::filesystem::path& path, ImageFileType fileType = IFT_UNKNOWN,
+                                   PNGCompressionLevel compressionLevel = PCL_DEFAULT)
   {
-    save_image_on_thread(image, path.string(), fileType);
+    save_image_on_thread(image, path.string(), fileType, compressionLevel);
   }
 
   /**
@@ -120,12 +159,14 @@ public:
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use (if the image is saved in PNG format).
    * \throws std::runtime_error If the image could not be saved.
    */
   template <typename T>
-  static void save_image_on_thread(const boost::shared_ptr<const ORUtils::Image<T> >& image, const boost::filesystem::path& path, ImageFileType fileType = IFT_UNKNOWN)
+  static void save_image_on_thread(const boost::shared_ptr<const ORUtils::Image<T> >& image, const boost::filesystem::path& path, ImageFileType fileType = IFT_UNKNOWN,
+                                   PNGCompressionLevel compressionLevel = PCL_DEFAULT)
   {
-    save_image_on_thread(image, path.string(), fileType);
+    save_image_on_thread(image, path.string(), fileType, compressionLevel);
   }
 
   //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
@@ -139,6 +180,15 @@ private:
    */
   static ITMUChar4Image_Ptr decode_rgba_png(const std::vector<unsigned char>& buffer, const std::string& path);
 
+  /**
+   * \brief Decodes a buffer in 16-bit greyscale PNG format into an image.
+   *
+   * \param buffer  The buffer to decode.
+   * \param path    The name of the file from which the buffer was originally loaded (if known).
+   * \return        The decoded image.
+   */
+  static ITMShortImage_Ptr decode_short_png(const std::vector<unsigned char>& buffer, const std::string& path);
+
   /**
    * \brief Attempts to deduce an image file's type based on its file extension.
    *
@@ -147,13 +197,23 @@ private:
    */
   static ImageFileType deduce_image_file_type(const std::string& path);
 
+  /**
+   * \brief Encodes a short image in 16-bit greyscale PNG format and writes it into a buffer.
+   *
+   * \param image             The image to encode.
+   * \param compressionLevel  The level of compression to use.
+   * \param buffer            The buffer into which to write the encoded image.
+   */
+  static void encode_png(const ITMShortImage_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer);
+
   /**
    * \brief Encodes an RGBA image in PNG format and writes it into a buffer.
    *
-   * \param image   The image to encode.
-   * \param buffer  The buffer into which to write the encoded image.
+   * \param image             The image to encode.
+   * \param compressionLevel  The level of compression to use.
+   * \param buffer            The buffer into which to write the encoded image.
    */
-  static void encode_png(const ITMUChar4Image_CPtr& image, std::vector<unsigned char>& buffer);
+  static void encode_png(const ITMUChar4Image_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer);
 };
 
 }
@@ -0,0 +1,200 @@
+/**
+ * itmx: PackedSequenceReader.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_PACKEDSEQUENCEREADER
+#define H_ITMX_PACKEDSEQUENCEREADER
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "PackedSequenceUtil.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to read frames from a packed sequence file (see PackedSequenceUtil).
+ *
+ * The file is memory-mapped rather than read, so reading a frame involves no system calls or copies beyond decoding
+ * its images, and any frame can be accessed directly via the index. Reading only accesses memory that is never
+ * written, so different frames can be read concurrently.
+ */
+class PackedSequenceReader
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct describes an encoded image in a frame record.
+   */
+  struct ImageRecord
+  {
+    /** The codec with which the image was encoded. */
+    int codec;
+
+    /** A pointer to the encoded data. */
+    const unsigned char *data;
+
+    /** The size of the image. */
+    Vector2i size;
+
+    /** The size (in bytes) of the encoded data. */
+    size_t encodedSize;
+  };
+
+  /**
+   * \brief An instance of this struct describes a frame record.
+   */
+  struct FrameRecord
+  {
+    /** The depth image for the frame (if any). */
+    boost::optional<ImageRecord> depth;
+
+    /** The offset of the end of the record. */
+    size_t endOffset;
+
+    /** A pointer to the camera -> world pose for the frame (if any). */
+    const unsigned char *pose;
+
+    /** The RGB image for the frame (if any). */
+    boost::optional<ImageRecord> rgb;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The calibration for the sequence (in the format of calib.txt). */
+  std::string m_calibText;
+
+  /** The memory-mapped file. */
+  boost::iostreams::mapped_file_source m_file;
+
+  /** The offsets of the frame records. */
+  std::vector<size_t> m_frameOffsets;
+
+  /** The path to the file. */
+  boost::filesystem::path m_path;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a packed sequence reader.
+   *
+   * \param path                The path to the packed sequence file.
+   * \throws std::runtime_error If the file could not be opened, or is not a packed sequence file.
+   */
+  explicit PackedSequenceReader(const boost::filesystem::path& path);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the calibration for the sequence.
+   *
+   * \return  The calibration for the sequence (in the format of calib.txt).
+   */
+  const std::string& get_calib_text() const;
+
+  /**
+   * \brief Gets the size of the depth images in the specified frame.
+   *
+   * \param frameIndex  The index of the frame.
+   * \return            The size of the depth image in the frame, or (0,0) if the frame has no depth image.
+   */
+  Vector2i get_depth_image_size(size_t frameIndex) const;
+
+  /**
+   * \brief Gets the number of frames in the sequence.
+   *
+   * \return  The number of frames in the sequence.
+   */
+  size_t get_frame_count() const;
+
+  /**
+   * \brief Gets the size of the RGB images in the specified frame.
+   *
+   * \param frameIndex  The index of the frame.
+   * \return            The size of the RGB image in the frame, or (0,0) if the frame has no RGB image.
+   */
+  Vector2i get_rgb_image_size(size_t frameIndex) const;
+
+  /**
+   * \brief Reads the images for the specified frame.
+   *
+   * Images are resized to match the frame if necessary. If the frame has no image of a particular type, the corresponding
+   * output image is left untouched.
+   *
+   * \param frameIndex          The index of the frame.
+   * \param rgbImage            The image into which to read the RGB image for the frame (may be NULL, if it is not needed).
+   * \param depthImage          The image into which to read the depth image for the frame (may be NULL, if it is not needed).
+   * \throws std::runtime_error If the frame index is invalid or the frame is corrupt.
+   */
+  void read_images(size_t frameIndex, ORUtils::Image<Vector4u> *rgbImage, ORUtils::Image<short> *depthImage) const;
+
+  /**
+   * \brief Reads the camera -> world pose for the specified frame.
+   *
+   * \param frameIndex          The index of the frame.
+   * \return                    The pose for the frame, if it has one, or boost::none otherwise.
+   * \throws std::runtime_error If the frame index is invalid or the frame is corrupt.
+   */
+  boost::optional<Matrix4f> read_pose(size_t frameIndex) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets a pointer to the specified offset in the file.
+   *
+   * \param offset  The offset.
+   * \return        A pointer to the offset in the file.
+   */
+  const unsigned char *at(size_t offset) const;
+
+  /**
+   * \brief Parses the frame record at the specified offset.
+   *
+   * \param offset              The offset of the record.
+   * \return                    The parsed record.
+   * \throws std::runtime_error If the record is corrupt.
+   */
+  FrameRecord parse_frame(size_t offset) const;
+
+  /**
+   * \brief Parses the encoded image at the specified offset in a frame record.
+   *
+   * \param offset              The offset of the image, which will be advanced past it.
+   * \return                    The parsed image.
+   * \throws std::runtime_error If the image is corrupt.
+   */
+  ImageRecord parse_image(size_t& offset) const;
+
+  /**
+   * \brief Parses the frame record for the frame with the specified index.
+   *
+   * \param frameIndex          The index of the frame.
+   * \return                    The parsed record.
+   * \throws std::runtime_error If the frame index is invalid or the record is corrupt.
+   */
+  FrameRecord parse_indexed_frame(size_t frameIndex) const;
+
+  /**
+   * \brief Throws an exception indicating that the file is corrupt if the specified range extends beyond the end of the file.
+   *
+   * \param offset              The offset of the start of the range.
+   * \param size                The size of the range.
+   * \throws std::runtime_error If the range extends beyond the end of the file.
+   */
+  void require(size_t offset, size_t size) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<PackedSequenceReader> PackedSequenceReader_Ptr;
+typedef boost::shared_ptr<const PackedSequenceReader> PackedSequenceReader_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * itmx: PackedSequenceRecordingSink.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_PACKEDSEQUENCERECORDINGSINK
+#define H_ITMX_PACKEDSEQUENCERECORDINGSINK
+
+#include "PackedSequenceWriter.h"
+#include "RecordingSink.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to write the recorded frames (and their poses) into a packed sequence file.
+ *
+ * Unlike a file recording sink, this produces a single file that can be replayed at high speed (see PackedSequenceUtil).
+ */
+class PackedSequenceRecordingSink : public RecordingSink
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The writer used to write the packed sequence file. */
+  PackedSequenceWriter m_writer;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a packed sequence recording sink.
+   *
+   * \param path                The path to the packed sequence file.
+   * \param calibText           The calibration for the sequence (in the format of calib.txt).
+   * \param maxQueueSize        The maximum number of frames that can be waiting to be written.
+   * \throws std::runtime_error If the file could not be opened.
+   */
+  PackedSequenceRecordingSink(const boost::filesystem::path& path, const std::string& calibText, size_t maxQueueSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the sink, waiting for any frames that are still in the queue to be written and then finishing the file.
+   */
+  ~PackedSequenceRecordingSink();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose);
+};
+
+}
+
+#endif
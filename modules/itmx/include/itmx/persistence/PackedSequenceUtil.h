@@ -0,0 +1,171 @@
+/**
+ * itmx: PackedSequenceUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_PACKEDSEQUENCEUTIL
+#define H_ITMX_PACKEDSEQUENCEUTIL
+
+#include <string>
+#include <vector>
+
+#include <ITMLib/Utils/ITMImageTypes.h>
+
+namespace itmx {
+
+/**
+ * \brief This class contains the constants and image codecs that define the packed sequence format.
+ *
+ * A packed sequence stores an entire RGB-D sequence (including the calibration and the camera poses) in a single file,
+ * so that it can be replayed without the cost of opening and parsing a separate file for every image. The file consists of:
+ *
+ * - A header: the 8-byte signature "SPTSEQ01", followed by the length of the calibration text (as a 32-bit integer) and the
+ *   text itself (in the format of calib.txt).
+ * - A record for each frame: a 32-bit set of flags (see FrameFlag) indicating which of the depth image, RGB image and pose
+ *   are present, followed by each image that is present (as its width, height, codec and encoded size, each as a 32-bit
+ *   integer, followed by the encoded data), followed by the camera -> world pose (if present) as 16 floats in column-major order.
+ * - An index: the 64-bit offset of each frame record from the start of the file, followed by a trailer containing the offset
+ *   of the index (as a 64-bit integer), the number of frames (as a 32-bit integer) and the 8-byte signature "SPTSEQIX".
+ *
+ * All integers are little-endian. If the index is missing (e.g. because the writer did not finish cleanly), the frame
+ * records can still be recovered by walking the file from the end of the header.
+ */
+class PackedSequenceUtil
+{
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the codecs that can be used to store depth images.
+   */
+  enum DepthCodec
+  {
+    /** Store the depths uncompressed (2 bytes per pixel). */
+    DC_RAW,
+
+    /**
+     * Store the difference between each depth and that of the pixel to its left (or above it, for the first pixel in a row),
+     * zigzag-encoded and then written as a variable-length integer. Since neighbouring depths are usually similar, most
+     * pixels take a single byte, and encoding and decoding are much cheaper than with a general-purpose compressor.
+     */
+    DC_DELTA_VARINT
+  };
+
+  /**
+   * \brief The values of this enumeration denote the flags that indicate which parts of a frame are present in a frame record.
+   */
+  enum FrameFlag
+  {
+    FF_DEPTH = 1,
+    FF_RGB = 2,
+    FF_POSE = 4
+  };
+
+  /**
+   * \brief The values of this enumeration denote the codecs that can be used to store RGB images.
+   */
+  enum RGBCodec
+  {
+    /** Store the colours uncompressed (3 bytes per pixel, since the alpha channel is always opaque). */
+    RC_RGB
+  };
+
+  //#################### PUBLIC STATIC VARIABLES ####################
+public:
+  /** The signature at the start of a packed sequence file. */
+  static const char *HEADER_SIGNATURE;
+
+  /** The size (in bytes) of the signatures in a packed sequence file. */
+  static const size_t SIGNATURE_SIZE = 8;
+
+  /** The signature at the end of the trailer of a packed sequence file. */
+  static const char *TRAILER_SIGNATURE;
+
+  /** The size (in bytes) of the trailer of a packed sequence file. */
+  static const size_t TRAILER_SIZE = 8 + 4 + SIGNATURE_SIZE;
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Decodes a depth image.
+   *
+   * \param codec               The codec with which the image was encoded.
+   * \param data                The encoded data.
+   * \param size                The size (in bytes) of the encoded data.
+   * \param image               The image into which to decode the data (this must already have the right size).
+   * \throws std::runtime_error If the codec is unknown or the data is corrupt.
+   */
+  static void decode_depth(int codec, const unsigned char *data, size_t size, ORUtils::Image<short>& image);
+
+  /**
+   * \brief Decodes an RGB image.
+   *
+   * \param codec               The codec with which the image was encoded.
+   * \param data                The encoded data.
+   * \param size                The size (in bytes) of the encoded data.
+   * \param image               The image into which to decode the data (this must already have the right size).
+   * \throws std::runtime_error If the codec is unknown or the data is corrupt.
+   */
+  static void decode_rgb(int codec, const unsigned char *data, size_t size, ORUtils::Image<Vector4u>& image);
+
+  /**
+   * \brief Encodes a depth image, appending the encoded data to a buffer.
+   *
+   * \param codec The codec with which to encode the image.
+   * \param image The image to encode.
+   * \param out   The buffer to which to append the encoded data.
+   */
+  static void encode_depth(DepthCodec codec, const ORUtils::Image<short>& image, std::vector<unsigned char>& out);
+
+  /**
+   * \brief Encodes an RGB image, appending the encoded data to a buffer.
+   *
+   * \param codec The codec with which to encode the image.
+   * \param image The image to encode.
+   * \param out   The buffer to which to append the encoded data.
+   */
+  static void encode_rgb(RGBCodec codec, const ORUtils::Image<Vector4u>& image, std::vector<unsigned char>& out);
+
+  /**
+   * \brief Determines whether or not the specified path refers to a packed sequence file.
+   *
+   * \param path The path.
+   * \return     true, if the path refers to a packed sequence file, or false otherwise.
+   */
+  static bool is_packed_sequence(const std::string& path);
+
+  /**
+   * \brief Reads a little-endian 32-bit unsigned integer from a buffer.
+   *
+   * \param p A pointer to the start of the integer.
+   * \return  The integer.
+   */
+  static unsigned int read_uint32(const unsigned char *p);
+
+  /**
+   * \brief Reads a little-endian 64-bit unsigned integer from a buffer.
+   *
+   * \param p A pointer to the start of the integer.
+   * \return  The integer.
+   */
+  static unsigned long long read_uint64(const unsigned char *p);
+
+  /**
+   * \brief Appends a little-endian 32-bit unsigned integer to a buffer.
+   *
+   * \param value The integer.
+   * \param out   The buffer.
+   */
+  static void write_uint32(unsigned int value, std::vector<unsigned char>& out);
+
+  /**
+   * \brief Appends a little-endian 64-bit unsigned integer to a buffer.
+   *
+   * \param value The integer.
+   * \param out   The buffer.
+   */
+  static void write_uint64(unsigned long long value, std::vector<unsigned char>& out);
+};
+
+}
+
+#endif
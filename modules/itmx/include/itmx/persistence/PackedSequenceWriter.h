@@ -0,0 +1,103 @@
+/**
+ * itmx: PackedSequenceWriter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_PACKEDSEQUENCEWRITER
+#define H_ITMX_PACKEDSEQUENCEWRITER
+
+#include <fstream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include "PackedSequenceUtil.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to write an RGB-D sequence to a packed sequence file (see PackedSequenceUtil).
+ */
+class PackedSequenceWriter
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A buffer into which to encode each frame record before writing it (reused to avoid reallocating it for every frame). */
+  std::vector<unsigned char> m_buffer;
+
+  /** The codec with which to encode the depth images. */
+  PackedSequenceUtil::DepthCodec m_depthCodec;
+
+  /** The offsets of the frame records that have been written so far. */
+  std::vector<unsigned long long> m_frameOffsets;
+
+  /** The stream to the packed sequence file. */
+  std::ofstream m_fs;
+
+  /** The offset at which the next frame record will be written. */
+  unsigned long long m_offset;
+
+  /** The path to the packed sequence file. */
+  boost::filesystem::path m_path;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a packed sequence writer.
+   *
+   * \param path                The path to the packed sequence file.
+   * \param calibText           The calibration for the sequence (in the format of calib.txt).
+   * \param depthCodec          The codec with which to encode the depth images.
+   * \throws std::runtime_error If the file could not be opened.
+   */
+  PackedSequenceWriter(const boost::filesystem::path& path, const std::string& calibText,
+                       PackedSequenceUtil::DepthCodec depthCodec = PackedSequenceUtil::DC_DELTA_VARINT);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the writer, finishing the file if close has not already been called.
+   */
+  ~PackedSequenceWriter();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  PackedSequenceWriter(const PackedSequenceWriter&);
+  PackedSequenceWriter& operator=(const PackedSequenceWriter&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Finishes the file by writing its index, and then closes it.
+   *
+   * This is idempotent, so it is safe to call it before the writer is destroyed.
+   *
+   * \throws std::runtime_error If the index could not be written.
+   */
+  void close();
+
+  /**
+   * \brief Writes a frame to the file.
+   *
+   * \param rgbImage            The RGB image for the frame (may be NULL).
+   * \param depthImage          The depth image for the frame (may be NULL).
+   * \param pose                The camera -> world pose for the frame (if known).
+   * \throws std::runtime_error If the frame could not be written.
+   */
+  void write_frame(const ORUtils::Image<Vector4u> *rgbImage, const ORUtils::Image<short> *depthImage, const boost::optional<Matrix4f>& pose);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the contents of the buffer to the file, and then clears the buffer.
+   *
+   * \throws std::runtime_error If the buffer could not be written.
+   */
+  void flush_buffer();
+};
+
+}
+
+#endif
@@ -6,7 +6,10 @@
 #ifndef H_ITMX_POSEPERSISTER
 #define H_ITMX_POSEPERSISTER
 
+#include <iosfwd>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 
@@ -15,12 +18,48 @@
 namespace itmx {
 
 /**
- * \brief This class contains utility functions for saving camera poses.
+ * \brief This class contains utility functions for loading and saving camera poses.
+ *
+ * Poses can either be saved individually, with one file per pose, or as part of a trajectory file, which contains one line
+ * per pose in the format used by the TUM RGB-D benchmark, i.e. "timestamp tx ty tz qx qy qz qw", where t is the translation
+ * component of the camera -> world transformation and q is a unit quaternion representing its rotation component. Lines
+ * starting with '#' are comments.
  */
 class PosePersister
 {
+  //#################### TYPEDEFS ####################
+public:
+  typedef std::pair<double,Matrix4f> TimestampedPose;
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Attempts to load a camera pose from a file (in the format written by save_pose).
+   *
+   * \param path                The path to the file from which to load the pose.
+   * \return                    The pose matrix.
+   * \throws std::runtime_error If the pose could not be loaded.
+   */
+  static Matrix4f load_pose(const std::string& path);
+
+  /**
+   * \brief Attempts to load a trajectory from a file (in the format written by write_trajectory_entry).
+   *
+   * \param path                The path to the file from which to load the trajectory.
+   * \return                    The timestamped camera -> world poses in the trajectory, in the order in which they appear in the file.
+   * \throws std::runtime_error If the trajectory could not be loaded.
+   */
+  static std::vector<TimestampedPose> load_trajectory(const std::string& path);
+
+  /**
+   * \brief Attempts to load a trajectory from a file (in the format written by write_trajectory_entry).
+   *
+   * \param path                The path to the file from which to load the trajectory.
+   * \return                    The timestamped camera -> world poses in the trajectory, in the order in which they appear in the file.
+   * \throws std::runtime_error If the trajectory could not be loaded.
+   */
+  static std::vector<TimestampedPose> load_trajectory(const boost::filesystem::path& path);
+
   /**
    * \brief Attempts to save a camera pose to a file.
    *
@@ -56,6 +95,15 @@ public:
    * \throws std::runtime_error If the pose could not be saved.
    */
   static void save_pose_on_thread(const Matrix4f& pose, const boost::filesystem::path& path);
+
+  /**
+   * \brief Writes a timestamped camera pose to a stream as a line of a trajectory file.
+   *
+   * \param os        The stream.
+   * \param timestamp The timestamp of the pose.
+   * \param pose      The camera -> world pose matrix (whose upper-left 3x3 block must be a rotation).
+   */
+  static void write_trajectory_entry(std::ostream& os, double timestamp, const Matrix4f& pose);
 };
 
 }
@@ -0,0 +1,140 @@
+/**
+ * itmx: RecordingSink.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_RECORDINGSINK
+#define H_ITMX_RECORDINGSINK
+
+#include <deque>
+
+#include <boost/optional.hpp>
+#include <boost/thread.hpp>
+
+#include "../base/ITMImagePtrTypes.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to write a stream of recorded frames to persistent storage.
+ *
+ * Frames are written on a dedicated worker thread, in the order in which they were pushed. The queue of frames waiting to be
+ * written is bounded: if it is full when a frame is pushed, the caller is blocked until there is space for it. This applies
+ * backpressure to the recording thread rather than letting a backlog of frames build up in memory, and ensures that no frame
+ * is ever dropped.
+ *
+ * Note that every derived class must call stop_worker at the start of its destructor, so that any frames still in the queue
+ * are written before the derived parts of the sink are destroyed.
+ */
+class RecordingSink
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a frame that is waiting to be written.
+   */
+  struct Frame
+  {
+    /** The depth image for the frame (if any). */
+    ITMShortImage_CPtr depthImage;
+
+    /** The camera -> world pose for the frame (if known). */
+    boost::optional<Matrix4f> pose;
+
+    /** The RGB image for the frame (if any). */
+    ITMUChar4Image_CPtr rgbImage;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The maximum number of frames that can be waiting in the queue. */
+  size_t m_maxQueueSize;
+
+  /** The frames that are waiting to be written (accessed only whilst holding m_queueMutex). */
+  std::deque<Frame> m_queue;
+
+  /** A condition variable used to signal that a frame has been added to or removed from the queue. */
+  boost::condition_variable m_queueChanged;
+
+  /** The mutex used to protect the queue and the termination flag. */
+  boost::mutex m_queueMutex;
+
+  /** The worker thread on which the frames are written. */
+  boost::thread m_worker;
+
+  /** A flag indicating that the worker thread should terminate once the queue is empty (accessed only whilst holding m_queueMutex). */
+  bool m_workerShouldTerminate;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a recording sink.
+   *
+   * \param maxQueueSize            The maximum number of frames that can be waiting in the queue.
+   * \throws std::invalid_argument  If the maximum queue size is zero.
+   */
+  explicit RecordingSink(size_t maxQueueSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the recording sink.
+   */
+  virtual ~RecordingSink();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  RecordingSink(const RecordingSink&);
+  RecordingSink& operator=(const RecordingSink&);
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes a frame to persistent storage (this is called on the worker thread).
+   *
+   * \param rgbImage            The RGB image for the frame (may be NULL).
+   * \param depthImage          The depth image for the frame (may be NULL).
+   * \param pose                The camera -> world pose for the frame (if known).
+   * \throws std::runtime_error If the frame could not be written.
+   */
+  virtual void write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds a frame to the queue of frames to be written, blocking until there is space for it if the queue is full.
+   *
+   * The images must not be modified once they have been pushed (they are written asynchronously).
+   *
+   * \param rgbImage    The RGB image for the frame (may be NULL).
+   * \param depthImage  The depth image for the frame (may be NULL).
+   * \param pose        The camera -> world pose for the frame (if known). Sinks that cannot store poses ignore this.
+   */
+  void push_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage = ITMShortImage_CPtr(),
+                  const boost::optional<Matrix4f>& pose = boost::none);
+
+  //#################### PROTECTED MEMBER FUNCTIONS ####################
+protected:
+  /**
+   * \brief Waits for all of the frames in the queue to be written, and then stops the worker thread.
+   *
+   * This is idempotent, so it is safe for derived classes to call it even though the base class destructor also calls it.
+   */
+  void stop_worker();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Runs the worker thread.
+   */
+  void run_worker();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<RecordingSink> RecordingSink_Ptr;
+
+}
+
+#endif
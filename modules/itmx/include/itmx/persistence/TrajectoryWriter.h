@@ -0,0 +1,105 @@
+/**
+ * itmx: TrajectoryWriter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_TRAJECTORYWRITER
+#define H_ITMX_TRAJECTORYWRITER
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "PosePersister.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to append a stream of timestamped camera poses to a single trajectory file.
+ *
+ * Saving each pose to a file of its own (see PosePersister::save_pose) produces a file per frame, so long sequences lead to
+ * directories containing vast numbers of tiny files, and the cost of creating them dominates the cost of writing the poses.
+ * A trajectory writer instead appends the poses (as lines in the format described in PosePersister) to one buffered file.
+ *
+ * Poses are accumulated in memory and handed to a dedicated writer thread in batches, which writes each batch to the file
+ * and then flushes it. Any poses that have not yet been written when the writer is destroyed are written before it returns.
+ */
+class TrajectoryWriter
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of poses to accumulate before handing them to the writer thread. */
+  size_t m_batchSize;
+
+  /** The stream to which the poses are written (accessed only by the writer thread once it has started). */
+  std::ofstream m_fs;
+
+  /** The poses that are waiting to be written (accessed only whilst holding m_queueMutex). */
+  std::vector<PosePersister::TimestampedPose> m_queue;
+
+  /** A condition variable used to signal that a batch of poses is ready to be written, or that the writer thread should terminate. */
+  boost::condition_variable m_queueChanged;
+
+  /** The mutex used to protect the queue and the termination flag. */
+  boost::mutex m_queueMutex;
+
+  /** The writer thread. */
+  boost::thread m_worker;
+
+  /** A flag indicating that the writer thread should terminate once the queue is empty (accessed only whilst holding m_queueMutex). */
+  bool m_workerShouldTerminate;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a trajectory writer.
+   *
+   * \param path                    The path to the trajectory file (any existing file at this path is overwritten).
+   * \param batchSize               The number of poses to accumulate before handing them to the writer thread.
+   * \throws std::invalid_argument  If the batch size is zero.
+   * \throws std::runtime_error     If the trajectory file cannot be opened.
+   */
+  explicit TrajectoryWriter(const boost::filesystem::path& path, size_t batchSize = 100);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the trajectory writer, first waiting for any remaining poses to be written.
+   */
+  ~TrajectoryWriter();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  TrajectoryWriter(const TrajectoryWriter&);
+  TrajectoryWriter& operator=(const TrajectoryWriter&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Appends a timestamped camera pose to the trajectory.
+   *
+   * \param timestamp The timestamp of the pose (e.g. the time in seconds at which the frame was captured, or the frame index).
+   * \param pose      The camera -> world pose matrix.
+   */
+  void write_pose(double timestamp, const Matrix4f& pose);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Runs the writer thread.
+   */
+  void run_worker();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<TrajectoryWriter> TrajectoryWriter_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * itmx: BackgroundRelocaliser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_BACKGROUNDRELOCALISER
+#define H_ITMX_BACKGROUNDRELOCALISER
+
+#include <deque>
+
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "Relocaliser.h"
+#include "../base/ITMImagePtrTypes.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to train another relocaliser on a separate thread, off the tracking critical path.
+ *
+ * Each call to train snapshots the RGB-D image pair and the camera pose into a bounded queue and returns immediately.
+ * A worker thread then trains the wrapped relocaliser on the queued samples, and performs its bookkeeping (see update)
+ * whenever it has been requested and there is no training left to do. If the queue is full when train is called, the
+ * sample is dropped rather than blocking the caller.
+ *
+ * Every call into the wrapped relocaliser is made whilst holding a mutex, so relocalise always sees the model as it was
+ * either before or after each training sample was added, never part-way through. A call to relocalise may therefore
+ * have to wait for a training sample that is already in progress, but it will never wait for the queue to drain.
+ *
+ * Note that the public member functions are intended to be called from a single (tracking) thread.
+ */
+class BackgroundRelocaliser : public Relocaliser
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a training sample that is waiting to be passed to the wrapped relocaliser.
+   */
+  struct TrainingSample
+  {
+    /** The position of the camera in the world. */
+    ORUtils::SE3Pose cameraPose;
+
+    /** A copy of the colour image. */
+    ITMUChar4Image_Ptr colourImage;
+
+    /** A copy of the depth image. */
+    ITMFloatImage_Ptr depthImage;
+
+    /** The intrinsic parameters of the depth sensor. */
+    Vector4f depthIntrinsics;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The type of device on which the wrapped relocaliser reads its input images. */
+  ITMLib::ITMLibSettings::DeviceType m_deviceType;
+
+  /** Previously used training samples whose images can be reused for later snapshots (accessed only whilst holding m_queueMutex). */
+  std::deque<TrainingSample> m_freeSamples;
+
+  /** The relocaliser that is trained on the worker thread. */
+  Relocaliser_Ptr m_innerRelocaliser;
+
+  /** The maximum number of training samples that can be waiting in the queue. */
+  size_t m_maxQueueSize;
+
+  /** The mutex used to serialise all calls into the wrapped relocaliser. */
+  mutable boost::mutex m_relocaliserMutex;
+
+  /** The training samples that are waiting to be passed to the wrapped relocaliser (accessed only whilst holding m_queueMutex). */
+  std::deque<TrainingSample> m_queue;
+
+  /** The mutex used to protect the queue, the free samples and the update flag. */
+  boost::mutex m_queueMutex;
+
+  /** The number of times the relocaliser has been reset (used to discard any sample that was dequeued before a reset). */
+  boost::atomic<size_t> m_resetCount;
+
+  /** A condition variable used to wake the worker thread when there is some work for it to do. */
+  boost::condition_variable m_workAvailable;
+
+  /** The worker thread on which the wrapped relocaliser is trained and updated. */
+  boost::thread m_worker;
+
+  /** A flag set in the destructor to indicate that the worker thread should terminate. */
+  boost::atomic<bool> m_workerShouldTerminate;
+
+  /** Whether or not an update of the wrapped relocaliser has been requested (accessed only whilst holding m_queueMutex). */
+  bool m_updateRequested;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a background relocaliser.
+   *
+   * \param innerRelocaliser  The relocaliser to train on the worker thread.
+   * \param deviceType        The type of device on which the wrapped relocaliser reads its input images.
+   * \param maxQueueSize      The maximum number of training samples that can be waiting in the queue.
+   * \throws std::invalid_argument  If the wrapped relocaliser is NULL or the maximum queue size is zero.
+   */
+  BackgroundRelocaliser(const Relocaliser_Ptr& innerRelocaliser, ITMLib::ITMLibSettings::DeviceType deviceType, size_t maxQueueSize = 5);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the background relocaliser, discarding any training samples that are still in the queue.
+   */
+  ~BackgroundRelocaliser();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  BackgroundRelocaliser(const BackgroundRelocaliser&);
+  BackgroundRelocaliser& operator=(const BackgroundRelocaliser&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void load_from_disk(const std::string& path);
+
+  /** Override */
+  virtual boost::optional<Result> relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage, const Vector4f& depthIntrinsics) const;
+
+  /** Override */
+  virtual std::vector<Result> relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                    const Vector4f& depthIntrinsics, size_t maxCandidateCount) const;
+
+  /** Override */
+  virtual void reset();
+
+  /** Override */
+  virtual void save_to_disk(const std::string& path) const;
+
+  /** Override */
+  virtual void train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                     const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose);
+
+  /** Override */
+  virtual void update();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Copies the specified image into another image on the device used by the wrapped relocaliser, (re)allocating it if necessary.
+   *
+   * \param src The image to copy.
+   * \param dst The image into which to copy it.
+   */
+  template <typename T>
+  void copy_image(const ORUtils::Image<T> *src, boost::shared_ptr<ORUtils::Image<T> >& dst) const;
+
+  /**
+   * \brief Discards any training samples that are waiting in the queue, and any pending update, and tells the worker thread
+   *        to discard the sample it is currently processing (if any).
+   */
+  void discard_queued_samples();
+
+  /**
+   * \brief Runs the worker thread.
+   */
+  void run_worker();
+};
+
+}
+
+#endif
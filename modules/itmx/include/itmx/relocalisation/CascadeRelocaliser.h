@@ -0,0 +1,123 @@
+/**
+ * itmx: CascadeRelocaliser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_CASCADERELOCALISER
+#define H_ITMX_CASCADERELOCALISER
+
+#include "Relocaliser.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to relocalise a camera by trying a sequence of relocalisers in turn,
+ *        starting with the cheapest, and only escalating to the next stage if the current one fails.
+ *
+ * The first result whose quality is good is returned immediately, so that the more expensive stages are only run when the
+ * cheaper ones cannot recover the pose. If no stage produces a good result, the first poor result (if any) is returned.
+ * The stages are normally wrapped in refining relocalisers (e.g. see ICPRefiningRelocaliser), so that the quality of each
+ * result reflects whether or not it passed verification against the scene.
+ *
+ * Every stage is trained, reset and updated along with the cascade. At most one stage can be marked as persistent,
+ * in which case saving or loading the cascade saves or loads that stage (the others are expected to be cheap to rebuild).
+ *
+ * The number of attempts, successes and the time taken by each stage are recorded and reported to the profiler (if enabled).
+ * Callers that want a summary of them can query them via get_stage_stats.
+ */
+class CascadeRelocaliser : public Relocaliser
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct holds the statistics for a stage of the cascade.
+   */
+  struct StageStats
+  {
+    /** The number of times the stage has been run. */
+    size_t attemptCount;
+
+    /** The number of times the stage has produced a good result. */
+    size_t hitCount;
+
+    /** The name of the stage. */
+    std::string name;
+
+    /** The total time (in milliseconds) spent running the stage. */
+    double totalMilliseconds;
+  };
+
+private:
+  /**
+   * \brief An instance of this struct represents a stage of the cascade.
+   */
+  struct Stage
+  {
+    /** The name of the hit rate gauge reported to the profiler. */
+    std::string gaugeName;
+
+    /** The name under which the stage is timed by the profiler. */
+    std::string profilingName;
+
+    /** The relocaliser used by the stage. */
+    Relocaliser_Ptr relocaliser;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The index of the persistent stage, if any. */
+  boost::optional<size_t> m_persistentStageIndex;
+
+  /** The stages of the cascade, in the order in which they are tried. */
+  std::vector<Stage> m_stages;
+
+  /** The statistics for each stage of the cascade. */
+  mutable std::vector<StageStats> m_stageStats;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds a stage to the end of the cascade.
+   *
+   * \param name                    The name of the stage (used when reporting its statistics).
+   * \param relocaliser             The relocaliser used by the stage.
+   * \param persistent              Whether or not saving or loading the cascade should save or load this stage.
+   * \throws std::invalid_argument  If the relocaliser is null, or the stage is persistent and the cascade already has a persistent stage.
+   */
+  void add_stage(const std::string& name, const Relocaliser_Ptr& relocaliser, bool persistent = false);
+
+  /**
+   * \brief Gets the statistics for each stage of the cascade.
+   *
+   * \return  The statistics for each stage of the cascade, in the order in which the stages are tried.
+   */
+  const std::vector<StageStats>& get_stage_stats() const;
+
+  /** Override */
+  virtual void load_from_disk(const std::string& path);
+
+  /** Override */
+  virtual boost::optional<Result> relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage, const Vector4f& depthIntrinsics) const;
+
+  /** Override */
+  virtual void reset();
+
+  /** Override */
+  virtual void save_to_disk(const std::string& path) const;
+
+  /** Override */
+  virtual void train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                     const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose);
+
+  /** Override */
+  virtual void update();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<CascadeRelocaliser> CascadeRelocaliser_Ptr;
+typedef boost::shared_ptr<const CascadeRelocaliser> CascadeRelocaliser_CPtr;
+
+}
+
+#endif
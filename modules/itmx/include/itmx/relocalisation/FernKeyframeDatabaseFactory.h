@@ -0,0 +1,38 @@
+/**
+ * itmx: FernKeyframeDatabaseFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_FERNKEYFRAMEDATABASEFACTORY
+#define H_ITMX_FERNKEYFRAMEDATABASEFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/FernKeyframeDatabase.h"
+
+namespace itmx {
+
+/**
+ * \brief This class can be used to construct fern keyframe databases.
+ */
+class FernKeyframeDatabaseFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes a fern keyframe database.
+   *
+   * \param fernCount         The number of ferns.
+   * \param decisionsPerFern  The number of decisions made by each fern.
+   * \param depthRange        The minimum and maximum depths of the images that will be encoded.
+   * \param seed              The seed for the random number generator used to generate the fern decisions.
+   * \param deviceType        The device on which the database should operate.
+   * \return                  The fern keyframe database.
+   */
+  static FernKeyframeDatabase_Ptr make_database(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed,
+                                                ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -6,14 +6,20 @@
 #ifndef H_ITMX_FERNRELOCALISER
 #define H_ITMX_FERNRELOCALISER
 
-#include <FernRelocLib/Relocaliser.h>
+#include <vector>
+
+#include <ITMLib/Utils/ITMLibSettings.h>
 
 #include "Relocaliser.h"
+#include "interface/FernKeyframeDatabase.h"
 
 namespace itmx {
 
 /**
- * \brief An instance of this class can be used to relocalise a camera in a 3D scene with the random fern-based relocaliser in InfiniTAM.
+ * \brief An instance of this class can be used to relocalise a camera in a 3D scene using random ferns, in the manner of the relocaliser in InfiniTAM.
+ *
+ * Unlike InfiniTAM's relocaliser, the ferns and keyframe codes are stored in a database on the device on which the
+ * relocaliser operates, so the depth images never need to be copied across to the CPU.
  */
 class FernRelocaliser : public Relocaliser
 {
@@ -30,18 +36,10 @@ public:
     DELAY_AFTER_RELOCALISATION
   };
 
-  //#################### TYPEDEFS ####################
-private:
-  typedef FernRelocLib::Relocaliser<float> WrappedRelocaliser;
-  typedef boost::shared_ptr<WrappedRelocaliser> WrappedRelocaliser_Ptr;
-
   //#################### PRIVATE MEMBER VARIABLES ####################
 private:
-  /** The number of decisions to perform in each fern. */
-  int m_decisionsPerFern;
-
-  /** The size of the input depth images. */
-  Vector2i m_depthImageSize;
+  /** The database used to encode the depth images and find the most similar keyframes. */
+  FernKeyframeDatabase_Ptr m_database;
 
   /** The threshold used when deciding whether to store a keyframe. */
   float m_harvestingThreshold;
@@ -52,40 +50,45 @@ private:
   /** The delay before trying to add another keyframe to the fern conservatory. */
   mutable uint32_t m_keyframeDelay;
 
-  /** The number of ferns to use for relocalisation. */
-  int m_numFerns;
-
-  /** The minimum and maximum range of the depth images. */
-  Vector2f m_rangeParameters;
-
-  /** The wrapped relocaliser. */
-  WrappedRelocaliser_Ptr m_relocaliser;
+  /** The camera poses of the keyframes in the database. */
+  std::vector<ORUtils::SE3Pose> m_keyframePoses;
 
   //#################### CONSTRUCTORS ####################
 public:
   /**
    * \brief Constructs a fern relocaliser.
    *
-   * \param depthImageSize      The dimensions of the depth images that will be passed to the relocaliser.
    * \param viewFrustumMin      The minimum distance to consider in the depth images.
    * \param viewFrustumMax      The maximum distance to consider in the depth images.
    * \param harvestingThreshold The threshold used when deciding whether to store a keyframe.
    * \param numFerns            The number of ferns to use for relocalisation.
    * \param decisionsPerFern    The number of decisions to perform in each fern.
+   * \param deviceType          The device on which the relocaliser should operate.
    * \param keyframeAddPolicy   The policy used to decide whether to store keyframes right after tracking failures.
    */
-  FernRelocaliser(const Vector2i& depthImageSize, float viewFrustumMin, float viewFrustumMax,
+  FernRelocaliser(float viewFrustumMin, float viewFrustumMax,
                   float harvestingThreshold, int numFerns, int decisionsPerFern,
+                  ITMLib::ITMLibSettings::DeviceType deviceType,
                   KeyframeAddPolicy keyframeAddPolicy = DELAY_AFTER_RELOCALISATION);
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /** Override */
+  virtual void load_from_disk(const std::string& path);
+
   /** Override */
   virtual boost::optional<Result> relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage, const Vector4f &depthIntrinsics) const;
 
+  /** Override */
+  virtual std::vector<Result> relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                    const Vector4f& depthIntrinsics, size_t maxCandidateCount) const;
+
   /** Override */
   virtual void reset();
 
+  /** Override */
+  virtual void save_to_disk(const std::string& path) const;
+
   /** Override */
   virtual void train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
                      const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose);
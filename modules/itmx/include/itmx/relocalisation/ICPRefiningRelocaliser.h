@@ -6,14 +6,16 @@
 #ifndef H_ITMX_ICPREFININGRELOCALISER
 #define H_ITMX_ICPREFININGRELOCALISER
 
+#include <vector>
+
 #include <ITMLib/Core/ITMDenseMapper.h>
 #include <ITMLib/Engines/Visualisation/Interface/ITMVisualisationEngine.h>
 #include <ITMLib/Objects/Scene/ITMScene.h>
 
-#include <tvgutil/filesystem/SequentialPathGenerator.h>
 #include <tvgutil/timing/AverageTimer.h>
 
 #include "../base/ITMObjectPtrTypes.h"
+#include "../persistence/TrajectoryWriter.h"
 #include "RefiningRelocaliser.h"
 
 namespace itmx {
@@ -42,8 +44,17 @@ private:
   /** The dense mapper used to find visible blocks in the voxel scene. */
   DenseMapper_Ptr m_denseVoxelMapper;
 
-  /** The path generator used when saving the relocalised poses. */
-  mutable boost::optional<tvgutil::SequentialPathGenerator> m_posePathGenerator;
+  /** The maximum number of candidate poses from the inner relocaliser to refine on each relocalisation call. */
+  size_t m_hypothesisCount;
+
+  /** The writer used to save the refined poses (if we're saving poses). */
+  TrajectoryWriter_Ptr m_refinedPoseWriter;
+
+  /** The index of the next relocalisation call (used to timestamp the saved poses). */
+  mutable size_t m_relocalisationIndex;
+
+  /** The writer used to save the relocalised poses before refinement (if we're saving poses). */
+  TrajectoryWriter_Ptr m_relocalisedPoseWriter;
 
   /** Whether or not to save the relocalised poses. */
   bool m_savePoses;
@@ -72,8 +83,8 @@ private:
   /** The tracking controller used to set up and perform the actual refinement. */
   TrackingController_Ptr m_trackingController;
 
-  /** The tracking state used to hold the refinement results. */
-  TrackingState_Ptr m_trackingState;
+  /** The tracking states used to hold the refinement results (one per candidate pose). */
+  std::vector<TrackingState_Ptr> m_trackingStates;
 
   /** The visualisation engine used to perform the raycasting. */
   VisualisationEngine_CPtr m_visualisationEngine;
@@ -98,12 +109,14 @@ public:
    * \param denseVoxelMapper    The dense mapper used to find visible blocks in the voxel scene.
    * \param settings            The settings to use for InfiniTAM.
    * \param visualisationEngine The visualisation engine used to perform the raycasting.
+   * \param hypothesisCount     The maximum number of inner relocaliser results to refine (if specified, this overrides the value in the settings).
    */
   ICPRefiningRelocaliser(const Relocaliser_Ptr& innerRelocaliser, const Tracker_Ptr& tracker,
                          const Vector2i& rgbImageSize, const Vector2i& depthImageSize,
                          const ITMLib::ITMRGBDCalib& calib, const Scene_Ptr& scene,
                          const DenseMapper_Ptr& denseVoxelMapper, const Settings_CPtr& settings,
-                         const VisualisationEngine_CPtr& visualisationEngine);
+                         const VisualisationEngine_CPtr& visualisationEngine,
+                         const boost::optional<size_t>& hypothesisCount = boost::none);
 
   //#################### DESTRUCTOR ####################
 public:
@@ -120,6 +133,9 @@ private:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /** Override */
+  virtual void load_from_disk(const std::string& path);
+
   /** Override */
   virtual boost::optional<Result> relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
                                              const Vector4f& depthIntrinsics) const;
@@ -131,6 +147,9 @@ public:
   /** Override */
   virtual void reset();
 
+  /** Override */
+  virtual void save_to_disk(const std::string& path) const;
+
   /** Override */
   virtual void train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
                      const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose);
@@ -141,7 +160,15 @@ public:
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /**
-   * \brief Saves the relocalised and refined poses in text files so that they can be used later (e.g. for evaluation).
+   * \brief Refines the specified candidate pose using ICP.
+   *
+   * \param initialPose   The candidate pose to refine.
+   * \param trackingState The tracking state in which to store the result of the refinement.
+   */
+  void refine_pose(const ORUtils::SE3Pose& initialPose, ITMLib::ITMTrackingState *trackingState) const;
+
+  /**
+   * \brief Appends the relocalised and refined poses to trajectory files so that they can be used later (e.g. for evaluation).
    *
    * \note Saving happens only if m_savePoses is true.
    *
@@ -163,6 +190,16 @@ private:
    * \param timer The timer to stop.
    */
   void stop_timer(AverageTimer& timer) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Ranks the specified tracking result, such that better results have lower ranks.
+   *
+   * \param trackerResult The tracking result.
+   * \return              The rank of the tracking result.
+   */
+  static int rank_tracking_result(ITMLib::ITMTrackingState::TrackingResult trackerResult);
 };
 
 }
@@ -5,19 +5,21 @@
 
 #include "ICPRefiningRelocaliser.h"
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
+#include <boost/math/special_functions/fpclassify.hpp>
+
 #include <ITMLib/Core/ITMTrackingController.h>
 #include <ITMLib/Objects/RenderStates/ITMRenderStateFactory.h>
 #include <ITMLib/Trackers/ITMTrackerFactory.h>
 
 #include <tvgutil/filesystem/PathFinder.h>
 #include <tvgutil/misc/SettingsContainer.h>
+#include <tvgutil/timing/ProfilingScope.h>
 #include <tvgutil/timing/TimeUtil.h>
 
-#include "../persistence/PosePersister.h"
-
 namespace itmx {
 
 //#################### CONSTRUCTORS ####################
@@ -27,9 +29,11 @@ ICPRefiningRelocaliser<VoxelType,IndexType>::ICPRefiningRelocaliser(const Reloca
                                                                     const Vector2i& rgbImageSize, const Vector2i& depthImageSize,
                                                                     const ITMLib::ITMRGBDCalib& calib, const Scene_Ptr& scene,
                                                                     const DenseMapper_Ptr& denseVoxelMapper, const Settings_CPtr& settings,
-                                                                    const VisualisationEngine_CPtr& visualisationEngine)
+                                                                    const VisualisationEngine_CPtr& visualisationEngine,
+                                                                    const boost::optional<size_t>& hypothesisCount)
 : RefiningRelocaliser(innerRelocaliser),
   m_denseVoxelMapper(denseVoxelMapper),
+  m_relocalisationIndex(0),
   m_scene(scene),
   m_settings(settings),
   m_timerRelocalisation("Relocalisation"),
@@ -38,27 +42,35 @@ ICPRefiningRelocaliser<VoxelType,IndexType>::ICPRefiningRelocaliser(const Reloca
   m_tracker(tracker),
   m_visualisationEngine(visualisationEngine)
 {
-  // Construct the tracking controller, tracking state and view.
-  m_trackingController.reset(new ITMTrackingController(m_tracker.get(), m_settings.get()));
-  m_trackingState.reset(new ITMTrackingState(depthImageSize, m_settings->GetMemoryType()));
-  m_view.reset(new ITMView(calib, rgbImageSize, depthImageSize, m_settings->deviceType == ITMLibSettings::DEVICE_CUDA));
-
   // Configure the relocaliser based on the settings that have been passed in.
   const static std::string settingsNamespace = "ICPRefiningRelocaliser.";
+  m_hypothesisCount = std::max<size_t>(hypothesisCount ? *hypothesisCount : m_settings->get_first_value<size_t>(settingsNamespace + "hypothesisCount", 1), 1);
   m_savePoses = m_settings->get_first_value<bool>(settingsNamespace + "saveRelocalisationPoses", false);
   m_timersEnabled = m_settings->get_first_value<bool>(settingsNamespace + "timersEnabled", false);
 
+  // Construct the tracking controller, the view and a tracking state for each pose hypothesis that we may need to refine.
+  m_trackingController.reset(new ITMTrackingController(m_tracker.get(), m_settings.get()));
+  m_view.reset(new ITMView(calib, rgbImageSize, depthImageSize, m_settings->deviceType == ITMLibSettings::DEVICE_CUDA));
+  for(size_t i = 0; i < m_hypothesisCount; ++i)
+  {
+    m_trackingStates.push_back(TrackingState_Ptr(new ITMTrackingState(depthImageSize, m_settings->GetMemoryType())));
+  }
+
   if(m_savePoses)
   {
     // Get the (global) experiment tag.
     const std::string experimentTag = m_settings->get_first_value<std::string>("experimentTag", tvgutil::TimeUtil::get_iso_timestamp());
 
     // Determine the directory to which to save the poses and make sure that it exists.
-    m_posePathGenerator.reset(tvgutil::SequentialPathGenerator(tvgutil::find_subdir_from_executable("reloc_poses") / experimentTag));
-    boost::filesystem::create_directories(m_posePathGenerator->get_base_dir());
+    const boost::filesystem::path poseDir = tvgutil::find_subdir_from_executable("reloc_poses") / experimentTag;
+    boost::filesystem::create_directories(poseDir);
+
+    // Append the poses to one trajectory file per stream, rather than saving a file per pose per relocalisation call.
+    m_refinedPoseWriter.reset(new TrajectoryWriter(poseDir / "icp.txt"));
+    m_relocalisedPoseWriter.reset(new TrajectoryWriter(poseDir / "reloc.txt"));
 
     // Output the directory we're using (for debugging purposes).
-    std::cout << "Saving relocalisation poses in: " << m_posePathGenerator->get_base_dir() << '\n';
+    std::cout << "Saving relocalisation poses in: " << poseDir << '\n';
   }
 }
 
@@ -77,6 +89,12 @@ ICPRefiningRelocaliser<VoxelType,IndexType>::~ICPRefiningRelocaliser()
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+template <typename VoxelType, typename IndexType>
+void ICPRefiningRelocaliser<VoxelType,IndexType>::load_from_disk(const std::string& path)
+{
+  m_innerRelocaliser->load_from_disk(path);
+}
+
 template <typename VoxelType, typename IndexType>
 boost::optional<Relocaliser::Result>
 ICPRefiningRelocaliser<VoxelType,IndexType>::relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
@@ -96,9 +114,14 @@ ICPRefiningRelocaliser<VoxelType,IndexType>::relocalise(const ITMUChar4Image *co
   // Reset the initial pose.
   initialPose.reset();
 
-  // Run the inner relocaliser. If it fails, save dummy poses and early out.
-  boost::optional<Result> relocalisationResult = m_innerRelocaliser->relocalise(colourImage, depthImage, depthIntrinsics);
-  if(!relocalisationResult)
+  // Run the inner relocaliser to get a set of candidate poses. If it fails, save dummy poses and early out.
+  std::vector<Result> candidates;
+  {
+    tvgutil::ProfilingScope innerScope("ICPRefiningRelocaliser.InnerRelocalise");
+    candidates = m_innerRelocaliser->relocalise_candidates(colourImage, depthImage, depthIntrinsics, m_hypothesisCount);
+  }
+
+  if(candidates.empty())
   {
     Matrix4f invalidPose;
     invalidPose.setValues(std::numeric_limits<float>::quiet_NaN());
@@ -107,8 +130,7 @@ ICPRefiningRelocaliser<VoxelType,IndexType>::relocalise(const ITMUChar4Image *co
     return boost::none;
   }
 
-  // Since the inner relocaliser succeeded, copy its result into the initial pose.
-  initialPose = relocalisationResult->pose;
+  tvgutil::ProfilingScope refineScope("ICPRefiningRelocaliser.Refine");
 
   // Copy the depth and RGB images into the view.
   m_view->depth->SetFrom(depthImage, m_settings->deviceType == ITMLibSettings::DEVICE_CUDA ? ITMFloatImage::CUDA_TO_CUDA : ITMFloatImage::CPU_TO_CPU);
@@ -126,29 +148,32 @@ ICPRefiningRelocaliser<VoxelType,IndexType>::relocalise(const ITMUChar4Image *co
     m_settings->GetMemoryType()
   ));
 
-  // Set up the tracking state using the initial pose.
-  m_trackingState->pose_d->SetFrom(initialPose.get_ptr());
-
-  // Update the list of visible blocks.
-  const bool resetVisibleList = true;
-  m_denseVoxelMapper->UpdateVisibleList(m_view.get(), m_trackingState.get(), m_scene.get(), m_voxelRenderState.get(), resetVisibleList);
+  // Refine each candidate pose using ICP (each in its own tracking state), and pick the one whose refinement
+  // was of the best quality. If several are equally good, we prefer the one the inner relocaliser ranked highest.
+  size_t bestIndex = 0;
+  for(size_t i = 0, size = candidates.size(); i < size; ++i)
+  {
+    refine_pose(candidates[i].pose, m_trackingStates[i].get());
+    if(rank_tracking_result(m_trackingStates[i]->trackerResult) < rank_tracking_result(m_trackingStates[bestIndex]->trackerResult))
+    {
+      bestIndex = i;
+    }
+  }
 
-  // Raycast from the initial pose to prepare for tracking.
-  m_trackingController->Prepare(m_trackingState.get(), m_scene.get(), m_view.get(), m_visualisationEngine.get(), m_voxelRenderState.get());
-
-  // Run the tracker to refine the initial pose.
-  m_trackingController->Track(m_trackingState.get(), m_view.get());
+  // Copy the best candidate pose into the initial pose.
+  initialPose = candidates[bestIndex].pose;
+  const TrackingState_Ptr& trackingState = m_trackingStates[bestIndex];
 
   // Save the poses.
-  save_poses(initialPose->GetInvM(), m_trackingState->pose_d->GetInvM());
+  save_poses(initialPose->GetInvM(), trackingState->pose_d->GetInvM());
 
   // Set up the result.
   boost::optional<Result> refinementResult;
-  if(m_trackingState->trackerResult != ITMTrackingState::TRACKING_FAILED)
+  if(trackingState->trackerResult != ITMTrackingState::TRACKING_FAILED)
   {
     refinementResult.reset(Result());
-    refinementResult->pose.SetFrom(m_trackingState->pose_d);
-    refinementResult->quality = m_trackingState->trackerResult == ITMTrackingState::TRACKING_GOOD ? RELOCALISATION_GOOD : RELOCALISATION_POOR;
+    refinementResult->pose.SetFrom(trackingState->pose_d);
+    refinementResult->quality = trackingState->trackerResult == ITMTrackingState::TRACKING_GOOD ? RELOCALISATION_GOOD : RELOCALISATION_POOR;
 
     // If we are in evaluation mode (we are saving the poses), force the quality to POOR to prevent fusion whilst evaluating the testing sequence.
     if(m_savePoses) refinementResult->quality = RELOCALISATION_POOR;
@@ -165,6 +190,12 @@ void ICPRefiningRelocaliser<VoxelType,IndexType>::reset()
   m_innerRelocaliser->reset();
 }
 
+template <typename VoxelType, typename IndexType>
+void ICPRefiningRelocaliser<VoxelType,IndexType>::save_to_disk(const std::string& path) const
+{
+  m_innerRelocaliser->save_to_disk(path);
+}
+
 template <typename VoxelType, typename IndexType>
 void ICPRefiningRelocaliser<VoxelType,IndexType>::train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
                                                         const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose)
@@ -184,14 +215,35 @@ void ICPRefiningRelocaliser<VoxelType,IndexType>::update()
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+template <typename VoxelType, typename IndexType>
+void ICPRefiningRelocaliser<VoxelType,IndexType>::refine_pose(const ORUtils::SE3Pose& initialPose, ITMTrackingState *trackingState) const
+{
+  // Set up the tracking state using the initial pose.
+  trackingState->pose_d->SetFrom(&initialPose);
+
+  // Update the list of visible blocks.
+  const bool resetVisibleList = true;
+  m_denseVoxelMapper->UpdateVisibleList(m_view.get(), trackingState, m_scene.get(), m_voxelRenderState.get(), resetVisibleList);
+
+  // Raycast from the initial pose to prepare for tracking.
+  m_trackingController->Prepare(trackingState, m_scene.get(), m_view.get(), m_visualisationEngine.get(), m_voxelRenderState.get());
+
+  // Run the tracker to refine the initial pose.
+  m_trackingController->Track(trackingState, m_view.get());
+}
+
 template <typename VoxelType, typename IndexType>
 void ICPRefiningRelocaliser<VoxelType,IndexType>::save_poses(const Matrix4f& relocalisedPose, const Matrix4f& refinedPose) const
 {
   if(!m_savePoses) return;
 
-  PosePersister::save_pose_on_thread(relocalisedPose, m_posePathGenerator->make_path("pose-%06i.reloc.txt"));
-  PosePersister::save_pose_on_thread(refinedPose, m_posePathGenerator->make_path("pose-%06i.icp.txt"));
-  m_posePathGenerator->increment_index();
+  // The poses are timestamped with the index of the relocalisation call. If relocalisation failed (in which case the poses
+  // are invalid), nothing is written for the call, so the evaluation tools can detect the failure from the missing timestamp.
+  const double timestamp = static_cast<double>(m_relocalisationIndex++);
+  if(boost::math::isnan(relocalisedPose.m[0])) return;
+
+  m_relocalisedPoseWriter->write_pose(timestamp, relocalisedPose);
+  m_refinedPoseWriter->write_pose(timestamp, refinedPose);
 }
 
 template <typename VoxelType, typename IndexType>
@@ -218,4 +270,20 @@ void ICPRefiningRelocaliser<VoxelType,IndexType>::stop_timer(AverageTimer& timer
   timer.stop();
 }
 
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+template <typename VoxelType, typename IndexType>
+int ICPRefiningRelocaliser<VoxelType,IndexType>::rank_tracking_result(ITMTrackingState::TrackingResult trackerResult)
+{
+  switch(trackerResult)
+  {
+    case ITMTrackingState::TRACKING_GOOD:
+      return 0;
+    case ITMTrackingState::TRACKING_POOR:
+      return 1;
+    default:
+      return 2;
+  }
+}
+
 }
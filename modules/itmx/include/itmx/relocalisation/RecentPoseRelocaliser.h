@@ -0,0 +1,61 @@
+/**
+ * itmx: RecentPoseRelocaliser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_RECENTPOSERELOCALISER
+#define H_ITMX_RECENTPOSERELOCALISER
+
+#include <boost/circular_buffer.hpp>
+
+#include "Relocaliser.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to "relocalise" a camera by proposing the poses from which it was recently trained.
+ *
+ * This is intended to be wrapped in a relocaliser that refines its proposals using ICP (see ICPRefiningRelocaliser), as the cheap
+ * first stage of a relocaliser cascade (see CascadeRelocaliser): after a brief loss of tracking, the camera is usually still close
+ * to one of the last known-good poses, in which case ICP from that pose recovers it without needing to consult a heavier model.
+ *
+ * To keep the proposals diverse, the most recent known-good pose is replaced by each new one that is similar to it, and it is only
+ * kept (and a new slot used) once the camera has moved significantly away from it.
+ */
+class RecentPoseRelocaliser : public Relocaliser
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The recent known-good poses, from the oldest to the most recent. */
+  boost::circular_buffer<ORUtils::SE3Pose> m_poses;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a recent pose relocaliser.
+   *
+   * \param maxPoseCount            The maximum number of recent poses to keep.
+   * \throws std::invalid_argument  If maxPoseCount is zero.
+   */
+  explicit RecentPoseRelocaliser(size_t maxPoseCount);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual boost::optional<Result> relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage, const Vector4f& depthIntrinsics) const;
+
+  /** Override */
+  virtual std::vector<Result> relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                    const Vector4f& depthIntrinsics, size_t maxCandidateCount) const;
+
+  /** Override */
+  virtual void reset();
+
+  /** Override */
+  virtual void train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                     const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose);
+};
+
+}
+
+#endif
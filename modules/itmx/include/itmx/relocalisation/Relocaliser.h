@@ -6,6 +6,9 @@
 #ifndef H_ITMX_RELOCALISER
 #define H_ITMX_RELOCALISER
 
+#include <string>
+#include <vector>
+
 #include <boost/optional.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -86,6 +89,43 @@ public:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Replaces the contents of the relocaliser with contents that were previously saved to disk (see save_to_disk).
+   *
+   * This allows a relocaliser that was trained on a scene in one session to relocalise against it immediately in a later one.
+   * By default, this throws. Derived relocalisers whose contents can be saved should override it (and save_to_disk).
+   *
+   * \param path                The path to the file from which to load the contents of the relocaliser.
+   * \throws std::runtime_error If the contents cannot be loaded (e.g. because the relocaliser does not support it, or the file is incompatible).
+   */
+  virtual void load_from_disk(const std::string& path);
+
+  /**
+   * \brief Attempts to find a set of candidate locations from which an RGB-D image pair may have been acquired.
+   *
+   * The candidates are returned in decreasing order of the relocaliser's confidence in them, so that the first candidate (if any)
+   * is the one that would be returned by relocalise. By default, this simply returns the result of relocalise (if successful).
+   * Derived relocalisers that can naturally produce several candidate poses should override it to return all of them.
+   *
+   * \param colourImage       The colour image.
+   * \param depthImage        The depth image.
+   * \param depthIntrinsics   The intrinsic parameters of the depth sensor.
+   * \param maxCandidateCount The maximum number of candidates to return.
+   * \return                  The candidate results of the relocalisation (empty if it was unsuccessful).
+   */
+  virtual std::vector<Result> relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                    const Vector4f& depthIntrinsics, size_t maxCandidateCount) const;
+
+  /**
+   * \brief Saves the contents of the relocaliser to disk, so that they can later be reloaded (see load_from_disk).
+   *
+   * By default, this throws. Derived relocalisers whose contents can be saved should override it (and load_from_disk).
+   *
+   * \param path                The path to the file to which to save the contents of the relocaliser.
+   * \throws std::runtime_error If the contents cannot be saved (e.g. because the relocaliser does not support it).
+   */
+  virtual void save_to_disk(const std::string& path) const;
+
   /**
    * \brief Updates the contents of the relocaliser when spare processing time is available.
    *
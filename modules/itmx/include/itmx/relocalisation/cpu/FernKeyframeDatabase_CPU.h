@@ -0,0 +1,44 @@
+/**
+ * itmx: FernKeyframeDatabase_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_FERNKEYFRAMEDATABASE_CPU
+#define H_ITMX_FERNKEYFRAMEDATABASE_CPU
+
+#include "../interface/FernKeyframeDatabase.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to encode depth images and search for similar keyframes on the CPU.
+ */
+class FernKeyframeDatabase_CPU : public FernKeyframeDatabase
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based fern keyframe database.
+   *
+   * \param fernCount         The number of ferns.
+   * \param decisionsPerFern  The number of decisions made by each fern.
+   * \param depthRange        The minimum and maximum depths of the images that will be encoded.
+   * \param seed              The seed for the random number generator used to generate the fern decisions.
+   */
+  FernKeyframeDatabase_CPU(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void encode_image_sub(const ITMFloatImage *depthImage);
+
+  /** Override */
+  virtual std::vector<Match> find_most_similar_keyframes_sub(int maxMatchCount) const;
+
+  /** Override */
+  virtual void store_codes_sub(int keyframeIndex);
+};
+
+}
+
+#endif
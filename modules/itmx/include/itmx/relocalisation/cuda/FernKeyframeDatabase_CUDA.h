@@ -0,0 +1,49 @@
+/**
+ * itmx: FernKeyframeDatabase_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_FERNKEYFRAMEDATABASE_CUDA
+#define H_ITMX_FERNKEYFRAMEDATABASE_CUDA
+
+#include "../interface/FernKeyframeDatabase.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to encode depth images and search for similar keyframes using CUDA.
+ */
+class FernKeyframeDatabase_CUDA : public FernKeyframeDatabase
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block into which to write the keyframe indices that are sorted alongside the dissimilarities (grown on demand). */
+  mutable boost::shared_ptr<ORUtils::MemoryBlock<int> > m_keyframeIndicesMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based fern keyframe database.
+   *
+   * \param fernCount         The number of ferns.
+   * \param decisionsPerFern  The number of decisions made by each fern.
+   * \param depthRange        The minimum and maximum depths of the images that will be encoded.
+   * \param seed              The seed for the random number generator used to generate the fern decisions.
+   */
+  FernKeyframeDatabase_CUDA(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void encode_image_sub(const ITMFloatImage *depthImage);
+
+  /** Override */
+  virtual std::vector<Match> find_most_similar_keyframes_sub(int maxMatchCount) const;
+
+  /** Override */
+  virtual void store_codes_sub(int keyframeIndex);
+};
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+/**
+ * itmx: FernKeyframeDatabase.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_FERNKEYFRAMEDATABASE
+#define H_ITMX_FERNKEYFRAMEDATABASE
+
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ITMLib/Utils/ITMImageTypes.h>
+
+#include <ORUtils/MemoryBlock.h>
+
+#include "../shared/FernKeyframeDatabase_Shared.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to encode depth images using a set of random ferns,
+ *        and to find the keyframes whose codes are most similar to that of the current image.
+ *
+ * Both the fern decisions and the table of keyframe codes are stored in memory blocks on the device on which the database
+ * operates, so encoding an image that is already on that device and searching the keyframes for it require no transfers
+ * of image data between the host and the device.
+ */
+class FernKeyframeDatabase
+{
+  //#################### TYPEDEFS ####################
+public:
+  /** A (keyframe index, dissimilarity) pair. */
+  typedef std::pair<int,float> Match;
+
+  //#################### NESTED TYPES ####################
+protected:
+  /**
+   * \brief An instance of this struct can be used to order matches by increasing dissimilarity, breaking ties in favour of older keyframes.
+   */
+  struct MatchComparator
+  {
+    bool operator()(const Match& lhs, const Match& rhs) const
+    {
+      return lhs.second < rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+    }
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block containing the codes assigned by the ferns to the most recently encoded image. */
+  boost::shared_ptr<ORUtils::MemoryBlock<char> > m_codesMB;
+
+  /** The number of decisions made by each fern. */
+  int m_decisionsPerFern;
+
+  /** A memory block containing the decisions made by all of the ferns (m_decisionsPerFern for each fern). */
+  boost::shared_ptr<ORUtils::MemoryBlock<FernDecision> > m_decisionsMB;
+
+  /** A memory block into which to write the dissimilarities between the keyframes and the most recently encoded image. */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_dissimilaritiesMB;
+
+  /** The number of ferns. */
+  int m_fernCount;
+
+  /** The number of keyframes in the database. */
+  int m_keyframeCount;
+
+  /** A memory block containing the codes of the keyframes (m_fernCount for each keyframe; its size is the database's capacity). */
+  boost::shared_ptr<ORUtils::MemoryBlock<char> > m_keyframeCodesMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a fern keyframe database.
+   *
+   * \param fernCount                 The number of ferns.
+   * \param decisionsPerFern          The number of decisions made by each fern.
+   * \param depthRange                The minimum and maximum depths of the images that will be encoded.
+   * \param seed                      The seed for the random number generator used to generate the fern decisions.
+   * \throws std::invalid_argument    If the number of ferns is not positive, or the number of decisions per fern is out of range.
+   */
+  FernKeyframeDatabase(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the fern keyframe database.
+   */
+  virtual ~FernKeyframeDatabase();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the codes assigned by the ferns to the specified depth image, and writes them into m_codesMB.
+   *
+   * \param depthImage  The depth image.
+   */
+  virtual void encode_image_sub(const ITMFloatImage *depthImage) = 0;
+
+  /**
+   * \brief Finds the keyframes whose codes are most similar to those of the most recently encoded image.
+   *
+   * \param maxMatchCount The maximum number of keyframes to find (this will be at most the number of keyframes in the database).
+   * \return            The matches, in increasing order of dissimilarity.
+   */
+  virtual std::vector<Match> find_most_similar_keyframes_sub(int maxMatchCount) const = 0;
+
+  /**
+   * \brief Copies the codes of the most recently encoded image into the specified row of the keyframe code table.
+   *
+   * \param keyframeIndex The index of the row into which to copy the codes.
+   */
+  virtual void store_codes_sub(int keyframeIndex) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds the most recently encoded image to the database as a new keyframe.
+   *
+   * \return  The index of the new keyframe.
+   */
+  int add_keyframe();
+
+  /**
+   * \brief Removes all of the keyframes from the database.
+   */
+  void clear();
+
+  /**
+   * \brief Encodes the specified depth image using the ferns.
+   *
+   * The image is read from the memory on the device on which the database operates.
+   *
+   * \param depthImage  The depth image.
+   */
+  void encode_image(const ITMFloatImage *depthImage);
+
+  /**
+   * \brief Finds the keyframes whose codes are most similar to those of the most recently encoded image.
+   *
+   * \param maxMatchCount The maximum number of keyframes to find.
+   * \return              The matches, in increasing order of dissimilarity (empty if the database contains no keyframes).
+   */
+  std::vector<Match> find_most_similar_keyframes(int maxMatchCount) const;
+
+  /**
+   * \brief Gets the contents of the database, e.g. so that they can be saved to disk.
+   *
+   * \param decisions     A vector into which to write the decisions made by the ferns (get_decisions_per_fern() for each fern).
+   * \param keyframeCodes A vector into which to write the codes of the keyframes (get_fern_count() for each keyframe).
+   */
+  void get_contents(std::vector<FernDecision>& decisions, std::vector<char>& keyframeCodes) const;
+
+  /**
+   * \brief Gets the number of decisions made by each fern.
+   *
+   * \return  The number of decisions made by each fern.
+   */
+  int get_decisions_per_fern() const;
+
+  /**
+   * \brief Gets the number of ferns.
+   *
+   * \return  The number of ferns.
+   */
+  int get_fern_count() const;
+
+  /**
+   * \brief Gets the number of keyframes in the database.
+   *
+   * \return  The number of keyframes in the database.
+   */
+  int get_keyframe_count() const;
+
+  /**
+   * \brief Replaces the contents of the database, e.g. with contents that were previously saved to disk.
+   *
+   * \param decisions               The decisions to be made by the ferns (get_decisions_per_fern() for each fern).
+   * \param keyframeCodes           The codes of the keyframes (get_fern_count() for each keyframe).
+   * \throws std::invalid_argument  If the number of decisions or codes does not match the shape of the database.
+   */
+  void set_contents(const std::vector<FernDecision>& decisions, const std::vector<char>& keyframeCodes);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Doubles the capacity of the keyframe code table, preserving the codes of the existing keyframes.
+   */
+  void grow_keyframe_codes();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<FernKeyframeDatabase> FernKeyframeDatabase_Ptr;
+typedef boost::shared_ptr<const FernKeyframeDatabase> FernKeyframeDatabase_CPtr;
+
+}
+
+#endif
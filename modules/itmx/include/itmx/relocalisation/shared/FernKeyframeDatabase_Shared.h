@@ -0,0 +1,131 @@
+/**
+ * itmx: FernKeyframeDatabase_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_FERNKEYFRAMEDATABASE_SHARED
+#define H_ITMX_FERNKEYFRAMEDATABASE_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace itmx {
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of binary decisions that each fern can make (so that a fern's code always fits into a char). */
+enum { FERNKEYFRAMEDATABASE_MAX_DECISIONS_PER_FERN = 7 };
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct represents one of the binary decisions that a fern makes about a depth image.
+ */
+struct FernDecision
+{
+  /** The location in the image at which to test the depth, as a fraction of the image's width and height. */
+  Vector2f location;
+
+  /** The depth threshold against which to test. */
+  float threshold;
+};
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Computes the average of the valid depths in a small window around the specified location in a depth image.
+ *
+ * Averaging over a window makes the fern decisions robust to noise in the depth image, much as the downsampling and
+ * blurring that InfiniTAM's fern encoder performs on the CPU does, but without needing to make an intermediate image.
+ *
+ * \param depths    The depth image.
+ * \param imgSize   The size of the depth image.
+ * \param location  The location, as a fraction of the image's width and height.
+ * \return          The average of the valid depths in the window, or -1 if there are none.
+ */
+_CPU_AND_GPU_CODE_
+inline float sample_window_depth(const float *depths, const Vector2i& imgSize, const Vector2f& location)
+{
+  const int radius = MAX(imgSize.x / 160, 1);
+  const int cx = MIN(static_cast<int>(location.x * imgSize.x), imgSize.x - 1);
+  const int cy = MIN(static_cast<int>(location.y * imgSize.y), imgSize.y - 1);
+
+  float sum = 0.0f;
+  int count = 0;
+  for(int y = MAX(cy - radius, 0), yend = MIN(cy + radius, imgSize.y - 1); y <= yend; ++y)
+  {
+    for(int x = MAX(cx - radius, 0), xend = MIN(cx + radius, imgSize.x - 1); x <= xend; ++x)
+    {
+      const float depth = depths[y * imgSize.x + x];
+      if(depth > 0.0f)
+      {
+        sum += depth;
+        ++count;
+      }
+    }
+  }
+
+  return count > 0 ? sum / count : -1.0f;
+}
+
+/**
+ * \brief Computes the code that the specified fern assigns to a depth image.
+ *
+ * Each of the fern's decisions contributes one bit to the code. If any of the decisions tests a region of the image that
+ * contains no valid depths, the fern's code is set to -1 (denoting "unknown"), and the fern is ignored during matching.
+ *
+ * \param fernIndex         The index of the fern.
+ * \param depths            The depth image.
+ * \param imgSize           The size of the depth image.
+ * \param decisions         The decisions made by all of the ferns (decisionsPerFern for each fern).
+ * \param decisionsPerFern  The number of decisions made by each fern.
+ * \param codes             An array into which to write the codes assigned to the image by the ferns.
+ */
+_CPU_AND_GPU_CODE_
+inline void compute_fern_code(int fernIndex, const float *depths, const Vector2i& imgSize, const FernDecision *decisions, int decisionsPerFern, char *codes)
+{
+  int code = 0;
+  for(int d = 0; d < decisionsPerFern; ++d)
+  {
+    const FernDecision& decision = decisions[fernIndex * decisionsPerFern + d];
+    const float depth = sample_window_depth(depths, imgSize, decision.location);
+    if(depth < 0.0f)
+    {
+      codes[fernIndex] = -1;
+      return;
+    }
+
+    if(depth > decision.threshold) code |= 1 << d;
+  }
+
+  codes[fernIndex] = static_cast<char>(code);
+}
+
+/**
+ * \brief Computes the dissimilarity between the specified keyframe and the current image.
+ *
+ * The dissimilarity is the fraction of the ferns that do not assign the same known code to both the keyframe and the image
+ * (a form of normalised Hamming distance between their codes).
+ *
+ * \param keyframeIndex     The index of the keyframe.
+ * \param keyframeCodes     The codes of all of the keyframes (fernCount for each keyframe).
+ * \param codes             The codes of the current image.
+ * \param fernCount         The number of ferns.
+ * \param dissimilarities   An array into which to write the dissimilarities between the keyframes and the image.
+ */
+_CPU_AND_GPU_CODE_
+inline void compute_keyframe_dissimilarity(int keyframeIndex, const char *keyframeCodes, const char *codes, int fernCount, float *dissimilarities)
+{
+  const char *keyframeCode = keyframeCodes + keyframeIndex * fernCount;
+
+  int matchCount = 0;
+  for(int f = 0; f < fernCount; ++f)
+  {
+    if(codes[f] != -1 && keyframeCode[f] == codes[f]) ++matchCount;
+  }
+
+  dissimilarities[keyframeIndex] = 1.0f - static_cast<float>(matchCount) / fernCount;
+}
+
+}
+
+#endif
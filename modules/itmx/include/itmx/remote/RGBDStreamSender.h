@@ -0,0 +1,141 @@
+/**
+ * itmx: RGBDStreamSender.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_RGBDSTREAMSENDER
+#define H_ITMX_RGBDSTREAMSENDER
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "RGBDStreamUtil.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to send a stream of RGB-D frames to a remote receiver over TCP (see RGBDStreamUtil).
+ *
+ * Frames are encoded on the calling thread and sent on a separate worker thread, so that a slow link never blocks
+ * the camera. At most one encoded frame waits to be sent at any one time: if a new frame is submitted before the
+ * previous one has started to be sent, the previous one is dropped.
+ */
+class RGBDStreamSender
+{
+  //#################### NESTED TYPES ####################
+private:
+  /** The network connection to the receiver (this is opaque here, to keep boost/asio.hpp out of the header). */
+  struct Connection;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The network connection to the receiver. */
+  boost::shared_ptr<Connection> m_connection;
+
+  /** The codec with which to encode the depth images. */
+  PackedSequenceUtil::DepthCodec m_depthCodec;
+
+  /** The number of frames that have been dropped because the link could not keep up. */
+  size_t m_droppedFrameCount;
+
+  /** The message describing the error (if any) that stopped the worker thread. */
+  std::string m_error;
+
+  /** A buffer into which to encode each frame (reused to avoid reallocating it for every frame). */
+  std::vector<unsigned char> m_frameBuffer;
+
+  /** Whether or not there is a frame waiting to be sent. */
+  bool m_framePending;
+
+  /** The synchronisation mutex. */
+  mutable boost::mutex m_mutex;
+
+  /** The encoded frame that is waiting to be sent (if any). */
+  std::vector<unsigned char> m_pendingFrame;
+
+  /** A condition variable used to wake the worker thread when there is a frame to send. */
+  boost::condition_variable m_pendingFrameReady;
+
+  /** The number of frames that have been sent so far. */
+  size_t m_sentFrameCount;
+
+  /** A flag used to tell the worker thread to stop. */
+  bool m_stopRequested;
+
+  /** The worker thread that sends the frames. */
+  boost::thread m_worker;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an RGB-D stream sender and connects it to a receiver.
+   *
+   * \param host                The host on which the receiver is listening.
+   * \param port                The port on which the receiver is listening.
+   * \param calibText           The calibration for the camera (in the format of calib.txt).
+   * \param rgbImageSize        The size of the RGB images that will be sent.
+   * \param depthImageSize      The size of the depth images that will be sent.
+   * \param depthCodec          The codec with which to encode the depth images.
+   * \throws std::runtime_error If the sender could not connect to the receiver.
+   */
+  RGBDStreamSender(const std::string& host, const std::string& port, const std::string& calibText,
+                   const Vector2i& rgbImageSize, const Vector2i& depthImageSize,
+                   PackedSequenceUtil::DepthCodec depthCodec = PackedSequenceUtil::DC_DELTA_VARINT);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the sender, closing the connection to the receiver.
+   *
+   * Any frame that is still waiting to be sent is discarded.
+   */
+  ~RGBDStreamSender();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  RGBDStreamSender(const RGBDStreamSender&);
+  RGBDStreamSender& operator=(const RGBDStreamSender&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the number of frames that have been dropped so far because the link could not keep up.
+   *
+   * \return The number of frames that have been dropped so far.
+   */
+  size_t get_dropped_frame_count() const;
+
+  /**
+   * \brief Gets the number of frames that have been sent so far.
+   *
+   * \return The number of frames that have been sent so far.
+   */
+  size_t get_sent_frame_count() const;
+
+  /**
+   * \brief Submits a frame to be sent to the receiver.
+   *
+   * This returns as soon as the frame has been encoded. If the previously submitted frame has not yet started
+   * to be sent, it is dropped in favour of this one.
+   *
+   * \param rgbImage            The RGB image for the frame.
+   * \param depthImage          The depth image for the frame.
+   * \throws std::runtime_error If the connection to the receiver has failed.
+   */
+  void send_frame(const ORUtils::Image<Vector4u> *rgbImage, const ORUtils::Image<short> *depthImage);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Sends the submitted frames to the receiver (this runs on the worker thread).
+   */
+  void run_worker();
+};
+
+}
+
+#endif
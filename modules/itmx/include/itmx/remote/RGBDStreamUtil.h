@@ -0,0 +1,124 @@
+/**
+ * itmx: RGBDStreamUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_RGBDSTREAMUTIL
+#define H_ITMX_RGBDSTREAMUTIL
+
+#include <string>
+#include <vector>
+
+#include "../persistence/PackedSequenceUtil.h"
+
+namespace itmx {
+
+/**
+ * \brief This class contains the constants and message codecs that define the RGB-D stream protocol.
+ *
+ * An RGB-D stream carries the frames from a camera on one machine to a SLAM pipeline on another, over a TCP connection
+ * that is opened by the sender. Every message is preceded by its size in bytes (as a 32-bit integer). The first message
+ * is a handshake: the 8-byte signature "SPTRGBD1", followed by the widths and heights of the RGB and depth images (each
+ * as a 32-bit integer), followed by the length of the calibration text (as a 32-bit integer) and the text itself (in the
+ * format of calib.txt). Every subsequent message is a frame: the depth image and then the RGB image, each stored as in a
+ * packed sequence frame record (see PackedSequenceUtil), i.e. as its width, height, codec and encoded size, followed by
+ * the encoded data. All integers are little-endian.
+ *
+ * Frames are only ever buffered one deep at each end of the connection: if a new frame is produced before the previous
+ * one has been consumed, the previous one is dropped. This keeps the latency bounded when the link or the receiver
+ * cannot keep up.
+ */
+class RGBDStreamUtil
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains the information about a stream that is sent in its handshake.
+   */
+  struct StreamInfo
+  {
+    /** The calibration for the camera (in the format of calib.txt). */
+    std::string calibText;
+
+    /** The size of the depth images. */
+    Vector2i depthImageSize;
+
+    /** The size of the RGB images. */
+    Vector2i rgbImageSize;
+  };
+
+  //#################### PUBLIC STATIC VARIABLES ####################
+public:
+  /** The signature at the start of a handshake message. */
+  static const char *HANDSHAKE_SIGNATURE;
+
+  /** The maximum size (in bytes) of a message that a receiver will accept (this guards against corrupt message sizes). */
+  static const size_t MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+
+  /** The size (in bytes) of the header that precedes each message. */
+  static const size_t MESSAGE_HEADER_SIZE = 4;
+
+  /** The size (in bytes) of the handshake signature. */
+  static const size_t SIGNATURE_SIZE = 8;
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Decodes a frame message into a pair of images.
+   *
+   * \param message             The frame message (without its header).
+   * \param rgbImage            The image into which to decode the RGB image (this must already have the right size).
+   * \param depthImage          The image into which to decode the depth image (this must already have the right size).
+   * \throws std::runtime_error If the message is corrupt, or either image in it is not of the expected size.
+   */
+  static void decode_frame(const std::vector<unsigned char>& message, ORUtils::Image<Vector4u>& rgbImage, ORUtils::Image<short>& depthImage);
+
+  /**
+   * \brief Decodes a handshake message.
+   *
+   * \param message             The handshake message (without its header).
+   * \return                    The information about the stream contained in the handshake.
+   * \throws std::runtime_error If the message is not a valid handshake.
+   */
+  static StreamInfo decode_handshake(const std::vector<unsigned char>& message);
+
+  /**
+   * \brief Encodes a frame message.
+   *
+   * \param rgbImage    The RGB image for the frame.
+   * \param depthImage  The depth image for the frame.
+   * \param depthCodec  The codec with which to encode the depth image.
+   * \param message     The buffer into which to encode the frame message (any previous contents are discarded).
+   */
+  static void encode_frame(const ORUtils::Image<Vector4u>& rgbImage, const ORUtils::Image<short>& depthImage,
+                           PackedSequenceUtil::DepthCodec depthCodec, std::vector<unsigned char>& message);
+
+  /**
+   * \brief Encodes a handshake message.
+   *
+   * \param info    The information about the stream.
+   * \param message The buffer into which to encode the handshake message (any previous contents are discarded).
+   */
+  static void encode_handshake(const StreamInfo& info, std::vector<unsigned char>& message);
+
+  /**
+   * \brief Makes the header that must precede a message of the specified size.
+   *
+   * \param messageSize The size (in bytes) of the message.
+   * \return            The header.
+   */
+  static std::vector<unsigned char> make_message_header(size_t messageSize);
+
+  /**
+   * \brief Reads the size of a message from its header.
+   *
+   * \param header              The header.
+   * \return                    The size (in bytes) of the message.
+   * \throws std::runtime_error If the message would be larger than the maximum acceptable size.
+   */
+  static size_t read_message_size(const unsigned char *header);
+};
+
+}
+
+#endif
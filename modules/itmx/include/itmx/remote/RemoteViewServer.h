@@ -0,0 +1,228 @@
+/**
+ * itmx: RemoteViewServer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_REMOTEVIEWSERVER
+#define H_ITMX_REMOTEVIEWSERVER
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread.hpp>
+
+#include "../base/ITMImagePtrTypes.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to stream a set of rendered views (e.g. the sub-windows of an application)
+ *        to any number of remote viewers over TCP, and to receive input events back from those viewers.
+ *
+ * Every message on a viewer's connection (in either direction) is preceded by its size in bytes (as a 32-bit integer), and starts
+ * with its type (see MessageType, as a 32-bit integer). The server sends each viewer MT_VIEW_FRAME messages, each consisting of the index of the view, the
+ * width and height of the image, the codec with which it was encoded (see ViewCodec) and the size of the encoded data (each as
+ * a 32-bit integer), followed by the encoded data. A viewer may send the server MT_INPUT_EVENT messages, each consisting of the
+ * type of the event (see InputEventType), the key or mouse button code, the index of the view in which the event occurred and
+ * the fractional position of the mouse within that view (the last two as 32-bit floats). All integers are little-endian.
+ *
+ * The views are encoded once on a dedicated encoder thread, however many viewers there are, and are sent to each viewer on a
+ * thread of its own. Each viewer only ever has the latest frame of each view waiting to be sent to it, so a slow viewer drops
+ * frames rather than falling behind, and never holds up either the application or the other viewers.
+ */
+class RemoteViewServer
+{
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the different types of input event that a viewer can send.
+   */
+  enum InputEventType
+  {
+    IET_KEY_DOWN,
+    IET_KEY_UP,
+    IET_MOUSE_BUTTON_DOWN,
+    IET_MOUSE_BUTTON_UP,
+    IET_MOUSE_MOVE
+  };
+
+  /**
+   * \brief The values of this enumeration denote the different types of message that can be sent between the server and a viewer.
+   */
+  enum MessageType
+  {
+    /** An input event (viewer -> server). */
+    MT_INPUT_EVENT,
+
+    /** A frame of one of the views (server -> viewer). */
+    MT_VIEW_FRAME
+  };
+
+  /**
+   * \brief The values of this enumeration denote the codecs that can be used to encode the views.
+   */
+  enum ViewCodec
+  {
+    /** 3 bytes per pixel (R, G, B), in row-major order. */
+    VC_RGB,
+
+    /** A PNG file (lossless, and typically much smaller than VC_RGB for rendered views). */
+    VC_PNG
+  };
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents an input event that has been received from a viewer.
+   */
+  struct InputEvent
+  {
+    /** The key or mouse button code (unused for mouse movement events). */
+    int code;
+
+    /** The fractional position of the mouse within the view. */
+    Vector2f fracPos;
+
+    /** The type of the event. */
+    InputEventType type;
+
+    /** The index of the view in which the event occurred. */
+    size_t viewIndex;
+  };
+
+private:
+  /** The network state used to accept viewers (this is opaque here, to keep boost/asio.hpp out of the header). */
+  struct Connection;
+
+  /** The state associated with a connected viewer. */
+  struct Viewer;
+  typedef boost::shared_ptr<Viewer> Viewer_Ptr;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The thread on which new viewers are accepted. */
+  boost::thread m_acceptor;
+
+  /** The codec with which to encode the views. */
+  ViewCodec m_codec;
+
+  /** The network state used to accept viewers. */
+  boost::shared_ptr<Connection> m_connection;
+
+  /** The thread on which the views are encoded. */
+  boost::thread m_encoder;
+
+  /** The input events that have been received from the viewers but not yet taken. */
+  std::deque<InputEvent> m_inputEvents;
+
+  /** The synchronisation mutex. */
+  boost::mutex m_mutex;
+
+  /** The latest image of each view that has been published but not yet encoded. */
+  std::map<size_t,ITMUChar4Image_CPtr> m_pendingViews;
+
+  /** A condition variable used to wake the encoder thread when a view is published. */
+  boost::condition_variable m_pendingViewsReady;
+
+  /** A flag used to tell the encoder thread to stop. */
+  bool m_stopRequested;
+
+  /** The viewers that are currently connected. */
+  std::vector<Viewer_Ptr> m_viewers;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a remote view server and starts listening for viewers.
+   *
+   * \param port                The port on which to listen for viewers.
+   * \param codec               The codec with which to encode the views.
+   * \throws std::runtime_error If the server could not listen on the specified port.
+   */
+  RemoteViewServer(unsigned short port, ViewCodec codec = VC_PNG);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the server, disconnecting any viewers.
+   */
+  ~RemoteViewServer();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  RemoteViewServer(const RemoteViewServer&);
+  RemoteViewServer& operator=(const RemoteViewServer&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the number of viewers that are currently connected.
+   *
+   * \return The number of viewers that are currently connected.
+   */
+  size_t get_viewer_count();
+
+  /**
+   * \brief Publishes the latest image of a view, to be sent to all of the connected viewers.
+   *
+   * This returns immediately: the image is encoded and sent asynchronously, so it must not be modified once it has been
+   * published. If an earlier image of the same view has not yet been encoded, it is dropped in favour of this one.
+   *
+   * \param viewIndex The index of the view.
+   * \param image     The image of the view (on the CPU).
+   */
+  void publish_view(size_t viewIndex, const ITMUChar4Image_CPtr& image);
+
+  /**
+   * \brief Takes any input events that have been received from the viewers since this was last called.
+   *
+   * \return The input events, in the order in which they were received.
+   */
+  std::vector<InputEvent> take_input_events();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Starts waiting asynchronously for the next viewer to connect.
+   */
+  void accept_next_viewer();
+
+  /**
+   * \brief Starts a viewer that has just connected, and waits for the next one.
+   *
+   * \param viewer  The viewer.
+   * \param err     The error (if any) that occurred whilst accepting the viewer.
+   */
+  void handle_accept(const Viewer_Ptr& viewer, const boost::system::error_code& err);
+
+  /**
+   * \brief Encodes the published views and passes them to the viewers for sending (this runs on the encoder thread).
+   */
+  void run_encoder();
+
+  /**
+   * \brief Receives input events from a viewer until it disconnects (this runs on the viewer's reader thread).
+   *
+   * \param viewer  The viewer.
+   */
+  void run_viewer_reader(const Viewer_Ptr& viewer);
+
+  /**
+   * \brief Sends the encoded views to a viewer until it disconnects (this runs on the viewer's writer thread).
+   *
+   * \param viewer  The viewer.
+   */
+  static void run_viewer_writer(const Viewer_Ptr& viewer);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<RemoteViewServer> RemoteViewServer_Ptr;
+
+}
+
+#endif
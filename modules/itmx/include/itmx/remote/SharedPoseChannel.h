@@ -0,0 +1,130 @@
+/**
+ * itmx: SharedPoseChannel.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_SHAREDPOSECHANNEL
+#define H_ITMX_SHAREDPOSECHANNEL
+
+#include <cstddef>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+
+namespace itmx {
+
+/**
+ * \brief This struct specifies the layout of a shared-memory channel via which camera poses (and, optionally, a raycast image)
+ *        can be published to other processes on the same machine (see SharedPosePublisher and SharedPoseReader).
+ *
+ * The channel consists of a header, followed by a fixed-size ring of pose slots, followed by the image (if any). Each pose slot
+ * and the image are protected by their own sequence numbers (a seqlock): a sequence number is odd whilst the data it protects is
+ * being written, so a reader can detect (and retry) any read that overlaps a write. The publisher never waits for the readers,
+ * and the readers never block the publisher. All of the types in the channel are plain data (plus lock-free atomics), so that
+ * the channel can be read without reference to any of the rest of the codebase.
+ *
+ * Times are expressed in microseconds on boost::chrono::steady_clock, which on Linux is the system-wide monotonic clock,
+ * so that they can be compared between processes.
+ */
+struct SharedPoseChannel
+{
+  //#################### CONSTANTS ####################
+
+  /** A value identifying the memory as a shared pose channel. */
+  static const boost::uint32_t MAGIC = 0x53504331; // "SPC1"
+
+  /** The number of slots in the ring of recent poses. */
+  static const boost::uint32_t SLOT_COUNT = 64;
+
+  /** The version of the channel layout (incremented whenever the layout changes). */
+  static const boost::uint32_t VERSION = 1;
+
+  //#################### NESTED TYPES ####################
+
+  /**
+   * \brief An instance of this struct represents the camera pose for a single frame.
+   */
+  struct PoseRecord
+  {
+    /** The time (in microseconds, on boost::chrono::steady_clock) at which the frame was captured. */
+    boost::int64_t captureTime;
+
+    /** The index of the frame. */
+    boost::uint64_t frameIndex;
+
+    /** The world-to-camera transformation for the frame (as a column-major 4x4 matrix of the kind used by InfiniTAM). */
+    float pose[16];
+
+    /** The quality of the tracking for the frame (0 = failed, 1 = poor, 2 = good, as per ITMTrackingState::TrackingResult). */
+    boost::int32_t trackingQuality;
+  };
+
+  /**
+   * \brief An instance of this struct represents a slot in the ring of recent poses.
+   */
+  struct PoseSlot
+  {
+    /** The sequence number of the slot (odd whilst the record is being written, and 2 * (recordIndex + 1) once it has been). */
+    boost::atomic<boost::uint64_t> sequence;
+
+    /** The record in the slot. */
+    PoseRecord record;
+  };
+
+  /**
+   * \brief An instance of this struct represents the header of the channel.
+   */
+  struct Header
+  {
+    /** The time (in microseconds, on boost::chrono::steady_clock) at which the frame from which the image was rendered was captured. */
+    boost::int64_t imageCaptureTime;
+
+    /** The height of the image (0 if the channel has no image). */
+    boost::int32_t imageHeight;
+
+    /** The sequence number of the image (odd whilst the image is being written). */
+    boost::atomic<boost::uint64_t> imageSequence;
+
+    /** The width of the image (0 if the channel has no image). */
+    boost::int32_t imageWidth;
+
+    /** A value identifying the memory as a shared pose channel (see MAGIC), written last when the channel is created. */
+    boost::atomic<boost::uint32_t> magic;
+
+    /** The number of records that have been written into the ring of recent poses. */
+    boost::atomic<boost::uint64_t> recordCount;
+
+    /** The version of the channel layout (see VERSION). */
+    boost::uint32_t version;
+  };
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Gets the offset (in bytes) of the image from the start of a channel.
+   *
+   * \return  The offset of the image from the start of a channel.
+   */
+  static size_t image_offset()
+  {
+    return sizeof(Header) + SLOT_COUNT * sizeof(PoseSlot);
+  }
+
+  /**
+   * \brief Gets the size (in bytes) of a channel with an image of the specified size.
+   *
+   * \note  The image consists of 4 floats per pixel (a point in the raycast, in voxel coordinates, and its confidence).
+   *
+   * \param imageWidth  The width of the image (0 if the channel has no image).
+   * \param imageHeight The height of the image (0 if the channel has no image).
+   * \return            The size of the channel.
+   */
+  static size_t size(int imageWidth, int imageHeight)
+  {
+    return image_offset() + static_cast<size_t>(imageWidth) * imageHeight * 4 * sizeof(float);
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * itmx: SharedPosePublisher.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_SHAREDPOSEPUBLISHER
+#define H_ITMX_SHAREDPOSEPUBLISHER
+
+#include <string>
+
+#include <boost/chrono/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <ITMLib/Utils/ITMImageTypes.h>
+#include <ORUtils/SE3Pose.h>
+
+#include "SharedPoseChannel.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to publish camera poses (and, optionally, a raycast image) to other processes
+ *        on the same machine via a named shared-memory channel (see SharedPoseChannel).
+ *
+ * Publishing a pose is a small copy into shared memory that never blocks: readers that cannot keep up simply miss poses
+ * (or, if they fall more than SharedPoseChannel::SLOT_COUNT poses behind, find that the poses they wanted have been
+ * overwritten). Other processes can read from the channel using SharedPoseReader.
+ */
+class SharedPosePublisher
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef boost::chrono::steady_clock Clock;
+
+  //#################### NESTED TYPES ####################
+private:
+  /** The shared-memory segment (this is opaque here, to keep boost/interprocess out of the header). */
+  struct Segment;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The channel header (in shared memory). */
+  SharedPoseChannel::Header *m_header;
+
+  /** The name of the channel. */
+  std::string m_name;
+
+  /** The shared-memory segment. */
+  boost::shared_ptr<Segment> m_segment;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a shared pose publisher, creating the named shared-memory channel (and replacing any existing channel with the same name).
+   *
+   * \param name                The name of the channel.
+   * \param imageSize           The size of the image to publish alongside the poses (or (0,0), if no image is to be published).
+   * \throws std::runtime_error If the channel could not be created.
+   */
+  explicit SharedPosePublisher(const std::string& name, const Vector2i& imageSize = Vector2i(0,0));
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the publisher, removing the channel.
+   *
+   * Readers that already have the channel open can continue to read the poses that were published before it was removed.
+   */
+  ~SharedPosePublisher();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  SharedPosePublisher(const SharedPosePublisher&);
+  SharedPosePublisher& operator=(const SharedPosePublisher&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the name of the channel.
+   *
+   * \return  The name of the channel.
+   */
+  const std::string& get_name() const;
+
+  /**
+   * \brief Gets the number of poses that have been published so far.
+   *
+   * \return  The number of poses that have been published so far.
+   */
+  size_t get_published_pose_count() const;
+
+  /**
+   * \brief Gets whether or not the channel has an image.
+   *
+   * \return  true, if the channel has an image, or false otherwise.
+   */
+  bool has_image() const;
+
+  /**
+   * \brief Publishes a raycast image to the channel.
+   *
+   * \param image                   The image (on the CPU). Its size must match the image size with which the publisher was constructed.
+   * \param captureTime             The time at which the frame from which the image was rendered was captured.
+   * \throws std::invalid_argument  If the size of the image does not match the image size of the channel.
+   */
+  void publish_image(const ORUtils::Image<Vector4f> *image, const Clock::time_point& captureTime);
+
+  /**
+   * \brief Publishes a camera pose to the channel.
+   *
+   * \param pose            The world-to-camera transformation for the frame.
+   * \param captureTime     The time at which the frame was captured.
+   * \param frameIndex      The index of the frame.
+   * \param trackingQuality The quality of the tracking for the frame (0 = failed, 1 = poor, 2 = good).
+   */
+  void publish_pose(const ORUtils::SE3Pose& pose, const Clock::time_point& captureTime, size_t frameIndex, int trackingQuality);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<SharedPosePublisher> SharedPosePublisher_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+/**
+ * itmx: SharedPoseReader.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_ITMX_SHAREDPOSEREADER
+#define H_ITMX_SHAREDPOSEREADER
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include "SharedPoseChannel.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to read the camera poses (and the image, if any) that another process
+ *        is publishing via a named shared-memory channel (see SharedPosePublisher).
+ *
+ * This class is header-only and depends only on boost, so that it can be used by external consumers without linking
+ * against the rest of the codebase. Reading never blocks the publisher: if a read overlaps a write, it is retried,
+ * and gives up (returning false) if it keeps being overtaken.
+ */
+class SharedPoseReader
+{
+  //#################### CONSTANTS ####################
+private:
+  /** The maximum number of times to retry a read that overlaps a write. */
+  static const int MAX_ATTEMPTS = 16;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The channel header (in shared memory). */
+  const SharedPoseChannel::Header *m_header;
+
+  /** The shared-memory segment. */
+  boost::interprocess::shared_memory_object m_memory;
+
+  /** The mapping of the shared-memory segment into this process. */
+  boost::interprocess::mapped_region m_region;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a shared pose reader, opening the named shared-memory channel.
+   *
+   * \param name                The name of the channel.
+   * \throws std::runtime_error If the channel does not exist, or is not a valid channel of the current version.
+   */
+  explicit SharedPoseReader(const std::string& name)
+  {
+    namespace bip = boost::interprocess;
+
+    try
+    {
+      bip::shared_memory_object(bip::open_only, name.c_str(), bip::read_only).swap(m_memory);
+      bip::mapped_region(m_memory, bip::read_only).swap(m_region);
+    }
+    catch(bip::interprocess_exception& e)
+    {
+      throw std::runtime_error("Error: Could not open shared pose channel '" + name + "': " + e.what());
+    }
+
+    if(m_region.get_size() < SharedPoseChannel::image_offset())
+    {
+      throw std::runtime_error("Error: Shared memory segment '" + name + "' is too small to be a shared pose channel");
+    }
+
+    m_header = static_cast<const SharedPoseChannel::Header*>(m_region.get_address());
+    if(m_header->magic.load(boost::memory_order_acquire) != SharedPoseChannel::MAGIC || m_header->version != SharedPoseChannel::VERSION)
+    {
+      throw std::runtime_error("Error: Shared memory segment '" + name + "' is not a valid shared pose channel of the current version");
+    }
+
+    if(m_region.get_size() < SharedPoseChannel::size(m_header->imageWidth, m_header->imageHeight))
+    {
+      throw std::runtime_error("Error: Shared pose channel '" + name + "' is too small to contain its image");
+    }
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  SharedPoseReader(const SharedPoseReader&);
+  SharedPoseReader& operator=(const SharedPoseReader&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the height of the channel's image.
+   *
+   * \return  The height of the channel's image (0 if the channel has no image).
+   */
+  int get_image_height() const
+  {
+    return m_header->imageHeight;
+  }
+
+  /**
+   * \brief Gets the width of the channel's image.
+   *
+   * \return  The width of the channel's image (0 if the channel has no image).
+   */
+  int get_image_width() const
+  {
+    return m_header->imageWidth;
+  }
+
+  /**
+   * \brief Gets the number of poses that have been published to the channel so far.
+   *
+   * \return  The number of poses that have been published to the channel so far.
+   */
+  boost::uint64_t get_record_count() const
+  {
+    return m_header->recordCount.load(boost::memory_order_acquire);
+  }
+
+  /**
+   * \brief Attempts to read the channel's image.
+   *
+   * \param image       A vector into which to read the image (4 floats per pixel, row by row).
+   * \param captureTime A variable into which to read the time at which the frame from which the image was rendered was captured.
+   * \return            true, if an image was successfully read, or false if the channel has no image, no image has yet been
+   *                    published, or every attempt to read it overlapped a write.
+   */
+  bool try_get_image(std::vector<float>& image, boost::int64_t& captureTime) const
+  {
+    const size_t floatCount = static_cast<size_t>(m_header->imageWidth) * m_header->imageHeight * 4;
+    if(floatCount == 0) return false;
+
+    image.resize(floatCount);
+    const char *data = static_cast<const char*>(m_region.get_address()) + SharedPoseChannel::image_offset();
+
+    for(int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt)
+    {
+      const boost::uint64_t before = m_header->imageSequence.load(boost::memory_order_acquire);
+      if(before == 0) return false;
+      if(before % 2 != 0) continue;
+
+      memcpy(&image[0], data, floatCount * sizeof(float));
+      captureTime = m_header->imageCaptureTime;
+
+      boost::atomic_thread_fence(boost::memory_order_acquire);
+      if(m_header->imageSequence.load(boost::memory_order_relaxed) == before) return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * \brief Attempts to read the most recently published pose.
+   *
+   * \param record  A variable into which to read the pose record.
+   * \return        true, if a pose was successfully read, or false if no pose has yet been published or every attempt to read one overlapped a write.
+   */
+  bool try_get_latest_pose(SharedPoseChannel::PoseRecord& record) const
+  {
+    for(int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt)
+    {
+      const boost::uint64_t recordCount = get_record_count();
+      if(recordCount == 0) return false;
+      if(try_get_pose(recordCount - 1, record)) return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * \brief Attempts to read the pose with the specified record index (i.e. the recordIndex'th pose published to the channel).
+   *
+   * \param recordIndex The record index of the pose.
+   * \param record      A variable into which to read the pose record.
+   * \return            true, if the pose was successfully read, or false if it has not yet been published, has already been
+   *                    overwritten, or was being written at the time.
+   */
+  bool try_get_pose(boost::uint64_t recordIndex, SharedPoseChannel::PoseRecord& record) const
+  {
+    const SharedPoseChannel::PoseSlot *slots = reinterpret_cast<const SharedPoseChannel::PoseSlot*>(
+      static_cast<const char*>(m_region.get_address()) + sizeof(SharedPoseChannel::Header)
+    );
+    const SharedPoseChannel::PoseSlot& slot = slots[recordIndex % SharedPoseChannel::SLOT_COUNT];
+
+    // The slot only holds the requested record if its sequence number is 2 * (recordIndex + 1) both before and after the copy.
+    const boost::uint64_t expected = 2 * (recordIndex + 1);
+    if(slot.sequence.load(boost::memory_order_acquire) != expected) return false;
+
+    memcpy(&record, &slot.record, sizeof(SharedPoseChannel::PoseRecord));
+
+    boost::atomic_thread_fence(boost::memory_order_acquire);
+    return slot.sequence.load(boost::memory_order_relaxed) == expected;
+  }
+};
+
+}
+
+#endif
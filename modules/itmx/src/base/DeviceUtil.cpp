@@ -0,0 +1,24 @@
+/**
+ * itmx: DeviceUtil.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "base/DeviceUtil.h"
+using namespace ITMLib;
+
+#ifdef WITH_CUDA
+#include <ORUtils/CUDADefines.h>
+#endif
+
+namespace itmx {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+void DeviceUtil::synchronise(ITMLibSettings::DeviceType deviceType)
+{
+#ifdef WITH_CUDA
+  if(deviceType == ITMLibSettings::DEVICE_CUDA) ORcudaSafeCall(cudaDeviceSynchronize());
+#endif
+}
+
+}
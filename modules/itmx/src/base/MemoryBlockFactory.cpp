@@ -6,25 +6,342 @@
 #include "base/MemoryBlockFactory.h"
 using namespace ITMLib;
 
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/thread.hpp>
+
+namespace {
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Formats the specified number of bytes as a number of megabytes.
+ *
+ * \param bytes The number of bytes.
+ * \return      A string containing the corresponding number of megabytes.
+ */
+std::string format_megabytes(size_t bytes)
+{
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << " MB";
+  return oss.str();
+}
+
+/**
+ * \brief Determines whether one memory usage group should be listed before another (i.e. whether it occupies more GPU, and then CPU, memory).
+ *
+ * \param lhs The first memory usage group.
+ * \param rhs The second memory usage group.
+ * \return    true, if the first group should be listed before the second, or false otherwise.
+ */
+bool larger_usage(const itmx::MemoryBlockFactory::MemoryUsage& lhs, const itmx::MemoryBlockFactory::MemoryUsage& rhs)
+{
+  if(lhs.gpuBytes != rhs.gpuBytes) return lhs.gpuBytes > rhs.gpuBytes;
+  if(lhs.cpuBytes != rhs.cpuBytes) return lhs.cpuBytes > rhs.cpuBytes;
+  return lhs.tag < rhs.tag;
+}
+
+}
+
 namespace itmx {
 
+//#################### NESTED TYPES ####################
+
+/**
+ * \brief An instance of this struct keeps track of the live memory blocks that have been made by the factory.
+ */
+struct MemoryBlockFactory::Registry
+{
+  /**
+   * \brief An instance of this struct records the details of a live memory block.
+   */
+  struct BlockRecord
+  {
+    /** A pointer to the memory block's dataSize field. */
+    const size_t *dataSize;
+
+    /** The size (in bytes) of each element of the memory block. */
+    size_t elementSize;
+
+    /** Whether or not the memory block is allocated on the GPU (as well as the CPU). */
+    bool onGPU;
+
+    /** The tag with which the memory block was made. */
+    std::string tag;
+  };
+
+  /** The live memory blocks. */
+  std::map<const void*,BlockRecord> blocks;
+
+  /** The number of memory blocks that have been allocated on the GPU. */
+  size_t deviceAllocationCount;
+
+  /** The number of memory blocks that have been freed on the GPU. */
+  size_t deviceFreeCount;
+
+  /** The budget (in bytes) for the amount of GPU memory that the live memory blocks may occupy (0 if there is no budget). */
+  size_t deviceMemoryBudget;
+
+  /** The mutex used to protect the registry. */
+  boost::mutex mutex;
+
+  /** The pooled storage blocks that are not currently leased, grouped by pool key. */
+  std::map<PoolKey,std::vector<boost::shared_ptr<void> > > pool;
+
+  Registry()
+  : deviceAllocationCount(0), deviceFreeCount(0), deviceMemoryBudget(0)
+  {}
+
+  /**
+   * \brief Computes the memory occupied by the live memory blocks, grouped by tag.
+   *
+   * \note  The caller must hold the mutex. The sizes of the blocks are read without synchronising with the threads
+   *        that own them, so the result may be slightly out of date if a block is being resized concurrently.
+   *
+   * \return  The memory occupied by the live memory blocks, grouped by tag (in descending order of memory usage).
+   */
+  std::vector<MemoryUsage> compute_usage() const
+  {
+    std::map<std::string,MemoryUsage> usageByTag;
+    for(std::map<const void*,BlockRecord>::const_iterator it = blocks.begin(), iend = blocks.end(); it != iend; ++it)
+    {
+      const BlockRecord& record = it->second;
+      const std::string tag = record.tag != "" ? record.tag : "(untagged)";
+
+      std::map<std::string,MemoryUsage>::iterator jt = usageByTag.find(tag);
+      if(jt == usageByTag.end())
+      {
+        MemoryUsage usage;
+        usage.blockCount = 0;
+        usage.cpuBytes = usage.gpuBytes = 0;
+        usage.tag = tag;
+        jt = usageByTag.insert(std::make_pair(tag, usage)).first;
+      }
+
+      const size_t bytes = *record.dataSize * record.elementSize;
+      ++jt->second.blockCount;
+      jt->second.cpuBytes += bytes;
+      if(record.onGPU) jt->second.gpuBytes += bytes;
+    }
+
+    std::vector<MemoryUsage> result;
+    result.reserve(usageByTag.size());
+    for(std::map<std::string,MemoryUsage>::const_iterator it = usageByTag.begin(), iend = usageByTag.end(); it != iend; ++it)
+    {
+      result.push_back(it->second);
+    }
+
+    std::sort(result.begin(), result.end(), larger_usage);
+    return result;
+  }
+
+  /**
+   * \brief Sets the tag of the specified memory block (if it is live).
+   *
+   * \note  The caller must hold the mutex.
+   *
+   * \param block The memory block.
+   * \param tag   The new tag for the memory block.
+   */
+  void retag(const void *block, const std::string& tag)
+  {
+    std::map<const void*,BlockRecord>::iterator it = blocks.find(block);
+    if(it != blocks.end()) it->second.tag = tag;
+  }
+};
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of storage blocks to keep in each pool when they are not leased. */
+static const size_t MAX_POOLED_BLOCKS_PER_KEY = 4;
+
+/** The tag given to pooled storage blocks that are not currently leased. */
+static const std::string POOL_TAG = "MemoryBlockFactory.Pool";
+
 //#################### SINGLETON IMPLEMENTATION ####################
 
 MemoryBlockFactory::MemoryBlockFactory()
-: m_deviceType(ITMLibSettings::DEVICE_CUDA)
+: m_deviceType(ITMLibSettings::DEVICE_CUDA), m_registry(new Registry)
 {}
 
 MemoryBlockFactory& MemoryBlockFactory::instance()
 {
-  static MemoryBlockFactory s_instance;
-  return s_instance;
+  // Note: The instance is deliberately never destroyed, since memory blocks (e.g. ones in static variables, or the pooled
+  //       storage blocks owned by the factory itself) may need to unregister themselves from it during static destruction.
+  static MemoryBlockFactory *s_instance = new MemoryBlockFactory;
+  return *s_instance;
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+void MemoryBlockFactory::clear_pool()
+{
+  // Note: The storage blocks must be destroyed without holding the mutex, since they unregister themselves when they are destroyed.
+  std::map<PoolKey,std::vector<boost::shared_ptr<void> > > pool;
+  {
+    boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+    pool.swap(m_registry->pool);
+  }
+}
+
+size_t MemoryBlockFactory::get_device_allocation_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  return m_registry->deviceAllocationCount;
+}
+
+size_t MemoryBlockFactory::get_device_free_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  return m_registry->deviceFreeCount;
+}
+
+size_t MemoryBlockFactory::get_device_memory_budget() const
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  return m_registry->deviceMemoryBudget;
+}
+
+std::vector<MemoryBlockFactory::MemoryUsage> MemoryBlockFactory::get_memory_usage() const
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  return m_registry->compute_usage();
+}
+
+MemoryBlockFactory::MemoryUsage MemoryBlockFactory::get_total_memory_usage() const
+{
+  const std::vector<MemoryUsage> usages = get_memory_usage();
+
+  MemoryUsage total;
+  total.blockCount = 0;
+  total.cpuBytes = total.gpuBytes = 0;
+  total.tag = "Total";
+
+  for(size_t i = 0, size = usages.size(); i < size; ++i)
+  {
+    total.blockCount += usages[i].blockCount;
+    total.cpuBytes += usages[i].cpuBytes;
+    total.gpuBytes += usages[i].gpuBytes;
+  }
+
+  return total;
+}
+
+void MemoryBlockFactory::set_device_memory_budget(size_t budget)
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  m_registry->deviceMemoryBudget = budget;
+}
+
 void MemoryBlockFactory::set_device_type(ITMLibSettings::DeviceType deviceType)
 {
   m_deviceType = deviceType;
 }
 
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MemoryBlockFactory::check_device_memory_budget(size_t gpuBytes, const std::string& tag) const
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+
+  const size_t budget = m_registry->deviceMemoryBudget;
+  if(budget == 0) return;
+
+  const std::vector<MemoryUsage> usages = m_registry->compute_usage();
+  size_t gpuBytesInUse = 0;
+  for(size_t i = 0, size = usages.size(); i < size; ++i) gpuBytesInUse += usages[i].gpuBytes;
+
+  if(gpuBytesInUse + gpuBytes > budget)
+  {
+    // List the largest consumers of GPU memory, to make it easier to see where the budget has gone.
+    std::ostringstream oss;
+    oss << "Error: Allocating " << format_megabytes(gpuBytes) << " of GPU memory for '" << (tag != "" ? tag : "(untagged)")
+        << "' would exceed the device memory budget of " << format_megabytes(budget) << " ("
+        << format_megabytes(gpuBytesInUse) << " already in use";
+
+    const size_t maxConsumerCount = 3;
+    for(size_t i = 0, size = std::min(usages.size(), maxConsumerCount); i < size && usages[i].gpuBytes > 0; ++i)
+    {
+      oss << (i == 0 ? "; largest consumers: " : ", ") << usages[i].tag << ' ' << format_megabytes(usages[i].gpuBytes);
+    }
+
+    oss << ')';
+    throw std::runtime_error(oss.str());
+  }
+}
+
+MemoryBlockFactory::PoolKey MemoryBlockFactory::make_pool_key(size_t dataSize, bool onGPU, const std::string& typeName)
+{
+  // Round the capacity up to the next power of two, so that requests of similar sizes can share storage.
+  PoolKey key;
+  key.capacity = 1;
+  while(key.capacity < dataSize) key.capacity <<= 1;
+  key.onGPU = onGPU;
+  key.typeName = typeName;
+  return key;
+}
+
+void MemoryBlockFactory::register_block(const void *block, const size_t *dataSize, size_t elementSize, bool onGPU, const std::string& tag) const
+{
+  Registry::BlockRecord record;
+  record.dataSize = dataSize;
+  record.elementSize = elementSize;
+  record.onGPU = onGPU;
+  record.tag = tag;
+
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  m_registry->blocks[block] = record;
+  if(onGPU) ++m_registry->deviceAllocationCount;
+}
+
+void MemoryBlockFactory::return_to_pool(const PoolKey& key, const boost::shared_ptr<void>& storage, bool reusable) const
+{
+  if(!reusable) return;
+
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  std::vector<boost::shared_ptr<void> >& blocks = m_registry->pool[key];
+  if(blocks.size() < MAX_POOLED_BLOCKS_PER_KEY)
+  {
+    blocks.push_back(storage);
+    m_registry->retag(storage.get(), POOL_TAG);
+  }
+
+  // Note: If the storage was not pooled, it will be released (without holding the mutex) when the lease's deleter is destroyed.
+}
+
+boost::shared_ptr<void> MemoryBlockFactory::take_from_pool(const PoolKey& key, const std::string& tag) const
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+
+  std::map<PoolKey,std::vector<boost::shared_ptr<void> > >::iterator it = m_registry->pool.find(key);
+  if(it == m_registry->pool.end() || it->second.empty()) return boost::shared_ptr<void>();
+
+  boost::shared_ptr<void> storage = it->second.back();
+  it->second.pop_back();
+  m_registry->retag(storage.get(), tag);
+  return storage;
+}
+
+void MemoryBlockFactory::unregister_block(const void *block) const
+{
+  boost::lock_guard<boost::mutex> lock(m_registry->mutex);
+  std::map<const void*,Registry::BlockRecord>::iterator it = m_registry->blocks.find(block);
+  if(it == m_registry->blocks.end()) return;
+  if(it->second.onGPU) ++m_registry->deviceFreeCount;
+  m_registry->blocks.erase(it);
+}
+
+//#################### STREAM OPERATORS ####################
+
+std::ostream& operator<<(std::ostream& os, const MemoryBlockFactory::MemoryUsage& usage)
+{
+  os << usage.tag << ": " << usage.blockCount << (usage.blockCount == 1 ? " block, " : " blocks, ")
+     << format_megabytes(usage.cpuBytes) << " CPU, " << format_megabytes(usage.gpuBytes) << " GPU";
+  return os;
+}
+
 }
@@ -0,0 +1,74 @@
+/**
+ * itmx: DualQuaternionBatchUtil_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "geometry/cuda/DualQuaternionBatchUtil_CUDA.h"
+
+namespace itmx {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_resample_trajectory(const float *sampleTimes, DualQuaternionColumns<float> samples, int sampleCount,
+                                       const float *queryTimes, int queryCount, DualQuaternionColumns<float> result)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < queryCount)
+  {
+    store_element(resample_trajectory(sampleTimes, samples, sampleCount, queryTimes[tid]), tid, result);
+  }
+}
+
+__global__ void ck_sclerp(DualQuaternionColumns<float> lhs, DualQuaternionColumns<float> rhs, const float *ts, int count, DualQuaternionColumns<float> result)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < count)
+  {
+    store_element(sclerp_elements(load_element(tid, lhs), load_element(tid, rhs), ts[tid]), tid, result);
+  }
+}
+
+__global__ void ck_smooth_trajectory(DualQuaternionColumns<float> samples, int sampleCount, int radius, DualQuaternionColumns<float> result)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < sampleCount)
+  {
+    store_element(smooth_trajectory_sample(tid, samples, sampleCount, radius), tid, result);
+  }
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+void DualQuaternionBatchUtil_CUDA::resample(const float *sampleTimes, const DualQuaternionColumns<float>& samples, int sampleCount,
+                                            const float *queryTimes, int queryCount, const DualQuaternionColumns<float>& result)
+{
+  if(sampleCount == 0 || queryCount == 0) return;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (queryCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_resample_trajectory<<<numBlocks,threadsPerBlock>>>(sampleTimes, samples, sampleCount, queryTimes, queryCount, result);
+}
+
+void DualQuaternionBatchUtil_CUDA::sclerp(const DualQuaternionColumns<float>& lhs, const DualQuaternionColumns<float>& rhs, const float *ts, int count,
+                                          const DualQuaternionColumns<float>& result)
+{
+  if(count == 0) return;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (count + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_sclerp<<<numBlocks,threadsPerBlock>>>(lhs, rhs, ts, count, result);
+}
+
+void DualQuaternionBatchUtil_CUDA::smooth(const DualQuaternionColumns<float>& samples, int sampleCount, int radius, const DualQuaternionColumns<float>& result)
+{
+  if(sampleCount == 0) return;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (sampleCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_smooth_trajectory<<<numBlocks,threadsPerBlock>>>(samples, sampleCount, radius, result);
+}
+
+}
@@ -0,0 +1,57 @@
+/**
+ * itmx: ArchiveRecordingSink.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/ArchiveRecordingSink.h"
+
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+ArchiveRecordingSink::ArchiveRecordingSink(const boost::filesystem::path& path, size_t maxQueueSize)
+: RecordingSink(maxQueueSize), m_frameIndex(0), m_fs(path.string().c_str(), std::ios_base::binary)
+{
+  if(!m_fs) throw std::runtime_error("Error: Could not open archive file " + path.string());
+  m_fs.write("SPTARCH1", 8);
+}
+
+//#################### DESTRUCTOR ####################
+
+ArchiveRecordingSink::~ArchiveRecordingSink()
+{
+  stop_worker();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ArchiveRecordingSink::write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose)
+{
+  if(depthImage) write_chunk("DPTH", *depthImage);
+  if(rgbImage) write_chunk("RGBA", *rgbImage);
+  if(!m_fs) throw std::runtime_error("Error: Could not write frame " + boost::lexical_cast<std::string>(m_frameIndex) + " to the archive file");
+  ++m_frameIndex;
+}
+
+template <typename T>
+void ArchiveRecordingSink::write_chunk(const char *tag, const ORUtils::Image<T>& image)
+{
+  m_fs.write(tag, 4);
+  write_int(m_frameIndex);
+  write_int(image.noDims.x);
+  write_int(image.noDims.y);
+  m_fs.write(reinterpret_cast<const char*>(image.GetData(MEMORYDEVICE_CPU)), image.dataSize * sizeof(T));
+}
+
+void ArchiveRecordingSink::write_int(int value)
+{
+  const unsigned int v = static_cast<unsigned int>(value);
+  const char bytes[4] = { static_cast<char>(v & 0xFF), static_cast<char>((v >> 8) & 0xFF), static_cast<char>((v >> 16) & 0xFF), static_cast<char>((v >> 24) & 0xFF) };
+  m_fs.write(bytes, 4);
+}
+
+}
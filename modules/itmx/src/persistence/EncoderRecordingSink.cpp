@@ -0,0 +1,66 @@
+/**
+ * itmx: EncoderRecordingSink.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/EncoderRecordingSink.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+  #define popen _popen
+  #define pclose _pclose
+#endif
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+EncoderRecordingSink::EncoderRecordingSink(const boost::filesystem::path& path, const std::string& codec, int frameRate, size_t maxQueueSize)
+: RecordingSink(maxQueueSize), m_codec(codec), m_frameRate(frameRate), m_frameSize(0, 0), m_path(path), m_pipe(NULL)
+{}
+
+//#################### DESTRUCTOR ####################
+
+EncoderRecordingSink::~EncoderRecordingSink()
+{
+  stop_worker();
+
+  // Closing the pipe signals the end of the stream to the encoder, and waits for it to finish writing the video.
+  if(m_pipe) pclose(m_pipe);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void EncoderRecordingSink::start_encoder(const Vector2i& frameSize)
+{
+  std::ostringstream oss;
+  oss << "ffmpeg -loglevel error -y -f rawvideo -pix_fmt rgba -s " << frameSize.x << 'x' << frameSize.y << " -r " << m_frameRate
+      << " -i - -c:v " << m_codec << " -pix_fmt yuv420p \"" << m_path.string() << '"';
+
+#ifdef _WIN32
+  m_pipe = popen(oss.str().c_str(), "wb");
+#else
+  m_pipe = popen(oss.str().c_str(), "w");
+#endif
+
+  if(!m_pipe) throw std::runtime_error("Error: Could not start the video encoder (is ffmpeg on the path?)");
+  m_frameSize = frameSize;
+}
+
+void EncoderRecordingSink::write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose)
+{
+  if(!rgbImage) return;
+
+  if(!m_pipe) start_encoder(rgbImage->noDims);
+  else if(rgbImage->noDims != m_frameSize) throw std::runtime_error("Error: Cannot change the size of a video whilst it is being encoded");
+
+  const size_t pixelCount = rgbImage->dataSize;
+  if(fwrite(rgbImage->GetData(MEMORYDEVICE_CPU), sizeof(Vector4u), pixelCount, m_pipe) != pixelCount)
+  {
+    throw std::runtime_error("Error: Could not write a frame to the video encoder");
+  }
+}
+
+}
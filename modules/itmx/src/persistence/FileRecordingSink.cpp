@@ -0,0 +1,34 @@
+/**
+ * itmx: FileRecordingSink.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/FileRecordingSink.h"
+using namespace tvgutil;
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+FileRecordingSink::FileRecordingSink(const boost::filesystem::path& baseDir, const std::string& rgbPattern, const std::string& depthPattern, size_t maxQueueSize,
+                                     ImagePersister::PNGCompressionLevel pngCompressionLevel)
+: RecordingSink(maxQueueSize), m_depthPattern(depthPattern), m_pathGenerator(baseDir), m_pngCompressionLevel(pngCompressionLevel), m_rgbPattern(rgbPattern)
+{}
+
+//#################### DESTRUCTOR ####################
+
+FileRecordingSink::~FileRecordingSink()
+{
+  stop_worker();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void FileRecordingSink::write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose)
+{
+  if(depthImage) ImagePersister::save_image(depthImage, m_pathGenerator.make_path(m_depthPattern).string(), ImagePersister::IFT_UNKNOWN, m_pngCompressionLevel);
+  if(rgbImage) ImagePersister::save_image(rgbImage, m_pathGenerator.make_path(m_rgbPattern).string(), ImagePersister::IFT_UNKNOWN, m_pngCompressionLevel);
+  m_pathGenerator.increment_index();
+}
+
+}
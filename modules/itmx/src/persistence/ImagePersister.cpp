@@ -5,9 +5,12 @@
 
 #include "persistence/ImagePersister.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/static_assert.hpp>
 
 #include <lodepng.h>
 
@@ -15,6 +18,51 @@
 
 namespace itmx {
 
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Configures a PNG encoder to use the specified level of compression.
+ *
+ * \param compressionLevel  The level of compression to use.
+ * \param scanlineCount     The number of scanlines in the image to be encoded.
+ * \param state             The encoder state to configure.
+ * \param filters           A buffer into which to write the filter types to use for the scanlines (if needed).
+ */
+static void configure_png_encoder(ImagePersister::PNGCompressionLevel compressionLevel, unsigned int scanlineCount, lodepng::State& state,
+                                  std::vector<unsigned char>& filters)
+{
+  switch(compressionLevel)
+  {
+    case ImagePersister::PCL_NONE:
+    {
+      // Write stored (uncompressed) deflate blocks and don't filter the scanlines, since filtering only helps compression.
+      state.encoder.zlibsettings.btype = 0;
+      state.encoder.filter_palette_zero = 0;
+      state.encoder.filter_strategy = LFS_ZERO;
+      break;
+    }
+    case ImagePersister::PCL_FAST:
+    {
+      // Use a small LZ77 window without lazy matching, and apply the Paeth filter to every scanline rather than trying each
+      // of the filters on each scanline to see which compresses best (which dominates the cost of the filtering stage).
+      state.encoder.zlibsettings.windowsize = 512;
+      state.encoder.zlibsettings.nicematch = 32;
+      state.encoder.zlibsettings.lazymatching = 0;
+      state.encoder.filter_palette_zero = 0;
+      state.encoder.filter_strategy = LFS_PREDEFINED;
+      filters.assign(scanlineCount, 4);
+      state.encoder.predefined_filters = &filters[0];
+      break;
+    }
+    case ImagePersister::PCL_DEFAULT:
+    default:
+    {
+      // Use LodePNG's default settings.
+      break;
+    }
+  }
+}
+
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
 ITMUChar4Image_Ptr ImagePersister::load_rgba_image(const std::string& path, ImageFileType fileType)
@@ -39,7 +87,29 @@ ITMUChar4Image_Ptr ImagePersister::load_rgba_image(const std::string& path, Imag
   }
 }
 
-void ImagePersister::save_image(const ITMShortImage_CPtr& image, const std::string& path, ImageFileType fileType)
+ITMShortImage_Ptr ImagePersister::load_short_image(const std::string& path, ImageFileType fileType)
+{
+  // If the image file type wasn't specified, try to deduce it.
+  if(fileType == IFT_UNKNOWN) fileType = deduce_image_file_type(path);
+
+  // Load the image in an appropriate way based on its file type.
+  switch(fileType)
+  {
+    case IFT_PNG:
+    {
+      std::vector<unsigned char> buffer;
+      lodepng::load_file(buffer, path);
+      if(buffer.empty()) throw std::runtime_error("Could not load PNG image from '" + path + "'");
+      return decode_short_png(buffer, path);
+    }
+    default:
+    {
+      throw std::runtime_error("Could not load image from '" + path + "': unsupported file type");
+    }
+  }
+}
+
+void ImagePersister::save_image(const ITMShortImage_CPtr& image, const std::string& path, ImageFileType fileType, PNGCompressionLevel compressionLevel)
 {
   // If the image file type wasn't specified, try to deduce it.
   if(fileType == IFT_UNKNOWN) fileType = deduce_image_file_type(path);
@@ -52,6 +122,13 @@ void ImagePersister::save_image(const ITMShortImage_CPtr& image, const std::stri
       SaveImageToFile(image.get(), path.c_str());
       break;
     }
+    case IFT_PNG:
+    {
+      std::vector<unsigned char> buffer;
+      encode_png(image, compressionLevel, buffer);
+      lodepng::save_file(buffer, path);
+      break;
+    }
     default:
     {
       throw std::runtime_error("Could not save image to '" + path + "': unsupported file type");
@@ -59,7 +136,7 @@ void ImagePersister::save_image(const ITMShortImage_CPtr& image, const std::stri
   }
 }
 
-void ImagePersister::save_image(const ITMUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType)
+void ImagePersister::save_image(const ITMUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType, PNGCompressionLevel compressionLevel)
 {
   // If the image file type wasn't specified, try to deduce it.
   if(fileType == IFT_UNKNOWN) fileType = deduce_image_file_type(path);
@@ -70,7 +147,7 @@ void ImagePersister::save_image(const ITMUChar4Image_CPtr& image, const std::str
     case IFT_PNG:
     {
       std::vector<unsigned char> buffer;
-      encode_png(image, buffer);
+      encode_png(image, compressionLevel, buffer);
       lodepng::save_file(buffer, path);
       break;
     }
@@ -90,33 +167,52 @@ void ImagePersister::save_image(const ITMUChar4Image_CPtr& image, const std::str
 
 ITMUChar4Image_Ptr ImagePersister::decode_rgba_png(const std::vector<unsigned char>& buffer, const std::string& path)
 {
-  // Decode the PNG.
-  std::vector<unsigned char> data;
+  // Note: The pixels of an RGBA image are laid out in memory in the same way as the 8-bit RGBA pixels produced by LodePNG.
+  BOOST_STATIC_ASSERT(sizeof(Vector4u) == 4);
+
+  // Decode the PNG. We use LodePNG's C interface here, since its C++ interface copies the decoded pixels into a vector.
+  unsigned char *data = NULL;
   unsigned int width, height;
-  if(lodepng::decode(data, width, height, buffer) != 0)
+  if(buffer.empty() || lodepng_decode32(&data, &width, &height, &buffer[0], buffer.size()) != 0)
   {
+    free(data);
     throw std::runtime_error("Failed to decode PNG from '" + path + "'");
   }
 
-  // Construct the image.
+  // Construct the image, and copy the decoded pixels into it.
   ITMUChar4Image_Ptr image(new ITMUChar4Image(Vector2i(width, height), true, true));
-  const int pixelCount = width * height;
-  const unsigned char *src = &data[0];
-  Vector4u *dest = image->GetData(MEMORYDEVICE_CPU);
+  memcpy(image->GetData(MEMORYDEVICE_CPU), data, width * height * sizeof(Vector4u));
+  free(data);
+
+  return image;
+}
+
+ITMShortImage_Ptr ImagePersister::decode_short_png(const std::vector<unsigned char>& buffer, const std::string& path)
+{
+  // Decode the PNG.
+  unsigned char *data = NULL;
+  unsigned int width, height;
+  if(buffer.empty() || lodepng_decode_memory(&data, &width, &height, &buffer[0], buffer.size(), LCT_GREY, 16) != 0)
+  {
+    free(data);
+    throw std::runtime_error("Failed to decode PNG from '" + path + "'");
+  }
+
+  // Construct the image, and write the decoded pixels into it (PNG stores 16-bit values in big-endian order).
+  ITMShortImage_Ptr image(new ITMShortImage(Vector2i(width, height), true, true));
+  const int pixelCount = static_cast<int>(width * height);
+  const unsigned char *src = data;
+  short *dest = image->GetData(MEMORYDEVICE_CPU);
 
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
   for(int i = 0; i < pixelCount; ++i)
   {
-    Vector4u& pixel = dest[i];
-    int offset = i * 4;
-    pixel.r = src[offset];
-    pixel.g = src[offset + 1];
-    pixel.b = src[offset + 2];
-    pixel.a = src[offset + 3];
+    dest[i] = static_cast<short>((src[i * 2] << 8) | src[i * 2 + 1]);
   }
 
+  free(data);
   return image;
 }
 
@@ -134,11 +230,12 @@ ImagePersister::ImageFileType ImagePersister::deduce_image_file_type(const std::
   return IFT_UNKNOWN;
 }
 
-void ImagePersister::encode_png(const ITMUChar4Image_CPtr& image, std::vector<unsigned char>& buffer)
+void ImagePersister::encode_png(const ITMShortImage_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer)
 {
+  // Convert the pixels into big-endian order, as required by PNG.
   const int pixelCount = static_cast<int>(image->dataSize);
-  std::vector<unsigned char> data(pixelCount * 4);
-  const Vector4u *src = image->GetData(MEMORYDEVICE_CPU);
+  std::vector<unsigned char> data(pixelCount * 2);
+  const short *src = image->GetData(MEMORYDEVICE_CPU);
   unsigned char *dest = &data[0];
 
 #ifdef WITH_OPENMP
@@ -146,15 +243,44 @@ void ImagePersister::encode_png(const ITMUChar4Image_CPtr& image, std::vector<un
 #endif
   for(int i = 0; i < pixelCount; ++i)
   {
-    const Vector4u& pixel = src[i];
-    int offset = i * 4;
-    dest[offset] = pixel.r;
-    dest[offset + 1] = pixel.g;
-    dest[offset + 2] = pixel.b;
-    dest[offset + 3] = pixel.a;
+    const unsigned short value = static_cast<unsigned short>(src[i]);
+    dest[i * 2] = static_cast<unsigned char>(value >> 8);
+    dest[i * 2 + 1] = static_cast<unsigned char>(value & 0xFF);
   }
 
-  lodepng::encode(buffer, &data[0], image->noDims.x, image->noDims.y);
+  // Encode the image as a 16-bit greyscale PNG. Note that we prevent LodePNG from choosing a different colour type for the
+  // output, since it would otherwise reduce the bit depth of any image whose values all happened to fit in 8 bits.
+  lodepng::State state;
+  std::vector<unsigned char> filters;
+  configure_png_encoder(compressionLevel, image->noDims.y, state, filters);
+  state.encoder.auto_convert = 0;
+  state.info_raw.colortype = state.info_png.color.colortype = LCT_GREY;
+  state.info_raw.bitdepth = state.info_png.color.bitdepth = 16;
+
+  if(lodepng::encode(buffer, &data[0], image->noDims.x, image->noDims.y, state) != 0)
+  {
+    throw std::runtime_error("Failed to encode a short image as a PNG");
+  }
+}
+
+void ImagePersister::encode_png(const ITMUChar4Image_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer)
+{
+  // Note: The pixels of an RGBA image are laid out in memory in the same way as the 8-bit RGBA pixels expected by LodePNG,
+  //       so we can encode the image data directly rather than first copying it into a separate buffer.
+  BOOST_STATIC_ASSERT(sizeof(Vector4u) == 4);
+  const unsigned char *data = reinterpret_cast<const unsigned char*>(image->GetData(MEMORYDEVICE_CPU));
+
+  lodepng::State state;
+  std::vector<unsigned char> filters;
+  configure_png_encoder(compressionLevel, image->noDims.y, state, filters);
+
+  // If we're trying to encode the image quickly, avoid the cost of scanning it to choose the most compact colour type.
+  if(compressionLevel != PCL_DEFAULT) state.encoder.auto_convert = 0;
+
+  if(lodepng::encode(buffer, data, image->noDims.x, image->noDims.y, state) != 0)
+  {
+    throw std::runtime_error("Failed to encode an RGBA image as a PNG");
+  }
 }
 
 }
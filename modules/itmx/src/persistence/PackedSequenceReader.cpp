@@ -0,0 +1,206 @@
+/**
+ * itmx: PackedSequenceReader.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/PackedSequenceReader.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+PackedSequenceReader::PackedSequenceReader(const boost::filesystem::path& path)
+: m_path(path)
+{
+  try
+  {
+    m_file.open(path.string());
+  }
+  catch(std::exception&)
+  {
+    throw std::runtime_error("Error: Could not open packed sequence file " + path.string());
+  }
+
+  // Check the header and read the calibration text.
+  const size_t sigSize = PackedSequenceUtil::SIGNATURE_SIZE;
+  require(0, sigSize + 4);
+  if(memcmp(at(0), PackedSequenceUtil::HEADER_SIGNATURE, sigSize) != 0)
+  {
+    throw std::runtime_error("Error: " + path.string() + " is not a packed sequence file");
+  }
+
+  const size_t calibSize = PackedSequenceUtil::read_uint32(at(sigSize));
+  require(sigSize + 4, calibSize);
+  m_calibText.assign(reinterpret_cast<const char*>(at(sigSize + 4)), calibSize);
+  const size_t firstFrameOffset = sigSize + 4 + calibSize;
+
+  // If the file has an intact index, use it to find the frame records.
+  const size_t fileSize = m_file.size();
+  bool indexFound = false;
+  if(fileSize >= firstFrameOffset + PackedSequenceUtil::TRAILER_SIZE)
+  {
+    const size_t trailerOffset = fileSize - PackedSequenceUtil::TRAILER_SIZE;
+    if(memcmp(at(trailerOffset + 12), PackedSequenceUtil::TRAILER_SIGNATURE, sigSize) == 0)
+    {
+      const unsigned long long indexOffset = PackedSequenceUtil::read_uint64(at(trailerOffset));
+      const size_t frameCount = PackedSequenceUtil::read_uint32(at(trailerOffset + 8));
+      if(indexOffset >= firstFrameOffset && indexOffset + frameCount * 8ULL == trailerOffset)
+      {
+        m_frameOffsets.resize(frameCount);
+        for(size_t i = 0; i < frameCount; ++i)
+        {
+          m_frameOffsets[i] = static_cast<size_t>(PackedSequenceUtil::read_uint64(at(static_cast<size_t>(indexOffset) + i * 8)));
+        }
+        indexFound = true;
+      }
+    }
+  }
+
+  // Otherwise, recover as many frame records as possible by walking the file (stopping at the first incomplete one).
+  if(!indexFound)
+  {
+    size_t offset = firstFrameOffset;
+    while(offset < fileSize)
+    {
+      try
+      {
+        const size_t endOffset = parse_frame(offset).endOffset;
+        m_frameOffsets.push_back(offset);
+        offset = endOffset;
+      }
+      catch(std::runtime_error&)
+      {
+        break;
+      }
+    }
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+const std::string& PackedSequenceReader::get_calib_text() const
+{
+  return m_calibText;
+}
+
+Vector2i PackedSequenceReader::get_depth_image_size(size_t frameIndex) const
+{
+  const FrameRecord record = parse_indexed_frame(frameIndex);
+  return record.depth ? record.depth->size : Vector2i(0, 0);
+}
+
+size_t PackedSequenceReader::get_frame_count() const
+{
+  return m_frameOffsets.size();
+}
+
+Vector2i PackedSequenceReader::get_rgb_image_size(size_t frameIndex) const
+{
+  const FrameRecord record = parse_indexed_frame(frameIndex);
+  return record.rgb ? record.rgb->size : Vector2i(0, 0);
+}
+
+void PackedSequenceReader::read_images(size_t frameIndex, ORUtils::Image<Vector4u> *rgbImage, ORUtils::Image<short> *depthImage) const
+{
+  const FrameRecord record = parse_indexed_frame(frameIndex);
+
+  if(depthImage && record.depth)
+  {
+    const ImageRecord& depth = *record.depth;
+    if(depthImage->noDims != depth.size) depthImage->ChangeDims(depth.size);
+    PackedSequenceUtil::decode_depth(depth.codec, depth.data, depth.encodedSize, *depthImage);
+  }
+
+  if(rgbImage && record.rgb)
+  {
+    const ImageRecord& rgb = *record.rgb;
+    if(rgbImage->noDims != rgb.size) rgbImage->ChangeDims(rgb.size);
+    PackedSequenceUtil::decode_rgb(rgb.codec, rgb.data, rgb.encodedSize, *rgbImage);
+  }
+}
+
+boost::optional<Matrix4f> PackedSequenceReader::read_pose(size_t frameIndex) const
+{
+  const FrameRecord record = parse_indexed_frame(frameIndex);
+  if(!record.pose) return boost::none;
+
+  Matrix4f pose;
+  for(int i = 0; i < 16; ++i)
+  {
+    const unsigned int bits = PackedSequenceUtil::read_uint32(record.pose + i * 4);
+    memcpy(&pose.m[i], &bits, sizeof(float));
+  }
+  return pose;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+const unsigned char *PackedSequenceReader::at(size_t offset) const
+{
+  return reinterpret_cast<const unsigned char*>(m_file.data()) + offset;
+}
+
+PackedSequenceReader::FrameRecord PackedSequenceReader::parse_frame(size_t offset) const
+{
+  FrameRecord record;
+  record.pose = NULL;
+
+  require(offset, 4);
+  const unsigned int flags = PackedSequenceUtil::read_uint32(at(offset));
+  offset += 4;
+
+  if(flags & PackedSequenceUtil::FF_DEPTH) record.depth = parse_image(offset);
+  if(flags & PackedSequenceUtil::FF_RGB) record.rgb = parse_image(offset);
+  if(flags & PackedSequenceUtil::FF_POSE)
+  {
+    require(offset, 16 * 4);
+    record.pose = at(offset);
+    offset += 16 * 4;
+  }
+
+  record.endOffset = offset;
+  return record;
+}
+
+PackedSequenceReader::ImageRecord PackedSequenceReader::parse_image(size_t& offset) const
+{
+  require(offset, 16);
+
+  ImageRecord record;
+  record.size.x = static_cast<int>(PackedSequenceUtil::read_uint32(at(offset)));
+  record.size.y = static_cast<int>(PackedSequenceUtil::read_uint32(at(offset + 4)));
+  record.codec = static_cast<int>(PackedSequenceUtil::read_uint32(at(offset + 8)));
+  record.encodedSize = PackedSequenceUtil::read_uint32(at(offset + 12));
+  offset += 16;
+
+  require(offset, record.encodedSize);
+  record.data = at(offset);
+  offset += record.encodedSize;
+
+  return record;
+}
+
+PackedSequenceReader::FrameRecord PackedSequenceReader::parse_indexed_frame(size_t frameIndex) const
+{
+  if(frameIndex >= m_frameOffsets.size())
+  {
+    throw std::runtime_error("Error: Invalid frame index " + boost::lexical_cast<std::string>(frameIndex) + " in packed sequence file " + m_path.string());
+  }
+
+  return parse_frame(m_frameOffsets[frameIndex]);
+}
+
+void PackedSequenceReader::require(size_t offset, size_t size) const
+{
+  if(offset > m_file.size() || size > m_file.size() - offset)
+  {
+    throw std::runtime_error("Error: Packed sequence file " + m_path.string() + " is corrupt");
+  }
+}
+
+}
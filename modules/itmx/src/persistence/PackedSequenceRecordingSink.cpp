@@ -0,0 +1,30 @@
+/**
+ * itmx: PackedSequenceRecordingSink.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/PackedSequenceRecordingSink.h"
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+PackedSequenceRecordingSink::PackedSequenceRecordingSink(const boost::filesystem::path& path, const std::string& calibText, size_t maxQueueSize)
+: RecordingSink(maxQueueSize), m_writer(path, calibText)
+{}
+
+//#################### DESTRUCTOR ####################
+
+PackedSequenceRecordingSink::~PackedSequenceRecordingSink()
+{
+  stop_worker();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void PackedSequenceRecordingSink::write_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose)
+{
+  m_writer.write_frame(rgbImage.get(), depthImage.get(), pose);
+}
+
+}
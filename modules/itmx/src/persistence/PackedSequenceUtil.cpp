@@ -0,0 +1,174 @@
+/**
+ * itmx: PackedSequenceUtil.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/PackedSequenceUtil.h"
+
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+namespace bf = boost::filesystem;
+
+namespace itmx {
+
+//#################### PUBLIC STATIC VARIABLES ####################
+
+const char *PackedSequenceUtil::HEADER_SIGNATURE = "SPTSEQ01";
+const size_t PackedSequenceUtil::SIGNATURE_SIZE;
+const char *PackedSequenceUtil::TRAILER_SIGNATURE = "SPTSEQIX";
+const size_t PackedSequenceUtil::TRAILER_SIZE;
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+void PackedSequenceUtil::decode_depth(int codec, const unsigned char *data, size_t size, ORUtils::Image<short>& image)
+{
+  const int width = image.noDims.x, height = image.noDims.y;
+  short *depths = image.GetData(MEMORYDEVICE_CPU);
+
+  switch(codec)
+  {
+    case DC_RAW:
+    {
+      if(size != image.dataSize * sizeof(short)) throw std::runtime_error("Error: Raw depth image has the wrong size");
+      for(size_t i = 0; i < image.dataSize; ++i)
+      {
+        depths[i] = static_cast<short>(data[2 * i] | (data[2 * i + 1] << 8));
+      }
+      break;
+    }
+    case DC_DELTA_VARINT:
+    {
+      const unsigned char *p = data, *end = data + size;
+      for(int y = 0; y < height; ++y)
+      {
+        for(int x = 0; x < width; ++x)
+        {
+          // Read the zigzag-encoded delta.
+          unsigned int zigzag = 0;
+          int shift = 0;
+          for(;;)
+          {
+            if(p == end || shift > 28) throw std::runtime_error("Error: Compressed depth image is corrupt");
+            const unsigned char b = *p++;
+            zigzag |= static_cast<unsigned int>(b & 0x7F) << shift;
+            if((b & 0x80) == 0) break;
+            shift += 7;
+          }
+          const int delta = static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+
+          // Add it to the prediction to recover the depth.
+          const int offset = y * width + x;
+          const int prediction = x > 0 ? depths[offset - 1] : y > 0 ? depths[offset - width] : 0;
+          depths[offset] = static_cast<short>(prediction + delta);
+        }
+      }
+      if(p != end) throw std::runtime_error("Error: Compressed depth image is corrupt");
+      break;
+    }
+    default:
+      throw std::runtime_error("Error: Unknown depth codec");
+  }
+}
+
+void PackedSequenceUtil::decode_rgb(int codec, const unsigned char *data, size_t size, ORUtils::Image<Vector4u>& image)
+{
+  if(codec != RC_RGB) throw std::runtime_error("Error: Unknown RGB codec");
+  if(size != image.dataSize * 3) throw std::runtime_error("Error: RGB image has the wrong size");
+
+  Vector4u *colours = image.GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0; i < image.dataSize; ++i, data += 3)
+  {
+    colours[i] = Vector4u(data[0], data[1], data[2], 255);
+  }
+}
+
+void PackedSequenceUtil::encode_depth(DepthCodec codec, const ORUtils::Image<short>& image, std::vector<unsigned char>& out)
+{
+  const int width = image.noDims.x, height = image.noDims.y;
+  const short *depths = image.GetData(MEMORYDEVICE_CPU);
+
+  switch(codec)
+  {
+    case DC_RAW:
+    {
+      out.reserve(out.size() + image.dataSize * sizeof(short));
+      for(size_t i = 0; i < image.dataSize; ++i)
+      {
+        const unsigned short d = static_cast<unsigned short>(depths[i]);
+        out.push_back(static_cast<unsigned char>(d & 0xFF));
+        out.push_back(static_cast<unsigned char>(d >> 8));
+      }
+      break;
+    }
+    case DC_DELTA_VARINT:
+    {
+      out.reserve(out.size() + image.dataSize + image.dataSize / 4);
+      for(int y = 0; y < height; ++y)
+      {
+        for(int x = 0; x < width; ++x)
+        {
+          const int offset = y * width + x;
+          const int prediction = x > 0 ? depths[offset - 1] : y > 0 ? depths[offset - width] : 0;
+          const int delta = depths[offset] - prediction;
+
+          // Zigzag-encode the delta so that small negative deltas also become small unsigned integers, and write it 7 bits at a time.
+          unsigned int zigzag = (static_cast<unsigned int>(delta) << 1) ^ static_cast<unsigned int>(delta >> 31);
+          while(zigzag >= 0x80)
+          {
+            out.push_back(static_cast<unsigned char>((zigzag & 0x7F) | 0x80));
+            zigzag >>= 7;
+          }
+          out.push_back(static_cast<unsigned char>(zigzag));
+        }
+      }
+      break;
+    }
+    default:
+      throw std::runtime_error("Error: Unknown depth codec");
+  }
+}
+
+void PackedSequenceUtil::encode_rgb(RGBCodec codec, const ORUtils::Image<Vector4u>& image, std::vector<unsigned char>& out)
+{
+  if(codec != RC_RGB) throw std::runtime_error("Error: Unknown RGB codec");
+
+  const Vector4u *colours = image.GetData(MEMORYDEVICE_CPU);
+  const size_t start = out.size();
+  out.resize(start + image.dataSize * 3);
+  unsigned char *p = &out[start];
+  for(size_t i = 0; i < image.dataSize; ++i, p += 3)
+  {
+    p[0] = colours[i].r;
+    p[1] = colours[i].g;
+    p[2] = colours[i].b;
+  }
+}
+
+bool PackedSequenceUtil::is_packed_sequence(const std::string& path)
+{
+  return bf::extension(path) == ".spseq" && bf::is_regular_file(path);
+}
+
+unsigned int PackedSequenceUtil::read_uint32(const unsigned char *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+}
+
+unsigned long long PackedSequenceUtil::read_uint64(const unsigned char *p)
+{
+  return read_uint32(p) | (static_cast<unsigned long long>(read_uint32(p + 4)) << 32);
+}
+
+void PackedSequenceUtil::write_uint32(unsigned int value, std::vector<unsigned char>& out)
+{
+  for(int i = 0; i < 4; ++i) out.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+}
+
+void PackedSequenceUtil::write_uint64(unsigned long long value, std::vector<unsigned char>& out)
+{
+  write_uint32(static_cast<unsigned int>(value & 0xFFFFFFFFULL), out);
+  write_uint32(static_cast<unsigned int>(value >> 32), out);
+}
+
+}
@@ -0,0 +1,132 @@
+/**
+ * itmx: PackedSequenceWriter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/PackedSequenceWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+PackedSequenceWriter::PackedSequenceWriter(const boost::filesystem::path& path, const std::string& calibText, PackedSequenceUtil::DepthCodec depthCodec)
+: m_depthCodec(depthCodec), m_fs(path.string().c_str(), std::ios_base::binary), m_offset(0), m_path(path)
+{
+  if(!m_fs) throw std::runtime_error("Error: Could not open packed sequence file " + path.string());
+
+  m_buffer.insert(m_buffer.end(), PackedSequenceUtil::HEADER_SIGNATURE, PackedSequenceUtil::HEADER_SIGNATURE + PackedSequenceUtil::SIGNATURE_SIZE);
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(calibText.size()), m_buffer);
+  m_buffer.insert(m_buffer.end(), calibText.begin(), calibText.end());
+  flush_buffer();
+}
+
+//#################### DESTRUCTOR ####################
+
+PackedSequenceWriter::~PackedSequenceWriter()
+{
+  try
+  {
+    close();
+  }
+  catch(std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void PackedSequenceWriter::close()
+{
+  if(!m_fs.is_open()) return;
+
+  const unsigned long long indexOffset = m_offset;
+  for(size_t i = 0, size = m_frameOffsets.size(); i < size; ++i)
+  {
+    PackedSequenceUtil::write_uint64(m_frameOffsets[i], m_buffer);
+  }
+
+  PackedSequenceUtil::write_uint64(indexOffset, m_buffer);
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(m_frameOffsets.size()), m_buffer);
+  m_buffer.insert(m_buffer.end(), PackedSequenceUtil::TRAILER_SIGNATURE, PackedSequenceUtil::TRAILER_SIGNATURE + PackedSequenceUtil::SIGNATURE_SIZE);
+
+  // Note: The file is closed even if the index could not be written, so that this is not attempted again.
+  try
+  {
+    flush_buffer();
+  }
+  catch(...)
+  {
+    m_fs.close();
+    throw;
+  }
+  m_fs.close();
+}
+
+void PackedSequenceWriter::write_frame(const ORUtils::Image<Vector4u> *rgbImage, const ORUtils::Image<short> *depthImage, const boost::optional<Matrix4f>& pose)
+{
+  if(!m_fs.is_open()) throw std::runtime_error("Error: Cannot write a frame to a packed sequence file that has been closed");
+
+  unsigned int flags = 0;
+  if(depthImage) flags |= PackedSequenceUtil::FF_DEPTH;
+  if(rgbImage) flags |= PackedSequenceUtil::FF_RGB;
+  if(pose) flags |= PackedSequenceUtil::FF_POSE;
+  PackedSequenceUtil::write_uint32(flags, m_buffer);
+
+  // Encode each image straight into the buffer after its header, and then go back and fill in its encoded size.
+  if(depthImage)
+  {
+    PackedSequenceUtil::write_uint32(depthImage->noDims.x, m_buffer);
+    PackedSequenceUtil::write_uint32(depthImage->noDims.y, m_buffer);
+    PackedSequenceUtil::write_uint32(m_depthCodec, m_buffer);
+    const size_t sizeOffset = m_buffer.size();
+    PackedSequenceUtil::write_uint32(0, m_buffer);
+    PackedSequenceUtil::encode_depth(m_depthCodec, *depthImage, m_buffer);
+
+    std::vector<unsigned char> size;
+    PackedSequenceUtil::write_uint32(static_cast<unsigned int>(m_buffer.size() - sizeOffset - 4), size);
+    std::copy(size.begin(), size.end(), m_buffer.begin() + sizeOffset);
+  }
+
+  if(rgbImage)
+  {
+    PackedSequenceUtil::write_uint32(rgbImage->noDims.x, m_buffer);
+    PackedSequenceUtil::write_uint32(rgbImage->noDims.y, m_buffer);
+    PackedSequenceUtil::write_uint32(PackedSequenceUtil::RC_RGB, m_buffer);
+    PackedSequenceUtil::write_uint32(static_cast<unsigned int>(rgbImage->dataSize * 3), m_buffer);
+    PackedSequenceUtil::encode_rgb(PackedSequenceUtil::RC_RGB, *rgbImage, m_buffer);
+  }
+
+  if(pose)
+  {
+    for(int i = 0; i < 16; ++i)
+    {
+      unsigned int bits;
+      memcpy(&bits, &pose->m[i], sizeof(float));
+      PackedSequenceUtil::write_uint32(bits, m_buffer);
+    }
+  }
+
+  const unsigned long long frameOffset = m_offset;
+  flush_buffer();
+  m_frameOffsets.push_back(frameOffset);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void PackedSequenceWriter::flush_buffer()
+{
+  m_fs.write(reinterpret_cast<const char*>(&m_buffer[0]), m_buffer.size());
+  const size_t size = m_buffer.size();
+  m_buffer.clear();
+
+  if(!m_fs) throw std::runtime_error("Error: Could not write to packed sequence file " + m_path.string());
+  m_offset += size;
+}
+
+}
@@ -5,9 +5,14 @@
 
 #include "persistence/PosePersister.h"
 
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <stdexcept>
 
+#include <boost/lexical_cast.hpp>
+
 #include <tvgutil/misc/ThreadPool.h>
 using tvgutil::ThreadPool;
 
@@ -17,6 +22,76 @@ namespace itmx {
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
+Matrix4f PosePersister::load_pose(const std::string& path)
+{
+  // Attempt to open the input file.
+  std::ifstream fs(path.c_str());
+  if(!fs) throw std::runtime_error("Could not open input file: " + path);
+
+  // Read the matrix from the file (each line of the file contains one row of the matrix).
+  Matrix4f pose;
+  for(int y = 0; y < 4; ++y)
+  {
+    fs >> pose(0, y) >> pose(1, y) >> pose(2, y) >> pose(3, y);
+  }
+
+  if(!fs) throw std::runtime_error("Could not read a pose from input file: " + path);
+  return pose;
+}
+
+std::vector<PosePersister::TimestampedPose> PosePersister::load_trajectory(const std::string& path)
+{
+  // Attempt to open the input file.
+  std::ifstream fs(path.c_str());
+  if(!fs) throw std::runtime_error("Could not open input file: " + path);
+
+  std::vector<TimestampedPose> trajectory;
+  std::string line;
+  for(int lineIndex = 1; std::getline(fs, line); ++lineIndex)
+  {
+    // Skip any blank lines and comments.
+    const size_t firstChar = line.find_first_not_of(" \t\r");
+    if(firstChar == std::string::npos || line[firstChar] == '#') continue;
+
+    // Read the timestamp, translation and rotation quaternion from the line.
+    std::istringstream is(line);
+    double timestamp, tx, ty, tz, qx, qy, qz, qw;
+    if(!(is >> timestamp >> tx >> ty >> tz >> qx >> qy >> qz >> qw))
+    {
+      throw std::runtime_error("Could not read a pose from line " + boost::lexical_cast<std::string>(lineIndex) + " of trajectory file: " + path);
+    }
+
+    // Normalise the quaternion (it is only stored to limited precision), and then convert it into a rotation matrix.
+    const double qLength = sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+    if(qLength == 0.0) throw std::runtime_error("Invalid rotation on line " + boost::lexical_cast<std::string>(lineIndex) + " of trajectory file: " + path);
+    qx /= qLength; qy /= qLength; qz /= qLength; qw /= qLength;
+
+    Matrix4f pose;
+    pose.setIdentity();
+    pose(0, 0) = static_cast<float>(1 - 2 * (qy * qy + qz * qz));
+    pose(1, 0) = static_cast<float>(2 * (qx * qy - qz * qw));
+    pose(2, 0) = static_cast<float>(2 * (qx * qz + qy * qw));
+    pose(0, 1) = static_cast<float>(2 * (qx * qy + qz * qw));
+    pose(1, 1) = static_cast<float>(1 - 2 * (qx * qx + qz * qz));
+    pose(2, 1) = static_cast<float>(2 * (qy * qz - qx * qw));
+    pose(0, 2) = static_cast<float>(2 * (qx * qz - qy * qw));
+    pose(1, 2) = static_cast<float>(2 * (qy * qz + qx * qw));
+    pose(2, 2) = static_cast<float>(1 - 2 * (qx * qx + qy * qy));
+    pose(3, 0) = static_cast<float>(tx);
+    pose(3, 1) = static_cast<float>(ty);
+    pose(3, 2) = static_cast<float>(tz);
+
+    trajectory.push_back(std::make_pair(timestamp, pose));
+  }
+
+  return trajectory;
+}
+
+std::vector<PosePersister::TimestampedPose> PosePersister::load_trajectory(const bf::path& path)
+{
+  return load_trajectory(path.string());
+}
+
 void PosePersister::save_pose(const Matrix4f& pose, const std::string& path)
 {
   // Attempt to open the output file.
@@ -41,8 +116,8 @@ void PosePersister::save_pose_on_thread(const Matrix4f& pose, const std::string&
   // Select the save_pose overload that takes a string.
   void (*f)(const Matrix4f&, const std::string&) = &save_pose;
 
-  // Call it on a separate thread.
-  ThreadPool::instance().post_task(boost::bind(f, pose, path));
+  // Call it on a separate thread. Pose files are tiny, so they are given priority over any images that are waiting to be saved.
+  ThreadPool::instance().post_task(boost::bind(f, pose, path), ThreadPool::TP_HIGH);
 }
 
 void PosePersister::save_pose_on_thread(const Matrix4f& pose, const bf::path& path)
@@ -50,4 +125,48 @@ void PosePersister::save_pose_on_thread(const Matrix4f& pose, const bf::path& pa
   save_pose_on_thread(pose, path.string());
 }
 
+void PosePersister::write_trajectory_entry(std::ostream& os, double timestamp, const Matrix4f& pose)
+{
+  // Convert the rotation component of the pose into a quaternion. Note that pose(x, y) is the element in column x and row y
+  // of the matrix. To keep the computation numerically stable, we divide by the largest of the quaternion's components.
+  const double r00 = pose(0, 0), r01 = pose(1, 0), r02 = pose(2, 0);
+  const double r10 = pose(0, 1), r11 = pose(1, 1), r12 = pose(2, 1);
+  const double r20 = pose(0, 2), r21 = pose(1, 2), r22 = pose(2, 2);
+  const double trace = r00 + r11 + r22;
+
+  double qx, qy, qz, qw;
+  if(trace > 0)
+  {
+    const double s = 2 * sqrt(trace + 1);
+    qw = s / 4; qx = (r21 - r12) / s; qy = (r02 - r20) / s; qz = (r10 - r01) / s;
+  }
+  else if(r00 > r11 && r00 > r22)
+  {
+    const double s = 2 * sqrt(1 + r00 - r11 - r22);
+    qw = (r21 - r12) / s; qx = s / 4; qy = (r01 + r10) / s; qz = (r02 + r20) / s;
+  }
+  else if(r11 > r22)
+  {
+    const double s = 2 * sqrt(1 + r11 - r00 - r22);
+    qw = (r02 - r20) / s; qx = (r01 + r10) / s; qy = s / 4; qz = (r12 + r21) / s;
+  }
+  else
+  {
+    const double s = 2 * sqrt(1 + r22 - r00 - r11);
+    qw = (r10 - r01) / s; qx = (r02 + r20) / s; qy = (r12 + r21) / s; qz = s / 4;
+  }
+
+  // Write the line. The timestamp is written to microsecond precision (as in the TUM RGB-D benchmark), and the
+  // other values with enough significant digits to recover the float-precision pose when the file is loaded.
+  const std::ios_base::fmtflags oldFlags = os.flags();
+  const std::streamsize oldPrecision = os.precision();
+  os << std::fixed << std::setprecision(6) << timestamp;
+  os.unsetf(std::ios_base::floatfield);
+  os << std::setprecision(9)
+     << ' ' << pose(3, 0) << ' ' << pose(3, 1) << ' ' << pose(3, 2)
+     << ' ' << qx << ' ' << qy << ' ' << qz << ' ' << qw << '\n';
+  os.flags(oldFlags);
+  os.precision(oldPrecision);
+}
+
 }
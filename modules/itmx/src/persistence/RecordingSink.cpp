@@ -0,0 +1,112 @@
+/**
+ * itmx: RecordingSink.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/RecordingSink.h"
+
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/timing/ProfilingScope.h>
+using tvgutil::Profiler;
+using tvgutil::ProfilingScope;
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+RecordingSink::RecordingSink(size_t maxQueueSize)
+: m_maxQueueSize(maxQueueSize), m_workerShouldTerminate(false)
+{
+  if(maxQueueSize == 0)
+  {
+    throw std::invalid_argument("Error: The queue of a recording sink must be able to hold at least one frame");
+  }
+
+  // Start the worker thread.
+  m_worker = boost::thread(boost::bind(&RecordingSink::run_worker, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+RecordingSink::~RecordingSink()
+{
+  stop_worker();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void RecordingSink::push_frame(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Matrix4f>& pose)
+{
+  Frame frame;
+  frame.depthImage = depthImage;
+  frame.pose = pose;
+  frame.rgbImage = rgbImage;
+
+  {
+    // Wait until there is space in the queue, and then add the frame to it.
+    boost::unique_lock<boost::mutex> lock(m_queueMutex);
+    while(m_queue.size() >= m_maxQueueSize) m_queueChanged.wait(lock);
+    m_queue.push_back(frame);
+  }
+
+  m_queueChanged.notify_all();
+}
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
+
+void RecordingSink::stop_worker()
+{
+  if(!m_worker.joinable()) return;
+
+  // Ask the worker thread to terminate once it has written the remaining frames, and wait for it to do so.
+  {
+    boost::lock_guard<boost::mutex> lock(m_queueMutex);
+    m_workerShouldTerminate = true;
+  }
+  m_queueChanged.notify_all();
+
+  m_worker.join();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void RecordingSink::run_worker()
+{
+  Profiler::instance().set_thread_name("Recording sink");
+
+  for(;;)
+  {
+    // Wait until there is a frame to write, or termination is requested.
+    Frame frame;
+    {
+      boost::unique_lock<boost::mutex> lock(m_queueMutex);
+      while(m_queue.empty() && !m_workerShouldTerminate) m_queueChanged.wait(lock);
+
+      // If the queue has been drained and we were asked to terminate, do so.
+      if(m_queue.empty()) return;
+
+      frame = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    // Let any thread that is waiting for space in the queue proceed.
+    m_queueChanged.notify_all();
+
+    // Write the frame. If this fails, report the problem and carry on, since there is no caller to which to propagate it.
+    try
+    {
+      ProfilingScope writeScope("RecordingSink.WriteFrame");
+      write_frame(frame.rgbImage, frame.depthImage, frame.pose);
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+    }
+  }
+}
+
+}
@@ -0,0 +1,109 @@
+/**
+ * itmx: TrajectoryWriter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/TrajectoryWriter.h"
+
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/timing/ProfilingScope.h>
+using tvgutil::Profiler;
+using tvgutil::ProfilingScope;
+
+namespace bf = boost::filesystem;
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+TrajectoryWriter::TrajectoryWriter(const bf::path& path, size_t batchSize)
+: m_batchSize(batchSize), m_fs(path.string().c_str()), m_workerShouldTerminate(false)
+{
+  if(batchSize == 0) throw std::invalid_argument("Error: The batch size of a trajectory writer must be at least one");
+  if(!m_fs) throw std::runtime_error("Error: Could not open trajectory file for writing: " + path.string());
+
+  m_fs << "# timestamp tx ty tz qx qy qz qw\n";
+  m_queue.reserve(batchSize);
+
+  // Start the writer thread.
+  m_worker = boost::thread(boost::bind(&TrajectoryWriter::run_worker, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+  // Ask the writer thread to terminate once it has written the remaining poses, and wait for it to do so.
+  {
+    boost::lock_guard<boost::mutex> lock(m_queueMutex);
+    m_workerShouldTerminate = true;
+  }
+  m_queueChanged.notify_all();
+
+  m_worker.join();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void TrajectoryWriter::write_pose(double timestamp, const Matrix4f& pose)
+{
+  bool batchReady;
+  {
+    boost::lock_guard<boost::mutex> lock(m_queueMutex);
+    m_queue.push_back(std::make_pair(timestamp, pose));
+    batchReady = m_queue.size() >= m_batchSize;
+  }
+
+  // Only wake the writer thread once a whole batch is ready, so that it writes and flushes the file once per batch rather than once per pose.
+  if(batchReady) m_queueChanged.notify_all();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TrajectoryWriter::run_worker()
+{
+  Profiler::instance().set_thread_name("Trajectory writer");
+
+  std::vector<PosePersister::TimestampedPose> batch;
+  batch.reserve(m_batchSize);
+
+  for(;;)
+  {
+    // Wait until there is a batch of poses to write, or termination is requested, and then take the poses from the queue.
+    bool terminating;
+    {
+      boost::unique_lock<boost::mutex> lock(m_queueMutex);
+      while(m_queue.size() < m_batchSize && !m_workerShouldTerminate) m_queueChanged.wait(lock);
+      m_queue.swap(batch);
+      terminating = m_workerShouldTerminate;
+    }
+
+    // Write the poses and flush the file. If this fails, report the problem, since there is no caller to which to propagate it.
+    if(!batch.empty())
+    {
+      ProfilingScope writeScope("TrajectoryWriter.WriteBatch");
+      for(size_t i = 0, size = batch.size(); i < size; ++i)
+      {
+        PosePersister::write_trajectory_entry(m_fs, batch[i].first, batch[i].second);
+      }
+      m_fs.flush();
+
+      if(!m_fs)
+      {
+        std::cerr << "Warning: Could not write a batch of " << batch.size() << " poses to a trajectory file\n";
+        m_fs.clear();
+      }
+
+      batch.clear();
+    }
+
+    // Note: Termination is only requested by the destructor, after which no more poses can be added, so the queue is now empty.
+    if(terminating) return;
+  }
+}
+
+}
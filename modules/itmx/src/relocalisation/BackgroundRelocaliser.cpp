@@ -0,0 +1,217 @@
+/**
+ * itmx: BackgroundRelocaliser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/BackgroundRelocaliser.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/timing/ProfilingScope.h>
+using tvgutil::Profiler;
+using tvgutil::ProfilingScope;
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+BackgroundRelocaliser::BackgroundRelocaliser(const Relocaliser_Ptr& innerRelocaliser, ITMLibSettings::DeviceType deviceType, size_t maxQueueSize)
+: m_deviceType(deviceType),
+  m_innerRelocaliser(innerRelocaliser),
+  m_maxQueueSize(maxQueueSize),
+  m_resetCount(0),
+  m_workerShouldTerminate(false),
+  m_updateRequested(false)
+{
+  if(!innerRelocaliser)
+  {
+    throw std::invalid_argument("Error: Cannot initialise a BackgroundRelocaliser with a NULL relocaliser");
+  }
+
+  if(maxQueueSize == 0)
+  {
+    throw std::invalid_argument("Error: The training queue of a BackgroundRelocaliser must be able to hold at least one sample");
+  }
+
+  // Start the worker thread.
+  m_worker = boost::thread(boost::bind(&BackgroundRelocaliser::run_worker, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+BackgroundRelocaliser::~BackgroundRelocaliser()
+{
+  // Set the flag that informs the worker thread that it should terminate, and wake it (it might be waiting for work).
+  {
+    boost::lock_guard<boost::mutex> lock(m_queueMutex);
+    m_workerShouldTerminate = true;
+  }
+  m_workAvailable.notify_one();
+
+  // Wait for the worker thread to finish any training sample it is processing and terminate gracefully.
+  m_worker.join();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void BackgroundRelocaliser::load_from_disk(const std::string& path)
+{
+  // Discard any training samples that were captured before the load, since they would otherwise be added to the loaded contents.
+  discard_queued_samples();
+
+  // Load the contents of the wrapped relocaliser, waiting for any training sample that is currently in progress to finish first.
+  boost::lock_guard<boost::mutex> lock(m_relocaliserMutex);
+  m_innerRelocaliser->load_from_disk(path);
+}
+
+boost::optional<Relocaliser::Result>
+BackgroundRelocaliser::relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage, const Vector4f& depthIntrinsics) const
+{
+  boost::lock_guard<boost::mutex> lock(m_relocaliserMutex);
+  return m_innerRelocaliser->relocalise(colourImage, depthImage, depthIntrinsics);
+}
+
+std::vector<Relocaliser::Result>
+BackgroundRelocaliser::relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                             const Vector4f& depthIntrinsics, size_t maxCandidateCount) const
+{
+  boost::lock_guard<boost::mutex> lock(m_relocaliserMutex);
+  return m_innerRelocaliser->relocalise_candidates(colourImage, depthImage, depthIntrinsics, maxCandidateCount);
+}
+
+void BackgroundRelocaliser::reset()
+{
+  // Discard any training samples that were captured before the reset, and any pending update.
+  discard_queued_samples();
+
+  // Reset the wrapped relocaliser, waiting for any training sample that is currently in progress to finish first.
+  boost::lock_guard<boost::mutex> lock(m_relocaliserMutex);
+  m_innerRelocaliser->reset();
+}
+
+void BackgroundRelocaliser::save_to_disk(const std::string& path) const
+{
+  boost::lock_guard<boost::mutex> lock(m_relocaliserMutex);
+  m_innerRelocaliser->save_to_disk(path);
+}
+
+void BackgroundRelocaliser::train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                  const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose)
+{
+  // Grab a sample into which to snapshot the inputs, or drop the inputs if the queue is already full.
+  TrainingSample sample;
+  {
+    boost::lock_guard<boost::mutex> lock(m_queueMutex);
+    if(m_queue.size() >= m_maxQueueSize) return;
+
+    if(!m_freeSamples.empty())
+    {
+      sample = m_freeSamples.front();
+      m_freeSamples.pop_front();
+    }
+  }
+
+  // Snapshot the inputs (note that no lock is held whilst copying the images).
+  copy_image(colourImage, sample.colourImage);
+  copy_image(depthImage, sample.depthImage);
+  sample.depthIntrinsics = depthIntrinsics;
+  sample.cameraPose.SetFrom(&cameraPose);
+
+  // Publish the sample to the worker thread.
+  {
+    boost::lock_guard<boost::mutex> lock(m_queueMutex);
+    m_queue.push_back(sample);
+  }
+  m_workAvailable.notify_one();
+}
+
+void BackgroundRelocaliser::update()
+{
+  // Ask the worker thread to update the wrapped relocaliser once it has no training left to do.
+  {
+    boost::lock_guard<boost::mutex> lock(m_queueMutex);
+    m_updateRequested = true;
+  }
+  m_workAvailable.notify_one();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+template <typename T>
+void BackgroundRelocaliser::copy_image(const ORUtils::Image<T> *src, boost::shared_ptr<ORUtils::Image<T> >& dst) const
+{
+  const bool useCUDA = m_deviceType == ITMLibSettings::DEVICE_CUDA;
+
+  if(!dst) dst.reset(new ORUtils::Image<T>(src->noDims, true, useCUDA));
+  else dst->ChangeDims(src->noDims);
+
+  // Copy the image on whichever device the wrapped relocaliser will read it from.
+  dst->SetFrom(src, useCUDA ? ORUtils::Image<T>::CUDA_TO_CUDA : ORUtils::Image<T>::CPU_TO_CPU);
+}
+
+void BackgroundRelocaliser::discard_queued_samples()
+{
+  boost::lock_guard<boost::mutex> lock(m_queueMutex);
+  m_freeSamples.insert(m_freeSamples.end(), m_queue.begin(), m_queue.end());
+  m_queue.clear();
+  m_updateRequested = false;
+  ++m_resetCount;
+}
+
+void BackgroundRelocaliser::run_worker()
+{
+  Profiler::instance().set_thread_name("Background relocaliser");
+
+  for(;;)
+  {
+    // Wait until there is a training sample to process, an update has been requested, or termination is requested.
+    TrainingSample sample;
+    bool performUpdate = false;
+    size_t resetCount;
+    {
+      boost::unique_lock<boost::mutex> lock(m_queueMutex);
+      while(!m_workerShouldTerminate && m_queue.empty() && !m_updateRequested) m_workAvailable.wait(lock);
+
+      // If we were asked to terminate, do so.
+      if(m_workerShouldTerminate) return;
+
+      resetCount = m_resetCount;
+
+      // Training samples take priority over updates, so that the model catches up with the inputs as quickly as possible.
+      if(!m_queue.empty())
+      {
+        sample = m_queue.front();
+        m_queue.pop_front();
+      }
+      else
+      {
+        performUpdate = true;
+        m_updateRequested = false;
+      }
+    }
+
+    // Train or update the wrapped relocaliser, holding the relocaliser mutex so that relocalise sees a consistent model.
+    // If the relocaliser was reset after we dequeued the work, the work refers to the old model and must be discarded.
+    {
+      boost::lock_guard<boost::mutex> lock(m_relocaliserMutex);
+      if(resetCount == m_resetCount)
+      {
+        ProfilingScope workScope(performUpdate ? "BackgroundRelocaliser.Update" : "BackgroundRelocaliser.Train");
+        if(performUpdate) m_innerRelocaliser->update();
+        else m_innerRelocaliser->train(sample.colourImage.get(), sample.depthImage.get(), sample.depthIntrinsics, sample.cameraPose);
+      }
+    }
+
+    // Hand the sample's images back so that they can be reused for a later snapshot.
+    if(!performUpdate)
+    {
+      boost::lock_guard<boost::mutex> lock(m_queueMutex);
+      m_freeSamples.push_back(sample);
+    }
+  }
+}
+
+}
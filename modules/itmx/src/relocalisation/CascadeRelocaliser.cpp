@@ -0,0 +1,114 @@
+/**
+ * itmx: CascadeRelocaliser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/CascadeRelocaliser.h"
+
+#include <stdexcept>
+
+#include <tvgutil/timing/ProfilingScope.h>
+using tvgutil::Profiler;
+using tvgutil::ProfilingScope;
+
+namespace itmx {
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void CascadeRelocaliser::add_stage(const std::string& name, const Relocaliser_Ptr& relocaliser, bool persistent)
+{
+  if(!relocaliser) throw std::invalid_argument("Error: Cannot add a null relocaliser to a relocaliser cascade");
+  if(persistent && m_persistentStageIndex) throw std::invalid_argument("Error: A relocaliser cascade can have at most one persistent stage");
+
+  if(persistent) m_persistentStageIndex = m_stages.size();
+
+  Stage stage;
+  stage.gaugeName = "CascadeRelocaliser." + name + ".HitRate";
+  stage.profilingName = "CascadeRelocaliser." + name;
+  stage.relocaliser = relocaliser;
+  m_stages.push_back(stage);
+
+  StageStats stats;
+  stats.attemptCount = stats.hitCount = 0;
+  stats.name = name;
+  stats.totalMilliseconds = 0.0;
+  m_stageStats.push_back(stats);
+}
+
+const std::vector<CascadeRelocaliser::StageStats>& CascadeRelocaliser::get_stage_stats() const
+{
+  return m_stageStats;
+}
+
+void CascadeRelocaliser::load_from_disk(const std::string& path)
+{
+  if(m_persistentStageIndex) m_stages[*m_persistentStageIndex].relocaliser->load_from_disk(path);
+  else Relocaliser::load_from_disk(path);
+}
+
+boost::optional<Relocaliser::Result> CascadeRelocaliser::relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                                    const Vector4f& depthIntrinsics) const
+{
+  Profiler& profiler = Profiler::instance();
+  boost::optional<Result> fallbackResult;
+
+  for(size_t i = 0, size = m_stages.size(); i < size; ++i)
+  {
+    const Stage& stage = m_stages[i];
+    StageStats& stats = m_stageStats[i];
+
+    // Run the stage, timing it both for our own statistics and for the profiler.
+    boost::optional<Result> result;
+    const Profiler::Clock::time_point t0 = Profiler::Clock::now();
+    {
+      ProfilingScope stageScope(stage.profilingName.c_str());
+      result = stage.relocaliser->relocalise(colourImage, depthImage, depthIntrinsics);
+    }
+    const Profiler::Clock::time_point t1 = Profiler::Clock::now();
+
+    const bool hit = result && result->quality == RELOCALISATION_GOOD;
+    ++stats.attemptCount;
+    if(hit) ++stats.hitCount;
+    stats.totalMilliseconds += boost::chrono::duration<double,boost::milli>(t1 - t0).count();
+    if(profiler.is_enabled()) profiler.set_gauge(stage.gaugeName, static_cast<double>(stats.hitCount) / stats.attemptCount);
+
+    // If the stage produced a good result, stop here. Otherwise, remember the first poor result in case no later stage does better.
+    if(hit) return result;
+    if(result && !fallbackResult) fallbackResult = result;
+  }
+
+  return fallbackResult;
+}
+
+void CascadeRelocaliser::reset()
+{
+  for(size_t i = 0, size = m_stages.size(); i < size; ++i)
+  {
+    m_stages[i].relocaliser->reset();
+  }
+}
+
+void CascadeRelocaliser::save_to_disk(const std::string& path) const
+{
+  if(m_persistentStageIndex) m_stages[*m_persistentStageIndex].relocaliser->save_to_disk(path);
+  else Relocaliser::save_to_disk(path);
+}
+
+void CascadeRelocaliser::train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                               const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose)
+{
+  for(size_t i = 0, size = m_stages.size(); i < size; ++i)
+  {
+    m_stages[i].relocaliser->train(colourImage, depthImage, depthIntrinsics, cameraPose);
+  }
+}
+
+void CascadeRelocaliser::update()
+{
+  for(size_t i = 0, size = m_stages.size(); i < size; ++i)
+  {
+    m_stages[i].relocaliser->update();
+  }
+}
+
+}
@@ -0,0 +1,43 @@
+/**
+ * itmx: FernKeyframeDatabaseFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/FernKeyframeDatabaseFactory.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include "relocalisation/cpu/FernKeyframeDatabase_CPU.h"
+
+#ifdef WITH_CUDA
+#include "relocalisation/cuda/FernKeyframeDatabase_CUDA.h"
+#endif
+
+namespace itmx {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+FernKeyframeDatabase_Ptr FernKeyframeDatabaseFactory::make_database(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed,
+                                                                    ITMLibSettings::DeviceType deviceType)
+{
+  FernKeyframeDatabase_Ptr database;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    database.reset(new FernKeyframeDatabase_CUDA(fernCount, decisionsPerFern, depthRange, seed));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    database.reset(new FernKeyframeDatabase_CPU(fernCount, decisionsPerFern, depthRange, seed));
+  }
+
+  return database;
+}
+
+}
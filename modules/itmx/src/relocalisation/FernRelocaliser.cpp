@@ -5,66 +5,171 @@
 
 #include "relocalisation/FernRelocaliser.h"
 
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <tvgutil/persistence/BinaryBufferUtil.h>
+using namespace tvgutil;
+
+#include "relocalisation/FernKeyframeDatabaseFactory.h"
+
+namespace {
+
+//#################### CONSTANTS ####################
+
+/** The signature at the start of a fern relocaliser file. */
+const char *SIGNATURE = "SPTFRN01";
+
+/** The size (in bytes) of the signature at the start of a fern relocaliser file. */
+const size_t SIGNATURE_SIZE = 8;
+
+}
+
 namespace itmx {
 
 //#################### CONSTRUCTORS ####################
 
-FernRelocaliser::FernRelocaliser(const Vector2i& depthImageSize, float viewFrustumMin, float viewFrustumMax,
+FernRelocaliser::FernRelocaliser(float viewFrustumMin, float viewFrustumMax,
                                  float harvestingThreshold, int numFerns, int decisionsPerFern,
+                                 ITMLib::ITMLibSettings::DeviceType deviceType,
                                  KeyframeAddPolicy keyframeAddPolicy)
-: m_decisionsPerFern(decisionsPerFern),
-  m_depthImageSize(depthImageSize),
-  m_harvestingThreshold(harvestingThreshold),
-  m_keyframeAddPolicy(keyframeAddPolicy),
-  m_numFerns(numFerns),
-  m_rangeParameters(viewFrustumMin, viewFrustumMax)
+: m_harvestingThreshold(harvestingThreshold),
+  m_keyframeAddPolicy(keyframeAddPolicy)
 {
+  const unsigned int seed = 12345;
+  m_database = FernKeyframeDatabaseFactory::make_database(numFerns, decisionsPerFern, Vector2f(viewFrustumMin, viewFrustumMax), seed, deviceType);
+
   reset();
 }
 
 //#################### PUBLIC VIRTUAL MEMBER FUNCTIONS ####################
 
+void FernRelocaliser::load_from_disk(const std::string& path)
+{
+  // Memory-map the file, so that only the bytes we actually need are read in.
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(path);
+  }
+  catch(std::exception&)
+  {
+    throw std::runtime_error("Error: Could not open fern relocaliser file " + path);
+  }
+
+  const unsigned char *data = reinterpret_cast<const unsigned char*>(file.data());
+  const unsigned char *end = data + file.size();
+  const std::runtime_error corruptError("Error: Fern relocaliser file " + path + " is corrupt");
+
+  // Check the header, and make sure that the saved ferns have the same shape as ours.
+  if(file.size() < SIGNATURE_SIZE || memcmp(data, SIGNATURE, SIGNATURE_SIZE) != 0)
+  {
+    throw std::runtime_error("Error: " + path + " is not a fern relocaliser file");
+  }
+
+  const unsigned char *p = data + SIGNATURE_SIZE;
+  int header[3];
+  if(!BinaryBufferUtil::read_values(p, end, header, 3)) throw corruptError;
+
+  const int fernCount = header[0], decisionsPerFern = header[1], keyframeCount = header[2];
+  if(fernCount != m_database->get_fern_count() || decisionsPerFern != m_database->get_decisions_per_fern())
+  {
+    throw std::runtime_error("Error: Fern relocaliser file " + path + " was saved from a relocaliser with a different number of ferns or decisions");
+  }
+
+  if(keyframeCount < 0) throw corruptError;
+
+  // Read in the fern decisions, the keyframe codes and the keyframe poses.
+  std::vector<FernDecision> decisions(fernCount * decisionsPerFern);
+  std::vector<char> keyframeCodes(static_cast<size_t>(keyframeCount) * fernCount);
+  std::vector<Matrix4f> keyframeMatrices(keyframeCount);
+  if(!BinaryBufferUtil::read_values(p, end, &decisions[0], decisions.size()) ||
+     !BinaryBufferUtil::read_values(p, end, keyframeCodes.empty() ? NULL : &keyframeCodes[0], keyframeCodes.size()) ||
+     !BinaryBufferUtil::read_values(p, end, keyframeMatrices.empty() ? NULL : &keyframeMatrices[0], keyframeMatrices.size()) ||
+     p != end)
+  {
+    throw corruptError;
+  }
+
+  // Replace the contents of the relocaliser. The decisions are replaced as well as the keyframes, since the keyframe
+  // codes are only meaningful with respect to the decisions that produced them.
+  reset();
+  m_database->set_contents(decisions, keyframeCodes);
+
+  m_keyframePoses.resize(keyframeCount);
+  for(int i = 0; i < keyframeCount; ++i) m_keyframePoses[i].SetM(keyframeMatrices[i]);
+}
+
 boost::optional<Relocaliser::Result>
 FernRelocaliser::relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage, const Vector4f &depthIntrinsics) const
 {
-  // Copy the current depth input across to the CPU for use by the relocaliser.
-  depthImage->UpdateHostFromDevice();
+  std::vector<Result> candidates = relocalise_candidates(colourImage, depthImage, depthIntrinsics, 1);
+  if(!candidates.empty()) return candidates[0];
+  else return boost::none;
+}
 
-  // Since we are relocalising, we don't want to add this as a keyframe.
-  bool considerKeyframe = false;
-  const int sceneId = 0;
-  const int requestedNearestNeighbourCount = 1;
-  int nearestNeighbour = -1;
+std::vector<Relocaliser::Result>
+FernRelocaliser::relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                       const Vector4f& depthIntrinsics, size_t maxCandidateCount) const
+{
+  std::vector<Result> candidates;
+  if(maxCandidateCount == 0) return candidates;
 
-  // Process the current depth image using the relocaliser. This attempts to find the nearest keyframe
-  // (if any) that is currently in the database.
-  m_relocaliser->ProcessFrame(depthImage, NULL, sceneId, requestedNearestNeighbourCount, &nearestNeighbour, NULL, considerKeyframe);
+  // Encode the current depth image (on whichever device the database uses), and find the nearest keyframes
+  // (if any) that are currently in the database, in increasing order of their distance from the image.
+  m_database->encode_image(depthImage);
+  std::vector<FernKeyframeDatabase::Match> matches = m_database->find_most_similar_keyframes(static_cast<int>(maxCandidateCount));
 
-  // If a nearest keyframe was found by the relocaliser, return it.
-  if(nearestNeighbour != -1)
+  // Return the poses of any nearest keyframes that were found.
+  for(size_t i = 0, size = matches.size(); i < size; ++i)
   {
-    // Set the number of frames for which the train function has to be called before the relocaliser can
-    // consider adding a new keyframe (no need to check the policy here).
-    m_keyframeDelay = 10;
-
-    // Retrieve the pose and set the quality to GOOD.
     Result result;
-    result.pose = m_relocaliser->RetrievePose(nearestNeighbour).pose;
+    result.pose = m_keyframePoses[matches[i].first];
     result.quality = RELOCALISATION_GOOD;
-
-    return result;
+    candidates.push_back(result);
   }
 
-  return boost::none;
+  // If any keyframes were found, set the number of frames for which the train function has to be called before
+  // the relocaliser can consider adding a new keyframe (no need to check the policy here).
+  if(!candidates.empty()) m_keyframeDelay = 10;
+
+  return candidates;
 }
 
 void FernRelocaliser::reset()
 {
   m_keyframeDelay = 0;
+  m_database->clear();
+  m_keyframePoses.clear();
+}
+
+void FernRelocaliser::save_to_disk(const std::string& path) const
+{
+  std::vector<FernDecision> decisions;
+  std::vector<char> keyframeCodes;
+  m_database->get_contents(decisions, keyframeCodes);
+
+  // Write the header (the signature, followed by the shape of the ferns and the number of keyframes).
+  std::vector<unsigned char> buffer(SIGNATURE, SIGNATURE + SIGNATURE_SIZE);
+  const int header[] = { m_database->get_fern_count(), m_database->get_decisions_per_fern(), m_database->get_keyframe_count() };
+  BinaryBufferUtil::append_values(header, 3, buffer);
+
+  // Write the fern decisions, the keyframe codes and the keyframe poses.
+  BinaryBufferUtil::append_values(&decisions[0], decisions.size(), buffer);
+  if(!keyframeCodes.empty()) BinaryBufferUtil::append_values(&keyframeCodes[0], keyframeCodes.size(), buffer);
+  for(size_t i = 0, size = m_keyframePoses.size(); i < size; ++i)
+  {
+    BinaryBufferUtil::append_values(&m_keyframePoses[i].GetM(), 1, buffer);
+  }
 
-  m_relocaliser.reset(new WrappedRelocaliser(
-    m_depthImageSize, m_rangeParameters, m_harvestingThreshold, m_numFerns, m_decisionsPerFern
-  ));
+  std::ofstream fs(path.c_str(), std::ios::binary);
+  if(!fs || !fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size()))
+  {
+    throw std::runtime_error("Error: Could not write fern relocaliser file " + path);
+  }
 }
 
 void FernRelocaliser::train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
@@ -82,18 +187,15 @@ void FernRelocaliser::train(const ITMUChar4Image *colourImage, const ITMFloatIma
     return;
   }
 
-  // Copy the current depth input across to the CPU for use by the relocaliser.
-  depthImage->UpdateHostFromDevice();
-
-  // Process the current depth image using the relocaliser. This attempts to find the nearest keyframe
-  // (if any) that is currently in the database, and may add the current frame as a new keyframe if the
-  // current frame differs sufficiently from the existing keyframes.
-  const bool considerKeyframe = true;
-  const int sceneId = 0;
-  const int requestedNearestNeighbourCount = 1;
-  int nearestNeighbour = -1;
-
-  m_relocaliser->ProcessFrame(depthImage, &cameraPose, sceneId, requestedNearestNeighbourCount, &nearestNeighbour, NULL, considerKeyframe);
+  // Encode the current depth image and find the nearest keyframe (if any) that is currently in the database.
+  // If the image differs sufficiently from all of the existing keyframes, add it as a new keyframe.
+  m_database->encode_image(depthImage);
+  std::vector<FernKeyframeDatabase::Match> matches = m_database->find_most_similar_keyframes(1);
+  if(matches.empty() || matches[0].second > m_harvestingThreshold)
+  {
+    m_database->add_keyframe();
+    m_keyframePoses.push_back(cameraPose);
+  }
 }
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
@@ -0,0 +1,60 @@
+/**
+ * itmx: RecentPoseRelocaliser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/RecentPoseRelocaliser.h"
+
+#include <stdexcept>
+
+#include "geometry/GeometryUtil.h"
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+RecentPoseRelocaliser::RecentPoseRelocaliser(size_t maxPoseCount)
+: m_poses(maxPoseCount)
+{
+  if(maxPoseCount == 0) throw std::invalid_argument("Error: A recent pose relocaliser must be able to keep at least one pose");
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+boost::optional<Relocaliser::Result> RecentPoseRelocaliser::relocalise(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                                       const Vector4f& depthIntrinsics) const
+{
+  std::vector<Result> candidates = relocalise_candidates(colourImage, depthImage, depthIntrinsics, 1);
+  if(candidates.empty()) return boost::none;
+  else return candidates[0];
+}
+
+std::vector<Relocaliser::Result> RecentPoseRelocaliser::relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                                              const Vector4f& depthIntrinsics, size_t maxCandidateCount) const
+{
+  // Propose the recent poses, starting with the most recent. Since nothing has been checked against the current images,
+  // the poses are all marked as poor (it is up to the caller to verify them, e.g. using ICP).
+  std::vector<Result> candidates;
+  for(boost::circular_buffer<ORUtils::SE3Pose>::const_reverse_iterator it = m_poses.rbegin(), iend = m_poses.rend(); it != iend && candidates.size() < maxCandidateCount; ++it)
+  {
+    Result candidate;
+    candidate.pose = *it;
+    candidate.quality = RELOCALISATION_POOR;
+    candidates.push_back(candidate);
+  }
+  return candidates;
+}
+
+void RecentPoseRelocaliser::reset()
+{
+  m_poses.clear();
+}
+
+void RecentPoseRelocaliser::train(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                  const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose)
+{
+  if(!m_poses.empty() && GeometryUtil::poses_are_similar(cameraPose, m_poses.back())) m_poses.back() = cameraPose;
+  else m_poses.push_back(cameraPose);
+}
+
+}
@@ -5,6 +5,8 @@
 
 #include "relocalisation/Relocaliser.h"
 
+#include <stdexcept>
+
 namespace itmx {
 
 //#################### DESTRUCTOR ####################
@@ -13,6 +15,28 @@ Relocaliser::~Relocaliser() {}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+void Relocaliser::load_from_disk(const std::string& path)
+{
+  throw std::runtime_error("Error: This relocaliser does not support loading its contents from disk");
+}
+
+std::vector<Relocaliser::Result> Relocaliser::relocalise_candidates(const ITMUChar4Image *colourImage, const ITMFloatImage *depthImage,
+                                                                    const Vector4f& depthIntrinsics, size_t maxCandidateCount) const
+{
+  std::vector<Result> candidates;
+  if(maxCandidateCount > 0)
+  {
+    boost::optional<Result> result = relocalise(colourImage, depthImage, depthIntrinsics);
+    if(result) candidates.push_back(*result);
+  }
+  return candidates;
+}
+
+void Relocaliser::save_to_disk(const std::string& path) const
+{
+  throw std::runtime_error("Error: This relocaliser does not support saving its contents to disk");
+}
+
 void Relocaliser::update()
 {
   // No-op by default
@@ -0,0 +1,68 @@
+/**
+ * itmx: FernKeyframeDatabase_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/cpu/FernKeyframeDatabase_CPU.h"
+
+#include <algorithm>
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+FernKeyframeDatabase_CPU::FernKeyframeDatabase_CPU(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed)
+: FernKeyframeDatabase(fernCount, decisionsPerFern, depthRange, seed)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void FernKeyframeDatabase_CPU::encode_image_sub(const ITMFloatImage *depthImage)
+{
+  const float *depths = depthImage->GetData(MEMORYDEVICE_CPU);
+  const Vector2i imgSize = depthImage->noDims;
+  const FernDecision *decisions = m_decisionsMB->GetData(MEMORYDEVICE_CPU);
+  char *codes = m_codesMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int fernIndex = 0; fernIndex < m_fernCount; ++fernIndex)
+  {
+    compute_fern_code(fernIndex, depths, imgSize, decisions, m_decisionsPerFern, codes);
+  }
+}
+
+std::vector<FernKeyframeDatabase::Match> FernKeyframeDatabase_CPU::find_most_similar_keyframes_sub(int maxMatchCount) const
+{
+  const char *codes = m_codesMB->GetData(MEMORYDEVICE_CPU);
+  float *dissimilarities = m_dissimilaritiesMB->GetData(MEMORYDEVICE_CPU);
+  const char *keyframeCodes = m_keyframeCodesMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int keyframeIndex = 0; keyframeIndex < m_keyframeCount; ++keyframeIndex)
+  {
+    compute_keyframe_dissimilarity(keyframeIndex, keyframeCodes, codes, m_fernCount, dissimilarities);
+  }
+
+  // Find the most similar keyframes, breaking ties in favour of older keyframes.
+  std::vector<Match> matches(m_keyframeCount);
+  for(int i = 0; i < m_keyframeCount; ++i)
+  {
+    matches[i] = std::make_pair(i, dissimilarities[i]);
+  }
+
+  std::partial_sort(matches.begin(), matches.begin() + maxMatchCount, matches.end(), MatchComparator());
+  matches.resize(maxMatchCount);
+  return matches;
+}
+
+void FernKeyframeDatabase_CPU::store_codes_sub(int keyframeIndex)
+{
+  std::copy(m_codesMB->GetData(MEMORYDEVICE_CPU), m_codesMB->GetData(MEMORYDEVICE_CPU) + m_fernCount,
+            m_keyframeCodesMB->GetData(MEMORYDEVICE_CPU) + keyframeIndex * m_fernCount);
+}
+
+}
@@ -0,0 +1,114 @@
+/**
+ * itmx: FernKeyframeDatabase_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/cuda/FernKeyframeDatabase_CUDA.h"
+
+#include <thrust/device_ptr.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <ORUtils/CUDADefines.h>
+
+#include "base/MemoryBlockFactory.h"
+#include "relocalisation/shared/FernKeyframeDatabase_Shared.h"
+
+namespace itmx {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_compute_fern_codes(const float *depths, Vector2i imgSize, const FernDecision *decisions, int decisionsPerFern, int fernCount, char *codes)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < fernCount)
+  {
+    compute_fern_code(tid, depths, imgSize, decisions, decisionsPerFern, codes);
+  }
+}
+
+__global__ void ck_compute_keyframe_dissimilarities(const char *keyframeCodes, const char *codes, int fernCount, int keyframeCount, float *dissimilarities)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < keyframeCount)
+  {
+    compute_keyframe_dissimilarity(tid, keyframeCodes, codes, fernCount, dissimilarities);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+FernKeyframeDatabase_CUDA::FernKeyframeDatabase_CUDA(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed)
+: FernKeyframeDatabase(fernCount, decisionsPerFern, depthRange, seed),
+  m_keyframeIndicesMB(MemoryBlockFactory::instance().make_block<int>(m_dissimilaritiesMB->dataSize, "FernKeyframeDatabase"))
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void FernKeyframeDatabase_CUDA::encode_image_sub(const ITMFloatImage *depthImage)
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (m_fernCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_compute_fern_codes<<<numBlocks,threadsPerBlock>>>(
+    depthImage->GetData(MEMORYDEVICE_CUDA),
+    depthImage->noDims,
+    m_decisionsMB->GetData(MEMORYDEVICE_CUDA),
+    m_decisionsPerFern,
+    m_fernCount,
+    m_codesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+std::vector<FernKeyframeDatabase::Match> FernKeyframeDatabase_CUDA::find_most_similar_keyframes_sub(int maxMatchCount) const
+{
+  // Compute the dissimilarities between all of the keyframes and the current image in parallel.
+  int threadsPerBlock = 256;
+  int numBlocks = (m_keyframeCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_compute_keyframe_dissimilarities<<<numBlocks,threadsPerBlock>>>(
+    m_keyframeCodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_codesMB->GetData(MEMORYDEVICE_CUDA),
+    m_fernCount,
+    m_keyframeCount,
+    m_dissimilaritiesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Make sure that there is enough space for the keyframe indices (the database may have grown since we last searched it).
+  if(m_keyframeIndicesMB->dataSize < m_dissimilaritiesMB->dataSize)
+  {
+    m_keyframeIndicesMB = MemoryBlockFactory::instance().make_block<int>(m_dissimilaritiesMB->dataSize, "FernKeyframeDatabase");
+  }
+
+  // Sort the keyframe indices by dissimilarity on the GPU. The sort is stable, so ties are broken in favour of older keyframes.
+  thrust::device_ptr<float> dissimilarities(m_dissimilaritiesMB->GetData(MEMORYDEVICE_CUDA));
+  thrust::device_ptr<int> keyframeIndices(m_keyframeIndicesMB->GetData(MEMORYDEVICE_CUDA));
+  thrust::sequence(keyframeIndices, keyframeIndices + m_keyframeCount);
+  thrust::stable_sort_by_key(dissimilarities, dissimilarities + m_keyframeCount, keyframeIndices);
+
+  // Copy only the best matches back across to the CPU.
+  std::vector<float> bestDissimilarities(maxMatchCount);
+  std::vector<int> bestIndices(maxMatchCount);
+  ORcudaSafeCall(cudaMemcpy(&bestDissimilarities[0], m_dissimilaritiesMB->GetData(MEMORYDEVICE_CUDA), maxMatchCount * sizeof(float), cudaMemcpyDeviceToHost));
+  ORcudaSafeCall(cudaMemcpy(&bestIndices[0], m_keyframeIndicesMB->GetData(MEMORYDEVICE_CUDA), maxMatchCount * sizeof(int), cudaMemcpyDeviceToHost));
+
+  std::vector<Match> matches(maxMatchCount);
+  for(int i = 0; i < maxMatchCount; ++i)
+  {
+    matches[i] = std::make_pair(bestIndices[i], bestDissimilarities[i]);
+  }
+
+  return matches;
+}
+
+void FernKeyframeDatabase_CUDA::store_codes_sub(int keyframeIndex)
+{
+  ORcudaSafeCall(cudaMemcpy(
+    m_keyframeCodesMB->GetData(MEMORYDEVICE_CUDA) + keyframeIndex * m_fernCount,
+    m_codesMB->GetData(MEMORYDEVICE_CUDA),
+    m_fernCount * sizeof(char),
+    cudaMemcpyDeviceToDevice
+  ));
+}
+
+}
@@ -0,0 +1,160 @@
+/**
+ * itmx: FernKeyframeDatabase.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "relocalisation/interface/FernKeyframeDatabase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+
+#include "base/MemoryBlockFactory.h"
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+FernKeyframeDatabase::FernKeyframeDatabase(int fernCount, int decisionsPerFern, const Vector2f& depthRange, unsigned int seed)
+: m_decisionsPerFern(decisionsPerFern), m_fernCount(fernCount), m_keyframeCount(0)
+{
+  if(fernCount <= 0)
+  {
+    throw std::invalid_argument("Error: A fern keyframe database must have at least one fern");
+  }
+
+  if(decisionsPerFern <= 0 || decisionsPerFern > FERNKEYFRAMEDATABASE_MAX_DECISIONS_PER_FERN)
+  {
+    throw std::invalid_argument("Error: The number of decisions per fern is out of range");
+  }
+
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  const int initialCapacity = 64;
+  m_codesMB = mbf.make_block<char>(fernCount, "FernKeyframeDatabase");
+  m_decisionsMB = mbf.make_block<FernDecision>(fernCount * decisionsPerFern, "FernKeyframeDatabase");
+  m_dissimilaritiesMB = mbf.make_block<float>(initialCapacity, "FernKeyframeDatabase");
+  m_keyframeCodesMB = mbf.make_block<char>(initialCapacity * fernCount, "FernKeyframeDatabase");
+
+  // Randomly generate the fern decisions, and copy them across to the device once and for all.
+  tvgutil::RandomNumberGenerator rng(seed);
+  FernDecision *decisions = m_decisionsMB->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, count = fernCount * decisionsPerFern; i < count; ++i)
+  {
+    decisions[i].location.x = rng.generate_real_from_uniform<float>(0.0f, 1.0f);
+    decisions[i].location.y = rng.generate_real_from_uniform<float>(0.0f, 1.0f);
+    decisions[i].threshold = rng.generate_real_from_uniform<float>(depthRange.x, depthRange.y);
+  }
+  m_decisionsMB->UpdateDeviceFromHost();
+}
+
+//#################### DESTRUCTOR ####################
+
+FernKeyframeDatabase::~FernKeyframeDatabase() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+int FernKeyframeDatabase::add_keyframe()
+{
+  if(static_cast<size_t>((m_keyframeCount + 1) * m_fernCount) > m_keyframeCodesMB->dataSize)
+  {
+    grow_keyframe_codes();
+  }
+
+  const int keyframeIndex = m_keyframeCount++;
+  store_codes_sub(keyframeIndex);
+  return keyframeIndex;
+}
+
+void FernKeyframeDatabase::clear()
+{
+  m_keyframeCount = 0;
+}
+
+void FernKeyframeDatabase::encode_image(const ITMFloatImage *depthImage)
+{
+  encode_image_sub(depthImage);
+}
+
+std::vector<FernKeyframeDatabase::Match> FernKeyframeDatabase::find_most_similar_keyframes(int maxMatchCount) const
+{
+  maxMatchCount = std::min(maxMatchCount, m_keyframeCount);
+  if(maxMatchCount <= 0) return std::vector<Match>();
+  return find_most_similar_keyframes_sub(maxMatchCount);
+}
+
+void FernKeyframeDatabase::get_contents(std::vector<FernDecision>& decisions, std::vector<char>& keyframeCodes) const
+{
+  // Note: The decisions are only ever written on the host, so the host copy of them is always up to date.
+  const FernDecision *decisionsData = m_decisionsMB->GetData(MEMORYDEVICE_CPU);
+  decisions.assign(decisionsData, decisionsData + m_fernCount * m_decisionsPerFern);
+
+  m_keyframeCodesMB->UpdateHostFromDevice();
+  const char *keyframeCodesData = m_keyframeCodesMB->GetData(MEMORYDEVICE_CPU);
+  keyframeCodes.assign(keyframeCodesData, keyframeCodesData + m_keyframeCount * m_fernCount);
+}
+
+int FernKeyframeDatabase::get_decisions_per_fern() const
+{
+  return m_decisionsPerFern;
+}
+
+int FernKeyframeDatabase::get_fern_count() const
+{
+  return m_fernCount;
+}
+
+int FernKeyframeDatabase::get_keyframe_count() const
+{
+  return m_keyframeCount;
+}
+
+void FernKeyframeDatabase::set_contents(const std::vector<FernDecision>& decisions, const std::vector<char>& keyframeCodes)
+{
+  if(decisions.size() != static_cast<size_t>(m_fernCount * m_decisionsPerFern))
+  {
+    throw std::invalid_argument("Error: The number of fern decisions does not match the shape of the fern keyframe database");
+  }
+
+  if(keyframeCodes.size() % m_fernCount != 0)
+  {
+    throw std::invalid_argument("Error: The number of keyframe codes is not a multiple of the number of ferns");
+  }
+
+  // Replace the decisions.
+  std::copy(decisions.begin(), decisions.end(), m_decisionsMB->GetData(MEMORYDEVICE_CPU));
+  m_decisionsMB->UpdateDeviceFromHost();
+
+  // Discard the existing keyframes, make sure that there is enough space for the new ones, and then copy them across.
+  m_keyframeCount = 0;
+  const int keyframeCount = static_cast<int>(keyframeCodes.size() / m_fernCount);
+  while(static_cast<size_t>(keyframeCount * m_fernCount) > m_keyframeCodesMB->dataSize) grow_keyframe_codes();
+
+  if(keyframeCount > 0)
+  {
+    std::copy(keyframeCodes.begin(), keyframeCodes.end(), m_keyframeCodesMB->GetData(MEMORYDEVICE_CPU));
+    m_keyframeCodesMB->UpdateDeviceFromHost();
+  }
+
+  m_keyframeCount = keyframeCount;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void FernKeyframeDatabase::grow_keyframe_codes()
+{
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  const size_t newCapacity = m_dissimilaritiesMB->dataSize * 2;
+
+  // Make sure that the host copy of the existing codes is up to date, and copy it into a larger block.
+  boost::shared_ptr<ORUtils::MemoryBlock<char> > newKeyframeCodesMB = mbf.make_block<char>(newCapacity * m_fernCount, "FernKeyframeDatabase");
+  m_keyframeCodesMB->UpdateHostFromDevice();
+  memcpy(newKeyframeCodesMB->GetData(MEMORYDEVICE_CPU), m_keyframeCodesMB->GetData(MEMORYDEVICE_CPU), m_keyframeCount * m_fernCount * sizeof(char));
+  newKeyframeCodesMB->UpdateDeviceFromHost();
+
+  m_keyframeCodesMB = newKeyframeCodesMB;
+  m_dissimilaritiesMB = mbf.make_block<float>(newCapacity, "FernKeyframeDatabase");
+}
+
+}
@@ -0,0 +1,171 @@
+/**
+ * itmx: RGBDStreamSender.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifdef _MSC_VER
+  // Suppress some VC++ warnings that are produced by boost/asio.hpp.
+  #pragma warning(disable:4267 4996)
+#endif
+
+#include <boost/asio.hpp>
+
+#ifdef _MSC_VER
+  // Re-enable the VC++ warnings for the rest of the code.
+  #pragma warning(default:4267 4996)
+#endif
+
+#include "remote/RGBDStreamSender.h"
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace itmx {
+
+//#################### NESTED TYPES ####################
+
+struct RGBDStreamSender::Connection
+{
+  boost::asio::io_service ioService;
+  boost::asio::ip::tcp::socket socket;
+
+  Connection()
+  : socket(ioService)
+  {}
+};
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Writes a message (preceded by its header) to a socket.
+ *
+ * \param socket  The socket.
+ * \param message The message.
+ * \throws boost::system::system_error If the write fails.
+ */
+static void write_message(boost::asio::ip::tcp::socket& socket, const std::vector<unsigned char>& message)
+{
+  const std::vector<unsigned char> header = RGBDStreamUtil::make_message_header(message.size());
+
+  std::vector<boost::asio::const_buffer> buffers;
+  buffers.push_back(boost::asio::buffer(header));
+  buffers.push_back(boost::asio::buffer(message));
+  boost::asio::write(socket, buffers);
+}
+
+//#################### CONSTRUCTORS ####################
+
+RGBDStreamSender::RGBDStreamSender(const std::string& host, const std::string& port, const std::string& calibText,
+                                   const Vector2i& rgbImageSize, const Vector2i& depthImageSize,
+                                   PackedSequenceUtil::DepthCodec depthCodec)
+: m_connection(new Connection), m_depthCodec(depthCodec), m_droppedFrameCount(0), m_framePending(false), m_sentFrameCount(0), m_stopRequested(false)
+{
+  RGBDStreamUtil::StreamInfo info;
+  info.calibText = calibText;
+  info.depthImageSize = depthImageSize;
+  info.rgbImageSize = rgbImageSize;
+
+  std::vector<unsigned char> handshake;
+  RGBDStreamUtil::encode_handshake(info, handshake);
+
+  try
+  {
+    boost::asio::ip::tcp::resolver resolver(m_connection->ioService);
+    boost::asio::connect(m_connection->socket, resolver.resolve(boost::asio::ip::tcp::resolver::query(host, port)));
+
+    // Frames are sent as soon as they are available, so Nagle's algorithm would only add latency.
+    m_connection->socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+    write_message(m_connection->socket, handshake);
+  }
+  catch(boost::system::system_error& e)
+  {
+    throw std::runtime_error("Error: Could not connect to RGB-D stream receiver at " + host + ":" + port + " (" + e.what() + ")");
+  }
+
+  m_worker = boost::thread(boost::bind(&RGBDStreamSender::run_worker, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+RGBDStreamSender::~RGBDStreamSender()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_stopRequested = true;
+  }
+  m_pendingFrameReady.notify_one();
+
+  // Unblock the worker if it is in the middle of a write.
+  boost::system::error_code err;
+  m_connection->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, err);
+
+  m_worker.join();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t RGBDStreamSender::get_dropped_frame_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_droppedFrameCount;
+}
+
+size_t RGBDStreamSender::get_sent_frame_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_sentFrameCount;
+}
+
+void RGBDStreamSender::send_frame(const ORUtils::Image<Vector4u> *rgbImage, const ORUtils::Image<short> *depthImage)
+{
+  // Encode the frame outside the lock, so that the worker can keep sending the previous frame in the meantime.
+  RGBDStreamUtil::encode_frame(*rgbImage, *depthImage, m_depthCodec, m_frameBuffer);
+
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(!m_error.empty()) throw std::runtime_error(m_error);
+
+    if(m_framePending) ++m_droppedFrameCount;
+    m_pendingFrame.swap(m_frameBuffer);
+    m_framePending = true;
+  }
+
+  m_pendingFrameReady.notify_one();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void RGBDStreamSender::run_worker()
+{
+  std::vector<unsigned char> frame;
+
+  for(;;)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(!m_framePending && !m_stopRequested) m_pendingFrameReady.wait(lock);
+      if(m_stopRequested) return;
+
+      frame.swap(m_pendingFrame);
+      m_framePending = false;
+    }
+
+    try
+    {
+      write_message(m_connection->socket, frame);
+    }
+    catch(boost::system::system_error& e)
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_error = std::string("Error: Lost connection to RGB-D stream receiver (") + e.what() + ")";
+      return;
+    }
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    ++m_sentFrameCount;
+  }
+}
+
+}
@@ -0,0 +1,152 @@
+/**
+ * itmx: RGBDStreamUtil.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "remote/RGBDStreamUtil.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace itmx {
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Reads a little-endian 32-bit unsigned integer from a message, advancing the read position past it.
+ *
+ * \param p                   The read position.
+ * \param end                 The end of the message.
+ * \return                    The integer.
+ * \throws std::runtime_error If the message ends before the integer does.
+ */
+static unsigned int read_uint32(const unsigned char *& p, const unsigned char *end)
+{
+  if(end - p < 4) throw std::runtime_error("Error: RGB-D stream message is truncated");
+  const unsigned int value = PackedSequenceUtil::read_uint32(p);
+  p += 4;
+  return value;
+}
+
+/**
+ * \brief Reads the header of an encoded image from a frame message, advancing the read position to the start of its data.
+ *
+ * \param p                   The read position.
+ * \param end                 The end of the message.
+ * \param expectedSize        The expected size of the image.
+ * \param codec               A place into which to write the codec with which the image was encoded.
+ * \param encodedSize         A place into which to write the size (in bytes) of the encoded data.
+ * \throws std::runtime_error If the header is corrupt, or the image is not of the expected size.
+ */
+static void read_image_header(const unsigned char *& p, const unsigned char *end, const Vector2i& expectedSize, int& codec, size_t& encodedSize)
+{
+  const int width = static_cast<int>(read_uint32(p, end));
+  const int height = static_cast<int>(read_uint32(p, end));
+  codec = static_cast<int>(read_uint32(p, end));
+  encodedSize = read_uint32(p, end);
+
+  if(width != expectedSize.x || height != expectedSize.y) throw std::runtime_error("Error: RGB-D stream image is not of the expected size");
+  if(static_cast<size_t>(end - p) < encodedSize) throw std::runtime_error("Error: RGB-D stream message is truncated");
+}
+
+//#################### PUBLIC STATIC VARIABLES ####################
+
+const char *RGBDStreamUtil::HANDSHAKE_SIGNATURE = "SPTRGBD1";
+const size_t RGBDStreamUtil::MAX_MESSAGE_SIZE;
+const size_t RGBDStreamUtil::MESSAGE_HEADER_SIZE;
+const size_t RGBDStreamUtil::SIGNATURE_SIZE;
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+void RGBDStreamUtil::decode_frame(const std::vector<unsigned char>& message, ORUtils::Image<Vector4u>& rgbImage, ORUtils::Image<short>& depthImage)
+{
+  if(message.empty()) throw std::runtime_error("Error: RGB-D stream message is truncated");
+  const unsigned char *p = &message[0], *end = p + message.size();
+
+  int codec;
+  size_t encodedSize;
+
+  read_image_header(p, end, depthImage.noDims, codec, encodedSize);
+  PackedSequenceUtil::decode_depth(codec, p, encodedSize, depthImage);
+  p += encodedSize;
+
+  read_image_header(p, end, rgbImage.noDims, codec, encodedSize);
+  PackedSequenceUtil::decode_rgb(codec, p, encodedSize, rgbImage);
+  p += encodedSize;
+
+  if(p != end) throw std::runtime_error("Error: RGB-D stream frame message has trailing data");
+}
+
+RGBDStreamUtil::StreamInfo RGBDStreamUtil::decode_handshake(const std::vector<unsigned char>& message)
+{
+  if(message.size() < SIGNATURE_SIZE || memcmp(&message[0], HANDSHAKE_SIGNATURE, SIGNATURE_SIZE) != 0)
+  {
+    throw std::runtime_error("Error: RGB-D stream handshake has the wrong signature");
+  }
+
+  const unsigned char *p = &message[0] + SIGNATURE_SIZE, *end = &message[0] + message.size();
+
+  StreamInfo info;
+  info.rgbImageSize.x = static_cast<int>(read_uint32(p, end));
+  info.rgbImageSize.y = static_cast<int>(read_uint32(p, end));
+  info.depthImageSize.x = static_cast<int>(read_uint32(p, end));
+  info.depthImageSize.y = static_cast<int>(read_uint32(p, end));
+
+  const size_t calibTextSize = read_uint32(p, end);
+  if(static_cast<size_t>(end - p) != calibTextSize) throw std::runtime_error("Error: RGB-D stream handshake is corrupt");
+  info.calibText.assign(reinterpret_cast<const char *>(p), calibTextSize);
+
+  return info;
+}
+
+void RGBDStreamUtil::encode_frame(const ORUtils::Image<Vector4u>& rgbImage, const ORUtils::Image<short>& depthImage,
+                                  PackedSequenceUtil::DepthCodec depthCodec, std::vector<unsigned char>& message)
+{
+  message.clear();
+
+  // Encode the depth image straight into the message after its header, and then go back and fill in its encoded size.
+  PackedSequenceUtil::write_uint32(depthImage.noDims.x, message);
+  PackedSequenceUtil::write_uint32(depthImage.noDims.y, message);
+  PackedSequenceUtil::write_uint32(depthCodec, message);
+  const size_t sizeOffset = message.size();
+  PackedSequenceUtil::write_uint32(0, message);
+  PackedSequenceUtil::encode_depth(depthCodec, depthImage, message);
+
+  std::vector<unsigned char> size;
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(message.size() - sizeOffset - 4), size);
+  std::copy(size.begin(), size.end(), message.begin() + sizeOffset);
+
+  PackedSequenceUtil::write_uint32(rgbImage.noDims.x, message);
+  PackedSequenceUtil::write_uint32(rgbImage.noDims.y, message);
+  PackedSequenceUtil::write_uint32(PackedSequenceUtil::RC_RGB, message);
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(rgbImage.dataSize * 3), message);
+  PackedSequenceUtil::encode_rgb(PackedSequenceUtil::RC_RGB, rgbImage, message);
+}
+
+void RGBDStreamUtil::encode_handshake(const StreamInfo& info, std::vector<unsigned char>& message)
+{
+  message.assign(HANDSHAKE_SIGNATURE, HANDSHAKE_SIGNATURE + SIGNATURE_SIZE);
+  PackedSequenceUtil::write_uint32(info.rgbImageSize.x, message);
+  PackedSequenceUtil::write_uint32(info.rgbImageSize.y, message);
+  PackedSequenceUtil::write_uint32(info.depthImageSize.x, message);
+  PackedSequenceUtil::write_uint32(info.depthImageSize.y, message);
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(info.calibText.size()), message);
+  message.insert(message.end(), info.calibText.begin(), info.calibText.end());
+}
+
+std::vector<unsigned char> RGBDStreamUtil::make_message_header(size_t messageSize)
+{
+  std::vector<unsigned char> header;
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(messageSize), header);
+  return header;
+}
+
+size_t RGBDStreamUtil::read_message_size(const unsigned char *header)
+{
+  const size_t messageSize = PackedSequenceUtil::read_uint32(header);
+  if(messageSize > MAX_MESSAGE_SIZE) throw std::runtime_error("Error: RGB-D stream message is too large");
+  return messageSize;
+}
+
+}
@@ -0,0 +1,394 @@
+/**
+ * itmx: RemoteViewServer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifdef _MSC_VER
+  // Suppress some VC++ warnings that are produced by boost/asio.hpp.
+  #pragma warning(disable:4267 4996)
+#endif
+
+#include <boost/asio.hpp>
+
+#ifdef _MSC_VER
+  // Re-enable the VC++ warnings for the rest of the code.
+  #pragma warning(default:4267 4996)
+#endif
+
+#include "remote/RemoteViewServer.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <lodepng.h>
+
+#include "persistence/PackedSequenceUtil.h"
+#include "remote/RGBDStreamUtil.h"
+
+namespace itmx {
+
+//#################### NESTED TYPES ####################
+
+struct RemoteViewServer::Connection
+{
+  boost::asio::io_service ioService;
+  boost::asio::ip::tcp::acceptor acceptor;
+
+  explicit Connection(unsigned short port)
+  : acceptor(ioService, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port))
+  {}
+};
+
+struct RemoteViewServer::Viewer
+{
+  /** Whether or not the viewer has disconnected (or is being disconnected). */
+  bool closed;
+
+  /** The encoded frames that are waiting to be sent to the viewer, indexed by view (each is a complete message, header included). */
+  std::map<size_t,boost::shared_ptr<const std::vector<unsigned char> > > pendingFrames;
+
+  /** A condition variable used to wake the writer thread when there is a frame to send. */
+  boost::condition_variable pendingFramesReady;
+
+  /** The synchronisation mutex. */
+  boost::mutex mutex;
+
+  /** The thread on which input events are received from the viewer. */
+  boost::thread reader;
+
+  /** The socket connected to the viewer. */
+  boost::asio::ip::tcp::socket socket;
+
+  /** The thread on which frames are sent to the viewer. */
+  boost::thread writer;
+
+  explicit Viewer(boost::asio::io_service& ioService)
+  : closed(false), socket(ioService)
+  {}
+
+  /** Disconnects the viewer, unblocking its reader and writer threads. */
+  void close()
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+      closed = true;
+    }
+    pendingFramesReady.notify_one();
+
+    boost::system::error_code err;
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, err);
+  }
+
+  /** Waits for the viewer's threads to finish (the viewer must already have been closed). */
+  void join()
+  {
+    reader.join();
+    writer.join();
+  }
+};
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Encodes a frame of a view as a complete message (header included).
+ *
+ * \param viewIndex The index of the view.
+ * \param image     The image of the view.
+ * \param codec     The codec with which to encode the image.
+ * \return          The message.
+ */
+static boost::shared_ptr<const std::vector<unsigned char> > encode_view_frame(size_t viewIndex, const ITMUChar4Image& image, RemoteViewServer::ViewCodec codec)
+{
+  // Strip the alpha channel, since the viewers have no use for it.
+  const int pixelCount = static_cast<int>(image.dataSize);
+  const Vector4u *src = image.GetData(MEMORYDEVICE_CPU);
+  std::vector<unsigned char> rgb(pixelCount * 3);
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    rgb[i * 3] = src[i].r;
+    rgb[i * 3 + 1] = src[i].g;
+    rgb[i * 3 + 2] = src[i].b;
+  }
+
+  std::vector<unsigned char> encoded;
+  if(codec == RemoteViewServer::VC_PNG) lodepng::encode(encoded, rgb, image.noDims.x, image.noDims.y, LCT_RGB);
+  else encoded.swap(rgb);
+
+  // Leave space for the message header at the start, and then go back and fill it in once the size of the message is known.
+  boost::shared_ptr<std::vector<unsigned char> > message(new std::vector<unsigned char>(RGBDStreamUtil::MESSAGE_HEADER_SIZE));
+  PackedSequenceUtil::write_uint32(RemoteViewServer::MT_VIEW_FRAME, *message);
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(viewIndex), *message);
+  PackedSequenceUtil::write_uint32(image.noDims.x, *message);
+  PackedSequenceUtil::write_uint32(image.noDims.y, *message);
+  PackedSequenceUtil::write_uint32(codec, *message);
+  PackedSequenceUtil::write_uint32(static_cast<unsigned int>(encoded.size()), *message);
+  message->insert(message->end(), encoded.begin(), encoded.end());
+
+  const std::vector<unsigned char> header = RGBDStreamUtil::make_message_header(message->size() - RGBDStreamUtil::MESSAGE_HEADER_SIZE);
+  std::copy(header.begin(), header.end(), message->begin());
+
+  return message;
+}
+
+/**
+ * \brief Reads a message (preceded by its header) from a socket.
+ *
+ * \param socket                      The socket.
+ * \param message                     The buffer into which to read the message (any previous contents are discarded).
+ * \throws boost::system::system_error If the read fails.
+ * \throws std::runtime_error          If the message would be larger than the maximum acceptable size.
+ */
+static void read_message(boost::asio::ip::tcp::socket& socket, std::vector<unsigned char>& message)
+{
+  unsigned char header[RGBDStreamUtil::MESSAGE_HEADER_SIZE];
+  boost::asio::read(socket, boost::asio::buffer(header, sizeof(header)));
+
+  message.resize(RGBDStreamUtil::read_message_size(header));
+  if(!message.empty()) boost::asio::read(socket, boost::asio::buffer(message));
+}
+
+/**
+ * \brief Reads a little-endian 32-bit float from the specified location.
+ *
+ * \param p The location.
+ * \return  The float.
+ */
+static float read_float(const unsigned char *p)
+{
+  const unsigned int bits = PackedSequenceUtil::read_uint32(p);
+  float value;
+  memcpy(&value, &bits, sizeof(float));
+  return value;
+}
+
+/**
+ * \brief Runs an I/O service until it is stopped.
+ *
+ * \param ioService The I/O service.
+ */
+static void run_io_service(boost::asio::io_service *ioService)
+{
+  ioService->run();
+}
+
+//#################### CONSTRUCTORS ####################
+
+RemoteViewServer::RemoteViewServer(unsigned short port, ViewCodec codec)
+: m_codec(codec), m_stopRequested(false)
+{
+  try
+  {
+    m_connection.reset(new Connection(port));
+  }
+  catch(boost::system::system_error& e)
+  {
+    throw std::runtime_error("Error: Could not listen for remote viewers on port " + boost::lexical_cast<std::string>(port) + " (" + e.what() + ")");
+  }
+
+  accept_next_viewer();
+  m_acceptor = boost::thread(boost::bind(&run_io_service, &m_connection->ioService));
+  m_encoder = boost::thread(boost::bind(&RemoteViewServer::run_encoder, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+RemoteViewServer::~RemoteViewServer()
+{
+  // Stop accepting new viewers.
+  m_connection->ioService.stop();
+  m_acceptor.join();
+
+  // Stop the encoder.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_stopRequested = true;
+  }
+  m_pendingViewsReady.notify_one();
+  m_encoder.join();
+
+  // Disconnect the viewers.
+  for(size_t i = 0, size = m_viewers.size(); i < size; ++i)
+  {
+    m_viewers[i]->close();
+    m_viewers[i]->join();
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t RemoteViewServer::get_viewer_count()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_viewers.size();
+}
+
+void RemoteViewServer::publish_view(size_t viewIndex, const ITMUChar4Image_CPtr& image)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    // If nobody is watching, avoid the cost of encoding the view.
+    if(m_viewers.empty()) return;
+
+    m_pendingViews[viewIndex] = image;
+  }
+
+  m_pendingViewsReady.notify_one();
+}
+
+std::vector<RemoteViewServer::InputEvent> RemoteViewServer::take_input_events()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  std::vector<InputEvent> events(m_inputEvents.begin(), m_inputEvents.end());
+  m_inputEvents.clear();
+  return events;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void RemoteViewServer::accept_next_viewer()
+{
+  Viewer_Ptr viewer(new Viewer(m_connection->ioService));
+  m_connection->acceptor.async_accept(viewer->socket, boost::bind(&RemoteViewServer::handle_accept, this, viewer, boost::asio::placeholders::error));
+}
+
+void RemoteViewServer::handle_accept(const Viewer_Ptr& viewer, const boost::system::error_code& err)
+{
+  if(!err)
+  {
+    boost::system::error_code ignored;
+    viewer->socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+
+    viewer->reader = boost::thread(boost::bind(&RemoteViewServer::run_viewer_reader, this, viewer));
+    viewer->writer = boost::thread(boost::bind(&RemoteViewServer::run_viewer_writer, viewer));
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_viewers.push_back(viewer);
+    std::cout << "[itmx] Remote viewer connected (" << m_viewers.size() << " connected)\n";
+  }
+  else if(err == boost::asio::error::operation_aborted) return;
+
+  accept_next_viewer();
+}
+
+void RemoteViewServer::run_encoder()
+{
+  std::map<size_t,ITMUChar4Image_CPtr> views;
+  std::vector<Viewer_Ptr> viewers, closedViewers;
+
+  for(;;)
+  {
+    // Wait for some views to be published, and then take them, together with a snapshot of the viewers that are still connected.
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(m_pendingViews.empty() && !m_stopRequested) m_pendingViewsReady.wait(lock);
+      if(m_stopRequested) return;
+
+      views.swap(m_pendingViews);
+
+      viewers.clear();
+      for(size_t i = 0, size = m_viewers.size(); i < size; ++i)
+      {
+        boost::lock_guard<boost::mutex> viewerLock(m_viewers[i]->mutex);
+        if(m_viewers[i]->closed) closedViewers.push_back(m_viewers[i]);
+        else viewers.push_back(m_viewers[i]);
+      }
+      m_viewers = viewers;
+    }
+
+    // Reap any viewers that have disconnected.
+    for(size_t i = 0, size = closedViewers.size(); i < size; ++i)
+    {
+      closedViewers[i]->join();
+    }
+    closedViewers.clear();
+
+    // Encode each view once, and pass the encoded frame to every viewer (replacing any older frame of the view that it has yet to send).
+    for(std::map<size_t,ITMUChar4Image_CPtr>::const_iterator it = views.begin(), iend = views.end(); it != iend; ++it)
+    {
+      boost::shared_ptr<const std::vector<unsigned char> > frame = encode_view_frame(it->first, *it->second, m_codec);
+
+      for(size_t i = 0, size = viewers.size(); i < size; ++i)
+      {
+        {
+          boost::lock_guard<boost::mutex> viewerLock(viewers[i]->mutex);
+          viewers[i]->pendingFrames[it->first] = frame;
+        }
+        viewers[i]->pendingFramesReady.notify_one();
+      }
+    }
+
+    views.clear();
+  }
+}
+
+void RemoteViewServer::run_viewer_reader(const Viewer_Ptr& viewer)
+{
+  const size_t inputEventMessageSize = 6 * sizeof(unsigned int);
+  std::vector<unsigned char> message;
+
+  try
+  {
+    for(;;)
+    {
+      read_message(viewer->socket, message);
+
+      // Ignore any messages that are not well-formed input events.
+      if(message.size() != inputEventMessageSize || PackedSequenceUtil::read_uint32(&message[0]) != MT_INPUT_EVENT) continue;
+
+      InputEvent event;
+      event.type = static_cast<InputEventType>(PackedSequenceUtil::read_uint32(&message[4]));
+      event.code = static_cast<int>(PackedSequenceUtil::read_uint32(&message[8]));
+      event.viewIndex = PackedSequenceUtil::read_uint32(&message[12]);
+      event.fracPos.x = read_float(&message[16]);
+      event.fracPos.y = read_float(&message[20]);
+      if(event.type > IET_MOUSE_MOVE) continue;
+
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_inputEvents.push_back(event);
+    }
+  }
+  catch(std::exception&)
+  {
+    // The viewer has disconnected (or sent something invalid), so disconnect it.
+  }
+
+  viewer->close();
+}
+
+void RemoteViewServer::run_viewer_writer(const Viewer_Ptr& viewer)
+{
+  std::map<size_t,boost::shared_ptr<const std::vector<unsigned char> > > frames;
+
+  try
+  {
+    for(;;)
+    {
+      {
+        boost::unique_lock<boost::mutex> lock(viewer->mutex);
+        while(viewer->pendingFrames.empty() && !viewer->closed) viewer->pendingFramesReady.wait(lock);
+        if(viewer->closed) return;
+        frames.swap(viewer->pendingFrames);
+      }
+
+      for(std::map<size_t,boost::shared_ptr<const std::vector<unsigned char> > >::const_iterator it = frames.begin(), iend = frames.end(); it != iend; ++it)
+      {
+        boost::asio::write(viewer->socket, boost::asio::buffer(*it->second));
+      }
+
+      frames.clear();
+    }
+  }
+  catch(boost::system::system_error&)
+  {
+    // The viewer has disconnected, so disconnect it.
+  }
+
+  viewer->close();
+}
+
+}
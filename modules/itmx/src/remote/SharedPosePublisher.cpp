@@ -0,0 +1,145 @@
+/**
+ * itmx: SharedPosePublisher.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "remote/SharedPosePublisher.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+namespace bip = boost::interprocess;
+
+namespace itmx {
+
+//#################### NESTED TYPES ####################
+
+struct SharedPosePublisher::Segment
+{
+  bip::shared_memory_object memory;
+  bip::mapped_region region;
+};
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Converts a time point on the steady clock to a number of microseconds since the clock's epoch.
+ *
+ * \param t The time point.
+ * \return  The number of microseconds since the clock's epoch.
+ */
+static boost::int64_t to_micros(const SharedPosePublisher::Clock::time_point& t)
+{
+  return boost::chrono::duration_cast<boost::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+//#################### CONSTRUCTORS ####################
+
+SharedPosePublisher::SharedPosePublisher(const std::string& name, const Vector2i& imageSize)
+: m_name(name), m_segment(new Segment)
+{
+  try
+  {
+    // Replace any channel left behind by a previous run (e.g. one that crashed before it could remove its channel).
+    bip::shared_memory_object::remove(name.c_str());
+
+    bip::shared_memory_object(bip::create_only, name.c_str(), bip::read_write).swap(m_segment->memory);
+    m_segment->memory.truncate(SharedPoseChannel::size(imageSize.x, imageSize.y));
+    bip::mapped_region(m_segment->memory, bip::read_write).swap(m_segment->region);
+  }
+  catch(bip::interprocess_exception& e)
+  {
+    throw std::runtime_error("Error: Could not create shared pose channel '" + name + "': " + e.what());
+  }
+
+  // Construct the header and the slots in place. The magic number is written last, so that a reader that opens
+  // the channel whilst it is being set up will not mistake it for a valid channel.
+  char *base = static_cast<char*>(m_segment->region.get_address());
+  m_header = new (base) SharedPoseChannel::Header;
+  m_header->imageCaptureTime = 0;
+  m_header->imageHeight = imageSize.y;
+  m_header->imageSequence.store(0, boost::memory_order_relaxed);
+  m_header->imageWidth = imageSize.x;
+  m_header->recordCount.store(0, boost::memory_order_relaxed);
+  m_header->version = SharedPoseChannel::VERSION;
+
+  SharedPoseChannel::PoseSlot *slots = reinterpret_cast<SharedPoseChannel::PoseSlot*>(base + sizeof(SharedPoseChannel::Header));
+  for(size_t i = 0; i < SharedPoseChannel::SLOT_COUNT; ++i)
+  {
+    new (&slots[i]) SharedPoseChannel::PoseSlot;
+    slots[i].sequence.store(0, boost::memory_order_relaxed);
+  }
+
+  m_header->magic.store(SharedPoseChannel::MAGIC, boost::memory_order_release);
+}
+
+//#################### DESTRUCTOR ####################
+
+SharedPosePublisher::~SharedPosePublisher()
+{
+  bip::shared_memory_object::remove(m_name.c_str());
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+const std::string& SharedPosePublisher::get_name() const
+{
+  return m_name;
+}
+
+size_t SharedPosePublisher::get_published_pose_count() const
+{
+  return static_cast<size_t>(m_header->recordCount.load(boost::memory_order_relaxed));
+}
+
+bool SharedPosePublisher::has_image() const
+{
+  return m_header->imageWidth > 0 && m_header->imageHeight > 0;
+}
+
+void SharedPosePublisher::publish_image(const ORUtils::Image<Vector4f> *image, const Clock::time_point& captureTime)
+{
+  if(image->noDims.x != m_header->imageWidth || image->noDims.y != m_header->imageHeight)
+  {
+    throw std::invalid_argument("Error: The size of the image does not match the image size of the shared pose channel");
+  }
+
+  char *base = static_cast<char*>(m_segment->region.get_address());
+  const boost::uint64_t sequence = m_header->imageSequence.load(boost::memory_order_relaxed);
+
+  // Mark the image as being written, write it, and then mark it as written.
+  m_header->imageSequence.store(sequence + 1, boost::memory_order_relaxed);
+  boost::atomic_thread_fence(boost::memory_order_release);
+
+  m_header->imageCaptureTime = to_micros(captureTime);
+  memcpy(base + SharedPoseChannel::image_offset(), image->GetData(MEMORYDEVICE_CPU), image->dataSize * sizeof(Vector4f));
+
+  m_header->imageSequence.store(sequence + 2, boost::memory_order_release);
+}
+
+void SharedPosePublisher::publish_pose(const ORUtils::SE3Pose& pose, const Clock::time_point& captureTime, size_t frameIndex, int trackingQuality)
+{
+  char *base = static_cast<char*>(m_segment->region.get_address());
+  SharedPoseChannel::PoseSlot *slots = reinterpret_cast<SharedPoseChannel::PoseSlot*>(base + sizeof(SharedPoseChannel::Header));
+
+  const boost::uint64_t recordIndex = m_header->recordCount.load(boost::memory_order_relaxed);
+  SharedPoseChannel::PoseSlot& slot = slots[recordIndex % SharedPoseChannel::SLOT_COUNT];
+
+  // Mark the slot as being written, write the record, and then mark the slot as holding the record.
+  slot.sequence.store(2 * recordIndex + 1, boost::memory_order_relaxed);
+  boost::atomic_thread_fence(boost::memory_order_release);
+
+  SharedPoseChannel::PoseRecord& record = slot.record;
+  record.captureTime = to_micros(captureTime);
+  record.frameIndex = frameIndex;
+  memcpy(record.pose, pose.GetM().m, sizeof(record.pose));
+  record.trackingQuality = trackingQuality;
+
+  slot.sequence.store(2 * (recordIndex + 1), boost::memory_order_release);
+  m_header->recordCount.store(recordIndex + 1, boost::memory_order_release);
+}
+
+}
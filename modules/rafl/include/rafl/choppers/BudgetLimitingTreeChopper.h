@@ -0,0 +1,175 @@
+/**
+ * rafl: BudgetLimitingTreeChopper.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_RAFL_BUDGETLIMITINGTREECHOPPER
+#define H_RAFL_BUDGETLIMITINGTREECHOPPER
+
+#include "TreeChopper.h"
+
+namespace rafl {
+
+/**
+ * \brief An instance of this class represents a tree chopper that keeps a forest within a memory and node budget.
+ *
+ * Whenever the forest's (approximate) memory usage or total node count exceeds the budget, the chopper picks a tree to chop.
+ * The node count is used as a proxy for the cost of prediction and training, which grows with the size of the trees even when
+ * their memory usage is within budget. If the forest is within the budget, the chopper leaves it unchanged.
+ *
+ * When choosing the tree to chop, the chopper prefers the tree whose removal would lose the least accuracy. Since the trees
+ * in a rafl forest are all trained on all of the examples (there is no bagging), there are no true out-of-bag examples, so the
+ * accuracy is instead estimated on a set of held-out validation examples supplied by the caller (e.g. examples from recent frames
+ * that were not added to the forest). For each tree, the chopper compares the accuracy of the whole forest on these examples with
+ * the accuracy of the forest without the tree. Ties (and the case in which no validation examples have been supplied) are broken
+ * in favour of chopping the tree that uses the most memory.
+ */
+template <typename Label>
+class BudgetLimitingTreeChopper : public TreeChopper<Label>
+{
+  //#################### TYPEDEFS AND USINGS ####################
+private:
+  using typename TreeChopper<Label>::RF_CPtr;
+  typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The maximum (approximate) number of bytes of storage that the forest may use before one of its trees becomes liable to be chopped. */
+  size_t m_maxMemoryUsage;
+
+  /** The maximum total number of nodes that the forest may contain before one of its trees becomes liable to be chopped. */
+  size_t m_maxNodeCount;
+
+  /** The held-out examples on which to estimate the accuracy lost by chopping each tree. */
+  std::vector<Example_CPtr> m_validationExamples;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a budget-limiting tree chopper.
+   *
+   * \param maxMemoryUsage  The maximum (approximate) number of bytes of storage that the forest may use before one of its trees becomes liable to be chopped.
+   * \param maxNodeCount    The maximum total number of nodes that the forest may contain before one of its trees becomes liable to be chopped.
+   */
+  BudgetLimitingTreeChopper(size_t maxMemoryUsage, size_t maxNodeCount)
+  : m_maxMemoryUsage(maxMemoryUsage), m_maxNodeCount(maxNodeCount)
+  {}
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual boost::optional<size_t> choose_tree_to_chop(const RF_CPtr& forest) const
+  {
+    // If the forest is within the budget, leave it unchanged.
+    if(forest->get_memory_usage() <= m_maxMemoryUsage && forest->get_node_count() <= m_maxNodeCount) return boost::none;
+
+    // Otherwise, estimate the accuracy that would be lost by chopping each tree.
+    const size_t treeCount = forest->get_tree_count();
+    const std::vector<int> losses = calculate_accuracy_losses(forest);
+
+    // Choose the tree whose removal would lose the least accuracy, breaking ties in favour of the tree using the most memory.
+    // Trees that only have a root node are never chopped, since chopping them would not reduce the size of the forest.
+    boost::optional<size_t> result;
+    size_t bestMemoryUsage = 0;
+    for(size_t i = 0; i < treeCount; ++i)
+    {
+      if(forest->get_tree(i)->get_node_count() <= 1) continue;
+
+      const size_t memoryUsage = forest->get_tree(i)->get_memory_usage();
+      if(!result || losses[i] < losses[*result] || (losses[i] == losses[*result] && memoryUsage > bestMemoryUsage))
+      {
+        result = i;
+        bestMemoryUsage = memoryUsage;
+      }
+    }
+
+    return result;
+  }
+
+  /**
+   * \brief Sets the held-out examples on which to estimate the accuracy lost by chopping each tree.
+   *
+   * \param validationExamples  The held-out examples on which to estimate the accuracy lost by chopping each tree.
+   */
+  void set_validation_examples(const std::vector<Example_CPtr>& validationExamples)
+  {
+    m_validationExamples = validationExamples;
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Calculates, for each tree in the forest, how many fewer validation examples the forest would classify correctly without it.
+   *
+   * \param forest  The random forest.
+   * \return        The number of validation examples that would be lost by chopping each tree (negative if chopping it would help).
+   */
+  std::vector<int> calculate_accuracy_losses(const RF_CPtr& forest) const
+  {
+    const size_t treeCount = forest->get_tree_count();
+    std::vector<int> losses(treeCount, 0);
+    std::vector<std::map<Label,float> > treeMasses(treeCount);
+
+    for(typename std::vector<Example_CPtr>::const_iterator it = m_validationExamples.begin(), iend = m_validationExamples.end(); it != iend; ++it)
+    {
+      const Descriptor_CPtr& descriptor = (*it)->get_descriptor();
+      const Label& label = (*it)->get_label();
+
+      // Look up the PMF for the example in each tree, and sum the masses across the whole forest.
+      std::map<Label,float> forestMasses;
+      for(size_t i = 0; i < treeCount; ++i)
+      {
+        treeMasses[i] = forest->get_tree(i)->lookup_pmf(descriptor).get_masses();
+        for(typename std::map<Label,float>::const_iterator jt = treeMasses[i].begin(), jend = treeMasses[i].end(); jt != jend; ++jt)
+        {
+          forestMasses[jt->first] += jt->second;
+        }
+      }
+
+      // Compare the prediction of the whole forest with that of the forest without each tree in turn.
+      const bool forestCorrect = find_best_label(forestMasses, NULL) == label;
+      for(size_t i = 0; i < treeCount; ++i)
+      {
+        const bool reducedCorrect = find_best_label(forestMasses, &treeMasses[i]) == label;
+        losses[i] += static_cast<int>(forestCorrect) - static_cast<int>(reducedCorrect);
+      }
+    }
+
+    return losses;
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Finds the label with the largest mass in a set of summed masses, optionally after subtracting another set of masses.
+   *
+   * \param masses          The summed masses.
+   * \param excludedMasses  An optional set of masses to subtract from the summed masses (may be NULL).
+   * \return                The label with the largest (remaining) mass.
+   */
+  static Label find_best_label(const std::map<Label,float>& masses, const std::map<Label,float> *excludedMasses)
+  {
+    Label bestLabel = Label();
+    float bestMass = -1.0f;
+    for(typename std::map<Label,float>::const_iterator it = masses.begin(), iend = masses.end(); it != iend; ++it)
+    {
+      float mass = it->second;
+      if(excludedMasses)
+      {
+        typename std::map<Label,float>::const_iterator jt = excludedMasses->find(it->first);
+        if(jt != excludedMasses->end()) mass -= jt->second;
+      }
+
+      if(mass > bestMass)
+      {
+        bestLabel = it->first;
+        bestMass = mass;
+      }
+    }
+    return bestLabel;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,523 @@
+/**
+ * rafl: CompiledRandomForest.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#ifndef H_RAFL_COMPILEDRANDOMFOREST
+#define H_RAFL_COMPILEDRANDOMFOREST
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "RandomForest.h"
+
+namespace rafl {
+
+/**
+ * \brief An instance of an instantiation of this class template represents a read-only snapshot of a random forest
+ *        that has been compiled into a flat form for fast prediction.
+ *
+ * The nodes of all of the trees are stored in a single contiguous array, with the decision functions in flat form
+ * (see FlatDecisionFunction), and the PMF for each leaf is stored as a dense array of masses indexed by label.
+ * This allows labels to be predicted for large batches of descriptors without any heap allocation, which is much
+ * faster than calling RandomForest::predict (which builds several std::maps per descriptor). The labels predicted
+ * are the same as those that RandomForest::predict would predict at the time the snapshot was made.
+ *
+ * Since the snapshot does not change when the forest is subsequently trained, it must be recompiled to reflect
+ * any changes to the forest.
+ *
+ * A compiled forest can also be saved to (and loaded from) a compact, versioned binary file. Unlike a forest saved
+ * using Boost.Serialization, this contains only what is needed for inference (no example reservoirs, splittability
+ * queues or settings), and loading it simply reads a handful of contiguous arrays, so it is both much smaller and
+ * much faster to load. The file format is that of the machine on which it was saved (in practice, little-endian).
+ *
+ * \tparam Label  The type of label predicted by the forest. Must be an integral type, and all labels must be in [0,MAX_LABEL_COUNT).
+ */
+template <typename Label>
+class CompiledRandomForest
+{
+  //#################### CONSTANTS ####################
+public:
+  /** The maximum number of distinct labels supported (the labels must be in [0,MAX_LABEL_COUNT)). */
+  enum { MAX_LABEL_COUNT = 256 };
+
+  /** The version of the binary file format written by save(). */
+  enum { FILE_FORMAT_VERSION = 1 };
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents a node in the compiled forest.
+   */
+  struct Node
+  {
+    /** The index of the node's left child in the node array, or -1 if the node is a leaf. */
+    int leftChildIndex;
+
+    /** The index of the node's leaf PMF in the leaf masses array, if the node is a leaf, or -1 otherwise. */
+    int leafIndex;
+
+    /** The index of the node's right child in the node array, or -1 if the node is a leaf. */
+    int rightChildIndex;
+
+    /** The node's decision function, in flat form (only valid if the node is not a leaf). */
+    FlatDecisionFunction splitter;
+  };
+
+private:
+  /**
+   * \brief An instance of this struct represents a node as it is stored in a compiled forest file.
+   *
+   * All of the fields have fixed sizes, so that the layout does not depend on the compiler (unlike that of Node,
+   * which contains an enum).
+   */
+  struct FileNode
+  {
+    boost::int32_t leftChildIndex;
+    boost::int32_t leafIndex;
+    boost::int32_t rightChildIndex;
+    boost::uint32_t firstFeatureIndex;
+    boost::uint32_t op;
+    boost::uint32_t secondFeatureIndex;
+    float threshold;
+  };
+
+  //#################### PRIVATE STATIC CONSTANTS ####################
+private:
+  /** The signature with which every compiled forest file starts. */
+  static const char FILE_SIGNATURE[8];
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of labels for which masses are stored for each leaf (i.e. one more than the largest label in any leaf). */
+  size_t m_labelCount;
+
+  /** The masses of the leaf PMFs: the masses for leaf i are stored in [i * m_labelCount, (i + 1) * m_labelCount). */
+  std::vector<float> m_leafMasses;
+
+  /** The number of features that a descriptor must have in order to be evaluated by the forest. */
+  size_t m_minDescriptorSize;
+
+  /** The nodes of all of the trees in the forest. */
+  std::vector<Node> m_nodes;
+
+  /** The indices of the roots of the trees in the node array. */
+  std::vector<int> m_rootIndices;
+
+  //#################### CONSTRUCTORS ####################
+private:
+  /**
+   * \brief Constructs an empty compiled forest (used when loading a compiled forest from a file).
+   */
+  CompiledRandomForest()
+  : m_labelCount(1), m_minDescriptorSize(0)
+  {}
+
+public:
+  /**
+   * \brief Compiles a random forest.
+   *
+   * Note that any leaves that do not contain any examples (for which the forest itself would be unable to make a PMF)
+   * do not contribute to the predictions of the compiled forest.
+   *
+   * \param forest              The random forest to compile.
+   * \throws std::runtime_error If any of the labels in the forest's leaves are outside [0,MAX_LABEL_COUNT).
+   */
+  explicit CompiledRandomForest(const RandomForest<Label>& forest)
+  : m_labelCount(1), m_minDescriptorSize(0)
+  {
+    typedef boost::shared_ptr<const DecisionTree<Label> > DT_CPtr;
+    const size_t treeCount = forest.get_tree_count();
+
+    // Determine the number of labels for which masses need to be stored.
+    for(size_t i = 0; i < treeCount; ++i)
+    {
+      DT_CPtr tree = forest.get_tree(i);
+      for(int j = 0, nodeCount = static_cast<int>(tree->m_nodes.size()); j < nodeCount; ++j)
+      {
+        if(!tree->is_leaf(j)) continue;
+
+        const std::map<Label,size_t>& bins = tree->m_nodes[j].m_reservoir.get_histogram().get_bins();
+        for(typename std::map<Label,size_t>::const_iterator it = bins.begin(), iend = bins.end(); it != iend; ++it)
+        {
+          const long labelIndex = static_cast<long>(it->first);
+          if(labelIndex < 0 || labelIndex >= MAX_LABEL_COUNT) throw std::runtime_error("Error: Cannot compile a random forest with labels outside [0,MAX_LABEL_COUNT)");
+          m_labelCount = std::max(m_labelCount, static_cast<size_t>(labelIndex + 1));
+        }
+      }
+    }
+
+    // Compile the nodes of each tree in turn into the node array.
+    for(size_t i = 0; i < treeCount; ++i)
+    {
+      DT_CPtr tree = forest.get_tree(i);
+      const int nodeOffset = static_cast<int>(m_nodes.size());
+      m_rootIndices.push_back(nodeOffset + tree->m_rootIndex);
+
+      for(int j = 0, nodeCount = static_cast<int>(tree->m_nodes.size()); j < nodeCount; ++j)
+      {
+        Node node;
+
+        if(tree->is_leaf(j))
+        {
+          node.leftChildIndex = node.rightChildIndex = -1;
+          node.splitter = FlatDecisionFunction();
+          node.leafIndex = static_cast<int>(m_leafMasses.size() / m_labelCount);
+          m_leafMasses.resize(m_leafMasses.size() + m_labelCount, 0.0f);
+
+          // Copy the masses of the leaf's PMF (if it has one) into the leaf masses array.
+          if(tree->m_nodes[j].m_reservoir.get_histogram().get_count() > 0)
+          {
+            float *leafMasses = &m_leafMasses[node.leafIndex * m_labelCount];
+            const tvgutil::ProbabilityMassFunction<Label> pmf = tree->make_pmf(j);
+            const std::map<Label,float>& masses = pmf.get_masses();
+            for(typename std::map<Label,float>::const_iterator it = masses.begin(), iend = masses.end(); it != iend; ++it)
+            {
+              leafMasses[static_cast<size_t>(it->first)] = it->second;
+            }
+          }
+        }
+        else
+        {
+          node.leftChildIndex = nodeOffset + tree->m_nodes[j].m_leftChildIndex;
+          node.leafIndex = -1;
+          node.rightChildIndex = nodeOffset + tree->m_nodes[j].m_rightChildIndex;
+          node.splitter = tree->m_nodes[j].m_splitter->to_flat();
+          m_minDescriptorSize = std::max(m_minDescriptorSize, static_cast<size_t>(node.splitter.get_min_descriptor_size()));
+        }
+
+        m_nodes.push_back(node);
+      }
+    }
+  }
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Determines whether or not the specified file contains a compiled forest (in the format written by save()).
+   *
+   * \param path  The path to the file.
+   * \return      true, if the file exists and starts with the compiled forest file signature, or false otherwise.
+   */
+  static bool is_compiled_forest_file(const std::string& path)
+  {
+    std::ifstream fs(path.c_str(), std::ios::binary);
+    char signature[sizeof(FILE_SIGNATURE)];
+    return fs.read(signature, sizeof(signature)) && memcmp(signature, FILE_SIGNATURE, sizeof(signature)) == 0;
+  }
+
+  /**
+   * \brief Loads a compiled forest from a binary file written by save().
+   *
+   * \param path                The path to the file.
+   * \return                    The loaded forest.
+   * \throws std::runtime_error If the file cannot be read, is not a compiled forest file of a supported version, or is corrupt.
+   */
+  static boost::shared_ptr<CompiledRandomForest> load(const std::string& path)
+  {
+    std::ifstream fs(path.c_str(), std::ios::binary);
+    if(!fs) throw std::runtime_error("Error: Could not open compiled forest file '" + path + "'");
+
+    // Read and check the header.
+    char signature[sizeof(FILE_SIGNATURE)];
+    if(!fs.read(signature, sizeof(signature)) || memcmp(signature, FILE_SIGNATURE, sizeof(signature)) != 0)
+    {
+      throw std::runtime_error("Error: '" + path + "' is not a compiled forest file");
+    }
+
+    if(read_value<boost::uint32_t>(fs) != FILE_FORMAT_VERSION)
+    {
+      throw std::runtime_error("Error: '" + path + "' was saved using an unsupported version of the compiled forest file format");
+    }
+
+    boost::shared_ptr<CompiledRandomForest> forest(new CompiledRandomForest);
+    forest->m_labelCount = read_value<boost::uint32_t>(fs);
+    forest->m_minDescriptorSize = read_value<boost::uint32_t>(fs);
+    const boost::uint32_t nodeCount = read_value<boost::uint32_t>(fs);
+    const boost::uint32_t rootCount = read_value<boost::uint32_t>(fs);
+    const boost::uint32_t leafCount = read_value<boost::uint32_t>(fs);
+    if(!fs || forest->m_labelCount == 0 || forest->m_labelCount > MAX_LABEL_COUNT)
+    {
+      throw std::runtime_error("Error: The header of compiled forest file '" + path + "' is corrupt");
+    }
+
+    // Read the arrays.
+    std::vector<FileNode> fileNodes(nodeCount);
+    forest->m_rootIndices.resize(rootCount);
+    forest->m_leafMasses.resize(static_cast<size_t>(leafCount) * forest->m_labelCount);
+    read_array(fs, fileNodes);
+    read_array(fs, forest->m_rootIndices);
+    read_array(fs, forest->m_leafMasses);
+    if(!fs) throw std::runtime_error("Error: Compiled forest file '" + path + "' is truncated");
+
+    // Convert the nodes to their in-memory form, checking that all of the indices are in range as we go.
+    const int nodeCountI = static_cast<int>(nodeCount), leafCountI = static_cast<int>(leafCount);
+    forest->m_nodes.resize(nodeCount);
+    for(size_t i = 0; i < nodeCount; ++i)
+    {
+      const FileNode& fileNode = fileNodes[i];
+      Node& node = forest->m_nodes[i];
+      node.leftChildIndex = fileNode.leftChildIndex;
+      node.leafIndex = fileNode.leafIndex;
+      node.rightChildIndex = fileNode.rightChildIndex;
+      node.splitter.firstFeatureIndex = fileNode.firstFeatureIndex;
+      node.splitter.op = static_cast<FlatDecisionFunction::Op>(fileNode.op);
+      node.splitter.secondFeatureIndex = fileNode.secondFeatureIndex;
+      node.splitter.threshold = fileNode.threshold;
+
+      bool valid;
+      if(node.leafIndex == -1)
+      {
+        valid = node.leftChildIndex >= 0 && node.leftChildIndex < nodeCountI && node.rightChildIndex >= 0 && node.rightChildIndex < nodeCountI &&
+                fileNode.op <= FlatDecisionFunction::FO_SUBTRACT && node.splitter.get_min_descriptor_size() <= forest->m_minDescriptorSize;
+      }
+      else valid = node.leafIndex >= 0 && node.leafIndex < leafCountI;
+
+      if(!valid) throw std::runtime_error("Error: Compiled forest file '" + path + "' is corrupt");
+    }
+
+    for(size_t i = 0; i < rootCount; ++i)
+    {
+      if(forest->m_rootIndices[i] < 0 || forest->m_rootIndices[i] >= nodeCountI)
+      {
+        throw std::runtime_error("Error: Compiled forest file '" + path + "' is corrupt");
+      }
+    }
+
+    return forest;
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the number of labels for which masses are stored for each leaf.
+   *
+   * \return  The number of labels for which masses are stored for each leaf (one more than the largest label in any leaf).
+   */
+  size_t get_label_count() const
+  {
+    return m_labelCount;
+  }
+
+  /**
+   * \brief Gets the masses of the leaf PMFs.
+   *
+   * \return  The masses of the leaf PMFs (the masses for leaf i are stored in [i * get_label_count(), (i + 1) * get_label_count())).
+   */
+  const std::vector<float>& get_leaf_masses() const
+  {
+    return m_leafMasses;
+  }
+
+  /**
+   * \brief Gets the number of features that a descriptor must have in order to be evaluated by the forest.
+   *
+   * \return  The number of features that a descriptor must have in order to be evaluated by the forest.
+   */
+  size_t get_min_descriptor_size() const
+  {
+    return m_minDescriptorSize;
+  }
+
+  /**
+   * \brief Gets the nodes of all of the trees in the forest.
+   *
+   * \return  The nodes of all of the trees in the forest.
+   */
+  const std::vector<Node>& get_nodes() const
+  {
+    return m_nodes;
+  }
+
+  /**
+   * \brief Gets the indices of the roots of the trees in the node array.
+   *
+   * \return  The indices of the roots of the trees in the node array.
+   */
+  const std::vector<int>& get_root_indices() const
+  {
+    return m_rootIndices;
+  }
+
+  /**
+   * \brief Predicts a label for the specified descriptor.
+   *
+   * \pre The descriptor must have at least get_min_descriptor_size() features.
+   *
+   * \param descriptor  A pointer to the features of the descriptor.
+   * \return            The predicted label.
+   */
+  Label predict(const float *descriptor) const
+  {
+    // Sum the masses from the PMFs of the leaves reached in the individual trees.
+    float masses[MAX_LABEL_COUNT];
+    std::fill(masses, masses + m_labelCount, 0.0f);
+
+    for(size_t i = 0, treeCount = m_rootIndices.size(); i < treeCount; ++i)
+    {
+      const float *leafMasses = &m_leafMasses[find_leaf(m_rootIndices[i], descriptor) * m_labelCount];
+      for(size_t k = 0; k < m_labelCount; ++k)
+      {
+        masses[k] += leafMasses[k];
+      }
+    }
+
+    // Find the label with the largest summed mass. As with ProbabilityMassFunction::calculate_best_label,
+    // the smallest such label is chosen in the event of a tie.
+    size_t bestLabelIndex = 0;
+    for(size_t k = 1; k < m_labelCount; ++k)
+    {
+      if(masses[k] > masses[bestLabelIndex]) bestLabelIndex = k;
+    }
+
+    return static_cast<Label>(bestLabelIndex);
+  }
+
+  /**
+   * \brief Predicts labels for a batch of descriptors.
+   *
+   * \param descriptors             A pointer to the features of the descriptors, which are stored contiguously, one after the other.
+   * \param descriptorSize          The number of features in each descriptor.
+   * \param descriptorCount         The number of descriptors.
+   * \param labels                  An array into which to write the labels predicted for the descriptors.
+   * \throws std::invalid_argument  If descriptorSize is less than get_min_descriptor_size().
+   */
+  void predict_batch(const float *descriptors, size_t descriptorSize, size_t descriptorCount, Label *labels) const
+  {
+    if(descriptorSize < m_minDescriptorSize) throw std::invalid_argument("Error: The descriptors are too small to be evaluated by the forest");
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int i = 0; i < static_cast<int>(descriptorCount); ++i)
+    {
+      labels[i] = predict(descriptors + i * descriptorSize);
+    }
+  }
+
+  /**
+   * \brief Saves the compiled forest to a compact binary file (which can be loaded using load()).
+   *
+   * \param path                The path to the file.
+   * \throws std::runtime_error If the file cannot be written.
+   */
+  void save(const std::string& path) const
+  {
+    std::ofstream fs(path.c_str(), std::ios::binary);
+    if(!fs) throw std::runtime_error("Error: Could not open compiled forest file '" + path + "' for writing");
+
+    // Convert the nodes to their on-disk form.
+    std::vector<FileNode> fileNodes(m_nodes.size());
+    for(size_t i = 0, size = m_nodes.size(); i < size; ++i)
+    {
+      const Node& node = m_nodes[i];
+      FileNode& fileNode = fileNodes[i];
+      fileNode.leftChildIndex = node.leftChildIndex;
+      fileNode.leafIndex = node.leafIndex;
+      fileNode.rightChildIndex = node.rightChildIndex;
+      fileNode.firstFeatureIndex = node.splitter.firstFeatureIndex;
+      fileNode.op = static_cast<boost::uint32_t>(node.splitter.op);
+      fileNode.secondFeatureIndex = node.splitter.secondFeatureIndex;
+      fileNode.threshold = node.splitter.threshold;
+    }
+
+    // Write the header, followed by the arrays.
+    fs.write(FILE_SIGNATURE, sizeof(FILE_SIGNATURE));
+    write_value<boost::uint32_t>(fs, FILE_FORMAT_VERSION);
+    write_value<boost::uint32_t>(fs, static_cast<boost::uint32_t>(m_labelCount));
+    write_value<boost::uint32_t>(fs, static_cast<boost::uint32_t>(m_minDescriptorSize));
+    write_value<boost::uint32_t>(fs, static_cast<boost::uint32_t>(m_nodes.size()));
+    write_value<boost::uint32_t>(fs, static_cast<boost::uint32_t>(m_rootIndices.size()));
+    write_value<boost::uint32_t>(fs, static_cast<boost::uint32_t>(m_leafMasses.size() / m_labelCount));
+    write_array(fs, fileNodes);
+    write_array(fs, m_rootIndices);
+    write_array(fs, m_leafMasses);
+
+    fs.flush();
+    if(!fs) throw std::runtime_error("Error: Could not write compiled forest file '" + path + "'");
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Reads an array of values from a binary stream.
+   *
+   * \param is  The stream.
+   * \param arr The array into which to read the values (its size determines the number of values read).
+   */
+  template <typename T>
+  static void read_array(std::istream& is, std::vector<T>& arr)
+  {
+    if(!arr.empty()) is.read(reinterpret_cast<char*>(&arr[0]), arr.size() * sizeof(T));
+  }
+
+  /**
+   * \brief Reads a value from a binary stream.
+   *
+   * \param is  The stream.
+   * \return    The value (or zero, if it could not be read).
+   */
+  template <typename T>
+  static T read_value(std::istream& is)
+  {
+    T value = 0;
+    is.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+  }
+
+  /**
+   * \brief Writes an array of values to a binary stream.
+   *
+   * \param os  The stream.
+   * \param arr The array of values.
+   */
+  template <typename T>
+  static void write_array(std::ostream& os, const std::vector<T>& arr)
+  {
+    if(!arr.empty()) os.write(reinterpret_cast<const char*>(&arr[0]), arr.size() * sizeof(T));
+  }
+
+  /**
+   * \brief Writes a value to a binary stream.
+   *
+   * \param os    The stream.
+   * \param value The value.
+   */
+  template <typename T>
+  static void write_value(std::ostream& os, const T& value)
+  {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Finds the leaf of a tree that the specified descriptor reaches.
+   *
+   * \param rootIndex   The index of the tree's root in the node array.
+   * \param descriptor  A pointer to the features of the descriptor.
+   * \return            The index of the leaf's PMF in the leaf masses array.
+   */
+  int find_leaf(int rootIndex, const float *descriptor) const
+  {
+    const Node *node = &m_nodes[rootIndex];
+    while(node->leafIndex == -1)
+    {
+      node = &m_nodes[node->splitter.goes_left(descriptor) ? node->leftChildIndex : node->rightChildIndex];
+    }
+    return node->leafIndex;
+  }
+};
+
+//#################### PRIVATE STATIC CONSTANTS ####################
+
+template <typename Label> const char CompiledRandomForest<Label>::FILE_SIGNATURE[8] = { 'R', 'A', 'F', 'L', 'C', 'R', 'F', '\0' };
+
+}
+
+#endif
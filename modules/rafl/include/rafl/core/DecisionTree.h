@@ -6,8 +6,13 @@
 #ifndef H_RAFL_DECISIONTREE
 #define H_RAFL_DECISIONTREE
 
+#include <algorithm>
 #include <set>
 #include <stdexcept>
+#include <vector>
+
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 
 #include <tvgutil/containers/PriorityQueue.h>
 #include <tvgutil/persistence/PropertyUtil.h>
@@ -16,8 +21,16 @@
 
 namespace rafl {
 
+//#################### FORWARD DECLARATIONS ####################
+
+template <typename Label> class CompiledRandomForest;
+
 /**
  * \brief An instance of an instantiation of this class template represents a tree suitable for use within a random forest.
+ *
+ * The nodes of the tree are stored by value in a contiguous node array (linked to each other by their indices in the array),
+ * and the storage used by the reservoirs of nodes that have been split is recycled for the reservoirs of new nodes, so that
+ * training does not need to make a separate heap allocation for each node.
  */
 template <typename Label>
 class DecisionTree
@@ -59,13 +72,30 @@ private:
     : m_depth(depth), m_leftChildIndex(-1), m_reservoir(maxClassSize, randomNumberGenerator), m_rightChildIndex(-1)
     {}
 
-  private:
     /**
-     * \brief Constructs a node.
+     * \brief Constructs an empty node.
+     *
+     * Note: This constructor is needed for serialization (and to grow the node array) and should not be used otherwise.
+     */
+    Node()
+    : m_depth(0), m_leftChildIndex(-1), m_rightChildIndex(-1)
+    {}
+
+    //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+  public:
+    /**
+     * \brief Swaps the contents of this node with those of another one.
      *
-     * Note: This constructor is needed for serialization and should not be used otherwise.
+     * \param rhs The node with which to swap contents.
      */
-    Node() {}
+    void swap(Node& rhs)
+    {
+      std::swap(m_depth, rhs.m_depth);
+      std::swap(m_leftChildIndex, rhs.m_leftChildIndex);
+      m_reservoir.swap(rhs.m_reservoir);
+      std::swap(m_rightChildIndex, rhs.m_rightChildIndex);
+      m_splitter.swap(rhs.m_splitter);
+    }
 
     //~~~~~~~~~~~~~~~~~~~~ SERIALIZATION ~~~~~~~~~~~~~~~~~~~~
   private:
@@ -115,6 +145,12 @@ public:
     /** The maximum height allowed for a tree. */
     size_t maxTreeHeight;
 
+    /** The confidence with which racing should avoid dropping the best candidate when splitting a node (in (0,1)). */
+    float racingConfidence;
+
+    /** The number of examples in the initial subsample on which candidates are evaluated when racing. */
+    size_t racingInitialSampleCount;
+
     /** A random number generator. */
     tvgutil::RandomNumberGenerator_Ptr randomNumberGenerator;
 
@@ -127,12 +163,18 @@ public:
     /** Whether or not to enable PMF reweighting to better handle a class imbalance in the training data. */
     bool usePMFReweighting;
 
+    /** Whether or not to race the candidates when splitting a node, dropping those that are unlikely to win along the way. */
+    bool useRacing;
+
     //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
   public:
     /**
      * \brief Default constructor.
+     *
+     * Racing is disabled by default. All other settings must be set explicitly.
      */
     Settings()
+    : racingConfidence(0.95f), racingInitialSampleCount(64), useRacing(false)
     {}
 
     /**
@@ -185,6 +227,18 @@ public:
         GET_SETTING(usePMFReweighting);
       #undef GET_SETTING
 
+      // The racing settings are optional, so that existing settings files can still be loaded.
+      #define GET_OPTIONAL_SETTING(param, type, defaultValue) param = boost::lexical_cast<type>(tvgutil::MapUtil::lookup(properties, #param, defaultValue))
+        GET_OPTIONAL_SETTING(racingConfidence, float, "0.95");
+        GET_OPTIONAL_SETTING(racingInitialSampleCount, size_t, "64");
+        GET_OPTIONAL_SETTING(useRacing, bool, "0");
+      #undef GET_OPTIONAL_SETTING
+
+      if(useRacing && (racingConfidence <= 0.0f || racingConfidence >= 1.0f))
+      {
+        throw std::runtime_error("Error: The racing confidence must be strictly between 0 and 1");
+      }
+
       randomNumberGenerator.reset(new tvgutil::RandomNumberGenerator(randomSeed));
       decisionFunctionGenerator = DecisionFunctionGeneratorFactory<Label>::instance().make(decisionFunctionGeneratorType, decisionFunctionGeneratorParams);
     }
@@ -262,15 +316,15 @@ public:
 private:
   typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
   typedef boost::shared_ptr<Node> Node_Ptr;
-  typedef tvgutil::PriorityQueue<int,float,signed char,std::greater<float> > SplittabilityQueue;
+  typedef tvgutil::PriorityQueue<int,float,signed char,std::greater<float>,tvgutil::PriorityQueueDenseDictionary<int> > SplittabilityQueue;
 
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The histogram holding the class frequencies observed in the training data. */
   tvgutil::Histogram<Label> m_classFrequencies;
 
-  /** The indices of nodes to which examples have been added during the current call to add_examples() and whose splittability may need recalculating. */
-  std::set<int> m_dirtyNodes;
+  /** A bitmap indicating the nodes to which examples have been added during the current call to add_examples() and whose splittability may need recalculating. */
+  std::vector<bool> m_dirtyNodes;
 
   /** The inverses of the L1-normalised class frequencies observed in the training data. */
   boost::optional<std::map<Label,float> > m_inverseClassWeights;
@@ -279,7 +333,7 @@ private:
   bool m_isValid;
 
   /** The nodes in the tree. */
-  std::vector<Node_Ptr> m_nodes;
+  std::vector<Node> m_nodes;
 
   /** The root node's index in the node array. */
   int m_rootIndex;
@@ -287,6 +341,9 @@ private:
   /** The settings needed to configure the decision tree. */
   Settings m_settings;
 
+  /** Storage released by the reservoirs of nodes that have been split, which will be reused by the reservoirs of new nodes. */
+  std::vector<ExampleMatrix<Label> > m_spareExampleStorage;
+
   /** A priority queue of nodes that ranks them by how suitable they are for splitting. */
   SplittabilityQueue m_splittabilityQueue;
 
@@ -346,18 +403,28 @@ public:
     // Add each example indicated in the indices list to the tree.
     for(size_t i = 0, size = indices.size(); i < size; ++i)
     {
-      add_example(examples.at(indices[i]));
+      const Example_CPtr& example = examples.at(indices[i]);
+      const Descriptor& descriptor = *example->get_descriptor();
+      add_example(&descriptor[0], descriptor.size(), example->get_label());
     }
 
-    // Provided we added at least one example, the tree is now valid if it wasn't already.
-    if(!examples.empty()) m_isValid = true;
+    finish_adding_examples(!examples.empty());
+  }
 
-    // Update the inverse class weights (note that this must be done before updating the dirty nodes,
-    // since the splittability calculations for the dirty nodes depend on the new weights).
-    update_inverse_class_weights();
+  /**
+   * \brief Adds new training examples that are stored contiguously in an example matrix to the decision tree.
+   *
+   * \param examples  The examples to be added.
+   */
+  void add_examples(const ExampleMatrix<Label>& examples)
+  {
+    const size_t featureCount = examples.get_feature_count();
+    for(size_t i = 0, size = examples.size(); i < size; ++i)
+    {
+      add_example(examples.get_features(i), featureCount, examples.get_label(i));
+    }
 
-    // Recalculate the splittabilities of nodes to which examples have been added.
-    update_dirty_nodes();
+    finish_adding_examples(!examples.empty());
   }
 
   /**
@@ -390,6 +457,28 @@ public:
     return m_classFrequencies;
   }
 
+  /**
+   * \brief Gets the (approximate) number of bytes of storage currently allocated for the tree.
+   *
+   * This counts the nodes and the storage for the examples in their reservoirs (including any spare storage
+   * retained for reuse), which between them dominate the size of a tree, but not the split functions.
+   *
+   * \return  The (approximate) number of bytes of storage currently allocated for the tree.
+   */
+  size_t get_memory_usage() const
+  {
+    size_t result = m_nodes.capacity() * sizeof(Node);
+    for(typename std::vector<Node>::const_iterator it = m_nodes.begin(), iend = m_nodes.end(); it != iend; ++it)
+    {
+      result += it->m_reservoir.get_memory_usage();
+    }
+    for(typename std::vector<ExampleMatrix<Label> >::const_iterator it = m_spareExampleStorage.begin(), iend = m_spareExampleStorage.end(); it != iend; ++it)
+    {
+      result += it->get_memory_usage();
+    }
+    return result;
+  }
+
   /**
    * \brief Gets the number of nodes in the tree.
    *
@@ -498,35 +587,58 @@ private:
   /**
    * \brief Adds a new training example to the decision tree.
    *
-   * \param example The example to be added.
+   * \param features      The features of the example's descriptor.
+   * \param featureCount  The number of features in the example's descriptor.
+   * \param label         The example's label.
    */
-  void add_example(const Example_CPtr& example)
+  void add_example(const float *features, size_t featureCount, const Label& label)
   {
     // Find the leaf to which to add the new example.
-    int leafIndex = find_leaf(*example->get_descriptor());
+    int leafIndex = find_leaf(features);
 
     // Add the example to the leaf's reservoir.
-    m_nodes[leafIndex]->m_reservoir.add_example(example);
+    m_nodes[leafIndex].m_reservoir.add_example(features, featureCount, label);
 
     // Mark the leaf as dirty to ensure that its splittability is properly recalculated once all of the examples have been added.
-    m_dirtyNodes.insert(leafIndex);
+    m_dirtyNodes[leafIndex] = true;
 
     // Update the class frequency histogram.
-    m_classFrequencies.add(example->get_label());
+    m_classFrequencies.add(label);
   }
 
   /**
    * \brief Adds a node to the decision tree.
    *
+   * Note that this may grow the node array, invalidating any references to existing nodes.
+   *
    * \param depth The depth of the node in the tree.
    *
    * \return The ID of the newly-added node.
    */
   int add_node(size_t depth)
   {
-    m_nodes.push_back(Node_Ptr(new Node(depth, m_settings.maxClassSize, m_settings.randomNumberGenerator)));
+    // If the node array is full, grow it geometrically. The existing nodes are swapped (rather than copied) into the new array,
+    // since copying them would copy their reservoirs.
+    if(m_nodes.size() == m_nodes.capacity())
+    {
+      std::vector<Node> nodes;
+      nodes.reserve(std::max<size_t>(m_nodes.size() * 2, 16));
+      nodes.resize(m_nodes.size());
+      for(size_t i = 0, size = m_nodes.size(); i < size; ++i) nodes[i].swap(m_nodes[i]);
+      m_nodes.swap(nodes);
+    }
+
+    m_nodes.push_back(Node(depth, m_settings.maxClassSize, m_settings.randomNumberGenerator));
+    m_dirtyNodes.push_back(false);
     if(depth > m_treeDepth) m_treeDepth = depth;
 
+    // Give the new node's reservoir any storage released by a node that has been split.
+    if(!m_spareExampleStorage.empty())
+    {
+      m_nodes.back().m_reservoir.swap_storage(m_spareExampleStorage.back());
+      m_spareExampleStorage.pop_back();
+    }
+
     int id = static_cast<int>(m_nodes.size()) - 1;
     const signed char nullData = -1;
     m_splittabilityQueue.insert(id, 0.0f, nullData);
@@ -534,42 +646,77 @@ private:
     return id;
   }
 
+  /**
+   * \brief Calculates the splittability of the specified node.
+   *
+   * \param nodeIndex  The index of the node.
+   * \return           The splittability of the node.
+   */
+  float calculate_splittability(int nodeIndex) const
+  {
+    const ExampleReservoir<Label>& reservoir = m_nodes[nodeIndex].m_reservoir;
+    if(m_nodes[nodeIndex].m_depth + 1 < m_settings.maxTreeHeight && reservoir.seen_examples() >= m_settings.seenExamplesThreshold)
+    {
+      return ExampleUtil::calculate_entropy(reservoir.get_histogram(), m_inverseClassWeights);
+    }
+    else
+    {
+      return 0.0f;
+    }
+  }
+
   /**
    * \brief Fills the specified reservoir with examples sampled from an input set of examples.
    *
-   * \param inputExamples The set of examples from which to sample.
+   * \param examples      The example matrix containing the input examples.
+   * \param rows          The rows of the example matrix that contain the input examples.
    * \param multipliers   The per-class ratios between the total number of examples seen for a class and the number of examples currently in the source reservoir.
    * \param reservoir     The reservoir to fill.
    */
-  void fill_reservoir(const std::vector<Example_CPtr>& inputExamples, const std::map<Label,float>& multipliers, ExampleReservoir<Label>& reservoir)
+  void fill_reservoir(const ExampleMatrix<Label>& examples, const std::vector<size_t>& rows, const std::map<Label,float>& multipliers, ExampleReservoir<Label>& reservoir)
   {
+    const size_t featureCount = examples.get_feature_count();
+
     // Group the input examples by label.
-    std::map<Label,std::vector<Example_CPtr> > inputExamplesByLabel;
-    for(typename std::vector<Example_CPtr>::const_iterator it = inputExamples.begin(), iend = inputExamples.end(); it != iend; ++it)
+    std::map<Label,std::vector<size_t> > inputRowsByLabel;
+    for(std::vector<size_t>::const_iterator it = rows.begin(), iend = rows.end(); it != iend; ++it)
     {
-      inputExamplesByLabel[(*it)->get_label()].push_back(*it);
+      inputRowsByLabel[examples.get_label(*it)].push_back(*it);
     }
 
-    // For each group:
-    for(typename std::map<Label,std::vector<Example_CPtr> >::const_iterator it = inputExamplesByLabel.begin(), iend = inputExamplesByLabel.end(); it != iend; ++it)
+    // Determine the number of examples to sample for each group (based on the multiplier for the group).
+    std::vector<size_t> sampleCounts;
+    sampleCounts.reserve(inputRowsByLabel.size());
+    size_t keptCount = 0;
+    for(typename std::map<Label,std::vector<size_t> >::const_iterator it = inputRowsByLabel.begin(), iend = inputRowsByLabel.end(); it != iend; ++it)
     {
-#if 1
-      // Sample the appropriate number of examples (based on the multiplier for the group) and add them to the target reservoir.
       typename std::map<Label,float>::const_iterator jt = multipliers.find(it->first);
       if(jt == multipliers.end()) throw std::runtime_error("The input examples appear to be from a different reservoir than the multipliers");
 
-      float multiplier = jt->second;
-      size_t sampleCount = static_cast<size_t>(it->second.size() * multiplier + 0.5f);
-      std::vector<Example_CPtr> sampledExamples = sample_examples(it->second, sampleCount);
+      sampleCounts.push_back(static_cast<size_t>(it->second.size() * jt->second + 0.5f));
+      keptCount += std::min(sampleCounts.back(), m_settings.maxClassSize);
+    }
+
+    // Reserve space in the target reservoir for the examples it will keep, so that its storage does not need to be grown repeatedly.
+    reservoir.reserve(keptCount, featureCount);
+
+    // For each group:
+    size_t groupIndex = 0;
+    for(typename std::map<Label,std::vector<size_t> >::const_iterator it = inputRowsByLabel.begin(), iend = inputRowsByLabel.end(); it != iend; ++it, ++groupIndex)
+    {
+#if 1
+      // Sample the appropriate number of examples and add them to the target reservoir.
+      const size_t sampleCount = sampleCounts[groupIndex];
+      std::vector<size_t> sampledRows = sample_rows(it->second, sampleCount);
       for(size_t j = 0; j < sampleCount; ++j)
       {
-        reservoir.add_example(sampledExamples[j]);
+        reservoir.add_example(examples.get_features(sampledRows[j]), featureCount, it->first);
       }
 #else
       // Simply add all of the examples for the group to the target reservoir (useful for debugging purposes).
       for(size_t j = 0, size = it->second.size(); j < size; ++j)
       {
-        reservoir.add_example(it->second[j]);
+        reservoir.add_example(examples.get_features(it->second[j]), featureCount, it->first);
       }
 #endif
     }
@@ -582,15 +729,45 @@ private:
    * \return            The index of the leaf to which an example with the descriptor would currently be added.
    */
   int find_leaf(const Descriptor& descriptor) const
+  {
+    return find_leaf(&descriptor[0]);
+  }
+
+  /**
+   * \brief Finds the index of the leaf to which an example with the specified descriptor features would currently be added.
+   *
+   * \param features  The features of the descriptor.
+   * \return          The index of the leaf to which an example with the descriptor would currently be added.
+   */
+  int find_leaf(const float *features) const
   {
     int curIndex = m_rootIndex;
     while(!is_leaf(curIndex))
     {
-      curIndex = m_nodes[curIndex]->m_splitter->classify_descriptor(descriptor) == DecisionFunction::DC_LEFT ? m_nodes[curIndex]->m_leftChildIndex : m_nodes[curIndex]->m_rightChildIndex;
+      const Node& node = m_nodes[curIndex];
+      curIndex = node.m_splitter->classify_features(features) == DecisionFunction::DC_LEFT ? node.m_leftChildIndex : node.m_rightChildIndex;
     }
     return curIndex;
   }
 
+  /**
+   * \brief Finishes adding a batch of examples to the decision tree.
+   *
+   * \param addedExamples Whether or not at least one example was added.
+   */
+  void finish_adding_examples(bool addedExamples)
+  {
+    // Provided we added at least one example, the tree is now valid if it wasn't already.
+    if(addedExamples) m_isValid = true;
+
+    // Update the inverse class weights (note that this must be done before updating the dirty nodes,
+    // since the splittability calculations for the dirty nodes depend on the new weights).
+    update_inverse_class_weights();
+
+    // Recalculate the splittabilities of nodes to which examples have been added.
+    update_dirty_nodes();
+  }
+
   /**
    * \brief Returns whether or not the specified node is a leaf.
    *
@@ -599,7 +776,7 @@ private:
    */
   bool is_leaf(int nodeIndex) const
   {
-    return m_nodes[nodeIndex]->m_leftChildIndex == -1;
+    return m_nodes[nodeIndex].m_leftChildIndex == -1;
   }
 
   /**
@@ -610,7 +787,7 @@ private:
    */
   tvgutil::ProbabilityMassFunction<Label> make_pmf(int leafIndex) const
   {
-    return tvgutil::ProbabilityMassFunction<Label>(*m_nodes[leafIndex]->m_reservoir.get_histogram(), m_inverseClassWeights);
+    return tvgutil::ProbabilityMassFunction<Label>(m_nodes[leafIndex].m_reservoir.get_histogram(), m_inverseClassWeights);
   }
 
   /**
@@ -622,14 +799,14 @@ private:
    */
   void output_subtree(std::ostream& os, int subtreeRootIndex, const std::string& indent) const
   {
-    int leftChildIndex = m_nodes[subtreeRootIndex]->m_leftChildIndex;
-    int rightChildIndex = m_nodes[subtreeRootIndex]->m_rightChildIndex;
-    DecisionFunction_Ptr splitter = m_nodes[subtreeRootIndex]->m_splitter;
+    int leftChildIndex = m_nodes[subtreeRootIndex].m_leftChildIndex;
+    int rightChildIndex = m_nodes[subtreeRootIndex].m_rightChildIndex;
+    DecisionFunction_Ptr splitter = m_nodes[subtreeRootIndex].m_splitter;
 
     // Output the current node.
     os << indent << subtreeRootIndex << ": ";
     if(splitter) os << *splitter;
-    else os << m_nodes[subtreeRootIndex]->m_reservoir.seen_examples() << ' ' << make_pmf(subtreeRootIndex);
+    else os << m_nodes[subtreeRootIndex].m_reservoir.seen_examples() << ' ' << make_pmf(subtreeRootIndex);
     os << '\n';
 
     // Recursively output any children of the current node.
@@ -638,21 +815,22 @@ private:
   }
 
   /**
-   * \brief Randomly samples sampleCount examples (with replacement) from the specified set of input examples.
+   * \brief Randomly samples sampleCount rows (with replacement) from the specified set of input rows.
    *
-   * \param inputExamples The set of examples from which to sample.
-   * \param sampleCount   The number of samples to choose.
-   * \return              The chosen set of examples.
+   * \param inputRows   The set of rows from which to sample.
+   * \param sampleCount The number of samples to choose.
+   * \return            The chosen set of rows.
    */
-  std::vector<Example_CPtr> sample_examples(const std::vector<Example_CPtr>& inputExamples, size_t sampleCount)
+  std::vector<size_t> sample_rows(const std::vector<size_t>& inputRows, size_t sampleCount)
   {
-    std::vector<Example_CPtr> outputExamples;
+    std::vector<size_t> outputRows;
+    outputRows.reserve(sampleCount);
     for(size_t i = 0; i < sampleCount; ++i)
     {
-      int exampleIndex = m_settings.randomNumberGenerator->generate_int_from_uniform(0, static_cast<int>(inputExamples.size()) - 1);
-      outputExamples.push_back(inputExamples[exampleIndex]);
+      int rowIndex = m_settings.randomNumberGenerator->generate_int_from_uniform(0, static_cast<int>(inputRows.size()) - 1);
+      outputRows.push_back(inputRows[rowIndex]);
     }
-    return outputExamples;
+    return outputRows;
   }
 
   /**
@@ -663,33 +841,42 @@ private:
    */
   bool split_node(int nodeIndex)
   {
-    Node& n = *m_nodes[nodeIndex];
     typename DecisionFunctionGenerator<Label>::Split_CPtr split = m_settings.decisionFunctionGenerator->split_examples(
-      n.m_reservoir,
+      m_nodes[nodeIndex].m_reservoir,
       m_settings.candidateCount,
       m_settings.gainThreshold,
       m_inverseClassWeights,
-      m_settings.randomNumberGenerator
+      m_settings.randomNumberGenerator,
+      m_settings.useRacing ? m_settings.racingInitialSampleCount : 0,
+      m_settings.racingConfidence
     );
     if(!split) return false;
 
-    // Set the decision function of the node to be split.
+    // Add left and right child nodes (note that this must be done before taking a reference to the node to be split,
+    // since adding nodes can grow the node array).
+    size_t childDepth = m_nodes[nodeIndex].m_depth + 1;
+    int leftChildIndex = add_node(childDepth);
+    int rightChildIndex = add_node(childDepth);
+
+    // Set the decision function and child indices of the node to be split.
+    Node& n = m_nodes[nodeIndex];
     n.m_splitter = split->m_decisionFunction;
+    n.m_leftChildIndex = leftChildIndex;
+    n.m_rightChildIndex = rightChildIndex;
 
-    // Add left and right child nodes and populate their example reservoirs based on the chosen split.
-    size_t childDepth = n.m_depth + 1;
-    n.m_leftChildIndex = add_node(childDepth);
-    n.m_rightChildIndex = add_node(childDepth);
+    // Populate the example reservoirs of the child nodes based on the chosen split.
     std::map<Label,float> multipliers = n.m_reservoir.get_class_multipliers();
-    fill_reservoir(split->m_leftExamples, multipliers, m_nodes[n.m_leftChildIndex]->m_reservoir);
-    fill_reservoir(split->m_rightExamples, multipliers, m_nodes[n.m_rightChildIndex]->m_reservoir);
+    fill_reservoir(n.m_reservoir.get_examples(), split->m_leftRows, multipliers, m_nodes[n.m_leftChildIndex].m_reservoir);
+    fill_reservoir(n.m_reservoir.get_examples(), split->m_rightRows, multipliers, m_nodes[n.m_rightChildIndex].m_reservoir);
 
     // Update the splittability for the child nodes.
     update_splittability(n.m_leftChildIndex);
     update_splittability(n.m_rightChildIndex);
 
-    // Clear the example reservoir in the node that was split.
+    // Clear the example reservoir in the node that was split, and keep its storage for reuse by future nodes.
     n.m_reservoir.clear();
+    m_spareExampleStorage.push_back(ExampleMatrix<Label>());
+    n.m_reservoir.swap_storage(m_spareExampleStorage.back());
 
     return true;
   }
@@ -699,13 +886,16 @@ private:
    */
   void update_dirty_nodes()
   {
-    for(std::set<int>::const_iterator it = m_dirtyNodes.begin(), iend = m_dirtyNodes.end(); it != iend; ++it)
+    // Recalculate the splittabilities of the dirty nodes, and then update the splittability queue in a single batch.
+    std::vector<std::pair<int,float> > updates;
+    for(int nodeIndex = 0, nodeCount = static_cast<int>(m_dirtyNodes.size()); nodeIndex < nodeCount; ++nodeIndex)
     {
-      update_splittability(*it);
+      if(m_dirtyNodes[nodeIndex]) updates.push_back(std::make_pair(nodeIndex, calculate_splittability(nodeIndex)));
     }
+    m_splittabilityQueue.update_keys(updates);
 
-    // Clear the list of dirty nodes once their splittability has been updated.
-    m_dirtyNodes.clear();
+    // Clear the dirty flags once the splittabilities of the nodes have been updated.
+    m_dirtyNodes.assign(m_dirtyNodes.size(), false);
   }
 
   /**
@@ -715,20 +905,7 @@ private:
    */
   void update_splittability(int nodeIndex)
   {
-    // Recalculate the node's splittability.
-    const ExampleReservoir<Label>& reservoir = m_nodes[nodeIndex]->m_reservoir;
-    float splittability;
-    if(m_nodes[nodeIndex]->m_depth + 1 < m_settings.maxTreeHeight && reservoir.seen_examples() >= m_settings.seenExamplesThreshold)
-    {
-      splittability = ExampleUtil::calculate_entropy(*reservoir.get_histogram(), m_inverseClassWeights);
-    }
-    else
-    {
-      splittability = 0.0f;
-    }
-
-    // Update the splittability queue to reflect the node's new splittability.
-    m_splittabilityQueue.update_key(nodeIndex, splittability);
+    m_splittabilityQueue.update_key(nodeIndex, calculate_splittability(nodeIndex));
   }
 
   /**
@@ -750,16 +927,70 @@ private:
   //#################### SERIALIZATION ####################
 private:
   /**
-   * \brief Serializes the decision tree to/from an archive.
+   * \brief Loads the decision tree from an archive.
+   *
+   * Trees saved before the nodes were stored by value (versions 0 and 1) are converted on loading.
+   *
+   * \param ar      The archive.
+   * \param version The file format version number.
+   */
+  template <typename Archive>
+  void load(Archive& ar, const unsigned int version)
+  {
+    ar & m_classFrequencies;
+
+    if(version < 2)
+    {
+      // Older trees stored a set of dirty nodes, and pointers to their nodes.
+      std::set<int> dirtyNodes;
+      std::vector<Node_Ptr> nodes;
+
+      ar & dirtyNodes;
+      ar & m_inverseClassWeights;
+      ar & m_isValid;
+      ar & nodes;
+
+      m_nodes.resize(nodes.size());
+      for(size_t i = 0, size = nodes.size(); i < size; ++i) m_nodes[i].swap(*nodes[i]);
+
+      m_dirtyNodes.assign(m_nodes.size(), false);
+      for(std::set<int>::const_iterator it = dirtyNodes.begin(), iend = dirtyNodes.end(); it != iend; ++it) m_dirtyNodes[*it] = true;
+    }
+    else
+    {
+      ar & m_inverseClassWeights;
+      ar & m_isValid;
+      ar & m_nodes;
+
+      m_dirtyNodes.assign(m_nodes.size(), false);
+    }
+
+    ar & m_rootIndex;
+    ar & m_settings;
+    ar & m_splittabilityQueue;
+    ar & m_treeDepth;
+
+    // Trees saved before racing was added (version 0) are loaded with racing disabled.
+    if(version >= 1)
+    {
+      ar & m_settings.racingConfidence;
+      ar & m_settings.racingInitialSampleCount;
+      ar & m_settings.useRacing;
+    }
+  }
+
+  /**
+   * \brief Saves the decision tree to an archive.
+   *
+   * Note that the dirty node bitmap is not saved, since it is always clear outside calls to add_examples().
    *
    * \param ar      The archive.
    * \param version The file format version number.
    */
   template <typename Archive>
-  void serialize(Archive& ar, const unsigned int version)
+  void save(Archive& ar, const unsigned int version) const
   {
     ar & m_classFrequencies;
-    ar & m_dirtyNodes;
     ar & m_inverseClassWeights;
     ar & m_isValid;
     ar & m_nodes;
@@ -767,11 +998,34 @@ private:
     ar & m_settings;
     ar & m_splittabilityQueue;
     ar & m_treeDepth;
+    ar & m_settings.racingConfidence;
+    ar & m_settings.racingInitialSampleCount;
+    ar & m_settings.useRacing;
   }
 
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+
   friend class boost::serialization::access;
+  template <typename L> friend class CompiledRandomForest;
 };
 
 }
 
+namespace boost { namespace serialization {
+
+/**
+ * \brief Specifies the serialization version of decision trees.
+ *
+ * Version 1 added the racing settings. Version 2 stores the nodes by value, rather than via pointers, and no longer stores the dirty nodes.
+ */
+template <typename Label>
+struct version<rafl::DecisionTree<Label> >
+{
+  typedef mpl::int_<2> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+}}
+
 #endif
@@ -6,12 +6,24 @@
 #ifndef H_RAFL_RANDOMFOREST
 #define H_RAFL_RANDOMFOREST
 
+#include <climits>
+#include <stdexcept>
+
+#include <numeric>
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/misc/ParallelUtil.h>
+
 #include "DecisionTree.h"
 
 namespace rafl {
 
 /**
  * \brief An instance of an instantiation of this class template represents a random forest.
+ *
+ * The trees in the forest are fully independent of each other (each has its own nodes, reservoirs and random number
+ * generator), so examples are added to them and they are trained in parallel (one tree per task) on the global task scheduler.
  */
 template <typename Label>
 class RandomForest
@@ -44,7 +56,12 @@ public:
   {
     for(size_t i = 0; i < treeCount; ++i)
     {
-      m_trees.push_back(DT_Ptr(new DT(settings)));
+      // Give each tree its own random number generator, seeded from the one in the settings. This ensures that
+      // the trees do not contend for a shared generator when they are trained in parallel, and that the result
+      // of training does not depend on the order in which the trees happen to be scheduled.
+      typename DT::Settings treeSettings = settings;
+      treeSettings.randomNumberGenerator.reset(new tvgutil::RandomNumberGenerator(settings.randomNumberGenerator->generate_int_from_uniform(0, INT_MAX)));
+      m_trees.push_back(DT_Ptr(new DT(treeSettings)));
     }
   }
 
@@ -66,10 +83,7 @@ public:
   void add_examples(const std::vector<Example_CPtr>& examples)
   {
     // Add the new examples to the different trees.
-    for(typename std::vector<DT_Ptr>::const_iterator it = m_trees.begin(), iend = m_trees.end(); it != iend; ++it)
-    {
-      (*it)->add_examples(examples);
-    }
+    tvgutil::ParallelUtil::parallel_for(0, static_cast<int>(m_trees.size()), boost::bind(&RandomForest::add_example_vector_to_tree, this, _1, boost::cref(examples)));
   }
 
   /**
@@ -81,11 +95,25 @@ public:
    */
   void add_examples(const std::vector<Example_CPtr>& examples, const std::vector<size_t>& indices)
   {
-    // Add the new examples to the different trees.
-    for(typename std::vector<DT_Ptr>::const_iterator it = m_trees.begin(), iend = m_trees.end(); it != iend; ++it)
+    // Check that the indices are valid before adding any examples (so that no tree is modified if any of them are invalid).
+    for(size_t i = 0, size = indices.size(); i < size; ++i)
     {
-      (*it)->add_examples(examples, indices);
+      if(indices[i] >= examples.size()) throw std::out_of_range("Error: Invalid example index");
     }
+
+    // Add the new examples to the different trees.
+    tvgutil::ParallelUtil::parallel_for(0, static_cast<int>(m_trees.size()), boost::bind(&RandomForest::add_indexed_examples_to_tree, this, _1, boost::cref(examples), boost::cref(indices)));
+  }
+
+  /**
+   * \brief Adds new training examples that are stored contiguously in an example matrix to the forest.
+   *
+   * \param examples  The examples to be added.
+   */
+  void add_examples(const ExampleMatrix<Label>& examples)
+  {
+    // Add the new examples to the different trees.
+    tvgutil::ParallelUtil::parallel_for(0, static_cast<int>(m_trees.size()), boost::bind(&RandomForest::add_example_matrix_to_tree, this, _1, boost::cref(examples)));
   }
 
   /**
@@ -114,6 +142,36 @@ public:
     return tvgutil::ProbabilityMassFunction<Label>(masses);
   }
 
+  /**
+   * \brief Gets the (approximate) number of bytes of storage currently allocated for the trees in the forest.
+   *
+   * \return  The (approximate) number of bytes of storage currently allocated for the trees in the forest.
+   */
+  size_t get_memory_usage() const
+  {
+    size_t result = 0;
+    for(typename std::vector<DT_Ptr>::const_iterator it = m_trees.begin(), iend = m_trees.end(); it != iend; ++it)
+    {
+      result += (*it)->get_memory_usage();
+    }
+    return result;
+  }
+
+  /**
+   * \brief Gets the total number of nodes in the trees in the forest.
+   *
+   * \return  The total number of nodes in the trees in the forest.
+   */
+  size_t get_node_count() const
+  {
+    size_t result = 0;
+    for(typename std::vector<DT_Ptr>::const_iterator it = m_trees.begin(), iend = m_trees.end(); it != iend; ++it)
+    {
+      result += (*it)->get_node_count();
+    }
+    return result;
+  }
+
   /**
    * \brief Gets the specified tree in the forest.
    *
@@ -220,12 +278,58 @@ public:
    */
   size_t train(size_t splitBudget)
   {
-    size_t nodesSplit = 0;
-    for(typename std::vector<DT_Ptr>::const_iterator it = m_trees.begin(), iend = m_trees.end(); it != iend; ++it)
-    {
-      nodesSplit += (*it)->train(splitBudget);
-    }
-    return nodesSplit;
+    // Train the trees in parallel, recording the number of nodes split in each, and then sum the results.
+    std::vector<size_t> nodesSplit(m_trees.size(), 0);
+    tvgutil::ParallelUtil::parallel_for(0, static_cast<int>(m_trees.size()), boost::bind(&RandomForest::train_tree, this, _1, splitBudget, boost::ref(nodesSplit)));
+    return std::accumulate(nodesSplit.begin(), nodesSplit.end(), static_cast<size_t>(0));
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Adds new training examples that are stored contiguously in an example matrix to the specified tree.
+   *
+   * \param treeIndex The index of the tree.
+   * \param examples  The examples to be added.
+   */
+  void add_example_matrix_to_tree(int treeIndex, const ExampleMatrix<Label>& examples)
+  {
+    m_trees[treeIndex]->add_examples(examples);
+  }
+
+  /**
+   * \brief Adds new training examples to the specified tree.
+   *
+   * \param treeIndex The index of the tree.
+   * \param examples  The examples to be added.
+   */
+  void add_example_vector_to_tree(int treeIndex, const std::vector<Example_CPtr>& examples)
+  {
+    m_trees[treeIndex]->add_examples(examples);
+  }
+
+  /**
+   * \brief Adds the examples with the specified indices in a pool to the specified tree.
+   *
+   * \param treeIndex The index of the tree.
+   * \param examples  A pool of examples that could potentially be added.
+   * \param indices   The indices of the examples in the pool that should be added to the tree.
+   */
+  void add_indexed_examples_to_tree(int treeIndex, const std::vector<Example_CPtr>& examples, const std::vector<size_t>& indices)
+  {
+    m_trees[treeIndex]->add_examples(examples, indices);
+  }
+
+  /**
+   * \brief Trains the specified tree.
+   *
+   * \param treeIndex   The index of the tree.
+   * \param splitBudget The maximum number of nodes that may be split in the tree.
+   * \param nodesSplit  An array into whose element for the tree to write the number of nodes that were split.
+   */
+  void train_tree(int treeIndex, size_t splitBudget, std::vector<size_t>& nodesSplit)
+  {
+    nodesSplit[treeIndex] = m_trees[treeIndex]->train(splitBudget);
   }
 
   //#################### SERIALIZATION ####################
@@ -21,6 +21,7 @@ header to avoid inadvertent mistakes.
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/serialization.hpp>
 
+#include "FlatDecisionFunction.h"
 #include "../base/Descriptor.h"
 
 namespace rafl {
@@ -52,12 +53,12 @@ public:
   //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
 public:
   /**
-   * \brief Classifies the specified descriptor using the decision function.
+   * \brief Classifies the descriptor with the specified features using the decision function.
    *
-   * \param descriptor  The descriptor to classify.
-   * \return            DC_LEFT, if the descriptor should be sent down the left subtree of the node, or DC_RIGHT otherwise.
+   * \param features  A pointer to the features of the descriptor to classify.
+   * \return          DC_LEFT, if the descriptor should be sent down the left subtree of the node, or DC_RIGHT otherwise.
    */
-  virtual DescriptorClassification classify_descriptor(const Descriptor& descriptor) const = 0;
+  virtual DescriptorClassification classify_features(const float *features) const = 0;
 
   /**
    * \brief Outputs the decision function to the specified stream.
@@ -66,6 +67,26 @@ public:
    */
   virtual void output(std::ostream& os) const = 0;
 
+  /**
+   * \brief Converts the decision function into a flat form that can be evaluated without virtual dispatch.
+   *
+   * \return The flat form of the decision function, which must classify every descriptor in the same way as the original.
+   */
+  virtual FlatDecisionFunction to_flat() const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Classifies the specified descriptor using the decision function.
+   *
+   * \param descriptor  The descriptor to classify.
+   * \return            DC_LEFT, if the descriptor should be sent down the left subtree of the node, or DC_RIGHT otherwise.
+   */
+  DescriptorClassification classify_descriptor(const Descriptor& descriptor) const
+  {
+    return classify_features(&descriptor[0]);
+  }
+
   //#################### SERIALIZATION #################### 
 private:
   /**
@@ -6,11 +6,12 @@
 #ifndef H_RAFL_DECISIONFUNCTIONGENERATOR
 #define H_RAFL_DECISIONFUNCTIONGENERATOR
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <utility>
 
-#ifdef WITH_OPENMP
-#include <omp.h>
-#endif
+#include <tvgutil/misc/ParallelUtil.h>
 
 #include "../examples/ExampleReservoir.h"
 #include "../examples/ExampleUtil.h"
@@ -34,17 +35,101 @@ public:
   /**
    * \brief An instance of this struct represents a split of a set of examples into two subsets,
    *        based on their classification against a decision function.
+   *
+   * The examples are identified by the indices of their rows in the example matrix of the reservoir that was split.
    */
   struct Split
   {
     /** The decision function that induced the split. */
     DecisionFunction_Ptr m_decisionFunction;
 
-    /** The examples that were sent left by the decision function. */
-    std::vector<Example_CPtr> m_leftExamples;
+    /** The rows containing the examples that were sent left by the decision function. */
+    std::vector<size_t> m_leftRows;
+
+    /** The rows containing the examples that were sent right by the decision function. */
+    std::vector<size_t> m_rightRows;
+  };
+
+private:
+  /**
+   * \brief An instance of this struct can be used to evaluate the information gains of a batch of split candidates in parallel.
+   *
+   * The candidates are evaluated on a subsample of the examples that consists of a prefix of each label's segment of the feature
+   * columns. The counts of examples sent left by each candidate are accumulated across calls, so that when the subsample grows,
+   * only the newly-added examples need to be classified. Each candidate writes only to its own elements of the gains and counts
+   * arrays, so no synchronisation is needed, and all of the arrays are allocated up-front, so evaluating a candidate allocates
+   * no memory. The gains are written as is, without checking whether the splits are worthwhile.
+   */
+  struct CandidateEvaluator
+  {
+    /** The indices of the candidates to evaluate. */
+    const std::vector<int>& candidateIndices;
+
+    /** The column-major buffer containing the feature columns tested by the candidates (with the examples grouped by label). */
+    const std::vector<float>& columns;
+
+    /** The index of the column for each feature in the buffer (or -1 for features that are not tested). */
+    const std::vector<int>& columnIndices;
+
+    /** The total number of examples (i.e. the length of each column). */
+    size_t exampleCount;
+
+    /** The flat forms of the candidates. */
+    const std::vector<FlatDecisionFunction>& flatCandidates;
+
+    /** The array into which to write the gain for each candidate. */
+    std::vector<float>& gains;
+
+    /** The weighted entropy of the subsample before splitting. */
+    float initialEntropy;
+
+    /** The weight to use for each label when calculating entropies. */
+    const std::vector<float>& labelWeights;
+
+    /** The number of examples of each label in the subsample that each candidate sends left (candidate-major). */
+    std::vector<size_t>& leftCounts;
+
+    /** The offsets in each column at which the newly-added examples of each label start. */
+    const std::vector<size_t>& rangeBegins;
+
+    /** The offsets in each column at which the newly-added examples of each label end. */
+    const std::vector<size_t>& rangeEnds;
+
+    /** A scratch array into which to write the number of examples of each label in the subsample that each candidate sends right (candidate-major). */
+    std::vector<size_t>& rightCounts;
+
+    /** The number of examples of each label in the subsample. */
+    const std::vector<size_t>& sampleCounts;
+
+    /**
+     * \brief Evaluates the specified candidate.
+     *
+     * \param i The index of the candidate in the candidate indices array.
+     */
+    void operator()(int i) const
+    {
+      const int candidateIndex = candidateIndices[i];
+
+      // Count the newly-added examples of each label that the candidate would send left, and add them to the existing counts.
+      const FlatDecisionFunction& f = flatCandidates[candidateIndex];
+      const float *first = &columns[columnIndices[f.firstFeatureIndex] * exampleCount];
+      const float *second = f.op != FlatDecisionFunction::FO_FIRST ? &columns[columnIndices[f.secondFeatureIndex] * exampleCount] : NULL;
+
+      const size_t labelCount = sampleCounts.size();
+      size_t *candidateLeftCounts = &leftCounts[candidateIndex * labelCount];
+      size_t leftCount = 0, sampleCount = 0;
+      for(size_t k = 0; k < labelCount; ++k)
+      {
+        candidateLeftCounts[k] += count_left(f.op, first, second, f.threshold, rangeBegins[k], rangeEnds[k]);
+        leftCount += candidateLeftCounts[k];
+        sampleCount += sampleCounts[k];
+      }
 
-    /** The examples that were sent right by the decision function. */
-    std::vector<Example_CPtr> m_rightExamples;
+      // Calculate the information gain we would obtain from this split of the subsample.
+      gains[candidateIndex] = calculate_information_gain(
+        initialEntropy, candidateLeftCounts, &rightCounts[candidateIndex * labelCount], &sampleCounts[0], &labelWeights[0], labelCount, leftCount, sampleCount - leftCount
+      );
+    }
   };
 
   //#################### PUBLIC TYPEDEFS ####################
@@ -52,11 +137,6 @@ public:
   typedef boost::shared_ptr<Split> Split_Ptr;
   typedef boost::shared_ptr<const Split> Split_CPtr;
 
-  //#################### PRIVATE VARIABLES ####################
-private:
-  /* The split candidates. */
-  mutable std::vector<Split> m_splitCandidates;
-
   //#################### DESTRUCTOR ####################
 public:
   /**
@@ -73,7 +153,7 @@ public:
    * \param randomNumberGenerator A random number generator.
    * \return                      The candidate decision function.
    */
-  virtual DecisionFunction_Ptr generate_candidate_decision_function(const std::vector<Example_CPtr>& examples, const tvgutil::RandomNumberGenerator_Ptr& randomNumberGenerator) const = 0;
+  virtual DecisionFunction_Ptr generate_candidate_decision_function(const ExampleMatrix<Label>& examples, const tvgutil::RandomNumberGenerator_Ptr& randomNumberGenerator) const = 0;
 
   /**
    * \brief Gets the parameters of the decision function generator as a string.
@@ -94,121 +174,255 @@ public:
   /**
    * \brief Tries to pick an appropriate way in which to split the specified reservoir of examples.
    *
-   * \param reservoir             The reservoir of examples to split.
-   * \param candidateCount        The number of candidates to evaluate.
-   * \param gainThreshold         The minimum information gain that must be obtained from a split to make it worthwhile.
-   * \param inverseClassWeights   The (optional) inverses of the L1-normalised class frequencies observed in the training data.
-   * \param randomNumberGenerator A random number generator.
-   * \return                      The chosen split, if one was suitable, or NULL otherwise.
+   * The candidates are evaluated in a batch. Before evaluating any of them, we copy the feature columns that
+   * they test into a column-major buffer in which the examples are grouped by label. For each candidate, the
+   * number of examples of each label that would be sent left can then be computed by a single vectorisable
+   * pass over a contiguous range of each relevant column, without making any lists of examples. Only the
+   * winning candidate's split is actually materialised.
+   *
+   * If racing is enabled, the candidates are first evaluated on a random subsample of the examples, which is
+   * then repeatedly doubled in size until it contains all of them. After each round, the candidates whose gains
+   * are (by a Hoeffding bound) unlikely to come within reach of the best gain seen so far, or to exceed the gain
+   * threshold, are dropped. This makes it possible to consider many more candidates for the same cost, at the
+   * expense of occasionally dropping a candidate that would have won. The gains of the candidates that survive
+   * until the end are computed on all of the examples, exactly as they would be without racing.
+   *
+   * \param reservoir                 The reservoir of examples to split.
+   * \param candidateCount            The number of candidates to evaluate.
+   * \param gainThreshold             The minimum information gain that must be obtained from a split to make it worthwhile.
+   * \param inverseClassWeights       The (optional) inverses of the L1-normalised class frequencies observed in the training data.
+   * \param randomNumberGenerator     A random number generator.
+   * \param racingInitialSampleCount  The number of examples in the initial subsample used for racing (0 disables racing).
+   * \param racingConfidence          The confidence with which racing should avoid dropping the best candidate (in (0,1)).
+   * \return                          The chosen split, if one was suitable, or NULL otherwise.
    */
   Split_CPtr split_examples(const ExampleReservoir<Label>& reservoir, int candidateCount, float gainThreshold, const boost::optional<std::map<Label,float> >& inverseClassWeights,
-                            const tvgutil::RandomNumberGenerator_Ptr& randomNumberGenerator) const
+                            const tvgutil::RandomNumberGenerator_Ptr& randomNumberGenerator, size_t racingInitialSampleCount = 0, float racingConfidence = 0.0f) const
   {
-    std::vector<Example_CPtr> examples = reservoir.get_examples();
-    float initialEntropy = ExampleUtil::calculate_entropy(*reservoir.get_histogram(), inverseClassWeights);
+    const ExampleMatrix<Label>& examples = reservoir.get_examples();
+    float initialEntropy = ExampleUtil::calculate_entropy(reservoir.get_histogram(), inverseClassWeights);
 
 #if 0
-    std::cout << "\nP: " << *reservoir.get_histogram() << ' ' << initialEntropy << '\n';
+    std::cout << "\nP: " << reservoir.get_histogram() << ' ' << initialEntropy << '\n';
 #endif
 
-    // Generate the split candidates.
-    if(m_splitCandidates.size() != candidateCount) m_splitCandidates.resize(candidateCount);
+    // Generate the split candidates, and convert them to flat form so that they can be evaluated without virtual calls.
+    std::vector<DecisionFunction_Ptr> candidates(candidateCount);
+    std::vector<FlatDecisionFunction> flatCandidates(candidateCount);
     for(int i = 0; i < candidateCount; ++i)
     {
-      m_splitCandidates[i].m_decisionFunction = generate_candidate_decision_function(examples, randomNumberGenerator);
+      candidates[i] = generate_candidate_decision_function(examples, randomNumberGenerator);
+      flatCandidates[i] = candidates[i]->to_flat();
     }
 
-    // Pick the best split candidate and return it.
-    float bestGain = static_cast<float>(INT_MIN);
-    int bestIndex = -1;
+    // If there are no examples, no split can be worthwhile, so early out.
+    const size_t exampleCount = examples.size();
+    if(exampleCount == 0) return Split_CPtr();
 
-#ifdef WITH_OPENMP
-    #pragma omp parallel for
-#endif
+    // Determine the order in which the examples should be added to the subsample on which the candidates are evaluated.
+    // Without racing, all of the examples are evaluated at once, so the examples can simply be taken in row order.
+    const bool racing = racingInitialSampleCount > 0 && racingInitialSampleCount < exampleCount;
+    std::vector<size_t> sampleOrder(exampleCount);
+    for(size_t j = 0; j < exampleCount; ++j) sampleOrder[j] = j;
+    if(racing)
+    {
+      for(size_t j = exampleCount - 1; j > 0; --j)
+      {
+        std::swap(sampleOrder[j], sampleOrder[randomNumberGenerator->generate_int_from_uniform(0, static_cast<int>(j))]);
+      }
+    }
+
+    // Group the rows of the example matrix by label (keeping them in sample order within each label), and determine the
+    // weight to use for each label when calculating entropies.
+    std::map<Label,float> multipliers = reservoir.get_class_multipliers();
+    if(inverseClassWeights) multipliers = combine_multipliers(multipliers, *inverseClassWeights);
+
+    std::map<Label,std::vector<size_t> > rowsByLabel;
+    for(size_t j = 0; j < exampleCount; ++j)
+    {
+      rowsByLabel[examples.get_label(sampleOrder[j])].push_back(sampleOrder[j]);
+    }
+
+    std::vector<size_t> orderedRows, segmentStarts, totalCounts;
+    std::vector<float> labelWeights;
+    std::map<Label,size_t> labelIndices;
+    orderedRows.reserve(exampleCount);
+    for(typename std::map<Label,std::vector<size_t> >::const_iterator it = rowsByLabel.begin(), iend = rowsByLabel.end(); it != iend; ++it)
+    {
+      labelIndices.insert(std::make_pair(it->first, segmentStarts.size()));
+      segmentStarts.push_back(orderedRows.size());
+      totalCounts.push_back(it->second.size());
+      orderedRows.insert(orderedRows.end(), it->second.begin(), it->second.end());
+
+      // Note: Labels without a multiplier are left unscaled, as in ProbabilityMassFunction.
+      typename std::map<Label,float>::const_iterator jt = multipliers.find(it->first);
+      labelWeights.push_back(jt != multipliers.end() ? jt->second : 1.0f);
+    }
+    segmentStarts.push_back(exampleCount);
+
+    // Look up the label index of each example once, in sample order, so that the subsample can be grown without any map lookups.
+    std::vector<size_t> sampleLabelIndices(exampleCount);
+    for(size_t j = 0; j < exampleCount; ++j)
+    {
+      sampleLabelIndices[j] = labelIndices.find(examples.get_label(sampleOrder[j]))->second;
+    }
+
+    // Copy the feature columns tested by the candidates into a column-major buffer, using the grouped row order.
+    const size_t featureCount = examples.get_feature_count();
+    std::vector<int> columnIndices(featureCount, -1);
+    std::vector<size_t> usedFeatures;
     for(int i = 0; i < candidateCount; ++i)
     {
-#if 0 && WITH_OPENMP
-      int threadID = omp_get_thread_num();
-      int threadCount = omp_get_num_threads();
-      std::cout << "threadID=" << threadID << " threadCount=" << threadCount << '\n';
-#endif
+      const FlatDecisionFunction& f = flatCandidates[i];
+      if(columnIndices[f.firstFeatureIndex] == -1)
+      {
+        columnIndices[f.firstFeatureIndex] = static_cast<int>(usedFeatures.size());
+        usedFeatures.push_back(f.firstFeatureIndex);
+      }
+      if(f.op != FlatDecisionFunction::FO_FIRST && columnIndices[f.secondFeatureIndex] == -1)
+      {
+        columnIndices[f.secondFeatureIndex] = static_cast<int>(usedFeatures.size());
+        usedFeatures.push_back(f.secondFeatureIndex);
+      }
+    }
 
-#if 0
-      std::cout << *splitCandidate->m_decisionFunction << '\n';
-#endif
+    std::vector<float> columns(usedFeatures.size() * exampleCount);
+    for(size_t j = 0; j < exampleCount; ++j)
+    {
+      const float *features = examples.get_features(orderedRows[j]);
+      for(size_t c = 0, columnCount = usedFeatures.size(); c < columnCount; ++c)
+      {
+        columns[c * exampleCount + j] = features[usedFeatures[c]];
+      }
+    }
 
-      // Partition the examples using the split candidate's decision function.
-      m_splitCandidates[i].m_leftExamples.clear();
-      m_splitCandidates[i].m_rightExamples.clear();
-      for(size_t j = 0, size = examples.size(); j < size; ++j)
+    // Evaluate the split candidates in parallel on progressively larger subsamples of the examples (or just on all
+    // of the examples if racing is disabled), dropping the candidates that are unlikely to win after each round.
+    const size_t labelCount = totalCounts.size();
+    std::vector<int> candidateIndices(candidateCount);
+    for(int i = 0; i < candidateCount; ++i) candidateIndices[i] = i;
+    std::vector<float> gains(candidateCount, static_cast<float>(INT_MIN));
+    std::vector<size_t> leftCounts(candidateCount * labelCount, 0), rightCounts(candidateCount * labelCount, 0);
+    std::vector<size_t> rangeBegins(segmentStarts.begin(), segmentStarts.end() - 1), rangeEnds(rangeBegins);
+    std::vector<size_t> sampleCounts(labelCount, 0);
+
+    // Since the gain for any split lies in [0, log2(labelCount)], this is the range used by the Hoeffding bound. The
+    // permitted probability of error is shared between the candidates, which are each dropped at most once.
+    const float gainRange = labelCount > 1 ? log2(static_cast<float>(labelCount)) : 0.0f;
+    const float logInverseDelta = racing ? log(candidateCount / (1.0f - racingConfidence)) : 0.0f;
+
+    size_t sampleCount = racing ? racingInitialSampleCount : exampleCount;
+    size_t previousSampleCount = 0;
+    for(;;)
+    {
+      // Add the next examples in sample order to the subsample, and evaluate the surviving candidates on it.
+      for(size_t j = previousSampleCount; j < sampleCount; ++j)
       {
-        if(m_splitCandidates[i].m_decisionFunction->classify_descriptor(*examples[j]->get_descriptor()) == DecisionFunction::DC_LEFT)
-        {
-          m_splitCandidates[i].m_leftExamples.push_back(examples[j]);
-        }
-        else
-        {
-          m_splitCandidates[i].m_rightExamples.push_back(examples[j]);
-        }
+        ++sampleCounts[sampleLabelIndices[j]];
       }
 
-      // Calculate the information gain we would obtain from this split.
-      float gain = calculate_information_gain(reservoir, initialEntropy, m_splitCandidates[i].m_leftExamples, m_splitCandidates[i].m_rightExamples, inverseClassWeights);
+      for(size_t k = 0; k < labelCount; ++k)
+      {
+        rangeBegins[k] = rangeEnds[k];
+        rangeEnds[k] = segmentStarts[k] + sampleCounts[k];
+      }
 
-#ifdef WITH_OPENMP
-      #pragma omp critical
-#endif
+      const bool finalRound = sampleCount == exampleCount;
+      const float sampleEntropy = finalRound ? initialEntropy : ExampleUtil::calculate_entropy(&sampleCounts[0], &labelWeights[0], labelCount, sampleCount);
+      CandidateEvaluator evaluator = {
+        candidateIndices, columns, columnIndices, exampleCount, flatCandidates, gains, sampleEntropy, labelWeights, leftCounts, rangeBegins, rangeEnds, rightCounts, sampleCounts
+      };
+      tvgutil::ParallelUtil::parallel_for(0, static_cast<int>(candidateIndices.size()), evaluator);
+
+      if(finalRound) break;
+
+      // Drop any candidate whose gain is unlikely either to exceed the threshold or to lie within reach of the best gain.
+      const float epsilon = gainRange * sqrt(logInverseDelta / (2.0f * sampleCount));
+      float bestSampleGain = static_cast<float>(INT_MIN);
+      for(size_t i = 0, size = candidateIndices.size(); i < size; ++i)
       {
-        if(gain > bestGain)
-        {
-          if(gain > gainThreshold && !m_splitCandidates[i].m_leftExamples.empty() && !m_splitCandidates[i].m_rightExamples.empty())
-          {
-            bestGain = gain;
-            bestIndex = i;
-          }
-        }
+        bestSampleGain = std::max(bestSampleGain, gains[candidateIndices[i]]);
       }
+
+      std::vector<int> survivingIndices;
+      for(size_t i = 0, size = candidateIndices.size(); i < size; ++i)
+      {
+        const float gain = gains[candidateIndices[i]];
+        if(gain + 2 * epsilon >= bestSampleGain && gain + epsilon > gainThreshold) survivingIndices.push_back(candidateIndices[i]);
+        else gains[candidateIndices[i]] = static_cast<float>(INT_MIN);
+      }
+      candidateIndices.swap(survivingIndices);
+
+      // If no candidate is left, early out.
+      if(candidateIndices.empty()) return Split_CPtr();
+
+      previousSampleCount = sampleCount;
+      sampleCount = std::min(sampleCount * 2, exampleCount);
     }
 
-    Split_Ptr bestSplitCandidate;
-    if(bestIndex != -1) bestSplitCandidate.reset(new Split(m_splitCandidates[bestIndex]));
+    // Pick the best of the candidates that would produce a worthwhile split (i.e. whose gain exceeds the threshold, and that
+    // would not send all of the examples the same way). Ties are broken in favour of the earliest candidate, so that the
+    // result does not depend on the order in which the candidates were evaluated.
+    float bestGain = static_cast<float>(INT_MIN);
+    int bestIndex = -1;
+    for(size_t i = 0, size = candidateIndices.size(); i < size; ++i)
+    {
+      const int candidateIndex = candidateIndices[i];
+      size_t leftCount = 0;
+      for(size_t k = 0; k < labelCount; ++k) leftCount += leftCounts[candidateIndex * labelCount + k];
+      if(gains[candidateIndex] > gainThreshold && leftCount > 0 && leftCount < exampleCount && gains[candidateIndex] > bestGain)
+      {
+        bestGain = gains[candidateIndex];
+        bestIndex = candidateIndex;
+      }
+    }
+
+    // If no split had a high enough gain, early out.
+    if(bestIndex == -1) return Split_CPtr();
 
-    // Return a split candidate that had maximum gain (note that this may be NULL if no split had a high enough gain).
-    return bestSplitCandidate;
+    // Otherwise, materialise the split for the best candidate and return it.
+    Split_Ptr bestSplit(new Split);
+    bestSplit->m_decisionFunction = candidates[bestIndex];
+    const FlatDecisionFunction& bestFlat = flatCandidates[bestIndex];
+    for(size_t j = 0; j < exampleCount; ++j)
+    {
+      if(bestFlat.goes_left(examples.get_features(j))) bestSplit->m_leftRows.push_back(j);
+      else bestSplit->m_rightRows.push_back(j);
+    }
+
+    return bestSplit;
   }
 
   //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
 private:
   /**
-   * \brief Calculates the information gain that results from splitting an example reservoir in a particular way.
+   * \brief Calculates the information gain that results from splitting a set of examples in a particular way.
    *
-   * \param reservoir           The reservoir.
-   * \param initialEntropy      The entropy of the example set before the split.
-   * \param leftExamples        The examples that end up in the left half of the split.
-   * \param rightExamples       The examples that end up in the right half of the split.
-   * \param inverseClassWeights The (optional) inverses of the L1-normalised class frequencies observed in the training data.
-   * \return                    The information gain resulting from the split.
+   * \param initialEntropy  The entropy of the example set before the split.
+   * \param leftCounts      The number of examples of each label that end up in the left half of the split.
+   * \param rightCounts     A preallocated array of labelCount elements into which to write the number of examples of each label
+   *                        that end up in the right half of the split.
+   * \param totalCounts     The number of examples of each label in the example set before the split.
+   * \param labelWeights    The weight for each label.
+   * \param labelCount      The number of labels.
+   * \param leftCount       The number of examples that end up in the left half of the split.
+   * \param rightCount      The number of examples that end up in the right half of the split.
+   * \return                The information gain resulting from the split.
    */
-  static float calculate_information_gain(const ExampleReservoir<Label>& reservoir, float initialEntropy, const std::vector<Example_CPtr>& leftExamples, const std::vector<Example_CPtr>& rightExamples, const boost::optional<std::map<Label,float> >& inverseClassWeights)
+  static float calculate_information_gain(float initialEntropy, const size_t *leftCounts, size_t *rightCounts, const size_t *totalCounts,
+                                          const float *labelWeights, size_t labelCount, size_t leftCount, size_t rightCount)
   {
-    float exampleCount = static_cast<float>(reservoir.current_size());
-    std::map<Label,float> multipliers = reservoir.get_class_multipliers();
-    if(inverseClassWeights) multipliers = combine_multipliers(multipliers, *inverseClassWeights);
-
-    float leftEntropy = ExampleUtil::calculate_entropy(leftExamples, multipliers);
-    float rightEntropy = ExampleUtil::calculate_entropy(rightExamples, multipliers);
-    float leftWeight = leftExamples.size() / exampleCount;
-    float rightWeight = rightExamples.size() / exampleCount;
-
-#if 0
-    std::cout << "L: " << ExampleUtil::make_histogram(leftExamples) << ' ' << leftEntropy << '\n';
-    std::cout << "R: " << ExampleUtil::make_histogram(rightExamples) << ' ' << rightEntropy << '\n';
-#endif
+    for(size_t k = 0; k < labelCount; ++k) rightCounts[k] = totalCounts[k] - leftCounts[k];
 
+    float exampleCount = static_cast<float>(leftCount + rightCount);
+    float leftEntropy = ExampleUtil::calculate_entropy(leftCounts, labelWeights, labelCount, leftCount);
+    float rightEntropy = ExampleUtil::calculate_entropy(rightCounts, labelWeights, labelCount, rightCount);
+    float leftWeight = leftCount / exampleCount;
+    float rightWeight = rightCount / exampleCount;
     float gain = initialEntropy - (leftWeight * leftEntropy + rightWeight * rightEntropy);
 
 #if 0
-    std::cout << "Gain: " << gain << '\n';
+    std::cout << "L: " << leftEntropy << " R: " << rightEntropy << " Gain: " << gain << '\n';
 #endif
 
     return gain;
@@ -242,6 +456,37 @@ private:
 
     return result;
   }
+
+  /**
+   * \brief Counts the examples in a contiguous range of rows of a column-major feature buffer that a flat decision function would send left.
+   *
+   * Each branch is a simple loop over contiguous memory with no data-dependent control flow, which the compiler can vectorise.
+   *
+   * \param op        The way in which the decision function computes the value to compare to the threshold.
+   * \param first     The column containing the first feature tested by the decision function.
+   * \param second    The column containing the second feature tested by the decision function (unused if op is FO_FIRST).
+   * \param threshold The threshold against which the decision function compares its value.
+   * \param begin     The first row in the range.
+   * \param end       One past the last row in the range.
+   * \return          The number of examples in the range that the decision function would send left.
+   */
+  static size_t count_left(FlatDecisionFunction::Op op, const float *first, const float *second, float threshold, size_t begin, size_t end)
+  {
+    size_t result = 0;
+    switch(op)
+    {
+      case FlatDecisionFunction::FO_ADD:
+        for(size_t j = begin; j < end; ++j) result += first[j] + second[j] < threshold ? 1 : 0;
+        break;
+      case FlatDecisionFunction::FO_SUBTRACT:
+        for(size_t j = begin; j < end; ++j) result += first[j] - second[j] < threshold ? 1 : 0;
+        break;
+      default:
+        for(size_t j = begin; j < end; ++j) result += first[j] < threshold ? 1 : 0;
+        break;
+    }
+    return result;
+  }
 };
 
 }
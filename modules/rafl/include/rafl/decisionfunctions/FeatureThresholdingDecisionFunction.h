@@ -46,11 +46,14 @@ private:
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
-  virtual DescriptorClassification classify_descriptor(const Descriptor& descriptor) const;
+  virtual DescriptorClassification classify_features(const float *features) const;
 
   /** Override */
   virtual void output(std::ostream& os) const;
 
+  /** Override */
+  virtual FlatDecisionFunction to_flat() const;
+
   //#################### SERIALIZATION #################### 
 private:
   /**
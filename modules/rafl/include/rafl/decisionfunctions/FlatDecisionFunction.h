@@ -0,0 +1,81 @@
+/**
+ * rafl: FlatDecisionFunction.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#ifndef H_RAFL_FLATDECISIONFUNCTION
+#define H_RAFL_FLATDECISIONFUNCTION
+
+namespace rafl {
+
+/**
+ * \brief An instance of this struct represents a decision function in a flat form that can be evaluated without virtual dispatch.
+ *
+ * The decision function computes a value from at most two features of a descriptor (either the first feature on its own,
+ * or the sum or difference of the two features), and sends the descriptor down the left subtree of the node iff this value
+ * is less than the threshold. This is general enough to represent all of the decision functions that rafl provides.
+ */
+struct FlatDecisionFunction
+{
+  //#################### ENUMERATIONS ####################
+
+  /**
+   * \brief An enumeration specifying the possible ways in which the value to compare to the threshold can be computed.
+   */
+  enum Op
+  {
+    /** Use the first feature on its own. */
+    FO_FIRST,
+
+    /** Add the two features. */
+    FO_ADD,
+
+    /** Subtract the second feature from the first. */
+    FO_SUBTRACT
+  };
+
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The index of the first feature. */
+  unsigned int firstFeatureIndex;
+
+  /** The way in which to compute the value to compare to the threshold. */
+  Op op;
+
+  /** The index of the second feature (unused if op is FO_FIRST). */
+  unsigned int secondFeatureIndex;
+
+  /** The threshold against which to compare the value. */
+  float threshold;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Determines whether the specified descriptor should be sent down the left subtree of the node.
+   *
+   * \param descriptor  A pointer to the features of the descriptor.
+   * \return            true, if the descriptor should be sent down the left subtree of the node, or false otherwise.
+   */
+  bool goes_left(const float *descriptor) const
+  {
+    float value = descriptor[firstFeatureIndex];
+    if(op == FO_ADD) value += descriptor[secondFeatureIndex];
+    else if(op == FO_SUBTRACT) value -= descriptor[secondFeatureIndex];
+    return value < threshold;
+  }
+
+  /**
+   * \brief Gets the number of features that a descriptor must have in order to be evaluated by the decision function.
+   *
+   * \return  The number of features that a descriptor must have in order to be evaluated by the decision function.
+   */
+  unsigned int get_min_descriptor_size() const
+  {
+    const unsigned int lastFeatureIndex = op == FO_FIRST || firstFeatureIndex > secondFeatureIndex ? firstFeatureIndex : secondFeatureIndex;
+    return lastFeatureIndex + 1;
+  }
+};
+
+}
+
+#endif
@@ -65,11 +65,11 @@ public:
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
-  virtual DecisionFunction_Ptr generate_candidate_decision_function(const std::vector<Example_CPtr>& examples, const tvgutil::RandomNumberGenerator_Ptr& randomNumberGenerator) const
+  virtual DecisionFunction_Ptr generate_candidate_decision_function(const ExampleMatrix<Label>& examples, const tvgutil::RandomNumberGenerator_Ptr& randomNumberGenerator) const
   {
     assert(!examples.empty());
 
-    int descriptorSize = static_cast<int>(examples[0]->get_descriptor()->size());
+    int descriptorSize = static_cast<int>(examples.get_feature_count());
     std::pair<int,int> featureIndexRange = this->get_feature_index_range(descriptorSize);
 
     // Pick the first random feature in the descriptor.
@@ -86,8 +86,8 @@ public:
     // the result of applying the pairwise operation to the chosen features
     // from that example as the threshold.
     int exampleIndex = randomNumberGenerator->generate_int_from_uniform(0, static_cast<int>(examples.size()) - 1);
-    const Descriptor& descriptor = (*examples[exampleIndex]->get_descriptor());
-    float threshold = PairwiseOpAndThresholdDecisionFunction::apply_op(op, descriptor[firstFeatureIndex], descriptor[secondFeatureIndex]);
+    const float *features = examples.get_features(exampleIndex);
+    float threshold = PairwiseOpAndThresholdDecisionFunction::apply_op(op, features[firstFeatureIndex], features[secondFeatureIndex]);
 
     return DecisionFunction_Ptr(new PairwiseOpAndThresholdDecisionFunction(
       firstFeatureIndex,
@@ -0,0 +1,64 @@
+/**
+ * rafl: ChunkedExampleFile.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_RAFL_CHUNKEDEXAMPLEFILE
+#define H_RAFL_CHUNKEDEXAMPLEFILE
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace rafl {
+
+/**
+ * \brief This struct describes the binary file format used to store large sets of examples as a sequence of chunks.
+ *
+ * A chunked example file starts with a header, consisting of the file signature, the version of the file format and
+ * the number of features in each example's descriptor (all as 32-bit values, apart from the signature). This is followed
+ * by any number of chunks, each of which consists of the number of examples in the chunk (a 32-bit unsigned integer),
+ * the labels of the examples (as 32-bit signed integers) and the features of the examples (as a row-major matrix of
+ * floats, one row per example). A file can thus be written and read one chunk at a time, so that the memory needed
+ * to process it is bounded by the size of a chunk rather than by the size of the file. As with compiled forest files,
+ * the file format is that of the machine on which the file was written (in practice, little-endian).
+ */
+struct ChunkedExampleFile
+{
+  //#################### CONSTANTS ####################
+
+  /** The version of the file format. */
+  enum { FILE_FORMAT_VERSION = 1 };
+
+  /** The size of the signature with which every chunked example file starts. */
+  enum { SIGNATURE_SIZE = 8 };
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Determines whether or not the specified file contains chunked examples.
+   *
+   * \param path  The path to the file.
+   * \return      true, if the file exists and starts with the chunked example file signature, or false otherwise.
+   */
+  static bool is_chunked_example_file(const std::string& path)
+  {
+    std::ifstream fs(path.c_str(), std::ios::binary);
+    char signature[SIGNATURE_SIZE];
+    return fs.read(signature, sizeof(signature)) && memcmp(signature, get_signature(), sizeof(signature)) == 0;
+  }
+
+  /**
+   * \brief Gets the signature with which every chunked example file starts.
+   *
+   * \return  The signature (an array of SIGNATURE_SIZE characters).
+   */
+  static const char *get_signature()
+  {
+    return "RAFLCEX";
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * rafl: ChunkedExampleReader.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_RAFL_CHUNKEDEXAMPLEREADER
+#define H_RAFL_CHUNKEDEXAMPLEREADER
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "ChunkedExampleFile.h"
+#include "ExampleMatrix.h"
+
+namespace rafl {
+
+/**
+ * \brief An instance of an instantiation of this class template can be used to read the examples in a chunked example file
+ *        (see ChunkedExampleFile) one chunk at a time.
+ *
+ * \tparam Label  The type of label used by the examples. Must be an integral type.
+ */
+template <typename Label>
+class ChunkedExampleReader
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of features in each example's descriptor. */
+  size_t m_featureCount;
+
+  /** The buffer into which the features of each chunk are read. */
+  std::vector<float> m_features;
+
+  /** The buffer into which the labels of each chunk are read. */
+  std::vector<boost::int32_t> m_fileLabels;
+
+  /** The stream from which to read the chunks. */
+  std::ifstream m_fs;
+
+  /** The labels of the examples in the most recently read chunk, converted to the label type. */
+  std::vector<Label> m_labels;
+
+  /** The path to the file. */
+  std::string m_path;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a reader for the specified chunked example file, and reads its header.
+   *
+   * \param path                The path to the file.
+   * \throws std::runtime_error If the file cannot be opened, or is not a chunked example file of a supported version.
+   */
+  explicit ChunkedExampleReader(const std::string& path)
+  : m_fs(path.c_str(), std::ios::binary), m_path(path)
+  {
+    if(!m_fs) throw std::runtime_error("Error: Could not open chunked example file '" + path + "' for reading");
+
+    char signature[ChunkedExampleFile::SIGNATURE_SIZE];
+    if(!m_fs.read(signature, sizeof(signature)) || memcmp(signature, ChunkedExampleFile::get_signature(), sizeof(signature)) != 0)
+    {
+      throw std::runtime_error("Error: '" + path + "' is not a chunked example file");
+    }
+
+    if(read_value<boost::uint32_t>() != ChunkedExampleFile::FILE_FORMAT_VERSION)
+    {
+      throw std::runtime_error("Error: '" + path + "' was written using an unsupported version of the chunked example file format");
+    }
+
+    m_featureCount = read_value<boost::uint32_t>();
+    if(!m_fs || m_featureCount == 0) throw std::runtime_error("Error: The header of chunked example file '" + path + "' is corrupt");
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ChunkedExampleReader(const ChunkedExampleReader&);
+  ChunkedExampleReader& operator=(const ChunkedExampleReader&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the number of features in each example's descriptor.
+   *
+   * \return  The number of features in each example's descriptor.
+   */
+  size_t get_feature_count() const
+  {
+    return m_featureCount;
+  }
+
+  /**
+   * \brief Reads the next non-empty chunk of examples from the file (if any).
+   *
+   * The chunk's storage (and the reader's own buffers) are reused from one call to the next, so reading a whole file
+   * in this way needs only as much memory as its largest chunk.
+   *
+   * \param chunk               An example matrix into which to read the chunk (any existing examples in it are removed).
+   * \return                    true, if a chunk was read, or false if the end of the file has been reached.
+   * \throws std::runtime_error If the file is truncated.
+   */
+  bool read_chunk(ExampleMatrix<Label>& chunk)
+  {
+    chunk.clear();
+
+    while(chunk.empty())
+    {
+      const boost::uint32_t exampleCount = read_value<boost::uint32_t>();
+      if(m_fs.gcount() == 0 && m_fs.eof()) return false;
+      if(!m_fs) throw std::runtime_error("Error: Chunked example file '" + m_path + "' is truncated");
+
+      m_fileLabels.resize(exampleCount);
+      m_features.resize(static_cast<size_t>(exampleCount) * m_featureCount);
+      read_array(m_fileLabels);
+      read_array(m_features);
+      if(!m_fs) throw std::runtime_error("Error: Chunked example file '" + m_path + "' is truncated");
+
+      m_labels.assign(m_fileLabels.begin(), m_fileLabels.end());
+      if(exampleCount > 0) chunk.add_examples(&m_features[0], m_featureCount, &m_labels[0], exampleCount);
+    }
+
+    return true;
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Reads an array of values from the file.
+   *
+   * \param arr The array into which to read the values (its size determines the number of values read).
+   */
+  template <typename T>
+  void read_array(std::vector<T>& arr)
+  {
+    if(!arr.empty()) m_fs.read(reinterpret_cast<char*>(&arr[0]), arr.size() * sizeof(T));
+  }
+
+  /**
+   * \brief Reads a value from the file.
+   *
+   * \return  The value (or zero, if it could not be read).
+   */
+  template <typename T>
+  T read_value()
+  {
+    T value = 0;
+    m_fs.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * rafl: ChunkedExampleWriter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_RAFL_CHUNKEDEXAMPLEWRITER
+#define H_RAFL_CHUNKEDEXAMPLEWRITER
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "ChunkedExampleFile.h"
+
+namespace rafl {
+
+/**
+ * \brief An instance of an instantiation of this class template can be used to write examples to a chunked example file
+ *        (see ChunkedExampleFile).
+ *
+ * Examples are buffered until a full chunk has been accumulated, at which point the chunk is written to the file,
+ * so the memory needed to write a file is bounded by the chunk size rather than by the number of examples.
+ *
+ * \tparam Label  The type of label used by the examples. Must be an integral type whose values fit in 32 bits.
+ */
+template <typename Label>
+class ChunkedExampleWriter
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The maximum number of examples in each chunk. */
+  size_t m_chunkSize;
+
+  /** The number of features in each example's descriptor. */
+  size_t m_featureCount;
+
+  /** The features of the examples in the current chunk. */
+  std::vector<float> m_features;
+
+  /** The stream to which to write the chunks. */
+  std::ofstream m_fs;
+
+  /** The labels of the examples in the current chunk. */
+  std::vector<boost::int32_t> m_labels;
+
+  /** The path to the file. */
+  std::string m_path;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a writer for a new chunked example file, and writes its header.
+   *
+   * \param path                    The path to the file.
+   * \param featureCount            The number of features in each example's descriptor.
+   * \param chunkSize               The maximum number of examples in each chunk.
+   * \throws std::invalid_argument  If the feature count or the chunk size is zero.
+   * \throws std::runtime_error     If the file cannot be opened for writing.
+   */
+  ChunkedExampleWriter(const std::string& path, size_t featureCount, size_t chunkSize = 65536)
+  : m_chunkSize(chunkSize), m_featureCount(featureCount), m_fs(path.c_str(), std::ios::binary), m_path(path)
+  {
+    if(featureCount == 0 || chunkSize == 0) throw std::invalid_argument("Error: The feature count and chunk size of a chunked example file must be non-zero");
+    if(!m_fs) throw std::runtime_error("Error: Could not open chunked example file '" + path + "' for writing");
+
+    m_features.reserve(chunkSize * featureCount);
+    m_labels.reserve(chunkSize);
+
+    m_fs.write(ChunkedExampleFile::get_signature(), ChunkedExampleFile::SIGNATURE_SIZE);
+    write_value<boost::uint32_t>(ChunkedExampleFile::FILE_FORMAT_VERSION);
+    write_value<boost::uint32_t>(static_cast<boost::uint32_t>(featureCount));
+  }
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the writer, writing any examples that have not yet been written to the file.
+   *
+   * \note  Any error that occurs whilst doing so is silently ignored: call close() to detect such errors.
+   */
+  ~ChunkedExampleWriter()
+  {
+    try { close(); }
+    catch(std::exception&) {}
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ChunkedExampleWriter(const ChunkedExampleWriter&);
+  ChunkedExampleWriter& operator=(const ChunkedExampleWriter&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds an example to the file.
+   *
+   * \param features                The features of the example's descriptor.
+   * \param featureCount            The number of features in the example's descriptor.
+   * \param label                   The label of the example.
+   * \throws std::invalid_argument  If the example's descriptor does not have the number of features specified on construction.
+   * \throws std::runtime_error     If the writer has been closed, or the chunk containing the example cannot be written.
+   */
+  void add_example(const float *features, size_t featureCount, const Label& label)
+  {
+    if(featureCount != m_featureCount)
+    {
+      throw std::invalid_argument("Error: Expected an example with " + boost::lexical_cast<std::string>(m_featureCount) + " features, not " + boost::lexical_cast<std::string>(featureCount));
+    }
+
+    if(!m_fs.is_open()) throw std::runtime_error("Error: Cannot add an example to chunked example file '" + m_path + "' after it has been closed");
+
+    m_features.insert(m_features.end(), features, features + featureCount);
+    m_labels.push_back(static_cast<boost::int32_t>(label));
+    if(m_labels.size() == m_chunkSize) write_chunk();
+  }
+
+  /**
+   * \brief Writes any examples that have not yet been written to the file, and closes it.
+   *
+   * \throws std::runtime_error If the file cannot be written.
+   */
+  void close()
+  {
+    if(!m_fs.is_open()) return;
+
+    if(!m_labels.empty()) write_chunk();
+    m_fs.close();
+    if(!m_fs) throw std::runtime_error("Error: Could not write chunked example file '" + m_path + "'");
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the examples in the current chunk to the file, and starts a new chunk.
+   *
+   * \throws std::runtime_error If the chunk cannot be written.
+   */
+  void write_chunk()
+  {
+    write_value<boost::uint32_t>(static_cast<boost::uint32_t>(m_labels.size()));
+    m_fs.write(reinterpret_cast<const char*>(&m_labels[0]), m_labels.size() * sizeof(boost::int32_t));
+    m_fs.write(reinterpret_cast<const char*>(&m_features[0]), m_features.size() * sizeof(float));
+    if(!m_fs) throw std::runtime_error("Error: Could not write chunked example file '" + m_path + "'");
+
+    m_features.clear();
+    m_labels.clear();
+  }
+
+  /**
+   * \brief Writes a value to the file.
+   *
+   * \param value The value.
+   */
+  template <typename T>
+  void write_value(const T& value)
+  {
+    m_fs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+};
+
+}
+
+#endif
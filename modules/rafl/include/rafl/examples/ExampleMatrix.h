@@ -0,0 +1,308 @@
+/**
+ * rafl: ExampleMatrix.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#ifndef H_RAFL_EXAMPLEMATRIX
+#define H_RAFL_EXAMPLEMATRIX
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/split_member.hpp>
+
+#include "Example.h"
+
+namespace rafl {
+
+/**
+ * \brief An instance of an instantiation of this class template represents a set of training examples that are stored
+ *        contiguously, as a row-major matrix of features together with a vector of labels.
+ *
+ * Each row of the matrix holds the feature descriptor of one example. Storing the examples in this way (rather than as
+ * a vector of separately-allocated Example objects) allows them to be added in bulk and scanned linearly, which is what
+ * both adding examples to a forest and evaluating candidate splits do.
+ */
+template <typename Label>
+class ExampleMatrix
+{
+  //#################### TYPEDEFS ####################
+private:
+  typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of features in each example's descriptor (0 until the first example is added, if not specified on construction). */
+  size_t m_featureCount;
+
+  /** The features of the examples, stored in row-major order (one row per example). */
+  std::vector<float> m_features;
+
+  /** The labels of the examples. */
+  std::vector<Label> m_labels;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an empty example matrix.
+   *
+   * \param featureCount  The number of features in each example's descriptor (if 0, this will be determined by the first example added).
+   */
+  explicit ExampleMatrix(size_t featureCount = 0)
+  : m_featureCount(featureCount)
+  {}
+
+  /**
+   * \brief Constructs an example matrix from a set of examples.
+   *
+   * \param examples              The examples.
+   * \throws std::invalid_argument  If the examples' descriptors are not all of the same size.
+   */
+  explicit ExampleMatrix(const std::vector<Example_CPtr>& examples)
+  : m_featureCount(0)
+  {
+    if(!examples.empty()) reserve(examples.size(), examples[0]->get_descriptor()->size());
+    for(typename std::vector<Example_CPtr>::const_iterator it = examples.begin(), iend = examples.end(); it != iend; ++it)
+    {
+      add_example(**it);
+    }
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds an example to the matrix.
+   *
+   * \param example                 The example to add.
+   * \return                        The index of the row in which the example has been stored.
+   * \throws std::invalid_argument  If the example's descriptor is not of the same size as the descriptors already in the matrix.
+   */
+  size_t add_example(const Example<Label>& example)
+  {
+    const Descriptor& descriptor = *example.get_descriptor();
+    return add_example(&descriptor[0], descriptor.size(), example.get_label());
+  }
+
+  /**
+   * \brief Adds an example to the matrix.
+   *
+   * \param features                The features of the example's descriptor.
+   * \param featureCount            The number of features in the example's descriptor.
+   * \param label                   The label of the example.
+   * \return                        The index of the row in which the example has been stored.
+   * \throws std::invalid_argument  If the example's descriptor is not of the same size as the descriptors already in the matrix.
+   */
+  size_t add_example(const float *features, size_t featureCount, const Label& label)
+  {
+    add_examples(features, featureCount, &label, 1);
+    return m_labels.size() - 1;
+  }
+
+  /**
+   * \brief Adds a set of examples whose descriptors are stored contiguously (one after the other) to the matrix.
+   *
+   * \param features                The features of the examples' descriptors.
+   * \param featureCount            The number of features in each example's descriptor.
+   * \param labels                  The labels of the examples.
+   * \param exampleCount            The number of examples to add.
+   * \throws std::invalid_argument  If the examples' descriptors are not of the same size as the descriptors already in the matrix.
+   */
+  void add_examples(const float *features, size_t featureCount, const Label *labels, size_t exampleCount)
+  {
+    ensure_feature_count(featureCount);
+    m_features.insert(m_features.end(), features, features + featureCount * exampleCount);
+    m_labels.insert(m_labels.end(), labels, labels + exampleCount);
+  }
+
+  /**
+   * \brief Removes all of the examples from the matrix.
+   */
+  void clear()
+  {
+    m_features.clear();
+    m_labels.clear();
+  }
+
+  /**
+   * \brief Gets whether or not the matrix is empty.
+   *
+   * \return  true, if the matrix contains no examples, or false otherwise.
+   */
+  bool empty() const
+  {
+    return m_labels.empty();
+  }
+
+  /**
+   * \brief Gets the number of features in each example's descriptor.
+   *
+   * \return  The number of features in each example's descriptor.
+   */
+  size_t get_feature_count() const
+  {
+    return m_featureCount;
+  }
+
+  /**
+   * \brief Gets the number of bytes of storage currently allocated for the examples in the matrix.
+   *
+   * \return  The number of bytes of storage currently allocated for the examples in the matrix.
+   */
+  size_t get_memory_usage() const
+  {
+    return m_features.capacity() * sizeof(float) + m_labels.capacity() * sizeof(Label);
+  }
+
+  /**
+   * \brief Gets the features of the descriptor of the specified example.
+   *
+   * \param row The index of the example's row in the matrix.
+   * \return    A pointer to the features of the example's descriptor.
+   */
+  const float *get_features(size_t row) const
+  {
+    return &m_features[row * m_featureCount];
+  }
+
+  /**
+   * \brief Gets the label of the specified example.
+   *
+   * \param row The index of the example's row in the matrix.
+   * \return    The label of the example.
+   */
+  const Label& get_label(size_t row) const
+  {
+    return m_labels[row];
+  }
+
+  /**
+   * \brief Makes a standalone copy of the specified example.
+   *
+   * \param row The index of the example's row in the matrix.
+   * \return    A copy of the example.
+   */
+  Example_CPtr make_example(size_t row) const
+  {
+    const float *features = get_features(row);
+    Descriptor_CPtr descriptor(new Descriptor(features, features + m_featureCount));
+    return Example_CPtr(new Example<Label>(descriptor, m_labels[row]));
+  }
+
+  /**
+   * \brief Reserves space in the matrix for the specified number of examples.
+   *
+   * \param exampleCount  The number of examples for which to reserve space.
+   * \param featureCount  The number of features in each example's descriptor.
+   * \throws std::invalid_argument  If the feature count differs from that of the descriptors already in the matrix.
+   */
+  void reserve(size_t exampleCount, size_t featureCount)
+  {
+    ensure_feature_count(featureCount);
+    m_features.reserve(exampleCount * featureCount);
+    m_labels.reserve(exampleCount);
+  }
+
+  /**
+   * \brief Replaces the specified example in the matrix with a new example.
+   *
+   * \param row                     The index of the row containing the example to replace.
+   * \param features                The features of the new example's descriptor.
+   * \param featureCount            The number of features in the new example's descriptor.
+   * \param label                   The label of the new example.
+   * \throws std::invalid_argument  If the new example's descriptor is not of the same size as the descriptors already in the matrix.
+   */
+  void set_example(size_t row, const float *features, size_t featureCount, const Label& label)
+  {
+    ensure_feature_count(featureCount);
+    std::copy(features, features + featureCount, m_features.begin() + row * m_featureCount);
+    m_labels[row] = label;
+  }
+
+  /**
+   * \brief Gets the number of examples in the matrix.
+   *
+   * \return  The number of examples in the matrix.
+   */
+  size_t size() const
+  {
+    return m_labels.size();
+  }
+
+  /**
+   * \brief Swaps the contents (and allocated storage) of this matrix with those of another one.
+   *
+   * \param rhs The matrix with which to swap contents.
+   */
+  void swap(ExampleMatrix& rhs)
+  {
+    std::swap(m_featureCount, rhs.m_featureCount);
+    m_features.swap(rhs.m_features);
+    m_labels.swap(rhs.m_labels);
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Ensures that the matrix stores descriptors with the specified number of features.
+   *
+   * If the matrix is empty and its feature count has not yet been determined, it is set to the specified value.
+   *
+   * \param featureCount            The number of features.
+   * \throws std::invalid_argument  If the matrix already stores descriptors with a different number of features.
+   */
+  void ensure_feature_count(size_t featureCount)
+  {
+    if(m_featureCount == featureCount) return;
+    if(m_featureCount == 0 && m_labels.empty()) m_featureCount = featureCount;
+    else throw std::invalid_argument("Error: All of the examples in an example matrix must have the same number of features");
+  }
+
+  //#################### SERIALIZATION ####################
+private:
+  /**
+   * \brief Loads the example matrix from an archive.
+   *
+   * \param ar      The archive.
+   * \param version The file format version number.
+   */
+  template <typename Archive>
+  void load(Archive& ar, const unsigned int version)
+  {
+    size_t featureSize;
+    ar & m_featureCount;
+    ar & featureSize;
+    m_features.resize(featureSize);
+    if(featureSize > 0) ar & boost::serialization::make_array(&m_features[0], featureSize);
+    ar & m_labels;
+  }
+
+  /**
+   * \brief Saves the example matrix to an archive.
+   *
+   * Note that the features are saved as a plain array rather than as a vector. Descriptors (which are also vectors of floats) are
+   * serialized via pointers elsewhere, which causes Boost to track vectors of floats in some translation units but not others.
+   *
+   * \param ar      The archive.
+   * \param version The file format version number.
+   */
+  template <typename Archive>
+  void save(Archive& ar, const unsigned int version) const
+  {
+    const size_t featureSize = m_features.size();
+    ar & m_featureCount;
+    ar & featureSize;
+    if(featureSize > 0) ar & boost::serialization::make_array(&m_features[0], featureSize);
+    ar & m_labels;
+  }
+
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+  friend class boost::serialization::access;
+};
+
+}
+
+#endif
@@ -9,19 +9,26 @@
 #include <algorithm>
 #include <cassert>
 #include <iosfwd>
-#include <iterator>
 #include <map>
 #include <vector>
 
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
+
 #include <tvgutil/numbers/RandomNumberGenerator.h>
 #include <tvgutil/statistics/Histogram.h>
 
-#include "Example.h"
+#include "ExampleMatrix.h"
 
 namespace rafl {
 
 /**
  * \brief An instance of an instantiation of this class template represents a reservoir to store the examples for a node.
+ *
+ * The examples are stored contiguously in an example matrix, and the reservoir keeps track of which rows of the matrix
+ * hold the examples for each class. Examples that are replaced have their rows overwritten in place. The storage for
+ * the matrix can be handed from one reservoir to another (see swap_storage), so that the owner of a set of reservoirs
+ * can recycle it rather than freeing and reallocating it.
  */
 template <typename Label>
 class ExampleReservoir
@@ -30,7 +37,6 @@ class ExampleReservoir
 private:
   typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
   typedef boost::shared_ptr<tvgutil::Histogram<Label> > Histogram_Ptr;
-  typedef boost::shared_ptr<const tvgutil::Histogram<Label> > Histogram_CPtr;
 
   //#################### PRIVATE VARIABLES ####################
 private:
@@ -38,10 +44,10 @@ private:
   size_t m_curSize;
 
   /** The examples in the reservoir. */
-  std::map<Label,std::vector<Example_CPtr> > m_examples;
+  ExampleMatrix<Label> m_examples;
 
   /** The histogram of the label distribution of all of the examples that have ever been added to the reservoir. */
-  Histogram_Ptr m_histogram;
+  tvgutil::Histogram<Label> m_histogram;
 
   /** The maximum number of examples of each class allowed in the reservoir at any one time. */
   size_t m_maxClassSize;
@@ -49,6 +55,9 @@ private:
   /** A random number generator. */
   tvgutil::RandomNumberGenerator_Ptr m_randomNumberGenerator;
 
+  /** The indices of the rows of the example matrix that hold the examples for each class. */
+  std::map<Label,std::vector<size_t> > m_rowsByClass;
+
   /** The total number of examples that have been added to the reservoir over time. */
   size_t m_seenExamples;
 
@@ -64,15 +73,17 @@ public:
    * \param randomNumberGenerator A random number generator.
    */
   ExampleReservoir(size_t maxClassSize, const tvgutil::RandomNumberGenerator_Ptr& randomNumberGenerator)
-  : m_curSize(0), m_histogram(new tvgutil::Histogram<Label>), m_maxClassSize(maxClassSize), m_randomNumberGenerator(randomNumberGenerator), m_seenExamples(0)
+  : m_curSize(0), m_maxClassSize(maxClassSize), m_randomNumberGenerator(randomNumberGenerator), m_seenExamples(0)
   {}
 
   /**
    * \brief Constructs an example reservoir.
    *
-   * Note: This constructor is needed for serialization and should not be used otherwise.
+   * Note: This constructor is needed for serialization (and to allow empty reservoirs to be swapped into) and should not be used otherwise.
    */
-  ExampleReservoir() {}
+  ExampleReservoir()
+  : m_curSize(0), m_maxClassSize(0), m_seenExamples(0)
+  {}
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -87,41 +98,62 @@ public:
    * \return        true, if the example was actually added to the reservoir, or false otherwise.
    */
   bool add_example(const Example_CPtr& example)
+  {
+    const Descriptor& descriptor = *example->get_descriptor();
+    return add_example(&descriptor[0], descriptor.size(), example->get_label());
+  }
+
+  /**
+   * \brief Adds an example to the reservoir.
+   *
+   * If there is already a full complement of examples for the class corresponding to the new example's label in the reservoir,
+   * an older example of that class may be (randomly) discarded to make space for the new one. If not, the new example itself
+   * is discarded. The example's features are copied into the reservoir.
+   *
+   * \param features      The features of the example's descriptor.
+   * \param featureCount  The number of features in the example's descriptor.
+   * \param label         The label of the example.
+   * \return              true, if the example was actually added to the reservoir, or false otherwise.
+   */
+  bool add_example(const float *features, size_t featureCount, const Label& label)
   {
     bool changed = false;
 
-    std::vector<Example_CPtr>& examplesForClass = m_examples[example->get_label()];
-    if(examplesForClass.size() < m_maxClassSize)
+    std::vector<size_t>& rowsForClass = m_rowsByClass[label];
+    if(rowsForClass.size() < m_maxClassSize)
     {
       // If we haven't yet reached the maximum number of examples for this class, simply add the new one.
-      examplesForClass.push_back(example);
+      rowsForClass.push_back(m_examples.add_example(features, featureCount, label));
       ++m_curSize;
       changed = true;
     }
     else
     {
       // Otherwise, randomly decide whether or not to replace one of the existing examples for this class with the new one.
-      size_t binSize = m_histogram->get_bins().find(example->get_label())->second;
+      size_t binSize = m_histogram.get_bin_count(label);
       size_t k = m_randomNumberGenerator->generate_int_from_uniform(0, static_cast<int>(binSize) - 1);
-      if(k < examplesForClass.size())
+      if(k < rowsForClass.size())
       {
-        examplesForClass[k] = example;
+        m_examples.set_example(rowsForClass[k], features, featureCount, label);
         changed = true;
       }
     }
 
-    m_histogram->add(example->get_label());
+    m_histogram.add(label);
     ++m_seenExamples;
     return changed;
   }
 
   /**
    * \brief Clears the reservoir.
+   *
+   * Note that the storage for the examples is retained, and can be passed on to another reservoir using swap_storage.
    */
   void clear()
   {
     m_examples.clear();
-    m_histogram.reset();
+    m_rowsByClass.clear();
+    m_histogram.clear();
     m_randomNumberGenerator.reset();
   }
 
@@ -144,13 +176,13 @@ public:
   {
     std::map<Label,float> result;
 
-    const std::map<Label,size_t>& bins = m_histogram->get_bins();
-    typename std::map<Label,std::vector<Example_CPtr> >::const_iterator it = m_examples.begin(), iend = m_examples.end();
+    const std::map<Label,size_t>& bins = m_histogram.get_bins();
+    typename std::map<Label,std::vector<size_t> >::const_iterator it = m_rowsByClass.begin(), iend = m_rowsByClass.end();
     typename std::map<Label,size_t>::const_iterator jt = bins.begin();
     for(; it != iend; ++it, ++jt)
     {
       assert(it->first == jt->first);
-      result.insert(std::make_pair(it->first, static_cast<float>(jt->second) / it->second.size()));
+      result.insert(result.end(), std::make_pair(it->first, static_cast<float>(jt->second) / it->second.size()));
     }
 
     return result;
@@ -159,17 +191,11 @@ public:
   /**
    * \brief Gets the examples currently in the reservoir.
    *
-   * \return  The examples currently in the reservoir.
+   * \return  The examples currently in the reservoir, stored contiguously in an example matrix.
    */
-  std::vector<Example_CPtr> get_examples() const
+  const ExampleMatrix<Label>& get_examples() const
   {
-    std::vector<Example_CPtr> examples;
-    examples.reserve(m_curSize);
-    for(typename std::map<Label,std::vector<Example_CPtr> >::const_iterator it = m_examples.begin(), iend = m_examples.end(); it != iend; ++it)
-    {
-      std::copy(it->second.begin(), it->second.end(), std::back_inserter(examples));
-    }
-    return examples;
+    return m_examples;
   }
 
   /**
@@ -177,11 +203,37 @@ public:
    *
    * \return  The histogram of the label distribution of all of the examples that have ever been added to the reservoir.
    */
-  Histogram_CPtr get_histogram() const
+  const tvgutil::Histogram<Label>& get_histogram() const
   {
     return m_histogram;
   }
 
+  /**
+   * \brief Gets the (approximate) number of bytes of storage currently allocated for the examples in the reservoir.
+   *
+   * \return  The (approximate) number of bytes of storage currently allocated for the examples in the reservoir.
+   */
+  size_t get_memory_usage() const
+  {
+    size_t result = m_examples.get_memory_usage();
+    for(typename std::map<Label,std::vector<size_t> >::const_iterator it = m_rowsByClass.begin(), iend = m_rowsByClass.end(); it != iend; ++it)
+    {
+      result += it->second.capacity() * sizeof(size_t);
+    }
+    return result;
+  }
+
+  /**
+   * \brief Reserves space in the reservoir for the specified number of examples.
+   *
+   * \param exampleCount  The number of examples for which to reserve space.
+   * \param featureCount  The number of features in each example's descriptor.
+   */
+  void reserve(size_t exampleCount, size_t featureCount)
+  {
+    m_examples.reserve(exampleCount, featureCount);
+  }
+
   /**
    * \brief Gets the total number of examples that have been added to the reservoir over time.
    *
@@ -192,6 +244,36 @@ public:
     return m_seenExamples;
   }
 
+  /**
+   * \brief Swaps the contents of this reservoir with those of another one.
+   *
+   * \param rhs The reservoir with which to swap contents.
+   */
+  void swap(ExampleReservoir& rhs)
+  {
+    std::swap(m_curSize, rhs.m_curSize);
+    m_examples.swap(rhs.m_examples);
+    m_histogram.swap(rhs.m_histogram);
+    std::swap(m_maxClassSize, rhs.m_maxClassSize);
+    m_randomNumberGenerator.swap(rhs.m_randomNumberGenerator);
+    m_rowsByClass.swap(rhs.m_rowsByClass);
+    std::swap(m_seenExamples, rhs.m_seenExamples);
+  }
+
+  /**
+   * \brief Swaps the storage for the examples in this reservoir with that of the specified example matrix.
+   *
+   * This is used to pass the storage retained by a cleared reservoir on to a new one. Both this reservoir
+   * and the matrix must be empty, so that only the allocated storage (and not any examples) changes hands.
+   *
+   * \param storage The (empty) example matrix with which to swap storage.
+   */
+  void swap_storage(ExampleMatrix<Label>& storage)
+  {
+    assert(m_examples.empty() && storage.empty());
+    m_examples.swap(storage);
+  }
+
   //#################### STREAM OPERATORS ####################
 
   /**
@@ -203,9 +285,9 @@ public:
    */
   friend std::ostream& operator<<(std::ostream& os, const ExampleReservoir& rhs)
   {
-    for(typename std::vector<Example_CPtr>::const_iterator it = rhs.m_examples.begin(), iend = rhs.m_examples.end(); it != iend; ++it)
+    for(size_t i = 0, size = rhs.m_examples.size(); i < size; ++i)
     {
-      os << (*it)->get_label() << ' ';
+      os << rhs.m_examples.get_label(i) << ' ';
     }
 
     return os;
@@ -214,25 +296,97 @@ public:
   //#################### SERIALIZATION #################### 
 private:
   /**
-   * \brief Serializes the example reservoir to/from an archive.
+   * \brief Loads the example reservoir from an archive.
+   *
+   * Reservoirs saved before the examples were stored in an example matrix (version 0) are converted on loading,
+   * as are reservoirs saved before the histogram was stored by value (versions 0 and 1).
+   *
+   * \param ar      The archive.
+   * \param version The file format version number.
+   */
+  template <typename Archive>
+  void load(Archive& ar, const unsigned int version)
+  {
+    ar & m_curSize;
+
+    if(version == 0)
+    {
+      std::map<Label,std::vector<Example_CPtr> > examples;
+      ar & examples;
+
+      m_examples.clear();
+      m_rowsByClass.clear();
+      for(typename std::map<Label,std::vector<Example_CPtr> >::const_iterator it = examples.begin(), iend = examples.end(); it != iend; ++it)
+      {
+        std::vector<size_t>& rowsForClass = m_rowsByClass[it->first];
+        for(typename std::vector<Example_CPtr>::const_iterator jt = it->second.begin(), jend = it->second.end(); jt != jend; ++jt)
+        {
+          rowsForClass.push_back(m_examples.add_example(**jt));
+        }
+      }
+    }
+    else
+    {
+      ar & m_examples;
+      ar & m_rowsByClass;
+    }
+
+    if(version < 2)
+    {
+      // The histogram of a reservoir that has been cleared was saved as a null pointer.
+      Histogram_Ptr histogram;
+      ar & histogram;
+      if(histogram) m_histogram = *histogram;
+      else m_histogram.clear();
+    }
+    else ar & m_histogram;
+
+    ar & m_maxClassSize;
+    ar & m_randomNumberGenerator;
+    ar & m_seenExamples;
+  }
+
+  /**
+   * \brief Saves the example reservoir to an archive.
    *
    * \param ar      The archive.
    * \param version The file format version number.
    */
   template <typename Archive>
-  void serialize(Archive& ar, const unsigned int version)
+  void save(Archive& ar, const unsigned int version) const
   {
     ar & m_curSize;
     ar & m_examples;
+    ar & m_rowsByClass;
     ar & m_histogram;
     ar & m_maxClassSize;
     ar & m_randomNumberGenerator;
     ar & m_seenExamples;
   }
 
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+
   friend class boost::serialization::access;
 };
 
 }
 
+namespace boost { namespace serialization {
+
+/**
+ * \brief Specifies the file format version number of example reservoirs.
+ *
+ * Version 1 stores the examples as an example matrix, rather than as a map from labels to vectors of examples.
+ * Version 2 stores the histogram by value, rather than via a pointer.
+ */
+template <typename Label>
+struct version<rafl::ExampleReservoir<Label> >
+{
+  typedef mpl::int_<2> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+}}
+
 #endif
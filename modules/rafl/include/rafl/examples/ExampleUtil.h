@@ -6,12 +6,13 @@
 #ifndef H_RAFL_EXAMPLEUTIL
 #define H_RAFL_EXAMPLEUTIL
 
+#include <cmath>
 #include <fstream>
 
 #include <tvgutil/persistence/LineUtil.h>
 #include <tvgutil/statistics/ProbabilityMassFunction.h>
 
-#include "Example.h"
+#include "ExampleMatrix.h"
 
 namespace rafl {
 
@@ -47,7 +48,40 @@ public:
   static float calculate_entropy(const tvgutil::Histogram<Label>& histogram,
                                  const typename boost::mpl::identity<boost::optional<std::map<Label,float> > >::type& multipliers = boost::none)
   {
-    return histogram.empty() ? 0.0f : tvgutil::ProbabilityMassFunction<Label>(histogram, multipliers).calculate_entropy();
+    return histogram.empty() ? 0.0f : tvgutil::ProbabilityMassFunction<Label>::calculate_entropy(histogram, multipliers);
+  }
+
+  /**
+   * \brief Calculates the weighted entropy of a label distribution represented by dense per-label example counts.
+   *
+   * This matches the entropy of the PMF that would be made from a histogram with the same counts and multipliers
+   * equal to the weights, but allocates no memory, so it can be used in tight loops (e.g. when evaluating split candidates).
+   *
+   * \param counts        The number of examples of each label.
+   * \param weights       The weight for each label.
+   * \param labelCount    The number of labels.
+   * \param exampleCount  The total number of examples (the sum of the counts).
+   * \return              The entropy of the label distribution.
+   */
+  static float calculate_entropy(const size_t *counts, const float *weights, size_t labelCount, size_t exampleCount)
+  {
+    if(exampleCount == 0) return 0.0f;
+
+    // Note: The masses are recomputed in the second pass rather than stored, which gives exactly the same values.
+    float sum = 0.0f;
+    for(size_t k = 0; k < labelCount; ++k)
+    {
+      if(counts[k] != 0) sum += static_cast<float>(counts[k]) / exampleCount * weights[k];
+    }
+
+    float entropy = 0.0f;
+    for(size_t k = 0; k < labelCount; ++k)
+    {
+      if(counts[k] == 0) continue;
+      float mass = static_cast<float>(counts[k]) / exampleCount * weights[k] / sum;
+      if(mass > 0) entropy += mass * log2(mass);
+    }
+    return -entropy;
   }
 
   /**
@@ -107,6 +141,25 @@ public:
     return histogram;
   }
 
+  /**
+   * \brief Makes a histogram from the label distribution of a subset of the examples in an example matrix.
+   *
+   * \param examples  The example matrix.
+   * \param rows      The indices of the rows of the matrix containing the examples in the subset.
+   * \return          The histogram.
+   */
+  template <typename Label>
+  static tvgutil::Histogram<Label> make_histogram(const ExampleMatrix<Label>& examples, const std::vector<size_t>& rows)
+  {
+    tvgutil::Histogram<Label> histogram;
+    for(std::vector<size_t>::const_iterator it = rows.begin(), iend = rows.end(); it != iend; ++it)
+    {
+      histogram.add(examples.get_label(*it));
+    }
+
+    return histogram;
+  }
+
   /**
    * \brief Makes a probability mass function (PMF) from the label distribution of a set of examples.
    *
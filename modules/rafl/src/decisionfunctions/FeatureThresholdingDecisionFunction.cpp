@@ -17,9 +17,9 @@ FeatureThresholdingDecisionFunction::FeatureThresholdingDecisionFunction(size_t
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
-DecisionFunction::DescriptorClassification FeatureThresholdingDecisionFunction::classify_descriptor(const Descriptor& descriptor) const
+DecisionFunction::DescriptorClassification FeatureThresholdingDecisionFunction::classify_features(const float *features) const
 {
-  return descriptor[m_featureIndex] < m_threshold ? DC_LEFT : DC_RIGHT;
+  return features[m_featureIndex] < m_threshold ? DC_LEFT : DC_RIGHT;
 }
 
 void FeatureThresholdingDecisionFunction::output(std::ostream& os) const
@@ -27,6 +27,16 @@ void FeatureThresholdingDecisionFunction::output(std::ostream& os) const
   os << "Feature " << m_featureIndex << " < " << m_threshold;
 }
 
+FlatDecisionFunction FeatureThresholdingDecisionFunction::to_flat() const
+{
+  FlatDecisionFunction result;
+  result.firstFeatureIndex = static_cast<unsigned int>(m_featureIndex);
+  result.op = FlatDecisionFunction::FO_FIRST;
+  result.secondFeatureIndex = 0;
+  result.threshold = m_threshold;
+  return result;
+}
+
 }
 
 BOOST_CLASS_EXPORT(rafl::FeatureThresholdingDecisionFunction)
@@ -23,9 +23,9 @@ PairwiseOpAndThresholdDecisionFunction::PairwiseOpAndThresholdDecisionFunction()
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
-DecisionFunction::DescriptorClassification PairwiseOpAndThresholdDecisionFunction::classify_descriptor(const Descriptor& descriptor) const
+DecisionFunction::DescriptorClassification PairwiseOpAndThresholdDecisionFunction::classify_features(const float *features) const
 {
-  float result = apply_op(m_op, descriptor[m_firstFeatureIndex], descriptor[m_secondFeatureIndex]);
+  float result = apply_op(m_op, features[m_firstFeatureIndex], features[m_secondFeatureIndex]);
   return result < m_threshold ? DC_LEFT : DC_RIGHT;
 }
 
@@ -37,6 +37,29 @@ void PairwiseOpAndThresholdDecisionFunction::output(std::ostream& os) const
      << " < " << m_threshold;
 }
 
+FlatDecisionFunction PairwiseOpAndThresholdDecisionFunction::to_flat() const
+{
+  FlatDecisionFunction result;
+  result.firstFeatureIndex = static_cast<unsigned int>(m_firstFeatureIndex);
+  result.secondFeatureIndex = static_cast<unsigned int>(m_secondFeatureIndex);
+  result.threshold = m_threshold;
+
+  switch(m_op)
+  {
+    case PO_ADD:
+      result.op = FlatDecisionFunction::FO_ADD;
+      break;
+    case PO_SUBTRACT:
+      result.op = FlatDecisionFunction::FO_SUBTRACT;
+      break;
+    default:
+      // This should never happen.
+      throw std::runtime_error("Unknown pairwise operation");
+  }
+
+  return result;
+}
+
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
 float PairwiseOpAndThresholdDecisionFunction::apply_op(Op op, float a, float b)
@@ -7,6 +7,8 @@
 #define H_RAFLEVALUATION_RANDOMFORESTEVALUATOR
 
 #include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <evaluation/core/LearnerEvaluator.h>
 #include <evaluation/core/PerformanceMeasure.h>
@@ -16,6 +18,7 @@
 #include <rafl/core/RandomForest.h>
 
 #include <tvgutil/containers/MapUtil.h>
+#include <tvgutil/misc/ParallelUtil.h>
 
 namespace raflevaluation {
 
@@ -39,6 +42,9 @@ private:
   /** The settings to use for the random forest. */
   std::map<std::string,std::string> m_settings;
 
+  /** The base seed from which to derive the random seeds for the forests trained on the individual splits. */
+  unsigned int m_randomSeed;
+
   /** The maximum number of nodes per tree that may be split in each training step. */
   size_t m_splitBudget;
 
@@ -54,9 +60,10 @@ public:
    * \param settings        The settings to use for the random forest.
    */
   explicit RandomForestEvaluator(const evaluation::SplitGenerator_Ptr& splitGenerator, const std::map<std::string,std::string>& settings)
-  : Base(splitGenerator), m_settings(settings)
+  : Base(splitGenerator), m_settings(settings), m_randomSeed(0)
   {
     #define GET_SETTING(param) tvgutil::MapUtil::typed_lookup(settings, #param, m_##param);
+      GET_SETTING(randomSeed);
       GET_SETTING(splitBudget);
       GET_SETTING(treeCount);
     #undef GET_SETTING
@@ -71,10 +78,15 @@ protected:
   }
 
   /** Override */
-  virtual ResultType evaluate_on_split(const std::vector<Example_CPtr>& examples, const evaluation::SplitGenerator::Split& split) const
+  virtual ResultType evaluate_on_split(const std::vector<Example_CPtr>& examples, const evaluation::SplitGenerator::Split& split, size_t splitIndex) const
   {
+    // Derive a random seed for this split from the base seed, so that each split's forest has its own random number
+    // generator and the results of the evaluation do not depend on the order in which the splits are evaluated.
+    std::map<std::string,std::string> settings = m_settings;
+    settings["randomSeed"] = boost::lexical_cast<std::string>(m_randomSeed + static_cast<unsigned int>(splitIndex));
+
     // Make a random forest using the specified settings and add the examples in the training set to it.
-    RandomForest_Ptr randomForest(new RandomForest(m_treeCount, typename DecisionTree::Settings(m_settings)));
+    RandomForest_Ptr randomForest(new RandomForest(m_treeCount, typename DecisionTree::Settings(settings)));
     randomForest->add_examples(examples, split.first);
 
     // Train the forest.
@@ -100,24 +112,33 @@ private:
     int indicesSize = static_cast<int>(indices.size());
     std::vector<Label> expectedLabels(indicesSize), predictedLabels(indicesSize);
 
-#ifdef WITH_OPENMP
-    #pragma omp parallel for
-#endif
-    for(int i = 0; i < indicesSize; ++i)
-    {
-      const Example_CPtr& example = examples[indices[i]];
-      predictedLabels[i] = randomForest->predict(example->get_descriptor());
-      expectedLabels[i] = example->get_label();
-
-#ifdef WITH_OPENMP
-      #pragma omp critical
-#endif
-      classLabels.insert(expectedLabels[i]);
-    }
+    // Predict the labels of the examples in parallel, and then collect the set of class labels that were expected.
+    tvgutil::ParallelUtil::parallel_for(0, indicesSize, boost::bind(
+      &RandomForestEvaluator::evaluate_example, _1, boost::cref(randomForest), boost::cref(examples), boost::cref(indices), boost::ref(expectedLabels), boost::ref(predictedLabels)
+    ));
+    classLabels.insert(expectedLabels.begin(), expectedLabels.end());
 
     Eigen::MatrixXf confusionMatrix = ConfusionMatrixUtil::make_confusion_matrix(classLabels, expectedLabels, predictedLabels);
     return boost::assign::map_list_of("Accuracy", ConfusionMatrixUtil::calculate_accuracy(ConfusionMatrixUtil::normalise_rows_L1(confusionMatrix)));
   }
+
+  /**
+   * \brief Predicts the label of one of the examples in a subset of a set of examples.
+   *
+   * \param i               The index of the example in the subset.
+   * \param randomForest    The random forest.
+   * \param examples        The overall set of examples from which the subset of evaluation examples is drawn.
+   * \param indices         The indices of the subset of examples on which to evaluate the random forest.
+   * \param expectedLabels  The array into whose i'th element to write the expected label of the example.
+   * \param predictedLabels The array into whose i'th element to write the predicted label of the example.
+   */
+  static void evaluate_example(int i, const RandomForest_Ptr& randomForest, const std::vector<Example_CPtr>& examples, const std::vector<size_t>& indices,
+                               std::vector<Label>& expectedLabels, std::vector<Label>& predictedLabels)
+  {
+    const Example_CPtr& example = examples[indices[i]];
+    predictedLabels[i] = randomForest->predict(example->get_descriptor());
+    expectedLabels[i] = example->get_label();
+  }
 };
 
 }
@@ -0,0 +1,137 @@
+/**
+ * raflevaluation: StreamingRandomForestEvaluator.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_RAFLEVALUATION_STREAMINGRANDOMFORESTEVALUATOR
+#define H_RAFLEVALUATION_STREAMINGRANDOMFORESTEVALUATOR
+
+#include <set>
+
+#include <boost/assign/list_of.hpp>
+
+#include <evaluation/core/PerformanceResult.h>
+#include <evaluation/util/ConfusionMatrixUtil.h>
+
+#include <rafl/core/CompiledRandomForest.h>
+#include <rafl/examples/ChunkedExampleReader.h>
+
+#include <tvgutil/containers/MapUtil.h>
+
+namespace raflevaluation {
+
+/**
+ * \brief An instance of this class can be used to evaluate a random forest on training and test sets that are too large
+ *        to be held in memory, by streaming them from chunked example files.
+ *
+ * The forest is trained online: each chunk of training examples is added to the forest, which is then trained, before the
+ * next chunk is read. The forest is then compiled, and the labels of each chunk of test examples are predicted in a batch,
+ * with only the confusion counts being retained. The memory used is thus bounded by the chunk size (and the size of the forest),
+ * rather than by the number of examples. Unlike RandomForestEvaluator, the example sets are not split randomly, so the result
+ * comes from a single train-test run.
+ *
+ * \tparam Label  The type of label used by the examples. Must be an integral type, and all labels must be in [0,CompiledRandomForest<Label>::MAX_LABEL_COUNT).
+ */
+template <typename Label>
+class StreamingRandomForestEvaluator
+{
+  //#################### TYPEDEFS ####################
+private:
+  typedef rafl::DecisionTree<Label> DecisionTree;
+  typedef rafl::RandomForest<Label> RandomForest;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The settings to use for the random forest. */
+  std::map<std::string,std::string> m_settings;
+
+  /** The maximum number of nodes per tree that may be split in each training step. */
+  size_t m_splitBudget;
+
+  /** The number of decision trees to use in the random forest. */
+  size_t m_treeCount;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a streaming random forest evaluator.
+   *
+   * \param settings  The settings to use for the random forest.
+   */
+  explicit StreamingRandomForestEvaluator(const std::map<std::string,std::string>& settings)
+  : m_settings(settings)
+  {
+    #define GET_SETTING(param) tvgutil::MapUtil::typed_lookup(settings, #param, m_##param);
+      GET_SETTING(splitBudget);
+      GET_SETTING(treeCount);
+    #undef GET_SETTING
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Trains a random forest on the examples in one chunked example file, and evaluates it on those in another.
+   *
+   * \param trainingSetPath     The path to the chunked example file containing the training examples.
+   * \param testingSetPath      The path to the chunked example file containing the test examples.
+   * \return                    The results of the evaluation.
+   * \throws std::runtime_error If either file cannot be read, or the files contain examples of different sizes.
+   */
+  evaluation::PerformanceResult evaluate(const std::string& trainingSetPath, const std::string& testingSetPath) const
+  {
+    // Train the forest online, one chunk of training examples at a time.
+    RandomForest randomForest(m_treeCount, typename DecisionTree::Settings(m_settings));
+    rafl::ExampleMatrix<Label> chunk;
+
+    rafl::ChunkedExampleReader<Label> trainingReader(trainingSetPath);
+    while(trainingReader.read_chunk(chunk))
+    {
+      randomForest.add_examples(chunk);
+      randomForest.train(m_splitBudget);
+    }
+
+    // Predict the labels of the test examples in batches, accumulating the number of times each label is predicted for each expected label.
+    const rafl::CompiledRandomForest<Label> compiledForest(randomForest);
+    rafl::ChunkedExampleReader<Label> testingReader(testingSetPath);
+    if(testingReader.get_feature_count() != trainingReader.get_feature_count())
+    {
+      throw std::runtime_error("Error: The training and test examples in '" + trainingSetPath + "' and '" + testingSetPath + "' are of different sizes");
+    }
+
+    std::set<Label> classLabels;
+    std::map<std::pair<Label,Label>,size_t> confusionCounts;
+    std::vector<Label> predictedLabels;
+    while(testingReader.read_chunk(chunk))
+    {
+      predictedLabels.resize(chunk.size());
+      compiledForest.predict_batch(chunk.get_features(0), chunk.get_feature_count(), chunk.size(), &predictedLabels[0]);
+
+      for(size_t i = 0, size = chunk.size(); i < size; ++i)
+      {
+        const Label& expectedLabel = chunk.get_label(i);
+        classLabels.insert(expectedLabel);
+        classLabels.insert(predictedLabels[i]);
+        ++confusionCounts[std::make_pair(expectedLabel, predictedLabels[i])];
+      }
+    }
+
+    // Make the confusion matrix from the accumulated counts, and use it to calculate the accuracy.
+    std::map<Label,int> labelToIndex;
+    for(typename std::set<Label>::const_iterator it = classLabels.begin(), iend = classLabels.end(); it != iend; ++it)
+    {
+      labelToIndex.insert(std::make_pair(*it, static_cast<int>(labelToIndex.size())));
+    }
+
+    Eigen::MatrixXf confusionMatrix = Eigen::MatrixXf::Zero(classLabels.size(), classLabels.size());
+    for(typename std::map<std::pair<Label,Label>,size_t>::const_iterator it = confusionCounts.begin(), iend = confusionCounts.end(); it != iend; ++it)
+    {
+      confusionMatrix(labelToIndex[it->first.first], labelToIndex[it->first.second]) = static_cast<float>(it->second);
+    }
+
+    return boost::assign::map_list_of("Accuracy", evaluation::ConfusionMatrixUtil::calculate_accuracy(evaluation::ConfusionMatrixUtil::normalise_rows_L1(confusionMatrix)));
+  }
+};
+
+}
+
+#endif
@@ -22,14 +22,21 @@ struct FeatureCalculatorFactory
   /**
    * \brief Makes a VOP feature calculator.
    *
+   * On the GPU, if there are kernel instantiations that are specialised for the specified patch size and bin count, they will be used.
+   * Otherwise, the generic kernels will be used instead.
+   *
    * \param maxVoxelLocationCount The maximum number of voxel locations for which we will be calculating features at any one time.
    * \param patchSize             The side length of a VOP patch (must be odd).
    * \param patchSpacing          The spacing in the scene (in voxels) between individual pixels in a patch.
    * \param binCount              The number of bins into which to quantize orientations when aligning voxel patches.
    * \param deviceType            The device on which the feature calculator should operate.
+   * \param featureCacheSize      The number of slots in the feature cache (0 to disable the feature cache).
+   * \param useFusedKernel        Whether or not to use the fused feature calculation kernel (CUDA only; ignored on the CPU).
+   * \param useCUDAGraph          Whether or not to capture the staged feature calculation kernels into a CUDA graph and replay it (CUDA only; ignored on the CPU).
    */
   static FeatureCalculator_CPtr make_vop_feature_calculator(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount,
-                                                            ITMLib::ITMLibSettings::DeviceType deviceType);
+                                                            ITMLib::ITMLibSettings::DeviceType deviceType, size_t featureCacheSize = 0,
+                                                            bool useFusedKernel = false, bool useCUDAGraph = false);
 };
 
 }
@@ -23,31 +23,80 @@ public:
    * \param patchSize             The side length of a VOP patch (must be odd).
    * \param patchSpacing          The spacing in the scene (in voxels) between individual pixels in a patch.
    * \param binCount              The number of bins into which to quantize orientations when aligning voxel patches.
+   * \param featureCacheSize      The number of slots in the feature cache (0 to disable the feature cache).
    */
-  VOPFeatureCalculator_CPU(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount);
+  VOPFeatureCalculator_CPU(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount, size_t featureCacheSize);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /** Override */
-  virtual void calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+  virtual void calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
+                                         const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                          ORUtils::MemoryBlock<float>& featuresMB) const;
 
   /** Override */
   virtual void convert_patches_to_lab(int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const;
 
   /** Override */
-  virtual void fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, ORUtils::MemoryBlock<float>& featuresMB) const;
+  virtual void fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const;
 
   /** Override */
   virtual void generate_coordinate_systems(int voxelLocationCount) const;
 
   /** Override */
-  virtual void generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB,
+  virtual void generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
                                     const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                     ORUtils::MemoryBlock<float>& featuresMB) const;
 
+  /** Override */
+  virtual int lookup_cached_features(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ITMVoxelIndex::IndexData *indexData,
+                                     ORUtils::MemoryBlock<float>& featuresMB) const;
+
+  /** Override */
+  virtual void stamp_voxel_blocks(const int *visibleEntityIDs, int visibleEntityCount, const ITMHashEntry *hashTable) const;
+
+  /** Override */
+  virtual void store_cached_features(int missCount, ORUtils::MemoryBlock<float>& featuresMB) const;
+
   /** Override */
   virtual void update_coordinate_systems(int voxelLocationCount, const ORUtils::MemoryBlock<float>& featuresMB) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+#ifdef WITH_AVX2
+  /**
+   * \brief Computes the intensity gradients at 8 consecutive pixels in a row of an intensity patch using AVX2.
+   *
+   * The pixels must all be in the interior of the patch. The results are identical to those computed by compute_histogram_for_patch.
+   *
+   * \param intensities   The intensity patch.
+   * \param indexInPatch  The index of the first of the 8 pixels within the patch.
+   * \param patchSize     The side length of the patch.
+   * \param xDerivs       An array into which to write the x derivatives of the intensity at the 8 pixels.
+   * \param yDerivs       An array into which to write the y derivatives of the intensity at the 8 pixels.
+   * \param mags          An array into which to write the gradient magnitudes at the 8 pixels.
+   */
+  static void compute_gradients_avx2(const float *intensities, int indexInPatch, int patchSize, float *xDerivs, float *yDerivs, float *mags);
+
+  /**
+   * \brief Computes the intensities of 8 consecutive pixels in an RGB patch using AVX2.
+   *
+   * The results are identical to those computed by compute_intensities_for_patch.
+   *
+   * \param rgb         The interleaved RGB values of the 8 pixels.
+   * \param intensities An array into which to write the intensities of the 8 pixels.
+   */
+  static void compute_intensities_avx2(const float *rgb, float *intensities);
+
+  /**
+   * \brief Converts 8 consecutive pixels in an RGB patch to the CIELab colour space in place using AVX2.
+   *
+   * The results are identical to those computed by convert_patch_to_lab.
+   *
+   * \param rgb The interleaved RGB values of the 8 pixels.
+   */
+  static void convert_rgb_to_lab_avx2(float *rgb);
+#endif
 };
 
 }
@@ -6,14 +6,97 @@
 #ifndef H_SPAINT_VOPFEATURECALCULATOR_CUDA
 #define H_SPAINT_VOPFEATURECALCULATOR_CUDA
 
+#include <cuda_runtime_api.h>
+
 #include "../interface/VOPFeatureCalculator.h"
 
+// CUDA graphs can only be used if executable graphs can be updated in place (which was introduced in CUDA 10.2).
+#if CUDART_VERSION >= 10020
+  #define SPAINT_USE_VOP_CUDA_GRAPH 1
+#endif
+
 namespace spaint {
 /**
  * \brief An instance of a class deriving from this one can be used to calculate VOP feature descriptors for voxels sampled from a scene using CUDA.
+ *
+ * By default, the stages of the VOP pipeline are run as separate kernels, each of which reads and writes the feature descriptors in global
+ * memory. Alternatively, a fused kernel can be used, in which there is one thread block per voxel and one thread per pixel of its patch.
+ * The block computes the voxel's normal and coordinate system, samples the patch, builds the orientation histogram, rotates the coordinate
+ * system and samples the final patch, all in shared memory, writing only the finished CIELab descriptor to global memory. The staged path
+ * is retained so that the two can be compared.
+ *
+ * Optionally, the kernels of the staged pipeline can instead be captured into a CUDA graph, which is then replayed whenever the features
+ * are next calculated with the same parameters (the same voxel locations and feature buffers, the same number of voxels and the same scene).
+ * Whenever the parameters change, the sequence is captured again, and the existing executable graph is updated in place if possible
+ * (which is much cheaper than instantiating a new one). The graph is launched on a blocking stream of the calculator's own, so that it
+ * is ordered with respect to the work on the default stream just as the individual kernels would be.
+ *
+ * For the patch size and bin count that are used in practice (see SemanticSegmentationComponent), specialised instantiations of the
+ * kernels that depend on them can also be used. These treat the patch size and bin count as compile-time constants, so that the shared
+ * arrays can be sized exactly and the compiler can strength-reduce the index arithmetic and unroll the loops. The generic kernels are
+ * used for any other configuration.
  */
 class VOPFeatureCalculator_CUDA : public VOPFeatureCalculator
 {
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct contains the parameters with which the staged pipeline was captured into the CUDA graph.
+   */
+  struct GraphParams
+  {
+    /** The feature descriptors into which the graph writes. */
+    float *features;
+
+    /** The scene's index data. */
+    const ITMVoxelIndex::IndexData *indexData;
+
+    /** The scene's voxel data. */
+    const SpaintVoxel *voxelData;
+
+    /** The number of voxel locations for which the graph calculates features. */
+    int voxelLocationCount;
+
+    /** The voxel locations for which the graph calculates features. */
+    const Vector3s *voxelLocations;
+  };
+
+  //#################### CONSTANTS ####################
+public:
+  /** The bin count for which specialised kernels are available. */
+  static const int SPECIALISED_BIN_COUNT = 36;
+
+  /** The patch size for which specialised kernels are available. */
+  static const int SPECIALISED_PATCH_SIZE = 13;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+#ifdef SPAINT_USE_VOP_CUDA_GRAPH
+  /** The executable CUDA graph (if any) into which the staged pipeline was most recently captured. */
+  mutable cudaGraphExec_t m_graphExec;
+#endif
+
+  /** The parameters with which the staged pipeline was most recently captured into the CUDA graph (if any). */
+  mutable GraphParams m_graphParams;
+
+  /** The stream on which the staged pipeline is captured and the CUDA graph is launched (if the CUDA graph is in use). */
+  cudaStream_t m_graphStream;
+
+  /** The stream on which to launch the kernels of the staged pipeline (this is the graph stream whilst the pipeline is being captured). */
+  mutable cudaStream_t m_launchStream;
+
+  /** A memory block into which to count the voxels that were not found in the feature cache. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_missCountMB;
+
+  /** Whether or not to capture the staged pipeline into a CUDA graph and replay it, rather than launching its kernels individually. */
+  bool m_useCUDAGraph;
+
+  /** Whether or not to calculate the feature descriptors using the fused kernel rather than the staged pipeline. */
+  bool m_useFusedKernel;
+
+  /** Whether or not to use the kernel instantiations that are specialised for SPECIALISED_PATCH_SIZE and SPECIALISED_BIN_COUNT. */
+  bool m_useSpecialisedKernels;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -23,29 +106,90 @@ public:
    * \param patchSize             The side length of a VOP patch (must be odd).
    * \param patchSpacing          The spacing in the scene (in voxels) between individual pixels in a patch.
    * \param binCount              The number of bins into which to quantize orientations when aligning voxel patches.
+   * \param featureCacheSize      The number of slots in the feature cache (0 to disable the feature cache).
+   * \param useFusedKernel        Whether or not to calculate the feature descriptors using the fused kernel rather than the staged pipeline.
+   * \param useCUDAGraph          Whether or not to capture the staged pipeline into a CUDA graph and replay it (ignored if the fused kernel is used).
+   * \param useSpecialisedKernels Whether or not to use the kernel instantiations that are specialised for the patch size and bin count.
+   * \throws std::invalid_argument If the fused kernel is requested, but the patches would have more than 256 pixels or the histograms more than 64 bins,
+   *                               or if the specialised kernels are requested, but are not available for the patch size and bin count.
+   * \throws std::runtime_error    If the CUDA graph is requested, but the CUDA runtime is too old to support updating executable graphs.
    */
-  VOPFeatureCalculator_CUDA(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount);
+  VOPFeatureCalculator_CUDA(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount, size_t featureCacheSize, bool useFusedKernel,
+                            bool useCUDAGraph = false, bool useSpecialisedKernels = false);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the CUDA-based VOP feature calculator.
+   */
+  virtual ~VOPFeatureCalculator_CUDA();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  VOPFeatureCalculator_CUDA(const VOPFeatureCalculator_CUDA&);
+  VOPFeatureCalculator_CUDA& operator=(const VOPFeatureCalculator_CUDA&);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets whether or not specialised kernels are available for the specified patch size and bin count.
+   *
+   * \param patchSize The side length of a VOP patch.
+   * \param binCount  The number of bins into which to quantize orientations when aligning voxel patches.
+   * \return          true, if specialised kernels are available for the patch size and bin count, or false otherwise.
+   */
+  static bool has_specialised_kernels(size_t patchSize, size_t binCount);
+
+  //#################### PROTECTED MEMBER FUNCTIONS ####################
+protected:
+  /** Override */
+  virtual void calculate_features_uncached(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, const SpaintVoxelScene *scene,
+                                           ORUtils::MemoryBlock<float>& featuresMB) const;
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Calculates the feature descriptors using the staged pipeline, by replaying the CUDA graph into which it was captured
+   *        (capturing it again first if the parameters have changed since it was last captured).
+   *
+   * \param voxelLocationsMB    A memory block containing the locations of the voxels for which to calculate feature descriptors.
+   * \param voxelLocationCount  The number of voxel locations for which to calculate feature descriptors.
+   * \param scene               The scene.
+   * \param featuresMB          A memory block into which to store the calculated feature descriptors.
+   */
+  void calculate_features_with_graph(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, const SpaintVoxelScene *scene,
+                                     ORUtils::MemoryBlock<float>& featuresMB) const;
+
   /** Override */
-  virtual void calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+  virtual void calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
+                                         const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                          ORUtils::MemoryBlock<float>& featuresMB) const;
 
   /** Override */
   virtual void convert_patches_to_lab(int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const;
 
   /** Override */
-  virtual void fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, ORUtils::MemoryBlock<float>& featuresMB) const;
+  virtual void fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const;
 
   /** Override */
   virtual void generate_coordinate_systems(int voxelLocationCount) const;
 
   /** Override */
-  virtual void generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB,
+  virtual void generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
                                     const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                     ORUtils::MemoryBlock<float>& featuresMB) const;
 
+  /** Override */
+  virtual int lookup_cached_features(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ITMVoxelIndex::IndexData *indexData,
+                                     ORUtils::MemoryBlock<float>& featuresMB) const;
+
+  /** Override */
+  virtual void stamp_voxel_blocks(const int *visibleEntityIDs, int visibleEntityCount, const ITMHashEntry *hashTable) const;
+
+  /** Override */
+  virtual void store_cached_features(int missCount, ORUtils::MemoryBlock<float>& featuresMB) const;
+
   /** Override */
   virtual void update_coordinate_systems(int voxelLocationCount, const ORUtils::MemoryBlock<float>& featuresMB) const;
 };
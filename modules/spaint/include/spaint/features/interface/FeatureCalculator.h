@@ -6,6 +6,8 @@
 #ifndef H_SPAINT_FEATURECALCULATOR
 #define H_SPAINT_FEATURECALCULATOR
 
+#include <ITMLib/Objects/RenderStates/ITMRenderState.h>
+
 #include "../../util/SpaintVoxelScene.h"
 
 namespace spaint {
@@ -39,6 +41,28 @@ public:
    * \return  The size of feature vector generated by this feature calculator.
    */
   virtual size_t get_feature_count() const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Informs the feature calculator that any features it has cached can no longer be trusted.
+   *
+   * This must be called after any operation that moves the scene's voxel blocks to different slots in the voxel block array
+   * (e.g. defragmenting the scene), since feature calculators may store information about the blocks by slot. By default,
+   * this does nothing.
+   */
+  virtual void invalidate_cached_features() const {}
+
+  /**
+   * \brief Informs the feature calculator that fusion has just updated the voxel blocks that are visible in the specified render state.
+   *
+   * Feature calculators that cache the features they calculate can use this to invalidate the features of any voxels whose
+   * surroundings may have changed. By default, this does nothing.
+   *
+   * \param renderState The render state whose visible voxel blocks were just updated by fusion.
+   * \param scene       The scene.
+   */
+  virtual void invalidate_fused_blocks(const ITMLib::ITMRenderState *renderState, const SpaintVoxelScene *scene) const {}
 };
 
 //#################### TYPEDEFS ####################
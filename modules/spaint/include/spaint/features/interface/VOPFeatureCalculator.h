@@ -12,6 +12,13 @@ namespace spaint {
 
 /**
  * \brief An instance of this class can be used to calculate VOP feature descriptors for voxels sampled from a scene.
+ *
+ * If a feature cache is enabled, the feature descriptors that are calculated are also stored in a direct-mapped cache on the
+ * device, keyed by voxel location. Each entry is tagged with the version of the cache at the time it was written, and each
+ * voxel block is tagged with the version at which fusion last updated it (see invalidate_fused_blocks). A cached descriptor
+ * is reused for as long as the block containing its voxel has not been updated since the descriptor was calculated, so only
+ * the voxels on new or recently fused surfaces need to be featurised each frame. Note that a descriptor also depends on the
+ * voxels in a small neighbourhood around its voxel, which can occasionally straddle a block that was updated on its own.
  */
 class VOPFeatureCalculator : public FeatureCalculator
 {
@@ -28,6 +35,36 @@ protected:
   /** The number of bins into which to quantize orientations when aligning voxel patches. */
   size_t m_binCount;
 
+  /** The version of the feature cache at which fusion last updated each voxel block in the scene (allocated when first needed). */
+  mutable boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_blockVersionsMB;
+
+  /** The feature descriptors stored in the feature cache (packed sequentially). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_cacheFeaturesMB;
+
+  /** The locations of the voxels whose feature descriptors are stored in the feature cache. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_cacheLocationsMB;
+
+  /** The indices (in the list of missed voxels) of the voxels that will be written to each slot of the feature cache. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_cacheOwnersMB;
+
+  /** The version of the feature cache at which each slot was written (0 denotes an empty slot). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_cacheVersionsMB;
+
+  /** The number of slots in the feature cache (0 if the feature cache is disabled). */
+  size_t m_featureCacheSize;
+
+  /** The current version of the feature cache (incremented whenever fusion updates some voxel blocks). */
+  mutable unsigned int m_featureCacheVersion;
+
+  /** The feature descriptors calculated for the voxels that were not found in the feature cache (packed sequentially). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_missFeaturesMB;
+
+  /** The indices (in the input list of voxels) of the voxels that were not found in the feature cache. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_missIndicesMB;
+
+  /** The locations of the voxels that were not found in the feature cache. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_missLocationsMB;
+
   /** The side length of a VOP patch (must be odd). */
   size_t m_patchSize;
 
@@ -52,20 +89,23 @@ protected:
    * \param patchSize             The side length of a VOP patch (must be odd).
    * \param patchSpacing          The spacing in the scene (in voxels) between individual pixels in a patch.
    * \param binCount              The number of bins into which to quantize orientations when aligning voxel patches.
+   * \param featureCacheSize      The number of slots in the feature cache (0 to disable the feature cache).
    */
-  VOPFeatureCalculator(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount);
+  VOPFeatureCalculator(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount, size_t featureCacheSize);
 
   //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
 private:
   /**
    * \brief Calculates the surface normals at the voxel locations.
    *
-   * \param voxelLocationsMB  A memory block containing the locations of the voxels for which to calculate the surface normals.
-   * \param voxelData         The scene's voxel data.
-   * \param indexData         The scene's index data.
-   * \param featuresMB        A memory block into which to store the calculated feature descriptors (packed sequentially).
+   * \param voxelLocationsMB    A memory block containing the locations of the voxels for which to calculate the surface normals.
+   * \param voxelLocationCount  The number of voxel locations (at the start of the memory block) for which to calculate the surface normals.
+   * \param voxelData           The scene's voxel data.
+   * \param indexData           The scene's index data.
+   * \param featuresMB          A memory block into which to store the calculated feature descriptors (packed sequentially).
    */
-  virtual void calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+  virtual void calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
+                                         const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                          ORUtils::MemoryBlock<float>& featuresMB) const = 0;
 
   /**
@@ -79,10 +119,11 @@ private:
   /**
    * \brief Writes the height of each voxel into the corresponding feature vector for use as an extra feature.
    *
-   * \param voxelLocationsMB  A memory block containing the locations of the voxels for which to fill in the heights.
-   * \param featuresMB        A memory block into which to store the calculated feature descriptors (packed sequentially).
+   * \param voxelLocationsMB    A memory block containing the locations of the voxels for which to fill in the heights.
+   * \param voxelLocationCount  The number of voxel locations (at the start of the memory block) for which to fill in the heights.
+   * \param featuresMB          A memory block into which to store the calculated feature descriptors (packed sequentially).
    */
-  virtual void fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, ORUtils::MemoryBlock<float>& featuresMB) const = 0;
+  virtual void fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const = 0;
 
   /**
    * \brief Generates coordinate systems in the tangent planes to the surfaces at the voxel locations.
@@ -94,15 +135,48 @@ private:
   /**
    * \brief Generates an RGB patch for each voxel by sampling from a regularly-spaced grid around it in its tangent plane.
    *
-   * \param voxelLocationsMB  A memory block containing the locations of the voxels for which to generate RGB patches.
-   * \param voxelData         The scene's voxel data.
-   * \param indexData         The scene's index data.
-   * \param featuresMB        A memory block into which to store the calculated feature descriptors (packed sequentially).
+   * \param voxelLocationsMB    A memory block containing the locations of the voxels for which to generate RGB patches.
+   * \param voxelLocationCount  The number of voxel locations (at the start of the memory block) for which to generate RGB patches.
+   * \param voxelData           The scene's voxel data.
+   * \param indexData           The scene's index data.
+   * \param featuresMB          A memory block into which to store the calculated feature descriptors (packed sequentially).
    */
-  virtual void generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB,
+  virtual void generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
                                     const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                     ORUtils::MemoryBlock<float>& featuresMB) const = 0;
 
+  /**
+   * \brief Looks up the specified voxels in the feature cache.
+   *
+   * The cached feature descriptors of any voxels that are found (and still valid) are copied into the output memory block.
+   * The indices and locations of the remaining voxels are written (in an unspecified order) into m_missIndicesMB and m_missLocationsMB.
+   *
+   * \param voxelLocationsMB  A memory block containing the locations of the voxels to look up.
+   * \param indexData         The scene's index data.
+   * \param featuresMB        A memory block into which to store the cached feature descriptors (packed sequentially).
+   * \return                  The number of voxels that were not found in the feature cache.
+   */
+  virtual int lookup_cached_features(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ITMVoxelIndex::IndexData *indexData,
+                                     ORUtils::MemoryBlock<float>& featuresMB) const = 0;
+
+  /**
+   * \brief Tags the specified voxel blocks with the current version of the feature cache.
+   *
+   * \param visibleEntityIDs    The IDs of the hash entries of the voxel blocks to tag.
+   * \param visibleEntityCount  The number of voxel blocks to tag.
+   * \param hashTable           The scene's hash table.
+   */
+  virtual void stamp_voxel_blocks(const int *visibleEntityIDs, int visibleEntityCount, const ITMHashEntry *hashTable) const = 0;
+
+  /**
+   * \brief Copies the feature descriptors calculated for the voxels that were not found in the feature cache into the output memory block,
+   *        and stores them in the feature cache.
+   *
+   * \param missCount   The number of voxels that were not found in the feature cache.
+   * \param featuresMB  A memory block into which to store the calculated feature descriptors (packed sequentially).
+   */
+  virtual void store_cached_features(int missCount, ORUtils::MemoryBlock<float>& featuresMB) const = 0;
+
   /**
    * \brief Updates the coordinate system for each voxel to align it with the dominant orientation in the voxel's RGB patch.
    *
@@ -121,6 +195,27 @@ public:
   /** Override */
   virtual size_t get_feature_count() const;
 
+  /** Override */
+  virtual void invalidate_cached_features() const;
+
+  /** Override */
+  virtual void invalidate_fused_blocks(const ITMLib::ITMRenderState *renderState, const SpaintVoxelScene *scene) const;
+
+  //#################### PROTECTED MEMBER FUNCTIONS ####################
+protected:
+  /**
+   * \brief Calculates feature descriptors for the specified voxels, without making use of the feature cache.
+   *
+   * By default, this runs the stages of the VOP pipeline one after the other, each over all of the voxels.
+   *
+   * \param voxelLocationsMB    A memory block containing the locations of the voxels for which to calculate feature descriptors.
+   * \param voxelLocationCount  The number of voxel locations (at the start of the memory block) for which to calculate feature descriptors.
+   * \param scene               The scene.
+   * \param featuresMB          A memory block into which to store the calculated feature descriptors (packed sequentially).
+   */
+  virtual void calculate_features_uncached(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, const SpaintVoxelScene *scene,
+                                           ORUtils::MemoryBlock<float>& featuresMB) const;
+
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /**
@@ -139,6 +234,13 @@ private:
    * \brief Sets up a debugging window containing a trackbar that can be used to control the delay between consecutive frames.
    */
   void process_debug_window() const;
+
+  /**
+   * \brief Makes sure that the memory block containing the versions of the voxel blocks in the specified scene has been allocated.
+   *
+   * \param scene The scene.
+   */
+  void require_block_versions(const SpaintVoxelScene *scene) const;
 };
 
 }
@@ -11,6 +11,37 @@
 
 namespace spaint {
 
+/**
+ * \brief Computes the slot in the feature cache in which the feature descriptor for a voxel would be stored.
+ *
+ * \param loc               The location of the voxel.
+ * \param featureCacheSize  The number of slots in the feature cache.
+ * \return                  The slot in the feature cache in which the feature descriptor for the voxel would be stored.
+ */
+_CPU_AND_GPU_CODE_
+inline int compute_feature_cache_slot(const Vector3s& loc, int featureCacheSize)
+{
+  const unsigned int hash = (static_cast<unsigned int>(loc.x) * 73856093u) ^ (static_cast<unsigned int>(loc.y) * 19349669u) ^ (static_cast<unsigned int>(loc.z) * 83492791u);
+  return static_cast<int>(hash % static_cast<unsigned int>(featureCacheSize));
+}
+
+/**
+ * \brief Records that the specified voxel that was not found in the feature cache should be written to its slot in the cache.
+ *
+ * If several voxels map to the same slot (or the same voxel was missed more than once), only the last write to the slot's owner
+ * survives, and only that voxel will subsequently be written to the slot. This avoids torn writes when the slots are written in parallel.
+ *
+ * \param missIndex         The index of the voxel in the list of missed voxels.
+ * \param missLocations     The locations of the missed voxels.
+ * \param featureCacheSize  The number of slots in the feature cache.
+ * \param cacheOwners       The indices (in the list of missed voxels) of the voxels that will be written to each slot of the feature cache.
+ */
+_CPU_AND_GPU_CODE_
+inline void claim_feature_cache_slot(int missIndex, const Vector3s *missLocations, int featureCacheSize, int *cacheOwners)
+{
+  cacheOwners[compute_feature_cache_slot(missLocations[missIndex], featureCacheSize)] = missIndex;
+}
+
 /**
  * \brief Converts the RGB patch for the specified voxel to the CIELab colour space.
  *
@@ -35,6 +66,21 @@ inline void convert_patch_to_lab(int voxelLocationIndex, size_t featureCount, fl
   }
 }
 
+/**
+ * \brief Quantizes the orientation of an intensity gradient into one of the bins of a histogram of oriented gradients.
+ *
+ * \param xDeriv    The x derivative of the intensity.
+ * \param yDeriv    The y derivative of the intensity.
+ * \param binCount  The number of bins into which to quantize the gradient orientations.
+ * \return          The bin into which the orientation of the gradient falls.
+ */
+_CPU_AND_GPU_CODE_
+inline int compute_orientation_bin(float xDeriv, float yDeriv, size_t binCount)
+{
+  double ori = atan2(yDeriv, xDeriv) + 2 * M_PI;
+  return static_cast<int>(binCount * ori / (2 * M_PI)) % binCount;
+}
+
 /**
  * \brief Computes a histogram of oriented gradients from a patch of intensity values.
  *
@@ -65,11 +111,8 @@ inline void compute_histogram_for_patch(int tid, size_t patchSize, const float *
     // Compute the magnitude.
     float mag = static_cast<float>(sqrt(xDeriv * xDeriv + yDeriv * yDeriv));
 
-    // Compute the orientation.
-    double ori = atan2(yDeriv, xDeriv) + 2 * M_PI;
-
-    // Quantize the orientation and update the histogram.
-    int bin = static_cast<int>(binCount * ori / (2 * M_PI)) % binCount;
+    // Compute and quantize the orientation, and update the histogram.
+    int bin = compute_orientation_bin(xDeriv, yDeriv, binCount);
 
 #if defined(__CUDACC__) && defined(__CUDA_ARCH__)
     atomicAdd(&histogram[bin], mag);
@@ -173,6 +216,38 @@ inline void generate_coordinate_system(int voxelLocationIndex, const Vector3f *s
   yAxes[voxelLocationIndex] = cross(xAxis, n);
 }
 
+/**
+ * \brief Samples the colour of the specified pixel in a voxel's patch from the scene.
+ *
+ * Neighbouring pixels in a patch usually fall within the same voxel block, so callers that sample several pixels
+ * in turn should share a single index cache between them to avoid repeating the hash table lookups.
+ *
+ * \param centre    The location of the voxel at the centre of the patch.
+ * \param xAxis     The x axis of the voxel's coordinate system, scaled by the patch spacing.
+ * \param yAxis     The y axis of the voxel's coordinate system, scaled by the patch spacing.
+ * \param x         The x offset of the pixel from the centre of the patch.
+ * \param y         The y offset of the pixel from the centre of the patch.
+ * \param voxelData The scene's voxel data.
+ * \param indexData The scene's index data.
+ * \param cache     The index cache to use when looking up the voxel.
+ * \return          The colour of the voxel at the pixel's location in world space, if any, or magenta otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector3u sample_patch_colour(const Vector3f& centre, const Vector3f& xAxis, const Vector3f& yAxis, int x, int y,
+                                    const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData, ITMVoxelIndex::IndexCache& cache)
+{
+  // Compute the location of the pixel in world space.
+  Vector3f yLoc = centre + static_cast<float>(y) * yAxis;
+  Vector3i loc = (yLoc + static_cast<float>(x) * xAxis).toIntRound();
+
+  // If there is a voxel at that location, get its colour; otherwise, default to magenta.
+  Vector3u clr(255, 0, 255);
+  int vmIndex;
+  SpaintVoxel voxel = readVoxel(voxelData, indexData, loc, vmIndex, cache);
+  if(vmIndex) clr = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxel);
+  return clr;
+}
+
 /**
  * \brief Generates an RGB patch for the specified voxel by sampling from a regularly-spaced grid around it in its tangent plane.
  *
@@ -199,24 +274,18 @@ inline void generate_rgb_patch(int voxelLocationIndex, const Vector3s *voxelLoca
 
   // Generate an RGB patch around the voxel on a patchSize * patchSize grid aligned with the voxel's x and y axes.
   int halfPatchSize = static_cast<int>(patchSize - 1) / 2;
-  bool isFound;
   Vector3f xAxis = xAxes[voxelLocationIndex] * patchSpacing;
   Vector3f yAxis = yAxes[voxelLocationIndex] * patchSpacing;
 
   // For each pixel in the patch:
+  ITMVoxelIndex::IndexCache cache;
   size_t offset = voxelLocationIndex * featureCount;
   for(int y = -halfPatchSize; y <= halfPatchSize; ++y)
   {
-    Vector3f yLoc = centre + static_cast<float>(y) * yAxis;
     for(int x = -halfPatchSize; x <= halfPatchSize; ++x)
     {
-      // Compute the location of the pixel in world space.
-      Vector3i loc = (yLoc + static_cast<float>(x) * xAxis).toIntRound();
-
-      // If there is a voxel at that location, get its colour; otherwise, default to magenta.
-      Vector3u clr(255, 0, 255);
-      SpaintVoxel voxel = readVoxel(voxelData, indexData, loc, isFound);
-      if(isFound) clr = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxel);
+      // Sample the colour of the pixel from the scene.
+      Vector3u clr = sample_patch_colour(centre, xAxis, yAxis, x, y, voxelData, indexData, cache);
 
       // Write the colour values into the relevant places in the features array.
       features[offset++] = clr.r;
@@ -226,6 +295,114 @@ inline void generate_rgb_patch(int voxelLocationIndex, const Vector3s *voxelLoca
   }
 }
 
+/**
+ * \brief Attempts to copy the cached feature descriptor for the specified voxel into the output features array.
+ *
+ * The cached feature descriptor is only used if it was calculated no earlier than the most recent update of the voxel's block by fusion.
+ *
+ * \param voxelLocationIndex  The index of the voxel to look up.
+ * \param voxelLocations      The locations of the voxels.
+ * \param indexData           The scene's index data.
+ * \param blockVersions       The version of the feature cache at which fusion last updated each voxel block in the scene.
+ * \param cacheLocations      The locations of the voxels whose feature descriptors are stored in the feature cache.
+ * \param cacheVersions       The version of the feature cache at which each slot was written (0 denotes an empty slot).
+ * \param cacheFeatures       The feature descriptors stored in the feature cache (packed sequentially).
+ * \param featureCacheSize    The number of slots in the feature cache.
+ * \param featureCount        The number of features in a feature descriptor for a voxel.
+ * \param features            The feature descriptors for the various voxels (stored sequentially).
+ * \return                    true, if a valid cached feature descriptor was found for the voxel, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool lookup_cached_feature(int voxelLocationIndex, const Vector3s *voxelLocations, const ITMVoxelIndex::IndexData *indexData, const unsigned int *blockVersions,
+                                  const Vector3s *cacheLocations, const unsigned int *cacheVersions, const float *cacheFeatures, int featureCacheSize,
+                                  size_t featureCount, float *features)
+{
+  // Check whether the cache slot for the voxel is occupied by the voxel itself.
+  const Vector3s loc = voxelLocations[voxelLocationIndex];
+  const int slot = compute_feature_cache_slot(loc, featureCacheSize);
+  const unsigned int cacheVersion = cacheVersions[slot];
+  if(cacheVersion == 0 || cacheLocations[slot] != loc) return false;
+
+  // Check that the voxel's block has not been updated since its feature descriptor was calculated.
+  bool isFound;
+  const int voxelAddress = findVoxel(indexData, loc.toInt(), isFound);
+  if(!isFound || cacheVersion < blockVersions[voxelAddress / SDF_BLOCK_SIZE3]) return false;
+
+  // Copy the cached feature descriptor into the features array.
+  const float *src = cacheFeatures + slot * featureCount;
+  float *dst = features + voxelLocationIndex * featureCount;
+  for(size_t i = 0; i < featureCount; ++i)
+  {
+    dst[i] = src[i];
+  }
+
+  return true;
+}
+
+/**
+ * \brief Tags the specified visible voxel block with the current version of the feature cache.
+ *
+ * \param visibleEntityIndex  The index of the voxel block in the list of visible entities.
+ * \param visibleEntityIDs    The IDs of the hash entries of the visible voxel blocks.
+ * \param hashTable           The scene's hash table.
+ * \param featureCacheVersion The current version of the feature cache.
+ * \param blockVersions       The version of the feature cache at which fusion last updated each voxel block in the scene.
+ */
+_CPU_AND_GPU_CODE_
+inline void stamp_voxel_block(int visibleEntityIndex, const int *visibleEntityIDs, const ITMHashEntry *hashTable, unsigned int featureCacheVersion,
+                              unsigned int *blockVersions)
+{
+  const int blockPtr = hashTable[visibleEntityIDs[visibleEntityIndex]].ptr;
+  if(blockPtr >= 0) blockVersions[blockPtr] = featureCacheVersion;
+}
+
+/**
+ * \brief Copies the feature descriptor calculated for a voxel that was not found in the feature cache into the output features array,
+ *        and stores it in the feature cache if the voxel owns its cache slot.
+ *
+ * \param missIndex           The index of the voxel in the list of missed voxels.
+ * \param missIndices         The indices (in the input list of voxels) of the missed voxels.
+ * \param missLocations       The locations of the missed voxels.
+ * \param missFeatures        The feature descriptors calculated for the missed voxels (packed sequentially).
+ * \param featureCount        The number of features in a feature descriptor for a voxel.
+ * \param featureCacheVersion The current version of the feature cache.
+ * \param featureCacheSize    The number of slots in the feature cache.
+ * \param cacheOwners         The indices (in the list of missed voxels) of the voxels that will be written to each slot of the feature cache.
+ * \param cacheLocations      The locations of the voxels whose feature descriptors are stored in the feature cache.
+ * \param cacheVersions       The version of the feature cache at which each slot was written (0 denotes an empty slot).
+ * \param cacheFeatures       The feature descriptors stored in the feature cache (packed sequentially).
+ * \param features            The feature descriptors for the various voxels (stored sequentially).
+ */
+_CPU_AND_GPU_CODE_
+inline void store_cached_feature(int missIndex, const int *missIndices, const Vector3s *missLocations, const float *missFeatures, size_t featureCount,
+                                 unsigned int featureCacheVersion, int featureCacheSize, const int *cacheOwners, Vector3s *cacheLocations,
+                                 unsigned int *cacheVersions, float *cacheFeatures, float *features)
+{
+  const float *src = missFeatures + missIndex * featureCount;
+
+  // Copy the feature descriptor into the features array.
+  float *dst = features + missIndices[missIndex] * featureCount;
+  for(size_t i = 0; i < featureCount; ++i)
+  {
+    dst[i] = src[i];
+  }
+
+  // If the voxel owns its cache slot, also store the feature descriptor in the cache.
+  const Vector3s loc = missLocations[missIndex];
+  const int slot = compute_feature_cache_slot(loc, featureCacheSize);
+  if(cacheOwners[slot] == missIndex)
+  {
+    float *cacheDst = cacheFeatures + slot * featureCount;
+    for(size_t i = 0; i < featureCount; ++i)
+    {
+      cacheDst[i] = src[i];
+    }
+
+    cacheLocations[slot] = loc;
+    cacheVersions[slot] = featureCacheVersion;
+  }
+}
+
 /**
  * \brief Updates the coordinate system for a voxel to align it with the dominant orientation in the voxel's RGB patch.
  *
@@ -17,11 +17,18 @@ namespace spaint {
 
 /**
  * \brief An instance of this class can be used to detect ArUco fiducials in a 3D scene.
+ *
+ * If a detection scale of less than 1 is specified (via the ArUcoFiducialDetector.detectionScale setting), the fiducials
+ * are detected in a downsampled copy of the colour image, and their corners are then refined at full resolution. This is
+ * much faster than detecting at full resolution, at the cost of missing fiducials that are very small in the image.
  */
 class ArUcoFiducialDetector : public FiducialDetector
 {
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The factor by which to downsample the colour image before detecting fiducials in it (1 means detect at full resolution). */
+  float m_detectionScale;
+
   /** The picker used when estimating poses from the scene raycast. */
   mutable Picker_CPtr m_picker;
 
@@ -34,6 +41,7 @@ public:
    * \brief Constructs an ArUco fiducial detector.
    *
    * \param settings  The settings to use for InfiniTAM.
+   * \throws std::invalid_argument If the detection scale specified in the settings is not in (0,1].
    */
   explicit ArUcoFiducialDetector(const Settings_CPtr& settings);
 
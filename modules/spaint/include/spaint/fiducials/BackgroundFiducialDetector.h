@@ -0,0 +1,184 @@
+/**
+ * spaint: BackgroundFiducialDetector.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BACKGROUNDFIDUCIALDETECTOR
+#define H_SPAINT_BACKGROUNDFIDUCIALDETECTOR
+
+#include <deque>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "FiducialDetector.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to run another fiducial detector on a separate thread, off the SLAM critical path.
+ *
+ * Each call to submit snapshots the view, the camera pose and the scene raycast and returns immediately. A worker thread
+ * then runs the wrapped detector on the snapshot, and publishes the resulting measurements tagged with the index of the
+ * frame on which they were made. At most one snapshot waits for the worker at any one time: if a new one is submitted
+ * whilst another is still waiting, the older one is dropped, so that the detector always works on the most recent frame.
+ *
+ * Note that the public member functions are intended to be called from a single (SLAM) thread.
+ */
+class BackgroundFiducialDetector
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains the fiducial measurements that were made on a particular frame.
+   */
+  struct Result
+  {
+    /** The index of the frame on which the measurements were made. */
+    size_t frameIndex;
+
+    /** The measurements of the fiducials (if any) that were detected in the frame. */
+    std::map<std::string,FiducialMeasurement> measurements;
+  };
+
+private:
+  /**
+   * \brief An instance of this struct represents a snapshot of the inputs needed to detect fiducials in a frame.
+   */
+  struct Snapshot
+  {
+    /** The index of the frame from which the snapshot was taken. */
+    size_t frameIndex;
+
+    /** The pose from which the view was captured. */
+    ORUtils::SE3Pose pose;
+
+    /** The mode to use when estimating the poses of the fiducials. */
+    FiducialDetector::PoseEstimationMode poseEstimationMode;
+
+    /** A render state containing a copy of the scene raycast. */
+    boost::shared_ptr<ITMLib::ITMRenderState> renderState;
+
+    /** A copy of the view. */
+    boost::shared_ptr<ITMLib::ITMView> view;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The type of device on which the wrapped detector reads its inputs. */
+  ITMLib::ITMLibSettings::DeviceType m_deviceType;
+
+  /** The number of snapshots that have been dropped because a newer one was submitted before the worker could start on them. */
+  size_t m_droppedSnapshotCount;
+
+  /** Previously used snapshots whose images can be reused for later snapshots (accessed only whilst holding m_mutex). */
+  std::deque<Snapshot> m_freeSnapshots;
+
+  /** The fiducial detector that is run on the worker thread. */
+  FiducialDetector_CPtr m_innerDetector;
+
+  /** The mutex used to protect the pending snapshot, the free snapshots and the results. */
+  boost::mutex m_mutex;
+
+  /** The snapshot (if any) that is waiting for the worker thread (accessed only whilst holding m_mutex). */
+  boost::optional<Snapshot> m_pendingSnapshot;
+
+  /** The number of times the detector has been reset (used to discard any results for snapshots taken before a reset). */
+  boost::atomic<size_t> m_resetCount;
+
+  /** The results that have been published by the worker thread but not yet taken (accessed only whilst holding m_mutex). */
+  std::deque<Result> m_results;
+
+  /** A condition variable used to wake the worker thread when there is a snapshot for it to process. */
+  boost::condition_variable m_workAvailable;
+
+  /** The worker thread on which the wrapped detector is run. */
+  boost::thread m_worker;
+
+  /** A flag set in the destructor to indicate that the worker thread should terminate. */
+  boost::atomic<bool> m_workerShouldTerminate;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a background fiducial detector.
+   *
+   * \param innerDetector The fiducial detector to run on the worker thread.
+   * \param deviceType    The type of device on which the wrapped detector reads its inputs.
+   * \throws std::invalid_argument  If the wrapped detector is NULL.
+   */
+  BackgroundFiducialDetector(const FiducialDetector_CPtr& innerDetector, ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the background fiducial detector, discarding any snapshot that is still waiting for the worker thread.
+   */
+  ~BackgroundFiducialDetector();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  BackgroundFiducialDetector(const BackgroundFiducialDetector&);
+  BackgroundFiducialDetector& operator=(const BackgroundFiducialDetector&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the number of snapshots that have been dropped because a newer one was submitted before the worker could start on them.
+   *
+   * \return  The number of snapshots that have been dropped.
+   */
+  size_t get_dropped_snapshot_count() const;
+
+  /**
+   * \brief Discards any pending snapshot, and any results that have not yet been taken or that are still being computed.
+   */
+  void reset();
+
+  /**
+   * \brief Snapshots the inputs needed to detect fiducials in a frame, and hands them to the worker thread.
+   *
+   * \param frameIndex          The index of the frame (used to tag the resulting measurements).
+   * \param view                A view of the 3D scene.
+   * \param pose                The pose from which the view was captured.
+   * \param renderState         A render state corresponding to the camera pose.
+   * \param poseEstimationMode  The mode to use when estimating the poses of the fiducials.
+   */
+  void submit(size_t frameIndex, const View_CPtr& view, const ORUtils::SE3Pose& pose, const VoxelRenderState_CPtr& renderState,
+              FiducialDetector::PoseEstimationMode poseEstimationMode);
+
+  /**
+   * \brief Takes any results that the worker thread has published since the last call.
+   *
+   * \return  The results, in the order in which the corresponding frames were submitted.
+   */
+  std::vector<Result> take_results();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Copies the inputs for a frame into a snapshot, allocating the snapshot's images if necessary.
+   *
+   * \param view        The view to copy.
+   * \param renderState The render state whose raycast should be copied.
+   * \param snapshot    The snapshot into which to copy the inputs.
+   */
+  void copy_inputs(const View_CPtr& view, const VoxelRenderState_CPtr& renderState, Snapshot& snapshot) const;
+
+  /**
+   * \brief Runs the worker thread.
+   */
+  void run_worker();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<BackgroundFiducialDetector> BackgroundFiducialDetector_Ptr;
+
+}
+
+#endif
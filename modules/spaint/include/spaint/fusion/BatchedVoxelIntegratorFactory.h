@@ -0,0 +1,37 @@
+/**
+ * spaint: BatchedVoxelIntegratorFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BATCHEDVOXELINTEGRATORFACTORY
+#define H_SPAINT_BATCHEDVOXELINTEGRATORFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/BatchedVoxelIntegrator.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct batched voxel integrators.
+ */
+struct BatchedVoxelIntegratorFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a batched voxel integrator.
+   *
+   * \param deviceType      The device on which the batched voxel integrator should operate.
+   * \param maxFrameCount   The maximum number of frames in a batch.
+   * \param depthImageSize  The size of the depth images to be integrated.
+   * \param rgbImageSize    The size of the colour images to be integrated.
+   * \return                The batched voxel integrator.
+   */
+  static BatchedVoxelIntegrator_Ptr make_batched_voxel_integrator(ITMLib::ITMLibSettings::DeviceType deviceType, int maxFrameCount,
+                                                                  const Vector2i& depthImageSize, const Vector2i& rgbImageSize);
+};
+
+}
+
+#endif
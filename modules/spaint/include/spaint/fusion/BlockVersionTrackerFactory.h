@@ -0,0 +1,33 @@
+/**
+ * spaint: BlockVersionTrackerFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKVERSIONTRACKERFACTORY
+#define H_SPAINT_BLOCKVERSIONTRACKERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/BlockVersionTracker.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct block version trackers.
+ */
+struct BlockVersionTrackerFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a block version tracker.
+   *
+   * \param deviceType  The device on which the block version tracker should operate.
+   * \return            The block version tracker.
+   */
+  static BlockVersionTracker_CPtr make_block_version_tracker(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * spaint: ConvergedBlockFilterFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CONVERGEDBLOCKFILTERFACTORY
+#define H_SPAINT_CONVERGEDBLOCKFILTERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/ConvergedBlockFilter.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct converged block filters.
+ */
+struct ConvergedBlockFilterFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a converged block filter.
+   *
+   * \param deviceType        The device on which the converged block filter should operate.
+   * \param convergenceFrames The number of consecutive frames for which a block must be saturated and stable before it is considered to have converged.
+   * \param maxSDFChange      The maximum mean change in the (normalised) SDF values of a block's observed voxels for which the block is considered to be stable.
+   * \param residualThreshold The depth residual (in m) above which a converged block is fused again.
+   * \return                  The converged block filter.
+   */
+  static ConvergedBlockFilter_Ptr make_converged_block_filter(ITMLib::ITMLibSettings::DeviceType deviceType, int convergenceFrames, float maxSDFChange, float residualThreshold);
+};
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * spaint: SharedVoxelFuser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SHAREDVOXELFUSER
+#define H_SPAINT_SHAREDVOXELFUSER
+
+#include <ITMLib/Engines/Reconstruction/Interface/ITMSceneReconstructionEngine.h>
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/BatchedVoxelIntegrator.h"
+#include "interface/BlockVersionTracker.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to fuse the frames from several sensors into a single shared voxel scene.
+ *
+ * Each SLAM component that shares the scene adds its frame (with its own pose and calibration) to the fuser as it is processed,
+ * at which point the voxel blocks that the frame needs are allocated. Once every component has processed its frame, the frames
+ * are integrated into the scene together, in one batched pass, so that the cost of integration grows much more slowly than the
+ * number of sensors. Note that a component that tracks against the shared scene therefore sees the contributions of the other
+ * sensors (and its own) one frame later than it would if it were fusing into a scene of its own.
+ *
+ * The frames from all of the sensors must have images of the same size.
+ */
+class SharedVoxelFuser
+{
+  //#################### TYPEDEFS ####################
+private:
+  typedef boost::shared_ptr<ITMLib::ITMSceneReconstructionEngine<SpaintVoxel,ITMVoxelIndex> > SceneReconstructionEngine_Ptr;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The integrator used to fuse the frames from all of the sensors into the scene in a single pass. */
+  BatchedVoxelIntegrator_Ptr m_batchedVoxelIntegrator;
+
+  /** The tracker used to stamp the voxel blocks changed by fusion with the versions at which they were changed. */
+  BlockVersionTracker_CPtr m_blockVersionTracker;
+
+  /** The scene reconstruction engine used to allocate the voxel blocks that each frame needs. */
+  SceneReconstructionEngine_Ptr m_sceneReconstructionEngine;
+
+  /** The shared voxel scene. */
+  SpaintVoxelScene_Ptr m_voxelScene;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a shared voxel fuser.
+   *
+   * \param voxelScene      The voxel scene to share.
+   * \param sensorCount     The number of sensors whose frames are to be fused into the scene (this is the maximum number of
+   *                        frames that can be added between successive flushes).
+   * \param depthImageSize  The size of the sensors' depth images.
+   * \param rgbImageSize    The size of the sensors' colour images.
+   * \param deviceType      The device on which the fuser should operate.
+   */
+  SharedVoxelFuser(const SpaintVoxelScene_Ptr& voxelScene, int sensorCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize,
+                   ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Allocates the voxel blocks that a sensor's frame needs, and adds the frame to those to be fused at the next flush.
+   *
+   * \param view                  The view containing the frame's images.
+   * \param trackingState         The tracking state containing the frame's pose.
+   * \param renderState           The sensor's live render state (whose list of visible entries will be updated).
+   * \throws std::runtime_error   If a frame has already been added for every sensor since the last flush, or the frame's images
+   *                              are not of the expected sizes.
+   */
+  void add_frame(const ITMLib::ITMView *view, const ITMLib::ITMTrackingState *trackingState, ITMLib::ITMRenderState *renderState);
+
+  /**
+   * \brief Discards any frames that have been added since the last flush without fusing them (e.g. when the scene is reset).
+   */
+  void discard();
+
+  /**
+   * \brief Fuses the frames that have been added since the last flush into the shared scene.
+   *
+   * \return  The number of frames that were fused.
+   */
+  int flush();
+
+  /**
+   * \brief Gets the shared voxel scene.
+   *
+   * \return  The shared voxel scene.
+   */
+  const SpaintVoxelScene_Ptr& get_voxel_scene() const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<SharedVoxelFuser> SharedVoxelFuser_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * spaint: VoxelBlockDefragmenterFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELBLOCKDEFRAGMENTERFACTORY
+#define H_SPAINT_VOXELBLOCKDEFRAGMENTERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/VoxelBlockDefragmenter.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct voxel block defragmenters.
+ */
+struct VoxelBlockDefragmenterFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a voxel block defragmenter.
+   *
+   * \param deviceType  The device on which the voxel block defragmenter should operate.
+   * \return            The voxel block defragmenter.
+   */
+  static VoxelBlockDefragmenter_CPtr make_voxel_block_defragmenter(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * spaint: VoxelSceneResetterFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENERESETTERFACTORY
+#define H_SPAINT_VOXELSCENERESETTERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/VoxelSceneResetter.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct voxel scene resetters.
+ */
+struct VoxelSceneResetterFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a voxel scene resetter.
+   *
+   * \param deviceType  The device on which the voxel scene resetter should operate.
+   * \return            The voxel scene resetter.
+   */
+  static VoxelSceneResetter_CPtr make_voxel_scene_resetter(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * spaint: BatchedVoxelIntegrator_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BATCHEDVOXELINTEGRATOR_CPU
+#define H_SPAINT_BATCHEDVOXELINTEGRATOR_CPU
+
+#include "../interface/BatchedVoxelIntegrator.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to integrate a batch of frames into a voxel scene in a single pass using the CPU.
+ */
+class BatchedVoxelIntegrator_CPU : public BatchedVoxelIntegrator
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based batched voxel integrator.
+   *
+   * \param maxFrameCount           The maximum number of frames in a batch.
+   * \param depthImageSize          The size of the depth images to be integrated.
+   * \param rgbImageSize            The size of the colour images to be integrated.
+   * \throws std::invalid_argument  If the maximum number of frames in a batch is less than 1.
+   */
+  BatchedVoxelIntegrator_CPU(int maxFrameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void copy_frame(int frameIndex, const ITMLib::ITMView *view);
+
+  /** Override */
+  virtual void flag_visible_entries(const ITMLib::ITMRenderState_VH *renderState);
+
+  /** Override */
+  virtual int gather_flagged_entries(const SpaintVoxelScene *scene);
+
+  /** Override */
+  virtual void integrate_batch(int entryCount, int frameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize, SpaintVoxelScene *scene);
+};
+
+}
+
+#endif
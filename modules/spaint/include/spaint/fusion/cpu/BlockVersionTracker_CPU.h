@@ -0,0 +1,32 @@
+/**
+ * spaint: BlockVersionTracker_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKVERSIONTRACKER_CPU
+#define H_SPAINT_BLOCKVERSIONTRACKER_CPU
+
+#include "../interface/BlockVersionTracker.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to stamp and query the versions of the voxel blocks of a scene using the CPU.
+ */
+class BlockVersionTracker_CPU : public BlockVersionTracker
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual int gather_modified_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion, int versionFlags, ORUtils::MemoryBlock<int>& entryIDsMB) const;
+
+  /** Override */
+  virtual void stamp_all_blocks(unsigned int version, int versionFlags, SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void stamp_entries(const int *entryIDs, int entryCount, unsigned int version, int versionFlags, SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ * spaint: VoxelBlockDefragmenter_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELBLOCKDEFRAGMENTER_CPU
+#define H_SPAINT_VOXELBLOCKDEFRAGMENTER_CPU
+
+#include "../interface/VoxelBlockDefragmenter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to reorder the resident voxel blocks of a scene into Morton order using the CPU.
+ */
+class VoxelBlockDefragmenter_CPU : public VoxelBlockDefragmenter
+{
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual int defragment_scene(SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ * spaint: VoxelSceneResetter_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENERESETTER_CPU
+#define H_SPAINT_VOXELSCENERESETTER_CPU
+
+#include "../interface/VoxelSceneResetter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to reset a voxel scene without clearing the whole of its voxel block array using the CPU.
+ */
+class VoxelSceneResetter_CPU : public VoxelSceneResetter
+{
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void reset_scene(SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * spaint: ConvergedBlockFilter_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CONVERGEDBLOCKFILTER_CUDA
+#define H_SPAINT_CONVERGEDBLOCKFILTER_CUDA
+
+#include "../interface/ConvergedBlockFilter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to stop the voxel blocks that have converged from being fused again using CUDA.
+ */
+class ConvergedBlockFilter_CUDA : public ConvergedBlockFilter
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based converged block filter.
+   *
+   * \param convergenceFrames       The number of consecutive frames for which a block must be saturated and stable before it is considered to have converged.
+   * \param maxSDFChange            The maximum mean change in the (normalised) SDF values of a block's observed voxels for which the block is considered to be stable.
+   * \param residualThreshold       The depth residual (in m) above which a converged block is fused again.
+   * \throws std::invalid_argument  If the number of convergence frames is not in the range [1,255].
+   */
+  ConvergedBlockFilter_CUDA(int convergenceFrames, float maxSDFChange, float residualThreshold);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual int exclude_converged_entries(int visibleEntryCount, const Matrix4f& M, const ITMLib::ITMView *view, const SpaintVoxelScene *scene,
+                                        ITMLib::ITMRenderState_VH *renderState);
+
+  /** Override */
+  virtual void restore_visible_entries(int visibleEntryCount, ITMLib::ITMRenderState_VH *renderState) const;
+
+  /** Override */
+  virtual void update_entries(const int *entryIDs, int entryCount, const SpaintVoxelScene *scene);
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * spaint: VoxelBlockDefragmenter_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELBLOCKDEFRAGMENTER_CUDA
+#define H_SPAINT_VOXELBLOCKDEFRAGMENTER_CUDA
+
+#include "../interface/VoxelBlockDefragmenter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to reorder the resident voxel blocks of a scene into Morton order using CUDA.
+ *
+ * The resident hash entries are compacted into a list on the device in a single pass over the hash table, and then sorted by key
+ * using thrust. The data of the relocated blocks is gathered into a transient scratch buffer and then scattered into the new slots,
+ * one array at a time, so the scratch buffer only needs to be as large as the resident part of the largest array.
+ */
+class VoxelBlockDefragmenter_CUDA : public VoxelBlockDefragmenter
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to store the new slots of the relocated voxel blocks. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_dstPtrsMB;
+
+  /** A memory block in which to store the IDs of the hash entries that refer to resident voxel blocks. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_entryIDsMB;
+
+  /** A memory block in which to store the keys by which to sort the resident hash entries. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned long long> > m_keysMB;
+
+  /** A memory block in which to store the number of resident voxel blocks found on the device. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_residentBlockCountMB;
+
+  /** A memory block in which to store the old slots of the relocated voxel blocks. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_srcPtrsMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based voxel block defragmenter.
+   */
+  VoxelBlockDefragmenter_CUDA();
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual int defragment_scene(SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * spaint: VoxelSceneResetter_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENERESETTER_CUDA
+#define H_SPAINT_VOXELSCENERESETTER_CUDA
+
+#include "../interface/VoxelSceneResetter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to reset a voxel scene without clearing the whole of its voxel block array using CUDA.
+ *
+ * The hash entries are reset in a single pass over the hash table, which also compacts the indices of the resident voxel blocks
+ * into a list on the device. The blocks in the list are then cleared with one thread block per voxel block.
+ */
+class VoxelSceneResetter_CUDA : public VoxelSceneResetter
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to store the number of resident voxel blocks found on the device. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_residentBlockCountMB;
+
+  /** A memory block in which to store the indices (in the voxel block array) of the resident voxel blocks. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_residentBlockPtrsMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based voxel scene resetter.
+   */
+  VoxelSceneResetter_CUDA();
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void reset_scene(SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * spaint: BatchedVoxelIntegrator.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BATCHEDVOXELINTEGRATOR
+#define H_SPAINT_BATCHEDVOXELINTEGRATOR
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+#include <ITMLib/Objects/Tracking/ITMTrackingState.h>
+#include <ITMLib/Objects/Views/ITMView.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to integrate a batch of frames into a voxel scene in a single pass.
+ *
+ * This is intended for offline reconstruction of recorded sequences whose poses are already known (e.g. because they are read
+ * from disk), for which there is no need to raycast the scene between successive frames. The voxel blocks that each frame needs
+ * are allocated as the frame arrives, and its depth image, colour image and poses are copied into the batch. Once the batch is
+ * full (or the sequence ends), every voxel of each block that was visible in any of the frames in the batch is loaded once,
+ * updated with each of the frames in turn (in the order in which they arrived), and written back once, which saves most of the
+ * memory traffic of integrating the frames one at a time. Note that a block is updated with every frame in the batch in whose
+ * view frustum it lies, whether or not it was in that frame's own list of visible blocks: the result can therefore differ very
+ * slightly from that of sequential integration near the edges of the visible region, but only by including extra observations.
+ *
+ * Each frame in a batch has its own poses and camera intrinsics, so a batch can contain frames from several different sensors
+ * observing the same scene (provided that their images are all of the sizes the integrator expects).
+ */
+class BatchedVoxelIntegrator
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the number of hash entries in the batch's list of entries to integrate. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_batchEntryCountMB;
+
+  /** A memory block in which to store the flags indicating which hash entries were visible in any of the frames in the batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_batchEntryFlagsMB;
+
+  /** A memory block in which to store the IDs of the hash entries to integrate (coalesced from the flags when the batch is flushed). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_batchEntryIDsMB;
+
+  /** A memory block in which to store the depth images of the frames in the batch (one after the other). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_depthsMB;
+
+  /** A memory block in which to store the world-to-depth-camera transformations of the frames in the batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Matrix4f> > m_depthPosesMB;
+
+  /** A memory block in which to store the intrinsic parameters of the depth cameras of the frames in the batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector4f> > m_depthProjParamsMB;
+
+  /** The maximum number of frames in a batch. */
+  const int m_maxFrameCount;
+
+  /** A memory block in which to store the colour images of the frames in the batch (one after the other). */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector4u> > m_rgbsMB;
+
+  /** A memory block in which to store the world-to-colour-camera transformations of the frames in the batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Matrix4f> > m_rgbPosesMB;
+
+  /** A memory block in which to store the intrinsic parameters of the colour cameras of the frames in the batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector4f> > m_rgbProjParamsMB;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The size of the depth images in the current batch. */
+  Vector2i m_depthImageSize;
+
+  /** The number of frames in the current batch. */
+  int m_frameCount;
+
+  /** The size of the colour images in the current batch. */
+  Vector2i m_rgbImageSize;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a batched voxel integrator.
+   *
+   * \param maxFrameCount           The maximum number of frames in a batch.
+   * \param depthImageSize          The size of the depth images to be integrated.
+   * \param rgbImageSize            The size of the colour images to be integrated.
+   * \throws std::invalid_argument  If the maximum number of frames in a batch is less than 1.
+   */
+  BatchedVoxelIntegrator(int maxFrameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the batched voxel integrator.
+   */
+  virtual ~BatchedVoxelIntegrator();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Copies the depth and colour images of a frame into the specified slot in the batch.
+   *
+   * \param frameIndex  The index of the slot in the batch.
+   * \param view        The view containing the frame's images.
+   */
+  virtual void copy_frame(int frameIndex, const ITMLib::ITMView *view) = 0;
+
+  /**
+   * \brief Flags the hash entries in the render state's list of visible entries as needing to be integrated.
+   *
+   * \param renderState The render state.
+   */
+  virtual void flag_visible_entries(const ITMLib::ITMRenderState_VH *renderState) = 0;
+
+  /**
+   * \brief Coalesces the flagged hash entries into m_batchEntryIDsMB, and clears their flags.
+   *
+   * Only entries whose voxel blocks are resident in the local voxel block array are retained.
+   *
+   * \param scene The scene.
+   * \return      The number of hash entries to integrate.
+   */
+  virtual int gather_flagged_entries(const SpaintVoxelScene *scene) = 0;
+
+  /**
+   * \brief Integrates all of the frames in the batch into the voxel blocks referred to by the hash entries in m_batchEntryIDsMB.
+   *
+   * \param entryCount      The number of hash entries in m_batchEntryIDsMB.
+   * \param frameCount      The number of frames in the batch.
+   * \param depthImageSize  The size of the depth images in the batch.
+   * \param rgbImageSize    The size of the colour images in the batch.
+   * \param scene           The scene.
+   */
+  virtual void integrate_batch(int entryCount, int frameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize, SpaintVoxelScene *scene) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds a frame to the current batch.
+   *
+   * This must be called after the voxel blocks that the frame needs have been allocated (which also fills in the render state's list
+   * of visible entries). If the batch is full after adding the frame, the caller should flush it before adding any further frames.
+   *
+   * \param view                  The view containing the frame's images.
+   * \param trackingState         The tracking state containing the frame's pose.
+   * \param renderState           The render state whose list of visible entries was updated when the frame's voxel blocks were allocated.
+   * \return                      true, if the batch is now full, or false otherwise.
+   * \throws std::runtime_error   If the batch is already full, or the frame's images are not the size the integrator expects.
+   */
+  bool add_frame(const ITMLib::ITMView *view, const ITMLib::ITMTrackingState *trackingState, const ITMLib::ITMRenderState *renderState);
+
+  /**
+   * \brief Discards the frames in the current batch without integrating them (e.g. when the scene is reset).
+   */
+  void discard();
+
+  /**
+   * \brief Integrates the frames in the current batch into the scene, and starts a new batch.
+   *
+   * \param scene The scene.
+   * \return      The number of frames that were integrated.
+   */
+  int flush(SpaintVoxelScene *scene);
+
+  /**
+   * \brief Gets the number of frames in the current batch.
+   *
+   * \return  The number of frames in the current batch.
+   */
+  int get_frame_count() const;
+
+  /**
+   * \brief Gets the maximum number of frames in a batch.
+   *
+   * \return  The maximum number of frames in a batch.
+   */
+  int get_max_frame_count() const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<BatchedVoxelIntegrator> BatchedVoxelIntegrator_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * spaint: BlockVersionTracker.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKVERSIONTRACKER
+#define H_SPAINT_BLOCKVERSIONTRACKER
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to stamp the voxel blocks of a scene with the versions
+ *        at which they were changed, and to find the blocks that have changed since a given version.
+ *
+ * The label versions of the blocks are stamped by the operations that relabel voxels themselves, since they know exactly
+ * which voxels they change. Fusion, however, happens inside InfiniTAM, so the geometry versions of the blocks are instead
+ * stamped after each frame has been fused, using the visible list (fusion only ever changes the blocks that are visible).
+ * This is conservative, in that a visible block is stamped even if fusing the frame didn't actually change it.
+ *
+ * Finding the modified blocks compacts the hash table into a list of entry IDs on the device, so it costs a single pass
+ * over the hash table, regardless of how many blocks have changed (and only a single integer is copied back to the host).
+ */
+class BlockVersionTracker
+{
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration are flags specifying which of the versions of a block are of interest.
+   */
+  enum VersionFlag
+  {
+    /** The version at which the block's geometry was last changed. */
+    VERSION_GEOMETRY = 1,
+
+    /** The version at which the labels of the block's voxels were last changed. */
+    VERSION_LABELS = 2,
+
+    /** Both versions. */
+    VERSION_ALL = VERSION_GEOMETRY | VERSION_LABELS
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the number of modified entries found on the device. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_countMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a block version tracker.
+   */
+  BlockVersionTracker();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the block version tracker.
+   */
+  virtual ~BlockVersionTracker();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the IDs of the hash entries that refer to blocks that have changed since the specified version into the specified memory block.
+   *
+   * \param scene         The scene.
+   * \param sinceVersion  The version since which the blocks must have changed.
+   * \param versionFlags  The versions of the blocks that should be compared (a block is modified if any of them is newer).
+   * \param entryIDsMB    The memory block into which to write the entry IDs.
+   * \return              The number of entry IDs written.
+   */
+  virtual int gather_modified_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion, int versionFlags, ORUtils::MemoryBlock<int>& entryIDsMB) const = 0;
+
+  /**
+   * \brief Stamps every block record of the scene with the specified version.
+   *
+   * \param version       The version with which to stamp the blocks.
+   * \param versionFlags  The versions of the blocks that should be stamped.
+   * \param scene         The scene.
+   */
+  virtual void stamp_all_blocks(unsigned int version, int versionFlags, SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Stamps the blocks referred to by the specified hash entries with the specified version.
+   *
+   * \param entryIDs      The IDs of the hash entries of the blocks to stamp.
+   * \param entryCount    The number of blocks to stamp.
+   * \param version       The version with which to stamp the blocks.
+   * \param versionFlags  The versions of the blocks that should be stamped.
+   * \param scene         The scene.
+   */
+  virtual void stamp_entries(const int *entryIDs, int entryCount, unsigned int version, int versionFlags, SpaintVoxelScene *scene) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Finds the hash entries that refer to the voxel blocks that have changed since the specified version.
+   *
+   * If the scene has been reset since the specified version (see SpaintVoxelScene::get_reset_version), the blocks it
+   * then contained no longer exist, and anything derived from them must be rebuilt from scratch rather than updated.
+   *
+   * \param scene                   The scene.
+   * \param sinceVersion            The version since which the blocks must have changed.
+   * \param versionFlags            The versions of the blocks that should be compared (a block is modified if any of them is newer).
+   * \param entryIDsMB              A memory block into which to write the IDs of the hash entries of the modified blocks. These are
+   *                                written on the device on which the tracker operates, in no particular order.
+   * \return                        The number of entry IDs written.
+   * \throws std::invalid_argument  If the memory block is too small to hold an entry for every voxel block in the scene.
+   */
+  int find_modified_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion, int versionFlags, ORUtils::MemoryBlock<int>& entryIDsMB) const;
+
+  /**
+   * \brief Stamps all of the voxel blocks in the scene with a new version.
+   *
+   * This is needed after any operation that may have changed blocks that weren't visible (e.g. fusing a batch of frames).
+   *
+   * \param scene         The scene.
+   * \param versionFlags  The versions of the blocks that should be stamped.
+   * \return              The version with which the blocks were stamped.
+   */
+  unsigned int stamp_all_blocks(SpaintVoxelScene *scene, int versionFlags) const;
+
+  /**
+   * \brief Stamps the voxel blocks that are currently visible with a new version.
+   *
+   * \param scene         The scene.
+   * \param renderState   The live render state of the scene (whose visible entries are the voxel blocks into which the frame was fused).
+   * \param versionFlags  The versions of the blocks that should be stamped.
+   * \return              The version with which the blocks were stamped.
+   */
+  unsigned int stamp_visible_blocks(SpaintVoxelScene *scene, const ITMLib::ITMRenderState *renderState, int versionFlags) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const BlockVersionTracker> BlockVersionTracker_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * spaint: ConvergedBlockFilter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CONVERGEDBLOCKFILTER
+#define H_SPAINT_CONVERGEDBLOCKFILTER
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+#include <ITMLib/Objects/Tracking/ITMTrackingState.h>
+#include <ITMLib/Objects/Views/ITMView.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to stop the voxel blocks that have converged from being fused again.
+ *
+ * During a long, largely static session, most of the blocks that are visible in each frame have long since converged, and
+ * fusing the frame into them again changes them very little whilst costing most of the fusion time. A converged block filter
+ * keeps track of how much each block changes each time it is fused. Once all of a block's observed voxels have reached the
+ * maximum weight, and its SDF values have barely changed for a number of consecutive frames, the block is considered to have
+ * converged, and is excluded from the visible list passed to integration. A converged block is fused again (and must then
+ * re-converge before being excluded again) if the live depth image disagrees with the most recent raycast where the block is
+ * seen, since that indicates that the part of the scene it contains has changed.
+ *
+ * The excluded blocks are put back into the visible list once integration has finished, so the raycaster and the swapping
+ * engine see exactly the same visible list as they would if every block had been fused.
+ */
+class ConvergedBlockFilter
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct records how close the voxel block to which a hash entry refers is to having converged.
+   */
+  struct BlockConvergence
+  {
+    /** The position of the voxel block to which the record refers (used to detect hash entries that have been reused for a different block). */
+    Vector3s pos;
+
+    /** The sum of the SDF values of the block's observed voxels after the block was last fused. */
+    float sdfSum;
+
+    /** The number of consecutive fusions for which the block has been saturated and stable. */
+    unsigned char stableFrames;
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the full list of visible entries whilst the converged entries are excluded from it. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_allVisibleEntryIDsMB;
+
+  /** A memory block in which to store the convergence records of the hash entries. */
+  boost::shared_ptr<ORUtils::MemoryBlock<BlockConvergence> > m_blockConvergenceMB;
+
+  /** The number of consecutive frames for which a block must be saturated and stable before it is considered to have converged. */
+  const int m_convergenceFrames;
+
+  /** The maximum mean change in the (normalised) SDF values of a block's observed voxels for which the block is considered to be stable. */
+  const float m_maxSDFChange;
+
+  /** A memory block in which to store the number of visible entries that remain once the converged entries have been excluded. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_remainingEntryCountMB;
+
+  /** The depth residual (in m) above which a converged block is fused again. */
+  const float m_residualThreshold;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of entries in the full list of visible entries, whilst the converged entries are excluded from the list (-1 otherwise). */
+  int m_allVisibleEntryCount;
+
+  /** The number of converged blocks that were excluded from integration for the most recent frame. */
+  int m_skippedBlockCount;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a converged block filter.
+   *
+   * \param convergenceFrames       The number of consecutive frames for which a block must be saturated and stable before it is considered to have converged.
+   * \param maxSDFChange            The maximum mean change in the (normalised) SDF values of a block's observed voxels for which the block is considered to be stable.
+   * \param residualThreshold       The depth residual (in m) above which a converged block is fused again.
+   * \throws std::invalid_argument  If the number of convergence frames is not in the range [1,255].
+   */
+  ConvergedBlockFilter(int convergenceFrames, float maxSDFChange, float residualThreshold);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the converged block filter.
+   */
+  virtual ~ConvergedBlockFilter();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Saves the full list of visible entries into m_allVisibleEntryIDsMB, and then replaces the render state's list of visible
+   *        entries with the entries that are to be fused (i.e. those that have not converged, or whose depth residual is too high).
+   *
+   * \param visibleEntryCount The number of visible entries.
+   * \param M                 The current camera pose (as a world-to-camera transformation).
+   * \param view              The current view.
+   * \param scene             The scene.
+   * \param renderState       The live render state (whose raycast result is from the most recent raycast of the scene).
+   * \return                  The number of visible entries that are to be fused.
+   */
+  virtual int exclude_converged_entries(int visibleEntryCount, const Matrix4f& M, const ITMLib::ITMView *view, const SpaintVoxelScene *scene,
+                                        ITMLib::ITMRenderState_VH *renderState) = 0;
+
+  /**
+   * \brief Copies the full list of visible entries from m_allVisibleEntryIDsMB back into the render state.
+   *
+   * \param visibleEntryCount The number of visible entries.
+   * \param renderState       The live render state.
+   */
+  virtual void restore_visible_entries(int visibleEntryCount, ITMLib::ITMRenderState_VH *renderState) const = 0;
+
+  /**
+   * \brief Updates the convergence records of the voxel blocks into which a frame has just been fused.
+   *
+   * \param entryIDs    The IDs of the hash entries of the voxel blocks into which the frame has just been fused.
+   * \param entryCount  The number of voxel blocks into which the frame has just been fused.
+   * \param scene       The scene.
+   */
+  virtual void update_entries(const int *entryIDs, int entryCount, const SpaintVoxelScene *scene) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Excludes the converged voxel blocks from the render state's list of visible entries, ready for integration.
+   *
+   * This must be called after the scene has been allocated for the current frame, and before the frame is integrated.
+   *
+   * \param view          The current view.
+   * \param trackingState The current tracking state.
+   * \param scene         The scene.
+   * \param renderState   The live render state.
+   */
+  void exclude_converged_blocks(const ITMLib::ITMView *view, const ITMLib::ITMTrackingState *trackingState, const SpaintVoxelScene *scene, ITMLib::ITMRenderState *renderState);
+
+  /**
+   * \brief Updates the convergence records of the voxel blocks that have just been fused, and then restores the full list of visible entries.
+   *
+   * This must be called after the frame has been integrated (and before the render state is used for anything else).
+   *
+   * \param scene       The scene.
+   * \param renderState The live render state.
+   */
+  void finish_integration(const SpaintVoxelScene *scene, ITMLib::ITMRenderState *renderState);
+
+  /**
+   * \brief Gets the number of converged blocks that were excluded from integration for the most recent frame.
+   *
+   * \return  The number of converged blocks that were excluded from integration for the most recent frame.
+   */
+  int get_skipped_block_count() const;
+
+  /**
+   * \brief Resets the converged block filter (e.g. when the scene is reset), so that no block is considered to have converged.
+   */
+  void reset();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<ConvergedBlockFilter> ConvergedBlockFilter_Ptr;
+
+}
+
+#endif
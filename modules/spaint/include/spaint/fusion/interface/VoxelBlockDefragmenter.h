@@ -0,0 +1,60 @@
+/**
+ * spaint: VoxelBlockDefragmenter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELBLOCKDEFRAGMENTER
+#define H_SPAINT_VOXELBLOCKDEFRAGMENTER
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to reorder the resident voxel blocks of a scene so that
+ *        blocks that are close to each other in space are also close to each other in memory.
+ *
+ * InfiniTAM hands out voxel blocks from the top of its free list, so once a scene has been reconstructed for a while (and blocks
+ * have been swapped out, reloaded from an archive, etc.), neighbouring blocks can end up scattered all over the voxel block array.
+ * Raycasting, feature calculation and label propagation all read voxels from neighbouring blocks, so this scattering costs a lot
+ * of cache and memory bandwidth. A voxel block defragmenter sorts the resident blocks by the Morton codes of their positions, and
+ * then moves their contents (together with the scene's per-block and per-voxel label data) into the same set of slots in the voxel
+ * block array, in that order, rewriting the pointers in the hash table to match. Since the set of slots in use does not change,
+ * the scene's free list remains valid and does not need to be rebuilt.
+ *
+ * Since the contents of each slot move, anything that caches data by slot (rather than by hash entry or voxel position)
+ * must be invalidated after the scene has been defragmented. A pass also needs transient device memory that is as large as
+ * the resident part of the voxel block array, so it is best run occasionally (e.g. whilst the scene is not being fused into).
+ */
+class VoxelBlockDefragmenter
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel block defragmenter.
+   */
+  virtual ~VoxelBlockDefragmenter() {}
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Reorders the resident voxel blocks of the specified scene into Morton order.
+   *
+   * Blocks that have been swapped out are left untouched. The versions, label presence masks and relabelled flags
+   * of the blocks move with them, so none of the blocks is considered to have changed.
+   *
+   * \param scene The scene.
+   * \return      The number of resident voxel blocks in the scene.
+   */
+  virtual int defragment_scene(SpaintVoxelScene *scene) const = 0;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const VoxelBlockDefragmenter> VoxelBlockDefragmenter_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * spaint: VoxelSceneResetter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENERESETTER
+#define H_SPAINT_VOXELSCENERESETTER
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to reset a voxel scene without clearing the whole of its voxel block array.
+ *
+ * InfiniTAM's ResetScene clears every voxel in the voxel block array, which is hundreds of megabytes for a typical scene, even if
+ * only a small part of the scene has actually been reconstructed. However, a voxel block that is not in use always contains cleared
+ * voxels once the scene has been reset once (InfiniTAM's swapping engine clears the blocks that it swaps out before freeing them),
+ * so a voxel scene resetter only clears the blocks that are resident in the scene's hash table, and then resets the hash table
+ * and the free lists in the same way as ResetScene. The cost of a reset is thus proportional to the number of hash entries and
+ * resident blocks, rather than to the capacity of the voxel block array.
+ *
+ * Since the voxel block array of a newly-created scene is uninitialised, the first reset of a scene must still be a full one.
+ */
+class VoxelSceneResetter
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel scene resetter.
+   */
+  virtual ~VoxelSceneResetter() {}
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Resets the voxel blocks, hash table and free lists of the specified scene, clearing only the voxel blocks that are resident.
+   *
+   * \note  This does not reset the scene's block occupancy, block versions or semantic label data, which must be reset separately.
+   *
+   * \param scene The scene (which must have been fully reset at least once).
+   */
+  virtual void reset_scene(SpaintVoxelScene *scene) const = 0;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const VoxelSceneResetter> VoxelSceneResetter_CPtr;
+
+}
+
+#endif
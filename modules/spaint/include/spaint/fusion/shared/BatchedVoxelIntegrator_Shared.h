@@ -0,0 +1,80 @@
+/**
+ * spaint: BatchedVoxelIntegrator_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BATCHEDVOXELINTEGRATOR_SHARED
+#define H_SPAINT_BATCHEDVOXELINTEGRATOR_SHARED
+
+#include <ITMLib/Engines/Reconstruction/Shared/ITMSceneReconstructionEngine_Shared.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Integrates all of the frames in a batch into a voxel, loading and storing the voxel only once.
+ *
+ * The voxel is updated with each frame in turn, in exactly the way in which InfiniTAM would update it if the frames were integrated
+ * one by one. If integration is to stop once a voxel has reached the maximum weight, the remaining frames are skipped from that point.
+ *
+ * \param entryID               The ID of the hash entry for the voxel block containing the voxel.
+ * \param linearIdx             The linear index of the voxel within its block.
+ * \param hashTable             The scene's hash table.
+ * \param voxelData             The scene's voxel data.
+ * \param frameCount            The number of frames in the batch.
+ * \param depthPoses            The world-to-depth-camera transformations of the frames in the batch.
+ * \param depthProjParams       The intrinsic parameters of the depth cameras of the frames in the batch.
+ * \param rgbPoses              The world-to-colour-camera transformations of the frames in the batch.
+ * \param rgbProjParams         The intrinsic parameters of the colour cameras of the frames in the batch.
+ * \param depths                The depth images of the frames in the batch (one after the other).
+ * \param depthImageSize        The size of the depth images.
+ * \param rgbs                  The colour images of the frames in the batch (one after the other).
+ * \param rgbImageSize          The size of the colour images.
+ * \param voxelSize             The size of a voxel (in m).
+ * \param mu                    The truncation distance (in m).
+ * \param maxW                  The maximum weight of a voxel.
+ * \param stopIntegratingAtMaxW Whether or not to stop integrating into a voxel once it has reached the maximum weight.
+ */
+_CPU_AND_GPU_CODE_
+inline void integrate_voxel_batch(int entryID, int linearIdx, const ITMHashEntry *hashTable, SpaintVoxel *voxelData, int frameCount,
+                                  const Matrix4f *depthPoses, const Vector4f *depthProjParams, const Matrix4f *rgbPoses, const Vector4f *rgbProjParams,
+                                  const float *depths, const Vector2i& depthImageSize, const Vector4u *rgbs, const Vector2i& rgbImageSize,
+                                  float voxelSize, float mu, int maxW, bool stopIntegratingAtMaxW)
+{
+  const ITMHashEntry& hashEntry = hashTable[entryID];
+  if(hashEntry.ptr < 0) return;
+
+  const int x = linearIdx % SDF_BLOCK_SIZE;
+  const int y = (linearIdx / SDF_BLOCK_SIZE) % SDF_BLOCK_SIZE;
+  const int z = linearIdx / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE);
+
+  Vector4f pt_model;
+  pt_model.x = (float)(hashEntry.pos.x * SDF_BLOCK_SIZE + x) * voxelSize;
+  pt_model.y = (float)(hashEntry.pos.y * SDF_BLOCK_SIZE + y) * voxelSize;
+  pt_model.z = (float)(hashEntry.pos.z * SDF_BLOCK_SIZE + z) * voxelSize;
+  pt_model.w = 1.0f;
+
+  const int depthArea = depthImageSize.x * depthImageSize.y;
+  const int rgbArea = rgbImageSize.x * rgbImageSize.y;
+
+  // Update a local copy of the voxel with each frame in turn, and then write it back.
+  SpaintVoxel *voxelPtr = voxelData + hashEntry.ptr * SDF_BLOCK_SIZE3 + linearIdx;
+  SpaintVoxel voxel = *voxelPtr;
+  for(int k = 0; k < frameCount; ++k)
+  {
+    if(stopIntegratingAtMaxW && voxel.w_depth == maxW) break;
+
+    ComputeUpdatedVoxelInfo<SpaintVoxel::hasColorInformation,SpaintVoxel::hasConfidenceInformation,SpaintVoxel>::compute(
+      voxel, pt_model, depthPoses[k], depthProjParams[k], rgbPoses[k], rgbProjParams[k], mu, maxW,
+      depths + k * depthArea, NULL, depthImageSize, rgbs + k * rgbArea, rgbImageSize
+    );
+  }
+  *voxelPtr = voxel;
+}
+
+}
+
+#endif
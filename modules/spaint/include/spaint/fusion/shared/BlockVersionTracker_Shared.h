@@ -0,0 +1,46 @@
+/**
+ * spaint: BlockVersionTracker_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKVERSIONTRACKER_SHARED
+#define H_SPAINT_BLOCKVERSIONTRACKER_SHARED
+
+#include "../interface/BlockVersionTracker.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not a voxel block has changed since the specified version.
+ *
+ * \param blockVersions The versions at which the block was last changed.
+ * \param sinceVersion  The version since which the block must have changed.
+ * \param versionFlags  The versions of the block that should be compared.
+ * \return              true, if any of the specified versions of the block is newer than sinceVersion, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_block_modified_since(const SpaintVoxelScene::BlockVersions& blockVersions, unsigned int sinceVersion, int versionFlags)
+{
+  return ((versionFlags & BlockVersionTracker::VERSION_GEOMETRY) && blockVersions.geometry > sinceVersion) ||
+         ((versionFlags & BlockVersionTracker::VERSION_LABELS) && blockVersions.labels > sinceVersion);
+}
+
+/**
+ * \brief Stamps a voxel block with the specified version.
+ *
+ * \param version       The version with which to stamp the block.
+ * \param versionFlags  The versions of the block that should be stamped.
+ * \param blockVersions The versions at which the block was last changed.
+ */
+_CPU_AND_GPU_CODE_
+inline void stamp_block_versions(unsigned int version, int versionFlags, SpaintVoxelScene::BlockVersions& blockVersions)
+{
+  if(versionFlags & BlockVersionTracker::VERSION_GEOMETRY) blockVersions.geometry = version;
+  if(versionFlags & BlockVersionTracker::VERSION_LABELS) blockVersions.labels = version;
+}
+
+}
+
+#endif
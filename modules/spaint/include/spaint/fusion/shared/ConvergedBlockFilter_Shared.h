@@ -0,0 +1,146 @@
+/**
+ * spaint: ConvergedBlockFilter_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CONVERGEDBLOCKFILTER_SHARED
+#define H_SPAINT_CONVERGEDBLOCKFILTER_SHARED
+
+#include "../interface/ConvergedBlockFilter.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not the live depth image disagrees with the most recent raycast of the scene where a voxel block is seen.
+ *
+ * The block's centre and corners are projected into the depth image. A sample indicates a change if the live depth differs from
+ * the depth of the raycast point at the same pixel by more than the threshold, and either of them lies within the block's extent.
+ * Since the raycast was made from the previous frame's pose, the pixel correspondence is only approximate, but the camera moves
+ * little between successive frames, and wrongly deciding that a block has changed only costs a redundant fusion.
+ *
+ * \param blockPos          The position of the voxel block (in block coordinates).
+ * \param M                 The current camera pose (as a world-to-camera transformation).
+ * \param projParams        The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+ * \param depth             The live depth image (in m).
+ * \param depthSize         The size of the live depth image.
+ * \param raycastResult     The points (in voxel coordinates, with w > 0 iff the ray hit the scene) of the most recent raycast of the scene.
+ * \param raycastSize       The size of the raycast result.
+ * \param voxelSize         The size of a voxel (in m).
+ * \param residualThreshold The depth residual (in m) above which the block is considered to have changed.
+ * \return                  true, if the block is considered to have changed, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool has_depth_residual(const Vector3s& blockPos, const Matrix4f& M, const Vector4f& projParams, const float *depth, const Vector2i& depthSize,
+                               const Vector4f *raycastResult, const Vector2i& raycastSize, float voxelSize, float residualThreshold)
+{
+  const float blockSize = voxelSize * SDF_BLOCK_SIZE;
+  const float halfDiagonal = 0.8660254f * blockSize;
+
+  const Vector4f centre((blockPos.x + 0.5f) * blockSize, (blockPos.y + 0.5f) * blockSize, (blockPos.z + 0.5f) * blockSize, 1.0f);
+  const float centreZ = (M * centre).z;
+
+  for(int i = 0; i < 9; ++i)
+  {
+    // Samples 0-7 are the corners of the block, and sample 8 is its centre.
+    const Vector4f pt = i == 8 ? centre : Vector4f((blockPos.x + (i & 1)) * blockSize, (blockPos.y + ((i >> 1) & 1)) * blockSize, (blockPos.z + ((i >> 2) & 1)) * blockSize, 1.0f);
+    const Vector4f c = M * pt;
+    if(c.z <= 0.0f) continue;
+
+    const int x = static_cast<int>(projParams.x * c.x / c.z + projParams.z + 0.5f);
+    const int y = static_cast<int>(projParams.y * c.y / c.z + projParams.w + 0.5f);
+    if(x < 0 || x >= depthSize.x || y < 0 || y >= depthSize.y) continue;
+
+    const float d = depth[y * depthSize.x + x];
+    if(d <= 0.0f) continue;
+
+    const int rx = x * raycastSize.x / depthSize.x, ry = y * raycastSize.y / depthSize.y;
+    const Vector4f r = raycastResult[ry * raycastSize.x + rx];
+    if(r.w <= 0.0f)
+    {
+      // The raycast did not hit the scene here: if the camera now sees a surface within the block, the block has changed.
+      if(fabs(d - centreZ) <= halfDiagonal) return true;
+      continue;
+    }
+
+    const float rayZ = (M * Vector4f(r.x * voxelSize, r.y * voxelSize, r.z * voxelSize, 1.0f)).z;
+    if(fabs(d - rayZ) > residualThreshold && (fabs(d - centreZ) <= halfDiagonal || fabs(rayZ - centreZ) <= halfDiagonal)) return true;
+  }
+
+  return false;
+}
+
+/**
+ * \brief Determines whether or not the voxel block to which the specified visible entry refers should be fused into.
+ *
+ * If the block has converged, but the depth residual where it is seen is too high, its convergence record is reset.
+ *
+ * \param entryID           The ID of the hash entry.
+ * \param hashTable         The scene's hash table.
+ * \param blockConvergence  The convergence records of the hash entries.
+ * \param convergenceFrames The number of consecutive stable frames after which a block is considered to have converged.
+ * \param M                 The current camera pose (as a world-to-camera transformation).
+ * \param projParams        The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+ * \param depth             The live depth image (in m).
+ * \param depthSize         The size of the live depth image.
+ * \param raycastResult     The points of the most recent raycast of the scene.
+ * \param raycastSize       The size of the raycast result.
+ * \param voxelSize         The size of a voxel (in m).
+ * \param residualThreshold The depth residual (in m) above which a converged block is fused again.
+ * \return                  true, if the block should be fused into, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool should_fuse_entry(int entryID, const ITMHashEntry *hashTable, ConvergedBlockFilter::BlockConvergence *blockConvergence, int convergenceFrames,
+                              const Matrix4f& M, const Vector4f& projParams, const float *depth, const Vector2i& depthSize,
+                              const Vector4f *raycastResult, const Vector2i& raycastSize, float voxelSize, float residualThreshold)
+{
+  // Note: Blocks that are not resident are kept in the list, since integration skips them anyway.
+  const ITMHashEntry& hashEntry = hashTable[entryID];
+  if(hashEntry.ptr < 0) return true;
+
+  ConvergedBlockFilter::BlockConvergence& convergence = blockConvergence[entryID];
+  if(!(convergence.pos == hashEntry.pos) || convergence.stableFrames < convergenceFrames) return true;
+
+  if(has_depth_residual(hashEntry.pos, M, projParams, depth, depthSize, raycastResult, raycastSize, voxelSize, residualThreshold))
+  {
+    convergence.stableFrames = 0;
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * \brief Updates the convergence record of a voxel block into which a frame has just been fused.
+ *
+ * \param entryID           The ID of the hash entry.
+ * \param hashEntry         The hash entry.
+ * \param observedCount     The number of the block's voxels that have been observed (i.e. have a non-zero depth weight).
+ * \param saturatedCount    The number of the block's voxels whose depth weight has reached the maximum.
+ * \param sdfSum            The sum of the (normalised) SDF values of the block's observed voxels.
+ * \param maxSDFChange      The maximum mean change in the SDF values of the observed voxels for which the block is considered to be stable.
+ * \param blockConvergence  The convergence records of the hash entries.
+ */
+_CPU_AND_GPU_CODE_
+inline void write_block_convergence(int entryID, const ITMHashEntry& hashEntry, int observedCount, int saturatedCount, float sdfSum, float maxSDFChange,
+                                    ConvergedBlockFilter::BlockConvergence *blockConvergence)
+{
+  ConvergedBlockFilter::BlockConvergence& convergence = blockConvergence[entryID];
+
+  // Note: The sum of the SDF values is only a cheap proxy for the block's SDF values themselves, but storing the values
+  //       from the previous fusion of every block would cost as much memory as the scene itself.
+  if(convergence.pos == hashEntry.pos && observedCount > 0 && saturatedCount == observedCount &&
+     fabs(sdfSum - convergence.sdfSum) <= maxSDFChange * observedCount)
+  {
+    if(convergence.stableFrames < 255) ++convergence.stableFrames;
+  }
+  else convergence.stableFrames = 0;
+
+  convergence.pos = hashEntry.pos;
+  convergence.sdfSum = sdfSum;
+}
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * spaint: VoxelBlockDefragmenter_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELBLOCKDEFRAGMENTER_SHARED
+#define H_SPAINT_VOXELBLOCKDEFRAGMENTER_SHARED
+
+#include "../../util/MortonCode_Shared.h"
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Copies an element of a relocated voxel block from its old slot in a per-block (or per-voxel) array into a scratch array.
+ *
+ * The scratch array holds the relocated blocks contiguously, in the order in which they are to be written back.
+ *
+ * \param i                 The index of the element in the scratch array.
+ * \param srcPtrs           The old slots of the relocated blocks, in the order in which they are to be written back.
+ * \param elementsPerBlock  The number of elements of the array that belong to each block.
+ * \param data              The array.
+ * \param scratch           The scratch array.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline void gather_block_element(int i, const int *srcPtrs, int elementsPerBlock, const T *data, T *scratch)
+{
+  const int k = i / elementsPerBlock, offset = i % elementsPerBlock;
+  scratch[i] = data[srcPtrs[k] * elementsPerBlock + offset];
+}
+
+/**
+ * \brief Gets the key by which to sort the resident voxel block referred to by a hash entry.
+ *
+ * \param hashEntry The hash entry.
+ * \return          The key by which to sort the block (the Morton code of its position).
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned long long make_block_sort_key(const ITMHashEntry& hashEntry)
+{
+  return make_morton_code(hashEntry.pos);
+}
+
+/**
+ * \brief Copies an element of a relocated voxel block from a scratch array into its new slot in a per-block (or per-voxel) array.
+ *
+ * \param i                 The index of the element in the scratch array.
+ * \param dstPtrs           The new slots of the relocated blocks, in the same order as the blocks in the scratch array.
+ * \param elementsPerBlock  The number of elements of the array that belong to each block.
+ * \param scratch           The scratch array.
+ * \param data              The array.
+ */
+template <typename T>
+_CPU_AND_GPU_CODE_TEMPLATE_
+inline void scatter_block_element(int i, const int *dstPtrs, int elementsPerBlock, const T *scratch, T *data)
+{
+  const int k = i / elementsPerBlock, offset = i % elementsPerBlock;
+  data[dstPtrs[k] * elementsPerBlock + offset] = scratch[i];
+}
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * spaint: VoxelSceneResetter_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENERESETTER_SHARED
+#define H_SPAINT_VOXELSCENERESETTER_SHARED
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Clears the specified voxel in a resident voxel block.
+ *
+ * \param ptr         The index of the voxel block in the voxel block array.
+ * \param linearIdx   The linear index of the voxel within the block.
+ * \param voxelData   The scene's voxel block array.
+ */
+_CPU_AND_GPU_CODE_
+inline void clear_voxel(int ptr, int linearIdx, SpaintVoxel *voxelData)
+{
+  voxelData[ptr * SDF_BLOCK_SIZE3 + linearIdx] = SpaintVoxel();
+}
+
+/**
+ * \brief Resets the specified hash entry to the state in which ITMLib's ResetScene leaves it.
+ *
+ * \param entryID   The ID of the hash entry.
+ * \param hashTable The scene's hash table.
+ * \return          The index in the voxel block array of the block to which the entry referred, if it was resident, or -1 otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline int reset_hash_entry(int entryID, ITMHashEntry *hashTable)
+{
+  ITMHashEntry& hashEntry = hashTable[entryID];
+  const int ptr = hashEntry.ptr;
+
+  hashEntry.pos.x = hashEntry.pos.y = hashEntry.pos.z = 0;
+  hashEntry.offset = 0;
+  hashEntry.ptr = -2;
+
+  return ptr >= 0 ? ptr : -1;
+}
+
+}
+
+#endif
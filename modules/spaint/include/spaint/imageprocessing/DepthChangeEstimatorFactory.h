@@ -0,0 +1,34 @@
+/**
+ * spaint: DepthChangeEstimatorFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHCHANGEESTIMATORFACTORY
+#define H_SPAINT_DEPTHCHANGEESTIMATORFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/DepthChangeEstimator.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct depth change estimators.
+ */
+struct DepthChangeEstimatorFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a depth change estimator.
+   *
+   * \param changeThreshold The minimum difference (in m) between the depths of a pixel in the two images for the pixel to be considered to have changed.
+   * \param deviceType      The device on which the depth change estimator should operate.
+   * \return                The depth change estimator.
+   */
+  static DepthChangeEstimator_Ptr make_depth_change_estimator(float changeThreshold, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
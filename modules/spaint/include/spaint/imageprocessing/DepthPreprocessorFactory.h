@@ -0,0 +1,39 @@
+/**
+ * spaint: DepthPreprocessorFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHPREPROCESSORFACTORY
+#define H_SPAINT_DEPTHPREPROCESSORFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/DepthPreprocessor.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct depth preprocessors.
+ */
+struct DepthPreprocessorFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a depth preprocessor.
+   *
+   * \param bilateralRadius             The radius (in pixels) of the bilateral filter (0 disables the filtering).
+   * \param spatialSigma                The standard deviation (in pixels) of the spatial kernel of the bilateral filter.
+   * \param depthSigma                  The standard deviation (in metres) of the range (depth) kernel of the bilateral filter.
+   * \param holeFillRadius              The radius (in pixels) of the neighbourhood used for hole filling (0 disables the hole filling).
+   * \param holeFillMaxDepthDifference  The maximum difference (in metres) between the depths used to fill a hole and the nearest depth in its neighbourhood.
+   * \param deviceType                  The device on which the depth preprocessor should operate.
+   * \return                            The depth preprocessor.
+   */
+  static DepthPreprocessor_Ptr make_depth_preprocessor(int bilateralRadius, float spatialSigma, float depthSigma, int holeFillRadius,
+                                                       float holeFillMaxDepthDifference, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
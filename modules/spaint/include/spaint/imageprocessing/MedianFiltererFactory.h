@@ -0,0 +1,34 @@
+/**
+ * spaint: MedianFiltererFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MEDIANFILTERERFACTORY
+#define H_SPAINT_MEDIANFILTERERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/MedianFilterer.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct median filterers.
+ */
+struct MedianFiltererFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a median filterer.
+   *
+   * \param kernelWidth The kernel width to use for median filtering.
+   * \param deviceType  The device on which the median filterer should operate.
+   * \return            The median filterer.
+   */
+  static MedianFilterer_CPtr make_median_filterer(unsigned int kernelWidth, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * spaint: DepthPreprocessor_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHPREPROCESSOR_CPU
+#define H_SPAINT_DEPTHPREPROCESSOR_CPU
+
+#include "../interface/DepthPreprocessor.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to reduce the noise in the depth image of a view using the CPU.
+ */
+class DepthPreprocessor_CPU : public DepthPreprocessor
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based depth preprocessor.
+   *
+   * \param bilateralRadius             The radius (in pixels) of the bilateral filter (0 disables the filtering).
+   * \param spatialSigma                The standard deviation (in pixels) of the spatial kernel of the bilateral filter.
+   * \param depthSigma                  The standard deviation (in metres) of the range (depth) kernel of the bilateral filter.
+   * \param holeFillRadius              The radius (in pixels) of the neighbourhood used for hole filling (0 disables the hole filling).
+   * \param holeFillMaxDepthDifference  The maximum difference (in metres) between the depths used to fill a hole and the nearest depth in its neighbourhood.
+   * \throws std::invalid_argument      If either radius is out of range, or any of the other parameters is not positive.
+   */
+  DepthPreprocessor_CPU(int bilateralRadius, float spatialSigma, float depthSigma, int holeFillRadius, float holeFillMaxDepthDifference);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void bilateral_filter(const ITMFloatImage *input, bool horizontal, ITMFloatImage *output) const;
+
+  /** Override */
+  virtual void fill_holes(const ITMFloatImage *input, ITMFloatImage *output) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * spaint: MedianFilterer_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MEDIANFILTERER_CPU
+#define H_SPAINT_MEDIANFILTERER_CPU
+
+#include "../interface/MedianFilterer.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to perform median filtering on RGBA images using the CPU.
+ */
+class MedianFilterer_CPU : public MedianFilterer
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based median filterer.
+   *
+   * \param kernelWidth             The kernel width to use for median filtering.
+   * \throws std::invalid_argument  If the kernel width is even or greater than MAX_KERNEL_WIDTH.
+   */
+  explicit MedianFilterer_CPU(unsigned int kernelWidth);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void filter(const ITMUChar4Image *input, ITMUChar4Image *output) const;
+};
+
+}
+
+#endif
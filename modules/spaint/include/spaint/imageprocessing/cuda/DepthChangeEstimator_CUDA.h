@@ -0,0 +1,36 @@
+/**
+ * spaint: DepthChangeEstimator_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHCHANGEESTIMATOR_CUDA
+#define H_SPAINT_DEPTHCHANGEESTIMATOR_CUDA
+
+#include "../interface/DepthChangeEstimator.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to estimate how much a depth image has changed relative to a reference depth image using CUDA.
+ */
+class DepthChangeEstimator_CUDA : public DepthChangeEstimator
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based depth change estimator.
+   *
+   * \param changeThreshold         The minimum difference (in m) between the depths of a pixel in the two images for the pixel to be considered to have changed.
+   * \throws std::invalid_argument  If the change threshold is not positive.
+   */
+  explicit DepthChangeEstimator_CUDA(float changeThreshold);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void count_pixels(const ITMFloatImage *depth, const ITMFloatImage *referenceDepth);
+};
+
+}
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * spaint: DepthChangeEstimator.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHCHANGEESTIMATOR
+#define H_SPAINT_DEPTHCHANGEESTIMATOR
+
+#include <ORUtils/MemoryBlock.h>
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to estimate how much a depth image has changed relative to a reference depth image.
+ *
+ * The change is measured as the fraction of the pixels that are valid in both images whose depths differ by more than a threshold.
+ * Counting pixels, rather than averaging the depth differences, means that sensor noise (which perturbs almost every pixel by a small
+ * amount) is ignored, whilst a small object moving in front of the camera (which changes a few pixels by a large amount) is not.
+ * The pixels are counted on the device on which the estimator operates, so only the counts have to be copied across to the CPU.
+ */
+class DepthChangeEstimator
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The minimum difference (in m) between the depths of a pixel in the two images for the pixel to be considered to have changed. */
+  float m_changeThreshold;
+
+  /** A memory block in which to store the number of pixels that are valid in both images (element 0) and the number of those pixels that have changed (element 1). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_pixelCountsMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a depth change estimator.
+   *
+   * \param changeThreshold         The minimum difference (in m) between the depths of a pixel in the two images for the pixel to be considered to have changed.
+   * \throws std::invalid_argument  If the change threshold is not positive.
+   */
+  explicit DepthChangeEstimator(float changeThreshold);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the depth change estimator.
+   */
+  virtual ~DepthChangeEstimator();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Counts the pixels that are valid in both depth images, and the number of those pixels that have changed, and
+   *        stores the counts in m_pixelCountsMB (which must be accessible on the CPU once this function returns).
+   *
+   * \param depth           The depth image.
+   * \param referenceDepth  The reference depth image (which must be the same size as the depth image).
+   */
+  virtual void count_pixels(const ITMFloatImage *depth, const ITMFloatImage *referenceDepth) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Estimates how much a depth image has changed relative to a reference depth image.
+   *
+   * \param depth                   The depth image.
+   * \param referenceDepth          The reference depth image.
+   * \return                        The fraction of the pixels that are valid in both images whose depths differ by more than the
+   *                                change threshold (or 1 if no pixel is valid in both images, since nothing is then known to be unchanged).
+   * \throws std::invalid_argument  If the two images are not the same size.
+   */
+  float estimate_changed_fraction(const ITMFloatImage *depth, const ITMFloatImage *referenceDepth);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<DepthChangeEstimator> DepthChangeEstimator_Ptr;
+
+}
+
+#endif
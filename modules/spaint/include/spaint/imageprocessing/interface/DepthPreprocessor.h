@@ -0,0 +1,111 @@
+/**
+ * spaint: DepthPreprocessor.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHPREPROCESSOR
+#define H_SPAINT_DEPTHPREPROCESSOR
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to reduce the noise in the depth image of a view before it is tracked.
+ *
+ * Two stages are supported, either of which can be disabled. First, small holes in the depth image are filled: each pixel without
+ * a valid depth is given the average of the nearby depths that lie within a threshold of the nearest one, provided that more than
+ * half of the pixels in its neighbourhood are valid (so the edges of large holes are left alone, and depth discontinuities are not
+ * bridged). Then, the depth image is smoothed using a separable approximation to a bilateral filter (a horizontal pass followed by
+ * a vertical pass), which costs O(r) per pixel rather than O(r^2) for a filter of radius r. Pixels without a valid depth are ignored.
+ *
+ * The preprocessing is performed directly on the device on which the preprocessor operates, using a buffer that is owned by the
+ * preprocessor and reused from one frame to the next.
+ */
+class DepthPreprocessor
+{
+  //#################### CONSTANTS ####################
+public:
+  /** The maximum radius (in pixels) of the bilateral filter. */
+  static const int MAX_BILATERAL_RADIUS = 7;
+
+  /** The maximum radius (in pixels) of the neighbourhood used for hole filling. */
+  static const int MAX_HOLE_FILL_RADIUS = 3;
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The radius (in pixels) of the bilateral filter (0 disables the filtering). */
+  int m_bilateralRadius;
+
+  /** The buffer used to hold the intermediate results of the preprocessing. */
+  ITMFloatImage_Ptr m_buffer;
+
+  /** The standard deviation (in metres) of the range (depth) kernel of the bilateral filter. */
+  float m_depthSigma;
+
+  /** The maximum difference (in metres) between the depths used to fill a hole and the nearest depth in its neighbourhood. */
+  float m_holeFillMaxDepthDifference;
+
+  /** The radius (in pixels) of the neighbourhood used for hole filling (0 disables the hole filling). */
+  int m_holeFillRadius;
+
+  /** The standard deviation (in pixels) of the spatial kernel of the bilateral filter. */
+  float m_spatialSigma;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a depth preprocessor.
+   *
+   * \param bilateralRadius             The radius (in pixels) of the bilateral filter (0 disables the filtering).
+   * \param spatialSigma                The standard deviation (in pixels) of the spatial kernel of the bilateral filter.
+   * \param depthSigma                  The standard deviation (in metres) of the range (depth) kernel of the bilateral filter.
+   * \param holeFillRadius              The radius (in pixels) of the neighbourhood used for hole filling (0 disables the hole filling).
+   * \param holeFillMaxDepthDifference  The maximum difference (in metres) between the depths used to fill a hole and the nearest depth in its neighbourhood.
+   * \throws std::invalid_argument      If either radius is out of range, or any of the other parameters is not positive.
+   */
+  DepthPreprocessor(int bilateralRadius, float spatialSigma, float depthSigma, int holeFillRadius, float holeFillMaxDepthDifference);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the depth preprocessor.
+   */
+  virtual ~DepthPreprocessor();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Applies one pass of the separable bilateral filter to a depth image, writing the result into an output image of the same size.
+   *
+   * \param input       The input depth image.
+   * \param horizontal  Whether to filter horizontally (rather than vertically).
+   * \param output      The output depth image.
+   */
+  virtual void bilateral_filter(const ITMFloatImage *input, bool horizontal, ITMFloatImage *output) const = 0;
+
+  /**
+   * \brief Fills small holes in a depth image, writing the result into an output image of the same size.
+   *
+   * \param input   The input depth image.
+   * \param output  The output depth image.
+   */
+  virtual void fill_holes(const ITMFloatImage *input, ITMFloatImage *output) const = 0;
+
+  //#################### PUBLIC OPERATORS ####################
+public:
+  /**
+   * \brief Preprocesses a depth image in place.
+   *
+   * \param depth The depth image (whose data must be up to date on the device on which the preprocessor operates).
+   */
+  void operator()(ITMFloatImage *depth);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<DepthPreprocessor> DepthPreprocessor_Ptr;
+
+}
+
+#endif
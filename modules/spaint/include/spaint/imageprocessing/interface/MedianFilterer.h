@@ -0,0 +1,82 @@
+/**
+ * spaint: MedianFilterer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MEDIANFILTERER
+#define H_SPAINT_MEDIANFILTERER
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to perform median filtering on RGBA images.
+ *
+ * Each channel is filtered independently, and pixels beyond the edges of the image are treated as copies of the
+ * nearest pixels on the edges. The filtering is performed directly on the device on which the filterer operates,
+ * so that (e.g.) a raycast can be filtered on the GPU before it is copied across to the CPU. A filterer does not
+ * use any buffers other than the input and output images, so it can safely be used to filter several images
+ * (e.g. those for different sub-windows) one after the other.
+ */
+class MedianFilterer
+{
+  //#################### CONSTANTS ####################
+public:
+  /** The maximum kernel width that can be used for median filtering. */
+  static const unsigned int MAX_KERNEL_WIDTH = 7;
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The kernel width to use for median filtering. */
+  unsigned int m_kernelWidth;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a median filterer.
+   *
+   * \param kernelWidth             The kernel width to use for median filtering.
+   * \throws std::invalid_argument  If the kernel width is even or greater than MAX_KERNEL_WIDTH.
+   */
+  explicit MedianFilterer(unsigned int kernelWidth);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the median filterer.
+   */
+  virtual ~MedianFilterer();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Performs median filtering on an RGBA input image to produce an RGBA output image of the same size.
+   *
+   * \param input   The input image.
+   * \param output  The output image.
+   */
+  virtual void filter(const ITMUChar4Image *input, ITMUChar4Image *output) const = 0;
+
+  //#################### PUBLIC OPERATORS ####################
+public:
+  /**
+   * \brief Performs median filtering on an RGBA input image to produce an RGBA output image.
+   *
+   * The median filtering will be performed using the parameters provided when the filterer was constructed.
+   * The output image will be resized to match the input image if necessary.
+   *
+   * \param input                   The input image.
+   * \param output                  The output image.
+   * \throws std::invalid_argument  If the input and output images are the same image (the filtering cannot be performed in place).
+   */
+  void operator()(const ITMUChar4Image_CPtr& input, const ITMUChar4Image_Ptr& output) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const MedianFilterer> MedianFilterer_CPtr;
+
+}
+
+#endif
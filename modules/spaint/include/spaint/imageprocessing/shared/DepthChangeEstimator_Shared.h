@@ -0,0 +1,35 @@
+/**
+ * spaint: DepthChangeEstimator_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHCHANGEESTIMATOR_SHARED
+#define H_SPAINT_DEPTHCHANGEESTIMATOR_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not a pixel is valid in both a depth image and a reference depth image, and if so, whether or not its depth has changed.
+ *
+ * \param pixelIndex      The (row-major) index of the pixel.
+ * \param depth           The depth image.
+ * \param referenceDepth  The reference depth image.
+ * \param changeThreshold The minimum difference (in m) between the depths of the pixel in the two images for the pixel to be considered to have changed.
+ * \param valid           A place in which to store whether or not the pixel is valid in both images.
+ * \param changed         A place in which to store whether or not the pixel is valid in both images and its depth has changed.
+ */
+_CPU_AND_GPU_CODE_
+inline void classify_depth_change(int pixelIndex, const float *depth, const float *referenceDepth, float changeThreshold, bool& valid, bool& changed)
+{
+  const float d = depth[pixelIndex], referenceD = referenceDepth[pixelIndex];
+  valid = d > 0.0f && referenceD > 0.0f;
+  changed = valid && fabs(d - referenceD) > changeThreshold;
+}
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * spaint: DepthPreprocessor_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHPREPROCESSOR_SHARED
+#define H_SPAINT_DEPTHPREPROCESSOR_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Applies one pass of a separable bilateral filter to the specified pixel of a depth image.
+ *
+ * \param x                   The x coordinate of the pixel.
+ * \param y                   The y coordinate of the pixel.
+ * \param input               The input depth image.
+ * \param width               The width of the depth images.
+ * \param height              The height of the depth images.
+ * \param radius              The radius (in pixels) of the filter.
+ * \param dx                  The x component of the direction in which to filter (1 for a horizontal pass, 0 for a vertical one).
+ * \param dy                  The y component of the direction in which to filter (0 for a horizontal pass, 1 for a vertical one).
+ * \param spatialWeightFactor The factor by which to multiply the squared distance (in pixels) from the pixel, i.e. -1 / (2 * spatialSigma^2).
+ * \param depthWeightFactor   The factor by which to multiply the squared depth difference from the pixel, i.e. -1 / (2 * depthSigma^2).
+ * \param output              The output depth image.
+ */
+_CPU_AND_GPU_CODE_
+inline void bilateral_filter_depth_pixel(int x, int y, const float *input, int width, int height, int radius, int dx, int dy,
+                                         float spatialWeightFactor, float depthWeightFactor, float *output)
+{
+  const int pixelIndex = y * width + x;
+  const float centreDepth = input[pixelIndex];
+
+  // Leave pixels without a valid depth unchanged.
+  if(centreDepth <= 0.0f)
+  {
+    output[pixelIndex] = centreDepth;
+    return;
+  }
+
+  // Compute a weighted average of the valid depths along the line through the pixel. Note that the pixel itself always has
+  // a weight of 1, so the sum of the weights can never be zero.
+  float weightedSum = 0.0f, weightSum = 0.0f;
+  for(int i = -radius; i <= radius; ++i)
+  {
+    const int nx = x + i * dx, ny = y + i * dy;
+    if(nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+
+    const float depth = input[ny * width + nx];
+    if(depth <= 0.0f) continue;
+
+    const float depthDifference = depth - centreDepth;
+    const float weight = expf(i * i * spatialWeightFactor + depthDifference * depthDifference * depthWeightFactor);
+    weightedSum += weight * depth;
+    weightSum += weight;
+  }
+
+  output[pixelIndex] = weightedSum / weightSum;
+}
+
+/**
+ * \brief Fills the specified pixel of a depth image if it is part of a small hole.
+ *
+ * A pixel is filled if it does not have a valid depth and more than half of the pixels in its neighbourhood do. It is given
+ * the average of the valid depths in its neighbourhood that are within a threshold of the nearest one, so that holes at depth
+ * discontinuities are filled from the foreground surface rather than with a depth that lies between the two surfaces.
+ *
+ * \param x                   The x coordinate of the pixel.
+ * \param y                   The y coordinate of the pixel.
+ * \param input               The input depth image.
+ * \param width               The width of the depth images.
+ * \param height              The height of the depth images.
+ * \param radius              The radius (in pixels) of the neighbourhood.
+ * \param maxDepthDifference  The maximum difference (in metres) between the depths used to fill the hole and the nearest depth.
+ * \param output              The output depth image.
+ */
+_CPU_AND_GPU_CODE_
+inline void fill_depth_hole_pixel(int x, int y, const float *input, int width, int height, int radius, float maxDepthDifference, float *output)
+{
+  const int pixelIndex = y * width + x;
+  const float depth = input[pixelIndex];
+  output[pixelIndex] = depth;
+  if(depth > 0.0f) return;
+
+  // Count the valid depths in the neighbourhood, and find the nearest one.
+  const int xMin = MAX(x - radius, 0), xMax = MIN(x + radius, width - 1);
+  const int yMin = MAX(y - radius, 0), yMax = MIN(y + radius, height - 1);
+  int validCount = 0;
+  float nearestDepth = 0.0f;
+  for(int ny = yMin; ny <= yMax; ++ny)
+  {
+    for(int nx = xMin; nx <= xMax; ++nx)
+    {
+      const float neighbourDepth = input[ny * width + nx];
+      if(neighbourDepth <= 0.0f) continue;
+      if(validCount == 0 || neighbourDepth < nearestDepth) nearestDepth = neighbourDepth;
+      ++validCount;
+    }
+  }
+
+  // If the pixel is not surrounded by enough valid depths to be part of a small hole, leave it alone.
+  const int neighbourhoodSize = (2 * radius + 1) * (2 * radius + 1);
+  if(validCount * 2 <= neighbourhoodSize) return;
+
+  // Otherwise, fill it with the average of the valid depths that are close to the nearest one.
+  float depthSum = 0.0f;
+  int depthCount = 0;
+  for(int ny = yMin; ny <= yMax; ++ny)
+  {
+    for(int nx = xMin; nx <= xMax; ++nx)
+    {
+      const float neighbourDepth = input[ny * width + nx];
+      if(neighbourDepth > 0.0f && neighbourDepth - nearestDepth <= maxDepthDifference)
+      {
+        depthSum += neighbourDepth;
+        ++depthCount;
+      }
+    }
+  }
+
+  output[pixelIndex] = depthSum / depthCount;
+}
+
+}
+
+#endif
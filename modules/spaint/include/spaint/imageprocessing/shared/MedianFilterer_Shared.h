@@ -0,0 +1,119 @@
+/**
+ * spaint: MedianFilterer_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MEDIANFILTERER_SHARED
+#define H_SPAINT_MEDIANFILTERER_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+#include "../interface/MedianFilterer.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Swaps two values if necessary so that they are in ascending order (this is the basic element of a sorting network).
+ *
+ * \param a The first value.
+ * \param b The second value.
+ */
+_CPU_AND_GPU_CODE_
+inline void compare_and_swap(unsigned char& a, unsigned char& b)
+{
+  if(a > b)
+  {
+    const unsigned char temp = a;
+    a = b;
+    b = temp;
+  }
+}
+
+/**
+ * \brief Finds the median of nine values using a sorting network.
+ *
+ * The network only performs the 19 compare-and-swap operations needed to move the median into the middle position,
+ * which is significantly cheaper than fully sorting the values. Note that the values are reordered in the process.
+ *
+ * \param p The values.
+ * \return  The median of the values.
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned char median_of_9(unsigned char *p)
+{
+  compare_and_swap(p[1], p[2]); compare_and_swap(p[4], p[5]); compare_and_swap(p[7], p[8]);
+  compare_and_swap(p[0], p[1]); compare_and_swap(p[3], p[4]); compare_and_swap(p[6], p[7]);
+  compare_and_swap(p[1], p[2]); compare_and_swap(p[4], p[5]); compare_and_swap(p[7], p[8]);
+  compare_and_swap(p[0], p[3]); compare_and_swap(p[5], p[8]); compare_and_swap(p[4], p[7]);
+  compare_and_swap(p[3], p[6]); compare_and_swap(p[1], p[4]); compare_and_swap(p[2], p[5]);
+  compare_and_swap(p[4], p[7]); compare_and_swap(p[4], p[2]); compare_and_swap(p[6], p[4]);
+  compare_and_swap(p[4], p[2]);
+  return p[4];
+}
+
+/**
+ * \brief Finds the median of an odd number of values using a partial selection sort.
+ *
+ * Only the smallest (n+1)/2 values are moved into place, since the median is the largest of these.
+ * Note that the values are reordered in the process.
+ *
+ * \param p The values.
+ * \param n The number of values (must be odd).
+ * \return  The median of the values.
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned char median_of_n(unsigned char *p, int n)
+{
+  const int mid = n / 2;
+  for(int i = 0; i <= mid; ++i)
+  {
+    for(int j = i + 1; j < n; ++j)
+    {
+      compare_and_swap(p[i], p[j]);
+    }
+  }
+  return p[mid];
+}
+
+/**
+ * \brief Computes the median-filtered value of a pixel in an RGBA image.
+ *
+ * \param x           The x coordinate of the pixel.
+ * \param y           The y coordinate of the pixel.
+ * \param kernelWidth The kernel width to use for median filtering (must be odd and at most MedianFilterer::MAX_KERNEL_WIDTH).
+ * \param input       The input image data.
+ * \param width       The width of the image.
+ * \param height      The height of the image.
+ * \param output      The output image data.
+ */
+_CPU_AND_GPU_CODE_
+inline void median_filter_pixel(int x, int y, int kernelWidth, const Vector4u *input, int width, int height, Vector4u *output)
+{
+  // Gather the values of each channel within the kernel, clamping the kernel to the image.
+  unsigned char values[4][MedianFilterer::MAX_KERNEL_WIDTH * MedianFilterer::MAX_KERNEL_WIDTH];
+  const int halfWidth = kernelWidth / 2;
+  int n = 0;
+  for(int dy = -halfWidth; dy <= halfWidth; ++dy)
+  {
+    const int ky = CLAMP(y + dy, 0, height - 1);
+    for(int dx = -halfWidth; dx <= halfWidth; ++dx, ++n)
+    {
+      const int kx = CLAMP(x + dx, 0, width - 1);
+      const Vector4u& value = input[ky * width + kx];
+      for(int c = 0; c < 4; ++c) values[c][n] = value[c];
+    }
+  }
+
+  // Compute the median of each channel, using a sorting network for the common 3x3 case.
+  Vector4u& result = output[y * width + x];
+  for(int c = 0; c < 4; ++c)
+  {
+    result[c] = n == 9 ? median_of_9(values[c]) : median_of_n(values[c], n);
+  }
+}
+
+}
+
+#endif
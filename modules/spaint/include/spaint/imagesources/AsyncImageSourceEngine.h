@@ -6,22 +6,69 @@
 #ifndef H_SPAINT_ASYNCIMAGESOURCEENGINE
 #define H_SPAINT_ASYNCIMAGESOURCEENGINE
 
-#include <queue>
+#include <vector>
 
+#include <boost/atomic.hpp>
 #include <boost/thread.hpp>
 
+#ifdef WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+
 #include <itmx/base/ITMImagePtrTypes.h>
 #include <itmx/base/ITMObjectPtrTypes.h>
 
+#include <tvgutil/containers/SPSCRingBuffer.h>
+#include <tvgutil/containers/TripleBuffer.h>
+
+#include "FrameTimestampSource.h"
+
 namespace spaint {
 
 /**
  * \brief An instance of this class can be used to read RGB-D images asynchronously from an existing image source.
  *        Images are read from the existing source on a separate thread and stored in an in-memory queue. This
  *        leads to lower latency when processing a disk sequence.
+ *
+ * In FIFO mode (the default), the images are cached in a lock-free single-producer/single-consumer ring of preallocated
+ * RGB-D images, and every image is delivered in order. The image grabber only needs to take a lock when it has to sleep
+ * (or wake the consumer), so it never holds one whilst reading images from the inner source.
+ *
+ * In latest-frame mode (intended for live cameras), only the newest image is kept: the images are cached in a lock-free
+ * triple buffer of preallocated RGB-D images, the image grabber never waits for the consumer, and each image it grabs
+ * replaces any image that has not yet been consumed. Consumers thus always receive current data, with a latency that
+ * does not grow when processing falls behind, and the number of images that were dropped can be queried.
+ *
+ * If pinned memory is requested (and CUDA is available), the cached images are allocated on both the CPU and the GPU,
+ * using page-locked host memory, and each image is asynchronously uploaded to the GPU on a dedicated CUDA stream as
+ * soon as it has been grabbed. Consumers that take the cached images via the swapping variant of getImages then receive
+ * images whose data are already resident on the device. Note that this only helps consumers that read the device data
+ * directly: InfiniTAM's view builders always upload their input images from the host, so SLAMComponent gains nothing
+ * from it, and the applications that process sequences leave it disabled.
+ *
+ * Each cached image is stamped with the time at which the image grabber received it from the inner source (together with
+ * any device timestamps provided by the inner source), so that consumers can tell when the frames they get were captured.
+ *
+ * The image grabber can optionally be restricted to a set of CPUs. The cached images can also be preallocated from a thread
+ * running on the consumer's CPUs, so that (on a NUMA machine) their pages are first touched, and thus placed, on the node
+ * of the thread that will read them, rather than on that of whichever thread happens to construct the engine.
  */
-class AsyncImageSourceEngine : public InputSource::ImageSourceEngine
+class AsyncImageSourceEngine : public InputSource::ImageSourceEngine, public FrameTimestampSource
 {
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the different ways in which the images can be buffered.
+   */
+  enum BufferingMode
+  {
+    /** Deliver every image, in order, from a queue of up to the specified capacity. */
+    BUFFER_FIFO,
+
+    /** Deliver only the newest image, dropping any older images that have not yet been consumed. */
+    BUFFER_LATEST
+  };
+
   //#################### NESTED TYPES ####################
 private:
   /**
@@ -37,33 +84,53 @@ private:
 
     /** The RGB component of the RGB-D image. */
     ITMUChar4Image_Ptr rgb;
+
+    /** The timestamps of the RGB-D image. */
+    FrameTimestamps timestamps;
+
+#ifdef WITH_CUDA
+    /** An event recorded on the upload stream once the RGB-D image has been uploaded to the GPU (only used with pinned memory). */
+    cudaEvent_t uploaded;
+#endif
   };
 
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The way in which the images are buffered. */
+  BufferingMode m_bufferingMode;
+
+  /** The calibration parameters most recently provided by the inner source (accessed only whilst holding m_mutex). */
+  ITMLib::ITMRGBDCalib m_calib;
+
+  /** The depth image size most recently provided by the inner source (accessed only whilst holding m_mutex). */
+  Vector2i m_depthImageSize;
+
+  /** The number of frames that have been dropped without being consumed (only ever non-zero in latest-frame mode). */
+  boost::atomic<size_t> m_droppedFrameCount;
+
+  /** The timestamps of the RGB-D image most recently returned by getImages (accessed only by the consumer). */
+  FrameTimestamps m_frameTimestamps;
+
   /** The thread on which images are grabbed from the existing image source. */
   boost::thread m_grabber;
 
+  /** The CPUs to which the image grabber is restricted (empty means no restriction). */
+  std::vector<int> m_grabberCpus;
+
   /** A flag set in the destructor to indicate that the image grabber should terminate. */
-  bool m_grabberShouldTerminate;
+  boost::atomic<bool> m_grabberShouldTerminate;
 
   /** The image source from which to obtain the images to cache. */
   ImageSourceEngine_Ptr m_innerSource;
 
-  /** The synchronisation mutex. */
-  mutable boost::mutex m_mutex;
-
-  /** A pool of reusable RGB-D images. */
-  std::queue<RGBDImage> m_pool;
-
-  /** The maximum number of elements that can be stored in the RGB-D image pool. */
-  size_t m_poolCapacity;
+  /** A flag set by the image grabber when the inner source has run out of images. */
+  boost::atomic<bool> m_innerSourceExhausted;
 
-  /** A queue in which to cache images from the inner source. */
-  std::queue<RGBDImage> m_queue;
+  /** A triple buffer of preallocated RGB-D images in which to cache the newest image from the inner source (only used in latest-frame mode). */
+  tvgutil::TripleBuffer<RGBDImage> m_latest;
 
-  /** The maximum number of images to cache. */
-  size_t m_queueCapacity;
+  /** The mutex used in conjunction with the condition variables to allow the image grabber and the consumer to sleep. */
+  mutable boost::mutex m_mutex;
 
   /** A condition variable used to wait for elements to be added to the queue. */
   mutable boost::condition_variable m_queueNotEmpty;
@@ -71,15 +138,37 @@ private:
   /** A condition variable used to wait for elements to be removed from the queue. */
   boost::condition_variable m_queueNotFull;
 
+  /** The RGB image size most recently provided by the inner source (accessed only whilst holding m_mutex). */
+  Vector2i m_rgbImageSize;
+
+  /** A ring of preallocated RGB-D images in which to cache images from the inner source (only used in FIFO mode). */
+  tvgutil::SPSCRingBuffer<RGBDImage> m_ring;
+
+#ifdef WITH_CUDA
+  /** The CUDA stream on which grabbed images are asynchronously uploaded to the GPU (only used with pinned memory). */
+  cudaStream_t m_uploadStream;
+#endif
+
+  /** Whether or not to allocate the cached images in pinned memory and upload them to the GPU as soon as they are grabbed. */
+  bool m_usePinnedMemory;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
    * \brief Constructs an asynchronous image source engine.
    *
-   * \param innerSource   The image source from which to obtain the images to cache.
-   * \param queueCapacity The maximum number of images to cache (0 means no limit).
+   * \param innerSource     The image source from which to obtain the images to cache.
+   * \param queueCapacity   The maximum number of images to cache in FIFO mode (0 means use a default capacity; ignored in latest-frame mode).
+   * \param usePinnedMemory Whether or not to cache the images in pinned memory and upload them to the GPU as soon as they are
+   *                        grabbed (this is ignored if CUDA is not available).
+   * \param bufferingMode   The way in which to buffer the images.
+   * \param grabberCpus     The CPUs to which to restrict the image grabber (empty means no restriction).
+   * \param consumerCpus    The CPUs on which the consumer of the images runs, from which to preallocate the cached images
+   *                        (empty means preallocate them on the calling thread).
    */
-  explicit AsyncImageSourceEngine(ImageSourceEngine *innerSource, size_t queueCapacity = 0);
+  explicit AsyncImageSourceEngine(ImageSourceEngine *innerSource, size_t queueCapacity = 0, bool usePinnedMemory = false,
+                                  BufferingMode bufferingMode = BUFFER_FIFO, const std::vector<int>& grabberCpus = std::vector<int>(),
+                                  const std::vector<int>& consumerCpus = std::vector<int>());
 
   //#################### DESTRUCTOR ####################
 public:
@@ -99,18 +188,103 @@ public:
   /** Override */
   virtual void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth);
 
+  /**
+   * \brief Gets the next RGB-D image by swapping the contents of the caller's images with those of the cached ones, thereby avoiding a copy.
+   *
+   * The caller keeps its image objects, but their memory is handed back to the image grabber, which will reuse it to cache
+   * a later RGB-D image. The caller's images may thus end up with the memory layout of the cached images (e.g. allocated
+   * only on the CPU), so it must not rely on their device data unless pinned memory is being used, in which case their
+   * device data will already contain the uploaded images, and the caller's images must have been allocated on both the
+   * CPU and the GPU (since the image grabber will upload into them). In latest-frame mode, the next RGB-D image is the
+   * newest one that has been grabbed.
+   *
+   * \param rgb                 An image whose contents will be set to the RGB component of the next RGB-D image.
+   * \param rawDepth            An image whose contents will be set to the depth component of the next RGB-D image.
+   * \throws std::runtime_error If there are no more images to get.
+   */
+  void getImages(ITMUChar4Image& rgb, ITMShortImage& rawDepth);
+
   /** Override */
   virtual Vector2i getRGBImageSize() const;
 
+  /**
+   * \brief Gets the number of frames that have been dropped without being consumed.
+   *
+   * \return The number of frames that have been dropped without being consumed (always zero in FIFO mode).
+   */
+  size_t get_dropped_frame_count() const;
+
+  /** Override */
+  virtual FrameTimestamps get_frame_timestamps() const;
+
   /** Override */
   virtual bool hasMoreImages() const;
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Gets the next RGB-D image to be consumed, if any.
+   *
+   * In latest-frame mode, this takes the newest image from the triple buffer, so it must only be called when about to consume it.
+   *
+   * \return The next RGB-D image to be consumed.
+   * \throws std::runtime_error If there are no more images to get.
+   */
+  RGBDImage& acquire_front();
+
+  /**
+   * \brief Allocates the depth and RGB components of the specified RGB-D image.
+   *
+   * \param rgbdImage       The RGB-D image.
+   * \param depthImageSize  The size of the depth component.
+   * \param rgbImageSize    The size of the RGB component.
+   */
+  void allocate_rgbd_image(RGBDImage& rgbdImage, const Vector2i& depthImageSize, const Vector2i& rgbImageSize) const;
+
+  /**
+   * \brief Gets whether or not there is an RGB-D image waiting to be consumed.
+   *
+   * \return true, if there is an RGB-D image waiting to be consumed, or false otherwise.
+   */
+  bool has_queued_image() const;
+
+  /**
+   * \brief Preallocates the RGB-D images in all of the slots of the buffer currently in use.
+   *
+   * The images are cleared once allocated, so that their host memory is first touched by the calling thread.
+   *
+   * \param cpus  The CPUs to which to restrict the calling thread before allocating the images (empty means no restriction).
+   */
+  void preallocate_rgbd_images(const std::vector<int>& cpus);
+
+  /**
+   * \brief Releases the RGB-D image at the front of the buffer back to the image grabber.
+   *
+   * \note   In latest-frame mode, this is a no-op: the front image is implicitly released when the next image is acquired.
+   */
+  void release_front();
+
   /**
    * \brief Runs the image grabber.
    */
   void run_image_grabber();
+
+  /**
+   * \brief Gets the specified slot for an RGB-D image in the buffer currently in use.
+   *
+   * \note   This is intended for setting up and tearing down the slots, and must only be called when the image grabber is not running.
+   *
+   * \param i The index of the slot.
+   * \return  The specified slot.
+   */
+  RGBDImage& slot(size_t i);
+
+  /**
+   * \brief Gets the number of slots for RGB-D images in the buffer currently in use.
+   *
+   * \return The number of slots for RGB-D images in the buffer currently in use.
+   */
+  size_t slot_count() const;
 };
 
 }
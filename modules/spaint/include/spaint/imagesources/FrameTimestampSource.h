@@ -0,0 +1,43 @@
+/**
+ * spaint: FrameTimestampSource.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FRAMETIMESTAMPSOURCE
+#define H_SPAINT_FRAMETIMESTAMPSOURCE
+
+#include "FrameTimestamps.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can provide the timestamps of the frames returned by an image source.
+ *
+ * Image sources that know when their frames were actually captured (e.g. because they receive them on a separate thread)
+ * should derive from this as well as from ImageSourceEngine, so that clients can discover it by casting. For any other
+ * source, the best a client can do is to assume that each frame was captured at the time at which it was returned.
+ */
+class FrameTimestampSource
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the frame timestamp source.
+   */
+  virtual ~FrameTimestampSource() {}
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the timestamps of the frame most recently returned by the image source's getImages function.
+   *
+   * \note  This must only be called by the thread that calls getImages.
+   *
+   * \return  The timestamps of the frame most recently returned by getImages.
+   */
+  virtual FrameTimestamps get_frame_timestamps() const = 0;
+};
+
+}
+
+#endif
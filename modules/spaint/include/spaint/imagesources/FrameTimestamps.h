@@ -0,0 +1,52 @@
+/**
+ * spaint: FrameTimestamps.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FRAMETIMESTAMPS
+#define H_SPAINT_FRAMETIMESTAMPS
+
+#include <boost/chrono/chrono.hpp>
+#include <boost/optional.hpp>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this struct records when an RGB-D frame was captured.
+ *
+ * The host receive time is always available. The device times are only available for image sources whose devices
+ * stamp their frames, and are expressed relative to the device's own clock, so they can only meaningfully be compared
+ * with each other (e.g. to determine how far apart the depth and RGB images of a frame were captured).
+ */
+struct FrameTimestamps
+{
+  //#################### TYPEDEFS ####################
+
+  typedef boost::chrono::steady_clock Clock;
+
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The time (in seconds, on the device's clock) at which the depth image was captured, if known. */
+  boost::optional<double> depthDeviceTime;
+
+  /** The time at which the frame was received by the host from its device (or read from disk). */
+  Clock::time_point hostReceiveTime;
+
+  /** The time (in seconds, on the device's clock) at which the RGB image was captured, if known. */
+  boost::optional<double> rgbDeviceTime;
+
+  //#################### CONSTRUCTORS ####################
+
+  /**
+   * \brief Constructs a set of frame timestamps for a frame that was received by the host at the specified time.
+   *
+   * \param hostReceiveTime_  The time at which the frame was received by the host.
+   */
+  explicit FrameTimestamps(const Clock::time_point& hostReceiveTime_ = Clock::now())
+  : hostReceiveTime(hostReceiveTime_)
+  {}
+};
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * spaint: ImageFileSequenceSource.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_IMAGEFILESEQUENCESOURCE
+#define H_SPAINT_IMAGEFILESEQUENCESOURCE
+
+#include <string>
+
+#include "RandomAccessImageSource.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class represents a sequence of RGB-D images stored as numbered image files (e.g. rgbm%06i.ppm / depthm%06i.pgm).
+ *
+ * The files for each frame are found by substituting the frame index into a pair of masks, in the same way as InfiniTAM's
+ * ImageFileReader, so a sequence read by this source ends at the same frame.
+ */
+class ImageFileSequenceSource : public RandomAccessImageSource
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The calibration parameters for the camera that produced the images. */
+  ITMLib::ITMRGBDCalib m_calib;
+
+  /** The mask used to construct the paths of the depth images. */
+  std::string m_depthImageMask;
+
+  /** The size of the depth images. */
+  Vector2i m_depthImageSize;
+
+  /** The mask used to construct the paths of the RGB images. */
+  std::string m_rgbImageMask;
+
+  /** The size of the RGB images. */
+  Vector2i m_rgbImageSize;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an image file sequence source.
+   *
+   * \param calibrationFilename The name of the file containing the calibration parameters.
+   * \param rgbImageMask        The mask used to construct the paths of the RGB images.
+   * \param depthImageMask      The mask used to construct the paths of the depth images.
+   * \param initialFrameIndex   The index of the first frame to be read (used to determine the image sizes).
+   * \throws std::runtime_error If the calibration could not be read.
+   */
+  ImageFileSequenceSource(const std::string& calibrationFilename, const std::string& rgbImageMask, const std::string& depthImageMask, size_t initialFrameIndex = 0);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual ITMLib::ITMRGBDCalib get_calib() const;
+
+  /** Override */
+  virtual Vector2i get_depth_image_size() const;
+
+  /** Override */
+  virtual Vector2i get_rgb_image_size() const;
+
+  /** Override */
+  virtual bool has_frame(size_t frameIndex) const;
+
+  /** Override */
+  virtual void read_images(size_t frameIndex, ITMUChar4Image *rgb, ITMShortImage *rawDepth) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Makes the path of an image for the specified frame.
+   *
+   * \param mask        The mask for the type of image.
+   * \param frameIndex  The index of the frame.
+   * \return            The path of the image.
+   */
+  static std::string make_path(const std::string& mask, size_t frameIndex);
+};
+
+}
+
+#endif
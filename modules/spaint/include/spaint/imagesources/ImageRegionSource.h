@@ -0,0 +1,46 @@
+/**
+ * spaint: ImageRegionSource.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_IMAGEREGIONSOURCE
+#define H_SPAINT_IMAGEREGIONSOURCE
+
+#include <boost/optional.hpp>
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can provide the regions of the frames returned by an image source
+ *        outside which the frames contain no valid data.
+ *
+ * Image sources whose frames only contain valid data within a known part of the image (e.g. because they have been masked
+ * to show a segmented object) should derive from this as well as from ImageSourceEngine, so that clients can discover it
+ * by casting and restrict their processing of the frames to the relevant region.
+ */
+class ImageRegionSource
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the image region source.
+   */
+  virtual ~ImageRegionSource() {}
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the region of the frame most recently returned by the image source's getImages function outside which it contains no valid data.
+   *
+   * \note  This must only be called by the thread that calls getImages.
+   *
+   * \return  The region, as (minX, minY, maxX, maxY) with inclusive bounds, or boost::none if the whole frame may contain valid data.
+   */
+  virtual boost::optional<Vector4i> get_image_region() const = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * spaint: PackedSequenceImageSourceEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_PACKEDSEQUENCEIMAGESOURCEENGINE
+#define H_SPAINT_PACKEDSEQUENCEIMAGESOURCEENGINE
+
+#include <itmx/base/ITMObjectPtrTypes.h>
+#include <itmx/persistence/PackedSequenceReader.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to read RGB-D images from a packed sequence file.
+ *
+ * The file is memory-mapped, so this is typically much faster than reading a sequence of individual image files,
+ * and can be wrapped in an AsyncImageSourceEngine to decode the images ahead of the point at which they are needed.
+ */
+class PackedSequenceImageSourceEngine : public InputSource::ImageSourceEngine
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The calibration for the sequence. */
+  ITMLib::ITMRGBDCalib m_calib;
+
+  /** The index of the next frame to read. */
+  size_t m_frameIndex;
+
+  /** The reader used to read the packed sequence file. */
+  itmx::PackedSequenceReader m_reader;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a packed sequence image source engine.
+   *
+   * \param path                The path to the packed sequence file.
+   * \param initialFrameNumber  The index of the first frame to read.
+   * \throws std::runtime_error If the file could not be opened, or its calibration could not be parsed.
+   */
+  explicit PackedSequenceImageSourceEngine(const std::string& path, size_t initialFrameNumber = 0);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual ITMLib::ITMRGBDCalib getCalib() const;
+
+  /** Override */
+  virtual Vector2i getDepthImageSize() const;
+
+  /** Override */
+  virtual void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth);
+
+  /** Override */
+  virtual Vector2i getRGBImageSize() const;
+
+  /** Override */
+  virtual bool hasMoreImages() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * spaint: ParallelImageSourceEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_PARALLELIMAGESOURCEENGINE
+#define H_SPAINT_PARALLELIMAGESOURCEENGINE
+
+#include <map>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include <itmx/base/ITMImagePtrTypes.h>
+#include <itmx/base/ITMObjectPtrTypes.h>
+
+#include "RandomAccessImageSource.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to read RGB-D images from a random-access source using several decoder threads at once.
+ *
+ * Each decoder thread claims the next frame that has not yet been claimed and decodes it into a preallocated slot. Frames
+ * can therefore finish decoding out of order, so they are held in a reorder buffer until they can be delivered in sequence.
+ * At most windowSize frames beyond the one that is due to be delivered next are ever claimed, which bounds the memory used.
+ *
+ * This is most useful for disk sequences stored as compressed image files, for which decoding a single frame can take longer
+ * than processing it. It is typically wrapped in an AsyncImageSourceEngine, so that the rest of the pipeline is unchanged.
+ */
+class ParallelImageSourceEngine : public InputSource::ImageSourceEngine
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a preallocated slot into which a decoder thread can decode a frame.
+   */
+  struct Slot
+  {
+    /** The depth component of the frame. */
+    ITMShortImage_Ptr rawDepth;
+
+    /** The RGB component of the frame. */
+    ITMUChar4Image_Ptr rgb;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The index of the next frame to be claimed by a decoder thread. */
+  size_t m_claimIndex;
+
+  /** The index of the next frame to be delivered to the consumer. */
+  size_t m_deliverIndex;
+
+  /** The index of the first frame that is known not to be available (the sequence ends just before it). */
+  size_t m_endIndex;
+
+  /** A condition variable used to wake the consumer when a frame has been decoded (or the end of the sequence has been found). */
+  mutable boost::condition_variable m_frameReady;
+
+  /** The slots that are not currently in use. */
+  std::vector<Slot> m_freeSlots;
+
+  /** The mutex used to protect the indices, the slots and the termination flag. */
+  mutable boost::mutex m_mutex;
+
+  /** The frames that have been decoded but not yet delivered, indexed by frame number. */
+  std::map<size_t,Slot> m_readyFrames;
+
+  /** The random-access source from which to read the frames. */
+  RandomAccessImageSource_CPtr m_source;
+
+  /** The maximum number of frames beyond the next one to be delivered that can be claimed at any one time. */
+  size_t m_windowSize;
+
+  /** A condition variable used to wake the decoder threads when there may be a frame for them to claim. */
+  boost::condition_variable m_workAvailable;
+
+  /** The decoder threads. */
+  boost::thread_group m_workers;
+
+  /** A flag set in the destructor to indicate that the decoder threads should terminate. */
+  bool m_workersShouldTerminate;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a parallel image source engine.
+   *
+   * \param source            The random-access source from which to read the frames.
+   * \param initialFrameIndex The index of the first frame to deliver.
+   * \param threadCount       The number of decoder threads to use.
+   * \param windowSize        The maximum number of frames that can be in flight at once (0 means twice the number of threads).
+   * \throws std::invalid_argument  If the source is NULL or the number of threads is zero.
+   */
+  ParallelImageSourceEngine(const RandomAccessImageSource_CPtr& source, size_t initialFrameIndex, size_t threadCount, size_t windowSize = 0);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the image source engine.
+   *
+   * \note  This waits for any frames that are currently being decoded to finish.
+   */
+  virtual ~ParallelImageSourceEngine();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ParallelImageSourceEngine(const ParallelImageSourceEngine&);
+  ParallelImageSourceEngine& operator=(const ParallelImageSourceEngine&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual ITMLib::ITMRGBDCalib getCalib() const;
+
+  /** Override */
+  virtual Vector2i getDepthImageSize() const;
+
+  /** Override */
+  virtual void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth);
+
+  /** Override */
+  virtual Vector2i getRGBImageSize() const;
+
+  /** Override */
+  virtual bool hasMoreImages() const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Runs one of the decoder threads.
+   */
+  void run_worker();
+
+  /**
+   * \brief Waits until either the next frame to be delivered has been decoded, or it is known not to be available.
+   *
+   * \param lock  A lock on m_mutex.
+   * \return      true, if the next frame has been decoded, or false otherwise.
+   */
+  bool wait_for_next_frame(boost::unique_lock<boost::mutex>& lock) const;
+};
+
+}
+
+#endif
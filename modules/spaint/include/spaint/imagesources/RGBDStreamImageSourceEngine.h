@@ -0,0 +1,146 @@
+/**
+ * spaint: RGBDStreamImageSourceEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_RGBDSTREAMIMAGESOURCEENGINE
+#define H_SPAINT_RGBDSTREAMIMAGESOURCEENGINE
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <itmx/base/ITMObjectPtrTypes.h>
+#include <itmx/remote/RGBDStreamUtil.h>
+
+#include "FrameTimestampSource.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to receive RGB-D images from a remote RGB-D stream sender over TCP
+ *        (see itmx::RGBDStreamUtil).
+ *
+ * Frames are received on a separate thread, but are only decoded when they are requested. At most one received frame
+ * is kept: if a new frame arrives before the previous one has been requested, the previous one is dropped, so that
+ * the images returned are always the most recent ones, however long the consumer takes to process each of them.
+ * The source has more images for as long as the sender stays connected.
+ */
+class RGBDStreamImageSourceEngine : public InputSource::ImageSourceEngine, public FrameTimestampSource
+{
+  //#################### NESTED TYPES ####################
+private:
+  /** The network connection to the sender (this is opaque here, to keep boost/asio.hpp out of the header). */
+  struct Connection;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The calibration for the camera. */
+  ITMLib::ITMRGBDCalib m_calib;
+
+  /** The network connection to the sender. */
+  boost::shared_ptr<Connection> m_connection;
+
+  /** Whether or not the connection to the sender has been closed. */
+  bool m_connectionClosed;
+
+  /** The number of frames that have been dropped because the consumer could not keep up. */
+  size_t m_droppedFrameCount;
+
+  /** A buffer into which to swap each frame before decoding it (reused to avoid reallocating it for every frame). */
+  std::vector<unsigned char> m_frameBuffer;
+
+  /** The timestamps of the frame most recently returned by getImages (accessed only by the consumer). */
+  FrameTimestamps m_frameTimestamps;
+
+  /** Whether or not there is a received frame waiting to be requested. */
+  bool m_framePending;
+
+  /** The synchronisation mutex. */
+  mutable boost::mutex m_mutex;
+
+  /** The received frame that is waiting to be requested (if any). */
+  std::vector<unsigned char> m_pendingFrame;
+
+  /** The timestamps of the received frame that is waiting to be requested (if any). */
+  FrameTimestamps m_pendingFrameTimestamps;
+
+  /** A condition variable used to wake the consumer when a frame arrives or the connection is closed. */
+  mutable boost::condition_variable m_pendingFrameReady;
+
+  /** The thread on which the frames are received. */
+  boost::thread m_receiver;
+
+  /** The information about the stream that was sent by the sender in its handshake. */
+  itmx::RGBDStreamUtil::StreamInfo m_streamInfo;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an RGB-D stream image source engine.
+   *
+   * This blocks until a sender has connected and completed its handshake.
+   *
+   * \param port                The port on which to listen for the sender.
+   * \throws std::runtime_error If no sender could be accepted, or its handshake or calibration could not be read.
+   */
+  explicit RGBDStreamImageSourceEngine(unsigned short port);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the image source engine, closing the connection to the sender.
+   */
+  ~RGBDStreamImageSourceEngine();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  RGBDStreamImageSourceEngine(const RGBDStreamImageSourceEngine&);
+  RGBDStreamImageSourceEngine& operator=(const RGBDStreamImageSourceEngine&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual ITMLib::ITMRGBDCalib getCalib() const;
+
+  /** Override */
+  virtual Vector2i getDepthImageSize() const;
+
+  /** Override */
+  virtual void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth);
+
+  /** Override */
+  virtual Vector2i getRGBImageSize() const;
+
+  /**
+   * \brief Gets the number of frames that have been dropped so far because the consumer could not keep up.
+   *
+   * \return The number of frames that have been dropped so far.
+   */
+  size_t get_dropped_frame_count() const;
+
+  /** Override */
+  virtual FrameTimestamps get_frame_timestamps() const;
+
+  /**
+   * \brief Gets whether or not the source has more images.
+   *
+   * This blocks until either a frame has arrived or the connection to the sender has been closed.
+   *
+   * \return true, if a frame is available, or false if the sender has disconnected.
+   */
+  virtual bool hasMoreImages() const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Receives frames from the sender until the connection is closed (this runs on the receiver thread).
+   */
+  void run_receiver();
+};
+
+}
+
+#endif
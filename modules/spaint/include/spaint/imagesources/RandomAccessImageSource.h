@@ -0,0 +1,82 @@
+/**
+ * spaint: RandomAccessImageSource.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_RANDOMACCESSIMAGESOURCE
+#define H_SPAINT_RANDOMACCESSIMAGESOURCE
+
+#include <boost/shared_ptr.hpp>
+
+#include <ITMLib/Objects/Camera/ITMRGBDCalib.h>
+#include <ITMLib/Utils/ITMImageTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one represents a sequence of RGB-D images that can be read in any order.
+ *
+ * Unlike an ImageSourceEngine, which can only deliver its images in order, a random-access source can read the images for
+ * any frame on demand. Implementations must allow read_images to be called concurrently from multiple threads, so that
+ * several frames can be decoded at once (see ParallelImageSourceEngine).
+ */
+class RandomAccessImageSource
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the source.
+   */
+  virtual ~RandomAccessImageSource() {}
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the calibration parameters for the camera that produced the images.
+   *
+   * \return  The calibration parameters for the camera that produced the images.
+   */
+  virtual ITMLib::ITMRGBDCalib get_calib() const = 0;
+
+  /**
+   * \brief Gets the size of the depth images.
+   *
+   * \return  The size of the depth images.
+   */
+  virtual Vector2i get_depth_image_size() const = 0;
+
+  /**
+   * \brief Gets the size of the RGB images.
+   *
+   * \return  The size of the RGB images.
+   */
+  virtual Vector2i get_rgb_image_size() const = 0;
+
+  /**
+   * \brief Determines whether or not the source contains the images for the specified frame.
+   *
+   * Note that a sequence ends at the first frame it does not contain.
+   *
+   * \param frameIndex  The index of the frame.
+   * \return            true, if the source contains the images for the frame, or false otherwise.
+   */
+  virtual bool has_frame(size_t frameIndex) const = 0;
+
+  /**
+   * \brief Reads the images for the specified frame (this must be safe to call concurrently).
+   *
+   * \param frameIndex          The index of the frame.
+   * \param rgb                 An image into which to read the RGB image for the frame (resized as necessary).
+   * \param rawDepth            An image into which to read the depth image for the frame (resized as necessary).
+   * \throws std::runtime_error If the images could not be read.
+   */
+  virtual void read_images(size_t frameIndex, ITMUChar4Image *rgb, ITMShortImage *rawDepth) const = 0;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const RandomAccessImageSource> RandomAccessImageSource_CPtr;
+
+}
+
+#endif
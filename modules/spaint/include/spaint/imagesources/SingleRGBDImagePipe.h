@@ -6,30 +6,54 @@
 #ifndef H_SPAINT_SINGLERGBDIMAGEPIPE
 #define H_SPAINT_SINGLERGBDIMAGEPIPE
 
+#include <boost/thread/mutex.hpp>
+
 #include <itmx/base/ITMImagePtrTypes.h>
 #include <itmx/base/ITMObjectPtrTypes.h>
 
+#include "ImageRegionSource.h"
+
 namespace spaint {
 
 /**
  * \brief An instance of this class represents a pipe to which individual RGB-D images can be
  *        written so as to feed them to a SLAM component.
+ *
+ * The pipe owns a pair of buffers that hold the current images. Images can either be copied into these buffers
+ * (using set_images), or swapped into them (using swap_in_images), in which case nothing is copied. When the
+ * SLAM component reads the images, the buffers are swapped with its input images wherever their sizes match,
+ * so a producer that swaps its images in hands them over to the SLAM component without any copying at all.
+ *
+ * A producer that knows that its images only contain valid data within a region (e.g. the bounding box of a segmented
+ * object) can pass the region in along with them, so that the SLAM component can restrict its processing to it.
  */
-class SingleRGBDImagePipe : public InputSource::ImageSourceEngine
+class SingleRGBDImagePipe : public InputSource::ImageSourceEngine, public ImageRegionSource
 {
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The intrinsic calibration parameters for the camera producing the RGB-D images being fed through the pipe. */
   ITMLib::ITMRGBDCalib m_calib;
 
-  /** The current depth image being fed through the pipe. */
-  ITMShortImage_CPtr m_depthImage;
+  /** The buffer holding the current depth image being fed through the pipe. */
+  ITMShortImage_Ptr m_depthImage;
 
   /** The size of depth image being fed through the pipe. */
   Vector2i m_depthImageSize;
 
-  /** The current RGB image being fed through the pipe. */
-  ITMUChar4Image_CPtr m_rgbImage;
+  /** The region (if any) outside which the images currently in the buffers contain no valid data. */
+  boost::optional<Vector4i> m_imageRegion;
+
+  /** Whether or not the buffers currently hold images that have not yet been read. */
+  bool m_imagesAvailable;
+
+  /** The region (if any) outside which the images most recently read from the pipe contain no valid data. */
+  boost::optional<Vector4i> m_lastReadImageRegion;
+
+  /** The mutex used to synchronise access to the buffers (the images may be read on a different thread from the one that writes them). */
+  mutable boost::mutex m_mutex;
+
+  /** The buffer holding the current RGB image being fed through the pipe. */
+  ITMUChar4Image_Ptr m_rgbImage;
 
   /** The size of RGB image being fed through the pipe. */
   Vector2i m_rgbImageSize;
@@ -57,16 +81,32 @@ public:
   /** Override */
   virtual Vector2i getRGBImageSize() const;
 
+  /** Override */
+  virtual boost::optional<Vector4i> get_image_region() const;
+
   /** Override */
   virtual bool hasMoreImages() const;
 
   /**
-   * \brief Sets the current RGB and depth images to feed through the pipe.
+   * \brief Sets the current RGB and depth images to feed through the pipe, by copying them into the pipe's buffers.
+   *
+   * \param rgbImage    The current RGB image to feed through the pipe.
+   * \param depthImage  The current depth image to feed through the pipe.
+   * \param imageRegion The region (if any) outside which the images contain no valid data.
+   */
+  void set_images(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Vector4i>& imageRegion = boost::none);
+
+  /**
+   * \brief Sets the current RGB and depth images to feed through the pipe, by swapping them with the pipe's buffers.
+   *
+   * This avoids any copying. After the call, the images passed in will contain whatever was in the pipe's buffers
+   * (normally the images that were previously read out of the pipe), and can be reused for the next pair of images.
    *
    * \param rgbImage    The current RGB image to feed through the pipe.
    * \param depthImage  The current depth image to feed through the pipe.
+   * \param imageRegion The region (if any) outside which the images contain no valid data.
    */
-  void set_images(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage);
+  void swap_in_images(ITMUChar4Image& rgbImage, ITMShortImage& depthImage, const boost::optional<Vector4i>& imageRegion = boost::none);
 };
 
 //#################### TYPEDEFS ####################
@@ -0,0 +1,71 @@
+/**
+ * spaint: SwappingCompositeImageSourceEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SWAPPINGCOMPOSITEIMAGESOURCEENGINE
+#define H_SPAINT_SWAPPINGCOMPOSITEIMAGESOURCEENGINE
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <InputSource/CompositeImageSourceEngine.h>
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class is a composite image source engine that can also swap the images of an asynchronous
+ *        sub-engine into the caller's images, rather than copying them.
+ *
+ * InfiniTAM's composite image source engine only exposes its current sub-engine as const, which is not enough to take
+ * the images from an AsyncImageSourceEngine by swapping. This class therefore keeps its own (non-const) record of the
+ * sub-engines that are added via add_subengine, so that it can find the current one without casting away constness.
+ * Sub-engines that are added directly via addSubengine are still used, but their images are always copied.
+ */
+class SwappingCompositeImageSourceEngine : public InputSource::CompositeImageSourceEngine
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The sub-engines that have been added via add_subengine (owned by the base class). */
+  std::vector<InputSource::ImageSourceEngine*> m_subengines;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Make the base class's copying getImages visible alongside the swapping one. */
+  using InputSource::CompositeImageSourceEngine::getImages;
+
+  /**
+   * \brief Adds a sub-engine to the composite image source engine.
+   *
+   * \param subengine The sub-engine to add (ownership passes to the composite image source engine).
+   */
+  void add_subengine(InputSource::ImageSourceEngine *subengine);
+
+  /**
+   * \brief Gets the current sub-engine, provided that it was added via add_subengine.
+   *
+   * \return  The current sub-engine, if it was added via add_subengine, or NULL otherwise.
+   */
+  InputSource::ImageSourceEngine *get_current_subengine();
+
+  /**
+   * \brief Gets the next RGB-D image, swapping it into the caller's images if the current sub-engine is asynchronous, and copying it otherwise.
+   *
+   * See AsyncImageSourceEngine::getImages for what swapping implies for the caller's images.
+   *
+   * \param rgb       An image into which to store the RGB component of the next RGB-D image.
+   * \param rawDepth  An image into which to store the depth component of the next RGB-D image.
+   */
+  void getImages(ITMUChar4Image& rgb, ITMShortImage& rawDepth);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<SwappingCompositeImageSourceEngine> SwappingCompositeImageSourceEngine_Ptr;
+
+}
+
+#endif
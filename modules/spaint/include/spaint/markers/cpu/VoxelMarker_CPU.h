@@ -6,6 +6,8 @@
 #ifndef H_SPAINT_VOXELMARKER_CPU
 #define H_SPAINT_VOXELMARKER_CPU
 
+#include <vector>
+
 #include "../interface/VoxelMarker.h"
 
 namespace spaint {
@@ -15,10 +17,29 @@ namespace spaint {
  */
 class VoxelMarker_CPU : public VoxelMarker
 {
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct can be used to order the indices of voxel locations by their sort keys.
+   */
+  struct KeyComparator
+  {
+    const std::vector<unsigned long long>& m_keys;
+
+    explicit KeyComparator(const std::vector<unsigned long long>& keys)
+    : m_keys(keys)
+    {}
+
+    bool operator()(int lhs, int rhs) const
+    {
+      return m_keys[lhs] < m_keys[rhs];
+    }
+  };
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
-  virtual void clear_labels(SpaintVoxel *voxels, int voxelCount, ClearingSettings settings) const;
+  virtual void clear_labels(SpaintVoxelScene *scene, ClearingSettings settings) const;
 
   /** Override */
   virtual void mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
@@ -27,6 +48,22 @@ public:
   /** Override */
   virtual void mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& voxelLabelsMB,
                            SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Marks a set of voxels in the scene with semantic labels, processing the voxels one voxel block at a time.
+   *
+   * \param voxelLocationsMB  A memory block containing the locations of the voxels to be marked.
+   * \param label             The semantic label with which to mark the voxels (used if voxelLabelsMB is NULL).
+   * \param voxelLabelsMB     An optional memory block containing the semantic labels with which to mark the individual voxels.
+   * \param scene             The scene.
+   * \param mode              The marking mode.
+   * \param oldVoxelLabelsMB  An optional memory block into which to store the old semantic labels of the voxels being marked.
+   */
+  void mark_voxels_sub(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
+                       const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *voxelLabelsMB, SpaintVoxelScene *scene,
+                       MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const;
 };
 
 }
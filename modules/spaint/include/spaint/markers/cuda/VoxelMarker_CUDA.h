@@ -6,6 +6,9 @@
 #ifndef H_SPAINT_VOXELMARKER_CUDA
 #define H_SPAINT_VOXELMARKER_CUDA
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include "../interface/VoxelMarker.h"
 
 namespace spaint {
@@ -15,10 +18,28 @@ namespace spaint {
  */
 class VoxelMarker_CUDA : public VoxelMarker
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A scratch memory block in which to sort the keys of the voxel locations being marked. */
+  mutable boost::shared_ptr<ORUtils::MemoryBlock<unsigned long long> > m_keysMB;
+
+  /** The mutex used to serialise access to the scratch memory blocks. */
+  mutable boost::mutex m_scratchMutex;
+
+  /** A scratch memory block in which to store the indices of the voxel locations being marked, in sorted order. */
+  mutable boost::shared_ptr<ORUtils::MemoryBlock<int> > m_sortedIndicesMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based voxel marker.
+   */
+  VoxelMarker_CUDA();
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
-  virtual void clear_labels(SpaintVoxel *voxels, int voxelCount, ClearingSettings settings) const;
+  virtual void clear_labels(SpaintVoxelScene *scene, ClearingSettings settings) const;
 
   /** Override */
   virtual void mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
@@ -27,6 +48,22 @@ public:
   /** Override */
   virtual void mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& voxelLabelsMB,
                            SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Marks a set of voxels in the scene with semantic labels, processing the voxels one voxel block at a time.
+   *
+   * \param voxelLocationsMB  A memory block containing the locations of the voxels to be marked.
+   * \param label             The semantic label with which to mark the voxels (used if voxelLabelsMB is NULL).
+   * \param voxelLabelsMB     An optional memory block containing the semantic labels with which to mark the individual voxels.
+   * \param scene             The scene.
+   * \param mode              The marking mode.
+   * \param oldVoxelLabelsMB  An optional memory block into which to store the old semantic labels of the voxels being marked.
+   */
+  void mark_voxels_sub(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
+                       const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *voxelLabelsMB, SpaintVoxelScene *scene,
+                       MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const;
 };
 
 }
@@ -26,17 +26,22 @@ public:
   //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
 public:
   /**
-   * \brief Clears the labels of some or all of the voxels in an array, depending on the settings specified.
+   * \brief Clears the labels of some or all of the voxels in the scene, depending on the settings specified.
    *
-   * \param voxels      The array of voxels.
-   * \param voxelCount  The number of voxels in the array.
-   * \param settings    The settings to use for the label-clearing operation.
+   * If the scene is being swapped, the labels of the voxels that have been swapped out to the global cache are cleared as well.
+   * Otherwise, the scene's label counts are updated to reflect the labels that are cleared, and only the voxel blocks whose label
+   * presence masks indicate that they may contain labels that need clearing are visited (their masks are then recomputed).
+   *
+   * \param scene     The scene.
+   * \param settings  The settings to use for the label-clearing operation.
    */
-  virtual void clear_labels(SpaintVoxel *voxels, int voxelCount, ClearingSettings settings) const = 0;
+  virtual void clear_labels(SpaintVoxelScene *scene, ClearingSettings settings) const = 0;
 
   /**
    * \brief Marks a set of voxels in the scene with the specified semantic label.
    *
+   * The scene's label counts (if any) are updated to reflect any labels that change.
+   *
    * \param voxelLocationsMB  A memory block containing the locations of the voxels in the scene.
    * \param label             The semantic label with which to mark the voxels.
    * \param scene             The scene.
@@ -49,6 +54,8 @@ public:
   /**
    * \brief Marks a set of voxels in the scene with the specified semantic labels.
    *
+   * The scene's label counts (if any) are updated to reflect any labels that change.
+   *
    * \param voxelLocationsMB  A memory block containing the locations of the voxels in the scene.
    * \param voxelLabelsMB     A memory block containing the semantic labels with which to mark the voxels (one per voxel).
    * \param scene             The scene.
@@ -57,6 +64,18 @@ public:
    */
   virtual void mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& voxelLabelsMB,
                            SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB = NULL) const = 0;
+
+  //#################### PROTECTED MEMBER FUNCTIONS ####################
+protected:
+  /**
+   * \brief Clears the labels of some or all of the voxels stored in the scene's global cache (if any), depending on the settings specified.
+   *
+   * The global cache always lives in host memory, so this is shared by all of the voxel markers.
+   *
+   * \param scene     The scene.
+   * \param settings  The settings to use for the label-clearing operation.
+   */
+  void clear_stored_labels(SpaintVoxelScene *scene, ClearingSettings settings) const;
 };
 
 //#################### TYPEDEFS ####################
@@ -9,9 +9,126 @@
 #include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
 
 #include "VoxelMarker_Settings.h"
+#include "../../util/SpaintVoxelScene.h"
 
 namespace spaint {
 
+/**
+ * \brief Atomically adds a delta to the voxel count for the specified label.
+ *
+ * \param packedLabel The label.
+ * \param delta       The delta to add (modulo 2^32, so that decrements can be expressed by wrapping around).
+ * \param labelCounts The scene's voxel counts for each label.
+ */
+_CPU_AND_GPU_CODE_
+inline void add_to_label_count(SpaintVoxel::PackedLabel packedLabel, unsigned int delta, unsigned int *labelCounts)
+{
+  unsigned int& labelCount = labelCounts[packedLabel.group * SpaintVoxelScene::LABEL_VALUE_COUNT + packedLabel.label];
+
+#if defined(__CUDACC__) && defined(__CUDA_ARCH__)
+  atomicAdd(&labelCount, delta);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp atomic
+  #endif
+  labelCount += delta;
+#endif
+}
+
+/**
+ * \brief Atomically replaces a voxel label with a new one, provided that it still has the value expected.
+ *
+ * This is needed when several threads can mark the same voxel at once (e.g. during propagation, when neighbouring pixels
+ * map to the same voxel), so that each change to the label can be counted exactly once.
+ *
+ * \param voxelLabel  The voxel label.
+ * \param expected    The value that the voxel label is expected to have.
+ * \param desired     The value with which to replace the voxel label.
+ * \return            The value that the voxel label had (the label was replaced iff this is equal to expected).
+ */
+_CPU_AND_GPU_CODE_
+inline SpaintVoxel::PackedLabel compare_and_swap_label(SpaintVoxel::PackedLabel& voxelLabel, SpaintVoxel::PackedLabel expected, SpaintVoxel::PackedLabel desired)
+{
+  SpaintVoxel::PackedLabel found;
+
+#if defined(__CUDACC__) && defined(__CUDA_ARCH__)
+  // CUDA has no byte-sized compare-and-swap, so we operate on the aligned word that contains the label instead
+  // (leaving the other bytes of the word unchanged).
+  const size_t labelAddress = reinterpret_cast<size_t>(&voxelLabel);
+  unsigned int *word = reinterpret_cast<unsigned int*>(labelAddress & ~static_cast<size_t>(3));
+  const unsigned int shift = static_cast<unsigned int>(labelAddress & 3) * 8;
+  const unsigned int expectedByte = *reinterpret_cast<const unsigned char*>(&expected);
+  const unsigned int desiredByte = *reinterpret_cast<const unsigned char*>(&desired);
+
+  unsigned int assumed = *word, foundByte;
+  for(;;)
+  {
+    foundByte = (assumed >> shift) & 0xFF;
+    if(foundByte != expectedByte) break;
+
+    const unsigned int actual = atomicCAS(word, assumed, (assumed & ~(0xFFu << shift)) | (desiredByte << shift));
+    if(actual == assumed) break;
+    assumed = actual;
+  }
+
+  *reinterpret_cast<unsigned char*>(&found) = static_cast<unsigned char>(foundByte);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp critical(spaint_compare_and_swap_label)
+  #endif
+  {
+    found = voxelLabel;
+    if(found == expected) voxelLabel = desired;
+  }
+#endif
+
+  return found;
+}
+
+/**
+ * \brief Atomically records in the label presence mask of a voxel block that one of the block's voxels may carry the specified label.
+ *
+ * Note that the default (background) label is not recorded.
+ *
+ * \param blockIndex    The index of the voxel block in the voxel block array.
+ * \param packedLabel   The label.
+ * \param labelPresence The scene's label presence masks (if any).
+ */
+_CPU_AND_GPU_CODE_
+inline void record_label_presence(int blockIndex, SpaintVoxel::PackedLabel packedLabel, unsigned int *labelPresence)
+{
+  if(!labelPresence || packedLabel == SpaintVoxel::PackedLabel()) return;
+
+  unsigned int& word = labelPresence[blockIndex * SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT + packedLabel.label / 32];
+  const unsigned int bit = 1u << (packedLabel.label % 32);
+
+#if defined(__CUDACC__) && defined(__CUDA_ARCH__)
+  atomicOr(&word, bit);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp atomic
+  #endif
+  word |= bit;
+#endif
+}
+
+/**
+ * \brief Updates the voxel counts for each label to reflect the fact that a voxel's label has changed.
+ *
+ * Note that voxels with the default (background) label are not counted.
+ *
+ * \param oldLabel    The old label of the voxel.
+ * \param newLabel    The new label of the voxel.
+ * \param labelCounts The scene's voxel counts for each label.
+ */
+_CPU_AND_GPU_CODE_
+inline void update_label_counts(SpaintVoxel::PackedLabel oldLabel, SpaintVoxel::PackedLabel newLabel, unsigned int *labelCounts)
+{
+  if(oldLabel == newLabel) return;
+  if(!(oldLabel == SpaintVoxel::PackedLabel())) add_to_label_count(oldLabel, ~0u, labelCounts);
+  if(!(newLabel == SpaintVoxel::PackedLabel())) add_to_label_count(newLabel, 1u, labelCounts);
+}
+
 /**
  * \brief Decides whether or not it is possible to overwrite the old semantic label for a voxel with a new one.
  *
@@ -37,16 +154,48 @@ inline bool can_overwrite_label(SpaintVoxel::PackedLabel oldLabel, SpaintVoxel::
 }
 
 /**
- * \brief Clears the label of the specified voxel as necessary depending on the settings specified.
+ * \brief Determines whether or not a voxel block may contain any voxels whose labels would be cleared, depending on the settings specified.
  *
- * \param voxel     The voxel whose label may be cleared.
- * \param settings  The settings to use for the label-clearing operation.
+ * \param blockPresence The label presence mask of the voxel block (LABEL_PRESENCE_WORD_COUNT words).
+ * \param settings      The settings to use for the label-clearing operation.
+ * \return              true, if the block may contain voxels whose labels would be cleared, or false otherwise.
  */
 _CPU_AND_GPU_CODE_
-inline void clear_label(SpaintVoxel& voxel, ClearingSettings settings)
+inline bool block_may_need_clearing(const unsigned int *blockPresence, ClearingSettings settings)
 {
-  SpaintVoxel::PackedLabel& packedLabel = voxel.packedLabel;
+  switch(settings.mode)
+  {
+    case CLEAR_EQ_LABEL:
+    case CLEAR_EQ_LABEL_NEQ_GROUP:
+      return (blockPresence[settings.label / 32] & (1u << (settings.label % 32))) != 0;
+    default:
+    {
+      // Note: Any block that may contain a non-default label needs to be visited.
+      for(int i = 0; i < SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT; ++i)
+      {
+        if(blockPresence[i] != 0) return true;
+      }
+      return false;
+    }
+  }
+}
 
+/**
+ * \brief Clears the specified voxel label as necessary depending on the settings specified.
+ *
+ * If the scene's label counts are being maintained, the count of any label that is cleared is decremented.
+ * If the label is cleared, any evidence accumulated for it is forgotten as well.
+ *
+ * \param packedLabel   The voxel label that may be cleared.
+ * \param settings      The settings to use for the label-clearing operation.
+ * \param labelCounts   The scene's voxel counts for each label (if any).
+ * \param labelEvidence The evidence accumulated for the voxel label (if any).
+ * \return              true, if the label was changed, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool clear_label(SpaintVoxel::PackedLabel& packedLabel, ClearingSettings settings, unsigned int *labelCounts = NULL,
+                        SpaintVoxel::LabelEvidence *labelEvidence = NULL)
+{
   bool shouldClear = false;
   switch(settings.mode)
   {
@@ -56,7 +205,14 @@ inline void clear_label(SpaintVoxel& voxel, ClearingSettings settings)
     default:                        shouldClear = true; break;
   }
 
-  if(shouldClear) packedLabel = SpaintVoxel::PackedLabel();
+  const SpaintVoxel::PackedLabel oldLabel = packedLabel;
+  if(shouldClear)
+  {
+    packedLabel = SpaintVoxel::PackedLabel();
+    if(labelEvidence) *labelEvidence = SpaintVoxel::LabelEvidence();
+  }
+  if(labelCounts) update_label_counts(oldLabel, packedLabel, labelCounts);
+  return !(oldLabel == packedLabel);
 }
 
 /**
@@ -66,24 +222,173 @@ inline void clear_label(SpaintVoxel& voxel, ClearingSettings settings)
  * \param label       The semantic label with which to mark the voxel.
  * \param oldLabel    An optional location into which to store the old semantic label of the voxel.
  * \param voxelData   The scene's voxel data.
+ * \param labelData   The scene's label data (if any).
  * \param voxelIndex  The scene's voxel index.
  * \param mode        The marking mode.
+ * \param labelCounts   The scene's voxel counts for each label (if any). If these are provided, the label is replaced atomically,
+ *                      so that the voxel can safely be marked by several threads at once.
+ * \param blockVersions The scene's block versions (if any). If these are provided, and the voxel's label changes, the label
+ *                      version of the voxel's block is set to the specified version.
+ * \param version       The version of the scene with which to stamp the voxel's block.
+ * \param labelPresence The scene's label presence masks (if any). If these are provided, and the voxel's label changes, the new label
+ *                      is recorded in the mask of the voxel's block.
  */
 _CPU_AND_GPU_CODE_
 inline void mark_voxel(const Vector3s& loc, SpaintVoxel::PackedLabel label, SpaintVoxel::PackedLabel *oldLabel,
-                       SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *voxelIndex,
-                       MarkingMode mode = NORMAL_MARKING)
+                       SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *voxelIndex,
+                       MarkingMode mode = NORMAL_MARKING, unsigned int *labelCounts = NULL,
+                       SpaintVoxelScene::BlockVersions *blockVersions = NULL, unsigned int version = 0, unsigned int *labelPresence = NULL)
 {
   bool isFound;
   int voxelAddress = findVoxel(voxelIndex, loc.toInt(), isFound);
   if(isFound)
   {
-    SpaintVoxel::PackedLabel oldLabelLocal = voxelData[voxelAddress].packedLabel;
+    SpaintVoxel::PackedLabel& voxelLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+    SpaintVoxel::PackedLabel oldLabelLocal = voxelLabel;
     if(oldLabel) *oldLabel = oldLabelLocal;
-    if(mode == FORCED_MARKING || can_overwrite_label(oldLabelLocal, label))
+
+    bool changed = false;
+    if(!labelCounts)
     {
-      voxelData[voxelAddress].packedLabel = label;
+      if(mode == FORCED_MARKING || can_overwrite_label(oldLabelLocal, label))
+      {
+        voxelLabel = label;
+        changed = !(oldLabelLocal == label);
+      }
     }
+    else
+    {
+      // Try to replace the label until we either succeed or find that it can no longer be overwritten (or has already been changed to the new label).
+      SpaintVoxel::PackedLabel currentLabel = oldLabelLocal;
+      while(!(currentLabel == label) && (mode == FORCED_MARKING || can_overwrite_label(currentLabel, label)))
+      {
+        const SpaintVoxel::PackedLabel foundLabel = compare_and_swap_label(voxelLabel, currentLabel, label);
+        if(foundLabel == currentLabel)
+        {
+          update_label_counts(currentLabel, label, labelCounts);
+          changed = true;
+          break;
+        }
+
+        currentLabel = foundLabel;
+      }
+    }
+
+    if(changed) record_label_presence(voxelAddress / SDF_BLOCK_SIZE3, label, labelPresence);
+
+    // Note: Threads that mark voxels in the same block concurrently all write the same version, so the stamp need not be atomic.
+    if(changed && blockVersions) blockVersions[voxelAddress / SDF_BLOCK_SIZE3].labels = version;
+  }
+}
+
+/**
+ * \brief Makes the key used to sort a voxel location when marking voxels in batches.
+ *
+ * The key orders voxels first by the voxel block that contains them, and then by their position within that block,
+ * so that all of the locations in a block end up contiguous after sorting, and duplicate locations end up adjacent.
+ *
+ * \param loc The location of the voxel.
+ * \return    The sort key for the voxel.
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned long long make_voxel_marking_key(const Vector3s& loc)
+{
+  // Note: Since the voxel coordinates are shorts, the block coordinates lie in [-4096,4095], and fit into 13 bits once offset.
+  Vector3i blockPos;
+  const unsigned long long linearIdx = static_cast<unsigned long long>(pointToVoxelBlockPos(loc.toInt(), blockPos));
+  const unsigned long long bx = static_cast<unsigned long long>(blockPos.x + 4096) & 0x1FFF;
+  const unsigned long long by = static_cast<unsigned long long>(blockPos.y + 4096) & 0x1FFF;
+  const unsigned long long bz = static_cast<unsigned long long>(blockPos.z + 4096) & 0x1FFF;
+  return (bx << 35) | (by << 22) | (bz << 9) | linearIdx;
+}
+
+/**
+ * \brief Marks all of the voxels in a single voxel block with semantic labels, as part of a batched marking operation.
+ *
+ * The voxel locations being marked must previously have been sorted by their keys (see make_voxel_marking_key). This function
+ * only does anything if the specified element of the sorted array is the first one in its voxel block, in which case it resolves
+ * the block in the hash table once, and then marks all of the voxels in it. Each location that appears more than once is only
+ * written once (with the label associated with its last occurrence in the unsorted array), and all of its occurrences receive
+ * the voxel's original label as their old label. Locations in voxel blocks that are not allocated are ignored.
+ *
+ * If the evidence for the voxel labels is being accumulated, the evidence provided by each forest label with which a voxel is
+ * (normally) marked is added to that voxel's evidence, and the voxel is relabelled with its best-supported label instead.
+ *
+ * \param i                     The index of an element of the sorted array.
+ * \param sortedKeys            The sorted keys of the voxel locations.
+ * \param sortedIndices         The indices of the voxel locations in the unsorted array, in sorted order (stably sorted).
+ * \param voxelCount            The number of voxel locations.
+ * \param voxelLocations        The (unsorted) voxel locations.
+ * \param label                 The semantic label with which to mark the voxels (used if voxelLabels is NULL).
+ * \param voxelLabels           An optional array of (unsorted) per-voxel semantic labels.
+ * \param oldVoxelLabels        An optional array into which to store the old (unsorted) semantic labels of the voxels.
+ * \param voxelData             The scene's voxel data.
+ * \param labelData             The scene's label data (if any).
+ * \param labelEvidence         The scene's label evidence data (if any).
+ * \param voxelIndex            The scene's voxel index.
+ * \param mode                  The marking mode.
+ * \param labelCounts           The scene's voxel counts for each label (if any).
+ * \param labelPresence         The scene's label presence masks (if any), in which the new labels of the block's voxels are recorded.
+ * \param relabelledBlockFlags  The scene's relabelled block flags (the flag for the block is set if any of its labels change).
+ * \param blockVersions         The scene's block versions (the label version of the block is stamped if any of its labels change).
+ * \param version               The version of the scene with which to stamp the block.
+ */
+_CPU_AND_GPU_CODE_
+inline void mark_voxel_block(int i, const unsigned long long *sortedKeys, const int *sortedIndices, int voxelCount,
+                             const Vector3s *voxelLocations, SpaintVoxel::PackedLabel label, const SpaintVoxel::PackedLabel *voxelLabels,
+                             SpaintVoxel::PackedLabel *oldVoxelLabels, SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData,
+                             SpaintVoxel::LabelEvidence *labelEvidence, const ITMVoxelIndex::IndexData *voxelIndex, MarkingMode mode, unsigned int *labelCounts,
+                             unsigned int *labelPresence, unsigned char *relabelledBlockFlags, SpaintVoxelScene::BlockVersions *blockVersions, unsigned int version)
+{
+  // If this element is not the first in its voxel block, early out.
+  const unsigned long long blockKey = sortedKeys[i] >> 9;
+  if(i > 0 && (sortedKeys[i - 1] >> 9) == blockKey) return;
+
+  // Resolve the voxel block in the hash table. If it has not been allocated, none of its voxels can be marked.
+  ITMVoxelBlockHash::IndexCache cache;
+  int vmIndex;
+  findVoxel(voxelIndex, voxelLocations[sortedIndices[i]].toInt(), vmIndex, cache);
+  if(!vmIndex) return;
+
+  // Mark each distinct voxel in the block, reusing the cached block pointer rather than looking up the hash table again.
+  while(i < voxelCount && (sortedKeys[i] >> 9) == blockKey)
+  {
+    int end = i;
+    while(end + 1 < voxelCount && sortedKeys[end + 1] == sortedKeys[i]) ++end;
+
+    const int voxelAddress = findVoxel(voxelIndex, voxelLocations[sortedIndices[i]].toInt(), vmIndex, cache);
+    SpaintVoxel::PackedLabel& voxelLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+    const SpaintVoxel::PackedLabel oldLabel = voxelLabel;
+    if(oldVoxelLabels)
+    {
+      for(int j = i; j <= end; ++j) oldVoxelLabels[sortedIndices[j]] = oldLabel;
+    }
+
+    SpaintVoxel::PackedLabel newLabel = voxelLabels ? voxelLabels[sortedIndices[end]] : label;
+    if(labelEvidence && mode == NORMAL_MARKING && newLabel.group == SpaintVoxel::LG_FOREST)
+    {
+      // Note: Every occurrence of the voxel location counts as a separate prediction.
+      SpaintVoxel::LabelEvidence& evidence = labelEvidence[voxelAddress];
+      for(int j = i; j <= end; ++j)
+      {
+        const SpaintVoxel::PackedLabel prediction = voxelLabels ? voxelLabels[sortedIndices[j]] : label;
+        if(prediction.group == SpaintVoxel::LG_FOREST) evidence.add(prediction.label);
+      }
+
+      newLabel.label = evidence.label0;
+    }
+
+    if((mode == FORCED_MARKING || can_overwrite_label(oldLabel, newLabel)) && !(oldLabel == newLabel))
+    {
+      // Note: Each distinct voxel is only marked by a single thread, so there is no need to replace its label atomically.
+      voxelLabel = newLabel;
+      if(labelCounts) update_label_counts(oldLabel, newLabel, labelCounts);
+      record_label_presence(voxelAddress / SDF_BLOCK_SIZE3, newLabel, labelPresence);
+      relabelledBlockFlags[voxelAddress / SDF_BLOCK_SIZE3] = 1;
+      blockVersions[voxelAddress / SDF_BLOCK_SIZE3].labels = version;
+    }
+
+    i = end + 1;
   }
 }
 
@@ -0,0 +1,110 @@
+/**
+ * spaint: BlockMeshCache.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKMESHCACHE
+#define H_SPAINT_BLOCKMESHCACHE
+
+#include <map>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "interface/LabelledMeshingEngine.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to maintain an up-to-date mesh of a voxel scene (with per-vertex colours and
+ *        semantic labels) whilst it is being reconstructed, at a cost that scales with the amount of the scene that changes
+ *        rather than with the size of the scene.
+ *
+ * The mesh is cached as a separate mesh for each voxel block, keyed by the ID of the block's hash entry (which remains the same
+ * for as long as the block exists). Each call to update uses the versions of the scene's voxel blocks (see SpaintVoxelScene) to
+ * find, on the device, the blocks whose meshes may have changed since the previous update, re-meshes only those blocks, and
+ * returns the block meshes that were added, replaced or removed, so that downstream consumers (e.g. physics or navigation) can
+ * update their own copies of the mesh incrementally. If the scene has been reset since the previous update, the cache is instead
+ * rebuilt from scratch, and the consumers are told to discard everything they received before.
+ *
+ * The meshes of voxel blocks that are swapped out are retained (the blocks still exist in the global cache, and will be re-meshed
+ * if they change after being swapped back in). Note that the public member functions are intended to be called from a single thread.
+ */
+class BlockMeshCache
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef LabelledMeshingEngine::Triangle Triangle;
+  typedef boost::shared_ptr<const std::vector<Triangle> > BlockMesh_CPtr;
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents the changes made to the cache by an update.
+   */
+  struct Changes
+  {
+    /** The meshes of the voxel blocks that were added or replaced by the update, keyed by the IDs of the blocks' hash entries. */
+    std::map<int,BlockMesh_CPtr> changedBlocks;
+
+    /** The IDs of the hash entries of the voxel blocks whose meshes were removed by the update (because they no longer contain any surface). */
+    std::vector<int> removedBlocks;
+
+    /** Whether or not the cache was rebuilt from scratch (in which case any block meshes received from earlier updates must be discarded). */
+    bool reset;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The meshes of the voxel blocks that contain some surface, keyed by the IDs of the blocks' hash entries. */
+  std::map<int,BlockMesh_CPtr> m_blockMeshes;
+
+  /** The engine used to mesh the voxel blocks. */
+  LabelledMeshingEngine_Ptr m_meshingEngine;
+
+  /** The version of the scene at which the cache was last brought up to date (if it ever has been). */
+  boost::optional<unsigned int> m_version;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an (empty) block mesh cache.
+   *
+   * \param meshingEngine           The engine to use to mesh the voxel blocks.
+   * \throws std::invalid_argument  If the meshing engine is NULL.
+   */
+  explicit BlockMeshCache(const LabelledMeshingEngine_Ptr& meshingEngine);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the cached meshes of the voxel blocks that contain some surface.
+   *
+   * \return  The cached block meshes, keyed by the IDs of the blocks' hash entries.
+   */
+  const std::map<int,BlockMesh_CPtr>& get_block_meshes() const;
+
+  /**
+   * \brief Gets the total number of triangles in the cached block meshes.
+   *
+   * \return  The total number of triangles in the cached block meshes.
+   */
+  size_t get_triangle_count() const;
+
+  /**
+   * \brief Brings the cache up to date with the current state of the specified scene.
+   *
+   * \param scene The scene (this must be the same scene on every call).
+   * \return      The changes made to the cache.
+   */
+  Changes update(const SpaintVoxelScene *scene);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<BlockMeshCache> BlockMeshCache_Ptr;
+typedef boost::shared_ptr<const BlockMeshCache> BlockMeshCache_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * spaint: LabelledMeshingEngineFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELLEDMESHINGENGINEFACTORY
+#define H_SPAINT_LABELLEDMESHINGENGINEFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/LabelledMeshingEngine.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct labelled meshing engines.
+ */
+struct LabelledMeshingEngineFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a labelled meshing engine.
+   *
+   * \param deviceType  The device on which the labelled meshing engine should operate.
+   * \return            The labelled meshing engine.
+   */
+  static LabelledMeshingEngine_Ptr make_labelled_meshing_engine(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * spaint: MeshExporter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MESHEXPORTER
+#define H_SPAINT_MESHEXPORTER
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+#include "interface/LabelledMeshingEngine.h"
+#include "../util/LabelManager.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to export a mesh of a voxel scene (with per-vertex colours and semantic labels)
+ *        to a binary PLY file, without stalling the rest of the application whilst it does so.
+ *
+ * An export is started by a call to start, which records the voxel blocks that are currently resident in the scene. Calls to
+ * update then mesh a limited number of these blocks at a time (e.g. once per frame), and hand the resulting triangles to a
+ * writer thread, which streams them to disk. Once every block has been meshed, the writer thread finalises the file by itself.
+ * Alternatively, finish can be called to mesh any remaining blocks immediately and wait for the file to be finalised.
+ *
+ * The vertices of the mesh are not shared between triangles (the faces simply index consecutive vertices), so that the mesh
+ * can be streamed without any global processing. The names of the semantic labels are listed in comments in the PLY header.
+ *
+ * Note that the public member functions are intended to be called from a single thread. If the scene continues to be
+ * reconstructed whilst it is being exported, the mesh will be a patchwork of the states of its blocks at the times at which
+ * they were meshed, and any blocks that are swapped out (or reset) before they are meshed will be missing from it.
+ */
+class MeshExporter
+{
+  //#################### TYPEDEFS ####################
+private:
+  typedef LabelledMeshingEngine::Triangle Triangle;
+  typedef boost::shared_ptr<std::vector<Triangle> > TriangleBatch_Ptr;
+
+  //#################### CONSTANTS ####################
+public:
+  /** The maximum number of batches of triangles that can be waiting for the writer thread before meshing blocks (it then waits for the writer to catch up). */
+  static const size_t MAX_PENDING_BATCH_COUNT = 4;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of voxel blocks that are to be meshed by the current export. */
+  int m_blockCount;
+
+  /** The position in the PLY file of the face count (which is filled in once the mesh has been written). */
+  std::streampos m_faceCountPos;
+
+  /** The label manager (if any) whose label names should be listed in the PLY header. */
+  LabelManager_CPtr m_labelManager;
+
+  /** The engine used to mesh the voxel blocks. */
+  LabelledMeshingEngine_Ptr m_meshingEngine;
+
+  /** Whether or not every voxel block has been meshed, so that the writer thread can finalise the file once it has written the pending batches (accessed only whilst holding m_mutex). */
+  bool m_meshingFinished;
+
+  /** The mutex used to protect the pending batches and the state shared with the writer thread. */
+  boost::mutex m_mutex;
+
+  /** The index of the next voxel block to mesh. */
+  int m_nextBlock;
+
+  /** The PLY file to which the mesh is being written (once an export has been started, this is accessed only by the writer thread). */
+  boost::shared_ptr<std::ofstream> m_os;
+
+  /** The path to the PLY file to which the mesh is being written. */
+  std::string m_path;
+
+  /** A condition variable used to signal the writer thread when there are batches for it to write (or meshing has finished or been cancelled), and to signal the meshing thread when it has written them. */
+  boost::condition_variable m_pendingBatchesChanged;
+
+  /** The batches of triangles that are waiting for the writer thread (accessed only whilst holding m_mutex). */
+  std::deque<TriangleBatch_Ptr> m_pendingBatches;
+
+  /** The number of triangles that have been written to the PLY file (accessed only by the writer thread). */
+  size_t m_triangleCount;
+
+  /** The position in the PLY file of the vertex count (which is filled in once the mesh has been written). */
+  std::streampos m_vertexCountPos;
+
+  /** The writer thread for the current export (if any). */
+  boost::thread m_writer;
+
+  /** A flag set to indicate that the writer thread should abandon the current export. */
+  boost::atomic<bool> m_writerShouldTerminate;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a mesh exporter.
+   *
+   * \param meshingEngine The engine to use to mesh the voxel blocks.
+   * \param labelManager  The label manager (if any) whose label names should be listed in the PLY header.
+   * \throws std::invalid_argument  If the meshing engine is NULL.
+   */
+  MeshExporter(const LabelledMeshingEngine_Ptr& meshingEngine, const LabelManager_CPtr& labelManager);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the mesh exporter, cancelling any export that is still in progress.
+   */
+  ~MeshExporter();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  MeshExporter(const MeshExporter&);
+  MeshExporter& operator=(const MeshExporter&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Cancels any export that is still in progress, and deletes its partially-written PLY file.
+   */
+  void cancel();
+
+  /**
+   * \brief Meshes any voxel blocks that remain to be meshed for the current export (if any), and waits for the PLY file to be finalised.
+   *
+   * \param scene The scene being exported.
+   */
+  void finish(const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Gets whether or not there are voxel blocks that remain to be meshed for the current export.
+   *
+   * \return  true, if there are voxel blocks that remain to be meshed, or false otherwise.
+   */
+  bool is_meshing() const;
+
+  /**
+   * \brief Starts exporting a mesh of the specified scene to a PLY file.
+   *
+   * If a previous export is still being written, this first waits for it to be finalised.
+   *
+   * \param path                The path to the PLY file.
+   * \param scene               The scene to export.
+   * \throws std::runtime_error If the PLY file cannot be opened for writing.
+   */
+  void start(const std::string& path, const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Meshes up to the specified number of the voxel blocks that remain to be meshed for the current export (if any).
+   *
+   * \param scene         The scene being exported.
+   * \param maxBlockCount The maximum number of voxel blocks to mesh.
+   */
+  void update(const SpaintVoxelScene *scene, int maxBlockCount);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Meshes the next batch of (up to blockCount) voxel blocks, and hands the resulting triangles to the writer thread.
+   *
+   * \param scene       The scene being exported.
+   * \param blockCount  The maximum number of voxel blocks to mesh.
+   */
+  void mesh_next_batch(const SpaintVoxelScene *scene, int blockCount);
+
+  /**
+   * \brief Runs the writer thread.
+   */
+  void run_writer();
+
+  /**
+   * \brief Writes the header of the PLY file, leaving space for the vertex and face counts to be filled in later.
+   */
+  void write_header();
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Fills in one of the element counts in the PLY header.
+   *
+   * \param os    The stream to which the PLY file is being written.
+   * \param pos   The position of the count in the file.
+   * \param count The count.
+   */
+  static void patch_count(std::ostream& os, std::streampos pos, size_t count);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<MeshExporter> MeshExporter_Ptr;
+
+}
+
+#endif
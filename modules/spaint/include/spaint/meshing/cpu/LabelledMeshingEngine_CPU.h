@@ -0,0 +1,35 @@
+/**
+ * spaint: LabelledMeshingEngine_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELLEDMESHINGENGINE_CPU
+#define H_SPAINT_LABELLEDMESHINGENGINE_CPU
+
+#include "../interface/LabelledMeshingEngine.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to extract a labelled triangle mesh from a voxel scene using the CPU.
+ */
+class LabelledMeshingEngine_CPU : public LabelledMeshingEngine
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void copy_entry_ids_to_host(int firstBlock, int blockCount, int *entryIDs) const;
+
+  /** Override */
+  virtual int find_changed_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion) const;
+
+  /** Override */
+  virtual int find_resident_entries(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual bool mesh_batch(const SpaintVoxelScene *scene, int firstBlock, int blockCount, std::vector<Triangle>& triangles, std::vector<int> *triangleEntryIDs) const;
+};
+
+}
+
+#endif
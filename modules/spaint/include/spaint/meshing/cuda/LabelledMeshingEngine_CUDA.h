@@ -0,0 +1,56 @@
+/**
+ * spaint: LabelledMeshingEngine_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELLEDMESHINGENGINE_CUDA
+#define H_SPAINT_LABELLEDMESHINGENGINE_CUDA
+
+#include "../interface/LabelledMeshingEngine.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to extract a labelled triangle mesh from a voxel scene using CUDA.
+ */
+class LabelledMeshingEngine_CUDA : public LabelledMeshingEngine
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to store the number of hash entries found by find_resident_entries. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_entryCountMB;
+
+  /** A memory block in which to store the number of triangles produced by the current batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_triangleCountMB;
+
+  /** A memory block in which to store the IDs of the hash entries of the voxel blocks that produced the triangles in the current batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_triangleEntryIDsMB;
+
+  /** A memory block in which to store the triangles produced by the current batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Triangle> > m_trianglesMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based labelled meshing engine.
+   */
+  LabelledMeshingEngine_CUDA();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void copy_entry_ids_to_host(int firstBlock, int blockCount, int *entryIDs) const;
+
+  /** Override */
+  virtual int find_changed_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion) const;
+
+  /** Override */
+  virtual int find_resident_entries(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual bool mesh_batch(const SpaintVoxelScene *scene, int firstBlock, int blockCount, std::vector<Triangle>& triangles, std::vector<int> *triangleEntryIDs) const;
+};
+
+}
+
+#endif
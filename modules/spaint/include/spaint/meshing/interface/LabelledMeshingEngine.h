@@ -0,0 +1,189 @@
+/**
+ * spaint: LabelledMeshingEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELLEDMESHINGENGINE
+#define H_SPAINT_LABELLEDMESHINGENGINE
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to extract a triangle mesh (with per-vertex colours
+ *        and semantic labels) from a voxel scene using marching cubes.
+ *
+ * Unlike InfiniTAM's meshing engine, which meshes the whole scene in one go into a single mesh, a labelled meshing engine
+ * meshes the scene's voxel blocks in batches. The voxel blocks that are resident when meshing starts are first recorded
+ * in a list, and batches of blocks from this list can then be meshed one at a time, which allows the mesh to be streamed
+ * to disk (and the work spread over several frames) without ever needing to hold the whole mesh in memory.
+ *
+ * Alternatively, only the voxel blocks whose meshes may have changed since a given version of the scene can be recorded
+ * (see prepare_changed), and the triangles can be tagged with the hash entries of the blocks that produced them, which
+ * allows a cache of per-block meshes to be kept up to date incrementally (see BlockMeshCache).
+ */
+class LabelledMeshingEngine
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents a vertex of a labelled mesh.
+   */
+  struct Vertex
+  {
+    /** The colour of the vertex (interpolated from the colours of the voxels on either side of the surface). */
+    Vector3u colour;
+
+    /** The semantic label of the vertex (taken from whichever of the voxels on either side of the surface is nearer to it). */
+    SpaintVoxel::Label label;
+
+    /** The position of the vertex (in m). */
+    Vector3f position;
+  };
+
+  /**
+   * \brief An instance of this struct represents a triangle of a labelled mesh.
+   */
+  struct Triangle
+  {
+    /** The vertices of the triangle. */
+    Vertex vertices[3];
+  };
+
+  //#################### CONSTANTS ####################
+public:
+  /** The maximum number of voxel blocks that can be meshed in a single batch. */
+  static const int MAX_BATCH_BLOCK_COUNT = 1024;
+
+  /** The maximum number of triangles that a single batch may produce on the GPU (batches that would produce more are automatically split). */
+  static const int MAX_BATCH_TRIANGLE_COUNT = 1 << 19;
+
+  /** The maximum number of triangles that marching cubes can produce for a single voxel. */
+  static const int MAX_VOXEL_TRIANGLE_COUNT = 5;
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the IDs of the hash entries of the voxel blocks that are to be meshed. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_entryIDsMB;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of voxel blocks that were recorded by the last call to prepare. */
+  int m_preparedBlockCount;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a labelled meshing engine.
+   */
+  LabelledMeshingEngine();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the labelled meshing engine.
+   */
+  virtual ~LabelledMeshingEngine();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Finds the hash entries of the voxel blocks in the scene that are currently resident, and writes their IDs into m_entryIDsMB.
+   *
+   * \param scene The scene.
+   * \return      The number of hash entries found.
+   */
+  virtual int find_resident_entries(const SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Finds the hash entries of the resident voxel blocks in the scene whose meshes may have changed since the specified version,
+   *        and writes their IDs into m_entryIDsMB.
+   *
+   * \param scene         The scene.
+   * \param sinceVersion  The version since which the meshes of the blocks must have changed.
+   * \return              The number of hash entries found.
+   */
+  virtual int find_changed_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion) const = 0;
+
+  /**
+   * \brief Copies the specified range of the IDs of the hash entries in m_entryIDsMB to the host.
+   *
+   * \param firstBlock  The index (in m_entryIDsMB) of the first entry ID to copy.
+   * \param blockCount  The number of entry IDs to copy.
+   * \param entryIDs    An array (of size blockCount) into which to copy the entry IDs.
+   */
+  virtual void copy_entry_ids_to_host(int firstBlock, int blockCount, int *entryIDs) const = 0;
+
+  /**
+   * \brief Runs marching cubes on the specified range of the voxel blocks in m_entryIDsMB, and appends the resulting triangles to the specified vector.
+   *
+   * \param scene             The scene.
+   * \param firstBlock        The index (in m_entryIDsMB) of the first voxel block to mesh.
+   * \param blockCount        The number of voxel blocks to mesh.
+   * \param triangles         The vector to which to append the triangles.
+   * \param triangleEntryIDs  A vector (if any) to which to append the ID of the hash entry of the voxel block that produced each triangle.
+   * \return                  true, if the triangles were appended, or false if the batch produced too many triangles (in which case nothing is appended).
+   */
+  virtual bool mesh_batch(const SpaintVoxelScene *scene, int firstBlock, int blockCount, std::vector<Triangle>& triangles, std::vector<int> *triangleEntryIDs) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the IDs of the hash entries of the specified range of the voxel blocks that were recorded by the last call to prepare (or prepare_changed).
+   *
+   * \param firstBlock              The index (in the recorded list) of the first voxel block.
+   * \param blockCount              The number of voxel blocks.
+   * \param entryIDs                A vector into which to write the entry IDs (any existing contents are replaced).
+   * \throws std::invalid_argument  If the range of voxel blocks is invalid.
+   */
+  void get_prepared_entry_ids(int firstBlock, int blockCount, std::vector<int>& entryIDs) const;
+
+  /**
+   * \brief Runs marching cubes on the specified range of the voxel blocks that were recorded by the last call to prepare,
+   *        and appends the resulting triangles to the specified vector.
+   *
+   * Voxel blocks that have been swapped out since prepare was called are skipped.
+   *
+   * \param scene                   The scene.
+   * \param firstBlock              The index (in the list recorded by prepare) of the first voxel block to mesh.
+   * \param blockCount              The number of voxel blocks to mesh (at most MAX_BATCH_BLOCK_COUNT).
+   * \param triangles               The vector to which to append the triangles.
+   * \param triangleEntryIDs        A vector (if any) to which to append the ID of the hash entry of the voxel block that produced each triangle.
+   * \throws std::invalid_argument  If the range of voxel blocks is invalid.
+   */
+  void mesh_blocks(const SpaintVoxelScene *scene, int firstBlock, int blockCount, std::vector<Triangle>& triangles, std::vector<int> *triangleEntryIDs = NULL) const;
+
+  /**
+   * \brief Records the voxel blocks in the scene that are currently resident, ready for them to be meshed.
+   *
+   * \param scene The scene.
+   * \return      The number of voxel blocks recorded.
+   */
+  int prepare(const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Records the resident voxel blocks in the scene whose meshes may have changed since the specified version, ready for them to be meshed.
+   *
+   * The cells of a voxel block extend into its neighbours in the positive x, y and z directions, so a block is recorded
+   * if it, or any of those neighbours, has changed (geometrically or semantically) since the specified version.
+   *
+   * \param scene         The scene.
+   * \param sinceVersion  The version since which the meshes of the blocks must have changed.
+   * \return              The number of voxel blocks recorded.
+   */
+  int prepare_changed(const SpaintVoxelScene *scene, unsigned int sinceVersion);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<LabelledMeshingEngine> LabelledMeshingEngine_Ptr;
+typedef boost::shared_ptr<const LabelledMeshingEngine> LabelledMeshingEngine_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * spaint: LabelledMeshingEngine_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELLEDMESHINGENGINE_SHARED
+#define H_SPAINT_LABELLEDMESHINGENGINE_SHARED
+
+#include <ITMLib/Engines/Meshing/Shared/ITMMeshingEngine_Shared.h>
+#include <ITMLib/Engines/Visualisation/Shared/ITMVisualisationEngine_Shared.h>
+
+#include "../interface/LabelledMeshingEngine.h"
+#include "../../fusion/shared/BlockVersionTracker_Shared.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not the specified hash entry refers to a resident voxel block whose mesh may have changed since the specified version.
+ *
+ * The cells of a voxel block extend into its neighbours in the positive x, y and z directions, so its mesh may have changed
+ * if either it or any of those neighbours has changed since the specified version.
+ *
+ * \param entryID       The ID of the hash entry.
+ * \param hashTable     The scene's hash table.
+ * \param blockVersions The versions at which the scene's voxel blocks were last changed.
+ * \param sinceVersion  The version since which the mesh of the block must have changed.
+ * \return              true, if the hash entry refers to a resident voxel block whose mesh may have changed, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_changed_entry(int entryID, const ITMHashEntry *hashTable, const SpaintVoxelScene::BlockVersions *blockVersions, unsigned int sinceVersion)
+{
+  const ITMHashEntry& hashEntry = hashTable[entryID];
+  if(hashEntry.ptr < 0) return false;
+  if(is_block_modified_since(blockVersions[hashEntry.ptr], sinceVersion, BlockVersionTracker::VERSION_ALL)) return true;
+
+  for(int j = 1; j < 8; ++j)
+  {
+    const Vector3i neighbourPos(
+      (hashEntry.pos.x + (j & 1)) * SDF_BLOCK_SIZE,
+      (hashEntry.pos.y + ((j >> 1) & 1)) * SDF_BLOCK_SIZE,
+      (hashEntry.pos.z + ((j >> 2) & 1)) * SDF_BLOCK_SIZE
+    );
+
+    bool isFound;
+    const int voxelAddress = findVoxel(hashTable, neighbourPos, isFound);
+    if(isFound && is_block_modified_since(blockVersions[voxelAddress / SDF_BLOCK_SIZE3], sinceVersion, BlockVersionTracker::VERSION_ALL)) return true;
+  }
+
+  return false;
+}
+
+/**
+ * \brief Determines whether or not the specified hash entry refers to a voxel block that is currently resident.
+ *
+ * \param entryID   The ID of the hash entry.
+ * \param hashTable The scene's hash table.
+ * \return          true, if the hash entry refers to a resident voxel block, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_resident_entry(int entryID, const ITMHashEntry *hashTable)
+{
+  return hashTable[entryID].ptr >= 0;
+}
+
+/**
+ * \brief Reads the SDF value, colour and semantic label of a voxel at a corner of a marching cubes cell.
+ *
+ * \param pos         The position of the voxel (in voxel coordinates).
+ * \param voxelData   The scene's voxel data.
+ * \param labelData   The scene's label data (if any).
+ * \param indexData   The scene's index data.
+ * \param sdf         A location into which to write the voxel's SDF value.
+ * \param colour      A location into which to write the voxel's colour.
+ * \param label       A location into which to write the voxel's semantic label.
+ * \return            true, if the voxel is allocated and has been observed, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool read_cell_corner(const Vector3i& pos, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                             float& sdf, Vector3f& colour, SpaintVoxel::Label& label)
+{
+  bool isFound;
+  const int voxelAddress = findVoxel(indexData, pos, isFound);
+  if(!isFound) return false;
+
+  const SpaintVoxel& voxel = voxelData[voxelAddress];
+  if(voxel.w_depth == 0) return false;
+
+  sdf = SpaintVoxel::valueToFloat(voxel.sdf);
+  colour = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxel).toFloat();
+  label = get_voxel_label(voxelAddress, voxelData, labelData).label;
+  return true;
+}
+
+/**
+ * \brief Runs marching cubes on the cell whose minimum corner is the specified voxel in a batch of voxel blocks.
+ *
+ * The cube corners and edges are numbered as in InfiniTAM's meshing engine, so that its edge and triangle tables can be used.
+ *
+ * \param i           The index of the voxel in the batch (SDF_BLOCK_SIZE3 voxels per block).
+ * \param entryIDs    The IDs of the hash entries of the voxel blocks in the batch.
+ * \param hashTable   The scene's hash table.
+ * \param voxelData   The scene's voxel data.
+ * \param labelData   The scene's label data (if any).
+ * \param voxelSize   The size of a voxel (in m).
+ * \param triangles   An array (of size LabelledMeshingEngine::MAX_VOXEL_TRIANGLE_COUNT) into which to write the triangles for the cell.
+ * \return            The number of triangles written.
+ */
+_CPU_AND_GPU_CODE_
+inline int mesh_cell(int i, const int *entryIDs, const ITMHashEntry *hashTable, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                     float voxelSize, LabelledMeshingEngine::Triangle *triangles)
+{
+  // If the voxel block has been swapped out (or deallocated) since the batch was recorded, early out.
+  const ITMHashEntry& hashEntry = hashTable[entryIDs[i / SDF_BLOCK_SIZE3]];
+  if(hashEntry.ptr < 0) return 0;
+
+  const int linearIdx = i % SDF_BLOCK_SIZE3;
+  const Vector3i blockPos(hashEntry.pos.x * SDF_BLOCK_SIZE, hashEntry.pos.y * SDF_BLOCK_SIZE, hashEntry.pos.z * SDF_BLOCK_SIZE);
+  const Vector3i pos(
+    blockPos.x + linearIdx % SDF_BLOCK_SIZE,
+    blockPos.y + (linearIdx / SDF_BLOCK_SIZE) % SDF_BLOCK_SIZE,
+    blockPos.z + linearIdx / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE)
+  );
+
+  // Read the voxels at the corners of the cell. If any of them is missing or unobserved, there is no surface to extract.
+  Vector3f cornerColours[8], cornerPositions[8];
+  SpaintVoxel::Label cornerLabels[8];
+  float cornerSdfs[8];
+  int cubeIndex = 0;
+  for(int j = 0; j < 8; ++j)
+  {
+    const Vector3i cornerPos(pos.x + ((j ^ (j >> 1)) & 1), pos.y + ((j >> 1) & 1), pos.z + ((j >> 2) & 1));
+    if(!read_cell_corner(cornerPos, voxelData, labelData, hashTable, cornerSdfs[j], cornerColours[j], cornerLabels[j])) return 0;
+    cornerPositions[j] = cornerPos.toFloat();
+    if(cornerSdfs[j] < 0) cubeIndex |= 1 << j;
+  }
+
+  const int edgeFlags = edgeTable[cubeIndex];
+  if(edgeFlags == 0) return 0;
+
+  // Compute the vertices at which the surface crosses the edges of the cell.
+  LabelledMeshingEngine::Vertex edgeVertices[12];
+  for(int e = 0; e < 12; ++e)
+  {
+    if((edgeFlags & (1 << e)) == 0) continue;
+
+    const int a = e < 8 ? e : e - 8;
+    const int b = e < 4 ? (e + 1) % 4 : e < 8 ? 4 + (e + 1) % 4 : e - 4;
+    const float denom = cornerSdfs[b] - cornerSdfs[a];
+    const float t = fabs(denom) < 0.00001f ? 0.0f : CLAMP(-cornerSdfs[a] / denom, 0.0f, 1.0f);
+
+    LabelledMeshingEngine::Vertex& v = edgeVertices[e];
+    v.position = (cornerPositions[a] + t * (cornerPositions[b] - cornerPositions[a])) * voxelSize;
+    v.colour = (cornerColours[a] + t * (cornerColours[b] - cornerColours[a])).toUChar();
+    v.label = t <= 0.5f ? cornerLabels[a] : cornerLabels[b];
+  }
+
+  // Assemble the triangles.
+  int triangleCount = 0;
+  for(int k = 0; triangleTable[cubeIndex][k] != -1; k += 3, ++triangleCount)
+  {
+    for(int j = 0; j < 3; ++j)
+    {
+      triangles[triangleCount].vertices[j] = edgeVertices[triangleTable[cubeIndex][k + j]];
+    }
+  }
+
+  return triangleCount;
+}
+
+}
+
+#endif
@@ -6,11 +6,15 @@
 #ifndef H_SPAINT_CAMERARENDERER
 #define H_SPAINT_CAMERARENDERER
 
+#include <vector>
+
 #include <boost/optional.hpp>
 
 #include <ITMLib/Utils/ITMMath.h>
 
-#include <rigging/Camera.h>
+#include <rigging/SimpleCamera.h>
+
+#include "VertexBufferMesh.h"
 
 namespace spaint {
 
@@ -32,6 +36,16 @@ struct CameraRenderer
 
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
+  /**
+   * \brief Makes a mesh for a camera's axes, suitable for use with render_cameras.
+   *
+   * The mesh must be made whilst the OpenGL context in which it is to be used is current.
+   *
+   * \param axesType  The type of axes the mesh should represent.
+   * \return          The mesh.
+   */
+  static VertexBufferMesh_CPtr make_axes_mesh(AxesType axesType);
+
   /**
    * \brief Renders a camera in the scene.
    *
@@ -43,6 +57,23 @@ struct CameraRenderer
    */
   static void render_camera(const rigging::Camera& cam, AxesType axesType = AXES_XYZ, float axisScale = 1.0f,
                             const boost::optional<Vector3f>& bodyColour = boost::none, double bodyScale = 0.02);
+
+  /**
+   * \brief Renders a set of cameras in the scene using cached meshes.
+   *
+   * The axes mesh (and body mesh, if any) are each bound only once, however many cameras are rendered.
+   *
+   * \param cams                    The cameras to render.
+   * \param axesMesh                The mesh to use for the cameras' axes (see make_axes_mesh).
+   * \param axisScale               The scale factor to apply to each axis.
+   * \param bodyMesh                The unit sphere mesh to use for the cameras' bodies (see QuadricRenderer::make_sphere_mesh), if we want to render them.
+   * \param bodyColours             The colours to use for the cameras' bodies (if we're rendering them).
+   * \param bodyScale               The scale factor to apply to the cameras' bodies (if we're rendering them).
+   * \throws std::invalid_argument  If we're rendering the cameras' bodies, but there is not exactly one body colour for each camera.
+   */
+  static void render_cameras(const std::vector<rigging::SimpleCamera>& cams, const VertexBufferMesh& axesMesh, float axisScale = 1.0f,
+                             const VertexBufferMesh_CPtr& bodyMesh = VertexBufferMesh_CPtr(),
+                             const std::vector<Vector3f>& bodyColours = std::vector<Vector3f>(), double bodyScale = 0.02);
 };
 
 }
@@ -6,22 +6,52 @@
 #ifndef H_SPAINT_QUADRICRENDERER
 #define H_SPAINT_QUADRICRENDERER
 
+#include <vector>
+
 #include <boost/optional.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include <Eigen/Dense>
 
+#include "VertexBufferMesh.h"
 #include "WrappedGL.h"
 
 namespace spaint {
 
 /**
  * \brief This class provides utility functions for rendering quadrics at arbitrary positions and orientations in space.
+ *
+ * Individual quadrics can be rendered using GLU. When many quadrics need to be rendered each frame, it is more efficient
+ * to build unit meshes for them once (see make_cylinder_mesh and make_sphere_mesh), and then render all of the quadrics
+ * that share a mesh together (see render_cylinders and render_spheres), so that the mesh only needs to be bound once.
  */
 class QuadricRenderer
 {
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Makes a mesh for a unit cylinder, suitable for use with render_cylinders.
+   *
+   * The cylinder has a radius of 1 and extends from z = 0 to z = 1. Like a GLU cylinder, it is open at both ends.
+   * The mesh must be made whilst the OpenGL context in which it is to be used is current.
+   *
+   * \param slices  The number of subdivisions of the cylinder around its length.
+   * \param stacks  The number of subdivisions of the cylinder along its length.
+   * \return        The mesh.
+   */
+  static VertexBufferMesh_CPtr make_cylinder_mesh(int slices, int stacks = 1);
+
+  /**
+   * \brief Makes a mesh for a unit sphere centred at the origin, suitable for use with render_spheres.
+   *
+   * The mesh must be made whilst the OpenGL context in which it is to be used is current.
+   *
+   * \param slices  The number of subdivisions of the sphere around its vertical axis (similar to lines of longitude).
+   * \param stacks  The number of subdivisions of the sphere along its vertical axis (similar to lines of latitude).
+   * \return        The mesh.
+   */
+  static VertexBufferMesh_CPtr make_sphere_mesh(int slices, int stacks);
+
   /**
    * \brief Renders a cylinder between the specified base centre and top centre points.
    *
@@ -37,6 +67,18 @@ public:
                               double baseRadius, double topRadius, int slices, int stacks = 1,
                               const boost::optional<boost::shared_ptr<GLUquadric> >& optionalQuadric = boost::none);
 
+  /**
+   * \brief Renders a set of cylinders using a cached unit cylinder mesh (see make_cylinder_mesh).
+   *
+   * \param mesh                    The unit cylinder mesh.
+   * \param baseCentres             The centres of the bases of the cylinders.
+   * \param topCentres              The centres of the tops of the cylinders.
+   * \param radii                   The radii of the cylinders.
+   * \throws std::invalid_argument  If the numbers of base centres, top centres and radii differ.
+   */
+  static void render_cylinders(const VertexBufferMesh& mesh, const std::vector<Eigen::Vector3f>& baseCentres,
+                               const std::vector<Eigen::Vector3f>& topCentres, const std::vector<float>& radii);
+
   /**
    * \brief Renders a sphere of the specified radius at the specified position.
    *
@@ -49,6 +91,16 @@ public:
   static void render_sphere(const Eigen::Vector3f& centre, double radius, int slices, int stacks,
                             const boost::optional<boost::shared_ptr<GLUquadric> >& optionalQuadric = boost::none);
 
+  /**
+   * \brief Renders a set of spheres using a cached unit sphere mesh (see make_sphere_mesh).
+   *
+   * \param mesh                    The unit sphere mesh.
+   * \param centres                 The positions of the centres of the spheres.
+   * \param radii                   The radii of the spheres.
+   * \throws std::invalid_argument  If the numbers of centres and radii differ.
+   */
+  static void render_spheres(const VertexBufferMesh& mesh, const std::vector<Eigen::Vector3f>& centres, const std::vector<float>& radii);
+
   //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
 private:
   /**
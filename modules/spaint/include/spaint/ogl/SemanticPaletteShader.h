@@ -0,0 +1,101 @@
+/**
+ * spaint: SemanticPaletteShader.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SEMANTICPALETTESHADER
+#define H_SPAINT_SEMANTICPALETTESHADER
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ITMLib/Utils/ITMMath.h>
+
+#include "WrappedGL.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class wraps a fragment shader that can be used to draw a compact semantic image (see SemanticVisualiser::render_compact)
+ *        that has been uploaded to a texture, looking up the colours of its labels in a small palette texture as it is drawn.
+ *
+ * The compact image's texture must contain the labels in its luminance channel and the intensities in its alpha channel (e.g. it can be
+ * uploaded as GL_LUMINANCE_ALPHA data on a little-endian machine), and must use nearest-neighbour filtering, since interpolating between
+ * labels would be meaningless. The palette is only re-uploaded when the label colours change, so changing them is essentially free.
+ *
+ * Note that a palette shader must be constructed and destroyed whilst the OpenGL context in which it is to be used is current.
+ */
+class SemanticPaletteShader
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The ID of the fragment shader. */
+  GLuint m_fragmentShaderID;
+
+  /** The colours currently stored in the palette texture. */
+  std::vector<Vector3u> m_paletteColours;
+
+  /** The number of entries in the palette texture (i.e. the maximum number of labels that can be in use). */
+  GLsizei m_paletteSize;
+
+  /** The ID of the palette texture (which contains one texel for each label). */
+  GLuint m_paletteTextureID;
+
+  /** The ID of the shader program. */
+  GLuint m_programID;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a palette shader.
+   *
+   * \param maxLabelCount         The maximum number of labels that can be in use.
+   * \throws std::runtime_error   If the shader cannot be compiled or linked.
+   */
+  explicit SemanticPaletteShader(size_t maxLabelCount);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the palette shader.
+   */
+  ~SemanticPaletteShader();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  SemanticPaletteShader(const SemanticPaletteShader&);
+  SemanticPaletteShader& operator=(const SemanticPaletteShader&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Binds the shader, so that any quads subsequently drawn with a compact semantic image bound to texture unit 0 are coloured using the specified label colours.
+   *
+   * \param labelColours  The colours to use for the semantic labels (any beyond the size of the palette are ignored).
+   */
+  void bind(const std::vector<Vector3u>& labelColours);
+
+  /**
+   * \brief Unbinds the shader, restoring the fixed-function pipeline.
+   */
+  void unbind() const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Uploads the specified label colours to the palette texture.
+   *
+   * \param labelColours  The colours to use for the semantic labels.
+   */
+  void update_palette(const std::vector<Vector3u>& labelColours);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<SemanticPaletteShader> SemanticPaletteShader_Ptr;
+
+}
+
+#endif
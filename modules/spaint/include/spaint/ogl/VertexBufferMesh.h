@@ -0,0 +1,106 @@
+/**
+ * spaint: VertexBufferMesh.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VERTEXBUFFERMESH
+#define H_SPAINT_VERTEXBUFFERMESH
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <Eigen/Dense>
+
+#include "WrappedGL.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class represents a mesh whose vertices (and, optionally, per-vertex colours) are stored in OpenGL buffer objects.
+ *
+ * Meshes like this are intended to be built once and then drawn many times (e.g. once for each instance of an object in the scene,
+ * with the model-view matrix set appropriately for each instance), avoiding the cost of regenerating and resubmitting the geometry
+ * using immediate mode each time. To draw several instances cheaply, the mesh can be bound once, drawn as many times as necessary,
+ * and then unbound.
+ *
+ * Note that a mesh must be constructed and destroyed whilst the OpenGL context in which it is to be used is current.
+ */
+class VertexBufferMesh
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The ID of the buffer object containing the per-vertex colours (0 if the mesh is uncoloured). */
+  GLuint m_colourBufferID;
+
+  /** The number of indices in the index buffer. */
+  GLsizei m_indexCount;
+
+  /** The ID of the buffer object containing the indices of the vertices of the mesh's primitives. */
+  GLuint m_indexBufferID;
+
+  /** The type of primitive from which the mesh is made (e.g. GL_QUADS or GL_LINES). */
+  GLenum m_primitiveType;
+
+  /** The ID of the buffer object containing the vertex positions. */
+  GLuint m_vertexBufferID;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a mesh.
+   *
+   * \param primitiveType           The type of primitive from which the mesh is made (e.g. GL_QUADS or GL_LINES).
+   * \param vertices                The positions of the mesh's vertices.
+   * \param indices                 The indices of the vertices of the mesh's primitives.
+   * \param colours                 The colours of the mesh's vertices (if empty, the current OpenGL colour is used when drawing).
+   * \throws std::invalid_argument  If colours are specified, but there is not exactly one for each vertex.
+   */
+  VertexBufferMesh(GLenum primitiveType, const std::vector<Eigen::Vector3f>& vertices, const std::vector<GLuint>& indices,
+                   const std::vector<Eigen::Vector3f>& colours = std::vector<Eigen::Vector3f>());
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the mesh.
+   */
+  ~VertexBufferMesh();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  VertexBufferMesh(const VertexBufferMesh&);
+  VertexBufferMesh& operator=(const VertexBufferMesh&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Binds the mesh's buffers so that the mesh can be drawn.
+   */
+  void bind() const;
+
+  /**
+   * \brief Draws the mesh using the current model-view matrix.
+   *
+   * \pre The mesh must have been bound using bind().
+   */
+  void draw() const;
+
+  /**
+   * \brief Binds, draws and then unbinds the mesh.
+   */
+  void render() const;
+
+  /**
+   * \brief Unbinds the mesh's buffers after drawing.
+   */
+  void unbind() const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const VertexBufferMesh> VertexBufferMesh_CPtr;
+
+}
+
+#endif
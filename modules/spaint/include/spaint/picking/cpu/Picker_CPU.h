@@ -20,8 +20,20 @@ public:
   /** Override */
   virtual bool pick(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB, size_t offset) const;
 
+  /** Override */
+  virtual bool pick_deferred(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB,
+                             Vector3f& latestPickPoint, size_t offset) const;
+
+  /** Override */
+  virtual size_t pick_batch(const std::vector<Vector2i>& points, const ITMLib::ITMRenderState *renderState, size_t maxPickPoints,
+                            ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB,
+                            bool copyToHost) const;
+
   /** Override */
   virtual void to_short(const ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB) const;
+
+  /** Override */
+  virtual void wait_for_host_copy() const;
 };
 
 }
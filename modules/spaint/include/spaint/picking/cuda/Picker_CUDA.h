@@ -7,6 +7,7 @@
 #define H_SPAINT_PICKER_CUDA
 
 #include "../interface/Picker.h"
+#include "../../util/cuda/AsyncReadback_CUDA.h"
 
 namespace spaint {
 
@@ -15,13 +16,62 @@ namespace spaint {
  */
 class Picker_CUDA : public Picker
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block into which to write the result of a deferred pick, as (x,y,z,hit), where hit is 1 if the ray hit the scene, or 0 otherwise. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector4f> > m_deferredResultMB;
+
+  /** The readback used to copy the results of deferred picks across to the CPU without waiting for them. */
+  mutable AsyncReadback_CUDA<Vector4f> m_deferredResultReadback;
+
+  /** An event recorded once the most recent asynchronous copy of a batch of pick points to the CPU has been issued. */
+  cudaEvent_t m_hostCopyEvent;
+
+  /** A memory block into which to write the number of points picked from a batch. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_pickPointCountMB;
+
+  /** A memory block used to upload a batch of points on the image plane to the GPU (grown on demand). */
+  mutable boost::shared_ptr<ORUtils::MemoryBlock<Vector2i> > m_pointsMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based picker.
+   */
+  Picker_CUDA();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the CUDA-based picker.
+   */
+  ~Picker_CUDA();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  Picker_CUDA(const Picker_CUDA&);
+  Picker_CUDA& operator=(const Picker_CUDA&);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
   virtual bool pick(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB, size_t offset) const;
 
+  /** Override */
+  virtual bool pick_deferred(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB,
+                             Vector3f& latestPickPoint, size_t offset) const;
+
+  /** Override */
+  virtual size_t pick_batch(const std::vector<Vector2i>& points, const ITMLib::ITMRenderState *renderState, size_t maxPickPoints,
+                            ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB,
+                            bool copyToHost) const;
+
   /** Override */
   virtual void to_short(const ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB) const;
+
+  /** Override */
+  virtual void wait_for_host_copy() const;
 };
 
 }
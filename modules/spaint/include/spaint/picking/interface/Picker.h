@@ -41,6 +41,48 @@ public:
    */
   virtual bool pick(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB, size_t offset = 0) const = 0;
 
+  /**
+   * \brief Picks the nearest scene points (if any) that would be hit by rays cast through a batch of points on the image plane
+   *        when viewed from the camera pose with the specified render state.
+   *
+   * The points that hit the scene are written, in the order in which they appear in the batch, to the front of the output
+   * memory blocks, whose data sizes are then set to the number of points picked. Points outside the image are treated as
+   * misses. The results are left on the same device as the render state: if they are needed on the CPU (e.g. for rendering),
+   * copyToHost can be used to start an asynchronous copy, which must then be waited for using wait_for_host_copy.
+   *
+   * \param points             The points on the image plane through which to cast the rays.
+   * \param renderState        A render state corresponding to the camera pose.
+   * \param maxPickPoints      The maximum number of pick points to keep (the output memory blocks must be able to hold this many points).
+   * \param pickPointsFloatMB  A memory block into which to write the voxel coordinates of the picked points in Vector3f format.
+   * \param pickPointsShortMB  A memory block into which to write the voxel coordinates of the picked points in Vector3s format.
+   * \param copyToHost         Whether or not to start copying the Vector3f pick points across to the CPU.
+   * \return                   The number of points picked.
+   */
+  virtual size_t pick_batch(const std::vector<Vector2i>& points, const ITMLib::ITMRenderState *renderState, size_t maxPickPoints,
+                            ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB,
+                            bool copyToHost = false) const = 0;
+
+  /**
+   * \brief Starts determining the nearest scene point (if any) that would be hit by a ray cast through (x,y) on the image plane
+   *        when viewed from the camera pose with the specified render state, without waiting for the result to reach the CPU.
+   *
+   * This is intended for per-frame UI feedback, for which a frame of latency is preferable to stalling the GPU. The point hit
+   * (if any) is written into the memory block as for pick, except that a miss leaves the existing contents of the memory block
+   * intact, so that it always contains the most recent point hit. However, the result returned is that of the most recent
+   * deferred pick whose result has reached the CPU, which need not be this one (on the GPU, it is typically the one started
+   * by the previous call). On the CPU, which does not need to wait for anything, the result is always that of this pick.
+   *
+   * \param x               The x coordinate of the point on the image plane through which the ray is cast.
+   * \param y               The y coordinate of the point on the image plane through which the ray is cast.
+   * \param renderState     A render state corresponding to the camera pose.
+   * \param pickPointsMB    A memory block into which to write the voxel coordinates of the nearest scene point (if any) that is hit by the ray.
+   * \param latestPickPoint A place into which to store the voxel coordinates of the point hit by the most recent deferred pick whose result has reached the CPU.
+   * \param offset          The offset into the memory block at which to write.
+   * \return                true, if the most recent deferred pick whose result has reached the CPU hit the scene, or false otherwise.
+   */
+  virtual bool pick_deferred(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB,
+                             Vector3f& latestPickPoint, size_t offset = 0) const = 0;
+
   /**
    * \brief Converts one or more pick points in Vector3f format into Vector3s format.
    *
@@ -49,6 +91,11 @@ public:
    */
   virtual void to_short(const ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB) const = 0;
 
+  /**
+   * \brief Waits for the host copy (if any) started by the most recent call to pick_batch to finish.
+   */
+  virtual void wait_for_host_copy() const = 0;
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -64,6 +111,18 @@ public:
     pickPointsMB.UpdateHostFromDevice();
 
     // Convert the pick points from voxel coordinates into scene coordinates and return them.
+    return get_host_positions<Vec>(pickPointsMB, voxelSize);
+  }
+
+  /**
+   * \brief Converts one or more pick points in voxel coordinates that are already available on the CPU into scene coordinates.
+   *
+   * \param pickPointsMB  The voxel coordinates of the picked points.
+   * \param voxelSize     The size of an InfiniTAM voxel (in metres).
+   */
+  template <typename Vec>
+  static std::vector<Vec> get_host_positions(const ORUtils::MemoryBlock<Vector3f>& pickPointsMB, float voxelSize)
+  {
     const Vector3f *pickPoints = pickPointsMB.GetData(MEMORYDEVICE_CPU);
     size_t pickPointCount = pickPointsMB.dataSize;
     std::vector<Vec> positions(pickPointCount);
@@ -28,6 +28,23 @@ inline bool get_pick_point(int x, int y, int width, const Vector4f *pointImage,
   return p.w > 0;
 }
 
+/**
+ * \brief Gets the scene point (if any) that would be picked by clicking at a specific location on the image plane,
+ *        treating locations outside the viewing area as misses.
+ *
+ * \param point       The point clicked.
+ * \param imgSize     The size of the viewing area on the image plane.
+ * \param pointImage  An image specifying the scene points that would be picked for every pixel on the image plane.
+ * \param pickPoint   A place into which to store the scene point (if any) that would be picked.
+ * \return            true, if clicking on the specified location picked a point, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool get_pick_point_checked(const Vector2i& point, const Vector2i& imgSize, const Vector4f *pointImage, Vector3f& pickPoint)
+{
+  if(point.x < 0 || point.x >= imgSize.x || point.y < 0 || point.y >= imgSize.y) return false;
+  return get_pick_point(point.x, point.y, imgSize.x, pointImage, pickPoint);
+}
+
 }
 
 #endif
@@ -6,6 +6,9 @@
 #ifndef H_SPAINT_OBJECTSEGMENTATIONCOMPONENT
 #define H_SPAINT_OBJECTSEGMENTATIONCOMPONENT
 
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
 #include "ObjectSegmentationContext.h"
 #include "../imagesources/SingleRGBDImagePipe.h"
 
@@ -13,23 +16,108 @@ namespace spaint {
 
 /**
  * \brief An instance of this pipeline component can be used to segment objects from the rest of the scene.
+ *
+ * Optionally, each frame can instead be segmented on a worker thread (see segmentAsynchronously), concurrently with SLAM
+ * for the next frame. In that case, run_segmentation snapshots the inputs it needs and returns immediately, and the results
+ * for a frame (the input mask for tracking, the overlay image and the masked images for the object scene) are published by
+ * the next call to run_segmentation, so that they are used a frame later than they would be otherwise.
  */
 class ObjectSegmentationComponent
 {
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct contains the results of segmenting a frame.
+   */
+  struct SegmentationResult
+  {
+    /** The inverse of the target mask, with which to mask the camera input for tracking purposes. */
+    ITMUCharImage_Ptr inputMask;
+
+    /** Whether or not the masked images for the object scene were written into the output buffers. */
+    bool outputWritten;
+
+    /** The masked version of the RGB input. */
+    ITMUChar4Image_CPtr rgbMasked;
+
+    /** The bounding box of the target mask. */
+    boost::optional<Vector4i> targetBounds;
+
+    /** The target mask (null if no target was found). */
+    ITMUCharImage_CPtr targetMask;
+  };
+
+  /**
+   * \brief An instance of this struct represents a snapshot of the inputs needed to segment a frame asynchronously.
+   */
+  struct Snapshot
+  {
+    /** A copy of the raw depth input. */
+    ITMShortImage_Ptr depthInput;
+
+    /** The camera pose from which the frame was captured. */
+    ORUtils::SE3Pose pose;
+
+    /** A render state containing a copy of the scene raycast. */
+    VoxelRenderState_Ptr renderState;
+
+    /** A copy of the view (this is the view on which the segmenter operates). */
+    View_Ptr view;
+
+    /** Whether or not to write the masked images for the object scene into the output buffers. */
+    bool writeOutput;
+  };
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The shared context needed for object segmentation. */
   ObjectSegmentationContext_Ptr m_context;
 
+  /** The buffer into which the masked depth image is written before being swapped into the output pipe. */
+  ITMShortImage_Ptr m_outputDepthImage;
+
   /** A flag controlling whether or not to write the masked RGB and depth images to the output pipe. */
   bool m_outputEnabled;
 
   /** The pipe to which to write the masked RGB and depth images resulting from the segmentation process. */
   SingleRGBDImagePipe_Ptr m_outputPipe;
 
+  /** The buffer into which the masked RGB image is written before being swapped into the output pipe. */
+  ITMUChar4Image_Ptr m_outputRGBImage;
+
   /** The ID of the scene on which the component should operate. */
   std::string m_sceneID;
 
+  /** Whether or not to segment each frame on a worker thread, concurrently with SLAM for the next frame. */
+  bool m_segmentAsynchronously;
+
+  /** The message of any exception thrown whilst segmenting the most recent frame asynchronously (accessed only whilst holding m_segmentationMutex). */
+  std::string m_segmentationError;
+
+  /** A condition variable used to wake the main thread when the worker thread has finished segmenting a frame. */
+  boost::condition_variable m_segmentationFinished;
+
+  /** The mutex used to protect the state shared between the main thread and the worker thread. */
+  boost::mutex m_segmentationMutex;
+
+  /** Whether or not a frame is waiting to be segmented, or being segmented, by the worker thread (accessed only whilst holding m_segmentationMutex). */
+  bool m_segmentationRequested;
+
+  /** A condition variable used to wake the worker thread when there is a frame for it to segment. */
+  boost::condition_variable m_segmentationRequestedCondition;
+
+  /** The results of segmenting the most recent frame asynchronously, if they have not yet been published (accessed only whilst holding m_segmentationMutex). */
+  boost::optional<SegmentationResult> m_segmentationResult;
+
+  /** The worker thread on which frames are segmented (if asynchronous segmentation is enabled). */
+  boost::thread m_segmentationWorker;
+
+  /** A flag set in the destructor to indicate that the worker thread should terminate. */
+  boost::atomic<bool> m_segmentationWorkerShouldTerminate;
+
+  /** The snapshot of the inputs for the frame that is being segmented asynchronously (accessed by the worker thread only whilst a frame is requested). */
+  Snapshot m_snapshot;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -41,8 +129,29 @@ public:
    */
   ObjectSegmentationComponent(const ObjectSegmentationContext_Ptr& context, const std::string& sceneID, const SingleRGBDImagePipe_Ptr& outputPipe = SingleRGBDImagePipe_Ptr());
 
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the object segmentation component, stopping the worker thread (if any).
+   */
+  ~ObjectSegmentationComponent();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ObjectSegmentationComponent(const ObjectSegmentationComponent&);
+  ObjectSegmentationComponent& operator=(const ObjectSegmentationComponent&);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Waits for any frame that is being segmented asynchronously, and discards the results without publishing them.
+   *
+   * This should be called when the component stops being run (e.g. when switching out of segmentation mode), so that
+   * stale results are not published when it is next run.
+   */
+  void cancel_segmentation();
+
   /**
    * \brief Resets the segmenter.
    */
@@ -51,7 +160,8 @@ public:
   /**
    * \brief Runs the segmentation section of the component.
    *
-   * \param renderState The render state associated with the camera position from which to segment the target.
+   * \param renderState         The render state associated with the camera position from which to segment the target.
+   * \throws std::runtime_error If asynchronous segmentation is enabled and segmenting the previous frame failed.
    */
   void run_segmentation(const VoxelRenderState_CPtr& renderState);
 
@@ -69,12 +179,56 @@ public:
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Copies the specified view into the snapshot.
+   *
+   * \param view  The view.
+   */
+  void copy_view_to_snapshot(const View_CPtr& view);
+
   /**
    * \brief Gets the segmenter.
    *
    * \return  The segmenter.
    */
-  const Segmenter_Ptr& get_segmenter() const;
+  const Segmenter_Ptr& get_segmenter();
+
+  /**
+   * \brief Publishes the results of segmenting a frame (i.e. sets the input mask for tracking and the overlay image,
+   *        writes the masked images to the output pipe and saves any segmentation video frame).
+   *
+   * \param result      The results of segmenting the frame.
+   * \param view        The view of the frame.
+   * \param depthInput  The raw depth input for the frame.
+   */
+  void publish_segmentation_result(const SegmentationResult& result, const View_CPtr& view, const ITMShortImage_CPtr& depthInput);
+
+  /**
+   * \brief Repeatedly segments the frames requested by the main thread (until the component is destroyed).
+   */
+  void run_segmentation_worker();
+
+  /**
+   * \brief Segments the target from a frame, and masks the frame's inputs accordingly.
+   *
+   * \param segmenter   The segmenter (which must be operating on the view of the frame).
+   * \param pose        The camera pose from which the frame was captured.
+   * \param renderState The render state associated with the camera position from which to segment the target.
+   * \param view        The view of the frame.
+   * \param depthInput  The raw depth input for the frame.
+   * \param writeOutput Whether or not to write the masked images for the object scene into the output buffers.
+   * \return            The results of segmenting the frame.
+   */
+  SegmentationResult segment_frame(const Segmenter_Ptr& segmenter, const ORUtils::SE3Pose& pose, const VoxelRenderState_CPtr& renderState,
+                                   const View_CPtr& view, const ITMShortImage_CPtr& depthInput, bool writeOutput);
+
+  /**
+   * \brief Waits for the frame (if any) that is being segmented asynchronously, and takes the results.
+   *
+   * \return                    The results of segmenting the frame, if a frame was segmented since the results were last taken, or boost::none otherwise.
+   * \throws std::runtime_error If segmenting the frame failed.
+   */
+  boost::optional<SegmentationResult> wait_for_segmentation();
 };
 
 //#################### TYPEDEFS ####################
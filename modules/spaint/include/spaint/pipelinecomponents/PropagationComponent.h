@@ -6,6 +6,10 @@
 #ifndef H_SPAINT_PROPAGATIONCOMPONENT
 #define H_SPAINT_PROPAGATIONCOMPONENT
 
+#include <boost/optional.hpp>
+
+#include <tvgutil/timing/WorkBudgetController.h>
+
 #include "PropagationContext.h"
 #include "../propagation/interface/LabelPropagator.h"
 
@@ -13,6 +17,9 @@ namespace spaint {
 
 /**
  * \brief An instance of this pipeline component can be used to propagate a specified label over surfaces in a scene.
+ *
+ * Optionally, the component can adapt the fraction of frames on which it propagates so as to hold the measured cost of
+ * propagation near a target time (see timeTarget). The current rate is published as a profiler gauge.
  */
 class PropagationComponent
 {
@@ -24,6 +31,9 @@ private:
   /** The label propagator. */
   LabelPropagator_CPtr m_labelPropagator;
 
+  /** The controller used to adapt the fraction of frames on which to propagate (if adaptive propagation is enabled). */
+  boost::optional<tvgutil::WorkBudgetController> m_runRate;
+
   /** The ID of the scene on which the component should operate. */
   std::string m_sceneID;
 
@@ -6,12 +6,31 @@
 #ifndef H_SPAINT_SLAMCOMPONENT
 #define H_SPAINT_SLAMCOMPONENT
 
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
 #include <ITMLib/Core/ITMDenseMapper.h>
 #include <ITMLib/Core/ITMDenseSurfelMapper.h>
+#include <ITMLib/Engines/Reconstruction/Interface/ITMSceneReconstructionEngine.h>
+#include <ITMLib/Engines/Swapping/Interface/ITMSwappingEngine.h>
+
+#include <itmx/remote/SharedPosePublisher.h>
 
 #include "SLAMContext.h"
-#include "../fiducials/FiducialDetector.h"
+#include "../fiducials/BackgroundFiducialDetector.h"
+#include "../fusion/SharedVoxelFuser.h"
+#include "../fusion/interface/BatchedVoxelIntegrator.h"
+#include "../fusion/interface/BlockVersionTracker.h"
+#include "../fusion/interface/ConvergedBlockFilter.h"
+#include "../fusion/interface/VoxelBlockDefragmenter.h"
+#include "../fusion/interface/VoxelSceneResetter.h"
+#include "../imageprocessing/interface/DepthChangeEstimator.h"
+#include "../imageprocessing/interface/DepthPreprocessor.h"
+#include "../segmentation/interface/DepthMasker.h"
+#include "../swapping/interface/VoxelSwapManager.h"
+#include "../trackers/ConstantVelocityMotionModel.h"
 #include "../trackers/FallibleTracker.h"
+#include "../visualisation/interface/BlockOccupancyUpdater.h"
 
 namespace spaint {
 
@@ -24,6 +43,8 @@ class SLAMComponent
 private:
   typedef boost::shared_ptr<ITMLib::ITMDenseMapper<SpaintVoxel,ITMVoxelIndex> > DenseMapper_Ptr;
   typedef boost::shared_ptr<ITMLib::ITMDenseSurfelMapper<SpaintSurfel> > DenseSurfelMapper_Ptr;
+  typedef boost::shared_ptr<ITMLib::ITMSceneReconstructionEngine<SpaintVoxel,ITMVoxelIndex> > SceneReconstructionEngine_Ptr;
+  typedef boost::shared_ptr<ITMLib::ITMSwappingEngine<SpaintVoxel,ITMVoxelIndex> > SwappingEngine_Ptr;
   typedef ITMLib::ITMTrackingState::TrackingResult TrackingResult;
 
   //#################### ENUMERATIONS ####################
@@ -52,17 +73,76 @@ public:
     TRACK_VOXELS
   };
 
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents an input frame that has been (or is being) acquired from the image source.
+   */
+  struct StagedFrame
+  {
+    /** Whether or not the image source was able to provide the frame. */
+    bool available;
+
+    /** The region (if any) of the frame outside which the image source knows that it contains nothing of interest. */
+    boost::optional<Vector4i> imageRegion;
+
+    /** The depth component of the frame. */
+    ITMShortImage_Ptr rawDepth;
+
+    /** The RGB component of the frame. */
+    ITMUChar4Image_Ptr rgb;
+
+    /** Whether or not the current sub-engine of a composite image source ran out of images after providing the frame. */
+    bool subengineExhausted;
+
+    /** The timestamps of the frame. */
+    FrameTimestamps timestamps;
+  };
+
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The detector (if any) used to detect fiducials on a separate thread, off the SLAM critical path. */
+  BackgroundFiducialDetector_Ptr m_backgroundFiducialDetector;
+
+  /** The integrator (if any) used to fuse batches of frames into the voxel scene in a single pass when the poses are known in advance. */
+  BatchedVoxelIntegrator_Ptr m_batchedVoxelIntegrator;
+
+  /** The updater (if any) used to keep the block occupancy of the voxel scene up to date as frames are fused. */
+  BlockOccupancyUpdater_CPtr m_blockOccupancyUpdater;
+
+  /** The tracker used to stamp the voxel blocks changed by fusion with the versions at which they were changed. */
+  BlockVersionTracker_CPtr m_blockVersionTracker;
+
   /** The shared context needed for SLAM. */
   SLAMContext_Ptr m_context;
 
+  /** The filter (if any) used to stop voxel blocks that have converged from being fused again. */
+  ConvergedBlockFilter_Ptr m_convergedBlockFilter;
+
+  /** The CUDA device that owns the scene (or -1, if the scene simply lives on whichever device is current when the component is used). */
+  int m_cudaDevice;
+
+  /** A function (if any) to call each time the voxel scene has been defragmented. */
+  boost::function<void()> m_defragmentationHook;
+
+  /** The number of fused frames between successive defragmentations of the voxel scene (0 to never defragment it automatically). */
+  size_t m_defragmentationInterval;
+
   /** The dense surfel mapper. */
   DenseSurfelMapper_Ptr m_denseSurfelMapper;
 
   /** The dense voxel mapper. */
   DenseMapper_Ptr m_denseVoxelMapper;
 
+  /** The estimator (if any) used to detect whether the depth image has changed since the most recently fused frame, when throttling fusion for a static camera. */
+  DepthChangeEstimator_Ptr m_depthChangeEstimator;
+
+  /** The masker used to apply the input mask (if any) to the depth image of each frame, on the device on which SLAM is running. */
+  DepthMasker_Ptr m_depthMasker;
+
+  /** The depth preprocessor used to reduce the noise in the depth image of each view before it is tracked (if any). */
+  DepthPreprocessor_Ptr m_depthPreprocessor;
+
   /** Whether or not the user wants fiducials to be detected. */
   bool m_detectFiducials;
 
@@ -75,6 +155,9 @@ private:
   /** The number of frames for which fusion has been run. */
   size_t m_fusedFramesCount;
 
+  /** A function (if any) to call each time fusion has been run. */
+  boost::function<void()> m_fusionHook;
+
   /** Whether or not the user wants fusion to be run. */
   bool m_fusionEnabled;
 
@@ -94,27 +177,133 @@ private:
    */
   size_t m_initialFramesToFuse;
 
+  /**
+   * The margin (in pixels) by which to expand the region of interest (if any) of each input frame before limiting the raycasts
+   * of the scene used for tracking to it. This must be large enough to cover any motion of the region between frames.
+   */
+  int m_inputRegionMargin;
+
+  /** A copy of the depth image of the most recently fused frame (if fusion is being throttled for a static camera). */
+  ITMFloatImage_Ptr m_lastFusedDepth;
+
+  /** The pose of the most recently fused frame (if fusion is being throttled for a static camera and a frame has been fused). */
+  boost::optional<ORUtils::SE3Pose> m_lastFusedPose;
+
+  /**
+   * The pose from which the supersampled surfel index image in the live surfel render state was last rendered,
+   * or none if the surfel scene has changed since then (in which case the index image must be rendered again).
+   */
+  boost::optional<ORUtils::SE3Pose> m_lastSurfelIndexPose;
+
   /** The engine used to perform low-level image processing operations. */
   LowLevelEngine_Ptr m_lowLevelEngine;
 
+  /** The number of frames that have been processed. */
+  size_t m_processedFramesCount;
+
   /** The mapping mode to use. */
   MappingMode m_mappingMode;
 
+  /** A function (if any) to call to get the pose of the mirrored scene, instead of reading it directly from the scene's SLAM state. */
+  boost::function<ORUtils::SE3Pose()> m_mirrorPoseProvider;
+
   /** The ID of the scene (if any) whose pose is to be mirrored. */
   std::string m_mirrorSceneID;
 
+  /** An optional motion model used to predict the initial pose for the tracker from the camera's recent motion. */
+  boost::optional<ConstantVelocityMotionModel> m_motionModel;
+
+  /** Whether or not a warning has been issued that the voxel scene's storage is close to being exhausted (re-armed once it no longer is). */
+  bool m_occupancyWarningIssued;
+
+  /** The fraction of the voxel block array or the hash table's excess list above which to warn that the voxel scene's storage is close to being exhausted. */
+  float m_occupancyWarningThreshold;
+
+  /**
+   * Whether or not to acquire the images for the next frame on a separate thread whilst the current frame is being processed.
+   * The processing itself is unaffected, so the results are identical to those obtained without pipelining.
+   */
+  bool m_pipelineFrames;
+
+  /** A function (if any) to call once the pose for the current frame has been finalised (i.e. will no longer change). */
+  boost::function<void()> m_poseFinalisedHook;
+
+  /** The message of the exception (if any) thrown by the prefetcher whilst acquiring the staged frame (accessed only whilst holding m_prefetchMutex). */
+  std::string m_prefetchError;
+
+  /** A condition variable used to wake the main thread when the prefetcher has finished acquiring the staged frame. */
+  boost::condition_variable m_prefetchFinished;
+
+  /** Whether or not the staged frame has been handed to the prefetcher and not yet collected (accessed only by the main thread). */
+  bool m_prefetchIssued;
+
+  /** The mutex used to protect the state shared between the main thread and the prefetcher. */
+  boost::mutex m_prefetchMutex;
+
+  /** Whether or not the prefetcher should acquire, or is acquiring, the staged frame (accessed only whilst holding m_prefetchMutex). */
+  bool m_prefetchRequested;
+
+  /** A condition variable used to wake the prefetcher when there is a frame for it to acquire. */
+  boost::condition_variable m_prefetchRequestedCondition;
+
+  /** The long-lived worker thread on which the images for the next frame are acquired (started the first time it is needed, if pipelining is enabled). */
+  boost::thread m_prefetcher;
+
+  /** A flag set in the destructor to indicate that the prefetcher should terminate (accessed only whilst holding m_prefetchMutex). */
+  bool m_prefetcherShouldTerminate;
+
   /** Whether or not to relocalise and train after processing every frame, for evaluation purposes. */
   bool m_relocaliseEveryFrame;
 
   /** The path to the relocalisation forest. */
   std::string m_relocaliserForestPath;
-
+  /** The type of relocaliser ("ferns", "forest" or "cascade"). */
   /** The type of relocaliser. */
   std::string m_relocaliserType;
 
+  /**
+   * The scene reconstruction engine used to fuse frames into the voxel scene when converged blocks are being filtered out or frames are
+   * being integrated in batches (since both of these need to intervene between allocation and integration, both of which are done by a
+   * single call to the dense voxel mapper).
+   */
+  SceneReconstructionEngine_Ptr m_sceneReconstructionEngine;
+
   /** The ID of the scene to reconstruct. */
   std::string m_sceneID;
 
+  /** The publisher (if any) used to make the camera poses (and, optionally, the live raycast) available to other processes via shared memory. */
+  itmx::SharedPosePublisher_Ptr m_sharedPosePublisher;
+
+  /** The fuser (if any) via which frames are fused into a voxel scene that is shared with other SLAM components. */
+  SharedVoxelFuser_Ptr m_sharedVoxelFuser;
+
+  /** The staging frame into which the images for the next frame are acquired when pipelining. */
+  StagedFrame m_stagedFrame;
+
+  /** The number of consecutive frames for which the camera and the scene have been static without a frame being fused. */
+  int m_staticFramesSinceFusion;
+
+  /** The number of frames between fusions whilst the camera and the scene are static (1 means fuse every frame, 0 means stop fusing altogether). */
+  int m_staticFusionInterval;
+
+  /** The largest fraction of the depth image that can have changed since the most recently fused frame for the scene to be considered static. */
+  float m_staticFusionMaxChangedFraction;
+
+  /** The largest rotation (in radians) of the camera since the most recently fused frame for the camera to be considered static. */
+  double m_staticFusionMaxRotation;
+
+  /** The largest translation (in metres) of the camera since the most recently fused frame for the camera to be considered static. */
+  float m_staticFusionMaxTranslation;
+
+  /** The largest rotation (in radians) of the camera for which the supersampled surfel index image can be reused (negative means never reuse it). */
+  double m_surfelIndexReuseMaxRotation;
+
+  /** The largest translation (in metres) of the camera for which the supersampled surfel index image can be reused (negative means never reuse it). */
+  float m_surfelIndexReuseMaxTranslation;
+
+  /** The swapping engine used when converged blocks are being filtered out (if swapping is not disabled). */
+  SwappingEngine_Ptr m_swappingEngine;
+
   /** The tracker. */
   Tracker_Ptr m_tracker;
 
@@ -124,12 +313,42 @@ private:
   /** The tracking controller. */
   TrackingController_Ptr m_trackingController;
 
+  /** The intermediate images used when repeatedly halving the resolution of the depth image for tracking. */
+  std::vector<ITMFloatImage_Ptr> m_trackingDepthPyramid;
+
+  /** The number of times to halve the resolution of the input images for tracking (0 means track at the full resolution). */
+  int m_trackingDownsampleLevels;
+
+  /** Whether or not to train and update the relocaliser on a separate thread, off the tracking critical path. */
+  bool m_trainRelocaliserInBackground;
+
   /** The tracking mode to use. */
   TrackingMode m_trackingMode;
 
+  /** The intermediate images used when repeatedly halving the resolution of the colour image for tracking. */
+  std::vector<ITMUChar4Image_Ptr> m_trackingRGBPyramid;
+
+  /** The reduced-resolution view used for tracking (if we're not tracking at the full resolution). */
+  View_Ptr m_trackingView;
+
+  /** The reduced-resolution render state used when raycasting the voxel scene for tracking (if we're not tracking at the full resolution). */
+  VoxelRenderState_Ptr m_trackingVoxelRenderState;
+
   /** The view builder. */
   ViewBuilder_Ptr m_viewBuilder;
 
+  /** Whether or not the voxel scene has been fully reset since it was created (or replaced), so that its unused voxel blocks are known to be clear. */
+  bool m_voxelSceneInitialised;
+
+  /** The resetter (if any) used to reset the voxel scene once it has been fully reset once, by clearing only its resident voxel blocks. */
+  VoxelSceneResetter_CPtr m_voxelSceneResetter;
+
+  /** The defragmenter (if any) used to reorder the voxel scene's resident voxel blocks into Morton order (created when first needed). */
+  VoxelBlockDefragmenter_CPtr m_voxelBlockDefragmenter;
+
+  /** The voxel swap manager (if swapping is enabled), which prefetches voxel blocks and preserves their labels across swaps. */
+  VoxelSwapManager_Ptr m_voxelSwapManager;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -148,8 +367,38 @@ public:
                 const std::string& trackerConfig, MappingMode mappingMode = MAP_VOXELS_ONLY, TrackingMode trackingMode = TRACK_VOXELS,
                 const FiducialDetector_CPtr& fiducialDetector = FiducialDetector_CPtr(), bool detectFiducials = false);
 
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the SLAM component.
+   *
+   * \note  If the images for the next frame are being acquired asynchronously, this will block until the acquisition finishes
+   *        and the prefetcher has terminated.
+   */
+  ~SLAMComponent();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  SLAMComponent(const SLAMComponent&);
+  SLAMComponent& operator=(const SLAMComponent&);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Reorders the resident voxel blocks of the voxel scene so that blocks that are close to each other in space are also close to each other in memory.
+   *
+   * This makes the passes that read voxels from neighbouring blocks (e.g. raycasting) more cache-friendly once the scene has become
+   * fragmented. It is run automatically every so often if a defragmentation interval has been specified, but can also be run at any
+   * other time when the scene is not being fused into (e.g. whilst fusion is disabled, or before saving a scene). The defragmentation
+   * hook (if any) is called afterwards, so that other components can invalidate anything they have stored about the blocks by slot.
+   *
+   * 
+eturn                    The number of resident voxel blocks in the scene.
+   * 	hrows std::runtime_error If the component shares its voxel scene with other components.
+   */
+  int defragment_voxel_scene();
+
   /**
    * \brief Gets whether or not the user wants fusion to be run.
    *
@@ -157,6 +406,13 @@ public:
    */
   bool get_fusion_enabled() const;
 
+  /**
+   * \brief Gets the ID of the scene (if any) whose pose is being mirrored.
+   *
+   * \return The ID of the scene (if any) whose pose is being mirrored, or the empty string otherwise.
+   */
+  const std::string& get_mirror_scene_id() const;
+
   /**
    * \brief Makes the SLAM component mirror the pose of the specified scene, rather than using its own tracker.
    *
@@ -176,6 +432,15 @@ public:
    */
   void reset_scene();
 
+  /**
+   * \brief Sets a function to call each time the voxel scene has been defragmented.
+   *
+   * This allows other components to invalidate anything they have stored about the voxel blocks by slot (e.g. cached features).
+   *
+   * \param hook The function to call (an empty function means do nothing).
+   */
+  void set_defragmentation_hook(const boost::function<void()>& hook);
+
   /**
    * \brief Sets whether or not the user wants fiducials to be detected.
    *
@@ -193,8 +458,108 @@ public:
    */
   void set_fusion_enabled(bool fusionEnabled);
 
+  /**
+   * \brief Sets a function to call each time fusion has been run.
+   *
+   * This allows other components to react to the voxel blocks that were updated (these are the ones in the live voxel render state's visible list).
+   *
+   * \param hook The function to call (an empty function means do nothing).
+   */
+  void set_fusion_hook(const boost::function<void()>& hook);
+
+  /**
+   * \brief Sets a function to call to get the pose of the mirrored scene, instead of reading it directly from the scene's SLAM state.
+   *
+   * This is needed when the mirrored scene is being processed concurrently on another thread, in which case the function
+   * can wait until the mirrored scene's pose is ready, or return a copy of it that was taken before the threads were started.
+   *
+   * \param provider The function to call (an empty function means read the pose directly from the mirrored scene's SLAM state).
+   */
+  void set_mirror_pose_provider(const boost::function<ORUtils::SE3Pose()>& provider);
+
+  /**
+   * \brief Sets a function to call once the pose for the current frame has been finalised.
+   *
+   * This allows any scenes that mirror the pose of this one to proceed without waiting for the rest of the frame.
+   *
+   * \param hook The function to call (an empty function means do nothing).
+   */
+  void set_pose_finalised_hook(const boost::function<void()>& hook);
+
+  /**
+   * \brief Makes the SLAM component fuse its frames into a voxel scene that is shared with other SLAM components, rather than into its own.
+   *
+   * The shared scene replaces the component's own voxel scene, so the component then also tracks against (and renders) the shared scene.
+   * The frames added to the fuser are only fused into the scene once the fuser is flushed, which should be done once each component
+   * that shares the scene has processed its frame. Note that resetting the scene of any component that shares it resets the shared scene.
+   *
+   * \param fuser                 The fuser via which to fuse frames into the shared scene.
+   * \throws std::runtime_error   If the component is using a feature that requires it to have its own voxel scene (e.g. swapping).
+   */
+  void set_shared_voxel_fuser(const SharedVoxelFuser_Ptr& fuser);
+
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Acquires the images for a frame from the image source.
+   *
+   * \param frame The staged frame into which to acquire the images.
+   */
+  void acquire_frame(StagedFrame& frame);
+
+  /**
+   * \brief Integrates any frames that have been batched up into the voxel scene.
+   */
+  void flush_batched_frames();
+
+  /**
+   * \brief Fuses the current frame into the voxel scene, skipping any voxel blocks that have converged.
+   *
+   * This does the same as the dense voxel mapper's ProcessFrame, except that the converged blocks are
+   * excluded from the visible list between allocating the scene and integrating the frame into it.
+   */
+  void fuse_voxels_skipping_converged_blocks();
+
+  /**
+   * \brief Gets the images for the next frame and stores them in the SLAM state's input images.
+   *
+   * If pipelining is enabled, the images for the frame after this one are then acquired asynchronously.
+   *
+   * \param subengineExhausted  Set to whether or not the current sub-engine of a composite image source ran out of images.
+   * \return                    true, if the images for the next frame were available, or false otherwise.
+   */
+  bool get_next_frame(bool& subengineExhausted);
+
+  /**
+   * \brief Gets the region (if any) to which to limit the raycast of the scene that is used for tracking.
+   *
+   * \param inputRegion The region of interest (if any) of the input images.
+   * \param imgSize     The size of the raycast result image.
+   * \return            The region of interest expanded by the input region margin and clamped to the image, if there is one,
+   *                    or boost::none otherwise.
+   */
+  boost::optional<Vector4i> get_raycast_region(const boost::optional<Vector4i>& inputRegion, const Vector2i& imgSize) const;
+
+  /**
+   * \brief Makes a relocaliser of the specified type (wrapped in a relocaliser that trains it in the background, if requested).
+   *
+   * \param relocaliserType         The type of relocaliser to make ("ferns" or, if grove is available, "forest").
+   * \return                        The relocaliser.
+   * \throws std::invalid_argument  If the relocaliser type is not supported.
+   */
+  itmx::Relocaliser_Ptr make_inner_relocaliser(const std::string& relocaliserType) const;
+
+  /**
+   * \brief Makes a relocaliser that uses ICP to refine the results of another relocaliser.
+   *
+   * \param innerRelocaliser The relocaliser whose results are to be refined.
+   * \param tracker          The ICP tracker to use for the refinement.
+   * \param hypothesisCount  The maximum number of inner relocaliser results to refine (if unspecified, this is taken from the settings).
+   * \return                 The refining relocaliser.
+   */
+  itmx::Relocaliser_Ptr make_refining_relocaliser(const itmx::Relocaliser_Ptr& innerRelocaliser, const Tracker_Ptr& tracker,
+                                                  const boost::optional<size_t>& hypothesisCount = boost::none) const;
+
   /**
    * \brief Render from the live camera position to prepare for tracking.
    *
@@ -202,11 +567,24 @@ private:
    */
   void prepare_for_tracking(TrackingMode trackingMode);
 
+  /**
+   * \brief Detects any fiducials in the current view of the scene, and updates the current set of fiducials accordingly.
+   *
+   * If fiducials are being detected in the background, this instead integrates any measurements that have been made
+   * since the last frame, and then hands the current frame to the background detector.
+   */
+  void process_fiducials();
+
   /**
    * \brief Perform relocalisation-specific operations (i.e. train a relocaliser if tracking succeeded or relocalise otherwise).
    */
   void process_relocalisation();
 
+  /**
+   * \brief Repeatedly acquires the staged frames requested by the main thread (until the component is destroyed).
+   */
+  void run_prefetcher();
+
   /**
    * \brief Sets up the relocaliser.
    */
@@ -216,6 +594,33 @@ private:
    * \brief Sets up the tracker.
    */
   void setup_tracker();
+
+  /**
+   * \brief Determines whether or not the fusion of the current frame can be skipped because neither the camera nor the scene
+   *        has changed appreciably since the most recently fused frame.
+   *
+   * \param view          The current view.
+   * \param trackingState The current tracking state.
+   * \return              true, if the fusion of the current frame can be skipped, or false otherwise.
+   */
+  bool should_skip_static_fusion(const ITMLib::ITMView *view, const ITMLib::ITMTrackingState *trackingState);
+
+  /**
+   * \brief Reports how much of the voxel scene's fixed-size storage is in use, warning if it is close to being exhausted.
+   */
+  void update_occupancy_telemetry();
+
+  /**
+   * \brief Updates the reduced-resolution view used for tracking by downsampling the current view on the device.
+   */
+  void update_tracking_view();
+
+  /**
+   * \brief Waits for the prefetcher to finish acquiring the staged frame.
+   *
+   * \throws std::runtime_error If the prefetcher failed to acquire the staged frame.
+   */
+  void wait_for_prefetched_frame();
 };
 
 //#################### TYPEDEFS ####################
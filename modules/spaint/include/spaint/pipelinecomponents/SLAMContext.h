@@ -11,7 +11,7 @@
 #include <ITMLib/Engines/Visualisation/Interface/ITMSurfelVisualisationEngine.h>
 #include <ITMLib/Engines/Visualisation/Interface/ITMVisualisationEngine.h>
 
-#include <itmx/relocalisation/RefiningRelocaliser.h>
+#include <itmx/relocalisation/Relocaliser.h>
 
 #include "../slamstate/SLAMState.h"
 
@@ -30,7 +30,7 @@ private:
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The relocalisers used to estimate the camera pose in the various scenes. */
-  std::map<std::string,itmx::RefiningRelocaliser_Ptr> m_relocalisers;
+  std::map<std::string,itmx::Relocaliser_Ptr> m_relocalisers;
 
   /** The states of the SLAM reconstructions for the various scenes. */
   std::map<std::string,SLAMState_Ptr> m_slamStates;
@@ -57,7 +57,7 @@ public:
    * \param sceneID The scene ID.
    * \return        The relocaliser for the specified scene.
    */
-  virtual itmx::RefiningRelocaliser_Ptr& get_relocaliser(const std::string& sceneID);
+  virtual itmx::Relocaliser_Ptr& get_relocaliser(const std::string& sceneID);
 
   /**
    * \brief Gets the relocaliser for the specified scene.
@@ -65,7 +65,7 @@ public:
    * \param sceneID The scene ID.
    * \return        The relocaliser for the specified scene.
    */
-  virtual itmx::RefiningRelocaliser_CPtr get_relocaliser(const std::string& sceneID) const;
+  virtual itmx::Relocaliser_CPtr get_relocaliser(const std::string& sceneID) const;
 
   /**
    * \brief Gets the SLAM state for the specified scene.
@@ -6,35 +6,121 @@
 #ifndef H_SPAINT_SEMANTICSEGMENTATIONCOMPONENT
 #define H_SPAINT_SEMANTICSEGMENTATIONCOMPONENT
 
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread.hpp>
+
 #include <rafl/core/RandomForest.h>
+#include <rafl/examples/ExampleMatrix.h>
+
+#include <tvgutil/timing/WorkBudgetController.h>
 
 #include "SemanticSegmentationContext.h"
 #include "../features/interface/FeatureCalculator.h"
+#include "../randomforest/interface/DeviceRandomForest.h"
+#include "../randomforest/interface/ForestPredictor.h"
+#include "../randomforest/interface/TrainingReplayBuffer.h"
 #include "../sampling/interface/PerLabelVoxelSampler.h"
+#include "../sampling/interface/StratifiedVoxelSampler.h"
+#include "../sampling/interface/SweepingVoxelSampler.h"
 #include "../sampling/interface/UniformVoxelSampler.h"
+#include "../sampling/interface/VisibleBlockVoxelSampler.h"
+#include "../sampling/interface/VoxelLocationSorter.h"
+#include "../segmentation/interface/SupervoxelSegmenter.h"
+#include "../visualisation/interface/FeatureInspectionVisualiser.h"
 
 namespace spaint {
 
 /**
  * \brief An instance of this pipeline component can be used to semantically segment a scene.
+ *
+ * The random forest is trained continuously on a background thread, which owns it exclusively. The render thread
+ * only computes training examples, which it hands to the trainer, and predicts labels using the most recent
+ * immutable snapshot of the forest published by the trainer. Training and prediction can thus both be run
+ * every frame without the cost of training stalling the render thread.
+ *
+ * Optionally, the component can also spend a fixed time slice each frame predicting labels for voxels elsewhere in the
+ * scene (see backgroundPredictionTimeSlice). This sweeps over all of the resident voxel blocks in batches, so that parts
+ * of the scene that are not currently visible still converge to a labelling without needing to be revisited.
+ *
+ * Optionally, the visible surface can instead be over-segmented into supervoxels each frame (see useSupervoxels), in which case labels
+ * are only predicted for the seeds of the supervoxels, and then broadcast to the other voxels in them. This labels more of the surface
+ * for far fewer predictions, since neighbouring voxels on the same surface patch would usually be predicted to have the same label.
+ *
+ * Optionally, the voxels used for both prediction and training can be sampled from the blocks in the render state's visible block
+ * list rather than from its raycast result (see sampleFromVisibleBlocks). This does not need a fresh raycast, so the semantic steps
+ * need not wait for rendering to finish, and it can also sample surfaces that are hidden behind others in the current view.
+ *
+ * Optionally, the rafl forest can be replaced by a forest that is trained and evaluated entirely on the device on which the component
+ * operates (see useDeviceForest). This is trained synchronously on the render thread, directly from the features computed on the device,
+ * so the training examples never need to be copied back to the host.
+ *
+ * The amount of work done can also be adapted to hold the measured cost of each part of it near a target time (see
+ * predictionTimeTarget, trainingTimeTarget and trainerTimeTarget). The current budgets are published as profiler gauges.
+ *
+ * In deterministic mode (see tvgutil::SeedUtil), the seeds of the samplers and the forest are derived from the root seed,
+ * the forest is trained synchronously on the render thread, and none of the work done depends on how long it takes
+ * (the adaptive budgets are disabled, and background prediction processes a single batch per frame), so that repeated
+ * runs on the same input perform identical work.
  */
 class SemanticSegmentationComponent
 {
   //#################### TYPEDEFS ####################
 private:
+  typedef boost::shared_ptr<const rafl::CompiledRandomForest<SpaintVoxel::Label> > CompiledRandomForest_CPtr;
+  typedef rafl::DecisionTree<SpaintVoxel::Label>::Settings DecisionTreeSettings;
+  typedef rafl::ExampleMatrix<SpaintVoxel::Label> ExampleMatrix;
   typedef boost::shared_ptr<rafl::RandomForest<SpaintVoxel::Label> > RandomForest_Ptr;
 
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The voxel sampler used to sweep over the whole scene during background prediction (null if background prediction is disabled). */
+  SweepingVoxelSampler_Ptr m_backgroundPredictionSampler;
+
+  /** The maximum time (in milliseconds) to spend on background prediction each frame. */
+  double m_backgroundPredictionTimeSlice;
+
+  /** A memory block in which to store the locations of the voxels sampled for background prediction purposes. */
+  Selector::Selection_Ptr m_backgroundPredictionVoxelLocationsMB;
+
   /** The shared context needed for semantic segmentation. */
   SemanticSegmentationContext_Ptr m_context;
 
+  /** Whether or not deterministic mode is enabled. */
+  bool m_deterministic;
+
+  /** The forest that is trained and evaluated entirely on the device, and used instead of the rafl forest (if the device forest is enabled). */
+  DeviceRandomForest_Ptr m_deviceForest;
+
   /** The feature calculator. */
   FeatureCalculator_CPtr m_featureCalculator;
 
-  /** The random forest. */
+  /** A memory block in which to store the feature descriptor of the voxel selected in feature inspection mode (allocated on first use). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_featureInspectionFeaturesMB;
+
+  /** The image into which to render the VOP patch of the voxel selected in feature inspection mode (allocated on first use). */
+  ITMUChar4Image_Ptr m_featureInspectionImage;
+
+  /** The visualiser used to render the VOP patch of the voxel selected in feature inspection mode. */
+  FeatureInspectionVisualiser_CPtr m_featureInspectionVisualiser;
+
+  /** The random forest (accessed only by the trainer once it has been started). */
   RandomForest_Ptr m_forest;
 
+  /** The predictor used to predict voxel labels from a snapshot of the random forest. */
+  ForestPredictor_Ptr m_forestPredictor;
+
+  /** The settings for a new forest with which the trainer should replace its forest, if a reset has been requested (accessed only whilst holding m_trainerMutex). */
+  boost::optional<DecisionTreeSettings> m_forestResetSettings;
+
+  /** The seed for the random number generator of each new forest (if deterministic mode is enabled), overriding the one in the forest settings file. */
+  boost::optional<unsigned int> m_forestSeed;
+
+  /** The most recent snapshot of the forest published by the trainer, if any (accessed only atomically). */
+  CompiledRandomForest_CPtr m_forestSnapshot;
+
   /** The maximum number of voxels for which to predict labels each frame. */
   size_t m_maxPredictionVoxelCount;
 
@@ -44,27 +130,72 @@ private:
   /** The side length of a VOP patch (must be odd). */
   size_t m_patchSize;
 
+  /** The training examples that have been made by the render thread but not yet added to the forest (accessed only whilst holding m_trainerMutex). */
+  std::vector<ExampleMatrix> m_pendingExamples;
+
+  /** The controller used to adapt the number of voxels for which to predict labels each frame (if adaptive prediction is enabled). */
+  boost::optional<tvgutil::WorkBudgetController> m_predictionBudget;
+
   /** A memory block in which to store the feature vectors computed for the various voxels during prediction. */
   boost::shared_ptr<ORUtils::MemoryBlock<float> > m_predictionFeaturesMB;
 
   /** A memory block in which to store the labels predicted for the various voxels. */
   boost::shared_ptr<ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> > m_predictionLabelsMB;
 
-  /** The voxel sampler used in prediction mode. */
+  /** The voxel sampler used in prediction mode (if stratified prediction sampling is disabled). */
   UniformVoxelSampler_CPtr m_predictionSampler;
 
   /** A memory block in which to store the locations of the voxels sampled for prediction purposes. */
   Selector::Selection_Ptr m_predictionVoxelLocationsMB;
 
+  /** The replay buffer (if any) from which the training examples are drawn, instead of training directly from the voxels sampled each frame. */
+  TrainingReplayBuffer_Ptr m_replayBuffer;
+
+  /** A memory block in which to store the feature vectors computed for the voxels sampled for training (if the replay buffer is in use). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_sampledTrainingFeaturesMB;
+
   /** The ID of the scene on which the component should operate. */
   std::string m_sceneID;
 
+  /** The controller used to adapt the number of nodes that may be split in each training step (if adaptive training is enabled; accessed only by whichever thread trains the forest). */
+  boost::optional<tvgutil::WorkBudgetController> m_splitBudget;
+
+  /** The voxel sampler used in prediction mode (if stratified prediction sampling is enabled). */
+  StratifiedVoxelSampler_CPtr m_stratifiedPredictionSampler;
+
+  /** A memory block in which to store the labels broadcast to the members of the supervoxels (if supervoxel prediction is enabled). */
+  boost::shared_ptr<ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> > m_supervoxelMemberLabelsMB;
+
+  /** A memory block in which to store the locations of the voxels of the members of the supervoxels (if supervoxel prediction is enabled). */
+  Selector::Selection_Ptr m_supervoxelMemberLocationsMB;
+
+  /** The segmenter used to over-segment the visible surface into supervoxels for prediction purposes (if supervoxel prediction is enabled). */
+  SupervoxelSegmenter_CPtr m_supervoxelSegmenter;
+
+  /** The thread on which the random forest is trained. */
+  boost::thread m_trainer;
+
+  /** A condition variable used to wake the trainer when there are new examples to add or a reset has been requested. */
+  boost::condition_variable m_trainerHasWork;
+
+  /** The mutex used to synchronise the hand-over of examples and reset requests to the trainer. */
+  boost::mutex m_trainerMutex;
+
+  /** A flag set in the destructor to indicate that the trainer should terminate. */
+  boost::atomic<bool> m_trainerShouldTerminate;
+
   /** A memory block in which to store the feature vectors computed for the various voxels during training. */
   boost::shared_ptr<ORUtils::MemoryBlock<float> > m_trainingFeaturesMB;
 
   /** A memory block in which to store a mask indicating which labels are currently in use and from which we want to train. */
   boost::shared_ptr<ORUtils::MemoryBlock<bool> > m_trainingLabelMaskMB;
 
+  /** The controller used to adapt the fraction of frames on which training examples are made (if adaptive training is enabled). */
+  boost::optional<tvgutil::WorkBudgetController> m_trainingRate;
+
+  /** The number of voxels per label to sample for training each frame (fewer than the maximum number from which to train, if the replay buffer is in use). */
+  size_t m_trainingSamplesPerLabel;
+
   /** The voxel sampler used in training mode. */
   PerLabelVoxelSampler_CPtr m_trainingSampler;
 
@@ -74,6 +205,18 @@ private:
   /** A memory block in which to store the locations of the voxels sampled for training purposes. */
   Selector::Selection_Ptr m_trainingVoxelLocationsMB;
 
+  /** The snapshot of the forest that was most recently uploaded to the predictor (accessed only by the render thread). */
+  CompiledRandomForest_CPtr m_uploadedForestSnapshot;
+
+  /** The voxel sampler used in prediction mode if voxels are being sampled from the visible blocks rather than the raycast result (null otherwise). */
+  VisibleBlockVoxelSampler_CPtr m_visibleBlockPredictionSampler;
+
+  /** The voxel sampler used in training mode if voxels are being sampled from the visible blocks rather than the raycast result (null otherwise). */
+  VisibleBlockVoxelSampler_CPtr m_visibleBlockTrainingSampler;
+
+  /** The sorter (if any) used to sort the sampled voxel locations into Morton order before their features are calculated (accessed only by the render thread). */
+  VoxelLocationSorter_Ptr m_voxelLocationSorter;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -85,10 +228,42 @@ public:
    */
   SemanticSegmentationComponent(const SemanticSegmentationContext_Ptr& context, const std::string& sceneID, unsigned int seed);
 
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the semantic segmentation component, stopping the trainer.
+   */
+  ~SemanticSegmentationComponent();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  SemanticSegmentationComponent(const SemanticSegmentationComponent&);
+  SemanticSegmentationComponent& operator=(const SemanticSegmentationComponent&);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Informs the component that its scene has just been defragmented.
+   *
+   * This allows the feature calculator to invalidate any cached features, since the scene's voxel blocks have moved.
+   * It should be called after every defragmentation pass (e.g. via the SLAM component's defragmentation hook) if the feature cache is enabled.
+   */
+  void handle_defragmentation();
+
+  /**
+   * \brief Informs the component that fusion has just been run on its scene.
+   *
+   * This allows the feature calculator to invalidate any cached features for the voxel blocks that fusion updated.
+   * It should be called after every fusion step (e.g. via the SLAM component's fusion hook) if the feature cache is enabled.
+   */
+  void handle_fusion();
+
   /**
    * \brief Resets the random forest.
+   *
+   * Prediction stops immediately, and the trainer replaces its forest with a new one as soon as it has finished its current training step
+   * (or immediately, in deterministic mode).
    */
   void reset_forest();
 
@@ -102,6 +277,9 @@ public:
   /**
    * \brief Runs the prediction section of the component.
    *
+   * This predicts labels for voxels sampled from the current view, followed (if enabled) by a time-sliced background
+   * pass that predicts labels for voxels elsewhere in the scene.
+   *
    * \param renderState The render state associated with the camera position from which to sample voxels.
    */
   void run_prediction(const VoxelRenderState_CPtr& renderState);
@@ -109,9 +287,57 @@ public:
   /**
    * \brief Runs the training section of the component.
    *
+   * This makes training examples from voxels sampled from the scene and hands them to the trainer, which adds them to the forest.
+   * In deterministic mode, the examples are instead added to the forest, and a single step of training is run, synchronously.
+   * If the device forest is in use, the examples are likewise added to it, and a single step of training is run, synchronously.
+   *
    * \param renderState The render state associated with the camera position from which to sample voxels.
    */
   void run_training(const VoxelRenderState_CPtr& renderState);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Makes the settings for a new random forest.
+   *
+   * \return The settings for a new random forest.
+   */
+  DecisionTreeSettings make_forest_settings() const;
+
+  /**
+   * \brief Predicts labels for the voxels whose feature descriptors are in the prediction features memory block, using whichever forest is in use.
+   *
+   * \param voxelCount The number of voxels for which to predict labels.
+   */
+  void predict_labels(size_t voxelCount);
+
+  /**
+   * \brief Predicts labels for batches of voxels swept from the whole scene, until the background prediction time slice is used up or no voxels remain to be predicted.
+   *
+   * \param scene  The scene.
+   */
+  void run_background_prediction(const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Runs the trainer, which repeatedly adds any pending examples to the forest, trains it and publishes a snapshot of it.
+   */
+  void run_trainer();
+
+  /**
+   * \brief Adds the most recently computed training examples to the device forest, and trains it for a single step.
+   */
+  void train_device_forest();
+
+  /**
+   * \brief Runs a single step of training: resets the forest (if requested), adds the specified examples to it and trains it.
+   *
+   * \param pendingExamples         The examples to add to the forest.
+   * \param resetSettings           The settings with which to replace the forest before training it (if any).
+   * \param forestMightBeSplittable A flag that is set to indicate whether or not further training of the forest might split any more nodes.
+   * \return                        A snapshot of the forest to publish, if it has changed and is valid, or null otherwise.
+   */
+  CompiledRandomForest_CPtr train_forest(const std::vector<ExampleMatrix>& pendingExamples, const boost::optional<DecisionTreeSettings>& resetSettings,
+                                         bool& forestMightBeSplittable);
 };
 
 //#################### TYPEDEFS ####################
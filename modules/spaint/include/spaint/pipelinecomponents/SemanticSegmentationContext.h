@@ -6,6 +6,8 @@
 #ifndef H_SPAINT_SEMANTICSEGMENTATIONCONTEXT
 #define H_SPAINT_SEMANTICSEGMENTATIONCONTEXT
 
+#include <map>
+
 #include "../markers/shared/VoxelMarker_Settings.h"
 #include "../selectors/Selector.h"
 #include "../slamstate/SLAMState.h"
@@ -24,12 +26,17 @@ private:
   typedef spaint::Selector::Selection Selection;
   typedef boost::shared_ptr<const Selection> Selection_CPtr;
 
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The overlay image (if any) to render whilst inspecting the features of voxels in different scenes. */
+  std::map<std::string,ITMUChar4Image_CPtr> m_featureInspectionImages;
+
   //#################### DESTRUCTOR ####################
 public:
   /**
    * \brief Destroys the semantic segmentation context.
    */
-  virtual ~SemanticSegmentationContext() {}
+  virtual ~SemanticSegmentationContext();
 
   //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
 public:
@@ -39,6 +46,24 @@ public:
   virtual const Settings_CPtr& get_settings() const = 0;
   virtual const SLAMState_Ptr& get_slam_state(const std::string& sceneID) = 0;
   virtual void mark_voxels(const std::string& sceneID, const Selection_CPtr& selection, const PackedLabels_CPtr& labels, MarkingMode mode) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the overlay image (if any) to render whilst inspecting the features of voxels in the specified scene.
+   *
+   * \param sceneID The ID of the scene whose features are being inspected.
+   * \return        The overlay image (if any) to render whilst inspecting the features of voxels in the scene.
+   */
+  virtual ITMUChar4Image_CPtr get_feature_inspection_image(const std::string& sceneID) const;
+
+  /**
+   * \brief Sets the overlay image (if any) to render whilst inspecting the features of voxels in the specified scene.
+   *
+   * \param sceneID                 The ID of the scene whose features are being inspected.
+   * \param featureInspectionImage  The overlay image (if any) to render whilst inspecting the features of voxels in the scene.
+   */
+  virtual void set_feature_inspection_image(const std::string& sceneID, const ITMUChar4Image_CPtr& featureInspectionImage);
 };
 
 //#################### TYPEDEFS ####################
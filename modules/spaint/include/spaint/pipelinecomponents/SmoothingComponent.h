@@ -6,13 +6,25 @@
 #ifndef H_SPAINT_SMOOTHINGCOMPONENT
 #define H_SPAINT_SMOOTHINGCOMPONENT
 
+#include <boost/optional.hpp>
+
+#include <tvgutil/timing/WorkBudgetController.h>
+
 #include "SmoothingContext.h"
 #include "../smoothing/interface/LabelSmoother.h"
+#include "../smoothing/interface/VoxelLabelSmoother.h"
 
 namespace spaint {
 
 /**
  * \brief An instance of this pipeline component can be used to smooth the labels in a scene to remove noise.
+ *
+ * By default, the labels are only smoothed in 2D, over the current raycast result. Optionally, they can also be smoothed
+ * in 3D, over the voxel graph of the blocks that have recently been relabelled (see VoxelLabelSmoother), so that labels
+ * in parts of the scene that are not currently visible are cleaned up as well.
+ *
+ * The component can also adapt the fraction of frames on which it smooths so as to hold the measured cost of smoothing
+ * near a target time (see timeTarget). The current rate is published as a profiler gauge.
  */
 class SmoothingComponent
 {
@@ -24,9 +36,15 @@ private:
   /** The label smoother. */
   LabelSmoother_CPtr m_labelSmoother;
 
+  /** The controller used to adapt the fraction of frames on which to smooth (if adaptive smoothing is enabled). */
+  boost::optional<tvgutil::WorkBudgetController> m_runRate;
+
   /** The ID of the scene on which the component should operate. */
   std::string m_sceneID;
 
+  /** The voxel label smoother used to smooth the labels in 3D (null if 3D smoothing is disabled). */
+  VoxelLabelSmoother_CPtr m_voxelLabelSmoother;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -0,0 +1,128 @@
+/**
+ * spaint: PointCloudExporter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_POINTCLOUDEXPORTER
+#define H_SPAINT_POINTCLOUDEXPORTER
+
+#include <string>
+
+#include <boost/thread.hpp>
+
+#include "interface/SurfacePointExtractor.h"
+#include "../util/LabelManager.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to export a labelled point cloud of the surface voxels of a scene to a columnar
+ *        binary file, for downstream analysis.
+ *
+ * The point cloud is extracted synchronously (this is a couple of passes over the resident voxel blocks on the device and a single
+ * copy to the host), and is then written to disk by a writer thread, so that the rest of the application is not stalled by the I/O.
+ *
+ * The file is laid out as follows (all values are stored in the native byte order of the machine that wrote the file):
+ *
+ * - An 8-byte signature ("SPAINTPC").
+ * - The file format version (a 32-bit unsigned integer).
+ * - A set of flags (a 32-bit unsigned integer, in which bit 0 is set iff the file has a confidence column).
+ * - The number of points, N (a 64-bit unsigned integer).
+ * - The size of a voxel in the scene, in m (a 32-bit float).
+ * - The number of semantic labels (a 32-bit unsigned integer), followed by the name of each label (as a 32-bit length and the characters of the name).
+ * - The columns, one after the other: positions in m (3N floats), confidences (N floats, if present), colours (3N bytes), labels (N bytes) and label groups (N bytes).
+ */
+class PointCloudExporter
+{
+  //#################### CONSTANTS ####################
+public:
+  /** The version of the file format written by the exporter. */
+  static const unsigned int FILE_FORMAT_VERSION = 1;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The point cloud that is being written (accessed only by the writer thread whilst the writer is running). */
+  SurfacePointCloud m_cloud;
+
+  /** The extractor used to extract the surface voxels of the scene. */
+  SurfacePointExtractor_CPtr m_extractor;
+
+  /** The label manager (if any) whose label names should be written to the file. */
+  LabelManager_CPtr m_labelManager;
+
+  /** The path to the file to which the point cloud is being written. */
+  std::string m_path;
+
+  /** The writer thread for the current export (if any). */
+  boost::thread m_writer;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a point cloud exporter.
+   *
+   * \param extractor               The extractor to use to extract the surface voxels of the scene.
+   * \param labelManager            The label manager (if any) whose label names should be written to the file.
+   * \throws std::invalid_argument  If the extractor is NULL.
+   */
+  PointCloudExporter(const SurfacePointExtractor_CPtr& extractor, const LabelManager_CPtr& labelManager);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the point cloud exporter, first waiting for any point cloud that is being written to be finished.
+   */
+  ~PointCloudExporter();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  PointCloudExporter(const PointCloudExporter&);
+  PointCloudExporter& operator=(const PointCloudExporter&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Waits for any point cloud that is being written to be finished.
+   */
+  void finish();
+
+  /**
+   * \brief Extracts a labelled point cloud of the surface voxels of the specified scene, and starts writing it to the specified file.
+   *
+   * If a previous point cloud is still being written, this first waits for it to be finished.
+   *
+   * \param path  The path to the file.
+   * \param scene The scene.
+   */
+  void start(const std::string& path, const SpaintVoxelScene *scene);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Runs the writer thread.
+   */
+  void run_writer();
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes a value to the specified stream.
+   *
+   * \param os    The stream.
+   * \param value The value.
+   */
+  template <typename T>
+  static void write_value(std::ostream& os, const T& value)
+  {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<PointCloudExporter> PointCloudExporter_Ptr;
+
+}
+
+#endif
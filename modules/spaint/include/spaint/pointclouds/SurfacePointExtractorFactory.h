@@ -0,0 +1,33 @@
+/**
+ * spaint: SurfacePointExtractorFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SURFACEPOINTEXTRACTORFACTORY
+#define H_SPAINT_SURFACEPOINTEXTRACTORFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/SurfacePointExtractor.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct surface point extractors.
+ */
+struct SurfacePointExtractorFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a surface point extractor.
+   *
+   * \param deviceType  The device on which the surface point extractor should operate.
+   * \return            The surface point extractor.
+   */
+  static SurfacePointExtractor_Ptr make_surface_point_extractor(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
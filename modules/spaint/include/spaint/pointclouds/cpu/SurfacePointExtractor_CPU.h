@@ -0,0 +1,32 @@
+/**
+ * spaint: SurfacePointExtractor_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SURFACEPOINTEXTRACTOR_CPU
+#define H_SPAINT_SURFACEPOINTEXTRACTOR_CPU
+
+#include "../interface/SurfacePointExtractor.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to extract a labelled point cloud of the surface voxels of a scene using the CPU.
+ */
+class SurfacePointExtractor_CPU : public SurfacePointExtractor
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual size_t count_surface_voxels(const SpaintVoxelScene *scene, int entryCount, float maxSDF) const;
+
+  /** Override */
+  virtual int find_resident_entries(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void write_surface_points(const SpaintVoxelScene *scene, int entryCount, float maxSDF, SurfacePointCloud& cloud) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * spaint: SurfacePointExtractor_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SURFACEPOINTEXTRACTOR_CUDA
+#define H_SPAINT_SURFACEPOINTEXTRACTOR_CUDA
+
+#include "../interface/SurfacePointExtractor.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to extract a labelled point cloud of the surface voxels of a scene using CUDA.
+ *
+ * The counting and writing kernels run one thread per voxel of each resident block. The writing kernel claims rows for the
+ * surface voxels a warp at a time (a single atomic per warp), and writes the columns into a device buffer that is laid out
+ * exactly as the host point cloud, so that the point cloud can be copied across to the host in one go.
+ */
+class SurfacePointExtractor_CUDA : public SurfacePointExtractor
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to store the column data of the point cloud on the device (this grows as necessary). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_columnsMB;
+
+  /** A memory block in which to store the number of hash entries or surface voxels found by the most recent kernel. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_countMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based surface point extractor.
+   */
+  SurfacePointExtractor_CUDA();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual size_t count_surface_voxels(const SpaintVoxelScene *scene, int entryCount, float maxSDF) const;
+
+  /** Override */
+  virtual int find_resident_entries(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void write_surface_points(const SpaintVoxelScene *scene, int entryCount, float maxSDF, SurfacePointCloud& cloud) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * spaint: SurfacePointExtractor.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SURFACEPOINTEXTRACTOR
+#define H_SPAINT_SURFACEPOINTEXTRACTOR
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this struct holds a point cloud of the surface voxels of a scene, with their colours and semantic labels, in columnar form.
+ *
+ * The columns are stored one after the other in a single buffer, in the order positions (3 floats per point), confidences
+ * (1 float per point, present only if the scene accumulates label evidence), colours (3 bytes per point), labels (1 byte
+ * per point) and label groups (1 byte per point). The float columns come first so that every column is naturally aligned.
+ * Row i of every column describes the same point.
+ */
+struct SurfacePointCloud
+{
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  /** The column data. */
+  std::vector<unsigned char> data;
+
+  /** Whether or not the point cloud has a confidence column. */
+  bool hasConfidences;
+
+  /** The number of points in the point cloud. */
+  size_t pointCount;
+
+  /** The size of a voxel in the scene from which the point cloud was extracted (in m). */
+  float voxelSize;
+
+  //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
+
+  SurfacePointCloud()
+  : hasConfidences(false), pointCount(0), voxelSize(0.0f)
+  {}
+
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Gets the offsets (in bytes) of the columns in the column data.
+   *
+   * \param positionsOffset   A location into which to write the offset of the position column.
+   * \param confidencesOffset A location into which to write the offset of the confidence column (equal to coloursOffset if absent).
+   * \param coloursOffset     A location into which to write the offset of the colour column.
+   * \param labelsOffset      A location into which to write the offset of the label column.
+   * \param groupsOffset      A location into which to write the offset of the label group column.
+   * \return                  The total size (in bytes) of the column data.
+   */
+  size_t get_column_offsets(size_t& positionsOffset, size_t& confidencesOffset, size_t& coloursOffset, size_t& labelsOffset, size_t& groupsOffset) const
+  {
+    positionsOffset = 0;
+    confidencesOffset = positionsOffset + pointCount * sizeof(Vector3f);
+    coloursOffset = confidencesOffset + (hasConfidences ? pointCount * sizeof(float) : 0);
+    labelsOffset = coloursOffset + pointCount * sizeof(Vector3u);
+    groupsOffset = labelsOffset + pointCount;
+    return groupsOffset + pointCount;
+  }
+};
+
+/**
+ * \brief An instance of a class deriving from this one can be used to extract a labelled point cloud of the surface voxels of a scene.
+ *
+ * A voxel is considered to be on the surface if it has been observed and lies within one voxel of the zero level set of the SDF.
+ * The extraction first compacts the IDs of the resident voxel blocks, then counts the surface voxels in them, and finally
+ * writes each surface voxel into its row of every column. On the GPU, the columns are written into a single device buffer
+ * laid out exactly as in SurfacePointCloud, so that the whole point cloud can be brought across to the host in a single copy.
+ */
+class SurfacePointExtractor
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct holds pointers to the columns of a point cloud.
+   */
+  struct Columns
+  {
+    /** The colour column. */
+    Vector3u *colours;
+
+    /** The confidence column (NULL if absent). */
+    float *confidences;
+
+    /** The label group column. */
+    uchar *groups;
+
+    /** The label column. */
+    uchar *labels;
+
+    /** The position column. */
+    Vector3f *positions;
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the IDs of the hash entries of the resident voxel blocks. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_entryIDsMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a surface point extractor.
+   */
+  SurfacePointExtractor();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the surface point extractor.
+   */
+  virtual ~SurfacePointExtractor();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Counts the surface voxels in the voxel blocks whose hash entry IDs are in m_entryIDsMB.
+   *
+   * \param scene       The scene.
+   * \param entryCount  The number of hash entry IDs in m_entryIDsMB.
+   * \param maxSDF      The maximum absolute (normalised) SDF value of a surface voxel.
+   * \return            The number of surface voxels.
+   */
+  virtual size_t count_surface_voxels(const SpaintVoxelScene *scene, int entryCount, float maxSDF) const = 0;
+
+  /**
+   * \brief Finds the hash entries of the voxel blocks in the scene that are currently resident, and writes their IDs into m_entryIDsMB.
+   *
+   * \param scene The scene.
+   * \return      The number of hash entries found.
+   */
+  virtual int find_resident_entries(const SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Writes the surface voxels in the voxel blocks whose hash entry IDs are in m_entryIDsMB into the columns of the specified point cloud.
+   *
+   * The point cloud's point count, confidence flag and column data will already have been set up to hold the points.
+   *
+   * \param scene       The scene.
+   * \param entryCount  The number of hash entry IDs in m_entryIDsMB.
+   * \param maxSDF      The maximum absolute (normalised) SDF value of a surface voxel.
+   * \param cloud       The point cloud.
+   */
+  virtual void write_surface_points(const SpaintVoxelScene *scene, int entryCount, float maxSDF, SurfacePointCloud& cloud) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Extracts a labelled point cloud of the surface voxels of the specified scene.
+   *
+   * Only the voxel blocks that are currently resident are considered.
+   *
+   * \param scene The scene.
+   * \param cloud The point cloud into which to write the surface voxels (its existing contents are replaced, but its buffer is reused).
+   */
+  void extract_surface_points(const SpaintVoxelScene *scene, SurfacePointCloud& cloud) const;
+
+  //#################### PROTECTED STATIC MEMBER FUNCTIONS ####################
+protected:
+  /**
+   * \brief Makes pointers to the columns of a point cloud whose column data is stored in the specified buffer.
+   *
+   * \param cloud   The point cloud (only its point count and confidence flag are used).
+   * \param buffer  The buffer.
+   * \return        Pointers to the columns of the point cloud in the buffer.
+   */
+  static Columns make_columns(const SurfacePointCloud& cloud, unsigned char *buffer);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<SurfacePointExtractor> SurfacePointExtractor_Ptr;
+typedef boost::shared_ptr<const SurfacePointExtractor> SurfacePointExtractor_CPtr;
+
+}
+
+#endif
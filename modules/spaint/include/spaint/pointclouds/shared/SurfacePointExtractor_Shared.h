@@ -0,0 +1,71 @@
+/**
+ * spaint: SurfacePointExtractor_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SURFACEPOINTEXTRACTOR_SHARED
+#define H_SPAINT_SURFACEPOINTEXTRACTOR_SHARED
+
+#include "../interface/SurfacePointExtractor.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Gets the position (in voxel coordinates) of the specified voxel in a voxel block.
+ *
+ * \param hashEntry The hash entry of the voxel block.
+ * \param linearIdx The index of the voxel within the block.
+ * \return          The position of the voxel.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector3i get_block_voxel_position(const ITMHashEntry& hashEntry, int linearIdx)
+{
+  return Vector3i(
+    hashEntry.pos.x * SDF_BLOCK_SIZE + linearIdx % SDF_BLOCK_SIZE,
+    hashEntry.pos.y * SDF_BLOCK_SIZE + (linearIdx / SDF_BLOCK_SIZE) % SDF_BLOCK_SIZE,
+    hashEntry.pos.z * SDF_BLOCK_SIZE + linearIdx / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE)
+  );
+}
+
+/**
+ * \brief Determines whether or not the specified voxel is on the surface.
+ *
+ * \param voxel   The voxel.
+ * \param maxSDF  The maximum absolute (normalised) SDF value of a surface voxel.
+ * \return        true, if the voxel has been observed and its absolute SDF value is at most maxSDF, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_surface_voxel(const SpaintVoxel& voxel, float maxSDF)
+{
+  return voxel.w_depth > 0 && fabs(SpaintVoxel::valueToFloat(voxel.sdf)) <= maxSDF;
+}
+
+/**
+ * \brief Writes a surface voxel into the specified row of the columns of a point cloud.
+ *
+ * \param row           The row into which to write the voxel.
+ * \param voxelAddress  The address of the voxel.
+ * \param pos           The position of the voxel (in voxel coordinates).
+ * \param voxelData     The scene's voxel data.
+ * \param labelData     The scene's label data (if any).
+ * \param evidenceData  The scene's label evidence data (if any).
+ * \param voxelSize     The size of a voxel (in m).
+ * \param columns       The columns of the point cloud.
+ */
+_CPU_AND_GPU_CODE_
+inline void write_surface_point(size_t row, int voxelAddress, const Vector3i& pos, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                const SpaintVoxel::LabelEvidence *evidenceData, float voxelSize, const SurfacePointExtractor::Columns& columns)
+{
+  const SpaintVoxel::PackedLabel packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+  columns.colours[row] = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxelData[voxelAddress]);
+  if(columns.confidences) columns.confidences[row] = evidenceData[voxelAddress].confidence();
+  columns.groups[row] = packedLabel.group;
+  columns.labels[row] = packedLabel.label;
+  columns.positions[row] = pos.toFloat() * voxelSize;
+}
+
+}
+
+#endif
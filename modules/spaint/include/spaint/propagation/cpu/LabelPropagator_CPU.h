@@ -24,14 +24,22 @@ public:
    * \param maxAngleBetweenNormals            The largest angle allowed between the normals of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if propagation is to occur.
+   * \param useFrontier                       Whether or not to process only the pixels on the frontier of the region being propagated.
    */
-  LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels);
+  LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                      bool useFrontier);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /** Override */
   virtual void calculate_normals(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const;
 
+  /** Override */
+  virtual int find_frontier(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void perform_frontier_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, int frontierSize, SpaintVoxelScene *scene) const;
+
   /** Override */
   virtual void perform_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, SpaintVoxelScene *scene) const;
 };
@@ -7,14 +7,26 @@
 #define H_SPAINT_LABELPROPAGATOR_CUDA
 
 #include "../interface/LabelPropagator.h"
+#include "../../util/cuda/ComponentStream_CUDA.h"
 
 namespace spaint {
 
 /**
  * \brief An instance of this class can be used to propagate a specified label across surfaces in the scene using CUDA.
+ *
+ * The propagation is done on a stream of the propagator's own (see ComponentStream_CUDA). Its first stage waits for the work
+ * already issued on the default stream, and its last stage makes the default stream wait for the labels to have been written.
  */
 class LabelPropagator_CUDA : public LabelPropagator
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block into which to write the number of pixels on the frontier (only used for frontier-based propagation). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_frontierSizeMB;
+
+  /** The stream on which to do the propagation. */
+  ComponentStream_CUDA m_stream;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -24,14 +36,22 @@ public:
    * \param maxAngleBetweenNormals            The largest angle allowed between the normals of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if propagation is to occur.
+   * \param useFrontier                       Whether or not to process only the pixels on the frontier of the region being propagated.
    */
-  LabelPropagator_CUDA(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels);
+  LabelPropagator_CUDA(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                       bool useFrontier);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /** Override */
   virtual void calculate_normals(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const;
 
+  /** Override */
+  virtual int find_frontier(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void perform_frontier_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, int frontierSize, SpaintVoxelScene *scene) const;
+
   /** Override */
   virtual void perform_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, SpaintVoxelScene *scene) const;
 };
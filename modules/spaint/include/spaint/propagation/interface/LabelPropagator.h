@@ -14,11 +14,22 @@ namespace spaint {
 
 /**
  * \brief An instance of a class deriving from this one can be used to propagate a specified label across surfaces in the scene.
+ *
+ * By default, every pixel in the raycast result is processed on every call. Alternatively, the propagator can first find
+ * the frontier of the region being propagated (the pixels that could actually be marked, given the labels of their
+ * neighbours), and then process only those. This makes the cost of each call scale with the perimeter of the region
+ * rather than with the image area, without changing which voxels get marked.
  */
 class LabelPropagator
 {
   //#################### PROTECTED VARIABLES ####################
 protected:
+  /** A memory block in which to store the indices of the pixels on the frontier of the region being propagated. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_frontierMB;
+
+  /** A memory block in which to store the label mask used to find the frontier (see PropagationMaskFlag). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_labelMaskMB;
+
   /** The largest angle allowed between the normals of neighbouring voxels if propagation is to occur. */
   const float m_maxAngleBetweenNormals;
 
@@ -31,6 +42,9 @@ protected:
   /** A memory block in which to store the surface normals of the voxels in the raycast result. */
   boost::shared_ptr<ORUtils::MemoryBlock<Vector3f> > m_surfaceNormalsMB;
 
+  /** Whether or not to process only the pixels on the frontier of the region being propagated. */
+  const bool m_useFrontier;
+
   //#################### CONSTRUCTORS ####################
 protected:
   /**
@@ -40,8 +54,10 @@ protected:
    * \param maxAngleBetweenNormals            The largest angle allowed between the normals of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if propagation is to occur.
+   * \param useFrontier                       Whether or not to process only the pixels on the frontier of the region being propagated.
    */
-  LabelPropagator(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels);
+  LabelPropagator(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                  bool useFrontier);
 
   //#################### DESTRUCTOR ####################
 public:
@@ -60,6 +76,28 @@ private:
    */
   virtual void calculate_normals(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const = 0;
 
+  /**
+   * \brief Finds the pixels in the raycast result that are on the frontier of the region being propagated, and writes their indices into m_frontierMB.
+   *
+   * \param label         The label being propagated.
+   * \param raycastResult The raycast result.
+   * \param scene         The scene.
+   * \return              The number of pixels on the frontier.
+   */
+  virtual int find_frontier(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Performs the propagation of the specified label to the pixels on the frontier in a device-specific way.
+   *
+   * The surface normals needed are computed on demand, rather than being read from m_surfaceNormalsMB.
+   *
+   * \param label         The label to propagate.
+   * \param raycastResult The raycast result.
+   * \param frontierSize  The number of pixels on the frontier (see find_frontier).
+   * \param scene         The scene.
+   */
+  virtual void perform_frontier_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, int frontierSize, SpaintVoxelScene *scene) const = 0;
+
   /**
    * \brief Performs the propagation of the specified label across the scene in a device-specific way.
    *
@@ -11,6 +11,36 @@
 
 namespace spaint {
 
+//#################### ENUMERATIONS ####################
+
+/**
+ * \brief The values of this enumeration are the flags that can be set in the label mask used for frontier-based propagation.
+ */
+enum PropagationMaskFlag
+{
+  /** The pixel's voxel could be marked with the label being propagated (i.e. marking it would change its label). */
+  PMF_CANDIDATE = 1,
+
+  /** The pixel's voxel already has the label being propagated, and so can act as a source for propagation. */
+  PMF_SOURCE = 2
+};
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Computes the surface normal at the specified point in the raycast result.
+ *
+ * \param loc       The point in the raycast result.
+ * \param voxelData The scene's voxel data.
+ * \param indexData The scene's index data.
+ * \return          The surface normal at the point, if the point is valid, or a zero vector otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector3f compute_surface_normal(const Vector4f& loc, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData)
+{
+  return loc.w > 0 ? computeSingleNormalFromSDF(voxelData, indexData, loc.toVector3()) : Vector3f(0.0f, 0.0f, 0.0f);
+}
+
 /**
  * \brief Determines whether or not the specified label should be propagated from a specified neighbouring voxel to the voxel of interest.
  *
@@ -23,8 +53,9 @@ namespace spaint {
  * \param normal                            The surface normal of the voxel of interest.
  * \param colour                            The RGB colour of the voxel of interest.
  * \param raycastResult                     The raycast result.
- * \param surfaceNormals                    The surface normals for the voxels in the raycast result.
+ * \param surfaceNormals                    The surface normals for the voxels in the raycast result (if NULL, they are computed on demand).
  * \param voxelData                         The scene's voxel data.
+ * \param labelData                         The scene's label data (if any).
  * \param indexData                         The scene's index data.
  * \param maxAngleBetweenNormals            The largest angle allowed between the normals of the neighbour and the voxel of interest if propagation is to occur.
  * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of the neighbour and the voxel of interest if propagation is to occur.
@@ -35,22 +66,24 @@ _CPU_AND_GPU_CODE_
 inline bool should_propagate_from_neighbour(int neighbourX, int neighbourY, int width, int height, SpaintVoxel::Label label,
                                             const Vector3f& loc, const Vector3f& normal, const Vector3u& colour,
                                             const Vector4f *raycastResult, const Vector3f *surfaceNormals,
-                                            const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                            float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours,
+                                            const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                            const ITMVoxelIndex::IndexData *indexData, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours,
                                             float maxSquaredDistanceBetweenVoxels)
 {
   // If the neighbour is outside the raycast result, early out.
   if(neighbourX < 0 || neighbourX >= width || neighbourY < 0 || neighbourY >= height) return false;
 
-  // Look up the position, normal and colour of the neighbouring voxel.
+  // Look up the neighbouring voxel. If it does not exist, or does not have the label being propagated, early out.
   int neighbourVoxelIndex = neighbourY * width + neighbourX;
   Vector3f neighbourLoc = raycastResult[neighbourVoxelIndex].toVector3();
 
   bool foundPoint;
-  const SpaintVoxel neighbourVoxel = readVoxel(voxelData, indexData, neighbourLoc.toIntRound(), foundPoint);
-  if(!foundPoint) return false;
+  const int neighbourVoxelAddress = findVoxel(indexData, neighbourLoc.toIntRound(), foundPoint);
+  if(!foundPoint || get_voxel_label(neighbourVoxelAddress, voxelData, labelData).label != label) return false;
 
-  Vector3f neighbourNormal = surfaceNormals[neighbourVoxelIndex];
+  // Look up the normal and colour of the neighbouring voxel.
+  const SpaintVoxel& neighbourVoxel = voxelData[neighbourVoxelAddress];
+  Vector3f neighbourNormal = surfaceNormals ? surfaceNormals[neighbourVoxelIndex] : compute_surface_normal(raycastResult[neighbourVoxelIndex], voxelData, indexData);
   Vector3u neighbourColour = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(neighbourVoxel);
 
   // Compute the angle between the neighbour's normal and the normal of the voxel of interest.
@@ -66,8 +99,7 @@ inline bool should_propagate_from_neighbour(int neighbourX, int neighbourY, int
   float distanceBetweenVoxels = sqrt(squaredDistanceBetweenVoxels);
 
   // Decide whether or not propagation should occur.
-  return neighbourVoxel.packedLabel.label == label &&
-         angleBetweenNormals <= maxAngleBetweenNormals * distanceBetweenVoxels &&
+  return angleBetweenNormals <= maxAngleBetweenNormals * distanceBetweenVoxels &&
          squaredDistanceBetweenColours <= maxSquaredDistanceBetweenColours * distanceBetweenVoxels &&
          squaredDistanceBetweenVoxels <= maxSquaredDistanceBetweenVoxels;
 }
@@ -80,23 +112,29 @@ inline bool should_propagate_from_neighbour(int neighbourX, int neighbourY, int
  * \param height                            The height of the raycast result.
  * \param label                             The label being propagated.
  * \param raycastResult                     The raycast result.
- * \param surfaceNormals                    The surface normals for the voxels in the raycast result.
+ * \param surfaceNormals                    The surface normals for the voxels in the raycast result (if NULL, they are computed on demand).
  * \param voxelData                         The scene's voxel data.
+ * \param labelData                         The scene's label data (if any).
  * \param indexData                         The scene's index data.
  * \param maxAngleBetweenNormals            The largest angle allowed between the normals of the neighbour and the voxel of interest if propagation is to occur.
  * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of the neighbour and the voxel of interest if propagation is to occur.
  * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of the neighbour and the voxel of interest if propagation is to occur.
+ * \param labelCounts                       The scene's voxel counts for each label (if any).
+ * \param labelPresence                     The scene's label presence masks (if any).
+ * \param blockVersions                     The scene's block versions (the label version of the voxel's block is stamped if its label changes).
+ * \param version                           The version of the scene with which to stamp the voxel's block.
  */
 _CPU_AND_GPU_CODE_
 inline void propagate_from_neighbours(int voxelIndex, int width, int height, SpaintVoxel::Label label,
                                       const Vector4f *raycastResult, const Vector3f *surfaceNormals,
-                                      SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                      float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours,
-                                      float maxSquaredDistanceBetweenVoxels)
+                                      SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData,
+                                      const ITMVoxelIndex::IndexData *indexData, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours,
+                                      float maxSquaredDistanceBetweenVoxels, unsigned int *labelCounts, unsigned int *labelPresence,
+                                      SpaintVoxelScene::BlockVersions *blockVersions, unsigned int version)
 {
   // Look up the position, normal and colour of the specified voxel.
   Vector3f loc = raycastResult[voxelIndex].toVector3();
-  Vector3f normal = surfaceNormals[voxelIndex];
+  Vector3f normal = surfaceNormals ? surfaceNormals[voxelIndex] : compute_surface_normal(raycastResult[voxelIndex], voxelData, indexData);
 
   bool foundPoint;
   const SpaintVoxel voxel = readVoxel(voxelData, indexData, loc.toIntRound(), foundPoint);
@@ -111,7 +149,7 @@ inline void propagate_from_neighbours(int voxelIndex, int width, int height, Spa
 
 #define SPFN(nx,ny) should_propagate_from_neighbour( \
   nx, ny, width, height, label, loc, normal, colour, \
-  raycastResult, surfaceNormals, voxelData, indexData, \
+  raycastResult, surfaceNormals, voxelData, labelData, indexData, \
   maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, \
   maxSquaredDistanceBetweenVoxels)
 
@@ -120,12 +158,81 @@ inline void propagate_from_neighbours(int voxelIndex, int width, int height, Spa
      (SPFN(x, y - 2) && SPFN(x, y - 5)) ||
      (SPFN(x, y + 2) && SPFN(x, y + 5)))
   {
-    mark_voxel(loc.toShortRound(), SpaintVoxel::PackedLabel(label, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, indexData);
+    mark_voxel(loc.toShortRound(), SpaintVoxel::PackedLabel(label, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, labelData, indexData, NORMAL_MARKING, labelCounts,
+              blockVersions, version, labelPresence);
   }
 
 #undef SPFN
 }
 
+/**
+ * \brief Determines whether or not the specified pixel in the raycast result is on the frontier of the region being propagated.
+ *
+ * A pixel is on the frontier if its voxel could be marked with the label being propagated, and there is at least one
+ * direction in which the voxels of both of the neighbours examined by propagate_from_neighbours already have the label.
+ * This is a necessary condition for propagation to mark the pixel's voxel, so only frontier pixels need to be processed.
+ *
+ * \param voxelIndex  The index of the pixel in the raycast result.
+ * \param width       The width of the raycast result.
+ * \param height      The height of the raycast result.
+ * \param labelMask   The label mask (see write_propagation_mask).
+ * \return            true, if the pixel is on the frontier, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_frontier_pixel(int voxelIndex, int width, int height, const unsigned char *labelMask)
+{
+  if((labelMask[voxelIndex] & PMF_CANDIDATE) == 0) return false;
+
+  int x = voxelIndex % width;
+  int y = voxelIndex / width;
+
+#define IS_SOURCE(nx,ny) ((nx) >= 0 && (nx) < width && (ny) >= 0 && (ny) < height && (labelMask[(ny) * width + (nx)] & PMF_SOURCE) != 0)
+
+  const bool result =
+    (IS_SOURCE(x - 2, y) && IS_SOURCE(x - 5, y)) ||
+    (IS_SOURCE(x + 2, y) && IS_SOURCE(x + 5, y)) ||
+    (IS_SOURCE(x, y - 2) && IS_SOURCE(x, y - 5)) ||
+    (IS_SOURCE(x, y + 2) && IS_SOURCE(x, y + 5));
+
+#undef IS_SOURCE
+
+  return result;
+}
+
+/**
+ * \brief Writes the entry for the specified pixel in the raycast result into the label mask used for frontier-based propagation.
+ *
+ * \param voxelIndex    The index of the pixel in the raycast result.
+ * \param label         The label being propagated.
+ * \param raycastResult The raycast result.
+ * \param voxelData     The scene's voxel data.
+ * \param labelData     The scene's label data (if any).
+ * \param indexData     The scene's index data.
+ * \param labelMask     The label mask.
+ */
+_CPU_AND_GPU_CODE_
+inline void write_propagation_mask(int voxelIndex, SpaintVoxel::Label label, const Vector4f *raycastResult,
+                                   const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                   const ITMVoxelIndex::IndexData *indexData, unsigned char *labelMask)
+{
+  unsigned char flags = 0;
+
+  // Note: Pixels that are not valid in the raycast result have a zero normal, so can never take part in propagation.
+  const Vector4f loc = raycastResult[voxelIndex];
+  bool foundPoint = false;
+  const int voxelAddress = loc.w > 0 ? findVoxel(indexData, loc.toVector3().toIntRound(), foundPoint) : -1;
+  if(foundPoint)
+  {
+    const SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+    if(packedLabel.label == label) flags |= PMF_SOURCE;
+
+    // Marking a voxel that already has the label only changes it if the existing label was predicted by the forest.
+    if(packedLabel.label != label || packedLabel.group == SpaintVoxel::LG_FOREST) flags |= PMF_CANDIDATE;
+  }
+
+  labelMask[voxelIndex] = flags;
+}
+
 /**
  * \brief Calculates the normal of the specified voxel in the raycast result and writes it into the surface normals array.
  *
@@ -138,17 +245,8 @@ inline void propagate_from_neighbours(int voxelIndex, int width, int height, Spa
 _CPU_AND_GPU_CODE_
 inline void write_surface_normal(int voxelIndex, const Vector4f *raycastResult, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData, Vector3f *surfaceNormals)
 {
-  Vector4f loc = raycastResult[voxelIndex];
-
   // If the voxel is valid, compute its actual surface normal; otherwise, use a default.
-  Vector3f n(0.0f, 0.0f, 0.0f);
-  if(loc.w > 0)
-  {
-    n = computeSingleNormalFromSDF(voxelData, indexData, loc.toVector3());
-  }
-
-  // Write the normal into the surface normals array.
-  surfaceNormals[voxelIndex] = n;
+  surfaceNormals[voxelIndex] = compute_surface_normal(raycastResult[voxelIndex], voxelData, indexData);
 }
 
 }
@@ -0,0 +1,38 @@
+/**
+ * spaint: DeviceRandomForestFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEVICERANDOMFORESTFACTORY
+#define H_SPAINT_DEVICERANDOMFORESTFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/DeviceRandomForest.h"
+
+namespace spaint {
+
+/**
+ * \brief This class can be used to construct device random forests.
+ */
+class DeviceRandomForestFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes a device random forest.
+   *
+   * \param treeCount     The number of trees in the forest.
+   * \param labelCount    The number of labels.
+   * \param featureCount  The number of features in each descriptor.
+   * \param settings      The settings for the forest.
+   * \param deviceType    The device on which the forest should operate.
+   * \return              The device random forest.
+   */
+  static DeviceRandomForest_Ptr make_device_random_forest(size_t treeCount, size_t labelCount, size_t featureCount, const DeviceRandomForest::Settings& settings,
+                                                          ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * spaint: ForestPredictorFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FORESTPREDICTORFACTORY
+#define H_SPAINT_FORESTPREDICTORFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/ForestPredictor.h"
+
+namespace spaint {
+
+/**
+ * \brief This class can be used to construct forest predictors.
+ */
+class ForestPredictorFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes a forest predictor.
+   *
+   * \param deviceType  The device on which the predictor should operate.
+   * \return            The forest predictor.
+   */
+  static ForestPredictor_Ptr make_forest_predictor(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -8,7 +8,7 @@
 
 #include <ORUtils/MemoryBlock.h>
 
-#include <rafl/examples/Example.h>
+#include <rafl/examples/ExampleMatrix.h>
 
 namespace spaint {
 
@@ -37,20 +37,20 @@ struct ForestUtil
    * segment i, the first descriptorCounts[i] (<= maxDescriptorsPerLabel) feature descriptors are valid and can be used to make
    * examples. Each feature descriptor in segment i is assigned label i when making examples.
    *
+   * Since the valid descriptors in each segment are contiguous, the examples for each label are copied into the example matrix
+   * in a single block, rather than being allocated one by one.
+   *
    * \param featuresMB              The InfiniTAM memory block containing the feature descriptors.
    * \param descriptorCountsMB      An InfiniTAM memory block containing the numbers of descriptors in each label segment that are valid.
    * \param featureCount            The number of features in a feature descriptor.
    * \param maxDescriptorsPerLabel  The number of descriptors that could potentially be stored in a label segment.
    * \param labelCount              The number of labels for which the memory block contains descriptors.
-   * \return                        The rafl examples.
+   * \return                        An example matrix containing the rafl examples.
    */
   template <typename Label>
-  static std::vector<boost::shared_ptr<const rafl::Example<Label> > > make_examples(const ORUtils::MemoryBlock<float>& featuresMB,
-                                                                                    const ORUtils::MemoryBlock<unsigned int>& descriptorCountsMB, 
-                                                                                    size_t featureCount, size_t maxDescriptorsPerLabel, size_t labelCount)
+  static rafl::ExampleMatrix<Label> make_examples(const ORUtils::MemoryBlock<float>& featuresMB, const ORUtils::MemoryBlock<unsigned int>& descriptorCountsMB,
+                                                  size_t featureCount, size_t maxDescriptorsPerLabel, size_t labelCount)
   {
-    typedef boost::shared_ptr<const rafl::Example<Label> > Example_CPtr;
-
     // Determine the number of examples we are trying to make (one per valid descriptor).
     descriptorCountsMB.UpdateHostFromDevice();
     const unsigned int *descriptorCounts = descriptorCountsMB.GetData(MEMORYDEVICE_CPU);
@@ -63,19 +63,16 @@ struct ForestUtil
     // Make the examples.
     featuresMB.UpdateHostFromDevice();
     const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
-    std::vector<Example_CPtr> examples(exampleCount);
-    size_t exampleIndex = 0;
+    rafl::ExampleMatrix<Label> examples(featureCount);
+    examples.reserve(exampleCount, featureCount);
     for(Label label = 0; label < static_cast<Label>(labelCount); ++label)
     {
-      for(size_t i = 0; i < descriptorCounts[label]; ++i)
-      {
-        // Copy the features for the example into a descriptor.
-        const float *featuresForExample = features + (label * maxDescriptorsPerLabel + i) * featureCount;
-        rafl::Descriptor_Ptr descriptor(new rafl::Descriptor(featuresForExample, featuresForExample + featureCount));
+      const size_t descriptorCount = descriptorCounts[label];
+      if(descriptorCount == 0) continue;
 
-        // Make the example and add it.
-        examples[exampleIndex++] = Example_CPtr(new rafl::Example<Label>(descriptor, label));
-      }
+      // Copy the features for all of the valid descriptors in the label's segment into the matrix at once.
+      const std::vector<Label> labels(descriptorCount, label);
+      examples.add_examples(features + label * maxDescriptorsPerLabel * featureCount, featureCount, &labels[0], descriptorCount);
     }
 
     return examples;
@@ -0,0 +1,39 @@
+/**
+ * spaint: TrainingReplayBufferFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TRAININGREPLAYBUFFERFACTORY
+#define H_SPAINT_TRAININGREPLAYBUFFERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/TrainingReplayBuffer.h"
+
+namespace spaint {
+
+/**
+ * \brief This class can be used to construct training replay buffers.
+ */
+class TrainingReplayBufferFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes a training replay buffer.
+   *
+   * \param maxLabelCount     The maximum number of labels that can be in use.
+   * \param capacityPerLabel  The number of slots in the buffer for each label.
+   * \param featureCount      The number of features in each descriptor.
+   * \param maxRefreshCount   The maximum number of descriptors to recalculate each time the buffer is refreshed.
+   * \param seed              The seed for the random number generator used to choose the slots to replace and draw.
+   * \param deviceType        The device on which the buffer should operate.
+   * \return                  The training replay buffer.
+   */
+  static TrainingReplayBuffer_Ptr make_training_replay_buffer(size_t maxLabelCount, size_t capacityPerLabel, size_t featureCount, size_t maxRefreshCount,
+                                                              unsigned int seed, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
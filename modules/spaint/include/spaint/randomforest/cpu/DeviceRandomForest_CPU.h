@@ -0,0 +1,56 @@
+/**
+ * spaint: DeviceRandomForest_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEVICERANDOMFOREST_CPU
+#define H_SPAINT_DEVICERANDOMFOREST_CPU
+
+#include "../interface/DeviceRandomForest.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class represents an online random forest that is trained and evaluated on the CPU.
+ */
+class DeviceRandomForest_CPU : public DeviceRandomForest
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based device random forest.
+   *
+   * \param treeCount               The number of trees in the forest.
+   * \param labelCount              The number of labels.
+   * \param featureCount            The number of features in each descriptor.
+   * \param settings                The settings for the forest.
+   * \throws std::invalid_argument  If any of the parameters are invalid.
+   */
+  DeviceRandomForest_CPU(size_t treeCount, size_t labelCount, size_t featureCount, const Settings& settings);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void add_examples_sub(const ORUtils::MemoryBlock<float>& featuresMB, const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB,
+                                size_t maxVoxelsPerLabel, unsigned int firstExampleID);
+
+  /** Override */
+  virtual void calculate_splittabilities();
+
+  /** Override */
+  virtual void predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                  ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const;
+
+  /** Override */
+  virtual void reset_trees();
+
+  /** Override */
+  virtual void split_leaves(int splitCount, unsigned int seed);
+
+  /** Override */
+  virtual void update_leaf_masses();
+};
+
+}
+
+#endif
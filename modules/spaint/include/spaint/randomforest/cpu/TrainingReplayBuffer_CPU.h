@@ -0,0 +1,43 @@
+/**
+ * spaint: TrainingReplayBuffer_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TRAININGREPLAYBUFFER_CPU
+#define H_SPAINT_TRAININGREPLAYBUFFER_CPU
+
+#include "../interface/TrainingReplayBuffer.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to keep a fixed-size buffer of labelled training examples for each label using the CPU.
+ */
+class TrainingReplayBuffer_CPU : public TrainingReplayBuffer
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based training replay buffer.
+   *
+   * \param maxLabelCount           The maximum number of labels that can be in use.
+   * \param capacityPerLabel        The number of slots in the buffer for each label.
+   * \param featureCount            The number of features in each descriptor.
+   * \param maxRefreshCount         The maximum number of descriptors to recalculate each time the buffer is refreshed.
+   * \param seed                    The seed for the random number generator used to choose the slots to replace and draw.
+   * \throws std::invalid_argument  If the capacity per label or the maximum refresh count is zero.
+   */
+  TrainingReplayBuffer_CPU(size_t maxLabelCount, size_t capacityPerLabel, size_t featureCount, size_t maxRefreshCount, unsigned int seed);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void check_slots(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void copy_feature_rows(const ORUtils::MemoryBlock<float>& srcFeaturesMB, int rowCount, ORUtils::MemoryBlock<float>& dstFeaturesMB) const;
+};
+
+}
+
+#endif
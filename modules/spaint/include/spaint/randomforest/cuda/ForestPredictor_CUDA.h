@@ -0,0 +1,27 @@
+/**
+ * spaint: ForestPredictor_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FORESTPREDICTOR_CUDA
+#define H_SPAINT_FORESTPREDICTOR_CUDA
+
+#include "../interface/ForestPredictor.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to predict voxel labels from feature descriptors using CUDA.
+ */
+class ForestPredictor_CUDA : public ForestPredictor
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                  ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,280 @@
+/**
+ * spaint: DeviceRandomForest.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEVICERANDOMFOREST
+#define H_SPAINT_DEVICERANDOMFOREST
+
+#include <boost/shared_ptr.hpp>
+
+#include <ORUtils/MemoryBlock.h>
+
+#include "../shared/DeviceRandomForest_Shared.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one represents an online random forest that is trained and evaluated entirely on a device.
+ *
+ * Unlike rafl::RandomForest, whose examples must be copied back to the host for training, the forest keeps all of its training state in
+ * memory blocks on the device on which it operates, and is trained directly from the memory blocks into which the feature calculator
+ * writes the training descriptors:
+ *
+ * - Training examples are copied into a fixed-size ring buffer (the example pool), and each example is given a unique ID.
+ * - Each node keeps a histogram of the labels of all of the examples it has seen, and a reservoir of the IDs of a random sample of them
+ *   (maintained using reservoir sampling). An ID whose example has since been overwritten in the pool is treated as an empty entry, so
+ *   the reservoirs effectively sample from the most recent examples only.
+ * - Each training step splits up to a given number of the most splittable leaves. Random candidate splits for all of them are generated and
+ *   evaluated over the leaves' reservoirs in parallel (one thread per candidate), and the best candidate for each leaf is used to split it if
+ *   its information gain is high enough. Only the splittabilities of the nodes are copied back to the host, to decide which leaves to split.
+ *
+ * The nodes and leaf PMFs are stored in the same layout as those of a forest uploaded to a ForestPredictor (each leaf's PMF is indexed by
+ * the leaf's own node index), so labels can be predicted directly from the trained forest.
+ *
+ * Note that the splits are single-feature threshold tests, and that threads adding examples to the same reservoir concurrently can race,
+ * so training is not deterministic.
+ */
+class DeviceRandomForest
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct can be used to provide the settings needed to configure a device random forest.
+   */
+  struct Settings
+  {
+    /** The number of candidate splits to consider when splitting a leaf. */
+    int candidateCount;
+
+    /** The minimum information gain required for a split to be acceptable. */
+    float gainThreshold;
+
+    /** The maximum number of nodes that each tree can contain. */
+    int maxNodesPerTree;
+
+    /** The maximum height allowed for a tree. */
+    int maxTreeHeight;
+
+    /** The number of examples that the example pool can hold (this must be at least the number of example slots passed to add_examples). */
+    int poolSize;
+
+    /** The maximum number of example IDs in each leaf's reservoir. */
+    int reservoirSize;
+
+    /** The seed for the random number generation. */
+    unsigned int seed;
+
+    /** The minimum number of examples that a leaf must have seen before it can be split. */
+    unsigned int seenExamplesThreshold;
+
+    /** A threshold splittability below which leaves should not be split (must be > 0). */
+    float splittabilityThreshold;
+
+    /** Whether or not to enable PMF reweighting to better handle a class imbalance in the training data. */
+    bool usePMFReweighting;
+
+    /**
+     * \brief Constructs a default set of device random forest settings.
+     */
+    Settings();
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the candidate splits for the leaves being split. */
+  boost::shared_ptr<ORUtils::MemoryBlock<DeviceForestSplitCandidate> > m_candidatesMB;
+
+  /** A memory block containing the numbers of examples of each label that have been seen by the forest. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_classCountsMB;
+
+  /** The number of features in each descriptor. */
+  int m_featureCount;
+
+  /** A memory block containing the histograms of the labels of the examples seen by each node. */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_histogramsMB;
+
+  /** The number of labels. */
+  int m_labelCount;
+
+  /** A memory block containing the masses of the leaf PMFs (the masses for node i are stored in [i * labelCount, (i + 1) * labelCount)). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_leafMassesMB;
+
+  /** A memory block containing the numbers of nodes in use in each tree. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_nodeCountsMB;
+
+  /** A memory block containing the depths of the nodes. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_nodeDepthsMB;
+
+  /** A memory block containing the nodes of all of the trees in the forest (the nodes of tree t are stored in [t * maxNodesPerTree, (t + 1) * maxNodesPerTree)). */
+  boost::shared_ptr<ORUtils::MemoryBlock<ForestPredictorNode> > m_nodesMB;
+
+  /** A memory block containing the IDs of the examples currently stored in each slot of the example pool (0 if a slot is empty). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_poolExampleIDsMB;
+
+  /** A memory block containing the features of the examples in the example pool. */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_poolFeaturesMB;
+
+  /** A memory block containing the labels of the examples in the example pool. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_poolLabelsMB;
+
+  /** A memory block containing the reservoirs of example IDs for each node (0 denotes an empty entry). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_reservoirsMB;
+
+  /** A memory block containing the indices of the roots of the trees in the node array. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_rootIndicesMB;
+
+  /** A memory block containing the numbers of examples that have been offered to the reservoir of each node. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_seenCountsMB;
+
+  /** The settings for the forest. */
+  Settings m_settings;
+
+  /** A memory block in which to store the indices of the leaves being split. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_splitLeavesMB;
+
+  /** A memory block in which to store the splittabilities of the nodes. */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_splittabilitiesMB;
+
+  /** The number of trees in the forest. */
+  int m_treeCount;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of examples that have been added to the forest since it was last reset. */
+  size_t m_exampleCount;
+
+  /** The ID to give the next example added to the forest (IDs are never reused, so reservoirs cannot refer to the wrong examples after a reset). */
+  unsigned int m_nextExampleID;
+
+  /** The number of training steps that have been run (used to vary the random numbers used for the splits). */
+  unsigned int m_trainingStepCount;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a device random forest.
+   *
+   * \param treeCount               The number of trees in the forest.
+   * \param labelCount              The number of labels.
+   * \param featureCount            The number of features in each descriptor.
+   * \param settings                The settings for the forest.
+   * \throws std::invalid_argument  If any of the parameters are invalid.
+   */
+  DeviceRandomForest(size_t treeCount, size_t labelCount, size_t featureCount, const Settings& settings);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the device random forest.
+   */
+  virtual ~DeviceRandomForest();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Adds the valid examples in the specified example slots to the forest.
+   *
+   * \param featuresMB        A memory block containing the feature descriptors of the examples.
+   * \param voxelCountsMB     A memory block containing the numbers of examples provided for each label.
+   * \param maxVoxelsPerLabel The maximum number of examples that can be provided for each label.
+   * \param firstExampleID    The ID to give the example in the first slot.
+   */
+  virtual void add_examples_sub(const ORUtils::MemoryBlock<float>& featuresMB, const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB,
+                                size_t maxVoxelsPerLabel, unsigned int firstExampleID) = 0;
+
+  /**
+   * \brief Calculates the splittabilities of the nodes, and makes them (and the node counts) available on the host.
+   */
+  virtual void calculate_splittabilities() = 0;
+
+  /**
+   * \brief Predicts labels for the specified feature descriptors.
+   *
+   * \param featuresMB      A memory block containing the feature descriptors, which are stored contiguously, one after the other.
+   * \param featureCount    The number of features in each descriptor.
+   * \param descriptorCount The number of descriptors.
+   * \param labelsMB        A memory block into which to write the labels predicted for the descriptors.
+   */
+  virtual void predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                  ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const = 0;
+
+  /**
+   * \brief Resets each tree of the forest to a single empty leaf, and clears the class counts.
+   */
+  virtual void reset_trees() = 0;
+
+  /**
+   * \brief Tries to split the leaves whose indices are stored on the host in the split leaves memory block, and makes the new node counts available on the host.
+   *
+   * \param splitCount  The number of leaves to try to split.
+   * \param seed        The seed to use to generate the candidate splits.
+   */
+  virtual void split_leaves(int splitCount, unsigned int seed) = 0;
+
+  /**
+   * \brief Updates the PMFs of the leaves of the forest from their histograms.
+   */
+  virtual void update_leaf_masses() = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds training examples to the forest.
+   *
+   * The examples are laid out as in ForestUtil::make_examples, i.e. the examples for label k are stored contiguously in the slots
+   * [k * maxVoxelsPerLabel, k * maxVoxelsPerLabel + voxelCounts[k]) of the features memory block. The features are read from the
+   * memory on the device on which the forest operates; the voxel counts must also be available on the host.
+   *
+   * \param featuresMB              A memory block containing the feature descriptors of the examples.
+   * \param featureCount            The number of features in each descriptor.
+   * \param voxelCountsMB           A memory block containing the numbers of examples provided for each label.
+   * \param maxVoxelsPerLabel       The maximum number of examples that can be provided for each label.
+   * \throws std::invalid_argument  If the descriptors are the wrong size, either memory block is too small, or the example pool cannot hold all of the slots.
+   */
+  void add_examples(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB, size_t maxVoxelsPerLabel);
+
+  /**
+   * \brief Gets whether or not any examples have been added to the forest since it was last reset.
+   *
+   * \return  true, if any examples have been added to the forest since it was last reset, or false otherwise.
+   */
+  bool has_examples() const;
+
+  /**
+   * \brief Predicts labels for the specified feature descriptors, writing them into the specified memory block.
+   *
+   * The descriptors are read from, and the labels written to, the memory on the device on which the forest operates.
+   * Note that the predictions are based on the leaf PMFs as of the end of the most recent training step.
+   *
+   * \param featuresMB              A memory block containing the feature descriptors, which are stored contiguously, one after the other.
+   * \param featureCount            The number of features in each descriptor.
+   * \param descriptorCount         The number of descriptors.
+   * \param labelsMB                A memory block into which to write the labels predicted for the descriptors.
+   * \throws std::invalid_argument  If the descriptors are too small to be evaluated by the forest, or either memory block is too small.
+   */
+  void predict_labels(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                      ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const;
+
+  /**
+   * \brief Resets the forest, discarding everything it has learnt.
+   */
+  void reset();
+
+  /**
+   * \brief Runs a single step of training on the forest, and then updates its leaf PMFs.
+   *
+   * \param splitBudget The maximum number of leaves to split.
+   * \return            The number of leaves that were actually split.
+   */
+  size_t train(size_t splitBudget);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<DeviceRandomForest> DeviceRandomForest_Ptr;
+typedef boost::shared_ptr<const DeviceRandomForest> DeviceRandomForest_CPtr;
+
+}
+
+#endif
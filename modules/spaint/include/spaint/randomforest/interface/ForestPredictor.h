@@ -0,0 +1,120 @@
+/**
+ * spaint: ForestPredictor.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FORESTPREDICTOR
+#define H_SPAINT_FORESTPREDICTOR
+
+#include <boost/shared_ptr.hpp>
+
+#include <ORUtils/MemoryBlock.h>
+
+#include <rafl/core/CompiledRandomForest.h>
+
+#include "../shared/ForestPredictor_Shared.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to predict voxel labels from feature descriptors
+ *        that are stored contiguously in a memory block, using a snapshot of a rafl random forest.
+ *
+ * The predictor works directly on the memory block into which the feature calculator writes the descriptors,
+ * and writes the predicted labels directly into a memory block on the same device, so no rafl descriptors need
+ * to be made and (on the GPU) no data needs to be transferred to or from the host.
+ */
+class ForestPredictor
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef rafl::CompiledRandomForest<SpaintVoxel::Label> CompiledForest;
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The number of labels for which masses are stored for each leaf of the forest. */
+  int m_labelCount;
+
+  /** A memory block containing the masses of the leaf PMFs of the forest. */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_leafMassesMB;
+
+  /** The number of features that a descriptor must have in order to be evaluated by the forest. */
+  size_t m_minDescriptorSize;
+
+  /** A memory block containing the nodes of all of the trees in the forest. */
+  boost::shared_ptr<ORUtils::MemoryBlock<ForestPredictorNode> > m_nodesMB;
+
+  /** A memory block containing the indices of the roots of the trees in the node array. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_rootIndicesMB;
+
+  /** The number of trees in the forest (or 0 if no forest has been uploaded yet). */
+  int m_treeCount;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a forest predictor.
+   */
+  ForestPredictor();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the forest predictor.
+   */
+  virtual ~ForestPredictor();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Predicts labels for the specified feature descriptors.
+   *
+   * \param featuresMB      A memory block containing the feature descriptors, which are stored contiguously, one after the other.
+   * \param featureCount    The number of features in each descriptor.
+   * \param descriptorCount The number of descriptors.
+   * \param labelsMB        A memory block into which to write the labels predicted for the descriptors.
+   */
+  virtual void predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                  ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets whether or not a forest has been uploaded to the predictor.
+   *
+   * \return  true, if a forest has been uploaded to the predictor, or false otherwise.
+   */
+  bool has_forest() const;
+
+  /**
+   * \brief Predicts labels for the specified feature descriptors, writing them into the specified memory block.
+   *
+   * The descriptors are read from, and the labels written to, the memory on the device on which the predictor operates.
+   *
+   * \param featuresMB              A memory block containing the feature descriptors, which are stored contiguously, one after the other.
+   * \param featureCount            The number of features in each descriptor.
+   * \param descriptorCount         The number of descriptors.
+   * \param labelsMB                A memory block into which to write the labels predicted for the descriptors.
+   * \throws std::runtime_error     If no forest has been uploaded to the predictor.
+   * \throws std::invalid_argument  If the descriptors are too small to be evaluated by the forest, or either memory block is too small.
+   */
+  void predict_labels(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                      ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const;
+
+  /**
+   * \brief Uploads a snapshot of a forest to the predictor, replacing any forest that was previously uploaded.
+   *
+   * \param forest                The compiled snapshot of the forest.
+   * \throws std::runtime_error   If the forest contains more than FORESTPREDICTOR_MAX_TREE_COUNT trees.
+   */
+  void update_forest(const CompiledForest& forest);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<ForestPredictor> ForestPredictor_Ptr;
+typedef boost::shared_ptr<const ForestPredictor> ForestPredictor_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * spaint: TrainingReplayBuffer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TRAININGREPLAYBUFFER
+#define H_SPAINT_TRAININGREPLAYBUFFER
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ORUtils/MemoryBlock.h>
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+
+#include "../../features/interface/FeatureCalculator.h"
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to keep a fixed-size buffer of labelled training examples
+ *        (feature descriptors and the voxels from which they were calculated) for each label on the device.
+ *
+ * Without a replay buffer, the forest is trained each training frame from voxels sampled from the current raycast, all of
+ * which must be featurised from scratch, and labels that are out of view contribute no examples at all. With one, a small
+ * number of newly-sampled voxels is added to the buffer each frame, and the training batch is drawn from the buffer, which
+ * gives a better balance between the labels, and needs far fewer feature descriptors to be calculated per frame.
+ *
+ * Each slot in the buffer records the version of the scene at which its descriptor was calculated. Before each draw, the
+ * slots whose voxels have been relabelled, or whose blocks are no longer resident, are evicted, and the descriptors of
+ * the slots whose blocks have been fused since then are recalculated (up to a per-frame budget, oldest first). Note that
+ * a descriptor also depends on the voxels in neighbouring blocks, so this only approximately tracks its validity.
+ *
+ * The descriptors are kept in a memory block on the device, and are only ever copied between memory blocks on the device.
+ * The bookkeeping for the slots (which is small) is done on the host.
+ */
+class TrainingReplayBuffer
+{
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the possible states of an occupied slot in the buffer.
+   */
+  enum SlotStatus
+  {
+    /** The voxel has been relabelled, or its block is no longer resident, so the slot must be evicted. */
+    SLOT_EVICTED,
+
+    /** The voxel's block has been fused since the descriptor was calculated, so the descriptor must be recalculated. */
+    SLOT_STALE,
+
+    /** The descriptor is up to date. */
+    SLOT_VALID
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The number of slots in the buffer for each label. */
+  const size_t m_capacityPerLabel;
+
+  /** A memory block containing the indices of the rows to which descriptors are being copied. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_dstRowsMB;
+
+  /** The number of features in each descriptor. */
+  const size_t m_featureCount;
+
+  /** A memory block containing the descriptors in the slots (grouped by label). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_featuresMB;
+
+  /** The maximum number of labels that can be in use. */
+  const size_t m_maxLabelCount;
+
+  /** A memory block containing the locations of the voxels in the slots (grouped by label). */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_slotLocationsMB;
+
+  /** A memory block into which to write the statuses of the slots when they are checked. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_slotStatusesMB;
+
+  /** A memory block containing the versions of the scene at which the descriptors in the slots were calculated. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_slotVersionsMB;
+
+  /** A memory block containing the indices of the rows from which descriptors are being copied. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_srcRowsMB;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The maximum number of descriptors to recalculate each time the buffer is refreshed. */
+  const size_t m_maxRefreshCount;
+
+  /** A memory block into which to write the recalculated descriptors. */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_refreshFeaturesMB;
+
+  /** A memory block containing the locations of the voxels whose descriptors are being recalculated. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_refreshLocationsMB;
+
+  /** The random number generator used to choose the slots to replace and draw. */
+  boost::shared_ptr<tvgutil::RandomNumberGenerator> m_rng;
+
+  /** The reset version of the scene when the buffer was last refreshed (any older slots refer to voxels that no longer exist). */
+  unsigned int m_sceneResetVersion;
+
+  /** The number of occupied slots for each label (the occupied slots for each label always precede the unoccupied ones). */
+  std::vector<size_t> m_slotCounts;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a training replay buffer.
+   *
+   * \param maxLabelCount           The maximum number of labels that can be in use.
+   * \param capacityPerLabel        The number of slots in the buffer for each label.
+   * \param featureCount            The number of features in each descriptor.
+   * \param maxRefreshCount         The maximum number of descriptors to recalculate each time the buffer is refreshed.
+   * \param seed                    The seed for the random number generator used to choose the slots to replace and draw.
+   * \throws std::invalid_argument  If the capacity per label or the maximum refresh count is zero.
+   */
+  TrainingReplayBuffer(size_t maxLabelCount, size_t capacityPerLabel, size_t featureCount, size_t maxRefreshCount, unsigned int seed);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the training replay buffer.
+   */
+  virtual ~TrainingReplayBuffer();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the status of every slot in the buffer into m_slotStatusesMB (the results for unoccupied slots are meaningless).
+   *
+   * The slot locations and versions must be up to date on the device, and the statuses must be left up to date on the host.
+   *
+   * \param scene The scene.
+   */
+  virtual void check_slots(const SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Copies rows of descriptors from one memory block to another, as specified by m_srcRowsMB and m_dstRowsMB.
+   *
+   * No row may be copied to more than once, and no row may be both copied from and copied to.
+   *
+   * \param srcFeaturesMB The memory block from which to copy the descriptors.
+   * \param rowCount      The number of rows to copy.
+   * \param dstFeaturesMB The memory block to which to copy the descriptors.
+   */
+  virtual void copy_feature_rows(const ORUtils::MemoryBlock<float>& srcFeaturesMB, int rowCount, ORUtils::MemoryBlock<float>& dstFeaturesMB) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Draws a balanced batch of training examples from the buffer.
+   *
+   * Up to the specified number of examples are drawn (without replacement) for each label that is in use. The examples
+   * are written in the layout produced by the per-label voxel sampler, i.e. grouped by label, with a fixed stride.
+   *
+   * \param labelMaskMB       A memory block containing a mask specifying which labels are currently in use.
+   * \param maxVoxelsPerLabel The maximum number of examples to draw for each label.
+   * \param featuresMB        A memory block into which to write the descriptors of the drawn examples.
+   * \param voxelCountsMB     A memory block into which to write the numbers of examples drawn for each label.
+   */
+  void draw(const ORUtils::MemoryBlock<bool>& labelMaskMB, size_t maxVoxelsPerLabel, ORUtils::MemoryBlock<float>& featuresMB,
+            ORUtils::MemoryBlock<unsigned int>& voxelCountsMB);
+
+  /**
+   * \brief Gets the number of occupied slots in the buffer for the specified label.
+   *
+   * \param label The label.
+   * \return      The number of occupied slots in the buffer for the label.
+   */
+  size_t get_slot_count(SpaintVoxel::Label label) const;
+
+  /**
+   * \brief Adds newly-sampled training examples to the buffer.
+   *
+   * The examples for each label are first put in any unoccupied slots, and then replace randomly-chosen occupied ones.
+   *
+   * \param voxelLocationsMB  A memory block containing the locations of the sampled voxels (grouped by label, with a fixed stride).
+   * \param featuresMB        A memory block containing the descriptors of the sampled voxels (in the same layout).
+   * \param voxelCountsMB     A memory block containing the numbers of voxels sampled for each label.
+   * \param maxVoxelsPerLabel The stride between the groups of examples for the different labels.
+   * \param scene             The scene from which the voxels were sampled.
+   */
+  void insert(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<float>& featuresMB,
+              const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB, size_t maxVoxelsPerLabel, const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Evicts the slots whose voxels have been relabelled or are no longer resident, and recalculates the descriptors
+   *        of (up to the refresh budget of) the slots whose voxels' blocks have been fused since their descriptors were calculated.
+   *
+   * \param scene             The scene.
+   * \param featureCalculator The feature calculator to use to recalculate the descriptors.
+   */
+  void refresh(const SpaintVoxelScene *scene, const FeatureCalculator& featureCalculator);
+
+  /**
+   * \brief Empties the buffer.
+   */
+  void reset();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Randomly chooses (without replacement) the specified number of the integers in [0,n), using a partial Fisher-Yates shuffle.
+   *
+   * \param n       The number of integers from which to choose.
+   * \param k       The number of integers to choose (must be at most n).
+   * \param order   A vector that is used as scratch space, and whose first k elements are the chosen integers on return.
+   */
+  void choose_without_replacement(size_t n, size_t k, std::vector<int>& order) const;
+
+  /**
+   * \brief Copies rows of descriptors from one memory block to another, as specified by the host copies of m_srcRowsMB and m_dstRowsMB.
+   *
+   * \param srcFeaturesMB The memory block from which to copy the descriptors.
+   * \param rowCount      The number of rows to copy.
+   * \param dstFeaturesMB The memory block to which to copy the descriptors.
+   */
+  void copy_rows(const ORUtils::MemoryBlock<float>& srcFeaturesMB, int rowCount, ORUtils::MemoryBlock<float>& dstFeaturesMB);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<TrainingReplayBuffer> TrainingReplayBuffer_Ptr;
+
+}
+
+#endif
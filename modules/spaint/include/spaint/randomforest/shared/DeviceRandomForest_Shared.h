@@ -0,0 +1,593 @@
+/**
+ * spaint: DeviceRandomForest_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEVICERANDOMFOREST_SHARED
+#define H_SPAINT_DEVICERANDOMFOREST_SHARED
+
+#include <cmath>
+
+#include "ForestPredictor_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of labels that a device random forest can handle. */
+enum { DEVICEFOREST_MAX_LABEL_COUNT = 32 };
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct represents a candidate split for a leaf of a device random forest.
+ */
+struct DeviceForestSplitCandidate
+{
+  /** The index of the feature tested by the candidate, or -1 if no candidate could be generated. */
+  int featureIndex;
+
+  /** The information gain achieved by splitting the leaf using the candidate. */
+  float gain;
+
+  /** The threshold against which the candidate compares the feature. */
+  float threshold;
+};
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Atomically adds a value to a float.
+ *
+ * \param target  The float to which to add the value.
+ * \param value   The value to add.
+ */
+_CPU_AND_GPU_CODE_
+inline void device_forest_atomic_add(float *target, float value)
+{
+#if defined(__CUDACC__) && defined(__CUDA_ARCH__)
+  atomicAdd(target, value);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp atomic
+  #endif
+  *target += value;
+#endif
+}
+
+/**
+ * \brief Atomically increments an unsigned integer.
+ *
+ * \param target  The unsigned integer to increment.
+ * \return        The value of the unsigned integer before it was incremented.
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned int device_forest_atomic_increment(unsigned int *target)
+{
+  unsigned int oldValue;
+
+#if defined(__CUDACC__) && defined(__CUDA_ARCH__)
+  oldValue = atomicAdd(target, 1);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp atomic capture
+  #endif
+  oldValue = (*target)++;
+#endif
+
+  return oldValue;
+}
+
+/**
+ * \brief Computes a pseudo-random number from a seed and a pair of counters.
+ *
+ * Since the number depends only on its inputs, threads can generate random numbers independently, without sharing any generator state.
+ *
+ * \param seed  The seed.
+ * \param a     The first counter.
+ * \param b     The second counter.
+ * \return      The pseudo-random number.
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned int device_forest_random(unsigned int seed, unsigned int a, unsigned int b)
+{
+  unsigned int h = seed ^ (a * 0x9E3779B9u) ^ (b * 0x85EBCA6Bu);
+  h ^= h >> 16;
+  h *= 0x7FEB352Du;
+  h ^= h >> 15;
+  h *= 0x846CA68Bu;
+  h ^= h >> 16;
+  return h;
+}
+
+/**
+ * \brief Calculates the weight with which examples of the specified label contribute to the PMFs of the forest.
+ *
+ * As in rafl::DecisionTree, if PMF reweighting is enabled, each label is weighted by the inverse of the fraction of all the
+ * examples seen by the forest that had that label, to better handle a class imbalance in the training data.
+ *
+ * \param label             The label.
+ * \param classCounts       The numbers of examples of each label that have been seen by the forest.
+ * \param labelCount        The number of labels.
+ * \param usePMFReweighting Whether or not PMF reweighting is enabled.
+ * \return                  The weight for the label.
+ */
+_CPU_AND_GPU_CODE_
+inline float calculate_class_weight(int label, const unsigned int *classCounts, int labelCount, bool usePMFReweighting)
+{
+  if(!usePMFReweighting) return 1.0f;
+  if(classCounts[label] == 0) return 0.0f;
+
+  unsigned int totalCount = 0;
+  for(int k = 0; k < labelCount; ++k) totalCount += classCounts[k];
+  return static_cast<float>(totalCount) / classCounts[label];
+}
+
+/**
+ * \brief Calculates the entropy (in bits) of the label distribution represented by a (pre-weighted) histogram.
+ *
+ * \param histogram   The weighted histogram.
+ * \param labelCount  The number of labels.
+ * \return            The entropy of the distribution, or 0 if the histogram is empty.
+ */
+_CPU_AND_GPU_CODE_
+inline float calculate_histogram_entropy(const float *histogram, int labelCount)
+{
+  float totalMass = 0.0f;
+  for(int k = 0; k < labelCount; ++k) totalMass += histogram[k];
+  if(totalMass <= 0.0f) return 0.0f;
+
+  float entropy = 0.0f;
+  for(int k = 0; k < labelCount; ++k)
+  {
+    // Note: If P(x_i) = 0, the value of the corresponding term is taken to be 0, since lim{p->0+} p*log2(p) = 0.
+    const float mass = histogram[k] / totalMass;
+    if(mass > 0.0f) entropy -= mass * log2f(mass);
+  }
+
+  return entropy;
+}
+
+/**
+ * \brief Gets the index of the slot in the example pool that holds the specified example, if it is still there.
+ *
+ * \param exampleID       The ID of the example (0 denotes an empty reservoir entry).
+ * \param poolExampleIDs  The IDs of the examples currently stored in each slot of the pool.
+ * \param poolSize        The number of slots in the pool.
+ * \return                The index of the slot that holds the example, or -1 if the example has since been overwritten.
+ */
+_CPU_AND_GPU_CODE_
+inline int get_pool_index(unsigned int exampleID, const unsigned int *poolExampleIDs, int poolSize)
+{
+  if(exampleID == 0) return -1;
+  const int poolIndex = static_cast<int>(exampleID % poolSize);
+  return poolExampleIDs[poolIndex] == exampleID ? poolIndex : -1;
+}
+
+/**
+ * \brief Adds a training example to a tree of a device random forest.
+ *
+ * Each thread handles a single (example slot, tree) pair. The examples are laid out as in ForestUtil::make_examples, i.e. the
+ * examples for label k are stored in the slots [k * maxVoxelsPerLabel, k * maxVoxelsPerLabel + voxelCounts[k]). The example
+ * is added to the histogram of the leaf that it reaches, and reservoir sampling is used to decide whether or not to add its
+ * ID to the leaf's reservoir.
+ *
+ * \param tid               The thread ID.
+ * \param features          The features of the examples, which are stored contiguously, one after the other.
+ * \param featureCount      The number of features in each descriptor.
+ * \param voxelCounts       The numbers of examples provided for each label.
+ * \param maxVoxelsPerLabel The maximum number of examples that can be provided for each label.
+ * \param firstExampleID    The ID of the example in the first slot (the IDs of the other examples follow consecutively).
+ * \param nodes             The nodes of all of the trees in the forest.
+ * \param rootIndices       The indices of the roots of the trees in the node array.
+ * \param treeCount         The number of trees in the forest.
+ * \param labelCount        The number of labels.
+ * \param reservoirSize     The capacity of the reservoir of each node.
+ * \param seed              The seed for the random number generation.
+ * \param classCounts       The numbers of examples of each label that have been seen by the forest.
+ * \param histograms        The histograms of the labels of the examples seen by each node.
+ * \param reservoirs        The reservoirs of example IDs for each node.
+ * \param seenCounts        The numbers of examples that have been offered to the reservoir of each node.
+ */
+_CPU_AND_GPU_CODE_
+inline void add_example_to_tree(int tid, const float *features, int featureCount, const unsigned int *voxelCounts, int maxVoxelsPerLabel, unsigned int firstExampleID,
+                                const ForestPredictorNode *nodes, const int *rootIndices, int treeCount, int labelCount, int reservoirSize, unsigned int seed,
+                                unsigned int *classCounts, float *histograms, unsigned int *reservoirs, unsigned int *seenCounts)
+{
+  const int slot = tid / treeCount, tree = tid % treeCount;
+  const int label = slot / maxVoxelsPerLabel;
+  if(static_cast<unsigned int>(slot % maxVoxelsPerLabel) >= voxelCounts[label]) return;
+
+  const unsigned int exampleID = firstExampleID + slot;
+  if(tree == 0) device_forest_atomic_increment(&classCounts[label]);
+
+  const int leafIndex = find_forest_leaf(features + slot * featureCount, nodes, rootIndices[tree]);
+  device_forest_atomic_add(&histograms[leafIndex * labelCount + label], 1.0f);
+
+  // Note: Threads that sample the same reservoir entry race to write it, but this just means that one of the examples is discarded at random.
+  const unsigned int seenCount = device_forest_atomic_increment(&seenCounts[leafIndex]);
+  const unsigned int entryIndex = seenCount < static_cast<unsigned int>(reservoirSize) ? seenCount : device_forest_random(seed, exampleID, tree) % (seenCount + 1);
+  if(entryIndex < static_cast<unsigned int>(reservoirSize)) reservoirs[leafIndex * reservoirSize + entryIndex] = exampleID;
+}
+
+/**
+ * \brief Calculates the splittability of a node of a device random forest.
+ *
+ * As in rafl::DecisionTree, the splittability of a leaf is the (weighted) entropy of its histogram, provided that it has seen enough
+ * examples and that splitting it would not make its tree too tall. The splittability of any other node is 0.
+ *
+ * \param nodeIndex             The index of the node.
+ * \param nodes                 The nodes of all of the trees in the forest.
+ * \param nodeCounts            The numbers of nodes in use in each tree.
+ * \param maxNodesPerTree       The maximum number of nodes in each tree.
+ * \param nodeDepths            The depths of the nodes.
+ * \param maxTreeHeight         The maximum height allowed for a tree.
+ * \param seenCounts            The numbers of examples that have been offered to the reservoir of each node.
+ * \param seenExamplesThreshold The number of examples that a node must have seen before it can be split.
+ * \param histograms            The histograms of the labels of the examples seen by each node.
+ * \param classCounts           The numbers of examples of each label that have been seen by the forest.
+ * \param labelCount            The number of labels.
+ * \param usePMFReweighting     Whether or not PMF reweighting is enabled.
+ * \param splittabilities       An array into which to write the splittabilities of the nodes.
+ */
+_CPU_AND_GPU_CODE_
+inline void calculate_splittability(int nodeIndex, const ForestPredictorNode *nodes, const int *nodeCounts, int maxNodesPerTree, const int *nodeDepths, int maxTreeHeight,
+                                    const unsigned int *seenCounts, unsigned int seenExamplesThreshold, const float *histograms, const unsigned int *classCounts,
+                                    int labelCount, bool usePMFReweighting, float *splittabilities)
+{
+  float splittability = 0.0f;
+
+  const bool inUse = nodeIndex % maxNodesPerTree < nodeCounts[nodeIndex / maxNodesPerTree];
+  if(inUse && nodes[nodeIndex].leafIndex != -1 && nodeDepths[nodeIndex] + 1 < maxTreeHeight && seenCounts[nodeIndex] >= seenExamplesThreshold)
+  {
+    float weightedHistogram[DEVICEFOREST_MAX_LABEL_COUNT];
+    for(int k = 0; k < labelCount; ++k)
+    {
+      weightedHistogram[k] = histograms[nodeIndex * labelCount + k] * calculate_class_weight(k, classCounts, labelCount, usePMFReweighting);
+    }
+    splittability = calculate_histogram_entropy(weightedHistogram, labelCount);
+  }
+
+  splittabilities[nodeIndex] = splittability;
+}
+
+/**
+ * \brief Copies a training example into the example pool of a device random forest.
+ *
+ * Each thread handles a single example slot (laid out as in add_example_to_tree). The example with ID i is stored in slot
+ * i % poolSize of the pool, replacing whichever example was there before. Invalid slots still clear their pool slots,
+ * so that the pool behaves as a ring buffer.
+ *
+ * \param tid               The thread ID.
+ * \param features          The features of the examples, which are stored contiguously, one after the other.
+ * \param featureCount      The number of features in each descriptor.
+ * \param voxelCounts       The numbers of examples provided for each label.
+ * \param maxVoxelsPerLabel The maximum number of examples that can be provided for each label.
+ * \param firstExampleID    The ID of the example in the first slot.
+ * \param poolSize          The number of slots in the pool.
+ * \param poolExampleIDs    The IDs of the examples currently stored in each slot of the pool.
+ * \param poolFeatures      The features of the examples in the pool.
+ * \param poolLabels        The labels of the examples in the pool.
+ */
+_CPU_AND_GPU_CODE_
+inline void copy_example_to_pool(int tid, const float *features, int featureCount, const unsigned int *voxelCounts, int maxVoxelsPerLabel, unsigned int firstExampleID,
+                                 int poolSize, unsigned int *poolExampleIDs, float *poolFeatures, int *poolLabels)
+{
+  const int label = tid / maxVoxelsPerLabel;
+  const bool valid = static_cast<unsigned int>(tid % maxVoxelsPerLabel) < voxelCounts[label];
+  const unsigned int exampleID = firstExampleID + tid;
+  const int poolIndex = static_cast<int>(exampleID % poolSize);
+
+  poolExampleIDs[poolIndex] = valid ? exampleID : 0;
+  if(!valid) return;
+
+  poolLabels[poolIndex] = label;
+
+  const float *src = features + tid * featureCount;
+  float *dest = poolFeatures + poolIndex * featureCount;
+  for(int i = 0; i < featureCount; ++i) dest[i] = src[i];
+}
+
+/**
+ * \brief Evaluates a candidate split for a leaf of a device random forest on the examples in the leaf's reservoir.
+ *
+ * Each thread evaluates a single candidate. The gain is the reduction in (weighted) entropy achieved by the split, or -1 if the
+ * candidate is invalid or would send all of the examples in the reservoir the same way.
+ *
+ * \param tid               The thread ID (the index of the candidate, with the candidates for each leaf stored contiguously).
+ * \param splitLeaves       The indices of the leaves to be split.
+ * \param candidateCount    The number of candidates for each leaf.
+ * \param reservoirs        The reservoirs of example IDs for each node.
+ * \param reservoirSize     The capacity of the reservoir of each node.
+ * \param poolExampleIDs    The IDs of the examples currently stored in each slot of the pool.
+ * \param poolFeatures      The features of the examples in the pool.
+ * \param poolLabels        The labels of the examples in the pool.
+ * \param poolSize          The number of slots in the pool.
+ * \param featureCount      The number of features in each descriptor.
+ * \param classCounts       The numbers of examples of each label that have been seen by the forest.
+ * \param labelCount        The number of labels.
+ * \param usePMFReweighting Whether or not PMF reweighting is enabled.
+ * \param candidates        The candidates (whose gains will be written).
+ */
+_CPU_AND_GPU_CODE_
+inline void evaluate_split_candidate(int tid, const int *splitLeaves, int candidateCount, const unsigned int *reservoirs, int reservoirSize,
+                                     const unsigned int *poolExampleIDs, const float *poolFeatures, const int *poolLabels, int poolSize, int featureCount,
+                                     const unsigned int *classCounts, int labelCount, bool usePMFReweighting, DeviceForestSplitCandidate *candidates)
+{
+  DeviceForestSplitCandidate& candidate = candidates[tid];
+  candidate.gain = -1.0f;
+  if(candidate.featureIndex == -1) return;
+
+  // Compute the histograms of the labels of the examples in the reservoir that the candidate would send left and right.
+  float leftHistogram[DEVICEFOREST_MAX_LABEL_COUNT], rightHistogram[DEVICEFOREST_MAX_LABEL_COUNT];
+  for(int k = 0; k < labelCount; ++k) leftHistogram[k] = rightHistogram[k] = 0.0f;
+
+  const unsigned int *reservoir = reservoirs + splitLeaves[tid / candidateCount] * reservoirSize;
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    const int poolIndex = get_pool_index(reservoir[i], poolExampleIDs, poolSize);
+    if(poolIndex == -1) continue;
+
+    const float value = poolFeatures[poolIndex * featureCount + candidate.featureIndex];
+    if(value < candidate.threshold) ++leftHistogram[poolLabels[poolIndex]];
+    else ++rightHistogram[poolLabels[poolIndex]];
+  }
+
+  // Weight the histograms, and compute the histogram of the leaf as a whole.
+  float parentHistogram[DEVICEFOREST_MAX_LABEL_COUNT];
+  float leftMass = 0.0f, rightMass = 0.0f;
+  for(int k = 0; k < labelCount; ++k)
+  {
+    const float weight = calculate_class_weight(k, classCounts, labelCount, usePMFReweighting);
+    leftHistogram[k] *= weight;
+    rightHistogram[k] *= weight;
+    parentHistogram[k] = leftHistogram[k] + rightHistogram[k];
+    leftMass += leftHistogram[k];
+    rightMass += rightHistogram[k];
+  }
+
+  if(leftMass <= 0.0f || rightMass <= 0.0f) return;
+
+  const float totalMass = leftMass + rightMass;
+  candidate.gain = calculate_histogram_entropy(parentHistogram, labelCount)
+                 - (leftMass / totalMass) * calculate_histogram_entropy(leftHistogram, labelCount)
+                 - (rightMass / totalMass) * calculate_histogram_entropy(rightHistogram, labelCount);
+}
+
+/**
+ * \brief Generates a candidate split for a leaf of a device random forest.
+ *
+ * Each thread generates a single candidate, which tests a random feature against the value of that feature for a random
+ * example in the leaf's reservoir (so that the thresholds follow the distribution of the data that reaches the leaf).
+ *
+ * \param tid             The thread ID (the index of the candidate, with the candidates for each leaf stored contiguously).
+ * \param splitLeaves     The indices of the leaves to be split.
+ * \param candidateCount  The number of candidates for each leaf.
+ * \param reservoirs      The reservoirs of example IDs for each node.
+ * \param reservoirSize   The capacity of the reservoir of each node.
+ * \param poolExampleIDs  The IDs of the examples currently stored in each slot of the pool.
+ * \param poolFeatures    The features of the examples in the pool.
+ * \param poolSize        The number of slots in the pool.
+ * \param featureCount    The number of features in each descriptor.
+ * \param seed            The seed for the random number generation (which should differ between training steps).
+ * \param candidates      An array into which to write the candidates.
+ */
+_CPU_AND_GPU_CODE_
+inline void generate_split_candidate(int tid, const int *splitLeaves, int candidateCount, const unsigned int *reservoirs, int reservoirSize,
+                                     const unsigned int *poolExampleIDs, const float *poolFeatures, int poolSize, int featureCount, unsigned int seed,
+                                     DeviceForestSplitCandidate *candidates)
+{
+  DeviceForestSplitCandidate& candidate = candidates[tid];
+  candidate.featureIndex = -1;
+  candidate.gain = -1.0f;
+  candidate.threshold = 0.0f;
+
+  // Pick a random entry in the leaf's reservoir, and search forwards from it (cyclically) for one whose example is still in the pool.
+  const unsigned int *reservoir = reservoirs + splitLeaves[tid / candidateCount] * reservoirSize;
+  const int startEntry = static_cast<int>(device_forest_random(seed, tid, 0) % reservoirSize);
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    const int poolIndex = get_pool_index(reservoir[(startEntry + i) % reservoirSize], poolExampleIDs, poolSize);
+    if(poolIndex == -1) continue;
+
+    candidate.featureIndex = static_cast<int>(device_forest_random(seed, tid, 1) % featureCount);
+    candidate.threshold = poolFeatures[poolIndex * featureCount + candidate.featureIndex];
+    break;
+  }
+}
+
+/**
+ * \brief Resets a tree of a device random forest so that it consists of a single, empty leaf.
+ *
+ * \param tree            The index of the tree.
+ * \param maxNodesPerTree The maximum number of nodes in each tree.
+ * \param labelCount      The number of labels.
+ * \param reservoirSize   The capacity of the reservoir of each node.
+ * \param histograms      The histograms of the labels of the examples seen by each node.
+ * \param nodeCounts      The numbers of nodes in use in each tree.
+ * \param nodeDepths      The depths of the nodes.
+ * \param nodes           The nodes of all of the trees in the forest.
+ * \param reservoirs      The reservoirs of example IDs for each node.
+ * \param rootIndices     The indices of the roots of the trees in the node array.
+ * \param seenCounts      The numbers of examples that have been offered to the reservoir of each node.
+ */
+_CPU_AND_GPU_CODE_
+inline void reset_tree(int tree, int maxNodesPerTree, int labelCount, int reservoirSize, float *histograms, int *nodeCounts, int *nodeDepths,
+                       ForestPredictorNode *nodes, unsigned int *reservoirs, int *rootIndices, unsigned int *seenCounts)
+{
+  // Note: The other nodes of the tree are fully initialised when they are allocated, so only the root needs to be reset here.
+  const int rootIndex = tree * maxNodesPerTree;
+  rootIndices[tree] = rootIndex;
+  nodeCounts[tree] = 1;
+
+  ForestPredictorNode& root = nodes[rootIndex];
+  root.firstFeatureIndex = root.secondFeatureIndex = 0;
+  root.leafIndex = rootIndex;
+  root.leftChildIndex = root.rightChildIndex = -1;
+  root.op = rafl::FlatDecisionFunction::FO_FIRST;
+  root.threshold = 0.0f;
+
+  nodeDepths[rootIndex] = 0;
+  seenCounts[rootIndex] = 0;
+  for(int k = 0; k < labelCount; ++k) histograms[rootIndex * labelCount + k] = 0.0f;
+  for(int i = 0; i < reservoirSize; ++i) reservoirs[rootIndex * reservoirSize + i] = 0;
+}
+
+/**
+ * \brief Splits a leaf of a device random forest using the best of its candidate splits, if that is good enough.
+ *
+ * Each thread handles a single leaf. If the leaf is split, two child leaves are allocated in its tree, and the examples in its reservoir
+ * are distributed between them. As in rafl::DecisionTree, the histograms of the children are estimated by scaling the numbers of examples
+ * of each label that they receive by the ratio between the number of examples of that label seen by the leaf and the number in its reservoir.
+ *
+ * \param tid             The thread ID (the index of the leaf in the list of leaves to be split).
+ * \param splitLeaves     The indices of the leaves to be split.
+ * \param candidates      The evaluated candidates for each leaf.
+ * \param candidateCount  The number of candidates for each leaf.
+ * \param gainThreshold   The minimum information gain required for a split to be acceptable.
+ * \param maxNodesPerTree The maximum number of nodes in each tree.
+ * \param labelCount      The number of labels.
+ * \param reservoirSize   The capacity of the reservoir of each node.
+ * \param poolExampleIDs  The IDs of the examples currently stored in each slot of the pool.
+ * \param poolFeatures    The features of the examples in the pool.
+ * \param poolLabels      The labels of the examples in the pool.
+ * \param poolSize        The number of slots in the pool.
+ * \param featureCount    The number of features in each descriptor.
+ * \param histograms      The histograms of the labels of the examples seen by each node.
+ * \param nodeCounts      The numbers of nodes in use in each tree.
+ * \param nodeDepths      The depths of the nodes.
+ * \param nodes           The nodes of all of the trees in the forest.
+ * \param reservoirs      The reservoirs of example IDs for each node.
+ * \param seenCounts      The numbers of examples that have been offered to the reservoir of each node.
+ */
+_CPU_AND_GPU_CODE_
+inline void split_leaf(int tid, const int *splitLeaves, const DeviceForestSplitCandidate *candidates, int candidateCount, float gainThreshold, int maxNodesPerTree,
+                       int labelCount, int reservoirSize, const unsigned int *poolExampleIDs, const float *poolFeatures, const int *poolLabels, int poolSize,
+                       int featureCount, float *histograms, int *nodeCounts, int *nodeDepths, ForestPredictorNode *nodes, unsigned int *reservoirs,
+                       unsigned int *seenCounts)
+{
+  // Find the best candidate for the leaf (the first such candidate in the event of a tie). If it isn't good enough, early out.
+  const DeviceForestSplitCandidate *leafCandidates = candidates + tid * candidateCount;
+  int bestCandidate = 0;
+  for(int i = 1; i < candidateCount; ++i)
+  {
+    if(leafCandidates[i].gain > leafCandidates[bestCandidate].gain) bestCandidate = i;
+  }
+
+  const DeviceForestSplitCandidate& split = leafCandidates[bestCandidate];
+  if(split.featureIndex == -1 || split.gain < 0.0f || split.gain < gainThreshold) return;
+
+  // Allocate the children in the leaf's tree. Note that the caller guarantees that there is room for them.
+  const int leafIndex = splitLeaves[tid];
+  const int tree = leafIndex / maxNodesPerTree;
+  int childOffset;
+#if defined(__CUDACC__) && defined(__CUDA_ARCH__)
+  childOffset = atomicAdd(&nodeCounts[tree], 2);
+#else
+  #ifdef WITH_OPENMP
+    #pragma omp atomic capture
+  #endif
+  { childOffset = nodeCounts[tree]; nodeCounts[tree] += 2; }
+#endif
+
+  const int childIndices[] = { tree * maxNodesPerTree + childOffset, tree * maxNodesPerTree + childOffset + 1 };
+
+  // Compute the per-label ratios between the numbers of examples seen by the leaf and the numbers in its reservoir.
+  const unsigned int *reservoir = reservoirs + leafIndex * reservoirSize;
+  float multipliers[DEVICEFOREST_MAX_LABEL_COUNT];
+  for(int k = 0; k < labelCount; ++k) multipliers[k] = 0.0f;
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    const int poolIndex = get_pool_index(reservoir[i], poolExampleIDs, poolSize);
+    if(poolIndex != -1) ++multipliers[poolLabels[poolIndex]];
+  }
+
+  for(int k = 0; k < labelCount; ++k)
+  {
+    if(multipliers[k] > 0.0f) multipliers[k] = histograms[leafIndex * labelCount + k] / multipliers[k];
+  }
+
+  // Initialise the children.
+  for(int j = 0; j < 2; ++j)
+  {
+    const int childIndex = childIndices[j];
+    ForestPredictorNode& child = nodes[childIndex];
+    child.firstFeatureIndex = child.secondFeatureIndex = 0;
+    child.leafIndex = childIndex;
+    child.leftChildIndex = child.rightChildIndex = -1;
+    child.op = rafl::FlatDecisionFunction::FO_FIRST;
+    child.threshold = 0.0f;
+
+    nodeDepths[childIndex] = nodeDepths[leafIndex] + 1;
+    seenCounts[childIndex] = 0;
+    for(int k = 0; k < labelCount; ++k) histograms[childIndex * labelCount + k] = 0.0f;
+  }
+
+  // Distribute the examples in the leaf's reservoir between the children. Since each child can receive at most all of the
+  // examples, their reservoirs cannot overflow. Note that the children's seen counts are deliberately set to the numbers
+  // of examples they receive (rather than the estimated numbers seen), so that their reservoirs stay open to new examples.
+  for(int i = 0; i < reservoirSize; ++i)
+  {
+    const int poolIndex = get_pool_index(reservoir[i], poolExampleIDs, poolSize);
+    if(poolIndex == -1) continue;
+
+    const int label = poolLabels[poolIndex];
+    const int childIndex = childIndices[poolFeatures[poolIndex * featureCount + split.featureIndex] < split.threshold ? 0 : 1];
+    reservoirs[childIndex * reservoirSize + seenCounts[childIndex]++] = reservoir[i];
+    histograms[childIndex * labelCount + label] += multipliers[label];
+  }
+
+  for(int j = 0; j < 2; ++j)
+  {
+    const int childIndex = childIndices[j];
+    for(int i = static_cast<int>(seenCounts[childIndex]); i < reservoirSize; ++i) reservoirs[childIndex * reservoirSize + i] = 0;
+  }
+
+  // Finally, turn the leaf into a branch node.
+  ForestPredictorNode& node = nodes[leafIndex];
+  node.firstFeatureIndex = split.featureIndex;
+  node.leafIndex = -1;
+  node.leftChildIndex = childIndices[0];
+  node.op = rafl::FlatDecisionFunction::FO_FIRST;
+  node.rightChildIndex = childIndices[1];
+  node.threshold = split.threshold;
+}
+
+/**
+ * \brief Updates the PMF of a leaf of a device random forest from its histogram.
+ *
+ * \param nodeIndex         The index of the node (nothing is done if it is not a leaf that is in use).
+ * \param nodes             The nodes of all of the trees in the forest.
+ * \param nodeCounts        The numbers of nodes in use in each tree.
+ * \param maxNodesPerTree   The maximum number of nodes in each tree.
+ * \param histograms        The histograms of the labels of the examples seen by each node.
+ * \param classCounts       The numbers of examples of each label that have been seen by the forest.
+ * \param labelCount        The number of labels.
+ * \param usePMFReweighting Whether or not PMF reweighting is enabled.
+ * \param leafMasses        The masses of the leaf PMFs.
+ */
+_CPU_AND_GPU_CODE_
+inline void update_leaf_pmf(int nodeIndex, const ForestPredictorNode *nodes, const int *nodeCounts, int maxNodesPerTree, const float *histograms,
+                            const unsigned int *classCounts, int labelCount, bool usePMFReweighting, float *leafMasses)
+{
+  if(nodeIndex % maxNodesPerTree >= nodeCounts[nodeIndex / maxNodesPerTree] || nodes[nodeIndex].leafIndex == -1) return;
+
+  const float *histogram = histograms + nodeIndex * labelCount;
+  float *masses = leafMasses + nodeIndex * labelCount;
+
+  float totalMass = 0.0f;
+  for(int k = 0; k < labelCount; ++k)
+  {
+    masses[k] = histogram[k] * calculate_class_weight(k, classCounts, labelCount, usePMFReweighting);
+    totalMass += masses[k];
+  }
+
+  if(totalMass > 0.0f)
+  {
+    for(int k = 0; k < labelCount; ++k) masses[k] /= totalMass;
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * spaint: ForestPredictor_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FORESTPREDICTOR_SHARED
+#define H_SPAINT_FORESTPREDICTOR_SHARED
+
+#include <rafl/decisionfunctions/FlatDecisionFunction.h>
+
+#include "../../util/SpaintVoxel.h"
+
+namespace spaint {
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of trees that a forest used by a forest predictor can contain. */
+enum { FORESTPREDICTOR_MAX_TREE_COUNT = 16 };
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct represents a node of a forest that has been uploaded to a forest predictor.
+ */
+struct ForestPredictorNode
+{
+  /** The index of the first feature tested by the node's decision function. */
+  int firstFeatureIndex;
+
+  /** The index of the node's leaf PMF in the leaf masses array, if the node is a leaf, or -1 otherwise. */
+  int leafIndex;
+
+  /** The index of the node's left child in the node array, or -1 if the node is a leaf. */
+  int leftChildIndex;
+
+  /** The way in which the node's decision function computes the value to compare to the threshold. */
+  rafl::FlatDecisionFunction::Op op;
+
+  /** The index of the node's right child in the node array, or -1 if the node is a leaf. */
+  int rightChildIndex;
+
+  /** The index of the second feature tested by the node's decision function (unused if op is FO_FIRST). */
+  int secondFeatureIndex;
+
+  /** The threshold against which the node's decision function compares its value. */
+  float threshold;
+};
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Finds the leaf of a tree that the specified feature descriptor reaches.
+ *
+ * \param descriptor  The features of the descriptor.
+ * \param nodes       The nodes of all of the trees in the forest.
+ * \param rootIndex   The index of the tree's root in the node array.
+ * \return            The index of the leaf's PMF in the leaf masses array.
+ */
+_CPU_AND_GPU_CODE_
+inline int find_forest_leaf(const float *descriptor, const ForestPredictorNode *nodes, int rootIndex)
+{
+  const ForestPredictorNode *node = &nodes[rootIndex];
+  while(node->leafIndex == -1)
+  {
+    float value = descriptor[node->firstFeatureIndex];
+    if(node->op == rafl::FlatDecisionFunction::FO_ADD) value += descriptor[node->secondFeatureIndex];
+    else if(node->op == rafl::FlatDecisionFunction::FO_SUBTRACT) value -= descriptor[node->secondFeatureIndex];
+    node = &nodes[value < node->threshold ? node->leftChildIndex : node->rightChildIndex];
+  }
+  return node->leafIndex;
+}
+
+/**
+ * \brief Calculates the probability that a forest assigns to the specified label for a feature descriptor.
+ *
+ * As in rafl::RandomForest::calculate_pmf, the masses from the PMFs of the leaves reached in the individual trees
+ * are summed and then normalised. If none of the leaves reached contains any mass, the probability is zero.
+ *
+ * \param descriptor  The features of the descriptor.
+ * \param nodes       The nodes of all of the trees in the forest.
+ * \param rootIndices The indices of the roots of the trees in the node array.
+ * \param treeCount   The number of trees in the forest.
+ * \param leafMasses  The masses of the leaf PMFs (the masses for leaf i are stored in [i * labelCount, (i + 1) * labelCount)).
+ * \param labelCount  The number of labels for which masses are stored for each leaf.
+ * \param label       The label whose probability is wanted.
+ * \return            The probability of the label.
+ */
+_CPU_AND_GPU_CODE_
+inline float calculate_label_probability(const float *descriptor, const ForestPredictorNode *nodes, const int *rootIndices, int treeCount,
+                                         const float *leafMasses, int labelCount, int label)
+{
+  float labelMass = 0.0f, totalMass = 0.0f;
+  for(int i = 0; i < treeCount; ++i)
+  {
+    const float *masses = leafMasses + find_forest_leaf(descriptor, nodes, rootIndices[i]) * labelCount;
+    for(int k = 0; k < labelCount; ++k) totalMass += masses[k];
+    if(label < labelCount) labelMass += masses[label];
+  }
+  return totalMass > 0.0f ? labelMass / totalMass : 0.0f;
+}
+
+/**
+ * \brief Predicts a label for the specified feature descriptor.
+ *
+ * Each thread predicts the label for a single descriptor. The masses from the PMFs of the leaves reached in the
+ * individual trees are summed in tree order, and the label with the largest summed mass is chosen (the smallest
+ * such label in the event of a tie), exactly as in rafl::CompiledRandomForest.
+ *
+ * \param tid               The thread ID (the index of the descriptor for which to predict a label).
+ * \param features          The features of the descriptors, which are stored contiguously, one after the other.
+ * \param featureCount      The number of features in each descriptor.
+ * \param nodes             The nodes of all of the trees in the forest.
+ * \param rootIndices       The indices of the roots of the trees in the node array.
+ * \param treeCount         The number of trees in the forest (at most FORESTPREDICTOR_MAX_TREE_COUNT).
+ * \param leafMasses        The masses of the leaf PMFs (the masses for leaf i are stored in [i * labelCount, (i + 1) * labelCount)).
+ * \param labelCount        The number of labels for which masses are stored for each leaf.
+ * \param labels            An array into which to write the labels predicted for the descriptors.
+ */
+_CPU_AND_GPU_CODE_
+inline void predict_label(int tid, const float *features, int featureCount, const ForestPredictorNode *nodes, const int *rootIndices, int treeCount,
+                          const float *leafMasses, int labelCount, SpaintVoxel::PackedLabel *labels)
+{
+  const float *descriptor = features + tid * featureCount;
+
+  // Find the leaf reached by the descriptor in each tree.
+  int leafIndices[FORESTPREDICTOR_MAX_TREE_COUNT];
+  for(int i = 0; i < treeCount; ++i)
+  {
+    leafIndices[i] = find_forest_leaf(descriptor, nodes, rootIndices[i]);
+  }
+
+  // Find the label with the largest summed mass over the leaves.
+  int bestLabel = 0;
+  float bestMass = -1.0f;
+  for(int k = 0; k < labelCount; ++k)
+  {
+    float mass = 0.0f;
+    for(int i = 0; i < treeCount; ++i)
+    {
+      mass += leafMasses[leafIndices[i] * labelCount + k];
+    }
+
+    if(mass > bestMass)
+    {
+      bestLabel = k;
+      bestMass = mass;
+    }
+  }
+
+  labels[tid] = SpaintVoxel::PackedLabel(static_cast<SpaintVoxel::Label>(bestLabel), SpaintVoxel::LG_FOREST);
+}
+
+}
+
+#endif
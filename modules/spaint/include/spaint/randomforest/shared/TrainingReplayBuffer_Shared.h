@@ -0,0 +1,73 @@
+/**
+ * spaint: TrainingReplayBuffer_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TRAININGREPLAYBUFFER_SHARED
+#define H_SPAINT_TRAININGREPLAYBUFFER_SHARED
+
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+
+#include "../interface/TrainingReplayBuffer.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Checks whether the descriptor in the specified slot of a training replay buffer is still valid.
+ *
+ * As with the per-label voxel sampler, voxels whose labels were predicted by the forest are not used as examples.
+ *
+ * \param slotIndex         The index of the slot.
+ * \param capacityPerLabel  The number of slots in the buffer for each label.
+ * \param slotLocations     The locations of the voxels in the slots.
+ * \param slotVersions      The versions of the scene at which the descriptors in the slots were calculated.
+ * \param voxelData         The scene's voxel data.
+ * \param labelData         The scene's label data (if any).
+ * \param indexData         The scene's index data.
+ * \param blockVersions     The versions of the scene's voxel blocks.
+ * \param slotStatuses      An array into which to write the statuses of the slots.
+ */
+_CPU_AND_GPU_CODE_
+inline void check_replay_slot(int slotIndex, int capacityPerLabel, const Vector3s *slotLocations, const unsigned int *slotVersions,
+                              const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                              const SpaintVoxelScene::BlockVersions *blockVersions, unsigned char *slotStatuses)
+{
+  bool isFound;
+  const int voxelAddress = findVoxel(indexData, slotLocations[slotIndex].toInt(), isFound);
+
+  unsigned char status = TrainingReplayBuffer::SLOT_EVICTED;
+  if(isFound)
+  {
+    const SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+    if(packedLabel.label == slotIndex / capacityPerLabel && packedLabel.group != SpaintVoxel::LG_FOREST)
+    {
+      const bool stale = blockVersions[voxelAddress / SDF_BLOCK_SIZE3].geometry > slotVersions[slotIndex];
+      status = stale ? TrainingReplayBuffer::SLOT_STALE : TrainingReplayBuffer::SLOT_VALID;
+    }
+  }
+
+  slotStatuses[slotIndex] = status;
+}
+
+/**
+ * \brief Copies a feature from one row of descriptors to another.
+ *
+ * \param i             The index of the feature within the rows being copied (the threads copy consecutive features of the same row).
+ * \param featureCount  The number of features in each descriptor.
+ * \param srcFeatures   The descriptors from which to copy.
+ * \param srcRows       The indices of the rows from which to copy.
+ * \param dstRows       The indices of the rows to which to copy.
+ * \param dstFeatures   The descriptors to which to copy.
+ */
+_CPU_AND_GPU_CODE_
+inline void copy_feature(int i, int featureCount, const float *srcFeatures, const int *srcRows, const int *dstRows, float *dstFeatures)
+{
+  const int row = i / featureCount, feature = i % featureCount;
+  dstFeatures[dstRows[row] * featureCount + feature] = srcFeatures[srcRows[row] * featureCount + feature];
+}
+
+}
+
+#endif
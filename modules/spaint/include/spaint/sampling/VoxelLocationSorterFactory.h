@@ -0,0 +1,34 @@
+/**
+ * spaint: VoxelLocationSorterFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELLOCATIONSORTERFACTORY
+#define H_SPAINT_VOXELLOCATIONSORTERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/VoxelLocationSorter.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct voxel location sorters.
+ */
+struct VoxelLocationSorterFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a voxel location sorter.
+   *
+   * \param maxVoxelCount The maximum number of voxel locations that can be sorted at once.
+   * \param deviceType    The device on which the voxel location sorter should operate.
+   * \return              The voxel location sorter.
+   */
+  static VoxelLocationSorter_Ptr make_voxel_location_sorter(size_t maxVoxelCount, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
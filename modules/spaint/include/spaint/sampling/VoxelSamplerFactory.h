@@ -9,7 +9,10 @@
 #include <ITMLib/Utils/ITMLibSettings.h>
 
 #include "interface/PerLabelVoxelSampler.h"
+#include "interface/StratifiedVoxelSampler.h"
+#include "interface/SweepingVoxelSampler.h"
 #include "interface/UniformVoxelSampler.h"
+#include "interface/VisibleBlockVoxelSampler.h"
 
 namespace spaint {
 
@@ -33,6 +36,31 @@ public:
   static PerLabelVoxelSampler_CPtr make_per_label_sampler(size_t maxLabelCount, size_t maxVoxelsPerLabel, int raycastResultSize, unsigned int seed,
                                                           ITMLib::ITMLibSettings::DeviceType deviceType);
 
+  /**
+   * \brief Makes a stratified voxel sampler.
+   *
+   * \param raycastResultDims   The dimensions of the raycast result (in pixels).
+   * \param maxVoxelCount       The maximum number of voxels that can be sampled at once.
+   * \param tileSize            The side length of a tile (in pixels).
+   * \param candidatesPerSample The number of candidate pixels from which to choose each sample.
+   * \param seed                The seed for the random number generator.
+   * \param deviceType          The device on which the sampler should operate.
+   * \return                    The voxel sampler.
+   */
+  static StratifiedVoxelSampler_CPtr make_stratified_sampler(const Vector2i& raycastResultDims, size_t maxVoxelCount, int tileSize, int candidatesPerSample,
+                                                             unsigned int seed, ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  /**
+   * \brief Makes a sweeping voxel sampler.
+   *
+   * \param maxVoxelCount   The maximum number of voxels that can be sampled at once.
+   * \param voxelsPerBlock  The number of voxels in each block that are considered in each sweep (must be a power of two no greater than SDF_BLOCK_SIZE3).
+   * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+   * \param deviceType      The device on which the sampler should operate.
+   * \return                The voxel sampler.
+   */
+  static SweepingVoxelSampler_Ptr make_sweeping_sampler(size_t maxVoxelCount, int voxelsPerBlock, float maxSDF, ITMLib::ITMLibSettings::DeviceType deviceType);
+
   /**
    * \brief Makes a uniform voxel sampler.
    *
@@ -42,6 +70,21 @@ public:
    * \return                  The voxel sampler.
    */
   static UniformVoxelSampler_CPtr make_uniform_sampler(int raycastResultSize, unsigned int seed, ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  /**
+   * \brief Makes a visible-block voxel sampler.
+   *
+   * \param maxLabelCount         The maximum number of labels that can be in use.
+   * \param maxVoxelsPerLabel     The maximum number of voxels to sample for each label (or in total, when sampling from the pooled candidates).
+   * \param maxCandidatesPerLabel The maximum number of candidate voxels to keep for each label.
+   * \param voxelsPerBlock        The number of voxels in each visible block that are considered in each call (must be a power of two no greater than SDF_BLOCK_SIZE3).
+   * \param maxSDF                The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+   * \param seed                  The seed for the random number generator.
+   * \param deviceType            The device on which the sampler should operate.
+   * \return                      The voxel sampler.
+   */
+  static VisibleBlockVoxelSampler_CPtr make_visible_block_sampler(size_t maxLabelCount, size_t maxVoxelsPerLabel, size_t maxCandidatesPerLabel, int voxelsPerBlock,
+                                                                  float maxSDF, unsigned int seed, ITMLib::ITMLibSettings::DeviceType deviceType);
 };
 
 }
@@ -0,0 +1,44 @@
+/**
+ * spaint: VisibleBlockVoxelSampler_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VISIBLEBLOCKVOXELSAMPLER_CPU
+#define H_SPAINT_VISIBLEBLOCKVOXELSAMPLER_CPU
+
+#include "../interface/VisibleBlockVoxelSampler.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to sample surface voxels from the visible blocks of a scene using the CPU.
+ */
+class VisibleBlockVoxelSampler_CPU : public VisibleBlockVoxelSampler
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based visible-block voxel sampler.
+   *
+   * \param maxLabelCount         The maximum number of labels that can be in use.
+   * \param maxVoxelsPerLabel     The maximum number of voxels to sample for each label (or in total, when sampling from the pooled candidates).
+   * \param maxCandidatesPerLabel The maximum number of candidate voxels to keep for each label.
+   * \param voxelsPerBlock        The number of voxels in each visible block that are considered in each call (must be a power of two no greater than SDF_BLOCK_SIZE3).
+   * \param maxSDF                The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+   * \param seed                  The seed for the random number generator.
+   */
+  VisibleBlockVoxelSampler_CPU(size_t maxLabelCount, size_t maxVoxelsPerLabel, size_t maxCandidatesPerLabel, int voxelsPerBlock, float maxSDF, unsigned int seed);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void write_candidate_voxel_locations(const ITMLib::ITMRenderState_VH *renderState, const SpaintVoxelScene *scene, int phase,
+                                               const ORUtils::MemoryBlock<bool> *labelMaskMB) const;
+
+  /** Override */
+  virtual void write_sampled_voxel_locations(size_t labelCount, size_t voxelsPerLabel, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const;
+};
+
+}
+
+#endif
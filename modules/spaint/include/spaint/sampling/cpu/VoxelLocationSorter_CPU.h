@@ -0,0 +1,36 @@
+/**
+ * spaint: VoxelLocationSorter_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELLOCATIONSORTER_CPU
+#define H_SPAINT_VOXELLOCATIONSORTER_CPU
+
+#include "../interface/VoxelLocationSorter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to sort batches of voxel locations into Morton (Z-curve) order using the CPU.
+ */
+class VoxelLocationSorter_CPU : public VoxelLocationSorter
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based voxel location sorter.
+   *
+   * \param maxVoxelCount The maximum number of voxel locations that can be sorted at once.
+   */
+  explicit VoxelLocationSorter_CPU(size_t maxVoxelCount);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void sort_segments(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int segmentCount, int segmentSize,
+                             const ORUtils::MemoryBlock<unsigned int> *segmentVoxelCountsMB);
+};
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * spaint: StratifiedVoxelSampler_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_STRATIFIEDVOXELSAMPLER_CUDA
+#define H_SPAINT_STRATIFIEDVOXELSAMPLER_CUDA
+
+#include "../interface/StratifiedVoxelSampler.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to sample voxels from a scene in a stratified, prioritised way using CUDA.
+ */
+class StratifiedVoxelSampler_CUDA : public StratifiedVoxelSampler
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based stratified voxel sampler.
+   *
+   * \param raycastResultDims   The dimensions of the raycast result (in pixels).
+   * \param maxVoxelCount       The maximum number of voxels that can be sampled at once.
+   * \param tileSize            The side length of a tile (in pixels).
+   * \param candidatesPerSample The number of candidate pixels from which to choose each sample.
+   * \param seed                The seed for the random number generator.
+   */
+  StratifiedVoxelSampler_CUDA(const Vector2i& raycastResultDims, size_t maxVoxelCount, int tileSize, int candidatesPerSample, unsigned int seed);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void write_sampled_voxel_locations(const ITMFloat4Image *raycastResult, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                             const ITMVoxelIndex::IndexData *indexData, size_t sampledVoxelCount,
+                                             ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * spaint: SweepingVoxelSampler_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SWEEPINGVOXELSAMPLER_CUDA
+#define H_SPAINT_SWEEPINGVOXELSAMPLER_CUDA
+
+#include "../interface/SweepingVoxelSampler.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to sweep over the surface voxels in all of the resident voxel blocks of a scene using CUDA.
+ */
+class SweepingVoxelSampler_CUDA : public SweepingVoxelSampler
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based sweeping voxel sampler.
+   *
+   * \param maxVoxelCount   The maximum number of voxels that can be sampled at once.
+   * \param voxelsPerBlock  The number of voxels in each block that are considered in each sweep (must be a power of two no greater than SDF_BLOCK_SIZE3).
+   * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+   */
+  SweepingVoxelSampler_CUDA(size_t maxVoxelCount, int voxelsPerBlock, float maxSDF);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual int gather_resident_entries(const ITMHashEntry *hashTable);
+
+  /** Override */
+  virtual int write_sampled_voxel_locations(int firstEntry, int entryCount, int phase, const SpaintVoxelScene *scene,
+                                            ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB);
+};
+
+}
+
+#endif
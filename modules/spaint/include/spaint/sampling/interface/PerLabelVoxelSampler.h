@@ -90,9 +90,11 @@ private:
    *
    * \param raycastResult The current raycast result.
    * \param voxelData     The scene's voxel data.
+   * \param labelData     The scene's label data (if any).
    * \param indexData     The scene's index data.
    */
-  virtual void calculate_voxel_masks(const ITMFloat4Image *raycastResult, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData) const = 0;
+  virtual void calculate_voxel_masks(const ITMFloat4Image *raycastResult, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                     const ITMVoxelIndex::IndexData *indexData) const = 0;
 
   /**
    * \brief Writes the number of candidate voxels that are available for each label into the voxel counts for labels memory block.
@@ -0,0 +1,115 @@
+/**
+ * spaint: StratifiedVoxelSampler.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_STRATIFIEDVOXELSAMPLER
+#define H_SPAINT_STRATIFIEDVOXELSAMPLER
+
+#include <ITMLib/Utils/ITMImageTypes.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace tvgutil {
+
+//#################### FORWARD DECLARATIONS ####################
+
+class RandomNumberGenerator;
+
+}
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to sample voxels from a scene in a way that is
+ *        stratified across the raycast result and that prioritises the voxels that most need labels to be predicted.
+ *
+ * The raycast result is divided into square tiles, and the samples are shared out between the tiles as evenly as possible,
+ * so that large surfaces cannot crowd out small objects. Each sample is chosen from a number of random candidate pixels in
+ * its tile, with preference given to voxels that have not yet been labelled, then to voxels whose labels were predicted by
+ * the forest or propagated (and so may be stale), and finally to any other valid voxels (e.g. those labelled by the user).
+ */
+class StratifiedVoxelSampler
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the indices of the candidate pixels for each sample in the raycast result. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_candidateVoxelIndicesMB;
+
+  /** The number of candidate pixels from which to choose each sample. */
+  const int m_candidatesPerSample;
+
+  /** The maximum number of voxels that can be sampled at once. */
+  const size_t m_maxVoxelCount;
+
+  /** The dimensions of the raycast result (in pixels). */
+  const Vector2i m_raycastResultDims;
+
+  /** A random number generator. */
+  boost::shared_ptr<tvgutil::RandomNumberGenerator> m_rng;
+
+  /** The side length of a tile (in pixels). */
+  const int m_tileSize;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a stratified voxel sampler.
+   *
+   * \param raycastResultDims   The dimensions of the raycast result (in pixels).
+   * \param maxVoxelCount       The maximum number of voxels that can be sampled at once.
+   * \param tileSize            The side length of a tile (in pixels).
+   * \param candidatesPerSample The number of candidate pixels from which to choose each sample.
+   * \param seed                The seed for the random number generator.
+   * \throws std::invalid_argument  If the tile size or the number of candidates per sample is not positive.
+   */
+  StratifiedVoxelSampler(const Vector2i& raycastResultDims, size_t maxVoxelCount, int tileSize, int candidatesPerSample, unsigned int seed);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel sampler.
+   */
+  virtual ~StratifiedVoxelSampler();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Chooses the best candidate pixel for each sample, and writes the locations of the corresponding voxels into the sampled voxel locations memory block.
+   *
+   * \param raycastResult           The current raycast result.
+   * \param voxelData               The scene's voxel data.
+   * \param labelData               The scene's label data (if any).
+   * \param indexData               The scene's index data.
+   * \param sampledVoxelCount       The number of sampled voxels.
+   * \param sampledVoxelLocationsMB A memory block into which to write the locations of the sampled voxels.
+   */
+  virtual void write_sampled_voxel_locations(const ITMFloat4Image *raycastResult, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                             const ITMVoxelIndex::IndexData *indexData, size_t sampledVoxelCount,
+                                             ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Samples the specified number of voxels from the current raycast result.
+   *
+   * As with the uniform voxel sampler, the voxels produced are not guaranteed to be valid (a sample whose
+   * candidates all lie outside the reconstructed scene has the location (0,0,0)), so client code must account for this.
+   *
+   * \param raycastResult           The current raycast result.
+   * \param scene                   The scene.
+   * \param numVoxelsToSample       The number of voxels to sample.
+   * \param sampledVoxelLocationsMB A memory block into which to write the locations of the sampled voxels.
+   * \throws std::invalid_argument  If more voxels are requested than the sampler can handle.
+   */
+  void sample_voxels(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, size_t numVoxelsToSample,
+                     ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const StratifiedVoxelSampler> StratifiedVoxelSampler_CPtr;
+
+}
+
+#endif
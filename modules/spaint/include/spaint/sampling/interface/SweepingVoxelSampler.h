@@ -0,0 +1,131 @@
+/**
+ * spaint: SweepingVoxelSampler.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SWEEPINGVOXELSAMPLER
+#define H_SPAINT_SWEEPINGVOXELSAMPLER
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to sweep over the surface voxels in all of the resident
+ *        voxel blocks of a scene, in batches, regardless of whether or not they are currently visible.
+ *
+ * At the start of each sweep, the sampler records the hash entries of the blocks that are currently resident. Each call to
+ * sample_voxels then samples voxels from the next few of these blocks, until the sweep is complete and a new one begins. To
+ * bound the size of each batch, only a fixed subset of the voxels in a block is considered in each sweep, with successive
+ * sweeps cycling through disjoint subsets, so that every voxel in a block is considered once every SDF_BLOCK_SIZE3 / voxelsPerBlock
+ * sweeps. Of the voxels considered, only those that have been observed, lie close to the surface and have not been labelled by
+ * the user are sampled (user labels cannot be overwritten by predictions, so there would be no point predicting labels for them).
+ */
+class SweepingVoxelSampler
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store a count computed on the device (the number of resident entries or the number of sampled voxels). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_countMB;
+
+  /** The number of entries at the start of m_entryIDsMB that refer to the blocks in the current sweep. */
+  int m_entryCount;
+
+  /** The index in m_entryIDsMB of the next entry from which to sample voxels. */
+  int m_entryCursor;
+
+  /** A memory block in which to store the IDs of the hash entries that refer to the blocks in the current sweep. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_entryIDsMB;
+
+  /** The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled. */
+  const float m_maxSDF;
+
+  /** The maximum number of voxels that can be sampled at once. */
+  const size_t m_maxVoxelCount;
+
+  /** The number of sweeps that have been started. */
+  int m_sweepCount;
+
+  /** The number of voxels in each block that are considered in each sweep. */
+  const int m_voxelsPerBlock;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a sweeping voxel sampler.
+   *
+   * \param maxVoxelCount   The maximum number of voxels that can be sampled at once.
+   * \param voxelsPerBlock  The number of voxels in each block that are considered in each sweep (must be a power of two no greater than SDF_BLOCK_SIZE3).
+   * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+   * \throws std::invalid_argument  If voxelsPerBlock is invalid, or is greater than maxVoxelCount.
+   */
+  SweepingVoxelSampler(size_t maxVoxelCount, int voxelsPerBlock, float maxSDF);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel sampler.
+   */
+  virtual ~SweepingVoxelSampler();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the IDs of the hash entries that refer to the blocks that are currently resident into the entry IDs memory block.
+   *
+   * \param hashTable The scene's hash table.
+   * \return          The number of entries written.
+   */
+  virtual int gather_resident_entries(const ITMHashEntry *hashTable) = 0;
+
+  /**
+   * \brief Writes the locations of the voxels to be sampled from a range of the entries in the current sweep into the sampled voxel locations memory block.
+   *
+   * \param firstEntry              The index in the entry IDs memory block of the first entry in the range.
+   * \param entryCount              The number of entries in the range.
+   * \param phase                   The index of the subset of the voxels in each block that should be considered.
+   * \param scene                   The scene.
+   * \param sampledVoxelLocationsMB A memory block into which to write the locations of the sampled voxels (in no particular order).
+   * \return                        The number of voxels sampled.
+   */
+  virtual int write_sampled_voxel_locations(int firstEntry, int entryCount, int phase, const SpaintVoxelScene *scene,
+                                            ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the maximum number of voxels that can be sampled at once.
+   *
+   * \return  The maximum number of voxels that can be sampled at once.
+   */
+  size_t get_max_voxel_count() const;
+
+  /**
+   * \brief Gets the number of blocks in the current sweep.
+   *
+   * \return The number of blocks in the current sweep (i.e. the number that were resident when it started).
+   */
+  int get_sweep_block_count() const;
+
+  /**
+   * \brief Samples the next batch of voxels in the sweep, starting a new sweep if the current one is complete.
+   *
+   * The size of the sampled voxel locations memory block is set to the number of voxels sampled, which is at most
+   * get_max_voxel_count(). Note that this can be zero even if the scene is not empty (e.g. if none of the voxels
+   * considered in the batch lie close to the surface).
+   *
+   * \param scene                   The scene.
+   * \param sampledVoxelLocationsMB A memory block into which to write the locations of the sampled voxels. It must have been
+   *                                allocated with space for at least get_max_voxel_count() locations.
+   * \return                        The number of voxels sampled.
+   */
+  size_t sample_voxels(const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<SweepingVoxelSampler> SweepingVoxelSampler_Ptr;
+
+}
+
+#endif
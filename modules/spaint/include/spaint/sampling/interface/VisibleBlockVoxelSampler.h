@@ -0,0 +1,179 @@
+/**
+ * spaint: VisibleBlockVoxelSampler.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VISIBLEBLOCKVOXELSAMPLER
+#define H_SPAINT_VISIBLEBLOCKVOXELSAMPLER
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace tvgutil {
+
+//#################### FORWARD DECLARATIONS ####################
+
+class RandomNumberGenerator;
+
+}
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to sample surface voxels from the blocks in a render state's
+ *        visible block list, rather than from a raycast result.
+ *
+ * Unlike the raycast-based samplers (see UniformVoxelSampler and PerLabelVoxelSampler), this does not need a fresh raycast of the
+ * scene, so it can be used before rendering has finished, and it is not limited to the first surface visible at each pixel. Each
+ * call considers a randomly-chosen subset of the voxels in each visible block (see SweepingVoxelSampler for how the subsets are
+ * formed), and treats those that have been observed and lie close to the surface as candidates. The candidates are either pooled
+ * (for prediction) or grouped by their labels (for training, in which case only voxels that have not been labelled by the forest
+ * are used). Since the number of candidates can be large, at most maxCandidatesPerLabel of them are kept for each label: which
+ * ones are kept is arbitrary, but the voxels to sample are then chosen uniformly at random from those that were kept.
+ */
+class VisibleBlockVoxelSampler
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the number of candidate voxels found for each label (this can exceed the number kept). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_candidateCountsMB;
+
+  /** A memory block in which to store random indices when sampling from the candidate voxels for each label. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_candidateVoxelIndicesMB;
+
+  /** A memory block in which to store the locations of the candidate voxels, grouped by label. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_candidateVoxelLocationsMB;
+
+  /** The maximum number of candidate voxels to keep for each label. */
+  const size_t m_maxCandidatesPerLabel;
+
+  /** The maximum number of labels that can be in use. */
+  const size_t m_maxLabelCount;
+
+  /** The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled. */
+  const float m_maxSDF;
+
+  /** The maximum number of voxels to sample for each label (or in total, when sampling from the pooled candidates). */
+  const size_t m_maxVoxelsPerLabel;
+
+  /** A random number generator. */
+  boost::shared_ptr<tvgutil::RandomNumberGenerator> m_rng;
+
+  /** The number of voxels in each visible block that are considered in each call. */
+  const int m_voxelsPerBlock;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a visible-block voxel sampler.
+   *
+   * \param maxLabelCount           The maximum number of labels that can be in use.
+   * \param maxVoxelsPerLabel       The maximum number of voxels to sample for each label (or in total, when sampling from the pooled candidates).
+   * \param maxCandidatesPerLabel   The maximum number of candidate voxels to keep for each label.
+   * \param voxelsPerBlock          The number of voxels in each visible block that are considered in each call (must be a power of two no greater than SDF_BLOCK_SIZE3).
+   * \param maxSDF                  The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+   * \param seed                    The seed for the random number generator.
+   * \throws std::invalid_argument  If voxelsPerBlock is invalid, or if maxLabelCount or maxCandidatesPerLabel is zero.
+   */
+  VisibleBlockVoxelSampler(size_t maxLabelCount, size_t maxVoxelsPerLabel, size_t maxCandidatesPerLabel, int voxelsPerBlock, float maxSDF, unsigned int seed);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel sampler.
+   */
+  virtual ~VisibleBlockVoxelSampler();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the locations of the candidate voxels in the visible blocks into the candidate voxel locations memory block,
+   *        and the numbers of candidates found for each label into the candidate counts memory block.
+   *
+   * The candidate counts must be available on the host once this function returns.
+   *
+   * \param renderState The render state whose visible block list should be used.
+   * \param scene       The scene.
+   * \param phase       The index of the subset of the voxels in each block that should be considered.
+   * \param labelMaskMB A memory block containing a mask specifying which labels are currently in use, or NULL to pool the candidates under label 0.
+   */
+  virtual void write_candidate_voxel_locations(const ITMLib::ITMRenderState_VH *renderState, const SpaintVoxelScene *scene, int phase,
+                                               const ORUtils::MemoryBlock<bool> *labelMaskMB) const = 0;
+
+  /**
+   * \brief Writes the locations of the sampled voxels into the sampled voxel locations memory block.
+   *
+   * The sampled voxels for label k are written to the range [k * voxelsPerLabel, (k + 1) * voxelsPerLabel) of the memory block.
+   *
+   * \param labelCount              The number of labels for which to write sampled voxels.
+   * \param voxelsPerLabel          The number of voxels sampled for each label (at most m_maxVoxelsPerLabel).
+   * \param sampledVoxelLocationsMB A memory block into which to write the locations of the sampled voxels.
+   */
+  virtual void write_sampled_voxel_locations(size_t labelCount, size_t voxelsPerLabel, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Samples voxels uniformly from the surface voxels in the visible blocks (e.g. for prediction).
+   *
+   * The size of the sampled voxel locations memory block is set to the number of voxels sampled, which is less than the number
+   * requested if fewer candidate voxels were found (possibly zero, e.g. if no blocks are visible).
+   *
+   * \param renderState             The render state whose visible block list should be used (this must be a voxel hashing render state).
+   * \param scene                   The scene.
+   * \param numVoxelsToSample       The number of voxels to sample (at most the maximum number of voxels per label).
+   * \param sampledVoxelLocationsMB A memory block into which to write the locations of the sampled voxels.
+   * \return                        The number of voxels sampled.
+   * \throws std::invalid_argument  If the render state is not a voxel hashing render state.
+   */
+  size_t sample_voxels(const ITMLib::ITMRenderState *renderState, const SpaintVoxelScene *scene, size_t numVoxelsToSample,
+                       ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const;
+
+  /**
+   * \brief Samples voxels for each currently-used label from the surface voxels in the visible blocks (e.g. for training).
+   *
+   * The sampled voxels are laid out in the same way as those of a per-label voxel sampler (see PerLabelVoxelSampler).
+   *
+   * \param renderState             The render state whose visible block list should be used (this must be a voxel hashing render state).
+   * \param scene                   The scene.
+   * \param labelMaskMB             A memory block containing a mask specifying which labels are currently in use.
+   * \param sampledVoxelLocationsMB A memory block into which to write the locations of the sampled voxels.
+   * \param voxelCountsForLabelsMB  A memory block into which to write the numbers of voxels sampled for each label.
+   * \throws std::invalid_argument  If the render state is not a voxel hashing render state.
+   */
+  void sample_voxels(const ITMLib::ITMRenderState *renderState, const SpaintVoxelScene *scene,
+                     const ORUtils::MemoryBlock<bool>& labelMaskMB,
+                     ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB,
+                     ORUtils::MemoryBlock<unsigned int>& voxelCountsForLabelsMB) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Randomly chooses candidate voxels to sample for each of the specified labels.
+   *
+   * \param labelCount      The number of labels to consider.
+   * \param labelMask       A mask indicating which labels are currently in use (NULL if all of the labels considered should be used).
+   * \param voxelsPerLabel  The number of voxels to sample for each label.
+   * \param voxelCounts     An array into which to write the number of voxels sampled for each label.
+   */
+  void choose_candidate_voxel_indices(size_t labelCount, const bool *labelMask, size_t voxelsPerLabel, unsigned int *voxelCounts) const;
+
+  /**
+   * \brief Gathers the candidate voxels from the visible blocks in the specified render state.
+   *
+   * \param renderState             The render state whose visible block list should be used.
+   * \param scene                   The scene.
+   * \param labelMaskMB             A memory block containing a mask specifying which labels are currently in use, or NULL to pool the candidates.
+   * \throws std::invalid_argument  If the render state is not a voxel hashing render state.
+   */
+  void gather_candidates(const ITMLib::ITMRenderState *renderState, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<bool> *labelMaskMB) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const VisibleBlockVoxelSampler> VisibleBlockVoxelSampler_CPtr;
+
+}
+
+#endif
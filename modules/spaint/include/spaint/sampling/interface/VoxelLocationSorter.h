@@ -0,0 +1,120 @@
+/**
+ * spaint: VoxelLocationSorter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELLOCATIONSORTER
+#define H_SPAINT_VOXELLOCATIONSORTER
+
+#include <boost/shared_ptr.hpp>
+
+#include <ITMLib/Utils/ITMMath.h>
+
+#include <ORUtils/MemoryBlock.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to sort batches of voxel locations into Morton (Z-curve) order.
+ *
+ * The voxel samplers produce their locations in an essentially random order, so neighbouring threads in the kernels that consume
+ * them (e.g. those that calculate features) look up unrelated voxel blocks in the hash table and read patches from unrelated parts
+ * of the voxel array. Sorting the locations by their Morton codes first makes neighbouring locations (and in particular, locations
+ * in the same voxel block, whose codes share all but their lowest nine bits) contiguous, so that neighbouring threads touch nearby
+ * memory. The sort is stable, so any duplicate locations keep their relative order.
+ *
+ * A batch can be divided into fixed-size segments (e.g. one per label), each of which is sorted independently and may contain
+ * fewer valid locations than its size. The valid locations in each segment are moved to its front, so that the layout of the
+ * batch is preserved. The permutation applied by the most recent sort is recorded, so that any outputs calculated for the
+ * sorted locations can be scattered back into the original order if necessary.
+ */
+class VoxelLocationSorter
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the sort keys of the voxel locations. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned long long> > m_keysMB;
+
+  /** The maximum number of voxel locations that can be sorted at once. */
+  size_t m_maxVoxelCount;
+
+  /** A memory block in which to store the permutation applied by the most recent sort (sorted[i] = unsorted[permutation[i]]). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_permutationMB;
+
+  /** A memory block in which to store a copy of the voxel locations in their original order whilst they are being sorted. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_unsortedVoxelLocationsMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a voxel location sorter.
+   *
+   * \param maxVoxelCount The maximum number of voxel locations that can be sorted at once.
+   */
+  explicit VoxelLocationSorter(size_t maxVoxelCount);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel location sorter.
+   */
+  virtual ~VoxelLocationSorter();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Sorts each segment of a batch of voxel locations (in place) into Morton order, and records the permutation applied.
+   *
+   * \param voxelLocationsMB      A memory block containing the voxel locations.
+   * \param segmentCount          The number of segments in the batch.
+   * \param segmentSize           The number of voxel locations in each segment.
+   * \param segmentVoxelCountsMB  An optional memory block containing the number of valid voxel locations at the front of each segment (may be NULL, if all of them are valid).
+   */
+  virtual void sort_segments(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int segmentCount, int segmentSize,
+                             const ORUtils::MemoryBlock<unsigned int> *segmentVoxelCountsMB) = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the permutation applied by the most recent sort.
+   *
+   * The permutation is stored on the device on which the sorter operates. After sorting n voxel locations, its first n elements
+   * are such that sorted[i] = unsorted[permutation[i]]. It is only valid until the next sort.
+   *
+   * \return  The permutation applied by the most recent sort.
+   */
+  const ORUtils::MemoryBlock<int>& get_permutation() const;
+
+  /**
+   * \brief Sorts a batch of voxel locations (in place) into Morton order.
+   *
+   * Only the copy of the locations on the device on which the sorter operates is sorted.
+   *
+   * \param voxelLocationsMB        A memory block containing the voxel locations.
+   * \param voxelCount              The number of voxel locations to sort.
+   * \throws std::invalid_argument  If the number of voxel locations is greater than the maximum number that can be sorted at once.
+   */
+  void sort_voxel_locations(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, size_t voxelCount);
+
+  /**
+   * \brief Sorts each segment of a batch of voxel locations (in place) into Morton order, moving the valid locations in each segment to its front.
+   *
+   * Only the copy of the locations on the device on which the sorter operates is sorted.
+   *
+   * \param voxelLocationsMB        A memory block containing the voxel locations.
+   * \param segmentCount            The number of segments in the batch.
+   * \param segmentSize             The number of voxel locations in each segment.
+   * \param segmentVoxelCountsMB    A memory block containing the number of valid voxel locations at the front of each segment.
+   * \throws std::invalid_argument  If the batch contains more voxel locations than can be sorted at once.
+   */
+  void sort_voxel_locations(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, size_t segmentCount, size_t segmentSize,
+                            const ORUtils::MemoryBlock<unsigned int>& segmentVoxelCountsMB);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<VoxelLocationSorter> VoxelLocationSorter_Ptr;
+
+}
+
+#endif
@@ -8,6 +8,8 @@
 
 #include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
 
+#include "../../util/SpaintVoxel.h"
+
 namespace spaint {
 
 /**
@@ -50,27 +52,28 @@ inline void copy_sampled_voxel_locations(int voxelIndex, const bool *labelMask,
  * \param raycastResult     The current raycast result.
  * \param raycastResultSize The size of the raycast result (in pixels).
  * \param voxelData         The scene's voxel data.
+ * \param labelData         The scene's label data (if any).
  * \param indexData         The scene's index data.
  * \param maxLabelCount     The maximum number of labels that can be in use.
  * \param voxelMasks        An array into which to write the voxel masks indicating which voxels may be used as examples of which labels.
  */
 _CPU_AND_GPU_CODE_
 inline void update_masks_for_voxel(int voxelIndex, const Vector4f *raycastResult, int raycastResultSize,
-                                   const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                   size_t maxLabelCount, unsigned char *voxelMasks)
+                                   const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                   const ITMVoxelIndex::IndexData *indexData, size_t maxLabelCount, unsigned char *voxelMasks)
 {
   // Note: We do not need to explicitly use the label mask in this function, since no voxel will ever be marked with an unused label.
 
   Vector3i loc = raycastResult[voxelIndex].toVector3().toIntRound();
   bool isFound;
   int voxelAddress = findVoxel(indexData, loc, isFound);
-  const SpaintVoxel *voxel = isFound ? &voxelData[voxelAddress] : NULL;
+  const SpaintVoxel::PackedLabel *packedLabel = isFound ? &get_voxel_label(voxelAddress, voxelData, labelData) : NULL;
 
   // Update the voxel masks for the various labels (even the ones that are not currently active).
   for(size_t k = 0; k < maxLabelCount; ++k)
   {
     // FIXME: We shouldn't hard-code which labels we're training from here.
-    voxelMasks[k * (raycastResultSize + 1) + voxelIndex] = voxel && voxel->packedLabel.label == k && voxel->packedLabel.group != SpaintVoxel::LG_FOREST ? 1 : 0;
+    voxelMasks[k * (raycastResultSize + 1) + voxelIndex] = packedLabel && packedLabel->label == k && packedLabel->group != SpaintVoxel::LG_FOREST ? 1 : 0;
   }
 }
 
@@ -0,0 +1,80 @@
+/**
+ * spaint: StratifiedVoxelSampler_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_STRATIFIEDVOXELSAMPLER_SHARED
+#define H_SPAINT_STRATIFIEDVOXELSAMPLER_SHARED
+
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+
+#include "../../util/SpaintVoxel.h"
+
+namespace spaint {
+
+/**
+ * \brief Computes the priority with which the voxel (if any) at the specified point in the raycast result should be sampled for prediction.
+ *
+ * \param point     The point in the raycast result.
+ * \param voxelData The scene's voxel data.
+ * \param labelData The scene's label data (if any).
+ * \param indexData The scene's index data.
+ * \return          2, if the voxel has not yet been labelled, 1, if its label was predicted by the forest or propagated,
+ *                  0, if it is any other valid voxel, or -1 if there is no voxel at the point.
+ */
+_CPU_AND_GPU_CODE_
+inline int compute_prediction_priority(const Vector4f& point, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                       const ITMVoxelIndex::IndexData *indexData)
+{
+  if(point.w <= 0) return -1;
+
+  bool isFound;
+  int voxelAddress = findVoxel(indexData, point.toVector3().toIntRound(), isFound);
+  if(!isFound) return -1;
+
+  const SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+  if(packedLabel.group == SpaintVoxel::LG_USER) return packedLabel.label == 0 ? 2 : 0;
+  else return 1;
+}
+
+/**
+ * \brief Chooses the candidate pixel with the highest prediction priority for a sample, and writes the location of the corresponding voxel
+ *        into the sampled voxel locations array.
+ *
+ * Ties are broken in favour of the earliest candidate. If none of the candidates contains a voxel, the location (0,0,0) is written instead.
+ *
+ * \param tid                   The thread ID (each thread handles a single sample).
+ * \param candidatesPerSample   The number of candidate pixels for each sample.
+ * \param candidateVoxelIndices The indices of the candidate pixels for each sample in the raycast result.
+ * \param raycastResult         The current raycast result.
+ * \param voxelData             The scene's voxel data.
+ * \param labelData             The scene's label data (if any).
+ * \param indexData             The scene's index data.
+ * \param sampledVoxelLocations An array into which to write the locations of the sampled voxels.
+ */
+_CPU_AND_GPU_CODE_
+inline void write_prioritised_voxel_location(int tid, int candidatesPerSample, const int *candidateVoxelIndices, const Vector4f *raycastResult,
+                                             const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                             const ITMVoxelIndex::IndexData *indexData, Vector3s *sampledVoxelLocations)
+{
+  Vector3s bestLoc(0,0,0);
+  int bestPriority = -1;
+
+  const int *candidates = candidateVoxelIndices + tid * candidatesPerSample;
+  for(int i = 0; i < candidatesPerSample; ++i)
+  {
+    const Vector4f point = raycastResult[candidates[i]];
+    const int priority = compute_prediction_priority(point, voxelData, labelData, indexData);
+    if(priority > bestPriority)
+    {
+      bestLoc = point.toVector3().toShortRound();
+      bestPriority = priority;
+    }
+  }
+
+  sampledVoxelLocations[tid] = bestLoc;
+}
+
+}
+
+#endif
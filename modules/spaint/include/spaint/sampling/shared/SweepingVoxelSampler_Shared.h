@@ -0,0 +1,86 @@
+/**
+ * spaint: SweepingVoxelSampler_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SWEEPINGVOXELSAMPLER_SHARED
+#define H_SPAINT_SWEEPINGVOXELSAMPLER_SHARED
+
+#include "../../util/SpaintVoxel.h"
+
+namespace spaint {
+
+/**
+ * \brief Determines whether or not the specified voxel is in the specified subset of its block's voxels.
+ *
+ * The voxels are assigned to the subsets by scrambling their linear indices (multiplying by an odd number is a bijection modulo
+ * the block size), so that the voxels in each subset are spread throughout the block rather than lying in a single plane.
+ *
+ * \param linearIdx       The linear index of the voxel within its block.
+ * \param phase           The index of the subset.
+ * \param voxelsPerBlock  The number of voxels in each subset (a power of two no greater than SDF_BLOCK_SIZE3).
+ * \return                true, if the voxel is in the subset, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_in_voxel_subset(int linearIdx, int phase, int voxelsPerBlock)
+{
+  const int scrambledIdx = (linearIdx * 149) & (SDF_BLOCK_SIZE3 - 1);
+  return scrambledIdx / voxelsPerBlock == phase;
+}
+
+/**
+ * \brief Calculates the position (in voxels) of the voxel with the specified linear index in a block.
+ *
+ * \param linearIdx The linear index of the voxel within its block.
+ * \param hashEntry The hash entry of the voxel's block.
+ * \return          The position of the voxel (in voxels).
+ */
+_CPU_AND_GPU_CODE_
+inline Vector3s make_block_voxel_location(int linearIdx, const ITMHashEntry& hashEntry)
+{
+  return Vector3s(
+    static_cast<short>(hashEntry.pos.x * SDF_BLOCK_SIZE + linearIdx % SDF_BLOCK_SIZE),
+    static_cast<short>(hashEntry.pos.y * SDF_BLOCK_SIZE + linearIdx / SDF_BLOCK_SIZE % SDF_BLOCK_SIZE),
+    static_cast<short>(hashEntry.pos.z * SDF_BLOCK_SIZE + linearIdx / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE))
+  );
+}
+
+/**
+ * \brief Determines whether or not the specified voxel should be sampled by a sweeping voxel sampler.
+ *
+ * A voxel is sampled iff it is in the subset of its block's voxels that is considered in the current sweep, has been observed,
+ * has a TSDF value that is close enough to zero, and has not been labelled by the user.
+ *
+ * \param linearIdx       The linear index of the voxel within its block.
+ * \param hashEntry       The hash entry of the voxel's block (which must be resident).
+ * \param phase           The index of the subset of the voxels in each block that should be considered.
+ * \param voxelsPerBlock  The number of voxels in each subset.
+ * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+ * \param voxelData       The scene's voxel data.
+ * \param labelData       The scene's label data (if any).
+ * \param loc             A location into which to write the position of the voxel (in voxels), if it is sampled.
+ * \return                true, if the voxel should be sampled, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool select_sweep_voxel(int linearIdx, const ITMHashEntry& hashEntry, int phase, int voxelsPerBlock, float maxSDF,
+                               const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, Vector3s& loc)
+{
+  if(!is_in_voxel_subset(linearIdx, phase, voxelsPerBlock)) return false;
+
+  const int voxelAddress = hashEntry.ptr * SDF_BLOCK_SIZE3 + linearIdx;
+  const SpaintVoxel& voxel = voxelData[voxelAddress];
+  if(voxel.w_depth == 0) return false;
+
+  const float sdf = SpaintVoxel::valueToFloat(voxel.sdf);
+  if(sdf > maxSDF || sdf < -maxSDF) return false;
+
+  const SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+  if(packedLabel.group == SpaintVoxel::LG_USER && packedLabel.label != 0) return false;
+
+  loc = make_block_voxel_location(linearIdx, hashEntry);
+  return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * spaint: VisibleBlockVoxelSampler_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VISIBLEBLOCKVOXELSAMPLER_SHARED
+#define H_SPAINT_VISIBLEBLOCKVOXELSAMPLER_SHARED
+
+#include "SweepingVoxelSampler_Shared.h"
+
+namespace spaint {
+
+/**
+ * \brief Copies the location of a randomly-chosen candidate voxel across to the sampled voxel locations array.
+ *
+ * Note: A candidate voxel index of -1 indicates that no voxel location has been sampled for a given label and voxel index.
+ *
+ * \param slot                    The index of the slot in the sampled voxel locations array to fill (label * voxelsPerLabel + voxel index).
+ * \param voxelsPerLabel          The number of voxels sampled for each label.
+ * \param maxVoxelsPerLabel       The maximum number of voxels that can be sampled for each label.
+ * \param maxCandidatesPerLabel   The maximum number of candidate voxels kept for each label.
+ * \param candidateVoxelLocations An array containing the locations of the candidate voxels (grouped by label).
+ * \param candidateVoxelIndices   An array specifying which candidate voxels should be sampled for each label.
+ * \param sampledVoxelLocations   An array into which to write the locations of the sampled voxels.
+ */
+_CPU_AND_GPU_CODE_
+inline void copy_visible_block_voxel_location(int slot, int voxelsPerLabel, int maxVoxelsPerLabel, int maxCandidatesPerLabel,
+                                              const Vector3s *candidateVoxelLocations, const int *candidateVoxelIndices,
+                                              Vector3s *sampledVoxelLocations)
+{
+  const int label = slot / voxelsPerLabel;
+  const int candidateVoxelIndex = candidateVoxelIndices[label * maxVoxelsPerLabel + slot % voxelsPerLabel];
+  if(candidateVoxelIndex != -1)
+  {
+    sampledVoxelLocations[slot] = candidateVoxelLocations[label * maxCandidatesPerLabel + candidateVoxelIndex];
+  }
+}
+
+/**
+ * \brief Determines whether or not the specified voxel in a visible block is a candidate for sampling, and if so, for which label.
+ *
+ * A voxel is a candidate iff it is in the subset of its block's voxels that is currently being considered, has been observed and
+ * has a TSDF value that is close enough to zero. If the candidates are being grouped by label, it must also have a label that is
+ * in use, and must not have been labelled by the forest (as for the per-label voxel sampler, we don't train on predictions).
+ *
+ * \param linearIdx       The linear index of the voxel within its block.
+ * \param hashEntry       The hash entry of the voxel's block (which must be resident).
+ * \param phase           The index of the subset of the voxels in each block that should be considered.
+ * \param voxelsPerBlock  The number of voxels in each subset.
+ * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be sampled.
+ * \param voxelData       The scene's voxel data.
+ * \param labelData       The scene's label data (if any).
+ * \param labelMask       A mask indicating which labels are currently in use, or NULL if the candidates are being pooled.
+ * \param maxLabelCount   The maximum number of labels that can be in use (i.e. the size of the label mask).
+ * \param loc             A location into which to write the position of the voxel (in voxels), if it is a candidate.
+ * \param label           A location into which to write the label whose candidates the voxel should join (0 if the candidates are being pooled).
+ * \return                true, if the voxel is a candidate, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool select_visible_block_voxel(int linearIdx, const ITMHashEntry& hashEntry, int phase, int voxelsPerBlock, float maxSDF,
+                                       const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const bool *labelMask,
+                                       int maxLabelCount, Vector3s& loc, int& label)
+{
+  if(!is_in_voxel_subset(linearIdx, phase, voxelsPerBlock)) return false;
+
+  const int voxelAddress = hashEntry.ptr * SDF_BLOCK_SIZE3 + linearIdx;
+  const SpaintVoxel& voxel = voxelData[voxelAddress];
+  if(voxel.w_depth == 0) return false;
+
+  const float sdf = SpaintVoxel::valueToFloat(voxel.sdf);
+  if(sdf > maxSDF || sdf < -maxSDF) return false;
+
+  if(labelMask)
+  {
+    // FIXME: We shouldn't hard-code which labels we're training from here (see also PerLabelVoxelSampler_Shared.h).
+    const SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+    if(packedLabel.label >= maxLabelCount || !labelMask[packedLabel.label] || packedLabel.group == SpaintVoxel::LG_FOREST) return false;
+    label = packedLabel.label;
+  }
+  else label = 0;
+
+  loc = make_block_voxel_location(linearIdx, hashEntry);
+  return true;
+}
+
+}
+
+#endif
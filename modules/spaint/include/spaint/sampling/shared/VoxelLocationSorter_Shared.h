@@ -0,0 +1,40 @@
+/**
+ * spaint: VoxelLocationSorter_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELLOCATIONSORTER_SHARED
+#define H_SPAINT_VOXELLOCATIONSORTER_SHARED
+
+#include "../../util/MortonCode_Shared.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Calculates the sort key of an element of a segmented batch of voxel locations.
+ *
+ * The segment index occupies the highest bits of the key, so that sorting never moves a location into a different segment.
+ * Below that is a flag that is set for elements beyond the valid locations of their segment, so that they sort to its back,
+ * and below that is the Morton code of the location (for valid elements only, since the others may contain garbage). Since
+ * each voxel block spans 8 voxels along each axis, the locations in a single voxel block share all but the lowest nine bits of
+ * their codes.
+ *
+ * \param i                   The index of the element.
+ * \param voxelLocations      The voxel locations.
+ * \param segmentSize         The number of elements in each segment.
+ * \param segmentVoxelCounts  The numbers of valid voxel locations at the front of the segments (may be NULL, if all of the locations are valid).
+ * \param keys                The array into which to write the sort keys.
+ */
+_CPU_AND_GPU_CODE_
+inline void write_voxel_location_sort_key(int i, const Vector3s *voxelLocations, int segmentSize, const unsigned int *segmentVoxelCounts, unsigned long long *keys)
+{
+  const int segment = i / segmentSize, offset = i % segmentSize;
+  const bool valid = !segmentVoxelCounts || static_cast<unsigned int>(offset) < segmentVoxelCounts[segment];
+  keys[i] = (static_cast<unsigned long long>(segment) << 49) | (valid ? make_morton_code(voxelLocations[i]) : (1ULL << 48));
+}
+
+}
+
+#endif
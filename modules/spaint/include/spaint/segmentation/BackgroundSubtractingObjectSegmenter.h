@@ -10,8 +10,13 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include <boost/optional.hpp>
+
+#include <tvgutil/timing/PlacementController.h>
+
 #include "ColourAppearanceModel.h"
 #include "Segmenter.h"
+#include "interface/ChangeMaskGenerator.h"
 #include "../touch/TouchDetector.h"
 
 namespace spaint {
@@ -24,9 +29,24 @@ class BackgroundSubtractingObjectSegmenter : public Segmenter
 {
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The generator used to perform the per-pixel stages of making the change mask on the device. */
+  ChangeMaskGenerator_CPtr m_changeMaskGenerator;
+
+  /**
+   * An optional controller used to choose, each frame, whether to perform the per-pixel stages of making the change mask
+   * on the device (alternative 0) or on the CPU (alternative 1), based on how long each has recently taken.
+   */
+  mutable boost::optional<tvgutil::PlacementController> m_changeMaskPlacement;
+
+  /** The generator used to perform the per-pixel stages of making the change mask on the CPU (if adaptive placement is enabled). */
+  ChangeMaskGenerator_CPtr m_cpuChangeMaskGenerator;
+
   /** The colour appearance model to use to separate the user's hand from any object it's holding. */
   ColourAppearanceModel_Ptr m_handAppearanceModel;
 
+  /** An image in which to store the posterior probability of each pixel being part of the user's hand. */
+  ITMFloatImage_Ptr m_handProbabilityImage;
+
   /** The touch detector to use to make the change and hand masks. */
   mutable TouchDetector_Ptr m_touchDetector;
 
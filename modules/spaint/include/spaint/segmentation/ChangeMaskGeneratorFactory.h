@@ -0,0 +1,34 @@
+/**
+ * spaint: ChangeMaskGeneratorFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CHANGEMASKGENERATORFACTORY
+#define H_SPAINT_CHANGEMASKGENERATORFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/ChangeMaskGenerator.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct change mask generators.
+ */
+struct ChangeMaskGeneratorFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a change mask generator.
+   *
+   * \param imgSize     The size of the images on which the generator is to run.
+   * \param deviceType  The device on which the generator should operate.
+   * \return            The change mask generator.
+   */
+  static ChangeMaskGenerator_CPtr make_change_mask_generator(const Vector2i& imgSize, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
@@ -6,6 +6,8 @@
 #ifndef H_SPAINT_COLOURAPPEARANCEMODEL
 #define H_SPAINT_COLOURAPPEARANCEMODEL
 
+#include <vector>
+
 #include <itmx/base/ITMImagePtrTypes.h>
 
 #include <tvgutil/statistics/ProbabilityMassFunction.h>
@@ -15,7 +17,9 @@ namespace spaint {
 /**
  * \brief An instance of this class can be used to represent a pixel-wise colour appearance model for an object.
  *
- * We base our model on a chroma-based 2D histogram over colours in the YCbCr colour space.
+ * We base our model on a chroma-based 2D histogram over colours in the YCbCr colour space. Since the posterior probability
+ * of a pixel depends only on the histogram bin into which its colour falls, we precompute a lookup table containing the
+ * posterior for each bin whenever the model is trained, so that evaluating a pixel is just a bin computation and a gather.
  */
 class ColourAppearanceModel
 {
@@ -43,6 +47,9 @@ private:
   // A (linearised) 2D probability mass function representing P(Colour | !object).
   PMF_Ptr m_pmfColourGivenNotObject;
 
+  /** A (linearised) 2D lookup table containing P(object | colour) for each bin of the histogram. */
+  std::vector<float> m_posteriors;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -63,6 +70,14 @@ public:
    */
   float compute_posterior_probability(const Vector3u& rgbColour) const;
 
+  /**
+   * \brief Computes the posterior probability of each pixel in an image being part of the object given its colour.
+   *
+   * \param image           The image (on the CPU).
+   * \param posteriorImage  An image (of the same size) into which to write the posterior probabilities.
+   */
+  void compute_posterior_image(const ITMUChar4Image_CPtr& image, const ITMFloatImage_Ptr& posteriorImage) const;
+
   /**
    * \brief Trains the colour appearance model for the object.
    *
@@ -80,6 +95,11 @@ private:
    * \return          The 2D histogram bin index for the colour.
    */
   int compute_bin(const Vector3u& rgbColour) const;
+
+  /**
+   * \brief Recomputes the lookup table of posterior probabilities from the likelihood PMFs.
+   */
+  void update_posteriors();
 };
 
 //#################### TYPEDEFS ####################
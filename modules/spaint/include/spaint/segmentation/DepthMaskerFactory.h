@@ -0,0 +1,33 @@
+/**
+ * spaint: DepthMaskerFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHMASKERFACTORY
+#define H_SPAINT_DEPTHMASKERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/DepthMasker.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct depth maskers.
+ */
+struct DepthMaskerFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a depth masker.
+   *
+   * \param deviceType  The device on which the depth masker should operate.
+   * \return            The depth masker.
+   */
+  static DepthMasker_Ptr make_depth_masker(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
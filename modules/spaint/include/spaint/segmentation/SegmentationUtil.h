@@ -7,8 +7,10 @@
 #define H_SPAINT_SEGMENTATIONUTIL
 
 #include <boost/mpl/identity.hpp>
+#include <boost/optional.hpp>
 
 #include <itmx/base/ITMImagePtrTypes.h>
+#include <itmx/base/MemoryBlockFactory.h>
 
 namespace spaint {
 
@@ -42,18 +44,35 @@ public:
    * \param mask            The binary mask.
    * \param image           The image to which to apply it.
    * \param backgroundValue The value to use for background pixels in the masked image.
-   * \return                A masked version of the input image.
+   * \return                A masked version of the input image (leased from the memory block factory's pool, since this is often called once per frame).
    */
   template <typename T>
   static boost::shared_ptr<ORUtils::Image<T> > apply_mask(const ITMUCharImage_CPtr& mask, const boost::shared_ptr<const ORUtils::Image<T> >& image,
                                                           const typename boost::mpl::identity<T>::type& backgroundValue)
   {
-    boost::shared_ptr<ORUtils::Image<T> > maskedImage(new ORUtils::Image<T>(image->noDims, true, true));
+    boost::shared_ptr<ORUtils::Image<T> > maskedImage = itmx::MemoryBlockFactory::instance().make_pooled_image<T>(image->noDims, "SegmentationUtil");
+    apply_mask(mask, *image, backgroundValue, *maskedImage);
+    return maskedImage;
+  }
+
+  /**
+   * \brief Applies a binary mask to an image, writing the result into an existing image (on the CPU only).
+   *
+   * \param mask            The binary mask.
+   * \param image           The image to which to apply it.
+   * \param backgroundValue The value to use for background pixels in the masked image.
+   * \param maskedImage     The image into which to write the masked version of the input image (resized to match it if necessary).
+   */
+  template <typename T>
+  static void apply_mask(const ITMUCharImage_CPtr& mask, const ORUtils::Image<T>& image, const typename boost::mpl::identity<T>::type& backgroundValue,
+                         ORUtils::Image<T>& maskedImage)
+  {
+    if(maskedImage.noDims != image.noDims) maskedImage.ChangeDims(image.noDims);
 
     const uchar *maskPtr = mask->GetData(MEMORYDEVICE_CPU);
-    const T *imagePtr = image->GetData(MEMORYDEVICE_CPU);
-    T *maskedImagePtr = maskedImage->GetData(MEMORYDEVICE_CPU);
-    int pixelCount = static_cast<int>(image->dataSize);
+    const T *imagePtr = image.GetData(MEMORYDEVICE_CPU);
+    T *maskedImagePtr = maskedImage.GetData(MEMORYDEVICE_CPU);
+    int pixelCount = static_cast<int>(image.dataSize);
 
   #ifdef WITH_OPENMP
     #pragma omp parallel for
@@ -62,10 +81,16 @@ public:
     {
       maskedImagePtr[i] = maskPtr[i] ? imagePtr[i] : backgroundValue;
     }
-
-    return maskedImage;
   }
 
+  /**
+   * \brief Computes the bounding box of the foreground pixels in a binary mask.
+   *
+   * \param mask  The binary mask.
+   * \return      The bounding box of the mask's foreground pixels, as (minX, minY, maxX, maxY) with inclusive bounds, or boost::none if the mask is empty.
+   */
+  static boost::optional<Vector4i> compute_bounding_box(const ITMUCharImage_CPtr& mask);
+
   /**
    * \brief Inverts a binary mask.
    *
@@ -0,0 +1,40 @@
+/**
+ * spaint: SupervoxelSegmenterFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SUPERVOXELSEGMENTERFACTORY
+#define H_SPAINT_SUPERVOXELSEGMENTERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/SupervoxelSegmenter.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct supervoxel segmenters.
+ */
+struct SupervoxelSegmenterFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a supervoxel segmenter.
+   *
+   * \param imageSize         The size of the raycast results to be segmented.
+   * \param seedSpacing       The side length (in pixels) of a seed cell.
+   * \param memberStride      The spacing (in pixels) between adjacent members.
+   * \param maxRadius         The maximum distance (in voxels) allowed between the positions of a member and its seed.
+   * \param maxNormalAngle    The maximum angle (in radians) allowed between the normals of a member and its seed.
+   * \param maxColourDistance The maximum distance allowed between the (RGB) colours of a member and its seed.
+   * \param deviceType        The device on which the segmenter should operate.
+   * \return                  The supervoxel segmenter.
+   */
+  static SupervoxelSegmenter_CPtr make_supervoxel_segmenter(const Vector2i& imageSize, int seedSpacing, int memberStride, float maxRadius, float maxNormalAngle,
+                                                            float maxColourDistance, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
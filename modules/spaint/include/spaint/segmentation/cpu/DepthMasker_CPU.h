@@ -0,0 +1,26 @@
+/**
+ * spaint: DepthMasker_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHMASKER_CPU
+#define H_SPAINT_DEPTHMASKER_CPU
+
+#include "../interface/DepthMasker.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to apply a binary mask to a depth image on the CPU.
+ */
+class DepthMasker_CPU : public DepthMasker
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void mask_depth(const ITMUCharImage_CPtr& mask, const ITMFloatImage *depth, float backgroundValue, ITMFloatImage *maskedDepth);
+};
+
+}
+
+#endif
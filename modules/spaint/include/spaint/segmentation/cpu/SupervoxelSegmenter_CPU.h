@@ -0,0 +1,45 @@
+/**
+ * spaint: SupervoxelSegmenter_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SUPERVOXELSEGMENTER_CPU
+#define H_SPAINT_SUPERVOXELSEGMENTER_CPU
+
+#include "../interface/SupervoxelSegmenter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to over-segment the visible surface of a scene into supervoxels using the CPU.
+ */
+class SupervoxelSegmenter_CPU : public SupervoxelSegmenter
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based supervoxel segmenter.
+   *
+   * \param imageSize               The size of the raycast results to be segmented.
+   * \param seedSpacing             The side length (in pixels) of a seed cell.
+   * \param memberStride            The spacing (in pixels) between adjacent members.
+   * \param maxRadius               The maximum distance (in voxels) allowed between the positions of a member and its seed.
+   * \param maxNormalAngle          The maximum angle (in radians) allowed between the normals of a member and its seed.
+   * \param maxColourDistance       The maximum distance allowed between the (RGB) colours of a member and its seed.
+   * \throws std::invalid_argument  If any of the parameters is out of range.
+   */
+  SupervoxelSegmenter_CPU(const Vector2i& imageSize, int seedSpacing, int memberStride, float maxRadius, float maxNormalAngle, float maxColourDistance);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void assign_members(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& seedLabelsMB,
+                              ORUtils::MemoryBlock<Vector3s>& memberLocationsMB, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& memberLabelsMB) const;
+
+  /** Override */
+  virtual void select_seeds(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& seedLocationsMB) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ * spaint: ChangeMaskGenerator_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CHANGEMASKGENERATOR_CUDA
+#define H_SPAINT_CHANGEMASKGENERATOR_CUDA
+
+#include "../interface/ChangeMaskGenerator.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to perform the per-pixel stages of making a change mask using CUDA.
+ */
+class ChangeMaskGenerator_CUDA : public ChangeMaskGenerator
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based change mask generator.
+   *
+   * \param imgSize The size of the images on which the generator is to run.
+   */
+  explicit ChangeMaskGenerator_CUDA(const Vector2i& imgSize);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void make_initial_change_mask(const ITMFloatImage *thresholdedRawDepth, const ITMFloatImage *depthRaycast, const ITMFloatImage *diffRawRaycast,
+                                        float invalidDepthValue, const Thresholds& thresholds) const;
+
+  /** Override */
+  virtual void remove_small_depth_clusters(const ITMFloatImage *thresholdedRawDepth, int maxIntraClusterDepthDiffMm, int minClusterSize) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * spaint: DepthMasker_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHMASKER_CUDA
+#define H_SPAINT_DEPTHMASKER_CUDA
+
+#include "../interface/DepthMasker.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to apply a binary mask to a depth image using CUDA.
+ *
+ * Since masks are normally made on the CPU, the masker keeps a copy of the most recent mask on the GPU, and only
+ * uploads a mask when it is given a different one. Masks are immutable, so a mask that is reused from one frame
+ * to the next (as is normal when the user is not interacting with the scene) costs nothing to upload.
+ */
+class DepthMasker_CUDA : public DepthMasker
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The mask that was most recently uploaded to the GPU (if any). */
+  ITMUCharImage_CPtr m_uploadedMask;
+
+  /** A copy of the most recently uploaded mask that is guaranteed to be available on the GPU. */
+  ITMUCharImage_Ptr m_uploadedMaskCopy;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based depth masker.
+   */
+  DepthMasker_CUDA();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void mask_depth(const ITMUCharImage_CPtr& mask, const ITMFloatImage *depth, float backgroundValue, ITMFloatImage *maskedDepth);
+};
+
+}
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * spaint: ChangeMaskGenerator.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CHANGEMASKGENERATOR
+#define H_SPAINT_CHANGEMASKGENERATOR
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to perform the per-pixel stages of making a mask
+ *        of the changes between a live depth image and a depth raycast of the reconstructed scene.
+ *
+ * All of the work is performed on the device, directly on the images produced by the touch detector. The contour-based
+ * filtering that happens in between the two stages needs only the (single-byte) change mask on the CPU.
+ */
+class ChangeMaskGenerator
+{
+  //#################### CONSTANTS ####################
+public:
+  /** The maximum depth (in mm) that can be clustered (any greater depths are put in the last bin of the depth histogram). */
+  static const int MAX_DEPTH_MM = 2000;
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains the thresholds used to make an initial change mask.
+   */
+  struct Thresholds
+  {
+    /** Pixels greater than this percentage distance from the centre of the image will be ignored. */
+    int centreDistThreshold;
+
+    /** Pixels with values above this will be treated as edges in the gradient magnitude image of the depth raycast. */
+    int depthEdgeThreshold;
+
+    /** Pixels whose depth difference (in mm) is less than this will be ignored. */
+    int lowerDiffThresholdMm;
+
+    /** Pixels near depth edges whose depth difference (in mm) is less than this will be ignored. */
+    int lowerDiffThresholdNearEdgesMm;
+
+    /** Pixels whose live depth value (in mm) is greater than this will be ignored. */
+    int upperDepthThresholdMm;
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The change mask. */
+  ITMUCharImage_Ptr m_changeMask;
+
+  /** The number of pixels in the change mask at each depth (in mm). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_depthHistogramMB;
+
+  /** The edges in the (greyscale) gradient magnitude image of the depth raycast. */
+  ITMUCharImage_Ptr m_depthEdges;
+
+  /** The depth edges after dilation. */
+  ITMUCharImage_Ptr m_dilatedDepthEdges;
+
+  /** A buffer in which to store the depth edges after the horizontal pass of the (separable) dilation. */
+  ITMUCharImage_Ptr m_dilationBuffer;
+
+  /** A mask indicating which depths (in mm) belong to clusters that are too small to retain. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_smallClusterDepthsMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a change mask generator.
+   *
+   * \param imgSize The size of the images on which the generator is to run.
+   */
+  explicit ChangeMaskGenerator(const Vector2i& imgSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the change mask generator.
+   */
+  virtual ~ChangeMaskGenerator();
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes an initial change mask on the device, starting from the whole image and filtering out pixels based on some simple criteria.
+   *
+   * \param thresholdedRawDepth The live depth image, with any pixels that are too far away set to -1.
+   * \param depthRaycast        The depth raycast of the scene.
+   * \param diffRawRaycast      The absolute difference (in m) between the live depth image and the depth raycast.
+   * \param invalidDepthValue   The value used in the depth raycast to denote parts of the scene for which there is no information.
+   * \param thresholds          The thresholds to use.
+   */
+  virtual void make_initial_change_mask(const ITMFloatImage *thresholdedRawDepth, const ITMFloatImage *depthRaycast, const ITMFloatImage *diffRawRaycast,
+                                        float invalidDepthValue, const Thresholds& thresholds) const = 0;
+
+  /**
+   * \brief Clusters the pixels in the change mask by depth on the device, and removes any clusters that are below a certain size.
+   *
+   * A new cluster starts wherever there is a gap of more than the specified size between consecutive depths (in sorted order).
+   *
+   * \pre   The device copy of the change mask is up to date.
+   * \param thresholdedRawDepth         The live depth image, with any pixels that are too far away set to -1.
+   * \param maxIntraClusterDepthDiffMm  The maximum difference in depth (in mm) to allow between consecutive pixels within the same cluster.
+   * \param minClusterSize              The minimum size of cluster to retain.
+   */
+  virtual void remove_small_depth_clusters(const ITMFloatImage *thresholdedRawDepth, int maxIntraClusterDepthDiffMm, int minClusterSize) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the change mask.
+   *
+   * \note  The change mask is only updated on the device: it is up to the caller to synchronise the host copy as necessary.
+   *
+   * \return  The change mask.
+   */
+  ITMUCharImage_Ptr get_change_mask() const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const ChangeMaskGenerator> ChangeMaskGenerator_CPtr;
+
+}
+
+#endif
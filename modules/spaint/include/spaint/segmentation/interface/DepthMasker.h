@@ -0,0 +1,74 @@
+/**
+ * spaint: DepthMasker.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHMASKER
+#define H_SPAINT_DEPTHMASKER
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to apply a binary mask to a depth image.
+ *
+ * The masking is performed directly on the device on which the masker operates, so that (e.g.) the depth image
+ * of a view can be masked on the GPU without first being copied across to the CPU. The masked depth image is
+ * written into a buffer that is owned by the masker and reused from one frame to the next.
+ */
+class DepthMasker
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The buffer into which the masked depth image is written. */
+  ITMFloatImage_Ptr m_maskedDepth;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a depth masker.
+   */
+  DepthMasker();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the depth masker.
+   */
+  virtual ~DepthMasker();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Applies a binary mask to a depth image, writing the result into a masked depth image of the same size.
+   *
+   * \param mask            The binary mask (whose data is only guaranteed to be available on the CPU).
+   * \param depth           The depth image.
+   * \param backgroundValue The value to use for background pixels in the masked depth image.
+   * \param maskedDepth     The masked depth image.
+   */
+  virtual void mask_depth(const ITMUCharImage_CPtr& mask, const ITMFloatImage *depth, float backgroundValue, ITMFloatImage *maskedDepth) = 0;
+
+  //#################### PUBLIC OPERATORS ####################
+public:
+  /**
+   * \brief Applies a binary mask to a depth image.
+   *
+   * \param mask                    The binary mask (whose data is only guaranteed to be available on the CPU).
+   * \param depth                   The depth image (whose data must be up to date on the device on which the masker operates).
+   * \param backgroundValue         The value to use for background pixels in the masked depth image.
+   * \return                        The masked depth image (up to date on the device on which the masker operates). This will be
+   *                                overwritten by the next call to the masker, but may be swapped with another image in between.
+   * \throws std::invalid_argument  If the mask and the depth image are of different sizes.
+   */
+  const ITMFloatImage_Ptr& operator()(const ITMUCharImage_CPtr& mask, const ITMFloatImage *depth, float backgroundValue);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<DepthMasker> DepthMasker_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,190 @@
+/**
+ * spaint: SupervoxelSegmenter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SUPERVOXELSEGMENTER
+#define H_SPAINT_SUPERVOXELSEGMENTER
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to over-segment the visible surface of a scene into
+ *        supervoxels, so that a label predicted for a single voxel of each supervoxel can be broadcast to the rest of it.
+ *
+ * The raycast result is divided into a regular grid of cells, and each cell seeds a supervoxel at one of its surface
+ * voxels (the one at its centre, if possible). The surface voxels at a regular subset of the pixels (the members) are
+ * then each assigned to the most similar of the seeds in their own and the neighbouring cells, based on their positions,
+ * normals and colours. A member is only assigned to a seed that is close to it, faces the same way and has a similar
+ * colour, so supervoxels do not cross depth discontinuities, creases or colour edges. Members whose surface voxels are
+ * not similar to any nearby seed are left unassigned, and keep their existing labels.
+ *
+ * Predicting labels only for the seeds (rather than for each of the voxels sampled) cuts the cost of prediction by the
+ * number of members per supervoxel, whilst still labelling the voxels at all of the members.
+ */
+class SupervoxelSegmenter
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents a seed of a supervoxel.
+   */
+  struct Seed
+  {
+    /** The colour of the seed voxel. */
+    Vector3f colour;
+
+    /** The surface normal at the seed voxel. */
+    Vector3f normal;
+
+    /** The position of the seed voxel (in voxel coordinates). */
+    Vector3f position;
+
+    /** Whether or not the seed is valid (i.e. whether or not any surface voxel was visible in the seed's cell). */
+    bool valid;
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The height of the grid of seed cells. */
+  int m_gridHeight;
+
+  /** The width of the grid of seed cells. */
+  int m_gridWidth;
+
+  /** The size of the raycast results to be segmented. */
+  Vector2i m_imageSize;
+
+  /** The maximum distance allowed between the colours of a member and its seed. */
+  float m_maxColourDistance;
+
+  /** The maximum distance (in voxels) allowed between the positions of a member and its seed. */
+  float m_maxRadius;
+
+  /** The height of the grid of members. */
+  int m_memberGridHeight;
+
+  /** The width of the grid of members. */
+  int m_memberGridWidth;
+
+  /** The spacing (in pixels) between adjacent members. */
+  int m_memberStride;
+
+  /** The minimum dot product allowed between the normals of a member and its seed (i.e. the cosine of the maximum angle between them). */
+  float m_minNormalDot;
+
+  /** A memory block in which to store the seeds of the supervoxels (one per cell). */
+  boost::shared_ptr<ORUtils::MemoryBlock<Seed> > m_seedsMB;
+
+  /** The side length (in pixels) of a seed cell. */
+  int m_seedSpacing;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a supervoxel segmenter.
+   *
+   * \param imageSize               The size of the raycast results to be segmented.
+   * \param seedSpacing             The side length (in pixels) of a seed cell.
+   * \param memberStride            The spacing (in pixels) between adjacent members.
+   * \param maxRadius               The maximum distance (in voxels) allowed between the positions of a member and its seed.
+   * \param maxNormalAngle          The maximum angle (in radians) allowed between the normals of a member and its seed.
+   * \param maxColourDistance       The maximum distance allowed between the (RGB) colours of a member and its seed.
+   * \throws std::invalid_argument  If any of the parameters is out of range.
+   */
+  SupervoxelSegmenter(const Vector2i& imageSize, int seedSpacing, int memberStride, float maxRadius, float maxNormalAngle, float maxColourDistance);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the supervoxel segmenter.
+   */
+  virtual ~SupervoxelSegmenter();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Assigns each member to the most similar nearby seed (if any), and writes its location and new label into the specified memory blocks.
+   *
+   * \param raycastResult     The raycast result.
+   * \param scene             The scene.
+   * \param seedLabelsMB      The labels predicted for the seeds.
+   * \param memberLocationsMB A memory block into which to write the locations of the members' voxels.
+   * \param memberLabelsMB    A memory block into which to write the new labels of the members' voxels.
+   */
+  virtual void assign_members(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& seedLabelsMB,
+                              ORUtils::MemoryBlock<Vector3s>& memberLocationsMB, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& memberLabelsMB) const = 0;
+
+  /**
+   * \brief Chooses the seed of each cell, and writes the locations of the seed voxels into the specified memory block.
+   *
+   * \param raycastResult   The raycast result.
+   * \param scene           The scene.
+   * \param seedLocationsMB A memory block into which to write the locations of the seed voxels.
+   */
+  virtual void select_seeds(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& seedLocationsMB) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Broadcasts the labels predicted for the seeds of the most recent segmentation to the members of their supervoxels.
+   *
+   * The voxels of unassigned members are given their existing labels, so that marking them has no effect.
+   *
+   * \param raycastResult           The raycast result that was segmented.
+   * \param scene                   The scene.
+   * \param seedLabelsMB            The labels predicted for the seeds (in the order in which their locations were written by segment).
+   * \param memberLocationsMB       A memory block (with space for at least get_member_count() elements) into which to write the locations of the members' voxels.
+   * \param memberLabelsMB          A memory block (with space for at least get_member_count() elements) into which to write the new labels of the members' voxels.
+   * \throws std::invalid_argument  If the raycast result is not of the size expected by the segmenter.
+   */
+  void broadcast_labels(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& seedLabelsMB,
+                        ORUtils::MemoryBlock<Vector3s>& memberLocationsMB, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& memberLabelsMB) const;
+
+  /**
+   * \brief Gets the number of members for which broadcast_labels writes locations and labels.
+   *
+   * \return  The number of members for which broadcast_labels writes locations and labels.
+   */
+  size_t get_member_count() const;
+
+  /**
+   * \brief Gets the number of seeds whose locations are written by segment.
+   *
+   * \return  The number of seeds whose locations are written by segment.
+   */
+  size_t get_seed_count() const;
+
+  /**
+   * \brief Chooses the seeds of the supervoxels into which to segment the specified raycast result.
+   *
+   * Note that, as with the uniform voxel sampler, the seeds of cells in which no surface voxel is visible are invalid,
+   * and have their locations set to (0,0,0). No labels are ever broadcast from such seeds.
+   *
+   * \param raycastResult           The raycast result to segment.
+   * \param scene                   The scene.
+   * \param seedLocationsMB         A memory block (with space for at least get_seed_count() elements) into which to write the locations of the seed voxels.
+   * \throws std::invalid_argument  If the raycast result is not of the size expected by the segmenter.
+   */
+  void segment(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& seedLocationsMB) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Checks that the specified raycast result is of the size expected by the segmenter.
+   *
+   * \param raycastResult           The raycast result.
+   * \throws std::invalid_argument  If the raycast result is not of the size expected by the segmenter.
+   */
+  void check_raycast_result_size(const ITMFloat4Image *raycastResult) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const SupervoxelSegmenter> SupervoxelSegmenter_CPtr;
+
+}
+
+#endif
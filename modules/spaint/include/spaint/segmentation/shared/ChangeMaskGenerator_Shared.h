@@ -0,0 +1,273 @@
+/**
+ * spaint: ChangeMaskGenerator_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CHANGEMASKGENERATOR_SHARED
+#define H_SPAINT_CHANGEMASKGENERATOR_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+#include "../interface/ChangeMaskGenerator.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Calculates the bin of the depth histogram into which a depth value falls.
+ *
+ * Since the live depth values come from a sensor that measures depth in whole millimetres, using one bin per millimetre
+ * loses no information, and clustering the bins gives exactly the same clusters as clustering the sorted depth values.
+ *
+ * \param depth       The depth value (in m).
+ * \param maxDepthMm  The depth (in mm) of the last bin.
+ * \return            The bin into which the depth value falls.
+ */
+_CPU_AND_GPU_CODE_
+inline int calculate_depth_bin(float depth, int maxDepthMm)
+{
+  const int depthMm = static_cast<int>(depth * 1000.0f + 0.5f);
+  return depthMm < 0 ? 0 : depthMm > maxDepthMm ? maxDepthMm : depthMm;
+}
+
+/**
+ * \brief Converts a depth value to the greyscale value used for edge detection.
+ *
+ * This matches the conversion made by OpenCVUtil::make_greyscale_image with a scale factor of 100.
+ *
+ * \param depth The depth value (in m).
+ * \return      The greyscale value.
+ */
+_CPU_AND_GPU_CODE_
+inline int greyscale_depth(float depth)
+{
+  float value = depth * 100.0f;
+  if(value < 0.0f) value = 0.0f;
+  if(value > 255.0f) value = 255.0f;
+  return static_cast<int>(value);
+}
+
+/**
+ * \brief Reflects a coordinate into the range [0,size) without repeating the border value (as OpenCV's BORDER_REFLECT_101 does).
+ *
+ * \param i     The coordinate.
+ * \param size  The size of the range.
+ * \return      The reflected coordinate.
+ */
+_CPU_AND_GPU_CODE_
+inline int reflect_101(int i, int size)
+{
+  if(i < 0) return -i;
+  if(i >= size) return 2 * size - 2 - i;
+  return i;
+}
+
+/**
+ * \brief Determines whether or not a pixel lies on an edge in the gradient magnitude image of the (greyscale) depth raycast.
+ *
+ * The gradient magnitude is calculated exactly as in the original OpenCV-based implementation: the mean of the absolute
+ * 3x3 Sobel gradients in x and y (saturated to [0,255] and rounded half to even), with reflection at the image borders.
+ *
+ * \param x                   The x coordinate of the pixel.
+ * \param y                   The y coordinate of the pixel.
+ * \param depthRaycast        The depth raycast.
+ * \param width               The width of the depth raycast.
+ * \param height              The height of the depth raycast.
+ * \param depthEdgeThreshold  The gradient magnitude above which a pixel is treated as an edge.
+ * \param depthEdges          The mask in which to mark the edges.
+ */
+_CPU_AND_GPU_CODE_
+inline void detect_depth_edge(int x, int y, const float *depthRaycast, int width, int height, int depthEdgeThreshold, unsigned char *depthEdges)
+{
+  int g[3][3];
+  for(int dy = -1; dy <= 1; ++dy)
+  {
+    const int row = reflect_101(y + dy, height) * width;
+    for(int dx = -1; dx <= 1; ++dx)
+    {
+      g[dy + 1][dx + 1] = greyscale_depth(depthRaycast[row + reflect_101(x + dx, width)]);
+    }
+  }
+
+  int gradX = (g[0][2] + 2 * g[1][2] + g[2][2]) - (g[0][0] + 2 * g[1][0] + g[2][0]);
+  int gradY = (g[2][0] + 2 * g[2][1] + g[2][2]) - (g[0][0] + 2 * g[0][1] + g[0][2]);
+  if(gradX < 0) gradX = -gradX;
+  if(gradY < 0) gradY = -gradY;
+  if(gradX > 255) gradX = 255;
+  if(gradY > 255) gradY = 255;
+
+  const int sum = gradX + gradY;
+  const int grad = sum / 2 + ((sum & 1) && ((sum / 2) & 1) ? 1 : 0);
+
+  depthEdges[y * width + x] = grad > depthEdgeThreshold ? 255 : 0;
+}
+
+/**
+ * \brief Dilates a pixel in a binary mask along a single axis, considering only those neighbours that lie within the image.
+ *
+ * \param x           The x coordinate of the pixel.
+ * \param y           The y coordinate of the pixel.
+ * \param input       The input mask.
+ * \param width       The width of the mask.
+ * \param height      The height of the mask.
+ * \param radius      The radius of the dilation.
+ * \param horizontal  Whether to dilate along the x axis (true) or the y axis (false).
+ * \param output      The output mask.
+ */
+_CPU_AND_GPU_CODE_
+inline void dilate_pixel(int x, int y, const unsigned char *input, int width, int height, int radius, bool horizontal, unsigned char *output)
+{
+  const int centre = horizontal ? x : y, size = horizontal ? width : height;
+  const int lo = centre - radius < 0 ? 0 : centre - radius;
+  const int hi = centre + radius >= size ? size - 1 : centre + radius;
+
+  unsigned char value = 0;
+  for(int i = lo; i <= hi && !value; ++i)
+  {
+    value = horizontal ? input[y * width + i] : input[i * width + x];
+  }
+
+  output[y * width + x] = value;
+}
+
+/**
+ * \brief Marks the depths that belong to clusters in the depth histogram that are below a certain size.
+ *
+ * A new cluster starts wherever the gap between consecutive non-empty bins is greater than the specified size.
+ *
+ * \param histogram           The depth histogram.
+ * \param binCount            The number of bins in the depth histogram.
+ * \param maxGap              The maximum gap (in bins) to allow between consecutive non-empty bins within the same cluster.
+ * \param minClusterSize      The minimum size of cluster to retain.
+ * \param smallClusterDepths  An array in which to mark the depths that belong to small clusters.
+ */
+_CPU_AND_GPU_CODE_
+inline void find_small_depth_clusters(const int *histogram, int binCount, int maxGap, int minClusterSize, unsigned char *smallClusterDepths)
+{
+  for(int i = 0; i < binCount; ++i) smallClusterDepths[i] = 0;
+
+  int clusterSize = 0, clusterStart = -1, lastBin = -1;
+  for(int i = 0; i <= binCount; ++i)
+  {
+    // Skip any empty bins (the extra iteration at the end is used to close the final cluster).
+    if(i < binCount && histogram[i] == 0) continue;
+
+    // If this bin starts a new cluster, or we have reached the end of the histogram, close the current cluster.
+    if(lastBin != -1 && (i == binCount || i - lastBin > maxGap))
+    {
+      if(clusterSize < minClusterSize)
+      {
+        for(int j = clusterStart; j <= lastBin; ++j) smallClusterDepths[j] = 1;
+      }
+
+      clusterSize = 0;
+    }
+
+    if(i == binCount) break;
+
+    if(clusterSize == 0) clusterStart = i;
+    clusterSize += histogram[i];
+    lastBin = i;
+  }
+}
+
+/**
+ * \brief Determines whether or not a pixel should be part of the initial change mask.
+ *
+ * \param pixelIndex          The index of the pixel.
+ * \param width               The width of the images.
+ * \param height              The height of the images.
+ * \param thresholdedRawDepth The live depth image, with any pixels that are too far away set to -1.
+ * \param depthRaycast        The depth raycast of the scene.
+ * \param diffRawRaycast      The absolute difference (in m) between the live depth image and the depth raycast.
+ * \param dilatedDepthEdges   The dilated edges in the gradient magnitude image of the depth raycast.
+ * \param invalidDepthValue   The value used in the depth raycast to denote parts of the scene for which there is no information.
+ * \param thresholds          The thresholds to use.
+ * \param changeMask          The change mask.
+ */
+_CPU_AND_GPU_CODE_
+inline void make_initial_change_pixel(int pixelIndex, int width, int height, const float *thresholdedRawDepth, const float *depthRaycast,
+                                      const float *diffRawRaycast, const unsigned char *dilatedDepthEdges, float invalidDepthValue,
+                                      const ChangeMaskGenerator::Thresholds& thresholds, unsigned char *changeMask)
+{
+  // If the live depth value for the pixel is invalid, remove it from the change mask (it can't form part of the final
+  // mask that we will use for object reconstruction, since without depth it can't be fused).
+  const float rawDepth = thresholdedRawDepth[pixelIndex];
+  if(rawDepth == -1.0f)
+  {
+    changeMask[pixelIndex] = 0;
+    return;
+  }
+
+  // If the depth raycast value for the pixel is invalid, remove it from the change mask (without a depth raycast value,
+  // we can't do background subtraction).
+  if(fabs(depthRaycast[pixelIndex] - invalidDepthValue) < 1e-3f)
+  {
+    changeMask[pixelIndex] = 0;
+    return;
+  }
+
+  // If the live depth value for the pixel is too large, remove it from the change mask (the depth gets increasingly
+  // unreliable as we get further away from the sensor, so this helps us avoid corrupting our mask with noise).
+  if(rawDepth * 1000.0f > thresholds.upperDepthThresholdMm)
+  {
+    changeMask[pixelIndex] = 0;
+    return;
+  }
+
+  // If the pixel is close to the corners of the image, remove it from the change mask (the depth gets increasingly
+  // unreliable as we get further away from the centre of the image).
+  const float halfWidth = width / 2.0f, halfHeight = height / 2.0f;
+  const int x = pixelIndex % width, y = pixelIndex / width;
+  const float xDist = fabs(x - halfWidth), yDist = fabs(y - halfHeight);
+  const float centreDist = sqrtf((xDist * xDist + yDist * yDist) / (halfWidth * halfWidth + halfHeight * halfHeight));
+  if(static_cast<int>(centreDist * 100) > thresholds.centreDistThreshold)
+  {
+    changeMask[pixelIndex] = 0;
+    return;
+  }
+
+  // If the difference between the pixel's values in the live depth image and the depth raycast is quite small,
+  // remove it from the change mask (this helps exclude minor differences that are caused by sensor noise).
+  const float diffRawRaycastMm = diffRawRaycast[pixelIndex] * 1000.0f;
+  if(diffRawRaycastMm < thresholds.lowerDiffThresholdMm)
+  {
+    changeMask[pixelIndex] = 0;
+    return;
+  }
+
+  // If the pixel is close to an edge in the depth raycast and there isn't a fairly significant difference between
+  // its values in the live depth image and the depth raycast, remove it from the change mask (we insist on a larger
+  // difference than normal near depth raycast edges because depth values tend to be unreliable along such boundaries).
+  if(dilatedDepthEdges[pixelIndex] && diffRawRaycastMm < thresholds.lowerDiffThresholdNearEdgesMm)
+  {
+    changeMask[pixelIndex] = 0;
+    return;
+  }
+
+  changeMask[pixelIndex] = 255;
+}
+
+/**
+ * \brief Removes a pixel from the change mask if its depth belongs to a cluster that is too small to retain.
+ *
+ * \param pixelIndex          The index of the pixel.
+ * \param thresholdedRawDepth The live depth image, with any pixels that are too far away set to -1.
+ * \param smallClusterDepths  An array indicating which depths (in mm) belong to clusters that are too small to retain.
+ * \param maxDepthMm          The depth (in mm) of the last bin of the depth histogram.
+ * \param changeMask          The change mask.
+ */
+_CPU_AND_GPU_CODE_
+inline void remove_small_depth_cluster_pixel(int pixelIndex, const float *thresholdedRawDepth, const unsigned char *smallClusterDepths,
+                                             int maxDepthMm, unsigned char *changeMask)
+{
+  if(changeMask[pixelIndex] && smallClusterDepths[calculate_depth_bin(thresholdedRawDepth[pixelIndex], maxDepthMm)])
+  {
+    changeMask[pixelIndex] = 0;
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * spaint: DepthMasker_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_DEPTHMASKER_SHARED
+#define H_SPAINT_DEPTHMASKER_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Applies a binary mask to a pixel of a depth image.
+ *
+ * \param pixelIndex      The index of the pixel.
+ * \param mask            The binary mask.
+ * \param depth           The depth image.
+ * \param backgroundValue The value to use for background pixels in the masked depth image.
+ * \param maskedDepth     The masked depth image.
+ */
+_CPU_AND_GPU_CODE_
+inline void mask_depth_pixel(int pixelIndex, const unsigned char *mask, const float *depth, float backgroundValue, float *maskedDepth)
+{
+  maskedDepth[pixelIndex] = mask[pixelIndex] ? depth[pixelIndex] : backgroundValue;
+}
+
+}
+
+#endif
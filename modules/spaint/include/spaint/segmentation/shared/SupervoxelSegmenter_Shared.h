@@ -0,0 +1,178 @@
+/**
+ * spaint: SupervoxelSegmenter_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_SUPERVOXELSEGMENTER_SHARED
+#define H_SPAINT_SUPERVOXELSEGMENTER_SHARED
+
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+
+#include "../interface/SupervoxelSegmenter.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Reads the position, normal and colour of the surface voxel (if any) at the specified pixel of the raycast result.
+ *
+ * \param pixelIndex    The index of the pixel in the raycast result.
+ * \param raycastResult The raycast result.
+ * \param voxelData     The scene's voxel data.
+ * \param indexData     The scene's index data.
+ * \param point         A seed into which to write the position, normal and colour of the surface voxel (its valid flag is also set).
+ */
+_CPU_AND_GPU_CODE_
+inline void read_surface_point(int pixelIndex, const Vector4f *raycastResult, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                               SupervoxelSegmenter::Seed& point)
+{
+  point.valid = false;
+
+  const Vector4f loc = raycastResult[pixelIndex];
+  if(loc.w <= 0) return;
+
+  point.position = loc.toVector3();
+
+  bool isFound;
+  const SpaintVoxel voxel = readVoxel(voxelData, indexData, point.position.toIntRound(), isFound);
+  if(!isFound) return;
+
+  const Vector3u colour = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxel);
+  point.colour = Vector3f(colour.r, colour.g, colour.b);
+  point.normal = computeSingleNormalFromSDF(voxelData, indexData, point.position);
+  point.valid = true;
+}
+
+/**
+ * \brief Assigns a member to the most similar nearby seed (if any), and writes the location and new label of its voxel.
+ *
+ * The member is compared with the seeds of its own cell and the eight surrounding cells. The cost of assigning it to one of them
+ * is the sum of its squared distance from the seed, the difference between their normals and the squared distance between their
+ * colours, each normalised so that the largest allowed value is 1. Seeds that exceed any of the limits are not considered at all.
+ *
+ * \param memberIndex       The index of the member.
+ * \param memberGridWidth   The width of the grid of members.
+ * \param memberStride      The spacing (in pixels) between adjacent members.
+ * \param width             The width of the raycast result.
+ * \param gridWidth         The width of the grid of seed cells.
+ * \param gridHeight        The height of the grid of seed cells.
+ * \param seedSpacing       The side length (in pixels) of a seed cell.
+ * \param raycastResult     The raycast result.
+ * \param voxelData         The scene's voxel data.
+ * \param labelData         The scene's label data (if any).
+ * \param indexData         The scene's index data.
+ * \param seeds             The seeds of the supervoxels.
+ * \param seedLabels        The labels predicted for the seeds.
+ * \param maxRadius         The maximum distance (in voxels) allowed between the positions of a member and its seed.
+ * \param minNormalDot      The minimum dot product allowed between the normals of a member and its seed.
+ * \param maxColourDistance The maximum distance allowed between the colours of a member and its seed.
+ * \param memberLocations   An array into which to write the locations of the members' voxels.
+ * \param memberLabels      An array into which to write the new labels of the members' voxels.
+ */
+_CPU_AND_GPU_CODE_
+inline void assign_member(int memberIndex, int memberGridWidth, int memberStride, int width, int gridWidth, int gridHeight, int seedSpacing,
+                          const Vector4f *raycastResult, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                          const ITMVoxelIndex::IndexData *indexData, const SupervoxelSegmenter::Seed *seeds, const SpaintVoxel::PackedLabel *seedLabels,
+                          float maxRadius, float minNormalDot, float maxColourDistance, Vector3s *memberLocations, SpaintVoxel::PackedLabel *memberLabels)
+{
+  const int x = (memberIndex % memberGridWidth) * memberStride;
+  const int y = (memberIndex / memberGridWidth) * memberStride;
+
+  SupervoxelSegmenter::Seed point;
+  read_surface_point(y * width + x, raycastResult, voxelData, indexData, point);
+
+  int bestSeed = -1;
+  if(point.valid)
+  {
+    const int cx = x / seedSpacing, cy = y / seedSpacing;
+    float bestCost = 3.0f;
+    for(int ny = cy - 1; ny <= cy + 1; ++ny)
+    {
+      if(ny < 0 || ny >= gridHeight) continue;
+      for(int nx = cx - 1; nx <= cx + 1; ++nx)
+      {
+        if(nx < 0 || nx >= gridWidth) continue;
+
+        const int seedIndex = ny * gridWidth + nx;
+        const SupervoxelSegmenter::Seed& seed = seeds[seedIndex];
+        if(!seed.valid) continue;
+
+        const Vector3f positionOffset = point.position - seed.position;
+        const float positionCost = dot(positionOffset, positionOffset) / (maxRadius * maxRadius);
+        const float normalCost = (1.0f - dot(point.normal, seed.normal)) / (1.0f - minNormalDot);
+        const Vector3f colourOffset = point.colour - seed.colour;
+        const float colourCost = dot(colourOffset, colourOffset) / (maxColourDistance * maxColourDistance);
+        if(positionCost > 1.0f || normalCost > 1.0f || colourCost > 1.0f) continue;
+
+        const float cost = positionCost + normalCost + colourCost;
+        if(cost <= bestCost)
+        {
+          bestCost = cost;
+          bestSeed = seedIndex;
+        }
+      }
+    }
+  }
+
+  const Vector3s loc = point.valid ? point.position.toShortRound() : Vector3s(0,0,0);
+  memberLocations[memberIndex] = loc;
+
+  if(bestSeed >= 0)
+  {
+    memberLabels[memberIndex] = seedLabels[bestSeed];
+  }
+  else
+  {
+    // If the member wasn't assigned to any seed, give its voxel its existing label, so that marking it has no effect.
+    bool isFound;
+    const int voxelAddress = findVoxel(indexData, loc.toInt(), isFound);
+    memberLabels[memberIndex] = isFound ? get_voxel_label(voxelAddress, voxelData, labelData) : SpaintVoxel::PackedLabel();
+  }
+}
+
+/**
+ * \brief Chooses the seed of a cell, and writes the location of the seed voxel.
+ *
+ * The seed is the surface voxel at the centre of the cell if there is one, or otherwise the first surface voxel found
+ * at the members in the cell (in raster order). If no surface voxel is visible in the cell, its seed is invalid.
+ *
+ * \param cellIndex     The index of the cell.
+ * \param gridWidth     The width of the grid of seed cells.
+ * \param seedSpacing   The side length (in pixels) of a seed cell.
+ * \param memberStride  The spacing (in pixels) between adjacent members.
+ * \param width         The width of the raycast result.
+ * \param height        The height of the raycast result.
+ * \param raycastResult The raycast result.
+ * \param voxelData     The scene's voxel data.
+ * \param indexData     The scene's index data.
+ * \param seeds         The seeds of the supervoxels.
+ * \param seedLocations An array into which to write the locations of the seed voxels.
+ */
+_CPU_AND_GPU_CODE_
+inline void select_seed(int cellIndex, int gridWidth, int seedSpacing, int memberStride, int width, int height, const Vector4f *raycastResult,
+                        const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData, SupervoxelSegmenter::Seed *seeds, Vector3s *seedLocations)
+{
+  const int x0 = (cellIndex % gridWidth) * seedSpacing, y0 = (cellIndex / gridWidth) * seedSpacing;
+  const int x1 = MIN(x0 + seedSpacing, width), y1 = MIN(y0 + seedSpacing, height);
+
+  SupervoxelSegmenter::Seed seed;
+  read_surface_point(((y0 + y1) / 2) * width + (x0 + x1) / 2, raycastResult, voxelData, indexData, seed);
+
+  // Note: The first member in the cell is the first pixel at a multiple of the member stride in each direction.
+  const int mx0 = (x0 + memberStride - 1) / memberStride * memberStride, my0 = (y0 + memberStride - 1) / memberStride * memberStride;
+  for(int y = my0; !seed.valid && y < y1; y += memberStride)
+  {
+    for(int x = mx0; !seed.valid && x < x1; x += memberStride)
+    {
+      read_surface_point(y * width + x, raycastResult, voxelData, indexData, seed);
+    }
+  }
+
+  seeds[cellIndex] = seed;
+  seedLocations[cellIndex] = seed.valid ? seed.position.toShortRound() : Vector3s(0,0,0);
+}
+
+}
+
+#endif
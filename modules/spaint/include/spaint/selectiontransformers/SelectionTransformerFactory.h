@@ -9,6 +9,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include "interface/SelectionTransformer.h"
+#include "../util/SpaintVoxelScene.h"
 
 namespace spaint {
 
@@ -32,6 +33,17 @@ public:
    * \return            The selection transformer.
    */
   static SelectionTransformer_Ptr make_voxel_to_cube(int radius, ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  /**
+   * \brief Makes a voxel to surface selection transformer.
+   *
+   * \param radius      The (Euclidean) radius (in voxels) of the sphere to select around each initial voxel.
+   * \param maxSDF      The maximum absolute (normalised) TSDF value that a voxel can have if it is to be selected.
+   * \param scene       The scene whose voxels are to be selected.
+   * \param deviceType  The device on which the transformer should operate.
+   * \return            The selection transformer.
+   */
+  static SelectionTransformer_Ptr make_voxel_to_surface(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene, ITMLib::ITMLibSettings::DeviceType deviceType);
 };
 
 }
@@ -0,0 +1,38 @@
+/**
+ * spaint: VoxelToSurfaceSelectionTransformer_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER_CPU
+#define H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER_CPU
+
+#include "../interface/VoxelToSurfaceSelectionTransformer.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to expand a selection of individual voxels into a selection of the near-surface
+ *        voxels within a sphere around each of the initial voxels using the CPU.
+ */
+class VoxelToSurfaceSelectionTransformer_CPU : public VoxelToSurfaceSelectionTransformer
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a voxel to surface selection transformer that uses the CPU.
+   *
+   * \param radius  The initial (Euclidean) radius (in voxels) of the sphere to select around each initial voxel.
+   * \param maxSDF  The maximum absolute (normalised) TSDF value that a voxel can have if it is to be selected.
+   * \param scene   The scene whose voxels are to be selected.
+   */
+  VoxelToSurfaceSelectionTransformer_CPU(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void transform_selection(const Selection& inputSelectionMB, Selection& outputSelectionMB) const;
+};
+
+}
+
+#endif
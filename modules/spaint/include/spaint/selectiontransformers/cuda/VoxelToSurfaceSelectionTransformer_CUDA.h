@@ -0,0 +1,43 @@
+/**
+ * spaint: VoxelToSurfaceSelectionTransformer_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER_CUDA
+#define H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER_CUDA
+
+#include "../interface/VoxelToSurfaceSelectionTransformer.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to expand a selection of individual voxels into a selection of the near-surface
+ *        voxels within a sphere around each of the initial voxels using CUDA.
+ */
+class VoxelToSurfaceSelectionTransformer_CUDA : public VoxelToSurfaceSelectionTransformer
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to count the voxels that are selected. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_outputVoxelCountMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a voxel to surface selection transformer that uses CUDA.
+   *
+   * \param radius  The initial (Euclidean) radius (in voxels) of the sphere to select around each initial voxel.
+   * \param maxSDF  The maximum absolute (normalised) TSDF value that a voxel can have if it is to be selected.
+   * \param scene   The scene whose voxels are to be selected.
+   */
+  VoxelToSurfaceSelectionTransformer_CUDA(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void transform_selection(const Selection& inputSelectionMB, Selection& outputSelectionMB) const;
+};
+
+}
+
+#endif
@@ -11,6 +11,7 @@ namespace spaint {
 //#################### FORWARD DECLARATIONS ####################
 
 class VoxelToCubeSelectionTransformer;
+class VoxelToSurfaceSelectionTransformer;
 
 /**
  * \brief An instance of a class deriving from this one can be used to visit selection transformers.
@@ -32,6 +33,13 @@ public:
    * \param transformer The selection transformer.
    */
   virtual void visit(const VoxelToCubeSelectionTransformer& transformer) const = 0;
+
+  /**
+   * \brief Visits a voxel to surface selection transformer.
+   *
+   * \param transformer The selection transformer.
+   */
+  virtual void visit(const VoxelToSurfaceSelectionTransformer& transformer) const = 0;
 };
 
 }
@@ -0,0 +1,81 @@
+/**
+ * spaint: VoxelToSurfaceSelectionTransformer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER
+#define H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER
+
+#include "SelectionTransformer.h"
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to expand a selection of individual voxels into a selection of the near-surface
+ *        voxels in the scene that lie within a sphere around each of the initial voxels.
+ *
+ * Rather than enumerating every voxel in a cube around each initial voxel (as VoxelToCubeSelectionTransformer does), only the
+ * allocated voxel blocks that intersect each sphere (and that are not known to contain only empty space) are examined, and only
+ * those voxels that have been observed and whose TSDF values are close enough to zero are selected. This keeps the output
+ * selection small even for large radii, since most of the voxels in a large cube are in free space or deep inside surfaces.
+ *
+ * Since the number of voxels selected depends on the scene, the output selection is allocated using an upper bound on its size,
+ * and its data size is then reduced to the number of voxels that were actually selected.
+ */
+class VoxelToSurfaceSelectionTransformer : public SelectionTransformer
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The maximum absolute (normalised) TSDF value that a voxel can have if it is to be selected. */
+  float m_maxSDF;
+
+  /** The (Euclidean) radius (in voxels) of the sphere to select around each initial voxel. */
+  int m_radius;
+
+  /** The scene whose voxels are to be selected. */
+  SpaintVoxelScene_CPtr m_scene;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a voxel to surface selection transformer.
+   *
+   * \param radius      The initial (Euclidean) radius (in voxels) of the sphere to select around each initial voxel.
+   * \param maxSDF      The maximum absolute (normalised) TSDF value that a voxel can have if it is to be selected.
+   * \param scene       The scene whose voxels are to be selected.
+   * \param deviceType  The device on which the transformer is operating.
+   */
+  VoxelToSurfaceSelectionTransformer(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene, ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void accept(const SelectionTransformerVisitor& visitor) const;
+
+  /** Override */
+  virtual size_t compute_output_selection_size(const Selection& inputSelectionMB) const;
+
+  /**
+   * \brief Gets the (Euclidean) radius (in voxels) of the sphere to select around each initial voxel.
+   *
+   * \return  The (Euclidean) radius (in voxels) of the sphere to select around each initial voxel.
+   */
+  int get_radius() const;
+
+  /** Override */
+  virtual void update(const tvginput::InputState& inputState);
+
+  //#################### PROTECTED MEMBER FUNCTIONS ####################
+protected:
+  /**
+   * \brief Calculates an upper bound on the number of voxels that can be selected around each initial voxel.
+   *
+   * \return  An upper bound on the number of voxels that can be selected around each initial voxel.
+   */
+  int max_voxels_per_sphere() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * spaint: VoxelToSurfaceSelectionTransformer_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER_SHARED
+#define H_SPAINT_VOXELTOSURFACESELECTIONTRANSFORMER_SHARED
+
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+
+#include "../../util/SpaintVoxelScene.h"
+#include "../../visualisation/shared/BlockOccupancy_Shared.h"
+
+namespace spaint {
+
+/**
+ * \brief Determines whether or not the specified voxel block intersects a sphere of voxels.
+ *
+ * \param blockPos      The position of the voxel block (in blocks).
+ * \param centre        The position of the centre of the sphere (in voxels).
+ * \param radiusSquared The square of the radius of the sphere (in voxels).
+ * \return              true, if the voxel block intersects the sphere, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool block_intersects_sphere(const Vector3i& blockPos, const Vector3i& centre, int radiusSquared)
+{
+  // Find the squared distance from the centre of the sphere to the nearest voxel in the block.
+  const Vector3i blockMin = blockPos * SDF_BLOCK_SIZE;
+  int distanceSquared = 0;
+  for(int k = 0; k < 3; ++k)
+  {
+    int d = 0;
+    if(centre[k] < blockMin[k]) d = blockMin[k] - centre[k];
+    else if(centre[k] > blockMin[k] + SDF_BLOCK_SIZE - 1) d = centre[k] - (blockMin[k] + SDF_BLOCK_SIZE - 1);
+    distanceSquared += d * d;
+  }
+  return distanceSquared <= radiusSquared;
+}
+
+/**
+ * \brief Finds the voxel block at the specified position, provided that it is allocated and might contain some surface voxels.
+ *
+ * \param blockPos        The position of the voxel block (in blocks).
+ * \param voxelIndex      The scene's voxel index.
+ * \param blockOccupancy  The scene's block occupancy data (if any).
+ * \return                The address of the first voxel in the block, if it was found, or -1 otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline int find_surface_block(const Vector3i& blockPos, const ITMVoxelIndex::IndexData *voxelIndex, const SpaintVoxelScene::BlockOccupancy *blockOccupancy)
+{
+  ITMVoxelBlockHash::IndexCache cache;
+  int vmIndex;
+  const int blockAddress = findVoxel(voxelIndex, blockPos * SDF_BLOCK_SIZE, vmIndex, cache);
+  if(!vmIndex) return -1;
+
+  // Note: If the block was found, vmIndex is one more than the index of its hash entry.
+  if(blockOccupancy && is_known_empty_block(vmIndex - 1, voxelIndex, blockOccupancy)) return -1;
+
+  return blockAddress;
+}
+
+/**
+ * \brief Determines whether or not the specified voxel should be selected by a voxel to surface selection transformer.
+ *
+ * A voxel is selected iff it lies within the sphere, has been observed, and has a TSDF value that is close enough to zero.
+ *
+ * \param linearIdx     The linear index of the voxel within its block.
+ * \param blockPos      The position of the voxel's block (in blocks).
+ * \param blockAddress  The address of the first voxel in the voxel's block.
+ * \param centre        The position of the centre of the sphere (in voxels).
+ * \param radiusSquared The square of the radius of the sphere (in voxels).
+ * \param maxSDF        The maximum absolute (normalised) TSDF value that a voxel can have if it is to be selected.
+ * \param voxelData     The scene's voxel data.
+ * \param loc           A location into which to write the position of the voxel (in voxels), if it is selected.
+ * \return              true, if the voxel should be selected, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool select_surface_voxel(int linearIdx, const Vector3i& blockPos, int blockAddress, const Vector3i& centre, int radiusSquared,
+                                 float maxSDF, const SpaintVoxel *voxelData, Vector3s& loc)
+{
+  const int x = blockPos.x * SDF_BLOCK_SIZE + linearIdx % SDF_BLOCK_SIZE;
+  const int y = blockPos.y * SDF_BLOCK_SIZE + linearIdx / SDF_BLOCK_SIZE % SDF_BLOCK_SIZE;
+  const int z = blockPos.z * SDF_BLOCK_SIZE + linearIdx / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE);
+  const int dx = x - centre.x, dy = y - centre.y, dz = z - centre.z;
+  if(dx * dx + dy * dy + dz * dz > radiusSquared) return false;
+
+  const SpaintVoxel& voxel = voxelData[blockAddress + linearIdx];
+  if(voxel.w_depth == 0) return false;
+
+  const float sdf = SpaintVoxel::valueToFloat(voxel.sdf);
+  if(sdf > maxSDF || sdf < -maxSDF) return false;
+
+  loc = Vector3s(static_cast<short>(x), static_cast<short>(y), static_cast<short>(z));
+  return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * spaint: LeapFramePoller.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LEAPFRAMEPOLLER
+#define H_SPAINT_LEAPFRAMEPOLLER
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+// This #undef is a disgusting hack that is needed to work around the fact that InfiniTAM #defines PI in a header.
+// Since the Leap SDK defines PI as a float (static const float PI = ...), things would break if we didn't do this.
+#undef PI
+
+#include <Leap.h>
+
+#include <tvgutil/containers/TripleBuffer.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class polls the Leap Motion controller for frames of data on a separate thread.
+ *
+ * Querying the controller can stall (e.g. when there is a hiccup on the USB bus), so doing so on the main loop can stall
+ * the rendering. The poller thread instead queries the controller, timestamps each new frame it receives and publishes
+ * it (together with the frame that preceded it, so that consumers can interpolate between the two) via a lock-free
+ * triple buffer. Consumers can thus always get the most recent frames without blocking.
+ *
+ * Each frame is timestamped by mapping the time at which the Leap Motion captured it onto the clock of the poller. The
+ * offset between the two clocks is estimated as the smallest difference observed between the time at which a frame was
+ * received and the time at which it was captured, since this is least affected by the latency of the polling itself.
+ */
+class LeapFramePoller
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents a frame of data from the Leap Motion, captured at a particular time.
+   */
+  struct FrameSample
+  {
+    /** The frame of data (invalid if no frame has been received yet). */
+    Leap::Frame frame;
+
+    /** The time (in seconds, relative to the construction of the poller) at which the frame was captured. */
+    double timestamp;
+
+    FrameSample() : timestamp(0.0) {}
+  };
+
+  /**
+   * \brief An instance of this struct represents the most recent frame received from the Leap Motion, together with the frame that preceded it.
+   */
+  struct FramePair
+  {
+    /** The most recent frame. */
+    FrameSample latest;
+
+    /** The frame that preceded the most recent frame (invalid if only one frame has been received so far). */
+    FrameSample previous;
+  };
+
+private:
+  typedef boost::chrono::steady_clock Clock;
+
+  //#################### CONSTANTS ####################
+private:
+  /** The amount (in seconds) by which the estimated clock offset is allowed to grow after each frame (so that it can follow any drift between the clocks). */
+  static const double CLOCK_OFFSET_RELAXATION;
+
+  /** The time (in microseconds) for which the poller thread sleeps when no new frame is available. */
+  static const int POLL_INTERVAL_MICROSECONDS = 500;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The estimated offset (in seconds) between the clock of the poller and the clock of the Leap Motion (only accessed by the poller thread). */
+  double m_clockOffset;
+
+  /** The time at which the poller was constructed. */
+  Clock::time_point m_creationTime;
+
+  /** A triple buffer in which the poller thread publishes the most recent frames. */
+  tvgutil::TripleBuffer<FramePair> m_frames;
+
+  /** The Leap Motion controller (only accessed by the poller thread once it has started). */
+  Leap::Controller m_leap;
+
+  /** The thread on which the Leap Motion controller is polled. */
+  boost::thread m_poller;
+
+  /** A flag set in the destructor to indicate that the poller thread should terminate. */
+  boost::atomic<bool> m_pollerShouldTerminate;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a Leap frame poller, and starts polling the Leap Motion controller.
+   */
+  LeapFramePoller();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the Leap frame poller.
+   *
+   * \note  This blocks until the poller thread has finished its current query of the Leap Motion controller.
+   */
+  ~LeapFramePoller();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  LeapFramePoller(const LeapFramePoller&);
+  LeapFramePoller& operator=(const LeapFramePoller&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the current time (in seconds, relative to the construction of the poller).
+   *
+   * \return  The current time.
+   */
+  double get_current_time() const;
+
+  /**
+   * \brief Gets the most recent frames received from the Leap Motion, without blocking.
+   *
+   * \note  This must only be called by a single consumer thread.
+   *
+   * \return  The most recent frames received from the Leap Motion (whose frames are invalid if none have been received yet).
+   *          The frames remain valid until the next call to this function.
+   */
+  const FramePair& get_latest_frames();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Polls the Leap Motion controller until termination is requested.
+   */
+  void run_poller();
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<LeapFramePoller> LeapFramePoller_Ptr;
+
+}
+
+#endif
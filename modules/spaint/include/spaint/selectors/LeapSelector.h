@@ -8,16 +8,11 @@
 
 #include <Eigen/Dense>
 
-// This #undef is a disgusting hack that is needed to work around the fact that InfiniTAM #defines PI in a header.
-// Since the Leap SDK defines PI as a float (static const float PI = ...), things would break if we didn't do this.
-#undef PI
-
-#include <Leap.h>
-
 #include <ITMLib/Engines/Visualisation/Interface/ITMVisualisationEngine.h>
 
 #include <rigging/MoveableCamera.h>
 
+#include "LeapFramePoller.h"
 #include "Selector.h"
 #include "../picking/interface/Picker.h"
 
@@ -57,8 +52,11 @@ private:
   /** The most recent frame of data from the Leap Motion. */
   Leap::Frame m_frame;
 
-  /** The Leap Motion controller. */
-  Leap::Controller m_leap;
+  /** The delay (in seconds) behind the current time at which to sample the user's index finger (0 means use the most recent frame as is). */
+  double m_interpolationDelay;
+
+  /** The Leap frame poller, which polls the Leap Motion controller on a separate thread. */
+  LeapFramePoller_Ptr m_leap;
 
   /** The mode in which the selector is operating. */
   Mode m_mode;
@@ -154,6 +152,22 @@ public:
    * \return          The size in the InfiniTAM coordinate system.
    */
   static float from_leap_size(float leapSize);
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Interpolates the tip position and direction of the user's index finger between the two most recent Leap frames.
+   *
+   * If the finger cannot be found in both frames (e.g. the hand was only detected in the most recent one), or the specified
+   * time is later than the most recent frame, the tip position and direction in the most recent frame are used as they are
+   * (we deliberately avoid extrapolating). If the time is earlier than the previous frame, the previous frame is used.
+   *
+   * \param frames  The two most recent Leap frames (the most recent one must contain exactly one hand).
+   * \param t       The time (as returned by the Leap frame poller) at which to interpolate.
+   * \param tipPos  A vector into which to write the (interpolated) tip position of the index finger.
+   * \param tipDir  A vector into which to write the (interpolated) direction of the index finger.
+   */
+  static void interpolate_index_finger(const LeapFramePoller::FramePair& frames, double t, Leap::Vector& tipPos, Leap::Vector& tipDir);
 };
 
 }
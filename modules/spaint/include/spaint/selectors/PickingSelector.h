@@ -22,6 +22,9 @@ class PickingSelector : public Selector
 {
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The most recent point picked by the user whose result has reached the CPU, in voxel coordinates. */
+  Vector3f m_latestPickPoint;
+
   /** The picker. */
   Picker_CPtr m_picker;
 
@@ -8,10 +8,14 @@
 
 #include <map>
 
+#include <boost/optional.hpp>
+
 #include <itmx/base/ITMImagePtrTypes.h>
 #include <itmx/base/ITMObjectPtrTypes.h>
 
 #include "../fiducials/Fiducial.h"
+#include "../imagesources/FrameTimestamps.h"
+#include "../swapping/interface/VoxelSceneArchive.h"
 #include "../util/SpaintSurfelScene.h"
 #include "../util/SpaintVoxelScene.h"
 
@@ -33,12 +37,21 @@ private:
   /** The image into which depth input is read each frame. */
   ITMShortImage_Ptr m_inputRawDepthImage;
 
+  /** The region (if any) of the input images, in the form (minX,minY,maxX,maxY), outside which they are known to contain nothing of interest. */
+  boost::optional<Vector4i> m_inputRegion;
+
   /** The image into which RGB input is read each frame. */
   ITMUChar4Image_Ptr m_inputRGBImage;
 
+  /** The timestamps of the frame currently in the input images. */
+  FrameTimestamps m_inputTimestamps;
+
   /** The surfel render state corresponding to the live camera pose. */
   SurfelRenderState_Ptr m_liveSurfelRenderState;
 
+  /** The pose (if any) from which the raycast in the live voxel render state was computed, if that raycast is up to date with the voxel scene. */
+  boost::optional<ORUtils::SE3Pose> m_liveVoxelRaycastPose;
+
   /** The voxel render state corresponding to the live camera pose. */
   VoxelRenderState_Ptr m_liveVoxelRenderState;
 
@@ -54,6 +67,19 @@ private:
   /** The current reconstructed voxel scene. */
   SpaintVoxelScene_Ptr m_voxelScene;
 
+  /** The archive from which the voxel scene was loaded (if any), and from which the parts of it that have not yet been seen are loaded lazily. */
+  VoxelSceneArchive_Ptr m_voxelSceneArchive;
+
+  /** A counter that is incremented whenever the geometry of the voxel scene may have changed (e.g. when a frame has been fused into it). */
+  size_t m_voxelSceneVersion;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a SLAM state.
+   */
+  SLAMState();
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -91,6 +117,13 @@ public:
    */
   ITMShortImage_Ptr get_input_raw_depth_image_copy() const;
 
+  /**
+   * \brief Gets the region (if any) of the input images outside which they are known to contain nothing of interest.
+   *
+   * \return  The region (if any), in the form (minX,minY,maxX,maxY), with inclusive bounds.
+   */
+  const boost::optional<Vector4i>& get_input_region() const;
+
   /**
    * \brief Gets the image into which RGB input is read each frame.
    *
@@ -105,6 +138,13 @@ public:
    */
   ITMUChar4Image_Ptr get_input_rgb_image_copy() const;
 
+  /**
+   * \brief Gets the timestamps of the frame currently in the input images.
+   *
+   * \return  The timestamps of the frame currently in the input images.
+   */
+  const FrameTimestamps& get_input_timestamps() const;
+
   /**
    * \brief Gets the intrinsic parameters for the camera that is being used to reconstruct the scene.
    *
@@ -119,6 +159,13 @@ public:
    */
   const SurfelRenderState_Ptr& get_live_surfel_render_state();
 
+  /**
+   * \brief Gets the pose (if any) from which the raycast in the live voxel render state was computed, if that raycast is up to date with the voxel scene.
+   *
+   * \return  The pose (if any) from which the raycast in the live voxel render state was computed, if that raycast is up to date with the voxel scene.
+   */
+  const boost::optional<ORUtils::SE3Pose>& get_live_voxel_raycast_pose() const;
+
   /**
    * \brief Gets the voxel render state corresponding to the live camera pose for the scene.
    *
@@ -126,6 +173,13 @@ public:
    */
   const VoxelRenderState_Ptr& get_live_voxel_render_state();
 
+  /**
+   * \brief Gets the voxel render state corresponding to the live camera pose for the scene.
+   *
+   * \return  The voxel render state corresponding to the live camera pose for the scene.
+   */
+  VoxelRenderState_CPtr get_live_voxel_render_state() const;
+
   /**
    * \brief Gets the current pose of the camera that is being used to reconstruct the scene.
    *
@@ -196,6 +250,29 @@ public:
    */
   SpaintVoxelScene_CPtr get_voxel_scene() const;
 
+  /**
+   * \brief Gets the archive from which the voxel scene was loaded (if any).
+   *
+   * \return  The archive from which the voxel scene was loaded (if any).
+   */
+  const VoxelSceneArchive_Ptr& get_voxel_scene_archive();
+
+  /**
+   * \brief Gets the current version of the voxel scene.
+   *
+   * The version is incremented whenever the geometry of the voxel scene may have changed, so a raycast of the scene
+   * can safely be reused for as long as the version remains the same. Note that changes to the semantic labels of
+   * the voxels do not change the version, since they do not affect the surfaces found by raycasting.
+   *
+   * \return  The current version of the voxel scene.
+   */
+  size_t get_voxel_scene_version() const;
+
+  /**
+   * \brief Notifies the SLAM state that the geometry of the voxel scene may have changed (e.g. because a frame has been fused into it).
+   */
+  void notify_voxel_scene_changed();
+
   /**
    * \brief Sets the mask to apply to the input images during tracking.
    *
@@ -210,6 +287,13 @@ public:
    */
   void set_input_raw_depth_image(const ITMShortImage_Ptr& inputRawDepthImage);
 
+  /**
+   * \brief Sets the region (if any) of the input images outside which they are known to contain nothing of interest.
+   *
+   * \param inputRegion The region (if any), in the form (minX,minY,maxX,maxY), with inclusive bounds.
+   */
+  void set_input_region(const boost::optional<Vector4i>& inputRegion);
+
   /**
    * \brief Sets the image into which RGB input is read each frame.
    *
@@ -217,6 +301,13 @@ public:
    */
   void set_input_rgb_image(const ITMUChar4Image_Ptr& inputRGBImage);
 
+  /**
+   * \brief Sets the timestamps of the frame currently in the input images.
+   *
+   * \param inputTimestamps The timestamps of the frame currently in the input images.
+   */
+  void set_input_timestamps(const FrameTimestamps& inputTimestamps);
+
   /**
    * \brief Sets the surfel render state corresponding to the live camera pose.
    *
@@ -224,6 +315,13 @@ public:
    */
   void set_live_surfel_render_state(const SurfelRenderState_Ptr& liveSurfelRenderState);
 
+  /**
+   * \brief Sets the pose (if any) from which the raycast in the live voxel render state was computed.
+   *
+   * \param liveVoxelRaycastPose The pose from which the raycast in the live voxel render state was computed (or boost::none, if the raycast is not up to date with the voxel scene).
+   */
+  void set_live_voxel_raycast_pose(const boost::optional<ORUtils::SE3Pose>& liveVoxelRaycastPose);
+
   /**
    * \brief Sets the voxel render state corresponding to the live camera pose.
    *
@@ -266,6 +364,13 @@ public:
    */
   void set_voxel_scene(const SpaintVoxelScene_Ptr& voxelScene);
 
+  /**
+   * \brief Sets the archive from which the voxel scene was loaded.
+   *
+   * \param voxelSceneArchive The archive from which the voxel scene was loaded (may be NULL).
+   */
+  void set_voxel_scene_archive(const VoxelSceneArchive_Ptr& voxelSceneArchive);
+
   /**
    * \brief Updates the current set of fiducials that we're maintaining with information from
    *        a set of fiducial measurements (e.g. from running a detector on the current frame).
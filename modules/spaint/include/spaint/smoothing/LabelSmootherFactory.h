@@ -11,6 +11,7 @@
 #include <ITMLib/Utils/ITMLibSettings.h>
 
 #include "interface/LabelSmoother.h"
+#include "interface/VoxelLabelSmoother.h"
 
 namespace spaint {
 
@@ -26,10 +27,23 @@ struct LabelSmootherFactory
    *
    * \param maxLabelCount                     The maximum number of labels that can be in use.
    * \param deviceType                        The device on which the label smoother should operate.
+   * \param iterationCount                    The number of smoothing iterations to perform on each call to smooth_labels.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if smoothing is to occur.
    * \return                                  The label smoother.
    */
-  static LabelSmoother_CPtr make_label_smoother(size_t maxLabelCount, ITMLib::ITMLibSettings::DeviceType deviceType, float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f);
+  static LabelSmoother_CPtr make_label_smoother(size_t maxLabelCount, ITMLib::ITMLibSettings::DeviceType deviceType, size_t iterationCount = 1,
+                                                float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f);
+
+  /**
+   * \brief Makes a voxel label smoother, which smooths the labels of the voxels in the scene in 3D.
+   *
+   * \param maxLabelCount   The maximum number of labels that can be in use.
+   * \param maxBlockCount   The maximum number of blocks to smooth on each call to smooth_labels.
+   * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be considered part of the surface.
+   * \param deviceType      The device on which the voxel label smoother should operate.
+   * \return                The voxel label smoother.
+   */
+  static VoxelLabelSmoother_CPtr make_voxel_label_smoother(size_t maxLabelCount, size_t maxBlockCount, float maxSDF, ITMLib::ITMLibSettings::DeviceType deviceType);
 };
 
 }
@@ -22,8 +22,9 @@ public:
    *
    * \param maxLabelCount                     The maximum number of labels that can be in use.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if smoothing is to occur.
+   * \param iterationCount                    The number of smoothing iterations to perform on each call to smooth_labels.
    */
-  LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels);
+  LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, size_t iterationCount);
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -7,14 +7,28 @@
 #define H_SPAINT_LABELSMOOTHER_CUDA
 
 #include "../interface/LabelSmoother.h"
+#include "../../util/cuda/ComponentStream_CUDA.h"
 
 namespace spaint {
 
 /**
  * \brief An instance of this class can be used to smooth the labelling of voxels in the scene using CUDA.
+ *
+ * When more than one iteration is requested, the smoothing is performed by a single tiled kernel. Each thread block loads the
+ * voxel addresses, positions and labels for a tile of the raycast result (plus an apron of one pixel per iteration) into shared
+ * memory, performs all of the iterations there, and then writes back the labels for the tile. This avoids one launch (and one
+ * set of hash lookups per neighbour) per iteration, at the cost of some redundant work in the aprons.
+ *
+ * The smoothing is done on a stream of the smoother's own (see ComponentStream_CUDA), which waits for the work already issued on the
+ * default stream, and which the default stream then waits for in turn.
  */
 class LabelSmoother_CUDA : public LabelSmoother
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The stream on which to do the smoothing. */
+  ComponentStream_CUDA m_stream;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -22,8 +36,10 @@ public:
    *
    * \param maxLabelCount                     The maximum number of labels that can be in use.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if smoothing is to occur.
+   * \param iterationCount                    The number of smoothing iterations to perform on each call to smooth_labels.
+   * \throws std::invalid_argument            If the number of iterations is zero or greater than the maximum supported by the tiled kernel.
    */
-  LabelSmoother_CUDA(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels);
+  LabelSmoother_CUDA(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, size_t iterationCount);
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -0,0 +1,41 @@
+/**
+ * spaint: VoxelLabelSmoother_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELLABELSMOOTHER_CUDA
+#define H_SPAINT_VOXELLABELSMOOTHER_CUDA
+
+#include "../interface/VoxelLabelSmoother.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to smooth the labelling of voxels in the scene in 3D using CUDA.
+ */
+class VoxelLabelSmoother_CUDA : public VoxelLabelSmoother
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based voxel label smoother.
+   *
+   * \param maxLabelCount   The maximum number of labels that can be in use.
+   * \param maxBlockCount   The maximum number of blocks to smooth on each call to smooth_labels.
+   * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be considered part of the surface.
+   * \param voxelMarker     The voxel marker to use to write the smoothed labels back into the scene.
+   */
+  VoxelLabelSmoother_CUDA(size_t maxLabelCount, size_t maxBlockCount, float maxSDF, const VoxelMarker_CPtr& voxelMarker);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual int gather_relabelled_entries(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual int write_smoothed_labels(int entryCount, SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
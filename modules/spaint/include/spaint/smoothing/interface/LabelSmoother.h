@@ -19,6 +19,9 @@ class LabelSmoother
 {
   //#################### PROTECTED VARIABLES ####################
 protected:
+  /** The number of smoothing iterations to perform on each call to smooth_labels. */
+  const size_t m_iterationCount;
+
   /** The maximum number of labels that can be in use. */
   const size_t m_maxLabelCount;
 
@@ -32,8 +35,10 @@ protected:
    *
    * \param maxLabelCount                     The maximum number of labels that can be in use.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if smoothing is to occur.
+   * \param iterationCount                    The number of smoothing iterations to perform on each call to smooth_labels.
+   * \throws std::invalid_argument            If the number of iterations is zero.
    */
-  LabelSmoother(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels);
+  LabelSmoother(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, size_t iterationCount);
 
   //#################### DESTRUCTOR ####################
 public:
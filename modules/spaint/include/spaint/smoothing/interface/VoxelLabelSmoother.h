@@ -0,0 +1,114 @@
+/**
+ * spaint: VoxelLabelSmoother.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELLABELSMOOTHER
+#define H_SPAINT_VOXELLABELSMOOTHER
+
+#include "../../markers/interface/VoxelMarker.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to smooth the labelling of voxels in the scene in 3D.
+ *
+ * Unlike LabelSmoother, which works over the current raycast result, this smooths the labels of the surface voxels in whole
+ * voxel blocks, based on the labels of their neighbours in the voxel graph (the 26 voxels surrounding each voxel, found via
+ * the scene's hash table). It is run incrementally: each call only smooths (some of) the blocks that have had voxels relabelled
+ * by the voxel marker since they were last smoothed, regardless of whether or not they are currently visible.
+ *
+ * The new labels for all of the voxels in the blocks being smoothed are computed before any of them are written, and are then
+ * written back via the voxel marker. Since this in turn flags any blocks whose labels change, smoothing naturally spreads to
+ * neighbouring blocks over successive calls, and stops once the labels stabilise. Only voxels that have no reliable label (i.e.
+ * that are unlabelled or have a label predicted by the forest) are ever relabelled, and the new labels are in the forest group,
+ * so that the smoothed labels are never used for training.
+ */
+class VoxelLabelSmoother
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store a count computed on the device (the number of relabelled blocks or smoothed voxels). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_countMB;
+
+  /** A memory block in which to store the IDs of the hash entries that refer to the relabelled blocks. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_entryIDsMB;
+
+  /** The maximum number of blocks to smooth on each call to smooth_labels. */
+  const size_t m_maxBlockCount;
+
+  /** The maximum number of labels that can be in use. */
+  const size_t m_maxLabelCount;
+
+  /** The maximum absolute (normalised) TSDF value that a voxel can have if it is to be considered part of the surface. */
+  const float m_maxSDF;
+
+  /** A memory block in which to store the new labels of the voxels whose labels are changed by smoothing. */
+  boost::shared_ptr<ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> > m_smoothedVoxelLabelsMB;
+
+  /** A memory block in which to store the locations of the voxels whose labels are changed by smoothing. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_smoothedVoxelLocationsMB;
+
+  /** The voxel marker used to write the smoothed labels back into the scene. */
+  VoxelMarker_CPtr m_voxelMarker;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a voxel label smoother.
+   *
+   * \param maxLabelCount   The maximum number of labels that can be in use.
+   * \param maxBlockCount   The maximum number of blocks to smooth on each call to smooth_labels.
+   * \param maxSDF          The maximum absolute (normalised) TSDF value that a voxel can have if it is to be considered part of the surface.
+   * \param voxelMarker     The voxel marker to use to write the smoothed labels back into the scene.
+   * \throws std::invalid_argument  If maxLabelCount is greater than the maximum supported, or maxBlockCount is zero.
+   */
+  VoxelLabelSmoother(size_t maxLabelCount, size_t maxBlockCount, float maxSDF, const VoxelMarker_CPtr& voxelMarker);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel label smoother.
+   */
+  virtual ~VoxelLabelSmoother();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the IDs of the hash entries that refer to the blocks that have been relabelled since they were last smoothed into the entry IDs memory block.
+   *
+   * \param scene The scene.
+   * \return      The number of entries written.
+   */
+  virtual int gather_relabelled_entries(const SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Computes the smoothed labels of the surface voxels in the blocks referred to by the first few entries in the entry IDs memory
+   *        block, and writes the locations and new labels of those whose labels should change into the smoothed voxel memory blocks.
+   *
+   * This also clears the relabelled block flags for the blocks concerned.
+   *
+   * \param entryCount  The number of entries whose blocks should be smoothed.
+   * \param scene       The scene.
+   * \return            The number of voxels whose labels should change.
+   */
+  virtual int write_smoothed_labels(int entryCount, SpaintVoxelScene *scene) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Smooths the labels of the surface voxels in (some of) the blocks that have been relabelled since they were last smoothed.
+   *
+   * \param scene The scene.
+   * \return      The number of blocks smoothed (any remaining relabelled blocks will be smoothed by subsequent calls).
+   */
+  size_t smooth_labels(SpaintVoxelScene *scene) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const VoxelLabelSmoother> VoxelLabelSmoother_CPtr;
+
+}
+
+#endif
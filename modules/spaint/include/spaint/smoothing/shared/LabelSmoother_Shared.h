@@ -10,6 +10,33 @@
 
 namespace spaint {
 
+/**
+ * \brief Selects the label (if any) with which to fill in a voxel, based on the numbers of its neighbours that have each label.
+ *
+ * \param labelCounts   The numbers of neighbouring voxels that have each label.
+ * \param maxLabelCount The maximum number of labels that can be in use.
+ * \return              The label with maximum support, if a significant number of the neighbours have it, or 0 otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline SpaintVoxel::Label select_smoothed_label(const unsigned char *labelCounts, int maxLabelCount)
+{
+  // Calculate the neighbouring label (if any) with maximum support.
+  SpaintVoxel::Label bestLabel(0);
+  int bestLabelCount = 0;
+  for(int i = 1; i < maxLabelCount; ++i)
+  {
+    if(labelCounts[i] > bestLabelCount)
+    {
+      bestLabel = i;
+      bestLabelCount = labelCounts[i];
+    }
+  }
+
+  // Only use the best label if at least a specified number of the neighbouring voxels are labelled with it.
+  const int bestLabelThreshold = 6;
+  return bestLabelCount >= bestLabelThreshold ? bestLabel : SpaintVoxel::Label(0);
+}
+
 /**
  * \brief Fills in the label of the specified voxel from its neighbours if a significant number of those within range share the same label.
  *
@@ -19,13 +46,20 @@ namespace spaint {
  * \param maxLabelCount                   The maximum number of labels that can be in use.
  * \param raycastResult                   The raycast result.
  * \param voxelData                       The scene's voxel data.
+ * \param labelData                       The scene's label data (if any).
  * \param indexData                       The scene's index data.
  * \param maxSquaredDistanceBetweenVoxels The maximum squared distance allowed between the positions of the neighbour and the voxel of interest if smoothing is to occur.
+ * \param voxelLabelCounts                The scene's voxel counts for each label (if any).
+ * \param labelPresence                   The scene's label presence masks (if any).
+ * \param blockVersions                   The scene's block versions (the label version of the voxel's block is stamped if its label changes).
+ * \param version                         The version of the scene with which to stamp the voxel's block.
  */
 _CPU_AND_GPU_CODE_
 inline void smooth_from_neighbours(int voxelIndex, int width, int height, int maxLabelCount, const Vector4f *raycastResult,
-                                   SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                   float maxSquaredDistanceBetweenVoxels)
+                                   SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData,
+                                   const ITMVoxelIndex::IndexData *indexData, float maxSquaredDistanceBetweenVoxels,
+                                   unsigned int *voxelLabelCounts, unsigned int *labelPresence, SpaintVoxelScene::BlockVersions *blockVersions,
+                                   unsigned int version)
 {
   // Note: We declare the label count array with a fixed maximum size here for simplicity.
   //       The size will need to be changed if we ever want to use more than 32 labels.
@@ -49,10 +83,10 @@ inline void smooth_from_neighbours(int voxelIndex, int width, int height, int ma
       int neighbourX = x + dx, neighbourY = y + dy;
       if(neighbourX < 0 || neighbourX >= width || neighbourY < 0 || neighbourY >= height) continue;
 
-      // Look up the position and properties of the neighbouring voxel.
+      // Look up the position of the neighbouring voxel and its address in the scene.
       int neighbourVoxelIndex = neighbourY * width + neighbourX;
       Vector3f neighbourLoc = raycastResult[neighbourVoxelIndex].toVector3();
-      const SpaintVoxel neighbourVoxel = readVoxel(voxelData, indexData, neighbourLoc.toIntRound(), foundPoint);
+      const int neighbourVoxelAddress = findVoxel(indexData, neighbourLoc.toIntRound(), foundPoint);
       if(!foundPoint) continue;
 
       // If the neighbouring voxel is near enough to the target voxel:
@@ -60,29 +94,18 @@ inline void smooth_from_neighbours(int voxelIndex, int width, int height, int ma
       if(dot(posOffset, posOffset) <= maxSquaredDistanceBetweenVoxels)
       {
         // Increment the count for its label.
-        ++labelCounts[neighbourVoxel.packedLabel.label];
+        ++labelCounts[get_voxel_label(neighbourVoxelAddress, voxelData, labelData).label];
       }
     }
   }
 
-  // Calculate the neighbouring label (if any) with maximum support.
-  SpaintVoxel::Label bestLabel(0);
-  int bestLabelCount = 0;
-  for(int i = 1; i < maxLabelCount; ++i)
-  {
-    if(labelCounts[i] > bestLabelCount)
-    {
-      bestLabel = i;
-      bestLabelCount = labelCounts[i];
-    }
-  }
-
   // If there is a best label, and at least a specified number of the neigbouring voxels are labelled with it,
   // use it to update the label of the target voxel.
-  const int bestLabelThreshold = 6;
-  if(bestLabel != 0 && bestLabelCount >= bestLabelThreshold)
+  const SpaintVoxel::Label bestLabel = select_smoothed_label(labelCounts, maxLabelCount);
+  if(bestLabel != 0)
   {
-    mark_voxel(loc.toShortRound(), SpaintVoxel::PackedLabel(bestLabel, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, indexData);
+    mark_voxel(loc.toShortRound(), SpaintVoxel::PackedLabel(bestLabel, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, labelData, indexData, NORMAL_MARKING, voxelLabelCounts,
+              blockVersions, version, labelPresence);
   }
 }
 
@@ -0,0 +1,118 @@
+/**
+ * spaint: VoxelLabelSmoother_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELLABELSMOOTHER_SHARED
+#define H_SPAINT_VOXELLABELSMOOTHER_SHARED
+
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+
+#include "../../util/SpaintVoxel.h"
+
+// The maximum number of labels supported by the voxel label smoother (the per-voxel label counts are stored in a fixed-size array).
+#define MAX_VOXEL_SMOOTHING_LABELS 32
+
+namespace spaint {
+
+/**
+ * \brief Determines whether or not the specified voxel is part of the surface, for the purposes of 3D label smoothing.
+ *
+ * \param voxel   The voxel.
+ * \param maxSDF  The maximum absolute (normalised) TSDF value that a voxel can have if it is to be considered part of the surface.
+ * \return        true, if the voxel has been observed and lies close enough to the surface, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_smoothing_surface_voxel(const SpaintVoxel& voxel, float maxSDF)
+{
+  const float sdf = SpaintVoxel::valueToFloat(voxel.sdf);
+  return voxel.w_depth > 0 && sdf <= maxSDF && sdf >= -maxSDF;
+}
+
+/**
+ * \brief Computes the smoothed label of a voxel in a relabelled block, based on the labels of its neighbours in the voxel graph.
+ *
+ * The smoothed label is the non-background label that is most common amongst the surface voxels in the voxel's 26-neighbourhood,
+ * provided that it is carried by a majority of them (and by at least a minimum number). Only surface voxels whose current label
+ * is not reliable (i.e. that are unlabelled or have a label predicted by the forest) are smoothed.
+ *
+ * \param linearIdx     The linear index of the voxel within its block.
+ * \param hashEntry     The hash entry of the voxel's block (which must be resident).
+ * \param voxelData     The scene's voxel data.
+ * \param labelData     The scene's label data (if any).
+ * \param indexData     The scene's index data.
+ * \param maxLabelCount The maximum number of labels that can be in use (at most MAX_VOXEL_SMOOTHING_LABELS).
+ * \param maxSDF        The maximum absolute (normalised) TSDF value that a voxel can have if it is to be considered part of the surface.
+ * \param loc           A location into which to write the position of the voxel (in voxels), if its label should change.
+ * \param newLabel      A location into which to write the new label of the voxel, if its label should change.
+ * \return              true, if the voxel's label should change, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool compute_smoothed_voxel_label(int linearIdx, const ITMHashEntry& hashEntry, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                         const ITMVoxelIndex::IndexData *indexData, int maxLabelCount, float maxSDF, Vector3s& loc,
+                                         SpaintVoxel::PackedLabel& newLabel)
+{
+  // If the voxel is not part of the surface, or already has a reliable label, early out.
+  const int voxelAddress = hashEntry.ptr * SDF_BLOCK_SIZE3 + linearIdx;
+  if(!is_smoothing_surface_voxel(voxelData[voxelAddress], maxSDF)) return false;
+
+  const SpaintVoxel::PackedLabel oldLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+  if(oldLabel.group != SpaintVoxel::LG_FOREST && !(oldLabel == SpaintVoxel::PackedLabel())) return false;
+
+  // Count the labels of the surface voxels in the voxel's 26-neighbourhood. Most of the neighbours lie in the same block,
+  // so we use a cache to avoid looking up the hash table for each of them.
+  const Vector3i pos(
+    hashEntry.pos.x * SDF_BLOCK_SIZE + linearIdx % SDF_BLOCK_SIZE,
+    hashEntry.pos.y * SDF_BLOCK_SIZE + linearIdx / SDF_BLOCK_SIZE % SDF_BLOCK_SIZE,
+    hashEntry.pos.z * SDF_BLOCK_SIZE + linearIdx / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE)
+  );
+
+  unsigned char labelCounts[MAX_VOXEL_SMOOTHING_LABELS] = {0,};
+  int neighbourCount = 0;
+  ITMVoxelBlockHash::IndexCache cache;
+
+  for(int dz = -1; dz <= 1; ++dz)
+  {
+    for(int dy = -1; dy <= 1; ++dy)
+    {
+      for(int dx = -1; dx <= 1; ++dx)
+      {
+        if(dx == 0 && dy == 0 && dz == 0) continue;
+
+        int vmIndex;
+        const int neighbourAddress = findVoxel(indexData, pos + Vector3i(dx, dy, dz), vmIndex, cache);
+        if(!vmIndex || !is_smoothing_surface_voxel(voxelData[neighbourAddress], maxSDF)) continue;
+
+        ++neighbourCount;
+        const SpaintVoxel::Label neighbourLabel = get_voxel_label(neighbourAddress, voxelData, labelData).label;
+        if(neighbourLabel < maxLabelCount) ++labelCounts[neighbourLabel];
+      }
+    }
+  }
+
+  // Find the non-background label with maximum support.
+  SpaintVoxel::Label bestLabel(0);
+  int bestLabelCount = 0;
+  for(int i = 1; i < maxLabelCount; ++i)
+  {
+    if(labelCounts[i] > bestLabelCount)
+    {
+      bestLabel = i;
+      bestLabelCount = labelCounts[i];
+    }
+  }
+
+  // Only use the best label if it is carried by a majority of (and a minimum number of) the neighbouring surface voxels.
+  const int minBestLabelCount = 4;
+  if(bestLabelCount < minBestLabelCount || 2 * bestLabelCount <= neighbourCount) return false;
+
+  newLabel = SpaintVoxel::PackedLabel(bestLabel, SpaintVoxel::LG_FOREST);
+  if(newLabel == oldLabel) return false;
+
+  loc = Vector3s(static_cast<short>(pos.x), static_cast<short>(pos.y), static_cast<short>(pos.z));
+  return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * spaint: LabelSnapshotterFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELSNAPSHOTTERFACTORY
+#define H_SPAINT_LABELSNAPSHOTTERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/LabelSnapshotter.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct label snapshotters.
+ */
+struct LabelSnapshotterFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a label snapshotter.
+   *
+   * \param deviceType      The device on which the label snapshotter should operate.
+   * \param path            The path to the label log file to write (any existing file is overwritten).
+   * \param intervalSeconds The minimum time (in seconds) between successive snapshots.
+   * \return                The label snapshotter.
+   */
+  static LabelSnapshotter_Ptr make_label_snapshotter(ITMLib::ITMLibSettings::DeviceType deviceType, const std::string& path, double intervalSeconds);
+};
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * spaint: VoxelSceneArchiveFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENEARCHIVEFACTORY
+#define H_SPAINT_VOXELSCENEARCHIVEFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/VoxelSceneArchive.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct voxel scene archives.
+ */
+struct VoxelSceneArchiveFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a voxel scene archive.
+   *
+   * \param deviceType  The device on which the scenes to be saved or loaded are stored.
+   * \return            The voxel scene archive.
+   */
+  static VoxelSceneArchive_Ptr make_voxel_scene_archive(ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
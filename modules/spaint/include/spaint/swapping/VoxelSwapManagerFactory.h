@@ -0,0 +1,34 @@
+/**
+ * spaint: VoxelSwapManagerFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSWAPMANAGERFACTORY
+#define H_SPAINT_VOXELSWAPMANAGERFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/VoxelSwapManager.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct voxel swap managers.
+ */
+struct VoxelSwapManagerFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a voxel swap manager.
+   *
+   * \param deviceType      The device on which the voxel swap manager should operate.
+   * \param lookaheadFrames The number of frames ahead of the camera for which to prefetch voxel blocks (0 disables prefetching).
+   * \return                The voxel swap manager.
+   */
+  static VoxelSwapManager_Ptr make_voxel_swap_manager(ITMLib::ITMLibSettings::DeviceType deviceType, int lookaheadFrames);
+};
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * spaint: LabelSnapshotter_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELSNAPSHOTTER_CPU
+#define H_SPAINT_LABELSNAPSHOTTER_CPU
+
+#include "../interface/LabelSnapshotter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to periodically snapshot the semantic labels of a scene on the CPU.
+ *
+ * The labels are gathered synchronously on the main thread (there is no device-to-host copy to overlap with),
+ * but comparing them with the previous snapshot and writing them to disk still happens on the writer thread.
+ */
+class LabelSnapshotter_CPU : public LabelSnapshotter
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The pointers of the gathered voxel blocks into the local voxel block array. */
+  std::vector<int> m_blockPtrs;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based label snapshotter.
+   *
+   * \param path                  The path to the label log file to write (any existing file is overwritten).
+   * \param intervalSeconds       The minimum time (in seconds) between successive snapshots.
+   * \throws std::runtime_error   If the label log file could not be opened for writing.
+   */
+  LabelSnapshotter_CPU(const std::string& path, double intervalSeconds);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the CPU-based label snapshotter.
+   */
+  virtual ~LabelSnapshotter_CPU();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void begin_gather(const SpaintVoxelScene *scene);
+
+  /** Override */
+  virtual void end_gather();
+};
+
+}
+
+#endif
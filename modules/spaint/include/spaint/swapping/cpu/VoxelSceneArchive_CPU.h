@@ -0,0 +1,29 @@
+/**
+ * spaint: VoxelSceneArchive_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENEARCHIVE_CPU
+#define H_SPAINT_VOXELSCENEARCHIVE_CPU
+
+#include "../interface/VoxelSceneArchive.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to save and load voxel scenes that are stored on the CPU.
+ */
+class VoxelSceneArchive_CPU : public VoxelSceneArchive
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void copy_from_scene_memory(void *dest, const void *src, size_t size) const;
+
+  /** Override */
+  virtual void copy_to_scene_memory(void *dest, const void *src, size_t size) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * spaint: VoxelSwapManager_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSWAPMANAGER_CPU
+#define H_SPAINT_VOXELSWAPMANAGER_CPU
+
+#include "../interface/VoxelSwapManager.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to support the swapping of voxel blocks using the CPU.
+ */
+class VoxelSwapManager_CPU : public VoxelSwapManager
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based voxel swap manager.
+   *
+   * \param lookaheadFrames         The number of frames ahead of the camera for which to prefetch voxel blocks (0 disables prefetching).
+   * \throws std::invalid_argument  If the number of lookahead frames is negative or greater than MAX_LOOKAHEAD_FRAMES.
+   */
+  explicit VoxelSwapManager_CPU(int lookaheadFrames);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void exclude_predicted_entries(ITMLib::ITMRenderState_VH *renderState) const;
+
+  /** Override */
+  virtual int find_swapped_in_entries(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void flag_predicted_entries(const PredictedPoses& predictedPoses, const Vector4f& projParams, const Vector2i& imgSize,
+                                      const SpaintVoxelScene *scene, ITMLib::ITMRenderState_VH *renderState) const;
+
+  /** Override */
+  virtual void flag_swapped_out_entries(const SpaintVoxelScene *scene) const;
+
+  /** Override */
+  virtual void write_stored_labels(int swappedInEntryCount, SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
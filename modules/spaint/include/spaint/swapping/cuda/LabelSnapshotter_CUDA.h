@@ -0,0 +1,66 @@
+/**
+ * spaint: LabelSnapshotter_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELSNAPSHOTTER_CUDA
+#define H_SPAINT_LABELSNAPSHOTTER_CUDA
+
+#include "../interface/LabelSnapshotter.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to periodically snapshot the semantic labels of a scene using CUDA.
+ *
+ * The labels of the resident voxel blocks are gathered into a compact staging area on the GPU, and then copied into pinned
+ * host memory, all on a stream of the label snapshotter's own. The main thread only issues this work: it is the writer thread
+ * that waits for it to finish. The stream is deliberately a blocking one, so that work subsequently issued on the default
+ * stream (e.g. fusing the next frame or marking voxels) waits for the labels to have been gathered before modifying them.
+ */
+class LabelSnapshotter_CUDA : public LabelSnapshotter
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to store the pointers of the gathered voxel blocks into the local voxel block array. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_blockPtrsMB;
+
+  /** The CUDA device on which the most recent snapshot was gathered. */
+  int m_device;
+
+  /** An event recorded once the number of gathered voxel blocks has been copied to the CPU. */
+  cudaEvent_t m_gatheredEvent;
+
+  /** The stream on which the labels are gathered and copied to the CPU. */
+  cudaStream_t m_stream;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based label snapshotter.
+   *
+   * \param path                  The path to the label log file to write (any existing file is overwritten).
+   * \param intervalSeconds       The minimum time (in seconds) between successive snapshots.
+   * \throws std::runtime_error   If the label log file could not be opened for writing.
+   */
+  LabelSnapshotter_CUDA(const std::string& path, double intervalSeconds);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the CUDA-based label snapshotter.
+   */
+  virtual ~LabelSnapshotter_CUDA();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void begin_gather(const SpaintVoxelScene *scene);
+
+  /** Override */
+  virtual void end_gather();
+};
+
+}
+
+#endif
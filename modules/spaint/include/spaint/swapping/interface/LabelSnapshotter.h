@@ -0,0 +1,234 @@
+/**
+ * spaint: LabelSnapshotter.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELSNAPSHOTTER
+#define H_SPAINT_LABELSNAPSHOTTER
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/chrono/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to periodically snapshot the semantic labels of a scene to disk,
+ *        so that a crash loses at most a few seconds of labelling.
+ *
+ * Each snapshot gathers the labels of the scene's resident voxel blocks into a staging area (asynchronously, in the CUDA case)
+ * and hands them to a writer thread. The writer thread compares them with the labels from the previous snapshot, and appends
+ * a record containing only the blocks whose labels have changed to a label log file. The main thread never waits for the disk:
+ * if a snapshot is still being written when the next one is due, the new snapshot is simply postponed.
+ *
+ * A label log has the following format (all values are in native byte order):
+ *
+ * - The signature "SPTLBD01", followed by the number of voxels per block (as a 32-bit integer).
+ * - Any number of records, each of which consists of its size in bytes (as a 32-bit integer, excluding the size itself),
+ *   the number of milliseconds since the log was started (as a 64-bit integer), the number of blocks in the record (as a
+ *   32-bit integer), and for each block, its position (as three 16-bit integers) followed by its run-length encoded labels,
+ *   i.e. the number of runs (as a 16-bit integer) and then each run's length (as a 16-bit integer) and label (as a byte).
+ *
+ * Since each record is written in one go and the log is flushed after each record, a log that was being written when the
+ * program crashed ends with at most one incomplete record, which is ignored when the log is loaded.
+ */
+class LabelSnapshotter
+{
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the number of voxel blocks whose labels have been gathered. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_blockCountMB;
+
+  /** A memory block in which to store the labels of the voxel blocks that have been gathered (SDF_BLOCK_SIZE3 per block). */
+  boost::shared_ptr<ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> > m_blockLabelsMB;
+
+  /** A memory block in which to store the positions of the voxel blocks that have been gathered (in block coordinates). */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > m_blockPositionsMB;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The error that caused the writer thread to stop (if any). */
+  std::string m_error;
+
+  /** The label log file. */
+  std::ofstream m_file;
+
+  /** The minimum time between successive snapshots. */
+  boost::chrono::milliseconds m_interval;
+
+  /** The time at which the most recent snapshot was started. */
+  boost::chrono::steady_clock::time_point m_lastSnapshotTime;
+
+  /** The time at which the label log was started. */
+  boost::chrono::steady_clock::time_point m_logStartTime;
+
+  /** The mutex used to synchronise access to the state shared with the writer thread. */
+  mutable boost::mutex m_mutex;
+
+  /** The keys of the voxel blocks in the previous snapshot (in ascending order). */
+  std::vector<unsigned long long> m_previousKeys;
+
+  /** The labels of the voxel blocks in the previous snapshot (SDF_BLOCK_SIZE3 per block, in the same order as the keys). */
+  std::vector<SpaintVoxel::PackedLabel> m_previousLabels;
+
+  /** Whether or not the staging area contains a snapshot that the writer thread has not yet finished consuming. */
+  bool m_stagingBusy;
+
+  /** The time at which the snapshot in the staging area was started. */
+  boost::chrono::steady_clock::time_point m_stagingTime;
+
+  /** The number of snapshots that have been started. */
+  size_t m_startedSnapshotCount;
+
+  /** A condition variable used to signal changes to the state shared with the writer thread. */
+  boost::condition_variable m_stateChanged;
+
+  /** Whether or not the writer thread has been asked to stop. */
+  bool m_stopRequested;
+
+  /** The number of snapshots that have been written to the label log. */
+  size_t m_writtenSnapshotCount;
+
+  /** The thread on which the snapshots are compared with their predecessors and written to the label log. */
+  boost::thread m_writerThread;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a label snapshotter.
+   *
+   * \param path                  The path to the label log file to write (any existing file is overwritten).
+   * \param intervalSeconds       The minimum time (in seconds) between successive snapshots.
+   * \throws std::runtime_error   If the label log file could not be opened for writing.
+   */
+  LabelSnapshotter(const std::string& path, double intervalSeconds);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the label snapshotter.
+   *
+   * Any snapshot that is still being written is completed before the label snapshotter is destroyed.
+   */
+  virtual ~LabelSnapshotter();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  LabelSnapshotter(const LabelSnapshotter&);
+  LabelSnapshotter& operator=(const LabelSnapshotter&);
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Starts gathering the positions and labels of the scene's resident voxel blocks into the staging area.
+   *
+   * This is called on the main thread, and must not wait for the gathering to finish.
+   *
+   * \param scene The scene.
+   */
+  virtual void begin_gather(const SpaintVoxelScene *scene) = 0;
+
+  /**
+   * \brief Waits for the gathering started by the most recent call to begin_gather to finish, and makes the results available on the CPU.
+   *
+   * This is called on the writer thread.
+   */
+  virtual void end_gather() = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Takes a final snapshot of the scene's labels, and waits for it (and any snapshot already in flight) to be written.
+   *
+   * \param scene               The scene.
+   * \throws std::runtime_error If the writer thread has stopped due to an error.
+   */
+  void finish(const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Gets the number of snapshots that have been written to the label log so far.
+   *
+   * \return  The number of snapshots that have been written to the label log so far.
+   */
+  size_t get_written_snapshot_count() const;
+
+  /**
+   * \brief Starts a snapshot of the scene's labels if the snapshot interval has elapsed and the previous snapshot has been consumed.
+   *
+   * This is intended to be called once per frame, and does not wait for the snapshot to be written.
+   *
+   * \param scene               The scene.
+   * \return                    true, if a snapshot was started, or false otherwise.
+   * \throws std::runtime_error If the writer thread has stopped due to an error.
+   */
+  bool update(const SpaintVoxelScene *scene);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Loads the most recent labels of all of the voxel blocks in a label log.
+   *
+   * The results are suitable for passing to VoxelMarker::mark_voxels (with FORCED_MARKING) to restore the labels into a
+   * scene that has been reconstructed again (e.g. from a saved scene archive).
+   *
+   * \param path                The path to the label log file.
+   * \param voxelLocations      A vector into which to write the locations of the voxels whose labels were loaded.
+   * \param labels              A vector into which to write the labels of the voxels (in the same order as their locations).
+   * \return                    The number of complete snapshots that were found in the label log.
+   * \throws std::runtime_error If the label log file could not be opened, or is not a valid label log.
+   */
+  static size_t load_latest_labels(const std::string& path, std::vector<Vector3s>& voxelLocations, std::vector<SpaintVoxel::PackedLabel>& labels);
+
+  //#################### PROTECTED MEMBER FUNCTIONS ####################
+protected:
+  /**
+   * \brief Stops the writer thread (after it has finished writing any snapshot in flight).
+   *
+   * Derived classes must call this from their destructors, since the writer thread calls end_gather.
+   */
+  void stop_writer();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Throws if the writer thread has stopped due to an error (the mutex must be held by the caller).
+   *
+   * \throws std::runtime_error If the writer thread has stopped due to an error.
+   */
+  void check_writer() const;
+
+  /**
+   * \brief Compares the snapshot in the staging area with the previous snapshot, and encodes a record containing the blocks whose labels have changed.
+   *
+   * \param blockCount  The number of voxel blocks in the snapshot.
+   * \param record      A vector into which to write the record.
+   */
+  void encode_record(int blockCount, std::vector<unsigned char>& record);
+
+  /**
+   * \brief Runs the writer thread.
+   */
+  void run_writer();
+
+  /**
+   * \brief Starts a snapshot of the scene's labels (the staging area must be free, and the mutex must be held by the caller).
+   *
+   * \param scene The scene.
+   */
+  void start_snapshot(const SpaintVoxelScene *scene);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<LabelSnapshotter> LabelSnapshotter_Ptr;
+
+}
+
+#endif
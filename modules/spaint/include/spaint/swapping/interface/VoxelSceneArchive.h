@@ -0,0 +1,246 @@
+/**
+ * spaint: VoxelSceneArchive.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSCENEARCHIVE
+#define H_SPAINT_VOXELSCENEARCHIVE
+
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <ORUtils/SE3Pose.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to save a voxel scene to disk, and to load it back again lazily.
+ *
+ * A scene archive stores the voxel blocks of a scene (including their labels) in a single file, grouped into cubic chunks of
+ * CHUNK_SIZE^3 blocks. The file consists of:
+ *
+ * - A header: the 8-byte signature "SPTSCN01", followed by the size of a voxel, SDF_BLOCK_SIZE, CHUNK_SIZE and a flag indicating
+ *   whether or not the labels are stored separately from the voxels (each as a 32-bit integer), and then the voxel size (as a float).
+ * - A record for each chunk: the position of each block in the chunk (as three 16-bit integers), followed by its voxels and (if the
+ *   labels are stored separately) its labels, each run-length encoded as a 32-bit run count followed by the runs themselves (each is
+ *   a 16-bit length followed by the repeated value). Since most of the voxels in a block are typically either unobserved or far from
+ *   the surface, this makes the blocks much smaller, and is very cheap to decode.
+ * - An index: the position (as three 32-bit integers), block count (as a 32-bit integer), and offset and size (as 64-bit integers)
+ *   of each chunk record, followed by a trailer containing the offset of the index (as a 64-bit integer), the number of chunks
+ *   (as a 32-bit integer) and the 8-byte signature "SPTSCNIX".
+ *
+ * All values are stored in native byte order, and the voxels are stored as raw structures, so an archive can only be loaded by a
+ * build of spaint with the same voxel layout (this is checked when the archive is opened).
+ *
+ * When an archive is opened, only its index is read. The archive file is memory-mapped, and each chunk is only read and
+ * decoded when it first comes into view, so the time taken to load a scene scales with how much of it has been seen,
+ * rather than with its size. If the scene supports swapping, the loaded blocks are inserted into the scene's hash table
+ * as swapped-out blocks whose data is in the global cache, so that InfiniTAM will swap them in as and when they are needed;
+ * otherwise, they are written directly into the scene's voxel block array.
+ */
+class VoxelSceneArchive
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct records where a chunk of voxel blocks is stored in the archive file.
+   */
+  struct ChunkInfo
+  {
+    /** The number of voxel blocks in the chunk. */
+    unsigned int blockCount;
+
+    /** Whether or not the chunk has been loaded into the scene. */
+    bool loaded;
+
+    /** The offset of the chunk record from the start of the file. */
+    unsigned long long offset;
+
+    /** The position of the chunk (in chunk coordinates). */
+    Vector3i pos;
+
+    /** The size (in bytes) of the chunk record. */
+    unsigned long long size;
+  };
+
+  //#################### CONSTANTS ####################
+public:
+  /** The size of a chunk along each axis (in voxel blocks). */
+  static const int CHUNK_SIZE = 8;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The chunks in the archive file from which the scene is being loaded (if any). */
+  std::vector<ChunkInfo> m_chunks;
+
+  /** The memory-mapped archive file from which the scene is being loaded (if any). */
+  boost::iostreams::mapped_file_source m_file;
+
+  /** The number of chunks that have been loaded into the scene so far. */
+  size_t m_loadedChunkCount;
+
+  /** The path to the archive file from which the scene is being loaded (if any). */
+  std::string m_path;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a voxel scene archive.
+   */
+  VoxelSceneArchive();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel scene archive.
+   */
+  virtual ~VoxelSceneArchive();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  VoxelSceneArchive(const VoxelSceneArchive&);
+  VoxelSceneArchive& operator=(const VoxelSceneArchive&);
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Copies data from the memory in which the scene is stored into host memory.
+   *
+   * \param dest  The host memory into which to copy the data.
+   * \param src   The scene memory from which to copy the data.
+   * \param size  The size (in bytes) of the data.
+   */
+  virtual void copy_from_scene_memory(void *dest, const void *src, size_t size) const = 0;
+
+  /**
+   * \brief Copies data from host memory into the memory in which the scene is stored.
+   *
+   * \param dest  The scene memory into which to copy the data.
+   * \param src   The host memory from which to copy the data.
+   * \param size  The size (in bytes) of the data.
+   */
+  virtual void copy_to_scene_memory(void *dest, const void *src, size_t size) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Closes the archive file from which the scene is being loaded (if any), without loading any more of it.
+   */
+  void close();
+
+  /**
+   * \brief Gets whether or not the scene is still being loaded from an archive file (i.e. whether some of its chunks are yet to be loaded).
+   *
+   * \return  true, if the scene is still being loaded from an archive file, or false otherwise.
+   */
+  bool is_open() const;
+
+  /**
+   * \brief Loads all of the chunks of the archive file that have not yet been loaded into the scene, and then closes the file.
+   *
+   * \param scene               The scene.
+   * \return                    The number of voxel blocks that were loaded.
+   * \throws std::runtime_error If the archive file is corrupt.
+   */
+  size_t load_all_chunks(SpaintVoxelScene *scene);
+
+  /**
+   * \brief Loads any chunks of the archive file that are visible from the specified camera pose and have not yet been loaded into the scene.
+   *
+   * Once all of the chunks have been loaded, the archive file is closed.
+   *
+   * \param pose                The camera pose.
+   * \param projParams          The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+   * \param imgSize             The size of the depth image.
+   * \param scene               The scene.
+   * \return                    The number of voxel blocks that were loaded.
+   * \throws std::runtime_error If the archive file is corrupt.
+   */
+  size_t load_visible_chunks(const ORUtils::SE3Pose& pose, const Vector4f& projParams, const Vector2i& imgSize, SpaintVoxelScene *scene);
+
+  /**
+   * \brief Opens an archive file from which to load the scene lazily.
+   *
+   * Only the archive's index is read at this point: its chunks are loaded by calls to load_visible_chunks or load_all_chunks.
+   * The scene should be empty (e.g. just reset), since any blocks it already contains take precedence over those in the archive.
+   *
+   * \param path                The path to the archive file.
+   * \param scene               The scene into which the archive will be loaded.
+   * \throws std::runtime_error If the archive file cannot be opened, is corrupt, or was saved from a scene with a different voxel layout or size.
+   */
+  void open(const std::string& path, const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Saves the scene to an archive file.
+   *
+   * If the scene is still being loaded from an archive file, the chunks that have not yet been loaded are loaded first,
+   * so that they are saved as well (this means that it is safe to save the scene back to the file from which it is being loaded).
+   *
+   * \param path                The path to the archive file.
+   * \param scene               The scene.
+   * \throws std::runtime_error If the archive file cannot be written.
+   */
+  void save(const std::string& path, SpaintVoxelScene *scene);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the path to the file in which the contents of the relocaliser for a scene are saved alongside its archive.
+   *
+   * Saving the relocaliser alongside the scene allows a later session that loads the scene to relocalise against it straight away.
+   *
+   * \param archivePath The path to the archive file.
+   * \return            The path to the file in which the contents of the relocaliser for the scene are saved.
+   */
+  static std::string get_relocaliser_path(const std::string& archivePath);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Loads the specified chunks of the archive file into the scene.
+   *
+   * \param chunkIndices        The indices (in m_chunks) of the chunks to load.
+   * \param scene               The scene.
+   * \return                    The number of voxel blocks that were loaded.
+   * \throws std::runtime_error If the archive file is corrupt.
+   */
+  size_t load_chunks(const std::vector<size_t>& chunkIndices, SpaintVoxelScene *scene);
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Appends a run-length encoded array of values to a buffer.
+   *
+   * \param values  The values.
+   * \param count   The number of values.
+   * \param out     The buffer.
+   */
+  template <typename T>
+  static void encode_runs(const T *values, int count, std::vector<unsigned char>& out);
+
+  /**
+   * \brief Decodes a run-length encoded array of values.
+   *
+   * \param p       A pointer to the start of the encoded data.
+   * \param end     A pointer to the end of the buffer containing the encoded data.
+   * \param values  The array into which to decode the values.
+   * \param count   The number of values in the array.
+   * \return        A pointer to the end of the encoded data, or NULL if the encoded data is corrupt.
+   */
+  template <typename T>
+  static const unsigned char *decode_runs(const unsigned char *p, const unsigned char *end, T *values, int count);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<VoxelSceneArchive> VoxelSceneArchive_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * spaint: VoxelSwapManager.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSWAPMANAGER
+#define H_SPAINT_VOXELSWAPMANAGER
+
+#include <boost/optional.hpp>
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to support the swapping of voxel blocks between
+ *        the GPU (or the local voxel block array) and the host-side global cache when reconstructing large scenes.
+ *
+ * InfiniTAM's swapping engine only swaps in voxel blocks once they become visible, and merges them back into the
+ * scene without their semantic labels. A voxel swap manager addresses both of these problems: before fusion, it
+ * marks the blocks that the camera is predicted to see over the next few frames (by extrapolating its trajectory)
+ * as visible, so that InfiniTAM swaps them in before they are needed; after fusion, it restores the labels of any
+ * blocks that have been swapped in from the labels saved with them in the global cache.
+ */
+class VoxelSwapManager
+{
+  //#################### CONSTANTS ####################
+public:
+  /** The maximum number of frames ahead of the camera for which voxel blocks can be prefetched. */
+  static const int MAX_LOOKAHEAD_FRAMES = 8;
+
+  /** The maximum number of swapped-in voxel blocks whose labels can be restored per frame (any others are restored on later frames). */
+  static const int MAX_RESTORED_BLOCK_COUNT = 4096;
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents the poses that the camera is predicted to have over the next few frames.
+   */
+  struct PredictedPoses
+  {
+    /** The number of predicted poses. */
+    int count;
+
+    /** The predicted poses (as world-to-camera transformations). */
+    Matrix4f M[MAX_LOOKAHEAD_FRAMES];
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** The number of frames ahead of the camera for which to prefetch voxel blocks. */
+  const int m_lookaheadFrames;
+
+  /** A memory block in which to flag the hash entries of the voxel blocks that are predicted to become visible. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_predictedFlagsMB;
+
+  /** The pose of the camera (as a world-to-camera transformation) when blocks were last prefetched (if any). */
+  boost::optional<Matrix4f> m_previousM;
+
+  /** A memory block in which to flag the hash entries whose voxel blocks are swapped out and whose labels will need restoring once they are swapped in. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_restorationFlagsMB;
+
+  /** A memory block in which to store the labels of the swapped-in voxel blocks that are being restored from the global cache. */
+  boost::shared_ptr<ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> > m_storedLabelsMB;
+
+  /** A memory block in which to flag which of the swapped-in voxel blocks have labels in the global cache. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_storedLabelsAvailableMB;
+
+  /** A memory block in which to store the number of voxel blocks that have been swapped in since their labels were last restored. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_swappedInEntryCountMB;
+
+  /** A memory block in which to store the IDs of the hash entries of the voxel blocks whose labels are being restored. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_swappedInEntryIDsMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a voxel swap manager.
+   *
+   * \param lookaheadFrames       The number of frames ahead of the camera for which to prefetch voxel blocks (0 disables prefetching).
+   * \throws std::invalid_argument  If the number of lookahead frames is negative or greater than MAX_LOOKAHEAD_FRAMES.
+   */
+  explicit VoxelSwapManager(int lookaheadFrames);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the voxel swap manager.
+   */
+  virtual ~VoxelSwapManager();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Removes the hash entries that have been flagged as predicted to become visible from the render state's list of visible entries.
+   *
+   * InfiniTAM retests the visibility of the blocks in the previous frame's visible list, and drops those that are not currently visible.
+   * Removing the predicted entries from the list ensures that they are instead kept visible (and therefore resident) until they are seen.
+   *
+   * \param renderState The render state.
+   */
+  virtual void exclude_predicted_entries(ITMLib::ITMRenderState_VH *renderState) const = 0;
+
+  /**
+   * \brief Finds the hash entries of voxel blocks that have been swapped in since their labels were last restored, and clears their restoration flags.
+   *
+   * At most MAX_RESTORED_BLOCK_COUNT entries are found: any others are left flagged, and will be found on a subsequent call.
+   *
+   * \param scene The scene.
+   * \return      The number of entries found (their IDs are written into m_swappedInEntryIDsMB).
+   */
+  virtual int find_swapped_in_entries(const SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Flags the hash entries of the allocated voxel blocks that are predicted to become visible, and marks them as visible in the render state.
+   *
+   * \param predictedPoses  The poses that the camera is predicted to have over the next few frames.
+   * \param projParams      The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+   * \param imgSize         The size of the depth image.
+   * \param scene           The scene.
+   * \param renderState     The render state.
+   */
+  virtual void flag_predicted_entries(const PredictedPoses& predictedPoses, const Vector4f& projParams, const Vector2i& imgSize,
+                                      const SpaintVoxelScene *scene, ITMLib::ITMRenderState_VH *renderState) const = 0;
+
+  /**
+   * \brief Flags the hash entries of the voxel blocks that are currently swapped out, so that their labels can be restored once they are swapped in.
+   *
+   * \param scene The scene.
+   */
+  virtual void flag_swapped_out_entries(const SpaintVoxelScene *scene) const = 0;
+
+  /**
+   * \brief Writes the labels stored in m_storedLabelsMB into the specified swapped-in voxel blocks.
+   *
+   * Only voxels that have not been labelled since they were swapped in have their labels restored.
+   *
+   * \param swappedInEntryCount The number of swapped-in voxel blocks whose labels are to be restored.
+   * \param scene               The scene.
+   */
+  virtual void write_stored_labels(int swappedInEntryCount, SpaintVoxelScene *scene) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Prepares the scene for the fusion of a new frame.
+   *
+   * This prefetches the voxel blocks that the camera is predicted to see over the next few frames, and records which
+   * voxel blocks are swapped out, so that their labels can be restored if they are swapped in during fusion.
+   *
+   * \param pose        The current pose of the camera.
+   * \param projParams  The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+   * \param imgSize     The size of the depth image.
+   * \param scene       The scene.
+   * \param renderState The render state that will be used for fusion.
+   */
+  void prepare_for_fusion(const ORUtils::SE3Pose& pose, const Vector4f& projParams, const Vector2i& imgSize, const SpaintVoxelScene *scene, ITMLib::ITMRenderState *renderState);
+
+  /**
+   * \brief Resets the voxel swap manager (e.g. when the scene is reset), so that it no longer extrapolates from previous poses.
+   */
+  void reset();
+
+  /**
+   * \brief Restores the labels of any voxel blocks that have been swapped in during fusion from the labels saved in the global cache.
+   *
+   * \param scene The scene.
+   */
+  void restore_swapped_in_labels(SpaintVoxelScene *scene);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<VoxelSwapManager> VoxelSwapManager_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * spaint: LabelSnapshotter_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_LABELSNAPSHOTTER_SHARED
+#define H_SPAINT_LABELSNAPSHOTTER_SHARED
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Copies the label of a voxel in a gathered voxel block into the staging area of a label snapshotter.
+ *
+ * \param blockIndex  The index of the voxel block in the staging area.
+ * \param linearIdx   The linear index of the voxel within the block.
+ * \param blockPtrs   The pointers of the gathered voxel blocks into the local voxel block array.
+ * \param voxelData   The scene's voxel data.
+ * \param labelData   The scene's label data (if any).
+ * \param blockLabels The labels of the gathered voxel blocks (SDF_BLOCK_SIZE3 per block).
+ */
+_CPU_AND_GPU_CODE_
+inline void copy_gathered_label(int blockIndex, int linearIdx, const int *blockPtrs, const SpaintVoxel *voxelData,
+                                const SpaintVoxel::PackedLabel *labelData, SpaintVoxel::PackedLabel *blockLabels)
+{
+  blockLabels[blockIndex * SDF_BLOCK_SIZE3 + linearIdx] = get_voxel_label(blockPtrs[blockIndex] * SDF_BLOCK_SIZE3 + linearIdx, voxelData, labelData);
+}
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * spaint: VoxelSwapManager_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VOXELSWAPMANAGER_SHARED
+#define H_SPAINT_VOXELSWAPMANAGER_SHARED
+
+#include "../interface/VoxelSwapManager.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not a sphere in the scene is at least partly visible from the specified camera pose.
+ *
+ * The sphere is treated as visible if it lies at least partly within the camera's view frustum (enlarged by an eighth of
+ * the image size on each side, as in InfiniTAM's own test for blocks that may need swapping in), and is no further away
+ * than the far plane of the frustum. Spheres that straddle the image plane are always treated as visible.
+ *
+ * \param centre      The centre of the sphere (in world coordinates, with w = 1).
+ * \param radius      The radius of the sphere (in m).
+ * \param M           The camera pose (as a world-to-camera transformation).
+ * \param projParams  The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+ * \param imgSize     The size of the depth image.
+ * \param maxDepth    The distance (in m) to the far plane of the view frustum.
+ * \return            true, if the sphere is at least partly visible, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_sphere_visible(const Vector4f& centre, float radius, const Matrix4f& M, const Vector4f& projParams, const Vector2i& imgSize, float maxDepth)
+{
+  const Vector4f p = M * centre;
+
+  if(p.z < radius) return p.z > -radius;
+  if(p.z - radius > maxDepth) return false;
+
+  // Project the centre of the sphere into the image, and check whether the sphere overlaps the enlarged image.
+  const float x = projParams.x * p.x / p.z + projParams.z;
+  const float y = projParams.y * p.y / p.z + projParams.w;
+  const float rx = projParams.x * radius / p.z + imgSize.x / 8.0f, ry = projParams.y * radius / p.z + imgSize.y / 8.0f;
+  return x >= -rx && x < imgSize.x + rx && y >= -ry && y < imgSize.y + ry;
+}
+
+/**
+ * \brief Determines whether or not a voxel block is predicted to become visible to the camera.
+ *
+ * \param blockPos        The position of the voxel block (in block coordinates).
+ * \param predictedPoses  The poses that the camera is predicted to have over the next few frames.
+ * \param projParams      The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+ * \param imgSize         The size of the depth image.
+ * \param voxelSize       The size of a voxel (in m).
+ * \param maxDepth        The distance (in m) to the far plane of the view frustum.
+ * \return                true, if the block is visible from any of the predicted poses, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_block_predicted_visible(const Vector3s& blockPos, const VoxelSwapManager::PredictedPoses& predictedPoses, const Vector4f& projParams,
+                                       const Vector2i& imgSize, float voxelSize, float maxDepth)
+{
+  const float blockSize = voxelSize * SDF_BLOCK_SIZE;
+  const float radius = 0.8660254f * blockSize; // half the length of the block's diagonal
+  const Vector4f centre((blockPos.x + 0.5f) * blockSize, (blockPos.y + 0.5f) * blockSize, (blockPos.z + 0.5f) * blockSize, 1.0f);
+
+  for(int i = 0; i < predictedPoses.count; ++i)
+  {
+    if(is_sphere_visible(centre, radius, predictedPoses.M[i], projParams, imgSize, maxDepth)) return true;
+  }
+
+  return false;
+}
+
+/**
+ * \brief Flags the hash entry with the specified ID if its voxel block is allocated and predicted to become visible, and marks it as visible.
+ *
+ * Blocks that are resident are marked as visible and in memory (type 1), whilst blocks that are swapped out are marked as
+ * visible but swapped out (type 2), which causes InfiniTAM to reallocate them and swap their contents back in during fusion.
+ *
+ * \param entryID             The ID of the hash entry.
+ * \param hashTable           The scene's hash table.
+ * \param predictedPoses      The poses that the camera is predicted to have over the next few frames.
+ * \param projParams          The intrinsic parameters of the depth camera (fx, fy, cx, cy).
+ * \param imgSize             The size of the depth image.
+ * \param voxelSize           The size of a voxel (in m).
+ * \param maxDepth            The distance (in m) to the far plane of the view frustum.
+ * \param entriesVisibleType  The visibility types of the hash entries.
+ * \param predictedFlags      The flags indicating which hash entries are predicted to become visible.
+ */
+_CPU_AND_GPU_CODE_
+inline void flag_predicted_entry(int entryID, const ITMHashEntry *hashTable, const VoxelSwapManager::PredictedPoses& predictedPoses, const Vector4f& projParams,
+                                 const Vector2i& imgSize, float voxelSize, float maxDepth, unsigned char *entriesVisibleType, unsigned char *predictedFlags)
+{
+  const ITMHashEntry& hashEntry = hashTable[entryID];
+  const bool predicted = hashEntry.ptr >= -1 && is_block_predicted_visible(hashEntry.pos, predictedPoses, projParams, imgSize, voxelSize, maxDepth);
+  if(predicted) entriesVisibleType[entryID] = hashEntry.ptr == -1 ? 2 : 1;
+  predictedFlags[entryID] = predicted ? 1 : 0;
+}
+
+/**
+ * \brief Flags the hash entry with the specified ID for label restoration if its voxel block is currently swapped out.
+ *
+ * Entries that are already flagged stay flagged until their labels have been restored, and entries that no longer
+ * correspond to allocated blocks (e.g. because the scene has been reset) are unflagged.
+ *
+ * \param entryID           The ID of the hash entry.
+ * \param hashTable         The scene's hash table.
+ * \param restorationFlags  The flags indicating which hash entries will need their labels restoring once they have been swapped in.
+ */
+_CPU_AND_GPU_CODE_
+inline void flag_swapped_out_entry(int entryID, const ITMHashEntry *hashTable, unsigned char *restorationFlags)
+{
+  const int ptr = hashTable[entryID].ptr;
+  if(ptr == -1) restorationFlags[entryID] = 1;
+  else if(ptr < -1) restorationFlags[entryID] = 0;
+}
+
+/**
+ * \brief Determines whether or not the hash entry with the specified ID is flagged for label restoration and has been swapped in.
+ *
+ * \param entryID           The ID of the hash entry.
+ * \param hashTable         The scene's hash table.
+ * \param restorationFlags  The flags indicating which hash entries will need their labels restoring once they have been swapped in.
+ * \return                  true, if the entry's labels should now be restored, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_swapped_in_entry(int entryID, const ITMHashEntry *hashTable, const unsigned char *restorationFlags)
+{
+  return restorationFlags[entryID] && hashTable[entryID].ptr >= 0;
+}
+
+/**
+ * \brief Restores the label of a voxel in a swapped-in voxel block from the label saved with the block in the global cache.
+ *
+ * The label is only restored if the voxel has not been labelled since the block was swapped in (InfiniTAM's swapping
+ * engine reallocates swapped-in blocks with the default label, and merges their other contents back in without labels).
+ *
+ * \param i                     The index of the voxel in the list of voxels being restored (SDF_BLOCK_SIZE3 per block).
+ * \param swappedInEntryIDs     The IDs of the hash entries of the swapped-in blocks.
+ * \param storedLabelsAvailable Flags indicating which of the swapped-in blocks have labels in the global cache.
+ * \param storedLabels          The labels saved with the swapped-in blocks in the global cache.
+ * \param hashTable             The scene's hash table.
+ * \param voxelData             The scene's voxel data.
+ * \param labelData             The scene's label data (if any).
+ */
+_CPU_AND_GPU_CODE_
+inline void restore_stored_label(int i, const int *swappedInEntryIDs, const unsigned char *storedLabelsAvailable, const SpaintVoxel::PackedLabel *storedLabels,
+                                 const ITMHashEntry *hashTable, SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData)
+{
+  const int blockIndex = i / SDF_BLOCK_SIZE3;
+  if(!storedLabelsAvailable[blockIndex]) return;
+
+  const int ptr = hashTable[swappedInEntryIDs[blockIndex]].ptr;
+  if(ptr < 0) return;
+
+  SpaintVoxel::PackedLabel& voxelLabel = get_voxel_label(ptr * SDF_BLOCK_SIZE3 + i % SDF_BLOCK_SIZE3, voxelData, labelData);
+  if(voxelLabel == SpaintVoxel::PackedLabel()) voxelLabel = storedLabels[i];
+}
+
+}
+
+#endif
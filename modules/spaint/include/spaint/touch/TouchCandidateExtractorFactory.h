@@ -0,0 +1,34 @@
+/**
+ * spaint: TouchCandidateExtractorFactory.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TOUCHCANDIDATEEXTRACTORFACTORY
+#define H_SPAINT_TOUCHCANDIDATEEXTRACTORFACTORY
+
+#include <ITMLib/Utils/ITMLibSettings.h>
+
+#include "interface/TouchCandidateExtractor.h"
+
+namespace spaint {
+
+/**
+ * \brief This struct can be used to construct touch candidate extractors.
+ */
+struct TouchCandidateExtractorFactory
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Makes a touch candidate extractor.
+   *
+   * \param imgSize     The size of the images on which the extractor is to run.
+   * \param deviceType  The device on which the extractor should operate.
+   * \return            The touch candidate extractor.
+   */
+  static TouchCandidateExtractor_Ptr make_touch_candidate_extractor(const Vector2i& imgSize, ITMLib::ITMLibSettings::DeviceType deviceType);
+};
+
+}
+
+#endif
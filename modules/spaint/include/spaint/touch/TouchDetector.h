@@ -6,7 +6,7 @@
 #ifndef H_SPAINT_TOUCHDETECTOR
 #define H_SPAINT_TOUCHDETECTOR
 
-#include <arrayfire.h>
+#include <boost/optional.hpp>
 
 #include <itmx/base/ITMObjectPtrTypes.h>
 
@@ -17,6 +17,7 @@
 #include <tvgutil/persistence/PropertyUtil.h>
 
 #include "TouchSettings.h"
+#include "interface/TouchCandidateExtractor.h"
 #include "../imageprocessing/interface/ImageProcessor.h"
 #include "../visualisation/interface/DepthVisualiser.h"
 
@@ -24,12 +25,17 @@ namespace spaint {
 
 /**
  * \brief An instance of this class can be used to detect a touch interaction.
+ *
+ * All of the per-pixel processing is performed by a touch candidate extractor on the device, so that the only
+ * data copied back to the CPU on each frame are the statistics of the candidate components and the touch points.
+ * If enabled in the touch settings, the detector can also track the hand from frame to frame, searching only a
+ * region of interest around the previous frame's touch interaction rather than the whole image.
  */
 class TouchDetector
 {
   //#################### TYPEDEFS ####################
 private:
-  typedef boost::shared_ptr<af::array> AFArray_Ptr;
+  typedef TouchCandidateExtractor::Candidate Candidate;
   typedef int Label;
   typedef rafl::RandomForest<Label> RF;
   typedef boost::shared_ptr<RF> RF_Ptr;
@@ -44,11 +50,8 @@ private:
 
   //#################### PRIVATE VARIABLES ####################
 private:
-  /** An image in which to store a mask of the changes that have been detected in the scene with respect to the reconstructed model. */
-  AFArray_Ptr m_changeMask;
-
-  /** An image in which to store the connected components of the change mask. */
-  af::array m_connectedComponentImage;
+  /** The extractor used to find candidate touch interactions and extract touch points from them. */
+  TouchCandidateExtractor_Ptr m_candidateExtractor;
 
   /** An image in which to store the depth of the reconstructed model as viewed from the current camera pose. */
   ITMFloatImage_Ptr m_depthRaycast;
@@ -56,12 +59,12 @@ private:
   /** The depth visualiser. */
   DepthVisualiser_CPtr m_depthVisualiser;
 
-  /** An image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast. */
-  AFArray_Ptr m_diffRawRaycast;
-
-  /** The random forest used to score the candidate connected components. */
+  /** The random forest used to score the candidate connected components (NULL if a compiled forest was loaded directly). */
   RF_Ptr m_forest;
 
+  /** The number of consecutive frames for which only a region of interest has been searched. */
+  int m_framesSinceFullScan;
+
   /** The height of the images on which the touch detector is running. */
   int m_imageHeight;
 
@@ -83,12 +86,12 @@ private:
   /** A thresholded version of the raw depth image captured from the camera in which parts of the scene > 2m away have been masked out. */
   ITMFloatImage_Ptr m_thresholdedRawDepth;
 
-  /** An image in which to store a mask denoting the detected touch region. */
-  AFArray_Ptr m_touchMask;
-
   /** The settings needed to configure the touch detector. */
   TouchSettings_Ptr m_touchSettings;
 
+  /** The region of interest around the touch interaction found in the previous frame (if any). */
+  boost::optional<Vector4i> m_trackedROI;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -158,38 +161,40 @@ public:
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /**
-   * \brief Detects changes between the raw depth image from the camera and a depth raycast of the reconstructed model.
+   * \brief Determines the region of interest in which to search for candidate touch interactions in the current frame.
+   *
+   * This is either a padded version of the bounding box of the previous frame's touch interaction or, if there is no
+   * such interaction, ROI tracking is disabled or it is time for a periodic full scan, the whole image.
+   *
+   * \return  The region of interest, as (minX, minY, maxX, maxY), inclusive.
    */
-  void detect_changes();
+  Vector4i determine_roi();
 
   /**
-   * \brief Extracts a set of touch points from the specified component in the connected component image.
+   * \brief Extracts a set of touch points from the specified candidate component.
    *
-   * \param component           The ID of a component in the connected component image.
-   * \param diffRawRaycastInMm  An image in which each pixel is the absolute difference in mm between the current and raycasted depths.
-   * \return                    The touch points extracted from the specified component.
+   * \param candidate The candidate component.
+   * \return          The touch points extracted from the specified component.
    */
-  std::vector<Eigen::Vector2i> extract_touch_points(int component, const af::array& diffRawRaycastInMm);
+  std::vector<Eigen::Vector2i> extract_touch_points(const Candidate& candidate);
 
   /**
    * Picks the candidate component most likely to correspond to a touch interaction based on mean distance to the scene.
    *
-   * \param candidateComponents The IDs of components in the connected component image that denote candidate touch interactions.
-   * \param diffRawRaycastInMm  An image in which each pixel is the absolute difference in mm between the current and raycasted depths.
-   * \return                    The ID of the best candidate component.
+   * \param candidates  The candidate components.
+   * \return            The index of the best candidate component.
    */
-  int pick_best_candidate_component_based_on_distance(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const;
+  int pick_best_candidate_component_based_on_distance(const std::vector<Candidate>& candidates) const;
 
   /**
    * \brief Picks the candidate component most likely to correspond to a touch interaction based on predictions made by a random forest.
    *
    * If no candidates are classified as interactions by the forest, there is no best candidate and we return -1.
    *
-   * \param candidateComponents The IDs of components in the connected component image that denote candidate touch interactions.
-   * \param diffRawRaycastInMm  An image in which each pixel is the absolute difference in mm between the current and raycasted depths.
-   * \return                    The ID of the best candidate component, or -1 if no candidates are classified as interactions by the forest.
+   * \param candidates  The candidate components.
+   * \return            The index of the best candidate component, or -1 if no candidates are classified as interactions by the forest.
    */
-  int pick_best_candidate_component_based_on_forest(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const;
+  int pick_best_candidate_component_based_on_forest(const std::vector<Candidate>& candidates) const;
 
   /**
    * \brief Prepares a thresholded version of the raw depth image and a depth raycast ready for change detection.
@@ -210,31 +215,13 @@ private:
   /**
    * \brief Saves an image of each candidate component to disk for use with the touchtrain application.
    *
-   * \param candidateComponents The candidate components denoting candidate touch interactions.
-   * \param diffRawRaycast      An image in which each pixel is the absolute difference between the raw depth image and the depth raycast.
+   * \param candidates  The candidate components.
    */
-  void save_candidate_components(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const;
+  void save_candidate_components(const std::vector<Candidate>& candidates) const;
 #endif
 
-  /**
-   * \brief Select candidate connected components that fall within a certain size range.
-   *
-   * \return  The IDs of the candidate components.
-   */
-  af::array select_candidate_components();
-
   //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
 private:
-  /**
-   * \brief Makes a copy of an ArrayFire array in which the elements have been clamped to the specified range.
-   *
-   * \param arr   An ArrayFire array.
-   * \param lower The lower bound of the range to which to clamp.
-   * \param upper The upper bound of the range to which to clamp.
-   * \return      A copy of the array in which the elements have been clamped to the specified range.
-   */
-  static af::array clamp_to_range(const af::array& arr, float lower, float upper);
-
   /**
    * \brief Converts an Eigen Vector to an InfiniTAM vector.
    *
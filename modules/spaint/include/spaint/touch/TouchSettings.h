@@ -7,7 +7,7 @@
 
 #include <boost/filesystem.hpp>
 
-#include <rafl/core/RandomForest.h>
+#include <rafl/core/CompiledRandomForest.h>
 
 namespace spaint {
 
@@ -19,6 +19,8 @@ class TouchSettings
   //#################### TYPEDEFS ####################
 private:
   typedef int Label;
+  typedef rafl::CompiledRandomForest<Label> CompiledRF;
+  typedef boost::shared_ptr<CompiledRF> CompiledRF_Ptr;
   typedef rafl::RandomForest<Label> RF;
   typedef boost::shared_ptr<RF> RF_Ptr;
 
@@ -50,6 +52,15 @@ public:
   /** The side length of the morphological opening kernel that is applied to the change mask to reduce noise. */
   int morphKernelSize;
 
+  /** The maximum number of consecutive frames for which to search only a region of interest before scanning the whole image again. */
+  int roiFullScanInterval;
+
+  /** The fraction of the image size by which to pad the bounding box of the previous frame's touch interaction to get the region of interest. */
+  float roiPaddingFraction;
+
+  /** Whether or not to search only a region of interest around the previous frame's touch interaction (if any), rather than the whole image. */
+  bool roiTrackingEnabled;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -70,6 +81,22 @@ public:
    */
   const std::string& get_save_candidate_components_path() const;
 
+  /**
+   * \brief Gets whether or not the file specified by the forest path contains a compiled (inference-only) forest,
+   *        as opposed to a full random forest saved using Boost.Serialization.
+   *
+   * \return  true, if the forest file contains a compiled forest, or false otherwise.
+   */
+  bool has_compiled_forest() const;
+
+  /**
+   * \brief Loads a compiled (inference-only) random forest from the file specified by the forest path.
+   *
+   * \pre     has_compiled_forest()
+   * \return  The compiled random forest that has been loaded.
+   */
+  CompiledRF_Ptr load_compiled_forest() const;
+
   /**
    * \brief Loads a random forest from the file specified by the forest path.
    *
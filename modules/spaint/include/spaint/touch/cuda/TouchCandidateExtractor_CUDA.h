@@ -0,0 +1,58 @@
+/**
+ * spaint: TouchCandidateExtractor_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TOUCHCANDIDATEEXTRACTOR_CUDA
+#define H_SPAINT_TOUCHCANDIDATEEXTRACTOR_CUDA
+
+#include "../interface/TouchCandidateExtractor.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to extract touch candidates using CUDA.
+ */
+class TouchCandidateExtractor_CUDA : public TouchCandidateExtractor
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to count the touch samples found on the device. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_touchSampleCountMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based touch candidate extractor.
+   *
+   * \param imgSize The size of the images on which the extractor is to run.
+   */
+  explicit TouchCandidateExtractor_CUDA(const Vector2i& imgSize);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void calculate_candidate_statistics(int minArea, int maxArea, const Vector4i& roi) const;
+
+  /** Override */
+  virtual void calculate_change_mask(const ITMFloatImage *rawDepth, const ITMFloatImage *depthRaycast, float changeThreshold, const Vector4i& roi) const;
+
+  /** Override */
+  virtual void classify_candidates() const;
+
+  /** Override */
+  virtual void label_components(const Vector4i& roi) const;
+
+  /** Override */
+  virtual void make_touch_masks(int componentID, int lowerThresholdMm, int upperThresholdMm, const Vector4i& roi) const;
+
+  /** Override */
+  virtual void open_mask(const ITMUCharImage_Ptr& mask, int kernelSize, const Vector4i& roi) const;
+
+  /** Override */
+  virtual int sample_touch_pixels(float scaleFactor) const;
+};
+
+}
+
+#endif
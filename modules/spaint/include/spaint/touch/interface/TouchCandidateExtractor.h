@@ -0,0 +1,327 @@
+/**
+ * spaint: TouchCandidateExtractor.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TOUCHCANDIDATEEXTRACTOR
+#define H_SPAINT_TOUCHCANDIDATEEXTRACTOR
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+#include <rafl/core/CompiledRandomForest.h>
+
+#include "../../randomforest/shared/ForestPredictor_Shared.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to find the connected regions of change between a raw depth image
+ *        and a depth raycast that might correspond to touch interactions, and to extract touch points from the chosen region.
+ *
+ * All of the per-pixel work (differencing, thresholding, morphology, connected component labelling and the per-component
+ * statistics) is performed on the device using InfiniTAM images. Only a small table of candidate statistics, and later the
+ * touch points themselves, are ever copied back to the CPU. If a touch forest has been set, the candidates are also classified
+ * on the device as part of the same pass, so that the cost of choosing between them does not grow with the number of candidates.
+ */
+class TouchCandidateExtractor
+{
+  //#################### CONSTANTS ####################
+public:
+  /** The number of bins in the histogram descriptor of a candidate. */
+  static const int HISTOGRAM_BIN_COUNT = 64;
+
+  /** The maximum number of candidates that can be found in a single frame. */
+  static const int MAX_CANDIDATE_COUNT = 64;
+
+  //#################### TYPEDEFS ####################
+public:
+  typedef rafl::CompiledRandomForest<int> CompiledTouchForest;
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains the statistics for a candidate connected component.
+   */
+  struct Candidate
+  {
+    /** The area of the component (in pixels). */
+    int area;
+
+    /** The bounding box of the component, as (minX, minY, maxX, maxY), inclusive. */
+    Vector4i boundingBox;
+
+    /** The ID of the component in the connected component image. */
+    int componentID;
+
+    /** The sum of the absolute differences (in mm) between the raw depth and the depth raycast over the component. */
+    int diffSumMm;
+
+    /**
+     * A histogram of the absolute differences (in mm) over an image that is zero everywhere except in the component.
+     * This is the same as the descriptor that TouchDescriptorCalculator would compute for the image.
+     */
+    std::vector<float> histogram;
+
+    /** The probability that the touch forest assigns to the component being a touch interaction (or -1 if no touch forest has been set). */
+    float touchProbability;
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /**
+   * The statistics for the candidates found in the most recent frame. This is laid out as the number of candidates
+   * found, followed by MAX_CANDIDATE_COUNT component IDs, areas and difference sums, followed by the histograms,
+   * followed by the bounding boxes.
+   */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_candidateStatsMB;
+
+  /** The mask of the pixels that have changed with respect to the reconstructed model. */
+  ITMUCharImage_Ptr m_changeMask;
+
+  /** A memory block in which to store the area of each component (indexed by its ID). */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_componentAreasMB;
+
+  /** The connected component image (each pixel holds the ID of its component, or -1 if it is unchanged). */
+  ITMIntImage_Ptr m_componentImage;
+
+  /** A memory block in which to store the candidate slot of each component (indexed by its ID), or -1 if it is not a candidate. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_componentSlotsMB;
+
+  /** An image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast. */
+  ITMFloatImage_Ptr m_diffRawRaycast;
+
+  /** An image in which each pixel is the absolute difference (in mm, clamped to [0,255]) between the raw depth image and the depth raycast. */
+  ITMUCharImage_Ptr m_diffRawRaycastInMm;
+
+  /** A temporary mask used when applying morphological operations. */
+  ITMUCharImage_Ptr m_morphologyBuffer;
+
+  /** The number of labels for which masses are stored for each leaf of the touch forest. */
+  int m_touchForestLabelCount;
+
+  /** A memory block containing the masses of the leaf PMFs of the touch forest (if any). */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_touchForestLeafMassesMB;
+
+  /** A memory block containing the nodes of all of the trees in the touch forest (if any). */
+  boost::shared_ptr<ORUtils::MemoryBlock<ForestPredictorNode> > m_touchForestNodesMB;
+
+  /** A memory block containing the indices of the roots of the trees in the touch forest's node array. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_touchForestRootIndicesMB;
+
+  /** The number of trees in the touch forest (or 0 if no touch forest has been set). */
+  int m_touchForestTreeCount;
+
+  /** The label that the touch forest uses to denote a touch interaction. */
+  int m_touchLabel;
+
+  /** A mask denoting the pixels in the component chosen as the touch interaction. */
+  ITMUCharImage_Ptr m_touchMask;
+
+  /** A mask denoting the pixels in the chosen component that are close to the surface being touched. */
+  ITMUCharImage_Ptr m_touchPixelMask;
+
+  /** The probabilities that the touch forest assigns to the candidates found in the most recent frame being touch interactions. */
+  boost::shared_ptr<ORUtils::MemoryBlock<float> > m_touchProbabilitiesMB;
+
+  /** A memory block in which to store the touch points (as indices into the downsampled grid) found in the most recent frame. */
+  boost::shared_ptr<ORUtils::MemoryBlock<int> > m_touchSamplesMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a touch candidate extractor.
+   *
+   * \param imgSize The size of the images on which the extractor is to run.
+   */
+  explicit TouchCandidateExtractor(const Vector2i& imgSize);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the touch candidate extractor.
+   */
+  virtual ~TouchCandidateExtractor();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Calculates the candidate statistics for the connected components (leaving them on the device).
+   *
+   * \param minArea The minimum area (in pixels) of a candidate component.
+   * \param maxArea The maximum area (in pixels) of a candidate component.
+   * \param roi     The region of interest to which the components are confined.
+   */
+  virtual void calculate_candidate_statistics(int minArea, int maxArea, const Vector4i& roi) const = 0;
+
+  /**
+   * \brief Calculates the change mask and the difference images from the raw depth image and the depth raycast.
+   *
+   * The difference images are calculated over the whole image, but the change mask is cleared outside the region of interest.
+   *
+   * \param rawDepth        The (thresholded) raw depth image.
+   * \param depthRaycast    The depth raycast.
+   * \param changeThreshold The difference (in m) above which a pixel is considered to have changed.
+   * \param roi             The region of interest.
+   */
+  virtual void calculate_change_mask(const ITMFloatImage *rawDepth, const ITMFloatImage *depthRaycast, float changeThreshold, const Vector4i& roi) const = 0;
+
+  /**
+   * \brief Evaluates the touch forest on the descriptors of the candidates found by calculate_candidate_statistics (leaving the probabilities on the device).
+   *
+   * \pre A touch forest has been set.
+   */
+  virtual void classify_candidates() const = 0;
+
+  /**
+   * \brief Labels the connected components (4-connected) of the change mask.
+   *
+   * \param roi The region of interest outside which the change mask is known to be clear.
+   */
+  virtual void label_components(const Vector4i& roi) const = 0;
+
+  /**
+   * \brief Computes the touch mask and touch pixel mask for the specified component.
+   *
+   * \param componentID       The ID of the component.
+   * \param lowerThresholdMm  The lower difference threshold (in mm) for touch pixels.
+   * \param upperThresholdMm  The upper difference threshold (in mm) for touch pixels.
+   * \param roi               A region of interest containing the component (the masks are cleared outside it).
+   */
+  virtual void make_touch_masks(int componentID, int lowerThresholdMm, int upperThresholdMm, const Vector4i& roi) const = 0;
+
+  /**
+   * \brief Applies a morphological opening operation with a square kernel to the specified mask.
+   *
+   * The opening is only applied within the region of interest, outside which the mask is assumed to be clear.
+   * Pixels outside the region of interest are ignored by the kernel, just as pixels outside the image are.
+   *
+   * \param mask        The mask.
+   * \param kernelSize  The size of the kernel (an odd number).
+   * \param roi         The region of interest.
+   */
+  virtual void open_mask(const ITMUCharImage_Ptr& mask, int kernelSize, const Vector4i& roi) const = 0;
+
+  /**
+   * \brief Samples the touch pixel mask on a downsampled grid, and makes the indices of the grid points that hit touch pixels available on the CPU.
+   *
+   * \param scaleFactor The factor by which to downsample the grid.
+   * \return            The number of grid points that hit touch pixels.
+   */
+  virtual int sample_touch_pixels(float scaleFactor) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Clears the touch mask (e.g. because no touch interaction was found).
+   */
+  void clear_touch_mask() const;
+
+  /**
+   * \brief Finds the connected regions of change between a raw depth image and a depth raycast that might correspond to touch interactions.
+   *
+   * Only changes within the specified region of interest are considered, and the cost of most of the processing is proportional
+   * to the size of that region. The difference images are still computed over the whole image.
+   *
+   * \param rawDepth        The (thresholded) raw depth image.
+   * \param depthRaycast    The depth raycast.
+   * \param changeThreshold The difference (in m) above which a pixel is considered to have changed.
+   * \param morphKernelSize The size of the kernel used to remove noise from the change mask.
+   * \param minArea         The minimum area (in pixels) of a candidate component.
+   * \param maxArea         The maximum area (in pixels) of a candidate component.
+   * \param roi             The region of interest, as (minX, minY, maxX, maxY), inclusive (it is clamped to the image bounds).
+   * \return                The candidate components, in ascending order of ID.
+   */
+  std::vector<Candidate> extract_candidates(const ITMFloatImage *rawDepth, const ITMFloatImage *depthRaycast, float changeThreshold,
+                                            int morphKernelSize, int minArea, int maxArea, const Vector4i& roi) const;
+
+  /**
+   * \brief Extracts a set of touch points from the specified candidate component.
+   *
+   * \param candidate         The candidate component (as found by the most recent call to extract_candidates).
+   * \param lowerThresholdMm  The lower difference threshold (in mm) for touch pixels.
+   * \param upperThresholdMm  The upper difference threshold (in mm) for touch pixels.
+   * \param scaleFactor       The factor by which to spatially quantise the touch pixels (this reduces the number of touch points).
+   * \param minTouchArea      The number of (quantised) touch points that must be exceeded for the user to be considered to be touching the scene.
+   * \return                  The touch points (in full-resolution image coordinates), in column-major order.
+   */
+  std::vector<Eigen::Vector2i> extract_touch_points(const Candidate& candidate, int lowerThresholdMm, int upperThresholdMm, float scaleFactor, float minTouchArea) const;
+
+
+  /**
+   * \brief Gets the (denoised) change mask computed by the most recent call to extract_candidates.
+   *
+   * \return  The change mask.
+   */
+  ITMUCharImage_CPtr get_change_mask() const;
+
+  /**
+   * \brief Gets the connected component image computed by the most recent call to extract_candidates.
+   *
+   * \return  The connected component image.
+   */
+  ITMIntImage_CPtr get_component_image() const;
+
+  /**
+   * \brief Gets an image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast.
+   *
+   * \return  An image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast.
+   */
+  ITMFloatImage_CPtr get_diff_raw_raycast() const;
+
+  /**
+   * \brief Gets an image in which each pixel is the absolute difference (in mm, clamped to [0,255]) between the raw depth image and the depth raycast.
+   *
+   * \return  An image in which each pixel is the absolute difference (in mm, clamped to [0,255]) between the raw depth image and the depth raycast.
+   */
+  ITMUCharImage_CPtr get_diff_raw_raycast_in_mm() const;
+
+  /**
+   * \brief Gets a region of interest that covers the whole of the images on which the extractor runs.
+   *
+   * \return  A region of interest that covers the whole image.
+   */
+  Vector4i get_full_roi() const;
+
+  /**
+   * \brief Gets a mask denoting the pixels in the component chosen as the touch interaction (if any).
+   *
+   * \return  A mask denoting the pixels in the component chosen as the touch interaction (if any).
+   */
+  ITMUCharImage_CPtr get_touch_mask() const;
+
+  /**
+   * \brief Gets a mask denoting the pixels in the chosen component that are close to the surface being touched.
+   *
+   * \return  A mask denoting the pixels in the chosen component that are close to the surface being touched.
+   */
+  ITMUCharImage_CPtr get_touch_pixel_mask() const;
+
+  /**
+   * \brief Gets whether or not a touch forest has been set.
+   *
+   * \return  true, if a touch forest has been set, or false otherwise.
+   */
+  bool has_touch_forest() const;
+
+  /**
+   * \brief Sets the forest used to classify the candidates, replacing any forest that was previously set.
+   *
+   * \param forest                The compiled snapshot of the touch forest.
+   * \param touchLabel            The label that the forest uses to denote a touch interaction.
+   * \throws std::invalid_argument If the forest needs larger descriptors than those computed for the candidates.
+   */
+  void set_touch_forest(const CompiledTouchForest& forest, int touchLabel);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<TouchCandidateExtractor> TouchCandidateExtractor_Ptr;
+typedef boost::shared_ptr<const TouchCandidateExtractor> TouchCandidateExtractor_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * spaint: TouchCandidateExtractor_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TOUCHCANDIDATEEXTRACTOR_SHARED
+#define H_SPAINT_TOUCHCANDIDATEEXTRACTOR_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+#include "../../randomforest/shared/ForestPredictor_Shared.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Calculates the change mask and difference images for a pixel by comparing the raw depth with the depth raycast.
+ *
+ * The absolute difference is only calculated if both depths are non-negative; otherwise, it is set to -1 (and the
+ * pixel is never marked as changed). The same difference is also stored in millimetres, clamped to [0,255]. Pixels
+ * outside the region of interest are never marked as changed.
+ *
+ * \param pixelIndex          The index of the pixel.
+ * \param width               The width of the images.
+ * \param roi                 The region of interest, as (minX, minY, maxX, maxY), inclusive.
+ * \param rawDepth            The (thresholded) raw depth image.
+ * \param depthRaycast        The depth raycast.
+ * \param changeThreshold     The difference (in m) above which a pixel is considered to have changed.
+ * \param diffRawRaycast      The image in which to store the absolute difference (in m).
+ * \param diffRawRaycastInMm  The image in which to store the absolute difference (in mm).
+ * \param changeMask          The change mask.
+ */
+_CPU_AND_GPU_CODE_
+inline void calculate_change_pixel(int pixelIndex, int width, const Vector4i& roi, const float *rawDepth, const float *depthRaycast, float changeThreshold,
+                                   float *diffRawRaycast, unsigned char *diffRawRaycastInMm, unsigned char *changeMask)
+{
+  const int x = pixelIndex % width, y = pixelIndex / width;
+  const bool inROI = roi.x <= x && x <= roi.z && roi.y <= y && y <= roi.w;
+
+  const float raw = rawDepth[pixelIndex], raycast = depthRaycast[pixelIndex];
+  const float diff = raw >= 0.0f && raycast >= 0.0f ? fabs(raw - raycast) : -1.0f;
+  const float diffInMm = diff * 1000.0f;
+
+  diffRawRaycast[pixelIndex] = diff;
+  diffRawRaycastInMm[pixelIndex] = diffInMm <= 0.0f ? 0 : diffInMm >= 255.0f ? 255 : static_cast<unsigned char>(diffInMm);
+  changeMask[pixelIndex] = inROI && diff > changeThreshold ? 1 : 0;
+}
+
+/**
+ * \brief Calculates the bin of the touch histogram descriptor into which a difference value (in mm) falls.
+ *
+ * This matches the binning used by TouchDescriptorCalculator, so that the forest sees the same descriptors either way.
+ *
+ * \param diffInMm  The difference value (in mm).
+ * \param binCount  The number of bins in the histogram.
+ * \return          The bin into which the value falls.
+ */
+_CPU_AND_GPU_CODE_
+inline int calculate_histogram_bin(unsigned char diffInMm, int binCount)
+{
+  const int bin = static_cast<int>(diffInMm * binCount / 255.0f);
+  return bin < binCount ? bin : binCount - 1;
+}
+
+/**
+ * \brief Calculates the probability that the touch forest assigns to a candidate being a touch interaction.
+ *
+ * The candidate's descriptor is rebuilt from the statistics table: it is the candidate's histogram, with all of the pixels
+ * outside the candidate added to the first bin (exactly as in TouchCandidateExtractor::extract_candidates).
+ *
+ * \param slot                The slot of the candidate in the statistics table.
+ * \param stats               The statistics table (see TouchCandidateExtractor::m_candidateStatsMB).
+ * \param maxCandidateCount   The maximum number of candidates in the statistics table.
+ * \param binCount            The number of bins in each candidate's histogram.
+ * \param pixelCount          The number of pixels in the image.
+ * \param nodes               The nodes of all of the trees in the touch forest.
+ * \param rootIndices         The indices of the roots of the trees in the node array.
+ * \param treeCount           The number of trees in the touch forest.
+ * \param leafMasses          The masses of the leaf PMFs of the touch forest.
+ * \param labelCount          The number of labels for which masses are stored for each leaf.
+ * \param touchLabel          The label that the touch forest uses to denote a touch interaction.
+ * \param descriptor          A scratch array of binCount elements in which to build the candidate's descriptor.
+ * \param touchProbabilities  The array into which to write the probability.
+ */
+_CPU_AND_GPU_CODE_
+inline void classify_candidate(int slot, const int *stats, int maxCandidateCount, int binCount, int pixelCount,
+                               const ForestPredictorNode *nodes, const int *rootIndices, int treeCount, const float *leafMasses,
+                               int labelCount, int touchLabel, float *descriptor, float *touchProbabilities)
+{
+  const int area = stats[1 + maxCandidateCount + slot];
+  const int *histogram = stats + 1 + 3 * maxCandidateCount + slot * binCount;
+  for(int i = 0; i < binCount; ++i) descriptor[i] = static_cast<float>(histogram[i]);
+  descriptor[0] += static_cast<float>(pixelCount - area);
+
+  touchProbabilities[slot] = calculate_label_probability(descriptor, nodes, rootIndices, treeCount, leafMasses, labelCount, touchLabel);
+}
+
+/**
+ * \brief Calculates the number of pixels in a region of interest.
+ *
+ * \param roi The region of interest, as (minX, minY, maxX, maxY), inclusive.
+ * \return    The number of pixels in the region of interest.
+ */
+_CPU_AND_GPU_CODE_
+inline int calculate_roi_pixel_count(const Vector4i& roi)
+{
+  return (roi.z - roi.x + 1) * (roi.w - roi.y + 1);
+}
+
+/**
+ * \brief Finds the root of the connected component containing the specified pixel.
+ *
+ * \param pixelIndex  The index of the pixel (which must be in the foreground).
+ * \param labels      The component labels, in which each foreground pixel refers to another pixel in its component with a smaller index.
+ * \return            The index of the root pixel of the component (the pixel in the component with the smallest index).
+ */
+_CPU_AND_GPU_CODE_
+inline int find_component_root(int pixelIndex, const int *labels)
+{
+  while(labels[pixelIndex] != pixelIndex) pixelIndex = labels[pixelIndex];
+  return pixelIndex;
+}
+
+/**
+ * \brief Initialises the component label of a pixel prior to connected component labelling.
+ *
+ * \param pixelIndex  The index of the pixel.
+ * \param mask        The binary mask whose connected components are to be labelled.
+ * \param labels      The component labels (set to the pixel's own index for foreground pixels, or -1 otherwise).
+ */
+_CPU_AND_GPU_CODE_
+inline void initialise_component_label(int pixelIndex, const unsigned char *mask, int *labels)
+{
+  labels[pixelIndex] = mask[pixelIndex] ? pixelIndex : -1;
+}
+
+/**
+ * \brief Applies a one-dimensional erosion or dilation (with a box kernel) to a pixel in a binary mask.
+ *
+ * A square erosion/dilation can be computed by a horizontal pass followed by a vertical pass. Pixels outside the
+ * region of interest are ignored, rather than being treated as background or foreground.
+ *
+ * \param x           The x coordinate of the pixel.
+ * \param y           The y coordinate of the pixel.
+ * \param input       The input mask.
+ * \param width       The width of the mask.
+ * \param roi         The region of interest, as (minX, minY, maxX, maxY), inclusive.
+ * \param radius      The radius of the kernel (i.e. half its size, rounded down).
+ * \param horizontal  Whether to apply the kernel horizontally (true) or vertically (false).
+ * \param erode       Whether to erode (true) or dilate (false).
+ * \param output      The output mask.
+ */
+_CPU_AND_GPU_CODE_
+inline void morph_pixel(int x, int y, const unsigned char *input, int width, const Vector4i& roi, int radius, bool horizontal, bool erode, unsigned char *output)
+{
+  const int centre = horizontal ? x : y, minLimit = horizontal ? roi.x : roi.y, maxLimit = horizontal ? roi.z : roi.w;
+  const int lo = centre - radius > minLimit ? centre - radius : minLimit, hi = centre + radius < maxLimit ? centre + radius : maxLimit;
+  const unsigned char target = erode ? 0 : 1;
+
+  unsigned char result = 1 - target;
+  for(int i = lo; i <= hi; ++i)
+  {
+    const unsigned char value = horizontal ? input[y * width + i] : input[i * width + x];
+    if(value == target)
+    {
+      result = target;
+      break;
+    }
+  }
+
+  output[y * width + x] = result;
+}
+
+/**
+ * \brief Computes the touch mask and touch pixel mask for a pixel, given the component that has been chosen as the touch interaction.
+ *
+ * The touch mask marks all of the pixels in the chosen component. The touch pixel mask marks those pixels in the component
+ * whose (quantised) difference from the scene lies strictly between the specified thresholds, i.e. those that are close to
+ * the surface being touched.
+ *
+ * \param pixelIndex          The index of the pixel.
+ * \param componentID         The ID of the chosen component.
+ * \param componentImage      The connected component image.
+ * \param diffRawRaycastInMm  The absolute difference (in mm) between the raw depth and the depth raycast.
+ * \param lowerThresholdMm    The lower difference threshold (in mm).
+ * \param upperThresholdMm    The upper difference threshold (in mm).
+ * \param touchMask           The touch mask.
+ * \param touchPixelMask      The touch pixel mask.
+ */
+_CPU_AND_GPU_CODE_
+inline void make_touch_pixel(int pixelIndex, int componentID, const int *componentImage, const unsigned char *diffRawRaycastInMm,
+                             int lowerThresholdMm, int upperThresholdMm, unsigned char *touchMask, unsigned char *touchPixelMask)
+{
+  const bool inComponent = componentImage[pixelIndex] == componentID;
+
+  // Quantise the difference to 32 levels before thresholding it.
+  const int quantisedDiff = inComponent ? diffRawRaycastInMm[pixelIndex] / 8 * 8 : 0;
+
+  touchMask[pixelIndex] = inComponent ? 1 : 0;
+  touchPixelMask[pixelIndex] = quantisedDiff > lowerThresholdMm && quantisedDiff < upperThresholdMm ? 1 : 0;
+}
+
+/**
+ * \brief Determines whether or not a point on a downsampled grid lies on a touch pixel (using nearest-neighbour sampling).
+ *
+ * \param x               The x coordinate of the point on the downsampled grid.
+ * \param y               The y coordinate of the point on the downsampled grid.
+ * \param touchPixelMask  The touch pixel mask.
+ * \param width           The width of the touch pixel mask.
+ * \param height          The height of the touch pixel mask.
+ * \param scaleFactor     The factor by which the grid has been downsampled.
+ * \return                true, if the point lies on a touch pixel, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_touch_sample(int x, int y, const unsigned char *touchPixelMask, int width, int height, float scaleFactor)
+{
+  int sx = static_cast<int>((x + 0.5f) / scaleFactor), sy = static_cast<int>((y + 0.5f) / scaleFactor);
+  if(sx > width - 1) sx = width - 1;
+  if(sy > height - 1) sy = height - 1;
+  return touchPixelMask[sy * width + sx] != 0;
+}
+
+}
+
+#endif
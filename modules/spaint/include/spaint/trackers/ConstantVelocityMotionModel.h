@@ -0,0 +1,82 @@
+/**
+ * spaint: ConstantVelocityMotionModel.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CONSTANTVELOCITYMOTIONMODEL
+#define H_SPAINT_CONSTANTVELOCITYMOTIONMODEL
+
+#include <boost/optional.hpp>
+
+#include <itmx/geometry/DualQuaternion.h>
+
+#include <ORUtils/SE3Pose.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to predict the camera pose for the next frame by assuming that the camera
+ *        keeps moving with the (rigid-body) velocity it had between the two most recent well-tracked frames.
+ *
+ * This is intended to seed an iterative tracker such as ICP, which would otherwise start from the previous frame's pose:
+ * the closer the initial pose is to the true one, the fewer iterations the tracker needs to converge, and the less likely
+ * it is to fail when the camera is moving quickly. The velocity can optionally be damped (i.e. only a fraction of it can be
+ * applied), which makes the prediction more conservative, and velocities that are implausibly large (e.g. because one of
+ * the poses from which they were calculated was wrong) are ignored altogether.
+ */
+class ConstantVelocityMotionModel
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The fraction of the estimated velocity to apply when predicting the next pose (in [0,1]). */
+  double m_damping;
+
+  /** The most recent well-tracked pose (if any), as a dual quaternion. */
+  boost::optional<itmx::DualQuatd> m_lastPose;
+
+  /** The largest per-frame rotation (in radians) that is considered plausible. */
+  double m_maxRotationPerFrame;
+
+  /** The largest per-frame translation (in metres) that is considered plausible. */
+  double m_maxTranslationPerFrame;
+
+  /** The estimated per-frame motion of the camera (if known), as a dual quaternion. */
+  boost::optional<itmx::DualQuatd> m_velocity;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a constant-velocity motion model.
+   *
+   * \param damping                 The fraction of the estimated velocity to apply when predicting the next pose.
+   * \param maxRotationPerFrame     The largest per-frame rotation (in radians) that is considered plausible.
+   * \param maxTranslationPerFrame  The largest per-frame translation (in metres) that is considered plausible.
+   * \throws std::invalid_argument  If the damping is not in [0,1].
+   */
+  ConstantVelocityMotionModel(double damping, double maxRotationPerFrame, double maxTranslationPerFrame);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Predicts the camera pose for the next frame.
+   *
+   * \return  The predicted pose, if the velocity of the camera is known, or boost::none otherwise.
+   */
+  boost::optional<ORUtils::SE3Pose> predict_pose() const;
+
+  /**
+   * \brief Forgets the velocity of the camera (e.g. after a tracking failure or relocalisation).
+   */
+  void reset();
+
+  /**
+   * \brief Updates the motion model with the pose of a well-tracked frame.
+   *
+   * \param pose  The pose of the frame.
+   */
+  void update(const ORUtils::SE3Pose& pose);
+};
+
+}
+
+#endif
@@ -53,6 +53,18 @@ public:
   RobustViconTracker(const std::string& host, const std::string& subjectName, const Vector2i& rgbImageSize, const Vector2i& depthImageSize,
                      const Settings_CPtr& settings, const LowLevelEngine_CPtr& lowLevelEngine);
 
+  /**
+   * \brief Constructs a robust Vicon tracker that gets its coarse poses from an existing Vicon pose provider.
+   *
+   * \param poseProvider      The provider from which to get the coarse camera poses (this can be shared with other trackers).
+   * \param rgbImageSize      The RGB image size.
+   * \param depthImageSize    The depth image size.
+   * \param settings          The settings to use for InfiniTAM.
+   * \param lowLevelEngine    The engine used to perform low-level image processing operations.
+   */
+  RobustViconTracker(const ViconPoseProvider_Ptr& poseProvider, const Vector2i& rgbImageSize, const Vector2i& depthImageSize,
+                     const Settings_CPtr& settings, const LowLevelEngine_CPtr& lowLevelEngine);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
@@ -0,0 +1,188 @@
+/**
+ * spaint: ViconPoseProvider.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_VICONPOSEPROVIDER
+#define H_SPAINT_VICONPOSEPROVIDER
+
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <Eigen/Dense>
+
+#include <vicon/Client.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class receives the pose of a camera subject from a Vicon system on a separate thread.
+ *
+ * The receiver thread computes the pose of the subject for every frame streamed by the Vicon system, and stores it
+ * (with a timestamp) in a fixed-size ring of recent samples. Consumers (e.g. trackers) can then get the pose of the
+ * subject at a particular time without blocking: the ring is single-producer, and each slot is protected by its own
+ * sequence number, so a consumer can detect (and skip) any slot that is overwritten whilst it is being read.
+ */
+class ViconPoseProvider
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents the pose of the camera subject at a particular time.
+   */
+  struct PoseSample
+  {
+    /** The camera's n (forward) axis. */
+    Eigen::Vector3f n;
+
+    /** The position of the camera (in metres, in the Vicon coordinate system). */
+    Eigen::Vector3f position;
+
+    /** The time (in seconds, relative to the construction of the provider) at which the subject had the pose. */
+    double timestamp;
+
+    /** Whether or not all of the markers needed to determine the pose were visible (if not, the pose is meaningless). */
+    bool tracked;
+
+    /** The camera's v (up) axis. */
+    Eigen::Vector3f v;
+  };
+
+private:
+  typedef boost::chrono::steady_clock Clock;
+
+  /**
+   * \brief An instance of this struct represents a slot in the ring of recent samples.
+   */
+  struct Slot
+  {
+    /** The sample in the slot. */
+    PoseSample sample;
+
+    /** The sequence number of the slot (odd whilst the sample is being written, and 2 * (sampleIndex + 1) once it has been). */
+    boost::atomic<size_t> sequence;
+  };
+
+  //#################### CONSTANTS ####################
+private:
+  /** The number of slots in the ring of recent samples (enough to cover a few hundred milliseconds at typical Vicon frame rates). */
+  static const size_t SLOT_COUNT = 128;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The time at which the provider was constructed. */
+  Clock::time_point m_creationTime;
+
+  /** The thread on which samples are received from the Vicon system. */
+  boost::thread m_receiver;
+
+  /** A flag set in the destructor to indicate that the receiver thread should terminate. */
+  boost::atomic<bool> m_receiverShouldTerminate;
+
+  /** The number of samples that have been written into the ring (only written by the receiver thread). */
+  boost::atomic<size_t> m_sampleCount;
+
+  /** The ring of recent samples. */
+  Slot m_slots[SLOT_COUNT];
+
+  /** The name given to the camera subject in the Vicon software. */
+  std::string m_subjectName;
+
+  /** The Vicon client (only accessed by the receiver thread once it has started). */
+  ViconDataStreamSDK::CPP::Client m_vicon;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a Vicon pose provider, and starts receiving poses from the Vicon system.
+   *
+   * \param host        The host on which the Vicon software is running (e.g. "<IP address>:<port>").
+   * \param subjectName The name given to the camera subject in the Vicon software.
+   * \throws std::runtime_error If the provider cannot connect to the Vicon system.
+   */
+  ViconPoseProvider(const std::string& host, const std::string& subjectName);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the Vicon pose provider.
+   *
+   * \note  This blocks until the receiver thread has finished waiting for its current frame from the Vicon system.
+   */
+  ~ViconPoseProvider();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ViconPoseProvider(const ViconPoseProvider&);
+  ViconPoseProvider& operator=(const ViconPoseProvider&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the current time (in seconds, relative to the construction of the provider).
+   *
+   * \return  The current time.
+   */
+  double get_current_time() const;
+
+  /**
+   * \brief Attempts to get the pose of the camera subject at the specified time, without blocking.
+   *
+   * If the time lies between two received samples, the pose is interpolated between them. If it is later than the most
+   * recent sample, the most recent sample is returned (we deliberately avoid extrapolating). If it is earlier than the
+   * oldest sample still available, the oldest sample is returned.
+   *
+   * \param timestamp The time (as returned by get_current_time) at which to get the pose of the subject.
+   * \return          The (possibly interpolated) pose of the subject, or boost::none if no samples have been received yet.
+   */
+  boost::optional<PoseSample> try_get_pose(double timestamp) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Attempts to compute the pose of the camera subject from the current Vicon frame.
+   *
+   * \param sample  The sample into which to write the pose (its tracked flag is set to false if any essential marker is occluded).
+   */
+  void compute_pose(PoseSample& sample) const;
+
+  /**
+   * \brief Receives samples from the Vicon system until termination is requested.
+   */
+  void run_receiver();
+
+  /**
+   * \brief Attempts to read the sample with the specified index from the ring.
+   *
+   * \param sampleIndex The index of the sample.
+   * \param sample      The sample into which to read it.
+   * \return            true, if the sample was read successfully, or false if it has already been overwritten.
+   */
+  bool try_read_sample(size_t sampleIndex, PoseSample& sample) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Interpolates between two samples.
+   *
+   * \param s0  The earlier sample.
+   * \param s1  The later sample.
+   * \param t   The time at which to interpolate (which must lie between the timestamps of the two samples).
+   * \return    The interpolated sample.
+   */
+  static PoseSample interpolate(const PoseSample& s0, const PoseSample& s1, double t);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<ViconPoseProvider> ViconPoseProvider_Ptr;
+
+}
+
+#endif
@@ -6,16 +6,12 @@
 #ifndef H_SPAINT_VICONTRACKER
 #define H_SPAINT_VICONTRACKER
 
-#include <map>
 #include <string>
 
 #include <boost/optional.hpp>
 
-#include <Eigen/Dense>
-
-#include <vicon/Client.h>
-
 #include "FallibleTracker.h"
+#include "ViconPoseProvider.h"
 
 namespace spaint {
 
@@ -24,33 +20,41 @@ namespace spaint {
  *
  * Note that the Vicon tracker is capable of detecting tracking failures. These generally occur
  * if we move out of range of the cameras or occlude the markers.
+ *
+ * The poses are received from the Vicon system on a separate thread (see ViconPoseProvider), so tracking never waits
+ * on the network: each call to TrackCamera interpolates the received poses to the time at which the frame was captured.
  */
 class ViconTracker : public FallibleTracker
 {
   //#################### PRIVATE VARIABLES ####################
 private:
-  /** The name given to the camera subject in the Vicon software. */
-  std::string m_subjectName;
+  /** The time (in seconds) by which the camera's frames lag behind the real world when they are passed to the tracker. */
+  double m_cameraLatency;
 
-  /** The Vicon client. */
-  ViconDataStreamSDK::CPP::Client m_vicon;
+  /** The inverse of the camera's initial global pose (available once the camera has first been tracked). */
+  boost::optional<Matrix4f> m_invInitialPose;
+
+  /** The provider from which to get the camera poses. */
+  ViconPoseProvider_Ptr m_poseProvider;
 
   //#################### CONSTRUCTORS ####################
 public:
   /**
    * \brief Constructs a Vicon tracker.
    *
-   * \param host        The host on which the Vicon software is running (e.g. "<IP address>:<port>").
-   * \param subjectName The name given to the camera subject in the Vicon software.
+   * \param host          The host on which the Vicon software is running (e.g. "<IP address>:<port>").
+   * \param subjectName   The name given to the camera subject in the Vicon software.
+   * \param cameraLatency The time (in seconds) by which the camera's frames lag behind the real world when they are passed to the tracker.
    */
-  ViconTracker(const std::string& host, const std::string& subjectName);
+  ViconTracker(const std::string& host, const std::string& subjectName, double cameraLatency = 0.0);
 
-  //#################### DESTRUCTOR ####################
-public:
   /**
-   * \brief Destroys the Vicon tracker.
+   * \brief Constructs a Vicon tracker that gets its poses from an existing pose provider.
+   *
+   * \param poseProvider  The provider from which to get the camera poses (this can be shared with other trackers).
+   * \param cameraLatency The time (in seconds) by which the camera's frames lag behind the real world when they are passed to the tracker.
    */
-  ~ViconTracker();
+  ViconTracker(const ViconPoseProvider_Ptr& poseProvider, double cameraLatency = 0.0);
 
   //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
 private:
@@ -71,18 +75,6 @@ public:
 
   /** Override */
   virtual void TrackCamera(ITMLib::ITMTrackingState *trackingState, const ITMLib::ITMView *view);
-
-  //#################### PRIVATE MEMBER FUNCTIONS ####################
-private:
-  /**
-   * \brief Attempts to get the positions of the markers for the Vicon subject with the specified name.
-   *
-   * This may fail if we move out of the range of the cameras or some of the markers are occluded.
-   *
-   * \param subjectName The name of the subject.
-   * \return            The positions of the markers for the subject, indexed by name, or boost::none if they are temporarily unavailable.
-   */
-  boost::optional<std::map<std::string,Eigen::Vector3f> > try_get_marker_positions(const std::string& subjectName) const;
 };
 
 }
@@ -0,0 +1,74 @@
+/**
+ * spaint: CUDADeviceScope.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_CUDADEVICESCOPE
+#define H_SPAINT_CUDADEVICESCOPE
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class makes a specific CUDA device current on the calling thread for as long as it exists.
+ *
+ * The device that was current when the scope was entered is made current again when the scope is exited. This is used to
+ * give each scene of a multi-scene pipeline its own device: the work for a scene is done within a scope for its device.
+ * If CUDA support is not available, or the specified device is negative, the scope does nothing.
+ */
+class CUDADeviceScope
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The device that was current when the scope was entered (or -1, if the scope did not switch devices). */
+  int m_previousDevice;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Enters a scope in which the specified CUDA device is current.
+   *
+   * \param device              The device to make current (a negative value means "stay on the current device").
+   * \throws std::runtime_error If the device cannot be made current.
+   */
+  explicit CUDADeviceScope(int device);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Exits the scope, making the previously current device current again.
+   */
+  ~CUDADeviceScope();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  CUDADeviceScope(const CUDADeviceScope&);
+  CUDADeviceScope& operator=(const CUDADeviceScope&);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Enables the current device and the specified device to access each other's memory directly.
+   *
+   * This is what allows a scene that is owned by one device to be rendered (or handed to another scene) on a different one.
+   * It does nothing if the specified device is negative or current, and peer access that has already been enabled is left as is.
+   *
+   * \param peerDevice          The device whose memory should be shared with the current device.
+   * \throws std::runtime_error If the two devices cannot access each other's memory directly.
+   */
+  static void enable_peer_access(int peerDevice);
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Enables the current device to access the memory of the specified device directly.
+   *
+   * \param peerDevice          The device whose memory the current device should be able to access.
+   * \throws std::runtime_error If peer access cannot be enabled.
+   */
+  static void enable_peer_access_from_current(int peerDevice);
+};
+
+}
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * spaint: MortonCode_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MORTONCODE_SHARED
+#define H_SPAINT_MORTONCODE_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace spaint {
+
+/**
+ * \brief Inserts two zero bits between each of the low 16 bits of a value (so that bit i of the value ends up in bit 3i of the result).
+ *
+ * \param x The value.
+ * \return  The value, with two zero bits inserted between each of its low 16 bits.
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned long long spread_bits_by_three(unsigned int x)
+{
+  unsigned long long v = x & 0xFFFF;
+  v = (v | (v << 16)) & 0x0000FF0000FFULL;
+  v = (v | (v << 8)) & 0x00F00F00F00FULL;
+  v = (v | (v << 4)) & 0x0C30C30C30C3ULL;
+  v = (v | (v << 2)) & 0x249249249249ULL;
+  return v;
+}
+
+/**
+ * \brief Calculates the Morton (Z-curve) code of a position with short coordinates (e.g. a voxel location or a voxel block position).
+ *
+ * Each coordinate is offset so that it is non-negative and fits into 16 bits, and the bits of the three coordinates are then
+ * interleaved, giving a 48-bit code. Positions that are close to each other tend to have codes that are close to each other,
+ * and in particular, the positions in any aligned cube of side 2^k share all but the lowest 3k bits of their codes.
+ *
+ * \param pos The position.
+ * \return    The Morton code of the position.
+ */
+_CPU_AND_GPU_CODE_
+inline unsigned long long make_morton_code(const Vector3s& pos)
+{
+  const unsigned int x = static_cast<unsigned int>(pos.x + 32768);
+  const unsigned int y = static_cast<unsigned int>(pos.y + 32768);
+  const unsigned int z = static_cast<unsigned int>(pos.z + 32768);
+  return spread_bits_by_three(x) | (spread_bits_by_three(y) << 1) | (spread_bits_by_three(z) << 2);
+}
+
+}
+
+#endif
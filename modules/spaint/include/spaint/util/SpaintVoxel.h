@@ -50,6 +50,110 @@ struct SpaintVoxel
 
   //#################### NESTED TYPES ####################
 
+  /**
+   * \brief An instance of this struct accumulates the evidence for the semantic label of a voxel from a stream of predictions.
+   *
+   * Rather than letting each prediction overwrite the previous one, we keep running evidence for the two labels that have
+   * been predicted most often so far, in a Misra-Gries style: a prediction of either label adds a unit of evidence to it,
+   * and a prediction of any other label instead removes a unit from the runner-up (replacing it once it has none left).
+   * The evidence saturates at MAX_EVIDENCE, at which point both amounts are halved, so that the voxel can still change
+   * its label if the predictions change (e.g. once the forest has been retrained). Note that the whole record fits into
+   * 4 bytes, and that a zeroed record denotes a voxel for which no predictions have yet been made.
+   */
+  struct LabelEvidence
+  {
+    //~~~~~~~~~~~~~~~~~~~~ ENUMERATIONS ~~~~~~~~~~~~~~~~~~~~
+
+    enum
+    {
+      /** The maximum amount of evidence that can be accumulated for a label. */
+      MAX_EVIDENCE = 64
+    };
+
+    //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+    /** The amount of evidence for the best label. */
+    uchar evidence0;
+
+    /** The amount of evidence for the runner-up label. */
+    uchar evidence1;
+
+    /** The best label (the one with the most evidence). */
+    uchar label0;
+
+    /** The runner-up label. */
+    uchar label1;
+
+    //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
+
+    _CPU_AND_GPU_CODE_
+    LabelEvidence()
+    : evidence0(0), evidence1(0), label0(0), label1(0)
+    {}
+
+    //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+    /**
+     * \brief Adds the evidence provided by a prediction of the specified label.
+     *
+     * \param label The predicted label.
+     * \return      The best label once the evidence has been added.
+     */
+    _CPU_AND_GPU_CODE_
+    Label add(Label label)
+    {
+      if(evidence0 == 0 || label == label0)
+      {
+        label0 = label;
+        increment(evidence0);
+      }
+      else if(evidence1 == 0 || label == label1)
+      {
+        label1 = label;
+        increment(evidence1);
+        if(evidence1 > evidence0)
+        {
+          const uchar tempEvidence = evidence0; evidence0 = evidence1; evidence1 = tempEvidence;
+          const uchar tempLabel = label0; label0 = label1; label1 = tempLabel;
+        }
+      }
+      else --evidence1;
+
+      return label0;
+    }
+
+    /**
+     * \brief Gets the confidence with which the best label is supported by the evidence accumulated so far.
+     *
+     * \return The fraction of the evidence for the two labels that supports the best label (in [0,1], or 0 if there is no evidence).
+     */
+    _CPU_AND_GPU_CODE_
+    float confidence() const
+    {
+      const int totalEvidence = evidence0 + evidence1;
+      return totalEvidence > 0 ? static_cast<float>(evidence0) / totalEvidence : 0.0f;
+    }
+
+    //~~~~~~~~~~~~~~~~~~~~ PRIVATE MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+  private:
+    /**
+     * \brief Adds a unit of evidence to the specified amount, halving both amounts first if it has saturated.
+     *
+     * \param evidence The amount of evidence (either evidence0 or evidence1).
+     */
+    _CPU_AND_GPU_CODE_
+    void increment(uchar& evidence)
+    {
+      if(evidence >= MAX_EVIDENCE)
+      {
+        evidence0 = (evidence0 + 1) / 2;
+        evidence1 /= 2;
+      }
+
+      ++evidence;
+    }
+  };
+
   /**
    * \brief An instance of this struct represents the semantic label for a voxel.
    *
@@ -102,8 +206,10 @@ struct SpaintVoxel
   uchar w_color;
 #endif
 
-  /** Semantic label. */
+#ifndef USE_LABEL_VOLUME
+  /** Semantic label (when a separate label volume is in use, the labels are stored there instead). */
   PackedLabel packedLabel;
+#endif
 
   //#################### CONSTRUCTORS ####################
 
@@ -116,7 +222,9 @@ struct SpaintVoxel
     clr = Vector3u((uchar)0);
     w_color = 0;
 #endif
+#ifndef USE_LABEL_VOLUME
     packedLabel = PackedLabel(0, LG_USER);
+#endif
   }
 
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
@@ -126,6 +234,47 @@ struct SpaintVoxel
   _CPU_AND_GPU_CODE_ static short floatToValue(float x) { return (short)((x) * 32767.0f); }
 };
 
+//#################### LABEL ACCESS ####################
+
+/**
+ * \brief Gets the semantic label of the voxel at the specified address in the scene.
+ *
+ * If a separate label volume is in use, the label is stored in the label volume at the same address as the voxel;
+ * otherwise, it is stored in the voxel itself (in which case the label data is ignored and can be NULL).
+ *
+ * \param voxelAddress  The address of the voxel.
+ * \param voxelData     The scene's voxel data.
+ * \param labelData     The scene's label data (if any).
+ * \return              The semantic label of the voxel.
+ */
+_CPU_AND_GPU_CODE_
+inline SpaintVoxel::PackedLabel& get_voxel_label(int voxelAddress, SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData)
+{
+#ifdef USE_LABEL_VOLUME
+  return labelData[voxelAddress];
+#else
+  return voxelData[voxelAddress].packedLabel;
+#endif
+}
+
+/**
+ * \brief Gets the semantic label of the voxel at the specified address in the scene.
+ *
+ * \param voxelAddress  The address of the voxel.
+ * \param voxelData     The scene's voxel data.
+ * \param labelData     The scene's label data (if any).
+ * \return              The semantic label of the voxel.
+ */
+_CPU_AND_GPU_CODE_
+inline const SpaintVoxel::PackedLabel& get_voxel_label(int voxelAddress, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData)
+{
+#ifdef USE_LABEL_VOLUME
+  return labelData[voxelAddress];
+#else
+  return voxelData[voxelAddress].packedLabel;
+#endif
+}
+
 //#################### COLOUR READING ####################
 
 /**
@@ -6,15 +6,461 @@
 #ifndef H_SPAINT_SPAINTVOXELSCENE
 #define H_SPAINT_SPAINTVOXELSCENE
 
+#include <vector>
+
+#include <boost/optional.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <ITMLib/Objects/RenderStates/ITMRenderState.h>
 #include <ITMLib/Objects/Scene/ITMScene.h>
 
 #include "SpaintVoxel.h"
 
 namespace spaint {
 
-typedef ITMLib::ITMScene<SpaintVoxel,ITMVoxelIndex> SpaintVoxelScene;
+/**
+ * \brief An instance of this class represents a voxel scene in which the voxels can be semantically labelled.
+ *
+ * If spaint is built with USE_LABEL_VOLUME, the semantic labels of the voxels are not stored in the voxels themselves,
+ * but in a separate label volume that is indexed by the same voxel addresses as the voxel block array (and so shares
+ * the scene's hash table). This keeps the voxels used for fusion and raycasting small, and allows label-only passes
+ * (e.g. propagation, smoothing and clearing) to touch only one byte per voxel.
+ *
+ * The scene can also (optionally) maintain a label evidence volume, again indexed by voxel address, in which the labels
+ * predicted for each voxel by the random forest are accumulated (see SpaintVoxel::LabelEvidence). Forest predictions then
+ * relabel a voxel with the label that has the most accumulated evidence, rather than simply with the latest prediction,
+ * so that the labels stabilise after far fewer predictions, and later stages can read off how confident they are.
+ *
+ * The scene can also (optionally) record, for each entry in its hash table, whether or not the voxel block to which it
+ * refers is known to contain only empty space. This block occupancy is updated incrementally during fusion (see
+ * BlockOccupancyUpdater), and allows raycasts of the scene to skip empty space when computing their depth ranges.
+ *
+ * Unless swapping is in use, the scene also maintains a count of the voxels that carry each semantic label in each label group.
+ * These counts are updated atomically by the operations that change the labels (marking, propagation, smoothing and clearing),
+ * so that they are always available without having to scan the voxel blocks. Voxels with the default (background) label,
+ * which every voxel has when it is first allocated, are not counted.
+ *
+ * Unless swapping is in use, the scene also maintains, for each of its voxel blocks, a bitmask of the label values that the
+ * block's voxels may carry (other than the default label). The bits are set by the operations that relabel voxels, and the
+ * masks of the blocks visited by a label-clearing pass are then recomputed from the labels that remain, so each mask is always
+ * a superset of the labels actually present in its block. This allows clears to skip the blocks that cannot carry any of the
+ * labels being cleared, rather than touching every voxel in the scene.
+ *
+ * The scene also records which of its voxel blocks have had voxels relabelled by the voxel marker since they were last
+ * smoothed, so that 3D label smoothing (see VoxelLabelSmoother) can be run incrementally on just those blocks.
+ *
+ * More generally, the scene maintains a version counter, and records for each of its voxel blocks the versions at which
+ * the block's geometry and labels were last changed. Each operation that changes the scene advances the counter and then
+ * stamps the blocks it changes with the new version: label versions are stamped by the operations that relabel voxels
+ * (marking, propagation, smoothing and clearing), and geometry versions are stamped after fusion (see BlockVersionTracker,
+ * which can also find the blocks that have changed since a given version on the device). This allows caches of anything
+ * derived from the scene to be updated incrementally: a cache records the version at which it was last brought up to date,
+ * and then only needs to revisit the blocks whose versions are newer (or everything, if the scene has since been reset).
+ *
+ * Finally, a rectangular region of interest can be associated with one of the scene's render states, in which case the
+ * raycasts of the scene into that render state only compute depth ranges for (and hence only march rays through) the
+ * pixels in the region. This is used to limit the raycasts of an object scene to the segmented object's bounding box.
+ */
+class SpaintVoxelScene : public ITMLib::ITMScene<SpaintVoxel,ITMVoxelIndex>
+{
+  //#################### ENUMERATIONS ####################
+public:
+  enum
+  {
+    /** The number of label groups for which voxel counts are maintained. */
+    LABEL_GROUP_COUNT = SpaintVoxel::LG_USER + 1,
+
+    /** The number of distinct label values that can be stored in a packed label (and hence the number of voxel counts per group). */
+    LABEL_VALUE_COUNT = 64,
+
+    /** The number of 32-bit words in the label presence mask of each voxel block (one bit per label value). */
+    LABEL_PRESENCE_WORD_COUNT = LABEL_VALUE_COUNT / 32
+  };
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct records when a voxel block was last changed.
+   */
+  struct BlockVersions
+  {
+    /** The version of the scene at which the block's geometry (its SDF values, weights and colours) was last changed. */
+    unsigned int geometry;
+
+    /** The version of the scene at which the labels of any of the block's voxels were last changed. */
+    unsigned int labels;
+  };
+
+  /**
+   * \brief An instance of this struct records what was known about the occupancy of a voxel block when it was last examined.
+   */
+  struct BlockOccupancy
+  {
+    /** Whether or not every voxel in the block had an SDF value of 1 (i.e. the block lay at least mu in front of any surface). */
+    bool empty;
+
+    /** The position of the block (used to detect hash entries that have since been reused for a different block). */
+    Vector3s pos;
+  };
+
+  /**
+   * \brief An instance of this struct records how much of the scene's fixed-size storage is in use.
+   *
+   * Once either the voxel block array or the hash table's excess list is exhausted, any further blocks that need to be
+   * allocated are silently dropped, so these figures indicate how close the scene is to being unable to grow.
+   */
+  struct Occupancy
+  {
+    /** The number of voxel blocks that are allocated in the local voxel block array. */
+    int allocatedBlockCount;
+
+    /** The capacity (in voxel blocks) of the local voxel block array. */
+    int blockCapacity;
+
+    /** The capacity (in entries) of the hash table's excess list. */
+    int excessEntryCapacity;
+
+    /** The number of entries in the hash table's excess list that are in use (one for each block whose bucket was already full). */
+    int usedExcessEntryCount;
+
+    //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+    /**
+     * \brief Gets the fraction of the local voxel block array that is in use.
+     *
+     * \return The fraction of the local voxel block array that is in use (in [0,1]).
+     */
+    float block_fraction() const
+    {
+      return blockCapacity > 0 ? static_cast<float>(allocatedBlockCount) / blockCapacity : 0.0f;
+    }
+
+    /**
+     * \brief Gets the fraction of the hash table's excess list that is in use.
+     *
+     * \return The fraction of the hash table's excess list that is in use (in [0,1]).
+     */
+    float excess_fraction() const
+    {
+      return excessEntryCapacity > 0 ? static_cast<float>(usedExcessEntryCount) / excessEntryCapacity : 0.0f;
+    }
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The block occupancy (if any), with one record for each entry in the scene's hash table. */
+  boost::shared_ptr<ORUtils::MemoryBlock<BlockOccupancy> > m_blockOccupancyMB;
+
+  /** The versions at which the voxel blocks were last changed, with one record for each block in the voxel block array. */
+  boost::shared_ptr<ORUtils::MemoryBlock<BlockVersions> > m_blockVersionsMB;
+
+  /** The voxel counts for each label (if any), with LABEL_VALUE_COUNT counts for each label group (see get_label_count_data). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_labelCountsMB;
+
+  /** The label evidence volume (if any), with one record for each voxel in the voxel block array. */
+  boost::shared_ptr<ORUtils::MemoryBlock<SpaintVoxel::LabelEvidence> > m_labelEvidenceMB;
+
+  /** The label presence masks (if any), with LABEL_PRESENCE_WORD_COUNT words for each block in the voxel block array (see get_label_presence_data). */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_labelPresenceMB;
+
+  /** A flag for each voxel block in the voxel block array, indicating whether or not the marker has relabelled any of its voxels since it was last smoothed. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned char> > m_relabelledBlockFlagsMB;
+
+  /** The label volume (if any), with one label for each voxel in the voxel block array. */
+  boost::shared_ptr<ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> > m_labelsMB;
+
+  /** The type of memory in which the scene is stored. */
+  MemoryDeviceType m_memoryType;
+
+  /** The region (if any) of the raycast result image, in the form (minX,minY,maxX,maxY), to which raycasts into m_raycastRegionRenderState are limited. */
+  boost::optional<Vector4i> m_raycastRegion;
+
+  /** The render state (if any) with which m_raycastRegion is associated. */
+  const ITMLib::ITMRenderState *m_raycastRegionRenderState;
+
+  /** The version of the scene at which it was last reset. */
+  unsigned int m_resetVersion;
+
+  /** The current version of the scene (the version with which the blocks changed by the most recent operation were stamped). */
+  unsigned int m_version;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a voxel scene.
+   *
+   * Note: The labels in the label volume (if any) are not initialised. They are cleared whenever the scene is reset.
+   *
+   * \param sceneParams       The scene parameters.
+   * \param useSwapping       Whether or not to use swapping.
+   * \param memoryType        The type of memory in which to store the scene.
+   * \param useBlockOccupancy Whether or not to record the occupancy of the scene's voxel blocks.
+   * \param useLabelEvidence  Whether or not to accumulate the evidence for the labels predicted for the voxels in a label evidence volume.
+   * \throws std::runtime_error If swapping is requested when a separate label volume or a label evidence volume is in use (neither is swapped).
+   */
+  SpaintVoxelScene(const ITMLib::ITMSceneParams *sceneParams, bool useSwapping, MemoryDeviceType memoryType, bool useBlockOccupancy = false,
+                   bool useLabelEvidence = false);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds a set of deltas to the scene's voxel counts for each label (if any).
+   *
+   * This is used by operations that change the labels of voxels on the host without going through the voxel marker
+   * (e.g. loading voxel blocks from an archive). The deltas are added modulo 2^32, so decrements can be expressed
+   * by wrapping around.
+   *
+   * \param deltas  The deltas, laid out in the same way as the counts (see get_label_count_data).
+   */
+  void add_to_label_counts(const std::vector<unsigned int>& deltas);
+
+  /**
+   * \brief Advances the scene's version counter.
+   *
+   * This must be called by each operation that changes the scene before it starts to do so. The operation should then
+   * stamp every voxel block it changes with the returned version.
+   *
+   * \return The new version of the scene.
+   */
+  unsigned int advance_version();
+
+  /**
+   * \brief Gets the scene's block occupancy data (if any).
+   *
+   * As with the voxel blocks, the block occupancy data is stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's block occupancy data, if block occupancy is being recorded, or NULL otherwise.
+   */
+  BlockOccupancy *get_block_occupancy_data();
+
+  /**
+   * \brief Gets the scene's block occupancy data (if any).
+   *
+   * As with the voxel blocks, the block occupancy data is stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's block occupancy data, if block occupancy is being recorded, or NULL otherwise.
+   */
+  const BlockOccupancy *get_block_occupancy_data() const;
+
+  /**
+   * \brief Gets the versions at which the scene's voxel blocks were last changed.
+   *
+   * There is one record for each block in the voxel block array (indexed by the ptr of the hash entry that refers to the block).
+   * As with the voxel blocks, the records are stored in the type of memory in which the scene is stored.
+   *
+   * \return  The versions at which the scene's voxel blocks were last changed.
+   */
+  BlockVersions *get_block_versions();
+
+  /**
+   * \brief Gets the versions at which the scene's voxel blocks were last changed.
+   *
+   * There is one record for each block in the voxel block array (indexed by the ptr of the hash entry that refers to the block).
+   * As with the voxel blocks, the records are stored in the type of memory in which the scene is stored.
+   *
+   * \return  The versions at which the scene's voxel blocks were last changed.
+   */
+  const BlockVersions *get_block_versions() const;
+
+  /**
+   * \brief Gets the scene's voxel counts for each label (if any).
+   *
+   * The count for a label is stored at index group * LABEL_VALUE_COUNT + label. As with the voxel blocks, the counts
+   * are stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's voxel counts for each label, if they are being maintained, or NULL otherwise.
+   */
+  unsigned int *get_label_count_data();
+
+  /**
+   * \brief Gets the scene's voxel counts for each label (if any).
+   *
+   * The count for a label is stored at index group * LABEL_VALUE_COUNT + label. As with the voxel blocks, the counts
+   * are stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's voxel counts for each label, if they are being maintained, or NULL otherwise.
+   */
+  const unsigned int *get_label_count_data() const;
+
+  /**
+   * \brief Gets the numbers of voxels in the scene that carry each label in the specified group.
+   *
+   * This copies the counts across from the device if necessary, so it should be called sparingly (e.g. once per frame).
+   *
+   * \param group  The label group.
+   * \return       A vector containing the number of voxels that carry each label in the group (indexed by label),
+   *               or an empty vector if the label counts are not being maintained.
+   */
+  std::vector<unsigned int> get_label_counts(SpaintVoxel::LabelGroup group) const;
+
+  /**
+   * \brief Gets the scene's label data (if any).
+   *
+   * As with the voxel blocks, the label data is stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's label data, if a separate label volume is in use, or NULL otherwise.
+   */
+  SpaintVoxel::PackedLabel *get_label_data();
+
+  /**
+   * \brief Gets the scene's label data (if any).
+   *
+   * As with the voxel blocks, the label data is stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's label data, if a separate label volume is in use, or NULL otherwise.
+   */
+  const SpaintVoxel::PackedLabel *get_label_data() const;
+
+  /**
+   * \brief Gets the scene's label evidence data (if any).
+   *
+   * As with the voxel blocks, the label evidence data is stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's label evidence data, if a label evidence volume is in use, or NULL otherwise.
+   */
+  SpaintVoxel::LabelEvidence *get_label_evidence_data();
+
+  /**
+   * \brief Gets the scene's label evidence data (if any).
+   *
+   * As with the voxel blocks, the label evidence data is stored in the type of memory in which the scene is stored.
+   *
+   * \return  The scene's label evidence data, if a label evidence volume is in use, or NULL otherwise.
+   */
+  const SpaintVoxel::LabelEvidence *get_label_evidence_data() const;
+
+  /**
+   * \brief Gets the scene's label presence masks (if any).
+   *
+   * The mask for the block in the voxel block array with index ptr occupies the LABEL_PRESENCE_WORD_COUNT words starting at
+   * index ptr * LABEL_PRESENCE_WORD_COUNT, and bit (label % 32) of its (label / 32)th word is set if any of the block's voxels
+   * may carry a non-default label with that value. As with the voxel blocks, the masks are stored in the type of memory in
+   * which the scene is stored.
+   *
+   * \return  The scene's label presence masks, if they are being maintained, or NULL otherwise.
+   */
+  unsigned int *get_label_presence_data();
+
+  /**
+   * \brief Gets the scene's label presence masks (if any).
+   *
+   * The mask for the block in the voxel block array with index ptr occupies the LABEL_PRESENCE_WORD_COUNT words starting at
+   * index ptr * LABEL_PRESENCE_WORD_COUNT, and bit (label % 32) of its (label / 32)th word is set if any of the block's voxels
+   * may carry a non-default label with that value. As with the voxel blocks, the masks are stored in the type of memory in
+   * which the scene is stored.
+   *
+   * \return  The scene's label presence masks, if they are being maintained, or NULL otherwise.
+   */
+  const unsigned int *get_label_presence_data() const;
+
+  /**
+   * \brief Gets how much of the scene's fixed-size storage is in use.
+   *
+   * This is cheap to call (it only reads counters that are maintained on the host), so it can be called every frame.
+   *
+   * \return How much of the scene's fixed-size storage is in use.
+   */
+  Occupancy get_occupancy() const;
+
+  /**
+   * \brief Gets the region (if any) to which raycasts of the scene into the specified render state are limited.
+   *
+   * \param renderState The render state.
+   * \return            The region (if any), in the form (minX,minY,maxX,maxY), to which raycasts of the scene into the render state are limited,
+   *                    or boost::none if the raycasts are unrestricted.
+   */
+  boost::optional<Vector4i> get_raycast_region(const ITMLib::ITMRenderState *renderState) const;
+
+  /**
+   * \brief Gets the flags indicating which of the scene's voxel blocks have had voxels relabelled since they were last smoothed.
+   *
+   * There is one flag for each block in the voxel block array (indexed by the ptr of the hash entry that refers to the block).
+   * As with the voxel blocks, the flags are stored in the type of memory in which the scene is stored.
+   *
+   * \return  The relabelled block flags.
+   */
+  unsigned char *get_relabelled_block_flags();
+
+  /**
+   * \brief Gets the flags indicating which of the scene's voxel blocks have had voxels relabelled since they were last smoothed.
+   *
+   * There is one flag for each block in the voxel block array (indexed by the ptr of the hash entry that refers to the block).
+   * As with the voxel blocks, the flags are stored in the type of memory in which the scene is stored.
+   *
+   * \return  The relabelled block flags.
+   */
+  const unsigned char *get_relabelled_block_flags() const;
+
+  /**
+   * \brief Gets the version of the scene at which it was last reset.
+   *
+   * Any cache that was last brought up to date at an earlier version must be rebuilt from scratch, since the blocks it
+   * was derived from may no longer exist.
+   *
+   * \return The version of the scene at which it was last reset (0 if it has never been reset).
+   */
+  unsigned int get_reset_version() const;
+
+  /**
+   * \brief Gets the current version of the scene.
+   *
+   * \return The current version of the scene (0 if it has not yet been changed).
+   */
+  unsigned int get_version() const;
+
+  /**
+   * \brief Forgets everything that is known about the occupancy of the scene's voxel blocks (if block occupancy is being recorded).
+   *
+   * This must be called whenever the voxel blocks are changed other than by fusion (e.g. when the scene is reset).
+   * Until they are next fused, the voxel blocks will then conservatively be assumed to be occupied.
+   */
+  void reset_block_occupancy();
+
+  /**
+   * \brief Records that the scene has been reset, and forgets the versions at which its voxel blocks were last changed.
+   *
+   * This must be called whenever all of the voxel blocks are deallocated (e.g. when the scene is reset).
+   */
+  void reset_block_versions();
+
+  /**
+   * \brief Resets the scene's voxel counts for each label to zero (if they are being maintained).
+   *
+   * This must be called whenever the labels of all of the voxels are reset other than by clearing them (e.g. when the scene is reset).
+   */
+  void reset_label_counts();
+
+  /**
+   * \brief Forgets all of the evidence accumulated for the labels of the voxels (if a label evidence volume is in use).
+   *
+   * This must be called whenever the labels of all of the voxels are reset other than by clearing them (e.g. when the scene is reset).
+   */
+  void reset_label_evidence();
+
+  /**
+   * \brief Forgets which labels are present in each of the scene's voxel blocks (if the label presence masks are being maintained).
+   *
+   * This sets every bit of every mask, so that the next label-clearing pass visits every block and recomputes the masks.
+   * It must be called whenever the labels of voxels are changed other than by operations that maintain the masks (e.g. when
+   * the scene is reset, or when voxel blocks are loaded from an archive).
+   */
+  void reset_label_presence();
+
+  /**
+   * \brief Sets the region (if any) to which raycasts of the scene into the specified render state are limited.
+   *
+   * Only one render state can have a region at a time, so setting a region replaces any region associated with another
+   * render state. Pixels outside the region are treated as having an empty depth range, so no points are found for them.
+   *
+   * \param renderState The render state.
+   * \param region      The region (if any) of the raycast result image, in the form (minX,minY,maxX,maxY), with inclusive bounds,
+   *                    or boost::none to remove any restriction.
+   */
+  void set_raycast_region(const ITMLib::ITMRenderState *renderState, const boost::optional<Vector4i>& region);
+};
+
+//#################### TYPEDEFS ####################
+
 typedef boost::shared_ptr<SpaintVoxelScene> SpaintVoxelScene_Ptr;
 typedef boost::shared_ptr<const SpaintVoxelScene> SpaintVoxelScene_CPtr;
 
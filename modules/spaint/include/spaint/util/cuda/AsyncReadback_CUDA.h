@@ -0,0 +1,186 @@
+/**
+ * spaint: AsyncReadback_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_ASYNCREADBACK_CUDA
+#define H_SPAINT_ASYNCREADBACK_CUDA
+
+#include <stdexcept>
+
+#include <cuda_runtime_api.h>
+
+#include <ORUtils/CUDADefines.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of an instantiation of this class template can be used to read small amounts of data (e.g. a pick point)
+ *        back from the GPU each frame without ever making the host wait for the GPU.
+ *
+ * Each call to request starts an asynchronous copy of the data into one of two pinned host buffers and records an event after it.
+ * Rather than waiting for the copy to finish, the host then calls poll, which checks (without blocking) whether any of the copies
+ * in flight have finished, and makes the data from the most recent finished copy available via latest. One buffer always holds
+ * the latest data whilst the other is being copied into, so in a typical per-frame loop the data seen on the host lags one frame
+ * behind the data on the GPU. This is only suitable for data whose consumers can tolerate that latency (e.g. UI feedback).
+ *
+ * If a request is made whilst the previous copy is still in flight, it is dropped rather than waited for (the next request will
+ * make up for it). The copies are issued on the specified stream, so they are ordered after the work that produces their data.
+ */
+template <typename T>
+class AsyncReadback_CUDA
+{
+  //#################### CONSTANTS ####################
+private:
+  /** The number of host buffers (one for the latest data, and one to copy into). */
+  static const int BUFFER_COUNT = 2;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The maximum number of elements that can be read back at once. */
+  size_t m_capacity;
+
+  /** The numbers of elements copied into each of the host buffers. */
+  size_t m_counts[BUFFER_COUNT];
+
+  /** The events recorded after the copies into each of the host buffers were issued. */
+  cudaEvent_t m_events[BUFFER_COUNT];
+
+  /** The (pinned) host buffers. */
+  T *m_hostBuffers[BUFFER_COUNT];
+
+  /** Whether or not a copy into each of the host buffers is in flight. */
+  bool m_inFlight[BUFFER_COUNT];
+
+  /** The index of the host buffer that contains the latest data (or -1, if no copy has finished yet). */
+  int m_latestBuffer;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an asynchronous readback.
+   *
+   * \param capacity  The maximum number of elements that can be read back at once.
+   */
+  explicit AsyncReadback_CUDA(size_t capacity = 1)
+  : m_capacity(capacity), m_latestBuffer(-1)
+  {
+    for(int i = 0; i < BUFFER_COUNT; ++i)
+    {
+      ORcudaSafeCall(cudaMallocHost(reinterpret_cast<void**>(&m_hostBuffers[i]), capacity * sizeof(T)));
+      ORcudaSafeCall(cudaEventCreateWithFlags(&m_events[i], cudaEventDisableTiming));
+      m_counts[i] = 0;
+      m_inFlight[i] = false;
+    }
+  }
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the asynchronous readback.
+   */
+  ~AsyncReadback_CUDA()
+  {
+    for(int i = 0; i < BUFFER_COUNT; ++i)
+    {
+      // Note: A pinned buffer must not be freed whilst a copy into it is still in flight.
+      if(m_inFlight[i]) cudaEventSynchronize(m_events[i]);
+      cudaEventDestroy(m_events[i]);
+      cudaFreeHost(m_hostBuffers[i]);
+    }
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  AsyncReadback_CUDA(const AsyncReadback_CUDA&);
+  AsyncReadback_CUDA& operator=(const AsyncReadback_CUDA&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets whether or not any data has been read back yet.
+   *
+   * \return  true, if any data has been read back yet, or false otherwise.
+   */
+  bool has_latest() const
+  {
+    return m_latestBuffer != -1;
+  }
+
+  /**
+   * \brief Gets the data from the most recent copy to have finished (as of the last call to poll).
+   *
+   * The data remain valid until the next call to poll.
+   *
+   * \return                    The data from the most recent copy to have finished.
+   * \throws std::runtime_error If no data has been read back yet.
+   */
+  const T *latest() const
+  {
+    if(m_latestBuffer == -1) throw std::runtime_error("Error: No data has been read back from the GPU yet");
+    return m_hostBuffers[m_latestBuffer];
+  }
+
+  /**
+   * \brief Gets the number of elements in the data from the most recent copy to have finished (as of the last call to poll).
+   *
+   * \return  The number of elements in the data from the most recent copy to have finished (0, if no data has been read back yet).
+   */
+  size_t latest_count() const
+  {
+    return m_latestBuffer != -1 ? m_counts[m_latestBuffer] : 0;
+  }
+
+  /**
+   * \brief Checks, without blocking, whether or not the copy in flight (if any) has finished, and if so makes its data the latest data.
+   *
+   * \return  true, if new data became available, or false otherwise.
+   */
+  bool poll()
+  {
+    for(int i = 0; i < BUFFER_COUNT; ++i)
+    {
+      if(!m_inFlight[i]) continue;
+
+      const cudaError_t status = cudaEventQuery(m_events[i]);
+      if(status == cudaErrorNotReady) continue;
+      ORcudaSafeCall(status);
+
+      // Since at most one copy is ever in flight, the one that has just finished must be the most recent.
+      m_inFlight[i] = false;
+      m_latestBuffer = i;
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * \brief Starts copying the specified data from the device to the host, without waiting for the copy to finish.
+   *
+   * \param deviceData              The data to copy (on the device).
+   * \param count                   The number of elements to copy.
+   * \param stream                  The stream on which to issue the copy.
+   * \return                        true, if the copy was started, or false if it was dropped because the previous copy is still in flight.
+   * \throws std::invalid_argument  If count exceeds the capacity of the readback.
+   */
+  bool request(const T *deviceData, size_t count, cudaStream_t stream = 0)
+  {
+    if(count > m_capacity) throw std::invalid_argument("Error: Cannot read back more elements than the capacity of the readback");
+
+    // Copy into whichever buffer does not contain the latest data, provided that it is not still being copied into.
+    const int buffer = m_latestBuffer == 0 ? 1 : 0;
+    if(m_inFlight[buffer] || m_inFlight[1 - buffer]) return false;
+
+    ORcudaSafeCall(cudaMemcpyAsync(m_hostBuffers[buffer], deviceData, count * sizeof(T), cudaMemcpyDeviceToHost, stream));
+    ORcudaSafeCall(cudaEventRecord(m_events[buffer], stream));
+    m_counts[buffer] = count;
+    m_inFlight[buffer] = true;
+    return true;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * spaint: ComponentStream_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_COMPONENTSTREAM_CUDA
+#define H_SPAINT_COMPONENTSTREAM_CUDA
+
+#include <cuda_runtime_api.h>
+
+#include <ORUtils/MemoryBlock.h>
+#include <ORUtils/CUDADefines.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class provides a pipeline component with a CUDA stream of its own, on which to do its work.
+ *
+ * The stream is a non-blocking one, so the work issued on it is not implicitly ordered with respect to the work on the
+ * default stream. Instead, the dependencies between the two are made explicit using events: begin_work makes the stream
+ * wait for the work that has already been issued on the default stream (e.g. the raycast that produced the component's
+ * inputs), and end_work makes the default stream wait for the work that has been issued on the stream (e.g. writing the
+ * voxel labels), so that it is safe for work issued on the default stream thereafter to consume the component's outputs.
+ * Whilst the component's work is in flight, other work issued on other streams (e.g. uploading the next input images,
+ * or snapshotting the labels) can overlap with it on the GPU.
+ *
+ * Values that the component needs to read back on the host are copied using copy_to_host, which only waits for the work
+ * on the component's own stream, rather than (as UpdateHostFromDevice does) implicitly synchronising with the default stream.
+ */
+class ComponentStream_CUDA
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** An event recorded on the default stream when the component starts some work. */
+  cudaEvent_t m_inputsReadyEvent;
+
+  /** An event recorded on the component's stream when the component finishes some work. */
+  cudaEvent_t m_outputsReadyEvent;
+
+  /** The component's stream. */
+  cudaStream_t m_stream;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a component stream.
+   */
+  ComponentStream_CUDA();
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the component stream.
+   */
+  ~ComponentStream_CUDA();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ComponentStream_CUDA(const ComponentStream_CUDA&);
+  ComponentStream_CUDA& operator=(const ComponentStream_CUDA&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes the component's stream wait for all of the work that has already been issued on the default stream.
+   *
+   * This should be called before the component issues any work that reads inputs produced on the default stream.
+   */
+  void begin_work() const;
+
+  /**
+   * \brief Copies the contents of a memory block from the device to the host, ordered with respect to the work on the component's stream.
+   *
+   * This blocks until the copy (and any earlier work on the component's stream) has finished.
+   *
+   * \param mb      The memory block (its host memory must be pinned, as it is for memory blocks that are allocated on both the CPU and the GPU).
+   * \param count   The number of elements to copy.
+   */
+  template <typename T>
+  void copy_to_host(ORUtils::MemoryBlock<T>& mb, size_t count) const
+  {
+    ORcudaSafeCall(cudaMemcpyAsync(mb.GetData(MEMORYDEVICE_CPU), mb.GetData(MEMORYDEVICE_CUDA), count * sizeof(T), cudaMemcpyDeviceToHost, m_stream));
+    ORcudaSafeCall(cudaStreamSynchronize(m_stream));
+  }
+
+  /**
+   * \brief Makes the default stream wait for all of the work that has been issued on the component's stream.
+   *
+   * This should be called once the component has issued all of the work that writes outputs consumed on the default stream.
+   */
+  void end_work() const;
+
+  /**
+   * \brief Gets the component's stream.
+   *
+   * \return  The component's stream.
+   */
+  cudaStream_t get() const;
+};
+
+}
+
+#endif
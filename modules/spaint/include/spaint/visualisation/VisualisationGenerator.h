@@ -15,7 +15,9 @@
 #include <itmx/base/ITMImagePtrTypes.h>
 #include <itmx/base/ITMObjectPtrTypes.h>
 
+#include "interface/MultiOutputVisualiser.h"
 #include "interface/SemanticVisualiser.h"
+#include "interface/StereoRaycaster.h"
 #include "../util/SpaintSurfelScene.h"
 
 namespace spaint {
@@ -57,12 +59,18 @@ private:
   /** The label manager. */
   LabelManager_CPtr m_labelManager;
 
+  /** The visualiser used to render several outputs of a voxel scene raycast in a single pass. */
+  MultiOutputVisualiser_CPtr m_multiOutputVisualiser;
+
   /** The semantic visualiser. */
   SemanticVisualiser_CPtr m_semanticVisualiser;
 
   /** The settings to use for InfiniTAM. */
   Settings_CPtr m_settings;
 
+  /** The raycaster used to raycast a voxel scene from both eyes of a stereo camera in a single pass. */
+  StereoRaycaster_CPtr m_stereoRaycaster;
+
   /** The InfiniTAM engine used for rendering a surfel scene. */
   SurfelVisualisationEngine_CPtr m_surfelVisualisationEngine;
 
@@ -84,6 +92,17 @@ public:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Expands a compact semantic visualisation (see shade_voxel_raycast_compact) into a colour image on the CPU, using the current label colours.
+   *
+   * This is useful when a compact semantic visualisation has been sent somewhere that can do the colour lookup itself (e.g. to an OpenGL texture),
+   * but a colour copy of it is also occasionally required (e.g. for a screenshot).
+   *
+   * \param input   The compact semantic visualisation (this must be up-to-date on the CPU).
+   * \param output  The location into which to put the colour image (this is resized to match the input, and is only up-to-date on the CPU).
+   */
+  void expand_compact_semantic_image(const ITMUShortImage_CPtr& input, const ITMUChar4Image_Ptr& output) const;
+
   /**
    * \brief Generates a visualisation of a surfel scene from the specified pose.
    *
@@ -93,13 +112,17 @@ public:
    * \param view              The current view of the scene.
    * \param renderState       The render state to use for intermediate storage.
    * \param visualisationType The type of visualisation to generate.
+   * \param copyToHost        Whether or not to make the output image accessible on the CPU (if false, in CUDA mode it is only guaranteed to be up-to-date on the GPU).
    */
   void generate_surfel_visualisation(const ITMUChar4Image_Ptr& output, const SpaintSurfelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
-                                     const View_CPtr& view, SurfelRenderState_Ptr& renderState, VisualisationType visualisationType) const;
+                                     const View_CPtr& view, SurfelRenderState_Ptr& renderState, VisualisationType visualisationType,
+                                     bool copyToHost = true) const;
 
   /**
    * \brief Generates a visualisation of a voxel scene from the specified pose.
    *
+   * This raycasts the scene (see raycast_voxel_scene) and then shades the raycast (see shade_voxel_raycast).
+   *
    * \param output            The location into which to put the output image.
    * \param scene             The scene to visualise.
    * \param pose              The pose from which to visualise the scene.
@@ -107,10 +130,11 @@ public:
    * \param renderState       The render state to use for intermediate storage.
    * \param visualisationType The type of visualisation to generate.
    * \param postprocessor     An optional function with which to postprocess the visualisation before returning it.
+   * \param copyToHost        Whether or not to make the output image accessible on the CPU (if false, in CUDA mode it is only guaranteed to be up-to-date on the GPU).
    */
   void generate_voxel_visualisation(const ITMUChar4Image_Ptr& output, const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
                                     const View_CPtr& view, VoxelRenderState_Ptr& renderState, VisualisationType visualisationType,
-                                    const boost::optional<Postprocessor>& postprocessor = boost::none) const;
+                                    const boost::optional<Postprocessor>& postprocessor = boost::none, bool copyToHost = true) const;
 
   /**
    * \brief Gets a Lambertian raycast of a voxel scene from the default pose (the current camera pose).
@@ -137,16 +161,117 @@ public:
    */
   void get_rgb_input(const ITMUChar4Image_Ptr& output, const View_CPtr& view) const;
 
+  /**
+   * \brief Raycasts a voxel scene from the specified pose, storing the surface points found in the raycastResult of the specified render state.
+   *
+   * The scene is raycast at the resolution of the render state. If the render state is smaller than the current depth image,
+   * the intrinsics of the depth camera are scaled accordingly (this can be used to render the scene at a reduced resolution).
+   *
+   * If a raycast of the same scene from the same pose (with the same intrinsics and image size) has already been computed
+   * during the current frame (e.g. for another sub-window, or to prepare for tracking), it can be passed in to avoid
+   * ray marching the scene again: its surface points will then simply be copied into the render state.
+   *
+   * \param scene         The scene to raycast.
+   * \param pose          The pose from which to raycast the scene.
+   * \param view          The current view of the scene.
+   * \param renderState   The render state into which to raycast the scene (created if it is NULL).
+   * \param cachedRaycast A render state (if any) containing an up-to-date raycast of the scene from the same pose.
+   */
+  void raycast_voxel_scene(const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose, const View_CPtr& view,
+                           VoxelRenderState_Ptr& renderState, const VoxelRenderState_CPtr& cachedRaycast = VoxelRenderState_CPtr()) const;
+
+  /**
+   * \brief Raycasts a voxel scene from both eyes of a stereo camera in a single pass, storing the surface points found for each eye in the raycastResult of its render state.
+   *
+   * \param scene             The scene to raycast.
+   * \param leftPose          The pose of the left eye.
+   * \param rightPose         The pose of the right eye.
+   * \param view              The current view of the scene.
+   * \param leftRenderState   The render state into which to raycast the scene for the left eye (created if it is NULL).
+   * \param rightRenderState  The render state into which to raycast the scene for the right eye (created if it is NULL).
+   * \throws std::invalid_argument If the two render states are of different sizes.
+   */
+  void raycast_voxel_scene_stereo(const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& leftPose, const ORUtils::SE3Pose& rightPose, const View_CPtr& view,
+                                  VoxelRenderState_Ptr& leftRenderState, VoxelRenderState_Ptr& rightRenderState) const;
+
+  /**
+   * \brief Generates a visualisation of a voxel scene by shading an existing raycast of it, without ray marching the scene again.
+   *
+   * \param output            The location into which to put the output image.
+   * \param scene             The scene to visualise.
+   * \param pose              The pose from which the scene was raycast.
+   * \param view              The current view of the scene.
+   * \param renderState       The render state containing the raycast (see raycast_voxel_scene).
+   * \param visualisationType The type of visualisation to generate.
+   * \param postprocessor     An optional function with which to postprocess the visualisation before returning it.
+   * \param copyToHost        Whether or not to make the output image accessible on the CPU (if false, in CUDA mode it is only guaranteed to be up-to-date on the GPU).
+   */
+  void shade_voxel_raycast(const ITMUChar4Image_Ptr& output, const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
+                           const View_CPtr& view, const VoxelRenderState_Ptr& renderState, VisualisationType visualisationType,
+                           const boost::optional<Postprocessor>& postprocessor = boost::none, bool copyToHost = true) const;
+
+  /**
+   * \brief Generates a compact semantic visualisation of a voxel scene by shading an existing raycast of it, without ray marching the scene again.
+   *
+   * Each pixel of the output contains the semantic label of the voxel hit by its ray and the shading intensity, rather than a colour
+   * (see SemanticVisualiser::render_compact), so the label colours must be applied by whatever consumes it. Only those semantic
+   * visualisation types that do not blend the label colours with the scene colours are supported (see supports_compact_semantic_visualisation).
+   *
+   * \param output            The location into which to put the output image.
+   * \param scene             The scene to visualise.
+   * \param pose              The pose from which the scene was raycast.
+   * \param renderState       The render state containing the raycast (see raycast_voxel_scene).
+   * \param visualisationType The type of semantic visualisation to generate.
+   * \param copyToHost        Whether or not to make the output image accessible on the CPU (if false, in CUDA mode it is only guaranteed to be up-to-date on the GPU).
+   * \throws std::invalid_argument If the visualisation type does not support compact semantic visualisation.
+   */
+  void shade_voxel_raycast_compact(const ITMUShortImage_Ptr& output, const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
+                                   const VoxelRenderState_CPtr& renderState, VisualisationType visualisationType, bool copyToHost = true) const;
+
+  /**
+   * \brief Renders several outputs of an existing raycast of a voxel scene (e.g. a semantic visualisation, a depth image and
+   *        a normal map) in a single pass, without ray marching the scene again.
+   *
+   * This is cheaper than calling shade_voxel_raycast (or a depth visualiser) once for each output, since each voxel
+   * hit by the raycast is only looked up once.
+   *
+   * \param scene             The scene to visualise.
+   * \param pose              The pose from which the scene was raycast.
+   * \param renderState       The render state containing the raycast (see raycast_voxel_scene).
+   * \param outputs           The outputs to render (any that are NULL will not be rendered).
+   * \param semanticType      The type of semantic visualisation to render into the semantic colour output (must be one of the VT_SCENE_SEMANTIC* types).
+   * \param depthType         The type of depth calculation to use for the depth output.
+   * \param invalidDepthValue The depth value to use for pixels whose rays do not intersect the scene.
+   * \param copyToHost        Whether or not to make the outputs accessible on the CPU (if false, in CUDA mode they are only guaranteed to be up-to-date on the GPU).
+   * \throws std::invalid_argument If semanticType is not a semantic visualisation type.
+   */
+  void shade_voxel_raycast_outputs(const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose, const VoxelRenderState_CPtr& renderState,
+                                   const MultiOutputVisualiser::Outputs& outputs, VisualisationType semanticType = VT_SCENE_SEMANTICLAMBERTIAN,
+                                   DepthVisualiser::DepthType depthType = DepthVisualiser::DT_ORTHOGRAPHIC, float invalidDepthValue = -1.0f,
+                                   bool copyToHost = true) const;
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Determines whether or not the specified type of visualisation can be generated as a compact semantic visualisation.
+   *
+   * \param visualisationType The type of visualisation.
+   * \return                  true, if the visualisation type is a semantic one that only uses the label colours (not the scene colours), or false otherwise.
+   */
+  static bool supports_compact_semantic_visualisation(VisualisationType visualisationType);
+
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /**
-   * \brief Makes a copy of an input raycast, optionally post-processes it and then ensures that it is accessible on the CPU.
+   * \brief Makes a copy of an input raycast, optionally post-processes it and then (if requested) ensures that it is accessible on the CPU.
    *
    * \param inputRaycast  The input raycast.
-   * \param postprocessor An optional function with which to postprocess the output raycast.
-   * \param outputRaycast The output raycast (guaranteed to be accessible on the CPU).
+   * \param postprocessor An optional function with which to postprocess the input raycast into the output raycast.
+   * \param outputRaycast The output raycast (accessible on the CPU if copyToHost is true, and on the device on which the input raycast resides otherwise).
+   * \param copyToHost    Whether or not to make the output raycast accessible on the CPU.
    */
-  void make_postprocessed_cpu_copy(const ITMUChar4Image *inputRaycast, const boost::optional<Postprocessor>& postprocessor, const ITMUChar4Image_Ptr& outputRaycast) const;
+  void make_postprocessed_copy(const ITMUChar4Image *inputRaycast, const boost::optional<Postprocessor>& postprocessor,
+                               const ITMUChar4Image_Ptr& outputRaycast, bool copyToHost = true) const;
 
   /**
    * \brief Prepares to copy a visualisation image into the specified output image.
@@ -155,6 +280,26 @@ private:
    * \param output  The output image to which the visualisation image will be copied.
    */
   void prepare_to_copy_visualisation(const Vector2i& inputSize, const ITMUChar4Image_Ptr& output) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets the intrinsics with which to raycast a scene into the specified render state.
+   *
+   * \param view        The current view of the scene.
+   * \param renderState The render state.
+   * \return            The intrinsics of the depth camera, scaled to the resolution of the render state.
+   */
+  static ITMLib::ITMIntrinsics get_raycast_intrinsics(const View_CPtr& view, const ITMLib::ITMRenderState *renderState);
+
+  /**
+   * \brief Gets the lighting type and label alpha with which to render the specified type of semantic visualisation.
+   *
+   * \param visualisationType  The type of semantic visualisation (one of the VT_SCENE_SEMANTIC* types).
+   * \param lightingType       A location into which to write the lighting type.
+   * \param labelAlpha         A location into which to write the label alpha.
+   */
+  static void get_semantic_shading(VisualisationType visualisationType, LightingType& lightingType, float& labelAlpha);
 };
 
 //#################### TYPEDEFS ####################
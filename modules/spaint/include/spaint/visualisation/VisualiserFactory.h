@@ -6,10 +6,15 @@
 #ifndef H_SPAINT_VISUALISERFACTORY
 #define H_SPAINT_VISUALISERFACTORY
 
+#include <ITMLib/Engines/Visualisation/Interface/ITMVisualisationEngine.h>
 #include <ITMLib/Utils/ITMLibSettings.h>
 
+#include "interface/BlockOccupancyUpdater.h"
 #include "interface/DepthVisualiser.h"
+#include "interface/FeatureInspectionVisualiser.h"
+#include "interface/MultiOutputVisualiser.h"
 #include "interface/SemanticVisualiser.h"
+#include "interface/StereoRaycaster.h"
 
 namespace spaint {
 
@@ -18,8 +23,20 @@ namespace spaint {
  */
 struct VisualiserFactory
 {
+  //#################### TYPEDEFS ####################
+
+  typedef boost::shared_ptr<ITMLib::ITMVisualisationEngine<SpaintVoxel,ITMVoxelIndex> > VoxelVisualisationEngine_Ptr;
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
+  /**
+   * \brief Makes a block occupancy updater.
+   *
+   * \param deviceType  The device on which the updater should operate.
+   * \return            The updater.
+   */
+  static BlockOccupancyUpdater_CPtr make_block_occupancy_updater(ITMLib::ITMLibSettings::DeviceType deviceType);
+
   /**
    * \brief Makes a depth visualiser.
    *
@@ -28,6 +45,31 @@ struct VisualiserFactory
    */
   static DepthVisualiser_CPtr make_depth_visualiser(ITMLib::ITMLibSettings::DeviceType deviceType);
 
+  /**
+   * \brief Makes a feature inspection visualiser.
+   *
+   * \param deviceType  The device on which the visualiser should operate.
+   * \return            The visualiser.
+   */
+  static FeatureInspectionVisualiser_CPtr make_feature_inspection_visualiser(ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  /**
+   * \brief Makes a multi-output visualiser.
+   *
+   * \param maxLabelCount The maximum number of labels that can be in use.
+   * \param deviceType    The device on which the visualiser should operate.
+   * \return              The visualiser.
+   */
+  static MultiOutputVisualiser_CPtr make_multi_output_visualiser(size_t maxLabelCount, ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  /**
+   * \brief Makes an InfiniTAM visualisation engine that uses the block occupancy of a voxel scene (if any) to skip empty space when raycasting it.
+   *
+   * \param deviceType  The device on which the visualisation engine should operate.
+   * \return            The visualisation engine.
+   */
+  static VoxelVisualisationEngine_Ptr make_occupancy_guided_visualisation_engine(ITMLib::ITMLibSettings::DeviceType deviceType);
+
   /**
    * \brief Makes a semantic visualiser.
    *
@@ -36,6 +78,14 @@ struct VisualiserFactory
    * \return              The visualiser.
    */
   static SemanticVisualiser_CPtr make_semantic_visualiser(size_t maxLabelCount, ITMLib::ITMLibSettings::DeviceType deviceType);
+
+  /**
+   * \brief Makes a stereo raycaster.
+   *
+   * \param deviceType  The device on which the raycaster should operate.
+   * \return            The raycaster.
+   */
+  static StereoRaycaster_CPtr make_stereo_raycaster(ITMLib::ITMLibSettings::DeviceType deviceType);
 };
 
 }
@@ -0,0 +1,26 @@
+/**
+ * spaint: BlockOccupancyUpdater_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKOCCUPANCYUPDATER_CPU
+#define H_SPAINT_BLOCKOCCUPANCYUPDATER_CPU
+
+#include "../interface/BlockOccupancyUpdater.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to keep the block occupancy of a voxel scene up to date using the CPU.
+ */
+class BlockOccupancyUpdater_CPU : public BlockOccupancyUpdater
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void update_entries(const int *entryIDs, int entryCount, SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ * spaint: FeatureInspectionVisualiser_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FEATUREINSPECTIONVISUALISER_CPU
+#define H_SPAINT_FEATUREINSPECTIONVISUALISER_CPU
+
+#include "../interface/FeatureInspectionVisualiser.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to render the VOP patch of a voxel's feature descriptor into an image using the CPU.
+ */
+class FeatureInspectionVisualiser_CPU : public FeatureInspectionVisualiser
+{
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void render_patch(const ORUtils::MemoryBlock<float>& featuresMB, const ITMUChar4Image_Ptr& outputImage) const;
+};
+
+}
+
+#endif
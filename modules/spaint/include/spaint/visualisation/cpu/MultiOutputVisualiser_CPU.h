@@ -0,0 +1,36 @@
+/**
+ * spaint: MultiOutputVisualiser_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MULTIOUTPUTVISUALISER_CPU
+#define H_SPAINT_MULTIOUTPUTVISUALISER_CPU
+
+#include "../interface/MultiOutputVisualiser.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to render several different visualisations of an InfiniTAM scene in a single pass using the CPU.
+ */
+class MultiOutputVisualiser_CPU : public MultiOutputVisualiser
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based multi-output visualiser.
+   *
+   * \param maxLabelCount The maximum number of labels that can be in use.
+   */
+  explicit MultiOutputVisualiser_CPU(size_t maxLabelCount);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState, LightingType lightingType,
+                               float labelAlpha, DepthVisualiser::DepthType depthType, float invalidDepthValue, const Outputs& outputs) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * spaint: OccupancyGuidedVisualisationEngine_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_OCCUPANCYGUIDEDVISUALISATIONENGINE_CPU
+#define H_SPAINT_OCCUPANCYGUIDEDVISUALISATIONENGINE_CPU
+
+#include <ITMLib/Engines/Visualisation/CPU/ITMVisualisationEngine_CPU.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class is an InfiniTAM visualisation engine that uses the block occupancy of a voxel scene
+ *        (if it is being recorded) to skip empty space when computing the depth ranges of a raycast on the CPU.
+ *
+ * The depth ranges are computed by projecting only the visible voxel blocks that are not known to contain only empty space,
+ * so rays start marching just in front of the surface rather than at the first allocated block. Since all of the raycasts
+ * of a scene (for rendering, for tracking and for relocalisation) compute their depth ranges via CreateExpectedDepths,
+ * they all benefit from this, provided that they share the engine.
+ *
+ * If a raycast region has been associated with the render state (see SpaintVoxelScene::set_raycast_region), the depth ranges
+ * of the pixels outside the region are then emptied (however the ranges were computed), so rays are only marched inside it.
+ */
+class OccupancyGuidedVisualisationEngine_CPU : public ITMLib::ITMVisualisationEngine_CPU<SpaintVoxel,ITMVoxelIndex>
+{
+  //#################### TYPEDEFS ####################
+private:
+  typedef ITMLib::ITMVisualisationEngine_CPU<SpaintVoxel,ITMVoxelIndex> Base;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void CreateExpectedDepths(const ITMLib::ITMScene<SpaintVoxel,ITMVoxelIndex> *scene, const ORUtils::SE3Pose *pose,
+                                    const ITMLib::ITMIntrinsics *intrinsics, ITMLib::ITMRenderState *renderState) const;
+};
+
+}
+
+#endif
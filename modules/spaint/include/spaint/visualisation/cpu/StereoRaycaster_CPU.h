@@ -0,0 +1,27 @@
+/**
+ * spaint: StereoRaycaster_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_STEREORAYCASTER_CPU
+#define H_SPAINT_STEREORAYCASTER_CPU
+
+#include "../interface/StereoRaycaster.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to raycast a voxel scene from both eyes of a stereo camera in a single pass using the CPU.
+ */
+class StereoRaycaster_CPU : public StereoRaycaster
+{
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void raycast(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *leftPose, const ORUtils::SE3Pose *rightPose, const ITMLib::ITMIntrinsics *intrinsics,
+                       ITMLib::ITMRenderState *leftRenderState, ITMLib::ITMRenderState *rightRenderState) const;
+};
+
+}
+
+#endif
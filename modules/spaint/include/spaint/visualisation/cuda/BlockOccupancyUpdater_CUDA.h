@@ -0,0 +1,26 @@
+/**
+ * spaint: BlockOccupancyUpdater_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKOCCUPANCYUPDATER_CUDA
+#define H_SPAINT_BLOCKOCCUPANCYUPDATER_CUDA
+
+#include "../interface/BlockOccupancyUpdater.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to keep the block occupancy of a voxel scene up to date using CUDA.
+ */
+class BlockOccupancyUpdater_CUDA : public BlockOccupancyUpdater
+{
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void update_entries(const int *entryIDs, int entryCount, SpaintVoxelScene *scene) const;
+};
+
+}
+
+#endif
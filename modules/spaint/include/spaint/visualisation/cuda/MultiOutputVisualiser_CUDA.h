@@ -0,0 +1,36 @@
+/**
+ * spaint: MultiOutputVisualiser_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MULTIOUTPUTVISUALISER_CUDA
+#define H_SPAINT_MULTIOUTPUTVISUALISER_CUDA
+
+#include "../interface/MultiOutputVisualiser.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to render several different visualisations of an InfiniTAM scene in a single pass using CUDA.
+ */
+class MultiOutputVisualiser_CUDA : public MultiOutputVisualiser
+{
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based multi-output visualiser.
+   *
+   * \param maxLabelCount The maximum number of labels that can be in use.
+   */
+  explicit MultiOutputVisualiser_CUDA(size_t maxLabelCount);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /** Override */
+  virtual void render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState, LightingType lightingType,
+                               float labelAlpha, DepthVisualiser::DepthType depthType, float invalidDepthValue, const Outputs& outputs) const;
+};
+
+}
+
+#endif
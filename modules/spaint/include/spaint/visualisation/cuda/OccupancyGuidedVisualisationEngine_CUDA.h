@@ -0,0 +1,74 @@
+/**
+ * spaint: OccupancyGuidedVisualisationEngine_CUDA.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_OCCUPANCYGUIDEDVISUALISATIONENGINE_CUDA
+#define H_SPAINT_OCCUPANCYGUIDEDVISUALISATIONENGINE_CUDA
+
+#include <ITMLib/Engines/Visualisation/CUDA/ITMVisualisationEngine_CUDA.h>
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class is an InfiniTAM visualisation engine that uses the block occupancy of a voxel scene
+ *        (if it is being recorded) to skip empty space when computing the depth ranges of a raycast using CUDA.
+ *
+ * The depth ranges are computed by projecting only the visible voxel blocks that are not known to contain only empty space,
+ * so rays start marching just in front of the surface rather than at the first allocated block. Since all of the raycasts
+ * of a scene (for rendering, for tracking and for relocalisation) compute their depth ranges via CreateExpectedDepths,
+ * they all benefit from this, provided that they share the engine.
+ *
+ * If a raycast region has been associated with the render state (see SpaintVoxelScene::set_raycast_region), the depth ranges
+ * of the pixels outside the region are then emptied (however the ranges were computed), so rays are only marched inside it.
+ */
+class OccupancyGuidedVisualisationEngine_CUDA : public ITMLib::ITMVisualisationEngine_CUDA<SpaintVoxel,ITMVoxelIndex>
+{
+  //#################### TYPEDEFS ####################
+private:
+  typedef ITMLib::ITMVisualisationEngine_CUDA<SpaintVoxel,ITMVoxelIndex> Base;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A memory block in which to store the number of rendering blocks into which the projected voxel blocks have been split. */
+  boost::shared_ptr<ORUtils::MemoryBlock<unsigned int> > m_renderingBlockCountMB;
+
+  /** A memory block in which to store the rendering blocks into which the projected voxel blocks have been split. */
+  boost::shared_ptr<ORUtils::MemoryBlock<RenderingBlock> > m_renderingBlocksMB;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CUDA-based occupancy-guided visualisation engine.
+   */
+  OccupancyGuidedVisualisationEngine_CUDA();
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual void CreateExpectedDepths(const ITMLib::ITMScene<SpaintVoxel,ITMVoxelIndex> *scene, const ORUtils::SE3Pose *pose,
+                                    const ITMLib::ITMIntrinsics *intrinsics, ITMLib::ITMRenderState *renderState) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the depth ranges of a raycast by projecting the visible voxel blocks that are not known to contain only empty space.
+   *
+   * \param scene           The scene.
+   * \param blockOccupancy  The scene's block occupancy data.
+   * \param pose            The camera pose.
+   * \param intrinsics      The camera intrinsics.
+   * \param renderState     The render state.
+   * \param ranges          The depth ranges (i.e. the data of the render state's rendering range image).
+   */
+  void create_occupancy_guided_depths(const ITMLib::ITMScene<SpaintVoxel,ITMVoxelIndex> *scene, const SpaintVoxelScene::BlockOccupancy *blockOccupancy,
+                                      const ORUtils::SE3Pose *pose, const ITMLib::ITMIntrinsics *intrinsics,
+                                      const ITMLib::ITMRenderState_VH *renderState, Vector2f *ranges) const;
+};
+
+}
+
+#endif
@@ -26,6 +26,10 @@ public:
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /** Override */
+  virtual void render_compact_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState,
+                                       LightingType lightingType, ITMUShortImage *outputImage) const;
+
   /** Override */
   virtual void render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMIntrinsics *intrinsics, const ITMLib::ITMRenderState *renderState,
                                LightingType lightingType, float labelAlpha, ITMUChar4Image *outputImage) const;
@@ -0,0 +1,62 @@
+/**
+ * spaint: BlockOccupancyUpdater.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKOCCUPANCYUPDATER
+#define H_SPAINT_BLOCKOCCUPANCYUPDATER
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to keep the block occupancy of a voxel scene up to date.
+ *
+ * Fusion only ever changes the voxel blocks that are visible from the current camera pose, so the block occupancy
+ * can be maintained incrementally by re-examining just those blocks after each frame has been fused. A block whose
+ * voxels all have an SDF value of 1 contains only empty space, and so can be skipped when computing the depth ranges
+ * of a raycast (see OccupancyGuidedVisualisationEngine_CPU and OccupancyGuidedVisualisationEngine_CUDA).
+ */
+class BlockOccupancyUpdater
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the block occupancy updater.
+   */
+  virtual ~BlockOccupancyUpdater();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Re-examines the specified voxel blocks, and records their occupancy in the scene's block occupancy data.
+   *
+   * \param entryIDs    The IDs of the hash entries of the voxel blocks to re-examine.
+   * \param entryCount  The number of voxel blocks to re-examine.
+   * \param scene       The scene.
+   */
+  virtual void update_entries(const int *entryIDs, int entryCount, SpaintVoxelScene *scene) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Updates the block occupancy of the scene to reflect the fusion of the latest frame.
+   *
+   * If the scene is not recording its block occupancy, this is a no-op.
+   *
+   * \param scene       The scene.
+   * \param renderState The live render state of the scene (whose visible entries are the voxel blocks into which the frame was fused).
+   */
+  void update_block_occupancy(SpaintVoxelScene *scene, const ITMLib::ITMRenderState *renderState) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const BlockOccupancyUpdater> BlockOccupancyUpdater_CPtr;
+
+}
+
+#endif
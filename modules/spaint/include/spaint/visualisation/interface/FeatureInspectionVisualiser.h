@@ -0,0 +1,48 @@
+/**
+ * spaint: FeatureInspectionVisualiser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FEATUREINSPECTIONVISUALISER
+#define H_SPAINT_FEATUREINSPECTIONVISUALISER
+
+#include <ORUtils/MemoryBlock.h>
+
+#include <itmx/base/ITMImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to render the VOP patch of a voxel's feature descriptor
+ *        into an image that can be shown as an overlay whilst inspecting the features of the scene.
+ *
+ * The image is written on the device on which the visualiser operates, so that the features do not need to be copied
+ * across to the CPU in order to be visualised.
+ */
+class FeatureInspectionVisualiser
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the feature inspection visualiser.
+   */
+  virtual ~FeatureInspectionVisualiser() {}
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Renders the VOP patch at the start of the specified feature descriptor into the specified image.
+   *
+   * \param featuresMB  A memory block whose start contains the feature descriptor (the patch is stored as row-major colour triplets).
+   * \param outputImage The image into which to render the patch (its size must be that of a VOP patch).
+   */
+  virtual void render_patch(const ORUtils::MemoryBlock<float>& featuresMB, const ITMUChar4Image_Ptr& outputImage) const = 0;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const FeatureInspectionVisualiser> FeatureInspectionVisualiser_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * spaint: MultiOutputVisualiser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MULTIOUTPUTVISUALISER
+#define H_SPAINT_MULTIOUTPUTVISUALISER
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState.h>
+#include <ITMLib/Utils/ITMImageTypes.h>
+
+#include <ORUtils/SE3Pose.h>
+
+#include "DepthVisualiser.h"
+#include "../shared/SemanticVisualiser_Settings.h"
+#include "../../util/LabelManager.h"
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to render several different visualisations of an InfiniTAM scene
+ *        from a single raycast in a single pass.
+ *
+ * Rendering the outputs separately (e.g. with a semantic visualiser and a depth visualiser) requires each pass to read the raycast
+ * and look up the voxels hit by the rays again. This class avoids that by computing all of the requested outputs for each pixel
+ * at the same time, performing each voxel lookup (and, if needed, each surface normal computation) only once.
+ */
+class MultiOutputVisualiser
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct specifies the outputs to render. Any output that is NULL will not be rendered.
+   *
+   * Each requested output image will be resized to the size of the raycast.
+   */
+  struct Outputs
+  {
+    /** An image into which to write the confidence of the voxel hit by each ray, in the range [0,1], or 0 for a miss. */
+    ITMFloatImage *confidence;
+
+    /** An image into which to write the depth of the surface point hit by each ray (in metres), or the invalid depth value for a miss. */
+    ITMFloatImage *depth;
+
+    /** An image into which to write the semantic label of the voxel hit by each ray, or 0 for a miss. */
+    ITMUCharImage *labels;
+
+    /** An image into which to write the unit surface normal at the point hit by each ray (in the w component, 1 denotes a hit and 0 a miss). */
+    ITMFloat4Image *normals;
+
+    /** An image into which to write the semantic visualisation of the scene (as produced by a semantic visualiser). */
+    ITMUChar4Image *semanticColour;
+
+    Outputs()
+    : confidence(NULL), depth(NULL), labels(NULL), normals(NULL), semanticColour(NULL)
+    {}
+  };
+
+  //#################### PROTECTED VARIABLES ####################
+protected:
+  /** A memory block in which to store the colours to use for the semantic labels. */
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3u> > m_labelColoursMB;
+
+  //#################### CONSTRUCTORS ####################
+protected:
+  /**
+   * \brief Constructs a multi-output visualiser.
+   *
+   * \param maxLabelCount The maximum number of labels that can be in use.
+   */
+  explicit MultiOutputVisualiser(size_t maxLabelCount);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the multi-output visualiser.
+   */
+  virtual ~MultiOutputVisualiser();
+
+  //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Renders the requested outputs for the specified scene from the specified camera pose.
+   *
+   * \param scene             The scene.
+   * \param pose              The camera pose.
+   * \param renderState       The render state corresponding to the specified camera pose.
+   * \param lightingType      The type of lighting to use for the semantic visualisation.
+   * \param labelAlpha        The proportion (in the range [0,1]) of the semantic visualisation's pixel colours that should be based on the voxels' semantic labels rather than their scene colours.
+   * \param depthType         The type of depth calculation to use.
+   * \param invalidDepthValue The depth value to use for pixels whose rays do not intersect the scene.
+   * \param outputs           The outputs to render (already resized to the size of the raycast).
+   */
+  virtual void render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState, LightingType lightingType,
+                               float labelAlpha, DepthVisualiser::DepthType depthType, float invalidDepthValue, const Outputs& outputs) const = 0;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Renders the requested outputs for the specified scene from the specified camera pose.
+   *
+   * \param scene             The scene.
+   * \param pose              The camera pose.
+   * \param renderState       The render state corresponding to the specified camera pose (containing an up-to-date raycast of the scene).
+   * \param labelColours      The colours to use for the semantic labels.
+   * \param lightingType      The type of lighting to use for the semantic visualisation.
+   * \param labelAlpha        The proportion (in the range [0,1]) of the semantic visualisation's pixel colours that should be based on the voxels' semantic labels rather than their scene colours.
+   * \param depthType         The type of depth calculation to use.
+   * \param invalidDepthValue The depth value to use for pixels whose rays do not intersect the scene.
+   * \param outputs           The outputs to render.
+   */
+  void render(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState, const std::vector<Vector3u>& labelColours,
+              LightingType lightingType, float labelAlpha, DepthVisualiser::DepthType depthType, float invalidDepthValue, const Outputs& outputs) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const MultiOutputVisualiser> MultiOutputVisualiser_CPtr;
+
+}
+
+#endif
@@ -48,6 +48,18 @@ public:
 
   //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Renders a compact semantic view of the specified scene from the specified camera pose.
+   *
+   * \param scene         The scene.
+   * \param pose          The camera pose.
+   * \param renderState   The render state corresponding to the specified camera pose.
+   * \param lightingType  The type of lighting to use.
+   * \param outputImage   The image into which to write the compact semantic visualisation of the scene (this will be the same size as the raycast result).
+   */
+  virtual void render_compact_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState,
+                                       LightingType lightingType, ITMUShortImage *outputImage) const = 0;
+
   /**
    * \brief Renders a semantic view of the specified scene from the specified camera pose.
    *
@@ -78,6 +90,23 @@ public:
    */
   void render(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMIntrinsics *intrinsics, const ITMLib::ITMRenderState *renderState,
               const std::vector<Vector3u>& labelColours, LightingType lightingType, float labelAlpha, ITMUChar4Image *outputImage) const;
+
+  /**
+   * \brief Renders a compact semantic view of the specified scene from the specified camera pose.
+   *
+   * Rather than a colour, each pixel of a compact semantic view contains the semantic label of the voxel hit by its ray and the
+   * shading intensity (see pack_compact_semantic_pixel). This is half the size of a colour image, and does not depend on the
+   * label colours, so the colour lookup can be deferred to whatever consumes the image (e.g. a fragment shader). Since the voxels'
+   * scene colours are not used, the result is equivalent to that of render with a label alpha of 1.
+   *
+   * \param scene         The scene.
+   * \param pose          The camera pose.
+   * \param renderState   The render state corresponding to the specified camera pose.
+   * \param lightingType  The type of lighting to use.
+   * \param outputImage   The image into which to write the compact semantic visualisation of the scene (resized to match the raycast result if necessary).
+   */
+  void render_compact(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState,
+                      LightingType lightingType, ITMUShortImage *outputImage) const;
 };
 
 //#################### TYPEDEFS ####################
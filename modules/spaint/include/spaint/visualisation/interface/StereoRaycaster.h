@@ -0,0 +1,60 @@
+/**
+ * spaint: StereoRaycaster.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_STEREORAYCASTER
+#define H_SPAINT_STEREORAYCASTER
+
+#include <ITMLib/Objects/Camera/ITMIntrinsics.h>
+#include <ITMLib/Objects/RenderStates/ITMRenderState.h>
+
+#include <ORUtils/SE3Pose.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of a class deriving from this one can be used to raycast a voxel scene from both eyes of a stereo camera in a single pass.
+ *
+ * Each pixel's rays for the left and right eyes are marched by the same thread, so a stereo pair can be raycast with a single
+ * kernel launch (rather than one per eye), and the two rays through each pixel, which tend to traverse neighbouring parts of
+ * the scene, are marched in lockstep.
+ */
+class StereoRaycaster
+{
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the stereo raycaster.
+   */
+  virtual ~StereoRaycaster() {}
+
+  //#################### PUBLIC ABSTRACT MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Raycasts the specified scene from the left and right eye poses of a stereo camera.
+   *
+   * The surface points found for each eye are written into the raycastResult of the corresponding render state.
+   * The expected depths for each eye must already have been computed in its render state (see CreateExpectedDepths),
+   * and the two render states must be of the same size.
+   *
+   * \param scene             The scene.
+   * \param leftPose          The pose of the left eye.
+   * \param rightPose         The pose of the right eye.
+   * \param intrinsics        The intrinsic parameters of the cameras for both eyes.
+   * \param leftRenderState   The render state for the left eye.
+   * \param rightRenderState  The render state for the right eye.
+   */
+  virtual void raycast(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *leftPose, const ORUtils::SE3Pose *rightPose, const ITMLib::ITMIntrinsics *intrinsics,
+                       ITMLib::ITMRenderState *leftRenderState, ITMLib::ITMRenderState *rightRenderState) const = 0;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<const StereoRaycaster> StereoRaycaster_CPtr;
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * spaint: BlockOccupancy_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_BLOCKOCCUPANCY_SHARED
+#define H_SPAINT_BLOCKOCCUPANCY_SHARED
+
+#include <ITMLib/Engines/Visualisation/Shared/ITMVisualisationEngine_Shared.h>
+
+#include "../../util/SpaintVoxelScene.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not the specified voxel lies in empty space (i.e. at least mu in front of any surface).
+ *
+ * Note that unobserved voxels also have an SDF value of 1, and so are treated as empty space, just as they are by the raycaster.
+ *
+ * \param voxel The voxel.
+ * \return      true, if the voxel lies in empty space, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_empty_voxel(const SpaintVoxel& voxel)
+{
+  return SpaintVoxel::valueToFloat(voxel.sdf) >= 1.0f;
+}
+
+/**
+ * \brief Determines whether or not the voxel block to which the specified hash entry refers is known to contain only empty space.
+ *
+ * \param entryID         The ID of the hash entry.
+ * \param hashTable       The scene's hash table.
+ * \param blockOccupancy  The scene's block occupancy data.
+ * \return                true, if the voxel block is known to contain only empty space, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool is_known_empty_block(int entryID, const ITMHashEntry *hashTable, const SpaintVoxelScene::BlockOccupancy *blockOccupancy)
+{
+  // Note: If the hash entry has been reused for a different block since the occupancy was recorded, the record is ignored.
+  const SpaintVoxelScene::BlockOccupancy& occupancy = blockOccupancy[entryID];
+  return occupancy.empty && occupancy.pos == hashTable[entryID].pos;
+}
+
+/**
+ * \brief Projects the voxel block to which the specified hash entry refers into the (subsampled) rendering range image,
+ *        provided that the block is resident and is not known to contain only empty space.
+ *
+ * \param entryID         The ID of the hash entry.
+ * \param hashTable       The scene's hash table.
+ * \param blockOccupancy  The scene's block occupancy data.
+ * \param M               The camera pose.
+ * \param projParams      The camera intrinsics.
+ * \param imgSize         The size of the rendering range image.
+ * \param voxelSize       The size of a voxel (in m).
+ * \param upperLeft       A location into which to write the upper-left corner of the block's bounding box in the range image.
+ * \param lowerRight      A location into which to write the lower-right corner of the block's bounding box in the range image.
+ * \param zRange          A location into which to write the range of depths spanned by the block.
+ * \return                true, if the block was projected, or false otherwise.
+ */
+_CPU_AND_GPU_CODE_
+inline bool project_occupied_block(int entryID, const ITMHashEntry *hashTable, const SpaintVoxelScene::BlockOccupancy *blockOccupancy,
+                                   const Matrix4f& M, const Vector4f& projParams, const Vector2i& imgSize, float voxelSize,
+                                   Vector2i& upperLeft, Vector2i& lowerRight, Vector2f& zRange)
+{
+  const ITMHashEntry& hashEntry = hashTable[entryID];
+  if(hashEntry.ptr < 0 || is_known_empty_block(entryID, hashTable, blockOccupancy)) return false;
+  return ProjectSingleBlock(hashEntry.pos, M, projParams, imgSize, voxelSize, upperLeft, lowerRight, zRange);
+}
+
+/**
+ * \brief Records the occupancy of the voxel block to which the specified hash entry refers.
+ *
+ * \param entryID         The ID of the hash entry.
+ * \param hashEntry       The hash entry.
+ * \param empty           Whether or not the block contains only empty space.
+ * \param blockOccupancy  The scene's block occupancy data.
+ */
+_CPU_AND_GPU_CODE_
+inline void write_block_occupancy(int entryID, const ITMHashEntry& hashEntry, bool empty, SpaintVoxelScene::BlockOccupancy *blockOccupancy)
+{
+  SpaintVoxelScene::BlockOccupancy& occupancy = blockOccupancy[entryID];
+  occupancy.empty = empty;
+  occupancy.pos = hashEntry.pos;
+}
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * spaint: FeatureInspectionVisualiser_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_FEATUREINSPECTIONVISUALISER_SHARED
+#define H_SPAINT_FEATUREINSPECTIONVISUALISER_SHARED
+
+#include <ITMLib/Utils/ITMMath.h>
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Writes the pixel of a feature inspection image that corresponds to the specified element of a VOP patch.
+ *
+ * \param pixelIndex  The index of the pixel (and of the patch element).
+ * \param features    The feature descriptor, whose start contains the patch (stored as row-major colour triplets).
+ * \param outputImage The feature inspection image.
+ */
+_CPU_AND_GPU_CODE_
+inline void write_feature_inspection_pixel(int pixelIndex, const float *features, Vector4u *outputImage)
+{
+  const float *colour = features + pixelIndex * 3;
+  Vector4u& pixel = outputImage[pixelIndex];
+  pixel.r = static_cast<unsigned char>(CLAMP(colour[0], 0.0f, 255.0f));
+  pixel.g = static_cast<unsigned char>(CLAMP(colour[1], 0.0f, 255.0f));
+  pixel.b = static_cast<unsigned char>(CLAMP(colour[2], 0.0f, 255.0f));
+  pixel.a = 255;
+}
+
+}
+
+#endif
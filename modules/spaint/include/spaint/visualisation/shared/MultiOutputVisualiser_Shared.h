@@ -0,0 +1,85 @@
+/**
+ * spaint: MultiOutputVisualiser_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_MULTIOUTPUTVISUALISER_SHARED
+#define H_SPAINT_MULTIOUTPUTVISUALISER_SHARED
+
+#include "DepthVisualiser_Shared.h"
+#include "SemanticVisualiser_Shared.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Computes the requested outputs for a pixel in a multi-output visualisation of the scene.
+ *
+ * Each output pointer may be NULL, in which case the corresponding output is not computed. The voxel hit by the pixel's ray is looked up
+ * at most once, and the surface normal is only computed if it is needed for the normals output or for lighting the semantic visualisation.
+ *
+ * \param locId             The raster index of the pixel.
+ * \param ptRay             The raycast result for the pixel (a surface point in voxel coordinates, with w > 0 iff the ray hit the scene).
+ * \param voxelData         The scene's voxel data.
+ * \param labelData         The scene's label data (if any).
+ * \param voxelIndex        The scene's voxel index.
+ * \param labelColours      The colour map for the semantic labels.
+ * \param viewerPos         The position of the viewer (in voxel coordinates).
+ * \param lightPos          The position of the light source that is illuminating the scene (in voxel coordinates).
+ * \param lightingType      The type of lighting to use for the semantic visualisation.
+ * \param labelAlpha        The proportion (in the range [0,1]) of the semantic colour that should be based on the voxel's semantic label rather than its scene colour.
+ * \param cameraPosition    The camera position (in world space).
+ * \param cameraLookVector  The camera look vector.
+ * \param voxelSize         The size of an InfiniTAM voxel (in metres).
+ * \param invalidDepthValue The depth value to use for pixels whose rays do not intersect the scene.
+ * \param depthType         The type of depth calculation to use.
+ * \param maxW              The maximum depth weight that a voxel can have (used to normalise the confidences).
+ * \param confidences       The confidence output (if requested).
+ * \param depths            The depth output (if requested).
+ * \param labels            The label output (if requested).
+ * \param normals           The normals output (if requested).
+ * \param semanticColours   The semantic colour output (if requested).
+ * \param cache             The index cache to use when looking up voxels.
+ */
+_CPU_AND_GPU_CODE_
+inline void shade_pixel_multi(int locId, const Vector4f& ptRay, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *voxelIndex,
+                              const Vector3u *labelColours, const Vector3f& viewerPos, const Vector3f& lightPos, LightingType lightingType, float labelAlpha,
+                              const Vector3f& cameraPosition, const Vector3f& cameraLookVector, float voxelSize, float invalidDepthValue,
+                              DepthVisualiser::DepthType depthType, float maxW, float *confidences, float *depths, SpaintVoxel::Label *labels,
+                              Vector4f *normals, Vector4u *semanticColours, ITMVoxelIndex::IndexCache& cache)
+{
+  const Vector3f point = ptRay.toVector3();
+  const bool foundPoint = ptRay.w > 0;
+
+  // The depth only depends on the surface point, so it can be computed without looking up any voxels.
+  if(depths) shade_pixel_depth(depths[locId], point * voxelSize, foundPoint, cameraPosition, cameraLookVector, voxelSize, invalidDepthValue, depthType);
+
+  // If the ray hit the scene and any of the other outputs have been requested, look up the voxel at the surface point.
+  // Note: As with readVoxel, a voxel that cannot be found is treated as a default voxel.
+  const bool needVoxel = confidences || labels || normals || semanticColours;
+  int vmIndex = 0;
+  const int voxelAddress = foundPoint && needVoxel ? findVoxel(voxelIndex, point.toIntRound(), vmIndex, cache) : -1;
+  const bool foundVoxel = vmIndex != 0;
+  const SpaintVoxel voxel = foundVoxel ? voxelData[voxelAddress] : SpaintVoxel();
+  const SpaintVoxel::Label label = foundVoxel ? get_voxel_label(voxelAddress, voxelData, labelData).label : 0;
+
+  // Compute the surface normal (if it is needed).
+  const bool needNormal = normals || (semanticColours && lightingType != LT_FLAT);
+  const Vector3f N = foundVoxel && needNormal ? compute_normal(point, voxelData, voxelIndex, cache) : Vector3f(0.0f, 0.0f, 0.0f);
+
+  // Write the requested outputs.
+  if(confidences) confidences[locId] = foundVoxel ? voxel.w_depth / maxW : 0.0f;
+  if(labels) labels[locId] = label;
+  if(normals) normals[locId] = Vector4f(N.x, N.y, N.z, foundVoxel ? 1.0f : 0.0f);
+  if(semanticColours)
+  {
+    semanticColours[locId] = foundPoint
+      ? compute_semantic_colour(point, foundVoxel, voxel, label, N, labelColours, viewerPos, lightPos, lightingType, labelAlpha)
+      : Vector4u((uchar)0);
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * spaint: RaycastRegion_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_RAYCASTREGION_SHARED
+#define H_SPAINT_RAYCASTREGION_SHARED
+
+#include <ITMLib/Engines/Visualisation/Shared/ITMVisualisationEngine_Shared.h>
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Empties the depth range of the specified pixel in the (subsampled) rendering range image if it lies outside a region.
+ *
+ * \param x       The x coordinate of the pixel.
+ * \param y       The y coordinate of the pixel.
+ * \param region  The region of the range image, in the form (minX,minY,maxX,maxY), with inclusive bounds.
+ * \param imgSize The size of the range image.
+ * \param ranges  The depth ranges.
+ */
+_CPU_AND_GPU_CODE_
+inline void clear_range_outside_region(int x, int y, const Vector4i& region, const Vector2i& imgSize, Vector2f *ranges)
+{
+  if(x < region.x || y < region.y || x > region.z || y > region.w)
+  {
+    ranges[y * imgSize.x + x] = Vector2f(FAR_AWAY, VERY_CLOSE);
+  }
+}
+
+/**
+ * \brief Converts a region of a raycast result image into the corresponding region of the (subsampled) rendering range image.
+ *
+ * Each pixel of the range image covers a square of pixels in the raycast result image, so the range image region is
+ * the set of range image pixels that cover any of the raycast result pixels in the original region.
+ *
+ * \param region        The region of the raycast result image, in the form (minX,minY,maxX,maxY), with inclusive bounds.
+ * \param raycastSize   The size of the raycast result image.
+ * \param rangeSize     The size of the range image.
+ * \return              The corresponding region of the range image, in the same form.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector4i scale_region_to_range_image(const Vector4i& region, const Vector2i& raycastSize, const Vector2i& rangeSize)
+{
+  return Vector4i(
+    region.x * rangeSize.x / raycastSize.x,
+    region.y * rangeSize.y / raycastSize.y,
+    region.z * rangeSize.x / raycastSize.x,
+    region.w * rangeSize.y / raycastSize.y
+  );
+}
+
+}
+
+#endif
@@ -17,74 +17,281 @@ namespace spaint {
 //#################### SHARED HELPER FUNCTIONS ####################
 
 /**
- * \brief Computes the colour for a pixel in a semantic visualisation of the scene.
+ * \brief Reads the trilinearly-interpolated SDF value at the specified point in the scene.
  *
- * This function is roughly analogous to a pixel shader.
+ * This is equivalent to InfiniTAM's readFromSDF_float_interpolated, except that it shares an index cache between the voxel lookups.
  *
- * \param dest          A location into which to write the computed colour.
- * \param point         The location of the point (if any) on the scene surface that was hit by a ray passing from the camera through the pixel.
- * \param foundPoint    A flag indicating whether or not any point was actually hit by the ray (true if yes; false if no).
- * \param voxelData     The scene's voxel data.
- * \param voxelIndex    The scene's voxel index.
- * \param labelColours  The colour map for the semantic labels.
+ * \param point       The point (in voxel coordinates).
+ * \param voxelData   The scene's voxel data.
+ * \param voxelIndex  The scene's voxel index.
+ * \param cache       The index cache to use when looking up the voxels.
+ * \return            The interpolated SDF value at the point.
+ */
+_CPU_AND_GPU_CODE_
+inline float read_sdf_interpolated(const Vector3f& point, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *voxelIndex, ITMVoxelIndex::IndexCache& cache)
+{
+  const Vector3i pos((int)floor(point.x), (int)floor(point.y), (int)floor(point.z));
+  const Vector3f coeff = point - pos.toFloat();
+
+  int vmIndex;
+  float sdf[8];
+  for(int i = 0; i < 8; ++i)
+  {
+    sdf[i] = SpaintVoxel::valueToFloat(readVoxel(voxelData, voxelIndex, pos + Vector3i(i & 1, (i >> 1) & 1, i >> 2), vmIndex, cache).sdf);
+  }
+
+  const float y0 = (1.0f - coeff.y) * ((1.0f - coeff.x) * sdf[0] + coeff.x * sdf[1]) + coeff.y * ((1.0f - coeff.x) * sdf[2] + coeff.x * sdf[3]);
+  const float y1 = (1.0f - coeff.y) * ((1.0f - coeff.x) * sdf[4] + coeff.x * sdf[5]) + coeff.y * ((1.0f - coeff.x) * sdf[6] + coeff.x * sdf[7]);
+  return (1.0f - coeff.z) * y0 + coeff.z * y1;
+}
+
+/**
+ * \brief Computes the unit surface normal at the specified point in the scene.
+ *
+ * This is equivalent to InfiniTAM's computeSingleNormalFromSDF (followed by normalisation), except that it shares an index cache between the voxel lookups.
+ *
+ * \param point       The point (in voxel coordinates).
+ * \param voxelData   The scene's voxel data.
+ * \param voxelIndex  The scene's voxel index.
+ * \param cache       The index cache to use when looking up the voxels.
+ * \return            The unit surface normal at the point.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector3f compute_normal(const Vector3f& point, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *voxelIndex, ITMVoxelIndex::IndexCache& cache)
+{
+  Vector3f N;
+  N.x = read_sdf_interpolated(point + Vector3f(1.0f, 0.0f, 0.0f), voxelData, voxelIndex, cache) - read_sdf_interpolated(point - Vector3f(1.0f, 0.0f, 0.0f), voxelData, voxelIndex, cache);
+  N.y = read_sdf_interpolated(point + Vector3f(0.0f, 1.0f, 0.0f), voxelData, voxelIndex, cache) - read_sdf_interpolated(point - Vector3f(0.0f, 1.0f, 0.0f), voxelData, voxelIndex, cache);
+  N.z = read_sdf_interpolated(point + Vector3f(0.0f, 0.0f, 1.0f), voxelData, voxelIndex, cache) - read_sdf_interpolated(point - Vector3f(0.0f, 0.0f, 1.0f), voxelData, voxelIndex, cache);
+  return N * (1.0f / sqrt(N.x * N.x + N.y * N.y + N.z * N.z));
+}
+
+/**
+ * \brief Computes the shading intensity for a pixel in a semantic visualisation of the scene, given the voxel that the pixel's ray hit.
+ *
+ * \param point         The location of the point on the scene surface that was hit by a ray passing from the camera through the pixel.
+ * \param foundVoxel    A flag indicating whether or not the voxel containing the point could be found.
+ * \param N             The unit surface normal at the point (only used if foundVoxel is true and the lighting is not flat).
  * \param viewerPos     The position of the viewer (in voxel coordinates).
  * \param lightPos      The position of the light source that is illuminating the scene (in voxel coordinates).
  * \param lightingType  The type of lighting to use.
- * \param labelAlpha    The proportion (in the range [0,1]) of the final pixel colour that should be based on the voxel's semantic label rather than its scene colour.
+ * \return              The intensity for the pixel (in the range [0,1]).
  */
 _CPU_AND_GPU_CODE_
-inline void shade_pixel_semantic(Vector4u& dest, const Vector3f& point, bool foundPoint,
-                                 const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *voxelIndex,
-                                 const Vector3u *labelColours, const Vector3f& viewerPos, const Vector3f& lightPos,
-                                 LightingType lightingType, const float labelAlpha)
+inline float compute_semantic_intensity(const Vector3f& point, bool foundVoxel, const Vector3f& N, const Vector3f& viewerPos, const Vector3f& lightPos, LightingType lightingType)
 {
   const float ambient = lightingType == LT_PHONG ? 0.3f : 0.2f;
   const float lambertianCoefficient = lightingType == LT_PHONG ? 0.35f : 0.8f;
   const float phongCoefficient = 0.35f;
   const float phongExponent = 20.0f;
 
-  dest = Vector4u((uchar)0);
-  if(foundPoint)
+  // If we're using flat lighting, the intensity doesn't depend on the surface normal.
+  float intensity = 1.0f;
+  if(lightingType != LT_FLAT)
   {
-    // Determine the base colour to use for the pixel based on the semantic label of the voxel we hit and its scene colour (if available).
-    const SpaintVoxel voxel = readVoxel(voxelData, voxelIndex, point.toIntRound(), foundPoint);
-    const Vector3u labelColour = labelColours[voxel.packedLabel.label];
-    Vector3u colour;
-    if(SpaintVoxel::hasColorInformation)
-    {
-      const Vector3u sceneColour = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxel);
-      colour = (labelAlpha * labelColour.toFloat() + (1.0f - labelAlpha) * sceneColour.toFloat()).toUChar();
-    }
-    else colour = labelColour;
-
-    // Calculate the Lambertian lighting term.
+    // Calculate the Lambertian lighting term. If the voxel could not be found, the ray is treated as a miss for lighting purposes.
     Vector3f L = normalize(lightPos - point);
-    Vector3f N(0.0f, 0.0f, 0.0f);
-    float NdotL = 0.0f;
-    computeNormalAndAngle<SpaintVoxel,ITMVoxelIndex>(foundPoint, point, voxelData, voxelIndex, L, N, NdotL);
+    const float NdotL = foundVoxel ? dot(N, L) : 0.0f;
+    const Vector3f litN = foundVoxel ? N : Vector3f(0.0f, 0.0f, 0.0f);
     float lambertian = CLAMP(NdotL, 0.0f, 1.0f);
 
     // Determine the intensity of the pixel using the Lambertian lighting equation.
-    float intensity = lightingType != LT_FLAT ? ambient + lambertianCoefficient * lambertian : 1.0f;
+    intensity = ambient + lambertianCoefficient * lambertian;
 
     // If we're using Phong lighting:
     if(lightingType == LT_PHONG)
     {
       // Calculate the Phong lighting term.
-      Vector3f R = 2.0f * N * NdotL - L;
+      Vector3f R = 2.0f * litN * NdotL - L;
       Vector3f V = normalize(viewerPos - point);
       float phong = pow(CLAMP(dot(R,V), 0.0f, 1.0f), phongExponent);
 
       // Add the Phong lighting term to the intensity.
       intensity += phongCoefficient * phong;
     }
+  }
+
+  return intensity;
+}
 
-    // Fill in the final colour for the pixel by scaling the base colour by the intensity.
-    dest.x = (uchar)(intensity * colour.r);
-    dest.y = (uchar)(intensity * colour.g);
-    dest.z = (uchar)(intensity * colour.b);
-    dest.w = 255;
+/**
+ * \brief Computes the colour for a pixel in a semantic visualisation of the scene, given the voxel that the pixel's ray hit.
+ *
+ * \param point         The location of the point on the scene surface that was hit by a ray passing from the camera through the pixel.
+ * \param foundVoxel    A flag indicating whether or not the voxel containing the point could be found.
+ * \param voxel         The voxel containing the point (or a default voxel, if it could not be found).
+ * \param label         The semantic label of the voxel (or 0, if it could not be found).
+ * \param N             The unit surface normal at the point (only used if foundVoxel is true and the lighting is not flat).
+ * \param labelColours  The colour map for the semantic labels.
+ * \param viewerPos     The position of the viewer (in voxel coordinates).
+ * \param lightPos      The position of the light source that is illuminating the scene (in voxel coordinates).
+ * \param lightingType  The type of lighting to use.
+ * \param labelAlpha    The proportion (in the range [0,1]) of the final pixel colour that should be based on the voxel's semantic label rather than its scene colour.
+ * \return              The colour for the pixel.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector4u compute_semantic_colour(const Vector3f& point, bool foundVoxel, const SpaintVoxel& voxel, SpaintVoxel::Label label, const Vector3f& N,
+                                        const Vector3u *labelColours, const Vector3f& viewerPos, const Vector3f& lightPos, LightingType lightingType, float labelAlpha)
+{
+  // Determine the base colour to use for the pixel based on the semantic label of the voxel and its scene colour (if available).
+  const Vector3u labelColour = labelColours[label];
+  Vector3u colour;
+  if(SpaintVoxel::hasColorInformation)
+  {
+    const Vector3u sceneColour = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxel);
+    colour = (labelAlpha * labelColour.toFloat() + (1.0f - labelAlpha) * sceneColour.toFloat()).toUChar();
   }
+  else colour = labelColour;
+
+  // Compute the final colour for the pixel by scaling the base colour by the intensity.
+  const float intensity = compute_semantic_intensity(point, foundVoxel, N, viewerPos, lightPos, lightingType);
+  return Vector4u((uchar)(intensity * colour.r), (uchar)(intensity * colour.g), (uchar)(intensity * colour.b), 255);
+}
+
+/**
+ * \brief Packs a semantic label and a shading intensity into a pixel of a compact semantic image.
+ *
+ * The label is stored in the low byte of the pixel and the intensity (scaled to [1,255]) in the high byte, so that on a
+ * little-endian machine a compact semantic image can be uploaded to OpenGL as a two-channel (luminance-alpha) image as is.
+ * A pixel whose ray did not hit the scene is stored as zero (the intensity of a pixel whose ray hit the scene is never zero).
+ *
+ * \param label     The semantic label.
+ * \param intensity The shading intensity (in the range [0,1]).
+ * \return          The packed pixel.
+ */
+_CPU_AND_GPU_CODE_
+inline ushort pack_compact_semantic_pixel(SpaintVoxel::Label label, float intensity)
+{
+  const int intensityByte = CLAMP((int)(intensity * 255.0f + 0.5f), 1, 255);
+  return (ushort)(label | (intensityByte << 8));
+}
+
+/**
+ * \brief Expands a pixel of a compact semantic image into the colour it represents.
+ *
+ * This is the inverse of pack_compact_semantic_pixel, combined with the colour lookup that would otherwise be done by compute_semantic_colour.
+ *
+ * \param pixel         The packed pixel.
+ * \param labelColours  The colour map for the semantic labels.
+ * \return              The colour for the pixel.
+ */
+_CPU_AND_GPU_CODE_
+inline Vector4u unpack_compact_semantic_pixel(ushort pixel, const Vector3u *labelColours)
+{
+  const int intensityByte = pixel >> 8;
+  if(intensityByte == 0) return Vector4u((uchar)0);
+
+  const Vector3u colour = labelColours[pixel & 0xff];
+  const float intensity = intensityByte / 255.0f;
+  return Vector4u((uchar)(intensity * colour.r), (uchar)(intensity * colour.g), (uchar)(intensity * colour.b), 255);
+}
+
+/**
+ * \brief Computes the colour for a pixel in a semantic visualisation of the scene.
+ *
+ * This function is roughly analogous to a pixel shader. Neighbouring pixels generally look up voxels in the same voxel blocks,
+ * so callers that shade a group of neighbouring pixels (e.g. a tile) should share a single index cache between them.
+ *
+ * \param dest          A location into which to write the computed colour.
+ * \param point         The location of the point (if any) on the scene surface that was hit by a ray passing from the camera through the pixel.
+ * \param foundPoint    A flag indicating whether or not any point was actually hit by the ray (true if yes; false if no).
+ * \param voxelData     The scene's voxel data.
+ * \param labelData     The scene's label data (if any).
+ * \param voxelIndex    The scene's voxel index.
+ * \param labelColours  The colour map for the semantic labels.
+ * \param viewerPos     The position of the viewer (in voxel coordinates).
+ * \param lightPos      The position of the light source that is illuminating the scene (in voxel coordinates).
+ * \param lightingType  The type of lighting to use.
+ * \param labelAlpha    The proportion (in the range [0,1]) of the final pixel colour that should be based on the voxel's semantic label rather than its scene colour.
+ * \param cache         The index cache to use when looking up voxels.
+ */
+_CPU_AND_GPU_CODE_
+inline void shade_pixel_semantic(Vector4u& dest, const Vector3f& point, bool foundPoint,
+                                 const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                 const ITMVoxelIndex::IndexData *voxelIndex, const Vector3u *labelColours, const Vector3f& viewerPos, const Vector3f& lightPos,
+                                 LightingType lightingType, const float labelAlpha, ITMVoxelIndex::IndexCache& cache)
+{
+  dest = Vector4u((uchar)0);
+  if(foundPoint)
+  {
+    // Look up the voxel we hit. Note: As with readVoxel, a voxel that cannot be found is treated as a default voxel.
+    int vmIndex;
+    const int voxelAddress = findVoxel(voxelIndex, point.toIntRound(), vmIndex, cache);
+    const bool foundVoxel = vmIndex != 0;
+    const SpaintVoxel voxel = foundVoxel ? voxelData[voxelAddress] : SpaintVoxel();
+    const SpaintVoxel::Label label = foundVoxel ? get_voxel_label(voxelAddress, voxelData, labelData).label : 0;
+
+    // If we need it for lighting, compute the surface normal, and then shade the pixel.
+    const Vector3f N = foundVoxel && lightingType != LT_FLAT ? compute_normal(point, voxelData, voxelIndex, cache) : Vector3f(0.0f, 0.0f, 0.0f);
+    dest = compute_semantic_colour(point, foundVoxel, voxel, label, N, labelColours, viewerPos, lightPos, lightingType, labelAlpha);
+  }
+}
+
+/**
+ * \brief Computes the colour for a pixel in a semantic visualisation of the scene, using a fresh index cache.
+ *
+ * See the overload above for a description of the parameters.
+ */
+_CPU_AND_GPU_CODE_
+inline void shade_pixel_semantic(Vector4u& dest, const Vector3f& point, bool foundPoint,
+                                 const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                 const ITMVoxelIndex::IndexData *voxelIndex, const Vector3u *labelColours, const Vector3f& viewerPos, const Vector3f& lightPos,
+                                 LightingType lightingType, const float labelAlpha)
+{
+  ITMVoxelIndex::IndexCache cache;
+  shade_pixel_semantic(dest, point, foundPoint, voxelData, labelData, voxelIndex, labelColours, viewerPos, lightPos, lightingType, labelAlpha, cache);
+}
+
+/**
+ * \brief Computes the packed label and intensity for a pixel in a compact semantic visualisation of the scene.
+ *
+ * This is the same as shade_pixel_semantic, except that rather than looking up the colour of the voxel's label, it writes the label
+ * and the shading intensity into the pixel (see pack_compact_semantic_pixel), so that the colour lookup can be done later (e.g. by
+ * a fragment shader). Since the scene colours of the voxels are not used, this corresponds to a label alpha of 1.
+ *
+ * \param dest          A location into which to write the packed pixel.
+ * \param point         The location of the point (if any) on the scene surface that was hit by a ray passing from the camera through the pixel.
+ * \param foundPoint    A flag indicating whether or not any point was actually hit by the ray (true if yes; false if no).
+ * \param voxelData     The scene's voxel data.
+ * \param labelData     The scene's label data (if any).
+ * \param voxelIndex    The scene's voxel index.
+ * \param viewerPos     The position of the viewer (in voxel coordinates).
+ * \param lightPos      The position of the light source that is illuminating the scene (in voxel coordinates).
+ * \param lightingType  The type of lighting to use.
+ * \param cache         The index cache to use when looking up voxels.
+ */
+_CPU_AND_GPU_CODE_
+inline void shade_pixel_semantic_compact(ushort& dest, const Vector3f& point, bool foundPoint,
+                                         const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *voxelIndex,
+                                         const Vector3f& viewerPos, const Vector3f& lightPos, LightingType lightingType, ITMVoxelIndex::IndexCache& cache)
+{
+  dest = 0;
+  if(foundPoint)
+  {
+    // Look up the voxel we hit. Note: As with readVoxel, a voxel that cannot be found is treated as a default voxel.
+    int vmIndex;
+    const int voxelAddress = findVoxel(voxelIndex, point.toIntRound(), vmIndex, cache);
+    const bool foundVoxel = vmIndex != 0;
+    const SpaintVoxel::Label label = foundVoxel ? get_voxel_label(voxelAddress, voxelData, labelData).label : 0;
+
+    // If we need it for lighting, compute the surface normal, and then shade the pixel.
+    const Vector3f N = foundVoxel && lightingType != LT_FLAT ? compute_normal(point, voxelData, voxelIndex, cache) : Vector3f(0.0f, 0.0f, 0.0f);
+    dest = pack_compact_semantic_pixel(label, compute_semantic_intensity(point, foundVoxel, N, viewerPos, lightPos, lightingType));
+  }
+}
+
+/**
+ * \brief Computes the packed label and intensity for a pixel in a compact semantic visualisation of the scene, using a fresh index cache.
+ *
+ * See the overload above for a description of the parameters.
+ */
+_CPU_AND_GPU_CODE_
+inline void shade_pixel_semantic_compact(ushort& dest, const Vector3f& point, bool foundPoint,
+                                         const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *voxelIndex,
+                                         const Vector3f& viewerPos, const Vector3f& lightPos, LightingType lightingType)
+{
+  ITMVoxelIndex::IndexCache cache;
+  shade_pixel_semantic_compact(dest, point, foundPoint, voxelData, labelData, voxelIndex, viewerPos, lightPos, lightingType, cache);
 }
 
 }
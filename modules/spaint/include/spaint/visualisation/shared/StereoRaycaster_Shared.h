@@ -0,0 +1,50 @@
+/**
+ * spaint: StereoRaycaster_Shared.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_SPAINT_STEREORAYCASTER_SHARED
+#define H_SPAINT_STEREORAYCASTER_SHARED
+
+#include <ITMLib/Engines/Visualisation/Shared/ITMVisualisationEngine_Shared.h>
+
+#include "../../util/SpaintVoxel.h"
+
+namespace spaint {
+
+//#################### SHARED HELPER FUNCTIONS ####################
+
+/**
+ * \brief Raycasts the scene through the specified pixel from both eyes of a stereo camera.
+ *
+ * \param x                 The x coordinate of the pixel.
+ * \param y                 The y coordinate of the pixel.
+ * \param width             The width of the raycast images.
+ * \param rangeWidth        The width of the images containing the expected depth ranges (these are subsampled by a factor of minmaximg_subsample).
+ * \param voxelData         The scene's voxel data.
+ * \param indexData         The scene's index data.
+ * \param leftInvM          The inverse of the left eye's pose matrix.
+ * \param rightInvM         The inverse of the right eye's pose matrix.
+ * \param invProjParams     The inverted projection parameters of the cameras for both eyes.
+ * \param oneOverVoxelSize  The reciprocal of the voxel size (in m).
+ * \param mu                The truncation distance of the signed distance function (in m).
+ * \param leftRanges        The expected depth ranges for the left eye.
+ * \param rightRanges       The expected depth ranges for the right eye.
+ * \param leftPtsRay        The image into which to write the surface points found for the left eye (in voxel coordinates).
+ * \param rightPtsRay       The image into which to write the surface points found for the right eye (in voxel coordinates).
+ */
+_CPU_AND_GPU_CODE_
+inline void raycast_stereo_pixel(int x, int y, int width, int rangeWidth, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                                 const Matrix4f& leftInvM, const Matrix4f& rightInvM, const Vector4f& invProjParams, float oneOverVoxelSize, float mu,
+                                 const Vector2f *leftRanges, const Vector2f *rightRanges, Vector4f *leftPtsRay, Vector4f *rightPtsRay)
+{
+  const int locId = y * width + x;
+  const int rangeLocId = (y / minmaximg_subsample) * rangeWidth + x / minmaximg_subsample;
+
+  castRay<SpaintVoxel,ITMVoxelIndex,false>(leftPtsRay[locId], NULL, x, y, voxelData, indexData, leftInvM, invProjParams, oneOverVoxelSize, mu, leftRanges[rangeLocId]);
+  castRay<SpaintVoxel,ITMVoxelIndex,false>(rightPtsRay[locId], NULL, x, y, voxelData, indexData, rightInvM, invProjParams, oneOverVoxelSize, mu, rightRanges[rangeLocId]);
+}
+
+}
+
+#endif
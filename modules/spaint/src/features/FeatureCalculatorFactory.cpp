@@ -17,21 +17,26 @@ namespace spaint {
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
 FeatureCalculator_CPtr FeatureCalculatorFactory::make_vop_feature_calculator(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount,
-                                                                             ITMLibSettings::DeviceType deviceType)
+                                                                             ITMLibSettings::DeviceType deviceType, size_t featureCacheSize,
+                                                                             bool useFusedKernel, bool useCUDAGraph)
 {
   FeatureCalculator_CPtr calculator;
 
   if(deviceType == ITMLibSettings::DEVICE_CUDA)
   {
 #ifdef WITH_CUDA
-    calculator.reset(new VOPFeatureCalculator_CUDA(maxVoxelLocationCount, patchSize, patchSpacing, binCount));
+    // If specialised kernels are available for the patch size and bin count, use them; otherwise, fall back to the generic kernels.
+    const bool useSpecialisedKernels = VOPFeatureCalculator_CUDA::has_specialised_kernels(patchSize, binCount);
+    calculator.reset(new VOPFeatureCalculator_CUDA(
+      maxVoxelLocationCount, patchSize, patchSpacing, binCount, featureCacheSize, useFusedKernel, useCUDAGraph, useSpecialisedKernels
+    ));
 #else
     throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
 #endif
   }
   else
   {
-    calculator.reset(new VOPFeatureCalculator_CPU(maxVoxelLocationCount, patchSize, patchSpacing, binCount));
+    calculator.reset(new VOPFeatureCalculator_CPU(maxVoxelLocationCount, patchSize, patchSpacing, binCount, featureCacheSize));
   }
 
   return calculator;
@@ -5,8 +5,13 @@
 
 #include "features/cpu/VOPFeatureCalculator_CPU.h"
 
+#include <algorithm>
 #include <vector>
 
+#ifdef WITH_AVX2
+#include <immintrin.h>
+#endif
+
 #include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
 
 #include "features/shared/VOPFeatureCalculator_Shared.h"
@@ -15,13 +20,13 @@ namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-VOPFeatureCalculator_CPU::VOPFeatureCalculator_CPU(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount)
-: VOPFeatureCalculator(maxVoxelLocationCount, patchSize, patchSpacing, binCount)
+VOPFeatureCalculator_CPU::VOPFeatureCalculator_CPU(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount, size_t featureCacheSize)
+: VOPFeatureCalculator(maxVoxelLocationCount, patchSize, patchSpacing, binCount, featureCacheSize)
 {}
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
-void VOPFeatureCalculator_CPU::calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB,
+void VOPFeatureCalculator_CPU::calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
                                                          const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                                          ORUtils::MemoryBlock<float>& featuresMB) const
 {
@@ -29,7 +34,6 @@ void VOPFeatureCalculator_CPU::calculate_surface_normals(const ORUtils::MemoryBl
   float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
   Vector3f *surfaceNormals = m_surfaceNormalsMB->GetData(MEMORYDEVICE_CPU);
   const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
-  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
 
 #ifdef WITH_OPENMP
   #pragma omp parallel for
@@ -45,20 +49,43 @@ void VOPFeatureCalculator_CPU::convert_patches_to_lab(int voxelLocationCount, OR
   const size_t featureCount = get_feature_count();
   float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
 
+#ifdef WITH_AVX2
+  const int patchArea = static_cast<int>(m_patchSize * m_patchSize);
+#endif
+
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
   for(int voxelLocationIndex = 0; voxelLocationIndex < voxelLocationCount; ++voxelLocationIndex)
   {
+#ifdef WITH_AVX2
+    // Convert the pixels in the voxel's patch in batches of 8.
+    float *rgbPatch = features + voxelLocationIndex * featureCount;
+    int indexInPatch = 0;
+    for(; indexInPatch + 8 <= patchArea; indexInPatch += 8)
+    {
+      convert_rgb_to_lab_avx2(rgbPatch + indexInPatch * 3);
+    }
+
+    // Convert any remaining pixels individually.
+    for(; indexInPatch < patchArea; ++indexInPatch)
+    {
+      float *rgb = rgbPatch + indexInPatch * 3;
+      Vector3f lab = convert_rgb_to_lab(Vector3f(rgb[0] / 255.0f, rgb[1] / 255.0f, rgb[2] / 255.0f));
+      rgb[0] = lab.x;
+      rgb[1] = lab.y;
+      rgb[2] = lab.z;
+    }
+#else
     convert_patch_to_lab(voxelLocationIndex, featureCount, features);
+#endif
   }
 }
 
-void VOPFeatureCalculator_CPU::fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, ORUtils::MemoryBlock<float>& featuresMB) const
+void VOPFeatureCalculator_CPU::fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const
 {
   const size_t featureCount = get_feature_count();
   float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
-  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
   const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
 
 #ifdef WITH_OPENMP
@@ -85,7 +112,7 @@ void VOPFeatureCalculator_CPU::generate_coordinate_systems(int voxelLocationCoun
   }
 }
 
-void VOPFeatureCalculator_CPU::generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB,
+void VOPFeatureCalculator_CPU::generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
                                                     const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                                     ORUtils::MemoryBlock<float>& featuresMB) const
 {
@@ -94,7 +121,6 @@ void VOPFeatureCalculator_CPU::generate_rgb_patches(const ORUtils::MemoryBlock<V
   const Vector3f *xAxes = m_xAxesMB->GetData(MEMORYDEVICE_CPU);
   const Vector3f *yAxes = m_yAxesMB->GetData(MEMORYDEVICE_CPU);
   const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
-  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
 
 #ifdef WITH_OPENMP
   #pragma omp parallel for
@@ -105,49 +131,249 @@ void VOPFeatureCalculator_CPU::generate_rgb_patches(const ORUtils::MemoryBlock<V
   }
 }
 
-void VOPFeatureCalculator_CPU::update_coordinate_systems(int voxelLocationCount, const ORUtils::MemoryBlock<float>& featuresMB) const
+int VOPFeatureCalculator_CPU::lookup_cached_features(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ITMVoxelIndex::IndexData *indexData,
+                                                     ORUtils::MemoryBlock<float>& featuresMB) const
 {
-  const int featureCount = static_cast<int>(get_feature_count());
-  const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
-  const int patchSize = static_cast<int>(m_patchSize);
-  const int patchArea = patchSize * patchSize;
-  Vector3f *xAxes = m_xAxesMB->GetData(MEMORYDEVICE_CPU);
-  Vector3f *yAxes = m_yAxesMB->GetData(MEMORYDEVICE_CPU);
-
-  std::vector<std::vector<float> > histograms(voxelLocationCount, std::vector<float>(m_binCount));
-  std::vector<std::vector<float> > intensities(voxelLocationCount, std::vector<float>(patchArea));
+  const unsigned int *blockVersions = m_blockVersionsMB->GetData(MEMORYDEVICE_CPU);
+  const float *cacheFeatures = m_cacheFeaturesMB->GetData(MEMORYDEVICE_CPU);
+  const Vector3s *cacheLocations = m_cacheLocationsMB->GetData(MEMORYDEVICE_CPU);
+  const unsigned int *cacheVersions = m_cacheVersionsMB->GetData(MEMORYDEVICE_CPU);
+  const int featureCacheSize = static_cast<int>(m_featureCacheSize);
+  const size_t featureCount = get_feature_count();
+  float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
 
-  int threadCount = voxelLocationCount * patchArea;
+  // Look up the voxels in the cache in parallel.
+  std::vector<unsigned char> hits(voxelLocationCount);
 
-  // Convert each voxel's RGB patch to an intensity patch.
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
-  for(int tid = 0; tid < threadCount; ++tid)
+  for(int voxelLocationIndex = 0; voxelLocationIndex < voxelLocationCount; ++voxelLocationIndex)
+  {
+    hits[voxelLocationIndex] = lookup_cached_feature(
+      voxelLocationIndex, voxelLocations, indexData, blockVersions, cacheLocations, cacheVersions, cacheFeatures, featureCacheSize, featureCount, features
+    );
+  }
+
+  // Gather together the voxels that were not found.
+  int *missIndices = m_missIndicesMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *missLocations = m_missLocationsMB->GetData(MEMORYDEVICE_CPU);
+  int missCount = 0;
+  for(int voxelLocationIndex = 0; voxelLocationIndex < voxelLocationCount; ++voxelLocationIndex)
   {
-    int voxelLocationIndex = tid / patchArea;
-    compute_intensities_for_patch(tid, features, featureCount, patchSize, &intensities[voxelLocationIndex][0]);
+    if(!hits[voxelLocationIndex])
+    {
+      missIndices[missCount] = voxelLocationIndex;
+      missLocations[missCount] = voxelLocations[voxelLocationIndex];
+      ++missCount;
+    }
   }
 
-  // Compute a histogram of oriented gradients from the intensity patch for each voxel.
+  return missCount;
+}
+
+void VOPFeatureCalculator_CPU::stamp_voxel_blocks(const int *visibleEntityIDs, int visibleEntityCount, const ITMHashEntry *hashTable) const
+{
+  unsigned int *blockVersions = m_blockVersionsMB->GetData(MEMORYDEVICE_CPU);
+
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
-  for(int tid = 0; tid < threadCount; ++tid)
+  for(int visibleEntityIndex = 0; visibleEntityIndex < visibleEntityCount; ++visibleEntityIndex)
   {
-    int voxelLocationIndex = tid / patchArea;
-    compute_histogram_for_patch(tid, m_patchSize, &intensities[voxelLocationIndex][0], m_binCount, &histograms[voxelLocationIndex][0]);
+    stamp_voxel_block(visibleEntityIndex, visibleEntityIDs, hashTable, m_featureCacheVersion, blockVersions);
   }
+}
 
-  // Calculate the dominant orientation for each voxel and rotate its coordinate system to align with that as necessary.
+void VOPFeatureCalculator_CPU::store_cached_features(int missCount, ORUtils::MemoryBlock<float>& featuresMB) const
+{
+  float *cacheFeatures = m_cacheFeaturesMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *cacheLocations = m_cacheLocationsMB->GetData(MEMORYDEVICE_CPU);
+  int *cacheOwners = m_cacheOwnersMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *cacheVersions = m_cacheVersionsMB->GetData(MEMORYDEVICE_CPU);
+  const int featureCacheSize = static_cast<int>(m_featureCacheSize);
+  const size_t featureCount = get_feature_count();
+  float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  const float *missFeatures = m_missFeaturesMB->GetData(MEMORYDEVICE_CPU);
+  const int *missIndices = m_missIndicesMB->GetData(MEMORYDEVICE_CPU);
+  const Vector3s *missLocations = m_missLocationsMB->GetData(MEMORYDEVICE_CPU);
+
+  // Decide which voxel to write to each contested cache slot (this is done serially, so the last voxel to claim a slot wins).
+  for(int missIndex = 0; missIndex < missCount; ++missIndex)
+  {
+    claim_feature_cache_slot(missIndex, missLocations, featureCacheSize, cacheOwners);
+  }
+
+  // Write the feature descriptors into both the output and the cache.
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
-  for(int tid = 0; tid < threadCount; ++tid)
+  for(int missIndex = 0; missIndex < missCount; ++missIndex)
+  {
+    store_cached_feature(
+      missIndex, missIndices, missLocations, missFeatures, featureCount, m_featureCacheVersion,
+      featureCacheSize, cacheOwners, cacheLocations, cacheVersions, cacheFeatures, features
+    );
+  }
+}
+
+void VOPFeatureCalculator_CPU::update_coordinate_systems(int voxelLocationCount, const ORUtils::MemoryBlock<float>& featuresMB) const
+{
+  const int featureCount = static_cast<int>(get_feature_count());
+  const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  const int patchSize = static_cast<int>(m_patchSize);
+  const int patchArea = patchSize * patchSize;
+  Vector3f *xAxes = m_xAxesMB->GetData(MEMORYDEVICE_CPU);
+  Vector3f *yAxes = m_yAxesMB->GetData(MEMORYDEVICE_CPU);
+
+  // Each voxel is processed by a single thread, so the threads can use private buffers for the intensities and histograms
+  // rather than sharing them via gradient-level parallelism (which would require the histograms to be updated atomically).
+#ifdef WITH_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    std::vector<float> histogram(m_binCount);
+    std::vector<float> intensities(patchArea);
+
+#ifdef WITH_OPENMP
+    #pragma omp for
+#endif
+    for(int voxelLocationIndex = 0; voxelLocationIndex < voxelLocationCount; ++voxelLocationIndex)
+    {
+      // Convert the voxel's RGB patch to an intensity patch.
+      int indexInPatch = 0;
+#ifdef WITH_AVX2
+      const float *rgbPatch = features + voxelLocationIndex * featureCount;
+      for(; indexInPatch + 8 <= patchArea; indexInPatch += 8)
+      {
+        compute_intensities_avx2(rgbPatch + indexInPatch * 3, &intensities[indexInPatch]);
+      }
+#endif
+      for(; indexInPatch < patchArea; ++indexInPatch)
+      {
+        compute_intensities_for_patch(voxelLocationIndex * patchArea + indexInPatch, features, featureCount, patchSize, &intensities[0]);
+      }
+
+      // Compute a histogram of oriented gradients from the intensity patch (the borders of the patch are skipped, since we can't compute gradients there).
+      std::fill(histogram.begin(), histogram.end(), 0.0f);
+      for(int y = 1; y < patchSize - 1; ++y)
+      {
+        int x = 1;
+#ifdef WITH_AVX2
+        for(; x + 8 <= patchSize - 1; x += 8)
+        {
+          float xDerivs[8], yDerivs[8], mags[8];
+          compute_gradients_avx2(&intensities[0], y * patchSize + x, patchSize, xDerivs, yDerivs, mags);
+          for(int i = 0; i < 8; ++i)
+          {
+            histogram[compute_orientation_bin(xDerivs[i], yDerivs[i], m_binCount)] += mags[i];
+          }
+        }
+#endif
+        for(; x < patchSize - 1; ++x)
+        {
+          const int i = y * patchSize + x;
+          const float xDeriv = intensities[i + 1] - intensities[i - 1];
+          const float yDeriv = intensities[i + patchSize] - intensities[i - patchSize];
+          histogram[compute_orientation_bin(xDeriv, yDeriv, m_binCount)] += static_cast<float>(sqrt(xDeriv * xDeriv + yDeriv * yDeriv));
+        }
+      }
+
+      // Calculate the dominant orientation for the voxel and rotate its coordinate system to align with that as necessary.
+      update_coordinate_system(0, patchArea, &histogram[0], m_binCount, &xAxes[voxelLocationIndex], &yAxes[voxelLocationIndex]);
+    }
+  }
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+#ifdef WITH_AVX2
+void VOPFeatureCalculator_CPU::compute_gradients_avx2(const float *intensities, int indexInPatch, int patchSize, float *xDerivs, float *yDerivs, float *mags)
+{
+  const float *centre = intensities + indexInPatch;
+  const __m256 xDeriv = _mm256_sub_ps(_mm256_loadu_ps(centre + 1), _mm256_loadu_ps(centre - 1));
+  const __m256 yDeriv = _mm256_sub_ps(_mm256_loadu_ps(centre + patchSize), _mm256_loadu_ps(centre - patchSize));
+  const __m256 mag = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(xDeriv, xDeriv), _mm256_mul_ps(yDeriv, yDeriv)));
+
+  _mm256_storeu_ps(xDerivs, xDeriv);
+  _mm256_storeu_ps(yDerivs, yDeriv);
+  _mm256_storeu_ps(mags, mag);
+}
+
+void VOPFeatureCalculator_CPU::compute_intensities_avx2(const float *rgb, float *intensities)
+{
+  // Gather the interleaved colour components of the 8 pixels.
+  const __m256i offsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  const __m256 r = _mm256_i32gather_ps(rgb, offsets, 4);
+  const __m256 g = _mm256_i32gather_ps(rgb + 1, offsets, 4);
+  const __m256 b = _mm256_i32gather_ps(rgb + 2, offsets, 4);
+
+  // Apply the same weighted sum as convert_rgb_to_grey, in the same order.
+  const __m256 rg = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.299f), r), _mm256_mul_ps(_mm256_set1_ps(0.587f), g));
+  _mm256_storeu_ps(intensities, _mm256_add_ps(rg, _mm256_mul_ps(_mm256_set1_ps(0.114f), b)));
+}
+
+void VOPFeatureCalculator_CPU::convert_rgb_to_lab_avx2(float *rgb)
+{
+  // Gather the interleaved colour components of the 8 pixels and scale them to [0,1].
+  const __m256i offsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  const __m256 maxComponent = _mm256_set1_ps(255.0f);
+  const __m256 r = _mm256_div_ps(_mm256_i32gather_ps(rgb, offsets, 4), maxComponent);
+  const __m256 g = _mm256_div_ps(_mm256_i32gather_ps(rgb + 1, offsets, 4), maxComponent);
+  const __m256 b = _mm256_div_ps(_mm256_i32gather_ps(rgb + 2, offsets, 4), maxComponent);
+
+  // Convert the colours to XYZ, using the same operations (in the same order) as convert_rgb_to_lab.
+  __m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.412453f), r), _mm256_mul_ps(_mm256_set1_ps(0.357580f), g)), _mm256_mul_ps(_mm256_set1_ps(0.180423f), b));
+  const __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.212671f), r), _mm256_mul_ps(_mm256_set1_ps(0.715160f), g)), _mm256_mul_ps(_mm256_set1_ps(0.072169f), b));
+  __m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.019334f), r), _mm256_mul_ps(_mm256_set1_ps(0.119193f), g)), _mm256_mul_ps(_mm256_set1_ps(0.950227f), b));
+
+  x = _mm256_div_ps(x, _mm256_set1_ps(0.950456f));
+  z = _mm256_div_ps(z, _mm256_set1_ps(1.088754f));
+
+  // Apply the non-linearity using the scalar helper, so that the cube roots are bit-identical to those computed by convert_rgb_to_lab.
+  float xs[8], ys[8], zs[8];
+  _mm256_storeu_ps(xs, x);
+  _mm256_storeu_ps(ys, y);
+  _mm256_storeu_ps(zs, z);
+  for(int i = 0; i < 8; ++i)
+  {
+    xs[i] = rgb_to_lab_f(xs[i]);
+    ys[i] = rgb_to_lab_f(ys[i]);
+    zs[i] = rgb_to_lab_f(zs[i]);
+  }
+
+  const __m256 fx = _mm256_loadu_ps(xs);
+  const __m256 fy = _mm256_loadu_ps(ys);
+  const __m256 fz = _mm256_loadu_ps(zs);
+
+  // Compute L, A and B.
+  const __m256 isAboveThreshold = _mm256_cmp_ps(y, _mm256_set1_ps(0.008856f), _CMP_GT_OQ);
+  const __m256 L = _mm256_blendv_ps(
+    _mm256_mul_ps(_mm256_set1_ps(903.3f), y),
+    _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(116.0f), fy), _mm256_set1_ps(16.0f)),
+    isAboveThreshold
+  );
+  __m256 A = _mm256_mul_ps(_mm256_set1_ps(500.0f), _mm256_sub_ps(fx, fy));
+  __m256 B = _mm256_mul_ps(_mm256_set1_ps(200.0f), _mm256_sub_ps(fy, fz));
+
+  const __m256 AplusB = _mm256_add_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_add_ps(A, B)), _mm256_set1_ps(0.000001f));
+  A = _mm256_div_ps(A, AplusB);
+  B = _mm256_div_ps(B, AplusB);
+
+  // Write the results back into the (interleaved) patch.
+  float Ls[8], As[8], Bs[8];
+  _mm256_storeu_ps(Ls, L);
+  _mm256_storeu_ps(As, A);
+  _mm256_storeu_ps(Bs, B);
+  for(int i = 0; i < 8; ++i)
   {
-    int voxelLocationIndex = tid / patchArea;
-    update_coordinate_system(tid, patchArea, &histograms[voxelLocationIndex][0], m_binCount, &xAxes[voxelLocationIndex], &yAxes[voxelLocationIndex]);
+    rgb[i * 3] = Ls[i];
+    rgb[i * 3 + 1] = As[i];
+    rgb[i * 3 + 2] = Bs[i];
   }
 }
+#endif
 
 }
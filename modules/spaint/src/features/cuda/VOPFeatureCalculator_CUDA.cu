@@ -5,8 +5,12 @@
 
 #include "features/cuda/VOPFeatureCalculator_CUDA.h"
 
+#include <stdexcept>
+
 #include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
 
+#include <ORUtils/CUDADefines.h>
+
 #include "features/shared/VOPFeatureCalculator_Shared.h"
 
 #define DEBUGGING 0
@@ -15,6 +19,100 @@ namespace spaint {
 
 //#################### CUDA KERNELS ####################
 
+__global__ void ck_claim_feature_cache_slots(const Vector3s *missLocations, int missCount, int featureCacheSize, int *cacheOwners)
+{
+  int missIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(missIndex < missCount)
+  {
+    claim_feature_cache_slot(missIndex, missLocations, featureCacheSize, cacheOwners);
+  }
+}
+
+/**
+ * \brief Calculates the VOP feature descriptors for the specified voxels, using one thread block per voxel and one thread per pixel of its patch.
+ *
+ * If PatchSize and BinCount are non-zero, they override the patch size and bin count passed in at runtime, allowing the compiler
+ * to specialise the kernel for them (e.g. to size the shared arrays exactly, turn the divisions and modulos into constant ones and
+ * unroll the histogram loops). If they are zero, the runtime values are used.
+ */
+template <int PatchSize, int BinCount>
+__global__ void ck_calculate_features_fused(const Vector3s *voxelLocations, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                                            const int dynamicPatchSize, const float patchSpacing, const size_t dynamicBinCount, float *features)
+{
+  const int patchSize = PatchSize > 0 ? PatchSize : dynamicPatchSize;
+  const size_t binCount = BinCount > 0 ? BinCount : dynamicBinCount;
+  const size_t featureCount = patchSize * patchSize * 3 + 3 + 1;
+  const int histogramSize = BinCount > 0 ? BinCount : 64;
+
+  // Note: As in ck_update_coordinate_systems, for the generic kernel we declare these shared arrays with fixed sizes for simplicity, which
+  //       limits us to histograms with at most 64 bins and VOP patches with at most 256 pixels. The axes are stored as plain floats, since
+  //       __shared__ variables cannot have constructors.
+  __shared__ float axes[6];
+  __shared__ float histogram[BinCount > 0 ? BinCount : 64];
+  __shared__ float intensities[PatchSize > 0 ? PatchSize * PatchSize : 256];
+
+  // There is one thread block per voxel, and one thread per pixel in the voxel's patch.
+  const int voxelLocationIndex = blockIdx.x;
+  const int indexInPatch = threadIdx.x;
+  const int halfPatchSize = (patchSize - 1) / 2;
+  const int x = indexInPatch % patchSize - halfPatchSize, y = indexInPatch / patchSize - halfPatchSize;
+
+  const Vector3s *voxelLocation = voxelLocations + voxelLocationIndex;
+  const Vector3f centre = voxelLocation->toFloat();
+  float *featuresForVoxel = features + voxelLocationIndex * featureCount;
+
+  // Calculate the surface normal at the voxel and write it into the feature vector, fill in the height of the voxel,
+  // and construct an initial coordinate system in the tangent plane to the surface at the voxel.
+  if(indexInPatch == 0)
+  {
+    Vector3f n, xAxis, yAxis;
+    write_surface_normal(0, voxelLocation, voxelData, indexData, &n, featureCount, featuresForVoxel);
+    fill_in_height(0, voxelLocation, featureCount, featuresForVoxel);
+    generate_coordinate_system(0, &n, &xAxis, &yAxis);
+
+    axes[0] = xAxis.x; axes[1] = xAxis.y; axes[2] = xAxis.z;
+    axes[3] = yAxis.x; axes[4] = yAxis.y; axes[5] = yAxis.z;
+  }
+
+  // Initialise the histogram.
+  for(int i = indexInPatch; i < histogramSize; i += blockDim.x) histogram[i] = 0.0f;
+  __syncthreads();
+
+  // Sample the pixel's colour from the initial patch, and convert it to an intensity value.
+  ITMVoxelIndex::IndexCache cache;
+  {
+    const Vector3f xAxis(axes[0], axes[1], axes[2]), yAxis(axes[3], axes[4], axes[5]);
+    const Vector3u clr = sample_patch_colour(centre, xAxis * patchSpacing, yAxis * patchSpacing, x, y, voxelData, indexData, cache);
+    intensities[indexInPatch] = convert_rgb_to_grey(clr.r, clr.g, clr.b);
+  }
+  __syncthreads();
+
+  // Compute a histogram of oriented gradients from the intensity patch.
+  compute_histogram_for_patch(indexInPatch, patchSize, intensities, binCount, histogram);
+  __syncthreads();
+
+  // Rotate the coordinate system to align with the dominant orientation as necessary.
+  if(indexInPatch == 0)
+  {
+    Vector3f xAxis(axes[0], axes[1], axes[2]), yAxis(axes[3], axes[4], axes[5]);
+    update_coordinate_system(0, patchSize * patchSize, histogram, binCount, &xAxis, &yAxis);
+
+    axes[0] = xAxis.x; axes[1] = xAxis.y; axes[2] = xAxis.z;
+    axes[3] = yAxis.x; axes[4] = yAxis.y; axes[5] = yAxis.z;
+  }
+  __syncthreads();
+
+  // Sample the pixel's colour from the rotated patch, convert it to CIELab and write it into the feature vector.
+  const Vector3f xAxis(axes[0], axes[1], axes[2]), yAxis(axes[3], axes[4], axes[5]);
+  const Vector3u clr = sample_patch_colour(centre, xAxis * patchSpacing, yAxis * patchSpacing, x, y, voxelData, indexData, cache);
+  const Vector3f lab = convert_rgb_to_lab(Vector3f(clr.r / 255.0f, clr.g / 255.0f, clr.b / 255.0f));
+
+  float *pixelFeatures = featuresForVoxel + indexInPatch * 3;
+  pixelFeatures[0] = lab.x;
+  pixelFeatures[1] = lab.y;
+  pixelFeatures[2] = lab.z;
+}
+
 __global__ void ck_calculate_surface_normals(const Vector3s *voxelLocations, const int voxelLocationCount,
                                              const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                              Vector3f *surfaceNormals, const size_t featureCount, float *features)
@@ -26,8 +124,10 @@ __global__ void ck_calculate_surface_normals(const Vector3s *voxelLocations, con
   }
 }
 
-__global__ void ck_convert_patches_to_lab(const int voxelLocationCount, const size_t featureCount, float *features)
+template <int PatchSize>
+__global__ void ck_convert_patches_to_lab(const int voxelLocationCount, const size_t dynamicFeatureCount, float *features)
 {
+  const size_t featureCount = PatchSize > 0 ? PatchSize * PatchSize * 3 + 3 + 1 : dynamicFeatureCount;
   int voxelLocationIndex = threadIdx.x + blockDim.x * blockIdx.x;
   if(voxelLocationIndex < voxelLocationCount)
   {
@@ -53,12 +153,15 @@ __global__ void ck_generate_coordinate_systems(const Vector3f *surfaceNormals, c
   }
 }
 
+template <int PatchSize>
 __global__ void ck_generate_rgb_patches(const Vector3s *voxelLocations, const int voxelLocationCount,
                                         const Vector3f *xAxes, const Vector3f *yAxes,
                                         const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                        const size_t patchSize, const float patchSpacing, const size_t featureCount,
-                                        float *features)
+                                        const size_t dynamicPatchSize, const float patchSpacing, float *features)
 {
+  const size_t patchSize = PatchSize > 0 ? PatchSize : dynamicPatchSize;
+  const size_t featureCount = patchSize * patchSize * 3 + 3 + 1;
+
   int voxelLocationIndex = threadIdx.x + blockDim.x * blockIdx.x;
   if(voxelLocationIndex < voxelLocationCount)
   {
@@ -66,26 +169,73 @@ __global__ void ck_generate_rgb_patches(const Vector3s *voxelLocations, const in
   }
 }
 
-__global__ void ck_update_coordinate_systems(const int voxelLocationCount, const float *features, const size_t featureCount,
-                                             const size_t patchSize, const size_t binCount, Vector3f *xAxes, Vector3f *yAxes)
+__global__ void ck_lookup_cached_features(const Vector3s *voxelLocations, const int voxelLocationCount, const ITMVoxelIndex::IndexData *indexData,
+                                          const unsigned int *blockVersions, const Vector3s *cacheLocations, const unsigned int *cacheVersions,
+                                          const float *cacheFeatures, int featureCacheSize, const size_t featureCount, float *features,
+                                          int *missIndices, Vector3s *missLocations, int *missCount)
 {
-  // Note: We declare these shared arrays with fixed sizes here for simplicity. The sizes will need to be changed
+  int voxelLocationIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(voxelLocationIndex < voxelLocationCount)
+  {
+    if(!lookup_cached_feature(voxelLocationIndex, voxelLocations, indexData, blockVersions, cacheLocations, cacheVersions, cacheFeatures, featureCacheSize, featureCount, features))
+    {
+      const int missIndex = atomicAdd(missCount, 1);
+      missIndices[missIndex] = voxelLocationIndex;
+      missLocations[missIndex] = voxelLocations[voxelLocationIndex];
+    }
+  }
+}
+
+__global__ void ck_stamp_voxel_blocks(const int *visibleEntityIDs, int visibleEntityCount, const ITMHashEntry *hashTable,
+                                      unsigned int featureCacheVersion, unsigned int *blockVersions)
+{
+  int visibleEntityIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(visibleEntityIndex < visibleEntityCount)
+  {
+    stamp_voxel_block(visibleEntityIndex, visibleEntityIDs, hashTable, featureCacheVersion, blockVersions);
+  }
+}
+
+__global__ void ck_store_cached_features(const int *missIndices, const Vector3s *missLocations, const float *missFeatures, int missCount,
+                                         const size_t featureCount, unsigned int featureCacheVersion, int featureCacheSize, const int *cacheOwners,
+                                         Vector3s *cacheLocations, unsigned int *cacheVersions, float *cacheFeatures, float *features)
+{
+  int missIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(missIndex < missCount)
+  {
+    store_cached_feature(
+      missIndex, missIndices, missLocations, missFeatures, featureCount, featureCacheVersion,
+      featureCacheSize, cacheOwners, cacheLocations, cacheVersions, cacheFeatures, features
+    );
+  }
+}
+
+template <int PatchSize, int BinCount>
+__global__ void ck_update_coordinate_systems(const int voxelLocationCount, const float *features, const size_t dynamicPatchSize,
+                                             const size_t dynamicBinCount, Vector3f *xAxes, Vector3f *yAxes)
+{
+  const size_t patchSize = PatchSize > 0 ? PatchSize : dynamicPatchSize;
+  const size_t binCount = BinCount > 0 ? BinCount : dynamicBinCount;
+  const size_t featureCount = patchSize * patchSize * 3 + 3 + 1;
+  const int histogramSize = BinCount > 0 ? BinCount : 64;
+
+  // Note: For the generic kernel, we declare these shared arrays with fixed sizes for simplicity. The sizes will need to be changed
   //       if we ever want to use a histogram with more than 64 bins or VOP patches that are bigger than 16 x 16.
-  __shared__ float histogram[64];
-  __shared__ float intensities[256];
+  __shared__ float histogram[BinCount > 0 ? BinCount : 64];
+  __shared__ float intensities[PatchSize > 0 ? PatchSize * PatchSize : 256];
 
   int tid = threadIdx.x + blockDim.x * blockIdx.x;
 
   // Initialise the histogram.
-  if(blockDim.x >= 64)
+  if(blockDim.x >= histogramSize)
   {
     // If there are enough threads in the block, initialise the histogram in parallel.
-    if(tid < 64) histogram[tid] = 0.0f;
+    if(threadIdx.x < histogramSize) histogram[threadIdx.x] = 0.0f;
   }
   else if(threadIdx.x == 0)
   {
     // Otherwise, initialise the histogram on a single thread.
-    for(int i = 0; i < 64; ++i) histogram[i] = 0.0f;
+    for(int i = 0; i < histogramSize; ++i) histogram[i] = 0.0f;
   }
   __syncthreads();
 
@@ -104,22 +254,178 @@ __global__ void ck_update_coordinate_systems(const int voxelLocationCount, const
 
 //#################### CONSTRUCTORS ####################
 
-VOPFeatureCalculator_CUDA::VOPFeatureCalculator_CUDA(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount)
-: VOPFeatureCalculator(maxVoxelLocationCount, patchSize, patchSpacing, binCount)
-{}
+VOPFeatureCalculator_CUDA::VOPFeatureCalculator_CUDA(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount, size_t featureCacheSize,
+                                                     bool useFusedKernel, bool useCUDAGraph, bool useSpecialisedKernels)
+: VOPFeatureCalculator(maxVoxelLocationCount, patchSize, patchSpacing, binCount, featureCacheSize),
+#ifdef SPAINT_USE_VOP_CUDA_GRAPH
+  m_graphExec(NULL),
+#endif
+  m_graphStream(0),
+  m_launchStream(0),
+  m_missCountMB(new ORUtils::MemoryBlock<int>(1, true, true)),
+  m_useCUDAGraph(useCUDAGraph && !useFusedKernel),
+  m_useFusedKernel(useFusedKernel),
+  m_useSpecialisedKernels(useSpecialisedKernels)
+{
+  if(useSpecialisedKernels && !has_specialised_kernels(patchSize, binCount))
+  {
+    throw std::invalid_argument("Error: There are no specialised VOP feature kernels for the specified patch size and bin count");
+  }
+
+  if(useFusedKernel && (patchSize * patchSize > 256 || binCount > 64))
+  {
+    throw std::invalid_argument("Error: The fused VOP feature kernel only supports patches with at most 256 pixels and histograms with at most 64 bins");
+  }
+
+  if(m_useCUDAGraph)
+  {
+#ifdef SPAINT_USE_VOP_CUDA_GRAPH
+    ORcudaSafeCall(cudaStreamCreate(&m_graphStream));
+#else
+    throw std::runtime_error("Error: Capturing the VOP feature pipeline into a CUDA graph requires CUDA 10.2 or later");
+#endif
+  }
+
+  m_graphParams.features = NULL;
+  m_graphParams.indexData = NULL;
+  m_graphParams.voxelData = NULL;
+  m_graphParams.voxelLocationCount = 0;
+  m_graphParams.voxelLocations = NULL;
+}
+
+//#################### DESTRUCTOR ####################
+
+VOPFeatureCalculator_CUDA::~VOPFeatureCalculator_CUDA()
+{
+#ifdef SPAINT_USE_VOP_CUDA_GRAPH
+  if(m_graphExec) cudaGraphExecDestroy(m_graphExec);
+#endif
+  if(m_graphStream) cudaStreamDestroy(m_graphStream);
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+bool VOPFeatureCalculator_CUDA::has_specialised_kernels(size_t patchSize, size_t binCount)
+{
+  return patchSize == SPECIALISED_PATCH_SIZE && binCount == SPECIALISED_BIN_COUNT;
+}
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
+
+void VOPFeatureCalculator_CUDA::calculate_features_uncached(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, const SpaintVoxelScene *scene,
+                                                            ORUtils::MemoryBlock<float>& featuresMB) const
+{
+  // If we're not using the fused kernel, run the stages of the pipeline separately (replaying them from a CUDA graph if requested).
+  if(!m_useFusedKernel)
+  {
+    if(m_useCUDAGraph) calculate_features_with_graph(voxelLocationsMB, voxelLocationCount, scene, featuresMB);
+    else VOPFeatureCalculator::calculate_features_uncached(voxelLocationsMB, voxelLocationCount, scene, featuresMB);
+    return;
+  }
+
+  // Otherwise, calculate the feature descriptors using one thread block per voxel and one thread per pixel in its patch.
+  int threadsPerBlock = static_cast<int>(m_patchSize * m_patchSize);
+  int numBlocks = voxelLocationCount;
+
+  void (*kernel)(const Vector3s*, const SpaintVoxel*, const ITMVoxelIndex::IndexData*, int, float, size_t, float*) =
+    m_useSpecialisedKernels ? ck_calculate_features_fused<SPECIALISED_PATCH_SIZE,SPECIALISED_BIN_COUNT> : ck_calculate_features_fused<0,0>;
+
+  kernel<<<numBlocks,threadsPerBlock>>>(
+    voxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->index.getIndexData(),
+    static_cast<int>(m_patchSize),
+    m_patchSpacing,
+    m_binCount,
+    featuresMB.GetData(MEMORYDEVICE_CUDA)
+  );
+
+#if DEBUGGING
+  featuresMB.UpdateHostFromDevice();
+#endif
+}
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
-void VOPFeatureCalculator_CUDA::calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB,
+void VOPFeatureCalculator_CUDA::calculate_features_with_graph(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, const SpaintVoxelScene *scene,
+                                                              ORUtils::MemoryBlock<float>& featuresMB) const
+{
+#ifdef SPAINT_USE_VOP_CUDA_GRAPH
+  if(voxelLocationCount == 0) return;
+
+  GraphParams params;
+  params.features = featuresMB.GetData(MEMORYDEVICE_CUDA);
+  params.indexData = scene->index.getIndexData();
+  params.voxelData = scene->localVBA.GetVoxelBlocks();
+  params.voxelLocationCount = voxelLocationCount;
+  params.voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CUDA);
+
+  // If the parameters have changed since the pipeline was last captured (or it has not yet been captured), capture it again.
+  const bool paramsChanged =
+    params.features != m_graphParams.features || params.indexData != m_graphParams.indexData || params.voxelData != m_graphParams.voxelData ||
+    params.voxelLocationCount != m_graphParams.voxelLocationCount || params.voxelLocations != m_graphParams.voxelLocations;
+
+  if(!m_graphExec || paramsChanged)
+  {
+    // Note: The stages of the pipeline must not synchronise with the host whilst they are being captured (so DEBUGGING must be disabled).
+    cudaGraph_t graph;
+    m_launchStream = m_graphStream;
+    ORcudaSafeCall(cudaStreamBeginCapture(m_graphStream, cudaStreamCaptureModeThreadLocal));
+    VOPFeatureCalculator::calculate_features_uncached(voxelLocationsMB, voxelLocationCount, scene, featuresMB);
+    m_launchStream = 0;
+    ORcudaSafeCall(cudaStreamEndCapture(m_graphStream, &graph));
+
+    // Try to update the existing executable graph in place, since only the kernel parameters and grid sizes will normally have changed.
+    // If that fails, instantiate a new executable graph instead.
+    bool updated = false;
+    if(m_graphExec)
+    {
+#if CUDART_VERSION >= 12000
+      cudaGraphExecUpdateResultInfo resultInfo;
+      updated = cudaGraphExecUpdate(m_graphExec, graph, &resultInfo) == cudaSuccess;
+#else
+      cudaGraphNode_t errorNode;
+      cudaGraphExecUpdateResult result;
+      updated = cudaGraphExecUpdate(m_graphExec, graph, &errorNode, &result) == cudaSuccess;
+#endif
+
+      if(!updated)
+      {
+        // Note: A failed update is not a sticky error, so we reset the last error before carrying on.
+        cudaGetLastError();
+        ORcudaSafeCall(cudaGraphExecDestroy(m_graphExec));
+        m_graphExec = NULL;
+      }
+    }
+
+    if(!updated)
+    {
+#if CUDART_VERSION >= 12000
+      ORcudaSafeCall(cudaGraphInstantiate(&m_graphExec, graph, 0));
+#else
+      ORcudaSafeCall(cudaGraphInstantiate(&m_graphExec, graph, NULL, NULL, 0));
+#endif
+    }
+
+    ORcudaSafeCall(cudaGraphDestroy(graph));
+    m_graphParams = params;
+  }
+
+  // Replay the graph. Since the graph stream is a blocking stream, this is ordered with respect to the work on the default stream.
+  ORcudaSafeCall(cudaGraphLaunch(m_graphExec, m_graphStream));
+#else
+  VOPFeatureCalculator::calculate_features_uncached(voxelLocationsMB, voxelLocationCount, scene, featuresMB);
+#endif
+}
+
+void VOPFeatureCalculator_CUDA::calculate_surface_normals(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
                                                           const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                                           ORUtils::MemoryBlock<float>& featuresMB) const
 {
-  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
-
   int threadsPerBlock = 256;
   int numBlocks = (voxelLocationCount + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_calculate_surface_normals<<<numBlocks,threadsPerBlock>>>(
+  ck_calculate_surface_normals<<<numBlocks,threadsPerBlock,0,m_launchStream>>>(
     voxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
     voxelLocationCount,
     voxelData,
@@ -140,7 +446,9 @@ void VOPFeatureCalculator_CUDA::convert_patches_to_lab(int voxelLocationCount, O
   int threadsPerBlock = 256;
   int numBlocks = (voxelLocationCount + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_convert_patches_to_lab<<<numBlocks,threadsPerBlock>>>(
+  void (*kernel)(int, size_t, float*) = m_useSpecialisedKernels ? ck_convert_patches_to_lab<SPECIALISED_PATCH_SIZE> : ck_convert_patches_to_lab<0>;
+
+  kernel<<<numBlocks,threadsPerBlock,0,m_launchStream>>>(
     voxelLocationCount,
     get_feature_count(),
     featuresMB.GetData(MEMORYDEVICE_CUDA)
@@ -151,14 +459,12 @@ void VOPFeatureCalculator_CUDA::convert_patches_to_lab(int voxelLocationCount, O
 #endif
 }
 
-void VOPFeatureCalculator_CUDA::fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, ORUtils::MemoryBlock<float>& featuresMB) const
+void VOPFeatureCalculator_CUDA::fill_in_heights(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const
 {
-  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
-
   int threadsPerBlock = 256;
   int numBlocks = (voxelLocationCount + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_fill_in_heights<<<numBlocks,threadsPerBlock>>>(
+  ck_fill_in_heights<<<numBlocks,threadsPerBlock,0,m_launchStream>>>(
     voxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
     voxelLocationCount,
     get_feature_count(),
@@ -175,7 +481,7 @@ void VOPFeatureCalculator_CUDA::generate_coordinate_systems(int voxelLocationCou
   int threadsPerBlock = 256;
   int numBlocks = (voxelLocationCount + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_generate_coordinate_systems<<<numBlocks,threadsPerBlock>>>(
+  ck_generate_coordinate_systems<<<numBlocks,threadsPerBlock,0,m_launchStream>>>(
     m_surfaceNormalsMB->GetData(MEMORYDEVICE_CUDA),
     voxelLocationCount,
     m_xAxesMB->GetData(MEMORYDEVICE_CUDA),
@@ -188,16 +494,17 @@ void VOPFeatureCalculator_CUDA::generate_coordinate_systems(int voxelLocationCou
 #endif
 }
 
-void VOPFeatureCalculator_CUDA::generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB,
+void VOPFeatureCalculator_CUDA::generate_rgb_patches(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount,
                                                      const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                                      ORUtils::MemoryBlock<float>& featuresMB) const
 {
-  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
-
   int threadsPerBlock = 256;
   int numBlocks = (voxelLocationCount + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_generate_rgb_patches<<<numBlocks,threadsPerBlock>>>(
+  void (*kernel)(const Vector3s*, int, const Vector3f*, const Vector3f*, const SpaintVoxel*, const ITMVoxelIndex::IndexData*, size_t, float, float*) =
+    m_useSpecialisedKernels ? ck_generate_rgb_patches<SPECIALISED_PATCH_SIZE> : ck_generate_rgb_patches<0>;
+
+  kernel<<<numBlocks,threadsPerBlock,0,m_launchStream>>>(
     voxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
     voxelLocationCount,
     m_xAxesMB->GetData(MEMORYDEVICE_CUDA),
@@ -206,7 +513,88 @@ void VOPFeatureCalculator_CUDA::generate_rgb_patches(const ORUtils::MemoryBlock<
     indexData,
     m_patchSize,
     m_patchSpacing,
+    featuresMB.GetData(MEMORYDEVICE_CUDA)
+  );
+
+#if DEBUGGING
+  featuresMB.UpdateHostFromDevice();
+#endif
+}
+
+int VOPFeatureCalculator_CUDA::lookup_cached_features(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ITMVoxelIndex::IndexData *indexData,
+                                                      ORUtils::MemoryBlock<float>& featuresMB) const
+{
+  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
+
+  // Reset the miss counter.
+  ORcudaSafeCall(cudaMemset(m_missCountMB->GetData(MEMORYDEVICE_CUDA), 0, sizeof(int)));
+
+  // Look up the voxels in the cache, gathering together the ones that were not found.
+  int threadsPerBlock = 256;
+  int numBlocks = (voxelLocationCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_lookup_cached_features<<<numBlocks,threadsPerBlock>>>(
+    voxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
+    voxelLocationCount,
+    indexData,
+    m_blockVersionsMB->GetData(MEMORYDEVICE_CUDA),
+    m_cacheLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    m_cacheVersionsMB->GetData(MEMORYDEVICE_CUDA),
+    m_cacheFeaturesMB->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_featureCacheSize),
+    get_feature_count(),
+    featuresMB.GetData(MEMORYDEVICE_CUDA),
+    m_missIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    m_missLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    m_missCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Copy the number of voxels that were not found back across to the CPU.
+  m_missCountMB->UpdateHostFromDevice();
+  return *m_missCountMB->GetData(MEMORYDEVICE_CPU);
+}
+
+void VOPFeatureCalculator_CUDA::stamp_voxel_blocks(const int *visibleEntityIDs, int visibleEntityCount, const ITMHashEntry *hashTable) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (visibleEntityCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_stamp_voxel_blocks<<<numBlocks,threadsPerBlock>>>(
+    visibleEntityIDs,
+    visibleEntityCount,
+    hashTable,
+    m_featureCacheVersion,
+    m_blockVersionsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void VOPFeatureCalculator_CUDA::store_cached_features(int missCount, ORUtils::MemoryBlock<float>& featuresMB) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (missCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Decide which voxel to write to each contested cache slot. Since this is done in a separate kernel from the writes
+  // themselves, every thread sees the same owner for each slot, and so each slot is written by at most one thread.
+  ck_claim_feature_cache_slots<<<numBlocks,threadsPerBlock>>>(
+    m_missLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    missCount,
+    static_cast<int>(m_featureCacheSize),
+    m_cacheOwnersMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Write the feature descriptors into both the output and the cache.
+  ck_store_cached_features<<<numBlocks,threadsPerBlock>>>(
+    m_missIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    m_missLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    m_missFeaturesMB->GetData(MEMORYDEVICE_CUDA),
+    missCount,
     get_feature_count(),
+    m_featureCacheVersion,
+    static_cast<int>(m_featureCacheSize),
+    m_cacheOwnersMB->GetData(MEMORYDEVICE_CUDA),
+    m_cacheLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    m_cacheVersionsMB->GetData(MEMORYDEVICE_CUDA),
+    m_cacheFeaturesMB->GetData(MEMORYDEVICE_CUDA),
     featuresMB.GetData(MEMORYDEVICE_CUDA)
   );
 
@@ -220,10 +608,12 @@ void VOPFeatureCalculator_CUDA::update_coordinate_systems(int voxelLocationCount
   int threadsPerBlock = static_cast<int>(m_patchSize * m_patchSize);
   int numBlocks = voxelLocationCount;
 
-  ck_update_coordinate_systems<<<numBlocks,threadsPerBlock>>>(
+  void (*kernel)(int, const float*, size_t, size_t, Vector3f*, Vector3f*) =
+    m_useSpecialisedKernels ? ck_update_coordinate_systems<SPECIALISED_PATCH_SIZE,SPECIALISED_BIN_COUNT> : ck_update_coordinate_systems<0,0>;
+
+  kernel<<<numBlocks,threadsPerBlock,0,m_launchStream>>>(
     voxelLocationCount,
     featuresMB.GetData(MEMORYDEVICE_CUDA),
-    get_feature_count(),
     m_patchSize,
     m_binCount,
     m_xAxesMB->GetData(MEMORYDEVICE_CUDA),
@@ -4,6 +4,9 @@
  */
 
 #include "features/interface/VOPFeatureCalculator.h"
+using namespace ITMLib;
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
 
 #include <itmx/base/MemoryBlockFactory.h>
 using itmx::MemoryBlockFactory;
@@ -18,7 +21,7 @@ namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-VOPFeatureCalculator::VOPFeatureCalculator(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount)
+VOPFeatureCalculator::VOPFeatureCalculator(size_t maxVoxelLocationCount, size_t patchSize, float patchSpacing, size_t binCount, size_t featureCacheSize)
 :
   // Debugging variables
   m_debugDelayMs(30),
@@ -26,12 +29,32 @@ VOPFeatureCalculator::VOPFeatureCalculator(size_t maxVoxelLocationCount, size_t
 
   // Normal variables
   m_binCount(binCount),
+  m_featureCacheSize(featureCacheSize),
+  m_featureCacheVersion(1),
   m_patchSize(patchSize),
   m_patchSpacing(patchSpacing),
-  m_surfaceNormalsMB(MemoryBlockFactory::instance().make_block<Vector3f>(maxVoxelLocationCount)),
-  m_xAxesMB(MemoryBlockFactory::instance().make_block<Vector3f>(maxVoxelLocationCount)),
-  m_yAxesMB(MemoryBlockFactory::instance().make_block<Vector3f>(maxVoxelLocationCount))
-{}
+  m_surfaceNormalsMB(MemoryBlockFactory::instance().make_block<Vector3f>(maxVoxelLocationCount, "VOPFeatureCalculator")),
+  m_xAxesMB(MemoryBlockFactory::instance().make_block<Vector3f>(maxVoxelLocationCount, "VOPFeatureCalculator")),
+  m_yAxesMB(MemoryBlockFactory::instance().make_block<Vector3f>(maxVoxelLocationCount, "VOPFeatureCalculator"))
+{
+  // If the feature cache is enabled, allocate it, together with the memory blocks needed for the voxels that are not found in it.
+  if(featureCacheSize > 0)
+  {
+    MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+    const size_t featureCount = get_feature_count();
+
+    m_cacheFeaturesMB = mbf.make_block<float>(featureCacheSize * featureCount, "VOPFeatureCalculator");
+    m_cacheLocationsMB = mbf.make_block<Vector3s>(featureCacheSize, "VOPFeatureCalculator");
+    m_cacheOwnersMB = mbf.make_block<int>(featureCacheSize, "VOPFeatureCalculator");
+    m_cacheVersionsMB = mbf.make_block<unsigned int>(featureCacheSize, "VOPFeatureCalculator");
+    m_missFeaturesMB = mbf.make_block<float>(maxVoxelLocationCount * featureCount, "VOPFeatureCalculator");
+    m_missIndicesMB = mbf.make_block<int>(maxVoxelLocationCount, "VOPFeatureCalculator");
+    m_missLocationsMB = mbf.make_block<Vector3s>(maxVoxelLocationCount, "VOPFeatureCalculator");
+
+    // Mark all of the slots in the cache as empty.
+    m_cacheVersionsMB->Clear();
+  }
+}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
@@ -41,17 +64,69 @@ void VOPFeatureCalculator::calculate_features(const ORUtils::MemoryBlock<Vector3
   process_debug_window();
 #endif
 
+  // If the feature cache is disabled, simply calculate the feature descriptors for all of the voxels.
+  if(m_featureCacheSize == 0)
+  {
+    calculate_features_uncached(voxelLocationsMB, static_cast<int>(voxelLocationsMB.dataSize), scene, featuresMB);
+    return;
+  }
+
+  // Otherwise, copy across the cached feature descriptors of any voxels whose blocks have not been updated since they were calculated.
+  require_block_versions(scene);
+  const int missCount = lookup_cached_features(voxelLocationsMB, scene->index.getIndexData(), featuresMB);
+
+  // Calculate the feature descriptors for the remaining voxels, and store them in both the output memory block and the cache.
+  if(missCount > 0)
+  {
+    calculate_features_uncached(*m_missLocationsMB, missCount, scene, *m_missFeaturesMB);
+    store_cached_features(missCount, featuresMB);
+  }
+}
+
+size_t VOPFeatureCalculator::get_feature_count() const
+{
+  // A feature vector consists of a patch of CIELab colour values, the surface normal,
+  // and the height of the voxel in the scene.
+  return m_patchSize * m_patchSize * 3 + 3 + 1;
+}
+
+void VOPFeatureCalculator::invalidate_cached_features() const
+{
+  // Mark all of the slots in the cache (if enabled) as empty. Note that the versions with which the voxel blocks are tagged are
+  // indexed by slot, so they may now refer to different blocks, but that doesn't matter, since nothing older than them is cached.
+  if(m_featureCacheSize > 0) m_cacheVersionsMB->Clear();
+}
+
+void VOPFeatureCalculator::invalidate_fused_blocks(const ITMRenderState *renderState, const SpaintVoxelScene *scene) const
+{
+  // If the feature cache is disabled, there is nothing to invalidate.
+  if(m_featureCacheSize == 0) return;
+
+  // Fusion only updates the voxel blocks in the render state's visible list, so that is all we need to invalidate.
+  const ITMRenderState_VH *renderStateVH = dynamic_cast<const ITMRenderState_VH*>(renderState);
+  if(!renderStateVH) return;
+
+  // Tag the updated blocks with a new version of the cache, so that any features cached for their voxels before now will no longer be used.
+  require_block_versions(scene);
+  ++m_featureCacheVersion;
+  stamp_voxel_blocks(renderStateVH->GetVisibleEntityIDs(), renderStateVH->noVisibleEntities, scene->index.GetEntries());
+}
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
+
+void VOPFeatureCalculator::calculate_features_uncached(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int voxelLocationCount, const SpaintVoxelScene *scene,
+                                                       ORUtils::MemoryBlock<float>& featuresMB) const
+{
   // Calculate the surface normals at the voxel locations (this also writes them into the feature vectors).
   const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
   const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
-  calculate_surface_normals(voxelLocationsMB, voxelData, indexData, featuresMB);
+  calculate_surface_normals(voxelLocationsMB, voxelLocationCount, voxelData, indexData, featuresMB);
 
   // Construct a coordinate system in the tangent plane to the surface at each voxel location.
-  const int voxelLocationCount = static_cast<int>(voxelLocationsMB.dataSize);
   generate_coordinate_systems(voxelLocationCount);
 
   // Read an RGB patch around each voxel location.
-  generate_rgb_patches(voxelLocationsMB, voxelData, indexData, featuresMB);
+  generate_rgb_patches(voxelLocationsMB, voxelLocationCount, voxelData, indexData, featuresMB);
 
 #if defined(WITH_OPENCV) && DEBUG_FEATURE_DISPLAY
   display_features(featuresMB, voxelLocationCount, "Feature Samples Before Rotation");
@@ -61,7 +136,7 @@ void VOPFeatureCalculator::calculate_features(const ORUtils::MemoryBlock<Vector3
   update_coordinate_systems(voxelLocationCount, featuresMB);
 
   // Read a new RGB patch around each voxel location that is oriented based on the dominant orientation.
-  generate_rgb_patches(voxelLocationsMB, voxelData, indexData, featuresMB);
+  generate_rgb_patches(voxelLocationsMB, voxelLocationCount, voxelData, indexData, featuresMB);
 
 #if defined(WITH_OPENCV) && DEBUG_FEATURE_DISPLAY
   display_features(featuresMB, voxelLocationCount, "Feature Samples After Rotation");
@@ -79,14 +154,7 @@ void VOPFeatureCalculator::calculate_features(const ORUtils::MemoryBlock<Vector3
   // we write are simply the y values of the voxels. We ensure that scene up corresponds to world up by making
   // use of the gyro in the Oculus Rift. (If the Rift is not being used, the camera should simply be held
   // horizontally when running the application.)
-  fill_in_heights(voxelLocationsMB, featuresMB);
-}
-
-size_t VOPFeatureCalculator::get_feature_count() const
-{
-  // A feature vector consists of a patch of CIELab colour values, the surface normal,
-  // and the height of the voxel in the scene.
-  return m_patchSize * m_patchSize * 3 + 3 + 1;
+  fill_in_heights(voxelLocationsMB, voxelLocationCount, featuresMB);
 }
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
@@ -129,4 +197,14 @@ void VOPFeatureCalculator::process_debug_window() const
 #endif
 }
 
+void VOPFeatureCalculator::require_block_versions(const SpaintVoxelScene *scene) const
+{
+  if(!m_blockVersionsMB)
+  {
+    // Note: No block has been updated since the cache was created, so all of the blocks start with version 0.
+    m_blockVersionsMB = MemoryBlockFactory::instance().make_block<unsigned int>(scene->localVBA.allocatedSize, "VOPFeatureCalculator");
+    m_blockVersionsMB->Clear();
+  }
+}
+
 }
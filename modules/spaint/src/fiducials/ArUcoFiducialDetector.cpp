@@ -6,6 +6,7 @@
 #include "fiducials/ArUcoFiducialDetector.h"
 
 #include <cmath>
+#include <stdexcept>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
@@ -30,8 +31,14 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 ArUcoFiducialDetector::ArUcoFiducialDetector(const Settings_CPtr& settings)
-: m_settings(settings)
-{}
+: m_detectionScale(settings->get_first_value<float>("ArUcoFiducialDetector.detectionScale", 1.0f)),
+  m_settings(settings)
+{
+  if(m_detectionScale <= 0.0f || m_detectionScale > 1.0f)
+  {
+    throw std::invalid_argument("Error: The ArUco fiducial detection scale must be in (0,1]");
+  }
+}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
@@ -49,7 +56,38 @@ std::map<std::string,FiducialMeasurement> ArUcoFiducialDetector::detect_fiducial
   cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_ARUCO_ORIGINAL);
   std::vector<std::vector<cv::Point2f> > corners;
   std::vector<int> ids;
-  cv::aruco::detectMarkers(rgbImage, dictionary, corners, ids);
+  if(m_detectionScale < 1.0f)
+  {
+    // Detect the fiducials in a downsampled copy of the image.
+    cv::Mat3b smallImage;
+    cv::resize(rgbImage, smallImage, cv::Size(), m_detectionScale, m_detectionScale, cv::INTER_AREA);
+    cv::aruco::detectMarkers(smallImage, dictionary, corners, ids);
+
+    // Scale the corners back up to full resolution, and refine them there. The search window needs to be a bit
+    // larger than the area of the full-resolution image covered by a single pixel of the downsampled one.
+    if(!corners.empty())
+    {
+      cv::Mat1b greyImage;
+      cv::cvtColor(rgbImage, greyImage, cv::COLOR_BGR2GRAY);
+
+      const float invScale = 1.0f / m_detectionScale;
+      const int windowHalfSize = static_cast<int>(ceil(invScale)) + 1;
+      const cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01);
+
+      for(size_t i = 0, size = corners.size(); i < size; ++i)
+      {
+        for(size_t j = 0, cornerCount = corners[i].size(); j < cornerCount; ++j)
+        {
+          cv::Point2f& corner = corners[i][j];
+          corner.x = (corner.x + 0.5f) * invScale - 0.5f;
+          corner.y = (corner.y + 0.5f) * invScale - 0.5f;
+        }
+
+        cv::cornerSubPix(greyImage, corners[i], cv::Size(windowHalfSize, windowHalfSize), cv::Size(-1, -1), criteria);
+      }
+    }
+  }
+  else cv::aruco::detectMarkers(rgbImage, dictionary, corners, ids);
 
 #if 0
   // Visualise the detected fiducials for debugging purposes.
@@ -208,7 +246,7 @@ boost::optional<Vector3f> ArUcoFiducialDetector::pick_corner_from_raycast(const
 
   if(!m_picker) m_picker = PickerFactory::make_picker(m_settings->deviceType);
 
-  static boost::shared_ptr<ORUtils::MemoryBlock<Vector3f> > pickPointFloatMB = MemoryBlockFactory::instance().make_block<Vector3f>(1);
+  static boost::shared_ptr<ORUtils::MemoryBlock<Vector3f> > pickPointFloatMB = MemoryBlockFactory::instance().make_block<Vector3f>(1, "ArUcoFiducialDetector");
   bool pickPointFound = m_picker->pick(p.x, p.y, renderState.get(), *pickPointFloatMB);
   if(!pickPointFound) return boost::none;
 
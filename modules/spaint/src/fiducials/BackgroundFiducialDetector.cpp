@@ -0,0 +1,178 @@
+/**
+ * spaint: BackgroundFiducialDetector.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fiducials/BackgroundFiducialDetector.h"
+using namespace ITMLib;
+
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+BackgroundFiducialDetector::BackgroundFiducialDetector(const FiducialDetector_CPtr& innerDetector, ITMLibSettings::DeviceType deviceType)
+: m_deviceType(deviceType),
+  m_droppedSnapshotCount(0),
+  m_innerDetector(innerDetector),
+  m_resetCount(0),
+  m_workerShouldTerminate(false)
+{
+  if(!innerDetector)
+  {
+    throw std::invalid_argument("Error: Cannot initialise a BackgroundFiducialDetector with a NULL fiducial detector");
+  }
+
+  // Start the worker thread.
+  m_worker = boost::thread(boost::bind(&BackgroundFiducialDetector::run_worker, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+BackgroundFiducialDetector::~BackgroundFiducialDetector()
+{
+  // Set the flag that informs the worker thread that it should terminate, and wake it (it might be waiting for work).
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_workerShouldTerminate = true;
+  }
+  m_workAvailable.notify_one();
+
+  // Wait for the worker thread to finish any snapshot it is processing and terminate gracefully.
+  m_worker.join();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t BackgroundFiducialDetector::get_dropped_snapshot_count() const
+{
+  return m_droppedSnapshotCount;
+}
+
+void BackgroundFiducialDetector::reset()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  if(m_pendingSnapshot)
+  {
+    m_freeSnapshots.push_back(*m_pendingSnapshot);
+    m_pendingSnapshot.reset();
+  }
+  m_results.clear();
+  ++m_resetCount;
+}
+
+void BackgroundFiducialDetector::submit(size_t frameIndex, const View_CPtr& view, const ORUtils::SE3Pose& pose, const VoxelRenderState_CPtr& renderState,
+                                        FiducialDetector::PoseEstimationMode poseEstimationMode)
+{
+  // Grab a snapshot into which to copy the inputs. If the worker hasn't yet started on the previous snapshot, we reuse
+  // that one (dropping the frame it contains), since it is more useful for the worker to process the most recent frame.
+  Snapshot snapshot;
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(m_pendingSnapshot)
+    {
+      snapshot = *m_pendingSnapshot;
+      m_pendingSnapshot.reset();
+      ++m_droppedSnapshotCount;
+    }
+    else if(!m_freeSnapshots.empty())
+    {
+      snapshot = m_freeSnapshots.front();
+      m_freeSnapshots.pop_front();
+    }
+  }
+
+  // Copy the inputs (note that no lock is held whilst copying the images).
+  snapshot.frameIndex = frameIndex;
+  snapshot.pose.SetFrom(&pose);
+  snapshot.poseEstimationMode = poseEstimationMode;
+  copy_inputs(view, renderState, snapshot);
+
+  // Publish the snapshot to the worker thread.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_pendingSnapshot = snapshot;
+  }
+  m_workAvailable.notify_one();
+}
+
+std::vector<BackgroundFiducialDetector::Result> BackgroundFiducialDetector::take_results()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  std::vector<Result> results(m_results.begin(), m_results.end());
+  m_results.clear();
+  return results;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void BackgroundFiducialDetector::copy_inputs(const View_CPtr& view, const VoxelRenderState_CPtr& renderState, Snapshot& snapshot) const
+{
+  const bool useCUDA = m_deviceType == ITMLibSettings::DEVICE_CUDA;
+  const MemoryDeviceType memoryType = useCUDA ? MEMORYDEVICE_CUDA : MEMORYDEVICE_CPU;
+
+  // Copy the view (only the colour and depth images and the calibration are needed by the detectors).
+  if(!snapshot.view)
+  {
+    snapshot.view.reset(new ITMView(view->calib, view->rgb->noDims, view->depth->noDims, useCUDA));
+  }
+
+  snapshot.view->calib = view->calib;
+  snapshot.view->rgb->SetFrom(view->rgb, useCUDA ? ITMUChar4Image::CUDA_TO_CUDA : ITMUChar4Image::CPU_TO_CPU);
+  snapshot.view->depth->SetFrom(view->depth, useCUDA ? ITMFloatImage::CUDA_TO_CUDA : ITMFloatImage::CPU_TO_CPU);
+
+  // Copy the scene raycast.
+  const ORUtils::Image<Vector4f> *raycastResult = renderState->raycastResult;
+  if(!snapshot.renderState)
+  {
+    snapshot.renderState.reset(new ITMRenderState(raycastResult->noDims, 0.0f, 0.0f, memoryType));
+  }
+
+  snapshot.renderState->raycastResult->SetFrom(raycastResult, useCUDA ? ORUtils::Image<Vector4f>::CUDA_TO_CUDA : ORUtils::Image<Vector4f>::CPU_TO_CPU);
+}
+
+void BackgroundFiducialDetector::run_worker()
+{
+  for(;;)
+  {
+    // Wait until there is a snapshot to process, or termination is requested.
+    Snapshot snapshot;
+    size_t resetCount;
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(!m_workerShouldTerminate && !m_pendingSnapshot) m_workAvailable.wait(lock);
+
+      // If we were asked to terminate, do so.
+      if(m_workerShouldTerminate) return;
+
+      snapshot = *m_pendingSnapshot;
+      m_pendingSnapshot.reset();
+      resetCount = m_resetCount;
+    }
+
+    // Run the wrapped detector on the snapshot. Any exception is reported on std::cerr, since there is no caller to which to propagate it.
+    Result result;
+    result.frameIndex = snapshot.frameIndex;
+    bool succeeded = true;
+    try
+    {
+      result.measurements = m_innerDetector->detect_fiducials(snapshot.view, snapshot.pose, snapshot.renderState, snapshot.poseEstimationMode);
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+      succeeded = false;
+    }
+
+    // Publish the result (unless the detector was reset whilst it was being computed), and hand back the snapshot's images for reuse.
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(succeeded && resetCount == m_resetCount) m_results.push_back(result);
+    m_freeSnapshots.push_back(snapshot);
+  }
+}
+
+}
@@ -0,0 +1,40 @@
+/**
+ * spaint: BatchedVoxelIntegratorFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/BatchedVoxelIntegratorFactory.h"
+using namespace ITMLib;
+
+#include "fusion/cpu/BatchedVoxelIntegrator_CPU.h"
+
+#ifdef WITH_CUDA
+#include "fusion/cuda/BatchedVoxelIntegrator_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+BatchedVoxelIntegrator_Ptr BatchedVoxelIntegratorFactory::make_batched_voxel_integrator(ITMLibSettings::DeviceType deviceType, int maxFrameCount,
+                                                                                        const Vector2i& depthImageSize, const Vector2i& rgbImageSize)
+{
+  BatchedVoxelIntegrator_Ptr integrator;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    integrator.reset(new BatchedVoxelIntegrator_CUDA(maxFrameCount, depthImageSize, rgbImageSize));
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    integrator.reset(new BatchedVoxelIntegrator_CPU(maxFrameCount, depthImageSize, rgbImageSize));
+  }
+
+  return integrator;
+}
+
+}
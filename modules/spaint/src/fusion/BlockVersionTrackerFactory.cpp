@@ -0,0 +1,39 @@
+/**
+ * spaint: BlockVersionTrackerFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/BlockVersionTrackerFactory.h"
+using namespace ITMLib;
+
+#include "fusion/cpu/BlockVersionTracker_CPU.h"
+
+#ifdef WITH_CUDA
+#include "fusion/cuda/BlockVersionTracker_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+BlockVersionTracker_CPtr BlockVersionTrackerFactory::make_block_version_tracker(ITMLibSettings::DeviceType deviceType)
+{
+  BlockVersionTracker_CPtr tracker;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    tracker.reset(new BlockVersionTracker_CUDA);
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    tracker.reset(new BlockVersionTracker_CPU);
+  }
+
+  return tracker;
+}
+
+}
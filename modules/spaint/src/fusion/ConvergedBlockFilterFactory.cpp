@@ -0,0 +1,40 @@
+/**
+ * spaint: ConvergedBlockFilterFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/ConvergedBlockFilterFactory.h"
+using namespace ITMLib;
+
+#include "fusion/cpu/ConvergedBlockFilter_CPU.h"
+
+#ifdef WITH_CUDA
+#include "fusion/cuda/ConvergedBlockFilter_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+ConvergedBlockFilter_Ptr ConvergedBlockFilterFactory::make_converged_block_filter(ITMLibSettings::DeviceType deviceType, int convergenceFrames,
+                                                                                  float maxSDFChange, float residualThreshold)
+{
+  ConvergedBlockFilter_Ptr filter;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    filter.reset(new ConvergedBlockFilter_CUDA(convergenceFrames, maxSDFChange, residualThreshold));
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    filter.reset(new ConvergedBlockFilter_CPU(convergenceFrames, maxSDFChange, residualThreshold));
+  }
+
+  return filter;
+}
+
+}
@@ -0,0 +1,66 @@
+/**
+ * spaint: SharedVoxelFuser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/SharedVoxelFuser.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <ITMLib/Engines/Reconstruction/ITMSceneReconstructionEngineFactory.h>
+
+#include "fusion/BatchedVoxelIntegratorFactory.h"
+#include "fusion/BlockVersionTrackerFactory.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SharedVoxelFuser::SharedVoxelFuser(const SpaintVoxelScene_Ptr& voxelScene, int sensorCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize,
+                                   ITMLibSettings::DeviceType deviceType)
+: m_batchedVoxelIntegrator(BatchedVoxelIntegratorFactory::make_batched_voxel_integrator(deviceType, sensorCount, depthImageSize, rgbImageSize)),
+  m_blockVersionTracker(BlockVersionTrackerFactory::make_block_version_tracker(deviceType)),
+  m_sceneReconstructionEngine(ITMSceneReconstructionEngineFactory::MakeSceneReconstructionEngine<SpaintVoxel,ITMVoxelIndex>(deviceType)),
+  m_voxelScene(voxelScene)
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SharedVoxelFuser::add_frame(const ITMView *view, const ITMTrackingState *trackingState, ITMRenderState *renderState)
+{
+  if(m_batchedVoxelIntegrator->get_frame_count() == m_batchedVoxelIntegrator->get_max_frame_count())
+  {
+    throw std::runtime_error("Error: Cannot add more than one frame per sensor to a shared voxel scene between flushes");
+  }
+
+  m_sceneReconstructionEngine->AllocateSceneFromDepth(m_voxelScene.get(), view, trackingState, renderState);
+  m_batchedVoxelIntegrator->add_frame(view, trackingState, renderState);
+}
+
+void SharedVoxelFuser::discard()
+{
+  m_batchedVoxelIntegrator->discard();
+}
+
+int SharedVoxelFuser::flush()
+{
+  const int frameCount = m_batchedVoxelIntegrator->flush(m_voxelScene.get());
+
+  // Note: The frames may have changed any block that was visible from any of the sensors, so we conservatively forget the recorded
+  //       block occupancy, and stamp the geometry of every block as changed (as is done when a single sensor's frames are batched).
+  if(frameCount > 0)
+  {
+    m_voxelScene->reset_block_occupancy();
+    m_blockVersionTracker->stamp_all_blocks(m_voxelScene.get(), BlockVersionTracker::VERSION_GEOMETRY);
+  }
+
+  return frameCount;
+}
+
+const SpaintVoxelScene_Ptr& SharedVoxelFuser::get_voxel_scene() const
+{
+  return m_voxelScene;
+}
+
+}
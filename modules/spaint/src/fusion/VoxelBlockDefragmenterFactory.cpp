@@ -0,0 +1,39 @@
+/**
+ * spaint: VoxelBlockDefragmenterFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/VoxelBlockDefragmenterFactory.h"
+using namespace ITMLib;
+
+#include "fusion/cpu/VoxelBlockDefragmenter_CPU.h"
+
+#ifdef WITH_CUDA
+#include "fusion/cuda/VoxelBlockDefragmenter_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+VoxelBlockDefragmenter_CPtr VoxelBlockDefragmenterFactory::make_voxel_block_defragmenter(ITMLibSettings::DeviceType deviceType)
+{
+  VoxelBlockDefragmenter_CPtr defragmenter;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    defragmenter.reset(new VoxelBlockDefragmenter_CUDA);
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    defragmenter.reset(new VoxelBlockDefragmenter_CPU);
+  }
+
+  return defragmenter;
+}
+
+}
@@ -0,0 +1,39 @@
+/**
+ * spaint: VoxelSceneResetterFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/VoxelSceneResetterFactory.h"
+using namespace ITMLib;
+
+#include "fusion/cpu/VoxelSceneResetter_CPU.h"
+
+#ifdef WITH_CUDA
+#include "fusion/cuda/VoxelSceneResetter_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+VoxelSceneResetter_CPtr VoxelSceneResetterFactory::make_voxel_scene_resetter(ITMLibSettings::DeviceType deviceType)
+{
+  VoxelSceneResetter_CPtr resetter;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    resetter.reset(new VoxelSceneResetter_CUDA);
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    resetter.reset(new VoxelSceneResetter_CPU);
+  }
+
+  return resetter;
+}
+
+}
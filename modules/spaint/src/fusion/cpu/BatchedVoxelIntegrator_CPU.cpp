@@ -0,0 +1,90 @@
+/**
+ * spaint: BatchedVoxelIntegrator_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cpu/BatchedVoxelIntegrator_CPU.h"
+using namespace ITMLib;
+
+#include <cstring>
+
+#include "fusion/shared/BatchedVoxelIntegrator_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+BatchedVoxelIntegrator_CPU::BatchedVoxelIntegrator_CPU(int maxFrameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize)
+: BatchedVoxelIntegrator(maxFrameCount, depthImageSize, rgbImageSize)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void BatchedVoxelIntegrator_CPU::copy_frame(int frameIndex, const ITMView *view)
+{
+  const size_t depthArea = view->depth->dataSize;
+  const size_t rgbArea = view->rgb->dataSize;
+  memcpy(m_depthsMB->GetData(MEMORYDEVICE_CPU) + frameIndex * depthArea, view->depth->GetData(MEMORYDEVICE_CPU), depthArea * sizeof(float));
+  memcpy(m_rgbsMB->GetData(MEMORYDEVICE_CPU) + frameIndex * rgbArea, view->rgb->GetData(MEMORYDEVICE_CPU), rgbArea * sizeof(Vector4u));
+}
+
+void BatchedVoxelIntegrator_CPU::flag_visible_entries(const ITMRenderState_VH *renderState)
+{
+  unsigned char *batchEntryFlags = m_batchEntryFlagsMB->GetData(MEMORYDEVICE_CPU);
+  const int *visibleEntryIDs = renderState->GetVisibleEntityIDs();
+  for(int i = 0; i < renderState->noVisibleEntities; ++i)
+  {
+    batchEntryFlags[visibleEntryIDs[i]] = 1;
+  }
+}
+
+int BatchedVoxelIntegrator_CPU::gather_flagged_entries(const SpaintVoxelScene *scene)
+{
+  unsigned char *batchEntryFlags = m_batchEntryFlagsMB->GetData(MEMORYDEVICE_CPU);
+  int *batchEntryIDs = m_batchEntryIDsMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+
+  int entryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    if(!batchEntryFlags[entryID]) continue;
+    if(hashTable[entryID].ptr >= 0) batchEntryIDs[entryCount++] = entryID;
+    batchEntryFlags[entryID] = 0;
+  }
+
+  return entryCount;
+}
+
+void BatchedVoxelIntegrator_CPU::integrate_batch(int entryCount, int frameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize, SpaintVoxelScene *scene)
+{
+  const int *batchEntryIDs = m_batchEntryIDsMB->GetData(MEMORYDEVICE_CPU);
+  const float *depths = m_depthsMB->GetData(MEMORYDEVICE_CPU);
+  const Matrix4f *depthPoses = m_depthPosesMB->GetData(MEMORYDEVICE_CPU);
+  const Vector4f *depthProjParams = m_depthProjParamsMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const int maxW = scene->sceneParams->maxW;
+  const float mu = scene->sceneParams->mu;
+  const Vector4u *rgbs = m_rgbsMB->GetData(MEMORYDEVICE_CPU);
+  const Matrix4f *rgbPoses = m_rgbPosesMB->GetData(MEMORYDEVICE_CPU);
+  const Vector4f *rgbProjParams = m_rgbProjParamsMB->GetData(MEMORYDEVICE_CPU);
+  const bool stopIntegratingAtMaxW = scene->sceneParams->stopIntegratingAtMaxW;
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const float voxelSize = scene->sceneParams->voxelSize;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < entryCount; ++i)
+  {
+    const int entryID = batchEntryIDs[i];
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      integrate_voxel_batch(
+        entryID, linearIdx, hashTable, voxelData, frameCount, depthPoses, depthProjParams, rgbPoses, rgbProjParams,
+        depths, depthImageSize, rgbs, rgbImageSize, voxelSize, mu, maxW, stopIntegratingAtMaxW
+      );
+    }
+  }
+}
+
+}
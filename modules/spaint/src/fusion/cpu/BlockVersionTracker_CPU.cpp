@@ -0,0 +1,59 @@
+/**
+ * spaint: BlockVersionTracker_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cpu/BlockVersionTracker_CPU.h"
+
+#include "fusion/shared/BlockVersionTracker_Shared.h"
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int BlockVersionTracker_CPU::gather_modified_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion, int versionFlags, ORUtils::MemoryBlock<int>& entryIDsMB) const
+{
+  const SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  int *entryIDs = entryIDsMB.GetData(MEMORYDEVICE_CPU);
+
+  int entryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    const int ptr = hashTable[entryID].ptr;
+    if(ptr >= 0 && is_block_modified_since(blockVersions[ptr], sinceVersion, versionFlags)) entryIDs[entryCount++] = entryID;
+  }
+
+  return entryCount;
+}
+
+void BlockVersionTracker_CPU::stamp_all_blocks(unsigned int version, int versionFlags, SpaintVoxelScene *scene) const
+{
+  SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
+  const int blockCount = scene->localVBA.allocatedSize / SDF_BLOCK_SIZE3;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < blockCount; ++i)
+  {
+    stamp_block_versions(version, versionFlags, blockVersions[i]);
+  }
+}
+
+void BlockVersionTracker_CPU::stamp_entries(const int *entryIDs, int entryCount, unsigned int version, int versionFlags, SpaintVoxelScene *scene) const
+{
+  SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < entryCount; ++i)
+  {
+    const int ptr = hashTable[entryIDs[i]].ptr;
+    if(ptr >= 0) stamp_block_versions(version, versionFlags, blockVersions[ptr]);
+  }
+}
+
+}
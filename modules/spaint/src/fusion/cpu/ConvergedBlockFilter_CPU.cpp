@@ -0,0 +1,90 @@
+/**
+ * spaint: ConvergedBlockFilter_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cpu/ConvergedBlockFilter_CPU.h"
+using namespace ITMLib;
+
+#include <cstring>
+
+#include "fusion/shared/ConvergedBlockFilter_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ConvergedBlockFilter_CPU::ConvergedBlockFilter_CPU(int convergenceFrames, float maxSDFChange, float residualThreshold)
+: ConvergedBlockFilter(convergenceFrames, maxSDFChange, residualThreshold)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int ConvergedBlockFilter_CPU::exclude_converged_entries(int visibleEntryCount, const Matrix4f& M, const ITMView *view, const SpaintVoxelScene *scene,
+                                                        ITMRenderState_VH *renderState)
+{
+  int *allVisibleEntryIDs = m_allVisibleEntryIDsMB->GetData(MEMORYDEVICE_CPU);
+  BlockConvergence *blockConvergence = m_blockConvergenceMB->GetData(MEMORYDEVICE_CPU);
+  const float *depth = view->depth->GetData(MEMORYDEVICE_CPU);
+  const Vector2i depthSize = view->depth->noDims;
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const Vector4f projParams = view->calib.intrinsics_d.projectionParamsSimple.all;
+  const Vector4f *raycastResult = renderState->raycastResult->GetData(MEMORYDEVICE_CPU);
+  const Vector2i raycastSize = renderState->raycastResult->noDims;
+  int *visibleEntryIDs = renderState->GetVisibleEntityIDs();
+  const float voxelSize = scene->sceneParams->voxelSize;
+
+  memcpy(allVisibleEntryIDs, visibleEntryIDs, visibleEntryCount * sizeof(int));
+
+  // Compact the list of visible entries in place, preserving the order of the entries that remain.
+  int remainingEntryCount = 0;
+  for(int i = 0; i < visibleEntryCount; ++i)
+  {
+    const int entryID = allVisibleEntryIDs[i];
+    if(should_fuse_entry(entryID, hashTable, blockConvergence, m_convergenceFrames, M, projParams, depth, depthSize, raycastResult, raycastSize, voxelSize, m_residualThreshold))
+    {
+      visibleEntryIDs[remainingEntryCount++] = entryID;
+    }
+  }
+
+  return remainingEntryCount;
+}
+
+void ConvergedBlockFilter_CPU::restore_visible_entries(int visibleEntryCount, ITMRenderState_VH *renderState) const
+{
+  memcpy(renderState->GetVisibleEntityIDs(), m_allVisibleEntryIDsMB->GetData(MEMORYDEVICE_CPU), visibleEntryCount * sizeof(int));
+}
+
+void ConvergedBlockFilter_CPU::update_entries(const int *entryIDs, int entryCount, const SpaintVoxelScene *scene)
+{
+  BlockConvergence *blockConvergence = m_blockConvergenceMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const int maxW = scene->sceneParams->maxW;
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < entryCount; ++i)
+  {
+    const int entryID = entryIDs[i];
+    const ITMHashEntry& hashEntry = hashTable[entryID];
+    if(hashEntry.ptr < 0) continue;
+
+    const SpaintVoxel *blockVoxels = voxelData + hashEntry.ptr * SDF_BLOCK_SIZE3;
+    int observedCount = 0, saturatedCount = 0;
+    float sdfSum = 0.0f;
+    for(int j = 0; j < SDF_BLOCK_SIZE3; ++j)
+    {
+      const SpaintVoxel& voxel = blockVoxels[j];
+      if(voxel.w_depth == 0) continue;
+      ++observedCount;
+      if(voxel.w_depth >= maxW) ++saturatedCount;
+      sdfSum += SpaintVoxel::valueToFloat(voxel.sdf);
+    }
+
+    write_block_convergence(entryID, hashEntry, observedCount, saturatedCount, sdfSum, m_maxSDFChange, blockConvergence);
+  }
+}
+
+}
@@ -0,0 +1,105 @@
+/**
+ * spaint: VoxelBlockDefragmenter_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cpu/VoxelBlockDefragmenter_CPU.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "fusion/shared/VoxelBlockDefragmenter_Shared.h"
+
+namespace spaint {
+
+namespace {
+
+//#################### LOCAL HELPER FUNCTIONS ####################
+
+/**
+ * \brief Moves the elements of a per-block (or per-voxel) array that belong to the relocated voxel blocks into their new slots.
+ *
+ * \param data              The array (may be NULL, in which case nothing is done).
+ * \param elementsPerBlock  The number of elements of the array that belong to each block.
+ * \param srcPtrs           The old slots of the relocated blocks.
+ * \param dstPtrs           The new slots of the relocated blocks.
+ */
+template <typename T>
+void relocate_block_elements(T *data, int elementsPerBlock, const std::vector<int>& srcPtrs, const std::vector<int>& dstPtrs)
+{
+  if(!data) return;
+
+  const int elementCount = static_cast<int>(srcPtrs.size()) * elementsPerBlock;
+  std::vector<T> scratch(elementCount);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < elementCount; ++i)
+  {
+    gather_block_element(i, &srcPtrs[0], elementsPerBlock, data, &scratch[0]);
+  }
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < elementCount; ++i)
+  {
+    scatter_block_element(i, &dstPtrs[0], elementsPerBlock, &scratch[0], data);
+  }
+}
+
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+int VoxelBlockDefragmenter_CPU::defragment_scene(SpaintVoxelScene *scene) const
+{
+  ITMHashEntry *hashTable = scene->index.GetEntries();
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+
+  // Find the hash entries that refer to resident voxel blocks, together with the slots those blocks currently occupy.
+  std::vector<std::pair<unsigned long long,int> > keyedEntryIDs;
+  std::vector<int> dstPtrs;
+  for(int entryID = 0; entryID < noTotalEntries; ++entryID)
+  {
+    const ITMHashEntry& hashEntry = hashTable[entryID];
+    if(hashEntry.ptr >= 0)
+    {
+      keyedEntryIDs.push_back(std::make_pair(make_block_sort_key(hashEntry), entryID));
+      dstPtrs.push_back(hashEntry.ptr);
+    }
+  }
+
+  const int blockCount = static_cast<int>(keyedEntryIDs.size());
+  if(blockCount == 0) return 0;
+
+  // Sort the entries into Morton order, and assign the occupied slots to them in ascending order.
+  std::sort(keyedEntryIDs.begin(), keyedEntryIDs.end());
+  std::sort(dstPtrs.begin(), dstPtrs.end());
+
+  std::vector<int> srcPtrs(blockCount);
+  for(int k = 0; k < blockCount; ++k)
+  {
+    srcPtrs[k] = hashTable[keyedEntryIDs[k].second].ptr;
+  }
+
+  // Move the blocks, together with all of the data that the scene stores for them by slot.
+  relocate_block_elements(scene->localVBA.GetVoxelBlocks(), SDF_BLOCK_SIZE3, srcPtrs, dstPtrs);
+  relocate_block_elements(scene->get_label_data(), SDF_BLOCK_SIZE3, srcPtrs, dstPtrs);
+  relocate_block_elements(scene->get_label_evidence_data(), SDF_BLOCK_SIZE3, srcPtrs, dstPtrs);
+  relocate_block_elements(scene->get_label_presence_data(), SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT, srcPtrs, dstPtrs);
+  relocate_block_elements(scene->get_relabelled_block_flags(), 1, srcPtrs, dstPtrs);
+  relocate_block_elements(scene->get_block_versions(), 1, srcPtrs, dstPtrs);
+
+  // Point the hash entries at the new slots of their blocks.
+  for(int k = 0; k < blockCount; ++k)
+  {
+    hashTable[keyedEntryIDs[k].second].ptr = dstPtrs[k];
+  }
+
+  return blockCount;
+}
+
+}
@@ -0,0 +1,47 @@
+/**
+ * spaint: VoxelSceneResetter_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cpu/VoxelSceneResetter_CPU.h"
+
+#include "fusion/shared/VoxelSceneResetter_Shared.h"
+
+namespace spaint {
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VoxelSceneResetter_CPU::reset_scene(SpaintVoxelScene *scene) const
+{
+  ITMHashEntry *hashTable = scene->index.GetEntries();
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+  // Reset the hash entries, clearing the voxel blocks that are resident as we go.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int entryID = 0; entryID < noTotalEntries; ++entryID)
+  {
+    const int ptr = reset_hash_entry(entryID, hashTable);
+    if(ptr >= 0)
+    {
+      for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+      {
+        clear_voxel(ptr, linearIdx, voxelData);
+      }
+    }
+  }
+
+  // Refill the free lists.
+  const int blockCount = scene->localVBA.allocatedSize / SDF_BLOCK_SIZE3;
+  int *allocationList = scene->localVBA.GetAllocationList();
+  for(int i = 0; i < blockCount; ++i) allocationList[i] = i;
+  scene->localVBA.lastFreeBlockId = blockCount - 1;
+
+  int *excessAllocationList = scene->index.GetExcessAllocationList();
+  for(int i = 0; i < SDF_EXCESS_LIST_SIZE; ++i) excessAllocationList[i] = i;
+  scene->index.SetLastFreeExcessListId(SDF_EXCESS_LIST_SIZE - 1);
+}
+
+}
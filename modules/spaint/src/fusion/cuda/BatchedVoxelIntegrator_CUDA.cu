@@ -0,0 +1,133 @@
+/**
+ * spaint: BatchedVoxelIntegrator_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cuda/BatchedVoxelIntegrator_CUDA.h"
+using namespace ITMLib;
+
+#include <ORUtils/CUDADefines.h>
+
+#include "fusion/shared/BatchedVoxelIntegrator_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_flag_visible_entries(const int *visibleEntryIDs, int visibleEntryCount, unsigned char *batchEntryFlags)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < visibleEntryCount) batchEntryFlags[visibleEntryIDs[i]] = 1;
+}
+
+__global__ void ck_gather_flagged_entries(const ITMHashEntry *hashTable, int noTotalEntries, unsigned char *batchEntryFlags, int *batchEntryIDs, int *batchEntryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < noTotalEntries && batchEntryFlags[entryID])
+  {
+    if(hashTable[entryID].ptr >= 0) batchEntryIDs[atomicAdd(batchEntryCount, 1)] = entryID;
+    batchEntryFlags[entryID] = 0;
+  }
+}
+
+__global__ void ck_integrate_batch(const int *batchEntryIDs, const ITMHashEntry *hashTable, SpaintVoxel *voxelData, int frameCount,
+                                   const Matrix4f *depthPoses, const Vector4f *depthProjParams, const Matrix4f *rgbPoses, const Vector4f *rgbProjParams,
+                                   const float *depths, Vector2i depthImageSize, const Vector4u *rgbs, Vector2i rgbImageSize,
+                                   float voxelSize, float mu, int maxW, bool stopIntegratingAtMaxW)
+{
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+  integrate_voxel_batch(
+    batchEntryIDs[blockIdx.x], linearIdx, hashTable, voxelData, frameCount, depthPoses, depthProjParams, rgbPoses, rgbProjParams,
+    depths, depthImageSize, rgbs, rgbImageSize, voxelSize, mu, maxW, stopIntegratingAtMaxW
+  );
+}
+
+//#################### CONSTRUCTORS ####################
+
+BatchedVoxelIntegrator_CUDA::BatchedVoxelIntegrator_CUDA(int maxFrameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize)
+: BatchedVoxelIntegrator(maxFrameCount, depthImageSize, rgbImageSize)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void BatchedVoxelIntegrator_CUDA::copy_frame(int frameIndex, const ITMView *view)
+{
+  const size_t depthArea = view->depth->dataSize;
+  const size_t rgbArea = view->rgb->dataSize;
+
+  ORcudaSafeCall(cudaMemcpy(
+    m_depthsMB->GetData(MEMORYDEVICE_CUDA) + frameIndex * depthArea,
+    view->depth->GetData(MEMORYDEVICE_CUDA),
+    depthArea * sizeof(float),
+    cudaMemcpyDeviceToDevice
+  ));
+
+  ORcudaSafeCall(cudaMemcpy(
+    m_rgbsMB->GetData(MEMORYDEVICE_CUDA) + frameIndex * rgbArea,
+    view->rgb->GetData(MEMORYDEVICE_CUDA),
+    rgbArea * sizeof(Vector4u),
+    cudaMemcpyDeviceToDevice
+  ));
+}
+
+void BatchedVoxelIntegrator_CUDA::flag_visible_entries(const ITMRenderState_VH *renderState)
+{
+  const int visibleEntryCount = renderState->noVisibleEntities;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (visibleEntryCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_flag_visible_entries<<<numBlocks,threadsPerBlock>>>(
+    renderState->GetVisibleEntityIDs(),
+    visibleEntryCount,
+    m_batchEntryFlagsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+int BatchedVoxelIntegrator_CUDA::gather_flagged_entries(const SpaintVoxelScene *scene)
+{
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_batchEntryCountMB->Clear();
+
+  ck_gather_flagged_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    noTotalEntries,
+    m_batchEntryFlagsMB->GetData(MEMORYDEVICE_CUDA),
+    m_batchEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_batchEntryCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_batchEntryCountMB->UpdateHostFromDevice();
+  return *m_batchEntryCountMB->GetData(MEMORYDEVICE_CPU);
+}
+
+void BatchedVoxelIntegrator_CUDA::integrate_batch(int entryCount, int frameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize, SpaintVoxelScene *scene)
+{
+  dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+  dim3 gridSize(entryCount);
+
+  ck_integrate_batch<<<gridSize,cudaBlockSize>>>(
+    m_batchEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    frameCount,
+    m_depthPosesMB->GetData(MEMORYDEVICE_CUDA),
+    m_depthProjParamsMB->GetData(MEMORYDEVICE_CUDA),
+    m_rgbPosesMB->GetData(MEMORYDEVICE_CUDA),
+    m_rgbProjParamsMB->GetData(MEMORYDEVICE_CUDA),
+    m_depthsMB->GetData(MEMORYDEVICE_CUDA),
+    depthImageSize,
+    m_rgbsMB->GetData(MEMORYDEVICE_CUDA),
+    rgbImageSize,
+    scene->sceneParams->voxelSize,
+    scene->sceneParams->mu,
+    scene->sceneParams->maxW,
+    scene->sceneParams->stopIntegratingAtMaxW
+  );
+}
+
+}
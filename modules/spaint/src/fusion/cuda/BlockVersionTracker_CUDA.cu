@@ -0,0 +1,85 @@
+/**
+ * spaint: BlockVersionTracker_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cuda/BlockVersionTracker_CUDA.h"
+
+#include "fusion/shared/BlockVersionTracker_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_gather_modified_entries(const ITMHashEntry *hashTable, int noTotalEntries, const SpaintVoxelScene::BlockVersions *blockVersions,
+                                           unsigned int sinceVersion, int versionFlags, int *entryIDs, int *entryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < noTotalEntries)
+  {
+    const int ptr = hashTable[entryID].ptr;
+    if(ptr >= 0 && is_block_modified_since(blockVersions[ptr], sinceVersion, versionFlags)) entryIDs[atomicAdd(entryCount, 1)] = entryID;
+  }
+}
+
+__global__ void ck_stamp_all_blocks(int blockCount, unsigned int version, int versionFlags, SpaintVoxelScene::BlockVersions *blockVersions)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < blockCount) stamp_block_versions(version, versionFlags, blockVersions[i]);
+}
+
+__global__ void ck_stamp_entries(const int *entryIDs, int entryCount, const ITMHashEntry *hashTable, unsigned int version, int versionFlags,
+                                 SpaintVoxelScene::BlockVersions *blockVersions)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < entryCount)
+  {
+    const int ptr = hashTable[entryIDs[i]].ptr;
+    if(ptr >= 0) stamp_block_versions(version, versionFlags, blockVersions[ptr]);
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int BlockVersionTracker_CUDA::gather_modified_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion, int versionFlags, ORUtils::MemoryBlock<int>& entryIDsMB) const
+{
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_countMB->Clear();
+
+  ck_gather_modified_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    noTotalEntries,
+    scene->get_block_versions(),
+    sinceVersion,
+    versionFlags,
+    entryIDsMB.GetData(MEMORYDEVICE_CUDA),
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_countMB->UpdateHostFromDevice();
+  return *m_countMB->GetData(MEMORYDEVICE_CPU);
+}
+
+void BlockVersionTracker_CUDA::stamp_all_blocks(unsigned int version, int versionFlags, SpaintVoxelScene *scene) const
+{
+  const int blockCount = scene->localVBA.allocatedSize / SDF_BLOCK_SIZE3;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (blockCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_stamp_all_blocks<<<numBlocks,threadsPerBlock>>>(blockCount, version, versionFlags, scene->get_block_versions());
+}
+
+void BlockVersionTracker_CUDA::stamp_entries(const int *entryIDs, int entryCount, unsigned int version, int versionFlags, SpaintVoxelScene *scene) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (entryCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_stamp_entries<<<numBlocks,threadsPerBlock>>>(entryIDs, entryCount, scene->index.GetEntries(), version, versionFlags, scene->get_block_versions());
+}
+
+}
@@ -0,0 +1,136 @@
+/**
+ * spaint: ConvergedBlockFilter_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cuda/ConvergedBlockFilter_CUDA.h"
+using namespace ITMLib;
+
+#include <ORUtils/CUDADefines.h>
+
+#include "fusion/shared/ConvergedBlockFilter_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_exclude_converged_entries(const int *allVisibleEntryIDs, int visibleEntryCount, const ITMHashEntry *hashTable,
+                                             ConvergedBlockFilter::BlockConvergence *blockConvergence, int convergenceFrames, Matrix4f M,
+                                             Vector4f projParams, const float *depth, Vector2i depthSize, const Vector4f *raycastResult,
+                                             Vector2i raycastSize, float voxelSize, float residualThreshold, int *visibleEntryIDs, int *remainingEntryCount)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < visibleEntryCount)
+  {
+    const int entryID = allVisibleEntryIDs[i];
+    if(should_fuse_entry(entryID, hashTable, blockConvergence, convergenceFrames, M, projParams, depth, depthSize, raycastResult, raycastSize, voxelSize, residualThreshold))
+    {
+      visibleEntryIDs[atomicAdd(remainingEntryCount, 1)] = entryID;
+    }
+  }
+}
+
+__global__ void ck_update_block_convergence(const int *entryIDs, const ITMHashEntry *hashTable, const SpaintVoxel *voxelData, int maxW, float maxSDFChange,
+                                            ConvergedBlockFilter::BlockConvergence *blockConvergence)
+{
+  __shared__ int observedCount, saturatedCount;
+  __shared__ float sdfSum;
+
+  // Note: Each thread block examines a single voxel block, so this early out is taken either by all of its threads or by none of them.
+  const int entryID = entryIDs[blockIdx.x];
+  const ITMHashEntry& hashEntry = hashTable[entryID];
+  if(hashEntry.ptr < 0) return;
+
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+  if(linearIdx == 0)
+  {
+    observedCount = saturatedCount = 0;
+    sdfSum = 0.0f;
+  }
+  __syncthreads();
+
+  const SpaintVoxel& voxel = voxelData[hashEntry.ptr * SDF_BLOCK_SIZE3 + linearIdx];
+  if(voxel.w_depth > 0)
+  {
+    atomicAdd(&observedCount, 1);
+    if(voxel.w_depth >= maxW) atomicAdd(&saturatedCount, 1);
+    atomicAdd(&sdfSum, SpaintVoxel::valueToFloat(voxel.sdf));
+  }
+  __syncthreads();
+
+  if(linearIdx == 0) write_block_convergence(entryID, hashEntry, observedCount, saturatedCount, sdfSum, maxSDFChange, blockConvergence);
+}
+
+//#################### CONSTRUCTORS ####################
+
+ConvergedBlockFilter_CUDA::ConvergedBlockFilter_CUDA(int convergenceFrames, float maxSDFChange, float residualThreshold)
+: ConvergedBlockFilter(convergenceFrames, maxSDFChange, residualThreshold)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int ConvergedBlockFilter_CUDA::exclude_converged_entries(int visibleEntryCount, const Matrix4f& M, const ITMView *view, const SpaintVoxelScene *scene,
+                                                         ITMRenderState_VH *renderState)
+{
+  int *visibleEntryIDs = renderState->GetVisibleEntityIDs();
+
+  ORcudaSafeCall(cudaMemcpy(
+    m_allVisibleEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    visibleEntryIDs,
+    visibleEntryCount * sizeof(int),
+    cudaMemcpyDeviceToDevice
+  ));
+
+  int threadsPerBlock = 256;
+  int numBlocks = (visibleEntryCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_remainingEntryCountMB->Clear();
+
+  ck_exclude_converged_entries<<<numBlocks,threadsPerBlock>>>(
+    m_allVisibleEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    visibleEntryCount,
+    scene->index.GetEntries(),
+    m_blockConvergenceMB->GetData(MEMORYDEVICE_CUDA),
+    m_convergenceFrames,
+    M,
+    view->calib.intrinsics_d.projectionParamsSimple.all,
+    view->depth->GetData(MEMORYDEVICE_CUDA),
+    view->depth->noDims,
+    renderState->raycastResult->GetData(MEMORYDEVICE_CUDA),
+    renderState->raycastResult->noDims,
+    scene->sceneParams->voxelSize,
+    m_residualThreshold,
+    visibleEntryIDs,
+    m_remainingEntryCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_remainingEntryCountMB->UpdateHostFromDevice();
+  return *m_remainingEntryCountMB->GetData(MEMORYDEVICE_CPU);
+}
+
+void ConvergedBlockFilter_CUDA::restore_visible_entries(int visibleEntryCount, ITMRenderState_VH *renderState) const
+{
+  ORcudaSafeCall(cudaMemcpy(
+    renderState->GetVisibleEntityIDs(),
+    m_allVisibleEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    visibleEntryCount * sizeof(int),
+    cudaMemcpyDeviceToDevice
+  ));
+}
+
+void ConvergedBlockFilter_CUDA::update_entries(const int *entryIDs, int entryCount, const SpaintVoxelScene *scene)
+{
+  dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+  dim3 gridSize(entryCount);
+
+  ck_update_block_convergence<<<gridSize,cudaBlockSize>>>(
+    entryIDs,
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->sceneParams->maxW,
+    m_maxSDFChange,
+    m_blockConvergenceMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,157 @@
+/**
+ * spaint: VoxelBlockDefragmenter_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cuda/VoxelBlockDefragmenter_CUDA.h"
+
+#include <algorithm>
+
+#include <thrust/device_ptr.h>
+#include <thrust/sort.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "fusion/shared/VoxelBlockDefragmenter_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_collect_resident_entries(const ITMHashEntry *hashTable, int noTotalEntries, int *entryIDs, unsigned long long *keys, int *dstPtrs,
+                                            int *residentBlockCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < noTotalEntries)
+  {
+    const ITMHashEntry& hashEntry = hashTable[entryID];
+    if(hashEntry.ptr >= 0)
+    {
+      const int k = atomicAdd(residentBlockCount, 1);
+      entryIDs[k] = entryID;
+      keys[k] = make_block_sort_key(hashEntry);
+      dstPtrs[k] = hashEntry.ptr;
+    }
+  }
+}
+
+template <typename T>
+__global__ void ck_gather_block_elements(const int *srcPtrs, int elementsPerBlock, int elementCount, const T *data, T *scratch)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < elementCount) gather_block_element(i, srcPtrs, elementsPerBlock, data, scratch);
+}
+
+__global__ void ck_lookup_src_ptrs(const int *entryIDs, int blockCount, const ITMHashEntry *hashTable, int *srcPtrs)
+{
+  int k = threadIdx.x + blockDim.x * blockIdx.x;
+  if(k < blockCount) srcPtrs[k] = hashTable[entryIDs[k]].ptr;
+}
+
+template <typename T>
+__global__ void ck_scatter_block_elements(const int *dstPtrs, int elementsPerBlock, int elementCount, const T *scratch, T *data)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < elementCount) scatter_block_element(i, dstPtrs, elementsPerBlock, scratch, data);
+}
+
+__global__ void ck_update_ptrs(const int *entryIDs, const int *dstPtrs, int blockCount, ITMHashEntry *hashTable)
+{
+  int k = threadIdx.x + blockDim.x * blockIdx.x;
+  if(k < blockCount) hashTable[entryIDs[k]].ptr = dstPtrs[k];
+}
+
+//#################### LOCAL HELPER FUNCTIONS ####################
+
+/**
+ * \brief Moves the elements of a per-block (or per-voxel) array on the device that belong to the relocated voxel blocks into their new slots.
+ *
+ * \param data              The array (may be NULL, in which case nothing is done).
+ * \param elementsPerBlock  The number of elements of the array that belong to each block.
+ * \param srcPtrs           The old slots of the relocated blocks.
+ * \param dstPtrs           The new slots of the relocated blocks.
+ * \param blockCount        The number of relocated blocks.
+ * \param scratchMB         A device-only scratch memory block that is large enough to hold the elements of all of the relocated blocks.
+ */
+template <typename T>
+void relocate_block_elements(T *data, int elementsPerBlock, const int *srcPtrs, const int *dstPtrs, int blockCount, ORUtils::MemoryBlock<unsigned char>& scratchMB)
+{
+  if(!data) return;
+
+  const int elementCount = blockCount * elementsPerBlock;
+  T *scratch = reinterpret_cast<T*>(scratchMB.GetData(MEMORYDEVICE_CUDA));
+
+  int threadsPerBlock = 256;
+  int numBlocks = (elementCount + threadsPerBlock - 1) / threadsPerBlock;
+  ck_gather_block_elements<<<numBlocks,threadsPerBlock>>>(srcPtrs, elementsPerBlock, elementCount, data, scratch);
+  ck_scatter_block_elements<<<numBlocks,threadsPerBlock>>>(dstPtrs, elementsPerBlock, elementCount, scratch, data);
+}
+
+//#################### CONSTRUCTORS ####################
+
+VoxelBlockDefragmenter_CUDA::VoxelBlockDefragmenter_CUDA()
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_dstPtrsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "VoxelBlockDefragmenter");
+  m_entryIDsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "VoxelBlockDefragmenter");
+  m_keysMB = mbf.make_block<unsigned long long>(SDF_LOCAL_BLOCK_NUM, "VoxelBlockDefragmenter");
+  m_residentBlockCountMB = mbf.make_block<int>(1, "VoxelBlockDefragmenter");
+  m_srcPtrsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "VoxelBlockDefragmenter");
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+int VoxelBlockDefragmenter_CUDA::defragment_scene(SpaintVoxelScene *scene) const
+{
+  ITMHashEntry *hashTable = scene->index.GetEntries();
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+  int *dstPtrs = m_dstPtrsMB->GetData(MEMORYDEVICE_CUDA);
+  int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CUDA);
+  unsigned long long *keys = m_keysMB->GetData(MEMORYDEVICE_CUDA);
+  int *srcPtrs = m_srcPtrsMB->GetData(MEMORYDEVICE_CUDA);
+
+  int threadsPerBlock = 256;
+
+  // Compact the hash entries that refer to resident voxel blocks into a list, together with the slots those blocks currently occupy.
+  m_residentBlockCountMB->Clear();
+
+  int numBlocks = (noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+  ck_collect_resident_entries<<<numBlocks,threadsPerBlock>>>(
+    hashTable, noTotalEntries, entryIDs, keys, dstPtrs, m_residentBlockCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_residentBlockCountMB->UpdateHostFromDevice();
+  const int blockCount = *m_residentBlockCountMB->GetData(MEMORYDEVICE_CPU);
+  if(blockCount == 0) return 0;
+
+  // Sort the entries into Morton order, and assign the occupied slots to them in ascending order. Blocks have distinct
+  // positions, and hence distinct keys, so the order in which the entries were compacted does not affect the result.
+  thrust::device_ptr<unsigned long long> keysPtr(keys);
+  thrust::device_ptr<int> entryIDsPtr(entryIDs);
+  thrust::device_ptr<int> dstPtrsPtr(dstPtrs);
+  thrust::sort_by_key(keysPtr, keysPtr + blockCount, entryIDsPtr);
+  thrust::sort(dstPtrsPtr, dstPtrsPtr + blockCount);
+
+  numBlocks = (blockCount + threadsPerBlock - 1) / threadsPerBlock;
+  ck_lookup_src_ptrs<<<numBlocks,threadsPerBlock>>>(entryIDs, blockCount, hashTable, srcPtrs);
+
+  // Move the blocks, together with all of the data that the scene stores for them by slot. The scratch memory is only
+  // needed for the duration of the pass, so (unlike the other memory blocks) it is allocated on the device for each pass.
+  const size_t maxElementSize = std::max(sizeof(SpaintVoxel), std::max(sizeof(SpaintVoxel::LabelEvidence), sizeof(SpaintVoxelScene::BlockVersions)));
+  ORUtils::MemoryBlock<unsigned char> scratchMB(blockCount * SDF_BLOCK_SIZE3 * maxElementSize, false, true);
+
+  relocate_block_elements(scene->localVBA.GetVoxelBlocks(), SDF_BLOCK_SIZE3, srcPtrs, dstPtrs, blockCount, scratchMB);
+  relocate_block_elements(scene->get_label_data(), SDF_BLOCK_SIZE3, srcPtrs, dstPtrs, blockCount, scratchMB);
+  relocate_block_elements(scene->get_label_evidence_data(), SDF_BLOCK_SIZE3, srcPtrs, dstPtrs, blockCount, scratchMB);
+  relocate_block_elements(scene->get_label_presence_data(), SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT, srcPtrs, dstPtrs, blockCount, scratchMB);
+  relocate_block_elements(scene->get_relabelled_block_flags(), 1, srcPtrs, dstPtrs, blockCount, scratchMB);
+  relocate_block_elements(scene->get_block_versions(), 1, srcPtrs, dstPtrs, blockCount, scratchMB);
+
+  // Point the hash entries at the new slots of their blocks.
+  ck_update_ptrs<<<numBlocks,threadsPerBlock>>>(entryIDs, dstPtrs, blockCount, hashTable);
+
+  return blockCount;
+}
+
+}
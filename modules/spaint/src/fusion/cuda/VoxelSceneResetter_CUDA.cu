@@ -0,0 +1,90 @@
+/**
+ * spaint: VoxelSceneResetter_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/cuda/VoxelSceneResetter_CUDA.h"
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "fusion/shared/VoxelSceneResetter_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_clear_voxel_blocks(const int *residentBlockPtrs, SpaintVoxel *voxelData)
+{
+  // Note: Each thread block clears a single voxel block.
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+  clear_voxel(residentBlockPtrs[blockIdx.x], linearIdx, voxelData);
+}
+
+__global__ void ck_fill_identity(int *list, int size)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < size) list[i] = i;
+}
+
+__global__ void ck_reset_hash_entries(ITMHashEntry *hashTable, int noTotalEntries, int *residentBlockPtrs, int *residentBlockCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < noTotalEntries)
+  {
+    const int ptr = reset_hash_entry(entryID, hashTable);
+    if(ptr >= 0) residentBlockPtrs[atomicAdd(residentBlockCount, 1)] = ptr;
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+VoxelSceneResetter_CUDA::VoxelSceneResetter_CUDA()
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_residentBlockCountMB = mbf.make_block<int>(1, "VoxelSceneResetter");
+  m_residentBlockPtrsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "VoxelSceneResetter");
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VoxelSceneResetter_CUDA::reset_scene(SpaintVoxelScene *scene) const
+{
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+  const int blockCount = scene->localVBA.allocatedSize / SDF_BLOCK_SIZE3;
+
+  int threadsPerBlock = 256;
+
+  // Reset the hash entries, compacting the indices of the resident voxel blocks into a list as we go.
+  m_residentBlockCountMB->Clear();
+
+  int numBlocks = (noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+  ck_reset_hash_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    noTotalEntries,
+    m_residentBlockPtrsMB->GetData(MEMORYDEVICE_CUDA),
+    m_residentBlockCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_residentBlockCountMB->UpdateHostFromDevice();
+  const int residentBlockCount = *m_residentBlockCountMB->GetData(MEMORYDEVICE_CPU);
+
+  // Clear the resident voxel blocks.
+  if(residentBlockCount > 0)
+  {
+    dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+    dim3 gridSize(residentBlockCount);
+    ck_clear_voxel_blocks<<<gridSize,cudaBlockSize>>>(m_residentBlockPtrsMB->GetData(MEMORYDEVICE_CUDA), scene->localVBA.GetVoxelBlocks());
+  }
+
+  // Refill the free lists.
+  numBlocks = (blockCount + threadsPerBlock - 1) / threadsPerBlock;
+  ck_fill_identity<<<numBlocks,threadsPerBlock>>>(scene->localVBA.GetAllocationList(), blockCount);
+  scene->localVBA.lastFreeBlockId = blockCount - 1;
+
+  numBlocks = (SDF_EXCESS_LIST_SIZE + threadsPerBlock - 1) / threadsPerBlock;
+  ck_fill_identity<<<numBlocks,threadsPerBlock>>>(scene->index.GetExcessAllocationList(), SDF_EXCESS_LIST_SIZE);
+  scene->index.SetLastFreeExcessListId(SDF_EXCESS_LIST_SIZE - 1);
+}
+
+}
@@ -0,0 +1,101 @@
+/**
+ * spaint: BatchedVoxelIntegrator.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/interface/BatchedVoxelIntegrator.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+BatchedVoxelIntegrator::BatchedVoxelIntegrator(int maxFrameCount, const Vector2i& depthImageSize, const Vector2i& rgbImageSize)
+: m_maxFrameCount(maxFrameCount), m_depthImageSize(depthImageSize), m_frameCount(0), m_rgbImageSize(rgbImageSize)
+{
+  if(maxFrameCount < 1) throw std::invalid_argument("Error: The maximum number of frames in a batch must be at least 1");
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_batchEntryCountMB = mbf.make_block<int>(1, "BatchedVoxelIntegrator");
+  m_batchEntryFlagsMB = mbf.make_block<unsigned char>(ITMVoxelBlockHash::noTotalEntries, "BatchedVoxelIntegrator");
+  m_batchEntryIDsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "BatchedVoxelIntegrator");
+  m_depthsMB = mbf.make_block<float>(maxFrameCount * depthImageSize.x * depthImageSize.y, "BatchedVoxelIntegrator");
+  m_depthPosesMB = mbf.make_block<Matrix4f>(maxFrameCount, "BatchedVoxelIntegrator");
+  m_depthProjParamsMB = mbf.make_block<Vector4f>(maxFrameCount, "BatchedVoxelIntegrator");
+  m_rgbsMB = mbf.make_block<Vector4u>(maxFrameCount * rgbImageSize.x * rgbImageSize.y, "BatchedVoxelIntegrator");
+  m_rgbPosesMB = mbf.make_block<Matrix4f>(maxFrameCount, "BatchedVoxelIntegrator");
+  m_rgbProjParamsMB = mbf.make_block<Vector4f>(maxFrameCount, "BatchedVoxelIntegrator");
+
+  m_batchEntryFlagsMB->Clear();
+}
+
+//#################### DESTRUCTOR ####################
+
+BatchedVoxelIntegrator::~BatchedVoxelIntegrator() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+bool BatchedVoxelIntegrator::add_frame(const ITMView *view, const ITMTrackingState *trackingState, const ITMRenderState *renderState)
+{
+  if(m_frameCount == m_maxFrameCount) throw std::runtime_error("Error: Cannot add a frame to a batch that is already full");
+  if(view->depth->noDims != m_depthImageSize || view->rgb->noDims != m_rgbImageSize)
+  {
+    throw std::runtime_error("Error: The frame's images are not the size expected by the batched voxel integrator");
+  }
+
+  // Record the frame's poses and intrinsics (which can differ between frames from different sensors), and copy its images into the batch.
+  const Matrix4f M_d = trackingState->pose_d->GetM();
+  m_depthPosesMB->GetData(MEMORYDEVICE_CPU)[m_frameCount] = M_d;
+  m_depthProjParamsMB->GetData(MEMORYDEVICE_CPU)[m_frameCount] = view->calib.intrinsics_d.projectionParamsSimple.all;
+  m_rgbPosesMB->GetData(MEMORYDEVICE_CPU)[m_frameCount] = view->calib.trafo_rgb_to_depth.calib_inv * M_d;
+  m_rgbProjParamsMB->GetData(MEMORYDEVICE_CPU)[m_frameCount] = view->calib.intrinsics_rgb.projectionParamsSimple.all;
+  copy_frame(m_frameCount, view);
+
+  // Add the blocks that are visible in the frame to those the batch needs to integrate.
+  const ITMRenderState_VH *renderStateVH = dynamic_cast<const ITMRenderState_VH*>(renderState);
+  if(renderStateVH && renderStateVH->noVisibleEntities > 0) flag_visible_entries(renderStateVH);
+
+  return ++m_frameCount == m_maxFrameCount;
+}
+
+void BatchedVoxelIntegrator::discard()
+{
+  m_batchEntryFlagsMB->Clear();
+  m_frameCount = 0;
+}
+
+int BatchedVoxelIntegrator::flush(SpaintVoxelScene *scene)
+{
+  const int frameCount = m_frameCount;
+  if(frameCount == 0) return 0;
+
+  const int entryCount = gather_flagged_entries(scene);
+  if(entryCount > 0)
+  {
+    m_depthPosesMB->UpdateDeviceFromHost();
+    m_depthProjParamsMB->UpdateDeviceFromHost();
+    m_rgbPosesMB->UpdateDeviceFromHost();
+    m_rgbProjParamsMB->UpdateDeviceFromHost();
+    integrate_batch(entryCount, frameCount, m_depthImageSize, m_rgbImageSize, scene);
+  }
+
+  m_frameCount = 0;
+  return frameCount;
+}
+
+int BatchedVoxelIntegrator::get_frame_count() const
+{
+  return m_frameCount;
+}
+
+int BatchedVoxelIntegrator::get_max_frame_count() const
+{
+  return m_maxFrameCount;
+}
+
+}
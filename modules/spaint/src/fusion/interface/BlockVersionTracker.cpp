@@ -0,0 +1,64 @@
+/**
+ * spaint: BlockVersionTracker.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/interface/BlockVersionTracker.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+BlockVersionTracker::BlockVersionTracker()
+: m_countMB(MemoryBlockFactory::instance().make_block<int>(1, "BlockVersionTracker"))
+{}
+
+//#################### DESTRUCTOR ####################
+
+BlockVersionTracker::~BlockVersionTracker() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+int BlockVersionTracker::find_modified_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion, int versionFlags, ORUtils::MemoryBlock<int>& entryIDsMB) const
+{
+  if(entryIDsMB.dataSize < static_cast<size_t>(SDF_LOCAL_BLOCK_NUM))
+  {
+    throw std::invalid_argument("Error: The memory block in which to store the modified entries must be able to hold an entry for every voxel block");
+  }
+
+  // If nothing has changed since the specified version, early out.
+  if(sinceVersion >= scene->get_version()) return 0;
+
+  return gather_modified_entries(scene, sinceVersion, versionFlags, entryIDsMB);
+}
+
+unsigned int BlockVersionTracker::stamp_all_blocks(SpaintVoxelScene *scene, int versionFlags) const
+{
+  const unsigned int version = scene->advance_version();
+  stamp_all_blocks(version, versionFlags, scene);
+  return version;
+}
+
+unsigned int BlockVersionTracker::stamp_visible_blocks(SpaintVoxelScene *scene, const ITMRenderState *renderState, int versionFlags) const
+{
+  const unsigned int version = scene->advance_version();
+
+  // Note: The visible entries of the live render state are the voxel blocks into which the most recent frame was fused.
+  const ITMRenderState_VH *renderStateVH = dynamic_cast<const ITMRenderState_VH*>(renderState);
+  if(renderStateVH && renderStateVH->noVisibleEntities > 0)
+  {
+    stamp_entries(renderStateVH->GetVisibleEntityIDs(), renderStateVH->noVisibleEntities, version, versionFlags, scene);
+  }
+
+  return version;
+}
+
+}
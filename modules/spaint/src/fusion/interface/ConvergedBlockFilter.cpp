@@ -0,0 +1,87 @@
+/**
+ * spaint: ConvergedBlockFilter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "fusion/interface/ConvergedBlockFilter.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ConvergedBlockFilter::ConvergedBlockFilter(int convergenceFrames, float maxSDFChange, float residualThreshold)
+: m_convergenceFrames(convergenceFrames),
+  m_maxSDFChange(maxSDFChange),
+  m_residualThreshold(residualThreshold),
+  m_allVisibleEntryCount(-1),
+  m_skippedBlockCount(0)
+{
+  if(convergenceFrames < 1 || convergenceFrames > 255)
+  {
+    throw std::invalid_argument("Error: The number of convergence frames must be in the range [1,255]");
+  }
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_allVisibleEntryIDsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "ConvergedBlockFilter");
+  m_blockConvergenceMB = mbf.make_block<BlockConvergence>(ITMVoxelBlockHash::noTotalEntries, "ConvergedBlockFilter");
+  m_remainingEntryCountMB = mbf.make_block<int>(1, "ConvergedBlockFilter");
+
+  reset();
+}
+
+//#################### DESTRUCTOR ####################
+
+ConvergedBlockFilter::~ConvergedBlockFilter() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ConvergedBlockFilter::exclude_converged_blocks(const ITMView *view, const ITMTrackingState *trackingState, const SpaintVoxelScene *scene, ITMRenderState *renderState)
+{
+  ITMRenderState_VH *renderStateVH = dynamic_cast<ITMRenderState_VH*>(renderState);
+  if(!renderStateVH) return;
+
+  const int visibleEntryCount = renderStateVH->noVisibleEntities;
+  if(visibleEntryCount == 0)
+  {
+    m_skippedBlockCount = 0;
+    return;
+  }
+
+  const int remainingEntryCount = exclude_converged_entries(visibleEntryCount, trackingState->pose_d->GetM(), view, scene, renderStateVH);
+
+  m_allVisibleEntryCount = visibleEntryCount;
+  m_skippedBlockCount = visibleEntryCount - remainingEntryCount;
+  renderStateVH->noVisibleEntities = remainingEntryCount;
+}
+
+void ConvergedBlockFilter::finish_integration(const SpaintVoxelScene *scene, ITMRenderState *renderState)
+{
+  ITMRenderState_VH *renderStateVH = dynamic_cast<ITMRenderState_VH*>(renderState);
+  if(!renderStateVH || m_allVisibleEntryCount < 0) return;
+
+  // Update the convergence records of the blocks that were fused, and then put the converged blocks back into the visible list.
+  if(renderStateVH->noVisibleEntities > 0) update_entries(renderStateVH->GetVisibleEntityIDs(), renderStateVH->noVisibleEntities, scene);
+  restore_visible_entries(m_allVisibleEntryCount, renderStateVH);
+
+  renderStateVH->noVisibleEntities = m_allVisibleEntryCount;
+  m_allVisibleEntryCount = -1;
+}
+
+int ConvergedBlockFilter::get_skipped_block_count() const
+{
+  return m_skippedBlockCount;
+}
+
+void ConvergedBlockFilter::reset()
+{
+  m_blockConvergenceMB->Clear();
+  m_skippedBlockCount = 0;
+}
+
+}
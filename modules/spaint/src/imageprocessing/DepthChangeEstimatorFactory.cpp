@@ -0,0 +1,40 @@
+/**
+ * spaint: DepthChangeEstimatorFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/DepthChangeEstimatorFactory.h"
+using namespace ITMLib;
+
+#include "imageprocessing/cpu/DepthChangeEstimator_CPU.h"
+
+#ifdef WITH_CUDA
+#include "imageprocessing/cuda/DepthChangeEstimator_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+DepthChangeEstimator_Ptr DepthChangeEstimatorFactory::make_depth_change_estimator(float changeThreshold, ITMLibSettings::DeviceType deviceType)
+{
+  DepthChangeEstimator_Ptr depthChangeEstimator;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    depthChangeEstimator.reset(new DepthChangeEstimator_CUDA(changeThreshold));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    depthChangeEstimator.reset(new DepthChangeEstimator_CPU(changeThreshold));
+  }
+
+  return depthChangeEstimator;
+}
+
+}
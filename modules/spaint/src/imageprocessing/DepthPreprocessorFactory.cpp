@@ -0,0 +1,41 @@
+/**
+ * spaint: DepthPreprocessorFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/DepthPreprocessorFactory.h"
+using namespace ITMLib;
+
+#include "imageprocessing/cpu/DepthPreprocessor_CPU.h"
+
+#ifdef WITH_CUDA
+#include "imageprocessing/cuda/DepthPreprocessor_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+DepthPreprocessor_Ptr DepthPreprocessorFactory::make_depth_preprocessor(int bilateralRadius, float spatialSigma, float depthSigma, int holeFillRadius,
+                                                                        float holeFillMaxDepthDifference, ITMLibSettings::DeviceType deviceType)
+{
+  DepthPreprocessor_Ptr depthPreprocessor;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    depthPreprocessor.reset(new DepthPreprocessor_CUDA(bilateralRadius, spatialSigma, depthSigma, holeFillRadius, holeFillMaxDepthDifference));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    depthPreprocessor.reset(new DepthPreprocessor_CPU(bilateralRadius, spatialSigma, depthSigma, holeFillRadius, holeFillMaxDepthDifference));
+  }
+
+  return depthPreprocessor;
+}
+
+}
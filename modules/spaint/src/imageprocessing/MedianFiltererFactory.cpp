@@ -0,0 +1,40 @@
+/**
+ * spaint: MedianFiltererFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/MedianFiltererFactory.h"
+using namespace ITMLib;
+
+#include "imageprocessing/cpu/MedianFilterer_CPU.h"
+
+#ifdef WITH_CUDA
+#include "imageprocessing/cuda/MedianFilterer_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+MedianFilterer_CPtr MedianFiltererFactory::make_median_filterer(unsigned int kernelWidth, ITMLibSettings::DeviceType deviceType)
+{
+  MedianFilterer_CPtr medianFilterer;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    medianFilterer.reset(new MedianFilterer_CUDA(kernelWidth));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    medianFilterer.reset(new MedianFilterer_CPU(kernelWidth));
+  }
+
+  return medianFilterer;
+}
+
+}
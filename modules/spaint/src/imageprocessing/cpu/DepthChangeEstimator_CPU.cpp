@@ -0,0 +1,44 @@
+/**
+ * spaint: DepthChangeEstimator_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/cpu/DepthChangeEstimator_CPU.h"
+
+#include "imageprocessing/shared/DepthChangeEstimator_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+DepthChangeEstimator_CPU::DepthChangeEstimator_CPU(float changeThreshold)
+: DepthChangeEstimator(changeThreshold)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DepthChangeEstimator_CPU::count_pixels(const ITMFloatImage *depth, const ITMFloatImage *referenceDepth)
+{
+  const float *depthData = depth->GetData(MEMORYDEVICE_CPU);
+  const float *referenceDepthData = referenceDepth->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(depth->dataSize);
+
+  int validCount = 0, changedCount = 0;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for reduction(+:validCount,changedCount)
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    bool valid, changed;
+    classify_depth_change(i, depthData, referenceDepthData, m_changeThreshold, valid, changed);
+    if(valid) ++validCount;
+    if(changed) ++changedCount;
+  }
+
+  int *pixelCounts = m_pixelCountsMB->GetData(MEMORYDEVICE_CPU);
+  pixelCounts[0] = validCount;
+  pixelCounts[1] = changedCount;
+}
+
+}
@@ -0,0 +1,59 @@
+/**
+ * spaint: DepthPreprocessor_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/cpu/DepthPreprocessor_CPU.h"
+
+#include "imageprocessing/shared/DepthPreprocessor_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+DepthPreprocessor_CPU::DepthPreprocessor_CPU(int bilateralRadius, float spatialSigma, float depthSigma, int holeFillRadius, float holeFillMaxDepthDifference)
+: DepthPreprocessor(bilateralRadius, spatialSigma, depthSigma, holeFillRadius, holeFillMaxDepthDifference)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DepthPreprocessor_CPU::bilateral_filter(const ITMFloatImage *input, bool horizontal, ITMFloatImage *output) const
+{
+  const float *inputData = input->GetData(MEMORYDEVICE_CPU);
+  float *outputData = output->GetData(MEMORYDEVICE_CPU);
+  const int width = input->noDims.x, height = input->noDims.y;
+  const int dx = horizontal ? 1 : 0, dy = horizontal ? 0 : 1;
+  const float spatialWeightFactor = -0.5f / (m_spatialSigma * m_spatialSigma);
+  const float depthWeightFactor = -0.5f / (m_depthSigma * m_depthSigma);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      bilateral_filter_depth_pixel(x, y, inputData, width, height, m_bilateralRadius, dx, dy, spatialWeightFactor, depthWeightFactor, outputData);
+    }
+  }
+}
+
+void DepthPreprocessor_CPU::fill_holes(const ITMFloatImage *input, ITMFloatImage *output) const
+{
+  const float *inputData = input->GetData(MEMORYDEVICE_CPU);
+  float *outputData = output->GetData(MEMORYDEVICE_CPU);
+  const int width = input->noDims.x, height = input->noDims.y;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      fill_depth_hole_pixel(x, y, inputData, width, height, m_holeFillRadius, m_holeFillMaxDepthDifference, outputData);
+    }
+  }
+}
+
+}
@@ -0,0 +1,39 @@
+/**
+ * spaint: MedianFilterer_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/cpu/MedianFilterer_CPU.h"
+
+#include "imageprocessing/shared/MedianFilterer_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+MedianFilterer_CPU::MedianFilterer_CPU(unsigned int kernelWidth)
+: MedianFilterer(kernelWidth)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MedianFilterer_CPU::filter(const ITMUChar4Image *input, ITMUChar4Image *output) const
+{
+  const Vector4u *inputData = input->GetData(MEMORYDEVICE_CPU);
+  Vector4u *outputData = output->GetData(MEMORYDEVICE_CPU);
+  const int width = input->noDims.x, height = input->noDims.y;
+  const int kernelWidth = static_cast<int>(m_kernelWidth);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      median_filter_pixel(x, y, kernelWidth, inputData, width, height, outputData);
+    }
+  }
+}
+
+}
@@ -0,0 +1,67 @@
+/**
+ * spaint: DepthChangeEstimator_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/cuda/DepthChangeEstimator_CUDA.h"
+
+#include "imageprocessing/shared/DepthChangeEstimator_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_count_depth_changes(const float *depth, const float *referenceDepth, int pixelCount, float changeThreshold, int *pixelCounts)
+{
+  __shared__ int validCount, changedCount;
+
+  if(threadIdx.x == 0) validCount = changedCount = 0;
+  __syncthreads();
+
+  // Accumulate the counts for the thread block in shared memory, so that only one thread per block has to update the global counts.
+  const int i = threadIdx.x + blockIdx.x * blockDim.x;
+  if(i < pixelCount)
+  {
+    bool valid, changed;
+    classify_depth_change(i, depth, referenceDepth, changeThreshold, valid, changed);
+    if(valid) atomicAdd(&validCount, 1);
+    if(changed) atomicAdd(&changedCount, 1);
+  }
+  __syncthreads();
+
+  if(threadIdx.x == 0)
+  {
+    atomicAdd(&pixelCounts[0], validCount);
+    atomicAdd(&pixelCounts[1], changedCount);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+DepthChangeEstimator_CUDA::DepthChangeEstimator_CUDA(float changeThreshold)
+: DepthChangeEstimator(changeThreshold)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DepthChangeEstimator_CUDA::count_pixels(const ITMFloatImage *depth, const ITMFloatImage *referenceDepth)
+{
+  const int pixelCount = static_cast<int>(depth->dataSize);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_pixelCountsMB->Clear();
+
+  ck_count_depth_changes<<<numBlocks,threadsPerBlock>>>(
+    depth->GetData(MEMORYDEVICE_CUDA),
+    referenceDepth->GetData(MEMORYDEVICE_CUDA),
+    pixelCount,
+    m_changeThreshold,
+    m_pixelCountsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_pixelCountsMB->UpdateHostFromDevice();
+}
+
+}
@@ -0,0 +1,78 @@
+/**
+ * spaint: DepthPreprocessor_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/cuda/DepthPreprocessor_CUDA.h"
+
+#include "imageprocessing/shared/DepthPreprocessor_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_bilateral_filter_depth(const float *input, int width, int height, int radius, int dx, int dy,
+                                          float spatialWeightFactor, float depthWeightFactor, float *output)
+{
+  const int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+  if(x < width && y < height)
+  {
+    bilateral_filter_depth_pixel(x, y, input, width, height, radius, dx, dy, spatialWeightFactor, depthWeightFactor, output);
+  }
+}
+
+__global__ void ck_fill_depth_holes(const float *input, int width, int height, int radius, float maxDepthDifference, float *output)
+{
+  const int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+  if(x < width && y < height)
+  {
+    fill_depth_hole_pixel(x, y, input, width, height, radius, maxDepthDifference, output);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+DepthPreprocessor_CUDA::DepthPreprocessor_CUDA(int bilateralRadius, float spatialSigma, float depthSigma, int holeFillRadius, float holeFillMaxDepthDifference)
+: DepthPreprocessor(bilateralRadius, spatialSigma, depthSigma, holeFillRadius, holeFillMaxDepthDifference)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DepthPreprocessor_CUDA::bilateral_filter(const ITMFloatImage *input, bool horizontal, ITMFloatImage *output) const
+{
+  const int width = input->noDims.x, height = input->noDims.y;
+
+  dim3 cudaBlockSize(16, 16);
+  dim3 gridSize((width + cudaBlockSize.x - 1) / cudaBlockSize.x, (height + cudaBlockSize.y - 1) / cudaBlockSize.y);
+
+  ck_bilateral_filter_depth<<<gridSize,cudaBlockSize>>>(
+    input->GetData(MEMORYDEVICE_CUDA),
+    width,
+    height,
+    m_bilateralRadius,
+    horizontal ? 1 : 0,
+    horizontal ? 0 : 1,
+    -0.5f / (m_spatialSigma * m_spatialSigma),
+    -0.5f / (m_depthSigma * m_depthSigma),
+    output->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void DepthPreprocessor_CUDA::fill_holes(const ITMFloatImage *input, ITMFloatImage *output) const
+{
+  const int width = input->noDims.x, height = input->noDims.y;
+
+  dim3 cudaBlockSize(16, 16);
+  dim3 gridSize((width + cudaBlockSize.x - 1) / cudaBlockSize.x, (height + cudaBlockSize.y - 1) / cudaBlockSize.y);
+
+  ck_fill_depth_holes<<<gridSize,cudaBlockSize>>>(
+    input->GetData(MEMORYDEVICE_CUDA),
+    width,
+    height,
+    m_holeFillRadius,
+    m_holeFillMaxDepthDifference,
+    output->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,47 @@
+/**
+ * spaint: MedianFilterer_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/cuda/MedianFilterer_CUDA.h"
+
+#include "imageprocessing/shared/MedianFilterer_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_median_filter(int kernelWidth, const Vector4u *input, int width, int height, Vector4u *output)
+{
+  const int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+  if(x < width && y < height)
+  {
+    median_filter_pixel(x, y, kernelWidth, input, width, height, output);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+MedianFilterer_CUDA::MedianFilterer_CUDA(unsigned int kernelWidth)
+: MedianFilterer(kernelWidth)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MedianFilterer_CUDA::filter(const ITMUChar4Image *input, ITMUChar4Image *output) const
+{
+  const int width = input->noDims.x, height = input->noDims.y;
+
+  dim3 cudaBlockSize(8, 8);
+  dim3 gridSize((width + cudaBlockSize.x - 1) / cudaBlockSize.x, (height + cudaBlockSize.y - 1) / cudaBlockSize.y);
+
+  ck_median_filter<<<gridSize,cudaBlockSize>>>(
+    static_cast<int>(m_kernelWidth),
+    input->GetData(MEMORYDEVICE_CUDA),
+    width,
+    height,
+    output->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,47 @@
+/**
+ * spaint: DepthChangeEstimator.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/interface/DepthChangeEstimator.h"
+
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+DepthChangeEstimator::DepthChangeEstimator(float changeThreshold)
+: m_changeThreshold(changeThreshold)
+{
+  if(changeThreshold <= 0.0f)
+  {
+    throw std::invalid_argument("Error: The change threshold for depth change estimation must be positive");
+  }
+
+  m_pixelCountsMB = MemoryBlockFactory::instance().make_block<int>(2, "DepthChangeEstimator");
+}
+
+//#################### DESTRUCTOR ####################
+
+DepthChangeEstimator::~DepthChangeEstimator() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+float DepthChangeEstimator::estimate_changed_fraction(const ITMFloatImage *depth, const ITMFloatImage *referenceDepth)
+{
+  if(depth->noDims != referenceDepth->noDims)
+  {
+    throw std::invalid_argument("Error: Depth change estimation requires the two depth images to be the same size");
+  }
+
+  count_pixels(depth, referenceDepth);
+
+  const int *pixelCounts = m_pixelCountsMB->GetData(MEMORYDEVICE_CPU);
+  return pixelCounts[0] > 0 ? static_cast<float>(pixelCounts[1]) / pixelCounts[0] : 1.0f;
+}
+
+}
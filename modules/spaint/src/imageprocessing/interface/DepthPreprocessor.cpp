@@ -0,0 +1,69 @@
+/**
+ * spaint: DepthPreprocessor.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imageprocessing/interface/DepthPreprocessor.h"
+
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using namespace itmx;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+DepthPreprocessor::DepthPreprocessor(int bilateralRadius, float spatialSigma, float depthSigma, int holeFillRadius, float holeFillMaxDepthDifference)
+: m_bilateralRadius(bilateralRadius),
+  m_buffer(MemoryBlockFactory::instance().make_image<float>(Vector2i(0, 0), "DepthPreprocessor")),
+  m_depthSigma(depthSigma),
+  m_holeFillMaxDepthDifference(holeFillMaxDepthDifference),
+  m_holeFillRadius(holeFillRadius),
+  m_spatialSigma(spatialSigma)
+{
+  if(bilateralRadius < 0 || bilateralRadius > MAX_BILATERAL_RADIUS)
+  {
+    throw std::invalid_argument("Error: The bilateral filter radius must be between 0 and " + boost::lexical_cast<std::string>(MAX_BILATERAL_RADIUS));
+  }
+
+  if(holeFillRadius < 0 || holeFillRadius > MAX_HOLE_FILL_RADIUS)
+  {
+    throw std::invalid_argument("Error: The hole filling radius must be between 0 and " + boost::lexical_cast<std::string>(MAX_HOLE_FILL_RADIUS));
+  }
+
+  if(spatialSigma <= 0.0f || depthSigma <= 0.0f || holeFillMaxDepthDifference <= 0.0f)
+  {
+    throw std::invalid_argument("Error: The depth preprocessing sigmas and hole filling threshold must be positive");
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+DepthPreprocessor::~DepthPreprocessor() {}
+
+//#################### PUBLIC OPERATORS ####################
+
+void DepthPreprocessor::operator()(ITMFloatImage *depth)
+{
+  // Note: The buffer will only be reallocated if the size of the depth images changes.
+  if(m_buffer->noDims != depth->noDims) m_buffer->ChangeDims(depth->noDims);
+
+  // The hole filling writes into the buffer, which is then swapped with the depth image. The horizontal pass of the bilateral
+  // filter writes into the buffer, and the vertical pass writes back into the depth image. Thus no copies are needed.
+  if(m_holeFillRadius > 0)
+  {
+    fill_holes(depth, m_buffer.get());
+    depth->Swap(*m_buffer);
+  }
+
+  if(m_bilateralRadius > 0)
+  {
+    bilateral_filter(depth, true, m_buffer.get());
+    bilateral_filter(m_buffer.get(), false, depth);
+  }
+}
+
+}
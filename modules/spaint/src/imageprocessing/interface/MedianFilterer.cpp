@@ -0,0 +1,42 @@
+/**
+ * spaint: MedianFilterer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#include "imageprocessing/interface/MedianFilterer.h"
+
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+MedianFilterer::MedianFilterer(unsigned int kernelWidth)
+: m_kernelWidth(kernelWidth)
+{
+  if(kernelWidth % 2 == 0 || kernelWidth > MAX_KERNEL_WIDTH)
+  {
+    throw std::invalid_argument("Error: The kernel width for median filtering must be odd and at most " + boost::lexical_cast<std::string>(MAX_KERNEL_WIDTH));
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+MedianFilterer::~MedianFilterer() {}
+
+//#################### PUBLIC OPERATORS ####################
+
+void MedianFilterer::operator()(const ITMUChar4Image_CPtr& input, const ITMUChar4Image_Ptr& output) const
+{
+  if(input.get() == output.get())
+  {
+    throw std::invalid_argument("Error: Median filtering cannot be performed in place");
+  }
+
+  output->ChangeDims(input->noDims);
+  filter(input.get(), output.get());
+}
+
+}
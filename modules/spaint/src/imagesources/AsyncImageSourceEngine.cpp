@@ -7,36 +7,66 @@
 
 #include <stdexcept>
 
+#ifdef WITH_CUDA
+#include <ORUtils/CUDADefines.h>
+#endif
+
+#include <tvgutil/misc/AffinityUtil.h>
+#include <tvgutil/timing/ProfilingScope.h>
+using namespace tvgutil;
+
 namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-AsyncImageSourceEngine::AsyncImageSourceEngine(ImageSourceEngine *innerSource, size_t queueCapacity)
-: m_grabberShouldTerminate(false),
+AsyncImageSourceEngine::AsyncImageSourceEngine(ImageSourceEngine *innerSource, size_t queueCapacity, bool usePinnedMemory, BufferingMode bufferingMode,
+                                               const std::vector<int>& grabberCpus, const std::vector<int>& consumerCpus)
+: m_bufferingMode(bufferingMode),
+  m_droppedFrameCount(0),
+  m_grabberCpus(grabberCpus),
+  m_grabberShouldTerminate(false),
   m_innerSource(innerSource),
-  m_queueCapacity(queueCapacity > 0 ? queueCapacity : std::numeric_limits<size_t>::max())
+  m_innerSourceExhausted(false),
+  // Note: The ring is unused in latest-frame mode, so we avoid giving it more than the minimum number of slots.
+  m_ring(bufferingMode == BUFFER_LATEST ? 1 : queueCapacity > 0 ? queueCapacity : 60),
+#ifdef WITH_CUDA
+  m_usePinnedMemory(usePinnedMemory)
+#else
+  m_usePinnedMemory(false)
+#endif
 {
   if(!innerSource)
   {
     throw std::runtime_error("Error: Cannot initialise an AsyncImageSourceEngine with a NULL ImageSourceEngine.");
   }
 
-  // Determine the maximum number of RGB-D images to store in the pool.
-  const size_t MAX_POOL_CAPACITY = 60;
-  m_poolCapacity = std::min(m_queueCapacity, MAX_POOL_CAPACITY);
-
-  // If the inner source has images available, fill the pool to avoid allocating memory at runtime.
-  // If the inner source doesn't have any images available, there is no need to allocate.
-  if(m_innerSource->hasMoreImages())
+#ifdef WITH_CUDA
+  // If we're using pinned memory, set up the upload stream and the events used to signal that each slot has been uploaded.
+  if(m_usePinnedMemory)
   {
-    for(size_t i = 0; i < m_poolCapacity; ++i)
+    ORcudaSafeCall(cudaStreamCreateWithFlags(&m_uploadStream, cudaStreamNonBlocking));
+
+    for(size_t i = 0, count = slot_count(); i < count; ++i)
     {
-      RGBDImage rgbdImage;
-      rgbdImage.rawDepth.reset(new ITMShortImage(m_innerSource->getDepthImageSize(), true, false));
-      rgbdImage.rgb.reset(new ITMUChar4Image(m_innerSource->getRGBImageSize(), true, false));
-      m_pool.push(rgbdImage);
+      ORcudaSafeCall(cudaEventCreateWithFlags(&slot(i).uploaded, cudaEventDisableTiming));
     }
   }
+#endif
+
+  // Record the initial calibration and image sizes, so that they can be provided before any images have been cached.
+  m_calib = m_innerSource->getCalib();
+  m_depthImageSize = m_innerSource->getDepthImageSize();
+  m_rgbImageSize = m_innerSource->getRGBImageSize();
+
+  // If the inner source has images available, preallocate the RGB-D images in the buffer to avoid allocating memory at runtime.
+  // If the inner source doesn't have any images available, there is no need to allocate. If the consumer's CPUs have been
+  // specified, we allocate the images on a temporary thread running on those CPUs, so that their memory is placed close to
+  // the consumer (this thread is not necessarily the one that will consume the images).
+  if(m_innerSource->hasMoreImages())
+  {
+    if(consumerCpus.empty()) preallocate_rgbd_images(consumerCpus);
+    else boost::thread(boost::bind(&AsyncImageSourceEngine::preallocate_rgbd_images, this, boost::cref(consumerCpus))).join();
+  }
 
   // Start the image grabber.
   m_grabber = boost::thread(boost::bind(&AsyncImageSourceEngine::run_image_grabber, this));
@@ -50,90 +80,196 @@ AsyncImageSourceEngine::~AsyncImageSourceEngine()
   m_grabberShouldTerminate = true;
 
   // Wake the image grabber (it might be waiting on a full queue).
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+  }
   m_queueNotFull.notify_one();
 
   // Wait for the image grabber to terminate gracefully.
   m_grabber.join();
+
+#ifdef WITH_CUDA
+  // If we were using pinned memory, wait for any outstanding uploads and then destroy the events and the upload stream.
+  if(m_usePinnedMemory)
+  {
+    ORcudaSafeCall(cudaStreamSynchronize(m_uploadStream));
+
+    for(size_t i = 0, count = slot_count(); i < count; ++i)
+    {
+      ORcudaSafeCall(cudaEventDestroy(slot(i).uploaded));
+    }
+
+    ORcudaSafeCall(cudaStreamDestroy(m_uploadStream));
+  }
+#endif
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 ITMLib::ITMRGBDCalib AsyncImageSourceEngine::getCalib() const
 {
-  boost::unique_lock<boost::mutex> lock(m_mutex);
+  // If there are images in the queue, return the first image's calibration; if not, return the most recent calibration.
+  // Note that in latest-frame mode, the next image to be consumed is always the most recent one.
+  if(m_bufferingMode == BUFFER_FIFO && !m_ring.empty()) return m_ring.front().calib;
 
-  // If there are images in the queue, return the first image's calibration; if not, defer to the inner source.
-  return !m_queue.empty() ? m_queue.front().calib : m_innerSource->getCalib();
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_calib;
 }
 
 Vector2i AsyncImageSourceEngine::getDepthImageSize() const
 {
-  boost::unique_lock<boost::mutex> lock(m_mutex);
+  // If there are images in the queue, return the first image's depth size; if not, return the most recent depth size.
+  if(m_bufferingMode == BUFFER_FIFO && !m_ring.empty()) return m_ring.front().rawDepth->noDims;
 
-  // If there are images in the queue, return the first image's depth size; if not, defer to the inner source.
-  return !m_queue.empty() ? m_queue.front().rawDepth->noDims : m_innerSource->getDepthImageSize();
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_depthImageSize;
 }
 
 void AsyncImageSourceEngine::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
 {
-  boost::unique_lock<boost::mutex> lock(m_mutex);
-
-  // If there are no more images available, early out.
-  if(m_queue.empty())
-  {
-    throw std::runtime_error("Error: No more images to get. Make sure to call hasMoreImages before calling getImages.");
-  }
-
-  // Otherwise, get the first RGB-D image from the queue.
-  RGBDImage& rgbdImage = m_queue.front();
+  // Get the next RGB-D image from the buffer (if there are no more images available, this will throw).
+  RGBDImage& rgbdImage = acquire_front();
+  m_frameTimestamps = rgbdImage.timestamps;
 
   // Ensure that the output images have the correct size (this is generally a no-op).
   rawDepth->ChangeDims(rgbdImage.rawDepth->noDims);
   rgb->ChangeDims(rgbdImage.rgb->noDims);
 
+#ifdef WITH_CUDA
+  // If we're using pinned memory, make sure that the RGB-D image has finished uploading to the GPU, since the image grabber
+  // may refill its host memory as soon as it has been released.
+  if(m_usePinnedMemory) ORcudaSafeCall(cudaEventSynchronize(rgbdImage.uploaded));
+#endif
+
   // Copy the depth and RGB images from the queued image into the output images.
   rawDepth->SetFrom(rgbdImage.rawDepth.get(), ITMShortImage::CPU_TO_CPU);
   rgb->SetFrom(rgbdImage.rgb.get(), ITMUChar4Image::CPU_TO_CPU);
 
-  // If there is space available in the RGB-D image pool, store the RGB-D image to avoid reallocating memory later.
-  if(m_pool.size() < m_poolCapacity) m_pool.push(rgbdImage);
+  // Release the RGB-D image back to the image grabber so that its memory can be reused.
+  release_front();
+}
 
-  // Remove the RGB-D image from the queue and inform the image grabber that the queue is not full.
-  m_queue.pop();
-  m_queueNotFull.notify_one();
+void AsyncImageSourceEngine::getImages(ITMUChar4Image& rgb, ITMShortImage& rawDepth)
+{
+  // Swap the contents of the caller's images with those of the next RGB-D image in the buffer (if there are no more images available,
+  // this will throw). The caller's memory will be reused by the image grabber (which resizes it as necessary) when it next fills the slot.
+  RGBDImage& rgbdImage = acquire_front();
+  m_frameTimestamps = rgbdImage.timestamps;
+
+#ifdef WITH_CUDA
+  // If we're using pinned memory, make sure that the RGB-D image has finished uploading to the GPU before handing it over.
+  if(m_usePinnedMemory) ORcudaSafeCall(cudaEventSynchronize(rgbdImage.uploaded));
+#endif
+  rawDepth.Swap(*rgbdImage.rawDepth);
+  rgb.Swap(*rgbdImage.rgb);
+
+  release_front();
 }
 
 Vector2i AsyncImageSourceEngine::getRGBImageSize() const
 {
-  boost::unique_lock<boost::mutex> lock(m_mutex);
+  // If there are images in the queue, return the first image's RGB size; if not, return the most recent RGB size.
+  if(m_bufferingMode == BUFFER_FIFO && !m_ring.empty()) return m_ring.front().rgb->noDims;
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_rgbImageSize;
+}
 
-  // If there are images in the queue, return the first image's RGB size; if not, defer to the inner source.
-  return !m_queue.empty() ? m_queue.front().rgb->noDims : m_innerSource->getRGBImageSize();
+size_t AsyncImageSourceEngine::get_dropped_frame_count() const
+{
+  return m_droppedFrameCount;
+}
+
+FrameTimestamps AsyncImageSourceEngine::get_frame_timestamps() const
+{
+  return m_frameTimestamps;
 }
 
 bool AsyncImageSourceEngine::hasMoreImages() const
 {
-  // We need to grab the mutex in case the queue is empty, in which case we need to wait to see if an image becomes available.
-  boost::unique_lock<boost::mutex> lock(m_mutex);
+  // If there's an image in the queue, we can return straight away without taking the lock.
+  if(has_queued_image()) return true;
 
-  // If the inner source has more images, wait for one to be added to the queue by the image grabber.
-  while(m_innerSource->hasMoreImages() && m_queue.empty()) m_queueNotEmpty.wait(lock);
+  // Otherwise, if the inner source has more images, wait for one to be added to the queue by the image grabber. Note that
+  // the predicate must be checked whilst holding the mutex to avoid missing a notification sent between it and the wait.
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  while(!m_innerSourceExhausted && !has_queued_image()) m_queueNotEmpty.wait(lock);
 
   // At this point, either there is now an image in the queue, in which case we return true,
   // or the inner source has terminated, in which case we return false.
-  return !m_queue.empty();
+  return has_queued_image();
 }
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+AsyncImageSourceEngine::RGBDImage& AsyncImageSourceEngine::acquire_front()
+{
+  const bool imageAvailable = m_bufferingMode == BUFFER_LATEST ? m_latest.take() : !m_ring.empty();
+  if(!imageAvailable)
+  {
+    throw std::runtime_error("Error: No more images to get. Make sure to call hasMoreImages before calling getImages.");
+  }
+
+  return m_bufferingMode == BUFFER_LATEST ? m_latest.front() : m_ring.front();
+}
+
+void AsyncImageSourceEngine::allocate_rgbd_image(RGBDImage& rgbdImage, const Vector2i& depthImageSize, const Vector2i& rgbImageSize) const
+{
+  // Note: When images are allocated on both the CPU and the GPU, InfiniTAM allocates their host memory as pinned memory.
+  rgbdImage.rawDepth.reset(new ITMShortImage(depthImageSize, true, m_usePinnedMemory));
+  rgbdImage.rgb.reset(new ITMUChar4Image(rgbImageSize, true, m_usePinnedMemory));
+}
+
+bool AsyncImageSourceEngine::has_queued_image() const
+{
+  return m_bufferingMode == BUFFER_LATEST ? m_latest.has_fresh() : !m_ring.empty();
+}
+
+void AsyncImageSourceEngine::preallocate_rgbd_images(const std::vector<int>& cpus)
+{
+  AffinityUtil::set_current_thread_affinity(cpus, "image buffer allocator");
+
+  for(size_t i = 0, count = slot_count(); i < count; ++i)
+  {
+    RGBDImage& rgbdImage = slot(i);
+    allocate_rgbd_image(rgbdImage, m_depthImageSize, m_rgbImageSize);
+
+    // Touch the newly-allocated memory, so that its pages are placed on the NUMA node of this thread.
+    rgbdImage.rawDepth->Clear();
+    rgbdImage.rgb->Clear();
+  }
+}
+
+void AsyncImageSourceEngine::release_front()
+{
+  // In latest-frame mode, the image grabber never waits for the consumer, so there is nothing to do.
+  if(m_bufferingMode == BUFFER_LATEST) return;
+
+  m_ring.pop();
+
+  // Inform the image grabber that the queue is not full. We briefly acquire the mutex first so that
+  // the notification cannot be sent between the image grabber checking the ring and going to sleep.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+  }
+  m_queueNotFull.notify_one();
+}
+
 void AsyncImageSourceEngine::run_image_grabber()
 {
+  Profiler& profiler = Profiler::instance();
+  profiler.set_thread_name("Image grabber");
+  AffinityUtil::set_current_thread_affinity(m_grabberCpus, "image grabber");
+
   while(!m_grabberShouldTerminate)
   {
-    boost::unique_lock<boost::mutex> lock(m_mutex);
-
-    // If the queue is full, wait until some images have been consumed or termination is requested.
-    while(!m_grabberShouldTerminate && m_queue.size() >= m_queueCapacity) m_queueNotFull.wait(lock);
+    // If the queue is full, wait until some images have been consumed or termination is requested. Note that in latest-frame
+    // mode, the ring is never used, and so there is never any need to wait.
+    if(m_bufferingMode == BUFFER_FIFO)
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(!m_grabberShouldTerminate && m_ring.full()) m_queueNotFull.wait(lock);
+    }
 
     // If we were asked to terminate, do so.
     if(m_grabberShouldTerminate) return;
@@ -141,40 +277,97 @@ void AsyncImageSourceEngine::run_image_grabber()
     // If there are no more images available from the inner source, notify anyone waiting for an image and terminate.
     if(!m_innerSource->hasMoreImages())
     {
+      {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_innerSourceExhausted = true;
+      }
       m_queueNotEmpty.notify_one();
       return;
     }
 
-    // Construct an RGB-D image into which to copy the data from the inner source.
-    RGBDImage rgbdImage;
-    if(!m_pool.empty())
-    {
-      // If possible, reuse an existing RGB-D image from the pool rather than allocating new memory.
-      rgbdImage = m_pool.front();
-      m_pool.pop();
+    // Get the calibration and image sizes for the next RGB-D image from the inner source.
+    const ITMLib::ITMRGBDCalib calib = m_innerSource->getCalib();
+    const Vector2i depthImageSize = m_innerSource->getDepthImageSize();
+    const Vector2i rgbImageSize = m_innerSource->getRGBImageSize();
 
+    // Get the next free RGB-D image in the buffer into which to copy the data from the inner source.
+    RGBDImage& rgbdImage = m_bufferingMode == BUFFER_LATEST ? m_latest.back_slot() : m_ring.back_slot();
+    if(rgbdImage.rawDepth && rgbdImage.rgb)
+    {
       // Ensure that the depth and RGB images have the correct size (this is a no-op unless the size of
-      // the images produced by the inner source has changed since we put the RGB-D image in the pool).
-      rgbdImage.rawDepth->ChangeDims(m_innerSource->getDepthImageSize());
-      rgbdImage.rgb->ChangeDims(m_innerSource->getRGBImageSize());
+      // the images produced by the inner source has changed since the slot was last used).
+      rgbdImage.rawDepth->ChangeDims(depthImageSize);
+      rgbdImage.rgb->ChangeDims(rgbImageSize);
     }
     else
     {
-      // If there was no existing image available from the pool, allocate new memory for the RGB-D image.
-      rgbdImage.rawDepth.reset(new ITMShortImage(m_innerSource->getDepthImageSize(), true, false));
-      rgbdImage.rgb.reset(new ITMUChar4Image(m_innerSource->getRGBImageSize(), true, false));
+      // If the slot was never allocated (because the inner source initially had no images), allocate memory for it now.
+      allocate_rgbd_image(rgbdImage, depthImageSize, rgbImageSize);
     }
 
-    // Get the calibration for the RGB-D image from the inner source.
-    rgbdImage.calib = m_innerSource->getCalib();
+    // Copy the images from the inner source into the RGB-D image (note that no lock is held whilst doing this).
+    rgbdImage.calib = calib;
+    {
+      ProfilingScope grabScope("AsyncImageSourceEngine.GrabFrame");
+      m_innerSource->getImages(rgbdImage.rgb.get(), rgbdImage.rawDepth.get());
+    }
+
+    // Stamp the RGB-D image with the time at which it was captured. If the inner source knows this, we use its timestamps;
+    // if not, the best we can do is to use the time at which we received the image from it.
+    const FrameTimestampSource *innerTimestampSource = dynamic_cast<const FrameTimestampSource*>(m_innerSource.get());
+    rgbdImage.timestamps = innerTimestampSource ? innerTimestampSource->get_frame_timestamps() : FrameTimestamps();
 
-    // Copy the images from the inner source into the RGB-D image.
-    m_innerSource->getImages(rgbdImage.rgb.get(), rgbdImage.rawDepth.get());
+#ifdef WITH_CUDA
+    // If we're using pinned memory, start uploading the RGB-D image to the GPU straight away, so that it is already
+    // resident on the device by the time it is consumed.
+    if(m_usePinnedMemory)
+    {
+      // If the profiler is enabled, time the upload on the upload stream, so that its overlap with the main pipeline can be seen.
+      const cudaEvent_t uploadStartEvent = profiler.is_enabled() ? profiler.start_gpu_stage(m_uploadStream) : NULL;
+
+      ORcudaSafeCall(cudaMemcpyAsync(
+        rgbdImage.rawDepth->GetData(MEMORYDEVICE_CUDA), rgbdImage.rawDepth->GetData(MEMORYDEVICE_CPU),
+        rgbdImage.rawDepth->dataSize * sizeof(short), cudaMemcpyHostToDevice, m_uploadStream
+      ));
+      ORcudaSafeCall(cudaMemcpyAsync(
+        rgbdImage.rgb->GetData(MEMORYDEVICE_CUDA), rgbdImage.rgb->GetData(MEMORYDEVICE_CPU),
+        rgbdImage.rgb->dataSize * sizeof(Vector4u), cudaMemcpyHostToDevice, m_uploadStream
+      ));
+      ORcudaSafeCall(cudaEventRecord(rgbdImage.uploaded, m_uploadStream));
+
+      if(uploadStartEvent) profiler.stop_gpu_stage("AsyncImageSourceEngine.Upload", uploadStartEvent, m_uploadStream);
+    }
+#endif
 
-    // Add the RGB-D image to the queue and inform the main thread that images are available.
-    m_queue.push(rgbdImage);
+    // Record the most recent calibration and image sizes, and publish the RGB-D image to the consumer. In latest-frame mode,
+    // this replaces any image that has not yet been consumed, which we count as dropped.
+    bool droppedImage = false;
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_calib = calib;
+      m_depthImageSize = depthImageSize;
+      m_rgbImageSize = rgbImageSize;
+      if(m_bufferingMode == BUFFER_LATEST) droppedImage = m_latest.push();
+      else m_ring.push();
+    }
     m_queueNotEmpty.notify_one();
+
+    if(droppedImage)
+    {
+      ++m_droppedFrameCount;
+      profiler.set_gauge("AsyncImageSourceEngine.DroppedFrames", static_cast<double>(m_droppedFrameCount));
+    }
   }
 }
 
+AsyncImageSourceEngine::RGBDImage& AsyncImageSourceEngine::slot(size_t i)
+{
+  return m_bufferingMode == BUFFER_LATEST ? m_latest.slot(i) : m_ring.slot(i);
+}
+
+size_t AsyncImageSourceEngine::slot_count() const
+{
+  return m_bufferingMode == BUFFER_LATEST ? m_latest.slot_count() : m_ring.capacity();
+}
+
 }
@@ -0,0 +1,79 @@
+/**
+ * spaint: ImageFileSequenceSource.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imagesources/ImageFileSequenceSource.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#include <ITMLib/Objects/Camera/ITMCalibIO.h>
+#include <ORUtils/FileUtils.h>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ImageFileSequenceSource::ImageFileSequenceSource(const std::string& calibrationFilename, const std::string& rgbImageMask,
+                                                 const std::string& depthImageMask, size_t initialFrameIndex)
+: m_depthImageMask(depthImageMask), m_depthImageSize(0, 0), m_rgbImageMask(rgbImageMask), m_rgbImageSize(0, 0)
+{
+  if(!readRGBDCalib(calibrationFilename.c_str(), m_calib))
+  {
+    throw std::runtime_error("Error: Could not read the calibration file " + calibrationFilename);
+  }
+
+  // Determine the image sizes from the first frame (if any).
+  if(has_frame(initialFrameIndex))
+  {
+    ITMUChar4Image rgb(Vector2i(1, 1), true, false);
+    ITMShortImage rawDepth(Vector2i(1, 1), true, false);
+    read_images(initialFrameIndex, &rgb, &rawDepth);
+    m_depthImageSize = rawDepth.noDims;
+    m_rgbImageSize = rgb.noDims;
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMRGBDCalib ImageFileSequenceSource::get_calib() const
+{
+  return m_calib;
+}
+
+Vector2i ImageFileSequenceSource::get_depth_image_size() const
+{
+  return m_depthImageSize;
+}
+
+Vector2i ImageFileSequenceSource::get_rgb_image_size() const
+{
+  return m_rgbImageSize;
+}
+
+bool ImageFileSequenceSource::has_frame(size_t frameIndex) const
+{
+  return boost::filesystem::exists(make_path(m_depthImageMask, frameIndex)) && boost::filesystem::exists(make_path(m_rgbImageMask, frameIndex));
+}
+
+void ImageFileSequenceSource::read_images(size_t frameIndex, ITMUChar4Image *rgb, ITMShortImage *rawDepth) const
+{
+  const std::string depthPath = make_path(m_depthImageMask, frameIndex);
+  if(!ReadImageFromFile(rawDepth, depthPath.c_str())) throw std::runtime_error("Error: Could not read depth image " + depthPath);
+
+  const std::string rgbPath = make_path(m_rgbImageMask, frameIndex);
+  if(!ReadImageFromFile(rgb, rgbPath.c_str())) throw std::runtime_error("Error: Could not read RGB image " + rgbPath);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+std::string ImageFileSequenceSource::make_path(const std::string& mask, size_t frameIndex)
+{
+  return (boost::format(mask) % frameIndex).str();
+}
+
+}
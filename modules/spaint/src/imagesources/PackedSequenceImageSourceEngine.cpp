@@ -0,0 +1,56 @@
+/**
+ * spaint: PackedSequenceImageSourceEngine.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imagesources/PackedSequenceImageSourceEngine.h"
+using namespace ITMLib;
+
+#include <sstream>
+#include <stdexcept>
+
+#include <ITMLib/Objects/Camera/ITMCalibIO.h>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+PackedSequenceImageSourceEngine::PackedSequenceImageSourceEngine(const std::string& path, size_t initialFrameNumber)
+: m_frameIndex(initialFrameNumber), m_reader(path)
+{
+  std::istringstream is(m_reader.get_calib_text());
+  if(!readRGBDCalib(is, m_calib))
+  {
+    throw std::runtime_error("Error: Could not read the calibration from packed sequence file " + path);
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMRGBDCalib PackedSequenceImageSourceEngine::getCalib() const
+{
+  return m_calib;
+}
+
+Vector2i PackedSequenceImageSourceEngine::getDepthImageSize() const
+{
+  // Note: The image sizes are those of the first frame, since they are the same throughout a sequence.
+  return m_reader.get_frame_count() > 0 ? m_reader.get_depth_image_size(0) : Vector2i(0, 0);
+}
+
+void PackedSequenceImageSourceEngine::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+{
+  m_reader.read_images(m_frameIndex++, rgb, rawDepth);
+}
+
+Vector2i PackedSequenceImageSourceEngine::getRGBImageSize() const
+{
+  return m_reader.get_frame_count() > 0 ? m_reader.get_rgb_image_size(0) : Vector2i(0, 0);
+}
+
+bool PackedSequenceImageSourceEngine::hasMoreImages() const
+{
+  return m_frameIndex < m_reader.get_frame_count();
+}
+
+}
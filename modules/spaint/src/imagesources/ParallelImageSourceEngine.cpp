@@ -0,0 +1,187 @@
+/**
+ * spaint: ParallelImageSourceEngine.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imagesources/ParallelImageSourceEngine.h"
+
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ParallelImageSourceEngine::ParallelImageSourceEngine(const RandomAccessImageSource_CPtr& source, size_t initialFrameIndex, size_t threadCount, size_t windowSize)
+: m_claimIndex(initialFrameIndex),
+  m_deliverIndex(initialFrameIndex),
+  m_endIndex(std::numeric_limits<size_t>::max()),
+  m_source(source),
+  m_windowSize(windowSize > 0 ? windowSize : 2 * threadCount),
+  m_workersShouldTerminate(false)
+{
+  if(!source)
+  {
+    throw std::invalid_argument("Error: Cannot initialise a ParallelImageSourceEngine with a NULL source");
+  }
+
+  if(threadCount == 0)
+  {
+    throw std::invalid_argument("Error: A ParallelImageSourceEngine needs at least one decoder thread");
+  }
+
+  // Preallocate one slot for each frame that can be in flight, so that no memory needs to be allocated at runtime.
+  const Vector2i depthImageSize = m_source->get_depth_image_size(), rgbImageSize = m_source->get_rgb_image_size();
+  m_freeSlots.resize(m_windowSize);
+  for(size_t i = 0; i < m_windowSize; ++i)
+  {
+    m_freeSlots[i].rawDepth.reset(new ITMShortImage(depthImageSize, true, false));
+    m_freeSlots[i].rgb.reset(new ITMUChar4Image(rgbImageSize, true, false));
+  }
+
+  // Start the decoder threads.
+  for(size_t i = 0; i < threadCount; ++i)
+  {
+    m_workers.create_thread(boost::bind(&ParallelImageSourceEngine::run_worker, this));
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+ParallelImageSourceEngine::~ParallelImageSourceEngine()
+{
+  // Ask the decoder threads to terminate, and wake any that are waiting for a frame to claim.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_workersShouldTerminate = true;
+  }
+  m_workAvailable.notify_all();
+
+  // Wait for the decoder threads to finish any frames they are decoding and terminate gracefully.
+  m_workers.join_all();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMLib::ITMRGBDCalib ParallelImageSourceEngine::getCalib() const
+{
+  return m_source->get_calib();
+}
+
+Vector2i ParallelImageSourceEngine::getDepthImageSize() const
+{
+  return m_source->get_depth_image_size();
+}
+
+void ParallelImageSourceEngine::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+{
+  // Wait for the next frame, and take it out of the reorder buffer.
+  Slot slot;
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if(!wait_for_next_frame(lock))
+    {
+      throw std::runtime_error("Error: No more images to get. Make sure to call hasMoreImages before calling getImages.");
+    }
+
+    std::map<size_t,Slot>::iterator it = m_readyFrames.find(m_deliverIndex);
+    slot = it->second;
+    m_readyFrames.erase(it);
+    ++m_deliverIndex;
+  }
+
+  // Copy the frame into the output images (note that no lock is held whilst doing so).
+  rawDepth->ChangeDims(slot.rawDepth->noDims);
+  rgb->ChangeDims(slot.rgb->noDims);
+  rawDepth->SetFrom(slot.rawDepth.get(), ITMShortImage::CPU_TO_CPU);
+  rgb->SetFrom(slot.rgb.get(), ITMUChar4Image::CPU_TO_CPU);
+
+  // Hand the slot back to the decoder threads. Delivering the frame also advances the window, so another frame can be claimed.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_freeSlots.push_back(slot);
+  }
+  m_workAvailable.notify_one();
+}
+
+Vector2i ParallelImageSourceEngine::getRGBImageSize() const
+{
+  return m_source->get_rgb_image_size();
+}
+
+bool ParallelImageSourceEngine::hasMoreImages() const
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  return wait_for_next_frame(lock);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ParallelImageSourceEngine::run_worker()
+{
+  for(;;)
+  {
+    // Wait until there is a frame we can claim, or termination is requested.
+    size_t frameIndex;
+    Slot slot;
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(!m_workersShouldTerminate && (m_claimIndex >= m_endIndex || m_claimIndex >= m_deliverIndex + m_windowSize || m_freeSlots.empty()))
+      {
+        m_workAvailable.wait(lock);
+      }
+
+      // If we were asked to terminate, do so.
+      if(m_workersShouldTerminate) return;
+
+      frameIndex = m_claimIndex++;
+      slot = m_freeSlots.back();
+      m_freeSlots.pop_back();
+    }
+
+    // Decode the frame (note that no lock is held whilst doing so, since this is the slow part).
+    bool decoded = false;
+    try
+    {
+      if(m_source->has_frame(frameIndex))
+      {
+        m_source->read_images(frameIndex, slot.rgb.get(), slot.rawDepth.get());
+        decoded = true;
+      }
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+    }
+
+    // Publish the frame to the consumer. If the frame could not be decoded, the sequence ends just before it.
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      if(decoded)
+      {
+        m_readyFrames[frameIndex] = slot;
+      }
+      else
+      {
+        m_freeSlots.push_back(slot);
+        if(frameIndex < m_endIndex) m_endIndex = frameIndex;
+      }
+    }
+    m_frameReady.notify_all();
+  }
+}
+
+bool ParallelImageSourceEngine::wait_for_next_frame(boost::unique_lock<boost::mutex>& lock) const
+{
+  while(m_deliverIndex < m_endIndex && m_readyFrames.find(m_deliverIndex) == m_readyFrames.end())
+  {
+    m_frameReady.wait(lock);
+  }
+
+  return m_deliverIndex < m_endIndex;
+}
+
+}
@@ -0,0 +1,195 @@
+/**
+ * spaint: RGBDStreamImageSourceEngine.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifdef _MSC_VER
+  // Suppress some VC++ warnings that are produced by boost/asio.hpp.
+  #pragma warning(disable:4267 4996)
+#endif
+
+#include <boost/asio.hpp>
+
+#ifdef _MSC_VER
+  // Re-enable the VC++ warnings for the rest of the code.
+  #pragma warning(default:4267 4996)
+#endif
+
+#include "imagesources/RGBDStreamImageSourceEngine.h"
+using namespace ITMLib;
+using namespace itmx;
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <ITMLib/Objects/Camera/ITMCalibIO.h>
+
+namespace spaint {
+
+//#################### NESTED TYPES ####################
+
+struct RGBDStreamImageSourceEngine::Connection
+{
+  boost::asio::io_service ioService;
+  boost::asio::ip::tcp::socket socket;
+
+  Connection()
+  : socket(ioService)
+  {}
+};
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Reads a message (preceded by its header) from a socket.
+ *
+ * \param socket                      The socket.
+ * \param message                     The buffer into which to read the message (any previous contents are discarded).
+ * \throws boost::system::system_error If the read fails.
+ * \throws std::runtime_error          If the message would be larger than the maximum acceptable size.
+ */
+static void read_message(boost::asio::ip::tcp::socket& socket, std::vector<unsigned char>& message)
+{
+  unsigned char header[RGBDStreamUtil::MESSAGE_HEADER_SIZE];
+  boost::asio::read(socket, boost::asio::buffer(header, sizeof(header)));
+
+  message.resize(RGBDStreamUtil::read_message_size(header));
+  if(!message.empty()) boost::asio::read(socket, boost::asio::buffer(message));
+}
+
+//#################### CONSTRUCTORS ####################
+
+RGBDStreamImageSourceEngine::RGBDStreamImageSourceEngine(unsigned short port)
+: m_connection(new Connection), m_connectionClosed(false), m_droppedFrameCount(0), m_framePending(false)
+{
+  const std::string portText = boost::lexical_cast<std::string>(port);
+
+  try
+  {
+    std::cout << "Waiting for an RGB-D stream sender to connect on port " << portText << "..." << std::endl;
+    boost::asio::ip::tcp::acceptor acceptor(m_connection->ioService, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port));
+    acceptor.accept(m_connection->socket);
+    m_connection->socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+    std::vector<unsigned char> handshake;
+    read_message(m_connection->socket, handshake);
+    m_streamInfo = RGBDStreamUtil::decode_handshake(handshake);
+  }
+  catch(boost::system::system_error& e)
+  {
+    throw std::runtime_error("Error: Could not accept an RGB-D stream sender on port " + portText + " (" + e.what() + ")");
+  }
+
+  std::istringstream is(m_streamInfo.calibText);
+  if(!readRGBDCalib(is, m_calib))
+  {
+    throw std::runtime_error("Error: Could not read the calibration sent by the RGB-D stream sender");
+  }
+
+  m_receiver = boost::thread(boost::bind(&RGBDStreamImageSourceEngine::run_receiver, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+RGBDStreamImageSourceEngine::~RGBDStreamImageSourceEngine()
+{
+  // Unblock the receiver if it is in the middle of a read.
+  boost::system::error_code err;
+  m_connection->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, err);
+
+  m_receiver.join();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMRGBDCalib RGBDStreamImageSourceEngine::getCalib() const
+{
+  return m_calib;
+}
+
+Vector2i RGBDStreamImageSourceEngine::getDepthImageSize() const
+{
+  return m_streamInfo.depthImageSize;
+}
+
+void RGBDStreamImageSourceEngine::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+{
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while(!m_framePending && !m_connectionClosed) m_pendingFrameReady.wait(lock);
+    if(!m_framePending) throw std::runtime_error("Error: Cannot get images from an RGB-D stream whose sender has disconnected");
+
+    m_frameBuffer.swap(m_pendingFrame);
+    m_frameTimestamps = m_pendingFrameTimestamps;
+    m_framePending = false;
+  }
+
+  // Decode the frame outside the lock, so that the receiver can keep receiving the next frame in the meantime.
+  RGBDStreamUtil::decode_frame(m_frameBuffer, *rgb, *rawDepth);
+}
+
+Vector2i RGBDStreamImageSourceEngine::getRGBImageSize() const
+{
+  return m_streamInfo.rgbImageSize;
+}
+
+size_t RGBDStreamImageSourceEngine::get_dropped_frame_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_droppedFrameCount;
+}
+
+FrameTimestamps RGBDStreamImageSourceEngine::get_frame_timestamps() const
+{
+  return m_frameTimestamps;
+}
+
+bool RGBDStreamImageSourceEngine::hasMoreImages() const
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  while(!m_framePending && !m_connectionClosed) m_pendingFrameReady.wait(lock);
+  return m_framePending;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void RGBDStreamImageSourceEngine::run_receiver()
+{
+  std::vector<unsigned char> frame;
+
+  try
+  {
+    for(;;)
+    {
+      read_message(m_connection->socket, frame);
+      const FrameTimestamps timestamps;
+
+      {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        if(m_framePending) ++m_droppedFrameCount;
+        m_pendingFrame.swap(frame);
+        m_pendingFrameTimestamps = timestamps;
+        m_framePending = true;
+      }
+
+      m_pendingFrameReady.notify_one();
+    }
+  }
+  catch(std::exception&)
+  {
+    // The sender has disconnected (or sent something invalid), so there are no more images.
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_connectionClosed = true;
+  }
+
+  m_pendingFrameReady.notify_one();
+}
+
+}
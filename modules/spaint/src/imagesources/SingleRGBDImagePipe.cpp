@@ -8,15 +8,45 @@ using namespace ITMLib;
 
 #include <stdexcept>
 
+#include <itmx/base/MemoryBlockFactory.h>
+using namespace itmx;
+
 namespace spaint {
 
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Transfers the contents of one image into another, by swapping them if the images are the same size, or copying them if not.
+ *
+ * \param src The source image (whose contents are unspecified after the call).
+ * \param dst The destination image.
+ */
+template <typename T>
+static void transfer_image(ORUtils::Image<T>& src, ORUtils::Image<T>& dst)
+{
+  if(src.noDims == dst.noDims)
+  {
+    dst.Swap(src);
+  }
+  else
+  {
+    dst.ChangeDims(src.noDims);
+    dst.SetFrom(&src, ORUtils::MemoryBlock<T>::CPU_TO_CPU);
+  }
+}
+
 //#################### CONSTRUCTORS ####################
 
 SingleRGBDImagePipe::SingleRGBDImagePipe(const ImageSourceEngine_CPtr& imageSourceEngine)
 : m_calib(imageSourceEngine->getCalib()),
   m_depthImageSize(imageSourceEngine->getDepthImageSize()),
+  m_imagesAvailable(false),
   m_rgbImageSize(imageSourceEngine->getRGBImageSize())
-{}
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_depthImage = mbf.make_image<short>(m_depthImageSize, "SingleRGBDImagePipe");
+  m_rgbImage = mbf.make_image<Vector4u>(m_rgbImageSize, "SingleRGBDImagePipe");
+}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
@@ -32,11 +62,13 @@ Vector2i SingleRGBDImagePipe::getDepthImageSize() const
 
 void SingleRGBDImagePipe::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
 {
-  rawDepth->SetFrom(m_depthImage.get(), ITMShortImage::CPU_TO_CPU);
-  rgb->SetFrom(m_rgbImage.get(), ITMUChar4Image::CPU_TO_CPU);
-
-  m_depthImage.reset();
-  m_rgbImage.reset();
+  // Hand the images over to the caller. Where the sizes match, the caller's old images are swapped into our buffers, so that
+  // they can in turn be swapped out to the producer and reused for the images after these ones.
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  transfer_image(*m_depthImage, *rawDepth);
+  transfer_image(*m_rgbImage, *rgb);
+  m_lastReadImageRegion = m_imageRegion;
+  m_imagesAvailable = false;
 }
 
 Vector2i SingleRGBDImagePipe::getRGBImageSize() const
@@ -44,15 +76,37 @@ Vector2i SingleRGBDImagePipe::getRGBImageSize() const
   return m_rgbImageSize;
 }
 
+boost::optional<Vector4i> SingleRGBDImagePipe::get_image_region() const
+{
+  return m_lastReadImageRegion;
+}
+
 bool SingleRGBDImagePipe::hasMoreImages() const
 {
-  return m_depthImage || m_rgbImage;
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_imagesAvailable;
+}
+
+void SingleRGBDImagePipe::set_images(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage, const boost::optional<Vector4i>& imageRegion)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  m_depthImage->ChangeDims(depthImage->noDims);
+  m_depthImage->SetFrom(depthImage.get(), ITMShortImage::CPU_TO_CPU);
+  m_rgbImage->ChangeDims(rgbImage->noDims);
+  m_rgbImage->SetFrom(rgbImage.get(), ITMUChar4Image::CPU_TO_CPU);
+
+  m_imageRegion = imageRegion;
+  m_imagesAvailable = true;
 }
 
-void SingleRGBDImagePipe::set_images(const ITMUChar4Image_CPtr& rgbImage, const ITMShortImage_CPtr& depthImage)
+void SingleRGBDImagePipe::swap_in_images(ITMUChar4Image& rgbImage, ITMShortImage& depthImage, const boost::optional<Vector4i>& imageRegion)
 {
-  m_depthImage = depthImage;
-  m_rgbImage = rgbImage;
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  transfer_image(depthImage, *m_depthImage);
+  transfer_image(rgbImage, *m_rgbImage);
+  m_imageRegion = imageRegion;
+  m_imagesAvailable = true;
 }
 
 }
@@ -0,0 +1,43 @@
+/**
+ * spaint: SwappingCompositeImageSourceEngine.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "imagesources/SwappingCompositeImageSourceEngine.h"
+using namespace InputSource;
+
+#include "imagesources/AsyncImageSourceEngine.h"
+
+namespace spaint {
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SwappingCompositeImageSourceEngine::add_subengine(ImageSourceEngine *subengine)
+{
+  addSubengine(subengine);
+  m_subengines.push_back(subengine);
+}
+
+ImageSourceEngine *SwappingCompositeImageSourceEngine::get_current_subengine()
+{
+  // Look up the non-const version of the base class's current sub-engine in our own record of the sub-engines.
+  const ImageSourceEngine *currentSubengine = getCurrentSubengine();
+  for(size_t i = 0, size = m_subengines.size(); i < size; ++i)
+  {
+    if(m_subengines[i] == currentSubengine) return m_subengines[i];
+  }
+
+  return NULL;
+}
+
+void SwappingCompositeImageSourceEngine::getImages(ITMUChar4Image& rgb, ITMShortImage& rawDepth)
+{
+  // Note: Calling hasMoreImages makes the base class advance to the sub-engine that will provide the next images (if any).
+  if(!hasMoreImages()) return;
+
+  AsyncImageSourceEngine *asyncSubengine = dynamic_cast<AsyncImageSourceEngine*>(get_current_subengine());
+  if(asyncSubengine) asyncSubengine->getImages(rgb, rawDepth);
+  else getImages(&rgb, &rawDepth);
+}
+
+}
@@ -5,59 +5,116 @@
 
 #include "markers/cpu/VoxelMarker_CPU.h"
 
+#include <algorithm>
+
 #include "markers/shared/VoxelMarker_Shared.h"
 
 namespace spaint {
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
-void VoxelMarker_CPU::clear_labels(SpaintVoxel *voxels, int voxelCount, ClearingSettings settings) const
+void VoxelMarker_CPU::clear_labels(SpaintVoxelScene *scene, ClearingSettings settings) const
 {
+  SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
+  const int blockCount = scene->localVBA.allocatedSize / SDF_BLOCK_SIZE3;
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  SpaintVoxel::LabelEvidence *labelEvidence = scene->get_label_evidence_data();
+  unsigned int *labelCounts = scene->get_label_count_data();
+  unsigned int *labelPresence = scene->get_label_presence_data();
+  const unsigned int version = scene->advance_version();
+
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(dynamic, 64)
 #endif
-  for(int i = 0; i < voxelCount; ++i)
+  for(int blockIndex = 0; blockIndex < blockCount; ++blockIndex)
   {
-    clear_label(voxels[i], settings);
+    // If the label presence masks are being maintained, skip any block that cannot contain labels that need clearing.
+    unsigned int *blockPresence = labelPresence ? labelPresence + blockIndex * SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT : NULL;
+    if(blockPresence && !block_may_need_clearing(blockPresence, settings)) continue;
+
+    // Clear the labels of the voxels in the block as necessary, recording the labels that remain.
+    unsigned int remainingPresence[SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT] = {0,};
+    bool changed = false;
+    for(int i = blockIndex * SDF_BLOCK_SIZE3, end = i + SDF_BLOCK_SIZE3; i < end; ++i)
+    {
+      SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(i, voxelData, labelData);
+      if(clear_label(packedLabel, settings, labelCounts, labelEvidence ? &labelEvidence[i] : NULL)) changed = true;
+      if(!(packedLabel == SpaintVoxel::PackedLabel())) remainingPresence[packedLabel.label / 32] |= 1u << (packedLabel.label % 32);
+    }
+
+    if(blockPresence)
+    {
+      for(int j = 0; j < SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT; ++j) blockPresence[j] = remainingPresence[j];
+    }
+
+    if(changed) blockVersions[blockIndex].labels = version;
   }
+
+  clear_stored_labels(scene, settings);
 }
 
 void VoxelMarker_CPU::mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
                                   SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const
+{
+  mark_voxels_sub(voxelLocationsMB, label, NULL, scene, mode, oldVoxelLabelsMB);
+}
+
+void VoxelMarker_CPU::mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& voxelLabelsMB,
+                                  SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const
+{
+  mark_voxels_sub(voxelLocationsMB, SpaintVoxel::PackedLabel(), &voxelLabelsMB, scene, mode, oldVoxelLabelsMB);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelMarker_CPU::mark_voxels_sub(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
+                                      const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *voxelLabelsMB, SpaintVoxelScene *scene,
+                                      MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const
 {
   const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel::PackedLabel *voxelLabels = voxelLabelsMB ? voxelLabelsMB->GetData(MEMORYDEVICE_CPU) : NULL;
   SpaintVoxel::PackedLabel *oldVoxelLabels = oldVoxelLabelsMB ? oldVoxelLabelsMB->GetData(MEMORYDEVICE_CPU) : NULL;
   int voxelCount = static_cast<int>(voxelLocationsMB.dataSize);
+  if(voxelCount == 0) return;
 
+  SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
   SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  SpaintVoxel::LabelEvidence *labelEvidence = scene->get_label_evidence_data();
+  unsigned int *labelCounts = scene->get_label_count_data();
+  unsigned int *labelPresence = scene->get_label_presence_data();
+  unsigned char *relabelledBlockFlags = scene->get_relabelled_block_flags();
+  const unsigned int version = scene->advance_version();
   const ITMVoxelIndex::IndexData *voxelIndex = scene->index.getIndexData();
 
+  // Compute the sort keys of the voxel locations.
+  std::vector<unsigned long long> keys(voxelCount);
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
   for(int i = 0; i < voxelCount; ++i)
   {
-    mark_voxel(voxelLocations[i], label, oldVoxelLabels ? &oldVoxelLabels[i] : NULL, voxelData, voxelIndex, mode);
+    keys[i] = make_voxel_marking_key(voxelLocations[i]);
   }
-}
 
-void VoxelMarker_CPU::mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& voxelLabelsMB,
-                                  SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const
-{
-  const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
-  const SpaintVoxel::PackedLabel *voxelLabels = voxelLabelsMB.GetData(MEMORYDEVICE_CPU);
-  SpaintVoxel::PackedLabel *oldVoxelLabels = oldVoxelLabelsMB ? oldVoxelLabelsMB->GetData(MEMORYDEVICE_CPU) : NULL;
-  int voxelCount = static_cast<int>(voxelLocationsMB.dataSize);
+  // Stably sort the indices of the voxel locations by key, so that the locations in each voxel block become contiguous
+  // and any duplicate locations remain in input order.
+  std::vector<int> sortedIndices(voxelCount);
+  for(int i = 0; i < voxelCount; ++i) sortedIndices[i] = i;
+  std::stable_sort(sortedIndices.begin(), sortedIndices.end(), KeyComparator(keys));
 
-  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
-  const ITMVoxelIndex::IndexData *voxelIndex = scene->index.getIndexData();
+  std::vector<unsigned long long> sortedKeys(voxelCount);
+  for(int i = 0; i < voxelCount; ++i) sortedKeys[i] = keys[sortedIndices[i]];
 
+  // Mark the voxels in each voxel block (the iteration for the first element in each block does all the work for that block).
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(dynamic, 64)
 #endif
   for(int i = 0; i < voxelCount; ++i)
   {
-    mark_voxel(voxelLocations[i], voxelLabels[i], oldVoxelLabels ? &oldVoxelLabels[i] : NULL, voxelData, voxelIndex, mode);
+    mark_voxel_block(i, &sortedKeys[0], &sortedIndices[0], voxelCount, voxelLocations, label, voxelLabels, oldVoxelLabels, voxelData, labelData, labelEvidence, voxelIndex, mode, labelCounts, labelPresence, relabelledBlockFlags,
+                     blockVersions, version);
   }
 }
 
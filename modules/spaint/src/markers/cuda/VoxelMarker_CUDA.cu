@@ -5,77 +5,184 @@
 
 #include "markers/cuda/VoxelMarker_CUDA.h"
 
+#include <thrust/device_ptr.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
 #include "markers/shared/VoxelMarker_Shared.h"
 
 namespace spaint {
 
 //#################### CUDA KERNELS ####################
 
-__global__ void ck_clear_labels(SpaintVoxel *voxels, int voxelCount, ClearingSettings settings)
+__global__ void ck_clear_labels(SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData, SpaintVoxel::LabelEvidence *labelEvidence, int voxelCount,
+                                ClearingSettings settings, unsigned int *labelCounts, SpaintVoxelScene::BlockVersions *blockVersions, unsigned int version)
 {
   int tid = blockDim.x * blockIdx.x + threadIdx.x;
-  if(tid < voxelCount) clear_label(voxels[tid], settings);
+  if(tid < voxelCount && clear_label(get_voxel_label(tid, voxelData, labelData), settings, labelCounts, labelEvidence ? &labelEvidence[tid] : NULL))
+  {
+    blockVersions[tid / SDF_BLOCK_SIZE3].labels = version;
+  }
+}
+
+__global__ void ck_clear_labels_in_blocks(SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData, SpaintVoxel::LabelEvidence *labelEvidence,
+                                          ClearingSettings settings, unsigned int *labelCounts, unsigned int *labelPresence,
+                                          SpaintVoxelScene::BlockVersions *blockVersions, unsigned int version)
+{
+  // Note: Each thread block processes a single voxel block, with one thread per voxel.
+  __shared__ unsigned int remainingPresence[SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT];
+  __shared__ bool changed;
+
+  // If the voxel block cannot contain any labels that need clearing, early out (all threads in the block reach the same decision).
+  unsigned int *blockPresence = labelPresence + blockIdx.x * SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT;
+  if(!block_may_need_clearing(blockPresence, settings)) return;
+
+  if(threadIdx.x < SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT) remainingPresence[threadIdx.x] = 0;
+  if(threadIdx.x == 0) changed = false;
+  __syncthreads();
+
+  // Clear the label of this thread's voxel as necessary, and record the label that remains (if any) in the block's new mask.
+  const int voxelAddress = blockIdx.x * SDF_BLOCK_SIZE3 + threadIdx.x;
+  SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+  if(clear_label(packedLabel, settings, labelCounts, labelEvidence ? &labelEvidence[voxelAddress] : NULL)) changed = true;
+  if(!(packedLabel == SpaintVoxel::PackedLabel())) atomicOr(&remainingPresence[packedLabel.label / 32], 1u << (packedLabel.label % 32));
+  __syncthreads();
+
+  // Replace the block's mask, and stamp the block if any of its labels changed.
+  if(threadIdx.x < SpaintVoxelScene::LABEL_PRESENCE_WORD_COUNT) blockPresence[threadIdx.x] = remainingPresence[threadIdx.x];
+  if(threadIdx.x == 0 && changed) blockVersions[blockIdx.x].labels = version;
 }
 
-__global__ void ck_mark_voxels(const Vector3s *voxelLocations, SpaintVoxel::PackedLabel label, int voxelCount, SpaintVoxel::PackedLabel *oldVoxelLabels,
-                               SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *voxelIndex, MarkingMode mode)
+__global__ void ck_make_voxel_marking_keys(const Vector3s *voxelLocations, int voxelCount, unsigned long long *keys)
 {
   int tid = blockDim.x * blockIdx.x + threadIdx.x;
-  if(tid < voxelCount) mark_voxel(voxelLocations[tid], label, oldVoxelLabels ? &oldVoxelLabels[tid] : NULL, voxelData, voxelIndex, mode);
+  if(tid < voxelCount) keys[tid] = make_voxel_marking_key(voxelLocations[tid]);
 }
 
-__global__ void ck_mark_voxels(const Vector3s *voxelLocations, const SpaintVoxel::PackedLabel *voxelLabels, int voxelCount, SpaintVoxel::PackedLabel *oldVoxelLabels,
-                               SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *voxelIndex, MarkingMode mode)
+__global__ void ck_mark_voxel_blocks(const unsigned long long *sortedKeys, const int *sortedIndices, int voxelCount, const Vector3s *voxelLocations,
+                                     SpaintVoxel::PackedLabel label, const SpaintVoxel::PackedLabel *voxelLabels, SpaintVoxel::PackedLabel *oldVoxelLabels,
+                                     SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData, SpaintVoxel::LabelEvidence *labelEvidence,
+                                     const ITMVoxelIndex::IndexData *voxelIndex,
+                                     MarkingMode mode, unsigned int *labelCounts, unsigned int *labelPresence, unsigned char *relabelledBlockFlags,
+                                     SpaintVoxelScene::BlockVersions *blockVersions, unsigned int version)
 {
   int tid = blockDim.x * blockIdx.x + threadIdx.x;
-  if(tid < voxelCount) mark_voxel(voxelLocations[tid], voxelLabels[tid], oldVoxelLabels ? &oldVoxelLabels[tid] : NULL, voxelData, voxelIndex, mode);
+  if(tid < voxelCount)
+  {
+    mark_voxel_block(tid, sortedKeys, sortedIndices, voxelCount, voxelLocations, label, voxelLabels, oldVoxelLabels, voxelData, labelData, labelEvidence,
+                     voxelIndex, mode, labelCounts, labelPresence, relabelledBlockFlags, blockVersions, version);
+  }
 }
 
+//#################### CONSTRUCTORS ####################
+
+VoxelMarker_CUDA::VoxelMarker_CUDA()
+: m_keysMB(new ORUtils::MemoryBlock<unsigned long long>(1, false, true)),
+  m_sortedIndicesMB(new ORUtils::MemoryBlock<int>(1, false, true))
+{}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
-void VoxelMarker_CUDA::clear_labels(SpaintVoxel *voxels, int voxelCount, ClearingSettings settings) const
+void VoxelMarker_CUDA::clear_labels(SpaintVoxelScene *scene, ClearingSettings settings) const
 {
-  int threadsPerBlock = 256;
-  int numBlocks = (voxelCount + threadsPerBlock - 1) / threadsPerBlock;
-
-  ck_clear_labels<<<numBlocks,threadsPerBlock>>>(voxels, voxelCount, settings);
+  const unsigned int version = scene->advance_version();
+  unsigned int *labelPresence = scene->get_label_presence_data();
+
+  if(labelPresence)
+  {
+    // If the label presence masks are being maintained, clear the labels one voxel block at a time, so that the blocks that
+    // cannot contain any of the labels being cleared can be skipped after reading only their masks.
+    const int blockCount = scene->localVBA.allocatedSize / SDF_BLOCK_SIZE3;
+    ck_clear_labels_in_blocks<<<blockCount,SDF_BLOCK_SIZE3>>>(
+      scene->localVBA.GetVoxelBlocks(), scene->get_label_data(), scene->get_label_evidence_data(), settings,
+      scene->get_label_count_data(), labelPresence, scene->get_block_versions(), version
+    );
+  }
+  else
+  {
+    // Otherwise, visit every voxel in the scene.
+    int voxelCount = scene->localVBA.allocatedSize;
+
+    int threadsPerBlock = 256;
+    int numBlocks = (voxelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+    ck_clear_labels<<<numBlocks,threadsPerBlock>>>(
+      scene->localVBA.GetVoxelBlocks(), scene->get_label_data(), scene->get_label_evidence_data(), voxelCount, settings,
+      scene->get_label_count_data(), scene->get_block_versions(), version
+    );
+  }
+
+  // Note: The kernel launch is asynchronous, so the labels stored in the global cache (if any) are cleared on the host whilst it runs.
+  clear_stored_labels(scene, settings);
 }
 
 void VoxelMarker_CUDA::mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
                                    SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const
 {
-  int voxelCount = static_cast<int>(voxelLocationsMB.dataSize);
-
-  int threadsPerBlock = 256;
-  int numBlocks = (voxelCount + threadsPerBlock - 1) / threadsPerBlock;
-
-  ck_mark_voxels<<<numBlocks,threadsPerBlock>>>(
-    voxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
-    label,
-    voxelCount,
-    oldVoxelLabelsMB ? oldVoxelLabelsMB->GetData(MEMORYDEVICE_CUDA) : NULL,
-    scene->localVBA.GetVoxelBlocks(),
-    scene->index.getIndexData(),
-    mode
-  );
+  mark_voxels_sub(voxelLocationsMB, label, NULL, scene, mode, oldVoxelLabelsMB);
 }
 
 void VoxelMarker_CUDA::mark_voxels(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& voxelLabelsMB,
                                    SpaintVoxelScene *scene, MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const
+{
+  mark_voxels_sub(voxelLocationsMB, SpaintVoxel::PackedLabel(), &voxelLabelsMB, scene, mode, oldVoxelLabelsMB);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelMarker_CUDA::mark_voxels_sub(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, SpaintVoxel::PackedLabel label,
+                                       const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *voxelLabelsMB, SpaintVoxelScene *scene,
+                                       MarkingMode mode, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel> *oldVoxelLabelsMB) const
 {
   int voxelCount = static_cast<int>(voxelLocationsMB.dataSize);
+  if(voxelCount == 0) return;
+
+  // The scratch memory blocks are shared between calls, so only one set of voxels can be marked at a time.
+  boost::lock_guard<boost::mutex> lock(m_scratchMutex);
+
+  // Make sure that the scratch memory blocks are large enough to hold the keys and indices for all of the voxel locations.
+  if(m_keysMB->dataSize < static_cast<size_t>(voxelCount))
+  {
+    m_keysMB.reset(new ORUtils::MemoryBlock<unsigned long long>(voxelCount, false, true));
+    m_sortedIndicesMB.reset(new ORUtils::MemoryBlock<int>(voxelCount, false, true));
+  }
 
   int threadsPerBlock = 256;
   int numBlocks = (voxelCount + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_mark_voxels<<<numBlocks,threadsPerBlock>>>(
-    voxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
-    voxelLabelsMB.GetData(MEMORYDEVICE_CUDA),
+  const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CUDA);
+  unsigned long long *keys = m_keysMB->GetData(MEMORYDEVICE_CUDA);
+  int *sortedIndices = m_sortedIndicesMB->GetData(MEMORYDEVICE_CUDA);
+
+  // Compute the sort keys of the voxel locations.
+  ck_make_voxel_marking_keys<<<numBlocks,threadsPerBlock>>>(voxelLocations, voxelCount, keys);
+
+  // Stably sort the indices of the voxel locations by key, so that the locations in each voxel block become contiguous
+  // and any duplicate locations remain in input order.
+  thrust::device_ptr<unsigned long long> keysPtr(keys);
+  thrust::device_ptr<int> sortedIndicesPtr(sortedIndices);
+  thrust::sequence(sortedIndicesPtr, sortedIndicesPtr + voxelCount);
+  thrust::stable_sort_by_key(keysPtr, keysPtr + voxelCount, sortedIndicesPtr);
+
+  // Mark the voxels in each voxel block (the thread for the first element in each block does all the work for that block).
+  ck_mark_voxel_blocks<<<numBlocks,threadsPerBlock>>>(
+    keys,
+    sortedIndices,
     voxelCount,
+    voxelLocations,
+    label,
+    voxelLabelsMB ? voxelLabelsMB->GetData(MEMORYDEVICE_CUDA) : NULL,
     oldVoxelLabelsMB ? oldVoxelLabelsMB->GetData(MEMORYDEVICE_CUDA) : NULL,
     scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->get_label_evidence_data(),
     scene->index.getIndexData(),
-    mode
+    mode,
+    scene->get_label_count_data(),
+    scene->get_label_presence_data(),
+    scene->get_relabelled_block_flags(),
+    scene->get_block_versions(),
+    scene->advance_version()
   );
 }
 
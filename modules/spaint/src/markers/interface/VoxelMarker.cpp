@@ -0,0 +1,37 @@
+/**
+ * spaint: VoxelMarker.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "markers/interface/VoxelMarker.h"
+
+#include "markers/shared/VoxelMarker_Shared.h"
+
+namespace spaint {
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
+
+void VoxelMarker::clear_stored_labels(SpaintVoxelScene *scene, ClearingSettings settings) const
+{
+  // If the scene is not being swapped, early out.
+  if(!scene->globalCache) return;
+
+  // Note: Swapping is never used in conjunction with a separate label volume, so the stored labels are always in the voxels themselves.
+  const int entryCount = scene->index.noTotalEntries;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int entryID = 0; entryID < entryCount; ++entryID)
+  {
+    if(!scene->globalCache->HasStoredData(entryID)) continue;
+
+    SpaintVoxel *storedBlock = scene->globalCache->GetStoredVoxelBlock(entryID);
+    for(int i = 0; i < SDF_BLOCK_SIZE3; ++i)
+    {
+      clear_label(get_voxel_label(i, storedBlock, NULL), settings);
+    }
+  }
+}
+
+}
@@ -0,0 +1,100 @@
+/**
+ * spaint: BlockMeshCache.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "meshing/BlockMeshCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+BlockMeshCache::BlockMeshCache(const LabelledMeshingEngine_Ptr& meshingEngine)
+: m_meshingEngine(meshingEngine)
+{
+  if(!meshingEngine)
+  {
+    throw std::invalid_argument("Error: Cannot initialise a BlockMeshCache with a NULL meshing engine");
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+const std::map<int,BlockMeshCache::BlockMesh_CPtr>& BlockMeshCache::get_block_meshes() const
+{
+  return m_blockMeshes;
+}
+
+size_t BlockMeshCache::get_triangle_count() const
+{
+  size_t triangleCount = 0;
+  for(std::map<int,BlockMesh_CPtr>::const_iterator it = m_blockMeshes.begin(), iend = m_blockMeshes.end(); it != iend; ++it)
+  {
+    triangleCount += it->second->size();
+  }
+  return triangleCount;
+}
+
+BlockMeshCache::Changes BlockMeshCache::update(const SpaintVoxelScene *scene)
+{
+  Changes changes;
+
+  // Note: Any voxel blocks that change after this point will be stamped with a later version, and so be re-meshed by the next update.
+  const unsigned int version = scene->get_version();
+
+  // Record the voxel blocks that need to be re-meshed. If the scene has been reset since the cache was last updated (or the cache
+  // has never been updated), the blocks from which the cached meshes were made no longer exist, so the cache must be rebuilt.
+  int blockCount;
+  changes.reset = !m_version || scene->get_reset_version() > *m_version;
+  if(changes.reset)
+  {
+    m_blockMeshes.clear();
+    blockCount = m_meshingEngine->prepare(scene);
+  }
+  else blockCount = m_meshingEngine->prepare_changed(scene, *m_version);
+
+  // Re-mesh the recorded blocks in batches, and replace (or remove) their cached meshes.
+  std::vector<int> entryIDs, triangleEntryIDs;
+  std::vector<Triangle> triangles;
+  for(int firstBlock = 0; firstBlock < blockCount; firstBlock += LabelledMeshingEngine::MAX_BATCH_BLOCK_COUNT)
+  {
+    const int batchBlockCount = std::min(blockCount - firstBlock, static_cast<int>(LabelledMeshingEngine::MAX_BATCH_BLOCK_COUNT));
+
+    triangles.clear();
+    triangleEntryIDs.clear();
+    m_meshingEngine->mesh_blocks(scene, firstBlock, batchBlockCount, triangles, &triangleEntryIDs);
+    m_meshingEngine->get_prepared_entry_ids(firstBlock, batchBlockCount, entryIDs);
+
+    // Group the triangles produced by the batch by the voxel blocks that produced them.
+    std::map<int,boost::shared_ptr<std::vector<Triangle> > > batchMeshes;
+    for(size_t i = 0, size = triangles.size(); i < size; ++i)
+    {
+      boost::shared_ptr<std::vector<Triangle> >& batchMesh = batchMeshes[triangleEntryIDs[i]];
+      if(!batchMesh) batchMesh.reset(new std::vector<Triangle>);
+      batchMesh->push_back(triangles[i]);
+    }
+
+    // Update the cache. Note that blocks that no longer produce any triangles have their cached meshes removed.
+    for(size_t i = 0, size = entryIDs.size(); i < size; ++i)
+    {
+      std::map<int,boost::shared_ptr<std::vector<Triangle> > >::const_iterator it = batchMeshes.find(entryIDs[i]);
+      if(it != batchMeshes.end())
+      {
+        m_blockMeshes[entryIDs[i]] = it->second;
+        changes.changedBlocks[entryIDs[i]] = it->second;
+      }
+      else if(m_blockMeshes.erase(entryIDs[i]) > 0)
+      {
+        changes.removedBlocks.push_back(entryIDs[i]);
+      }
+    }
+  }
+
+  m_version = version;
+  return changes;
+}
+
+}
@@ -0,0 +1,39 @@
+/**
+ * spaint: LabelledMeshingEngineFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "meshing/LabelledMeshingEngineFactory.h"
+using namespace ITMLib;
+
+#include "meshing/cpu/LabelledMeshingEngine_CPU.h"
+
+#ifdef WITH_CUDA
+#include "meshing/cuda/LabelledMeshingEngine_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+LabelledMeshingEngine_Ptr LabelledMeshingEngineFactory::make_labelled_meshing_engine(ITMLibSettings::DeviceType deviceType)
+{
+  LabelledMeshingEngine_Ptr meshingEngine;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    meshingEngine.reset(new LabelledMeshingEngine_CUDA);
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    meshingEngine.reset(new LabelledMeshingEngine_CPU);
+  }
+
+  return meshingEngine;
+}
+
+}
@@ -0,0 +1,293 @@
+/**
+ * spaint: MeshExporter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "meshing/MeshExporter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/timing/ProfilingScope.h>
+using namespace tvgutil;
+
+namespace {
+
+//#################### LOCAL CONSTANTS ####################
+
+/** The width (in characters) reserved in the PLY header for each element count. */
+const int COUNT_WIDTH = 10;
+
+/** The number of faces to write to the PLY file at a time. */
+const size_t FACE_BUFFER_SIZE = 4096;
+
+/** The size (in bytes) of a face in the PLY file (a vertex count, followed by three vertex indices). */
+const size_t FACE_SIZE = 1 + 3 * sizeof(int);
+
+/** The size (in bytes) of a vertex in the PLY file (a position, followed by a colour and a semantic label). */
+const size_t VERTEX_SIZE = 3 * sizeof(float) + 4;
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Determines whether or not the machine on which we are running is little-endian.
+ *
+ * \return  true, if the machine is little-endian, or false otherwise.
+ */
+bool is_little_endian()
+{
+  const unsigned short x = 1;
+  return *reinterpret_cast<const unsigned char*>(&x) == 1;
+}
+
+}
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+MeshExporter::MeshExporter(const LabelledMeshingEngine_Ptr& meshingEngine, const LabelManager_CPtr& labelManager)
+: m_blockCount(0),
+  m_labelManager(labelManager),
+  m_meshingEngine(meshingEngine),
+  m_meshingFinished(false),
+  m_nextBlock(0),
+  m_triangleCount(0),
+  m_writerShouldTerminate(false)
+{
+  if(!meshingEngine)
+  {
+    throw std::invalid_argument("Error: Cannot initialise a MeshExporter with a NULL meshing engine");
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+MeshExporter::~MeshExporter()
+{
+  cancel();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void MeshExporter::cancel()
+{
+  if(!m_writer.joinable()) return;
+
+  // Tell the writer thread to abandon the export (it deletes the partially-written file itself), and wait for it to terminate.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_writerShouldTerminate = true;
+    m_pendingBatches.clear();
+  }
+  m_pendingBatchesChanged.notify_all();
+  m_writer.join();
+
+  m_blockCount = m_nextBlock = 0;
+}
+
+void MeshExporter::finish(const SpaintVoxelScene *scene)
+{
+  while(is_meshing()) mesh_next_batch(scene, LabelledMeshingEngine::MAX_BATCH_BLOCK_COUNT);
+  if(m_writer.joinable()) m_writer.join();
+}
+
+bool MeshExporter::is_meshing() const
+{
+  return m_nextBlock < m_blockCount;
+}
+
+void MeshExporter::start(const std::string& path, const SpaintVoxelScene *scene)
+{
+  // If a previous export is still in progress, finish it first.
+  finish(scene);
+
+  // Open the PLY file and write its header.
+  boost::shared_ptr<std::ofstream> os(new std::ofstream(path.c_str(), std::ios::binary));
+  if(!*os) throw std::runtime_error("Error: Could not open " + path + " for writing");
+
+  m_os = os;
+  m_path = path;
+  m_triangleCount = 0;
+  write_header();
+
+  // Record the voxel blocks to mesh.
+  m_blockCount = m_meshingEngine->prepare(scene);
+  m_nextBlock = 0;
+  m_meshingFinished = m_blockCount == 0;
+  m_writerShouldTerminate = false;
+
+  // Start the writer thread.
+  m_writer = boost::thread(boost::bind(&MeshExporter::run_writer, this));
+}
+
+void MeshExporter::update(const SpaintVoxelScene *scene, int maxBlockCount)
+{
+  while(maxBlockCount > 0 && is_meshing())
+  {
+    const int blockCount = std::min(maxBlockCount, static_cast<int>(LabelledMeshingEngine::MAX_BATCH_BLOCK_COUNT));
+    mesh_next_batch(scene, blockCount);
+    maxBlockCount -= blockCount;
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MeshExporter::mesh_next_batch(const SpaintVoxelScene *scene, int blockCount)
+{
+  // Mesh the next batch of voxel blocks.
+  blockCount = std::min(blockCount, m_blockCount - m_nextBlock);
+  TriangleBatch_Ptr batch(new std::vector<Triangle>);
+  {
+    ProfilingScope profilingScope("MeshExporter.MeshBatch");
+    m_meshingEngine->mesh_blocks(scene, m_nextBlock, blockCount, *batch);
+  }
+  m_nextBlock += blockCount;
+
+  // Hand the triangles to the writer thread, first waiting for it to catch up if it has fallen too far behind.
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while(m_pendingBatches.size() >= MAX_PENDING_BATCH_COUNT) m_pendingBatchesChanged.wait(lock);
+    if(!batch->empty()) m_pendingBatches.push_back(batch);
+    if(!is_meshing()) m_meshingFinished = true;
+  }
+  m_pendingBatchesChanged.notify_all();
+}
+
+void MeshExporter::run_writer()
+{
+  std::vector<unsigned char> buffer;
+  bool completed = false;
+
+  Profiler::instance().set_thread_name("Mesh writer");
+
+  for(;;)
+  {
+    // Wait until there is a batch to write, meshing has finished, or the export is cancelled.
+    TriangleBatch_Ptr batch;
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(!m_writerShouldTerminate && !m_meshingFinished && m_pendingBatches.empty()) m_pendingBatchesChanged.wait(lock);
+
+      if(m_writerShouldTerminate) break;
+      if(m_pendingBatches.empty())
+      {
+        completed = true;
+        break;
+      }
+
+      batch = m_pendingBatches.front();
+      m_pendingBatches.pop_front();
+    }
+    m_pendingBatchesChanged.notify_all();
+
+    // Write the vertices of the triangles in the batch (note that no lock is held whilst writing).
+    ProfilingScope profilingScope("MeshExporter.WriteBatch");
+    const std::vector<Triangle>& triangles = *batch;
+    buffer.resize(triangles.size() * 3 * VERTEX_SIZE);
+    unsigned char *p = &buffer[0];
+    for(size_t i = 0, size = triangles.size(); i < size; ++i)
+    {
+      for(int j = 0; j < 3; ++j, p += VERTEX_SIZE)
+      {
+        const LabelledMeshingEngine::Vertex& v = triangles[i].vertices[j];
+        memcpy(p, &v.position.x, sizeof(float));
+        memcpy(p + sizeof(float), &v.position.y, sizeof(float));
+        memcpy(p + 2 * sizeof(float), &v.position.z, sizeof(float));
+        p[3 * sizeof(float)] = v.colour.r;
+        p[3 * sizeof(float) + 1] = v.colour.g;
+        p[3 * sizeof(float) + 2] = v.colour.b;
+        p[3 * sizeof(float) + 3] = v.label;
+      }
+    }
+
+    m_os->write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
+    m_triangleCount += triangles.size();
+  }
+
+  if(completed)
+  {
+    // Write the faces (each of which simply refers to the next three vertices).
+    buffer.resize(FACE_BUFFER_SIZE * FACE_SIZE);
+    for(size_t i = 0; i < m_triangleCount; i += FACE_BUFFER_SIZE)
+    {
+      const size_t faceCount = std::min(FACE_BUFFER_SIZE, m_triangleCount - i);
+      unsigned char *p = &buffer[0];
+      for(size_t j = 0; j < faceCount; ++j, p += FACE_SIZE)
+      {
+        const int baseIndex = static_cast<int>(3 * (i + j));
+        const int indices[] = { baseIndex, baseIndex + 1, baseIndex + 2 };
+        p[0] = 3;
+        memcpy(p + 1, indices, sizeof(indices));
+      }
+      m_os->write(reinterpret_cast<const char*>(&buffer[0]), faceCount * FACE_SIZE);
+    }
+
+    // Fill in the element counts in the header.
+    patch_count(*m_os, m_vertexCountPos, 3 * m_triangleCount);
+    patch_count(*m_os, m_faceCountPos, m_triangleCount);
+  }
+
+  m_os->close();
+
+  if(completed && !m_os->fail())
+  {
+    std::cout << "[spaint] Finished saving mesh (" << m_triangleCount << " triangles) to " << m_path << '\n';
+  }
+  else
+  {
+    if(completed) std::cerr << "Error: Could not write a mesh to " << m_path << '\n';
+    std::remove(m_path.c_str());
+  }
+
+  m_os.reset();
+}
+
+void MeshExporter::write_header()
+{
+  std::ostream& os = *m_os;
+  os << "ply\n"
+     << "format " << (is_little_endian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+     << "comment Exported by spaint\n";
+
+  if(m_labelManager)
+  {
+    for(size_t i = 0, count = m_labelManager->get_label_count(); i < count; ++i)
+    {
+      const SpaintVoxel::Label label = static_cast<SpaintVoxel::Label>(i);
+      os << "comment label " << i << ' ' << m_labelManager->get_label_name(label) << '\n';
+    }
+  }
+
+  os << "element vertex ";
+  m_vertexCountPos = os.tellp();
+  os << std::setw(COUNT_WIDTH) << 0 << '\n'
+     << "property float x\n"
+     << "property float y\n"
+     << "property float z\n"
+     << "property uchar red\n"
+     << "property uchar green\n"
+     << "property uchar blue\n"
+     << "property uchar label\n"
+     << "element face ";
+  m_faceCountPos = os.tellp();
+  os << std::setw(COUNT_WIDTH) << 0 << '\n'
+     << "property list uchar int vertex_indices\n"
+     << "end_header\n";
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+void MeshExporter::patch_count(std::ostream& os, std::streampos pos, size_t count)
+{
+  os.seekp(pos);
+  os << std::setw(COUNT_WIDTH) << count;
+}
+
+}
@@ -0,0 +1,72 @@
+/**
+ * spaint: LabelledMeshingEngine_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "meshing/cpu/LabelledMeshingEngine_CPU.h"
+using namespace ITMLib;
+
+#include <algorithm>
+
+#include "meshing/shared/LabelledMeshingEngine_Shared.h"
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void LabelledMeshingEngine_CPU::copy_entry_ids_to_host(int firstBlock, int blockCount, int *entryIDs) const
+{
+  const int *src = m_entryIDsMB->GetData(MEMORYDEVICE_CPU) + firstBlock;
+  std::copy(src, src + blockCount, entryIDs);
+}
+
+int LabelledMeshingEngine_CPU::find_changed_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion) const
+{
+  const SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+
+  int entryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    if(is_changed_entry(entryID, hashTable, blockVersions, sinceVersion)) entryIDs[entryCount++] = entryID;
+  }
+
+  return entryCount;
+}
+
+int LabelledMeshingEngine_CPU::find_resident_entries(const SpaintVoxelScene *scene) const
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+
+  int entryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    if(is_resident_entry(entryID, hashTable)) entryIDs[entryCount++] = entryID;
+  }
+
+  return entryCount;
+}
+
+bool LabelledMeshingEngine_CPU::mesh_batch(const SpaintVoxelScene *scene, int firstBlock, int blockCount, std::vector<Triangle>& triangles, std::vector<int> *triangleEntryIDs) const
+{
+  const int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU) + firstBlock;
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const float voxelSize = scene->sceneParams->voxelSize;
+
+  // Note: The triangles are appended directly to the output vector, so there is no limit on the number that a batch can produce.
+  Triangle cellTriangles[MAX_VOXEL_TRIANGLE_COUNT];
+  for(int i = 0, voxelCount = blockCount * SDF_BLOCK_SIZE3; i < voxelCount; ++i)
+  {
+    const int cellTriangleCount = mesh_cell(i, entryIDs, hashTable, voxelData, labelData, voxelSize, cellTriangles);
+    triangles.insert(triangles.end(), cellTriangles, cellTriangles + cellTriangleCount);
+    if(triangleEntryIDs) triangleEntryIDs->insert(triangleEntryIDs->end(), cellTriangleCount, entryIDs[i / SDF_BLOCK_SIZE3]);
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,160 @@
+/**
+ * spaint: LabelledMeshingEngine_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "meshing/cuda/LabelledMeshingEngine_CUDA.h"
+using namespace ITMLib;
+
+#include <ORUtils/CUDADefines.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "meshing/shared/LabelledMeshingEngine_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_find_changed_entries(const ITMHashEntry *hashTable, const SpaintVoxelScene::BlockVersions *blockVersions, unsigned int sinceVersion,
+                                        int *entryIDs, int *entryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < ITMVoxelBlockHash::noTotalEntries && is_changed_entry(entryID, hashTable, blockVersions, sinceVersion))
+  {
+    entryIDs[atomicAdd(entryCount, 1)] = entryID;
+  }
+}
+
+__global__ void ck_find_resident_entries(const ITMHashEntry *hashTable, int *entryIDs, int *entryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < ITMVoxelBlockHash::noTotalEntries && is_resident_entry(entryID, hashTable))
+  {
+    entryIDs[atomicAdd(entryCount, 1)] = entryID;
+  }
+}
+
+__global__ void ck_mesh_cells(int voxelCount, const int *entryIDs, const ITMHashEntry *hashTable, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                              float voxelSize, LabelledMeshingEngine::Triangle *triangles, int *triangleEntryIDs, unsigned int *triangleCount)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < voxelCount)
+  {
+    LabelledMeshingEngine::Triangle cellTriangles[LabelledMeshingEngine::MAX_VOXEL_TRIANGLE_COUNT];
+    const int cellTriangleCount = mesh_cell(i, entryIDs, hashTable, voxelData, labelData, voxelSize, cellTriangles);
+    if(cellTriangleCount == 0) return;
+
+    // Note: Triangles beyond the capacity of the output array are dropped, but still counted, so that the caller can detect the overflow.
+    const unsigned int offset = atomicAdd(triangleCount, static_cast<unsigned int>(cellTriangleCount));
+    for(int j = 0; j < cellTriangleCount; ++j)
+    {
+      if(offset + j < static_cast<unsigned int>(LabelledMeshingEngine::MAX_BATCH_TRIANGLE_COUNT))
+      {
+        triangles[offset + j] = cellTriangles[j];
+        if(triangleEntryIDs) triangleEntryIDs[offset + j] = entryIDs[i / SDF_BLOCK_SIZE3];
+      }
+    }
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+LabelledMeshingEngine_CUDA::LabelledMeshingEngine_CUDA()
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_entryCountMB = mbf.make_block<int>(1, "LabelledMeshingEngine");
+  m_triangleCountMB = mbf.make_block<unsigned int>(1, "LabelledMeshingEngine");
+  m_triangleEntryIDsMB = mbf.make_block<int>(MAX_BATCH_TRIANGLE_COUNT, "LabelledMeshingEngine");
+  m_trianglesMB = mbf.make_block<Triangle>(MAX_BATCH_TRIANGLE_COUNT, "LabelledMeshingEngine");
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void LabelledMeshingEngine_CUDA::copy_entry_ids_to_host(int firstBlock, int blockCount, int *entryIDs) const
+{
+  ORcudaSafeCall(cudaMemcpy(entryIDs, m_entryIDsMB->GetData(MEMORYDEVICE_CUDA) + firstBlock, blockCount * sizeof(int), cudaMemcpyDeviceToHost));
+}
+
+int LabelledMeshingEngine_CUDA::find_changed_entries(const SpaintVoxelScene *scene, unsigned int sinceVersion) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (ITMVoxelBlockHash::noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_entryCountMB->Clear();
+
+  ck_find_changed_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    scene->get_block_versions(),
+    sinceVersion,
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_entryCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_entryCountMB->UpdateHostFromDevice();
+  return *m_entryCountMB->GetData(MEMORYDEVICE_CPU);
+}
+
+int LabelledMeshingEngine_CUDA::find_resident_entries(const SpaintVoxelScene *scene) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (ITMVoxelBlockHash::noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_entryCountMB->Clear();
+
+  ck_find_resident_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_entryCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_entryCountMB->UpdateHostFromDevice();
+  return *m_entryCountMB->GetData(MEMORYDEVICE_CPU);
+}
+
+bool LabelledMeshingEngine_CUDA::mesh_batch(const SpaintVoxelScene *scene, int firstBlock, int blockCount, std::vector<Triangle>& triangles, std::vector<int> *triangleEntryIDs) const
+{
+  const int voxelCount = blockCount * SDF_BLOCK_SIZE3;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (voxelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_triangleCountMB->Clear();
+
+  ck_mesh_cells<<<numBlocks,threadsPerBlock>>>(
+    voxelCount,
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA) + firstBlock,
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->sceneParams->voxelSize,
+    m_trianglesMB->GetData(MEMORYDEVICE_CUDA),
+    triangleEntryIDs ? m_triangleEntryIDsMB->GetData(MEMORYDEVICE_CUDA) : NULL,
+    m_triangleCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // If the batch produced more triangles than we could store, signal to the caller that it needs to be split.
+  m_triangleCountMB->UpdateHostFromDevice();
+  const unsigned int triangleCount = *m_triangleCountMB->GetData(MEMORYDEVICE_CPU);
+  if(triangleCount > static_cast<unsigned int>(MAX_BATCH_TRIANGLE_COUNT)) return false;
+
+  // Otherwise, copy only the triangles that were actually produced across to the host.
+  if(triangleCount > 0)
+  {
+    const size_t oldSize = triangles.size();
+    triangles.resize(oldSize + triangleCount);
+    ORcudaSafeCall(cudaMemcpy(&triangles[oldSize], m_trianglesMB->GetData(MEMORYDEVICE_CUDA), triangleCount * sizeof(Triangle), cudaMemcpyDeviceToHost));
+
+    if(triangleEntryIDs)
+    {
+      const size_t oldIDCount = triangleEntryIDs->size();
+      triangleEntryIDs->resize(oldIDCount + triangleCount);
+      ORcudaSafeCall(cudaMemcpy(&(*triangleEntryIDs)[oldIDCount], m_triangleEntryIDsMB->GetData(MEMORYDEVICE_CUDA), triangleCount * sizeof(int), cudaMemcpyDeviceToHost));
+    }
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,72 @@
+/**
+ * spaint: LabelledMeshingEngine.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "meshing/interface/LabelledMeshingEngine.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+LabelledMeshingEngine::LabelledMeshingEngine()
+: m_preparedBlockCount(0)
+{
+  m_entryIDsMB = MemoryBlockFactory::instance().make_block<int>(ITMVoxelBlockHash::noTotalEntries, "LabelledMeshingEngine");
+}
+
+//#################### DESTRUCTOR ####################
+
+LabelledMeshingEngine::~LabelledMeshingEngine() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void LabelledMeshingEngine::get_prepared_entry_ids(int firstBlock, int blockCount, std::vector<int>& entryIDs) const
+{
+  if(firstBlock < 0 || blockCount < 0 || firstBlock + blockCount > m_preparedBlockCount)
+  {
+    throw std::invalid_argument("Error: Invalid range of voxel blocks");
+  }
+
+  entryIDs.resize(blockCount);
+  if(blockCount > 0) copy_entry_ids_to_host(firstBlock, blockCount, &entryIDs[0]);
+}
+
+void LabelledMeshingEngine::mesh_blocks(const SpaintVoxelScene *scene, int firstBlock, int blockCount, std::vector<Triangle>& triangles, std::vector<int> *triangleEntryIDs) const
+{
+  if(firstBlock < 0 || blockCount < 0 || blockCount > MAX_BATCH_BLOCK_COUNT || firstBlock + blockCount > m_preparedBlockCount)
+  {
+    throw std::invalid_argument("Error: Invalid range of voxel blocks to mesh");
+  }
+
+  if(blockCount == 0) return;
+
+  // If the batch produces too many triangles to be meshed in one go, split it in half and mesh each half separately.
+  // Note that this always terminates, since a single voxel block can never produce more than MAX_BATCH_TRIANGLE_COUNT triangles.
+  if(!mesh_batch(scene, firstBlock, blockCount, triangles, triangleEntryIDs))
+  {
+    const int halfCount = blockCount / 2;
+    mesh_blocks(scene, firstBlock, halfCount, triangles, triangleEntryIDs);
+    mesh_blocks(scene, firstBlock + halfCount, blockCount - halfCount, triangles, triangleEntryIDs);
+  }
+}
+
+int LabelledMeshingEngine::prepare(const SpaintVoxelScene *scene)
+{
+  m_preparedBlockCount = find_resident_entries(scene);
+  return m_preparedBlockCount;
+}
+
+int LabelledMeshingEngine::prepare_changed(const SpaintVoxelScene *scene, unsigned int sinceVersion)
+{
+  m_preparedBlockCount = find_changed_entries(scene, sinceVersion);
+  return m_preparedBlockCount;
+}
+
+}
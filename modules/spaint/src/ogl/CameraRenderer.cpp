@@ -5,6 +5,8 @@
 
 #include "ogl/CameraRenderer.h"
 
+#include <stdexcept>
+
 #include <rigging/SimpleCamera.h>
 using namespace rigging;
 
@@ -12,6 +14,40 @@ using namespace rigging;
 
 namespace spaint {
 
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+VertexBufferMesh_CPtr CameraRenderer::make_axes_mesh(AxesType axesType)
+{
+  // The mesh is rendered with the camera's u, v and n axes as its x, y and z axes (see render_cameras),
+  // so the XYZ axes (which point along -u, -v and n) are built with negated x and y directions.
+  const float sign = axesType == AXES_NUV ? 1.0f : -1.0f;
+
+  std::vector<Eigen::Vector3f> vertices;
+  vertices.push_back(Eigen::Vector3f::Zero()); vertices.push_back(Eigen::Vector3f(sign, 0.0f, 0.0f));
+  vertices.push_back(Eigen::Vector3f::Zero()); vertices.push_back(Eigen::Vector3f(0.0f, sign, 0.0f));
+  vertices.push_back(Eigen::Vector3f::Zero()); vertices.push_back(Eigen::Vector3f(0.0f, 0.0f, 1.0f));
+
+  std::vector<Eigen::Vector3f> colours;
+  switch(axesType)
+  {
+    case AXES_NUV:
+      colours.resize(2, Eigen::Vector3f(1.0f, 1.0f, 0.0f));
+      colours.resize(4, Eigen::Vector3f(0.0f, 1.0f, 1.0f));
+      colours.resize(6, Eigen::Vector3f(1.0f, 0.0f, 1.0f));
+      break;
+    default:  // AXES_XYZ
+      colours.resize(2, Eigen::Vector3f(1.0f, 0.0f, 0.0f));
+      colours.resize(4, Eigen::Vector3f(0.0f, 1.0f, 0.0f));
+      colours.resize(6, Eigen::Vector3f(0.0f, 0.0f, 1.0f));
+      break;
+  }
+
+  std::vector<GLuint> indices;
+  for(GLuint i = 0; i < 6; ++i) indices.push_back(i);
+
+  return VertexBufferMesh_CPtr(new VertexBufferMesh(GL_LINES, vertices, indices, colours));
+}
+
 void CameraRenderer::render_camera(const Camera& cam, AxesType axesType, float axisScale, const boost::optional<Vector3f>& bodyColour, double bodyScale)
 {
   const Eigen::Vector3f n = cam.n() * axisScale, p = cam.p(), u = cam.u() * axisScale, v = cam.v() * axisScale;
@@ -49,4 +85,52 @@ void CameraRenderer::render_camera(const Camera& cam, AxesType axesType, float a
   glPopMatrix();
 }
 
+void CameraRenderer::render_cameras(const std::vector<SimpleCamera>& cams, const VertexBufferMesh& axesMesh, float axisScale,
+                                    const VertexBufferMesh_CPtr& bodyMesh, const std::vector<Vector3f>& bodyColours, double bodyScale)
+{
+  // If a body mesh was specified, render the cameras' bodies as wireframe spheres.
+  if(bodyMesh)
+  {
+    if(bodyColours.size() != cams.size()) throw std::invalid_argument("Error: Each camera whose body is to be rendered must have a body colour");
+
+    glMatrixMode(GL_MODELVIEW);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    bodyMesh->bind();
+    for(size_t i = 0, size = cams.size(); i < size; ++i)
+    {
+      const Eigen::Vector3f& p = cams[i].p();
+      glColor3f(bodyColours[i].r, bodyColours[i].g, bodyColours[i].b);
+      glPushMatrix();
+      glTranslatef(p.x(), p.y(), p.z());
+      glScaled(bodyScale, bodyScale, bodyScale);
+      bodyMesh->draw();
+      glPopMatrix();
+    }
+    bodyMesh->unbind();
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  }
+
+  // Render the cameras' axes.
+  glMatrixMode(GL_MODELVIEW);
+  axesMesh.bind();
+  for(size_t i = 0, size = cams.size(); i < size; ++i)
+  {
+    const SimpleCamera& cam = cams[i];
+    const Eigen::Vector3f n = cam.n() * axisScale, p = cam.p(), u = cam.u() * axisScale, v = cam.v() * axisScale;
+
+    Eigen::Matrix4f m;
+    m(0,0) = u.x(); m(0,1) = v.x(); m(0,2) = n.x(); m(0,3) = p.x();
+    m(1,0) = u.y(); m(1,1) = v.y(); m(1,2) = n.y(); m(1,3) = p.y();
+    m(2,0) = u.z(); m(2,1) = v.z(); m(2,2) = n.z(); m(2,3) = p.z();
+    m(3,0) = m(3,1) = m(3,2) = 0.0f;
+    m(3,3) = 1.0f;
+
+    glPushMatrix();
+    glMultMatrixf(m.data());
+    axesMesh.draw();
+    glPopMatrix();
+  }
+  axesMesh.unbind();
+}
+
 }
@@ -5,6 +5,9 @@
 
 #include "ogl/QuadricRenderer.h"
 
+#include <cmath>
+#include <stdexcept>
+
 #include <rigging/SimpleCamera.h>
 using namespace rigging;
 
@@ -12,6 +15,67 @@ namespace spaint {
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
+VertexBufferMesh_CPtr QuadricRenderer::make_cylinder_mesh(int slices, int stacks)
+{
+  std::vector<Eigen::Vector3f> vertices;
+  for(int i = 0; i <= stacks; ++i)
+  {
+    const float z = static_cast<float>(i) / stacks;
+    for(int j = 0; j < slices; ++j)
+    {
+      const float theta = static_cast<float>(2 * M_PI * j / slices);
+      vertices.push_back(Eigen::Vector3f(sinf(theta), cosf(theta), z));
+    }
+  }
+
+  std::vector<GLuint> indices;
+  for(int i = 0; i < stacks; ++i)
+  {
+    for(int j = 0; j < slices; ++j)
+    {
+      const int k = (j + 1) % slices;
+      indices.push_back(i * slices + j);
+      indices.push_back(i * slices + k);
+      indices.push_back((i + 1) * slices + k);
+      indices.push_back((i + 1) * slices + j);
+    }
+  }
+
+  return VertexBufferMesh_CPtr(new VertexBufferMesh(GL_QUADS, vertices, indices));
+}
+
+VertexBufferMesh_CPtr QuadricRenderer::make_sphere_mesh(int slices, int stacks)
+{
+  // Note: Each ring of vertices (including the degenerate rings at the poles) has slices + 1 vertices,
+  //       so that the quads around the seam do not need to wrap their indices.
+  std::vector<Eigen::Vector3f> vertices;
+  for(int i = 0; i <= stacks; ++i)
+  {
+    const float phi = static_cast<float>(M_PI * i / stacks);
+    const float r = sinf(phi), z = cosf(phi);
+    for(int j = 0; j <= slices; ++j)
+    {
+      const float theta = static_cast<float>(2 * M_PI * j / slices);
+      vertices.push_back(Eigen::Vector3f(r * sinf(theta), r * cosf(theta), z));
+    }
+  }
+
+  std::vector<GLuint> indices;
+  const int ringSize = slices + 1;
+  for(int i = 0; i < stacks; ++i)
+  {
+    for(int j = 0; j < slices; ++j)
+    {
+      indices.push_back(i * ringSize + j);
+      indices.push_back((i + 1) * ringSize + j);
+      indices.push_back((i + 1) * ringSize + j + 1);
+      indices.push_back(i * ringSize + j + 1);
+    }
+  }
+
+  return VertexBufferMesh_CPtr(new VertexBufferMesh(GL_QUADS, vertices, indices));
+}
+
 void QuadricRenderer::render_cylinder(const Eigen::Vector3f& baseCentre, const Eigen::Vector3f& topCentre,
                                       double baseRadius, double topRadius, int slices, int stacks,
                                       const boost::optional<boost::shared_ptr<GLUquadric> >& optionalQuadric)
@@ -26,6 +90,28 @@ void QuadricRenderer::render_cylinder(const Eigen::Vector3f& baseCentre, const E
   end_oriented_quadric();
 }
 
+void QuadricRenderer::render_cylinders(const VertexBufferMesh& mesh, const std::vector<Eigen::Vector3f>& baseCentres,
+                                       const std::vector<Eigen::Vector3f>& topCentres, const std::vector<float>& radii)
+{
+  if(topCentres.size() != baseCentres.size() || radii.size() != baseCentres.size())
+  {
+    throw std::invalid_argument("Error: Each cylinder to be rendered must have a base centre, a top centre and a radius");
+  }
+
+  mesh.bind();
+  for(size_t i = 0, size = baseCentres.size(); i < size; ++i)
+  {
+    Eigen::Vector3f axis = topCentres[i] - baseCentres[i];
+    if(axis.norm() < 1e-3f) continue;
+
+    begin_oriented_quadric(baseCentres[i], axis);
+    glScalef(radii[i], radii[i], axis.norm());
+    mesh.draw();
+    end_oriented_quadric();
+  }
+  mesh.unbind();
+}
+
 void QuadricRenderer::render_sphere(const Eigen::Vector3f& centre, double radius, int slices, int stacks,
                                     const boost::optional<boost::shared_ptr<GLUquadric> >& optionalQuadric)
 {
@@ -40,6 +126,27 @@ void QuadricRenderer::render_sphere(const Eigen::Vector3f& centre, double radius
   glPopMatrix();
 }
 
+void QuadricRenderer::render_spheres(const VertexBufferMesh& mesh, const std::vector<Eigen::Vector3f>& centres, const std::vector<float>& radii)
+{
+  if(radii.size() != centres.size())
+  {
+    throw std::invalid_argument("Error: Each sphere to be rendered must have a centre and a radius");
+  }
+
+  glMatrixMode(GL_MODELVIEW);
+  mesh.bind();
+  for(size_t i = 0, size = centres.size(); i < size; ++i)
+  {
+    const Eigen::Vector3f& centre = centres[i];
+    glPushMatrix();
+    glTranslatef(centre.x(), centre.y(), centre.z());
+    glScalef(radii[i], radii[i], radii[i]);
+    mesh.draw();
+    glPopMatrix();
+  }
+  mesh.unbind();
+}
+
 //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
 
 void QuadricRenderer::begin_oriented_quadric(const Eigen::Vector3f& p, const Eigen::Vector3f& axis)
@@ -0,0 +1,139 @@
+/**
+ * spaint: SemanticPaletteShader.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "ogl/SemanticPaletteShader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+//#################### LOCAL CONSTANTS ####################
+
+/**
+ * The source code of the fragment shader. The label of each pixel is stored in the luminance channel of the compact image,
+ * and its intensity in the alpha channel (see pack_compact_semantic_pixel). Pixels whose rays missed the scene have zero
+ * intensity, and are drawn as transparent black, as in a colour semantic visualisation.
+ */
+const char *fragmentShaderSource =
+  "#version 110\n"
+  "uniform sampler2D compactImage;\n"
+  "uniform sampler2D palette;\n"
+  "uniform float paletteSize;\n"
+  "void main()\n"
+  "{\n"
+  "  vec4 texel = texture2D(compactImage, gl_TexCoord[0].st);\n"
+  "  float label = floor(texel.r * 255.0 + 0.5);\n"
+  "  vec3 colour = texture2D(palette, vec2((label + 0.5) / paletteSize, 0.5)).rgb;\n"
+  "  gl_FragColor = vec4(colour * texel.a, texel.a > 0.0 ? 1.0 : 0.0);\n"
+  "}\n";
+
+}
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SemanticPaletteShader::SemanticPaletteShader(size_t maxLabelCount)
+: m_paletteSize(static_cast<GLsizei>(maxLabelCount))
+{
+  // Compile the fragment shader.
+  m_fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(m_fragmentShaderID, 1, &fragmentShaderSource, NULL);
+  glCompileShader(m_fragmentShaderID);
+
+  GLint status;
+  glGetShaderiv(m_fragmentShaderID, GL_COMPILE_STATUS, &status);
+  if(status != GL_TRUE)
+  {
+    char log[1024];
+    glGetShaderInfoLog(m_fragmentShaderID, sizeof(log), NULL, log);
+    glDeleteShader(m_fragmentShaderID);
+    throw std::runtime_error("Error: Could not compile the semantic palette shader: " + std::string(log));
+  }
+
+  // Link it into a program (the vertices are processed by the fixed-function pipeline).
+  m_programID = glCreateProgram();
+  glAttachShader(m_programID, m_fragmentShaderID);
+  glLinkProgram(m_programID);
+
+  glGetProgramiv(m_programID, GL_LINK_STATUS, &status);
+  if(status != GL_TRUE)
+  {
+    char log[1024];
+    glGetProgramInfoLog(m_programID, sizeof(log), NULL, log);
+    glDeleteProgram(m_programID);
+    glDeleteShader(m_fragmentShaderID);
+    throw std::runtime_error("Error: Could not link the semantic palette shader: " + std::string(log));
+  }
+
+  // Set the uniforms, which never change: the compact image is bound to texture unit 0, and the palette to texture unit 1.
+  glUseProgram(m_programID);
+  glUniform1i(glGetUniformLocation(m_programID, "compactImage"), 0);
+  glUniform1i(glGetUniformLocation(m_programID, "palette"), 1);
+  glUniform1f(glGetUniformLocation(m_programID, "paletteSize"), static_cast<float>(m_paletteSize));
+  glUseProgram(0);
+
+  // Set up the palette texture, initially with every label coloured black.
+  glGenTextures(1, &m_paletteTextureID);
+  update_palette(std::vector<Vector3u>(maxLabelCount, Vector3u((uchar)0)));
+}
+
+//#################### DESTRUCTOR ####################
+
+SemanticPaletteShader::~SemanticPaletteShader()
+{
+  glDeleteTextures(1, &m_paletteTextureID);
+  glDeleteProgram(m_programID);
+  glDeleteShader(m_fragmentShaderID);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SemanticPaletteShader::bind(const std::vector<Vector3u>& labelColours)
+{
+  // If the label colours have changed since they were last uploaded, upload them again.
+  const size_t colourCount = std::min(labelColours.size(), m_paletteColours.size());
+  if(!std::equal(labelColours.begin(), labelColours.begin() + colourCount, m_paletteColours.begin()))
+  {
+    update_palette(labelColours);
+  }
+
+  glUseProgram(m_programID);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, m_paletteTextureID);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+void SemanticPaletteShader::unbind() const
+{
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glActiveTexture(GL_TEXTURE0);
+  glUseProgram(0);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void SemanticPaletteShader::update_palette(const std::vector<Vector3u>& labelColours)
+{
+  // Copy the label colours into the palette (any labels for which no colours are specified keep their existing colours).
+  m_paletteColours.resize(m_paletteSize, Vector3u((uchar)0));
+  std::copy(labelColours.begin(), labelColours.begin() + std::min(labelColours.size(), m_paletteColours.size()), m_paletteColours.begin());
+
+  // Upload the palette. Note: Vector3u is a tightly-packed array of three bytes, so the palette can be uploaded directly.
+  glBindTexture(GL_TEXTURE_2D, m_paletteTextureID);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, m_paletteSize, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, &m_paletteColours[0]);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+}
@@ -0,0 +1,94 @@
+/**
+ * spaint: VertexBufferMesh.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "ogl/VertexBufferMesh.h"
+
+#include <stdexcept>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VertexBufferMesh::VertexBufferMesh(GLenum primitiveType, const std::vector<Eigen::Vector3f>& vertices, const std::vector<GLuint>& indices,
+                                   const std::vector<Eigen::Vector3f>& colours)
+: m_colourBufferID(0), m_indexCount(static_cast<GLsizei>(indices.size())), m_primitiveType(primitiveType)
+{
+  if(!colours.empty() && colours.size() != vertices.size())
+  {
+    throw std::invalid_argument("Error: A coloured mesh must have exactly one colour for each vertex");
+  }
+
+  // Note: Eigen::Vector3f is a tightly-packed array of three floats, so the vertex data can be uploaded directly.
+  glGenBuffers(1, &m_vertexBufferID);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Eigen::Vector3f), vertices.empty() ? NULL : &vertices[0], GL_STATIC_DRAW);
+
+  if(!colours.empty())
+  {
+    glGenBuffers(1, &m_colourBufferID);
+    glBindBuffer(GL_ARRAY_BUFFER, m_colourBufferID);
+    glBufferData(GL_ARRAY_BUFFER, colours.size() * sizeof(Eigen::Vector3f), &colours[0], GL_STATIC_DRAW);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glGenBuffers(1, &m_indexBufferID);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferID);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.empty() ? NULL : &indices[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+//#################### DESTRUCTOR ####################
+
+VertexBufferMesh::~VertexBufferMesh()
+{
+  if(m_colourBufferID != 0) glDeleteBuffers(1, &m_colourBufferID);
+  glDeleteBuffers(1, &m_indexBufferID);
+  glDeleteBuffers(1, &m_vertexBufferID);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VertexBufferMesh::bind() const
+{
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, 0);
+
+  if(m_colourBufferID != 0)
+  {
+    // Since the per-vertex colours overwrite the current colour, we save it so that it can be restored when the mesh is unbound.
+    glPushAttrib(GL_CURRENT_BIT);
+    glBindBuffer(GL_ARRAY_BUFFER, m_colourBufferID);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(3, GL_FLOAT, 0, 0);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferID);
+}
+
+void VertexBufferMesh::draw() const
+{
+  glDrawElements(m_primitiveType, m_indexCount, GL_UNSIGNED_INT, 0);
+}
+
+void VertexBufferMesh::render() const
+{
+  bind();
+  draw();
+  unbind();
+}
+
+void VertexBufferMesh::unbind() const
+{
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  if(m_colourBufferID != 0) glPopAttrib();
+  glPopClientAttrib();
+}
+
+}
@@ -28,6 +28,47 @@ bool Picker_CPU::pick(int x, int y, const ITMLib::ITMRenderState *renderState, O
   );
 }
 
+bool Picker_CPU::pick_deferred(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB,
+                               Vector3f& latestPickPoint, size_t offset) const
+{
+  if(offset >= pickPointsMB.dataSize)
+  {
+    throw std::runtime_error("Error: The offset at which to write the pick point is out of range");
+  }
+
+  // The result is available immediately on the CPU, so there is nothing to defer.
+  Vector3f pickPoint;
+  if(!get_pick_point(x, y, renderState->raycastResult->noDims.x, renderState->raycastResult->GetData(MEMORYDEVICE_CPU), pickPoint)) return false;
+
+  *(pickPointsMB.GetData(MEMORYDEVICE_CPU) + offset) = latestPickPoint = pickPoint;
+  return true;
+}
+
+size_t Picker_CPU::pick_batch(const std::vector<Vector2i>& points, const ITMLib::ITMRenderState *renderState, size_t maxPickPoints,
+                              ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB,
+                              bool copyToHost) const
+{
+  const Vector2i imgSize = renderState->raycastResult->noDims;
+  const Vector4f *pointImage = renderState->raycastResult->GetData(MEMORYDEVICE_CPU);
+  Vector3f *pickPointsFloat = pickPointsFloatMB.GetData(MEMORYDEVICE_CPU);
+  Vector3s *pickPointsShort = pickPointsShortMB.GetData(MEMORYDEVICE_CPU);
+
+  // Pick the points in order, stopping once we have kept as many as we can.
+  size_t pickPointCount = 0;
+  for(size_t i = 0, pointCount = points.size(); i < pointCount && pickPointCount < maxPickPoints; ++i)
+  {
+    if(get_pick_point_checked(points[i], imgSize, pointImage, pickPointsFloat[pickPointCount]))
+    {
+      pickPointsShort[pickPointCount] = pickPointsFloat[pickPointCount].toShortRound();
+      ++pickPointCount;
+    }
+  }
+
+  // Note that the pick points are already on the CPU, so copyToHost can be ignored.
+  pickPointsFloatMB.dataSize = pickPointsShortMB.dataSize = pickPointCount;
+  return pickPointCount;
+}
+
 void Picker_CPU::to_short(const ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB) const
 {
   if(pickPointsFloatMB.dataSize != pickPointsShortMB.dataSize)
@@ -48,4 +89,9 @@ void Picker_CPU::to_short(const ORUtils::MemoryBlock<Vector3f>& pickPointsFloatM
   }
 }
 
+void Picker_CPU::wait_for_host_copy() const
+{
+  // No-op
+}
+
 }
@@ -3,6 +3,7 @@
  * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
  */
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "picking/cuda/Picker_CUDA.h"
@@ -11,6 +12,11 @@
 
 namespace spaint {
 
+//#################### CONSTANTS ####################
+
+/** The number of threads with which to launch ck_pick_batch. */
+#define PICK_BATCH_THREADS 256
+
 //#################### CUDA KERNELS ####################
 
 __global__ void ck_get_pick_point(int x, int y, int width, const Vector4f *imageData, Vector3f *pickPoint, bool *result)
@@ -18,12 +24,81 @@ __global__ void ck_get_pick_point(int x, int y, int width, const Vector4f *image
   *result = get_pick_point(x, y, width, imageData, *pickPoint);
 }
 
+/**
+ * \brief Picks a single point, writing the pick point into the output only if the ray hit the scene, and recording the result for a deferred readback.
+ */
+__global__ void ck_get_pick_point_deferred(int x, int y, int width, const Vector4f *imageData, Vector3f *pickPoint, Vector4f *result)
+{
+  Vector3f p;
+  const bool hit = get_pick_point(x, y, width, imageData, p);
+  if(hit) *pickPoint = p;
+  *result = Vector4f(p.x, p.y, p.z, hit ? 1.0f : 0.0f);
+}
+
+/**
+ * \brief Picks a batch of points and compacts the ones that hit the scene, in order, to the front of the output arrays.
+ *
+ * This must be launched with a single block of PICK_BATCH_THREADS threads. The batch is processed in chunks of that size,
+ * and each hit is written to its rank amongst the hits seen so far, so the output order is deterministic.
+ */
+__global__ void ck_pick_batch(const Vector2i *points, int pointCount, Vector2i imgSize, const Vector4f *pointImage, int maxPickPoints,
+                              Vector3f *pickPointsFloat, Vector3s *pickPointsShort, int *pickPointCount)
+{
+  __shared__ bool hits[PICK_BATCH_THREADS];
+  __shared__ int hitsSoFar;
+
+  const int tid = threadIdx.x;
+  if(tid == 0) hitsSoFar = 0;
+  __syncthreads();
+
+  for(int chunkBegin = 0; chunkBegin < pointCount; chunkBegin += PICK_BATCH_THREADS)
+  {
+    const int i = chunkBegin + tid;
+    Vector3f pickPoint;
+    hits[tid] = i < pointCount && get_pick_point_checked(points[i], imgSize, pointImage, pickPoint);
+    __syncthreads();
+
+    // Count the hits in the chunk that precede this one (the chunks are small, so a serial count suffices).
+    int rank = 0;
+    for(int j = 0; j < tid; ++j) rank += hits[j];
+
+    const int outputIdx = hitsSoFar + rank;
+    if(hits[tid] && outputIdx < maxPickPoints)
+    {
+      pickPointsFloat[outputIdx] = pickPoint;
+      pickPointsShort[outputIdx] = pickPoint.toShortRound();
+    }
+    __syncthreads();
+
+    if(tid == PICK_BATCH_THREADS - 1) hitsSoFar += rank + hits[tid];
+    __syncthreads();
+  }
+
+  if(tid == 0) *pickPointCount = min(hitsSoFar, maxPickPoints);
+}
+
 __global__ void ck_to_short(const Vector3f *pickPointsFloat, Vector3s *pickPointsShort, int pointCount)
 {
   int tid = threadIdx.x + blockDim.x * blockIdx.x;
   if(tid < pointCount) pickPointsShort[tid] = pickPointsFloat[tid].toShortRound();
 }
 
+//#################### CONSTRUCTORS ####################
+
+Picker_CUDA::Picker_CUDA()
+: m_deferredResultMB(new ORUtils::MemoryBlock<Vector4f>(1, false, true)),
+  m_pickPointCountMB(new ORUtils::MemoryBlock<int>(1, true, true))
+{
+  ORcudaSafeCall(cudaEventCreateWithFlags(&m_hostCopyEvent, cudaEventDisableTiming));
+}
+
+//#################### DESTRUCTOR ####################
+
+Picker_CUDA::~Picker_CUDA()
+{
+  cudaEventDestroy(m_hostCopyEvent);
+}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 bool Picker_CUDA::pick(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB, size_t offset) const
@@ -45,6 +120,85 @@ bool Picker_CUDA::pick(int x, int y, const ITMLib::ITMRenderState *renderState,
   return *result.GetData(MEMORYDEVICE_CPU);
 }
 
+bool Picker_CUDA::pick_deferred(int x, int y, const ITMLib::ITMRenderState *renderState, ORUtils::MemoryBlock<Vector3f>& pickPointsMB,
+                                Vector3f& latestPickPoint, size_t offset) const
+{
+  if(offset >= pickPointsMB.dataSize)
+  {
+    throw std::runtime_error("Error: The offset at which to write the pick point is out of range");
+  }
+
+  ck_get_pick_point_deferred<<<1,1>>>(
+    x, y,
+    renderState->raycastResult->noDims.x,
+    renderState->raycastResult->GetData(MEMORYDEVICE_CUDA),
+    pickPointsMB.GetData(MEMORYDEVICE_CUDA) + offset,
+    m_deferredResultMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Start copying the result of this pick across to the CPU, and pick up the result of the most recent pick whose copy has finished.
+  // Note that if the previous copy is still in flight, the result of this pick is simply never read back, which is harmless for UI feedback.
+  m_deferredResultReadback.request(m_deferredResultMB->GetData(MEMORYDEVICE_CUDA), 1);
+  m_deferredResultReadback.poll();
+  if(!m_deferredResultReadback.has_latest()) return false;
+
+  const Vector4f& result = *m_deferredResultReadback.latest();
+  if(result.w <= 0.0f) return false;
+
+  latestPickPoint = Vector3f(result.x, result.y, result.z);
+  return true;
+}
+
+size_t Picker_CUDA::pick_batch(const std::vector<Vector2i>& points, const ITMLib::ITMRenderState *renderState, size_t maxPickPoints,
+                               ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB,
+                               bool copyToHost) const
+{
+  const size_t pointCount = points.size();
+  if(pointCount == 0 || maxPickPoints == 0)
+  {
+    pickPointsFloatMB.dataSize = pickPointsShortMB.dataSize = 0;
+    return 0;
+  }
+
+  // Upload the points to the GPU, growing the staging memory block if necessary.
+  if(!m_pointsMB || m_pointsMB->dataSize < pointCount)
+  {
+    m_pointsMB.reset(new ORUtils::MemoryBlock<Vector2i>(pointCount, true, true));
+  }
+
+  std::copy(points.begin(), points.end(), m_pointsMB->GetData(MEMORYDEVICE_CPU));
+  ORcudaSafeCall(cudaMemcpy(m_pointsMB->GetData(MEMORYDEVICE_CUDA), m_pointsMB->GetData(MEMORYDEVICE_CPU), pointCount * sizeof(Vector2i), cudaMemcpyHostToDevice));
+
+  // Pick all of the points in a single launch.
+  ck_pick_batch<<<1,PICK_BATCH_THREADS>>>(
+    m_pointsMB->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(pointCount),
+    renderState->raycastResult->noDims,
+    renderState->raycastResult->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(maxPickPoints),
+    pickPointsFloatMB.GetData(MEMORYDEVICE_CUDA),
+    pickPointsShortMB.GetData(MEMORYDEVICE_CUDA),
+    m_pickPointCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Read back the number of points picked, which is all that the CPU needs in order to size the selection.
+  m_pickPointCountMB->UpdateHostFromDevice();
+  const size_t pickPointCount = static_cast<size_t>(*m_pickPointCountMB->GetData(MEMORYDEVICE_CPU));
+  pickPointsFloatMB.dataSize = pickPointsShortMB.dataSize = pickPointCount;
+
+  // If requested, start copying the Vector3f pick points across to the CPU without waiting for the copy to finish.
+  if(copyToHost && pickPointCount > 0)
+  {
+    ORcudaSafeCall(cudaMemcpyAsync(
+      pickPointsFloatMB.GetData(MEMORYDEVICE_CPU), pickPointsFloatMB.GetData(MEMORYDEVICE_CUDA),
+      pickPointCount * sizeof(Vector3f), cudaMemcpyDeviceToHost
+    ));
+  }
+  ORcudaSafeCall(cudaEventRecord(m_hostCopyEvent));
+
+  return pickPointCount;
+}
+
 void Picker_CUDA::to_short(const ORUtils::MemoryBlock<Vector3f>& pickPointsFloatMB, ORUtils::MemoryBlock<Vector3s>& pickPointsShortMB) const
 {
   if(pickPointsFloatMB.dataSize != pickPointsShortMB.dataSize)
@@ -61,4 +215,9 @@ void Picker_CUDA::to_short(const ORUtils::MemoryBlock<Vector3f>& pickPointsFloat
   ck_to_short<<<numBlocks,threadsPerBlock>>>(pickPointsFloat, pickPointsShort, pointCount);
 }
 
+void Picker_CUDA::wait_for_host_copy() const
+{
+  ORcudaSafeCall(cudaEventSynchronize(m_hostCopyEvent));
+}
+
 }
@@ -4,15 +4,23 @@
  */
 
 #include "pipelinecomponents/ObjectSegmentationComponent.h"
-using namespace tvgutil;
+using namespace ITMLib;
+
+#include <iostream>
+#include <stdexcept>
 
+#include <boost/bind.hpp>
 #include <boost/serialization/extended_type_info.hpp>
 #include <boost/serialization/singleton.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 
+#include <itmx/base/MemoryBlockFactory.h>
 #include <itmx/persistence/ImagePersister.h>
 using namespace itmx;
 
+#include <tvgutil/timing/Profiler.h>
+using namespace tvgutil;
+
 #include "segmentation/SegmentationUtil.h"
 
 #if WITH_ARRAYFIRE && WITH_OPENCV
@@ -24,13 +32,58 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 ObjectSegmentationComponent::ObjectSegmentationComponent(const ObjectSegmentationContext_Ptr& context, const std::string& sceneID, const SingleRGBDImagePipe_Ptr& outputPipe)
-: m_context(context), m_outputEnabled(false), m_outputPipe(outputPipe), m_sceneID(sceneID)
-{}
+: m_context(context), m_outputEnabled(false), m_outputPipe(outputPipe), m_sceneID(sceneID),
+  m_segmentAsynchronously(context->get_settings()->get_first_value<bool>("ObjectSegmentationComponent.segmentAsynchronously", false)),
+  m_segmentationRequested(false), m_segmentationWorkerShouldTerminate(false)
+{
+  if(outputPipe)
+  {
+    MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+    m_outputDepthImage = mbf.make_image<short>(outputPipe->getDepthImageSize(), "ObjectSegmentationComponent");
+    m_outputRGBImage = mbf.make_image<Vector4u>(outputPipe->getRGBImageSize(), "ObjectSegmentationComponent");
+  }
+
+  // If asynchronous segmentation is enabled, start the worker thread.
+  if(m_segmentAsynchronously) m_segmentationWorker = boost::thread(boost::bind(&ObjectSegmentationComponent::run_segmentation_worker, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+ObjectSegmentationComponent::~ObjectSegmentationComponent()
+{
+  // Set the flag that informs the worker thread that it should terminate, and wake it (it might be waiting for work).
+  {
+    boost::lock_guard<boost::mutex> lock(m_segmentationMutex);
+    m_segmentationWorkerShouldTerminate = true;
+  }
+  m_segmentationRequestedCondition.notify_one();
+
+  // Wait for the worker thread to finish any frame it is segmenting and terminate gracefully.
+  if(m_segmentationWorker.joinable()) m_segmentationWorker.join();
+}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+void ObjectSegmentationComponent::cancel_segmentation()
+{
+  if(!m_segmentAsynchronously) return;
+
+  // Note: Since the results are being discarded, any error that occurred whilst computing them is only reported.
+  try
+  {
+    wait_for_segmentation();
+  }
+  catch(std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+}
+
 void ObjectSegmentationComponent::reset_segmenter()
 {
+  // Make sure that the worker thread is not still using the segmenter.
+  cancel_segmentation();
+
   const Segmenter_Ptr& segmenter = get_segmenter();
   if(segmenter) segmenter->reset();
 }
@@ -41,14 +94,121 @@ void ObjectSegmentationComponent::run_segmentation(const VoxelRenderState_CPtr&
   const Segmenter_Ptr& segmenter = get_segmenter();
   if(!segmenter) return;
 
-  // Segment the current input images to obtain a mask for the target.
   const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
-  ITMUCharImage_CPtr targetMask = segmenter->segment(slamState->get_pose(), renderState);
+  const bool writeOutput = m_outputEnabled && m_outputPipe;
+
+  // If asynchronous segmentation is disabled, segment the current frame and publish the results straight away.
+  if(!m_segmentAsynchronously)
+  {
+    View_CPtr view = slamState->get_view();
+    ITMShortImage_CPtr depthInput = slamState->get_input_raw_depth_image_copy();
+    publish_segmentation_result(segment_frame(segmenter, slamState->get_pose(), renderState, view, depthInput, writeOutput), view, depthInput);
+    return;
+  }
+
+  // Otherwise, wait for the worker thread to finish segmenting the previous frame (which it has been doing concurrently with
+  // SLAM for the current frame), and publish the results. Note that the snapshot still contains the inputs for that frame.
+  boost::optional<SegmentationResult> result = wait_for_segmentation();
+  if(result) publish_segmentation_result(*result, m_snapshot.view, m_snapshot.depthInput);
+
+  // If there is no scene raycast against which to segment the target, early out.
+  if(!renderState) return;
+
+  // Snapshot the inputs for the current frame, so that SLAM for the next frame can overwrite them whilst the worker segments them.
+  const bool useCUDA = m_context->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA;
+  copy_view_to_snapshot(slamState->get_view());
+
+  const ITMShortImage_Ptr& depthInput = slamState->get_input_raw_depth_image();
+  if(!m_snapshot.depthInput) m_snapshot.depthInput.reset(new ITMShortImage(depthInput->noDims, true, false));
+  m_snapshot.depthInput->ChangeDims(depthInput->noDims);
+  m_snapshot.depthInput->SetFrom(depthInput.get(), ITMShortImage::CPU_TO_CPU);
+
+  const ORUtils::Image<Vector4f> *raycastResult = renderState->raycastResult;
+  if(!m_snapshot.renderState || m_snapshot.renderState->raycastResult->noDims != raycastResult->noDims)
+  {
+    m_snapshot.renderState.reset(new ITMRenderState(raycastResult->noDims, 0.0f, 0.0f, useCUDA ? MEMORYDEVICE_CUDA : MEMORYDEVICE_CPU));
+  }
+  m_snapshot.renderState->raycastResult->SetFrom(raycastResult, useCUDA ? ORUtils::Image<Vector4f>::CUDA_TO_CUDA : ORUtils::Image<Vector4f>::CPU_TO_CPU);
+
+  m_snapshot.pose.SetFrom(&slamState->get_pose());
+  m_snapshot.writeOutput = writeOutput;
+
+  // Ask the worker thread to segment the snapshot.
+  {
+    boost::lock_guard<boost::mutex> lock(m_segmentationMutex);
+    m_segmentationRequested = true;
+  }
+  m_segmentationRequestedCondition.notify_one();
+}
+
+void ObjectSegmentationComponent::run_segmentation_training(const VoxelRenderState_CPtr& renderState)
+{
+  const Segmenter_Ptr& segmenter = get_segmenter();
+  if(!segmenter) return;
+
+  // If asynchronous segmentation is enabled, the segmenter operates on the snapshot's view, so copy the current view into it first.
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+  if(m_segmentAsynchronously)
+  {
+    cancel_segmentation();
+    copy_view_to_snapshot(slamState->get_view());
+  }
+
+  ITMUChar4Image_CPtr segmentationImage = segmenter->train(slamState->get_pose(), renderState);
+  m_context->set_segmentation_image(m_sceneID, segmentationImage);
+}
+
+void ObjectSegmentationComponent::toggle_output()
+{
+  m_outputEnabled = !m_outputEnabled;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ObjectSegmentationComponent::copy_view_to_snapshot(const View_CPtr& view)
+{
+  const bool useCUDA = m_context->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA;
+
+  // Note: Only the colour and depth images and the calibration are needed by the segmenter.
+  if(!m_snapshot.view)
+  {
+    m_snapshot.view.reset(new ITMView(view->calib, view->rgb->noDims, view->depth->noDims, useCUDA));
+  }
+
+  m_snapshot.view->calib = view->calib;
+  m_snapshot.view->rgb->SetFrom(view->rgb, useCUDA ? ITMUChar4Image::CUDA_TO_CUDA : ITMUChar4Image::CPU_TO_CPU);
+  m_snapshot.view->depth->SetFrom(view->depth, useCUDA ? ITMFloatImage::CUDA_TO_CUDA : ITMFloatImage::CPU_TO_CPU);
+}
+
+const Segmenter_Ptr& ObjectSegmentationComponent::get_segmenter()
+{
+#if WITH_ARRAYFIRE && WITH_OPENCV
+  if(!m_context->get_segmenter())
+  {
+    // If asynchronous segmentation is enabled, the segmenter must operate on the snapshot's view, since the worker thread
+    // segments each frame whilst SLAM for the next frame is writing into the scene's view.
+    View_CPtr view = m_context->get_slam_state(m_sceneID)->get_view();
+    if(m_segmentAsynchronously)
+    {
+      copy_view_to_snapshot(view);
+      view = m_snapshot.view;
+    }
+
+    const TouchSettings_Ptr touchSettings(new TouchSettings(m_context->get_resources_dir() + "/TouchSettings.xml"));
+    m_context->set_segmenter(Segmenter_Ptr(new BackgroundSubtractingObjectSegmenter(view, m_context->get_settings(), touchSettings)));
+  }
+#endif
+
+  return m_context->get_segmenter();
+}
 
+void ObjectSegmentationComponent::publish_segmentation_result(const SegmentationResult& result, const View_CPtr& view, const ITMShortImage_CPtr& depthInput)
+{
   // If there's a target mask, use its inverse to mask the camera input for tracking purposes. If not, early out.
-  if(targetMask)
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+  if(result.targetMask)
   {
-    slamState->set_input_mask(SegmentationUtil::invert_mask(targetMask));
+    slamState->set_input_mask(result.inputMask);
   }
   else
   {
@@ -57,64 +217,119 @@ void ObjectSegmentationComponent::run_segmentation(const VoxelRenderState_CPtr&
     return;
   }
 
-  // Make masked versions of the depth and RGB inputs.
-  View_CPtr view = slamState->get_view();
-  ITMUChar4Image_Ptr colouredDepthInput(new ITMUChar4Image(view->depth->dataSize, true, false));
-  m_context->get_visualisation_generator()->get_depth_input(colouredDepthInput, view);
-  ITMShortImage_CPtr depthInput = slamState->get_input_raw_depth_image_copy();
-  ITMUChar4Image_CPtr rgbInput(slamState->get_view()->rgb, boost::serialization::null_deleter());
-
-  ITMUChar4Image_CPtr colouredDepthMasked = SegmentationUtil::apply_mask(targetMask, colouredDepthInput, Vector4u((uchar)0));
-  ITMShortImage_CPtr depthMasked = SegmentationUtil::apply_mask(targetMask, depthInput, 0);
-  ITMUChar4Image_CPtr rgbMasked = SegmentationUtil::apply_mask(targetMask, rgbInput, Vector4u((uchar)0));
-
-  // If output is enabled, write the masked images to the output pipe.
-  if(m_outputEnabled && m_outputPipe) m_outputPipe->set_images(rgbMasked, depthMasked);
+  // If the masked images were written into our output buffers, swap them into the pipe. We also pass the bounding box
+  // of the target mask along with them, so that the object scene can restrict its processing to it.
+  if(result.outputWritten)
+  {
+    m_outputPipe->swap_in_images(*m_outputRGBImage, *m_outputDepthImage, result.targetBounds);
+  }
 
   // If we're currently saving a segmentation video, save the original and masked versions of the depth and colour inputs to disk.
   boost::optional<SequentialPathGenerator>& segmentationPathGenerator = m_context->get_segmentation_path_generator();
   if(segmentationPathGenerator)
   {
+    ITMUChar4Image_CPtr rgbInput(view->rgb, boost::serialization::null_deleter());
+    ITMUChar4Image_Ptr colouredDepthInput(new ITMUChar4Image(view->depth->dataSize, true, false));
+    m_context->get_visualisation_generator()->get_depth_input(colouredDepthInput, view);
+    ITMUChar4Image_CPtr colouredDepthMasked = SegmentationUtil::apply_mask(result.targetMask, colouredDepthInput, Vector4u((uchar)0));
+    ITMShortImage_CPtr depthMasked = SegmentationUtil::apply_mask(result.targetMask, depthInput, 0);
+
     segmentationPathGenerator->increment_index();
     ImagePersister::save_image_on_thread(colouredDepthInput, segmentationPathGenerator->make_path("cdepth%06i.png"));
     ImagePersister::save_image_on_thread(colouredDepthMasked, segmentationPathGenerator->make_path("cdepthm%06i.png"));
     ImagePersister::save_image_on_thread(depthInput, segmentationPathGenerator->make_path("depth%06i.pgm"));
     ImagePersister::save_image_on_thread(depthMasked, segmentationPathGenerator->make_path("depthm%06i.pgm"));
     ImagePersister::save_image_on_thread(rgbInput, segmentationPathGenerator->make_path("rgb%06i.ppm"));
-    ImagePersister::save_image_on_thread(rgbMasked, segmentationPathGenerator->make_path("rgbm%06i.ppm"));
+    ImagePersister::save_image_on_thread(result.rgbMasked, segmentationPathGenerator->make_path("rgbm%06i.ppm"));
   }
 
   // Set the masked colour image as the segmentation overlay image so that it will be rendered.
-  m_context->set_segmentation_image(m_sceneID, rgbMasked);
+  m_context->set_segmentation_image(m_sceneID, result.rgbMasked);
 }
 
-void ObjectSegmentationComponent::run_segmentation_training(const VoxelRenderState_CPtr& renderState)
+void ObjectSegmentationComponent::run_segmentation_worker()
 {
-  const Segmenter_Ptr& segmenter = get_segmenter();
-  if(!segmenter) return;
+  Profiler::instance().set_thread_name("Object segmenter");
 
-  ITMUChar4Image_CPtr segmentationImage = segmenter->train(m_context->get_slam_state(m_sceneID)->get_pose(), renderState);
-  m_context->set_segmentation_image(m_sceneID, segmentationImage);
+  for(;;)
+  {
+    // Wait until there is a frame to segment, or termination is requested.
+    {
+      boost::unique_lock<boost::mutex> lock(m_segmentationMutex);
+      while(!m_segmentationWorkerShouldTerminate && !m_segmentationRequested) m_segmentationRequestedCondition.wait(lock);
+
+      // If we were asked to terminate, do so.
+      if(m_segmentationWorkerShouldTerminate) return;
+    }
+
+    // Segment the snapshot. Any exception is handed back to the main thread, which rethrows it when it waits for the results.
+    boost::optional<SegmentationResult> result;
+    std::string error;
+    try
+    {
+      result = segment_frame(m_context->get_segmenter(), m_snapshot.pose, m_snapshot.renderState, m_snapshot.view, m_snapshot.depthInput, m_snapshot.writeOutput);
+    }
+    catch(std::exception& e)
+    {
+      error = e.what();
+    }
+
+    // Hand the results back to the main thread.
+    {
+      boost::lock_guard<boost::mutex> lock(m_segmentationMutex);
+      m_segmentationResult = result;
+      m_segmentationError = error;
+      m_segmentationRequested = false;
+    }
+    m_segmentationFinished.notify_one();
+  }
 }
 
-void ObjectSegmentationComponent::toggle_output()
+ObjectSegmentationComponent::SegmentationResult
+ObjectSegmentationComponent::segment_frame(const Segmenter_Ptr& segmenter, const ORUtils::SE3Pose& pose, const VoxelRenderState_CPtr& renderState,
+                                           const View_CPtr& view, const ITMShortImage_CPtr& depthInput, bool writeOutput)
 {
-  m_outputEnabled = !m_outputEnabled;
-}
+  SegmentationResult result;
+  result.outputWritten = false;
 
-//#################### PRIVATE MEMBER FUNCTIONS ####################
+  // Segment the input images to obtain a mask for the target. If there isn't one, early out.
+  result.targetMask = segmenter->segment(pose, renderState);
+  if(!result.targetMask) return result;
+
+  // Make the inverse of the target mask (for tracking purposes) and a masked version of the RGB input.
+  ITMUChar4Image_CPtr rgbInput(view->rgb, boost::serialization::null_deleter());
+  result.inputMask = SegmentationUtil::invert_mask(result.targetMask);
+  result.rgbMasked = SegmentationUtil::apply_mask(result.targetMask, rgbInput, Vector4u((uchar)0));
+
+  // If desired, also mask the inputs for the object scene. To avoid any copying or allocation on the way to the object scene,
+  // we mask the inputs directly into our own output buffers, which can then be swapped into the output pipe.
+  if(writeOutput)
+  {
+    SegmentationUtil::apply_mask(result.targetMask, *depthInput, 0, *m_outputDepthImage);
+    SegmentationUtil::apply_mask(result.targetMask, *rgbInput, Vector4u((uchar)0), *m_outputRGBImage);
+    result.targetBounds = SegmentationUtil::compute_bounding_box(result.targetMask);
+    result.outputWritten = true;
+  }
+
+  return result;
+}
 
-const Segmenter_Ptr& ObjectSegmentationComponent::get_segmenter() const
+boost::optional<ObjectSegmentationComponent::SegmentationResult> ObjectSegmentationComponent::wait_for_segmentation()
 {
-#if WITH_ARRAYFIRE && WITH_OPENCV
-  if(!m_context->get_segmenter())
+  boost::unique_lock<boost::mutex> lock(m_segmentationMutex);
+  while(m_segmentationRequested) m_segmentationFinished.wait(lock);
+
+  boost::optional<SegmentationResult> result;
+  result.swap(m_segmentationResult);
+
+  if(m_segmentationError != "")
   {
-    const TouchSettings_Ptr touchSettings(new TouchSettings(m_context->get_resources_dir() + "/TouchSettings.xml"));
-    m_context->set_segmenter(Segmenter_Ptr(new BackgroundSubtractingObjectSegmenter(m_context->get_slam_state(m_sceneID)->get_view(), m_context->get_settings(), touchSettings)));
+    std::string error;
+    error.swap(m_segmentationError);
+    throw std::runtime_error(error);
   }
-#endif
 
-  return m_context->get_segmenter();
+  return result;
 }
 
 }
@@ -5,6 +5,12 @@
 
 #include "pipelinecomponents/PropagationComponent.h"
 
+#include <boost/chrono/chrono.hpp>
+
+#include <tvgutil/timing/Profiler.h>
+using tvgutil::Profiler;
+using tvgutil::WorkBudgetController;
+
 #include "propagation/LabelPropagatorFactory.h"
 
 namespace spaint {
@@ -16,14 +22,33 @@ PropagationComponent::PropagationComponent(const PropagationContext_Ptr& context
 {
   const Vector2i& depthImageSize = context->get_slam_state(sceneID)->get_depth_image_size();
   const int raycastResultSize = depthImageSize.width * depthImageSize.height;
-  m_labelPropagator = LabelPropagatorFactory::make_label_propagator(raycastResultSize, context->get_settings()->deviceType);
+  const Settings_CPtr& settings = context->get_settings();
+  const bool useFrontier = settings->get_first_value<bool>("PropagationComponent.useFrontier", false);
+  m_labelPropagator = LabelPropagatorFactory::make_label_propagator(raycastResultSize, settings->deviceType, useFrontier);
+
+  // Optionally adapt the fraction of frames on which to propagate so as to hold the cost of propagation near a target time (in ms).
+  const double timeTarget = settings->get_first_value<double>("PropagationComponent.timeTarget", 0.0);
+  if(timeTarget > 0.0) m_runRate = WorkBudgetController(timeTarget, 0.1, 1.0, 1.0);
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void PropagationComponent::run(const VoxelRenderState_CPtr& renderState)
 {
+  // If adaptive propagation is enabled and propagation is not due on this frame, early out.
+  if(m_runRate && !m_runRate->accrue()) return;
+
+  typedef boost::chrono::steady_clock Clock;
+  const Clock::time_point startTime = Clock::now();
+
   m_labelPropagator->propagate_label(m_context->get_semantic_label(), renderState->raycastResult, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get());
+
+  // If adaptive propagation is enabled, update the propagation rate based on how long the propagation took.
+  if(m_runRate)
+  {
+    m_runRate->update(1.0, boost::chrono::duration<double,boost::milli>(Clock::now() - startTime).count());
+    Profiler::instance().set_gauge("Propagation.Rate", m_runRate->get_budget());
+  }
 }
 
 }
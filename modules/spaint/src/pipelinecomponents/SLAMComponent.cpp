@@ -5,28 +5,58 @@
 
 #include "pipelinecomponents/SLAMComponent.h"
 
+#include <algorithm>
+#include <iostream>
+
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/serialization/extended_type_info.hpp>
-#include <boost/serialization/singleton.hpp>
-#include <boost/serialization/shared_ptr.hpp>
 namespace bf = boost::filesystem;
 
 #include <ITMLib/Engines/LowLevel/ITMLowLevelEngineFactory.h>
+#include <ITMLib/Engines/Reconstruction/ITMSceneReconstructionEngineFactory.h>
+#include <ITMLib/Engines/Swapping/ITMSwappingEngineFactory.h>
 #include <ITMLib/Engines/ViewBuilding/ITMViewBuilderFactory.h>
 #include <ITMLib/Objects/RenderStates/ITMRenderStateFactory.h>
 using namespace InputSource;
 using namespace ITMLib;
 using namespace ORUtils;
 
+#ifdef WITH_GROVE
+#include <grove/relocalisation/ScoreRelocaliserFactory.h>
+#endif
+
+#include <itmx/geometry/GeometryUtil.h>
+#include <itmx/relocalisation/BackgroundRelocaliser.h>
+#include <itmx/relocalisation/CascadeRelocaliser.h>
 #include <itmx/relocalisation/FernRelocaliser.h>
 #include <itmx/relocalisation/ICPRefiningRelocaliser.h>
+#include <itmx/relocalisation/RecentPoseRelocaliser.h>
 using namespace itmx;
 
 #include <tvgutil/misc/SettingsContainer.h>
+#include <tvgutil/timing/Profiler.h>
+#include <tvgutil/timing/ProfilingScope.h>
 using namespace tvgutil;
 
-#include "segmentation/SegmentationUtil.h"
+#include "fusion/BatchedVoxelIntegratorFactory.h"
+#include "fusion/BlockVersionTrackerFactory.h"
+#include "fusion/ConvergedBlockFilterFactory.h"
+#include "fusion/VoxelBlockDefragmenterFactory.h"
+#include "fusion/VoxelSceneResetterFactory.h"
+#include "imageprocessing/DepthChangeEstimatorFactory.h"
+#include "imageprocessing/DepthPreprocessorFactory.h"
+#include "imagesources/AsyncImageSourceEngine.h"
+#include "imagesources/FrameTimestampSource.h"
+#include "imagesources/ImageRegionSource.h"
+#include "imagesources/SingleRGBDImagePipe.h"
+#include "imagesources/SwappingCompositeImageSourceEngine.h"
+#include "markers/VoxelMarkerFactory.h"
+#include "segmentation/DepthMaskerFactory.h"
+#include "swapping/VoxelSceneArchiveFactory.h"
+#include "swapping/VoxelSwapManagerFactory.h"
 #include "trackers/TrackerFactory.h"
+#include "util/CUDADeviceScope.h"
+#include "visualisation/VisualiserFactory.h"
 
 namespace spaint {
 
@@ -36,16 +66,35 @@ SLAMComponent::SLAMComponent(const SLAMContext_Ptr& context, const std::string&
                              const std::string& trackerConfig, MappingMode mappingMode, TrackingMode trackingMode,
                              const FiducialDetector_CPtr& fiducialDetector, bool detectFiducials)
 : m_context(context),
+  m_cudaDevice(context->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA ? context->get_settings()->get_first_value<int>("SLAMComponent." + sceneID + "CUDADevice", -1) : -1),
+  m_defragmentationInterval(0),
   m_detectFiducials(detectFiducials),
   m_fallibleTracker(NULL),
   m_fiducialDetector(fiducialDetector),
   m_imageSourceEngine(imageSourceEngine),
   m_initialFramesToFuse(50), // FIXME: This value should be passed in rather than hard-coded.
   m_mappingMode(mappingMode),
+  m_occupancyWarningIssued(false),
+  m_prefetchIssued(false),
+  m_prefetchRequested(false),
+  m_prefetcherShouldTerminate(false),
+  m_processedFramesCount(0),
   m_sceneID(sceneID),
+  m_staticFramesSinceFusion(0),
+  m_staticFusionInterval(1),
+  m_surfelIndexReuseMaxRotation(-1.0),
+  m_surfelIndexReuseMaxTranslation(-1.0f),
   m_trackerConfig(trackerConfig),
-  m_trackingMode(trackingMode)
+  m_trackingDownsampleLevels(0),
+  m_trackingMode(trackingMode),
+  m_voxelSceneInitialised(false)
 {
+  // If the scene is to be owned by a specific CUDA device, make sure that the device that is current now (which is the one on
+  // which the scene will be rendered) and the scene's device can access each other's memory, and then switch to the scene's
+  // device for the rest of the set-up, so that everything belonging to the scene is allocated there.
+  CUDADeviceScope::enable_peer_access(m_cudaDevice);
+  CUDADeviceScope deviceScope(m_cudaDevice);
+
   // Determine the RGB and depth image sizes.
   Vector2i rgbImageSize = m_imageSourceEngine->getRGBImageSize();
   Vector2i depthImageSize = m_imageSourceEngine->getDepthImageSize();
@@ -60,16 +109,59 @@ SLAMComponent::SLAMComponent(const SLAMContext_Ptr& context, const std::string&
   const Settings_CPtr& settings = context->get_settings();
   m_lowLevelEngine.reset(ITMLowLevelEngineFactory::MakeLowLevelEngine(settings->deviceType));
 
-  // Set up the view builder.
+  // Set up the view builder and the depth masker.
   m_viewBuilder.reset(ITMViewBuilderFactory::MakeViewBuilder(m_imageSourceEngine->getCalib(), settings->deviceType));
+  m_depthMasker = DepthMaskerFactory::make_depth_masker(settings->deviceType);
+
+  // If requested, set up a depth preprocessor to fill small holes in the depth image of each view and/or smooth it before it is
+  // tracked. Less noisy depth lets ICP converge in fewer iterations and makes tracking failures (and thus relocalisation) rarer.
+  const int bilateralRadius = settings->get_first_value<int>("SLAMComponent.depthBilateralRadius", 0);
+  const int holeFillRadius = settings->get_first_value<int>("SLAMComponent.depthHoleFillRadius", 0);
+  if(bilateralRadius > 0 || holeFillRadius > 0)
+  {
+    m_depthPreprocessor = DepthPreprocessorFactory::make_depth_preprocessor(
+      bilateralRadius,
+      settings->get_first_value<float>("SLAMComponent.depthBilateralSpatialSigma", 2.0f),
+      settings->get_first_value<float>("SLAMComponent.depthBilateralDepthSigma", 0.02f),
+      holeFillRadius,
+      settings->get_first_value<float>("SLAMComponent.depthHoleFillMaxDepthDifference", 0.05f),
+      settings->deviceType
+    );
+  }
 
-  // Set up the scenes.
+  // Set up the scenes. If requested, the voxel scene records which of its voxel blocks contain only empty space,
+  // so that raycasts of it can skip them (the block occupancy is kept up to date as each frame is fused), and/or
+  // accumulates the evidence for the labels predicted for its voxels, so that the predicted labels stabilise.
   MemoryDeviceType memoryType = settings->GetMemoryType();
-  slamState->set_voxel_scene(SpaintVoxelScene_Ptr(new SpaintVoxelScene(&settings->sceneParams, settings->swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED, memoryType)));
+  const bool useBlockOccupancy = settings->get_first_value<bool>("SLAMComponent.useBlockOccupancy", false);
+  const bool useLabelEvidence = settings->get_first_value<bool>("SLAMComponent.useLabelEvidence", false);
+  slamState->set_voxel_scene(SpaintVoxelScene_Ptr(new SpaintVoxelScene(
+    &settings->sceneParams, settings->swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED, memoryType, useBlockOccupancy, useLabelEvidence
+  )));
   if(mappingMode != MAP_VOXELS_ONLY)
   {
     slamState->set_surfel_scene(SpaintSurfelScene_Ptr(new SpaintSurfelScene(&settings->surfelSceneParams, memoryType)));
   }
+  if(useBlockOccupancy) m_blockOccupancyUpdater = VisualiserFactory::make_block_occupancy_updater(settings->deviceType);
+  m_blockVersionTracker = BlockVersionTrackerFactory::make_block_version_tracker(settings->deviceType);
+
+  // Unless told otherwise, reset the voxel scene by clearing only the voxel blocks that are in use, rather than the whole voxel block array.
+  if(settings->get_first_value<bool>("SLAMComponent.fastSceneReset", true))
+  {
+    m_voxelSceneResetter = VoxelSceneResetterFactory::make_voxel_scene_resetter(settings->deviceType);
+  }
+
+  // Since the voxel scene's storage has a fixed size, and any blocks that cannot be allocated once it is full are silently dropped,
+  // we monitor how much of it is in use, and warn once more than a certain fraction of it is.
+  m_occupancyWarningThreshold = settings->get_first_value<float>("SLAMComponent.occupancyWarningThreshold", 0.9f);
+
+  // If requested, defragment the voxel scene every so often, by reordering its resident voxel blocks into Morton order, so that
+  // the passes that read voxels from neighbouring blocks stay cache-friendly as blocks are allocated, swapped and reloaded.
+  m_defragmentationInterval = settings->get_first_value<size_t>("SLAMComponent.defragmentationInterval", 0);
+
+  // If the image source can tell us which region of each frame it is interested in (e.g. because it is providing the segmented
+  // images of an object), we limit the raycasts used for tracking to that region, expanded by a margin to allow for motion.
+  m_inputRegionMargin = settings->get_first_value<int>("SLAMComponent.inputRegionMargin", 32);
 
   // Set up the dense mappers.
   const SpaintVoxelScene_Ptr& voxelScene = slamState->get_voxel_scene();
@@ -77,15 +169,122 @@ SLAMComponent::SLAMComponent(const SLAMContext_Ptr& context, const std::string&
   if(mappingMode != MAP_VOXELS_ONLY)
   {
     m_denseSurfelMapper.reset(new ITMDenseSurfelMapper<SpaintSurfel>(depthImageSize, settings->deviceType));
+
+    // Rendering the supersampled surfel index image used for mapping is expensive, so if the surfel scene has not changed since the
+    // index image was last rendered, and the camera has only moved very slightly since then, we reuse the existing index image.
+    m_surfelIndexReuseMaxRotation = settings->get_first_value<double>("SLAMComponent.surfelIndexReuseMaxRotation", 0.002);
+    m_surfelIndexReuseMaxTranslation = settings->get_first_value<float>("SLAMComponent.surfelIndexReuseMaxTranslation", 0.001f);
+  }
+
+  // If requested, set up a filter to stop voxel blocks that have converged from being fused again. Since the filtering has to
+  // happen between allocating the scene and integrating each frame into it, we fuse using our own engines in that case.
+  if(settings->get_first_value<bool>("SLAMComponent.skipConvergedBlocks", false))
+  {
+    m_convergedBlockFilter = ConvergedBlockFilterFactory::make_converged_block_filter(
+      settings->deviceType,
+      settings->get_first_value<int>("SLAMComponent.convergedBlockFrames", 10),
+      settings->get_first_value<float>("SLAMComponent.convergedBlockMaxSDFChange", 0.005f),
+      settings->get_first_value<float>("SLAMComponent.convergedBlockResidualThreshold", 0.02f)
+    );
+
+    m_sceneReconstructionEngine.reset(ITMSceneReconstructionEngineFactory::MakeSceneReconstructionEngine<SpaintVoxel,ITMVoxelIndex>(settings->deviceType));
+    if(settings->swappingMode != ITMLibSettings::SWAPPINGMODE_DISABLED)
+    {
+      m_swappingEngine.reset(ITMSwappingEngineFactory::MakeSwappingEngine<SpaintVoxel,ITMVoxelIndex>(settings->deviceType));
+    }
+  }
+
+  // If requested, fuse only every so often whilst neither the camera nor the scene is changing (e.g. when the camera is on a tripod),
+  // since fusing a stream of near-identical frames into the same voxel blocks costs a lot of GPU time for very little benefit. The
+  // camera is considered static if it has barely moved since the most recently fused frame, and the scene is considered static if
+  // few of the pixels in the depth image have changed since that frame. Comparing against the most recently fused frame, rather
+  // than the previous frame, means that slow but steady motion cannot go unnoticed indefinitely.
+  m_staticFusionInterval = settings->get_first_value<int>("SLAMComponent.staticFusionInterval", 1);
+  if(m_staticFusionInterval < 0)
+  {
+    throw std::invalid_argument("Error: The static fusion interval must be non-negative");
+  }
+
+  if(m_staticFusionInterval != 1)
+  {
+    m_staticFusionMaxRotation = settings->get_first_value<double>("SLAMComponent.staticFusionMaxRotation", 0.005);
+    m_staticFusionMaxTranslation = settings->get_first_value<float>("SLAMComponent.staticFusionMaxTranslation", 0.005f);
+    m_staticFusionMaxChangedFraction = settings->get_first_value<float>("SLAMComponent.staticFusionMaxChangedFraction", 0.01f);
+    m_depthChangeEstimator = DepthChangeEstimatorFactory::make_depth_change_estimator(
+      settings->get_first_value<float>("SLAMComponent.staticFusionDepthChangeThreshold", 0.02f),
+      settings->deviceType
+    );
+    m_lastFusedDepth.reset(new ITMFloatImage(depthImageSize, true, settings->deviceType == ITMLibSettings::DEVICE_CUDA));
+  }
+
+  // Optionally track (and raycast the voxel scene for tracking) at a reduced resolution, whilst still fusing the full-resolution
+  // depth images. The input images are downsampled by repeated halving, so the downsampling factor must be a power of two.
+  const int trackingDownsampleFactor = settings->get_first_value<int>("SLAMComponent.trackingDownsampleFactor", 1);
+  while((1 << m_trackingDownsampleLevels) < trackingDownsampleFactor) ++m_trackingDownsampleLevels;
+  if(trackingDownsampleFactor < 1 || (1 << m_trackingDownsampleLevels) != trackingDownsampleFactor)
+  {
+    throw std::invalid_argument("Error: The tracking downsampling factor must be a power of two");
+  }
+
+  if(m_trackingDownsampleLevels > 0 && trackingMode == TRACK_SURFELS)
+  {
+    throw std::invalid_argument("Error: Tracking at a reduced resolution is only supported when tracking against the voxel scene");
   }
 
   // Set up the tracker and the tracking controller.
   setup_tracker();
   m_trackingController.reset(new ITMTrackingController(m_tracker.get(), settings.get()));
   const Vector2i trackedImageSize = m_trackingController->GetTrackedImageSize(rgbImageSize, depthImageSize);
-  slamState->set_tracking_state(TrackingState_Ptr(new ITMTrackingState(trackedImageSize, memoryType)));
+  const Vector2i reducedTrackedImageSize(trackedImageSize.x >> m_trackingDownsampleLevels, trackedImageSize.y >> m_trackingDownsampleLevels);
+  slamState->set_tracking_state(TrackingState_Ptr(new ITMTrackingState(reducedTrackedImageSize, memoryType)));
   m_tracker->UpdateInitialPose(slamState->get_tracking_state().get());
 
+  if(m_trackingDownsampleLevels > 0)
+  {
+    m_trackingVoxelRenderState.reset(ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(reducedTrackedImageSize, voxelScene->sceneParams, memoryType));
+  }
+
+  // Optionally seed the tracker each frame with a pose predicted from the camera's recent motion, rather than the previous pose.
+  if(settings->get_first_value<bool>("SLAMComponent.useMotionModel", false))
+  {
+    m_motionModel = ConstantVelocityMotionModel(
+      settings->get_first_value<double>("SLAMComponent.motionModelDamping", 1.0),
+      settings->get_first_value<double>("SLAMComponent.motionModelMaxRotationPerFrame", 0.2),
+      settings->get_first_value<double>("SLAMComponent.motionModelMaxTranslationPerFrame", 0.1)
+    );
+  }
+
+  // If requested, integrate the frames into the voxel scene in batches, rather than one at a time. This is intended for offline
+  // reconstruction of sequences whose poses are known in advance, and so is only allowed if the tracker does not need a raycast
+  // of the scene (e.g. because it reads the poses from disk), since the scene is only updated once per batch. Swapping must also
+  // be disabled, since the voxel blocks that each batch needs must stay resident until the batch has been integrated.
+  const int batchedIntegrationFrames = settings->get_first_value<int>("SLAMComponent.batchedIntegrationFrames", 0);
+  if(batchedIntegrationFrames > 0)
+  {
+    if(m_tracker->requiresPointCloudRendering())
+    {
+      throw std::runtime_error("Error: Batched integration requires a tracker that does not need to raycast the scene (e.g. a file-based tracker)");
+    }
+
+    if(settings->swappingMode != ITMLibSettings::SWAPPINGMODE_DISABLED)
+    {
+      throw std::runtime_error("Error: Batched integration cannot be used when swapping is enabled");
+    }
+
+    if(m_convergedBlockFilter)
+    {
+      throw std::runtime_error("Error: Batched integration cannot be combined with skipping converged blocks");
+    }
+
+    if(m_depthChangeEstimator)
+    {
+      throw std::runtime_error("Error: Batched integration cannot be combined with throttling fusion for a static camera");
+    }
+
+    m_batchedVoxelIntegrator = BatchedVoxelIntegratorFactory::make_batched_voxel_integrator(settings->deviceType, batchedIntegrationFrames, depthImageSize, rgbImageSize);
+    m_sceneReconstructionEngine.reset(ITMSceneReconstructionEngineFactory::MakeSceneReconstructionEngine<SpaintVoxel,ITMVoxelIndex>(settings->deviceType));
+  }
+
   // Set up the relocaliser.
   setup_relocaliser();
 
@@ -96,17 +295,116 @@ SLAMComponent::SLAMComponent(const SLAMContext_Ptr& context, const std::string&
     slamState->set_live_surfel_render_state(SurfelRenderState_Ptr(new ITMSurfelRenderState(trackedImageSize, settings->surfelSceneParams.supersamplingFactor)));
   }
 
+  // Set up the staging frame into which to acquire the next frame's images if pipelining is enabled. Note that we never
+  // pipeline the acquisition from a pipe, since its images are only provided by another component during each frame.
+  m_pipelineFrames = settings->get_first_value<bool>("SLAMComponent.pipelineFrames", false) &&
+                     !boost::dynamic_pointer_cast<const SingleRGBDImagePipe>(m_imageSourceEngine);
+  if(m_pipelineFrames)
+  {
+    m_stagedFrame.rawDepth.reset(new ITMShortImage(depthImageSize, true, true));
+    m_stagedFrame.rgb.reset(new ITMUChar4Image(rgbImageSize, true, true));
+  }
+
+  // If requested, set up a background fiducial detector, so that fiducial detection doesn't slow down the SLAM frames.
+  // Note that this means that the fiducial measurements for each frame are only integrated during a later frame.
+  if(m_fiducialDetector && settings->get_first_value<bool>("SLAMComponent.detectFiducialsInBackground", false))
+  {
+    m_backgroundFiducialDetector.reset(new BackgroundFiducialDetector(m_fiducialDetector, settings->deviceType));
+  }
+
+  // If swapping is enabled, set up a voxel swap manager to prefetch the voxel blocks that the camera is about to see,
+  // and to restore the labels of any blocks that are swapped back in (InfiniTAM's swapping engine does not preserve them).
+  if(settings->swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED)
+  {
+    const int lookaheadFrames = settings->get_first_value<int>("SLAMComponent.swappingLookaheadFrames", 5);
+    m_voxelSwapManager = VoxelSwapManagerFactory::make_voxel_swap_manager(settings->deviceType, lookaheadFrames);
+  }
+
   // Set up the scene.
   reset_scene();
+
+  // If requested, open an archive from which to load a previously saved scene. Only the archive's index is read
+  // at this point: the chunks of voxel blocks it contains are loaded during subsequent frames as they come into view.
+  const std::string sceneArchivePath = settings->get_first_value<std::string>("SLAMComponent.sceneArchive", "");
+  if(sceneArchivePath != "")
+  {
+    VoxelSceneArchive_Ptr sceneArchive = VoxelSceneArchiveFactory::make_voxel_scene_archive(settings->deviceType);
+    sceneArchive->open(sceneArchivePath, voxelScene.get());
+    slamState->set_voxel_scene_archive(sceneArchive);
+
+    // If the relocaliser's contents were saved alongside the scene, load them, so that we can relocalise against the scene
+    // straight away rather than having to learn it again. Failing to do so is not fatal, since the relocaliser can still learn.
+    const std::string relocaliserPath = VoxelSceneArchive::get_relocaliser_path(sceneArchivePath);
+    if(bf::exists(relocaliserPath))
+    {
+      try
+      {
+        m_context->get_relocaliser(m_sceneID)->load_from_disk(relocaliserPath);
+      }
+      catch(std::exception& e)
+      {
+        std::cerr << "Warning: Could not load the relocaliser saved alongside the scene: " << e.what() << '\n';
+      }
+    }
+  }
+
+  // If requested, set up a shared-memory channel via which other processes on the same machine can read the camera poses with
+  // minimal latency. Optionally, the live raycast can be published alongside them.
+  const std::string sharedPoseChannel = settings->get_first_value<std::string>("SLAMComponent.sharedPoseChannel", "");
+  if(sharedPoseChannel != "")
+  {
+    const bool publishImage = settings->get_first_value<bool>("SLAMComponent.sharedPoseChannelImage", false);
+    m_sharedPosePublisher.reset(new SharedPosePublisher(sharedPoseChannel, publishImage ? trackedImageSize : Vector2i(0,0)));
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+SLAMComponent::~SLAMComponent()
+{
+  // Set the flag that informs the prefetcher that it should terminate, and wake it (it might be waiting for work).
+  {
+    boost::lock_guard<boost::mutex> lock(m_prefetchMutex);
+    m_prefetcherShouldTerminate = true;
+  }
+  m_prefetchRequestedCondition.notify_one();
+
+  // Wait for the prefetcher to finish any frame it is acquiring (before the staging frame is destroyed) and terminate gracefully.
+  if(m_prefetcher.joinable()) m_prefetcher.join();
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+int SLAMComponent::defragment_voxel_scene()
+{
+  // Note: The voxel blocks of a shared scene are owned by the shared voxel fuser, which may be holding on to it between frames.
+  if(m_sharedVoxelFuser) throw std::runtime_error("Error: A SLAM component that shares its voxel scene cannot defragment it");
+
+  CUDADeviceScope deviceScope(m_cudaDevice);
+
+  const bool timeGPU = m_context->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA && m_cudaDevice < 0;
+  ProfilingScope stageScope("SLAM.Defragment", timeGPU);
+
+  if(!m_voxelBlockDefragmenter)
+  {
+    m_voxelBlockDefragmenter = VoxelBlockDefragmenterFactory::make_voxel_block_defragmenter(m_context->get_settings()->deviceType);
+  }
+
+  const int residentBlockCount = m_voxelBlockDefragmenter->defragment_scene(m_context->get_slam_state(m_sceneID)->get_voxel_scene().get());
+  if(m_defragmentationHook) m_defragmentationHook();
+  return residentBlockCount;
+}
+
 bool SLAMComponent::get_fusion_enabled() const
 {
   return m_fusionEnabled;
 }
 
+const std::string& SLAMComponent::get_mirror_scene_id() const
+{
+  return m_mirrorSceneID;
+}
+
 void SLAMComponent::mirror_pose_of(const std::string& mirrorSceneID)
 {
   m_mirrorSceneID = mirrorSceneID;
@@ -114,7 +412,27 @@ void SLAMComponent::mirror_pose_of(const std::string& mirrorSceneID)
 
 bool SLAMComponent::process_frame()
 {
-  if(!m_imageSourceEngine->hasMoreImages()) return false;
+  // Process the frame on the device that owns the scene.
+  CUDADeviceScope deviceScope(m_cudaDevice);
+
+  // Note: Each stage of the frame is timed on the GPU as well as the CPU when we're running in CUDA mode, unless the scene
+  //       is owned by a specific device (the profiler's events belong to the device on which they were created).
+  const bool timeGPU = m_context->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA && m_cudaDevice < 0;
+  ProfilingScope frameScope("SLAM.ProcessFrame", timeGPU);
+
+  // Get the next frame (if any).
+  bool frameAvailable, subengineExhausted = false;
+  {
+    ProfilingScope stageScope("SLAM.GetNextFrame", timeGPU);
+    frameAvailable = get_next_frame(subengineExhausted);
+  }
+
+  if(!frameAvailable)
+  {
+    // If we're integrating frames in batches, integrate any frames that are left over at the end of the sequence.
+    if(m_batchedVoxelIntegrator) flush_batched_frames();
+    return false;
+  }
 
   const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
   const ITMShortImage_Ptr& inputRawDepthImage = slamState->get_input_raw_depth_image();
@@ -126,24 +444,42 @@ bool SLAMComponent::process_frame()
   const View_Ptr& view = slamState->get_view();
   const SpaintVoxelScene_Ptr& voxelScene = slamState->get_voxel_scene();
 
-  // Get the next frame.
-  ITMView *newView = view.get();
-  m_imageSourceEngine->getImages(inputRGBImage.get(), inputRawDepthImage.get());
-  const bool useBilateralFilter = m_trackingMode == TRACK_SURFELS;
-  m_viewBuilder->UpdateView(&newView, inputRGBImage.get(), inputRawDepthImage.get(), useBilateralFilter);
-  slamState->set_view(newView);
+  // Build the view for the frame.
+  {
+    ProfilingScope stageScope("SLAM.BuildView", timeGPU);
+    ITMView *newView = view.get();
+    const bool useBilateralFilter = m_trackingMode == TRACK_SURFELS && !m_depthPreprocessor;
+    m_viewBuilder->UpdateView(&newView, inputRGBImage.get(), inputRawDepthImage.get(), useBilateralFilter);
+    slamState->set_view(newView);
+  }
+
+  // If we're preprocessing the depth images, do so now, so that both tracking and fusion see the preprocessed depth image.
+  // Note that this replaces the view builder's (much slower) iterated bilateral filter, which is otherwise used in surfel mode.
+  if(m_depthPreprocessor)
+  {
+    ProfilingScope stageScope("SLAM.PreprocessDepth", timeGPU);
+    (*m_depthPreprocessor)(view->depth);
+  }
 
-  // If there's an active input mask of the right size, apply it to the depth image.
+  // If there's an active input mask of the right size, apply it to the depth image. The masking is done on the device on which
+  // the depth image lives (so that it does not need to be copied across to the CPU and back), and the masked depth image is
+  // swapped into the view for tracking.
   ITMFloatImage_Ptr maskedDepthImage;
   ITMUCharImage_CPtr inputMask = m_context->get_slam_state(m_sceneID)->get_input_mask();
   if(inputMask && inputMask->noDims == view->depth->noDims)
   {
-    view->depth->UpdateHostFromDevice();
-    maskedDepthImage = SegmentationUtil::apply_mask(inputMask, ITMFloatImage_CPtr(view->depth, boost::serialization::null_deleter()), -1.0f);
-    maskedDepthImage->UpdateDeviceFromHost();
+    ProfilingScope stageScope("SLAM.MaskDepth", timeGPU);
+    maskedDepthImage = (*m_depthMasker)(inputMask, view->depth, -1.0f);
     view->depth->Swap(*maskedDepthImage);
   }
 
+  // If we're tracking at a reduced resolution, downsample the (possibly masked) input images for tracking on the device.
+  if(m_trackingDownsampleLevels > 0)
+  {
+    ProfilingScope stageScope("SLAM.DownsampleForTracking", timeGPU);
+    update_tracking_view();
+  }
+
   // Make a note of the current pose in case tracking fails.
   SE3Pose oldPose(*trackingState->pose_d);
 
@@ -151,14 +487,30 @@ bool SLAMComponent::process_frame()
   // If not, use our own tracker to estimate the pose.
   if(m_mirrorSceneID != "")
   {
-    *trackingState->pose_d = m_context->get_slam_state(m_mirrorSceneID)->get_pose();
+    *trackingState->pose_d = m_mirrorPoseProvider ? m_mirrorPoseProvider() : m_context->get_slam_state(m_mirrorSceneID)->get_pose();
     trackingState->trackerResult = ITMTrackingState::TRACKING_GOOD;
   }
   else
   {
     // Note: When using a normal tracker, it's safe to call this even before we've started fusion (it will be a no-op).
     //       When using a file-based tracker, we *must* call it in order to correctly set the pose for the first frame.
-    m_trackingController->Track(trackingState.get(), view.get());
+    ProfilingScope stageScope("SLAM.Track", timeGPU);
+
+    // If we're using a motion model and it can predict the pose for this frame, start tracking from the predicted pose.
+    boost::optional<SE3Pose> predictedPose = m_motionModel ? m_motionModel->predict_pose() : boost::none;
+    if(predictedPose) *trackingState->pose_d = *predictedPose;
+    const SE3Pose initialPose(*trackingState->pose_d);
+
+    m_trackingController->Track(trackingState.get(), m_trackingView ? m_trackingView.get() : view.get());
+
+    // Record how far the tracker had to move the pose from its initial estimate. The tracker does not report the number of
+    // iterations it took, but this correction is what drives it, so it can be used to measure the effect of the motion model.
+    Vector3f r1, t1, r2, t2;
+    initialPose.GetParams(t1, r1);
+    trackingState->pose_d->GetParams(t2, r2);
+    Profiler& profiler = Profiler::instance();
+    profiler.set_gauge("SLAM.TrackingCorrectionRotation", DualQuatd::angle_between_rotations(DualQuatd::from_rotation(r1), DualQuatd::from_rotation(r2)));
+    profiler.set_gauge("SLAM.TrackingCorrectionTranslation", length(t2 - t1));
   }
 
   // If there was an active input mask, restore the original depth image after tracking.
@@ -170,6 +522,7 @@ bool SLAMComponent::process_frame()
     case ITMLibSettings::FAILUREMODE_RELOCALISE:
     {
       // Allow the relocaliser to either improve the pose, store a new keyframe or update its model.
+      ProfilingScope stageScope("SLAM.Relocalise", timeGPU);
       process_relocalisation();
       break;
     }
@@ -192,6 +545,14 @@ bool SLAMComponent::process_frame()
     }
   }
 
+  // Update the motion model with the final pose for the frame. If tracking was not good, the camera's recent motion
+  // can no longer be trusted (and a relocalised pose may be far from the previous one), so the model is reset.
+  if(m_motionModel)
+  {
+    if(trackingState->trackerResult == ITMTrackingState::TRACKING_GOOD) m_motionModel->update(*trackingState->pose_d);
+    else m_motionModel->reset();
+  }
+
   // Decide whether or not fusion should be run.
   bool runFusion = m_fusionEnabled;
   if(trackingState->trackerResult == ITMTrackingState::TRACKING_FAILED ||
@@ -201,20 +562,94 @@ bool SLAMComponent::process_frame()
     runFusion = false;
   }
 
+  // If we're throttling fusion for a static camera, and neither the camera nor the scene has changed appreciably since we last fused a frame, skip fusion.
+  if(runFusion && m_depthChangeEstimator)
+  {
+    ProfilingScope stageScope("SLAM.DetectStaticCamera", timeGPU);
+    if(should_skip_static_fusion(view.get(), trackingState.get())) runFusion = false;
+    Profiler::instance().set_gauge("SLAM.StaticFramesSinceFusion", m_staticFramesSinceFusion);
+  }
+
+  // If the scene is being loaded lazily from an archive, load any parts of it that have come into view.
+  const VoxelSceneArchive_Ptr& sceneArchive = slamState->get_voxel_scene_archive();
+  if(sceneArchive && trackingState->trackerResult != ITMTrackingState::TRACKING_FAILED)
+  {
+    ProfilingScope stageScope("SLAM.LoadVisibleChunks", timeGPU);
+    if(sceneArchive->load_visible_chunks(*trackingState->pose_d, view->calib.intrinsics_d.projectionParamsSimple.all, view->depth->noDims, voxelScene.get()) > 0)
+    {
+      // Note: The loaded voxel blocks may have replaced blocks whose occupancy or convergence was recorded, so we conservatively forget it all.
+      voxelScene->reset_block_occupancy();
+      if(m_convergedBlockFilter) m_convergedBlockFilter->reset();
+      m_blockVersionTracker->stamp_all_blocks(voxelScene.get(), BlockVersionTracker::VERSION_ALL);
+      slamState->notify_voxel_scene_changed();
+    }
+  }
+
   if(runFusion)
   {
     // Run the fusion process.
-    m_denseVoxelMapper->ProcessFrame(view.get(), trackingState.get(), voxelScene.get(), liveVoxelRenderState.get());
+    ProfilingScope stageScope("SLAM.Fusion", timeGPU);
+    if(m_voxelSwapManager)
+    {
+      m_voxelSwapManager->prepare_for_fusion(
+        *trackingState->pose_d, view->calib.intrinsics_d.projectionParamsSimple.all, view->depth->noDims, voxelScene.get(), liveVoxelRenderState.get()
+      );
+    }
+
+    if(m_sharedVoxelFuser)
+    {
+      // Allocate the voxel blocks that the frame needs in the shared scene, and leave it to be fused along with the frames from the
+      // other sensors that share the scene once they have all been processed.
+      m_sharedVoxelFuser->add_frame(view.get(), trackingState.get(), liveVoxelRenderState.get());
+    }
+    else if(m_batchedVoxelIntegrator)
+    {
+      // Allocate the voxel blocks that the frame needs and add it to the current batch, integrating the batch once it is full.
+      m_sceneReconstructionEngine->AllocateSceneFromDepth(voxelScene.get(), view.get(), trackingState.get(), liveVoxelRenderState.get());
+      if(m_batchedVoxelIntegrator->add_frame(view.get(), trackingState.get(), liveVoxelRenderState.get())) flush_batched_frames();
+    }
+    else
+    {
+      if(m_convergedBlockFilter) fuse_voxels_skipping_converged_blocks();
+      else
+      {
+        m_denseVoxelMapper->ProcessFrame(view.get(), trackingState.get(), voxelScene.get(), liveVoxelRenderState.get());
+        m_blockVersionTracker->stamp_visible_blocks(voxelScene.get(), liveVoxelRenderState.get(), BlockVersionTracker::VERSION_GEOMETRY);
+      }
+
+      if(m_voxelSwapManager) m_voxelSwapManager->restore_swapped_in_labels(voxelScene.get());
+
+      // Note: Any voxel blocks that were swapped in have been given new storage, whose label data was either just restored or is stale,
+      //       so we conservatively stamp the labels of all of the visible blocks as changed.
+      if(voxelScene->globalCache) m_blockVersionTracker->stamp_visible_blocks(voxelScene.get(), liveVoxelRenderState.get(), BlockVersionTracker::VERSION_LABELS);
+      if(m_blockOccupancyUpdater) m_blockOccupancyUpdater->update_block_occupancy(voxelScene.get(), liveVoxelRenderState.get());
+      slamState->notify_voxel_scene_changed();
+    }
+
     if(m_mappingMode != MAP_VOXELS_ONLY)
     {
       m_denseSurfelMapper->ProcessFrame(view.get(), trackingState.get(), surfelScene.get(), liveSurfelRenderState.get());
+
+      // Note: Fusing a frame can add, merge and remove surfels, so any existing index image can no longer be trusted.
+      m_lastSurfelIndexPose.reset();
     }
 
     ++m_fusedFramesCount;
+
+    // If we're throttling fusion for a static camera, record the frame we just fused, so that subsequent frames can be compared with it.
+    if(m_depthChangeEstimator)
+    {
+      m_lastFusedDepth->SetFrom(view->depth, m_context->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA ? ITMFloatImage::CUDA_TO_CUDA : ITMFloatImage::CPU_TO_CPU);
+      m_lastFusedPose = *trackingState->pose_d;
+      m_staticFramesSinceFusion = 0;
+    }
+
+    if(m_fusionHook) m_fusionHook();
   }
   else if(trackingState->trackerResult != ITMTrackingState::TRACKING_FAILED)
   {
     // If we're not fusing, but the tracking has not completely failed, update the list of visible blocks so that things are kept up to date.
+    ProfilingScope stageScope("SLAM.UpdateVisibleList", timeGPU);
     m_denseVoxelMapper->UpdateVisibleList(view.get(), trackingState.get(), voxelScene.get(), liveVoxelRenderState.get());
   }
   else
@@ -223,50 +658,136 @@ bool SLAMComponent::process_frame()
     *trackingState->pose_d = oldPose;
   }
 
-  // Render from the live camera position to prepare for tracking in the next frame.
-  prepare_for_tracking(m_trackingMode);
+  // If we're integrating frames in batches but didn't fuse this frame (e.g. because fusion has been disabled), integrate the frames
+  // in the current batch now, rather than holding them back until fusion resumes.
+  if(!runFusion && m_batchedVoxelIntegrator) flush_batched_frames();
 
-  // If we're using surfel mapping, render a supersampled index image to use when finding surfel correspondences in the next frame.
-  if(m_mappingMode != MAP_VOXELS_ONLY)
+  // The pose for this frame is now final, so any scenes that mirror it can proceed. We also publish it to any external
+  // consumers at this point, rather than at the end of the frame, to avoid making them wait for the raycast.
+  if(m_poseFinalisedHook) m_poseFinalisedHook();
+  if(m_sharedPosePublisher)
+  {
+    m_sharedPosePublisher->publish_pose(*trackingState->pose_d, slamState->get_input_timestamps().hostReceiveTime, m_processedFramesCount, trackingState->trackerResult);
+  }
+
+  {
+    ProfilingScope stageScope("SLAM.PrepareForTracking", timeGPU);
+
+    // Render from the live camera position to prepare for tracking in the next frame.
+    prepare_for_tracking(m_trackingMode);
+
+    // If we're using surfel mapping, render a supersampled index image to use when finding surfel correspondences in the next frame.
+    // If the surfel scene has not changed since the existing index image was rendered, and the camera has barely moved since then,
+    // we reuse the existing index image instead. Since we compare against the pose from which it was rendered, rather than the
+    // pose in the previous frame, a slowly moving camera cannot make the index image drift arbitrarily far from the current pose.
+    if(m_mappingMode != MAP_VOXELS_ONLY)
+    {
+      if(!m_lastSurfelIndexPose || !GeometryUtil::poses_are_similar(*m_lastSurfelIndexPose, *trackingState->pose_d, m_surfelIndexReuseMaxRotation, m_surfelIndexReuseMaxTranslation))
+      {
+        m_context->get_surfel_visualisation_engine()->FindSurfaceSuper(surfelScene.get(), trackingState->pose_d, &view->calib.intrinsics_d, USR_RENDER, liveSurfelRenderState.get());
+        m_lastSurfelIndexPose = *trackingState->pose_d;
+      }
+    }
+  }
+
+  // If we're publishing the live raycast to external consumers, do so now that it has been rendered.
+  if(m_sharedPosePublisher && m_sharedPosePublisher->has_image())
   {
-    m_context->get_surfel_visualisation_engine()->FindSurfaceSuper(surfelScene.get(), trackingState->pose_d, &view->calib.intrinsics_d, USR_RENDER, liveSurfelRenderState.get());
+    ITMFloat4Image *raycastResult = liveVoxelRenderState->raycastResult;
+    raycastResult->UpdateHostFromDevice();
+    m_sharedPosePublisher->publish_image(raycastResult, slamState->get_input_timestamps().hostReceiveTime);
   }
 
   // If we're using a composite image source engine and the current sub-engine has run out of images, disable fusion.
-  CompositeImageSourceEngine_CPtr compositeImageSourceEngine = boost::dynamic_pointer_cast<const CompositeImageSourceEngine>(m_imageSourceEngine);
-  if(compositeImageSourceEngine && !compositeImageSourceEngine->getCurrentSubengine()->hasMoreImages()) m_fusionEnabled = false;
+  if(subengineExhausted) m_fusionEnabled = false;
 
-  // If we're using a fiducial detector and the user wants to detect fiducials and the tracking is good, try to detect fiducial markers
-  // in the current view of the scene and update the current set of fiducials that we're maintaining accordingly.
-  if(m_fiducialDetector && m_detectFiducials && trackingState->trackerResult == ITMTrackingState::TRACKING_GOOD)
+  // If we're using a fiducial detector and the user wants to detect fiducials, try to detect fiducial markers in the current
+  // view of the scene and update the current set of fiducials that we're maintaining accordingly.
+  if(m_fiducialDetector && m_detectFiducials)
   {
-    slamState->update_fiducials(m_fiducialDetector->detect_fiducials(view, *trackingState->pose_d, liveVoxelRenderState, FiducialDetector::PEM_RAYCAST));
+    ProfilingScope stageScope("SLAM.ProcessFiducials", timeGPU);
+    process_fiducials();
   }
 
+  // If we're defragmenting the voxel scene periodically, and enough frames have been fused since it was last defragmented, do so now.
+  // This happens at the end of the frame, so that it does not delay the publication of the pose or the raycast for tracking.
+  if(runFusion && m_defragmentationInterval > 0 && m_fusedFramesCount % m_defragmentationInterval == 0) defragment_voxel_scene();
+
+  // Report how much of the voxel scene's storage is in use, now that this frame's blocks have been allocated.
+  update_occupancy_telemetry();
+
+  // Report the end-to-end latency of the frame, from its capture to the end of its processing.
+  const FrameTimestamps::Clock::duration latency = FrameTimestamps::Clock::now() - slamState->get_input_timestamps().hostReceiveTime;
+  Profiler::instance().set_gauge("SLAM.FrameLatency", boost::chrono::duration<double,boost::milli>(latency).count());
+
+  ++m_processedFramesCount;
   return true;
 }
 
 void SLAMComponent::reset_scene()
 {
-  // Reset the scene.
+  CUDADeviceScope deviceScope(m_cudaDevice);
+
+  // Reset the scene. The first reset of a voxel scene must clear the whole of its voxel block array, since that starts out
+  // uninitialised, but after that, any block that is not in use is known to be clear, so only the resident blocks need clearing.
   const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
-  m_denseVoxelMapper->ResetScene(slamState->get_voxel_scene().get());
+  if(m_voxelSceneResetter && m_voxelSceneInitialised) m_voxelSceneResetter->reset_scene(slamState->get_voxel_scene().get());
+  else m_denseVoxelMapper->ResetScene(slamState->get_voxel_scene().get());
+  m_voxelSceneInitialised = true;
+  slamState->get_voxel_scene()->reset_block_occupancy();
+  slamState->get_voxel_scene()->reset_block_versions();
+  slamState->get_voxel_scene()->reset_label_presence();
+#ifdef USE_LABEL_VOLUME
+  // Note: Resetting the scene only resets the voxels themselves, so we need to clear the separate label volume as well.
+  //       This must happen before the label counts are reset, since clearing decrements the counts of the labels it clears.
+  VoxelMarkerFactory::make_voxel_marker(m_context->get_settings()->deviceType)->clear_labels(slamState->get_voxel_scene().get(), ClearingSettings(CLEAR_ALL, 0, 0));
+#endif
+  slamState->get_voxel_scene()->reset_label_counts();
+  slamState->get_voxel_scene()->reset_label_evidence();
+  slamState->notify_voxel_scene_changed();
   if(m_mappingMode != MAP_VOXELS_ONLY)
   {
     slamState->get_surfel_scene()->Reset();
+    m_lastSurfelIndexPose.reset();
   }
 
   // Reset the tracking state.
   slamState->get_tracking_state()->Reset();
+  slamState->set_live_voxel_raycast_pose(boost::none);
+
+  // Stop loading the scene from an archive (if we were), since the loaded parts of it have been discarded.
+  slamState->set_voxel_scene_archive(VoxelSceneArchive_Ptr());
 
   // Reset the relocaliser.
   m_context->get_relocaliser(m_sceneID)->reset();
 
+  // Discard any fiducial measurements that are still being made in the background, since they refer to the old scene.
+  if(m_backgroundFiducialDetector) m_backgroundFiducialDetector->reset();
+
+  // Stop the voxel swap manager from extrapolating the camera's trajectory from poses in the old scene.
+  if(m_voxelSwapManager) m_voxelSwapManager->reset();
+
+  // Forget which voxel blocks had converged in the old scene.
+  if(m_convergedBlockFilter) m_convergedBlockFilter->reset();
+
+  // Forget the most recently fused frame, since it was fused into the old scene.
+  m_lastFusedPose.reset();
+  m_staticFramesSinceFusion = 0;
+
+  // Discard any frames that were waiting to be integrated into the old scene.
+  if(m_batchedVoxelIntegrator) m_batchedVoxelIntegrator->discard();
+  if(m_sharedVoxelFuser) m_sharedVoxelFuser->discard();
+
   // Reset some variables to their initial values.
   m_fusedFramesCount = 0;
   m_fusionEnabled = true;
 }
 
+void SLAMComponent::set_defragmentation_hook(const boost::function<void()>& hook)
+{
+  m_defragmentationHook = hook;
+}
+
 void SLAMComponent::set_detect_fiducials(bool detectFiducials)
 {
   m_detectFiducials = detectFiducials;
@@ -277,14 +798,245 @@ void SLAMComponent::set_fusion_enabled(bool fusionEnabled)
   m_fusionEnabled = fusionEnabled;
 }
 
+void SLAMComponent::set_fusion_hook(const boost::function<void()>& hook)
+{
+  m_fusionHook = hook;
+}
+
+void SLAMComponent::set_mirror_pose_provider(const boost::function<ORUtils::SE3Pose()>& provider)
+{
+  m_mirrorPoseProvider = provider;
+}
+
+void SLAMComponent::set_pose_finalised_hook(const boost::function<void()>& hook)
+{
+  m_poseFinalisedHook = hook;
+}
+
+void SLAMComponent::set_shared_voxel_fuser(const SharedVoxelFuser_Ptr& fuser)
+{
+  // Make sure that we're not using any feature that needs to manage the component's own voxel scene.
+  if(m_batchedVoxelIntegrator || m_convergedBlockFilter || m_voxelSwapManager || m_defragmentationInterval > 0)
+  {
+    throw std::runtime_error("Error: A SLAM component that shares its voxel scene cannot use batched integration, converged block filtering, swapping or periodic defragmentation");
+  }
+
+  if(m_cudaDevice >= 0)
+  {
+    throw std::runtime_error("Error: A SLAM component whose scene is owned by a specific CUDA device cannot share its voxel scene");
+  }
+
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+  if(slamState->get_voxel_scene_archive())
+  {
+    throw std::runtime_error("Error: A SLAM component that is loading its scene from an archive cannot share its voxel scene");
+  }
+
+  // Replace the component's own voxel scene with the shared one.
+  m_sharedVoxelFuser = fuser;
+  slamState->set_voxel_scene(fuser->get_voxel_scene());
+  m_voxelSceneInitialised = false;
+  slamState->set_live_voxel_raycast_pose(boost::none);
+  slamState->notify_voxel_scene_changed();
+}
+
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+void SLAMComponent::acquire_frame(StagedFrame& frame)
+{
+  frame.available = m_imageSourceEngine->hasMoreImages();
+  frame.subengineExhausted = false;
+  if(!frame.available) return;
+
+  // Note: Once hasMoreImages has returned true, the current sub-engine of a composite image source is the one that will provide the images.
+  CompositeImageSourceEngine_CPtr compositeImageSourceEngine = boost::dynamic_pointer_cast<const CompositeImageSourceEngine>(m_imageSourceEngine);
+  const ImageSourceEngine *currentSubengine = compositeImageSourceEngine ? compositeImageSourceEngine->getCurrentSubengine() : m_imageSourceEngine.get();
+
+  // If the images can come from an asynchronous image source, swap them into the frame rather than copying them. A swapping
+  // composite image source does this itself (for its asynchronous sub-engines); a standalone asynchronous image source can
+  // do it directly.
+  SwappingCompositeImageSourceEngine *swappingImageSourceEngine = dynamic_cast<SwappingCompositeImageSourceEngine*>(m_imageSourceEngine.get());
+  AsyncImageSourceEngine *asyncImageSourceEngine = dynamic_cast<AsyncImageSourceEngine*>(m_imageSourceEngine.get());
+  if(swappingImageSourceEngine) swappingImageSourceEngine->getImages(*frame.rgb, *frame.rawDepth);
+  else if(asyncImageSourceEngine) asyncImageSourceEngine->getImages(*frame.rgb, *frame.rawDepth);
+  else m_imageSourceEngine->getImages(frame.rgb.get(), frame.rawDepth.get());
+
+  // Note: We check whether the current sub-engine has run out of images immediately after getting the images,
+  //       since if we're pipelining, the sub-engine may have moved on by the time the frame is processed.
+
+  // Record when the frame was captured. If the image source that provided it can't tell us, the best we can do is to use the time at which we got it.
+  const FrameTimestampSource *timestampSource = dynamic_cast<const FrameTimestampSource*>(currentSubengine);
+  frame.timestamps = timestampSource ? timestampSource->get_frame_timestamps() : FrameTimestamps();
+
+  // Record the region of interest (if any) of the frame.
+  const ImageRegionSource *regionSource = dynamic_cast<const ImageRegionSource*>(currentSubengine);
+  frame.imageRegion = regionSource ? regionSource->get_image_region() : boost::none;
+
+  frame.subengineExhausted = compositeImageSourceEngine && !currentSubengine->hasMoreImages();
+}
+
+void SLAMComponent::flush_batched_frames()
+{
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+  const SpaintVoxelScene_Ptr& voxelScene = slamState->get_voxel_scene();
+  if(m_batchedVoxelIntegrator->flush(voxelScene.get()) == 0) return;
+
+  // Note: The batch may have changed any block that was visible in any of its frames, so we conservatively forget the recorded block
+  //       occupancy, and then re-establish it for the blocks that are visible in the most recent frame. For the same reason, we
+  //       stamp the geometry of every block as changed.
+  voxelScene->reset_block_occupancy();
+  if(m_blockOccupancyUpdater) m_blockOccupancyUpdater->update_block_occupancy(voxelScene.get(), slamState->get_live_voxel_render_state().get());
+  m_blockVersionTracker->stamp_all_blocks(voxelScene.get(), BlockVersionTracker::VERSION_GEOMETRY);
+  slamState->notify_voxel_scene_changed();
+}
+
+void SLAMComponent::fuse_voxels_skipping_converged_blocks()
+{
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+  const VoxelRenderState_Ptr& liveVoxelRenderState = slamState->get_live_voxel_render_state();
+  const TrackingState_Ptr& trackingState = slamState->get_tracking_state();
+  const View_Ptr& view = slamState->get_view();
+  const SpaintVoxelScene_Ptr& voxelScene = slamState->get_voxel_scene();
+
+  // Allocate the voxel blocks that the frame will touch, and find the visible blocks.
+  m_sceneReconstructionEngine->AllocateSceneFromDepth(voxelScene.get(), view.get(), trackingState.get(), liveVoxelRenderState.get());
+
+  // Integrate the frame into the visible blocks that have not converged (or that have changed since they did).
+  m_convergedBlockFilter->exclude_converged_blocks(view.get(), trackingState.get(), voxelScene.get(), liveVoxelRenderState.get());
+  m_sceneReconstructionEngine->IntegrateIntoScene(voxelScene.get(), view.get(), trackingState.get(), liveVoxelRenderState.get());
+
+  // Stamp the blocks into which the frame was actually integrated, before the converged blocks are restored to the visible list.
+  m_blockVersionTracker->stamp_visible_blocks(voxelScene.get(), liveVoxelRenderState.get(), BlockVersionTracker::VERSION_GEOMETRY);
+  m_convergedBlockFilter->finish_integration(voxelScene.get(), liveVoxelRenderState.get());
+
+  // Swap voxel blocks between the GPU and the host as the dense voxel mapper would.
+  if(m_swappingEngine)
+  {
+    const ITMLibSettings::SwappingMode swappingMode = m_context->get_settings()->swappingMode;
+    if(swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED)
+    {
+      m_swappingEngine->IntegrateGlobalIntoLocal(voxelScene.get(), liveVoxelRenderState.get());
+      m_swappingEngine->SaveToGlobalMemory(voxelScene.get(), liveVoxelRenderState.get());
+    }
+    else if(swappingMode == ITMLibSettings::SWAPPINGMODE_DELETE)
+    {
+      m_swappingEngine->CleanLocalMemory(voxelScene.get(), liveVoxelRenderState.get());
+    }
+  }
+}
+
+bool SLAMComponent::get_next_frame(bool& subengineExhausted)
+{
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+
+  if(m_pipelineFrames)
+  {
+    // If the images for the next frame are being acquired asynchronously, wait for the acquisition to finish.
+    // If not (e.g. because this is the first frame), acquire them synchronously.
+    if(m_prefetchIssued) wait_for_prefetched_frame();
+    else acquire_frame(m_stagedFrame);
+
+    if(!m_stagedFrame.available) return false;
+
+    // Swap the staged images into the SLAM state's input images (this avoids any copying), and then
+    // start acquiring the images for the frame after this one into the buffers we just swapped out.
+    slamState->get_input_raw_depth_image()->Swap(*m_stagedFrame.rawDepth);
+    slamState->get_input_rgb_image()->Swap(*m_stagedFrame.rgb);
+    slamState->set_input_region(m_stagedFrame.imageRegion);
+    slamState->set_input_timestamps(m_stagedFrame.timestamps);
+    subengineExhausted = m_stagedFrame.subengineExhausted;
+
+    // Note: The prefetcher is started the first time it is needed, and then reused for every subsequent frame.
+    if(!m_prefetcher.joinable()) m_prefetcher = boost::thread(boost::bind(&SLAMComponent::run_prefetcher, this));
+    {
+      boost::lock_guard<boost::mutex> lock(m_prefetchMutex);
+      m_prefetchRequested = true;
+    }
+    m_prefetchRequestedCondition.notify_one();
+    m_prefetchIssued = true;
+    return true;
+  }
+  else
+  {
+    StagedFrame frame;
+    frame.rawDepth = slamState->get_input_raw_depth_image();
+    frame.rgb = slamState->get_input_rgb_image();
+    acquire_frame(frame);
+    slamState->set_input_region(frame.imageRegion);
+    slamState->set_input_timestamps(frame.timestamps);
+    subengineExhausted = frame.subengineExhausted;
+    return frame.available;
+  }
+}
+
+boost::optional<Vector4i> SLAMComponent::get_raycast_region(const boost::optional<Vector4i>& inputRegion, const Vector2i& imgSize) const
+{
+  if(!inputRegion) return boost::none;
+
+  return Vector4i(
+    std::max(inputRegion->x - m_inputRegionMargin, 0),
+    std::max(inputRegion->y - m_inputRegionMargin, 0),
+    std::min(inputRegion->z + m_inputRegionMargin, imgSize.x - 1),
+    std::min(inputRegion->w + m_inputRegionMargin, imgSize.y - 1)
+  );
+}
+
+Relocaliser_Ptr SLAMComponent::make_inner_relocaliser(const std::string& relocaliserType) const
+{
+  const Settings_CPtr& settings = m_context->get_settings();
+  static const std::string settingsNamespace = "SLAMComponent.";
+
+  // Construct a relocaliser of the specified type.
+  Relocaliser_Ptr relocaliser;
+  if(relocaliserType == "ferns")
+  {
+    relocaliser.reset(new FernRelocaliser(
+      settings->sceneParams.viewFrustum_min,
+      settings->sceneParams.viewFrustum_max,
+      FernRelocaliser::get_default_harvesting_threshold(),
+      FernRelocaliser::get_default_num_ferns(),
+      FernRelocaliser::get_default_num_decisions_per_fern(),
+      settings->deviceType,
+      m_relocaliseEveryFrame ? FernRelocaliser::ALWAYS_TRY_ADD : FernRelocaliser::DELAY_AFTER_RELOCALISATION
+    ));
+  }
+#ifdef WITH_GROVE
+  else if(relocaliserType == "forest")
+  {
+    const std::string forestPath = settings->get_first_value<std::string>(settingsNamespace + "relocalisationForestPath");
+    relocaliser = grove::ScoreRelocaliserFactory::make_score_relocaliser(forestPath, settings);
+  }
+#endif
+  else throw std::invalid_argument("Invalid relocaliser type: " + relocaliserType);
+
+  // If requested, decorate this relocaliser with one that trains it on a separate thread.
+  if(m_trainRelocaliserInBackground)
+  {
+    relocaliser.reset(new BackgroundRelocaliser(relocaliser, settings->deviceType));
+  }
+
+  return relocaliser;
+}
+
+Relocaliser_Ptr SLAMComponent::make_refining_relocaliser(const Relocaliser_Ptr& innerRelocaliser, const Tracker_Ptr& tracker,
+                                                         const boost::optional<size_t>& hypothesisCount) const
+{
+  return Relocaliser_Ptr(new ICPRefiningRelocaliser<SpaintVoxel,ITMVoxelIndex>(
+    innerRelocaliser, tracker, m_imageSourceEngine->getRGBImageSize(), m_imageSourceEngine->getDepthImageSize(), m_imageSourceEngine->getCalib(),
+    m_context->get_slam_state(m_sceneID)->get_voxel_scene(), m_denseVoxelMapper, m_context->get_settings(), m_context->get_voxel_visualisation_engine(),
+    hypothesisCount
+  ));
+}
+
 void SLAMComponent::prepare_for_tracking(TrackingMode trackingMode)
 {
   const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
   const TrackingState_Ptr& trackingState = slamState->get_tracking_state();
   const View_Ptr& view = slamState->get_view();
 
+  // Until we know otherwise, assume that the live voxel render state does not contain an up-to-date raycast of the voxel scene.
+  slamState->set_live_voxel_raycast_pose(boost::none);
+
   switch(trackingMode)
   {
     case TRACK_SURFELS:
@@ -298,13 +1050,73 @@ void SLAMComponent::prepare_for_tracking(TrackingMode trackingMode)
     default:
     {
       const SpaintVoxelScene_Ptr& voxelScene = slamState->get_voxel_scene();
-      const VoxelRenderState_Ptr& liveVoxelRenderState = slamState->get_live_voxel_render_state();
-      m_trackingController->Prepare(trackingState.get(), voxelScene.get(), view.get(), m_context->get_voxel_visualisation_engine().get(), liveVoxelRenderState.get());
+
+      // If we're tracking at a reduced resolution, raycast into the reduced-resolution render state, having first found the voxel
+      // blocks that are visible in the reduced-resolution view (the live render state's list of visible blocks is maintained by
+      // fusion). Note that in this case, the live render state is not raycast, so its raycast can be out of date.
+      ITMView *trackingView = view.get();
+      VoxelRenderState *trackingRenderState = slamState->get_live_voxel_render_state().get();
+      boost::optional<Vector4i> inputRegion = slamState->get_input_region();
+      if(m_trackingView && m_trackingVoxelRenderState)
+      {
+        trackingView = m_trackingView.get();
+        trackingRenderState = m_trackingVoxelRenderState.get();
+        m_denseVoxelMapper->UpdateVisibleList(trackingView, trackingState.get(), voxelScene.get(), trackingRenderState);
+
+        const int levels = m_trackingDownsampleLevels;
+        if(inputRegion) inputRegion = Vector4i(inputRegion->x >> levels, inputRegion->y >> levels, inputRegion->z >> levels, inputRegion->w >> levels);
+      }
+
+      // If the input images have a region of interest, limit the raycast to that region (expanded by the margin).
+      const boost::optional<Vector4i> raycastRegion = get_raycast_region(inputRegion, trackingRenderState->raycastResult->noDims);
+      voxelScene->set_raycast_region(trackingRenderState, raycastRegion);
+
+      m_trackingController->Prepare(trackingState.get(), voxelScene.get(), trackingView, m_context->get_voxel_visualisation_engine().get(), trackingRenderState);
+
+      // If the tracking controller has just performed a full raycast of the scene from the live pose (rather than skipping the
+      // rendering or forward-projecting an old raycast), record the fact so that the raycast can be reused for visualisation.
+      // (InfiniTAM resets the age of the point cloud to 0, or to -2 on the first frame, whenever it performs a full raycast.)
+      // Note: A raycast that was limited to a region, or made into the reduced-resolution render state, cannot be reused.
+      if(!raycastRegion && trackingView == view.get() &&
+         (trackingState->age_pointCloud == 0 || trackingState->age_pointCloud == -2) && trackingState->pose_pointCloud->GetM() == trackingState->pose_d->GetM())
+      {
+        slamState->set_live_voxel_raycast_pose(*trackingState->pose_d);
+      }
       break;
     }
   }
 }
 
+void SLAMComponent::process_fiducials()
+{
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+
+  // If we're detecting fiducials in the background, integrate any measurements that have been made since the last frame.
+  if(m_backgroundFiducialDetector)
+  {
+    const std::vector<BackgroundFiducialDetector::Result> results = m_backgroundFiducialDetector->take_results();
+    for(size_t i = 0, size = results.size(); i < size; ++i)
+    {
+      slamState->update_fiducials(results[i].measurements);
+    }
+  }
+
+  // If the tracking is good, detect any fiducials in the current view of the scene (either now, or in the background).
+  const TrackingState_Ptr& trackingState = slamState->get_tracking_state();
+  if(trackingState->trackerResult != ITMTrackingState::TRACKING_GOOD) return;
+
+  const View_Ptr& view = slamState->get_view();
+  const VoxelRenderState_Ptr& liveVoxelRenderState = slamState->get_live_voxel_render_state();
+  if(m_backgroundFiducialDetector)
+  {
+    m_backgroundFiducialDetector->submit(m_processedFramesCount, view, *trackingState->pose_d, liveVoxelRenderState, FiducialDetector::PEM_RAYCAST);
+  }
+  else
+  {
+    slamState->update_fiducials(m_fiducialDetector->detect_fiducials(view, *trackingState->pose_d, liveVoxelRenderState, FiducialDetector::PEM_RAYCAST));
+  }
+}
+
 void SLAMComponent::process_relocalisation()
 {
   const Relocaliser_Ptr& relocaliser = m_context->get_relocaliser(m_sceneID);
@@ -317,9 +1129,10 @@ void SLAMComponent::process_relocalisation()
   const SE3Pose oldPose(*trackingState->pose_d);
 
   // If we're not training in this frame, allow the relocaliser to perform any necessary internal bookkeeping.
-  // Note that we prevent training and bookkeeping from both running in the same frame for performance reasons.
+  // Note that we prevent training and bookkeeping from both running in the same frame for performance reasons,
+  // unless they are both being performed in the background, in which case neither is on the critical path.
   const bool performTraining = trackingState->trackerResult == ITMTrackingState::TRACKING_GOOD || m_relocaliseEveryFrame;
-  if(!performTraining)
+  if(!performTraining || m_trainRelocaliserInBackground)
   {
     relocaliser->update();
   }
@@ -353,35 +1166,58 @@ void SLAMComponent::process_relocalisation()
   }
 }
 
+void SLAMComponent::run_prefetcher()
+{
+  Profiler::instance().set_thread_name("Frame prefetcher");
+
+  for(;;)
+  {
+    // Wait until there is a frame to acquire, or termination is requested.
+    {
+      boost::unique_lock<boost::mutex> lock(m_prefetchMutex);
+      while(!m_prefetcherShouldTerminate && !m_prefetchRequested) m_prefetchRequestedCondition.wait(lock);
+
+      // If we were asked to terminate, do so.
+      if(m_prefetcherShouldTerminate) return;
+    }
+
+    // Acquire the images into the staged frame. Any exception is handed back to the main thread, which rethrows it when it waits for the frame.
+    std::string error;
+    try
+    {
+      acquire_frame(m_stagedFrame);
+    }
+    catch(std::exception& e)
+    {
+      error = e.what();
+    }
+
+    // Tell the main thread that the staged frame is ready.
+    {
+      boost::lock_guard<boost::mutex> lock(m_prefetchMutex);
+      m_prefetchError = error;
+      m_prefetchRequested = false;
+    }
+    m_prefetchFinished.notify_one();
+  }
+}
+
 void SLAMComponent::setup_relocaliser()
 {
   const Vector2i depthImageSize = m_imageSourceEngine->getDepthImageSize();
   const Vector2i rgbImageSize = m_imageSourceEngine->getRGBImageSize();
   const Settings_CPtr& settings = m_context->get_settings();
-  const SpaintVoxelScene_Ptr& voxelScene = m_context->get_slam_state(m_sceneID)->get_voxel_scene();
 
   // Look up the non-relocaliser-specific settings, such as the type of relocaliser to construct.
   static const std::string settingsNamespace = "SLAMComponent.";
   m_relocaliseEveryFrame = settings->get_first_value<bool>(settingsNamespace + "relocaliseEveryFrame", false);
   m_relocaliserType = settings->get_first_value<std::string>(settingsNamespace + "relocaliserType", "ferns");
 
-  // Construct a relocaliser of the specified type.
-  Relocaliser_Ptr innerRelocaliser;
-  if(m_relocaliserType == "ferns")
-  {
-    innerRelocaliser.reset(new FernRelocaliser(
-      depthImageSize,
-      settings->sceneParams.viewFrustum_min,
-      settings->sceneParams.viewFrustum_max,
-      FernRelocaliser::get_default_harvesting_threshold(),
-      FernRelocaliser::get_default_num_ferns(),
-      FernRelocaliser::get_default_num_decisions_per_fern(),
-      m_relocaliseEveryFrame ? FernRelocaliser::ALWAYS_TRY_ADD : FernRelocaliser::DELAY_AFTER_RELOCALISATION
-    ));
-  }
-  else throw std::invalid_argument("Invalid relocaliser type: " + m_relocaliserType);
+  // Note that when relocalising every frame for evaluation purposes, we train synchronously by default,
+  // so that each frame is relocalised against a model that has been trained on all of the previous frames.
+  m_trainRelocaliserInBackground = settings->get_first_value<bool>(settingsNamespace + "trainRelocaliserInBackground", !m_relocaliseEveryFrame);
 
-  // Now decorate this relocaliser with one that uses an ICP tracker to refine the results.
+  // Construct the ICP tracker that will be used to refine the results of the relocaliser.
   std::string trackerConfig = "<tracker type='infinitam'>";
   std::string trackerParams = settings->get_first_value<std::string>(settingsNamespace + "refinementTrackerParams", "");
   if(trackerParams != "") trackerConfig += "<params>" + trackerParams + "</params>";
@@ -391,21 +1227,152 @@ void SLAMComponent::setup_relocaliser()
   FallibleTracker *dummy;
   Tracker_Ptr tracker = TrackerFactory::make_tracker_from_string(trackerConfig, trackSurfels, rgbImageSize, depthImageSize, m_lowLevelEngine, m_imuCalibrator, settings, dummy);
 
-  m_context->get_relocaliser(m_sceneID).reset(new ICPRefiningRelocaliser<SpaintVoxel,ITMVoxelIndex>(
-    innerRelocaliser, tracker, rgbImageSize, depthImageSize, m_imageSourceEngine->getCalib(),
-    voxelScene, m_denseVoxelMapper, settings, m_context->get_voxel_visualisation_engine()
-  ));
+  Relocaliser_Ptr& relocaliser = m_context->get_relocaliser(m_sceneID);
+  if(m_relocaliserType == "cascade")
+  {
+    // Each stage of the cascade writes its refined poses to the same files, so saving them is not supported.
+    if(settings->get_first_value<bool>("ICPRefiningRelocaliser.saveRelocalisationPoses", false))
+    {
+      throw std::invalid_argument("Error: Cannot save the relocalisation poses when using a relocaliser cascade");
+    }
+
+    // Construct a cascade that first tries ICP from a few recent known-good poses, then falls back to ferns and finally
+    // (if available) to the much more expensive forest relocaliser. Note that all of the stages can share a single ICP
+    // tracker, since the cascade only ever runs one of them at a time.
+    CascadeRelocaliser_Ptr cascade(new CascadeRelocaliser);
+
+    const size_t recentPoseCount = settings->get_first_value<size_t>(settingsNamespace + "cascadeRecentPoseCount", 5);
+    Relocaliser_Ptr recentPoseRelocaliser(new RecentPoseRelocaliser(recentPoseCount));
+    cascade->add_stage("Recent", make_refining_relocaliser(recentPoseRelocaliser, tracker, recentPoseCount));
+
+    const bool persistent = true;
+    cascade->add_stage("Ferns", make_refining_relocaliser(make_inner_relocaliser("ferns"), tracker), persistent);
+
+#ifdef WITH_GROVE
+    if(settings->get_first_value<std::string>(settingsNamespace + "relocalisationForestPath", "") != "")
+    {
+      cascade->add_stage("Forest", make_refining_relocaliser(make_inner_relocaliser("forest"), tracker));
+    }
+#endif
+
+    relocaliser = cascade;
+  }
+  else relocaliser = make_refining_relocaliser(make_inner_relocaliser(m_relocaliserType), tracker);
 }
 
 void SLAMComponent::setup_tracker()
 {
   const Settings_CPtr& settings = m_context->get_settings();
   const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
-  const Vector2i& depthImageSize = slamState->get_depth_image_size();
-  const Vector2i& rgbImageSize = slamState->get_rgb_image_size();
+
+  // Note: If we're tracking at a reduced resolution, the tracker only ever sees the reduced-resolution images.
+  const int levels = m_trackingDownsampleLevels;
+  const Vector2i depthImageSize(slamState->get_depth_image_size().x >> levels, slamState->get_depth_image_size().y >> levels);
+  const Vector2i rgbImageSize(slamState->get_rgb_image_size().x >> levels, slamState->get_rgb_image_size().y >> levels);
 
   m_imuCalibrator.reset(new ITMIMUCalibrator_iPad);
   m_tracker = TrackerFactory::make_tracker_from_string(m_trackerConfig, m_trackingMode == TRACK_SURFELS, rgbImageSize, depthImageSize, m_lowLevelEngine, m_imuCalibrator, settings, m_fallibleTracker);
 }
 
+bool SLAMComponent::should_skip_static_fusion(const ITMView *view, const ITMTrackingState *trackingState)
+{
+  // Always fuse the initial frames, so that the scene has a chance to converge before we start throttling fusion.
+  if(!m_lastFusedPose || m_fusedFramesCount < m_initialFramesToFuse) return false;
+
+  // If the camera has moved appreciably since the most recently fused frame, fuse the current frame. This check is made first,
+  // since it's much cheaper than comparing the depth images.
+  if(!GeometryUtil::poses_are_similar(*m_lastFusedPose, *trackingState->pose_d, m_staticFusionMaxRotation, m_staticFusionMaxTranslation)) return false;
+
+  // If the scene has changed appreciably since the most recently fused frame (e.g. because something has moved in front of the
+  // camera), fuse the current frame.
+  const float changedFraction = m_depthChangeEstimator->estimate_changed_fraction(view->depth, m_lastFusedDepth.get());
+  Profiler::instance().set_gauge("SLAM.StaticDepthChangedFraction", changedFraction);
+  if(changedFraction > m_staticFusionMaxChangedFraction) return false;
+
+  // Otherwise, the camera and the scene are both static, so only fuse the current frame if the static fusion interval has elapsed.
+  ++m_staticFramesSinceFusion;
+  return m_staticFusionInterval == 0 || m_staticFramesSinceFusion < m_staticFusionInterval;
+}
+
+void SLAMComponent::update_occupancy_telemetry()
+{
+  const SpaintVoxelScene::Occupancy occupancy = m_context->get_slam_state(m_sceneID)->get_voxel_scene()->get_occupancy();
+  const float blockFraction = occupancy.block_fraction(), excessFraction = occupancy.excess_fraction();
+
+  Profiler& profiler = Profiler::instance();
+  profiler.set_gauge("SLAM.VoxelBlockOccupancy", 100.0 * blockFraction);
+  profiler.set_gauge("SLAM.HashExcessOccupancy", 100.0 * excessFraction);
+
+  // Warn (once) when either the voxel block array or the excess list is nearly full, since beyond that point new parts of the
+  // scene will silently fail to be allocated (and hence cannot be fused or labelled). The warning is re-armed once neither is.
+  const bool nearlyFull = blockFraction > m_occupancyWarningThreshold || excessFraction > m_occupancyWarningThreshold;
+  if(nearlyFull && !m_occupancyWarningIssued)
+  {
+    std::cerr << "Warning: The storage for scene '" << m_sceneID << "' is nearly exhausted ("
+              << occupancy.allocatedBlockCount << '/' << occupancy.blockCapacity << " voxel blocks, "
+              << occupancy.usedExcessEntryCount << '/' << occupancy.excessEntryCapacity << " excess hash entries in use). "
+              << "Beyond this point, new parts of the scene will not be reconstructed. Consider enabling swapping.\n";
+  }
+  m_occupancyWarningIssued = nearlyFull;
+}
+
+void SLAMComponent::update_tracking_view()
+{
+  const View_Ptr& view = m_context->get_slam_state(m_sceneID)->get_view();
+
+  // If we haven't yet made the reduced-resolution view, do so now (we can't do this any earlier, since the view builder
+  // only makes the full-resolution view when the first frame is processed). The intrinsics are scaled in the same way
+  // as those for the lower levels of InfiniTAM's tracking pyramids.
+  if(!m_trackingView)
+  {
+    const int levels = m_trackingDownsampleLevels;
+    const float scale = 1.0f / (1 << levels);
+    const Vector2i rgbSize(view->rgb->noDims.x >> levels, view->rgb->noDims.y >> levels);
+    const Vector2i depthSize(view->depth->noDims.x >> levels, view->depth->noDims.y >> levels);
+    const bool useGPU = m_context->get_settings()->deviceType == ITMLibSettings::DEVICE_CUDA;
+
+    m_trackingView.reset(new ITMView(view->calib, rgbSize, depthSize, useGPU));
+
+    const Vector4f& d = view->calib.intrinsics_d.projectionParamsSimple.all;
+    const Vector4f& rgb = view->calib.intrinsics_rgb.projectionParamsSimple.all;
+    m_trackingView->calib.intrinsics_d.SetFrom(depthSize.x, depthSize.y, d.x * scale, d.y * scale, d.z * scale, d.w * scale);
+    m_trackingView->calib.intrinsics_rgb.SetFrom(rgbSize.x, rgbSize.y, rgb.x * scale, rgb.y * scale, rgb.z * scale, rgb.w * scale);
+
+    for(int i = 1; i < levels; ++i)
+    {
+      m_trackingDepthPyramid.push_back(ITMFloatImage_Ptr(new ITMFloatImage(Vector2i(view->depth->noDims.x >> i, view->depth->noDims.y >> i), true, useGPU)));
+      m_trackingRGBPyramid.push_back(ITMUChar4Image_Ptr(new ITMUChar4Image(Vector2i(view->rgb->noDims.x >> i, view->rgb->noDims.y >> i), true, useGPU)));
+    }
+  }
+
+  // Repeatedly halve the resolution of the depth and colour images. Invalid depth pixels are ignored when averaging.
+  const ITMFloatImage *depthIn = view->depth;
+  const ITMUChar4Image *rgbIn = view->rgb;
+  for(int i = 0; i < m_trackingDownsampleLevels; ++i)
+  {
+    const bool lastLevel = i == m_trackingDownsampleLevels - 1;
+    ITMFloatImage *depthOut = lastLevel ? m_trackingView->depth : m_trackingDepthPyramid[i].get();
+    ITMUChar4Image *rgbOut = lastLevel ? m_trackingView->rgb : m_trackingRGBPyramid[i].get();
+    m_lowLevelEngine->FilterSubsampleWithHoles(depthOut, depthIn);
+    m_lowLevelEngine->FilterSubsample(rgbOut, rgbIn);
+    depthIn = depthOut;
+    rgbIn = rgbOut;
+  }
+}
+
+void SLAMComponent::wait_for_prefetched_frame()
+{
+  m_prefetchIssued = false;
+
+  boost::unique_lock<boost::mutex> lock(m_prefetchMutex);
+  while(m_prefetchRequested) m_prefetchFinished.wait(lock);
+
+  if(m_prefetchError != "")
+  {
+    std::string error;
+    error.swap(m_prefetchError);
+    throw std::runtime_error(error);
+  }
+}
+
 }
@@ -12,12 +12,12 @@ namespace spaint {
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
-itmx::RefiningRelocaliser_Ptr& SLAMContext::get_relocaliser(const std::string& sceneID)
+itmx::Relocaliser_Ptr& SLAMContext::get_relocaliser(const std::string& sceneID)
 {
   return m_relocalisers[sceneID];
 }
 
-itmx::RefiningRelocaliser_CPtr SLAMContext::get_relocaliser(const std::string& sceneID) const
+itmx::Relocaliser_CPtr SLAMContext::get_relocaliser(const std::string& sceneID) const
 {
   return MapUtil::lookup(m_relocalisers, sceneID);
 }
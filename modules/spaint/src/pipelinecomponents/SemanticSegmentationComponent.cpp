@@ -5,20 +5,36 @@
 
 #include "pipelinecomponents/SemanticSegmentationComponent.h"
 
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/chrono/chrono.hpp>
+
 #include <itmx/base/MemoryBlockFactory.h>
 using itmx::MemoryBlockFactory;
 
-#include <rafl/examples/Example.h>
+#include <rafl/examples/ExampleMatrix.h>
 using namespace rafl;
 
+#include <tvgutil/numbers/SeedUtil.h>
+#include <tvgutil/timing/ProfilingScope.h>
+using tvgutil::Profiler;
+using tvgutil::ProfilingScope;
+using tvgutil::RandomNumberGenerator;
+using tvgutil::SeedUtil;
+using tvgutil::WorkBudgetController;
+
 #include "features/FeatureCalculatorFactory.h"
+#include "randomforest/DeviceRandomForestFactory.h"
+#include "randomforest/ForestPredictorFactory.h"
 #include "randomforest/ForestUtil.h"
 #include "randomforest/SpaintDecisionFunctionGenerator.h"
+#include "randomforest/TrainingReplayBufferFactory.h"
+#include "sampling/VoxelLocationSorterFactory.h"
 #include "sampling/VoxelSamplerFactory.h"
-
-#ifdef WITH_OPENCV
-#include "ocv/OpenCVUtil.h"
-#endif
+#include "segmentation/SupervoxelSegmenterFactory.h"
+#include "visualisation/VisualiserFactory.h"
 
 #define DEBUGGING 1
 
@@ -27,15 +43,24 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 SemanticSegmentationComponent::SemanticSegmentationComponent(const SemanticSegmentationContext_Ptr& context, const std::string& sceneID, unsigned int seed)
-: m_context(context), m_sceneID(sceneID)
+: m_context(context), m_sceneID(sceneID), m_trainerShouldTerminate(false)
 {
+  const Settings_CPtr& settings = context->get_settings();
+
+  // In deterministic mode, give each of the samplers (and the forest) its own seed, derived from the root seed.
+  m_deterministic = SeedUtil::is_deterministic(*settings);
+  const unsigned int predictionSeed = SeedUtil::get_deterministic_seed(*settings, "SemanticSegmentationComponent.predictionSampler").get_value_or(seed);
+  const unsigned int trainingSeed = SeedUtil::get_deterministic_seed(*settings, "SemanticSegmentationComponent.trainingSampler").get_value_or(seed);
+  m_forestSeed = SeedUtil::get_deterministic_seed(*settings, "SemanticSegmentationComponent.forest");
+
   // Set the maximum numbers of voxels to use for training and prediction.
-  // FIXME: These values shouldn't be hard-coded here ultimately.
+  // FIXME: The training value shouldn't be hard-coded here ultimately.
 #ifndef USE_LOW_POWER_MODE
-  m_maxPredictionVoxelCount = 8192;
+  const size_t defaultMaxPredictionVoxelCount = 8192;
 #else
-  m_maxPredictionVoxelCount = 512;
+  const size_t defaultMaxPredictionVoxelCount = 512;
 #endif
+  m_maxPredictionVoxelCount = settings->get_first_value<size_t>("SemanticSegmentationComponent.maxPredictionVoxelCount", defaultMaxPredictionVoxelCount);
   m_maxTrainingVoxelsPerLabel = 128;
   const size_t maxLabelCount = context->get_label_manager()->get_max_label_count();
   const size_t maxTrainingVoxelCount = maxLabelCount * m_maxTrainingVoxelsPerLabel;
@@ -43,9 +68,100 @@ SemanticSegmentationComponent::SemanticSegmentationComponent(const SemanticSegme
   // Set up the voxel samplers.
   const Vector2i& depthImageSize = context->get_slam_state(sceneID)->get_depth_image_size();
   const int raycastResultSize = depthImageSize.width * depthImageSize.height;
-  const Settings_CPtr& settings = context->get_settings();
-  m_predictionSampler = VoxelSamplerFactory::make_uniform_sampler(raycastResultSize, seed, settings->deviceType);
-  m_trainingSampler = VoxelSamplerFactory::make_per_label_sampler(maxLabelCount, m_maxTrainingVoxelsPerLabel, raycastResultSize, seed, settings->deviceType);
+  if(settings->get_first_value<bool>("SemanticSegmentationComponent.stratifyPredictionSamples", false))
+  {
+    // Stratifying the samples spreads them out across the image and favours the voxels that still need predictions,
+    // which is intended to allow a smaller prediction budget (see maxPredictionVoxelCount) to be used.
+    const int tileSize = settings->get_first_value<int>("SemanticSegmentationComponent.predictionTileSize", 32);
+    const int candidatesPerSample = settings->get_first_value<int>("SemanticSegmentationComponent.predictionCandidatesPerSample", 4);
+    m_stratifiedPredictionSampler = VoxelSamplerFactory::make_stratified_sampler(
+      depthImageSize, m_maxPredictionVoxelCount, tileSize, candidatesPerSample, predictionSeed, settings->deviceType
+    );
+  }
+  else m_predictionSampler = VoxelSamplerFactory::make_uniform_sampler(raycastResultSize, predictionSeed, settings->deviceType);
+
+  // Optionally over-segment the visible surface into supervoxels each frame, and predict labels only for their seeds, which
+  // then replace the sampled voxels. The number of seeds is thus fixed by their spacing, and must not exceed the maximum
+  // number of voxels for which labels can be predicted.
+  if(settings->get_first_value<bool>("SemanticSegmentationComponent.useSupervoxels", false))
+  {
+    const int seedSpacing = settings->get_first_value<int>("SemanticSegmentationComponent.supervoxelSeedSpacing", 16);
+    const int memberStride = settings->get_first_value<int>("SemanticSegmentationComponent.supervoxelMemberStride", 4);
+    const float maxRadius = settings->get_first_value<float>("SemanticSegmentationComponent.supervoxelMaxRadius", 16.0f);                 // in voxels
+    const float maxNormalAngle = settings->get_first_value<float>("SemanticSegmentationComponent.supervoxelMaxNormalAngle", 0.5f);        // in radians
+    const float maxColourDistance = settings->get_first_value<float>("SemanticSegmentationComponent.supervoxelMaxColourDistance", 40.0f); // in RGB units
+    m_supervoxelSegmenter = SupervoxelSegmenterFactory::make_supervoxel_segmenter(
+      depthImageSize, seedSpacing, memberStride, maxRadius, maxNormalAngle, maxColourDistance, settings->deviceType
+    );
+
+    if(m_supervoxelSegmenter->get_seed_count() > m_maxPredictionVoxelCount)
+    {
+      throw std::invalid_argument("Error: The supervoxel seed spacing is too small for the maximum prediction voxel count");
+    }
+  }
+
+  // Background prediction is disabled by default, since it competes with the rest of the pipeline for the device.
+  // If enabled, only a subset of the voxels in each block is considered per sweep, to spread the work out evenly.
+  m_backgroundPredictionTimeSlice = settings->get_first_value<double>("SemanticSegmentationComponent.backgroundPredictionTimeSlice", 0.0);
+  if(m_backgroundPredictionTimeSlice > 0.0)
+  {
+    const int voxelsPerBlock = settings->get_first_value<int>("SemanticSegmentationComponent.backgroundPredictionVoxelsPerBlock", 64);
+    const float maxSDF = 0.5f * settings->sceneParams.voxelSize / settings->sceneParams.mu; // half a voxel from the surface
+    m_backgroundPredictionSampler = VoxelSamplerFactory::make_sweeping_sampler(m_maxPredictionVoxelCount, voxelsPerBlock, maxSDF, settings->deviceType);
+  }
+
+  // Optionally adapt the amount of work done each frame so as to hold the measured cost of each part of it near a target time (in ms).
+  // A target of zero (the default) keeps the corresponding budget fixed. Note that the prediction budget can never exceed the
+  // maximum prediction voxel count, since this determines the sizes of the memory blocks allocated below.
+  // In deterministic mode, the budgets are always kept fixed, since adapting them would make the work done depend on timings.
+  const double predictionTimeTarget = settings->get_first_value<double>("SemanticSegmentationComponent.predictionTimeTarget", 0.0);
+  const double trainingTimeTarget = settings->get_first_value<double>("SemanticSegmentationComponent.trainingTimeTarget", 0.0);
+  const double trainerTimeTarget = settings->get_first_value<double>("SemanticSegmentationComponent.trainerTimeTarget", 0.0);
+  if(m_deterministic && (predictionTimeTarget > 0.0 || trainingTimeTarget > 0.0 || trainerTimeTarget > 0.0))
+  {
+    std::cerr << "Warning: Ignoring the semantic segmentation time targets, since adaptive budgets are not supported in deterministic mode\n";
+  }
+  else if(predictionTimeTarget > 0.0 && m_supervoxelSegmenter)
+  {
+    std::cerr << "Warning: Ignoring the prediction time target, since the number of predictions is fixed by the supervoxel seed spacing\n";
+  }
+  else if(predictionTimeTarget > 0.0)
+  {
+    const double maxBudget = static_cast<double>(m_maxPredictionVoxelCount);
+    m_predictionBudget = WorkBudgetController(predictionTimeTarget, std::min(256.0, maxBudget), maxBudget, maxBudget);
+  }
+
+  if(!m_deterministic)
+  {
+    if(trainingTimeTarget > 0.0) m_trainingRate = WorkBudgetController(trainingTimeTarget, 0.1, 1.0, 1.0);
+    if(trainerTimeTarget > 0.0) m_splitBudget = WorkBudgetController(trainerTimeTarget, 1.0, 100.0, 20.0);
+  }
+
+  // Optionally keep a replay buffer of training examples for each label on the device, and draw each frame's training examples from that.
+  // Only a few voxels per label then need to be sampled and featurised each frame (together with any buffered voxels whose blocks have
+  // been fused since they were featurised), and labels that are out of view continue to contribute examples.
+  const size_t replayBufferCapacity = settings->get_first_value<size_t>("SemanticSegmentationComponent.replayBufferCapacityPerLabel", 0);
+  if(replayBufferCapacity > 0)
+  {
+    m_trainingSamplesPerLabel = std::min(settings->get_first_value<size_t>("SemanticSegmentationComponent.replayBufferSamplesPerLabel", 16), replayBufferCapacity);
+  }
+  else m_trainingSamplesPerLabel = m_maxTrainingVoxelsPerLabel;
+
+  // Optionally sample the voxels for prediction and training from the visible blocks instead of the raycast result. If so, these
+  // samplers replace the raycast-based ones (except that supervoxel prediction, which is inherently raycast-based, still takes precedence).
+  if(settings->get_first_value<bool>("SemanticSegmentationComponent.sampleFromVisibleBlocks", false))
+  {
+    const size_t candidatesPerLabel = settings->get_first_value<size_t>("SemanticSegmentationComponent.visibleBlockCandidatesPerLabel", 16384);
+    const int voxelsPerBlock = settings->get_first_value<int>("SemanticSegmentationComponent.visibleBlockVoxelsPerBlock", 64);
+    const float maxSDF = 0.5f * settings->sceneParams.voxelSize / settings->sceneParams.mu; // half a voxel from the surface
+    m_visibleBlockPredictionSampler = VoxelSamplerFactory::make_visible_block_sampler(
+      1, m_maxPredictionVoxelCount, std::max(candidatesPerLabel, m_maxPredictionVoxelCount), voxelsPerBlock, maxSDF, predictionSeed, settings->deviceType
+    );
+    m_visibleBlockTrainingSampler = VoxelSamplerFactory::make_visible_block_sampler(
+      maxLabelCount, m_trainingSamplesPerLabel, candidatesPerLabel, voxelsPerBlock, maxSDF, trainingSeed, settings->deviceType
+    );
+  }
+  else m_trainingSampler = VoxelSamplerFactory::make_per_label_sampler(maxLabelCount, m_trainingSamplesPerLabel, raycastResultSize, trainingSeed, settings->deviceType);
 
   // Set up the feature calculator.
   // FIXME: These values shouldn't be hard-coded here ultimately.
@@ -53,21 +169,52 @@ SemanticSegmentationComponent::SemanticSegmentationComponent(const SemanticSegme
   const float patchSpacing = 0.01f / settings->sceneParams.voxelSize; // 10mm = 0.01m (dividing by the voxel size, which is in m, expresses the spacing in voxels)
   const size_t binCount = 36;                                         // 10 degrees per bin
 
+  // Note: Caching the features is only safe if handle_fusion is called after every fusion step (and handle_defragmentation after every defragmentation pass).
+  const size_t featureCacheSize = settings->get_first_value<size_t>("SemanticSegmentationComponent.featureCacheSize", 0);
+  const bool useFusedFeatureKernel = settings->get_first_value<bool>("SemanticSegmentationComponent.useFusedFeatureKernel", false);
+  const bool useFeatureCUDAGraph = settings->get_first_value<bool>("SemanticSegmentationComponent.useFeatureCUDAGraph", false);
+
   m_featureCalculator = FeatureCalculatorFactory::make_vop_feature_calculator(
     std::max(m_maxPredictionVoxelCount, maxTrainingVoxelCount),
-    m_patchSize, patchSpacing, binCount, settings->deviceType
+    m_patchSize, patchSpacing, binCount, settings->deviceType, featureCacheSize, useFusedFeatureKernel, useFeatureCUDAGraph
   );
 
   // Set up the memory blocks needed for prediction and training.
   MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
   const size_t featureCount = m_featureCalculator->get_feature_count();
-  m_predictionFeaturesMB = mbf.make_block<float>(m_maxPredictionVoxelCount * featureCount);
-  m_predictionLabelsMB = mbf.make_block<SpaintVoxel::PackedLabel>(m_maxPredictionVoxelCount);
-  m_predictionVoxelLocationsMB = mbf.make_block<Vector3s>(m_maxPredictionVoxelCount);
-  m_trainingFeaturesMB = mbf.make_block<float>(maxTrainingVoxelCount * featureCount);
-  m_trainingLabelMaskMB = mbf.make_block<bool>(maxLabelCount);
-  m_trainingVoxelCountsMB = mbf.make_block<unsigned int>(maxLabelCount);
-  m_trainingVoxelLocationsMB = mbf.make_block<Vector3s>(maxTrainingVoxelCount);
+  if(m_backgroundPredictionSampler) m_backgroundPredictionVoxelLocationsMB = mbf.make_block<Vector3s>(m_maxPredictionVoxelCount, "SemanticSegmentationComponent");
+  m_predictionFeaturesMB = mbf.make_block<float>(m_maxPredictionVoxelCount * featureCount, "SemanticSegmentationComponent");
+  m_predictionLabelsMB = mbf.make_block<SpaintVoxel::PackedLabel>(m_maxPredictionVoxelCount, "SemanticSegmentationComponent");
+  m_predictionVoxelLocationsMB = mbf.make_block<Vector3s>(m_maxPredictionVoxelCount, "SemanticSegmentationComponent");
+  if(m_supervoxelSegmenter)
+  {
+    const size_t memberCount = m_supervoxelSegmenter->get_member_count();
+    m_supervoxelMemberLabelsMB = mbf.make_block<SpaintVoxel::PackedLabel>(memberCount, "SemanticSegmentationComponent");
+    m_supervoxelMemberLocationsMB = mbf.make_block<Vector3s>(memberCount, "SemanticSegmentationComponent");
+  }
+  m_trainingFeaturesMB = mbf.make_block<float>(maxTrainingVoxelCount * featureCount, "SemanticSegmentationComponent");
+  m_trainingLabelMaskMB = mbf.make_block<bool>(maxLabelCount, "SemanticSegmentationComponent");
+  m_trainingVoxelCountsMB = mbf.make_block<unsigned int>(maxLabelCount, "SemanticSegmentationComponent");
+  m_trainingVoxelLocationsMB = mbf.make_block<Vector3s>(maxLabelCount * m_trainingSamplesPerLabel, "SemanticSegmentationComponent");
+
+  if(replayBufferCapacity > 0)
+  {
+    const size_t maxRefreshCount = settings->get_first_value<size_t>("SemanticSegmentationComponent.replayBufferRefreshBudget", 256);
+    m_replayBuffer = TrainingReplayBufferFactory::make_training_replay_buffer(
+      maxLabelCount, replayBufferCapacity, featureCount, std::min(maxRefreshCount, maxTrainingVoxelCount), trainingSeed, settings->deviceType
+    );
+    m_sampledTrainingFeaturesMB = mbf.make_block<float>(maxLabelCount * m_trainingSamplesPerLabel * featureCount, "SemanticSegmentationComponent");
+  }
+
+  // If requested, sort each batch of sampled voxel locations into Morton order before calculating their features, so that
+  // neighbouring threads in the feature calculation (and marking) kernels access nearby voxel blocks. The prediction and
+  // training batches are sorted one at a time on the render thread, so a single sorter can be shared between them.
+  if(settings->get_first_value<bool>("SemanticSegmentationComponent.sortVoxelLocations", false))
+  {
+    m_voxelLocationSorter = VoxelLocationSorterFactory::make_voxel_location_sorter(
+      std::max(m_maxPredictionVoxelCount, maxLabelCount * m_trainingSamplesPerLabel), settings->deviceType
+    );
+  }
 
   // Register the relevant decision function generators with the factory.
   DecisionFunctionGeneratorFactory<SpaintVoxel::Label>::instance().register_maker(
@@ -75,17 +222,109 @@ SemanticSegmentationComponent::SemanticSegmentationComponent(const SemanticSegme
     &SpaintDecisionFunctionGenerator::maker
   );
 
-  // Set up the random forest.
-  reset_forest();
+  // Set up the random forest and the predictor used to predict labels from it.
+  const size_t treeCount = 5;
+  m_forest.reset(new RandomForest<SpaintVoxel::Label>(treeCount, make_forest_settings()));
+  m_forestPredictor = ForestPredictorFactory::make_forest_predictor(settings->deviceType);
+
+  // Optionally use a forest that is trained and evaluated entirely on the device instead. Its structural settings are taken from the
+  // same settings file as those of the rafl forest, but its memory limits must be specified separately, since it cannot grow.
+  if(settings->get_first_value<bool>("SemanticSegmentationComponent.useDeviceForest", false))
+  {
+    if(m_deterministic)
+    {
+      std::cerr << "Warning: Ignoring useDeviceForest, since training the device forest is not deterministic\n";
+    }
+    else
+    {
+      const DecisionTreeSettings dtSettings = make_forest_settings();
+      DeviceRandomForest::Settings dfSettings;
+      dfSettings.candidateCount = dtSettings.candidateCount;
+      dfSettings.gainThreshold = dtSettings.gainThreshold;
+      dfSettings.maxNodesPerTree = settings->get_first_value<int>("SemanticSegmentationComponent.deviceForestMaxNodesPerTree", 4096);
+      dfSettings.maxTreeHeight = static_cast<int>(dtSettings.maxTreeHeight);
+      dfSettings.poolSize = settings->get_first_value<int>("SemanticSegmentationComponent.deviceForestPoolSize", 16384);
+      dfSettings.reservoirSize = settings->get_first_value<int>("SemanticSegmentationComponent.deviceForestReservoirSize", 256);
+      dfSettings.seed = seed;
+      dfSettings.seenExamplesThreshold = static_cast<unsigned int>(dtSettings.seenExamplesThreshold);
+      dfSettings.splittabilityThreshold = dtSettings.splittabilityThreshold;
+      dfSettings.usePMFReweighting = dtSettings.usePMFReweighting;
+
+      if(static_cast<size_t>(dfSettings.poolSize) < maxTrainingVoxelCount)
+      {
+        throw std::invalid_argument("Error: The device forest pool size must be at least the maximum number of training voxels per frame");
+      }
+
+      m_deviceForest = DeviceRandomForestFactory::make_device_random_forest(treeCount, maxLabelCount, featureCount, dfSettings, settings->deviceType);
+    }
+  }
+
+  // Start the trainer (unless we're in deterministic mode or using the device forest, in which case the forest is trained synchronously).
+  if(!m_deterministic && !m_deviceForest) m_trainer = boost::thread(boost::bind(&SemanticSegmentationComponent::run_trainer, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+SemanticSegmentationComponent::~SemanticSegmentationComponent()
+{
+  // Set the flag that informs the trainer that it should terminate.
+  m_trainerShouldTerminate = true;
+
+  // Wake the trainer (it might be waiting for work).
+  {
+    boost::lock_guard<boost::mutex> lock(m_trainerMutex);
+  }
+  m_trainerHasWork.notify_one();
+
+  // Wait for the trainer to terminate gracefully.
+  if(m_trainer.joinable()) m_trainer.join();
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+void SemanticSegmentationComponent::handle_defragmentation()
+{
+  m_featureCalculator->invalidate_cached_features();
+}
+
+void SemanticSegmentationComponent::handle_fusion()
+{
+  const SLAMState_Ptr& slamState = m_context->get_slam_state(m_sceneID);
+  m_featureCalculator->invalidate_fused_blocks(slamState->get_live_voxel_render_state().get(), slamState->get_voxel_scene().get());
+}
+
 void SemanticSegmentationComponent::reset_forest()
 {
-  const size_t treeCount = 5;
-  DecisionTree<SpaintVoxel::Label>::Settings dtSettings(m_context->get_resources_dir() + "/RaflSettings.xml");
-  m_forest.reset(new RandomForest<SpaintVoxel::Label>(treeCount, dtSettings));
+  // If the device forest is in use, it is trained on the render thread, so we can just reset it directly.
+  if(m_deviceForest)
+  {
+    m_deviceForest->reset();
+    return;
+  }
+
+  DecisionTreeSettings dtSettings = make_forest_settings();
+
+  // In deterministic mode, there is no trainer, so we can just replace the forest and withdraw the current snapshot directly.
+  if(m_deterministic)
+  {
+    m_forest.reset(new RandomForest<SpaintVoxel::Label>(m_forest->get_tree_count(), dtSettings));
+    boost::atomic_store(&m_forestSnapshot, CompiledRandomForest_CPtr());
+    return;
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(m_trainerMutex);
+
+    // Ask the trainer to replace its forest, and discard any examples that were meant for the old one.
+    m_forestResetSettings = dtSettings;
+    m_pendingExamples.clear();
+
+    // Withdraw the current snapshot so that no further predictions are made using the old forest. Note that we do this whilst
+    // holding the mutex, since the trainer only publishes snapshots whilst holding it, and checks for a pending reset first.
+    boost::atomic_store(&m_forestSnapshot, CompiledRandomForest_CPtr());
+  }
+
+  m_trainerHasWork.notify_one();
 }
 
 void SemanticSegmentationComponent::run_feature_inspection(const VoxelRenderState_CPtr& renderState)
@@ -93,27 +332,31 @@ void SemanticSegmentationComponent::run_feature_inspection(const VoxelRenderStat
   // Get the voxels (if any) selected by the user (prior to selection transformation).
   Selector::Selection_CPtr selection = m_context->get_selector()->get_selection();
 
-  // If the user hasn't selected a single voxel, early out.
-  if(!selection || selection->dataSize != 1) return;
-
-  // Calculate the feature descriptor for the selected voxel.
-  boost::shared_ptr<ORUtils::MemoryBlock<float> > featuresMB = MemoryBlockFactory::instance().make_block<float>(m_featureCalculator->get_feature_count());
-  m_featureCalculator->calculate_features(*selection, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *featuresMB);
-
-#ifdef WITH_OPENCV
-  // Convert the feature descriptor into an OpenCV image and show it in a window.
-  featuresMB->UpdateHostFromDevice();
-  const float *features = featuresMB->GetData(MEMORYDEVICE_CPU);
-  const int patchSize = static_cast<int>(m_patchSize);
-  cv::Mat3b featureInspectionImage = OpenCVUtil::make_rgb_image(features, patchSize, patchSize);
+  // If the user hasn't selected a single voxel, clear the feature inspection image and early out.
+  if(!selection || selection->dataSize != 1)
+  {
+    m_context->set_feature_inspection_image(m_sceneID, ITMUChar4Image_CPtr());
+    return;
+  }
 
-  const float scaleFactor = 10.0f;
-  cv::resize(featureInspectionImage, featureInspectionImage, cv::Size(), scaleFactor, scaleFactor, CV_INTER_NN);
+  // If this is the first time we've inspected the features of a voxel, allocate the memory block and image we need. These
+  // are then reused on subsequent frames, so that inspecting the features does not allocate any memory from frame to frame.
+  if(!m_featureInspectionImage)
+  {
+    MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+    const int patchSize = static_cast<int>(m_patchSize);
+    m_featureInspectionFeaturesMB = mbf.make_block<float>(m_featureCalculator->get_feature_count(), "SemanticSegmentationComponent");
+    m_featureInspectionImage = mbf.make_image<Vector4u>(Vector2i(patchSize, patchSize), "SemanticSegmentationComponent");
+    m_featureInspectionVisualiser = VisualiserFactory::make_feature_inspection_visualiser(m_context->get_settings()->deviceType);
+  }
 
-  cv::imshow("Feature Inspection", featureInspectionImage);
-  const int delayMs = 1;
-  cv::waitKey(delayMs);  // this is required in order to make OpenCV actually show the window
-#endif
+  // Calculate the feature descriptor for the selected voxel, render its VOP patch into the feature inspection image and publish
+  // the image so that it can be shown as an overlay. The first two steps both happen on the device on which the component operates,
+  // so the descriptor never needs to be copied back to the host. Note that the patch has been converted to CIELab at this point,
+  // so the colours shown are its Lab values.
+  m_featureCalculator->calculate_features(*selection, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *m_featureInspectionFeaturesMB);
+  m_featureInspectionVisualiser->render_patch(*m_featureInspectionFeaturesMB, m_featureInspectionImage);
+  m_context->set_feature_inspection_image(m_sceneID, m_featureInspectionImage);
 }
 
 void SemanticSegmentationComponent::run_prediction(const VoxelRenderState_CPtr& renderState)
@@ -121,31 +364,81 @@ void SemanticSegmentationComponent::run_prediction(const VoxelRenderState_CPtr&
   // If we haven't been provided with a camera position from which to sample, early out.
   if(!renderState) return;
 
-  // If the random forest is not yet valid, early out.
-  if(!m_forest->is_valid()) return;
+  // If the trainer has not yet published a snapshot of a valid forest (or the device forest has not yet been given any examples), early out.
+  CompiledRandomForest_CPtr forestSnapshot = boost::atomic_load(&m_forestSnapshot);
+  if(m_deviceForest ? !m_deviceForest->has_examples() : !forestSnapshot) return;
+
+  typedef boost::chrono::steady_clock Clock;
+  const Clock::time_point startTime = Clock::now();
+
+  // Sample some voxels for which to predict labels (as many as the current budget allows, if adaptive prediction is enabled).
+  // If supervoxel prediction is enabled, the seeds of the supervoxels are used instead.
+  const SpaintVoxelScene *scene = m_context->get_slam_state(m_sceneID)->get_voxel_scene().get();
+  size_t voxelCount;
+  if(m_supervoxelSegmenter)
+  {
+    voxelCount = m_supervoxelSegmenter->get_seed_count();
+    m_supervoxelSegmenter->segment(renderState->raycastResult, scene, *m_predictionVoxelLocationsMB);
+  }
+  else
+  {
+    voxelCount = m_predictionBudget ? static_cast<size_t>(m_predictionBudget->get_budget()) : m_maxPredictionVoxelCount;
+    if(m_visibleBlockPredictionSampler)
+    {
+      // Note: This can sample fewer voxels than requested (e.g. if few blocks are visible), in which case we predict labels for fewer voxels.
+      voxelCount = m_visibleBlockPredictionSampler->sample_voxels(renderState.get(), scene, voxelCount, *m_predictionVoxelLocationsMB);
+    }
+    else if(m_stratifiedPredictionSampler)
+    {
+      m_stratifiedPredictionSampler->sample_voxels(renderState->raycastResult, scene, voxelCount, *m_predictionVoxelLocationsMB);
+    }
+    else m_predictionSampler->sample_voxels(renderState->raycastResult, voxelCount, *m_predictionVoxelLocationsMB);
+    m_predictionVoxelLocationsMB->dataSize = voxelCount;
+
+    // Note: The features, labels and marking all follow the order of the locations, so once they are sorted, nothing needs to be
+    //       scattered back. We don't sort the supervoxel seeds, since the labels predicted for them are broadcast by seed index.
+    if(m_voxelLocationSorter) m_voxelLocationSorter->sort_voxel_locations(*m_predictionVoxelLocationsMB, voxelCount);
+  }
 
-  // Sample some voxels for which to predict labels.
-  m_predictionSampler->sample_voxels(renderState->raycastResult, m_maxPredictionVoxelCount, *m_predictionVoxelLocationsMB);
+  // If no voxels could be sampled (which can happen when sampling from the visible blocks), there is nothing to predict,
+  // but background prediction can still make use of the time slice.
+  if(voxelCount == 0)
+  {
+    if(m_backgroundPredictionSampler) run_background_prediction(scene);
+    return;
+  }
 
   // Calculate feature descriptors for the sampled voxels.
-  m_featureCalculator->calculate_features(*m_predictionVoxelLocationsMB, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *m_predictionFeaturesMB);
-  std::vector<Descriptor_CPtr> descriptors = ForestUtil::make_descriptors(*m_predictionFeaturesMB, m_maxPredictionVoxelCount, m_featureCalculator->get_feature_count());
+  m_featureCalculator->calculate_features(*m_predictionVoxelLocationsMB, scene, *m_predictionFeaturesMB);
+
+  // If the trainer has published a new snapshot of the forest since we last uploaded one to the predictor, upload it.
+  if(forestSnapshot && forestSnapshot != m_uploadedForestSnapshot)
+  {
+    m_forestPredictor->update_forest(*forestSnapshot);
+    m_uploadedForestSnapshot = forestSnapshot;
+  }
 
   // Predict labels for the voxels based on the feature descriptors.
-  SpaintVoxel::PackedLabel *labels = m_predictionLabelsMB->GetData(MEMORYDEVICE_CPU);
+  predict_labels(voxelCount);
 
-#ifdef WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for(int i = 0; i < static_cast<int>(m_maxPredictionVoxelCount); ++i)
+  // Mark the voxels with their predicted labels. If supervoxel prediction is enabled, broadcast the labels predicted for
+  // the seeds to the members of their supervoxels first, and mark the members' voxels instead.
+  if(m_supervoxelSegmenter)
   {
-    labels[i] = SpaintVoxel::PackedLabel(m_forest->predict(descriptors[i]), SpaintVoxel::LG_FOREST);
+    m_supervoxelSegmenter->broadcast_labels(renderState->raycastResult, scene, *m_predictionLabelsMB, *m_supervoxelMemberLocationsMB, *m_supervoxelMemberLabelsMB);
+    m_context->mark_voxels(m_sceneID, m_supervoxelMemberLocationsMB, m_supervoxelMemberLabelsMB, NORMAL_MARKING);
   }
+  else m_context->mark_voxels(m_sceneID, m_predictionVoxelLocationsMB, m_predictionLabelsMB, NORMAL_MARKING);
 
-  m_predictionLabelsMB->UpdateDeviceFromHost();
+  // If adaptive prediction is enabled, update the budget based on how long the prediction took.
+  if(m_predictionBudget)
+  {
+    m_predictionBudget->update(static_cast<double>(voxelCount), boost::chrono::duration<double,boost::milli>(Clock::now() - startTime).count());
+    Profiler::instance().set_gauge("SemanticSegmentation.PredictionVoxelBudget", m_predictionBudget->get_budget());
+  }
 
-  // Mark the voxels with their predicted labels.
-  m_context->mark_voxels(m_sceneID, m_predictionVoxelLocationsMB, m_predictionLabelsMB, NORMAL_MARKING);
+  // If background prediction is enabled, use the rest of the time slice to predict labels for voxels elsewhere in the scene.
+  if(m_backgroundPredictionSampler) run_background_prediction(scene);
 }
 
 void SemanticSegmentationComponent::run_training(const VoxelRenderState_CPtr& renderState)
@@ -153,6 +446,12 @@ void SemanticSegmentationComponent::run_training(const VoxelRenderState_CPtr& re
   // If we haven't been provided with a camera position from which to sample, early out.
   if(!renderState) return;
 
+  // If adaptive training is enabled and training is not due on this frame, early out.
+  if(m_trainingRate && !m_trainingRate->accrue()) return;
+
+  typedef boost::chrono::steady_clock Clock;
+  const Clock::time_point startTime = Clock::now();
+
   // Calculate a mask indicating the labels that are currently in use and from which we want to train.
   // Note that we deliberately avoid training from the background label (0), since the entire scene is
   // initially labelled as background and so training from the background would cause us to learn
@@ -168,8 +467,24 @@ void SemanticSegmentationComponent::run_training(const VoxelRenderState_CPtr& re
   m_trainingLabelMaskMB->UpdateDeviceFromHost();
 
   // Sample voxels from the scene to use for training the random forest.
-  const ORUtils::Image<Vector4f> *raycastResult = renderState->raycastResult;
-  m_trainingSampler->sample_voxels(raycastResult, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *m_trainingLabelMaskMB, *m_trainingVoxelLocationsMB, *m_trainingVoxelCountsMB);
+  if(m_visibleBlockTrainingSampler)
+  {
+    m_visibleBlockTrainingSampler->sample_voxels(
+      renderState.get(), m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *m_trainingLabelMaskMB, *m_trainingVoxelLocationsMB, *m_trainingVoxelCountsMB
+    );
+  }
+  else
+  {
+    const ORUtils::Image<Vector4f> *raycastResult = renderState->raycastResult;
+    m_trainingSampler->sample_voxels(raycastResult, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *m_trainingLabelMaskMB, *m_trainingVoxelLocationsMB, *m_trainingVoxelCountsMB);
+  }
+
+  // If requested, sort the sampled voxel locations for each label into Morton order. Each label's locations are sorted separately,
+  // so the per-label layout of the samples (on which the example construction and the replay buffer rely) is preserved.
+  if(m_voxelLocationSorter)
+  {
+    m_voxelLocationSorter->sort_voxel_locations(*m_trainingVoxelLocationsMB, maxLabelCount, m_trainingSamplesPerLabel, *m_trainingVoxelCountsMB);
+  }
 
 #if DEBUGGING
   // Output the numbers of voxels sampled for each label (for debugging purposes).
@@ -183,23 +498,200 @@ void SemanticSegmentationComponent::run_training(const VoxelRenderState_CPtr& re
   m_trainingVoxelLocationsMB->UpdateHostFromDevice();
 #endif
 
-  // Compute feature vectors for the sampled voxels.
-  m_featureCalculator->calculate_features(*m_trainingVoxelLocationsMB, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *m_trainingFeaturesMB);
-
-  // Make the training examples.
-  typedef boost::shared_ptr<const Example<SpaintVoxel::Label> > Example_CPtr;
-  std::vector<Example_CPtr> examples = ForestUtil::make_examples<SpaintVoxel::Label>(
-    *m_trainingFeaturesMB,
-    *m_trainingVoxelCountsMB,
-    m_featureCalculator->get_feature_count(),
-    m_maxTrainingVoxelsPerLabel,
-    maxLabelCount
-  );
+  // Compute feature vectors for the sampled voxels. If the replay buffer is in use, we then add them to the buffer (after first bringing
+  // the examples already in it up to date), and draw the training examples from the buffer instead.
+  const SpaintVoxelScene *scene = m_context->get_slam_state(m_sceneID)->get_voxel_scene().get();
+  if(m_replayBuffer)
+  {
+    m_featureCalculator->calculate_features(*m_trainingVoxelLocationsMB, scene, *m_sampledTrainingFeaturesMB);
+    m_replayBuffer->refresh(scene, *m_featureCalculator);
+    m_replayBuffer->insert(*m_trainingVoxelLocationsMB, *m_sampledTrainingFeaturesMB, *m_trainingVoxelCountsMB, m_trainingSamplesPerLabel, scene);
+    m_replayBuffer->draw(*m_trainingLabelMaskMB, m_maxTrainingVoxelsPerLabel, *m_trainingFeaturesMB, *m_trainingVoxelCountsMB);
+  }
+  else m_featureCalculator->calculate_features(*m_trainingVoxelLocationsMB, scene, *m_trainingFeaturesMB);
+
+  // If the device forest is in use, train it directly from the feature vectors, without copying them back to the host.
+  if(m_deviceForest)
+  {
+    train_device_forest();
+  }
+  else
+  {
+    // Otherwise, make the training examples.
+    ExampleMatrix examples = ForestUtil::make_examples<SpaintVoxel::Label>(
+      *m_trainingFeaturesMB,
+      *m_trainingVoxelCountsMB,
+      m_featureCalculator->get_feature_count(),
+      m_maxTrainingVoxelsPerLabel,
+      maxLabelCount
+    );
+
+    // In deterministic mode, add the training examples to the forest and train it for a single step synchronously.
+    if(m_deterministic)
+    {
+      bool forestMightBeSplittable;
+      CompiledRandomForest_CPtr forestSnapshot = train_forest(std::vector<ExampleMatrix>(1, examples), boost::none, forestMightBeSplittable);
+      if(forestSnapshot) boost::atomic_store(&m_forestSnapshot, forestSnapshot);
+      return;
+    }
+
+    // Otherwise, hand the training examples over to the trainer.
+    {
+      boost::lock_guard<boost::mutex> lock(m_trainerMutex);
+      m_pendingExamples.push_back(examples);
+    }
+    m_trainerHasWork.notify_one();
+  }
+
+  // If adaptive training is enabled, update the training rate based on how long it took to make the examples.
+  if(m_trainingRate)
+  {
+    m_trainingRate->update(1.0, boost::chrono::duration<double,boost::milli>(Clock::now() - startTime).count());
+    Profiler::instance().set_gauge("SemanticSegmentation.TrainingRate", m_trainingRate->get_budget());
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+SemanticSegmentationComponent::DecisionTreeSettings SemanticSegmentationComponent::make_forest_settings() const
+{
+  DecisionTreeSettings dtSettings(m_context->get_resources_dir() + "/RaflSettings.xml");
+  if(m_forestSeed) dtSettings.randomNumberGenerator.reset(new RandomNumberGenerator(*m_forestSeed));
+  return dtSettings;
+}
+
+void SemanticSegmentationComponent::predict_labels(size_t voxelCount)
+{
+  // Note that both forests work directly on the device on which the features were computed, so no data needs to be copied to or from the host.
+  const size_t featureCount = m_featureCalculator->get_feature_count();
+  if(m_deviceForest) m_deviceForest->predict_labels(*m_predictionFeaturesMB, featureCount, voxelCount, *m_predictionLabelsMB);
+  else m_forestPredictor->predict_labels(*m_predictionFeaturesMB, featureCount, voxelCount, *m_predictionLabelsMB);
+}
+
+void SemanticSegmentationComponent::run_background_prediction(const SpaintVoxelScene *scene)
+{
+  typedef boost::chrono::steady_clock Clock;
+  const Clock::time_point startTime = Clock::now();
+  const boost::chrono::duration<double,boost::milli> timeSlice(m_backgroundPredictionTimeSlice);
+
+  ProfilingScope backgroundScope("SemanticSegmentation.BackgroundPrediction");
+
+  // Note that a batch can legitimately be empty (e.g. if none of the voxels it considered were near the surface), so we
+  // keep going until the time slice is used up, but stop early if the scene contains no resident blocks at all. In
+  // deterministic mode, we process exactly one batch per frame, since the number that fit in the time slice would vary.
+  do
+  {
+    const size_t voxelCount = m_backgroundPredictionSampler->sample_voxels(scene, *m_backgroundPredictionVoxelLocationsMB);
+    if(voxelCount == 0)
+    {
+      if(m_backgroundPredictionSampler->get_sweep_block_count() == 0) break;
+      else continue;
+    }
+
+    // Predict labels for the sampled voxels and mark them (as with the visible voxels, the predictor only writes forest labels,
+    // and these never overwrite labels that were chosen by the user).
+    m_featureCalculator->calculate_features(*m_backgroundPredictionVoxelLocationsMB, scene, *m_predictionFeaturesMB);
+    predict_labels(voxelCount);
+    m_context->mark_voxels(m_sceneID, m_backgroundPredictionVoxelLocationsMB, m_predictionLabelsMB, NORMAL_MARKING);
+  }
+  while(!m_deterministic && Clock::now() - startTime < timeSlice);
+}
+
+void SemanticSegmentationComponent::run_trainer()
+{
+  bool forestMightBeSplittable = false;
+
+  Profiler::instance().set_thread_name("Forest trainer");
+
+  while(!m_trainerShouldTerminate)
+  {
+    // Wait until there is something to do, and then take ownership of any pending examples and reset request.
+    std::vector<ExampleMatrix> pendingExamples;
+    boost::optional<DecisionTreeSettings> resetSettings;
+    {
+      boost::unique_lock<boost::mutex> lock(m_trainerMutex);
+      while(!m_trainerShouldTerminate && !forestMightBeSplittable && !m_forestResetSettings && m_pendingExamples.empty()) m_trainerHasWork.wait(lock);
+      pendingExamples.swap(m_pendingExamples);
+      resetSettings.swap(m_forestResetSettings);
+    }
+
+    // If we were asked to terminate, do so.
+    if(m_trainerShouldTerminate) return;
+
+    // Run a single step of training. If this changed the forest, publish the resulting snapshot for use in prediction, unless
+    // a reset has been requested in the meantime (since the snapshot would then be for the old forest).
+    CompiledRandomForest_CPtr forestSnapshot = train_forest(pendingExamples, resetSettings, forestMightBeSplittable);
+    if(!forestSnapshot) continue;
+
+    boost::lock_guard<boost::mutex> lock(m_trainerMutex);
+    if(!m_forestResetSettings) boost::atomic_store(&m_forestSnapshot, forestSnapshot);
+  }
+}
+
+void SemanticSegmentationComponent::train_device_forest()
+{
+  typedef boost::chrono::steady_clock Clock;
+
+  ProfilingScope trainScope("SemanticSegmentation.TrainDeviceForest");
+
+  m_deviceForest->add_examples(*m_trainingFeaturesMB, m_featureCalculator->get_feature_count(), *m_trainingVoxelCountsMB, m_maxTrainingVoxelsPerLabel);
+
+  // As with the rafl forest, if adaptive training is enabled, allow as many nodes to be split as the current budget allows, and then update the budget.
+  const size_t splitBudget = m_splitBudget ? static_cast<size_t>(m_splitBudget->get_budget()) : 20;
+  const Clock::time_point startTime = Clock::now();
+  const size_t nodesSplit = m_deviceForest->train(splitBudget);
+  if(m_splitBudget)
+  {
+    m_splitBudget->update(static_cast<double>(nodesSplit), boost::chrono::duration<double,boost::milli>(Clock::now() - startTime).count());
+    Profiler::instance().set_gauge("SemanticSegmentation.SplitBudget", m_splitBudget->get_budget());
+  }
+}
+
+SemanticSegmentationComponent::CompiledRandomForest_CPtr
+SemanticSegmentationComponent::train_forest(const std::vector<ExampleMatrix>& pendingExamples, const boost::optional<DecisionTreeSettings>& resetSettings,
+                                            bool& forestMightBeSplittable)
+{
+  typedef boost::chrono::steady_clock Clock;
+
+  // If a reset was requested, replace the forest.
+  if(resetSettings)
+  {
+    m_forest.reset(new RandomForest<SpaintVoxel::Label>(m_forest->get_tree_count(), *resetSettings));
+    forestMightBeSplittable = false;
+  }
+
+  // Add any pending examples to the forest, and then train it for a single step.
+  size_t nodesSplit;
+  {
+    ProfilingScope trainScope("SemanticSegmentation.TrainForest");
+
+    for(size_t i = 0, size = pendingExamples.size(); i < size; ++i)
+    {
+      m_forest->add_examples(pendingExamples[i]);
+    }
+
+    // If adaptive training is enabled, allow as many nodes to be split as the current budget allows, and then update the budget
+    // based on how long the splitting took. Note that if no nodes were split, we learn nothing about the cost of splitting.
+    const size_t splitBudget = m_splitBudget ? static_cast<size_t>(m_splitBudget->get_budget()) : 20;
+    const Clock::time_point startTime = Clock::now();
+    nodesSplit = m_forest->train(splitBudget);
+    if(m_splitBudget)
+    {
+      m_splitBudget->update(static_cast<double>(nodesSplit), boost::chrono::duration<double,boost::milli>(Clock::now() - startTime).count());
+      Profiler::instance().set_gauge("SemanticSegmentation.SplitBudget", m_splitBudget->get_budget());
+    }
+  }
+
+  // If nothing changed, there is no need to publish a new snapshot, and we can wait for more examples before trying to train again.
+  forestMightBeSplittable = nodesSplit > 0;
+  if(!forestMightBeSplittable && pendingExamples.empty()) return CompiledRandomForest_CPtr();
+
+  // Otherwise, if the forest is valid, make a new snapshot of it for use in prediction. Note that the trainer makes the snapshot
+  // before taking the lock, and then only publishes it if no reset has been requested in the meantime.
+  if(!m_forest->is_valid()) return CompiledRandomForest_CPtr();
 
-  // Train the forest.
-  const size_t splitBudget = 20;
-  m_forest->add_examples(examples);
-  m_forest->train(splitBudget);
+  ProfilingScope snapshotScope("SemanticSegmentation.SnapshotForest");
+  return CompiledRandomForest_CPtr(new CompiledRandomForest<SpaintVoxel::Label>(*m_forest));
 }
 
 }
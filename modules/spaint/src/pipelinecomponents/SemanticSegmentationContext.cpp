@@ -0,0 +1,29 @@
+/**
+ * spaint: SemanticSegmentationContext.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "pipelinecomponents/SemanticSegmentationContext.h"
+
+#include <tvgutil/containers/MapUtil.h>
+using namespace tvgutil;
+
+namespace spaint {
+
+//#################### DESTRUCTOR ####################
+
+SemanticSegmentationContext::~SemanticSegmentationContext() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMUChar4Image_CPtr SemanticSegmentationContext::get_feature_inspection_image(const std::string& sceneID) const
+{
+  return MapUtil::lookup(m_featureInspectionImages, sceneID, ITMUChar4Image_CPtr());
+}
+
+void SemanticSegmentationContext::set_feature_inspection_image(const std::string& sceneID, const ITMUChar4Image_CPtr& featureInspectionImage)
+{
+  m_featureInspectionImages[sceneID] = featureInspectionImage;
+}
+
+}
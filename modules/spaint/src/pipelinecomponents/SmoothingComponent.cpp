@@ -5,6 +5,12 @@
 
 #include "pipelinecomponents/SmoothingComponent.h"
 
+#include <boost/chrono/chrono.hpp>
+
+#include <tvgutil/timing/Profiler.h>
+using tvgutil::Profiler;
+using tvgutil::WorkBudgetController;
+
 #include "smoothing/LabelSmootherFactory.h"
 
 namespace spaint {
@@ -15,14 +21,42 @@ SmoothingComponent::SmoothingComponent(const SmoothingContext_Ptr& context, cons
 : m_context(context), m_sceneID(sceneID)
 {
   size_t maxLabelCount = context->get_label_manager()->get_max_label_count();
-  m_labelSmoother = LabelSmootherFactory::make_label_smoother(maxLabelCount, context->get_settings()->deviceType);
+  const Settings_CPtr& settings = context->get_settings();
+  const size_t iterationCount = settings->get_first_value<size_t>("SmoothingComponent.iterationCount", 1);
+  m_labelSmoother = LabelSmootherFactory::make_label_smoother(maxLabelCount, settings->deviceType, iterationCount);
+
+  if(settings->get_first_value<bool>("SmoothingComponent.useVoxelSmoothing", false))
+  {
+    const size_t maxBlockCount = settings->get_first_value<size_t>("SmoothingComponent.voxelSmoothingMaxBlockCount", 256);
+    const float maxSDF = settings->sceneParams.voxelSize / settings->sceneParams.mu; // within one voxel of the surface
+    m_voxelLabelSmoother = LabelSmootherFactory::make_voxel_label_smoother(maxLabelCount, maxBlockCount, maxSDF, settings->deviceType);
+  }
+
+  // Optionally adapt the fraction of frames on which to smooth so as to hold the cost of smoothing near a target time (in ms).
+  const double timeTarget = settings->get_first_value<double>("SmoothingComponent.timeTarget", 0.0);
+  if(timeTarget > 0.0) m_runRate = WorkBudgetController(timeTarget, 0.1, 1.0, 1.0);
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void SmoothingComponent::run(const VoxelRenderState_CPtr& renderState)
 {
-  m_labelSmoother->smooth_labels(renderState->raycastResult, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get());
+  // If adaptive smoothing is enabled and smoothing is not due on this frame, early out.
+  if(m_runRate && !m_runRate->accrue()) return;
+
+  typedef boost::chrono::steady_clock Clock;
+  const Clock::time_point startTime = Clock::now();
+
+  SpaintVoxelScene *scene = m_context->get_slam_state(m_sceneID)->get_voxel_scene().get();
+  m_labelSmoother->smooth_labels(renderState->raycastResult, scene);
+  if(m_voxelLabelSmoother) m_voxelLabelSmoother->smooth_labels(scene);
+
+  // If adaptive smoothing is enabled, update the smoothing rate based on how long the smoothing took.
+  if(m_runRate)
+  {
+    m_runRate->update(1.0, boost::chrono::duration<double,boost::milli>(Clock::now() - startTime).count());
+    Profiler::instance().set_gauge("Smoothing.Rate", m_runRate->get_budget());
+  }
 }
 
 }
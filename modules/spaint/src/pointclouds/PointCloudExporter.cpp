@@ -0,0 +1,103 @@
+/**
+ * spaint: PointCloudExporter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "pointclouds/PointCloudExporter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+
+#include <tvgutil/timing/ProfilingScope.h>
+using namespace tvgutil;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+PointCloudExporter::PointCloudExporter(const SurfacePointExtractor_CPtr& extractor, const LabelManager_CPtr& labelManager)
+: m_extractor(extractor), m_labelManager(labelManager)
+{
+  if(!extractor)
+  {
+    throw std::invalid_argument("Error: Cannot initialise a PointCloudExporter with a NULL surface point extractor");
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+PointCloudExporter::~PointCloudExporter()
+{
+  finish();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void PointCloudExporter::finish()
+{
+  if(m_writer.joinable()) m_writer.join();
+}
+
+void PointCloudExporter::start(const std::string& path, const SpaintVoxelScene *scene)
+{
+  // If a previous point cloud is still being written, wait for it to be finished (the writer thread owns the point cloud until then).
+  finish();
+
+  {
+    ProfilingScope profilingScope("PointCloudExporter.Extract");
+    m_extractor->extract_surface_points(scene, m_cloud);
+  }
+
+  m_path = path;
+  m_writer = boost::thread(boost::bind(&PointCloudExporter::run_writer, this));
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void PointCloudExporter::run_writer()
+{
+  Profiler::instance().set_thread_name("Point cloud writer");
+  ProfilingScope profilingScope("PointCloudExporter.Write");
+
+  std::ofstream os(m_path.c_str(), std::ios::binary);
+  if(os)
+  {
+    // Write the header.
+    os.write("SPAINTPC", 8);
+    write_value<boost::uint32_t>(os, FILE_FORMAT_VERSION);
+    write_value<boost::uint32_t>(os, m_cloud.hasConfidences ? 1 : 0);
+    write_value<boost::uint64_t>(os, m_cloud.pointCount);
+    write_value<float>(os, m_cloud.voxelSize);
+
+    // Write the names of the semantic labels.
+    const size_t labelCount = m_labelManager ? m_labelManager->get_label_count() : 0;
+    write_value<boost::uint32_t>(os, static_cast<boost::uint32_t>(labelCount));
+    for(size_t i = 0; i < labelCount; ++i)
+    {
+      const std::string name = m_labelManager->get_label_name(static_cast<SpaintVoxel::Label>(i));
+      write_value<boost::uint32_t>(os, static_cast<boost::uint32_t>(name.size()));
+      os.write(name.data(), name.size());
+    }
+
+    // Write the columns (these are already laid out in the point cloud exactly as they are in the file).
+    if(!m_cloud.data.empty()) os.write(reinterpret_cast<const char*>(&m_cloud.data[0]), m_cloud.data.size());
+    os.close();
+  }
+
+  if(os)
+  {
+    std::cout << "[spaint] Finished saving point cloud (" << m_cloud.pointCount << " points) to " << m_path << '\n';
+  }
+  else
+  {
+    std::cerr << "Error: Could not write a point cloud to " << m_path << '\n';
+    std::remove(m_path.c_str());
+  }
+}
+
+}
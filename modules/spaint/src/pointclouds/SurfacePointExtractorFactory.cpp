@@ -0,0 +1,39 @@
+/**
+ * spaint: SurfacePointExtractorFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "pointclouds/SurfacePointExtractorFactory.h"
+using namespace ITMLib;
+
+#include "pointclouds/cpu/SurfacePointExtractor_CPU.h"
+
+#ifdef WITH_CUDA
+#include "pointclouds/cuda/SurfacePointExtractor_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+SurfacePointExtractor_Ptr SurfacePointExtractorFactory::make_surface_point_extractor(ITMLibSettings::DeviceType deviceType)
+{
+  SurfacePointExtractor_Ptr extractor;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    extractor.reset(new SurfacePointExtractor_CUDA);
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    extractor.reset(new SurfacePointExtractor_CPU);
+  }
+
+  return extractor;
+}
+
+}
@@ -0,0 +1,74 @@
+/**
+ * spaint: SurfacePointExtractor_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "pointclouds/cpu/SurfacePointExtractor_CPU.h"
+using namespace ITMLib;
+
+#include "pointclouds/shared/SurfacePointExtractor_Shared.h"
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+size_t SurfacePointExtractor_CPU::count_surface_voxels(const SpaintVoxelScene *scene, int entryCount, float maxSDF) const
+{
+  const int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+  size_t voxelCount = 0;
+  for(int i = 0; i < entryCount; ++i)
+  {
+    const SpaintVoxel *blockVoxels = voxelData + hashTable[entryIDs[i]].ptr * SDF_BLOCK_SIZE3;
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      if(is_surface_voxel(blockVoxels[linearIdx], maxSDF)) ++voxelCount;
+    }
+  }
+
+  return voxelCount;
+}
+
+int SurfacePointExtractor_CPU::find_resident_entries(const SpaintVoxelScene *scene) const
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+
+  int entryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    if(hashTable[entryID].ptr >= 0) entryIDs[entryCount++] = entryID;
+  }
+
+  return entryCount;
+}
+
+void SurfacePointExtractor_CPU::write_surface_points(const SpaintVoxelScene *scene, int entryCount, float maxSDF, SurfacePointCloud& cloud) const
+{
+  const int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel::LabelEvidence *evidenceData = scene->get_label_evidence_data();
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const float voxelSize = scene->sceneParams->voxelSize;
+
+  const Columns columns = make_columns(cloud, &cloud.data[0]);
+
+  size_t row = 0;
+  for(int i = 0; i < entryCount; ++i)
+  {
+    const ITMHashEntry& hashEntry = hashTable[entryIDs[i]];
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      const int voxelAddress = hashEntry.ptr * SDF_BLOCK_SIZE3 + linearIdx;
+      if(is_surface_voxel(voxelData[voxelAddress], maxSDF))
+      {
+        write_surface_point(row++, voxelAddress, get_block_voxel_position(hashEntry, linearIdx), voxelData, labelData, evidenceData, voxelSize, columns);
+      }
+    }
+  }
+}
+
+}
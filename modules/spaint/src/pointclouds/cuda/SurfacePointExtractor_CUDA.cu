@@ -0,0 +1,128 @@
+/**
+ * spaint: SurfacePointExtractor_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "pointclouds/cuda/SurfacePointExtractor_CUDA.h"
+using namespace ITMLib;
+
+#include <ORUtils/CUDADefines.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "pointclouds/shared/SurfacePointExtractor_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_count_surface_voxels(const int *entryIDs, const ITMHashEntry *hashTable, const SpaintVoxel *voxelData, float maxSDF, unsigned int *voxelCount)
+{
+  // Note: There is one CUDA block per voxel block, and one thread per voxel.
+  const int voxelAddress = hashTable[entryIDs[blockIdx.x]].ptr * SDF_BLOCK_SIZE3 + threadIdx.x;
+  const int blockVoxelCount = __syncthreads_count(is_surface_voxel(voxelData[voxelAddress], maxSDF));
+  if(threadIdx.x == 0 && blockVoxelCount > 0) atomicAdd(voxelCount, static_cast<unsigned int>(blockVoxelCount));
+}
+
+__global__ void ck_find_resident_entries(const ITMHashEntry *hashTable, int *entryIDs, unsigned int *entryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < ITMVoxelBlockHash::noTotalEntries && hashTable[entryID].ptr >= 0)
+  {
+    entryIDs[atomicAdd(entryCount, 1u)] = entryID;
+  }
+}
+
+__global__ void ck_write_surface_points(const int *entryIDs, const ITMHashEntry *hashTable, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                        const SpaintVoxel::LabelEvidence *evidenceData, float maxSDF, float voxelSize, SurfacePointExtractor::Columns columns,
+                                        unsigned int *rowCount)
+{
+  // Note: There is one CUDA block per voxel block, and one thread per voxel (SDF_BLOCK_SIZE3 is a multiple of the warp size, so every warp is full).
+  const ITMHashEntry hashEntry = hashTable[entryIDs[blockIdx.x]];
+  const int voxelAddress = hashEntry.ptr * SDF_BLOCK_SIZE3 + threadIdx.x;
+  const bool isSurface = is_surface_voxel(voxelData[voxelAddress], maxSDF);
+
+  // Claim consecutive rows for the surface voxels in the warp, using a single atomic.
+  const int laneIdx = threadIdx.x & (warpSize - 1);
+  const unsigned int surfaceMask = __ballot_sync(0xFFFFFFFF, isSurface);
+  unsigned int baseRow = 0;
+  if(laneIdx == 0 && surfaceMask != 0) baseRow = atomicAdd(rowCount, static_cast<unsigned int>(__popc(surfaceMask)));
+  baseRow = __shfl_sync(0xFFFFFFFF, baseRow, 0);
+
+  if(isSurface)
+  {
+    const unsigned int row = baseRow + __popc(surfaceMask & ((1u << laneIdx) - 1));
+    write_surface_point(row, voxelAddress, get_block_voxel_position(hashEntry, threadIdx.x), voxelData, labelData, evidenceData, voxelSize, columns);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+SurfacePointExtractor_CUDA::SurfacePointExtractor_CUDA()
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_columnsMB = mbf.make_block<unsigned char>(0, "SurfacePointExtractor");
+  m_countMB = mbf.make_block<unsigned int>(1, "SurfacePointExtractor");
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+size_t SurfacePointExtractor_CUDA::count_surface_voxels(const SpaintVoxelScene *scene, int entryCount, float maxSDF) const
+{
+  m_countMB->Clear();
+
+  ck_count_surface_voxels<<<entryCount,SDF_BLOCK_SIZE3>>>(
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    maxSDF,
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_countMB->UpdateHostFromDevice();
+  return *m_countMB->GetData(MEMORYDEVICE_CPU);
+}
+
+int SurfacePointExtractor_CUDA::find_resident_entries(const SpaintVoxelScene *scene) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (ITMVoxelBlockHash::noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_countMB->Clear();
+
+  ck_find_resident_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_countMB->UpdateHostFromDevice();
+  return static_cast<int>(*m_countMB->GetData(MEMORYDEVICE_CPU));
+}
+
+void SurfacePointExtractor_CUDA::write_surface_points(const SpaintVoxelScene *scene, int entryCount, float maxSDF, SurfacePointCloud& cloud) const
+{
+  // Make sure that the device buffer is large enough to hold the column data.
+  const size_t dataSize = cloud.data.size();
+  if(m_columnsMB->dataSize < dataSize) m_columnsMB->Resize(dataSize);
+
+  m_countMB->Clear();
+
+  ck_write_surface_points<<<entryCount,SDF_BLOCK_SIZE3>>>(
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->get_label_evidence_data(),
+    maxSDF,
+    scene->sceneParams->voxelSize,
+    make_columns(cloud, m_columnsMB->GetData(MEMORYDEVICE_CUDA)),
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Copy the whole point cloud across to the host in one go.
+  ORcudaSafeCall(cudaMemcpy(&cloud.data[0], m_columnsMB->GetData(MEMORYDEVICE_CUDA), dataSize, cudaMemcpyDeviceToHost));
+}
+
+}
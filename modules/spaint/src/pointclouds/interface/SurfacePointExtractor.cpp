@@ -0,0 +1,62 @@
+/**
+ * spaint: SurfacePointExtractor.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "pointclouds/interface/SurfacePointExtractor.h"
+using namespace ITMLib;
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SurfacePointExtractor::SurfacePointExtractor()
+{
+  m_entryIDsMB = MemoryBlockFactory::instance().make_block<int>(ITMVoxelBlockHash::noTotalEntries, "SurfacePointExtractor");
+}
+
+//#################### DESTRUCTOR ####################
+
+SurfacePointExtractor::~SurfacePointExtractor() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SurfacePointExtractor::extract_surface_points(const SpaintVoxelScene *scene, SurfacePointCloud& cloud) const
+{
+  // A voxel is on the surface if it lies within one voxel of the zero level set. Since the SDF values are normalised by mu,
+  // this corresponds to an absolute SDF value of at most voxelSize / mu.
+  const float voxelSize = scene->sceneParams->voxelSize;
+  const float maxSDF = voxelSize / scene->sceneParams->mu;
+
+  const int entryCount = find_resident_entries(scene);
+
+  cloud.hasConfidences = scene->get_label_evidence_data() != NULL;
+  cloud.pointCount = entryCount > 0 ? count_surface_voxels(scene, entryCount, maxSDF) : 0;
+  cloud.voxelSize = voxelSize;
+
+  size_t positionsOffset, confidencesOffset, coloursOffset, labelsOffset, groupsOffset;
+  cloud.data.resize(cloud.get_column_offsets(positionsOffset, confidencesOffset, coloursOffset, labelsOffset, groupsOffset));
+
+  if(cloud.pointCount > 0) write_surface_points(scene, entryCount, maxSDF, cloud);
+}
+
+//#################### PROTECTED STATIC MEMBER FUNCTIONS ####################
+
+SurfacePointExtractor::Columns SurfacePointExtractor::make_columns(const SurfacePointCloud& cloud, unsigned char *buffer)
+{
+  size_t positionsOffset, confidencesOffset, coloursOffset, labelsOffset, groupsOffset;
+  cloud.get_column_offsets(positionsOffset, confidencesOffset, coloursOffset, labelsOffset, groupsOffset);
+
+  Columns columns;
+  columns.colours = reinterpret_cast<Vector3u*>(buffer + coloursOffset);
+  columns.confidences = cloud.hasConfidences ? reinterpret_cast<float*>(buffer + confidencesOffset) : NULL;
+  columns.groups = buffer + groupsOffset;
+  columns.labels = buffer + labelsOffset;
+  columns.positions = reinterpret_cast<Vector3f*>(buffer + positionsOffset);
+  return columns;
+}
+
+}
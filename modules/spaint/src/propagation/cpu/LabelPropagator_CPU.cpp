@@ -11,8 +11,9 @@ namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-LabelPropagator_CPU::LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels)
-: LabelPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels)
+LabelPropagator_CPU::LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                                         bool useFrontier)
+: LabelPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, useFrontier)
 {}
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
@@ -34,14 +35,76 @@ void LabelPropagator_CPU::calculate_normals(const ITMFloat4Image *raycastResult,
   }
 }
 
+int LabelPropagator_CPU::find_frontier(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const
+{
+  const int height = raycastResult->noDims.y;
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  unsigned char *labelMask = m_labelMaskMB->GetData(MEMORYDEVICE_CPU);
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  const int raycastResultSize = static_cast<int>(raycastResult->dataSize);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const int width = raycastResult->noDims.x;
+
+  // Determine which pixels could be marked with the label, and which already have it.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int voxelIndex = 0; voxelIndex < raycastResultSize; ++voxelIndex)
+  {
+    write_propagation_mask(voxelIndex, label, raycastResultData, voxelData, labelData, indexData, labelMask);
+  }
+
+  // Collect the indices of the pixels on the frontier.
+  int *frontier = m_frontierMB->GetData(MEMORYDEVICE_CPU);
+  int frontierSize = 0;
+  for(int voxelIndex = 0; voxelIndex < raycastResultSize; ++voxelIndex)
+  {
+    if(is_frontier_pixel(voxelIndex, width, height, labelMask)) frontier[frontierSize++] = voxelIndex;
+  }
+
+  return frontierSize;
+}
+
+void LabelPropagator_CPU::perform_frontier_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, int frontierSize, SpaintVoxelScene *scene) const
+{
+  SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
+  const int *frontier = m_frontierMB->GetData(MEMORYDEVICE_CPU);
+  const int height = raycastResult->noDims.y;
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  unsigned int *labelCounts = scene->get_label_count_data();
+  unsigned int *labelPresence = scene->get_label_presence_data();
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  const unsigned int version = scene->advance_version();
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const int width = raycastResult->noDims.x;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < frontierSize; ++i)
+  {
+    propagate_from_neighbours(
+      frontier[i], width, height, label, raycastResultData, NULL, voxelData, labelData, indexData,
+      m_maxAngleBetweenNormals, m_maxSquaredDistanceBetweenColours, m_maxSquaredDistanceBetweenVoxels, labelCounts, labelPresence, blockVersions, version
+    );
+  }
+}
+
 void LabelPropagator_CPU::perform_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, SpaintVoxelScene *scene) const
 {
+  SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
   const int height = raycastResult->noDims.y;
   const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
   const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
   const int raycastResultSize = static_cast<int>(raycastResult->dataSize);
   const Vector3f *surfaceNormals = m_surfaceNormalsMB->GetData(MEMORYDEVICE_CPU);
   SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  unsigned int *labelCounts = scene->get_label_count_data();
+  unsigned int *labelPresence = scene->get_label_presence_data();
+  const unsigned int version = scene->advance_version();
   const int width = raycastResult->noDims.x;
 
 #ifdef WITH_OPENMP
@@ -50,8 +113,8 @@ void LabelPropagator_CPU::perform_propagation(SpaintVoxel::Label label, const IT
   for(int voxelIndex = 0; voxelIndex < raycastResultSize; ++voxelIndex)
   {
     propagate_from_neighbours(
-      voxelIndex, width, height, label, raycastResultData, surfaceNormals, voxelData, indexData,
-      m_maxAngleBetweenNormals, m_maxSquaredDistanceBetweenColours, m_maxSquaredDistanceBetweenVoxels
+      voxelIndex, width, height, label, raycastResultData, surfaceNormals, voxelData, labelData, indexData,
+      m_maxAngleBetweenNormals, m_maxSquaredDistanceBetweenColours, m_maxSquaredDistanceBetweenVoxels, labelCounts, labelPresence, blockVersions, version
     );
   }
 }
@@ -5,6 +5,8 @@
 
 #include "propagation/cuda/LabelPropagator_CUDA.h"
 
+#include <ORUtils/CUDADefines.h>
+
 #include "propagation/shared/LabelPropagator_Shared.h"
 
 #define DEBUGGING 0
@@ -13,6 +15,17 @@ namespace spaint {
 
 //#################### CUDA KERNELS ####################
 
+__global__ void ck_calculate_propagation_mask(SpaintVoxel::Label label, const Vector4f *raycastResultData, int raycastResultSize,
+                                              const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                              const ITMVoxelIndex::IndexData *indexData, unsigned char *labelMask)
+{
+  int voxelIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(voxelIndex < raycastResultSize)
+  {
+    write_propagation_mask(voxelIndex, label, raycastResultData, voxelData, labelData, indexData, labelMask);
+  }
+}
+
 __global__ void ck_calculate_normals(const Vector4f *raycastResultData, int raycastResultSize,
                                      const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                      Vector3f *surfaceNormals)
@@ -24,24 +37,53 @@ __global__ void ck_calculate_normals(const Vector4f *raycastResultData, int rayc
   }
 }
 
+__global__ void ck_find_frontier(const unsigned char *labelMask, int raycastResultSize, int width, int height, int *frontier, int *frontierSize)
+{
+  int voxelIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(voxelIndex < raycastResultSize && is_frontier_pixel(voxelIndex, width, height, labelMask))
+  {
+    frontier[atomicAdd(frontierSize, 1)] = voxelIndex;
+  }
+}
+
+__global__ void ck_perform_frontier_propagation(SpaintVoxel::Label label, const int *frontier, int frontierSize, const Vector4f *raycastResultData, int width, int height,
+                                                SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                                                float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                                                unsigned int *labelCounts, unsigned int *labelPresence, SpaintVoxelScene::BlockVersions *blockVersions,
+                                                unsigned int version)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < frontierSize)
+  {
+    propagate_from_neighbours(
+      frontier[tid], width, height, label, raycastResultData, NULL, voxelData, labelData, indexData,
+      maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, labelCounts, labelPresence, blockVersions, version
+    );
+  }
+}
+
 __global__ void ck_perform_propagation(SpaintVoxel::Label label, const Vector4f *raycastResultData, int raycastResultSize, int width, int height,
-                                       const Vector3f *surfaceNormals, SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                       float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels)
+                                       const Vector3f *surfaceNormals, SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData,
+                                       const ITMVoxelIndex::IndexData *indexData, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                                       unsigned int *labelCounts, unsigned int *labelPresence, SpaintVoxelScene::BlockVersions *blockVersions,
+                                       unsigned int version)
 {
   int voxelIndex = threadIdx.x + blockDim.x * blockIdx.x;
   if(voxelIndex < raycastResultSize)
   {
     propagate_from_neighbours(
-      voxelIndex, width, height, label, raycastResultData, surfaceNormals, voxelData, indexData,
-      maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels
+      voxelIndex, width, height, label, raycastResultData, surfaceNormals, voxelData, labelData, indexData,
+      maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, labelCounts, labelPresence, blockVersions, version
     );
   }
 }
 
 //#################### CONSTRUCTORS ####################
 
-LabelPropagator_CUDA::LabelPropagator_CUDA(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels)
-: LabelPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels)
+LabelPropagator_CUDA::LabelPropagator_CUDA(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                                           bool useFrontier)
+: LabelPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, useFrontier),
+  m_frontierSizeMB(new ORUtils::MemoryBlock<int>(1, true, true))
 {}
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
@@ -53,7 +95,10 @@ void LabelPropagator_CUDA::calculate_normals(const ITMFloat4Image *raycastResult
   int threadsPerBlock = 256;
   int numBlocks = (raycastResultSize + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_calculate_normals<<<numBlocks,threadsPerBlock>>>(
+  // Note: This is the first stage of non-frontier propagation, so we wait for the raycast result and the labels to be ready first.
+  m_stream.begin_work();
+
+  ck_calculate_normals<<<numBlocks,threadsPerBlock,0,m_stream.get()>>>(
     raycastResult->GetData(MEMORYDEVICE_CUDA),
     raycastResultSize,
     scene->localVBA.GetVoxelBlocks(),
@@ -66,6 +111,72 @@ void LabelPropagator_CUDA::calculate_normals(const ITMFloat4Image *raycastResult
 #endif
 }
 
+int LabelPropagator_CUDA::find_frontier(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene) const
+{
+  const int raycastResultSize = static_cast<int>(raycastResult->dataSize);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (raycastResultSize + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Note: This is the first stage of frontier propagation, so we wait for the raycast result and the labels to be ready first.
+  m_stream.begin_work();
+
+  // Determine which pixels could be marked with the label, and which already have it.
+  ck_calculate_propagation_mask<<<numBlocks,threadsPerBlock,0,m_stream.get()>>>(
+    label,
+    raycastResult->GetData(MEMORYDEVICE_CUDA),
+    raycastResultSize,
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->index.getIndexData(),
+    m_labelMaskMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Collect the indices of the pixels on the frontier (in no particular order).
+  ORcudaSafeCall(cudaMemsetAsync(m_frontierSizeMB->GetData(MEMORYDEVICE_CUDA), 0, sizeof(int), m_stream.get()));
+
+  ck_find_frontier<<<numBlocks,threadsPerBlock,0,m_stream.get()>>>(
+    m_labelMaskMB->GetData(MEMORYDEVICE_CUDA),
+    raycastResultSize,
+    raycastResult->noDims.x,
+    raycastResult->noDims.y,
+    m_frontierMB->GetData(MEMORYDEVICE_CUDA),
+    m_frontierSizeMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Copy the size of the frontier back across to the CPU so that we know how many threads to launch to process it.
+  m_stream.copy_to_host(*m_frontierSizeMB, 1);
+  return *m_frontierSizeMB->GetData(MEMORYDEVICE_CPU);
+}
+
+void LabelPropagator_CUDA::perform_frontier_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, int frontierSize, SpaintVoxelScene *scene) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (frontierSize + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_perform_frontier_propagation<<<numBlocks,threadsPerBlock,0,m_stream.get()>>>(
+    label,
+    m_frontierMB->GetData(MEMORYDEVICE_CUDA),
+    frontierSize,
+    raycastResult->GetData(MEMORYDEVICE_CUDA),
+    raycastResult->noDims.x,
+    raycastResult->noDims.y,
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->index.getIndexData(),
+    m_maxAngleBetweenNormals,
+    m_maxSquaredDistanceBetweenColours,
+    m_maxSquaredDistanceBetweenVoxels,
+    scene->get_label_count_data(),
+    scene->get_label_presence_data(),
+    scene->get_block_versions(),
+    scene->advance_version()
+  );
+
+  // Make any subsequent work on the default stream wait for the labels to have been propagated.
+  m_stream.end_work();
+}
+
 void LabelPropagator_CUDA::perform_propagation(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, SpaintVoxelScene *scene) const
 {
   const int raycastResultSize = static_cast<int>(raycastResult->dataSize);
@@ -73,7 +184,7 @@ void LabelPropagator_CUDA::perform_propagation(SpaintVoxel::Label label, const I
   int threadsPerBlock = 256;
   int numBlocks = (raycastResultSize + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_perform_propagation<<<numBlocks,threadsPerBlock>>>(
+  ck_perform_propagation<<<numBlocks,threadsPerBlock,0,m_stream.get()>>>(
     label,
     raycastResult->GetData(MEMORYDEVICE_CUDA),
     raycastResultSize,
@@ -81,11 +192,19 @@ void LabelPropagator_CUDA::perform_propagation(SpaintVoxel::Label label, const I
     raycastResult->noDims.y,
     m_surfaceNormalsMB->GetData(MEMORYDEVICE_CUDA),
     scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
     scene->index.getIndexData(),
     m_maxAngleBetweenNormals,
     m_maxSquaredDistanceBetweenColours,
-    m_maxSquaredDistanceBetweenVoxels
+    m_maxSquaredDistanceBetweenVoxels,
+    scene->get_label_count_data(),
+    scene->get_label_presence_data(),
+    scene->get_block_versions(),
+    scene->advance_version()
   );
+
+  // Make any subsequent work on the default stream wait for the labels to have been propagated.
+  m_stream.end_work();
 }
 
 }
@@ -12,12 +12,20 @@ namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-LabelPropagator::LabelPropagator(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels)
+LabelPropagator::LabelPropagator(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                                 bool useFrontier)
 : m_maxAngleBetweenNormals(maxAngleBetweenNormals),
   m_maxSquaredDistanceBetweenColours(maxSquaredDistanceBetweenColours),
   m_maxSquaredDistanceBetweenVoxels(maxSquaredDistanceBetweenVoxels),
-  m_surfaceNormalsMB(MemoryBlockFactory::instance().make_block<Vector3f>(raycastResultSize))
-{}
+  m_surfaceNormalsMB(MemoryBlockFactory::instance().make_block<Vector3f>(raycastResultSize, "LabelPropagator")),
+  m_useFrontier(useFrontier)
+{
+  if(useFrontier)
+  {
+    m_frontierMB = MemoryBlockFactory::instance().make_block<int>(raycastResultSize, "LabelPropagator");
+    m_labelMaskMB = MemoryBlockFactory::instance().make_block<unsigned char>(raycastResultSize, "LabelPropagator");
+  }
+}
 
 //#################### DESTRUCTOR ####################
 
@@ -27,6 +35,14 @@ LabelPropagator::~LabelPropagator() {}
 
 void LabelPropagator::propagate_label(SpaintVoxel::Label label, const ITMFloat4Image *raycastResult, SpaintVoxelScene *scene) const
 {
+  if(m_useFrontier)
+  {
+    // Find the pixels on the frontier of the region being propagated, and propagate the label to those alone.
+    const int frontierSize = find_frontier(label, raycastResult, scene);
+    if(frontierSize > 0) perform_frontier_propagation(label, raycastResult, frontierSize, scene);
+    return;
+  }
+
   // Calculate the normals of the voxels in the raycast result.
   calculate_normals(raycastResult, scene);
 
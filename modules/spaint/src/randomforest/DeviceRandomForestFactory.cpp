@@ -0,0 +1,42 @@
+/**
+ * spaint: DeviceRandomForestFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/DeviceRandomForestFactory.h"
+using namespace ITMLib;
+
+#include "randomforest/cpu/DeviceRandomForest_CPU.h"
+
+#ifdef WITH_CUDA
+#include "randomforest/cuda/DeviceRandomForest_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+DeviceRandomForest_Ptr DeviceRandomForestFactory::make_device_random_forest(size_t treeCount, size_t labelCount, size_t featureCount,
+                                                                            const DeviceRandomForest::Settings& settings,
+                                                                            ITMLibSettings::DeviceType deviceType)
+{
+  DeviceRandomForest_Ptr forest;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    forest.reset(new DeviceRandomForest_CUDA(treeCount, labelCount, featureCount, settings));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    forest.reset(new DeviceRandomForest_CPU(treeCount, labelCount, featureCount, settings));
+  }
+
+  return forest;
+}
+
+}
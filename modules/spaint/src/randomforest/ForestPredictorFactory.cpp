@@ -0,0 +1,40 @@
+/**
+ * spaint: ForestPredictorFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "randomforest/ForestPredictorFactory.h"
+using namespace ITMLib;
+
+#include "randomforest/cpu/ForestPredictor_CPU.h"
+
+#ifdef WITH_CUDA
+#include "randomforest/cuda/ForestPredictor_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+ForestPredictor_Ptr ForestPredictorFactory::make_forest_predictor(ITMLibSettings::DeviceType deviceType)
+{
+  ForestPredictor_Ptr predictor;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    predictor.reset(new ForestPredictor_CUDA);
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    predictor.reset(new ForestPredictor_CPU);
+  }
+
+  return predictor;
+}
+
+}
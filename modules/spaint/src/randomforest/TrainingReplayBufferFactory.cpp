@@ -0,0 +1,41 @@
+/**
+ * spaint: TrainingReplayBufferFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/TrainingReplayBufferFactory.h"
+using namespace ITMLib;
+
+#include "randomforest/cpu/TrainingReplayBuffer_CPU.h"
+
+#ifdef WITH_CUDA
+#include "randomforest/cuda/TrainingReplayBuffer_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+TrainingReplayBuffer_Ptr TrainingReplayBufferFactory::make_training_replay_buffer(size_t maxLabelCount, size_t capacityPerLabel, size_t featureCount,
+                                                                                  size_t maxRefreshCount, unsigned int seed, ITMLibSettings::DeviceType deviceType)
+{
+  TrainingReplayBuffer_Ptr buffer;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    buffer.reset(new TrainingReplayBuffer_CUDA(maxLabelCount, capacityPerLabel, featureCount, maxRefreshCount, seed));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    buffer.reset(new TrainingReplayBuffer_CPU(maxLabelCount, capacityPerLabel, featureCount, maxRefreshCount, seed));
+  }
+
+  return buffer;
+}
+
+}
@@ -0,0 +1,196 @@
+/**
+ * spaint: DeviceRandomForest_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/cpu/DeviceRandomForest_CPU.h"
+
+#include "randomforest/shared/DeviceRandomForest_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+DeviceRandomForest_CPU::DeviceRandomForest_CPU(size_t treeCount, size_t labelCount, size_t featureCount, const Settings& settings)
+: DeviceRandomForest(treeCount, labelCount, featureCount, settings)
+{
+  reset();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DeviceRandomForest_CPU::add_examples_sub(const ORUtils::MemoryBlock<float>& featuresMB, const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB,
+                                              size_t maxVoxelsPerLabel, unsigned int firstExampleID)
+{
+  const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  const unsigned int *voxelCounts = voxelCountsMB.GetData(MEMORYDEVICE_CPU);
+  const int slotCount = m_labelCount * static_cast<int>(maxVoxelsPerLabel);
+
+  // Copy the examples into the pool.
+  unsigned int *poolExampleIDs = m_poolExampleIDsMB->GetData(MEMORYDEVICE_CPU);
+  float *poolFeatures = m_poolFeaturesMB->GetData(MEMORYDEVICE_CPU);
+  int *poolLabels = m_poolLabelsMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int tid = 0; tid < slotCount; ++tid)
+  {
+    copy_example_to_pool(
+      tid, features, m_featureCount, voxelCounts, static_cast<int>(maxVoxelsPerLabel), firstExampleID,
+      m_settings.poolSize, poolExampleIDs, poolFeatures, poolLabels
+    );
+  }
+
+  // Add the examples to the trees.
+  const ForestPredictorNode *nodes = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  const int *rootIndices = m_rootIndicesMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *classCounts = m_classCountsMB->GetData(MEMORYDEVICE_CPU);
+  float *histograms = m_histogramsMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *reservoirs = m_reservoirsMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *seenCounts = m_seenCountsMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int tid = 0; tid < slotCount * m_treeCount; ++tid)
+  {
+    add_example_to_tree(
+      tid, features, m_featureCount, voxelCounts, static_cast<int>(maxVoxelsPerLabel), firstExampleID, nodes, rootIndices, m_treeCount,
+      m_labelCount, m_settings.reservoirSize, m_settings.seed, classCounts, histograms, reservoirs, seenCounts
+    );
+  }
+}
+
+void DeviceRandomForest_CPU::calculate_splittabilities()
+{
+  const unsigned int *classCounts = m_classCountsMB->GetData(MEMORYDEVICE_CPU);
+  const float *histograms = m_histogramsMB->GetData(MEMORYDEVICE_CPU);
+  const int *nodeCounts = m_nodeCountsMB->GetData(MEMORYDEVICE_CPU);
+  const int *nodeDepths = m_nodeDepthsMB->GetData(MEMORYDEVICE_CPU);
+  const ForestPredictorNode *nodes = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  const unsigned int *seenCounts = m_seenCountsMB->GetData(MEMORYDEVICE_CPU);
+  float *splittabilities = m_splittabilitiesMB->GetData(MEMORYDEVICE_CPU);
+  const int nodeCount = m_treeCount * m_settings.maxNodesPerTree;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+  {
+    calculate_splittability(
+      nodeIndex, nodes, nodeCounts, m_settings.maxNodesPerTree, nodeDepths, m_settings.maxTreeHeight, seenCounts, m_settings.seenExamplesThreshold,
+      histograms, classCounts, m_labelCount, m_settings.usePMFReweighting, splittabilities
+    );
+  }
+}
+
+void DeviceRandomForest_CPU::predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                                ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const
+{
+  const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  const float *leafMasses = m_leafMassesMB->GetData(MEMORYDEVICE_CPU);
+  const ForestPredictorNode *nodes = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  const int *rootIndices = m_rootIndicesMB->GetData(MEMORYDEVICE_CPU);
+  SpaintVoxel::PackedLabel *labels = labelsMB.GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int tid = 0; tid < static_cast<int>(descriptorCount); ++tid)
+  {
+    predict_label(tid, features, static_cast<int>(featureCount), nodes, rootIndices, m_treeCount, leafMasses, m_labelCount, labels);
+  }
+}
+
+void DeviceRandomForest_CPU::reset_trees()
+{
+  float *histograms = m_histogramsMB->GetData(MEMORYDEVICE_CPU);
+  int *nodeCounts = m_nodeCountsMB->GetData(MEMORYDEVICE_CPU);
+  int *nodeDepths = m_nodeDepthsMB->GetData(MEMORYDEVICE_CPU);
+  ForestPredictorNode *nodes = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *reservoirs = m_reservoirsMB->GetData(MEMORYDEVICE_CPU);
+  int *rootIndices = m_rootIndicesMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *seenCounts = m_seenCountsMB->GetData(MEMORYDEVICE_CPU);
+
+  for(int tree = 0; tree < m_treeCount; ++tree)
+  {
+    reset_tree(
+      tree, m_settings.maxNodesPerTree, m_labelCount, m_settings.reservoirSize, histograms, nodeCounts,
+      nodeDepths, nodes, reservoirs, rootIndices, seenCounts
+    );
+  }
+
+  m_classCountsMB->Clear();
+}
+
+void DeviceRandomForest_CPU::split_leaves(int splitCount, unsigned int seed)
+{
+  const unsigned int *poolExampleIDs = m_poolExampleIDsMB->GetData(MEMORYDEVICE_CPU);
+  const float *poolFeatures = m_poolFeaturesMB->GetData(MEMORYDEVICE_CPU);
+  const int *poolLabels = m_poolLabelsMB->GetData(MEMORYDEVICE_CPU);
+  const int *splitLeaves = m_splitLeavesMB->GetData(MEMORYDEVICE_CPU);
+  DeviceForestSplitCandidate *candidates = m_candidatesMB->GetData(MEMORYDEVICE_CPU);
+  const unsigned int *classCounts = m_classCountsMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *reservoirs = m_reservoirsMB->GetData(MEMORYDEVICE_CPU);
+  const int candidateCount = splitCount * m_settings.candidateCount;
+
+  // Generate and evaluate the candidate splits for all of the leaves at once.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int tid = 0; tid < candidateCount; ++tid)
+  {
+    generate_split_candidate(
+      tid, splitLeaves, m_settings.candidateCount, reservoirs, m_settings.reservoirSize, poolExampleIDs,
+      poolFeatures, m_settings.poolSize, m_featureCount, seed, candidates
+    );
+
+    evaluate_split_candidate(
+      tid, splitLeaves, m_settings.candidateCount, reservoirs, m_settings.reservoirSize, poolExampleIDs, poolFeatures, poolLabels,
+      m_settings.poolSize, m_featureCount, classCounts, m_labelCount, m_settings.usePMFReweighting, candidates
+    );
+  }
+
+  // Split each leaf using its best candidate (if that is good enough).
+  float *histograms = m_histogramsMB->GetData(MEMORYDEVICE_CPU);
+  int *nodeCounts = m_nodeCountsMB->GetData(MEMORYDEVICE_CPU);
+  int *nodeDepths = m_nodeDepthsMB->GetData(MEMORYDEVICE_CPU);
+  ForestPredictorNode *nodes = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *seenCounts = m_seenCountsMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int tid = 0; tid < splitCount; ++tid)
+  {
+    split_leaf(
+      tid, splitLeaves, candidates, m_settings.candidateCount, m_settings.gainThreshold, m_settings.maxNodesPerTree, m_labelCount,
+      m_settings.reservoirSize, poolExampleIDs, poolFeatures, poolLabels, m_settings.poolSize, m_featureCount, histograms,
+      nodeCounts, nodeDepths, nodes, reservoirs, seenCounts
+    );
+  }
+}
+
+void DeviceRandomForest_CPU::update_leaf_masses()
+{
+  const unsigned int *classCounts = m_classCountsMB->GetData(MEMORYDEVICE_CPU);
+  const float *histograms = m_histogramsMB->GetData(MEMORYDEVICE_CPU);
+  const int *nodeCounts = m_nodeCountsMB->GetData(MEMORYDEVICE_CPU);
+  const ForestPredictorNode *nodes = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  float *leafMasses = m_leafMassesMB->GetData(MEMORYDEVICE_CPU);
+  const int nodeCount = m_treeCount * m_settings.maxNodesPerTree;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+  {
+    update_leaf_pmf(
+      nodeIndex, nodes, nodeCounts, m_settings.maxNodesPerTree, histograms,
+      classCounts, m_labelCount, m_settings.usePMFReweighting, leafMasses
+    );
+  }
+}
+
+}
@@ -0,0 +1,32 @@
+/**
+ * spaint: ForestPredictor_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "randomforest/cpu/ForestPredictor_CPU.h"
+
+#include "randomforest/shared/ForestPredictor_Shared.h"
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ForestPredictor_CPU::predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                             ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const
+{
+  const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  const float *leafMasses = m_leafMassesMB->GetData(MEMORYDEVICE_CPU);
+  const ForestPredictorNode *nodes = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  const int *rootIndices = m_rootIndicesMB->GetData(MEMORYDEVICE_CPU);
+  SpaintVoxel::PackedLabel *labels = labelsMB.GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int tid = 0; tid < static_cast<int>(descriptorCount); ++tid)
+  {
+    predict_label(tid, features, static_cast<int>(featureCount), nodes, rootIndices, m_treeCount, leafMasses, m_labelCount, labels);
+  }
+}
+
+}
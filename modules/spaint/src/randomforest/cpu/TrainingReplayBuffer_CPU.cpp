@@ -0,0 +1,58 @@
+/**
+ * spaint: TrainingReplayBuffer_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/cpu/TrainingReplayBuffer_CPU.h"
+
+#include "randomforest/shared/TrainingReplayBuffer_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+TrainingReplayBuffer_CPU::TrainingReplayBuffer_CPU(size_t maxLabelCount, size_t capacityPerLabel, size_t featureCount, size_t maxRefreshCount, unsigned int seed)
+: TrainingReplayBuffer(maxLabelCount, capacityPerLabel, featureCount, maxRefreshCount, seed)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TrainingReplayBuffer_CPU::check_slots(const SpaintVoxelScene *scene) const
+{
+  const int capacityPerLabel = static_cast<int>(m_capacityPerLabel);
+  const int slotCount = static_cast<int>(m_maxLabelCount * m_capacityPerLabel);
+  const SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const Vector3s *slotLocations = m_slotLocationsMB->GetData(MEMORYDEVICE_CPU);
+  unsigned char *slotStatuses = m_slotStatusesMB->GetData(MEMORYDEVICE_CPU);
+  const unsigned int *slotVersions = m_slotVersionsMB->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int slotIndex = 0; slotIndex < slotCount; ++slotIndex)
+  {
+    check_replay_slot(slotIndex, capacityPerLabel, slotLocations, slotVersions, voxelData, labelData, indexData, blockVersions, slotStatuses);
+  }
+}
+
+void TrainingReplayBuffer_CPU::copy_feature_rows(const ORUtils::MemoryBlock<float>& srcFeaturesMB, int rowCount, ORUtils::MemoryBlock<float>& dstFeaturesMB) const
+{
+  const int featureCount = static_cast<int>(m_featureCount);
+  const int *dstRows = m_dstRowsMB->GetData(MEMORYDEVICE_CPU);
+  float *dstFeatures = dstFeaturesMB.GetData(MEMORYDEVICE_CPU);
+  const float *srcFeatures = srcFeaturesMB.GetData(MEMORYDEVICE_CPU);
+  const int *srcRows = m_srcRowsMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < rowCount * featureCount; ++i)
+  {
+    copy_feature(i, featureCount, srcFeatures, srcRows, dstRows, dstFeatures);
+  }
+}
+
+}
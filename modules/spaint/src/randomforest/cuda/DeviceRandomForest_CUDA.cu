@@ -0,0 +1,341 @@
+/**
+ * spaint: DeviceRandomForest_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/cuda/DeviceRandomForest_CUDA.h"
+
+#include "randomforest/shared/DeviceRandomForest_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_add_examples_to_trees(int threadCount, const float *features, int featureCount, const unsigned int *voxelCounts, int maxVoxelsPerLabel,
+                                         unsigned int firstExampleID, const ForestPredictorNode *nodes, const int *rootIndices, int treeCount, int labelCount,
+                                         int reservoirSize, unsigned int seed, unsigned int *classCounts, float *histograms, unsigned int *reservoirs,
+                                         unsigned int *seenCounts)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < threadCount)
+  {
+    add_example_to_tree(
+      tid, features, featureCount, voxelCounts, maxVoxelsPerLabel, firstExampleID, nodes, rootIndices, treeCount,
+      labelCount, reservoirSize, seed, classCounts, histograms, reservoirs, seenCounts
+    );
+  }
+}
+
+__global__ void ck_calculate_splittabilities(int nodeCount, const ForestPredictorNode *nodes, const int *nodeCounts, int maxNodesPerTree, const int *nodeDepths,
+                                             int maxTreeHeight, const unsigned int *seenCounts, unsigned int seenExamplesThreshold, const float *histograms,
+                                             const unsigned int *classCounts, int labelCount, bool usePMFReweighting, float *splittabilities)
+{
+  int nodeIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(nodeIndex < nodeCount)
+  {
+    calculate_splittability(
+      nodeIndex, nodes, nodeCounts, maxNodesPerTree, nodeDepths, maxTreeHeight, seenCounts, seenExamplesThreshold,
+      histograms, classCounts, labelCount, usePMFReweighting, splittabilities
+    );
+  }
+}
+
+__global__ void ck_copy_examples_to_pool(int slotCount, const float *features, int featureCount, const unsigned int *voxelCounts, int maxVoxelsPerLabel,
+                                         unsigned int firstExampleID, int poolSize, unsigned int *poolExampleIDs, float *poolFeatures, int *poolLabels)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < slotCount)
+  {
+    copy_example_to_pool(tid, features, featureCount, voxelCounts, maxVoxelsPerLabel, firstExampleID, poolSize, poolExampleIDs, poolFeatures, poolLabels);
+  }
+}
+
+__global__ void ck_evaluate_split_candidates(int threadCount, const int *splitLeaves, int candidateCount, const unsigned int *reservoirs, int reservoirSize,
+                                             const unsigned int *poolExampleIDs, const float *poolFeatures, const int *poolLabels, int poolSize, int featureCount,
+                                             const unsigned int *classCounts, int labelCount, bool usePMFReweighting, DeviceForestSplitCandidate *candidates)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < threadCount)
+  {
+    evaluate_split_candidate(
+      tid, splitLeaves, candidateCount, reservoirs, reservoirSize, poolExampleIDs, poolFeatures, poolLabels,
+      poolSize, featureCount, classCounts, labelCount, usePMFReweighting, candidates
+    );
+  }
+}
+
+__global__ void ck_generate_split_candidates(int threadCount, const int *splitLeaves, int candidateCount, const unsigned int *reservoirs, int reservoirSize,
+                                             const unsigned int *poolExampleIDs, const float *poolFeatures, int poolSize, int featureCount, unsigned int seed,
+                                             DeviceForestSplitCandidate *candidates)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < threadCount)
+  {
+    generate_split_candidate(tid, splitLeaves, candidateCount, reservoirs, reservoirSize, poolExampleIDs, poolFeatures, poolSize, featureCount, seed, candidates);
+  }
+}
+
+__global__ void ck_predict_labels(int descriptorCount, const float *features, int featureCount, const ForestPredictorNode *nodes, const int *rootIndices, int treeCount,
+                                  const float *leafMasses, int labelCount, SpaintVoxel::PackedLabel *labels)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < descriptorCount)
+  {
+    predict_label(tid, features, featureCount, nodes, rootIndices, treeCount, leafMasses, labelCount, labels);
+  }
+}
+
+__global__ void ck_reset_trees(int treeCount, int maxNodesPerTree, int labelCount, int reservoirSize, float *histograms, int *nodeCounts, int *nodeDepths,
+                               ForestPredictorNode *nodes, unsigned int *reservoirs, int *rootIndices, unsigned int *seenCounts)
+{
+  int tree = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tree < treeCount)
+  {
+    reset_tree(tree, maxNodesPerTree, labelCount, reservoirSize, histograms, nodeCounts, nodeDepths, nodes, reservoirs, rootIndices, seenCounts);
+  }
+}
+
+__global__ void ck_split_leaves(int splitCount, const int *splitLeaves, const DeviceForestSplitCandidate *candidates, int candidateCount, float gainThreshold,
+                                int maxNodesPerTree, int labelCount, int reservoirSize, const unsigned int *poolExampleIDs, const float *poolFeatures,
+                                const int *poolLabels, int poolSize, int featureCount, float *histograms, int *nodeCounts, int *nodeDepths,
+                                ForestPredictorNode *nodes, unsigned int *reservoirs, unsigned int *seenCounts)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < splitCount)
+  {
+    split_leaf(
+      tid, splitLeaves, candidates, candidateCount, gainThreshold, maxNodesPerTree, labelCount, reservoirSize, poolExampleIDs,
+      poolFeatures, poolLabels, poolSize, featureCount, histograms, nodeCounts, nodeDepths, nodes, reservoirs, seenCounts
+    );
+  }
+}
+
+__global__ void ck_update_leaf_masses(int nodeCount, const ForestPredictorNode *nodes, const int *nodeCounts, int maxNodesPerTree, const float *histograms,
+                                      const unsigned int *classCounts, int labelCount, bool usePMFReweighting, float *leafMasses)
+{
+  int nodeIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(nodeIndex < nodeCount)
+  {
+    update_leaf_pmf(nodeIndex, nodes, nodeCounts, maxNodesPerTree, histograms, classCounts, labelCount, usePMFReweighting, leafMasses);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+DeviceRandomForest_CUDA::DeviceRandomForest_CUDA(size_t treeCount, size_t labelCount, size_t featureCount, const Settings& settings)
+: DeviceRandomForest(treeCount, labelCount, featureCount, settings)
+{
+  reset();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DeviceRandomForest_CUDA::add_examples_sub(const ORUtils::MemoryBlock<float>& featuresMB, const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB,
+                                               size_t maxVoxelsPerLabel, unsigned int firstExampleID)
+{
+  const int slotCount = m_labelCount * static_cast<int>(maxVoxelsPerLabel);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (slotCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Copy the examples into the pool.
+  ck_copy_examples_to_pool<<<numBlocks,threadsPerBlock>>>(
+    slotCount,
+    featuresMB.GetData(MEMORYDEVICE_CUDA),
+    m_featureCount,
+    voxelCountsMB.GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(maxVoxelsPerLabel),
+    firstExampleID,
+    m_settings.poolSize,
+    m_poolExampleIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_poolFeaturesMB->GetData(MEMORYDEVICE_CUDA),
+    m_poolLabelsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Add the examples to the trees.
+  const int threadCount = slotCount * m_treeCount;
+  numBlocks = (threadCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_add_examples_to_trees<<<numBlocks,threadsPerBlock>>>(
+    threadCount,
+    featuresMB.GetData(MEMORYDEVICE_CUDA),
+    m_featureCount,
+    voxelCountsMB.GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(maxVoxelsPerLabel),
+    firstExampleID,
+    m_nodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_rootIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    m_treeCount,
+    m_labelCount,
+    m_settings.reservoirSize,
+    m_settings.seed,
+    m_classCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_histogramsMB->GetData(MEMORYDEVICE_CUDA),
+    m_reservoirsMB->GetData(MEMORYDEVICE_CUDA),
+    m_seenCountsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void DeviceRandomForest_CUDA::calculate_splittabilities()
+{
+  const int nodeCount = m_treeCount * m_settings.maxNodesPerTree;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (nodeCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_calculate_splittabilities<<<numBlocks,threadsPerBlock>>>(
+    nodeCount,
+    m_nodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodeCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.maxNodesPerTree,
+    m_nodeDepthsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.maxTreeHeight,
+    m_seenCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.seenExamplesThreshold,
+    m_histogramsMB->GetData(MEMORYDEVICE_CUDA),
+    m_classCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_labelCount,
+    m_settings.usePMFReweighting,
+    m_splittabilitiesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Note: Only the splittabilities and node counts are copied across to the host - the histograms and reservoirs stay on the device.
+  m_nodeCountsMB->UpdateHostFromDevice();
+  m_splittabilitiesMB->UpdateHostFromDevice();
+}
+
+void DeviceRandomForest_CUDA::predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                                 ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const
+{
+  if(descriptorCount == 0) return;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (static_cast<int>(descriptorCount) + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_predict_labels<<<numBlocks,threadsPerBlock>>>(
+    static_cast<int>(descriptorCount),
+    featuresMB.GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(featureCount),
+    m_nodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_rootIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    m_treeCount,
+    m_leafMassesMB->GetData(MEMORYDEVICE_CUDA),
+    m_labelCount,
+    labelsMB.GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void DeviceRandomForest_CUDA::reset_trees()
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (m_treeCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_reset_trees<<<numBlocks,threadsPerBlock>>>(
+    m_treeCount,
+    m_settings.maxNodesPerTree,
+    m_labelCount,
+    m_settings.reservoirSize,
+    m_histogramsMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodeCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodeDepthsMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_reservoirsMB->GetData(MEMORYDEVICE_CUDA),
+    m_rootIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    m_seenCountsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_classCountsMB->Clear();
+}
+
+void DeviceRandomForest_CUDA::split_leaves(int splitCount, unsigned int seed)
+{
+  // Upload the indices of the leaves to split.
+  m_splitLeavesMB->UpdateDeviceFromHost();
+
+  // Generate and evaluate the candidate splits for all of the leaves at once.
+  const int candidateCount = splitCount * m_settings.candidateCount;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (candidateCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_generate_split_candidates<<<numBlocks,threadsPerBlock>>>(
+    candidateCount,
+    m_splitLeavesMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.candidateCount,
+    m_reservoirsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.reservoirSize,
+    m_poolExampleIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_poolFeaturesMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.poolSize,
+    m_featureCount,
+    seed,
+    m_candidatesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  ck_evaluate_split_candidates<<<numBlocks,threadsPerBlock>>>(
+    candidateCount,
+    m_splitLeavesMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.candidateCount,
+    m_reservoirsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.reservoirSize,
+    m_poolExampleIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_poolFeaturesMB->GetData(MEMORYDEVICE_CUDA),
+    m_poolLabelsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.poolSize,
+    m_featureCount,
+    m_classCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_labelCount,
+    m_settings.usePMFReweighting,
+    m_candidatesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Split each leaf using its best candidate (if that is good enough).
+  numBlocks = (splitCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_split_leaves<<<numBlocks,threadsPerBlock>>>(
+    splitCount,
+    m_splitLeavesMB->GetData(MEMORYDEVICE_CUDA),
+    m_candidatesMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.candidateCount,
+    m_settings.gainThreshold,
+    m_settings.maxNodesPerTree,
+    m_labelCount,
+    m_settings.reservoirSize,
+    m_poolExampleIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_poolFeaturesMB->GetData(MEMORYDEVICE_CUDA),
+    m_poolLabelsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.poolSize,
+    m_featureCount,
+    m_histogramsMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodeCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodeDepthsMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_reservoirsMB->GetData(MEMORYDEVICE_CUDA),
+    m_seenCountsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Copy the new node counts across to the host, so that the caller can tell how many leaves were split.
+  m_nodeCountsMB->UpdateHostFromDevice();
+}
+
+void DeviceRandomForest_CUDA::update_leaf_masses()
+{
+  const int nodeCount = m_treeCount * m_settings.maxNodesPerTree;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (nodeCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_update_leaf_masses<<<numBlocks,threadsPerBlock>>>(
+    nodeCount,
+    m_nodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_nodeCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_settings.maxNodesPerTree,
+    m_histogramsMB->GetData(MEMORYDEVICE_CUDA),
+    m_classCountsMB->GetData(MEMORYDEVICE_CUDA),
+    m_labelCount,
+    m_settings.usePMFReweighting,
+    m_leafMassesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
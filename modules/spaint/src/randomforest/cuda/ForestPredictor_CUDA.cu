@@ -0,0 +1,47 @@
+/**
+ * spaint: ForestPredictor_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "randomforest/cuda/ForestPredictor_CUDA.h"
+
+#include "randomforest/shared/ForestPredictor_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_predict_labels(int descriptorCount, const float *features, int featureCount, const ForestPredictorNode *nodes, const int *rootIndices, int treeCount,
+                                  const float *leafMasses, int labelCount, SpaintVoxel::PackedLabel *labels)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < descriptorCount)
+  {
+    predict_label(tid, features, featureCount, nodes, rootIndices, treeCount, leafMasses, labelCount, labels);
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ForestPredictor_CUDA::predict_labels_sub(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                              ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const
+{
+  if(descriptorCount == 0) return;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (static_cast<int>(descriptorCount) + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_predict_labels<<<numBlocks,threadsPerBlock>>>(
+    static_cast<int>(descriptorCount),
+    featuresMB.GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(featureCount),
+    m_nodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_rootIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    m_treeCount,
+    m_leafMassesMB->GetData(MEMORYDEVICE_CUDA),
+    m_labelCount,
+    labelsMB.GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,79 @@
+/**
+ * spaint: TrainingReplayBuffer_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/cuda/TrainingReplayBuffer_CUDA.h"
+
+#include "randomforest/shared/TrainingReplayBuffer_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_check_replay_slots(int slotCount, int capacityPerLabel, const Vector3s *slotLocations, const unsigned int *slotVersions,
+                                      const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                                      const SpaintVoxelScene::BlockVersions *blockVersions, unsigned char *slotStatuses)
+{
+  int slotIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(slotIndex < slotCount)
+  {
+    check_replay_slot(slotIndex, capacityPerLabel, slotLocations, slotVersions, voxelData, labelData, indexData, blockVersions, slotStatuses);
+  }
+}
+
+__global__ void ck_copy_feature_rows(int elementCount, int featureCount, const float *srcFeatures, const int *srcRows, const int *dstRows, float *dstFeatures)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < elementCount) copy_feature(i, featureCount, srcFeatures, srcRows, dstRows, dstFeatures);
+}
+
+//#################### CONSTRUCTORS ####################
+
+TrainingReplayBuffer_CUDA::TrainingReplayBuffer_CUDA(size_t maxLabelCount, size_t capacityPerLabel, size_t featureCount, size_t maxRefreshCount, unsigned int seed)
+: TrainingReplayBuffer(maxLabelCount, capacityPerLabel, featureCount, maxRefreshCount, seed)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TrainingReplayBuffer_CUDA::check_slots(const SpaintVoxelScene *scene) const
+{
+  const int slotCount = static_cast<int>(m_maxLabelCount * m_capacityPerLabel);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (slotCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_check_replay_slots<<<numBlocks,threadsPerBlock>>>(
+    slotCount,
+    static_cast<int>(m_capacityPerLabel),
+    m_slotLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    m_slotVersionsMB->GetData(MEMORYDEVICE_CUDA),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->index.getIndexData(),
+    scene->get_block_versions(),
+    m_slotStatusesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_slotStatusesMB->UpdateHostFromDevice();
+}
+
+void TrainingReplayBuffer_CUDA::copy_feature_rows(const ORUtils::MemoryBlock<float>& srcFeaturesMB, int rowCount, ORUtils::MemoryBlock<float>& dstFeaturesMB) const
+{
+  const int featureCount = static_cast<int>(m_featureCount);
+  const int elementCount = rowCount * featureCount;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (elementCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_copy_feature_rows<<<numBlocks,threadsPerBlock>>>(
+    elementCount,
+    featureCount,
+    srcFeaturesMB.GetData(MEMORYDEVICE_CUDA),
+    m_srcRowsMB->GetData(MEMORYDEVICE_CUDA),
+    m_dstRowsMB->GetData(MEMORYDEVICE_CUDA),
+    dstFeaturesMB.GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,198 @@
+/**
+ * spaint: DeviceRandomForest.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/interface/DeviceRandomForest.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+DeviceRandomForest::Settings::Settings()
+: candidateCount(128),
+  gainThreshold(0.0f),
+  maxNodesPerTree(4096),
+  maxTreeHeight(20),
+  poolSize(16384),
+  reservoirSize(256),
+  seed(1234),
+  seenExamplesThreshold(512),
+  splittabilityThreshold(0.5f),
+  usePMFReweighting(true)
+{}
+
+DeviceRandomForest::DeviceRandomForest(size_t treeCount, size_t labelCount, size_t featureCount, const Settings& settings)
+: m_featureCount(static_cast<int>(featureCount)),
+  m_labelCount(static_cast<int>(labelCount)),
+  m_settings(settings),
+  m_treeCount(static_cast<int>(treeCount)),
+  m_exampleCount(0),
+  m_nextExampleID(1),
+  m_trainingStepCount(0)
+{
+  if(treeCount == 0 || treeCount > FORESTPREDICTOR_MAX_TREE_COUNT)
+  {
+    throw std::invalid_argument("Error: A device random forest must have between 1 and FORESTPREDICTOR_MAX_TREE_COUNT trees");
+  }
+
+  if(labelCount == 0 || labelCount > DEVICEFOREST_MAX_LABEL_COUNT)
+  {
+    throw std::invalid_argument("Error: A device random forest must have between 1 and DEVICEFOREST_MAX_LABEL_COUNT labels");
+  }
+
+  if(featureCount == 0) throw std::invalid_argument("Error: The descriptors of a device random forest must have at least one feature");
+
+  if(settings.candidateCount <= 0 || settings.maxNodesPerTree <= 0 || settings.poolSize <= 0 || settings.reservoirSize <= 0)
+  {
+    throw std::invalid_argument("Error: The candidate count, maximum nodes per tree, pool size and reservoir size of a device random forest must all be positive");
+  }
+
+  if(settings.splittabilityThreshold <= 0.0f) throw std::invalid_argument("Error: The splittability threshold of a device random forest must be positive");
+
+  // Allocate the memory blocks. The ones used to split leaves are allocated on demand, since their sizes depend on the split budget.
+  const size_t nodeCount = treeCount * settings.maxNodesPerTree;
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_classCountsMB = mbf.make_block<unsigned int>(labelCount, "DeviceRandomForest");
+  m_histogramsMB = mbf.make_block<float>(nodeCount * labelCount, "DeviceRandomForest");
+  m_leafMassesMB = mbf.make_block<float>(nodeCount * labelCount, "DeviceRandomForest");
+  m_nodeCountsMB = mbf.make_block<int>(treeCount, "DeviceRandomForest");
+  m_nodeDepthsMB = mbf.make_block<int>(nodeCount, "DeviceRandomForest");
+  m_nodesMB = mbf.make_block<ForestPredictorNode>(nodeCount, "DeviceRandomForest");
+  m_poolExampleIDsMB = mbf.make_block<unsigned int>(settings.poolSize, "DeviceRandomForest");
+  m_poolFeaturesMB = mbf.make_block<float>(settings.poolSize * featureCount, "DeviceRandomForest");
+  m_poolLabelsMB = mbf.make_block<int>(settings.poolSize, "DeviceRandomForest");
+  m_reservoirsMB = mbf.make_block<unsigned int>(nodeCount * settings.reservoirSize, "DeviceRandomForest");
+  m_rootIndicesMB = mbf.make_block<int>(treeCount, "DeviceRandomForest");
+  m_seenCountsMB = mbf.make_block<unsigned int>(nodeCount, "DeviceRandomForest");
+  m_splittabilitiesMB = mbf.make_block<float>(nodeCount, "DeviceRandomForest");
+
+  // Note: The pool is only cleared here, and not when the forest is reset, since example IDs are never reused.
+  m_poolExampleIDsMB->Clear();
+}
+
+//#################### DESTRUCTOR ####################
+
+DeviceRandomForest::~DeviceRandomForest() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void DeviceRandomForest::add_examples(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB,
+                                      size_t maxVoxelsPerLabel)
+{
+  if(featureCount != static_cast<size_t>(m_featureCount)) throw std::invalid_argument("Error: The descriptors are the wrong size for the device random forest");
+
+  const size_t slotCount = m_labelCount * maxVoxelsPerLabel;
+  if(voxelCountsMB.dataSize < static_cast<size_t>(m_labelCount) || featuresMB.dataSize < slotCount * featureCount)
+  {
+    throw std::invalid_argument("Error: The memory blocks are too small for the specified number of examples");
+  }
+
+  if(slotCount > static_cast<size_t>(m_settings.poolSize))
+  {
+    throw std::invalid_argument("Error: The example pool of the device random forest is too small to hold all of the example slots");
+  }
+
+  // If no examples were actually provided, early out.
+  const unsigned int *voxelCounts = voxelCountsMB.GetData(MEMORYDEVICE_CPU);
+  size_t exampleCount = 0;
+  for(int k = 0; k < m_labelCount; ++k) exampleCount += std::min<size_t>(voxelCounts[k], maxVoxelsPerLabel);
+  if(exampleCount == 0) return;
+
+  add_examples_sub(featuresMB, voxelCountsMB, maxVoxelsPerLabel, m_nextExampleID);
+
+  m_exampleCount += exampleCount;
+  m_nextExampleID += static_cast<unsigned int>(slotCount);
+}
+
+bool DeviceRandomForest::has_examples() const
+{
+  return m_exampleCount > 0;
+}
+
+void DeviceRandomForest::predict_labels(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                        ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const
+{
+  if(featureCount < static_cast<size_t>(m_featureCount)) throw std::invalid_argument("Error: The descriptors are too small to be evaluated by the forest");
+  if(featuresMB.dataSize < featureCount * descriptorCount || labelsMB.dataSize < descriptorCount)
+  {
+    throw std::invalid_argument("Error: The memory blocks are too small for the specified number of descriptors");
+  }
+
+  predict_labels_sub(featuresMB, featureCount, descriptorCount, labelsMB);
+}
+
+void DeviceRandomForest::reset()
+{
+  reset_trees();
+  m_leafMassesMB->Clear();
+  m_exampleCount = 0;
+}
+
+size_t DeviceRandomForest::train(size_t splitBudget)
+{
+  ++m_trainingStepCount;
+
+  // Calculate the splittabilities of the nodes, and find all of the leaves that are splittable enough, most splittable first.
+  calculate_splittabilities();
+
+  const int nodeCount = m_treeCount * m_settings.maxNodesPerTree;
+  const float *splittabilities = m_splittabilitiesMB->GetData(MEMORYDEVICE_CPU);
+  std::vector<std::pair<float,int> > splittableLeaves;
+  for(int i = 0; i < nodeCount; ++i)
+  {
+    if(splittabilities[i] >= m_settings.splittabilityThreshold) splittableLeaves.push_back(std::make_pair(splittabilities[i], i));
+  }
+
+  std::sort(splittableLeaves.begin(), splittableLeaves.end(), std::greater<std::pair<float,int> >());
+
+  // Choose the leaves to split, skipping any whose trees do not have room for two more nodes.
+  const int *nodeCounts = m_nodeCountsMB->GetData(MEMORYDEVICE_CPU);
+  const std::vector<int> oldNodeCounts(nodeCounts, nodeCounts + m_treeCount);
+  std::vector<int> freeNodeCounts(m_treeCount);
+  for(int t = 0; t < m_treeCount; ++t) freeNodeCounts[t] = m_settings.maxNodesPerTree - nodeCounts[t];
+
+  const size_t splitCapacity = std::max<size_t>(splitBudget, 1);
+  if(!m_splitLeavesMB || m_splitLeavesMB->dataSize < splitCapacity)
+  {
+    MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+    m_candidatesMB = mbf.make_block<DeviceForestSplitCandidate>(splitCapacity * m_settings.candidateCount, "DeviceRandomForest");
+    m_splitLeavesMB = mbf.make_block<int>(splitCapacity, "DeviceRandomForest");
+  }
+
+  int splitCount = 0;
+  int *splitLeaves = m_splitLeavesMB->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0, size = splittableLeaves.size(); i < size && static_cast<size_t>(splitCount) < splitBudget; ++i)
+  {
+    const int leafIndex = splittableLeaves[i].second;
+    int& freeNodeCount = freeNodeCounts[leafIndex / m_settings.maxNodesPerTree];
+    if(freeNodeCount >= 2)
+    {
+      splitLeaves[splitCount++] = leafIndex;
+      freeNodeCount -= 2;
+    }
+  }
+
+  // Try to split the chosen leaves, and count the number that were actually split.
+  size_t nodesSplit = 0;
+  if(splitCount > 0)
+  {
+    split_leaves(splitCount, m_settings.seed ^ (m_trainingStepCount * 0x9E3779B9u));
+    for(int t = 0; t < m_treeCount; ++t) nodesSplit += (nodeCounts[t] - oldNodeCounts[t]) / 2;
+  }
+
+  // Update the leaf PMFs, which will have changed if any examples were added or any leaves were split.
+  update_leaf_masses();
+
+  return nodesSplit;
+}
+
+}
@@ -0,0 +1,89 @@
+/**
+ * spaint: ForestPredictor.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "randomforest/interface/ForestPredictor.h"
+
+#include <algorithm>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ForestPredictor::ForestPredictor()
+: m_labelCount(0), m_minDescriptorSize(0), m_treeCount(0)
+{}
+
+//#################### DESTRUCTOR ####################
+
+ForestPredictor::~ForestPredictor() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+bool ForestPredictor::has_forest() const
+{
+  return m_treeCount > 0;
+}
+
+void ForestPredictor::predict_labels(const ORUtils::MemoryBlock<float>& featuresMB, size_t featureCount, size_t descriptorCount,
+                                     ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& labelsMB) const
+{
+  if(!has_forest()) throw std::runtime_error("Error: Cannot predict labels before a forest has been uploaded to the predictor");
+  if(featureCount < m_minDescriptorSize) throw std::invalid_argument("Error: The descriptors are too small to be evaluated by the forest");
+  if(featuresMB.dataSize < featureCount * descriptorCount || labelsMB.dataSize < descriptorCount)
+  {
+    throw std::invalid_argument("Error: The memory blocks are too small for the specified number of descriptors");
+  }
+
+  predict_labels_sub(featuresMB, featureCount, descriptorCount, labelsMB);
+}
+
+void ForestPredictor::update_forest(const CompiledForest& forest)
+{
+  const std::vector<CompiledForest::Node>& nodes = forest.get_nodes();
+  const std::vector<float>& leafMasses = forest.get_leaf_masses();
+  const std::vector<int>& rootIndices = forest.get_root_indices();
+
+  if(rootIndices.size() > FORESTPREDICTOR_MAX_TREE_COUNT)
+  {
+    throw std::runtime_error("Error: The forest predictor cannot handle forests with more than FORESTPREDICTOR_MAX_TREE_COUNT trees");
+  }
+
+  // Make sure that the memory blocks are large enough to hold the forest. Since the forest
+  // generally only grows during training, we only reallocate them when strictly necessary.
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  if(!m_leafMassesMB || m_leafMassesMB->dataSize < leafMasses.size()) m_leafMassesMB = mbf.make_block<float>(leafMasses.size(), "ForestPredictor");
+  if(!m_nodesMB || m_nodesMB->dataSize < nodes.size()) m_nodesMB = mbf.make_block<ForestPredictorNode>(nodes.size(), "ForestPredictor");
+  if(!m_rootIndicesMB) m_rootIndicesMB = mbf.make_block<int>(FORESTPREDICTOR_MAX_TREE_COUNT, "ForestPredictor");
+
+  // Copy the forest into the memory blocks.
+  std::copy(leafMasses.begin(), leafMasses.end(), m_leafMassesMB->GetData(MEMORYDEVICE_CPU));
+  std::copy(rootIndices.begin(), rootIndices.end(), m_rootIndicesMB->GetData(MEMORYDEVICE_CPU));
+
+  ForestPredictorNode *dest = m_nodesMB->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0, size = nodes.size(); i < size; ++i)
+  {
+    const CompiledForest::Node& node = nodes[i];
+    dest[i].firstFeatureIndex = static_cast<int>(node.splitter.firstFeatureIndex);
+    dest[i].leafIndex = node.leafIndex;
+    dest[i].leftChildIndex = node.leftChildIndex;
+    dest[i].op = node.splitter.op;
+    dest[i].rightChildIndex = node.rightChildIndex;
+    dest[i].secondFeatureIndex = static_cast<int>(node.splitter.secondFeatureIndex);
+    dest[i].threshold = node.splitter.threshold;
+  }
+
+  m_leafMassesMB->UpdateDeviceFromHost();
+  m_nodesMB->UpdateDeviceFromHost();
+  m_rootIndicesMB->UpdateDeviceFromHost();
+
+  m_labelCount = static_cast<int>(forest.get_label_count());
+  m_minDescriptorSize = forest.get_min_descriptor_size();
+  m_treeCount = static_cast<int>(rootIndices.size());
+}
+
+}
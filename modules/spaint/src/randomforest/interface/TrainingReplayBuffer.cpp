@@ -0,0 +1,255 @@
+/**
+ * spaint: TrainingReplayBuffer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "randomforest/interface/TrainingReplayBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+TrainingReplayBuffer::TrainingReplayBuffer(size_t maxLabelCount, size_t capacityPerLabel, size_t featureCount, size_t maxRefreshCount, unsigned int seed)
+: m_capacityPerLabel(capacityPerLabel),
+  m_featureCount(featureCount),
+  m_maxLabelCount(maxLabelCount),
+  m_maxRefreshCount(std::min(maxRefreshCount, maxLabelCount * capacityPerLabel)),
+  m_rng(new tvgutil::RandomNumberGenerator(seed)),
+  m_sceneResetVersion(0),
+  m_slotCounts(maxLabelCount, 0)
+{
+  if(capacityPerLabel == 0) throw std::invalid_argument("Error: A training replay buffer must have at least one slot per label");
+  if(maxRefreshCount == 0) throw std::invalid_argument("Error: A training replay buffer must be able to refresh at least one descriptor at a time");
+
+  // Note: No more rows than there are slots are ever copied at once.
+  const size_t slotCount = maxLabelCount * capacityPerLabel;
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_dstRowsMB = mbf.make_block<int>(slotCount, "TrainingReplayBuffer");
+  m_featuresMB = mbf.make_block<float>(slotCount * featureCount, "TrainingReplayBuffer");
+  m_refreshFeaturesMB = mbf.make_block<float>(m_maxRefreshCount * featureCount, "TrainingReplayBuffer");
+  m_refreshLocationsMB = mbf.make_block<Vector3s>(m_maxRefreshCount, "TrainingReplayBuffer");
+  m_slotLocationsMB = mbf.make_block<Vector3s>(slotCount, "TrainingReplayBuffer");
+  m_slotStatusesMB = mbf.make_block<unsigned char>(slotCount, "TrainingReplayBuffer");
+  m_slotVersionsMB = mbf.make_block<unsigned int>(slotCount, "TrainingReplayBuffer");
+  m_srcRowsMB = mbf.make_block<int>(slotCount, "TrainingReplayBuffer");
+
+  m_slotLocationsMB->Clear();
+  m_slotVersionsMB->Clear();
+}
+
+//#################### DESTRUCTOR ####################
+
+TrainingReplayBuffer::~TrainingReplayBuffer() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void TrainingReplayBuffer::draw(const ORUtils::MemoryBlock<bool>& labelMaskMB, size_t maxVoxelsPerLabel, ORUtils::MemoryBlock<float>& featuresMB,
+                                ORUtils::MemoryBlock<unsigned int>& voxelCountsMB)
+{
+  const bool *labelMask = labelMaskMB.GetData(MEMORYDEVICE_CPU);
+  unsigned int *voxelCounts = voxelCountsMB.GetData(MEMORYDEVICE_CPU);
+  int *dstRows = m_dstRowsMB->GetData(MEMORYDEVICE_CPU);
+  int *srcRows = m_srcRowsMB->GetData(MEMORYDEVICE_CPU);
+
+  // For each label that is in use, draw as many distinct slots as we can (up to the maximum), so that each label is as well represented as possible.
+  int rowCount = 0;
+  std::vector<int> order;
+  for(size_t k = 0; k < m_maxLabelCount; ++k)
+  {
+    const size_t drawCount = labelMask[k] ? std::min(m_slotCounts[k], maxVoxelsPerLabel) : 0;
+    choose_without_replacement(m_slotCounts[k], drawCount, order);
+
+    for(size_t i = 0; i < drawCount; ++i, ++rowCount)
+    {
+      srcRows[rowCount] = static_cast<int>(k * m_capacityPerLabel + order[i]);
+      dstRows[rowCount] = static_cast<int>(k * maxVoxelsPerLabel + i);
+    }
+
+    voxelCounts[k] = static_cast<unsigned int>(drawCount);
+  }
+  voxelCountsMB.UpdateDeviceFromHost();
+
+  copy_rows(*m_featuresMB, rowCount, featuresMB);
+}
+
+size_t TrainingReplayBuffer::get_slot_count(SpaintVoxel::Label label) const
+{
+  return label < m_maxLabelCount ? m_slotCounts[label] : 0;
+}
+
+void TrainingReplayBuffer::insert(const ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, const ORUtils::MemoryBlock<float>& featuresMB,
+                                  const ORUtils::MemoryBlock<unsigned int>& voxelCountsMB, size_t maxVoxelsPerLabel, const SpaintVoxelScene *scene)
+{
+  voxelLocationsMB.UpdateHostFromDevice();
+
+  const unsigned int *voxelCounts = voxelCountsMB.GetData(MEMORYDEVICE_CPU);
+  const Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+  int *dstRows = m_dstRowsMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *slotLocations = m_slotLocationsMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *slotVersions = m_slotVersionsMB->GetData(MEMORYDEVICE_CPU);
+  int *srcRows = m_srcRowsMB->GetData(MEMORYDEVICE_CPU);
+  const unsigned int version = scene->get_version();
+
+  int rowCount = 0;
+  std::vector<int> order;
+  for(size_t k = 0; k < m_maxLabelCount; ++k)
+  {
+    // Put as many of the new examples for the label as possible into the unoccupied slots, and let the rest replace
+    // distinct, randomly-chosen occupied slots (so that no slot is written more than once).
+    const size_t newCount = std::min(static_cast<size_t>(voxelCounts[k]), m_capacityPerLabel);
+    const size_t oldCount = m_slotCounts[k];
+    const size_t freeCount = m_capacityPerLabel - oldCount;
+    const size_t replacedCount = newCount > freeCount ? newCount - freeCount : 0;
+    choose_without_replacement(oldCount, replacedCount, order);
+
+    for(size_t i = 0; i < newCount; ++i, ++rowCount)
+    {
+      const size_t slot = i < freeCount ? m_slotCounts[k]++ : order[i - freeCount];
+      const size_t src = k * maxVoxelsPerLabel + i, dst = k * m_capacityPerLabel + slot;
+      slotLocations[dst] = voxelLocations[src];
+      slotVersions[dst] = version;
+      srcRows[rowCount] = static_cast<int>(src);
+      dstRows[rowCount] = static_cast<int>(dst);
+    }
+  }
+
+  copy_rows(featuresMB, rowCount, *m_featuresMB);
+}
+
+void TrainingReplayBuffer::refresh(const SpaintVoxelScene *scene, const FeatureCalculator& featureCalculator)
+{
+  // If the scene has been reset since the buffer was last refreshed, none of the voxels in the buffer exist any more.
+  if(scene->get_reset_version() != m_sceneResetVersion)
+  {
+    reset();
+    m_sceneResetVersion = scene->get_reset_version();
+    return;
+  }
+
+  // If the buffer is empty, early out.
+  size_t totalSlotCount = 0;
+  for(size_t k = 0; k < m_maxLabelCount; ++k) totalSlotCount += m_slotCounts[k];
+  if(totalSlotCount == 0) return;
+
+  // Check the status of every slot on the device.
+  m_slotLocationsMB->UpdateDeviceFromHost();
+  m_slotVersionsMB->UpdateDeviceFromHost();
+  check_slots(scene);
+
+  int *dstRows = m_dstRowsMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *slotLocations = m_slotLocationsMB->GetData(MEMORYDEVICE_CPU);
+  unsigned char *slotStatuses = m_slotStatusesMB->GetData(MEMORYDEVICE_CPU);
+  unsigned int *slotVersions = m_slotVersionsMB->GetData(MEMORYDEVICE_CPU);
+  int *srcRows = m_srcRowsMB->GetData(MEMORYDEVICE_CPU);
+
+  // Evict the slots that are no longer valid by moving slots from the end of each label's group into their places. We first work out
+  // where each remaining slot comes from, so that the descriptors can then be moved in a single pass: since each slot that is moved
+  // comes from beyond the end of the compacted group, no descriptor is ever both moved and overwritten.
+  int rowCount = 0;
+  std::vector<size_t> origins(m_capacityPerLabel);
+  for(size_t k = 0; k < m_maxLabelCount; ++k)
+  {
+    const size_t base = k * m_capacityPerLabel;
+    size_t& slotCount = m_slotCounts[k];
+    for(size_t i = 0; i < slotCount; ++i) origins[i] = i;
+
+    for(size_t i = 0; i < slotCount;)
+    {
+      if(slotStatuses[base + origins[i]] == SLOT_EVICTED) origins[i] = origins[--slotCount];
+      else ++i;
+    }
+
+    for(size_t i = 0; i < slotCount; ++i)
+    {
+      if(origins[i] == i) continue;
+
+      const size_t src = base + origins[i], dst = base + i;
+      slotLocations[dst] = slotLocations[src];
+      slotStatuses[dst] = slotStatuses[src];
+      slotVersions[dst] = slotVersions[src];
+      srcRows[rowCount] = static_cast<int>(src);
+      dstRows[rowCount] = static_cast<int>(dst);
+      ++rowCount;
+    }
+  }
+
+  copy_rows(*m_featuresMB, rowCount, *m_featuresMB);
+
+  // Find the stale slots. If there are more of them than we can refresh at once, refresh the ones whose descriptors are oldest.
+  std::vector<std::pair<unsigned int,int> > staleSlots;
+  for(size_t k = 0; k < m_maxLabelCount; ++k)
+  {
+    for(size_t i = 0; i < m_slotCounts[k]; ++i)
+    {
+      const int slot = static_cast<int>(k * m_capacityPerLabel + i);
+      if(slotStatuses[slot] == SLOT_STALE) staleSlots.push_back(std::make_pair(slotVersions[slot], slot));
+    }
+  }
+
+  if(staleSlots.empty()) return;
+
+  if(staleSlots.size() > m_maxRefreshCount)
+  {
+    std::nth_element(staleSlots.begin(), staleSlots.begin() + m_maxRefreshCount, staleSlots.end());
+    staleSlots.resize(m_maxRefreshCount);
+  }
+
+  // Recalculate the descriptors of the chosen slots, and copy them into the buffer.
+  const int refreshCount = static_cast<int>(staleSlots.size());
+  const unsigned int version = scene->get_version();
+  Vector3s *refreshLocations = m_refreshLocationsMB->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0; i < refreshCount; ++i)
+  {
+    const int slot = staleSlots[i].second;
+    refreshLocations[i] = slotLocations[slot];
+    slotVersions[slot] = version;
+    srcRows[i] = i;
+    dstRows[i] = slot;
+  }
+
+  // Note: The feature calculator calculates descriptors for every location in the memory block it is given, so we temporarily shrink it.
+  m_refreshLocationsMB->dataSize = refreshCount;
+  m_refreshLocationsMB->UpdateDeviceFromHost();
+  featureCalculator.calculate_features(*m_refreshLocationsMB, scene, *m_refreshFeaturesMB);
+  m_refreshLocationsMB->dataSize = m_maxRefreshCount;
+
+  copy_rows(*m_refreshFeaturesMB, refreshCount, *m_featuresMB);
+}
+
+void TrainingReplayBuffer::reset()
+{
+  std::fill(m_slotCounts.begin(), m_slotCounts.end(), 0);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TrainingReplayBuffer::choose_without_replacement(size_t n, size_t k, std::vector<int>& order) const
+{
+  order.resize(n);
+  for(size_t i = 0; i < n; ++i) order[i] = static_cast<int>(i);
+
+  for(size_t i = 0; i < k; ++i)
+  {
+    const int j = m_rng->generate_int_from_uniform(static_cast<int>(i), static_cast<int>(n) - 1);
+    std::swap(order[i], order[j]);
+  }
+}
+
+void TrainingReplayBuffer::copy_rows(const ORUtils::MemoryBlock<float>& srcFeaturesMB, int rowCount, ORUtils::MemoryBlock<float>& dstFeaturesMB)
+{
+  if(rowCount == 0) return;
+
+  m_dstRowsMB->UpdateDeviceFromHost();
+  m_srcRowsMB->UpdateDeviceFromHost();
+  copy_feature_rows(srcFeaturesMB, rowCount, dstFeaturesMB);
+}
+
+}
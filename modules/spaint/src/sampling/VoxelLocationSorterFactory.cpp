@@ -0,0 +1,40 @@
+/**
+ * spaint: VoxelLocationSorterFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/VoxelLocationSorterFactory.h"
+using namespace ITMLib;
+
+#include "sampling/cpu/VoxelLocationSorter_CPU.h"
+
+#ifdef WITH_CUDA
+#include "sampling/cuda/VoxelLocationSorter_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+VoxelLocationSorter_Ptr VoxelLocationSorterFactory::make_voxel_location_sorter(size_t maxVoxelCount, ITMLibSettings::DeviceType deviceType)
+{
+  VoxelLocationSorter_Ptr sorter;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    sorter.reset(new VoxelLocationSorter_CUDA(maxVoxelCount));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    sorter.reset(new VoxelLocationSorter_CPU(maxVoxelCount));
+  }
+
+  return sorter;
+}
+
+}
@@ -7,11 +7,17 @@
 using namespace ITMLib;
 
 #include "sampling/cpu/PerLabelVoxelSampler_CPU.h"
+#include "sampling/cpu/StratifiedVoxelSampler_CPU.h"
+#include "sampling/cpu/SweepingVoxelSampler_CPU.h"
 #include "sampling/cpu/UniformVoxelSampler_CPU.h"
+#include "sampling/cpu/VisibleBlockVoxelSampler_CPU.h"
 
 #ifdef WITH_CUDA
 #include "sampling/cuda/PerLabelVoxelSampler_CUDA.h"
+#include "sampling/cuda/StratifiedVoxelSampler_CUDA.h"
+#include "sampling/cuda/SweepingVoxelSampler_CUDA.h"
 #include "sampling/cuda/UniformVoxelSampler_CUDA.h"
+#include "sampling/cuda/VisibleBlockVoxelSampler_CUDA.h"
 #endif
 
 namespace spaint {
@@ -40,6 +46,49 @@ PerLabelVoxelSampler_CPtr VoxelSamplerFactory::make_per_label_sampler(size_t max
   return sampler;
 }
 
+StratifiedVoxelSampler_CPtr VoxelSamplerFactory::make_stratified_sampler(const Vector2i& raycastResultDims, size_t maxVoxelCount, int tileSize, int candidatesPerSample,
+                                                                        unsigned int seed, ITMLibSettings::DeviceType deviceType)
+{
+  StratifiedVoxelSampler_CPtr sampler;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    sampler.reset(new StratifiedVoxelSampler_CUDA(raycastResultDims, maxVoxelCount, tileSize, candidatesPerSample, seed));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU to false if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    sampler.reset(new StratifiedVoxelSampler_CPU(raycastResultDims, maxVoxelCount, tileSize, candidatesPerSample, seed));
+  }
+
+  return sampler;
+}
+
+SweepingVoxelSampler_Ptr VoxelSamplerFactory::make_sweeping_sampler(size_t maxVoxelCount, int voxelsPerBlock, float maxSDF, ITMLibSettings::DeviceType deviceType)
+{
+  SweepingVoxelSampler_Ptr sampler;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    sampler.reset(new SweepingVoxelSampler_CUDA(maxVoxelCount, voxelsPerBlock, maxSDF));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU to false if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    sampler.reset(new SweepingVoxelSampler_CPU(maxVoxelCount, voxelsPerBlock, maxSDF));
+  }
+
+  return sampler;
+}
+
 UniformVoxelSampler_CPtr VoxelSamplerFactory::make_uniform_sampler(int raycastResultSize, unsigned int seed, ITMLibSettings::DeviceType deviceType)
 {
   UniformVoxelSampler_CPtr sampler;
@@ -61,4 +110,27 @@ UniformVoxelSampler_CPtr VoxelSamplerFactory::make_uniform_sampler(int raycastRe
   return sampler;
 }
 
+
+VisibleBlockVoxelSampler_CPtr VoxelSamplerFactory::make_visible_block_sampler(size_t maxLabelCount, size_t maxVoxelsPerLabel, size_t maxCandidatesPerLabel,
+                                                                              int voxelsPerBlock, float maxSDF, unsigned int seed,
+                                                                              ITMLibSettings::DeviceType deviceType)
+{
+  VisibleBlockVoxelSampler_CPtr sampler;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    sampler.reset(new VisibleBlockVoxelSampler_CUDA(maxLabelCount, maxVoxelsPerLabel, maxCandidatesPerLabel, voxelsPerBlock, maxSDF, seed));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU to false if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    sampler.reset(new VisibleBlockVoxelSampler_CPU(maxLabelCount, maxVoxelsPerLabel, maxCandidatesPerLabel, voxelsPerBlock, maxSDF, seed));
+  }
+
+  return sampler;
+}
 }
@@ -42,6 +42,7 @@ void PerLabelVoxelSampler_CPU::calculate_voxel_mask_prefix_sums(const ORUtils::M
 
 void PerLabelVoxelSampler_CPU::calculate_voxel_masks(const ITMFloat4Image *raycastResult,
                                                      const SpaintVoxel *voxelData,
+                                                     const SpaintVoxel::PackedLabel *labelData,
                                                      const ITMVoxelIndex::IndexData *indexData) const
 {
   const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
@@ -58,6 +59,7 @@ void PerLabelVoxelSampler_CPU::calculate_voxel_masks(const ITMFloat4Image *rayca
       raycastResultData,
       m_raycastResultSize,
       voxelData,
+      labelData,
       indexData,
       m_maxLabelCount,
       voxelMasks
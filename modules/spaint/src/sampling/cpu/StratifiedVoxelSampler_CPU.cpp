@@ -0,0 +1,37 @@
+/**
+ * spaint: StratifiedVoxelSampler_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cpu/StratifiedVoxelSampler_CPU.h"
+
+#include "sampling/shared/StratifiedVoxelSampler_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+StratifiedVoxelSampler_CPU::StratifiedVoxelSampler_CPU(const Vector2i& raycastResultDims, size_t maxVoxelCount, int tileSize, int candidatesPerSample, unsigned int seed)
+: StratifiedVoxelSampler(raycastResultDims, maxVoxelCount, tileSize, candidatesPerSample, seed)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void StratifiedVoxelSampler_CPU::write_sampled_voxel_locations(const ITMFloat4Image *raycastResult, const SpaintVoxel *voxelData,
+                                                               const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                                                               size_t sampledVoxelCount, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const
+{
+  const int *candidateVoxelIndices = m_candidateVoxelIndicesMB->GetData(MEMORYDEVICE_CPU);
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  Vector3s *sampledVoxelLocations = sampledVoxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int tid = 0; tid < static_cast<int>(sampledVoxelCount); ++tid)
+  {
+    write_prioritised_voxel_location(tid, m_candidatesPerSample, candidateVoxelIndices, raycastResultData, voxelData, labelData, indexData, sampledVoxelLocations);
+  }
+}
+
+}
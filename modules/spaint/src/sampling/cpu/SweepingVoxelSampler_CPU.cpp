@@ -0,0 +1,62 @@
+/**
+ * spaint: SweepingVoxelSampler_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cpu/SweepingVoxelSampler_CPU.h"
+
+#include "sampling/shared/SweepingVoxelSampler_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SweepingVoxelSampler_CPU::SweepingVoxelSampler_CPU(size_t maxVoxelCount, int voxelsPerBlock, float maxSDF)
+: SweepingVoxelSampler(maxVoxelCount, voxelsPerBlock, maxSDF)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int SweepingVoxelSampler_CPU::gather_resident_entries(const ITMHashEntry *hashTable)
+{
+  int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+
+  int entryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    if(hashTable[entryID].ptr >= 0) entryIDs[entryCount++] = entryID;
+  }
+
+  return entryCount;
+}
+
+int SweepingVoxelSampler_CPU::write_sampled_voxel_locations(int firstEntry, int entryCount, int phase, const SpaintVoxelScene *scene,
+                                                            ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB)
+{
+  const int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  Vector3s *sampledVoxelLocations = sampledVoxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+
+  int sampledVoxelCount = 0;
+  for(int i = firstEntry, end = firstEntry + entryCount; i < end; ++i)
+  {
+    // Note: The block may have been swapped out since the start of the sweep.
+    const ITMHashEntry& hashEntry = hashTable[entryIDs[i]];
+    if(hashEntry.ptr < 0) continue;
+
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      Vector3s loc;
+      if(select_sweep_voxel(linearIdx, hashEntry, phase, m_voxelsPerBlock, m_maxSDF, voxelData, labelData, loc))
+      {
+        sampledVoxelLocations[sampledVoxelCount++] = loc;
+      }
+    }
+  }
+
+  return sampledVoxelCount;
+}
+
+}
@@ -0,0 +1,74 @@
+/**
+ * spaint: VisibleBlockVoxelSampler_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cpu/VisibleBlockVoxelSampler_CPU.h"
+using namespace ITMLib;
+
+#include "sampling/shared/VisibleBlockVoxelSampler_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VisibleBlockVoxelSampler_CPU::VisibleBlockVoxelSampler_CPU(size_t maxLabelCount, size_t maxVoxelsPerLabel, size_t maxCandidatesPerLabel, int voxelsPerBlock,
+                                                           float maxSDF, unsigned int seed)
+: VisibleBlockVoxelSampler(maxLabelCount, maxVoxelsPerLabel, maxCandidatesPerLabel, voxelsPerBlock, maxSDF, seed)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VisibleBlockVoxelSampler_CPU::write_candidate_voxel_locations(const ITMRenderState_VH *renderState, const SpaintVoxelScene *scene, int phase,
+                                                                   const ORUtils::MemoryBlock<bool> *labelMaskMB) const
+{
+  unsigned int *candidateCounts = m_candidateCountsMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *candidateVoxelLocations = m_candidateVoxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const bool *labelMask = labelMaskMB ? labelMaskMB->GetData(MEMORYDEVICE_CPU) : NULL;
+  const int maxLabelCount = static_cast<int>(m_maxLabelCount);
+  const int *visibleEntryIDs = renderState->GetVisibleEntityIDs();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+  for(size_t k = 0; k < m_maxLabelCount; ++k) candidateCounts[k] = 0;
+
+  for(int i = 0; i < renderState->noVisibleEntities; ++i)
+  {
+    const ITMHashEntry& hashEntry = hashTable[visibleEntryIDs[i]];
+    if(hashEntry.ptr < 0) continue;
+
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      Vector3s loc;
+      int label;
+      if(select_visible_block_voxel(linearIdx, hashEntry, phase, m_voxelsPerBlock, m_maxSDF, voxelData, labelData, labelMask, maxLabelCount, loc, label))
+      {
+        // Note: We keep counting candidates once the space for the label is full, since the count is needed to detect this.
+        const unsigned int candidateIdx = candidateCounts[label]++;
+        if(candidateIdx < m_maxCandidatesPerLabel) candidateVoxelLocations[label * m_maxCandidatesPerLabel + candidateIdx] = loc;
+      }
+    }
+  }
+}
+
+void VisibleBlockVoxelSampler_CPU::write_sampled_voxel_locations(size_t labelCount, size_t voxelsPerLabel, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const
+{
+  const Vector3s *candidateVoxelLocations = m_candidateVoxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+  const int *candidateVoxelIndices = m_candidateVoxelIndicesMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *sampledVoxelLocations = sampledVoxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+
+  const int slotCount = static_cast<int>(labelCount * voxelsPerLabel);
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int slot = 0; slot < slotCount; ++slot)
+  {
+    copy_visible_block_voxel_location(
+      slot, static_cast<int>(voxelsPerLabel), static_cast<int>(m_maxVoxelsPerLabel), static_cast<int>(m_maxCandidatesPerLabel),
+      candidateVoxelLocations, candidateVoxelIndices, sampledVoxelLocations
+    );
+  }
+}
+
+}
@@ -0,0 +1,73 @@
+/**
+ * spaint: VoxelLocationSorter_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cpu/VoxelLocationSorter_CPU.h"
+
+#include <algorithm>
+
+#include "sampling/shared/VoxelLocationSorter_Shared.h"
+
+namespace {
+
+//#################### LOCAL TYPES ####################
+
+/**
+ * \brief An instance of this struct can be used to compare the indices of two voxel locations by their sort keys.
+ */
+struct KeyComparator
+{
+  const unsigned long long *m_keys;
+
+  explicit KeyComparator(const unsigned long long *keys)
+  : m_keys(keys)
+  {}
+
+  bool operator()(int i, int j) const
+  {
+    return m_keys[i] < m_keys[j];
+  }
+};
+
+}
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelLocationSorter_CPU::VoxelLocationSorter_CPU(size_t maxVoxelCount)
+: VoxelLocationSorter(maxVoxelCount)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelLocationSorter_CPU::sort_segments(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int segmentCount, int segmentSize,
+                                            const ORUtils::MemoryBlock<unsigned int> *segmentVoxelCountsMB)
+{
+  const int voxelCount = segmentCount * segmentSize;
+  Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+  const unsigned int *segmentVoxelCounts = segmentVoxelCountsMB ? segmentVoxelCountsMB->GetData(MEMORYDEVICE_CPU) : NULL;
+  unsigned long long *keys = m_keysMB->GetData(MEMORYDEVICE_CPU);
+  int *permutation = m_permutationMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *unsortedVoxelLocations = m_unsortedVoxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+
+  // Compute the sort keys of the voxel locations, and make a copy of the locations in their original order.
+  for(int i = 0; i < voxelCount; ++i)
+  {
+    write_voxel_location_sort_key(i, voxelLocations, segmentSize, segmentVoxelCounts, keys);
+    permutation[i] = i;
+    unsortedVoxelLocations[i] = voxelLocations[i];
+  }
+
+  // Stably sort the indices of the voxel locations by key.
+  std::stable_sort(permutation, permutation + voxelCount, KeyComparator(keys));
+
+  // Gather the voxel locations into sorted order.
+  for(int i = 0; i < voxelCount; ++i)
+  {
+    voxelLocations[i] = unsortedVoxelLocations[permutation[i]];
+  }
+}
+
+}
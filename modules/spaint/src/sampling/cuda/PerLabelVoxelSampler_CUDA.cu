@@ -13,6 +13,8 @@
 #endif
 
 #include <thrust/device_ptr.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
 #include <thrust/scan.h>
 
 #ifdef _MSC_VER
@@ -26,16 +28,37 @@
 
 namespace spaint {
 
+//#################### HELPER FUNCTORS ####################
+
+/**
+ * \brief An instance of this struct can be used to map an index in the concatenated voxel masks to the label whose mask contains it.
+ */
+struct MaskSegmentFunctor
+{
+  /** The size of each label's voxel mask (including the dummy element at the end). */
+  int stride;
+
+  explicit MaskSegmentFunctor(int stride_)
+  : stride(stride_)
+  {}
+
+  __host__ __device__
+  int operator()(int i) const
+  {
+    return i / stride;
+  }
+};
+
 //#################### CUDA KERNELS ####################
 
 __global__ void ck_calculate_voxel_masks(const Vector4f *raycastResult, int raycastResultSize,
-                                         const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                         size_t maxLabelCount, unsigned char *voxelMasks)
+                                         const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                         const ITMVoxelIndex::IndexData *indexData, size_t maxLabelCount, unsigned char *voxelMasks)
 {
   int voxelIndex = threadIdx.x + blockDim.x * blockIdx.x;
   if(voxelIndex < raycastResultSize)
   {
-    update_masks_for_voxel(voxelIndex, raycastResult, raycastResultSize, voxelData, indexData, maxLabelCount, voxelMasks);
+    update_masks_for_voxel(voxelIndex, raycastResult, raycastResultSize, voxelData, labelData, indexData, maxLabelCount, voxelMasks);
   }
 }
 
@@ -83,23 +106,25 @@ void PerLabelVoxelSampler_CUDA::calculate_voxel_mask_prefix_sums(const ORUtils::
   const unsigned char *voxelMasks = m_voxelMasksMB->GetData(MEMORYDEVICE_CUDA);
   unsigned int *voxelMaskPrefixSums = m_voxelMaskPrefixSumsMB->GetData(MEMORYDEVICE_CUDA);
 
-  // For each possible label:
+  // Find the number of labels whose masks need to be scanned (the masks of any unused labels below the highest used label are all zero,
+  // so it does no harm to scan them along with the others). If no labels are in use, there is nothing to do.
+  int labelCount = static_cast<int>(m_maxLabelCount);
+  while(labelCount > 0 && !labelMask[labelCount - 1]) --labelCount;
+  if(labelCount == 0) return;
+
+  // Calculate the prefix sums of the voxel masks for all of these labels in a single segmented scan over the concatenated masks.
   const int stride = m_raycastResultSize + 1;
-  for(size_t k = 0; k < m_maxLabelCount; ++k)
-  {
-    // If the label is not currently in use, continue.
-    if(!labelMask[k]) continue;
-
-    // Calculate the prefix sum of the voxel mask.
-    thrust::device_ptr<const unsigned char> voxelMask(voxelMasks + k * stride);
-    thrust::device_ptr<unsigned int> voxelMaskPrefixSum(voxelMaskPrefixSums + k * stride);
-
-    thrust::exclusive_scan(
-      voxelMask,
-      voxelMask + stride,
-      voxelMaskPrefixSum
-    );
-  }
+  thrust::device_ptr<const unsigned char> voxelMasksBegin(voxelMasks);
+  thrust::device_ptr<unsigned int> voxelMaskPrefixSumsBegin(voxelMaskPrefixSums);
+  thrust::transform_iterator<MaskSegmentFunctor,thrust::counting_iterator<int> > segmentsBegin(thrust::counting_iterator<int>(0), MaskSegmentFunctor(stride));
+
+  thrust::exclusive_scan_by_key(
+    segmentsBegin,
+    segmentsBegin + labelCount * stride,
+    voxelMasksBegin,
+    voxelMaskPrefixSumsBegin,
+    0u
+  );
 
 #if DEBUGGING
   m_voxelMaskPrefixSumsMB->UpdateHostFromDevice();
@@ -108,6 +133,7 @@ void PerLabelVoxelSampler_CUDA::calculate_voxel_mask_prefix_sums(const ORUtils::
 
 void PerLabelVoxelSampler_CUDA::calculate_voxel_masks(const ITMFloat4Image *raycastResult,
                                                       const SpaintVoxel *voxelData,
+                                                      const SpaintVoxel::PackedLabel *labelData,
                                                       const ITMVoxelIndex::IndexData *indexData) const
 {
   int threadsPerBlock = 256;
@@ -116,6 +142,7 @@ void PerLabelVoxelSampler_CUDA::calculate_voxel_masks(const ITMFloat4Image *rayc
     raycastResult->GetData(MEMORYDEVICE_CUDA),
     m_raycastResultSize,
     voxelData,
+    labelData,
     indexData,
     m_maxLabelCount,
     m_voxelMasksMB->GetData(MEMORYDEVICE_CUDA)
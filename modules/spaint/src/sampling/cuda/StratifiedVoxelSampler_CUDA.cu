@@ -0,0 +1,52 @@
+/**
+ * spaint: StratifiedVoxelSampler_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cuda/StratifiedVoxelSampler_CUDA.h"
+
+#include "sampling/shared/StratifiedVoxelSampler_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_write_prioritised_voxel_locations(int voxelsToSample, int candidatesPerSample, const int *candidateVoxelIndices, const Vector4f *raycastResult,
+                                                     const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                                     const ITMVoxelIndex::IndexData *indexData, Vector3s *sampledVoxelLocations)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < voxelsToSample)
+  {
+    write_prioritised_voxel_location(tid, candidatesPerSample, candidateVoxelIndices, raycastResult, voxelData, labelData, indexData, sampledVoxelLocations);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+StratifiedVoxelSampler_CUDA::StratifiedVoxelSampler_CUDA(const Vector2i& raycastResultDims, size_t maxVoxelCount, int tileSize, int candidatesPerSample, unsigned int seed)
+: StratifiedVoxelSampler(raycastResultDims, maxVoxelCount, tileSize, candidatesPerSample, seed)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void StratifiedVoxelSampler_CUDA::write_sampled_voxel_locations(const ITMFloat4Image *raycastResult, const SpaintVoxel *voxelData,
+                                                                const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                                                                size_t sampledVoxelCount, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (static_cast<int>(sampledVoxelCount) + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_write_prioritised_voxel_locations<<<numBlocks,threadsPerBlock>>>(
+    static_cast<int>(sampledVoxelCount),
+    m_candidatesPerSample,
+    m_candidateVoxelIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    raycastResult->GetData(MEMORYDEVICE_CUDA),
+    voxelData,
+    labelData,
+    indexData,
+    sampledVoxelLocationsMB.GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,95 @@
+/**
+ * spaint: SweepingVoxelSampler_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cuda/SweepingVoxelSampler_CUDA.h"
+
+#include "sampling/shared/SweepingVoxelSampler_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_gather_resident_entries(const ITMHashEntry *hashTable, int noTotalEntries, int *entryIDs, int *entryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < noTotalEntries && hashTable[entryID].ptr >= 0)
+  {
+    entryIDs[atomicAdd(entryCount, 1)] = entryID;
+  }
+}
+
+__global__ void ck_write_sweep_voxel_locations(const int *entryIDs, int firstEntry, int phase, int voxelsPerBlock, float maxSDF, const ITMHashEntry *hashTable,
+                                               const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, Vector3s *sampledVoxelLocations,
+                                               int *sampledVoxelCount)
+{
+  // Each thread block examines a single voxel block, with one thread per voxel.
+  // Note: The block may have been swapped out since the start of the sweep.
+  const ITMHashEntry hashEntry = hashTable[entryIDs[firstEntry + blockIdx.x]];
+  if(hashEntry.ptr < 0) return;
+
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+
+  Vector3s loc;
+  if(select_sweep_voxel(linearIdx, hashEntry, phase, voxelsPerBlock, maxSDF, voxelData, labelData, loc))
+  {
+    sampledVoxelLocations[atomicAdd(sampledVoxelCount, 1)] = loc;
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+SweepingVoxelSampler_CUDA::SweepingVoxelSampler_CUDA(size_t maxVoxelCount, int voxelsPerBlock, float maxSDF)
+: SweepingVoxelSampler(maxVoxelCount, voxelsPerBlock, maxSDF)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int SweepingVoxelSampler_CUDA::gather_resident_entries(const ITMHashEntry *hashTable)
+{
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_countMB->Clear();
+
+  ck_gather_resident_entries<<<numBlocks,threadsPerBlock>>>(
+    hashTable,
+    noTotalEntries,
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Note: The entry IDs are gathered in no particular order, but each of them is visited exactly once in the sweep.
+  m_countMB->UpdateHostFromDevice();
+  return *m_countMB->GetData(MEMORYDEVICE_CPU);
+}
+
+int SweepingVoxelSampler_CUDA::write_sampled_voxel_locations(int firstEntry, int entryCount, int phase, const SpaintVoxelScene *scene,
+                                                             ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB)
+{
+  dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+  dim3 gridSize(entryCount);
+
+  m_countMB->Clear();
+
+  ck_write_sweep_voxel_locations<<<gridSize,cudaBlockSize>>>(
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    firstEntry,
+    phase,
+    m_voxelsPerBlock,
+    m_maxSDF,
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    sampledVoxelLocationsMB.GetData(MEMORYDEVICE_CUDA),
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_countMB->UpdateHostFromDevice();
+  return *m_countMB->GetData(MEMORYDEVICE_CPU);
+}
+
+}
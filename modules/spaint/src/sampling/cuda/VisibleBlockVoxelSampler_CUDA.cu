@@ -0,0 +1,104 @@
+/**
+ * spaint: VisibleBlockVoxelSampler_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cuda/VisibleBlockVoxelSampler_CUDA.h"
+using namespace ITMLib;
+
+#include "sampling/shared/VisibleBlockVoxelSampler_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_copy_visible_block_voxel_locations(int slotCount, int voxelsPerLabel, int maxVoxelsPerLabel, int maxCandidatesPerLabel,
+                                                      const Vector3s *candidateVoxelLocations, const int *candidateVoxelIndices,
+                                                      Vector3s *sampledVoxelLocations)
+{
+  int slot = threadIdx.x + blockDim.x * blockIdx.x;
+  if(slot < slotCount)
+  {
+    copy_visible_block_voxel_location(slot, voxelsPerLabel, maxVoxelsPerLabel, maxCandidatesPerLabel, candidateVoxelLocations, candidateVoxelIndices, sampledVoxelLocations);
+  }
+}
+
+__global__ void ck_write_visible_block_candidates(const int *visibleEntryIDs, int phase, int voxelsPerBlock, float maxSDF, const ITMHashEntry *hashTable,
+                                                  const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const bool *labelMask,
+                                                  int maxLabelCount, unsigned int maxCandidatesPerLabel, Vector3s *candidateVoxelLocations,
+                                                  unsigned int *candidateCounts)
+{
+  // Each thread block examines a single visible voxel block, with one thread per voxel.
+  const ITMHashEntry hashEntry = hashTable[visibleEntryIDs[blockIdx.x]];
+  if(hashEntry.ptr < 0) return;
+
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+
+  Vector3s loc;
+  int label;
+  if(select_visible_block_voxel(linearIdx, hashEntry, phase, voxelsPerBlock, maxSDF, voxelData, labelData, labelMask, maxLabelCount, loc, label))
+  {
+    // Note: We keep counting candidates once the space for the label is full, since the count is needed to detect this.
+    const unsigned int candidateIdx = atomicAdd(&candidateCounts[label], 1U);
+    if(candidateIdx < maxCandidatesPerLabel) candidateVoxelLocations[label * maxCandidatesPerLabel + candidateIdx] = loc;
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+VisibleBlockVoxelSampler_CUDA::VisibleBlockVoxelSampler_CUDA(size_t maxLabelCount, size_t maxVoxelsPerLabel, size_t maxCandidatesPerLabel, int voxelsPerBlock,
+                                                             float maxSDF, unsigned int seed)
+: VisibleBlockVoxelSampler(maxLabelCount, maxVoxelsPerLabel, maxCandidatesPerLabel, voxelsPerBlock, maxSDF, seed)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VisibleBlockVoxelSampler_CUDA::write_candidate_voxel_locations(const ITMRenderState_VH *renderState, const SpaintVoxelScene *scene, int phase,
+                                                                    const ORUtils::MemoryBlock<bool> *labelMaskMB) const
+{
+  m_candidateCountsMB->Clear();
+
+  const int visibleEntryCount = renderState->noVisibleEntities;
+  if(visibleEntryCount > 0)
+  {
+    dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+    dim3 gridSize(visibleEntryCount);
+
+    ck_write_visible_block_candidates<<<gridSize,cudaBlockSize>>>(
+      renderState->GetVisibleEntityIDs(),
+      phase,
+      m_voxelsPerBlock,
+      m_maxSDF,
+      scene->index.GetEntries(),
+      scene->localVBA.GetVoxelBlocks(),
+      scene->get_label_data(),
+      labelMaskMB ? labelMaskMB->GetData(MEMORYDEVICE_CUDA) : NULL,
+      static_cast<int>(m_maxLabelCount),
+      static_cast<unsigned int>(m_maxCandidatesPerLabel),
+      m_candidateVoxelLocationsMB->GetData(MEMORYDEVICE_CUDA),
+      m_candidateCountsMB->GetData(MEMORYDEVICE_CUDA)
+    );
+  }
+
+  m_candidateCountsMB->UpdateHostFromDevice();
+}
+
+void VisibleBlockVoxelSampler_CUDA::write_sampled_voxel_locations(size_t labelCount, size_t voxelsPerLabel, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const
+{
+  const int slotCount = static_cast<int>(labelCount * voxelsPerLabel);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (slotCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_copy_visible_block_voxel_locations<<<numBlocks,threadsPerBlock>>>(
+    slotCount,
+    static_cast<int>(voxelsPerLabel),
+    static_cast<int>(m_maxVoxelsPerLabel),
+    static_cast<int>(m_maxCandidatesPerLabel),
+    m_candidateVoxelLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    m_candidateVoxelIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    sampledVoxelLocationsMB.GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
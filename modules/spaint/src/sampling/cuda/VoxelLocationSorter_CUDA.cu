@@ -0,0 +1,74 @@
+/**
+ * spaint: VoxelLocationSorter_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/cuda/VoxelLocationSorter_CUDA.h"
+
+#include <ORUtils/CUDADefines.h>
+
+#include <thrust/device_ptr.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include "sampling/shared/VoxelLocationSorter_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_gather_voxel_locations(const Vector3s *unsortedVoxelLocations, const int *permutation, int voxelCount, Vector3s *voxelLocations)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < voxelCount) voxelLocations[i] = unsortedVoxelLocations[permutation[i]];
+}
+
+__global__ void ck_write_voxel_location_sort_keys(const Vector3s *voxelLocations, int voxelCount, int segmentSize, const unsigned int *segmentVoxelCounts,
+                                                  unsigned long long *keys)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < voxelCount) write_voxel_location_sort_key(i, voxelLocations, segmentSize, segmentVoxelCounts, keys);
+}
+
+//#################### CONSTRUCTORS ####################
+
+VoxelLocationSorter_CUDA::VoxelLocationSorter_CUDA(size_t maxVoxelCount)
+: VoxelLocationSorter(maxVoxelCount)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelLocationSorter_CUDA::sort_segments(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, int segmentCount, int segmentSize,
+                                             const ORUtils::MemoryBlock<unsigned int> *segmentVoxelCountsMB)
+{
+  const int voxelCount = segmentCount * segmentSize;
+  Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CUDA);
+  unsigned long long *keys = m_keysMB->GetData(MEMORYDEVICE_CUDA);
+  int *permutation = m_permutationMB->GetData(MEMORYDEVICE_CUDA);
+  Vector3s *unsortedVoxelLocations = m_unsortedVoxelLocationsMB->GetData(MEMORYDEVICE_CUDA);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (voxelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Compute the sort keys of the voxel locations, and make a copy of the locations in their original order.
+  ck_write_voxel_location_sort_keys<<<numBlocks,threadsPerBlock>>>(
+    voxelLocations,
+    voxelCount,
+    segmentSize,
+    segmentVoxelCountsMB ? segmentVoxelCountsMB->GetData(MEMORYDEVICE_CUDA) : NULL,
+    keys
+  );
+
+  ORcudaSafeCall(cudaMemcpy(unsortedVoxelLocations, voxelLocations, voxelCount * sizeof(Vector3s), cudaMemcpyDeviceToDevice));
+
+  // Stably sort the indices of the voxel locations by key.
+  thrust::device_ptr<unsigned long long> keysPtr(keys);
+  thrust::device_ptr<int> permutationPtr(permutation);
+  thrust::sequence(permutationPtr, permutationPtr + voxelCount);
+  thrust::stable_sort_by_key(keysPtr, keysPtr + voxelCount, permutationPtr);
+
+  // Gather the voxel locations into sorted order.
+  ck_gather_voxel_locations<<<numBlocks,threadsPerBlock>>>(unsortedVoxelLocations, permutation, voxelCount, voxelLocations);
+}
+
+}
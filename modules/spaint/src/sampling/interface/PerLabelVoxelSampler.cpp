@@ -15,14 +15,14 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 PerLabelVoxelSampler::PerLabelVoxelSampler(size_t maxLabelCount, size_t maxVoxelsPerLabel, int raycastResultSize, unsigned int seed)
-: m_candidateVoxelIndicesMB(MemoryBlockFactory::instance().make_block<int>(maxLabelCount * maxVoxelsPerLabel)),
-  m_candidateVoxelLocationsMB(MemoryBlockFactory::instance().make_block<Vector3s>(maxLabelCount * raycastResultSize)),
+: m_candidateVoxelIndicesMB(MemoryBlockFactory::instance().make_block<int>(maxLabelCount * maxVoxelsPerLabel, "PerLabelVoxelSampler")),
+  m_candidateVoxelLocationsMB(MemoryBlockFactory::instance().make_block<Vector3s>(maxLabelCount * raycastResultSize, "PerLabelVoxelSampler")),
   m_maxLabelCount(maxLabelCount),
   m_maxVoxelsPerLabel(maxVoxelsPerLabel),
   m_raycastResultSize(raycastResultSize),
   m_rng(new tvgutil::RandomNumberGenerator(seed)),
-  m_voxelMaskPrefixSumsMB(MemoryBlockFactory::instance().make_block<unsigned int>(maxLabelCount * (raycastResultSize + 1))),
-  m_voxelMasksMB(MemoryBlockFactory::instance().make_block<unsigned char>(maxLabelCount * (raycastResultSize + 1)))
+  m_voxelMaskPrefixSumsMB(MemoryBlockFactory::instance().make_block<unsigned int>(maxLabelCount * (raycastResultSize + 1), "PerLabelVoxelSampler")),
+  m_voxelMasksMB(MemoryBlockFactory::instance().make_block<unsigned char>(maxLabelCount * (raycastResultSize + 1), "PerLabelVoxelSampler"))
 {
   // Make sure that the dummy elements at the end of the voxel masks for the various labels are properly initialised.
   unsigned char *voxelMasks = m_voxelMasksMB->GetData(MEMORYDEVICE_CPU);
@@ -47,8 +47,9 @@ void PerLabelVoxelSampler::sample_voxels(const ITMFloat4Image *raycastResult, co
   // Calculate the voxel masks for all labels (these indicate which voxels could serve as examples of each label).
   // Note that we calculate masks even for unused labels to avoid unnecessary branching - these will always be empty.
   const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
   const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
-  calculate_voxel_masks(raycastResult, voxelData, indexData);
+  calculate_voxel_masks(raycastResult, voxelData, labelData, indexData);
 
   // Calculate the prefix sums of the voxel masks for the used labels (these can be used to determine the locations in
   // the candidate voxel locations array into which candidate voxels should be written).
@@ -0,0 +1,78 @@
+/**
+ * spaint: StratifiedVoxelSampler.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/interface/StratifiedVoxelSampler.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+StratifiedVoxelSampler::StratifiedVoxelSampler(const Vector2i& raycastResultDims, size_t maxVoxelCount, int tileSize, int candidatesPerSample, unsigned int seed)
+: m_candidatesPerSample(candidatesPerSample),
+  m_maxVoxelCount(maxVoxelCount),
+  m_raycastResultDims(raycastResultDims),
+  m_rng(new tvgutil::RandomNumberGenerator(seed)),
+  m_tileSize(tileSize)
+{
+  if(tileSize <= 0) throw std::invalid_argument("Error: The tiles used by a stratified voxel sampler must have a positive size");
+  if(candidatesPerSample <= 0) throw std::invalid_argument("Error: A stratified voxel sampler must consider at least one candidate per sample");
+
+  m_candidateVoxelIndicesMB = MemoryBlockFactory::instance().make_block<int>(maxVoxelCount * candidatesPerSample, "StratifiedVoxelSampler");
+}
+
+//#################### DESTRUCTOR ####################
+
+StratifiedVoxelSampler::~StratifiedVoxelSampler() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void StratifiedVoxelSampler::sample_voxels(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, size_t numVoxelsToSample,
+                                           ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const
+{
+  if(numVoxelsToSample > m_maxVoxelCount)
+  {
+    throw std::invalid_argument("Error: Cannot sample more voxels than the maximum specified when the stratified voxel sampler was constructed");
+  }
+
+  // Share the samples out between the tiles in turn, starting from a randomly-chosen tile so that no tile is
+  // consistently favoured over the others when the number of samples is not a multiple of the number of tiles.
+  const int tilesX = (m_raycastResultDims.x + m_tileSize - 1) / m_tileSize;
+  const int tilesY = (m_raycastResultDims.y + m_tileSize - 1) / m_tileSize;
+  const int tileCount = tilesX * tilesY;
+  const int firstTile = m_rng->generate_int_from_uniform(0, tileCount - 1);
+
+  // For each sample, choose some random candidate pixels from its tile.
+  int *candidateVoxelIndices = m_candidateVoxelIndicesMB->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0; i < numVoxelsToSample; ++i)
+  {
+    const int tile = static_cast<int>((firstTile + i) % tileCount);
+    const int minX = (tile % tilesX) * m_tileSize, minY = (tile / tilesX) * m_tileSize;
+    const int maxX = std::min(minX + m_tileSize, m_raycastResultDims.x) - 1, maxY = std::min(minY + m_tileSize, m_raycastResultDims.y) - 1;
+
+    for(int j = 0; j < m_candidatesPerSample; ++j)
+    {
+      const int x = m_rng->generate_int_from_uniform(minX, maxX);
+      const int y = m_rng->generate_int_from_uniform(minY, maxY);
+      candidateVoxelIndices[i * m_candidatesPerSample + j] = y * m_raycastResultDims.x + x;
+    }
+  }
+  m_candidateVoxelIndicesMB->UpdateDeviceFromHost();
+
+  // Choose the best candidate for each sample, and write the sampled voxel locations into the sampled voxel locations array.
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  write_sampled_voxel_locations(raycastResult, voxelData, labelData, indexData, numVoxelsToSample, sampledVoxelLocationsMB);
+}
+
+}
@@ -0,0 +1,80 @@
+/**
+ * spaint: SweepingVoxelSampler.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/interface/SweepingVoxelSampler.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SweepingVoxelSampler::SweepingVoxelSampler(size_t maxVoxelCount, int voxelsPerBlock, float maxSDF)
+: m_entryCount(0),
+  m_entryCursor(0),
+  m_maxSDF(maxSDF),
+  m_maxVoxelCount(maxVoxelCount),
+  m_sweepCount(0),
+  m_voxelsPerBlock(voxelsPerBlock)
+{
+  if(voxelsPerBlock <= 0 || voxelsPerBlock > SDF_BLOCK_SIZE3 || (voxelsPerBlock & (voxelsPerBlock - 1)) != 0)
+  {
+    throw std::invalid_argument("Error: The number of voxels per block considered by a sweeping voxel sampler must be a power of two no greater than the block size");
+  }
+
+  if(static_cast<size_t>(voxelsPerBlock) > maxVoxelCount)
+  {
+    throw std::invalid_argument("Error: A sweeping voxel sampler must be able to sample at least one block's worth of voxels at once");
+  }
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_countMB = mbf.make_block<int>(1, "SweepingVoxelSampler");
+  m_entryIDsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "SweepingVoxelSampler");
+}
+
+//#################### DESTRUCTOR ####################
+
+SweepingVoxelSampler::~SweepingVoxelSampler() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t SweepingVoxelSampler::get_max_voxel_count() const
+{
+  return m_maxVoxelCount;
+}
+
+int SweepingVoxelSampler::get_sweep_block_count() const
+{
+  return m_entryCount;
+}
+
+size_t SweepingVoxelSampler::sample_voxels(const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB)
+{
+  // If the current sweep is complete, start a new one over the blocks that are currently resident.
+  if(m_entryCursor >= m_entryCount)
+  {
+    m_entryCount = gather_resident_entries(scene->index.GetEntries());
+    m_entryCursor = 0;
+    ++m_sweepCount;
+  }
+
+  // Sample voxels from as many of the remaining blocks in the sweep as are guaranteed to fit in the batch. The subset
+  // of the voxels in each block that is considered changes from one sweep to the next.
+  const int phaseCount = SDF_BLOCK_SIZE3 / m_voxelsPerBlock;
+  const int phase = (m_sweepCount - 1) % phaseCount;
+  const int entryCount = std::min(static_cast<int>(m_maxVoxelCount / m_voxelsPerBlock), m_entryCount - m_entryCursor);
+
+  const int sampledVoxelCount = entryCount > 0 ? write_sampled_voxel_locations(m_entryCursor, entryCount, phase, scene, sampledVoxelLocationsMB) : 0;
+  m_entryCursor += entryCount;
+
+  sampledVoxelLocationsMB.dataSize = sampledVoxelCount;
+  return sampledVoxelCount;
+}
+
+}
@@ -17,7 +17,7 @@ namespace spaint {
 UniformVoxelSampler::UniformVoxelSampler(int raycastResultSize, unsigned int seed)
 : m_raycastResultSize(raycastResultSize),
   m_rng(new tvgutil::RandomNumberGenerator(seed)),
-  m_sampledVoxelIndicesMB(MemoryBlockFactory::instance().make_block<int>(raycastResultSize))
+  m_sampledVoxelIndicesMB(MemoryBlockFactory::instance().make_block<int>(raycastResultSize, "UniformVoxelSampler"))
 {}
 
 //#################### DESTRUCTOR ####################
@@ -0,0 +1,128 @@
+/**
+ * spaint: VisibleBlockVoxelSampler.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/interface/VisibleBlockVoxelSampler.h"
+using namespace ITMLib;
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VisibleBlockVoxelSampler::VisibleBlockVoxelSampler(size_t maxLabelCount, size_t maxVoxelsPerLabel, size_t maxCandidatesPerLabel, int voxelsPerBlock,
+                                                   float maxSDF, unsigned int seed)
+: m_maxCandidatesPerLabel(maxCandidatesPerLabel),
+  m_maxLabelCount(maxLabelCount),
+  m_maxSDF(maxSDF),
+  m_maxVoxelsPerLabel(maxVoxelsPerLabel),
+  m_rng(new tvgutil::RandomNumberGenerator(seed)),
+  m_voxelsPerBlock(voxelsPerBlock)
+{
+  if(voxelsPerBlock <= 0 || voxelsPerBlock > SDF_BLOCK_SIZE3 || (voxelsPerBlock & (voxelsPerBlock - 1)) != 0)
+  {
+    throw std::invalid_argument("Error: The number of voxels per block considered by a visible-block voxel sampler must be a power of two no greater than the block size");
+  }
+
+  if(maxLabelCount == 0 || maxCandidatesPerLabel == 0)
+  {
+    throw std::invalid_argument("Error: A visible-block voxel sampler must be able to keep at least one candidate voxel for at least one label");
+  }
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_candidateCountsMB = mbf.make_block<unsigned int>(maxLabelCount, "VisibleBlockVoxelSampler");
+  m_candidateVoxelIndicesMB = mbf.make_block<int>(maxLabelCount * maxVoxelsPerLabel, "VisibleBlockVoxelSampler");
+  m_candidateVoxelLocationsMB = mbf.make_block<Vector3s>(maxLabelCount * maxCandidatesPerLabel, "VisibleBlockVoxelSampler");
+}
+
+//#################### DESTRUCTOR ####################
+
+VisibleBlockVoxelSampler::~VisibleBlockVoxelSampler() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t VisibleBlockVoxelSampler::sample_voxels(const ITMRenderState *renderState, const SpaintVoxelScene *scene, size_t numVoxelsToSample,
+                                               ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB) const
+{
+  // Gather the candidate voxels, pooling them under label 0.
+  gather_candidates(renderState, scene, NULL);
+
+  // Choose which of the candidates to sample. Since they are chosen in order, any shortfall is left at the end.
+  numVoxelsToSample = std::min(numVoxelsToSample, m_maxVoxelsPerLabel);
+  unsigned int sampledVoxelCount;
+  choose_candidate_voxel_indices(1, NULL, numVoxelsToSample, &sampledVoxelCount);
+
+  // Write the sampled voxel locations into the sampled voxel locations array.
+  if(sampledVoxelCount > 0) write_sampled_voxel_locations(1, numVoxelsToSample, sampledVoxelLocationsMB);
+
+  sampledVoxelLocationsMB.dataSize = sampledVoxelCount;
+  return sampledVoxelCount;
+}
+
+void VisibleBlockVoxelSampler::sample_voxels(const ITMRenderState *renderState, const SpaintVoxelScene *scene,
+                                             const ORUtils::MemoryBlock<bool>& labelMaskMB,
+                                             ORUtils::MemoryBlock<Vector3s>& sampledVoxelLocationsMB,
+                                             ORUtils::MemoryBlock<unsigned int>& voxelCountsForLabelsMB) const
+{
+  // Gather the candidate voxels, grouping them by label.
+  gather_candidates(renderState, scene, &labelMaskMB);
+
+  // Randomly choose candidate voxels to sample for each used label, and write their locations into the sampled voxel locations array.
+  choose_candidate_voxel_indices(m_maxLabelCount, labelMaskMB.GetData(MEMORYDEVICE_CPU), m_maxVoxelsPerLabel, voxelCountsForLabelsMB.GetData(MEMORYDEVICE_CPU));
+  voxelCountsForLabelsMB.UpdateDeviceFromHost();
+  write_sampled_voxel_locations(m_maxLabelCount, m_maxVoxelsPerLabel, sampledVoxelLocationsMB);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VisibleBlockVoxelSampler::choose_candidate_voxel_indices(size_t labelCount, const bool *labelMask, size_t voxelsPerLabel, unsigned int *voxelCounts) const
+{
+  const unsigned int *candidateCounts = m_candidateCountsMB->GetData(MEMORYDEVICE_CPU);
+  int *candidateVoxelIndices = m_candidateVoxelIndicesMB->GetData(MEMORYDEVICE_CPU);
+
+  for(size_t k = 0; k < labelCount; ++k)
+  {
+    int *labelIndices = candidateVoxelIndices + k * m_maxVoxelsPerLabel;
+
+    // Note: More candidates than were kept may have been found, in which case we can only sample from the ones that were kept.
+    const size_t candidateCount = labelMask && !labelMask[k] ? 0 : std::min(static_cast<size_t>(candidateCounts[k]), m_maxCandidatesPerLabel);
+    if(candidateCount < voxelsPerLabel)
+    {
+      // If we don't have enough candidate voxels for this label, just use all of the ones we do have.
+      for(size_t i = 0; i < candidateCount; ++i) labelIndices[i] = static_cast<int>(i);
+      for(size_t i = candidateCount; i < voxelsPerLabel; ++i) labelIndices[i] = -1;
+      voxelCounts[k] = static_cast<unsigned int>(candidateCount);
+    }
+    else
+    {
+      // If we do have enough candidate voxels for this label, sample the requested number of voxels from the candidates.
+      for(size_t i = 0; i < voxelsPerLabel; ++i)
+      {
+        labelIndices[i] = m_rng->generate_int_from_uniform(0, static_cast<int>(candidateCount) - 1);
+      }
+      voxelCounts[k] = static_cast<unsigned int>(voxelsPerLabel);
+    }
+  }
+
+  m_candidateVoxelIndicesMB->UpdateDeviceFromHost();
+}
+
+void VisibleBlockVoxelSampler::gather_candidates(const ITMRenderState *renderState, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<bool> *labelMaskMB) const
+{
+  const ITMRenderState_VH *renderStateVH = dynamic_cast<const ITMRenderState_VH*>(renderState);
+  if(!renderStateVH) throw std::invalid_argument("Error: A visible-block voxel sampler needs a voxel hashing render state");
+
+  // Consider a different, randomly-chosen subset of the voxels in each block each time, so that over time every voxel can be sampled.
+  const int phase = m_rng->generate_int_from_uniform(0, SDF_BLOCK_SIZE3 / m_voxelsPerBlock - 1);
+  write_candidate_voxel_locations(renderStateVH, scene, phase, labelMaskMB);
+}
+
+}
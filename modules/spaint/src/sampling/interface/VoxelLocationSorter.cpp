@@ -0,0 +1,61 @@
+/**
+ * spaint: VoxelLocationSorter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "sampling/interface/VoxelLocationSorter.h"
+
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelLocationSorter::VoxelLocationSorter(size_t maxVoxelCount)
+: m_maxVoxelCount(maxVoxelCount)
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_keysMB = mbf.make_block<unsigned long long>(maxVoxelCount, "VoxelLocationSorter");
+  m_permutationMB = mbf.make_block<int>(maxVoxelCount, "VoxelLocationSorter");
+  m_unsortedVoxelLocationsMB = mbf.make_block<Vector3s>(maxVoxelCount, "VoxelLocationSorter");
+}
+
+//#################### DESTRUCTOR ####################
+
+VoxelLocationSorter::~VoxelLocationSorter() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+const ORUtils::MemoryBlock<int>& VoxelLocationSorter::get_permutation() const
+{
+  return *m_permutationMB;
+}
+
+void VoxelLocationSorter::sort_voxel_locations(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, size_t voxelCount)
+{
+  if(voxelCount > m_maxVoxelCount)
+  {
+    throw std::invalid_argument("Error: Too many voxel locations to sort at once");
+  }
+
+  if(voxelCount > 0) sort_segments(voxelLocationsMB, 1, static_cast<int>(voxelCount), NULL);
+}
+
+void VoxelLocationSorter::sort_voxel_locations(ORUtils::MemoryBlock<Vector3s>& voxelLocationsMB, size_t segmentCount, size_t segmentSize,
+                                               const ORUtils::MemoryBlock<unsigned int>& segmentVoxelCountsMB)
+{
+  if(segmentCount * segmentSize > m_maxVoxelCount)
+  {
+    throw std::invalid_argument("Error: Too many voxel locations to sort at once");
+  }
+
+  if(segmentCount * segmentSize > 0)
+  {
+    sort_segments(voxelLocationsMB, static_cast<int>(segmentCount), static_cast<int>(segmentSize), &segmentVoxelCountsMB);
+  }
+}
+
+}
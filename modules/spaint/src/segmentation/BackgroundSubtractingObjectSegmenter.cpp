@@ -7,9 +7,15 @@
 
 #include <cmath>
 
+#include <boost/chrono/chrono.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 
+#include <tvgutil/timing/Profiler.h>
+using tvgutil::PlacementController;
+using tvgutil::Profiler;
+
 #include "ocv/OpenCVUtil.h"
+#include "segmentation/ChangeMaskGeneratorFactory.h"
 #include "util/CameraPoseConverter.h"
 
 #define DEBUGGING 1
@@ -19,8 +25,21 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 BackgroundSubtractingObjectSegmenter::BackgroundSubtractingObjectSegmenter(const View_CPtr& view, const Settings_CPtr& itmSettings, const TouchSettings_Ptr& touchSettings)
-: Segmenter(view), m_touchDetector(new TouchDetector(view->depth->noDims, itmSettings, touchSettings))
-{}
+: Segmenter(view),
+  m_changeMaskGenerator(ChangeMaskGeneratorFactory::make_change_mask_generator(view->depth->noDims, itmSettings->deviceType)),
+  m_handProbabilityImage(new ITMFloatImage(view->rgb->noDims, true, false)),
+  m_touchDetector(new TouchDetector(view->depth->noDims, itmSettings, touchSettings))
+{
+  // If we're running on the GPU, optionally allow the per-pixel stages of making the change mask to be moved to the CPU
+  // on frames on which that is measured to be cheaper (e.g. when the GPU is heavily loaded by the rest of the pipeline).
+  if(itmSettings->deviceType == ITMLibSettings::DEVICE_CUDA &&
+     itmSettings->get_first_value<bool>("BackgroundSubtractingObjectSegmenter.adaptiveChangeMaskPlacement", false))
+  {
+    const size_t probeInterval = itmSettings->get_first_value<size_t>("BackgroundSubtractingObjectSegmenter.changeMaskProbeInterval", 30);
+    m_changeMaskPlacement = PlacementController(2, probeInterval);
+    m_cpuChangeMaskGenerator = ChangeMaskGeneratorFactory::make_change_mask_generator(view->depth->noDims, ITMLibSettings::DEVICE_CPU);
+  }
+}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
@@ -64,10 +83,13 @@ ITMUCharImage_CPtr BackgroundSubtractingObjectSegmenter::segment(const ORUtils::
 
   // Make the hand mask.
   static cv::Mat1b handMask = cv::Mat1b::zeros(m_view->rgb->noDims.y, m_view->rgb->noDims.x);
-  const Vector4u *rgbPtr = rgbInput->GetData(MEMORYDEVICE_CPU);
   const uchar *changeMaskPtr = changeMask->GetData(MEMORYDEVICE_CPU);
   const int pixelCount = static_cast<int>(rgbInput->dataSize);
 
+  // Compute the probability of each pixel being part of the hand in a single pass over the colour input image.
+  if(m_handAppearanceModel) m_handAppearanceModel->compute_posterior_image(rgbInput, m_handProbabilityImage);
+  const float *handProbPtr = m_handProbabilityImage->GetData(MEMORYDEVICE_CPU);
+
   // For each pixel in the current colour input image:
 #if WITH_OPENMP
   #pragma omp parallel for
@@ -78,7 +100,7 @@ ITMUCharImage_CPtr BackgroundSubtractingObjectSegmenter::segment(const ORUtils::
     unsigned char value = 0;
     if(changeMaskPtr[i])
     {
-      float handProb = m_handAppearanceModel ? m_handAppearanceModel->compute_posterior_probability(rgbPtr[i].toVector3()) : 0.0f;
+      float handProb = m_handAppearanceModel ? handProbPtr[i] : 0.0f;
       int handProbThreshold = 100 - objectProbThreshold;
 
 #if 1
@@ -185,111 +207,44 @@ ITMUCharImage_CPtr BackgroundSubtractingObjectSegmenter::make_change_mask(const
   rigging::MoveableCamera_CPtr camera(new rigging::SimpleCamera(CameraPoseConverter::pose_to_camera(pose)));
   m_touchDetector->determine_touch_points(camera, depthInput, renderState);
 
-  // Get a thresholded version of the live depth image.
-  ITMFloatImage_CPtr thresholdedRawDepth = m_touchDetector->get_thresholded_raw_depth();
-  thresholdedRawDepth->UpdateHostFromDevice();
-  const float *thresholdedRawDepthPtr = thresholdedRawDepth->GetData(MEMORYDEVICE_CPU);
+  // Make an initial change mask, directly from the touch detector's images.
+  ChangeMaskGenerator::Thresholds thresholds;
+  thresholds.centreDistThreshold = centreDistThreshold;
+  thresholds.depthEdgeThreshold = depthEdgeThreshold;
+  thresholds.lowerDiffThresholdMm = lowerDiffThresholdMm;
+  thresholds.lowerDiffThresholdNearEdgesMm = lowerDiffThresholdNearEdgesMm;
+  thresholds.upperDepthThresholdMm = upperDepthThresholdMm;
+
+  // Choose whether to run the per-pixel stages on the device or the CPU, and start timing them (including any transfers).
+  typedef boost::chrono::steady_clock Clock;
+  const Clock::time_point startTime = Clock::now();
+  const size_t placement = m_changeMaskPlacement ? m_changeMaskPlacement->choose() : 0;
+  const bool onCPU = placement == 1;
+  const ChangeMaskGenerator_CPtr& changeMaskGenerator = onCPU ? m_cpuChangeMaskGenerator : m_changeMaskGenerator;
 
-  // Get the depth raycast of the scene.
+  ITMFloatImage_CPtr thresholdedRawDepth = m_touchDetector->get_thresholded_raw_depth();
   ITMFloatImage_CPtr depthRaycast = m_touchDetector->get_depth_raycast();
-  depthRaycast->UpdateHostFromDevice();
-  const float *depthRaycastPtr = depthRaycast->GetData(MEMORYDEVICE_CPU);
-
-  // Compute a dilated, thresholded version of the gradient magnitude of the depth raycast.
-  const int width = depthRaycast->noDims.x, height = depthRaycast->noDims.y;
-  cv::Mat1b cvDepthRaycast = OpenCVUtil::make_greyscale_image(depthRaycastPtr, width, height, OpenCVUtil::ROW_MAJOR, 100.0f);
-  cv::Mat gradX, gradY, absGradX, absGradY, grad, depthEdges, dilatedDepthEdges;
-  cv::Sobel(cvDepthRaycast, gradX, CV_16S, 1, 0, 3);
-  cv::convertScaleAbs(gradX, absGradX);
-  cv::Sobel(cvDepthRaycast, gradY, CV_16S, 0, 1, 3);
-  cv::convertScaleAbs(gradY, absGradY);
-  cv::addWeighted(absGradX, 0.5, absGradY, 0.5, 0, grad);
-  cv::threshold(grad, depthEdges, depthEdgeThreshold, 255.0, cv::THRESH_BINARY);
-  cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(7, 7));
-  cv::dilate(depthEdges, dilatedDepthEdges, kernel);
-
-  // Get the difference between the live depth image and the depth raycast of the scene.
   ITMFloatImage_CPtr diffRawRaycast = m_touchDetector->get_diff_raw_raycast();
-  const float *diffRawRaycastPtr = diffRawRaycast->GetData(MEMORYDEVICE_CPU);
-
-  // Make an initial change mask, starting from the whole image and filtering out pixels based on some simple criteria.
-  static ITMUCharImage_Ptr changeMask(new ITMUCharImage(Vector2i(width, height), true, true));
-  uchar *changeMaskPtr = changeMask->GetData(MEMORYDEVICE_CPU);
-  const double halfWidth = width / 2.0, halfHeight = height / 2.0;
-  const int pixelCount = static_cast<int>(changeMask->dataSize);
-
-#if WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for(int i = 0; i < pixelCount; ++i)
+  if(onCPU)
   {
-    // Every pixel starts off as part of the change mask.
-    changeMaskPtr[i] = 255;
-
-    // If the live depth value for the pixel is invalid, remove it from the change mask (it can't form part of the final
-    // mask that we will use for object reconstruction, since without depth it can't be fused).
-    if(thresholdedRawDepthPtr[i] == -1.0f)
-    {
-      changeMaskPtr[i] = 0;
-      continue;
-    }
-
-    // If the depth raycast value for the pixel is invalid, remove it from the change mask (without a depth raycast value,
-    // we can't do background subtraction).
-    if(fabs(depthRaycastPtr[i] - m_touchDetector->invalid_depth_value()) < 1e-3f)
-    {
-      changeMaskPtr[i] = 0;
-      continue;
-    }
-
-    // If the live depth value for the pixel is too large, remove it from the change mask (the depth gets increasingly
-    // unreliable as we get further away from the sensor, so this helps us avoid corrupting our mask with noise).
-    if(thresholdedRawDepthPtr[i] * 1000.0f > upperDepthThresholdMm)
-    {
-      changeMaskPtr[i] = 0;
-      continue;
-    }
-
-    // If the pixel is close to the corners of the image, remove it from the change mask (the depth gets increasingly
-    // unreliable as we get further away from the centre of the image).
-    const int x = i % width, y = i / width;
-    const double xDist = fabs(x - halfWidth), yDist = fabs(y - halfHeight);
-    const double centreDist = sqrt((xDist * xDist + yDist * yDist) / (halfWidth * halfWidth + halfHeight * halfHeight));
-    if(static_cast<int>(centreDist * 100) > centreDistThreshold)
-    {
-      changeMaskPtr[i] = 0;
-      continue;
-    }
+    thresholdedRawDepth->UpdateHostFromDevice();
+    depthRaycast->UpdateHostFromDevice();
+    diffRawRaycast->UpdateHostFromDevice();
+  }
 
-    // If the difference between the pixel's values in the live depth image and the depth raycast is quite small,
-    // remove it from the change mask (this helps exclude minor differences that are caused by sensor noise).
-    const float diffRawRaycastMm = diffRawRaycastPtr[i] * 1000.0f;
-    if(diffRawRaycastMm < lowerDiffThresholdMm)
-    {
-      changeMaskPtr[i] = 0;
-      continue;
-    }
+  changeMaskGenerator->make_initial_change_mask(
+    thresholdedRawDepth.get(), depthRaycast.get(), diffRawRaycast.get(), m_touchDetector->invalid_depth_value(), thresholds
+  );
 
-    // If the pixel is close to an edge in the depth raycast and there isn't a fairly significant difference between
-    // its values in the live depth image and the depth raycast, remove it from the change mask (we insist on a larger
-    // difference than normal near depth raycast edges because depth values tend to be unreliable along such boundaries).
-    if(dilatedDepthEdges.data[i] && diffRawRaycastMm < lowerDiffThresholdNearEdgesMm)
-    {
-      changeMaskPtr[i] = 0;
-      continue;
-    }
-  }
+  // Copy the change mask across to the CPU (if necessary), and then into an OpenCV image, so that its contours can be analysed.
+  ITMUCharImage_Ptr changeMask = changeMaskGenerator->get_change_mask();
+  if(!onCPU) changeMask->UpdateHostFromDevice();
+  uchar *changeMaskPtr = changeMask->GetData(MEMORYDEVICE_CPU);
+  const int width = changeMask->noDims.x, height = changeMask->noDims.y;
+  const int pixelCount = static_cast<int>(changeMask->dataSize);
 
-  // Copy the change mask across to an OpenCV image.
   static cv::Mat1b cvChangeMask = cv::Mat1b::zeros(height, width);
-
-#if WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for(int i = 0; i < pixelCount; ++i)
-  {
-    cvChangeMask.data[i] = changeMaskPtr[i];
-  }
+  std::copy(changeMaskPtr, changeMaskPtr + pixelCount, cvChangeMask.data);
 
   // Find the connected components of the change mask.
   cv::Mat1i ccsImage, stats;
@@ -406,42 +361,15 @@ ITMUCharImage_CPtr BackgroundSubtractingObjectSegmenter::make_change_mask(const
   }
 
   // Cluster the pixels in the change mask by depth, and discard clusters that are below a certain size.
-  std::multimap<float,int> depthToPixels;
-  for(int i = 0; i < pixelCount; ++i)
-  {
-    if(changeMaskPtr[i])
-    {
-      depthToPixels.insert(std::make_pair(thresholdedRawDepthPtr[i], i));
-    }
-  }
-
-  std::vector<std::vector<int> > clusters;
-  boost::optional<float> lastDepth;
-  for(std::multimap<float,int>::const_iterator it = depthToPixels.begin(), iend = depthToPixels.end(); it != iend; ++it)
-  {
-    float depth = it->first;
-    if(!lastDepth || static_cast<int>(ROUND((depth - *lastDepth) * 1000)) > maxIntraClusterDepthDiffMm)
-    {
-      clusters.push_back(std::vector<int>());
-    }
-    lastDepth = depth;
-
-    clusters.back().push_back(it->second);
-  }
+  if(!onCPU) changeMask->UpdateDeviceFromHost();
+  changeMaskGenerator->remove_small_depth_clusters(thresholdedRawDepth.get(), maxIntraClusterDepthDiffMm, minClusterSize);
+  if(!onCPU) changeMask->UpdateHostFromDevice();
 
-  for(size_t i = 0, clusterCount = clusters.size(); i < clusterCount; ++i)
+  // If adaptive placement is enabled, record how long making the change mask took with the chosen placement.
+  if(m_changeMaskPlacement)
   {
-    const std::vector<int>& cluster = clusters[i];
-    const size_t clusterSize = cluster.size();
-
-    if(clusterSize < minClusterSize)
-    {
-      for(size_t j = 0; j < clusterSize; ++j)
-      {
-        cvChangeMask.data[cluster[j]] = 0;
-        changeMaskPtr[cluster[j]] = 0;
-      }
-    }
+    m_changeMaskPlacement->update(placement, boost::chrono::duration<double,boost::milli>(Clock::now() - startTime).count());
+    Profiler::instance().set_gauge("ChangeMask.OnCPU", m_changeMaskPlacement->get_cheapest_alternative() == 1 ? 1.0 : 0.0);
   }
 
 #if DEBUGGING
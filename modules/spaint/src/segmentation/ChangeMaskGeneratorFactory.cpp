@@ -0,0 +1,40 @@
+/**
+ * spaint: ChangeMaskGeneratorFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/ChangeMaskGeneratorFactory.h"
+using namespace ITMLib;
+
+#include "segmentation/cpu/ChangeMaskGenerator_CPU.h"
+
+#ifdef WITH_CUDA
+#include "segmentation/cuda/ChangeMaskGenerator_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+ChangeMaskGenerator_CPtr ChangeMaskGeneratorFactory::make_change_mask_generator(const Vector2i& imgSize, ITMLibSettings::DeviceType deviceType)
+{
+  ChangeMaskGenerator_CPtr generator;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    generator.reset(new ChangeMaskGenerator_CUDA(imgSize));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    generator.reset(new ChangeMaskGenerator_CPU(imgSize));
+  }
+
+  return generator;
+}
+
+}
@@ -5,6 +5,9 @@
 
 #include "segmentation/ColourAppearanceModel.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <tvgutil/containers/MapUtil.h>
 using namespace tvgutil;
 
@@ -15,32 +18,35 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 ColourAppearanceModel::ColourAppearanceModel(int binsCb, int binsCr)
-: m_binsCb(binsCb), m_binsCr(binsCr)
+: m_binsCb(binsCb), m_binsCr(binsCr), m_posteriors(binsCb * binsCr, 0.5f)
 {}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
-float ColourAppearanceModel::compute_posterior_probability(const Vector3u& rgbColour) const
+void ColourAppearanceModel::compute_posterior_image(const ITMUChar4Image_CPtr& image, const ITMFloatImage_Ptr& posteriorImage) const
 {
-  // If we haven't yet seen enough training data to successfully build our appearance model, early out.
-  if(!m_pmfColourGivenObject || !m_pmfColourGivenNotObject) return 0.5f;
-
-  /*
-  P(object | colour) =                   P(colour | object) * P(object)
-                       -----------------------------------------------------------------
-                       P(colour | object) * P(object) + P(colour | !object) * P(!object)
+  if(posteriorImage->noDims != image->noDims)
+  {
+    throw std::invalid_argument("Error: The posterior image must have the same size as the input image");
+  }
 
-  For simplicity, assume that P(object) = P(!object) = 0.5. Then:
+  const Vector4u *imagePtr = image->GetData(MEMORYDEVICE_CPU);
+  float *posteriorImagePtr = posteriorImage->GetData(MEMORYDEVICE_CPU);
+  const float *posteriors = &m_posteriors[0];
+  const int pixelCount = static_cast<int>(image->dataSize);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    posteriorImagePtr[i] = posteriors[compute_bin(imagePtr[i].toVector3())];
+  }
+}
 
-  P(object | colour) =            P(colour | object)
-                       ----------------------------------------
-                       P(colour | object) + P(colour | !object)
-  */
-  int bin = compute_bin(rgbColour);
-  float colourGivenObject = MapUtil::lookup(m_pmfColourGivenObject->get_masses(), bin, 0.0f);
-  float colourGivenNotObject = MapUtil::lookup(m_pmfColourGivenNotObject->get_masses(), bin, 0.0f);
-  float denom = colourGivenObject + colourGivenNotObject;
-  return denom > 0.0f ? colourGivenObject / denom : 0.5f;
+float ColourAppearanceModel::compute_posterior_probability(const Vector3u& rgbColour) const
+{
+  return m_posteriors[compute_bin(rgbColour)];
 }
 
 void ColourAppearanceModel::train(const ITMUChar4Image_CPtr& image, const ITMUCharImage_CPtr& objectMask)
@@ -57,6 +63,9 @@ void ColourAppearanceModel::train(const ITMUChar4Image_CPtr& image, const ITMUCh
   // Update the likelihood PMFs from the histograms.
   if(m_histColourGivenObject.get_count() > 0) m_pmfColourGivenObject.reset(new ProbabilityMassFunction<int>(m_histColourGivenObject));
   if(m_histColourGivenNotObject.get_count() > 0) m_pmfColourGivenNotObject.reset(new ProbabilityMassFunction<int>(m_histColourGivenNotObject));
+
+  // Regenerate the lookup table of posterior probabilities.
+  update_posteriors();
 }
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
@@ -71,4 +80,35 @@ int ColourAppearanceModel::compute_bin(const Vector3u& rgbColour) const
   return y * m_binsCb + x;
 }
 
+void ColourAppearanceModel::update_posteriors()
+{
+  // If we haven't yet seen enough training data to successfully build our appearance model, use an uninformative posterior.
+  if(!m_pmfColourGivenObject || !m_pmfColourGivenNotObject)
+  {
+    std::fill(m_posteriors.begin(), m_posteriors.end(), 0.5f);
+    return;
+  }
+
+  /*
+  P(object | colour) =                   P(colour | object) * P(object)
+                       -----------------------------------------------------------------
+                       P(colour | object) * P(object) + P(colour | !object) * P(!object)
+
+  For simplicity, assume that P(object) = P(!object) = 0.5. Then:
+
+  P(object | colour) =            P(colour | object)
+                       ----------------------------------------
+                       P(colour | object) + P(colour | !object)
+  */
+  const std::map<int,float>& massesGivenObject = m_pmfColourGivenObject->get_masses();
+  const std::map<int,float>& massesGivenNotObject = m_pmfColourGivenNotObject->get_masses();
+  for(int bin = 0, binCount = static_cast<int>(m_posteriors.size()); bin < binCount; ++bin)
+  {
+    float colourGivenObject = MapUtil::lookup(massesGivenObject, bin, 0.0f);
+    float colourGivenNotObject = MapUtil::lookup(massesGivenNotObject, bin, 0.0f);
+    float denom = colourGivenObject + colourGivenNotObject;
+    m_posteriors[bin] = denom > 0.0f ? colourGivenObject / denom : 0.5f;
+  }
+}
+
 }
@@ -0,0 +1,40 @@
+/**
+ * spaint: DepthMaskerFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/DepthMaskerFactory.h"
+using namespace ITMLib;
+
+#include "segmentation/cpu/DepthMasker_CPU.h"
+
+#ifdef WITH_CUDA
+#include "segmentation/cuda/DepthMasker_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+DepthMasker_Ptr DepthMaskerFactory::make_depth_masker(ITMLibSettings::DeviceType deviceType)
+{
+  DepthMasker_Ptr masker;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    masker.reset(new DepthMasker_CUDA);
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    masker.reset(new DepthMasker_CPU);
+  }
+
+  return masker;
+}
+
+}
@@ -9,6 +9,28 @@ namespace spaint {
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
+boost::optional<Vector4i> SegmentationUtil::compute_bounding_box(const ITMUCharImage_CPtr& mask)
+{
+  const int width = mask->noDims.x, height = mask->noDims.y;
+  const uchar *maskPtr = mask->GetData(MEMORYDEVICE_CPU);
+
+  Vector4i box(width, height, -1, -1);
+  for(int y = 0; y < height; ++y)
+  {
+    const uchar *row = maskPtr + y * width;
+    for(int x = 0; x < width; ++x)
+    {
+      if(!row[x]) continue;
+      if(x < box.x) box.x = x;
+      if(x > box.z) box.z = x;
+      box.w = y;
+      if(box.y == height) box.y = y;
+    }
+  }
+
+  return box.z >= 0 ? boost::optional<Vector4i>(box) : boost::none;
+}
+
 ITMUCharImage_Ptr SegmentationUtil::invert_mask(const ITMUCharImage_CPtr& mask)
 {
   ITMUCharImage_Ptr invertedMask(new ITMUCharImage(mask->noDims, true, false));
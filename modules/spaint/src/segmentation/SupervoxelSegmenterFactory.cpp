@@ -0,0 +1,41 @@
+/**
+ * spaint: SupervoxelSegmenterFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/SupervoxelSegmenterFactory.h"
+using namespace ITMLib;
+
+#include "segmentation/cpu/SupervoxelSegmenter_CPU.h"
+
+#ifdef WITH_CUDA
+#include "segmentation/cuda/SupervoxelSegmenter_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+SupervoxelSegmenter_CPtr SupervoxelSegmenterFactory::make_supervoxel_segmenter(const Vector2i& imageSize, int seedSpacing, int memberStride, float maxRadius,
+                                                                               float maxNormalAngle, float maxColourDistance, ITMLibSettings::DeviceType deviceType)
+{
+  SupervoxelSegmenter_CPtr segmenter;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    segmenter.reset(new SupervoxelSegmenter_CUDA(imageSize, seedSpacing, memberStride, maxRadius, maxNormalAngle, maxColourDistance));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    segmenter.reset(new SupervoxelSegmenter_CPU(imageSize, seedSpacing, memberStride, maxRadius, maxNormalAngle, maxColourDistance));
+  }
+
+  return segmenter;
+}
+
+}
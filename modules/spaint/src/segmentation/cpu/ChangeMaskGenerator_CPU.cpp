@@ -0,0 +1,101 @@
+/**
+ * spaint: ChangeMaskGenerator_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/cpu/ChangeMaskGenerator_CPU.h"
+
+#include "segmentation/shared/ChangeMaskGenerator_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ChangeMaskGenerator_CPU::ChangeMaskGenerator_CPU(const Vector2i& imgSize)
+: ChangeMaskGenerator(imgSize)
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ChangeMaskGenerator_CPU::make_initial_change_mask(const ITMFloatImage *thresholdedRawDepth, const ITMFloatImage *depthRaycast, const ITMFloatImage *diffRawRaycast,
+                                                       float invalidDepthValue, const Thresholds& thresholds) const
+{
+  const int width = m_changeMask->noDims.x, height = m_changeMask->noDims.y;
+  const int pixelCount = width * height;
+  const float *depthRaycastPtr = depthRaycast->GetData(MEMORYDEVICE_CPU);
+  unsigned char *depthEdges = m_depthEdges->GetData(MEMORYDEVICE_CPU);
+  unsigned char *dilatedDepthEdges = m_dilatedDepthEdges->GetData(MEMORYDEVICE_CPU);
+  unsigned char *dilationBuffer = m_dilationBuffer->GetData(MEMORYDEVICE_CPU);
+
+  // Find the edges in the gradient magnitude image of the depth raycast.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    detect_depth_edge(i % width, i / width, depthRaycastPtr, width, height, thresholds.depthEdgeThreshold, depthEdges);
+  }
+
+  // Dilate the edges using a 7x7 square kernel (this is separable, so we dilate horizontally and then vertically).
+  const int dilationRadius = 3;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    dilate_pixel(i % width, i / width, depthEdges, width, height, dilationRadius, true, dilationBuffer);
+  }
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    dilate_pixel(i % width, i / width, dilationBuffer, width, height, dilationRadius, false, dilatedDepthEdges);
+  }
+
+  // Make the initial change mask.
+  const float *thresholdedRawDepthPtr = thresholdedRawDepth->GetData(MEMORYDEVICE_CPU);
+  const float *diffRawRaycastPtr = diffRawRaycast->GetData(MEMORYDEVICE_CPU);
+  unsigned char *changeMask = m_changeMask->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    make_initial_change_pixel(
+      i, width, height, thresholdedRawDepthPtr, depthRaycastPtr, diffRawRaycastPtr, dilatedDepthEdges, invalidDepthValue, thresholds, changeMask
+    );
+  }
+}
+
+void ChangeMaskGenerator_CPU::remove_small_depth_clusters(const ITMFloatImage *thresholdedRawDepth, int maxIntraClusterDepthDiffMm, int minClusterSize) const
+{
+  const int pixelCount = static_cast<int>(m_changeMask->dataSize);
+  const float *thresholdedRawDepthPtr = thresholdedRawDepth->GetData(MEMORYDEVICE_CPU);
+  unsigned char *changeMask = m_changeMask->GetData(MEMORYDEVICE_CPU);
+  int *depthHistogram = m_depthHistogramMB->GetData(MEMORYDEVICE_CPU);
+  unsigned char *smallClusterDepths = m_smallClusterDepthsMB->GetData(MEMORYDEVICE_CPU);
+
+  // Make a histogram of the depths of the pixels in the change mask.
+  m_depthHistogramMB->Clear();
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    if(changeMask[i]) ++depthHistogram[calculate_depth_bin(thresholdedRawDepthPtr[i], MAX_DEPTH_MM)];
+  }
+
+  // Cluster the depths, and remove any pixels in clusters that are too small from the change mask.
+  find_small_depth_clusters(depthHistogram, MAX_DEPTH_MM + 1, maxIntraClusterDepthDiffMm, minClusterSize, smallClusterDepths);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    remove_small_depth_cluster_pixel(i, thresholdedRawDepthPtr, smallClusterDepths, MAX_DEPTH_MM, changeMask);
+  }
+}
+
+}
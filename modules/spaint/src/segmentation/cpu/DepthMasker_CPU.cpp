@@ -0,0 +1,30 @@
+/**
+ * spaint: DepthMasker_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/cpu/DepthMasker_CPU.h"
+
+#include "segmentation/shared/DepthMasker_Shared.h"
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DepthMasker_CPU::mask_depth(const ITMUCharImage_CPtr& mask, const ITMFloatImage *depth, float backgroundValue, ITMFloatImage *maskedDepth)
+{
+  const unsigned char *maskPtr = mask->GetData(MEMORYDEVICE_CPU);
+  const float *depthPtr = depth->GetData(MEMORYDEVICE_CPU);
+  float *maskedDepthPtr = maskedDepth->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(depth->dataSize);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex)
+  {
+    mask_depth_pixel(pixelIndex, maskPtr, depthPtr, backgroundValue, maskedDepthPtr);
+  }
+}
+
+}
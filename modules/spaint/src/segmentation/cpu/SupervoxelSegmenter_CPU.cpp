@@ -0,0 +1,66 @@
+/**
+ * spaint: SupervoxelSegmenter_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/cpu/SupervoxelSegmenter_CPU.h"
+
+#include "segmentation/shared/SupervoxelSegmenter_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SupervoxelSegmenter_CPU::SupervoxelSegmenter_CPU(const Vector2i& imageSize, int seedSpacing, int memberStride, float maxRadius, float maxNormalAngle, float maxColourDistance)
+: SupervoxelSegmenter(imageSize, seedSpacing, memberStride, maxRadius, maxNormalAngle, maxColourDistance)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void SupervoxelSegmenter_CPU::assign_members(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& seedLabelsMB,
+                                             ORUtils::MemoryBlock<Vector3s>& memberLocationsMB, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& memberLabelsMB) const
+{
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const int memberCount = static_cast<int>(get_member_count());
+  SpaintVoxel::PackedLabel *memberLabels = memberLabelsMB.GetData(MEMORYDEVICE_CPU);
+  Vector3s *memberLocations = memberLocationsMB.GetData(MEMORYDEVICE_CPU);
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel::PackedLabel *seedLabels = seedLabelsMB.GetData(MEMORYDEVICE_CPU);
+  const Seed *seeds = m_seedsMB->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int memberIndex = 0; memberIndex < memberCount; ++memberIndex)
+  {
+    assign_member(
+      memberIndex, m_memberGridWidth, m_memberStride, m_imageSize.width, m_gridWidth, m_gridHeight, m_seedSpacing, raycastResultData,
+      voxelData, labelData, indexData, seeds, seedLabels, m_maxRadius, m_minNormalDot, m_maxColourDistance, memberLocations, memberLabels
+    );
+  }
+}
+
+void SupervoxelSegmenter_CPU::select_seeds(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& seedLocationsMB) const
+{
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  const int seedCount = static_cast<int>(get_seed_count());
+  Vector3s *seedLocations = seedLocationsMB.GetData(MEMORYDEVICE_CPU);
+  Seed *seeds = m_seedsMB->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int cellIndex = 0; cellIndex < seedCount; ++cellIndex)
+  {
+    select_seed(
+      cellIndex, m_gridWidth, m_seedSpacing, m_memberStride, m_imageSize.width, m_imageSize.height,
+      raycastResultData, voxelData, indexData, seeds, seedLocations
+    );
+  }
+}
+
+}
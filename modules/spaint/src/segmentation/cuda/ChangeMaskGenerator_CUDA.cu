@@ -0,0 +1,134 @@
+/**
+ * spaint: ChangeMaskGenerator_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/cuda/ChangeMaskGenerator_CUDA.h"
+
+#include "segmentation/shared/ChangeMaskGenerator_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_accumulate_depth_histogram(const float *thresholdedRawDepth, const unsigned char *changeMask, int pixelCount, int *depthHistogram)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < pixelCount && changeMask[tid])
+  {
+    atomicAdd(&depthHistogram[calculate_depth_bin(thresholdedRawDepth[tid], ChangeMaskGenerator::MAX_DEPTH_MM)], 1);
+  }
+}
+
+__global__ void ck_detect_depth_edges(const float *depthRaycast, int width, int height, int depthEdgeThreshold, unsigned char *depthEdges)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < width * height)
+  {
+    detect_depth_edge(tid % width, tid / width, depthRaycast, width, height, depthEdgeThreshold, depthEdges);
+  }
+}
+
+__global__ void ck_dilate(const unsigned char *input, int width, int height, int radius, bool horizontal, unsigned char *output)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < width * height)
+  {
+    dilate_pixel(tid % width, tid / width, input, width, height, radius, horizontal, output);
+  }
+}
+
+__global__ void ck_find_small_depth_clusters(const int *depthHistogram, int maxGap, int minClusterSize, unsigned char *smallClusterDepths)
+{
+  // The histogram is small, so a single thread can cluster it without needing to copy it back across to the CPU.
+  find_small_depth_clusters(depthHistogram, ChangeMaskGenerator::MAX_DEPTH_MM + 1, maxGap, minClusterSize, smallClusterDepths);
+}
+
+__global__ void ck_make_initial_change_mask(int width, int height, const float *thresholdedRawDepth, const float *depthRaycast, const float *diffRawRaycast,
+                                            const unsigned char *dilatedDepthEdges, float invalidDepthValue, ChangeMaskGenerator::Thresholds thresholds,
+                                            unsigned char *changeMask)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < width * height)
+  {
+    make_initial_change_pixel(tid, width, height, thresholdedRawDepth, depthRaycast, diffRawRaycast, dilatedDepthEdges, invalidDepthValue, thresholds, changeMask);
+  }
+}
+
+__global__ void ck_remove_small_depth_clusters(const float *thresholdedRawDepth, const unsigned char *smallClusterDepths, int pixelCount, unsigned char *changeMask)
+{
+  int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < pixelCount)
+  {
+    remove_small_depth_cluster_pixel(tid, thresholdedRawDepth, smallClusterDepths, ChangeMaskGenerator::MAX_DEPTH_MM, changeMask);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+ChangeMaskGenerator_CUDA::ChangeMaskGenerator_CUDA(const Vector2i& imgSize)
+: ChangeMaskGenerator(imgSize)
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ChangeMaskGenerator_CUDA::make_initial_change_mask(const ITMFloatImage *thresholdedRawDepth, const ITMFloatImage *depthRaycast, const ITMFloatImage *diffRawRaycast,
+                                                        float invalidDepthValue, const Thresholds& thresholds) const
+{
+  const int width = m_changeMask->noDims.x, height = m_changeMask->noDims.y;
+  const int pixelCount = width * height;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Find the edges in the gradient magnitude image of the depth raycast.
+  ck_detect_depth_edges<<<numBlocks,threadsPerBlock>>>(
+    depthRaycast->GetData(MEMORYDEVICE_CUDA), width, height, thresholds.depthEdgeThreshold, m_depthEdges->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Dilate the edges using a 7x7 square kernel (this is separable, so we dilate horizontally and then vertically).
+  const int dilationRadius = 3;
+  ck_dilate<<<numBlocks,threadsPerBlock>>>(
+    m_depthEdges->GetData(MEMORYDEVICE_CUDA), width, height, dilationRadius, true, m_dilationBuffer->GetData(MEMORYDEVICE_CUDA)
+  );
+  ck_dilate<<<numBlocks,threadsPerBlock>>>(
+    m_dilationBuffer->GetData(MEMORYDEVICE_CUDA), width, height, dilationRadius, false, m_dilatedDepthEdges->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Make the initial change mask.
+  ck_make_initial_change_mask<<<numBlocks,threadsPerBlock>>>(
+    width, height,
+    thresholdedRawDepth->GetData(MEMORYDEVICE_CUDA),
+    depthRaycast->GetData(MEMORYDEVICE_CUDA),
+    diffRawRaycast->GetData(MEMORYDEVICE_CUDA),
+    m_dilatedDepthEdges->GetData(MEMORYDEVICE_CUDA),
+    invalidDepthValue,
+    thresholds,
+    m_changeMask->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void ChangeMaskGenerator_CUDA::remove_small_depth_clusters(const ITMFloatImage *thresholdedRawDepth, int maxIntraClusterDepthDiffMm, int minClusterSize) const
+{
+  const int pixelCount = static_cast<int>(m_changeMask->dataSize);
+  const float *thresholdedRawDepthPtr = thresholdedRawDepth->GetData(MEMORYDEVICE_CUDA);
+  unsigned char *changeMask = m_changeMask->GetData(MEMORYDEVICE_CUDA);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Make a histogram of the depths of the pixels in the change mask.
+  m_depthHistogramMB->Clear();
+  ck_accumulate_depth_histogram<<<numBlocks,threadsPerBlock>>>(thresholdedRawDepthPtr, changeMask, pixelCount, m_depthHistogramMB->GetData(MEMORYDEVICE_CUDA));
+
+  // Cluster the depths, and remove any pixels in clusters that are too small from the change mask.
+  ck_find_small_depth_clusters<<<1,1>>>(
+    m_depthHistogramMB->GetData(MEMORYDEVICE_CUDA), maxIntraClusterDepthDiffMm, minClusterSize, m_smallClusterDepthsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  ck_remove_small_depth_clusters<<<numBlocks,threadsPerBlock>>>(
+    thresholdedRawDepthPtr, m_smallClusterDepthsMB->GetData(MEMORYDEVICE_CUDA), pixelCount, changeMask
+  );
+}
+
+}
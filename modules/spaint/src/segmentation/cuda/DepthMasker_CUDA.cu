@@ -0,0 +1,57 @@
+/**
+ * spaint: DepthMasker_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/cuda/DepthMasker_CUDA.h"
+
+#include <itmx/base/MemoryBlockFactory.h>
+using namespace itmx;
+
+#include "segmentation/shared/DepthMasker_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_mask_depth(const unsigned char *mask, const float *depth, int pixelCount, float backgroundValue, float *maskedDepth)
+{
+  int pixelIndex = threadIdx.x + blockIdx.x * blockDim.x;
+  if(pixelIndex < pixelCount)
+  {
+    mask_depth_pixel(pixelIndex, mask, depth, backgroundValue, maskedDepth);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+DepthMasker_CUDA::DepthMasker_CUDA()
+: m_uploadedMaskCopy(MemoryBlockFactory::instance().make_image<unsigned char>(Vector2i(0, 0), "DepthMasker"))
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void DepthMasker_CUDA::mask_depth(const ITMUCharImage_CPtr& mask, const ITMFloatImage *depth, float backgroundValue, ITMFloatImage *maskedDepth)
+{
+  // If the mask has changed since it was last uploaded, upload it to the GPU.
+  if(mask != m_uploadedMask)
+  {
+    if(m_uploadedMaskCopy->noDims != mask->noDims) m_uploadedMaskCopy->ChangeDims(mask->noDims);
+    m_uploadedMaskCopy->SetFrom(mask.get(), ITMUCharImage::CPU_TO_CUDA);
+    m_uploadedMask = mask;
+  }
+
+  int pixelCount = static_cast<int>(depth->dataSize);
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_mask_depth<<<numBlocks,threadsPerBlock>>>(
+    m_uploadedMaskCopy->GetData(MEMORYDEVICE_CUDA),
+    depth->GetData(MEMORYDEVICE_CUDA),
+    pixelCount,
+    backgroundValue,
+    maskedDepth->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,99 @@
+/**
+ * spaint: SupervoxelSegmenter_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/cuda/SupervoxelSegmenter_CUDA.h"
+
+#include "segmentation/shared/SupervoxelSegmenter_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_assign_members(int memberCount, int memberGridWidth, int memberStride, int width, int gridWidth, int gridHeight, int seedSpacing,
+                                  const Vector4f *raycastResult, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                  const ITMVoxelIndex::IndexData *indexData, const SupervoxelSegmenter::Seed *seeds, const SpaintVoxel::PackedLabel *seedLabels,
+                                  float maxRadius, float minNormalDot, float maxColourDistance, Vector3s *memberLocations, SpaintVoxel::PackedLabel *memberLabels)
+{
+  int memberIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(memberIndex < memberCount)
+  {
+    assign_member(
+      memberIndex, memberGridWidth, memberStride, width, gridWidth, gridHeight, seedSpacing, raycastResult, voxelData, labelData,
+      indexData, seeds, seedLabels, maxRadius, minNormalDot, maxColourDistance, memberLocations, memberLabels
+    );
+  }
+}
+
+__global__ void ck_select_seeds(int seedCount, int gridWidth, int seedSpacing, int memberStride, int width, int height, const Vector4f *raycastResult,
+                                const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData, SupervoxelSegmenter::Seed *seeds, Vector3s *seedLocations)
+{
+  int cellIndex = threadIdx.x + blockDim.x * blockIdx.x;
+  if(cellIndex < seedCount)
+  {
+    select_seed(cellIndex, gridWidth, seedSpacing, memberStride, width, height, raycastResult, voxelData, indexData, seeds, seedLocations);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+SupervoxelSegmenter_CUDA::SupervoxelSegmenter_CUDA(const Vector2i& imageSize, int seedSpacing, int memberStride, float maxRadius, float maxNormalAngle, float maxColourDistance)
+: SupervoxelSegmenter(imageSize, seedSpacing, memberStride, maxRadius, maxNormalAngle, maxColourDistance)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void SupervoxelSegmenter_CUDA::assign_members(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& seedLabelsMB,
+                                              ORUtils::MemoryBlock<Vector3s>& memberLocationsMB, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& memberLabelsMB) const
+{
+  const int memberCount = static_cast<int>(get_member_count());
+
+  int threadsPerBlock = 256;
+  int numBlocks = (memberCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_assign_members<<<numBlocks,threadsPerBlock>>>(
+    memberCount,
+    m_memberGridWidth,
+    m_memberStride,
+    m_imageSize.width,
+    m_gridWidth,
+    m_gridHeight,
+    m_seedSpacing,
+    raycastResult->GetData(MEMORYDEVICE_CUDA),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->index.getIndexData(),
+    m_seedsMB->GetData(MEMORYDEVICE_CUDA),
+    seedLabelsMB.GetData(MEMORYDEVICE_CUDA),
+    m_maxRadius,
+    m_minNormalDot,
+    m_maxColourDistance,
+    memberLocationsMB.GetData(MEMORYDEVICE_CUDA),
+    memberLabelsMB.GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void SupervoxelSegmenter_CUDA::select_seeds(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& seedLocationsMB) const
+{
+  const int seedCount = static_cast<int>(get_seed_count());
+
+  int threadsPerBlock = 256;
+  int numBlocks = (seedCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_select_seeds<<<numBlocks,threadsPerBlock>>>(
+    seedCount,
+    m_gridWidth,
+    m_seedSpacing,
+    m_memberStride,
+    m_imageSize.width,
+    m_imageSize.height,
+    raycastResult->GetData(MEMORYDEVICE_CUDA),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->index.getIndexData(),
+    m_seedsMB->GetData(MEMORYDEVICE_CUDA),
+    seedLocationsMB.GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
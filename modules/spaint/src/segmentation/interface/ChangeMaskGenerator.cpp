@@ -0,0 +1,42 @@
+/**
+ * spaint: ChangeMaskGenerator.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/interface/ChangeMaskGenerator.h"
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTANTS ####################
+
+const int ChangeMaskGenerator::MAX_DEPTH_MM;
+
+//#################### CONSTRUCTORS ####################
+
+ChangeMaskGenerator::ChangeMaskGenerator(const Vector2i& imgSize)
+{
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+
+  m_changeMask = mbf.make_image<unsigned char>(imgSize, "ChangeMaskGenerator");
+  m_depthHistogramMB = mbf.make_block<int>(MAX_DEPTH_MM + 1, "ChangeMaskGenerator");
+  m_depthEdges = mbf.make_image<unsigned char>(imgSize, "ChangeMaskGenerator");
+  m_dilatedDepthEdges = mbf.make_image<unsigned char>(imgSize, "ChangeMaskGenerator");
+  m_dilationBuffer = mbf.make_image<unsigned char>(imgSize, "ChangeMaskGenerator");
+  m_smallClusterDepthsMB = mbf.make_block<unsigned char>(MAX_DEPTH_MM + 1, "ChangeMaskGenerator");
+}
+
+//#################### DESTRUCTOR ####################
+
+ChangeMaskGenerator::~ChangeMaskGenerator() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMUCharImage_Ptr ChangeMaskGenerator::get_change_mask() const
+{
+  return m_changeMask;
+}
+
+}
@@ -0,0 +1,41 @@
+/**
+ * spaint: DepthMasker.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/interface/DepthMasker.h"
+
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using namespace itmx;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+DepthMasker::DepthMasker()
+: m_maskedDepth(MemoryBlockFactory::instance().make_image<float>(Vector2i(0, 0), "DepthMasker"))
+{}
+
+//#################### DESTRUCTOR ####################
+
+DepthMasker::~DepthMasker() {}
+
+//#################### PUBLIC OPERATORS ####################
+
+const ITMFloatImage_Ptr& DepthMasker::operator()(const ITMUCharImage_CPtr& mask, const ITMFloatImage *depth, float backgroundValue)
+{
+  if(mask->noDims != depth->noDims)
+  {
+    throw std::invalid_argument("Error: The mask and the depth image to which it is applied must be the same size");
+  }
+
+  // Note: The buffer will only be reallocated if the size of the depth images changes.
+  if(m_maskedDepth->noDims != depth->noDims) m_maskedDepth->ChangeDims(depth->noDims);
+
+  mask_depth(mask, depth, backgroundValue, m_maskedDepth.get());
+  return m_maskedDepth;
+}
+
+}
@@ -0,0 +1,84 @@
+/**
+ * spaint: SupervoxelSegmenter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "segmentation/interface/SupervoxelSegmenter.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SupervoxelSegmenter::SupervoxelSegmenter(const Vector2i& imageSize, int seedSpacing, int memberStride, float maxRadius, float maxNormalAngle, float maxColourDistance)
+: m_imageSize(imageSize),
+  m_maxColourDistance(maxColourDistance),
+  m_maxRadius(maxRadius),
+  m_memberStride(memberStride),
+  m_seedSpacing(seedSpacing)
+{
+  if(seedSpacing < 1) throw std::invalid_argument("Error: The seed spacing of a supervoxel segmenter must be at least one pixel");
+  if(memberStride < 1) throw std::invalid_argument("Error: The member stride of a supervoxel segmenter must be at least one pixel");
+  if(maxRadius <= 0.0f) throw std::invalid_argument("Error: The maximum radius of a supervoxel must be positive");
+  if(maxColourDistance <= 0.0f) throw std::invalid_argument("Error: The maximum colour distance within a supervoxel must be positive");
+  if(maxNormalAngle <= 0.0f || maxNormalAngle > static_cast<float>(M_PI))
+  {
+    throw std::invalid_argument("Error: The maximum normal angle within a supervoxel must be in the range (0,pi]");
+  }
+
+  m_gridWidth = (imageSize.width + seedSpacing - 1) / seedSpacing;
+  m_gridHeight = (imageSize.height + seedSpacing - 1) / seedSpacing;
+  m_memberGridWidth = (imageSize.width + memberStride - 1) / memberStride;
+  m_memberGridHeight = (imageSize.height + memberStride - 1) / memberStride;
+  m_minNormalDot = cosf(maxNormalAngle);
+
+  m_seedsMB = MemoryBlockFactory::instance().make_block<Seed>(m_gridWidth * m_gridHeight, "SupervoxelSegmenter");
+}
+
+//#################### DESTRUCTOR ####################
+
+SupervoxelSegmenter::~SupervoxelSegmenter() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SupervoxelSegmenter::broadcast_labels(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, const ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& seedLabelsMB,
+                                           ORUtils::MemoryBlock<Vector3s>& memberLocationsMB, ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>& memberLabelsMB) const
+{
+  check_raycast_result_size(raycastResult);
+  assign_members(raycastResult, scene, seedLabelsMB, memberLocationsMB, memberLabelsMB);
+  memberLocationsMB.dataSize = memberLabelsMB.dataSize = get_member_count();
+}
+
+size_t SupervoxelSegmenter::get_member_count() const
+{
+  return static_cast<size_t>(m_memberGridWidth * m_memberGridHeight);
+}
+
+size_t SupervoxelSegmenter::get_seed_count() const
+{
+  return static_cast<size_t>(m_gridWidth * m_gridHeight);
+}
+
+void SupervoxelSegmenter::segment(const ITMFloat4Image *raycastResult, const SpaintVoxelScene *scene, ORUtils::MemoryBlock<Vector3s>& seedLocationsMB) const
+{
+  check_raycast_result_size(raycastResult);
+  select_seeds(raycastResult, scene, seedLocationsMB);
+  seedLocationsMB.dataSize = get_seed_count();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void SupervoxelSegmenter::check_raycast_result_size(const ITMFloat4Image *raycastResult) const
+{
+  if(raycastResult->noDims != m_imageSize)
+  {
+    throw std::invalid_argument("Error: The raycast result is not of the size expected by the supervoxel segmenter");
+  }
+}
+
+}
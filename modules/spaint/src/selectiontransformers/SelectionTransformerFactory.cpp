@@ -7,9 +7,11 @@
 using namespace ITMLib;
 
 #include "selectiontransformers/cpu/VoxelToCubeSelectionTransformer_CPU.h"
+#include "selectiontransformers/cpu/VoxelToSurfaceSelectionTransformer_CPU.h"
 
 #ifdef WITH_CUDA
 #include "selectiontransformers/cuda/VoxelToCubeSelectionTransformer_CUDA.h"
+#include "selectiontransformers/cuda/VoxelToSurfaceSelectionTransformer_CUDA.h"
 #endif
 
 namespace spaint {
@@ -37,4 +39,25 @@ SelectionTransformer_Ptr SelectionTransformerFactory::make_voxel_to_cube(int rad
   return transformer;
 }
 
+SelectionTransformer_Ptr SelectionTransformerFactory::make_voxel_to_surface(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene, ITMLibSettings::DeviceType deviceType)
+{
+  SelectionTransformer_Ptr transformer;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    transformer.reset(new VoxelToSurfaceSelectionTransformer_CUDA(radius, maxSDF, scene));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU to false if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    transformer.reset(new VoxelToSurfaceSelectionTransformer_CPU(radius, maxSDF, scene));
+  }
+
+  return transformer;
+}
+
 }
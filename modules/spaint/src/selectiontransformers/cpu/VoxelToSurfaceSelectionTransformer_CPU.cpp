@@ -0,0 +1,88 @@
+/**
+ * spaint: VoxelToSurfaceSelectionTransformer_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "selectiontransformers/cpu/VoxelToSurfaceSelectionTransformer_CPU.h"
+using namespace ITMLib;
+
+#include <algorithm>
+#include <vector>
+
+#include "selectiontransformers/shared/VoxelToSurfaceSelectionTransformer_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelToSurfaceSelectionTransformer_CPU::VoxelToSurfaceSelectionTransformer_CPU(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene)
+: VoxelToSurfaceSelectionTransformer(radius, maxSDF, scene, ITMLibSettings::DEVICE_CPU)
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VoxelToSurfaceSelectionTransformer_CPU::transform_selection(const Selection& inputSelectionMB, Selection& outputSelectionMB) const
+{
+  const Vector3s *inputSelection = inputSelectionMB.GetData(MEMORYDEVICE_CPU);
+  Vector3s *outputSelection = outputSelectionMB.GetData(MEMORYDEVICE_CPU);
+  const int inputVoxelCount = static_cast<int>(inputSelectionMB.dataSize);
+  const int maxVoxelsPerSphere = max_voxels_per_sphere();
+  const int radiusSquared = m_radius * m_radius;
+
+  const ITMVoxelIndex::IndexData *voxelIndex = m_scene->index.getIndexData();
+  const SpaintVoxel *voxelData = m_scene->localVBA.GetVoxelBlocks();
+  const SpaintVoxelScene::BlockOccupancy *blockOccupancy = m_scene->get_block_occupancy_data();
+
+  // Select the surface voxels around each initial voxel, writing them into a separate region of the output selection for each sphere.
+  std::vector<int> sphereVoxelCounts(inputVoxelCount, 0);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < inputVoxelCount; ++i)
+  {
+    const Vector3i centre = inputSelection[i].toInt();
+    Vector3i minBlockPos, maxBlockPos;
+    pointToVoxelBlockPos(Vector3i(centre.x - m_radius, centre.y - m_radius, centre.z - m_radius), minBlockPos);
+    pointToVoxelBlockPos(Vector3i(centre.x + m_radius, centre.y + m_radius, centre.z + m_radius), maxBlockPos);
+
+    Vector3s *sphereSelection = outputSelection + i * maxVoxelsPerSphere;
+    int& sphereVoxelCount = sphereVoxelCounts[i];
+
+    Vector3i blockPos;
+    for(blockPos.z = minBlockPos.z; blockPos.z <= maxBlockPos.z; ++blockPos.z)
+    {
+      for(blockPos.y = minBlockPos.y; blockPos.y <= maxBlockPos.y; ++blockPos.y)
+      {
+        for(blockPos.x = minBlockPos.x; blockPos.x <= maxBlockPos.x; ++blockPos.x)
+        {
+          if(!block_intersects_sphere(blockPos, centre, radiusSquared)) continue;
+
+          const int blockAddress = find_surface_block(blockPos, voxelIndex, blockOccupancy);
+          if(blockAddress < 0) continue;
+
+          for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+          {
+            if(select_surface_voxel(linearIdx, blockPos, blockAddress, centre, radiusSquared, m_maxSDF, voxelData, sphereSelection[sphereVoxelCount]))
+            {
+              ++sphereVoxelCount;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Compact the selected voxels to the start of the output selection, and shrink it to fit them.
+  int outputVoxelCount = 0;
+  for(int i = 0; i < inputVoxelCount; ++i)
+  {
+    const Vector3s *sphereSelection = outputSelection + i * maxVoxelsPerSphere;
+    std::copy(sphereSelection, sphereSelection + sphereVoxelCounts[i], outputSelection + outputVoxelCount);
+    outputVoxelCount += sphereVoxelCounts[i];
+  }
+
+  outputSelectionMB.dataSize = outputVoxelCount;
+}
+
+}
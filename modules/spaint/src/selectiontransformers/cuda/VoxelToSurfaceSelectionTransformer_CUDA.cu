@@ -0,0 +1,92 @@
+/**
+ * spaint: VoxelToSurfaceSelectionTransformer_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "selectiontransformers/cuda/VoxelToSurfaceSelectionTransformer_CUDA.h"
+using namespace ITMLib;
+
+#include <ORUtils/CUDADefines.h>
+
+#include "selectiontransformers/shared/VoxelToSurfaceSelectionTransformer_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_select_surface_voxels(int blockSpan, int radius, int radiusSquared, float maxSDF, const Vector3s *inputSelection,
+                                       const ITMVoxelIndex::IndexData *voxelIndex, const SpaintVoxel *voxelData,
+                                       const SpaintVoxelScene::BlockOccupancy *blockOccupancy, Vector3s *outputSelection, int *outputVoxelCount)
+{
+  __shared__ int blockAddress;
+
+  // Each thread block examines a single voxel block in the cube of blocks around a single input voxel, with one thread per voxel.
+  const Vector3i centre = inputSelection[blockIdx.y].toInt();
+  Vector3i minBlockPos;
+  pointToVoxelBlockPos(Vector3i(centre.x - radius, centre.y - radius, centre.z - radius), minBlockPos);
+  const int blockOffset = blockIdx.x;
+  const Vector3i blockPos = minBlockPos + Vector3i(blockOffset % blockSpan, blockOffset / blockSpan % blockSpan, blockOffset / (blockSpan * blockSpan));
+
+  // Only look up the voxel block in the hash table once, and share the result between all of the threads.
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+  if(linearIdx == 0)
+  {
+    blockAddress = block_intersects_sphere(blockPos, centre, radiusSquared) ? find_surface_block(blockPos, voxelIndex, blockOccupancy) : -1;
+  }
+  __syncthreads();
+
+  // Note: This early out is taken either by all of the threads in the thread block or by none of them.
+  if(blockAddress < 0) return;
+
+  Vector3s loc;
+  if(select_surface_voxel(linearIdx, blockPos, blockAddress, centre, radiusSquared, maxSDF, voxelData, loc))
+  {
+    outputSelection[atomicAdd(outputVoxelCount, 1)] = loc;
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+VoxelToSurfaceSelectionTransformer_CUDA::VoxelToSurfaceSelectionTransformer_CUDA(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene)
+: VoxelToSurfaceSelectionTransformer(radius, maxSDF, scene, ITMLibSettings::DEVICE_CUDA),
+  m_outputVoxelCountMB(new ORUtils::MemoryBlock<int>(1, true, true))
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VoxelToSurfaceSelectionTransformer_CUDA::transform_selection(const Selection& inputSelectionMB, Selection& outputSelectionMB) const
+{
+  const int inputVoxelCount = static_cast<int>(inputSelectionMB.dataSize);
+  if(inputVoxelCount == 0)
+  {
+    outputSelectionMB.dataSize = 0;
+    return;
+  }
+
+  // The 2r+1 voxels spanned by each sphere along each axis can touch at most this many voxel blocks.
+  const int blockSpan = (2 * m_radius + SDF_BLOCK_SIZE - 1) / SDF_BLOCK_SIZE + 1;
+
+  ORcudaSafeCall(cudaMemset(m_outputVoxelCountMB->GetData(MEMORYDEVICE_CUDA), 0, sizeof(int)));
+
+  dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+  dim3 gridSize(blockSpan * blockSpan * blockSpan, inputVoxelCount);
+
+  ck_select_surface_voxels<<<gridSize,cudaBlockSize>>>(
+    blockSpan,
+    m_radius,
+    m_radius * m_radius,
+    m_maxSDF,
+    inputSelectionMB.GetData(MEMORYDEVICE_CUDA),
+    m_scene->index.getIndexData(),
+    m_scene->localVBA.GetVoxelBlocks(),
+    m_scene->get_block_occupancy_data(),
+    outputSelectionMB.GetData(MEMORYDEVICE_CUDA),
+    m_outputVoxelCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Shrink the output selection to fit the voxels that were actually selected (in no particular order).
+  m_outputVoxelCountMB->UpdateHostFromDevice();
+  outputSelectionMB.dataSize = *m_outputVoxelCountMB->GetData(MEMORYDEVICE_CPU);
+}
+
+}
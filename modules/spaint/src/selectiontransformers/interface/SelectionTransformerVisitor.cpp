@@ -15,4 +15,6 @@ SelectionTransformerVisitor::~SelectionTransformerVisitor() {}
 
 void SelectionTransformerVisitor::visit(const VoxelToCubeSelectionTransformer& transformer) const {}
 
+void SelectionTransformerVisitor::visit(const VoxelToSurfaceSelectionTransformer& transformer) const {}
+
 }
@@ -0,0 +1,69 @@
+/**
+ * spaint: VoxelToSurfaceSelectionTransformer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "selectiontransformers/interface/VoxelToSurfaceSelectionTransformer.h"
+using namespace ITMLib;
+using namespace tvginput;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelToSurfaceSelectionTransformer::VoxelToSurfaceSelectionTransformer(int radius, float maxSDF, const SpaintVoxelScene_CPtr& scene, ITMLibSettings::DeviceType deviceType)
+: SelectionTransformer(deviceType),
+  m_maxSDF(maxSDF),
+  m_radius(radius),
+  m_scene(scene)
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VoxelToSurfaceSelectionTransformer::accept(const SelectionTransformerVisitor& visitor) const
+{
+  visitor.visit(*this);
+}
+
+size_t VoxelToSurfaceSelectionTransformer::compute_output_selection_size(const Selection& inputSelectionMB) const
+{
+  // Note: This is only an upper bound, since most of the voxels in each sphere will generally not be selected.
+  return inputSelectionMB.dataSize * max_voxels_per_sphere();
+}
+
+int VoxelToSurfaceSelectionTransformer::get_radius() const
+{
+  return m_radius;
+}
+
+void VoxelToSurfaceSelectionTransformer::update(const InputState& inputState)
+{
+  // Allow the user to change the selection radius. Much larger radii are permitted than for cubes, since the cost of
+  // the selection depends on the amount of surface within each sphere, rather than on the sphere's volume.
+  const int minRadius = 1;
+  const int maxRadius = 30;
+  static bool canChange = true;
+
+  if(!inputState.key_down(KEYCODE_RSHIFT) && inputState.key_down(KEYCODE_LEFTBRACKET))
+  {
+    if(canChange && m_radius > minRadius) --m_radius;
+    canChange = false;
+  }
+  else if(!inputState.key_down(KEYCODE_RSHIFT) && inputState.key_down(KEYCODE_RIGHTBRACKET))
+  {
+    if(canChange && m_radius < maxRadius) ++m_radius;
+    canChange = false;
+  }
+  else canChange = true;
+}
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
+
+int VoxelToSurfaceSelectionTransformer::max_voxels_per_sphere() const
+{
+  // Each sphere is contained in a cube of side 2r+1 voxels.
+  int cubeSideLength = 2 * m_radius + 1;
+  return cubeSideLength * cubeSideLength * cubeSideLength;
+}
+
+}
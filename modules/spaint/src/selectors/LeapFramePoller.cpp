@@ -0,0 +1,87 @@
+/**
+ * spaint: LeapFramePoller.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "selectors/LeapFramePoller.h"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/timing/Profiler.h>
+using tvgutil::Profiler;
+
+namespace spaint {
+
+//#################### CONSTANTS ####################
+
+const double LeapFramePoller::CLOCK_OFFSET_RELAXATION = 1e-5;
+
+//#################### CONSTRUCTORS ####################
+
+LeapFramePoller::LeapFramePoller()
+: m_clockOffset(0.0), m_creationTime(Clock::now()), m_pollerShouldTerminate(false)
+{
+  // Start the poller thread.
+  m_poller = boost::thread(boost::bind(&LeapFramePoller::run_poller, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+LeapFramePoller::~LeapFramePoller()
+{
+  m_pollerShouldTerminate = true;
+  m_poller.join();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+double LeapFramePoller::get_current_time() const
+{
+  return boost::chrono::duration<double>(Clock::now() - m_creationTime).count();
+}
+
+const LeapFramePoller::FramePair& LeapFramePoller::get_latest_frames()
+{
+  // Note: Until the first frames are published, the front slot holds a default-constructed pair of invalid frames.
+  m_frames.take();
+  return m_frames.front();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void LeapFramePoller::run_poller()
+{
+  Profiler::instance().set_thread_name("Leap poller");
+
+  FrameSample latest;
+  bool clockOffsetKnown = false;
+
+  while(!m_pollerShouldTerminate)
+  {
+    // Get the current frame from the Leap Motion. If it isn't a new one, back off briefly rather than spinning.
+    Leap::Frame frame = m_leap.frame();
+    if(!frame.isValid() || (latest.frame.isValid() && frame.id() == latest.frame.id()))
+    {
+      boost::this_thread::sleep_for(boost::chrono::microseconds(POLL_INTERVAL_MICROSECONDS));
+      continue;
+    }
+
+    // Update the estimated offset between the clocks, and use it to timestamp the frame.
+    const double captureTime = frame.timestamp() / 1000000.0;
+    const double observedOffset = get_current_time() - captureTime;
+    m_clockOffset = clockOffsetKnown ? std::min(m_clockOffset + CLOCK_OFFSET_RELAXATION, observedOffset) : observedOffset;
+    clockOffsetKnown = true;
+
+    // Publish the frame, together with the one that preceded it.
+    FramePair& frames = m_frames.back_slot();
+    frames.previous = latest;
+    latest.frame = frame;
+    latest.timestamp = captureTime + m_clockOffset;
+    frames.latest = latest;
+    m_frames.push();
+  }
+}
+
+}
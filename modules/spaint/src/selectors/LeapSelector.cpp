@@ -30,10 +30,12 @@ LeapSelector::LeapSelector(const Settings_CPtr& settings, const VoxelVisualisati
 : Selector(settings),
   m_camera(CameraFactory::make_default_camera()),
   m_fiducialID(fiducialID),
+  m_interpolationDelay(settings->get_first_value<double>("LeapSelector.interpolationDelay", 0.01)),
+  m_leap(new LeapFramePoller),
   m_mode(mode),
   m_picker(PickerFactory::make_picker(settings->deviceType)),
-  m_pickPointFloatMB(MemoryBlockFactory::instance().make_block<Vector3f>(1)),
-  m_pickPointShortMB(MemoryBlockFactory::instance().make_block<Vector3s>(1)),
+  m_pickPointFloatMB(MemoryBlockFactory::instance().make_block<Vector3f>(1, "LeapSelector")),
+  m_pickPointShortMB(MemoryBlockFactory::instance().make_block<Vector3s>(1, "LeapSelector")),
   m_visualisationEngine(visualisationEngine)
 {}
 
@@ -108,8 +110,9 @@ void LeapSelector::update(const InputState& inputState, const SLAMState_CPtr& sl
     m_camera.reset(new SimpleCamera(c.p(), -c.v(), c.n()));
   }
 
-  // Get the current frame of data from the Leap Motion.
-  m_frame = m_leap.frame();
+  // Get the most recent frames of data from the Leap Motion (this never blocks, since the Leap Motion is polled on a separate thread).
+  const LeapFramePoller::FramePair& frames = m_leap->get_latest_frames();
+  m_frame = frames.latest.frame;
 
   // If the current frame is invalid, or the user is not trying to interact with the scene using a single hand, early out.
   // Note that we do not currently support multi-hand selection, although this may change in the future.
@@ -118,16 +121,18 @@ void LeapSelector::update(const InputState& inputState, const SLAMState_CPtr& sl
   // Update whether or not the selector is active.
   m_isActive = inputState.key_down(KEYCODE_l);
 
-  // Find the position of the tip of the index finger in world coordinates.
-  const Leap::Finger& indexFinger = m_frame.hands()[0].fingers()[1];
-  Eigen::Vector3f fingerPosWorld = from_leap_position(indexFinger.tipPosition());
+  // Find the position of the tip of the index finger in world coordinates, interpolating it to a time just behind the
+  // current one, so that it moves smoothly even if the frames arrive irregularly.
+  Leap::Vector tipPos, tipDir;
+  interpolate_index_finger(frames, m_leap->get_current_time() - m_interpolationDelay, tipPos, tipDir);
+  Eigen::Vector3f fingerPosWorld = from_leap_position(tipPos);
 
   switch(m_mode)
   {
     case MODE_POINT:
     {
       // Find the direction of the index finger in world coordinates.
-      Eigen::Vector3f fingerDirWorld = from_leap_direction(indexFinger.direction());
+      Eigen::Vector3f fingerDirWorld = from_leap_direction(tipDir);
 
       // Generate a raycast of the scene from a camera that points along the index finger.
       VoxelRenderState_Ptr fingerRenderState(ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(renderState->raycastResult->noDims, &m_settings->sceneParams, m_settings->GetMemoryType()));
@@ -163,4 +168,30 @@ float LeapSelector::from_leap_size(float leapSize)
   return leapSize / 1000.0f;
 }
 
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+void LeapSelector::interpolate_index_finger(const LeapFramePoller::FramePair& frames, double t, Leap::Vector& tipPos, Leap::Vector& tipDir)
+{
+  const Leap::Hand& hand = frames.latest.frame.hands()[0];
+  const Leap::Finger& finger = hand.fingers()[1];
+  tipPos = finger.tipPosition();
+  tipDir = finger.direction();
+
+  // If the time is not earlier than the most recent frame, or there is no previous frame, use the most recent frame as is.
+  const LeapFramePoller::FrameSample& s0 = frames.previous;
+  const LeapFramePoller::FrameSample& s1 = frames.latest;
+  if(t >= s1.timestamp || !s0.frame.isValid()) return;
+
+  // If the same hand cannot be found in the previous frame, there is nothing meaningful to interpolate, so use the most recent frame.
+  const Leap::Hand& previousHand = s0.frame.hand(hand.id());
+  if(!previousHand.isValid()) return;
+  const Leap::Finger& previousFinger = previousHand.fingers()[1];
+
+  // Otherwise, linearly interpolate the tip position and direction of the finger.
+  const double duration = s1.timestamp - s0.timestamp;
+  const float alpha = duration > 0.0 && t > s0.timestamp ? static_cast<float>((t - s0.timestamp) / duration) : 0.0f;
+  tipPos = previousFinger.tipPosition() * (1.0f - alpha) + tipPos * alpha;
+  tipDir = (previousFinger.direction() * (1.0f - alpha) + tipDir * alpha).normalized();
+}
+
 }
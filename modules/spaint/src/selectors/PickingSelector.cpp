@@ -18,8 +18,8 @@ namespace spaint {
 PickingSelector::PickingSelector(const Settings_CPtr& settings)
 : Selector(settings),
   m_picker(PickerFactory::make_picker(settings->deviceType)),
-  m_pickPointFloatMB(MemoryBlockFactory::instance().make_block<Vector3f>(1)),
-  m_pickPointShortMB(MemoryBlockFactory::instance().make_block<Vector3s>(1)),
+  m_pickPointFloatMB(MemoryBlockFactory::instance().make_block<Vector3f>(1, "PickingSelector")),
+  m_pickPointShortMB(MemoryBlockFactory::instance().make_block<Vector3s>(1, "PickingSelector")),
   m_pickPointValid(false)
 {}
 
@@ -35,8 +35,10 @@ boost::optional<Eigen::Vector3f> PickingSelector::get_position() const
   // If the last update did not yield a valid pick point, early out.
   if(!m_pickPointValid) return boost::none;
 
-  // Convert the pick point from voxel coordinates into scene coordinates and return it.
-  return Picker::get_positions<Eigen::Vector3f>(*m_pickPointFloatMB, m_settings->sceneParams.voxelSize)[0];
+  // Convert the pick point from voxel coordinates into scene coordinates and return it. Note that the host copy of
+  // the pick point made by the picker is used, so that rendering the selector never needs to wait for the GPU.
+  const float voxelSize = m_settings->sceneParams.voxelSize;
+  return Eigen::Vector3f(m_latestPickPoint.x * voxelSize, m_latestPickPoint.y * voxelSize, m_latestPickPoint.z * voxelSize);
 }
 
 Selector::Selection_CPtr PickingSelector::get_selection() const
@@ -59,7 +61,10 @@ void PickingSelector::update(const InputState& inputState, const SLAMState_CPtr&
   int x = (int)ROUND(inputState.mouse_position_x() * (renderState->raycastResult->noDims.x - 1));
   int y = (int)ROUND(inputState.mouse_position_y() * (renderState->raycastResult->noDims.y - 1));
 
-  m_pickPointValid = m_picker->pick(x, y, renderState.get(), *m_pickPointFloatMB);
+  // Note that the result may lag a frame behind the mouse, since waiting for it would stall the GPU. That is fine for
+  // interactive feedback, and the pick point on the device is always the most recent point hit, so it can still be
+  // used for the selection whenever the result is valid.
+  m_pickPointValid = m_picker->pick_deferred(x, y, renderState.get(), *m_pickPointFloatMB, m_latestPickPoint);
   if(m_pickPointValid) m_picker->to_short(*m_pickPointFloatMB, *m_pickPointShortMB);
 }
 
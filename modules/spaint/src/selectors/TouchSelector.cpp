@@ -71,8 +71,11 @@ std::vector<Eigen::Vector3f> TouchSelector::get_positions() const
   // If the last update did not yield any valid touch points, early out.
   if(m_keptTouchPointCount == 0) return std::vector<Eigen::Vector3f>();
 
+  // Wait for the asynchronous copy of the touch points to the CPU to finish.
+  m_picker->wait_for_host_copy();
+
   // Convert the touch points from voxel coordinates into scene coordinates and return them.
-  return Picker::get_positions<Eigen::Vector3f>(*m_keptTouchPointsFloatMB, m_settings->sceneParams.voxelSize);
+  return Picker::get_host_positions<Eigen::Vector3f>(*m_keptTouchPointsFloatMB, m_settings->sceneParams.voxelSize);
 }
 
 Selector::Selection_CPtr TouchSelector::get_selection() const
@@ -90,24 +93,17 @@ void TouchSelector::update(const InputState& inputState, const SLAMState_CPtr& s
   std::cout << runningTouchDetectorOnFrame << '\n';
 #endif
 
-  // Determine which of the touch points are valid (i.e. are ones that we want to keep) and copy them into a memory block.
+  // Determine which of the touch points are valid (i.e. are ones that we want to keep) and pick them all in a single batch.
   // Note that we limit the overall number of points we keep for performance reasons, so not all of the valid touch points
-  // may end up being retained.
-  m_keptTouchPointsFloatMB->Clear();
-  m_keptTouchPointCount = 0;
-  for(size_t i = 0, touchPointCount = touchPoints.size(); i < touchPointCount && m_keptTouchPointCount < m_maxKeptTouchPoints; ++i)
+  // may end up being retained. The kept points are left on the device for the selection transformer: we only start an
+  // asynchronous copy of them back to the CPU, which get_positions waits for if and when they are needed for rendering.
+  std::vector<Vector2i> batch(touchPoints.size());
+  for(size_t i = 0, touchPointCount = touchPoints.size(); i < touchPointCount; ++i)
   {
-    if(m_picker->pick(touchPoints[i][0], touchPoints[i][1], renderState.get(), *m_keptTouchPointsFloatMB, m_keptTouchPointCount))
-    {
-      ++m_keptTouchPointCount;
-    }
+    batch[i] = Vector2i(touchPoints[i][0], touchPoints[i][1]);
   }
 
-  // Convert the touch points we kept to Vector3s format.
-  if(m_keptTouchPointCount > 0)
-  {
-    m_picker->to_short(*m_keptTouchPointsFloatMB, *m_keptTouchPointsShortMB);
-  }
+  m_keptTouchPointCount = m_picker->pick_batch(batch, renderState.get(), m_maxKeptTouchPoints, *m_keptTouchPointsFloatMB, *m_keptTouchPointsShortMB, true);
 }
 
 }
@@ -11,6 +11,12 @@ using namespace ORUtils;
 
 namespace spaint {
 
+//#################### CONSTRUCTORS ####################
+
+SLAMState::SLAMState()
+: m_voxelSceneVersion(0)
+{}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 const Vector2i& SLAMState::get_depth_image_size() const
@@ -40,6 +46,11 @@ ITMShortImage_Ptr SLAMState::get_input_raw_depth_image_copy() const
   return copy;
 }
 
+const boost::optional<Vector4i>& SLAMState::get_input_region() const
+{
+  return m_inputRegion;
+}
+
 const ITMUChar4Image_Ptr& SLAMState::get_input_rgb_image()
 {
   return m_inputRGBImage;
@@ -52,6 +63,11 @@ ITMUChar4Image_Ptr SLAMState::get_input_rgb_image_copy() const
   return copy;
 }
 
+const FrameTimestamps& SLAMState::get_input_timestamps() const
+{
+  return m_inputTimestamps;
+}
+
 const ITMIntrinsics& SLAMState::get_intrinsics() const
 {
   return m_view->calib.intrinsics_d;
@@ -62,11 +78,21 @@ const SurfelRenderState_Ptr& SLAMState::get_live_surfel_render_state()
   return m_liveSurfelRenderState;
 }
 
+const boost::optional<SE3Pose>& SLAMState::get_live_voxel_raycast_pose() const
+{
+  return m_liveVoxelRaycastPose;
+}
+
 const VoxelRenderState_Ptr& SLAMState::get_live_voxel_render_state()
 {
   return m_liveVoxelRenderState;
 }
 
+VoxelRenderState_CPtr SLAMState::get_live_voxel_render_state() const
+{
+  return m_liveVoxelRenderState;
+}
+
 const SE3Pose& SLAMState::get_pose() const
 {
   return *m_trackingState->pose_d;
@@ -117,6 +143,21 @@ SpaintVoxelScene_CPtr SLAMState::get_voxel_scene() const
   return m_voxelScene;
 }
 
+const VoxelSceneArchive_Ptr& SLAMState::get_voxel_scene_archive()
+{
+  return m_voxelSceneArchive;
+}
+
+size_t SLAMState::get_voxel_scene_version() const
+{
+  return m_voxelSceneVersion;
+}
+
+void SLAMState::notify_voxel_scene_changed()
+{
+  ++m_voxelSceneVersion;
+}
+
 void SLAMState::set_input_mask(const ITMUCharImage_Ptr& inputMask)
 {
   m_inputMask = inputMask;
@@ -127,16 +168,31 @@ void SLAMState::set_input_raw_depth_image(const ITMShortImage_Ptr& inputRawDepth
   m_inputRawDepthImage = inputRawDepthImage;
 }
 
+void SLAMState::set_input_region(const boost::optional<Vector4i>& inputRegion)
+{
+  m_inputRegion = inputRegion;
+}
+
 void SLAMState::set_input_rgb_image(const ITMUChar4Image_Ptr& inputRGBImage)
 {
   m_inputRGBImage = inputRGBImage;
 }
 
+void SLAMState::set_input_timestamps(const FrameTimestamps& inputTimestamps)
+{
+  m_inputTimestamps = inputTimestamps;
+}
+
 void SLAMState::set_live_surfel_render_state(const SurfelRenderState_Ptr& liveSurfelRenderState)
 {
   m_liveSurfelRenderState = liveSurfelRenderState;
 }
 
+void SLAMState::set_live_voxel_raycast_pose(const boost::optional<SE3Pose>& liveVoxelRaycastPose)
+{
+  m_liveVoxelRaycastPose = liveVoxelRaycastPose;
+}
+
 void SLAMState::set_live_voxel_render_state(const VoxelRenderState_Ptr& liveVoxelRenderState)
 {
   m_liveVoxelRenderState = liveVoxelRenderState;
@@ -167,6 +223,11 @@ void SLAMState::set_voxel_scene(const SpaintVoxelScene_Ptr& voxelScene)
   m_voxelScene = voxelScene;
 }
 
+void SLAMState::set_voxel_scene_archive(const VoxelSceneArchive_Ptr& voxelSceneArchive)
+{
+  m_voxelSceneArchive = voxelSceneArchive;
+}
+
 void SLAMState::update_fiducials(const std::map<std::string,FiducialMeasurement>& measurements)
 {
   // For each fiducial measurement:
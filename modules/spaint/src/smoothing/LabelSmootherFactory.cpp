@@ -6,31 +6,57 @@
 #include "smoothing/LabelSmootherFactory.h"
 using namespace ITMLib;
 
+#include "markers/VoxelMarkerFactory.h"
 #include "smoothing/cpu/LabelSmoother_CPU.h"
+#include "smoothing/cpu/VoxelLabelSmoother_CPU.h"
 
 #ifdef WITH_CUDA
 #include "smoothing/cuda/LabelSmoother_CUDA.h"
+#include "smoothing/cuda/VoxelLabelSmoother_CUDA.h"
 #endif
 
 namespace spaint {
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
-LabelSmoother_CPtr LabelSmootherFactory::make_label_smoother(size_t maxLabelCount,  ITMLibSettings::DeviceType deviceType, float maxSquaredDistanceBetweenVoxels)
+LabelSmoother_CPtr LabelSmootherFactory::make_label_smoother(size_t maxLabelCount,  ITMLibSettings::DeviceType deviceType, size_t iterationCount, float maxSquaredDistanceBetweenVoxels)
 {
   LabelSmoother_CPtr smoother;
 
   if(deviceType == ITMLibSettings::DEVICE_CUDA)
   {
 #ifdef WITH_CUDA
-    smoother.reset(new LabelSmoother_CUDA(maxLabelCount, maxSquaredDistanceBetweenVoxels));
+    smoother.reset(new LabelSmoother_CUDA(maxLabelCount, maxSquaredDistanceBetweenVoxels, iterationCount));
 #else
     throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
 #endif
   }
   else
   {
-    smoother.reset(new LabelSmoother_CPU(maxLabelCount, maxSquaredDistanceBetweenVoxels));
+    smoother.reset(new LabelSmoother_CPU(maxLabelCount, maxSquaredDistanceBetweenVoxels, iterationCount));
+  }
+
+  return smoother;
+}
+
+VoxelLabelSmoother_CPtr LabelSmootherFactory::make_voxel_label_smoother(size_t maxLabelCount, size_t maxBlockCount, float maxSDF, ITMLibSettings::DeviceType deviceType)
+{
+  VoxelLabelSmoother_CPtr smoother;
+
+  // Note: The smoothed labels are written back into the scene using a voxel marker for the same device.
+  const VoxelMarker_CPtr voxelMarker = VoxelMarkerFactory::make_voxel_marker(deviceType);
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    smoother.reset(new VoxelLabelSmoother_CUDA(maxLabelCount, maxBlockCount, maxSDF, voxelMarker));
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    smoother.reset(new VoxelLabelSmoother_CPU(maxLabelCount, maxBlockCount, maxSDF, voxelMarker));
   }
 
   return smoother;
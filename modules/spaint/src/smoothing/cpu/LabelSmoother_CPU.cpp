@@ -11,27 +11,36 @@ namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-LabelSmoother_CPU::LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels)
-: LabelSmoother(maxLabelCount, maxSquaredDistanceBetweenVoxels)
+LabelSmoother_CPU::LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, size_t iterationCount)
+: LabelSmoother(maxLabelCount, maxSquaredDistanceBetweenVoxels, iterationCount)
 {}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void LabelSmoother_CPU::smooth_labels(const ITMFloat4Image *raycastResult, SpaintVoxelScene *scene) const
 {
+  SpaintVoxelScene::BlockVersions *blockVersions = scene->get_block_versions();
   const int height = raycastResult->noDims.y;
   const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
   const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
   const int raycastResultSize = static_cast<int>(raycastResult->dataSize);
   SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  unsigned int *labelCounts = scene->get_label_count_data();
+  unsigned int *labelPresence = scene->get_label_presence_data();
+  const unsigned int version = scene->advance_version();
   const int width = raycastResult->noDims.x;
 
+  for(size_t i = 0; i < m_iterationCount; ++i)
+  {
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+    #pragma omp parallel for
 #endif
-  for(int voxelIndex = 0; voxelIndex < raycastResultSize; ++voxelIndex)
-  {
-    smooth_from_neighbours(voxelIndex, width, height, static_cast<int>(m_maxLabelCount), raycastResultData, voxelData, indexData, m_maxSquaredDistanceBetweenVoxels);
+    for(int voxelIndex = 0; voxelIndex < raycastResultSize; ++voxelIndex)
+    {
+      smooth_from_neighbours(voxelIndex, width, height, static_cast<int>(m_maxLabelCount), raycastResultData, voxelData, labelData, indexData, m_maxSquaredDistanceBetweenVoxels, labelCounts,
+                             labelPresence, blockVersions, version);
+    }
   }
 }
 
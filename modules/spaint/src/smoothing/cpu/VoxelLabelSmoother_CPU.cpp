@@ -0,0 +1,70 @@
+/**
+ * spaint: VoxelLabelSmoother_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "smoothing/cpu/VoxelLabelSmoother_CPU.h"
+
+#include "smoothing/shared/VoxelLabelSmoother_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelLabelSmoother_CPU::VoxelLabelSmoother_CPU(size_t maxLabelCount, size_t maxBlockCount, float maxSDF, const VoxelMarker_CPtr& voxelMarker)
+: VoxelLabelSmoother(maxLabelCount, maxBlockCount, maxSDF, voxelMarker)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int VoxelLabelSmoother_CPU::gather_relabelled_entries(const SpaintVoxelScene *scene) const
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const unsigned char *relabelledBlockFlags = scene->get_relabelled_block_flags();
+  int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+
+  int entryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    const int ptr = hashTable[entryID].ptr;
+    if(ptr >= 0 && relabelledBlockFlags[ptr]) entryIDs[entryCount++] = entryID;
+  }
+
+  return entryCount;
+}
+
+int VoxelLabelSmoother_CPU::write_smoothed_labels(int entryCount, SpaintVoxelScene *scene) const
+{
+  const int *entryIDs = m_entryIDsMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const int maxLabelCount = static_cast<int>(m_maxLabelCount);
+  unsigned char *relabelledBlockFlags = scene->get_relabelled_block_flags();
+  SpaintVoxel::PackedLabel *smoothedVoxelLabels = m_smoothedVoxelLabelsMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *smoothedVoxelLocations = m_smoothedVoxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+  int smoothedVoxelCount = 0;
+  for(int i = 0; i < entryCount; ++i)
+  {
+    const ITMHashEntry& hashEntry = hashTable[entryIDs[i]];
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      Vector3s loc;
+      SpaintVoxel::PackedLabel newLabel;
+      if(compute_smoothed_voxel_label(linearIdx, hashEntry, voxelData, labelData, indexData, maxLabelCount, m_maxSDF, loc, newLabel))
+      {
+        smoothedVoxelLocations[smoothedVoxelCount] = loc;
+        smoothedVoxelLabels[smoothedVoxelCount] = newLabel;
+        ++smoothedVoxelCount;
+      }
+    }
+
+    relabelledBlockFlags[hashEntry.ptr] = 0;
+  }
+
+  return smoothedVoxelCount;
+}
+
+}
@@ -5,49 +5,254 @@
 
 #include "smoothing/cuda/LabelSmoother_CUDA.h"
 
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
 #include "smoothing/shared/LabelSmoother_Shared.h"
 
 #define DEBUGGING 0
 
+// The width and height (in pixels) of the tiles processed by the thread blocks of the tiled smoothing kernel.
+#define SMOOTHING_TILE_SIZE 16
+
+// The maximum number of iterations supported by the tiled smoothing kernel (this determines the size of the apron around each tile).
+#define MAX_SMOOTHING_ITERATIONS 8
+
+// The maximum width and height (in pixels) of a tile plus its apron.
+#define MAX_SMOOTHING_REGION_SIZE (SMOOTHING_TILE_SIZE + 2 * MAX_SMOOTHING_ITERATIONS)
+
 namespace spaint {
 
 //#################### CUDA KERNELS ####################
 
 __global__ void ck_smooth_from_neighbours(const Vector4f *raycastResultData, int raycastResultSize, int width, int height, int maxLabelCount,
-                                          SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData, float maxSquaredDistanceBetweenVoxels)
+                                          SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                                          float maxSquaredDistanceBetweenVoxels, unsigned int *labelCounts, unsigned int *labelPresence,
+                                          SpaintVoxelScene::BlockVersions *blockVersions, unsigned int version)
 {
   int voxelIndex = threadIdx.x + blockDim.x * blockIdx.x;
   if(voxelIndex < raycastResultSize)
   {
-    smooth_from_neighbours(voxelIndex, width, height, maxLabelCount, raycastResultData, voxelData, indexData, maxSquaredDistanceBetweenVoxels);
+    smooth_from_neighbours(voxelIndex, width, height, maxLabelCount, raycastResultData, voxelData, labelData, indexData, maxSquaredDistanceBetweenVoxels, labelCounts,
+                           labelPresence, blockVersions, version);
+  }
+}
+
+__global__ void ck_smooth_labels_tiled(const Vector4f *raycastResultData, int width, int height, int maxLabelCount, int iterationCount,
+                                       SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *indexData,
+                                       float maxSquaredDistanceBetweenVoxels, unsigned int *labelCounts, unsigned int *labelPresence,
+                                       SpaintVoxelScene::BlockVersions *blockVersions, unsigned int version)
+{
+  // Note: The voxel positions and labels are stored as arrays of built-in types, since __shared__ variables cannot have constructors.
+  __shared__ int voxelAddresses[MAX_SMOOTHING_REGION_SIZE * MAX_SMOOTHING_REGION_SIZE];
+  __shared__ float voxelPositions[MAX_SMOOTHING_REGION_SIZE * MAX_SMOOTHING_REGION_SIZE][3];
+  __shared__ unsigned char voxelLabels[2][MAX_SMOOTHING_REGION_SIZE * MAX_SMOOTHING_REGION_SIZE];
+  __shared__ unsigned char voxelGroups[2][MAX_SMOOTHING_REGION_SIZE * MAX_SMOOTHING_REGION_SIZE];
+
+  // The region processed by this block consists of the block's tile plus an apron of one pixel per iteration. After k iterations,
+  // only the labels of the pixels at least k pixels from the edge of the region are correct, so those of the tile end up correct.
+  const int regionSize = SMOOTHING_TILE_SIZE + 2 * iterationCount;
+  const int regionPixelCount = regionSize * regionSize;
+  const int regionX = blockIdx.x * SMOOTHING_TILE_SIZE - iterationCount;
+  const int regionY = blockIdx.y * SMOOTHING_TILE_SIZE - iterationCount;
+  const int threadCount = blockDim.x * blockDim.y;
+  const int threadIndex = threadIdx.y * blockDim.x + threadIdx.x;
+
+  // Load the addresses, positions and labels of the voxels hit by the pixels in the region.
+  for(int i = threadIndex; i < regionPixelCount; i += threadCount)
+  {
+    const int x = regionX + i % regionSize, y = regionY + i / regionSize;
+
+    int voxelAddress = -1;
+    if(x >= 0 && x < width && y >= 0 && y < height)
+    {
+      const Vector3f loc = raycastResultData[y * width + x].toVector3();
+      bool foundPoint;
+      voxelAddress = findVoxel(indexData, loc.toIntRound(), foundPoint);
+      if(!foundPoint) voxelAddress = -1;
+
+      voxelPositions[i][0] = loc.x;
+      voxelPositions[i][1] = loc.y;
+      voxelPositions[i][2] = loc.z;
+    }
+
+    voxelAddresses[i] = voxelAddress;
+    if(voxelAddress >= 0)
+    {
+      const SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+      voxelLabels[0][i] = packedLabel.label;
+      voxelGroups[0][i] = packedLabel.group;
+    }
+  }
+
+  __syncthreads();
+
+  // Record the label that was loaded for this thread's pixel in the tile, so that we can tell whether the smoothing changed it.
+  const int tileIndex = (threadIdx.y + iterationCount) * regionSize + threadIdx.x + iterationCount;
+  const SpaintVoxel::PackedLabel initialLabel(voxelLabels[0][tileIndex], static_cast<SpaintVoxel::LabelGroup>(voxelGroups[0][tileIndex]));
+
+  // Perform the smoothing iterations in shared memory, ping-ponging between the two sets of label arrays.
+  // Note: Unlike the single-pass kernel, each pixel is updated independently here, even if several pixels hit the same voxel.
+  for(int iteration = 0; iteration < iterationCount; ++iteration)
+  {
+    const int src = iteration % 2, dst = 1 - src;
+
+    for(int i = threadIndex; i < regionPixelCount; i += threadCount)
+    {
+      if(voxelAddresses[i] < 0) continue;
+
+      unsigned char label = voxelLabels[src][i], group = voxelGroups[src][i];
+
+      // Pixels on the edge of the region do not have all of their neighbours available, so they are left unchanged.
+      const int rx = i % regionSize, ry = i / regionSize;
+      if(rx > 0 && rx < regionSize - 1 && ry > 0 && ry < regionSize - 1)
+      {
+        // Count the labels of the neighbouring voxels that are near enough to the target voxel.
+        unsigned char labelCounts[32] = {0,};
+        for(int dy = -1; dy <= 1; ++dy)
+        {
+          for(int dx = -1; dx <= 1; ++dx)
+          {
+            const int j = i + dy * regionSize + dx;
+            if(j == i || voxelAddresses[j] < 0) continue;
+
+            const float ox = voxelPositions[j][0] - voxelPositions[i][0];
+            const float oy = voxelPositions[j][1] - voxelPositions[i][1];
+            const float oz = voxelPositions[j][2] - voxelPositions[i][2];
+            if(ox * ox + oy * oy + oz * oz <= maxSquaredDistanceBetweenVoxels) ++labelCounts[voxelLabels[src][j]];
+          }
+        }
+
+        // If there is a suitable label, use it to update the label of the target voxel, just as mark_voxel would.
+        const SpaintVoxel::Label bestLabel = select_smoothed_label(labelCounts, maxLabelCount);
+        const SpaintVoxel::PackedLabel newLabel(bestLabel, SpaintVoxel::LG_PROPAGATED);
+        if(bestLabel != 0 && can_overwrite_label(SpaintVoxel::PackedLabel(label, static_cast<SpaintVoxel::LabelGroup>(group)), newLabel))
+        {
+          label = newLabel.label;
+          group = newLabel.group;
+        }
+      }
+
+      voxelLabels[dst][i] = label;
+      voxelGroups[dst][i] = group;
+    }
+
+    __syncthreads();
+  }
+
+  // Write back the labels of the pixels in the tile that have changed. Pixels whose labels have not changed must not be
+  // written back, since the voxel they hit may be shared with a pixel in another tile whose change would then be reverted.
+  // For the same reason, and in case the user has labelled the voxel since it was loaded, each write must also respect
+  // the label that is currently in the voxel, just as mark_voxel does.
+  const int finalBuffer = iterationCount % 2;
+  const int voxelAddress = voxelAddresses[tileIndex];
+  const SpaintVoxel::PackedLabel newLabel(voxelLabels[finalBuffer][tileIndex], static_cast<SpaintVoxel::LabelGroup>(voxelGroups[finalBuffer][tileIndex]));
+  if(voxelAddress >= 0 && !(newLabel == initialLabel))
+  {
+    SpaintVoxel::PackedLabel& packedLabel = get_voxel_label(voxelAddress, voxelData, labelData);
+    bool changed = false;
+    if(!labelCounts)
+    {
+      if(!(packedLabel == newLabel) && can_overwrite_label(packedLabel, newLabel))
+      {
+        packedLabel = newLabel;
+        changed = true;
+      }
+    }
+    else
+    {
+      // Several pixels can map to the same voxel, so if the label counts are being maintained, we must replace the label atomically.
+      SpaintVoxel::PackedLabel currentLabel = packedLabel;
+      while(!(currentLabel == newLabel) && can_overwrite_label(currentLabel, newLabel))
+      {
+        const SpaintVoxel::PackedLabel foundLabel = compare_and_swap_label(packedLabel, currentLabel, newLabel);
+        if(foundLabel == currentLabel)
+        {
+          update_label_counts(currentLabel, newLabel, labelCounts);
+          changed = true;
+          break;
+        }
+
+        currentLabel = foundLabel;
+      }
+    }
+
+    if(changed)
+    {
+      record_label_presence(voxelAddress / SDF_BLOCK_SIZE3, newLabel, labelPresence);
+      blockVersions[voxelAddress / SDF_BLOCK_SIZE3].labels = version;
+    }
   }
 }
 
 //#################### CONSTRUCTORS ####################
 
-LabelSmoother_CUDA::LabelSmoother_CUDA(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels)
-: LabelSmoother(maxLabelCount, maxSquaredDistanceBetweenVoxels)
-{}
+LabelSmoother_CUDA::LabelSmoother_CUDA(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, size_t iterationCount)
+: LabelSmoother(maxLabelCount, maxSquaredDistanceBetweenVoxels, iterationCount)
+{
+  if(iterationCount > MAX_SMOOTHING_ITERATIONS)
+  {
+    throw std::invalid_argument("Error: The CUDA label smoother cannot perform more than " + boost::lexical_cast<std::string>(MAX_SMOOTHING_ITERATIONS) + " smoothing iterations per call");
+  }
+}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void LabelSmoother_CUDA::smooth_labels(const ITMFloat4Image *raycastResult, SpaintVoxelScene *scene) const
 {
+  // Wait for the raycast result and the labels to be ready before smoothing on the smoother's own stream.
+  m_stream.begin_work();
+
+  // If more than one iteration has been requested, use the tiled kernel to perform them all in a single launch.
+  if(m_iterationCount > 1)
+  {
+    dim3 cudaBlockSize(SMOOTHING_TILE_SIZE, SMOOTHING_TILE_SIZE);
+    dim3 gridSize((raycastResult->noDims.x + SMOOTHING_TILE_SIZE - 1) / SMOOTHING_TILE_SIZE, (raycastResult->noDims.y + SMOOTHING_TILE_SIZE - 1) / SMOOTHING_TILE_SIZE);
+
+    ck_smooth_labels_tiled<<<gridSize,cudaBlockSize,0,m_stream.get()>>>(
+      raycastResult->GetData(MEMORYDEVICE_CUDA),
+      raycastResult->noDims.x,
+      raycastResult->noDims.y,
+      static_cast<int>(m_maxLabelCount),
+      static_cast<int>(m_iterationCount),
+      scene->localVBA.GetVoxelBlocks(),
+      scene->get_label_data(),
+      scene->index.getIndexData(),
+      m_maxSquaredDistanceBetweenVoxels,
+      scene->get_label_count_data(),
+      scene->get_label_presence_data(),
+      scene->get_block_versions(),
+      scene->advance_version()
+    );
+
+    m_stream.end_work();
+    return;
+  }
+
   const int raycastResultSize = static_cast<int>(raycastResult->dataSize);
 
   int threadsPerBlock = 256;
   int numBlocks = (raycastResultSize + threadsPerBlock - 1) / threadsPerBlock;
 
-  ck_smooth_from_neighbours<<<numBlocks,threadsPerBlock>>>(
+  ck_smooth_from_neighbours<<<numBlocks,threadsPerBlock,0,m_stream.get()>>>(
     raycastResult->GetData(MEMORYDEVICE_CUDA),
     raycastResultSize,
     raycastResult->noDims.x,
     raycastResult->noDims.y,
     static_cast<int>(m_maxLabelCount),
     scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
     scene->index.getIndexData(),
-    m_maxSquaredDistanceBetweenVoxels
+    m_maxSquaredDistanceBetweenVoxels,
+    scene->get_label_count_data(),
+    scene->get_label_presence_data(),
+    scene->get_block_versions(),
+    scene->advance_version()
   );
+
+  // Make any subsequent work on the default stream wait for the labels to have been smoothed.
+  m_stream.end_work();
 }
 
 }
@@ -0,0 +1,99 @@
+/**
+ * spaint: VoxelLabelSmoother_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "smoothing/cuda/VoxelLabelSmoother_CUDA.h"
+
+#include "smoothing/shared/VoxelLabelSmoother_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_gather_relabelled_entries(const ITMHashEntry *hashTable, int noTotalEntries, const unsigned char *relabelledBlockFlags,
+                                             int *entryIDs, int *entryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < noTotalEntries)
+  {
+    const int ptr = hashTable[entryID].ptr;
+    if(ptr >= 0 && relabelledBlockFlags[ptr]) entryIDs[atomicAdd(entryCount, 1)] = entryID;
+  }
+}
+
+__global__ void ck_write_smoothed_labels(const int *entryIDs, const ITMHashEntry *hashTable, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                         const ITMVoxelIndex::IndexData *indexData, int maxLabelCount, float maxSDF, unsigned char *relabelledBlockFlags,
+                                         Vector3s *smoothedVoxelLocations, SpaintVoxel::PackedLabel *smoothedVoxelLabels, int *smoothedVoxelCount)
+{
+  // Each thread block smooths a single voxel block, with one thread per voxel.
+  const ITMHashEntry hashEntry = hashTable[entryIDs[blockIdx.x]];
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+
+  Vector3s loc;
+  SpaintVoxel::PackedLabel newLabel;
+  if(compute_smoothed_voxel_label(linearIdx, hashEntry, voxelData, labelData, indexData, maxLabelCount, maxSDF, loc, newLabel))
+  {
+    const int i = atomicAdd(smoothedVoxelCount, 1);
+    smoothedVoxelLocations[i] = loc;
+    smoothedVoxelLabels[i] = newLabel;
+  }
+
+  if(linearIdx == 0) relabelledBlockFlags[hashEntry.ptr] = 0;
+}
+
+//#################### CONSTRUCTORS ####################
+
+VoxelLabelSmoother_CUDA::VoxelLabelSmoother_CUDA(size_t maxLabelCount, size_t maxBlockCount, float maxSDF, const VoxelMarker_CPtr& voxelMarker)
+: VoxelLabelSmoother(maxLabelCount, maxBlockCount, maxSDF, voxelMarker)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int VoxelLabelSmoother_CUDA::gather_relabelled_entries(const SpaintVoxelScene *scene) const
+{
+  const int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_countMB->Clear();
+
+  ck_gather_relabelled_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    noTotalEntries,
+    scene->get_relabelled_block_flags(),
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_countMB->UpdateHostFromDevice();
+  return *m_countMB->GetData(MEMORYDEVICE_CPU);
+}
+
+int VoxelLabelSmoother_CUDA::write_smoothed_labels(int entryCount, SpaintVoxelScene *scene) const
+{
+  dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+  dim3 gridSize(entryCount);
+
+  m_countMB->Clear();
+
+  ck_write_smoothed_labels<<<gridSize,cudaBlockSize>>>(
+    m_entryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->index.getIndexData(),
+    static_cast<int>(m_maxLabelCount),
+    m_maxSDF,
+    scene->get_relabelled_block_flags(),
+    m_smoothedVoxelLocationsMB->GetData(MEMORYDEVICE_CUDA),
+    m_smoothedVoxelLabelsMB->GetData(MEMORYDEVICE_CUDA),
+    m_countMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_countMB->UpdateHostFromDevice();
+  return *m_countMB->GetData(MEMORYDEVICE_CPU);
+}
+
+}
@@ -5,14 +5,22 @@
 
 #include "smoothing/interface/LabelSmoother.h"
 
+#include <stdexcept>
+
 namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-LabelSmoother::LabelSmoother(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels)
-: m_maxLabelCount(maxLabelCount),
+LabelSmoother::LabelSmoother(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, size_t iterationCount)
+: m_iterationCount(iterationCount),
+  m_maxLabelCount(maxLabelCount),
   m_maxSquaredDistanceBetweenVoxels(maxSquaredDistanceBetweenVoxels)
-{}
+{
+  if(iterationCount == 0)
+  {
+    throw std::invalid_argument("Error: A label smoother must perform at least one smoothing iteration");
+  }
+}
 
 //#################### DESTRUCTOR ####################
 
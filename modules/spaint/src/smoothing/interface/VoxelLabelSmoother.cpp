@@ -0,0 +1,71 @@
+/**
+ * spaint: VoxelLabelSmoother.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "smoothing/interface/VoxelLabelSmoother.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "smoothing/shared/VoxelLabelSmoother_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelLabelSmoother::VoxelLabelSmoother(size_t maxLabelCount, size_t maxBlockCount, float maxSDF, const VoxelMarker_CPtr& voxelMarker)
+: m_maxBlockCount(maxBlockCount),
+  m_maxLabelCount(maxLabelCount),
+  m_maxSDF(maxSDF),
+  m_voxelMarker(voxelMarker)
+{
+  if(maxLabelCount > MAX_VOXEL_SMOOTHING_LABELS)
+  {
+    throw std::invalid_argument("Error: The voxel label smoother does not support more than " + boost::lexical_cast<std::string>(MAX_VOXEL_SMOOTHING_LABELS) + " labels");
+  }
+
+  if(maxBlockCount == 0)
+  {
+    throw std::invalid_argument("Error: A voxel label smoother must be able to smooth at least one block at once");
+  }
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  const size_t maxVoxelCount = maxBlockCount * SDF_BLOCK_SIZE3;
+  m_countMB = mbf.make_block<int>(1, "VoxelLabelSmoother");
+  m_entryIDsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "VoxelLabelSmoother");
+  m_smoothedVoxelLabelsMB = mbf.make_block<SpaintVoxel::PackedLabel>(maxVoxelCount, "VoxelLabelSmoother");
+  m_smoothedVoxelLocationsMB = mbf.make_block<Vector3s>(maxVoxelCount, "VoxelLabelSmoother");
+}
+
+//#################### DESTRUCTOR ####################
+
+VoxelLabelSmoother::~VoxelLabelSmoother() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t VoxelLabelSmoother::smooth_labels(SpaintVoxelScene *scene) const
+{
+  // Find the blocks that have been relabelled since they were last smoothed. If there aren't any, early out.
+  const int relabelledEntryCount = gather_relabelled_entries(scene);
+  if(relabelledEntryCount == 0) return 0;
+
+  // Compute the new labels for the surface voxels in as many of the blocks as we can smooth at once. The remaining
+  // blocks keep their flags, and so will be smoothed on a subsequent call.
+  const int entryCount = std::min(relabelledEntryCount, static_cast<int>(m_maxBlockCount));
+  const int smoothedVoxelCount = write_smoothed_labels(entryCount, scene);
+
+  // Write the new labels back into the scene via the voxel marker (which also flags any blocks whose labels change).
+  m_smoothedVoxelLabelsMB->dataSize = smoothedVoxelCount;
+  m_smoothedVoxelLocationsMB->dataSize = smoothedVoxelCount;
+  m_voxelMarker->mark_voxels(*m_smoothedVoxelLocationsMB, *m_smoothedVoxelLabelsMB, scene, NORMAL_MARKING);
+
+  return static_cast<size_t>(entryCount);
+}
+
+}
@@ -0,0 +1,39 @@
+/**
+ * spaint: LabelSnapshotterFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/LabelSnapshotterFactory.h"
+using namespace ITMLib;
+
+#include "swapping/cpu/LabelSnapshotter_CPU.h"
+
+#ifdef WITH_CUDA
+#include "swapping/cuda/LabelSnapshotter_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+LabelSnapshotter_Ptr LabelSnapshotterFactory::make_label_snapshotter(ITMLibSettings::DeviceType deviceType, const std::string& path, double intervalSeconds)
+{
+  LabelSnapshotter_Ptr snapshotter;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    snapshotter.reset(new LabelSnapshotter_CUDA(path, intervalSeconds));
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    snapshotter.reset(new LabelSnapshotter_CPU(path, intervalSeconds));
+  }
+
+  return snapshotter;
+}
+
+}
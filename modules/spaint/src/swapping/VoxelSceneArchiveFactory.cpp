@@ -0,0 +1,39 @@
+/**
+ * spaint: VoxelSceneArchiveFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/VoxelSceneArchiveFactory.h"
+using namespace ITMLib;
+
+#include "swapping/cpu/VoxelSceneArchive_CPU.h"
+
+#ifdef WITH_CUDA
+#include "swapping/cuda/VoxelSceneArchive_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+VoxelSceneArchive_Ptr VoxelSceneArchiveFactory::make_voxel_scene_archive(ITMLibSettings::DeviceType deviceType)
+{
+  VoxelSceneArchive_Ptr archive;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    archive.reset(new VoxelSceneArchive_CUDA);
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    archive.reset(new VoxelSceneArchive_CPU);
+  }
+
+  return archive;
+}
+
+}
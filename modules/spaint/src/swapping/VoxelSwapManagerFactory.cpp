@@ -0,0 +1,39 @@
+/**
+ * spaint: VoxelSwapManagerFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/VoxelSwapManagerFactory.h"
+using namespace ITMLib;
+
+#include "swapping/cpu/VoxelSwapManager_CPU.h"
+
+#ifdef WITH_CUDA
+#include "swapping/cuda/VoxelSwapManager_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+VoxelSwapManager_Ptr VoxelSwapManagerFactory::make_voxel_swap_manager(ITMLibSettings::DeviceType deviceType, int lookaheadFrames)
+{
+  VoxelSwapManager_Ptr swapManager;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    swapManager.reset(new VoxelSwapManager_CUDA(lookaheadFrames));
+#else
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    swapManager.reset(new VoxelSwapManager_CPU(lookaheadFrames));
+  }
+
+  return swapManager;
+}
+
+}
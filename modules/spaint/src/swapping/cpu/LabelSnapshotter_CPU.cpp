@@ -0,0 +1,69 @@
+/**
+ * spaint: LabelSnapshotter_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/cpu/LabelSnapshotter_CPU.h"
+using namespace ITMLib;
+
+#include "swapping/shared/LabelSnapshotter_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+LabelSnapshotter_CPU::LabelSnapshotter_CPU(const std::string& path, double intervalSeconds)
+: LabelSnapshotter(path, intervalSeconds)
+{}
+
+//#################### DESTRUCTOR ####################
+
+LabelSnapshotter_CPU::~LabelSnapshotter_CPU()
+{
+  stop_writer();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void LabelSnapshotter_CPU::begin_gather(const SpaintVoxelScene *scene)
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  SpaintVoxel::PackedLabel *blockLabels = m_blockLabelsMB->GetData(MEMORYDEVICE_CPU);
+  Vector3s *blockPositions = m_blockPositionsMB->GetData(MEMORYDEVICE_CPU);
+
+  // Find the resident voxel blocks.
+  m_blockPtrs.clear();
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    const ITMHashEntry& hashEntry = hashTable[entryID];
+    if(hashEntry.ptr < 0) continue;
+
+    blockPositions[m_blockPtrs.size()] = hashEntry.pos;
+    m_blockPtrs.push_back(hashEntry.ptr);
+  }
+
+  const int blockCount = static_cast<int>(m_blockPtrs.size());
+  *m_blockCountMB->GetData(MEMORYDEVICE_CPU) = blockCount;
+
+  // Copy their labels into the staging area.
+  const int *blockPtrs = blockCount > 0 ? &m_blockPtrs[0] : NULL;
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+  {
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      copy_gathered_label(blockIndex, linearIdx, blockPtrs, voxelData, labelData, blockLabels);
+    }
+  }
+}
+
+void LabelSnapshotter_CPU::end_gather()
+{
+  // No-op (the labels were gathered synchronously by begin_gather)
+}
+
+}
@@ -0,0 +1,24 @@
+/**
+ * spaint: VoxelSceneArchive_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/cpu/VoxelSceneArchive_CPU.h"
+
+#include <cstring>
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelSceneArchive_CPU::copy_from_scene_memory(void *dest, const void *src, size_t size) const
+{
+  memcpy(dest, src, size);
+}
+
+void VoxelSceneArchive_CPU::copy_to_scene_memory(void *dest, const void *src, size_t size) const
+{
+  memcpy(dest, src, size);
+}
+
+}
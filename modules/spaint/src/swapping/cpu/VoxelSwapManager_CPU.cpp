@@ -0,0 +1,107 @@
+/**
+ * spaint: VoxelSwapManager_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/cpu/VoxelSwapManager_CPU.h"
+using namespace ITMLib;
+
+#include "swapping/shared/VoxelSwapManager_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelSwapManager_CPU::VoxelSwapManager_CPU(int lookaheadFrames)
+: VoxelSwapManager(lookaheadFrames)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelSwapManager_CPU::exclude_predicted_entries(ITMRenderState_VH *renderState) const
+{
+  const unsigned char *predictedFlags = m_predictedFlagsMB->GetData(MEMORYDEVICE_CPU);
+  int *visibleEntryIDs = renderState->GetVisibleEntityIDs();
+
+  // Compact the list of visible entries in place, preserving the order of the entries that remain.
+  int visibleEntryCount = 0;
+  for(int i = 0; i < renderState->noVisibleEntities; ++i)
+  {
+    const int entryID = visibleEntryIDs[i];
+    if(!predictedFlags[entryID]) visibleEntryIDs[visibleEntryCount++] = entryID;
+  }
+
+  renderState->noVisibleEntities = visibleEntryCount;
+}
+
+int VoxelSwapManager_CPU::find_swapped_in_entries(const SpaintVoxelScene *scene) const
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  unsigned char *restorationFlags = m_restorationFlagsMB->GetData(MEMORYDEVICE_CPU);
+  int *swappedInEntryIDs = m_swappedInEntryIDsMB->GetData(MEMORYDEVICE_CPU);
+
+  int swappedInEntryCount = 0;
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries && swappedInEntryCount < MAX_RESTORED_BLOCK_COUNT; ++entryID)
+  {
+    if(is_swapped_in_entry(entryID, hashTable, restorationFlags))
+    {
+      swappedInEntryIDs[swappedInEntryCount++] = entryID;
+      restorationFlags[entryID] = 0;
+    }
+  }
+
+  return swappedInEntryCount;
+}
+
+void VoxelSwapManager_CPU::flag_predicted_entries(const PredictedPoses& predictedPoses, const Vector4f& projParams, const Vector2i& imgSize,
+                                                  const SpaintVoxelScene *scene, ITMRenderState_VH *renderState) const
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const float voxelSize = scene->sceneParams->voxelSize;
+  const float maxDepth = scene->sceneParams->viewFrustum_max;
+  unsigned char *entriesVisibleType = renderState->GetEntriesVisibleType();
+  unsigned char *predictedFlags = m_predictedFlagsMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    flag_predicted_entry(entryID, hashTable, predictedPoses, projParams, imgSize, voxelSize, maxDepth, entriesVisibleType, predictedFlags);
+  }
+}
+
+void VoxelSwapManager_CPU::flag_swapped_out_entries(const SpaintVoxelScene *scene) const
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  unsigned char *restorationFlags = m_restorationFlagsMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int entryID = 0; entryID < ITMVoxelBlockHash::noTotalEntries; ++entryID)
+  {
+    flag_swapped_out_entry(entryID, hashTable, restorationFlags);
+  }
+}
+
+void VoxelSwapManager_CPU::write_stored_labels(int swappedInEntryCount, SpaintVoxelScene *scene) const
+{
+  const int *swappedInEntryIDs = m_swappedInEntryIDsMB->GetData(MEMORYDEVICE_CPU);
+  const unsigned char *storedLabelsAvailable = m_storedLabelsAvailableMB->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel::PackedLabel *storedLabels = m_storedLabelsMB->GetData(MEMORYDEVICE_CPU);
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const int voxelCount = swappedInEntryCount * SDF_BLOCK_SIZE3;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < voxelCount; ++i)
+  {
+    restore_stored_label(i, swappedInEntryIDs, storedLabelsAvailable, storedLabels, hashTable, voxelData, labelData);
+  }
+}
+
+}
@@ -0,0 +1,123 @@
+/**
+ * spaint: LabelSnapshotter_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/cuda/LabelSnapshotter_CUDA.h"
+using namespace ITMLib;
+
+#include <ORUtils/CUDADefines.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "swapping/shared/LabelSnapshotter_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_find_resident_entries(const ITMHashEntry *hashTable, Vector3s *blockPositions, int *blockPtrs, int *blockCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < ITMVoxelBlockHash::noTotalEntries)
+  {
+    const ITMHashEntry& hashEntry = hashTable[entryID];
+    if(hashEntry.ptr >= 0)
+    {
+      const int blockIndex = atomicAdd(blockCount, 1);
+      blockPositions[blockIndex] = hashEntry.pos;
+      blockPtrs[blockIndex] = hashEntry.ptr;
+    }
+  }
+}
+
+__global__ void ck_gather_labels(const int *blockCount, const int *blockPtrs, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                 SpaintVoxel::PackedLabel *blockLabels)
+{
+  // Note: The grid is sized for the maximum possible number of resident blocks, so that it can be launched without first reading the count back.
+  const int blockIndex = blockIdx.x;
+  if(blockIndex < *blockCount)
+  {
+    copy_gathered_label(blockIndex, threadIdx.x, blockPtrs, voxelData, labelData, blockLabels);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+LabelSnapshotter_CUDA::LabelSnapshotter_CUDA(const std::string& path, double intervalSeconds)
+: LabelSnapshotter(path, intervalSeconds), m_device(0)
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_blockPtrsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "LabelSnapshotter.BlockPtrs");
+
+  ORcudaSafeCall(cudaStreamCreate(&m_stream));
+  ORcudaSafeCall(cudaEventCreateWithFlags(&m_gatheredEvent, cudaEventDisableTiming));
+}
+
+//#################### DESTRUCTOR ####################
+
+LabelSnapshotter_CUDA::~LabelSnapshotter_CUDA()
+{
+  // Make sure that the writer thread has finished with the stream and event before destroying them.
+  stop_writer();
+
+  cudaEventDestroy(m_gatheredEvent);
+  cudaStreamDestroy(m_stream);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void LabelSnapshotter_CUDA::begin_gather(const SpaintVoxelScene *scene)
+{
+  ORcudaSafeCall(cudaGetDevice(&m_device));
+
+  int *blockCount = m_blockCountMB->GetData(MEMORYDEVICE_CUDA);
+  ORcudaSafeCall(cudaMemsetAsync(blockCount, 0, sizeof(int), m_stream));
+
+  int threadsPerBlock = 256;
+  int numBlocks = (ITMVoxelBlockHash::noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_find_resident_entries<<<numBlocks,threadsPerBlock,0,m_stream>>>(
+    scene->index.GetEntries(),
+    m_blockPositionsMB->GetData(MEMORYDEVICE_CUDA),
+    m_blockPtrsMB->GetData(MEMORYDEVICE_CUDA),
+    blockCount
+  );
+
+  ck_gather_labels<<<SDF_LOCAL_BLOCK_NUM,SDF_BLOCK_SIZE3,0,m_stream>>>(
+    blockCount,
+    m_blockPtrsMB->GetData(MEMORYDEVICE_CUDA),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    m_blockLabelsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  ORcudaSafeCall(cudaMemcpyAsync(m_blockCountMB->GetData(MEMORYDEVICE_CPU), blockCount, sizeof(int), cudaMemcpyDeviceToHost, m_stream));
+  ORcudaSafeCall(cudaEventRecord(m_gatheredEvent, m_stream));
+}
+
+void LabelSnapshotter_CUDA::end_gather()
+{
+  // Note: This is called on the writer thread, which needs to target the same device as the main thread did when the snapshot was started.
+  ORcudaSafeCall(cudaSetDevice(m_device));
+  ORcudaSafeCall(cudaEventSynchronize(m_gatheredEvent));
+
+  // Copy only the gathered blocks (rather than the whole staging area) across to the CPU.
+  const int blockCount = *m_blockCountMB->GetData(MEMORYDEVICE_CPU);
+  if(blockCount == 0) return;
+
+  ORcudaSafeCall(cudaMemcpyAsync(
+    m_blockPositionsMB->GetData(MEMORYDEVICE_CPU), m_blockPositionsMB->GetData(MEMORYDEVICE_CUDA),
+    blockCount * sizeof(Vector3s), cudaMemcpyDeviceToHost, m_stream
+  ));
+
+  ORcudaSafeCall(cudaMemcpyAsync(
+    m_blockLabelsMB->GetData(MEMORYDEVICE_CPU), m_blockLabelsMB->GetData(MEMORYDEVICE_CUDA),
+    blockCount * SDF_BLOCK_SIZE3 * sizeof(SpaintVoxel::PackedLabel), cudaMemcpyDeviceToHost, m_stream
+  ));
+
+  ORcudaSafeCall(cudaStreamSynchronize(m_stream));
+}
+
+}
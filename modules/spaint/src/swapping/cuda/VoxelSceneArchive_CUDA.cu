@@ -0,0 +1,24 @@
+/**
+ * spaint: VoxelSceneArchive_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/cuda/VoxelSceneArchive_CUDA.h"
+
+#include <ORUtils/CUDADefines.h>
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelSceneArchive_CUDA::copy_from_scene_memory(void *dest, const void *src, size_t size) const
+{
+  ORcudaSafeCall(cudaMemcpy(dest, src, size, cudaMemcpyDeviceToHost));
+}
+
+void VoxelSceneArchive_CUDA::copy_to_scene_memory(void *dest, const void *src, size_t size) const
+{
+  ORcudaSafeCall(cudaMemcpy(dest, src, size, cudaMemcpyHostToDevice));
+}
+
+}
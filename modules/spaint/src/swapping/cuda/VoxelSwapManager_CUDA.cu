@@ -0,0 +1,185 @@
+/**
+ * spaint: VoxelSwapManager_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/cuda/VoxelSwapManager_CUDA.h"
+using namespace ITMLib;
+
+#include <algorithm>
+
+#include <ORUtils/CUDADefines.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "swapping/shared/VoxelSwapManager_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_exclude_predicted_entries(const int *visibleEntryIDs, int visibleEntryCount, const unsigned char *predictedFlags,
+                                             int *remainingVisibleEntryIDs, int *remainingVisibleEntryCount)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < visibleEntryCount)
+  {
+    const int entryID = visibleEntryIDs[i];
+    if(!predictedFlags[entryID]) remainingVisibleEntryIDs[atomicAdd(remainingVisibleEntryCount, 1)] = entryID;
+  }
+}
+
+__global__ void ck_find_swapped_in_entries(const ITMHashEntry *hashTable, unsigned char *restorationFlags, int *swappedInEntryIDs, int *swappedInEntryCount)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < ITMVoxelBlockHash::noTotalEntries && is_swapped_in_entry(entryID, hashTable, restorationFlags))
+  {
+    // Note: Entries beyond the capacity of the list are left flagged, so that they will be found on a subsequent call.
+    const int i = atomicAdd(swappedInEntryCount, 1);
+    if(i < VoxelSwapManager::MAX_RESTORED_BLOCK_COUNT)
+    {
+      swappedInEntryIDs[i] = entryID;
+      restorationFlags[entryID] = 0;
+    }
+  }
+}
+
+__global__ void ck_flag_predicted_entries(const ITMHashEntry *hashTable, VoxelSwapManager::PredictedPoses predictedPoses, Vector4f projParams, Vector2i imgSize,
+                                          float voxelSize, float maxDepth, unsigned char *entriesVisibleType, unsigned char *predictedFlags)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < ITMVoxelBlockHash::noTotalEntries)
+  {
+    flag_predicted_entry(entryID, hashTable, predictedPoses, projParams, imgSize, voxelSize, maxDepth, entriesVisibleType, predictedFlags);
+  }
+}
+
+__global__ void ck_flag_swapped_out_entries(const ITMHashEntry *hashTable, unsigned char *restorationFlags)
+{
+  int entryID = threadIdx.x + blockDim.x * blockIdx.x;
+  if(entryID < ITMVoxelBlockHash::noTotalEntries)
+  {
+    flag_swapped_out_entry(entryID, hashTable, restorationFlags);
+  }
+}
+
+__global__ void ck_restore_stored_labels(int voxelCount, const int *swappedInEntryIDs, const unsigned char *storedLabelsAvailable, const SpaintVoxel::PackedLabel *storedLabels,
+                                         const ITMHashEntry *hashTable, SpaintVoxel *voxelData, SpaintVoxel::PackedLabel *labelData)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < voxelCount)
+  {
+    restore_stored_label(i, swappedInEntryIDs, storedLabelsAvailable, storedLabels, hashTable, voxelData, labelData);
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+VoxelSwapManager_CUDA::VoxelSwapManager_CUDA(int lookaheadFrames)
+: VoxelSwapManager(lookaheadFrames)
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_remainingVisibleEntryCountMB = mbf.make_block<int>(1, "VoxelSwapManager");
+  m_remainingVisibleEntryIDsMB = mbf.make_block<int>(SDF_LOCAL_BLOCK_NUM, "VoxelSwapManager");
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void VoxelSwapManager_CUDA::exclude_predicted_entries(ITMRenderState_VH *renderState) const
+{
+  const int visibleEntryCount = renderState->noVisibleEntities;
+  if(visibleEntryCount == 0) return;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (visibleEntryCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_remainingVisibleEntryCountMB->Clear();
+
+  ck_exclude_predicted_entries<<<numBlocks,threadsPerBlock>>>(
+    renderState->GetVisibleEntityIDs(),
+    visibleEntryCount,
+    m_predictedFlagsMB->GetData(MEMORYDEVICE_CUDA),
+    m_remainingVisibleEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_remainingVisibleEntryCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_remainingVisibleEntryCountMB->UpdateHostFromDevice();
+  const int remainingVisibleEntryCount = *m_remainingVisibleEntryCountMB->GetData(MEMORYDEVICE_CPU);
+
+  ORcudaSafeCall(cudaMemcpy(
+    renderState->GetVisibleEntityIDs(),
+    m_remainingVisibleEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    remainingVisibleEntryCount * sizeof(int),
+    cudaMemcpyDeviceToDevice
+  ));
+
+  renderState->noVisibleEntities = remainingVisibleEntryCount;
+}
+
+int VoxelSwapManager_CUDA::find_swapped_in_entries(const SpaintVoxelScene *scene) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (ITMVoxelBlockHash::noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_swappedInEntryCountMB->Clear();
+
+  ck_find_swapped_in_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    m_restorationFlagsMB->GetData(MEMORYDEVICE_CUDA),
+    m_swappedInEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_swappedInEntryCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_swappedInEntryCountMB->UpdateHostFromDevice();
+  return std::min(*m_swappedInEntryCountMB->GetData(MEMORYDEVICE_CPU), static_cast<int>(MAX_RESTORED_BLOCK_COUNT));
+}
+
+void VoxelSwapManager_CUDA::flag_predicted_entries(const PredictedPoses& predictedPoses, const Vector4f& projParams, const Vector2i& imgSize,
+                                                   const SpaintVoxelScene *scene, ITMRenderState_VH *renderState) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (ITMVoxelBlockHash::noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_flag_predicted_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    predictedPoses,
+    projParams,
+    imgSize,
+    scene->sceneParams->voxelSize,
+    scene->sceneParams->viewFrustum_max,
+    renderState->GetEntriesVisibleType(),
+    m_predictedFlagsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void VoxelSwapManager_CUDA::flag_swapped_out_entries(const SpaintVoxelScene *scene) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (ITMVoxelBlockHash::noTotalEntries + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_flag_swapped_out_entries<<<numBlocks,threadsPerBlock>>>(
+    scene->index.GetEntries(),
+    m_restorationFlagsMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void VoxelSwapManager_CUDA::write_stored_labels(int swappedInEntryCount, SpaintVoxelScene *scene) const
+{
+  const int voxelCount = swappedInEntryCount * SDF_BLOCK_SIZE3;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (voxelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_restore_stored_labels<<<numBlocks,threadsPerBlock>>>(
+    voxelCount,
+    m_swappedInEntryIDsMB->GetData(MEMORYDEVICE_CUDA),
+    m_storedLabelsAvailableMB->GetData(MEMORYDEVICE_CUDA),
+    m_storedLabelsMB->GetData(MEMORYDEVICE_CUDA),
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data()
+  );
+}
+
+}
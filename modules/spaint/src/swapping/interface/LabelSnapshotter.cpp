@@ -0,0 +1,418 @@
+/**
+ * spaint: LabelSnapshotter.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/interface/LabelSnapshotter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace {
+
+//#################### CONSTANTS ####################
+
+/** The signature at the start of a label log file. */
+const char *HEADER_SIGNATURE = "SPTLBD01";
+
+/** The size (in bytes) of the signature at the start of a label log file. */
+const size_t SIGNATURE_SIZE = 8;
+
+//#################### LOCAL HELPER FUNCTIONS ####################
+
+/**
+ * \brief Appends a value (in native byte order) to a buffer.
+ *
+ * \param value The value to append.
+ * \param out   The buffer.
+ */
+template <typename T>
+void append_value(const T& value, std::vector<unsigned char>& out)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * \brief Computes a key for a voxel block that can be used to order blocks by position.
+ *
+ * \param blockPos  The position of the voxel block (in block coordinates).
+ * \return          The key.
+ */
+unsigned long long block_key(const Vector3s& blockPos)
+{
+  return (static_cast<unsigned long long>(blockPos.x + 32768) << 32) |
+         (static_cast<unsigned long long>(blockPos.y + 32768) << 16) |
+          static_cast<unsigned long long>(blockPos.z + 32768);
+}
+
+/**
+ * \brief Attempts to read a value (in native byte order) from a buffer, advancing the read pointer past it.
+ *
+ * \param p     The read pointer.
+ * \param end   A pointer to the end of the buffer.
+ * \param value The variable into which to read the value.
+ * \return      true, if the value was successfully read, or false if there was not enough data left in the buffer.
+ */
+template <typename T>
+bool read_value(const unsigned char *& p, const unsigned char *end, T& value)
+{
+  if(static_cast<size_t>(end - p) < sizeof(T)) return false;
+  memcpy(&value, p, sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+
+/**
+ * \brief A comparator that orders the indices of gathered voxel blocks by their keys.
+ */
+struct KeyIndexComparator
+{
+  const std::vector<unsigned long long>& m_keys;
+
+  explicit KeyIndexComparator(const std::vector<unsigned long long>& keys)
+  : m_keys(keys)
+  {}
+
+  bool operator()(int lhs, int rhs) const
+  {
+    return m_keys[lhs] < m_keys[rhs];
+  }
+};
+
+}
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+LabelSnapshotter::LabelSnapshotter(const std::string& path, double intervalSeconds)
+: m_file(path.c_str(), std::ios::binary | std::ios::trunc),
+  m_interval(static_cast<boost::chrono::milliseconds::rep>(intervalSeconds * 1000)),
+  m_logStartTime(boost::chrono::steady_clock::now()),
+  m_stagingBusy(false),
+  m_startedSnapshotCount(0),
+  m_stopRequested(false),
+  m_writtenSnapshotCount(0)
+{
+  if(!m_file) throw std::runtime_error("Error: Could not open label log file '" + path + "' for writing");
+
+  // The first snapshot is taken after a full interval, rather than on the first frame (when there is nothing to save).
+  m_lastSnapshotTime = m_logStartTime;
+
+  std::vector<unsigned char> header(HEADER_SIGNATURE, HEADER_SIGNATURE + SIGNATURE_SIZE);
+  append_value(static_cast<unsigned int>(SDF_BLOCK_SIZE3), header);
+  m_file.write(reinterpret_cast<const char*>(&header[0]), header.size());
+  m_file.flush();
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_blockCountMB = mbf.make_block<int>(1, "LabelSnapshotter.BlockCount");
+  m_blockLabelsMB = mbf.make_block<SpaintVoxel::PackedLabel>(SDF_LOCAL_BLOCK_NUM * SDF_BLOCK_SIZE3, "LabelSnapshotter.BlockLabels");
+  m_blockPositionsMB = mbf.make_block<Vector3s>(SDF_LOCAL_BLOCK_NUM, "LabelSnapshotter.BlockPositions");
+
+  m_writerThread = boost::thread(&LabelSnapshotter::run_writer, this);
+}
+
+//#################### DESTRUCTOR ####################
+
+LabelSnapshotter::~LabelSnapshotter()
+{
+  stop_writer();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void LabelSnapshotter::finish(const SpaintVoxelScene *scene)
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+
+  while(m_stagingBusy && m_error.empty()) m_stateChanged.wait(lock);
+  check_writer();
+
+  start_snapshot(scene);
+
+  while(m_writtenSnapshotCount < m_startedSnapshotCount && m_error.empty()) m_stateChanged.wait(lock);
+  check_writer();
+}
+
+size_t LabelSnapshotter::get_written_snapshot_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_writtenSnapshotCount;
+}
+
+bool LabelSnapshotter::update(const SpaintVoxelScene *scene)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  check_writer();
+
+  if(m_stagingBusy || boost::chrono::steady_clock::now() - m_lastSnapshotTime < m_interval) return false;
+
+  start_snapshot(scene);
+  return true;
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+size_t LabelSnapshotter::load_latest_labels(const std::string& path, std::vector<Vector3s>& voxelLocations, std::vector<SpaintVoxel::PackedLabel>& labels)
+{
+  std::ifstream fs(path.c_str(), std::ios::binary);
+  if(!fs) throw std::runtime_error("Error: Could not open label log file '" + path + "'");
+
+  std::vector<unsigned char> buffer((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+  const unsigned char *p = buffer.empty() ? NULL : &buffer[0];
+  const unsigned char *end = p + buffer.size();
+
+  unsigned int voxelsPerBlock = 0;
+  if(buffer.size() < SIGNATURE_SIZE || memcmp(p, HEADER_SIGNATURE, SIGNATURE_SIZE) != 0)
+  {
+    throw std::runtime_error("Error: '" + path + "' is not a label log file");
+  }
+  p += SIGNATURE_SIZE;
+  if(!read_value(p, end, voxelsPerBlock) || voxelsPerBlock != SDF_BLOCK_SIZE3)
+  {
+    throw std::runtime_error("Error: The label log file '" + path + "' was written with a different voxel block size");
+  }
+
+  // Replay the complete records in order, keeping the most recent labels of each block.
+  std::map<unsigned long long,std::pair<Vector3s,std::vector<SpaintVoxel::PackedLabel> > > latestLabels;
+  size_t snapshotCount = 0;
+  unsigned int recordSize;
+  while(read_value(p, end, recordSize) && static_cast<size_t>(end - p) >= recordSize)
+  {
+    const unsigned char *recordEnd = p + recordSize;
+
+    unsigned long long timestamp;
+    unsigned int blockCount;
+    if(!read_value(p, recordEnd, timestamp) || !read_value(p, recordEnd, blockCount))
+    {
+      throw std::runtime_error("Error: The label log file '" + path + "' is corrupt");
+    }
+
+    for(unsigned int i = 0; i < blockCount; ++i)
+    {
+      Vector3s blockPos;
+      unsigned short runCount;
+      if(!read_value(p, recordEnd, blockPos.x) || !read_value(p, recordEnd, blockPos.y) || !read_value(p, recordEnd, blockPos.z) ||
+         !read_value(p, recordEnd, runCount))
+      {
+        throw std::runtime_error("Error: The label log file '" + path + "' is corrupt");
+      }
+
+      std::vector<SpaintVoxel::PackedLabel> blockLabels;
+      blockLabels.reserve(SDF_BLOCK_SIZE3);
+      for(unsigned short j = 0; j < runCount; ++j)
+      {
+        unsigned short runLength;
+        SpaintVoxel::PackedLabel label;
+        if(!read_value(p, recordEnd, runLength) || !read_value(p, recordEnd, label) || blockLabels.size() + runLength > SDF_BLOCK_SIZE3)
+        {
+          throw std::runtime_error("Error: The label log file '" + path + "' is corrupt");
+        }
+        blockLabels.insert(blockLabels.end(), runLength, label);
+      }
+      if(blockLabels.size() != SDF_BLOCK_SIZE3) throw std::runtime_error("Error: The label log file '" + path + "' is corrupt");
+
+      std::pair<Vector3s,std::vector<SpaintVoxel::PackedLabel> >& entry = latestLabels[block_key(blockPos)];
+      entry.first = blockPos;
+      entry.second.swap(blockLabels);
+    }
+
+    p = recordEnd;
+    ++snapshotCount;
+  }
+
+  // Convert the labels of each block into a list of voxel locations and labels.
+  voxelLocations.clear();
+  labels.clear();
+  voxelLocations.reserve(latestLabels.size() * SDF_BLOCK_SIZE3);
+  labels.reserve(latestLabels.size() * SDF_BLOCK_SIZE3);
+
+  for(std::map<unsigned long long,std::pair<Vector3s,std::vector<SpaintVoxel::PackedLabel> > >::const_iterator it = latestLabels.begin(), iend = latestLabels.end(); it != iend; ++it)
+  {
+    const Vector3s& blockPos = it->second.first;
+    for(int linearIdx = 0; linearIdx < SDF_BLOCK_SIZE3; ++linearIdx)
+    {
+      const int x = linearIdx % SDF_BLOCK_SIZE, y = (linearIdx / SDF_BLOCK_SIZE) % SDF_BLOCK_SIZE, z = linearIdx / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE);
+      voxelLocations.push_back(Vector3s(
+        static_cast<short>(blockPos.x * SDF_BLOCK_SIZE + x),
+        static_cast<short>(blockPos.y * SDF_BLOCK_SIZE + y),
+        static_cast<short>(blockPos.z * SDF_BLOCK_SIZE + z)
+      ));
+      labels.push_back(it->second.second[linearIdx]);
+    }
+  }
+
+  return snapshotCount;
+}
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
+
+void LabelSnapshotter::stop_writer()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_stopRequested = true;
+  }
+  m_stateChanged.notify_all();
+
+  if(m_writerThread.joinable()) m_writerThread.join();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void LabelSnapshotter::check_writer() const
+{
+  if(!m_error.empty()) throw std::runtime_error("Error: The label snapshotter has stopped (" + m_error + ")");
+}
+
+void LabelSnapshotter::encode_record(int blockCount, std::vector<unsigned char>& record)
+{
+  const Vector3s *blockPositions = m_blockPositionsMB->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel::PackedLabel *blockLabels = m_blockLabelsMB->GetData(MEMORYDEVICE_CPU);
+
+  // Sort the gathered blocks by position, so that they can be merged with those from the previous snapshot.
+  std::vector<unsigned long long> keys(blockCount);
+  std::vector<int> order(blockCount);
+  for(int i = 0; i < blockCount; ++i)
+  {
+    keys[i] = block_key(blockPositions[i]);
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), KeyIndexComparator(keys));
+
+  std::vector<unsigned long long> currentKeys;
+  std::vector<SpaintVoxel::PackedLabel> currentLabels;
+  currentKeys.reserve(blockCount);
+  currentLabels.reserve(blockCount * SDF_BLOCK_SIZE3);
+
+  record.clear();
+  append_value(static_cast<unsigned long long>(boost::chrono::duration_cast<boost::chrono::milliseconds>(m_stagingTime - m_logStartTime).count()), record);
+  append_value(0U, record);
+
+  unsigned int changedBlockCount = 0;
+  size_t j = 0, previousCount = m_previousKeys.size();
+  for(int k = 0; k < blockCount; ++k)
+  {
+    const int i = order[k];
+    const SpaintVoxel::PackedLabel *labels = blockLabels + i * SDF_BLOCK_SIZE3;
+
+    // Note: Blocks that are no longer resident (e.g. because they have been swapped out) are kept in the
+    //       previous snapshot, since their labels have not changed.
+    while(j < previousCount && m_previousKeys[j] < keys[i])
+    {
+      currentKeys.push_back(m_previousKeys[j]);
+      currentLabels.insert(currentLabels.end(), m_previousLabels.begin() + j * SDF_BLOCK_SIZE3, m_previousLabels.begin() + (j + 1) * SDF_BLOCK_SIZE3);
+      ++j;
+    }
+
+    bool changed = true;
+    if(j < previousCount && m_previousKeys[j] == keys[i])
+    {
+      changed = !std::equal(labels, labels + SDF_BLOCK_SIZE3, m_previousLabels.begin() + j * SDF_BLOCK_SIZE3);
+      ++j;
+    }
+
+    currentKeys.push_back(keys[i]);
+    currentLabels.insert(currentLabels.end(), labels, labels + SDF_BLOCK_SIZE3);
+    if(!changed) continue;
+
+    // Append the block's position and its run-length encoded labels to the record.
+    const Vector3s& blockPos = blockPositions[i];
+    append_value(blockPos.x, record);
+    append_value(blockPos.y, record);
+    append_value(blockPos.z, record);
+
+    const size_t runCountOffset = record.size();
+    append_value(static_cast<unsigned short>(0), record);
+
+    unsigned short runCount = 0;
+    for(int start = 0, end; start < SDF_BLOCK_SIZE3; start = end)
+    {
+      for(end = start + 1; end < SDF_BLOCK_SIZE3 && labels[end] == labels[start]; ++end);
+      append_value(static_cast<unsigned short>(end - start), record);
+      append_value(labels[start], record);
+      ++runCount;
+    }
+
+    memcpy(&record[runCountOffset], &runCount, sizeof(unsigned short));
+    ++changedBlockCount;
+  }
+
+  for(; j < previousCount; ++j)
+  {
+    currentKeys.push_back(m_previousKeys[j]);
+    currentLabels.insert(currentLabels.end(), m_previousLabels.begin() + j * SDF_BLOCK_SIZE3, m_previousLabels.begin() + (j + 1) * SDF_BLOCK_SIZE3);
+  }
+
+  memcpy(&record[sizeof(unsigned long long)], &changedBlockCount, sizeof(unsigned int));
+
+  m_previousKeys.swap(currentKeys);
+  m_previousLabels.swap(currentLabels);
+}
+
+void LabelSnapshotter::run_writer()
+{
+  std::vector<unsigned char> record;
+
+  try
+  {
+    for(;;)
+    {
+      {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while(!m_stagingBusy && !m_stopRequested) m_stateChanged.wait(lock);
+        if(!m_stagingBusy) return;
+      }
+
+      // Wait for the labels to reach the CPU, and compare them with those from the previous snapshot.
+      end_gather();
+      encode_record(*m_blockCountMB->GetData(MEMORYDEVICE_CPU), record);
+
+      // Release the staging area, so that the next snapshot can be started whilst this one is being written.
+      {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_stagingBusy = false;
+      }
+      m_stateChanged.notify_all();
+
+      const unsigned int recordSize = static_cast<unsigned int>(record.size());
+      m_file.write(reinterpret_cast<const char*>(&recordSize), sizeof(unsigned int));
+      m_file.write(reinterpret_cast<const char*>(&record[0]), record.size());
+      m_file.flush();
+      if(!m_file) throw std::runtime_error("could not write to the label log file");
+
+      {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        ++m_writtenSnapshotCount;
+      }
+      m_stateChanged.notify_all();
+    }
+  }
+  catch(std::exception& e)
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_error = e.what();
+    }
+    m_stateChanged.notify_all();
+  }
+}
+
+void LabelSnapshotter::start_snapshot(const SpaintVoxelScene *scene)
+{
+  begin_gather(scene);
+
+  m_lastSnapshotTime = m_stagingTime = boost::chrono::steady_clock::now();
+  m_stagingBusy = true;
+  ++m_startedSnapshotCount;
+  m_stateChanged.notify_all();
+}
+
+}
@@ -0,0 +1,539 @@
+/**
+ * spaint: VoxelSceneArchive.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/interface/VoxelSceneArchive.h"
+using namespace ITMLib;
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+
+#include "markers/shared/VoxelMarker_Shared.h"
+#include "swapping/shared/VoxelSwapManager_Shared.h"
+
+namespace {
+
+//#################### CONSTANTS ####################
+
+/** The signature at the start of a scene archive file. */
+const char *HEADER_SIGNATURE = "SPTSCN01";
+
+/** The size (in bytes) of the header of a scene archive file. */
+const size_t HEADER_SIZE = 8 + 4 * 4 + 4;
+
+/** The size (in bytes) of each entry in the index of a scene archive file. */
+const size_t INDEX_ENTRY_SIZE = 3 * 4 + 4 + 8 + 8;
+
+/** The size (in bytes) of the signatures in a scene archive file. */
+const size_t SIGNATURE_SIZE = 8;
+
+/** The signature at the end of the trailer of a scene archive file. */
+const char *TRAILER_SIGNATURE = "SPTSCNIX";
+
+/** The size (in bytes) of the trailer of a scene archive file. */
+const size_t TRAILER_SIZE = 8 + 4 + SIGNATURE_SIZE;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Appends a value to a buffer (in native byte order).
+ *
+ * \param value The value.
+ * \param out   The buffer.
+ */
+template <typename T>
+void append_value(const T& value, std::vector<unsigned char>& out)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * \brief Computes the position of the chunk containing the specified voxel block.
+ *
+ * \param blockPos  The position of the voxel block (in block coordinates).
+ * \return          The position of the chunk containing it (in chunk coordinates).
+ */
+Vector3i chunk_pos(const Vector3s& blockPos)
+{
+  const int n = spaint::VoxelSceneArchive::CHUNK_SIZE;
+  const int b[] = { blockPos.x, blockPos.y, blockPos.z };
+  int c[3];
+  for(int i = 0; i < 3; ++i) c[i] = b[i] >= 0 ? b[i] / n : (b[i] - n + 1) / n;
+  return Vector3i(c[0], c[1], c[2]);
+}
+
+/**
+ * \brief Attempts to read a value (in native byte order) from a buffer, advancing the read pointer past it.
+ *
+ * \param p     The read pointer.
+ * \param end   A pointer to the end of the buffer.
+ * \param value The variable into which to read the value.
+ * \return      true, if the value was successfully read, or false if there was not enough data left in the buffer.
+ */
+template <typename T>
+bool read_value(const unsigned char *& p, const unsigned char *end, T& value)
+{
+  if(static_cast<size_t>(end - p) < sizeof(T)) return false;
+  memcpy(&value, p, sizeof(T));
+  p += sizeof(T);
+  return true;
+}
+
+}
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelSceneArchive::VoxelSceneArchive()
+: m_loadedChunkCount(0)
+{}
+
+//#################### DESTRUCTOR ####################
+
+VoxelSceneArchive::~VoxelSceneArchive() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VoxelSceneArchive::close()
+{
+  if(m_file.is_open()) m_file.close();
+  m_chunks.clear();
+  m_loadedChunkCount = 0;
+  m_path.clear();
+}
+
+bool VoxelSceneArchive::is_open() const
+{
+  return m_file.is_open();
+}
+
+size_t VoxelSceneArchive::load_all_chunks(SpaintVoxelScene *scene)
+{
+  std::vector<size_t> chunkIndices;
+  for(size_t i = 0, size = m_chunks.size(); i < size; ++i)
+  {
+    if(!m_chunks[i].loaded) chunkIndices.push_back(i);
+  }
+
+  return load_chunks(chunkIndices, scene);
+}
+
+size_t VoxelSceneArchive::load_visible_chunks(const ORUtils::SE3Pose& pose, const Vector4f& projParams, const Vector2i& imgSize, SpaintVoxelScene *scene)
+{
+  if(!is_open()) return 0;
+
+  // Find the chunks that have not yet been loaded and whose bounding spheres are at least partly visible from the camera.
+  const float chunkSize = scene->sceneParams->voxelSize * SDF_BLOCK_SIZE * CHUNK_SIZE;
+  const float radius = 0.8660254f * chunkSize; // half the length of a chunk's diagonal
+  const Matrix4f M = pose.GetM();
+
+  std::vector<size_t> chunkIndices;
+  for(size_t i = 0, size = m_chunks.size(); i < size; ++i)
+  {
+    const ChunkInfo& chunk = m_chunks[i];
+    if(chunk.loaded) continue;
+
+    const Vector4f centre((chunk.pos.x + 0.5f) * chunkSize, (chunk.pos.y + 0.5f) * chunkSize, (chunk.pos.z + 0.5f) * chunkSize, 1.0f);
+    if(is_sphere_visible(centre, radius, M, projParams, imgSize, scene->sceneParams->viewFrustum_max))
+    {
+      chunkIndices.push_back(i);
+    }
+  }
+
+  return load_chunks(chunkIndices, scene);
+}
+
+void VoxelSceneArchive::open(const std::string& path, const SpaintVoxelScene *scene)
+{
+  close();
+
+  try
+  {
+    m_file.open(path);
+  }
+  catch(std::exception&)
+  {
+    throw std::runtime_error("Error: Could not open scene archive " + path);
+  }
+
+  try
+  {
+    const unsigned char *data = reinterpret_cast<const unsigned char*>(m_file.data());
+    const size_t fileSize = m_file.size();
+    const std::runtime_error corruptError("Error: Scene archive " + path + " is corrupt");
+
+    // Check the header, and make sure that the archive is compatible with the scene.
+    if(fileSize < HEADER_SIZE + TRAILER_SIZE || memcmp(data, HEADER_SIGNATURE, SIGNATURE_SIZE) != 0)
+    {
+      throw std::runtime_error("Error: " + path + " is not a scene archive");
+    }
+
+    const unsigned char *p = data + SIGNATURE_SIZE;
+    unsigned int voxelStructSize, blockSize, chunkSize, separateLabels;
+    float voxelSize;
+    read_value(p, data + HEADER_SIZE, voxelStructSize);
+    read_value(p, data + HEADER_SIZE, blockSize);
+    read_value(p, data + HEADER_SIZE, chunkSize);
+    read_value(p, data + HEADER_SIZE, separateLabels);
+    read_value(p, data + HEADER_SIZE, voxelSize);
+
+    if(voxelStructSize != sizeof(SpaintVoxel) || blockSize != SDF_BLOCK_SIZE || chunkSize != CHUNK_SIZE ||
+       (separateLabels != 0) != (scene->get_label_data() != NULL) || voxelSize != scene->sceneParams->voxelSize)
+    {
+      throw std::runtime_error("Error: Scene archive " + path + " was saved from a scene with a different voxel layout or size");
+    }
+
+    // Read the trailer, and use it to find the index.
+    const unsigned char *trailer = data + fileSize - TRAILER_SIZE;
+    if(memcmp(trailer + 12, TRAILER_SIGNATURE, SIGNATURE_SIZE) != 0) throw corruptError;
+
+    unsigned long long indexOffset;
+    unsigned int chunkCount;
+    p = trailer;
+    read_value(p, trailer + TRAILER_SIZE, indexOffset);
+    read_value(p, trailer + TRAILER_SIZE, chunkCount);
+    if(indexOffset < HEADER_SIZE || indexOffset + chunkCount * static_cast<unsigned long long>(INDEX_ENTRY_SIZE) != fileSize - TRAILER_SIZE)
+    {
+      throw corruptError;
+    }
+
+    // Read the index.
+    m_chunks.resize(chunkCount);
+    p = data + indexOffset;
+    for(unsigned int i = 0; i < chunkCount; ++i)
+    {
+      ChunkInfo& chunk = m_chunks[i];
+      read_value(p, trailer, chunk.pos.x);
+      read_value(p, trailer, chunk.pos.y);
+      read_value(p, trailer, chunk.pos.z);
+      read_value(p, trailer, chunk.blockCount);
+      read_value(p, trailer, chunk.offset);
+      read_value(p, trailer, chunk.size);
+      chunk.loaded = false;
+
+      if(chunk.offset < HEADER_SIZE || chunk.offset > indexOffset || chunk.size > indexOffset - chunk.offset) throw corruptError;
+    }
+  }
+  catch(...)
+  {
+    close();
+    throw;
+  }
+
+  m_path = path;
+
+  // If the archive is empty, there is nothing to load, so close it straight away.
+  if(m_chunks.empty()) close();
+}
+
+void VoxelSceneArchive::save(const std::string& path, SpaintVoxelScene *scene)
+{
+  // If the scene is still being loaded from an archive file, finish loading it, so that the parts of the scene
+  // that have not yet been seen are saved as well. This also closes the file, which may be the one we are writing.
+  load_all_chunks(scene);
+
+  const int entryCount = ITMVoxelBlockHash::noTotalEntries;
+  ITMGlobalCache<SpaintVoxel,ITMVoxelBlockHash> *globalCache = scene->globalCache;
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+  // Copy the hash table into host memory, and group the allocated voxel blocks into chunks.
+  std::vector<ITMHashEntry> hashTable(entryCount);
+  copy_from_scene_memory(&hashTable[0], scene->index.GetEntries(), entryCount * sizeof(ITMHashEntry));
+
+  std::map<unsigned long long,std::vector<int> > chunkEntries;
+  for(int entryID = 0; entryID < entryCount; ++entryID)
+  {
+    if(hashTable[entryID].ptr < -1) continue;
+
+    // Note: Block coordinates are 16-bit, so chunk coordinates easily fit in 21 bits each.
+    const Vector3i pos = chunk_pos(hashTable[entryID].pos);
+    const unsigned long long key = (static_cast<unsigned long long>(pos.x + (1 << 20)) << 42) |
+                                   (static_cast<unsigned long long>(pos.y + (1 << 20)) << 21) |
+                                   static_cast<unsigned long long>(pos.z + (1 << 20));
+    chunkEntries[key].push_back(entryID);
+  }
+
+  std::ofstream fs(path.c_str(), std::ios_base::binary);
+  if(!fs) throw std::runtime_error("Error: Could not open scene archive " + path + " for writing");
+  const std::runtime_error writeError("Error: Could not write to scene archive " + path);
+
+  // Write the header.
+  std::vector<unsigned char> buffer(HEADER_SIGNATURE, HEADER_SIGNATURE + SIGNATURE_SIZE);
+  append_value(static_cast<unsigned int>(sizeof(SpaintVoxel)), buffer);
+  append_value(static_cast<unsigned int>(SDF_BLOCK_SIZE), buffer);
+  append_value(static_cast<unsigned int>(CHUNK_SIZE), buffer);
+  append_value(labelData ? 1U : 0U, buffer);
+  append_value(scene->sceneParams->voxelSize, buffer);
+
+  unsigned long long offset = buffer.size();
+  fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
+  if(!fs) throw writeError;
+
+  // Write a record for each chunk.
+  std::vector<ChunkInfo> chunks;
+  std::vector<SpaintVoxel> voxels(SDF_BLOCK_SIZE3);
+  std::vector<SpaintVoxel::PackedLabel> labels(SDF_BLOCK_SIZE3);
+  for(std::map<unsigned long long,std::vector<int> >::const_iterator it = chunkEntries.begin(), iend = chunkEntries.end(); it != iend; ++it)
+  {
+    const std::vector<int>& entryIDs = it->second;
+
+    ChunkInfo chunk;
+    chunk.blockCount = 0;
+    chunk.loaded = true;
+    chunk.offset = offset;
+    chunk.pos = chunk_pos(hashTable[entryIDs[0]].pos);
+
+    buffer.clear();
+    for(size_t i = 0, size = entryIDs.size(); i < size; ++i)
+    {
+      const int entryID = entryIDs[i];
+      const ITMHashEntry& hashEntry = hashTable[entryID];
+
+      // Get the voxels (and labels, if they are stored separately) of the block, either from the scene memory (if it is resident),
+      // or from the global cache (if it is swapped out).
+      if(hashEntry.ptr >= 0)
+      {
+        copy_from_scene_memory(&voxels[0], voxelData + hashEntry.ptr * SDF_BLOCK_SIZE3, SDF_BLOCK_SIZE3 * sizeof(SpaintVoxel));
+        if(labelData) copy_from_scene_memory(&labels[0], labelData + hashEntry.ptr * SDF_BLOCK_SIZE3, SDF_BLOCK_SIZE3 * sizeof(SpaintVoxel::PackedLabel));
+      }
+      else if(globalCache && globalCache->HasStoredData(entryID))
+      {
+        const SpaintVoxel *storedBlock = globalCache->GetStoredVoxelBlock(entryID);
+        std::copy(storedBlock, storedBlock + SDF_BLOCK_SIZE3, voxels.begin());
+      }
+      else continue;
+
+      append_value(hashEntry.pos, buffer);
+      encode_runs(&voxels[0], SDF_BLOCK_SIZE3, buffer);
+      if(labelData) encode_runs(&labels[0], SDF_BLOCK_SIZE3, buffer);
+      ++chunk.blockCount;
+    }
+
+    if(chunk.blockCount == 0) continue;
+
+    chunk.size = buffer.size();
+    fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
+    if(!fs) throw writeError;
+
+    offset += chunk.size;
+    chunks.push_back(chunk);
+  }
+
+  // Write the index and the trailer.
+  buffer.clear();
+  for(size_t i = 0, size = chunks.size(); i < size; ++i)
+  {
+    const ChunkInfo& chunk = chunks[i];
+    append_value(chunk.pos.x, buffer);
+    append_value(chunk.pos.y, buffer);
+    append_value(chunk.pos.z, buffer);
+    append_value(chunk.blockCount, buffer);
+    append_value(chunk.offset, buffer);
+    append_value(chunk.size, buffer);
+  }
+
+  append_value(offset, buffer);
+  append_value(static_cast<unsigned int>(chunks.size()), buffer);
+  buffer.insert(buffer.end(), TRAILER_SIGNATURE, TRAILER_SIGNATURE + SIGNATURE_SIZE);
+
+  fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
+  if(!fs) throw writeError;
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+std::string VoxelSceneArchive::get_relocaliser_path(const std::string& archivePath)
+{
+  return archivePath + ".reloc";
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+size_t VoxelSceneArchive::load_chunks(const std::vector<size_t>& chunkIndices, SpaintVoxelScene *scene)
+{
+  if(chunkIndices.empty()) return 0;
+
+  const int entryCount = ITMVoxelBlockHash::noTotalEntries;
+  ITMGlobalCache<SpaintVoxel,ITMVoxelBlockHash> *globalCache = scene->globalCache;
+  SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+  // Copy the scene's hash table, together with the lists from which it allocates excess entries and voxel blocks, into host memory.
+  // Note: If the scene has a global cache, the loaded blocks are inserted as swapped-out blocks, so no voxel blocks need to be allocated.
+  std::vector<ITMHashEntry> hashTable(entryCount);
+  copy_from_scene_memory(&hashTable[0], scene->index.GetEntries(), entryCount * sizeof(ITMHashEntry));
+
+  std::vector<int> excessAllocationList(SDF_EXCESS_LIST_SIZE);
+  copy_from_scene_memory(&excessAllocationList[0], scene->index.GetExcessAllocationList(), SDF_EXCESS_LIST_SIZE * sizeof(int));
+  int lastFreeExcessListId = scene->index.GetLastFreeExcessListId();
+
+  std::vector<int> allocationList;
+  int lastFreeBlockId = scene->localVBA.lastFreeBlockId;
+  if(!globalCache)
+  {
+    allocationList.resize(scene->localVBA.allocatedSize);
+    copy_from_scene_memory(&allocationList[0], scene->localVBA.GetAllocationList(), allocationList.size() * sizeof(int));
+  }
+
+  // Decode the blocks in each chunk, and insert them into the scene.
+  const unsigned char *data = reinterpret_cast<const unsigned char*>(m_file.data());
+  std::vector<SpaintVoxel> voxels(SDF_BLOCK_SIZE3);
+  std::vector<SpaintVoxel::PackedLabel> labels(SDF_BLOCK_SIZE3);
+  std::vector<unsigned int> labelCountDeltas(SpaintVoxelScene::LABEL_GROUP_COUNT * SpaintVoxelScene::LABEL_VALUE_COUNT);
+  size_t loadedBlockCount = 0, skippedBlockCount = 0;
+
+  for(size_t i = 0, size = chunkIndices.size(); i < size; ++i)
+  {
+    const ChunkInfo& chunk = m_chunks[chunkIndices[i]];
+    const unsigned char *p = data + chunk.offset, *end = p + chunk.size;
+
+    for(unsigned int j = 0; j < chunk.blockCount; ++j)
+    {
+      Vector3s blockPos;
+      bool valid = read_value(p, end, blockPos);
+      if(valid) p = decode_runs(p, end, &voxels[0], SDF_BLOCK_SIZE3);
+      if(valid && p && labelData) p = decode_runs(p, end, &labels[0], SDF_BLOCK_SIZE3);
+      if(!valid || !p) throw std::runtime_error("Error: Scene archive " + m_path + " is corrupt");
+
+      // Look for the block in the hash table. If it's already there (e.g. because it was observed before its chunk
+      // was loaded), the existing block takes precedence. Otherwise, find the hash entry into which to insert it.
+      int entryID = hashIndex(blockPos);
+      bool found = false, needsExcessEntry = false;
+      if(hashTable[entryID].ptr >= -1)
+      {
+        for(;;)
+        {
+          if(hashTable[entryID].pos == blockPos) { found = true; break; }
+          if(hashTable[entryID].offset < 1) { needsExcessEntry = true; break; }
+          entryID = SDF_BUCKET_NUM + hashTable[entryID].offset - 1;
+        }
+      }
+
+      if(found) continue;
+
+      // If the scene has run out of excess entries or voxel blocks, skip the block.
+      if((needsExcessEntry && lastFreeExcessListId < 0) || (!globalCache && lastFreeBlockId < 0))
+      {
+        ++skippedBlockCount;
+        continue;
+      }
+
+      if(needsExcessEntry)
+      {
+        const int excessOffset = excessAllocationList[lastFreeExcessListId--];
+        hashTable[entryID].offset = excessOffset + 1;
+        entryID = SDF_BUCKET_NUM + excessOffset;
+      }
+
+      ITMHashEntry& hashEntry = hashTable[entryID];
+      hashEntry.pos = blockPos;
+      hashEntry.offset = 0;
+
+      if(globalCache)
+      {
+        hashEntry.ptr = -1;
+        globalCache->SetStoredData(entryID, &voxels[0]);
+      }
+      else
+      {
+        hashEntry.ptr = allocationList[lastFreeBlockId--];
+        copy_to_scene_memory(voxelData + hashEntry.ptr * SDF_BLOCK_SIZE3, &voxels[0], SDF_BLOCK_SIZE3 * sizeof(SpaintVoxel));
+        if(labelData) copy_to_scene_memory(labelData + hashEntry.ptr * SDF_BLOCK_SIZE3, &labels[0], SDF_BLOCK_SIZE3 * sizeof(SpaintVoxel::PackedLabel));
+
+        // Count the labels of the loaded voxels (the voxels in the block they replace were unallocated, and so had the default label).
+        for(int k = 0; k < SDF_BLOCK_SIZE3; ++k)
+        {
+          update_label_counts(SpaintVoxel::PackedLabel(), get_voxel_label(k, &voxels[0], &labels[0]), &labelCountDeltas[0]);
+        }
+      }
+
+      ++loadedBlockCount;
+    }
+  }
+
+  // Copy the updated hash table back into the scene memory, and update the allocation state of the scene.
+  // Note: The allocation lists themselves are unchanged, since allocating from them simply moves their last free IDs.
+  copy_to_scene_memory(scene->index.GetEntries(), &hashTable[0], entryCount * sizeof(ITMHashEntry));
+  scene->index.SetLastFreeExcessListId(lastFreeExcessListId);
+  scene->localVBA.lastFreeBlockId = lastFreeBlockId;
+  if(!globalCache)
+  {
+    scene->add_to_label_counts(labelCountDeltas);
+
+    // Note: The labels of the loaded blocks were not recorded in the label presence masks, so the next clear must revisit every block.
+    scene->reset_label_presence();
+  }
+
+  // Note: The chunks are only marked as loaded once the scene has been updated, in case one of them turns out to be corrupt.
+  for(size_t i = 0, size = chunkIndices.size(); i < size; ++i)
+  {
+    m_chunks[chunkIndices[i]].loaded = true;
+  }
+
+  if(skippedBlockCount > 0)
+  {
+    std::cerr << "Warning: The scene is full, so " << skippedBlockCount << " voxel blocks from scene archive " << m_path << " could not be loaded\n";
+  }
+
+  // If all of the chunks have now been loaded, close the archive file.
+  m_loadedChunkCount += chunkIndices.size();
+  if(m_loadedChunkCount == m_chunks.size()) close();
+
+  return loadedBlockCount;
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+template <typename T>
+const unsigned char *VoxelSceneArchive::decode_runs(const unsigned char *p, const unsigned char *end, T *values, int count)
+{
+  unsigned int runCount;
+  if(!read_value(p, end, runCount)) return NULL;
+
+  int i = 0;
+  for(unsigned int r = 0; r < runCount; ++r)
+  {
+    unsigned short length;
+    T value;
+    if(!read_value(p, end, length) || !read_value(p, end, value) || length == 0 || length > count - i) return NULL;
+
+    std::fill(values + i, values + i + length, value);
+    i += length;
+  }
+
+  return i == count ? p : NULL;
+}
+
+template <typename T>
+void VoxelSceneArchive::encode_runs(const T *values, int count, std::vector<unsigned char>& out)
+{
+  const size_t runCountOffset = out.size();
+  append_value(0U, out);
+
+  // Note: The values are compared bytewise, since the voxel type does not define an equality operator.
+  unsigned int runCount = 0;
+  for(int i = 0; i < count;)
+  {
+    int j = i + 1;
+    while(j < count && j - i < 65535 && memcmp(&values[j], &values[i], sizeof(T)) == 0) ++j;
+
+    append_value(static_cast<unsigned short>(j - i), out);
+    append_value(values[i], out);
+    ++runCount;
+    i = j;
+  }
+
+  memcpy(&out[runCountOffset], &runCount, sizeof(unsigned int));
+}
+
+}
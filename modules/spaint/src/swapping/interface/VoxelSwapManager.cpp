@@ -0,0 +1,133 @@
+/**
+ * spaint: VoxelSwapManager.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "swapping/interface/VoxelSwapManager.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+VoxelSwapManager::VoxelSwapManager(int lookaheadFrames)
+: m_lookaheadFrames(lookaheadFrames)
+{
+  if(lookaheadFrames < 0 || lookaheadFrames > MAX_LOOKAHEAD_FRAMES)
+  {
+    throw std::invalid_argument("Error: The number of lookahead frames for a voxel swap manager must be in the range [0," + boost::lexical_cast<std::string>(MAX_LOOKAHEAD_FRAMES) + "]");
+  }
+
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  const int entryCount = ITMVoxelBlockHash::noTotalEntries;
+
+  m_predictedFlagsMB = mbf.make_block<unsigned char>(entryCount, "VoxelSwapManager");
+  m_restorationFlagsMB = mbf.make_block<unsigned char>(entryCount, "VoxelSwapManager");
+  m_storedLabelsMB = mbf.make_block<SpaintVoxel::PackedLabel>(MAX_RESTORED_BLOCK_COUNT * SDF_BLOCK_SIZE3, "VoxelSwapManager");
+  m_storedLabelsAvailableMB = mbf.make_block<unsigned char>(MAX_RESTORED_BLOCK_COUNT, "VoxelSwapManager");
+  m_swappedInEntryCountMB = mbf.make_block<int>(1, "VoxelSwapManager");
+  m_swappedInEntryIDsMB = mbf.make_block<int>(MAX_RESTORED_BLOCK_COUNT, "VoxelSwapManager");
+
+  m_predictedFlagsMB->Clear();
+  m_restorationFlagsMB->Clear();
+}
+
+//#################### DESTRUCTOR ####################
+
+VoxelSwapManager::~VoxelSwapManager() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void VoxelSwapManager::prepare_for_fusion(const ORUtils::SE3Pose& pose, const Vector4f& projParams, const Vector2i& imgSize,
+                                          const SpaintVoxelScene *scene, ITMRenderState *renderState)
+{
+  // Record which voxel blocks are currently swapped out, so that we can tell which ones have been swapped in once fusion has been run.
+  flag_swapped_out_entries(scene);
+
+  // If prefetching is disabled, early out.
+  if(m_lookaheadFrames == 0) return;
+
+  // Extrapolate the camera's trajectory over the next few frames, assuming that it continues to move with constant velocity.
+  const Matrix4f M = pose.GetM();
+  if(!m_previousM)
+  {
+    // We need at least two poses to extrapolate from, so just record this one for next time.
+    m_previousM = M;
+    return;
+  }
+
+  Matrix4f invPreviousM;
+  m_previousM->inv(invPreviousM);
+  const Matrix4f deltaM = M * invPreviousM;
+  m_previousM = M;
+
+  PredictedPoses predictedPoses;
+  predictedPoses.count = m_lookaheadFrames;
+  Matrix4f predictedM = M;
+  for(int i = 0; i < m_lookaheadFrames; ++i)
+  {
+    predictedM = deltaM * predictedM;
+    predictedPoses.M[i] = predictedM;
+  }
+
+  // Mark the voxel blocks that the camera is predicted to see as visible, so that InfiniTAM swaps them in during fusion,
+  // and make sure that InfiniTAM doesn't drop them again just because they aren't visible from the current pose.
+  ITMRenderState_VH *renderStateVH = dynamic_cast<ITMRenderState_VH*>(renderState);
+  if(!renderStateVH) return;
+
+  flag_predicted_entries(predictedPoses, projParams, imgSize, scene, renderStateVH);
+  exclude_predicted_entries(renderStateVH);
+}
+
+void VoxelSwapManager::reset()
+{
+  m_previousM.reset();
+}
+
+void VoxelSwapManager::restore_swapped_in_labels(SpaintVoxelScene *scene)
+{
+  // If the scene is not being swapped, early out.
+  if(!scene->globalCache) return;
+
+  // Find the voxel blocks that have been swapped in since their labels were last restored. If there aren't any, early out.
+  const int swappedInEntryCount = find_swapped_in_entries(scene);
+  if(swappedInEntryCount == 0) return;
+
+  // Gather the labels saved with the swapped-in blocks in the global cache (which always lives in host memory).
+  // Note: Swapping is never used in conjunction with a separate label volume, so the labels are in the voxels themselves.
+  m_swappedInEntryIDsMB->UpdateHostFromDevice();
+  const int *swappedInEntryIDs = m_swappedInEntryIDsMB->GetData(MEMORYDEVICE_CPU);
+  SpaintVoxel::PackedLabel *storedLabels = m_storedLabelsMB->GetData(MEMORYDEVICE_CPU);
+  unsigned char *storedLabelsAvailable = m_storedLabelsAvailableMB->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < swappedInEntryCount; ++i)
+  {
+    const int entryID = swappedInEntryIDs[i];
+    storedLabelsAvailable[i] = scene->globalCache->HasStoredData(entryID) ? 1 : 0;
+    if(!storedLabelsAvailable[i]) continue;
+
+    const SpaintVoxel *storedBlock = scene->globalCache->GetStoredVoxelBlock(entryID);
+    for(int j = 0; j < SDF_BLOCK_SIZE3; ++j)
+    {
+      storedLabels[i * SDF_BLOCK_SIZE3 + j] = get_voxel_label(j, storedBlock, NULL);
+    }
+  }
+
+  m_storedLabelsAvailableMB->UpdateDeviceFromHost();
+  m_storedLabelsMB->UpdateDeviceFromHost();
+
+  // Write the stored labels into the swapped-in blocks.
+  write_stored_labels(swappedInEntryCount, scene);
+}
+
+}
@@ -0,0 +1,40 @@
+/**
+ * spaint: TouchCandidateExtractorFactory.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "touch/TouchCandidateExtractorFactory.h"
+using namespace ITMLib;
+
+#include "touch/cpu/TouchCandidateExtractor_CPU.h"
+
+#ifdef WITH_CUDA
+#include "touch/cuda/TouchCandidateExtractor_CUDA.h"
+#endif
+
+namespace spaint {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+TouchCandidateExtractor_Ptr TouchCandidateExtractorFactory::make_touch_candidate_extractor(const Vector2i& imgSize, ITMLibSettings::DeviceType deviceType)
+{
+  TouchCandidateExtractor_Ptr extractor;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    extractor.reset(new TouchCandidateExtractor_CUDA(imgSize));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    extractor.reset(new TouchCandidateExtractor_CPU(imgSize));
+  }
+
+  return extractor;
+}
+
+}
@@ -7,6 +7,8 @@
 using namespace ITMLib;
 using namespace rafl;
 
+#include <algorithm>
+
 #include <boost/format.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 
@@ -14,7 +16,7 @@ using namespace rafl;
 using namespace tvgutil;
 
 #include "imageprocessing/ImageProcessorFactory.h"
-#include "touch/TouchDescriptorCalculator.h"
+#include "touch/TouchCandidateExtractorFactory.h"
 #include "util/RGBDUtil.h"
 #include "visualisation/VisualiserFactory.h"
 
@@ -24,14 +26,11 @@ using namespace tvgutil;
 
 //#define DEBUG_TOUCH_DISPLAY
 //#define DEBUG_TOUCH_OUTPUT_FOREST_STATISTICS 
-//#define DEBUG_TOUCH_DISPLAY_CONNECTED_COMPONENTS
 //#define DEBUG_TOUCH_DISPLAY_TOUCH_POINTS
 //#define DEBUG_TOUCH_DISPLAY_RAW_DEPTH_AND_DEPTH_RAYCAST
 //#define DEBUG_TOUCH_DISPLAY_DENOISED_CHANGE_MASK
 //#define DEBUG_TOUCH_DISPLAY_TOUCH_PIXELS
-//#define DEBUG_TOUCH_DISPLAY_BEST_CANDIDATE_MASK_AND_DIFF
 //#define DEBUG_TOUCH_OUTPUT_PMF
-//#define DEBUG_TOUCH_DISPLAY_CANDIDATE_COMPONENTS
 //#define DEBUG_TOUCH_OUTPUT_COMPONENT_AREAS
 
 namespace spaint {
@@ -45,17 +44,15 @@ TouchDetector::TouchDetector(const Vector2i& imgSize, const Settings_CPtr& itmSe
   m_touchDebuggingOutputWindowName("TouchDebuggingOutputWindow"),
 
   // Normal variables.
-  m_changeMask(new af::array(imgSize.y, imgSize.x)),
-  m_connectedComponentImage(imgSize.y, imgSize.x, u32),
+  m_candidateExtractor(TouchCandidateExtractorFactory::make_touch_candidate_extractor(imgSize, itmSettings->deviceType)),
   m_depthRaycast(new ITMFloatImage(imgSize, true, true)),
   m_depthVisualiser(VisualiserFactory::make_depth_visualiser(itmSettings->deviceType)),
-  m_diffRawRaycast(new af::array(imgSize.y, imgSize.x, f32)),
+  m_framesSinceFullScan(0),
   m_imageHeight(imgSize.y),
   m_imageProcessor(ImageProcessorFactory::make_image_processor(itmSettings->deviceType)),
   m_imageWidth(imgSize.x),
   m_itmSettings(itmSettings),
   m_thresholdedRawDepth(new ITMFloatImage(imgSize, true, true)),
-  m_touchMask(new af::array(imgSize.y, imgSize.x, u8)),
   m_touchSettings(touchSettings)
 {
   // Set the maximum and minimum areas (in pixels) of a connected change component for it to be considered a candidate touch interaction.
@@ -64,19 +61,28 @@ TouchDetector::TouchDetector(const Vector2i& imgSize, const Settings_CPtr& itmSe
   m_minCandidateArea = static_cast<int>(m_touchSettings->minCandidateFraction * imageArea);
   m_maxCandidateArea = static_cast<int>(m_touchSettings->maxCandidateFraction * imageArea);
 
-  // Load the random forest used to score the candidate connected components.
-  m_forest = m_touchSettings->load_forest();
+  // Load the random forest used to score the candidate connected components, and give a flattened copy of it to the
+  // candidate extractor, so that the candidates can be classified on the device. If the forest file contains a compiled
+  // (inference-only) forest, it can be used directly; otherwise, we load the full forest and compile it.
+  if(m_touchSettings->has_compiled_forest())
+  {
+    m_candidateExtractor->set_touch_forest(*m_touchSettings->load_compiled_forest(), 1);
+  }
+  else
+  {
+    m_forest = m_touchSettings->load_forest();
+    m_candidateExtractor->set_touch_forest(TouchCandidateExtractor::CompiledTouchForest(*m_forest), 1);
 
 #if defined(DEBUG_TOUCH_OUTPUT_FOREST_STATISTICS)
-  // Output the statistics of the forest for debugging purposes.
-  m_forest->output_statistics(std::cout);
+    // Output the statistics of the forest for debugging purposes.
+    m_forest->output_statistics(std::cout);
 #endif
+  }
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 std::vector<Eigen::Vector2i> TouchDetector::determine_touch_points(const rigging::MoveableCamera_CPtr& camera, const ITMFloatImage_CPtr& rawDepth, const VoxelRenderState_CPtr& renderState)
-try
 {
 #if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY)
   process_debug_windows();
@@ -85,49 +91,86 @@ try
   // Prepare a thresholded version of the raw depth image and a depth raycast ready for change detection.
   prepare_inputs(camera, rawDepth, renderState);
 
-  // Detect changes in the scene with respect to the reconstructed model.
-  detect_changes();
+  // Detect changes in the scene with respect to the reconstructed model, and find the connected components of the
+  // resulting change mask (within the region of interest) that fall within a certain size range. These are the
+  // candidate touch interactions. If no components meet the size constraints, clear the touch mask and early out.
+  std::vector<Candidate> candidates = m_candidateExtractor->extract_candidates(
+    m_thresholdedRawDepth.get(),
+    m_depthRaycast.get(),
+    m_touchSettings->lowerDepthThresholdMm / 1000.0f,
+    m_touchSettings->morphKernelSize,
+    m_minCandidateArea,
+    m_maxCandidateArea,
+    determine_roi()
+  );
+
+#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_RAW_DEPTH_AND_DEPTH_RAYCAST)
+  // Display the raw depth image, the depth raycast and the absolute difference between them.
+  const float mToCm = 100.0f; // the scaling factor needed to convert metres to centimetres
+  m_thresholdedRawDepth->UpdateHostFromDevice();
+  m_depthRaycast->UpdateHostFromDevice();
+  ITMFloatImage_CPtr diffRawRaycast = m_candidateExtractor->get_diff_raw_raycast();
+  diffRawRaycast->UpdateHostFromDevice();
+  OpenCVUtil::show_scaled_greyscale_figure("Current raw depth from camera in centimetres", m_thresholdedRawDepth->GetData(MEMORYDEVICE_CPU), m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR, mToCm);
+  OpenCVUtil::show_scaled_greyscale_figure("Current depth raycast in centimetres", m_depthRaycast->GetData(MEMORYDEVICE_CPU), m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR, mToCm);
+  OpenCVUtil::show_scaled_greyscale_figure("Diff image in centimetres", diffRawRaycast->GetData(MEMORYDEVICE_CPU), m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR, mToCm);
+#endif
 
-  // Make a connected-component image from the change mask.
-  m_connectedComponentImage = af::regions(*m_changeMask);
+#if defined(WITH_OPENCV) && (defined(DEBUG_TOUCH_DISPLAY) || defined(DEBUG_TOUCH_DISPLAY_DENOISED_CHANGE_MASK))
+  // Display the change mask after applying morphological operations.
+  ITMUCharImage_CPtr changeMask = m_candidateExtractor->get_change_mask();
+  changeMask->UpdateHostFromDevice();
+  OpenCVUtil::show_scaled_greyscale_figure(m_touchDebuggingOutputWindowName, changeMask->GetData(MEMORYDEVICE_CPU), m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR, OpenCVUtil::ScaleByFactor(255.0f));
+#endif
 
-#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_CONNECTED_COMPONENTS)
-  // Display the connected components.
-  int componentCount = af::max<int>(m_connectedComponentImage) + 1;
-  af::array connectedComponentDebugImage = m_connectedComponentImage * (255.0f / componentCount);
-  OpenCVUtil::show_greyscale_figure("connectedComponentDebugImage", connectedComponentDebugImage.as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
+#if defined(DEBUG_TOUCH_OUTPUT_COMPONENT_AREAS)
+  for(size_t i = 0, size = candidates.size(); i < size; ++i)
+  {
+    std::cout << "Candidate " << candidates[i].componentID << ": area " << candidates[i].area << '\n';
+  }
 #endif
 
-  // Select candidate connected components that fall within a certain size range. If no components meet the size constraints, clear the touch mask and early out.
-  af::array candidateComponents = select_candidate_components();
-  if(candidateComponents.isempty())
+  if(candidates.empty())
   {
-    *m_touchMask = 0;
+    m_candidateExtractor->clear_touch_mask();
+    m_trackedROI.reset();
     return std::vector<Eigen::Vector2i>();
   }
 
-  // Convert the differences between the raw depth image and the depth raycast to millimetres.
-  af::array diffRawRaycastInMm = clamp_to_range(*m_diffRawRaycast * 1000.0f, 0.0f, 255.0f).as(u8);
-
 #ifdef WITH_OPENCV
   // If desired, save the candidate connected components for use with the touchtrain application.
   if(m_touchSettings->should_save_candidate_components())
   {
-    save_candidate_components(candidateComponents, diffRawRaycastInMm);
+    save_candidate_components(candidates);
   }
 #endif
 
-  // Pick the candidate component most likely to correspond to a touch interaction.
-  int bestConnectedComponent = pick_best_candidate_component_based_on_forest(candidateComponents, diffRawRaycastInMm);
-  if(bestConnectedComponent == -1)
+  // Pick the candidate component most likely to correspond to a touch interaction. If there isn't one, we have lost
+  // track of the hand (if we had it), so the next frame will be a full scan.
+  int bestCandidateIndex = pick_best_candidate_component_based_on_forest(candidates);
+  if(bestCandidateIndex == -1)
   {
-    *m_touchMask = 0;
+    m_candidateExtractor->clear_touch_mask();
+    m_trackedROI.reset();
     return std::vector<Eigen::Vector2i>();
   }
 
+  // Track the region around the chosen component, so that the next frame need only search near it. The padding allows for the
+  // hand moving between frames; if the hand is cut off by the edge of the region, the next region will grow to follow it.
+  const Candidate& bestCandidate = candidates[bestCandidateIndex];
+  const int paddingX = static_cast<int>(m_touchSettings->roiPaddingFraction * m_imageWidth);
+  const int paddingY = static_cast<int>(m_touchSettings->roiPaddingFraction * m_imageHeight);
+  const Vector4i& box = bestCandidate.boundingBox;
+  m_trackedROI = Vector4i(
+    std::max(box.x - paddingX, 0),
+    std::max(box.y - paddingY, 0),
+    std::min(box.z + paddingX, m_imageWidth - 1),
+    std::min(box.w + paddingY, m_imageHeight - 1)
+  );
+
   // Extract a set of touch points from the chosen connected component that denote the parts of the scene touched by the user.
   // Note that the set of touch points may end up being empty if the user is not touching the scene.
-  std::vector<Eigen::Vector2i> touchPoints = extract_touch_points(bestConnectedComponent, diffRawRaycastInMm);
+  std::vector<Eigen::Vector2i> touchPoints = extract_touch_points(bestCandidate);
 
 #if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_TOUCH_POINTS)
   // Display the touch points.
@@ -142,25 +185,17 @@ try
 
   return touchPoints;
 }
-catch(af::exception&)
-{
-  // Prevent the touch detector from crashing when tracking is lost.
-  return std::vector<Eigen::Vector2i>();
-}
 
 ITMUChar4Image_CPtr TouchDetector::generate_touch_image(const View_CPtr& view) const
 {
-  static Vector2i imgSize = ImageProcessor::image_size(m_touchMask);
-  static ITMUCharImage_Ptr touchMask(new ITMUCharImage(imgSize, true, true));
+  ITMUCharImage_CPtr touchMask = m_candidateExtractor->get_touch_mask();
+  const Vector2i imgSize = touchMask->noDims;
   ITMUChar4Image_Ptr touchImage(new ITMUChar4Image(imgSize, true, false));
 
   // Get the current RGB and depth images.
   const ITMUChar4Image *rgb = view->rgb;
   const ITMFloatImage *depth = view->depth;
 
-  // Copy the touch mask across to an InfiniTAM image.
-  m_imageProcessor->copy_af_to_itm(m_touchMask, touchMask);
-
   // Copy the RGB and depth images and the touch mask across to the CPU.
   rgb->UpdateHostFromDevice();
   depth->UpdateHostFromDevice();
@@ -221,14 +256,12 @@ ITMFloatImage_CPtr TouchDetector::get_depth_raycast() const
 
 ITMFloatImage_CPtr TouchDetector::get_diff_raw_raycast() const
 {
-  static ITMFloatImage_Ptr diffRawRaycast;
-  return m_imageProcessor->convert_af_to_itm(m_diffRawRaycast, diffRawRaycast);
+  return m_candidateExtractor->get_diff_raw_raycast();
 }
 
 ITMUCharImage_CPtr TouchDetector::get_touch_mask() const
 {
-  static ITMUCharImage_Ptr touchMask;
-  return m_imageProcessor->convert_af_to_itm(m_touchMask, touchMask);
+  return m_candidateExtractor->get_touch_mask();
 }
 
 ITMFloatImage_CPtr TouchDetector::get_thresholded_raw_depth() const
@@ -243,166 +276,84 @@ float TouchDetector::invalid_depth_value() const
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
-void TouchDetector::detect_changes()
+Vector4i TouchDetector::determine_roi()
 {
-  // Calculate the difference between the raw depth image and the depth raycast.
-  m_imageProcessor->calculate_depth_difference(m_thresholdedRawDepth, m_depthRaycast, m_diffRawRaycast);
-
-#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_RAW_DEPTH_AND_DEPTH_RAYCAST)
-  // Display the raw depth image and the depth raycast.
-  const float mToCm = 100.0f; // the scaling factor needed to convert metres to centimetres
-  m_thresholdedRawDepth->UpdateHostFromDevice();
-  m_depthRaycast->UpdateHostFromDevice();
-  OpenCVUtil::show_scaled_greyscale_figure("Current raw depth from camera in centimetres", m_thresholdedRawDepth->GetData(MEMORYDEVICE_CPU), m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR, mToCm);
-  OpenCVUtil::show_scaled_greyscale_figure("Current depth raycast in centimetres", m_depthRaycast->GetData(MEMORYDEVICE_CPU), m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR, mToCm);
-
-  // Display the absolute difference between the raw depth image and the depth raycast.
-  af::array diffRawRaycastInCm = clamp_to_range(*m_diffRawRaycast * mToCm, 0.0f, 255.0f);
-  OpenCVUtil::show_greyscale_figure("Diff image in centimetres", diffRawRaycastInCm.as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-#endif
-
-  // Threshold the difference image to find significant differences between the raw depth image
-  // and the depth raycast. Such differences indicate locations in which the scene has changed
-  // since it was originally reconstructed, e.g. the locations of moving objects such as hands.
-  *m_changeMask = *m_diffRawRaycast > (m_touchSettings->lowerDepthThresholdMm / 1000.0f);
-
-#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY)
-  // Display the change mask.
-  OpenCVUtil::show_greyscale_figure(m_touchDebuggingOutputWindowName, (m_changeMask.copy() * 255.0f).as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-#endif
-
-  // Apply a morphological opening operation to the change mask to reduce noise.
-  int morphKernelSize = m_touchSettings->morphKernelSize;
-  if(morphKernelSize < 3) morphKernelSize = 3;
-  if(morphKernelSize % 2 == 0) ++morphKernelSize;
-  af::array morphKernel = af::constant(1, morphKernelSize, morphKernelSize);
-  *m_changeMask = af::erode(*m_changeMask, morphKernel);
-  *m_changeMask = af::dilate(*m_changeMask, morphKernel);
-
-#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_DENOISED_CHANGE_MASK)
-  // Display the change mask after applying morphological operations.
-  OpenCVUtil::show_greyscale_figure("MorphologicalOperatorWindow", (m_changeMask.copy() * 255.0f).as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-#endif
+  // Search only the tracked region if possible, but periodically scan the whole image so that new interactions
+  // (e.g. a second hand, or the hand reappearing elsewhere) are not missed indefinitely.
+  if(m_touchSettings->roiTrackingEnabled && m_trackedROI && m_framesSinceFullScan < m_touchSettings->roiFullScanInterval)
+  {
+    ++m_framesSinceFullScan;
+    return *m_trackedROI;
+  }
+  else
+  {
+    m_framesSinceFullScan = 0;
+    return m_candidateExtractor->get_full_roi();
+  }
 }
 
-std::vector<Eigen::Vector2i> TouchDetector::extract_touch_points(int component, const af::array& diffRawRaycastInMm)
+std::vector<Eigen::Vector2i> TouchDetector::extract_touch_points(const Candidate& candidate)
 {
-  // Determine the component's binary mask and difference image.
-  *m_touchMask = m_connectedComponentImage == component;
-  af::array diffImage = diffRawRaycastInMm * *m_touchMask;
-
-  // Quantize the intensites in the difference image to 32 levels (from a starting point of 256 levels).
-  diffImage = (diffImage / 8).as(u8) * 8;
-
-  // Threshold the difference image, keeping only parts that are close to the surface.
+  // Keep only the parts of the component that are close to the surface, and spatially quantize them by sampling them
+  // at 30% of the image size. This has the effect of reducing the eventual number of touch points. If too few touch
+  // points remain, the user is assumed not to be touching the scene in a meaningful way.
   const int upperDepthThresholdMm = m_touchSettings->lowerDepthThresholdMm + 15;
-  diffImage = (diffImage > m_touchSettings->lowerDepthThresholdMm) && (diffImage < upperDepthThresholdMm);
-
-  // Apply a morphological opening operation to the difference image to reduce noise.
-  af::array morphKernel = af::constant(1, 5, 5);
-  diffImage = af::erode(diffImage, morphKernel);
-  diffImage = af::dilate(diffImage, morphKernel);
+  const float scaleFactor = 0.3f;
+  const float touchAreaLowerThreshold = m_touchSettings->minTouchAreaFraction * m_imageWidth * m_imageHeight;
+  std::vector<Eigen::Vector2i> touchPoints = m_candidateExtractor->extract_touch_points(
+    candidate, m_touchSettings->lowerDepthThresholdMm, upperDepthThresholdMm, scaleFactor, touchAreaLowerThreshold
+  );
 
 #if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_TOUCH_PIXELS)
   // Display the touch pixels.
-  OpenCVUtil::show_greyscale_figure("diffImage", (diffImage * 255).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
+  ITMUCharImage_CPtr touchPixelMask = m_candidateExtractor->get_touch_pixel_mask();
+  touchPixelMask->UpdateHostFromDevice();
+  OpenCVUtil::show_scaled_greyscale_figure("diffImage", touchPixelMask->GetData(MEMORYDEVICE_CPU), m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR, OpenCVUtil::ScaleByFactor(255.0f));
 #endif
 
-  // Spatially quantize the difference image by resizing it to 50% of its current size. This has the effect of reducing the eventual number of touch points.
-  const float scaleFactor = 0.3f;
-  diffImage = af::resize(scaleFactor, diffImage);
-
-  // Make a 1D array whose elements denote the pixels at which the user is touching the scene. Each element is a column-major index into the resized difference image.
-  af::array touchIndicesImage = af::where(diffImage);
-
-  // If there are too few touch indices, assume the user is not touching the scene in a meaningful way and early out.
-  const float touchAreaLowerThreshold = m_touchSettings->minTouchAreaFraction * m_imageWidth * m_imageHeight;
-  if(touchIndicesImage.elements() <= touchAreaLowerThreshold) return std::vector<Eigen::Vector2i>();
-
-  // Otherwise, convert the touch indices to touch points and return them.
-  const int resizedDiffHeight = static_cast<int>(m_imageHeight * scaleFactor);
-  const int *touchIndices = touchIndicesImage.as(s32).host<int>();
-  std::vector<Eigen::Vector2i> touchPoints;
-  for(int i = 0, touchPointCount = static_cast<int>(touchIndicesImage.elements()); i < touchPointCount; ++i)
-  {
-    Eigen::Vector2f point(touchIndices[i] / resizedDiffHeight, touchIndices[i] % resizedDiffHeight);
-    touchPoints.push_back((point / scaleFactor).cast<int>());
-  }
-
   return touchPoints;
 }
 
-int TouchDetector::pick_best_candidate_component_based_on_distance(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const
+int TouchDetector::pick_best_candidate_component_based_on_distance(const std::vector<Candidate>& candidates) const
 {
-  const int *candidateIDs = candidateComponents.host<int>();
-  const int candidateCount = static_cast<int>(candidateComponents.dims(0));
-
-  int bestCandidateID = -1;
-  af::array mask;
-
-  if(candidateCount == 1)
+  // Select the candidate that is closest to a surface. Since the mean differences are all taken over the whole image,
+  // comparing the sums of the differences is equivalent to comparing the means. (If there is only one candidate,
+  // then by definition it's the best candidate.)
+  std::vector<int> diffSums(candidates.size());
+  for(size_t i = 0, size = candidates.size(); i < size; ++i)
   {
-    // If there is only one candidate, then by definition it's the best candidate.
-    bestCandidateID = candidateIDs[0];
+    diffSums[i] = candidates[i].diffSumMm;
   }
-  else
-  {
-    // Otherwise, select the candidate that is closest to a surface.
-    std::vector<float> meanDistances(candidateCount);
-    for(int i = 0; i < candidateCount; ++i)
-    {
-      mask = m_connectedComponentImage == candidateIDs[i];
-      meanDistances[i] = af::mean<float>(diffRawRaycastInMm * mask);
-    }
-    size_t minIndex = ArgUtil::argmin(meanDistances);
-    bestCandidateID = candidateIDs[minIndex];
-  }
-
-#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_BEST_CANDIDATE_MASK_AND_DIFF)
-  // Display the best candidate's mask and difference image.
-  mask = m_connectedComponentImage.as(s32) == bestCandidateID;
-  OpenCVUtil::show_greyscale_figure("bestCandidateMask", (mask * 255).as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-  OpenCVUtil::show_greyscale_figure("bestCandidateDiff", (diffRawRaycastInMm * mask).as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-#endif
 
-  return bestCandidateID;
+  return static_cast<int>(ArgUtil::argmin(diffSums));
 }
 
-int TouchDetector::pick_best_candidate_component_based_on_forest(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const
+int TouchDetector::pick_best_candidate_component_based_on_forest(const std::vector<Candidate>& candidates) const
 {
-  const int *candidateIDs = candidateComponents.host<int>();
-  const int candidateCount = static_cast<int>(candidateComponents.dims(0));
+  const int candidateCount = static_cast<int>(candidates.size());
   const Label isTouchLabel = 1;
 
   std::vector<float> touchProb(candidateCount);
-  af::array candidateDiff;
   for(int i = 0; i < candidateCount; ++i)
   {
-    candidateDiff = (m_connectedComponentImage == candidateIDs[i]) * diffRawRaycastInMm;
-    Descriptor_CPtr descriptor = TouchDescriptorCalculator::calculate_histogram_descriptor(candidateDiff);
+    // If the candidate has already been classified on the device, use the probability that was calculated there.
+    if(m_candidateExtractor->has_touch_forest())
+    {
+      touchProb[i] = candidates[i].touchProbability;
+      continue;
+    }
+
+    const std::vector<float>& histogram = candidates[i].histogram;
+    Descriptor_CPtr descriptor(new Descriptor(histogram.begin(), histogram.end()));
     touchProb[i] = MapUtil::lookup(m_forest->calculate_pmf(descriptor).get_masses(), isTouchLabel);
 
 #if defined(DEBUG_TOUCH_OUTPUT_PMF)
     std::cout << "The PMF is: " << m_forest->calculate_pmf(descriptor) << '\n';
 #endif
-
-#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_CANDIDATE_COMPONENTS)
-    // Display each candidate difference image.
-    OpenCVUtil::show_greyscale_figure("diff mask[" + boost::lexical_cast<std::string>(i) + "]", candidateDiff.as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-#endif
   }
 
   const size_t maxIndex = ArgUtil::argmax(touchProb);
-  int bestCandidateID = touchProb[maxIndex] > 0.5f ? candidateIDs[maxIndex] : -1;
-
-#if defined(WITH_OPENCV) && defined(DEBUG_TOUCH_DISPLAY_BEST_CANDIDATE_MASK_AND_DIFF)
-  // Display the best candidate's mask and difference image.
-  af::array mask = m_connectedComponentImage.as(s32) == bestCandidateID;
-  OpenCVUtil::show_greyscale_figure("bestCandidateMask", (mask * 255).as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-  OpenCVUtil::show_greyscale_figure("bestCandidateDiff", (diffRawRaycastInMm * mask).as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
-#endif
-
-  return bestCandidateID;
+  return touchProb[maxIndex] > 0.5f ? static_cast<int>(maxIndex) : -1;
 }
 
 void TouchDetector::prepare_inputs(const rigging::MoveableCamera_CPtr& camera, const ITMFloatImage_CPtr& rawDepth, const VoxelRenderState_CPtr& renderState)
@@ -453,18 +404,30 @@ void TouchDetector::process_debug_windows()
   cv::waitKey(m_debugDelayMs);
 }
 
-void TouchDetector::save_candidate_components(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const
+void TouchDetector::save_candidate_components(const std::vector<Candidate>& candidates) const
 {
   static size_t imageCounter = 0;
 
-  const int *candidateIDs = candidateComponents.host<int>();
-  const int candidateCount = static_cast<int>(candidateComponents.dims(0));
-  af::array candidateDiffAF(m_imageHeight, m_imageWidth, u8);
+  // Copy the connected component image and the differences between the raw depth image and the depth raycast across to the CPU.
+  ITMIntImage_CPtr componentImage = m_candidateExtractor->get_component_image();
+  ITMUCharImage_CPtr diffRawRaycastInMm = m_candidateExtractor->get_diff_raw_raycast_in_mm();
+  componentImage->UpdateHostFromDevice();
+  diffRawRaycastInMm->UpdateHostFromDevice();
+  const int *componentData = componentImage->GetData(MEMORYDEVICE_CPU);
+  const unsigned char *diffData = diffRawRaycastInMm->GetData(MEMORYDEVICE_CPU);
 
-  for(int i = 0; i < candidateCount; ++i)
+  const int pixelCount = m_imageWidth * m_imageHeight;
+  std::vector<unsigned char> candidateDiff(pixelCount);
+
+  for(size_t i = 0, candidateCount = candidates.size(); i < candidateCount; ++i)
   {
-    candidateDiffAF = (m_connectedComponentImage == candidateIDs[i]) * diffRawRaycastInMm;
-    cv::Mat1b candidateDiffCV = OpenCVUtil::make_greyscale_image(candidateDiffAF.as(u8).host<unsigned char>(), m_imageWidth, m_imageHeight, OpenCVUtil::COL_MAJOR);
+    const int componentID = candidates[i].componentID;
+    for(int j = 0; j < pixelCount; ++j)
+    {
+      candidateDiff[j] = componentData[j] == componentID ? diffData[j] : 0;
+    }
+
+    cv::Mat1b candidateDiffCV = OpenCVUtil::make_greyscale_image(&candidateDiff[0], m_imageWidth, m_imageHeight, OpenCVUtil::ROW_MAJOR);
 
     if(imageCounter < 1e5)
     {
@@ -475,51 +438,8 @@ void TouchDetector::save_candidate_components(const af::array& candidateComponen
 }
 #endif
 
-af::array TouchDetector::select_candidate_components()
-{
-  // Add one to every pixel in the connected component image to allow for a special zero component.
-  m_connectedComponentImage += 1;
-
-  // Set all regions in the connected component image which are in the static scene to zero.
-  m_connectedComponentImage *= *m_changeMask;
-
-  // Calculate the areas of the connected components.
-  const int componentCount = af::max<int>(m_connectedComponentImage) + 1;
-  af::array componentAreas = af::histogram(m_connectedComponentImage, componentCount);
-
-  // Zero out the connected component corresponding to the static scene.
-  componentAreas(0) = 0;
-
-  // Zero out connected components that are either too small or too large.
-  componentAreas -= (componentAreas < m_minCandidateArea) * componentAreas;
-  componentAreas -= (componentAreas > m_maxCandidateArea) * componentAreas;
-
-  // Keep the remaining non-zero components as candidates.
-  af::array candidates = af::where(componentAreas).as(s32);
-
-#if defined(DEBUG_TOUCH_OUTPUT_COMPONENT_AREAS)
-  af::print("componentAreas", componentAreas);
-  if(candidates.elements() > 0) af::print("candidates", candidates);
-#endif
-
-  return candidates;
-}
-
 //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
 
-af::array TouchDetector::clamp_to_range(const af::array& arr, float lower, float upper)
-{
-  static af::array lowerMask, upperMask;
-  lowerMask = arr < lower;
-  upperMask = arr > upper;
-
-  static af::array arrayCopy;
-  arrayCopy = arr - lowerMask * arr;
-  arrayCopy = arrayCopy - (upperMask * arrayCopy) + (upperMask * upper);
-
-  return arrayCopy;
-}
-
 Vector3f TouchDetector::to_itm(const Eigen::Vector3f& v)
 {
   return Vector3f(v[0], v[1], v[2]);
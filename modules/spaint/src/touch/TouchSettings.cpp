@@ -15,6 +15,9 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 TouchSettings::TouchSettings(const boost::filesystem::path& touchSettingsFile)
+: roiFullScanInterval(30),
+  roiPaddingFraction(0.1f),
+  roiTrackingEnabled(false)
 {
   // Load in the settings.
   boost::property_tree::ptree tree = PropertyUtil::load_properties_from_xml_file(touchSettingsFile.string());
@@ -33,6 +36,18 @@ TouchSettings::TouchSettings(const boost::filesystem::path& touchSettingsFile)
     GET_SETTING(saveCandidateComponentsPath);
   #undef GET_SETTING
 
+  // Load in the optional settings (if present), so that existing settings files continue to work.
+  #define GET_OPTIONAL_SETTING(param) if(properties.find(#param) != properties.end()) tvgutil::MapUtil::typed_lookup(properties, #param, param)
+    GET_OPTIONAL_SETTING(roiFullScanInterval);
+    GET_OPTIONAL_SETTING(roiPaddingFraction);
+    GET_OPTIONAL_SETTING(roiTrackingEnabled);
+  #undef GET_OPTIONAL_SETTING
+
+  if(roiFullScanInterval < 1)
+  {
+    throw std::runtime_error("Error: The touch region of interest full scan interval must be at least 1");
+  }
+
   // Determine the full path to the file containing the random forest, and check that it exists.
   fullForestPath = touchSettingsFile.branch_path() / forestPath;
   if(!boost::filesystem::exists(fullForestPath))
@@ -63,6 +78,16 @@ const std::string& TouchSettings::get_save_candidate_components_path() const
   return saveCandidateComponentsPath;
 }
 
+bool TouchSettings::has_compiled_forest() const
+{
+  return CompiledRF::is_compiled_forest_file(fullForestPath.string());
+}
+
+TouchSettings::CompiledRF_Ptr TouchSettings::load_compiled_forest() const
+{
+  return CompiledRF::load(fullForestPath.string());
+}
+
 TouchSettings::RF_Ptr TouchSettings::load_forest() const
 {
   // Register the relevant decision function generators with the factory.
@@ -0,0 +1,266 @@
+/**
+ * spaint: TouchCandidateExtractor_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "touch/cpu/TouchCandidateExtractor_CPU.h"
+
+#include <algorithm>
+
+#include "touch/shared/TouchCandidateExtractor_Shared.h"
+
+namespace spaint {
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Merges the connected components containing the two specified pixels.
+ *
+ * \param a       The index of the first pixel.
+ * \param b       The index of the second pixel.
+ * \param labels  The component labels.
+ */
+static void merge_components(int a, int b, int *labels)
+{
+  a = find_component_root(a, labels);
+  b = find_component_root(b, labels);
+  if(a < b) labels[b] = a;
+  else if(b < a) labels[a] = b;
+}
+
+//#################### CONSTRUCTORS ####################
+
+TouchCandidateExtractor_CPU::TouchCandidateExtractor_CPU(const Vector2i& imgSize)
+: TouchCandidateExtractor(imgSize)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TouchCandidateExtractor_CPU::calculate_candidate_statistics(int minArea, int maxArea, const Vector4i& roi) const
+{
+  int *areas = m_componentAreasMB->GetData(MEMORYDEVICE_CPU);
+  const int *componentImage = m_componentImage->GetData(MEMORYDEVICE_CPU);
+  const unsigned char *diffRawRaycastInMm = m_diffRawRaycastInMm->GetData(MEMORYDEVICE_CPU);
+  int *slots = m_componentSlotsMB->GetData(MEMORYDEVICE_CPU);
+  int *stats = m_candidateStatsMB->GetData(MEMORYDEVICE_CPU);
+  const int width = m_componentImage->noDims.x;
+
+  int *candidateIDs = stats + 1;
+  int *candidateAreas = candidateIDs + MAX_CANDIDATE_COUNT;
+  int *candidateDiffSums = candidateAreas + MAX_CANDIDATE_COUNT;
+  int *candidateHistograms = candidateDiffSums + MAX_CANDIDATE_COUNT;
+  int *candidateBoundingBoxes = candidateHistograms + MAX_CANDIDATE_COUNT * HISTOGRAM_BIN_COUNT;
+
+  // Calculate the areas of the components (all of which lie within the region of interest).
+  for(int y = roi.y; y <= roi.w; ++y)
+  {
+    std::fill(areas + y * width + roi.x, areas + y * width + roi.z + 1, 0);
+  }
+
+  for(int y = roi.y; y <= roi.w; ++y)
+  {
+    for(int x = roi.x; x <= roi.z; ++x)
+    {
+      const int i = y * width + x;
+      if(componentImage[i] >= 0) ++areas[componentImage[i]];
+    }
+  }
+
+  // Assign a slot to each component whose area is in range (each component is represented by its root pixel).
+  m_candidateStatsMB->Clear();
+  int candidateCount = 0;
+  for(int y = roi.y; y <= roi.w; ++y)
+  {
+    for(int x = roi.x; x <= roi.z; ++x)
+    {
+      const int i = y * width + x;
+      if(componentImage[i] != i) continue;
+
+      slots[i] = -1;
+      if(areas[i] < minArea || areas[i] > maxArea) continue;
+
+      if(candidateCount < MAX_CANDIDATE_COUNT)
+      {
+        slots[i] = candidateCount;
+        candidateIDs[candidateCount] = i;
+        candidateAreas[candidateCount] = areas[i];
+
+        // The root pixel is part of the component, so it provides a valid initial bounding box.
+        int *boundingBox = candidateBoundingBoxes + candidateCount * 4;
+        boundingBox[0] = boundingBox[2] = x;
+        boundingBox[1] = boundingBox[3] = y;
+      }
+
+      ++candidateCount;
+    }
+  }
+  stats[0] = candidateCount;
+
+  // Accumulate the difference sums, histograms and bounding boxes of the candidates.
+  for(int y = roi.y; y <= roi.w; ++y)
+  {
+    for(int x = roi.x; x <= roi.z; ++x)
+    {
+      const int i = y * width + x;
+      if(componentImage[i] < 0) continue;
+
+      const int slot = slots[componentImage[i]];
+      if(slot < 0) continue;
+
+      candidateDiffSums[slot] += diffRawRaycastInMm[i];
+      ++candidateHistograms[slot * HISTOGRAM_BIN_COUNT + calculate_histogram_bin(diffRawRaycastInMm[i], HISTOGRAM_BIN_COUNT)];
+
+      int *boundingBox = candidateBoundingBoxes + slot * 4;
+      boundingBox[0] = std::min(boundingBox[0], x);
+      boundingBox[1] = std::min(boundingBox[1], y);
+      boundingBox[2] = std::max(boundingBox[2], x);
+      boundingBox[3] = std::max(boundingBox[3], y);
+    }
+  }
+}
+
+void TouchCandidateExtractor_CPU::calculate_change_mask(const ITMFloatImage *rawDepth, const ITMFloatImage *depthRaycast, float changeThreshold, const Vector4i& roi) const
+{
+  unsigned char *changeMask = m_changeMask->GetData(MEMORYDEVICE_CPU);
+  const float *depthRaycastData = depthRaycast->GetData(MEMORYDEVICE_CPU);
+  float *diffRawRaycast = m_diffRawRaycast->GetData(MEMORYDEVICE_CPU);
+  unsigned char *diffRawRaycastInMm = m_diffRawRaycastInMm->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(rawDepth->dataSize);
+  const float *rawDepthData = rawDepth->GetData(MEMORYDEVICE_CPU);
+  const int width = rawDepth->noDims.x;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    calculate_change_pixel(i, width, roi, rawDepthData, depthRaycastData, changeThreshold, diffRawRaycast, diffRawRaycastInMm, changeMask);
+  }
+}
+
+void TouchCandidateExtractor_CPU::classify_candidates() const
+{
+  const int *stats = m_candidateStatsMB->GetData(MEMORYDEVICE_CPU);
+  const int candidateCount = std::min(stats[0], MAX_CANDIDATE_COUNT);
+  const int pixelCount = static_cast<int>(m_changeMask->dataSize);
+  float *touchProbabilities = m_touchProbabilitiesMB->GetData(MEMORYDEVICE_CPU);
+
+  float descriptor[HISTOGRAM_BIN_COUNT];
+  for(int i = 0; i < candidateCount; ++i)
+  {
+    classify_candidate(
+      i, stats, MAX_CANDIDATE_COUNT, HISTOGRAM_BIN_COUNT, pixelCount,
+      m_touchForestNodesMB->GetData(MEMORYDEVICE_CPU), m_touchForestRootIndicesMB->GetData(MEMORYDEVICE_CPU), m_touchForestTreeCount,
+      m_touchForestLeafMassesMB->GetData(MEMORYDEVICE_CPU), m_touchForestLabelCount, m_touchLabel, descriptor, touchProbabilities
+    );
+  }
+}
+
+void TouchCandidateExtractor_CPU::label_components(const Vector4i& roi) const
+{
+  const unsigned char *changeMask = m_changeMask->GetData(MEMORYDEVICE_CPU);
+  int *labels = m_componentImage->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(m_changeMask->dataSize);
+  const int width = m_changeMask->noDims.x;
+
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    initialise_component_label(i, changeMask, labels);
+  }
+
+  // Merge each changed pixel with its changed left and upper neighbours (this gives 4-connected components).
+  // Since the change mask is clear outside the region of interest, only the pixels within it need to be considered.
+  for(int y = roi.y; y <= roi.w; ++y)
+  {
+    for(int x = roi.x; x <= roi.z; ++x)
+    {
+      const int i = y * width + x;
+      if(!changeMask[i]) continue;
+      if(x > roi.x && changeMask[i - 1]) merge_components(i, i - 1, labels);
+      if(y > roi.y && changeMask[i - width]) merge_components(i, i - width, labels);
+    }
+  }
+
+  // Point each changed pixel directly at the root of its component, which then serves as the component's ID.
+  for(int y = roi.y; y <= roi.w; ++y)
+  {
+    for(int x = roi.x; x <= roi.z; ++x)
+    {
+      const int i = y * width + x;
+      if(labels[i] >= 0) labels[i] = find_component_root(i, labels);
+    }
+  }
+}
+
+void TouchCandidateExtractor_CPU::make_touch_masks(int componentID, int lowerThresholdMm, int upperThresholdMm, const Vector4i& roi) const
+{
+  const int *componentImage = m_componentImage->GetData(MEMORYDEVICE_CPU);
+  const unsigned char *diffRawRaycastInMm = m_diffRawRaycastInMm->GetData(MEMORYDEVICE_CPU);
+  unsigned char *touchMask = m_touchMask->GetData(MEMORYDEVICE_CPU);
+  unsigned char *touchPixelMask = m_touchPixelMask->GetData(MEMORYDEVICE_CPU);
+  const int width = m_componentImage->noDims.x;
+
+  m_touchMask->Clear();
+  m_touchPixelMask->Clear();
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = roi.y; y <= roi.w; ++y)
+  {
+    for(int x = roi.x; x <= roi.z; ++x)
+    {
+      make_touch_pixel(y * width + x, componentID, componentImage, diffRawRaycastInMm, lowerThresholdMm, upperThresholdMm, touchMask, touchPixelMask);
+    }
+  }
+}
+
+void TouchCandidateExtractor_CPU::open_mask(const ITMUCharImage_Ptr& mask, int kernelSize, const Vector4i& roi) const
+{
+  unsigned char *maskData = mask->GetData(MEMORYDEVICE_CPU);
+  unsigned char *bufferData = m_morphologyBuffer->GetData(MEMORYDEVICE_CPU);
+  const int radius = kernelSize / 2;
+  const int width = mask->noDims.x;
+
+  // Erode and then dilate the mask, applying each square kernel as a horizontal pass followed by a vertical pass.
+  for(int pass = 0; pass < 4; ++pass)
+  {
+    const bool erode = pass < 2, horizontal = pass % 2 == 0;
+    const unsigned char *input = horizontal ? maskData : bufferData;
+    unsigned char *output = horizontal ? bufferData : maskData;
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int y = roi.y; y <= roi.w; ++y)
+    {
+      for(int x = roi.x; x <= roi.z; ++x)
+      {
+        morph_pixel(x, y, input, width, roi, radius, horizontal, erode, output);
+      }
+    }
+  }
+}
+
+int TouchCandidateExtractor_CPU::sample_touch_pixels(float scaleFactor) const
+{
+  const int height = m_touchPixelMask->noDims.y;
+  const int resizedHeight = static_cast<int>(height * scaleFactor);
+  const int width = m_touchPixelMask->noDims.x;
+  const int resizedWidth = static_cast<int>(width * scaleFactor);
+  int *samples = m_touchSamplesMB->GetData(MEMORYDEVICE_CPU);
+  const unsigned char *touchPixelMask = m_touchPixelMask->GetData(MEMORYDEVICE_CPU);
+
+  int sampleCount = 0;
+  for(int x = 0; x < resizedWidth; ++x)
+  {
+    for(int y = 0; y < resizedHeight; ++y)
+    {
+      if(is_touch_sample(x, y, touchPixelMask, width, height, scaleFactor)) samples[sampleCount++] = x * resizedHeight + y;
+    }
+  }
+
+  return sampleCount;
+}
+
+}
@@ -0,0 +1,390 @@
+/**
+ * spaint: TouchCandidateExtractor_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "touch/cuda/TouchCandidateExtractor_CUDA.h"
+
+#include <ORUtils/CUDADefines.h>
+
+#include "touch/shared/TouchCandidateExtractor_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA DEVICE FUNCTIONS ####################
+
+/**
+ * \brief Determines the pixel in a region of interest for which a thread is responsible.
+ *
+ * \param tid   The (global) index of the thread.
+ * \param roi   The region of interest, as (minX, minY, maxX, maxY), inclusive.
+ * \param x     An int into which to write the x coordinate of the pixel.
+ * \param y     An int into which to write the y coordinate of the pixel.
+ * \return      true, if the thread is responsible for a pixel, or false if it lies beyond the end of the region of interest.
+ */
+__device__ bool get_roi_pixel(int tid, const Vector4i& roi, int& x, int& y)
+{
+  const int roiWidth = roi.z - roi.x + 1, roiHeight = roi.w - roi.y + 1;
+  if(tid >= roiWidth * roiHeight) return false;
+
+  x = roi.x + tid % roiWidth;
+  y = roi.y + tid / roiWidth;
+  return true;
+}
+
+/**
+ * \brief Merges the connected components containing the two specified pixels.
+ *
+ * Several threads may be merging components at once, so the root with the larger index is atomically pointed at the one
+ * with the smaller index. If another thread changed that root in the meantime, we retry with the updated roots.
+ *
+ * \param a       The index of the first pixel.
+ * \param b       The index of the second pixel.
+ * \param labels  The component labels.
+ */
+__device__ void merge_components(int a, int b, int *labels)
+{
+  bool done = false;
+  while(!done)
+  {
+    a = find_component_root(a, labels);
+    b = find_component_root(b, labels);
+
+    if(a < b)
+    {
+      const int old = atomicMin(&labels[b], a);
+      done = old == b;
+      b = old;
+    }
+    else if(b < a)
+    {
+      const int old = atomicMin(&labels[a], b);
+      done = old == a;
+      a = old;
+    }
+    else done = true;
+  }
+}
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_accumulate_candidate_statistics(const int *componentImage, const unsigned char *diffRawRaycastInMm, const int *slots, int width, Vector4i roi, int *stats)
+{
+  const int K = TouchCandidateExtractor::MAX_CANDIDATE_COUNT, B = TouchCandidateExtractor::HISTOGRAM_BIN_COUNT;
+  int *globalDiffSums = stats + 1 + 2 * K, *globalHistograms = stats + 1 + 3 * K, *globalBoundingBoxes = stats + 1 + 3 * K + K * B;
+
+  // Accumulate the statistics for the pixels handled by this block in shared memory, to avoid contention on the global counters.
+  // The bounding boxes start from the ones initialised by ck_select_candidates.
+  __shared__ int boundingBoxes[K * 4];
+  __shared__ int diffSums[K];
+  __shared__ int histograms[K * B];
+  for(int i = threadIdx.x; i < K * 4; i += blockDim.x) boundingBoxes[i] = globalBoundingBoxes[i];
+  for(int i = threadIdx.x; i < K; i += blockDim.x) diffSums[i] = 0;
+  for(int i = threadIdx.x; i < K * B; i += blockDim.x) histograms[i] = 0;
+  __syncthreads();
+
+  int x, y;
+  if(get_roi_pixel(threadIdx.x + blockDim.x * blockIdx.x, roi, x, y))
+  {
+    const int i = y * width + x;
+    const int slot = componentImage[i] >= 0 ? slots[componentImage[i]] : -1;
+    if(slot >= 0)
+    {
+      atomicAdd(&diffSums[slot], diffRawRaycastInMm[i]);
+      atomicAdd(&histograms[slot * B + calculate_histogram_bin(diffRawRaycastInMm[i], B)], 1);
+      atomicMin(&boundingBoxes[slot * 4], x);
+      atomicMin(&boundingBoxes[slot * 4 + 1], y);
+      atomicMax(&boundingBoxes[slot * 4 + 2], x);
+      atomicMax(&boundingBoxes[slot * 4 + 3], y);
+    }
+  }
+  __syncthreads();
+
+  // Add the block's statistics to the global ones.
+  for(int i = threadIdx.x; i < K * 4; i += blockDim.x)
+  {
+    if(i % 4 < 2) atomicMin(&globalBoundingBoxes[i], boundingBoxes[i]);
+    else atomicMax(&globalBoundingBoxes[i], boundingBoxes[i]);
+  }
+  for(int i = threadIdx.x; i < K; i += blockDim.x)
+  {
+    if(diffSums[i] != 0) atomicAdd(&globalDiffSums[i], diffSums[i]);
+  }
+  for(int i = threadIdx.x; i < K * B; i += blockDim.x)
+  {
+    if(histograms[i] != 0) atomicAdd(&globalHistograms[i], histograms[i]);
+  }
+}
+
+__global__ void ck_accumulate_component_areas(const int *componentImage, int width, Vector4i roi, int *areas)
+{
+  int x, y;
+  if(!get_roi_pixel(threadIdx.x + blockDim.x * blockIdx.x, roi, x, y)) return;
+
+  const int i = y * width + x;
+  if(componentImage[i] >= 0) atomicAdd(&areas[componentImage[i]], 1);
+}
+
+__global__ void ck_calculate_change_mask(const float *rawDepth, const float *depthRaycast, int pixelCount, int width, Vector4i roi, float changeThreshold,
+                                         float *diffRawRaycast, unsigned char *diffRawRaycastInMm, unsigned char *changeMask)
+{
+  const int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < pixelCount) calculate_change_pixel(tid, width, roi, rawDepth, depthRaycast, changeThreshold, diffRawRaycast, diffRawRaycastInMm, changeMask);
+}
+
+__global__ void ck_classify_candidates(const int *stats, int pixelCount, const ForestPredictorNode *nodes, const int *rootIndices, int treeCount,
+                                       const float *leafMasses, int labelCount, int touchLabel, float *touchProbabilities)
+{
+  // Each thread classifies a single candidate, so that all of the candidates are classified at once.
+  const int K = TouchCandidateExtractor::MAX_CANDIDATE_COUNT, B = TouchCandidateExtractor::HISTOGRAM_BIN_COUNT;
+  const int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < K && tid < stats[0])
+  {
+    float descriptor[B];
+    classify_candidate(tid, stats, K, B, pixelCount, nodes, rootIndices, treeCount, leafMasses, labelCount, touchLabel, descriptor, touchProbabilities);
+  }
+}
+
+__global__ void ck_compress_component_labels(int width, Vector4i roi, int *labels)
+{
+  int x, y;
+  if(!get_roi_pixel(threadIdx.x + blockDim.x * blockIdx.x, roi, x, y)) return;
+
+  const int i = y * width + x;
+  if(labels[i] >= 0) labels[i] = find_component_root(i, labels);
+}
+
+__global__ void ck_initialise_component_labels(const unsigned char *mask, int pixelCount, int *labels)
+{
+  const int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < pixelCount) initialise_component_label(tid, mask, labels);
+}
+
+__global__ void ck_make_touch_masks(int componentID, const int *componentImage, const unsigned char *diffRawRaycastInMm, int width, Vector4i roi,
+                                    int lowerThresholdMm, int upperThresholdMm, unsigned char *touchMask, unsigned char *touchPixelMask)
+{
+  int x, y;
+  if(get_roi_pixel(threadIdx.x + blockDim.x * blockIdx.x, roi, x, y))
+  {
+    make_touch_pixel(y * width + x, componentID, componentImage, diffRawRaycastInMm, lowerThresholdMm, upperThresholdMm, touchMask, touchPixelMask);
+  }
+}
+
+__global__ void ck_merge_components(const unsigned char *mask, int width, Vector4i roi, int *labels)
+{
+  int x, y;
+  if(!get_roi_pixel(threadIdx.x + blockDim.x * blockIdx.x, roi, x, y)) return;
+
+  const int i = y * width + x;
+  if(!mask[i]) return;
+  if(x > roi.x && mask[i - 1]) merge_components(i, i - 1, labels);
+  if(y > roi.y && mask[i - width]) merge_components(i, i - width, labels);
+}
+
+__global__ void ck_morph(const unsigned char *input, int width, Vector4i roi, int radius, bool horizontal, bool erode, unsigned char *output)
+{
+  int x, y;
+  if(get_roi_pixel(threadIdx.x + blockDim.x * blockIdx.x, roi, x, y)) morph_pixel(x, y, input, width, roi, radius, horizontal, erode, output);
+}
+
+__global__ void ck_sample_touch_pixels(const unsigned char *touchPixelMask, int width, int height, float scaleFactor,
+                                       int resizedWidth, int resizedHeight, int *samples, int *sampleCount)
+{
+  // Note: Threads are assigned to grid points in column-major order, to match the order in which the points are returned.
+  const int tid = threadIdx.x + blockDim.x * blockIdx.x;
+  if(tid < resizedWidth * resizedHeight)
+  {
+    const int x = tid / resizedHeight, y = tid % resizedHeight;
+    if(is_touch_sample(x, y, touchPixelMask, width, height, scaleFactor)) samples[atomicAdd(sampleCount, 1)] = tid;
+  }
+}
+
+__global__ void ck_select_candidates(const int *componentImage, const int *areas, int width, Vector4i roi, int minArea, int maxArea, int *slots, int *stats)
+{
+  int x, y;
+  if(!get_roi_pixel(threadIdx.x + blockDim.x * blockIdx.x, roi, x, y)) return;
+
+  const int i = y * width + x;
+  if(componentImage[i] != i) return;
+
+  // The thread for the root pixel of each component decides whether or not the component is a candidate.
+  slots[i] = -1;
+  const int area = areas[i];
+  if(area < minArea || area > maxArea) return;
+
+  const int K = TouchCandidateExtractor::MAX_CANDIDATE_COUNT, B = TouchCandidateExtractor::HISTOGRAM_BIN_COUNT;
+  const int slot = atomicAdd(&stats[0], 1);
+  if(slot < K)
+  {
+    slots[i] = slot;
+    stats[1 + slot] = i;
+    stats[1 + K + slot] = area;
+
+    // The root pixel is part of the component, so it provides a valid initial bounding box.
+    int *boundingBox = stats + 1 + 3 * K + K * B + slot * 4;
+    boundingBox[0] = boundingBox[2] = x;
+    boundingBox[1] = boundingBox[3] = y;
+  }
+}
+
+//#################### CONSTRUCTORS ####################
+
+TouchCandidateExtractor_CUDA::TouchCandidateExtractor_CUDA(const Vector2i& imgSize)
+: TouchCandidateExtractor(imgSize),
+  m_touchSampleCountMB(new ORUtils::MemoryBlock<int>(1, true, true))
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TouchCandidateExtractor_CUDA::calculate_candidate_statistics(int minArea, int maxArea, const Vector4i& roi) const
+{
+  int *areas = m_componentAreasMB->GetData(MEMORYDEVICE_CUDA);
+  const int *componentImage = m_componentImage->GetData(MEMORYDEVICE_CUDA);
+  const int pixelCount = static_cast<int>(m_componentImage->dataSize);
+  int *slots = m_componentSlotsMB->GetData(MEMORYDEVICE_CUDA);
+  int *stats = m_candidateStatsMB->GetData(MEMORYDEVICE_CUDA);
+  const int width = m_componentImage->noDims.x;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (calculate_roi_pixel_count(roi) + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Calculate the areas of the components.
+  ORcudaSafeCall(cudaMemset(areas, 0, pixelCount * sizeof(int)));
+  ck_accumulate_component_areas<<<numBlocks,threadsPerBlock>>>(componentImage, width, roi, areas);
+
+  // Assign a slot to each component whose area is in range, and accumulate the statistics of the candidates.
+  ORcudaSafeCall(cudaMemset(stats, 0, m_candidateStatsMB->dataSize * sizeof(int)));
+  ck_select_candidates<<<numBlocks,threadsPerBlock>>>(componentImage, areas, width, roi, minArea, maxArea, slots, stats);
+  ck_accumulate_candidate_statistics<<<numBlocks,threadsPerBlock>>>(componentImage, m_diffRawRaycastInMm->GetData(MEMORYDEVICE_CUDA), slots, width, roi, stats);
+}
+
+void TouchCandidateExtractor_CUDA::calculate_change_mask(const ITMFloatImage *rawDepth, const ITMFloatImage *depthRaycast, float changeThreshold, const Vector4i& roi) const
+{
+  const int pixelCount = static_cast<int>(rawDepth->dataSize);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  ck_calculate_change_mask<<<numBlocks,threadsPerBlock>>>(
+    rawDepth->GetData(MEMORYDEVICE_CUDA),
+    depthRaycast->GetData(MEMORYDEVICE_CUDA),
+    pixelCount,
+    rawDepth->noDims.x,
+    roi,
+    changeThreshold,
+    m_diffRawRaycast->GetData(MEMORYDEVICE_CUDA),
+    m_diffRawRaycastInMm->GetData(MEMORYDEVICE_CUDA),
+    m_changeMask->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void TouchCandidateExtractor_CUDA::classify_candidates() const
+{
+  ck_classify_candidates<<<1,MAX_CANDIDATE_COUNT>>>(
+    m_candidateStatsMB->GetData(MEMORYDEVICE_CUDA),
+    static_cast<int>(m_changeMask->dataSize),
+    m_touchForestNodesMB->GetData(MEMORYDEVICE_CUDA),
+    m_touchForestRootIndicesMB->GetData(MEMORYDEVICE_CUDA),
+    m_touchForestTreeCount,
+    m_touchForestLeafMassesMB->GetData(MEMORYDEVICE_CUDA),
+    m_touchForestLabelCount,
+    m_touchLabel,
+    m_touchProbabilitiesMB->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void TouchCandidateExtractor_CUDA::label_components(const Vector4i& roi) const
+{
+  const unsigned char *changeMask = m_changeMask->GetData(MEMORYDEVICE_CUDA);
+  int *labels = m_componentImage->GetData(MEMORYDEVICE_CUDA);
+  const int pixelCount = static_cast<int>(m_changeMask->dataSize);
+  const int width = m_changeMask->noDims.x;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+  int numROIBlocks = (calculate_roi_pixel_count(roi) + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Label the components using a union-find approach: each changed pixel starts as its own component, the components of neighbouring
+  // changed pixels are then merged, and finally each pixel is pointed directly at the root of its component. Unlike label propagation,
+  // this needs a fixed number of passes, so there is no need to copy a convergence flag back across to the CPU. Since the change mask
+  // is clear outside the region of interest, only the initialisation needs to touch the whole image.
+  ck_initialise_component_labels<<<numBlocks,threadsPerBlock>>>(changeMask, pixelCount, labels);
+  ck_merge_components<<<numROIBlocks,threadsPerBlock>>>(changeMask, width, roi, labels);
+  ck_compress_component_labels<<<numROIBlocks,threadsPerBlock>>>(width, roi, labels);
+}
+
+void TouchCandidateExtractor_CUDA::make_touch_masks(int componentID, int lowerThresholdMm, int upperThresholdMm, const Vector4i& roi) const
+{
+  int threadsPerBlock = 256;
+  int numBlocks = (calculate_roi_pixel_count(roi) + threadsPerBlock - 1) / threadsPerBlock;
+
+  m_touchMask->Clear();
+  m_touchPixelMask->Clear();
+
+  ck_make_touch_masks<<<numBlocks,threadsPerBlock>>>(
+    componentID,
+    m_componentImage->GetData(MEMORYDEVICE_CUDA),
+    m_diffRawRaycastInMm->GetData(MEMORYDEVICE_CUDA),
+    m_componentImage->noDims.x,
+    roi,
+    lowerThresholdMm,
+    upperThresholdMm,
+    m_touchMask->GetData(MEMORYDEVICE_CUDA),
+    m_touchPixelMask->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+void TouchCandidateExtractor_CUDA::open_mask(const ITMUCharImage_Ptr& mask, int kernelSize, const Vector4i& roi) const
+{
+  unsigned char *maskData = mask->GetData(MEMORYDEVICE_CUDA);
+  unsigned char *bufferData = m_morphologyBuffer->GetData(MEMORYDEVICE_CUDA);
+  const int radius = kernelSize / 2;
+  const int width = mask->noDims.x;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (calculate_roi_pixel_count(roi) + threadsPerBlock - 1) / threadsPerBlock;
+
+  // Erode and then dilate the mask, applying each square kernel as a horizontal pass followed by a vertical pass.
+  ck_morph<<<numBlocks,threadsPerBlock>>>(maskData, width, roi, radius, true, true, bufferData);
+  ck_morph<<<numBlocks,threadsPerBlock>>>(bufferData, width, roi, radius, false, true, maskData);
+  ck_morph<<<numBlocks,threadsPerBlock>>>(maskData, width, roi, radius, true, false, bufferData);
+  ck_morph<<<numBlocks,threadsPerBlock>>>(bufferData, width, roi, radius, false, false, maskData);
+}
+
+int TouchCandidateExtractor_CUDA::sample_touch_pixels(float scaleFactor) const
+{
+  const int height = m_touchPixelMask->noDims.y;
+  const int resizedHeight = static_cast<int>(height * scaleFactor);
+  const int width = m_touchPixelMask->noDims.x;
+  const int resizedWidth = static_cast<int>(width * scaleFactor);
+
+  int threadsPerBlock = 256;
+  int numBlocks = (resizedWidth * resizedHeight + threadsPerBlock - 1) / threadsPerBlock;
+
+  ORcudaSafeCall(cudaMemset(m_touchSampleCountMB->GetData(MEMORYDEVICE_CUDA), 0, sizeof(int)));
+
+  ck_sample_touch_pixels<<<numBlocks,threadsPerBlock>>>(
+    m_touchPixelMask->GetData(MEMORYDEVICE_CUDA),
+    width,
+    height,
+    scaleFactor,
+    resizedWidth,
+    resizedHeight,
+    m_touchSamplesMB->GetData(MEMORYDEVICE_CUDA),
+    m_touchSampleCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  // Copy the number of samples back across to the CPU, followed by just that many samples.
+  m_touchSampleCountMB->UpdateHostFromDevice();
+  const int sampleCount = *m_touchSampleCountMB->GetData(MEMORYDEVICE_CPU);
+  if(sampleCount > 0)
+  {
+    ORcudaSafeCall(cudaMemcpy(
+      m_touchSamplesMB->GetData(MEMORYDEVICE_CPU), m_touchSamplesMB->GetData(MEMORYDEVICE_CUDA), sampleCount * sizeof(int), cudaMemcpyDeviceToHost
+    ));
+  }
+
+  return sampleCount;
+}
+
+}
@@ -0,0 +1,261 @@
+/**
+ * spaint: TouchCandidateExtractor.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "touch/interface/TouchCandidateExtractor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Clamps a region of interest to the bounds of an image.
+ *
+ * \param roi     The region of interest, as (minX, minY, maxX, maxY), inclusive.
+ * \param imgSize The size of the image.
+ * \return        The clamped region of interest.
+ */
+static Vector4i clamp_roi(const Vector4i& roi, const Vector2i& imgSize)
+{
+  return Vector4i(
+    std::max(roi.x, 0),
+    std::max(roi.y, 0),
+    std::min(roi.z, imgSize.x - 1),
+    std::min(roi.w, imgSize.y - 1)
+  );
+}
+
+/**
+ * \brief Determines whether or not the first of two candidates has a smaller component ID than the second.
+ *
+ * \param lhs The first candidate.
+ * \param rhs The second candidate.
+ * \return    true, if the first candidate has a smaller component ID than the second, or false otherwise.
+ */
+static bool has_smaller_component_id(const TouchCandidateExtractor::Candidate& lhs, const TouchCandidateExtractor::Candidate& rhs)
+{
+  return lhs.componentID < rhs.componentID;
+}
+
+//#################### CONSTANTS ####################
+
+const int TouchCandidateExtractor::HISTOGRAM_BIN_COUNT;
+const int TouchCandidateExtractor::MAX_CANDIDATE_COUNT;
+
+//#################### CONSTRUCTORS ####################
+
+TouchCandidateExtractor::TouchCandidateExtractor(const Vector2i& imgSize)
+: m_touchForestLabelCount(0), m_touchForestTreeCount(0), m_touchLabel(1)
+{
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  const size_t pixelCount = static_cast<size_t>(imgSize.x * imgSize.y);
+
+  m_candidateStatsMB = mbf.make_block<int>(1 + 3 * MAX_CANDIDATE_COUNT + MAX_CANDIDATE_COUNT * HISTOGRAM_BIN_COUNT + 4 * MAX_CANDIDATE_COUNT, "TouchCandidateExtractor");
+  m_changeMask = mbf.make_image<unsigned char>(imgSize, "TouchCandidateExtractor");
+  m_componentAreasMB = mbf.make_block<int>(pixelCount, "TouchCandidateExtractor");
+  m_componentImage = mbf.make_image<int>(imgSize, "TouchCandidateExtractor");
+  m_componentSlotsMB = mbf.make_block<int>(pixelCount, "TouchCandidateExtractor");
+  m_diffRawRaycast = mbf.make_image<float>(imgSize, "TouchCandidateExtractor");
+  m_diffRawRaycastInMm = mbf.make_image<unsigned char>(imgSize, "TouchCandidateExtractor");
+  m_morphologyBuffer = mbf.make_image<unsigned char>(imgSize, "TouchCandidateExtractor");
+  m_touchMask = mbf.make_image<unsigned char>(imgSize, "TouchCandidateExtractor");
+  m_touchPixelMask = mbf.make_image<unsigned char>(imgSize, "TouchCandidateExtractor");
+  m_touchProbabilitiesMB = mbf.make_block<float>(MAX_CANDIDATE_COUNT, "TouchCandidateExtractor");
+  m_touchSamplesMB = mbf.make_block<int>(pixelCount, "TouchCandidateExtractor");
+
+  clear_touch_mask();
+}
+
+//#################### DESTRUCTOR ####################
+
+TouchCandidateExtractor::~TouchCandidateExtractor() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void TouchCandidateExtractor::clear_touch_mask() const
+{
+  m_touchMask->Clear();
+}
+
+std::vector<TouchCandidateExtractor::Candidate>
+TouchCandidateExtractor::extract_candidates(const ITMFloatImage *rawDepth, const ITMFloatImage *depthRaycast, float changeThreshold,
+                                            int morphKernelSize, int minArea, int maxArea, const Vector4i& roi) const
+{
+  const Vector4i clampedROI = clamp_roi(roi, m_changeMask->noDims);
+  if(clampedROI.x > clampedROI.z || clampedROI.y > clampedROI.w)
+  {
+    throw std::invalid_argument("Error: The region of interest for touch candidate extraction does not overlap the image");
+  }
+
+  // Find the pixels that have changed significantly with respect to the reconstructed model, e.g. because a hand is in front of it.
+  calculate_change_mask(rawDepth, depthRaycast, changeThreshold, clampedROI);
+
+  // Apply a morphological opening operation to the change mask to reduce noise.
+  if(morphKernelSize < 3) morphKernelSize = 3;
+  if(morphKernelSize % 2 == 0) ++morphKernelSize;
+  open_mask(m_changeMask, morphKernelSize, clampedROI);
+
+  // Label the connected components of the change mask, and compute the statistics of those whose areas are in range.
+  label_components(clampedROI);
+  calculate_candidate_statistics(minArea, maxArea, clampedROI);
+
+  // If a touch forest has been set, classify all of the candidates at once on the device.
+  if(has_touch_forest()) classify_candidates();
+
+  // Copy the (small) tables of statistics and probabilities back across to the CPU. These are the only transfers needed to choose between the candidates.
+  m_candidateStatsMB->UpdateHostFromDevice();
+  if(has_touch_forest()) m_touchProbabilitiesMB->UpdateHostFromDevice();
+
+  // Unpack the statistics. Any candidates beyond the maximum number will have been dropped on the device.
+  const int *stats = m_candidateStatsMB->GetData(MEMORYDEVICE_CPU);
+  const int candidateCount = stats[0] < MAX_CANDIDATE_COUNT ? stats[0] : MAX_CANDIDATE_COUNT;
+  const int *componentIDs = stats + 1;
+  const int *areas = componentIDs + MAX_CANDIDATE_COUNT;
+  const int *diffSums = areas + MAX_CANDIDATE_COUNT;
+  const int *histograms = diffSums + MAX_CANDIDATE_COUNT;
+  const int *boundingBoxes = histograms + MAX_CANDIDATE_COUNT * HISTOGRAM_BIN_COUNT;
+  const int pixelCount = static_cast<int>(m_changeMask->dataSize);
+  const float *touchProbabilities = m_touchProbabilitiesMB->GetData(MEMORYDEVICE_CPU);
+
+  std::vector<Candidate> candidates(candidateCount);
+  for(int i = 0; i < candidateCount; ++i)
+  {
+    Candidate& candidate = candidates[i];
+    candidate.area = areas[i];
+    candidate.boundingBox = Vector4i(boundingBoxes[i * 4], boundingBoxes[i * 4 + 1], boundingBoxes[i * 4 + 2], boundingBoxes[i * 4 + 3]);
+    candidate.componentID = componentIDs[i];
+    candidate.diffSumMm = diffSums[i];
+
+    // The histogram is of an image that is zero outside the component, so all of the pixels outside it fall into the first bin.
+    const int *histogram = histograms + i * HISTOGRAM_BIN_COUNT;
+    candidate.histogram.assign(histogram, histogram + HISTOGRAM_BIN_COUNT);
+    candidate.histogram[0] += static_cast<float>(pixelCount - candidate.area);
+
+    candidate.touchProbability = has_touch_forest() ? touchProbabilities[i] : -1.0f;
+  }
+
+  // The candidates may have been found in any order on the device, so sort them to make the result deterministic.
+  std::sort(candidates.begin(), candidates.end(), has_smaller_component_id);
+
+  return candidates;
+}
+
+std::vector<Eigen::Vector2i> TouchCandidateExtractor::extract_touch_points(const Candidate& candidate, int lowerThresholdMm, int upperThresholdMm,
+                                                                           float scaleFactor, float minTouchArea) const
+{
+  // Find the pixels in the component that are close to the surface, and apply a morphological opening operation to reduce noise.
+  // Since an opening can only remove pixels, both steps can be confined to the component's bounding box.
+  make_touch_masks(candidate.componentID, lowerThresholdMm, upperThresholdMm, candidate.boundingBox);
+  open_mask(m_touchPixelMask, 5, candidate.boundingBox);
+
+  // Spatially quantise the touch pixels by sampling them on a coarser grid. This reduces the eventual number of touch points.
+  const int sampleCount = sample_touch_pixels(scaleFactor);
+
+  // If there are too few touch points, assume the user is not touching the scene in a meaningful way and early out.
+  if(sampleCount <= minTouchArea) return std::vector<Eigen::Vector2i>();
+
+  // Otherwise, convert the (column-major) sample indices to touch points and return them.
+  int *samples = m_touchSamplesMB->GetData(MEMORYDEVICE_CPU);
+  std::sort(samples, samples + sampleCount);
+
+  const int resizedHeight = static_cast<int>(m_touchPixelMask->noDims.y * scaleFactor);
+  std::vector<Eigen::Vector2i> touchPoints(sampleCount);
+  for(int i = 0; i < sampleCount; ++i)
+  {
+    Eigen::Vector2f point(samples[i] / resizedHeight, samples[i] % resizedHeight);
+    touchPoints[i] = (point / scaleFactor).cast<int>();
+  }
+
+  return touchPoints;
+}
+
+ITMUCharImage_CPtr TouchCandidateExtractor::get_change_mask() const
+{
+  return m_changeMask;
+}
+
+ITMIntImage_CPtr TouchCandidateExtractor::get_component_image() const
+{
+  return m_componentImage;
+}
+
+ITMFloatImage_CPtr TouchCandidateExtractor::get_diff_raw_raycast() const
+{
+  return m_diffRawRaycast;
+}
+
+ITMUCharImage_CPtr TouchCandidateExtractor::get_diff_raw_raycast_in_mm() const
+{
+  return m_diffRawRaycastInMm;
+}
+
+Vector4i TouchCandidateExtractor::get_full_roi() const
+{
+  return Vector4i(0, 0, m_changeMask->noDims.x - 1, m_changeMask->noDims.y - 1);
+}
+
+ITMUCharImage_CPtr TouchCandidateExtractor::get_touch_mask() const
+{
+  return m_touchMask;
+}
+
+ITMUCharImage_CPtr TouchCandidateExtractor::get_touch_pixel_mask() const
+{
+  return m_touchPixelMask;
+}
+
+bool TouchCandidateExtractor::has_touch_forest() const
+{
+  return m_touchForestTreeCount > 0;
+}
+
+void TouchCandidateExtractor::set_touch_forest(const CompiledTouchForest& forest, int touchLabel)
+{
+  if(forest.get_min_descriptor_size() > static_cast<size_t>(HISTOGRAM_BIN_COUNT))
+  {
+    throw std::invalid_argument("Error: The touch forest needs larger descriptors than those computed for the touch candidates");
+  }
+
+  const std::vector<CompiledTouchForest::Node>& nodes = forest.get_nodes();
+  const std::vector<float>& leafMasses = forest.get_leaf_masses();
+  const std::vector<int>& rootIndices = forest.get_root_indices();
+
+  // Copy the forest into memory blocks on the device, in the same flat form used by the forest predictor.
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_touchForestLeafMassesMB = mbf.make_block<float>(std::max<size_t>(leafMasses.size(), 1), "TouchCandidateExtractor");
+  m_touchForestNodesMB = mbf.make_block<ForestPredictorNode>(std::max<size_t>(nodes.size(), 1), "TouchCandidateExtractor");
+  m_touchForestRootIndicesMB = mbf.make_block<int>(std::max<size_t>(rootIndices.size(), 1), "TouchCandidateExtractor");
+
+  std::copy(leafMasses.begin(), leafMasses.end(), m_touchForestLeafMassesMB->GetData(MEMORYDEVICE_CPU));
+  std::copy(rootIndices.begin(), rootIndices.end(), m_touchForestRootIndicesMB->GetData(MEMORYDEVICE_CPU));
+
+  ForestPredictorNode *dest = m_touchForestNodesMB->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0, size = nodes.size(); i < size; ++i)
+  {
+    const CompiledTouchForest::Node& node = nodes[i];
+    dest[i].firstFeatureIndex = static_cast<int>(node.splitter.firstFeatureIndex);
+    dest[i].leafIndex = node.leafIndex;
+    dest[i].leftChildIndex = node.leftChildIndex;
+    dest[i].op = node.splitter.op;
+    dest[i].rightChildIndex = node.rightChildIndex;
+    dest[i].secondFeatureIndex = static_cast<int>(node.splitter.secondFeatureIndex);
+    dest[i].threshold = node.splitter.threshold;
+  }
+
+  m_touchForestLeafMassesMB->UpdateDeviceFromHost();
+  m_touchForestNodesMB->UpdateDeviceFromHost();
+  m_touchForestRootIndicesMB->UpdateDeviceFromHost();
+
+  m_touchForestLabelCount = static_cast<int>(forest.get_label_count());
+  m_touchForestTreeCount = static_cast<int>(rootIndices.size());
+  m_touchLabel = touchLabel;
+}
+
+}
@@ -0,0 +1,60 @@
+/**
+ * spaint: ConstantVelocityMotionModel.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "trackers/ConstantVelocityMotionModel.h"
+
+#include <stdexcept>
+
+#include <itmx/geometry/GeometryUtil.h>
+using namespace itmx;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ConstantVelocityMotionModel::ConstantVelocityMotionModel(double damping, double maxRotationPerFrame, double maxTranslationPerFrame)
+: m_damping(damping), m_maxRotationPerFrame(maxRotationPerFrame), m_maxTranslationPerFrame(maxTranslationPerFrame)
+{
+  if(damping < 0.0 || damping > 1.0) throw std::invalid_argument("Error: The damping of a constant-velocity motion model must be in [0,1]");
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+boost::optional<ORUtils::SE3Pose> ConstantVelocityMotionModel::predict_pose() const
+{
+  if(!m_lastPose || !m_velocity) return boost::none;
+
+  // Apply the (damped) per-frame motion to the most recent pose. Note that the poses map world space to camera space,
+  // so the motion is applied on the left.
+  const DualQuatd step = m_damping < 1.0 ? m_velocity->pow(m_damping) : *m_velocity;
+  return GeometryUtil::dual_quat_to_pose(step * *m_lastPose);
+}
+
+void ConstantVelocityMotionModel::reset()
+{
+  m_lastPose.reset();
+  m_velocity.reset();
+}
+
+void ConstantVelocityMotionModel::update(const ORUtils::SE3Pose& pose)
+{
+  const DualQuatd dq = GeometryUtil::pose_to_dual_quat<double>(pose);
+
+  if(m_lastPose)
+  {
+    // Estimate the motion between the previous pose and this one (for unit dual quaternions, the conjugate is the inverse).
+    const DualQuatd velocity = dq * m_lastPose->conjugate();
+
+    // If the motion is implausibly large, don't use it for prediction.
+    const double rotation = length(velocity.get_rotation());
+    const double translation = length(velocity.get_translation());
+    if(rotation <= m_maxRotationPerFrame && translation <= m_maxTranslationPerFrame) m_velocity = velocity;
+    else m_velocity.reset();
+  }
+
+  m_lastPose = dq;
+}
+
+}
@@ -24,6 +24,15 @@ RobustViconTracker::RobustViconTracker(const std::string& host, const std::strin
   ));
 }
 
+RobustViconTracker::RobustViconTracker(const ViconPoseProvider_Ptr& poseProvider, const Vector2i& rgbImageSize, const Vector2i& depthImageSize,
+                                       const Settings_CPtr& settings, const LowLevelEngine_CPtr& lowLevelEngine)
+{
+  m_viconTracker.reset(new ViconTracker(poseProvider));
+  m_icpTracker.reset(ITMTrackerFactory::Instance().Make(
+    rgbImageSize, depthImageSize, settings.get(), lowLevelEngine.get(), NULL, &settings->sceneParams
+  ));
+}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 bool RobustViconTracker::requiresColourRendering() const
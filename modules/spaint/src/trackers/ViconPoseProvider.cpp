@@ -0,0 +1,206 @@
+/**
+ * spaint: ViconPoseProvider.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "trackers/ViconPoseProvider.h"
+using namespace ViconDataStreamSDK::CPP;
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ViconPoseProvider::ViconPoseProvider(const std::string& host, const std::string& subjectName)
+: m_creationTime(Clock::now()), m_receiverShouldTerminate(false), m_sampleCount(0), m_subjectName(subjectName)
+{
+  for(size_t i = 0; i < SLOT_COUNT; ++i)
+  {
+    m_slots[i].sequence = 0;
+  }
+
+  // Connect to the Vicon system.
+  if(m_vicon.Connect(host).Result != Result::Success || !m_vicon.IsConnected().Connected)
+  {
+    throw std::runtime_error("Could not connect to the Vicon system");
+  }
+
+  // Set up the Vicon client.
+  m_vicon.EnableMarkerData();
+  m_vicon.EnableSegmentData();
+  m_vicon.EnableUnlabeledMarkerData();
+  m_vicon.SetAxisMapping(Direction::Right, Direction::Down, Direction::Forward);
+  m_vicon.SetStreamMode(ViconDataStreamSDK::CPP::StreamMode::ServerPush);
+
+  // Start the receiver thread.
+  m_receiver = boost::thread(boost::bind(&ViconPoseProvider::run_receiver, this));
+}
+
+//#################### DESTRUCTOR ####################
+
+ViconPoseProvider::~ViconPoseProvider()
+{
+  // Wait for the receiver thread to terminate, and then disconnect from the Vicon system.
+  m_receiverShouldTerminate = true;
+  m_receiver.join();
+
+  m_vicon.DisableMarkerData();
+  m_vicon.DisableSegmentData();
+  m_vicon.DisableUnlabeledMarkerData();
+  m_vicon.Disconnect();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+double ViconPoseProvider::get_current_time() const
+{
+  return boost::chrono::duration<double>(Clock::now() - m_creationTime).count();
+}
+
+boost::optional<ViconPoseProvider::PoseSample> ViconPoseProvider::try_get_pose(double timestamp) const
+{
+  for(;;)
+  {
+    const size_t sampleCount = m_sampleCount.load(boost::memory_order_acquire);
+    if(sampleCount == 0) return boost::none;
+
+    // Walk backwards through the ring from the most recent sample until we find one that is no later than the
+    // specified time. If we run into a slot that has been overwritten, all of the older ones will have been too.
+    const size_t oldestIndex = sampleCount > SLOT_COUNT ? sampleCount - SLOT_COUNT : 0;
+    boost::optional<PoseSample> laterSample;
+    for(size_t i = sampleCount; i-- > oldestIndex;)
+    {
+      PoseSample sample;
+      if(!try_read_sample(i, sample)) break;
+
+      if(sample.timestamp <= timestamp)
+      {
+        return laterSample ? interpolate(sample, *laterSample, timestamp) : sample;
+      }
+
+      laterSample = sample;
+    }
+
+    // If we managed to read at least one sample, then the specified time is earlier than any that we could read,
+    // so return the oldest one. Otherwise, even the most recent sample was overwritten whilst we were reading it
+    // (which can only happen if this thread was descheduled for a long time), so simply try again.
+    if(laterSample) return laterSample;
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void ViconPoseProvider::compute_pose(PoseSample& sample) const
+{
+  // Look up the positions of the markers on the camera that are needed to determine its pose.
+  const char *markerNames[] = { "centre", "front", "left", "right" };
+  Eigen::Vector3f markerPositions[4];
+  for(int i = 0; i < 4; ++i)
+  {
+    Output_GetMarkerGlobalTranslation trans = m_vicon.GetMarkerGlobalTranslation(m_subjectName, markerNames[i]);
+
+    // If we can't currently get the position of the marker, the pose can't be determined.
+    if(trans.Result != Result::Success || trans.Occluded)
+    {
+      sample.tracked = false;
+      return;
+    }
+
+    // Transform the marker position from the Vicon coordinate system to our one (the Vicon coordinate system is in mm, whereas ours is in metres).
+    markerPositions[i] = Eigen::Vector3f(
+      static_cast<float>(trans.Translation[0] / 1000),
+      static_cast<float>(trans.Translation[1] / 1000),
+      static_cast<float>(trans.Translation[2] / 1000)
+    );
+  }
+
+  const Eigen::Vector3f& c = markerPositions[0];
+  const Eigen::Vector3f& f = markerPositions[1];
+  const Eigen::Vector3f& l = markerPositions[2];
+  const Eigen::Vector3f& r = markerPositions[3];
+
+  // Calculate the camera's v axis using the positions of the markers on top of the camera.
+  sample.v = (r - c).cross(l - c).normalized();
+
+  // Calculate the camera's n axis by projecting a vector from the right marker to the front marker into the plane defined by the markers on top of the camera.
+  sample.n = f - r;
+  sample.n = (sample.n - sample.n.dot(sample.v) * sample.v).normalized();
+
+  sample.position = c;
+  sample.tracked = true;
+}
+
+void ViconPoseProvider::run_receiver()
+{
+  while(!m_receiverShouldTerminate)
+  {
+    // Wait for the next frame from the Vicon system (if we can't get one, back off briefly rather than spinning).
+    if(m_vicon.GetFrame().Result != Result::Success)
+    {
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+      continue;
+    }
+
+    // Compute the pose of the subject, timestamping it with the time at which the frame was actually captured.
+    PoseSample sample;
+    Output_GetLatencyTotal latency = m_vicon.GetLatencyTotal();
+    sample.timestamp = get_current_time() - (latency.Result == Result::Success ? latency.Total : 0.0);
+    compute_pose(sample);
+
+    // Write the sample into the next slot in the ring. The slot's sequence number is made odd whilst the sample
+    // is being written, so that any consumer that reads the slot concurrently can tell that it was overwritten.
+    const size_t sampleIndex = m_sampleCount.load(boost::memory_order_relaxed);
+    Slot& slot = m_slots[sampleIndex % SLOT_COUNT];
+    slot.sequence.store(2 * sampleIndex + 1, boost::memory_order_relaxed);
+    boost::atomic_thread_fence(boost::memory_order_release);
+    slot.sample = sample;
+    slot.sequence.store(2 * (sampleIndex + 1), boost::memory_order_release);
+
+    // Publish the sample.
+    m_sampleCount.store(sampleIndex + 1, boost::memory_order_release);
+  }
+}
+
+bool ViconPoseProvider::try_read_sample(size_t sampleIndex, PoseSample& sample) const
+{
+  const Slot& slot = m_slots[sampleIndex % SLOT_COUNT];
+  const size_t expectedSequence = 2 * (sampleIndex + 1);
+
+  if(slot.sequence.load(boost::memory_order_acquire) != expectedSequence) return false;
+  sample = slot.sample;
+  boost::atomic_thread_fence(boost::memory_order_acquire);
+  return slot.sequence.load(boost::memory_order_relaxed) == expectedSequence;
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+ViconPoseProvider::PoseSample ViconPoseProvider::interpolate(const PoseSample& s0, const PoseSample& s1, double t)
+{
+  const double duration = s1.timestamp - s0.timestamp;
+  const float alpha = duration > 0.0 ? static_cast<float>((t - s0.timestamp) / duration) : 1.0f;
+
+  // If either sample could not be tracked, there is nothing meaningful to interpolate, so just use the nearer one.
+  if(!s0.tracked || !s1.tracked) return alpha < 0.5f ? s0 : s1;
+
+  PoseSample result;
+  result.timestamp = t;
+  result.tracked = true;
+
+  // Linearly interpolate the position of the camera.
+  result.position = (1.0f - alpha) * s0.position + alpha * s1.position;
+
+  // Spherically interpolate the orientation of the camera (the n and v axes of each sample are orthonormal).
+  Eigen::Matrix3f r0, r1;
+  r0 << s0.n, s0.v, s0.n.cross(s0.v);
+  r1 << s1.n, s1.v, s1.n.cross(s1.v);
+  const Eigen::Matrix3f r = Eigen::Quaternionf(r0).slerp(alpha, Eigen::Quaternionf(r1)).toRotationMatrix();
+  result.n = r.col(0);
+  result.v = r.col(1);
+
+  return result;
+}
+
+}
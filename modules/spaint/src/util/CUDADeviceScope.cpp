@@ -0,0 +1,93 @@
+/**
+ * spaint: CUDADeviceScope.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "util/CUDADeviceScope.h"
+
+#include <stdexcept>
+
+#ifdef WITH_CUDA
+#include <ORUtils/CUDADefines.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+CUDADeviceScope::CUDADeviceScope(int device)
+: m_previousDevice(-1)
+{
+#ifdef WITH_CUDA
+  if(device < 0) return;
+
+  int currentDevice;
+  ORcudaSafeCall(cudaGetDevice(&currentDevice));
+  if(device == currentDevice) return;
+
+  if(cudaSetDevice(device) != cudaSuccess)
+  {
+    throw std::runtime_error("Error: Could not make CUDA device " + boost::lexical_cast<std::string>(device) + " current");
+  }
+
+  m_previousDevice = currentDevice;
+#endif
+}
+
+//#################### DESTRUCTOR ####################
+
+CUDADeviceScope::~CUDADeviceScope()
+{
+#ifdef WITH_CUDA
+  if(m_previousDevice >= 0) cudaSetDevice(m_previousDevice);
+#endif
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+void CUDADeviceScope::enable_peer_access(int peerDevice)
+{
+#ifdef WITH_CUDA
+  if(peerDevice < 0) return;
+
+  int currentDevice;
+  ORcudaSafeCall(cudaGetDevice(&currentDevice));
+  if(peerDevice == currentDevice) return;
+
+  int forwardAccess = 0, backwardAccess = 0;
+  ORcudaSafeCall(cudaDeviceCanAccessPeer(&forwardAccess, currentDevice, peerDevice));
+  ORcudaSafeCall(cudaDeviceCanAccessPeer(&backwardAccess, peerDevice, currentDevice));
+  if(!forwardAccess || !backwardAccess)
+  {
+    throw std::runtime_error(
+      "Error: CUDA devices " + boost::lexical_cast<std::string>(currentDevice) + " and " +
+      boost::lexical_cast<std::string>(peerDevice) + " cannot access each other's memory directly"
+    );
+  }
+
+  enable_peer_access_from_current(peerDevice);
+  {
+    CUDADeviceScope peerScope(peerDevice);
+    enable_peer_access_from_current(currentDevice);
+  }
+#endif
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+void CUDADeviceScope::enable_peer_access_from_current(int peerDevice)
+{
+#ifdef WITH_CUDA
+  cudaError_t err = cudaDeviceEnablePeerAccess(peerDevice, 0);
+  if(err == cudaErrorPeerAccessAlreadyEnabled)
+  {
+    // Clear the error, since enabling peer access more than once is harmless.
+    cudaGetLastError();
+  }
+  else ORcudaSafeCall(err);
+#endif
+}
+
+}
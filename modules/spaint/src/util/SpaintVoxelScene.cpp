@@ -0,0 +1,233 @@
+/**
+ * spaint: SpaintVoxelScene.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "util/SpaintVoxelScene.h"
+using namespace ITMLib;
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+SpaintVoxelScene::SpaintVoxelScene(const ITMSceneParams *sceneParams, bool useSwapping, MemoryDeviceType memoryType, bool useBlockOccupancy,
+                                   bool useLabelEvidence)
+: ITMScene<SpaintVoxel,ITMVoxelIndex>(sceneParams, useSwapping, memoryType),
+  m_memoryType(memoryType),
+  m_raycastRegionRenderState(NULL),
+  m_resetVersion(0),
+  m_version(0)
+{
+#ifdef USE_LABEL_VOLUME
+  if(useSwapping)
+  {
+    throw std::runtime_error("Error: Swapping is not currently supported when the voxel labels are stored in a separate label volume");
+  }
+
+  m_labelsMB.reset(new ORUtils::MemoryBlock<SpaintVoxel::PackedLabel>(localVBA.allocatedSize, memoryType));
+#endif
+
+  // Note: The label counts are only maintained if swapping is disabled, since swapping moves labels between the
+  //       device and the global cache without going through the voxel marker.
+  if(!useSwapping)
+  {
+    m_labelCountsMB.reset(new ORUtils::MemoryBlock<unsigned int>(LABEL_GROUP_COUNT * LABEL_VALUE_COUNT, true, memoryType == MEMORYDEVICE_CUDA));
+    reset_label_counts();
+
+    // Note: The same applies to the label presence masks. They start out with every bit set, since the labels in
+    //       the label volume (if any) are not initialised until they are first cleared.
+    m_labelPresenceMB.reset(new ORUtils::MemoryBlock<unsigned int>(localVBA.allocatedSize / SDF_BLOCK_SIZE3 * LABEL_PRESENCE_WORD_COUNT, memoryType));
+    reset_label_presence();
+  }
+
+  if(useLabelEvidence)
+  {
+    if(useSwapping)
+    {
+      throw std::runtime_error("Error: Swapping is not currently supported when the evidence for the voxel labels is being accumulated");
+    }
+
+    m_labelEvidenceMB.reset(new ORUtils::MemoryBlock<SpaintVoxel::LabelEvidence>(localVBA.allocatedSize, memoryType));
+    reset_label_evidence();
+  }
+
+  m_relabelledBlockFlagsMB.reset(new ORUtils::MemoryBlock<unsigned char>(localVBA.allocatedSize / SDF_BLOCK_SIZE3, memoryType));
+  m_relabelledBlockFlagsMB->Clear();
+
+  m_blockVersionsMB.reset(new ORUtils::MemoryBlock<BlockVersions>(localVBA.allocatedSize / SDF_BLOCK_SIZE3, memoryType));
+  m_blockVersionsMB->Clear();
+
+  if(useBlockOccupancy)
+  {
+    m_blockOccupancyMB.reset(new ORUtils::MemoryBlock<BlockOccupancy>(ITMVoxelBlockHash::noTotalEntries, memoryType));
+    reset_block_occupancy();
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SpaintVoxelScene::add_to_label_counts(const std::vector<unsigned int>& deltas)
+{
+  if(!m_labelCountsMB) return;
+
+  m_labelCountsMB->UpdateHostFromDevice();
+  unsigned int *labelCounts = m_labelCountsMB->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0, size = std::min(deltas.size(), m_labelCountsMB->dataSize); i < size; ++i)
+  {
+    labelCounts[i] += deltas[i];
+  }
+  m_labelCountsMB->UpdateDeviceFromHost();
+}
+
+unsigned int SpaintVoxelScene::advance_version()
+{
+  return ++m_version;
+}
+
+SpaintVoxelScene::BlockOccupancy *SpaintVoxelScene::get_block_occupancy_data()
+{
+  return m_blockOccupancyMB ? m_blockOccupancyMB->GetData(m_memoryType) : NULL;
+}
+
+const SpaintVoxelScene::BlockOccupancy *SpaintVoxelScene::get_block_occupancy_data() const
+{
+  return m_blockOccupancyMB ? m_blockOccupancyMB->GetData(m_memoryType) : NULL;
+}
+
+SpaintVoxelScene::BlockVersions *SpaintVoxelScene::get_block_versions()
+{
+  return m_blockVersionsMB->GetData(m_memoryType);
+}
+
+const SpaintVoxelScene::BlockVersions *SpaintVoxelScene::get_block_versions() const
+{
+  return m_blockVersionsMB->GetData(m_memoryType);
+}
+
+unsigned int *SpaintVoxelScene::get_label_count_data()
+{
+  return m_labelCountsMB ? m_labelCountsMB->GetData(m_memoryType) : NULL;
+}
+
+const unsigned int *SpaintVoxelScene::get_label_count_data() const
+{
+  return m_labelCountsMB ? m_labelCountsMB->GetData(m_memoryType) : NULL;
+}
+
+std::vector<unsigned int> SpaintVoxelScene::get_label_counts(SpaintVoxel::LabelGroup group) const
+{
+  if(!m_labelCountsMB) return std::vector<unsigned int>();
+
+  m_labelCountsMB->UpdateHostFromDevice();
+  const unsigned int *groupCounts = m_labelCountsMB->GetData(MEMORYDEVICE_CPU) + group * LABEL_VALUE_COUNT;
+  return std::vector<unsigned int>(groupCounts, groupCounts + LABEL_VALUE_COUNT);
+}
+
+SpaintVoxel::PackedLabel *SpaintVoxelScene::get_label_data()
+{
+  return m_labelsMB ? m_labelsMB->GetData(m_memoryType) : NULL;
+}
+
+const SpaintVoxel::PackedLabel *SpaintVoxelScene::get_label_data() const
+{
+  return m_labelsMB ? m_labelsMB->GetData(m_memoryType) : NULL;
+}
+
+SpaintVoxel::LabelEvidence *SpaintVoxelScene::get_label_evidence_data()
+{
+  return m_labelEvidenceMB ? m_labelEvidenceMB->GetData(m_memoryType) : NULL;
+}
+
+const SpaintVoxel::LabelEvidence *SpaintVoxelScene::get_label_evidence_data() const
+{
+  return m_labelEvidenceMB ? m_labelEvidenceMB->GetData(m_memoryType) : NULL;
+}
+
+unsigned int *SpaintVoxelScene::get_label_presence_data()
+{
+  return m_labelPresenceMB ? m_labelPresenceMB->GetData(m_memoryType) : NULL;
+}
+
+const unsigned int *SpaintVoxelScene::get_label_presence_data() const
+{
+  return m_labelPresenceMB ? m_labelPresenceMB->GetData(m_memoryType) : NULL;
+}
+
+SpaintVoxelScene::Occupancy SpaintVoxelScene::get_occupancy() const
+{
+  // Note: The free lists are used as stacks, so the index of the last free element is one less than the number of free elements.
+  //       The size of the local voxel block array is measured in voxels rather than blocks.
+  Occupancy occupancy;
+  occupancy.blockCapacity = localVBA.allocatedSize / SDF_BLOCK_SIZE3;
+  occupancy.allocatedBlockCount = occupancy.blockCapacity - (localVBA.lastFreeBlockId + 1);
+  occupancy.excessEntryCapacity = SDF_EXCESS_LIST_SIZE;
+  occupancy.usedExcessEntryCount = occupancy.excessEntryCapacity - (index.GetLastFreeExcessListId() + 1);
+  return occupancy;
+}
+
+boost::optional<Vector4i> SpaintVoxelScene::get_raycast_region(const ITMRenderState *renderState) const
+{
+  return renderState == m_raycastRegionRenderState ? m_raycastRegion : boost::none;
+}
+
+unsigned char *SpaintVoxelScene::get_relabelled_block_flags()
+{
+  return m_relabelledBlockFlagsMB->GetData(m_memoryType);
+}
+
+const unsigned char *SpaintVoxelScene::get_relabelled_block_flags() const
+{
+  return m_relabelledBlockFlagsMB->GetData(m_memoryType);
+}
+
+unsigned int SpaintVoxelScene::get_reset_version() const
+{
+  return m_resetVersion;
+}
+
+unsigned int SpaintVoxelScene::get_version() const
+{
+  return m_version;
+}
+
+void SpaintVoxelScene::reset_block_occupancy()
+{
+  // Note: Clearing the records marks every block as not known to be empty.
+  if(m_blockOccupancyMB) m_blockOccupancyMB->Clear();
+}
+
+void SpaintVoxelScene::reset_block_versions()
+{
+  // Note: Clearing the records marks every block as unchanged since version 0, which is earlier than the reset version,
+  //       so any block that is reallocated afterwards will be found as changed once it has been stamped by fusion.
+  m_blockVersionsMB->Clear();
+  m_resetVersion = advance_version();
+}
+
+void SpaintVoxelScene::reset_label_counts()
+{
+  if(m_labelCountsMB) m_labelCountsMB->Clear();
+}
+
+void SpaintVoxelScene::reset_label_evidence()
+{
+  // Note: A zeroed record denotes a voxel for which no labels have yet been predicted.
+  if(m_labelEvidenceMB) m_labelEvidenceMB->Clear();
+}
+
+void SpaintVoxelScene::reset_label_presence()
+{
+  // Note: Setting every bit marks every label as possibly present in every block.
+  if(m_labelPresenceMB) m_labelPresenceMB->Clear(0xFF);
+}
+
+void SpaintVoxelScene::set_raycast_region(const ITMRenderState *renderState, const boost::optional<Vector4i>& region)
+{
+  m_raycastRegion = region;
+  m_raycastRegionRenderState = region ? renderState : NULL;
+}
+
+}
@@ -0,0 +1,48 @@
+/**
+ * spaint: ComponentStream_CUDA.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "util/cuda/ComponentStream_CUDA.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+ComponentStream_CUDA::ComponentStream_CUDA()
+{
+  ORcudaSafeCall(cudaStreamCreateWithFlags(&m_stream, cudaStreamNonBlocking));
+  ORcudaSafeCall(cudaEventCreateWithFlags(&m_inputsReadyEvent, cudaEventDisableTiming));
+  ORcudaSafeCall(cudaEventCreateWithFlags(&m_outputsReadyEvent, cudaEventDisableTiming));
+}
+
+//#################### DESTRUCTOR ####################
+
+ComponentStream_CUDA::~ComponentStream_CUDA()
+{
+  // Note: Destroying a stream or an event whilst work is still pending on it is safe (its resources are released once the work has finished).
+  cudaEventDestroy(m_outputsReadyEvent);
+  cudaEventDestroy(m_inputsReadyEvent);
+  cudaStreamDestroy(m_stream);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ComponentStream_CUDA::begin_work() const
+{
+  ORcudaSafeCall(cudaEventRecord(m_inputsReadyEvent, 0));
+  ORcudaSafeCall(cudaStreamWaitEvent(m_stream, m_inputsReadyEvent, 0));
+}
+
+void ComponentStream_CUDA::end_work() const
+{
+  ORcudaSafeCall(cudaEventRecord(m_outputsReadyEvent, m_stream));
+  ORcudaSafeCall(cudaStreamWaitEvent(0, m_outputsReadyEvent, 0));
+}
+
+cudaStream_t ComponentStream_CUDA::get() const
+{
+  return m_stream;
+}
+
+}
@@ -5,10 +5,15 @@
 
 #include "visualisation/VisualisationGenerator.h"
 
+#include <stdexcept>
+
+#include <boost/serialization/shared_ptr.hpp>
+
 #include <ITMLib/Objects/RenderStates/ITMRenderStateFactory.h>
 using namespace ITMLib;
 
 #include "visualisation/VisualiserFactory.h"
+#include "visualisation/shared/SemanticVisualiser_Shared.h"
 
 namespace spaint {
 
@@ -17,16 +22,37 @@ namespace spaint {
 VisualisationGenerator::VisualisationGenerator(const VoxelVisualisationEngine_CPtr& voxelVisualisationEngine, const SurfelVisualisationEngine_CPtr& surfelVisualisationEngine,
                                                const LabelManager_CPtr& labelManager, const Settings_CPtr& settings)
 : m_labelManager(labelManager),
+  m_multiOutputVisualiser(VisualiserFactory::make_multi_output_visualiser(labelManager->get_max_label_count(), settings->deviceType)),
   m_semanticVisualiser(VisualiserFactory::make_semantic_visualiser(labelManager->get_max_label_count(), settings->deviceType)),
   m_settings(settings),
+  m_stereoRaycaster(VisualiserFactory::make_stereo_raycaster(settings->deviceType)),
   m_surfelVisualisationEngine(surfelVisualisationEngine),
   m_voxelVisualisationEngine(voxelVisualisationEngine)
 {}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+void VisualisationGenerator::expand_compact_semantic_image(const ITMUShortImage_CPtr& input, const ITMUChar4Image_Ptr& output) const
+{
+  output->ChangeDims(input->noDims);
+
+  const std::vector<Vector3u>& labelColours = m_labelManager->get_label_colours();
+  const ushort *inputData = input->GetData(MEMORYDEVICE_CPU);
+  Vector4u *outputData = output->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(input->dataSize);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    outputData[i] = unpack_compact_semantic_pixel(inputData[i], &labelColours[0]);
+  }
+}
+
 void VisualisationGenerator::generate_surfel_visualisation(const ITMUChar4Image_Ptr& output, const SpaintSurfelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
-                                                           const View_CPtr& view, SurfelRenderState_Ptr& renderState, VisualisationType visualisationType) const
+                                                           const View_CPtr& view, SurfelRenderState_Ptr& renderState, VisualisationType visualisationType,
+                                                           bool copyToHost) const
 {
   if(!scene)
   {
@@ -88,12 +114,12 @@ void VisualisationGenerator::generate_surfel_visualisation(const ITMUChar4Image_
     }
   }
 
-  if(m_settings->deviceType == ITMLibSettings::DEVICE_CUDA) output->UpdateHostFromDevice();
+  if(copyToHost && m_settings->deviceType == ITMLibSettings::DEVICE_CUDA) output->UpdateHostFromDevice();
 }
 
 void VisualisationGenerator::generate_voxel_visualisation(const ITMUChar4Image_Ptr& output, const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
                                                           const View_CPtr& view, VoxelRenderState_Ptr& renderState, VisualisationType visualisationType,
-                                                          const boost::optional<Postprocessor>& postprocessor) const
+                                                          const boost::optional<Postprocessor>& postprocessor, bool copyToHost) const
 {
   if(!scene)
   {
@@ -101,24 +127,92 @@ void VisualisationGenerator::generate_voxel_visualisation(const ITMUChar4Image_P
     return;
   }
 
+  raycast_voxel_scene(scene, pose, view, renderState);
+  shade_voxel_raycast(output, scene, pose, view, renderState, visualisationType, postprocessor, copyToHost);
+}
+
+void VisualisationGenerator::get_default_raycast(const ITMUChar4Image_Ptr& output, const VoxelRenderState_CPtr& liveRenderState, const boost::optional<Postprocessor>& postprocessor) const
+{
+  make_postprocessed_copy(liveRenderState->raycastImage, postprocessor, output);
+}
+
+void VisualisationGenerator::get_depth_input(const ITMUChar4Image_Ptr& output, const View_CPtr& view) const
+{
+  prepare_to_copy_visualisation(view->depth->noDims, output);
+  if(m_settings->deviceType == ITMLibSettings::DEVICE_CUDA) view->depth->UpdateHostFromDevice();
+  m_voxelVisualisationEngine->DepthToUchar4(output.get(), view->depth);
+}
+
+void VisualisationGenerator::get_rgb_input(const ITMUChar4Image_Ptr& output, const View_CPtr& view) const
+{
+  prepare_to_copy_visualisation(view->rgb->noDims, output);
+  if(m_settings->deviceType == ITMLibSettings::DEVICE_CUDA) view->rgb->UpdateHostFromDevice();
+  output->SetFrom(view->rgb, ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU);
+}
+
+void VisualisationGenerator::raycast_voxel_scene(const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose, const View_CPtr& view,
+                                                 VoxelRenderState_Ptr& renderState, const VoxelRenderState_CPtr& cachedRaycast) const
+{
   if(!renderState) renderState.reset(ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(view->depth->noDims, scene->sceneParams, m_settings->GetMemoryType()));
 
-  const ITMIntrinsics *intrinsics = &view->calib.intrinsics_d;
-  m_voxelVisualisationEngine->FindVisibleBlocks(scene.get(), &pose, intrinsics, renderState.get());
-  m_voxelVisualisationEngine->CreateExpectedDepths(scene.get(), &pose, intrinsics, renderState.get());
+  // If an up-to-date raycast of the scene from the same pose is available, copy its surface points rather than ray marching the scene again.
+  if(cachedRaycast && cachedRaycast->raycastResult->noDims == renderState->raycastResult->noDims)
+  {
+    if(cachedRaycast != renderState)
+    {
+      const bool useCUDA = m_settings->deviceType == ITMLibSettings::DEVICE_CUDA;
+      renderState->raycastResult->SetFrom(cachedRaycast->raycastResult, useCUDA ? ORUtils::MemoryBlock<Vector4f>::CUDA_TO_CUDA : ORUtils::MemoryBlock<Vector4f>::CPU_TO_CPU);
+    }
+    return;
+  }
+
+  const ITMIntrinsics intrinsics = get_raycast_intrinsics(view, renderState.get());
+  m_voxelVisualisationEngine->FindVisibleBlocks(scene.get(), &pose, &intrinsics, renderState.get());
+  m_voxelVisualisationEngine->CreateExpectedDepths(scene.get(), &pose, &intrinsics, renderState.get());
+  m_voxelVisualisationEngine->FindSurface(scene.get(), &pose, &intrinsics, renderState.get());
+}
+
+void VisualisationGenerator::raycast_voxel_scene_stereo(const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& leftPose, const ORUtils::SE3Pose& rightPose, const View_CPtr& view,
+                                                        VoxelRenderState_Ptr& leftRenderState, VoxelRenderState_Ptr& rightRenderState) const
+{
+  if(!leftRenderState) leftRenderState.reset(ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(view->depth->noDims, scene->sceneParams, m_settings->GetMemoryType()));
+  if(!rightRenderState) rightRenderState.reset(ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(view->depth->noDims, scene->sceneParams, m_settings->GetMemoryType()));
+
+  if(leftRenderState->raycastResult->noDims != rightRenderState->raycastResult->noDims)
+  {
+    throw std::invalid_argument("Error: Cannot raycast a stereo pair into render states of different sizes");
+  }
+
+  // Find the visible blocks and expected depth ranges for each eye (these are comparatively cheap), and then march the rays for both eyes in a single pass.
+  const ITMIntrinsics intrinsics = get_raycast_intrinsics(view, leftRenderState.get());
+  m_voxelVisualisationEngine->FindVisibleBlocks(scene.get(), &leftPose, &intrinsics, leftRenderState.get());
+  m_voxelVisualisationEngine->CreateExpectedDepths(scene.get(), &leftPose, &intrinsics, leftRenderState.get());
+  m_voxelVisualisationEngine->FindVisibleBlocks(scene.get(), &rightPose, &intrinsics, rightRenderState.get());
+  m_voxelVisualisationEngine->CreateExpectedDepths(scene.get(), &rightPose, &intrinsics, rightRenderState.get());
+  m_stereoRaycaster->raycast(scene.get(), &leftPose, &rightPose, &intrinsics, leftRenderState.get(), rightRenderState.get());
+}
+
+void VisualisationGenerator::shade_voxel_raycast(const ITMUChar4Image_Ptr& output, const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
+                                                 const View_CPtr& view, const VoxelRenderState_Ptr& renderState, VisualisationType visualisationType,
+                                                 const boost::optional<Postprocessor>& postprocessor, bool copyToHost) const
+{
+  // Note: All of the shading modes read the surface points from the existing raycast, so none of them needs to ray march the scene.
+  const ITMIntrinsics raycastIntrinsics = get_raycast_intrinsics(view, renderState.get());
+  const ITMIntrinsics *intrinsics = &raycastIntrinsics;
+  const IITMVisualisationEngine::RenderRaycastSelection raycastType = IITMVisualisationEngine::RENDER_FROM_OLD_RAYCAST;
 
   switch(visualisationType)
   {
     case VT_SCENE_COLOUR:
     {
       m_voxelVisualisationEngine->RenderImage(scene.get(), &pose, intrinsics, renderState.get(), renderState->raycastImage,
-                                              ITMLib::IITMVisualisationEngine::RENDER_COLOUR_FROM_VOLUME);
+                                              IITMVisualisationEngine::RENDER_COLOUR_FROM_VOLUME, raycastType);
       break;
     }
     case VT_SCENE_NORMAL:
     {
       m_voxelVisualisationEngine->RenderImage(scene.get(), &pose, intrinsics, renderState.get(), renderState->raycastImage,
-                                              ITMLib::IITMVisualisationEngine::RENDER_COLOUR_FROM_NORMAL);
+                                              IITMVisualisationEngine::RENDER_COLOUR_FROM_NORMAL, raycastType);
       break;
     }
     case VT_SCENE_SEMANTICCOLOUR:
@@ -128,12 +222,9 @@ void VisualisationGenerator::generate_voxel_visualisation(const ITMUChar4Image_P
     {
       const std::vector<Vector3u>& labelColours = m_labelManager->get_label_colours();
 
-      LightingType lightingType = LT_LAMBERTIAN;
-      if(visualisationType == VT_SCENE_SEMANTICFLAT) lightingType = LT_FLAT;
-      else if(visualisationType == VT_SCENE_SEMANTICPHONG) lightingType = LT_PHONG;
-
-      float labelAlpha = visualisationType == VT_SCENE_SEMANTICCOLOUR ? 0.4f : 1.0f;
-      m_voxelVisualisationEngine->FindSurface(scene.get(), &pose, intrinsics, renderState.get());
+      LightingType lightingType;
+      float labelAlpha;
+      get_semantic_shading(visualisationType, lightingType, labelAlpha);
       m_semanticVisualiser->render(scene.get(), &pose, intrinsics, renderState.get(), labelColours, lightingType, labelAlpha, renderState->raycastImage);
       break;
     }
@@ -141,62 +232,91 @@ void VisualisationGenerator::generate_voxel_visualisation(const ITMUChar4Image_P
     default:
     {
       m_voxelVisualisationEngine->RenderImage(scene.get(), &pose, intrinsics, renderState.get(), renderState->raycastImage,
-                                              ITMLib::IITMVisualisationEngine::RENDER_SHADED_GREYSCALE);
+                                              IITMVisualisationEngine::RENDER_SHADED_GREYSCALE, raycastType);
       break;
     }
   }
 
-  make_postprocessed_cpu_copy(renderState->raycastImage, postprocessor, output);
+  make_postprocessed_copy(renderState->raycastImage, postprocessor, output, copyToHost);
 }
 
-void VisualisationGenerator::get_default_raycast(const ITMUChar4Image_Ptr& output, const VoxelRenderState_CPtr& liveRenderState, const boost::optional<Postprocessor>& postprocessor) const
+void VisualisationGenerator::shade_voxel_raycast_compact(const ITMUShortImage_Ptr& output, const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose,
+                                                         const VoxelRenderState_CPtr& renderState, VisualisationType visualisationType, bool copyToHost) const
 {
-  make_postprocessed_cpu_copy(liveRenderState->raycastImage, postprocessor, output);
+  if(!supports_compact_semantic_visualisation(visualisationType))
+  {
+    throw std::invalid_argument("Error: A compact semantic visualisation can only be generated for a semantic visualisation type that does not use the scene colours");
+  }
+
+  LightingType lightingType;
+  float labelAlpha;
+  get_semantic_shading(visualisationType, lightingType, labelAlpha);
+  m_semanticVisualiser->render_compact(scene.get(), &pose, renderState.get(), lightingType, output.get());
+
+  if(copyToHost && m_settings->deviceType == ITMLibSettings::DEVICE_CUDA) output->UpdateHostFromDevice();
 }
 
-void VisualisationGenerator::get_depth_input(const ITMUChar4Image_Ptr& output, const View_CPtr& view) const
+void VisualisationGenerator::shade_voxel_raycast_outputs(const SpaintVoxelScene_CPtr& scene, const ORUtils::SE3Pose& pose, const VoxelRenderState_CPtr& renderState,
+                                                         const MultiOutputVisualiser::Outputs& outputs, VisualisationType semanticType,
+                                                         DepthVisualiser::DepthType depthType, float invalidDepthValue, bool copyToHost) const
 {
-  prepare_to_copy_visualisation(view->depth->noDims, output);
-  if(m_settings->deviceType == ITMLibSettings::DEVICE_CUDA) view->depth->UpdateHostFromDevice();
-  m_voxelVisualisationEngine->DepthToUchar4(output.get(), view->depth);
+  if(semanticType != VT_SCENE_SEMANTICCOLOUR && semanticType != VT_SCENE_SEMANTICFLAT && semanticType != VT_SCENE_SEMANTICLAMBERTIAN && semanticType != VT_SCENE_SEMANTICPHONG)
+  {
+    throw std::invalid_argument("Error: The semantic colour output can only be rendered using a semantic visualisation type");
+  }
+
+  LightingType lightingType;
+  float labelAlpha;
+  get_semantic_shading(semanticType, lightingType, labelAlpha);
+
+  m_multiOutputVisualiser->render(
+    scene.get(), &pose, renderState.get(), m_labelManager->get_label_colours(), lightingType, labelAlpha, depthType, invalidDepthValue, outputs
+  );
+
+  if(copyToHost && m_settings->deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+    if(outputs.confidence) outputs.confidence->UpdateHostFromDevice();
+    if(outputs.depth) outputs.depth->UpdateHostFromDevice();
+    if(outputs.labels) outputs.labels->UpdateHostFromDevice();
+    if(outputs.normals) outputs.normals->UpdateHostFromDevice();
+    if(outputs.semanticColour) outputs.semanticColour->UpdateHostFromDevice();
+  }
 }
 
-void VisualisationGenerator::get_rgb_input(const ITMUChar4Image_Ptr& output, const View_CPtr& view) const
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+bool VisualisationGenerator::supports_compact_semantic_visualisation(VisualisationType visualisationType)
 {
-  prepare_to_copy_visualisation(view->rgb->noDims, output);
-  if(m_settings->deviceType == ITMLibSettings::DEVICE_CUDA) view->rgb->UpdateHostFromDevice();
-  output->SetFrom(view->rgb, ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU);
+  // Note: The semantic colour visualisation blends the label colours with the scene colours, so it cannot be deferred to a colour lookup.
+  return visualisationType == VT_SCENE_SEMANTICFLAT || visualisationType == VT_SCENE_SEMANTICLAMBERTIAN || visualisationType == VT_SCENE_SEMANTICPHONG;
 }
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
-void VisualisationGenerator::make_postprocessed_cpu_copy(const ITMUChar4Image *inputRaycast, const boost::optional<Postprocessor>& postprocessor,
-                                                         const ITMUChar4Image_Ptr& outputRaycast) const
+void VisualisationGenerator::make_postprocessed_copy(const ITMUChar4Image *inputRaycast, const boost::optional<Postprocessor>& postprocessor,
+                                                     const ITMUChar4Image_Ptr& outputRaycast, bool copyToHost) const
 {
   // Make sure that the output raycast is of the right size.
   prepare_to_copy_visualisation(inputRaycast->noDims, outputRaycast);
 
+  const bool useCUDA = m_settings->deviceType == ITMLibSettings::DEVICE_CUDA;
+
   if(postprocessor)
   {
-    // Copy the input raycast to the output raycast on the relevant device (e.g. on the GPU, if that's where the input currently resides).
-    outputRaycast->SetFrom(
-      inputRaycast,
-      m_settings->deviceType == ITMLibSettings::DEVICE_CUDA ? ORUtils::MemoryBlock<Vector4u>::CUDA_TO_CUDA : ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU
-    );
-
-    // Post-process the output raycast.
-    (*postprocessor)(outputRaycast, outputRaycast);
+    // Post-process the input raycast directly into the output raycast on the relevant device (e.g. on the GPU, if that's
+    // where the input currently resides). This avoids the need to make an intermediate copy of the input raycast.
+    (*postprocessor)(ITMUChar4Image_CPtr(inputRaycast, boost::serialization::null_deleter()), outputRaycast);
 
     // Transfer the output raycast to the CPU if necessary (if we're in CPU mode, this is a no-op).
-    outputRaycast->UpdateHostFromDevice();
+    if(copyToHost) outputRaycast->UpdateHostFromDevice();
   }
   else
   {
-    // If there is no post-processing to be done, copy the input raycast directly into the CPU memory of the output raycast.
-    outputRaycast->SetFrom(
-      inputRaycast,
-      m_settings->deviceType == ITMLibSettings::DEVICE_CUDA ? ORUtils::MemoryBlock<Vector4u>::CUDA_TO_CPU : ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU
-    );
+    // If there is no post-processing to be done, copy the input raycast directly into the relevant memory of the output raycast
+    // (its CPU memory, if we need the result on the CPU, or otherwise its memory on the device on which the input resides).
+    ORUtils::MemoryBlock<Vector4u>::MemoryCopyDirection direction = ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU;
+    if(useCUDA) direction = copyToHost ? ORUtils::MemoryBlock<Vector4u>::CUDA_TO_CPU : ORUtils::MemoryBlock<Vector4u>::CUDA_TO_CUDA;
+    outputRaycast->SetFrom(inputRaycast, direction);
   }
 }
 
@@ -206,4 +326,32 @@ void VisualisationGenerator::prepare_to_copy_visualisation(const Vector2i& input
   output->ChangeDims(inputSize);
 }
 
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+ITMIntrinsics VisualisationGenerator::get_raycast_intrinsics(const View_CPtr& view, const ITMRenderState *renderState)
+{
+  ITMIntrinsics intrinsics = view->calib.intrinsics_d;
+
+  // If the render state is smaller than the depth images (e.g. because the scene is being rendered at a reduced resolution), scale the intrinsics to match.
+  const Vector2i& depthSize = view->depth->noDims;
+  const Vector2i& raycastSize = renderState->raycastResult->noDims;
+  if(raycastSize != depthSize)
+  {
+    const float sx = static_cast<float>(raycastSize.x) / depthSize.x, sy = static_cast<float>(raycastSize.y) / depthSize.y;
+    const Vector4f& params = intrinsics.projectionParamsSimple.all;
+    intrinsics.projectionParamsSimple.all = Vector4f(params.x * sx, params.y * sy, params.z * sx, params.w * sy);
+  }
+
+  return intrinsics;
+}
+
+void VisualisationGenerator::get_semantic_shading(VisualisationType visualisationType, LightingType& lightingType, float& labelAlpha)
+{
+  lightingType = LT_LAMBERTIAN;
+  if(visualisationType == VT_SCENE_SEMANTICFLAT) lightingType = LT_FLAT;
+  else if(visualisationType == VT_SCENE_SEMANTICPHONG) lightingType = LT_PHONG;
+
+  labelAlpha = visualisationType == VT_SCENE_SEMANTICCOLOUR ? 0.4f : 1.0f;
+}
+
 }
@@ -6,18 +6,49 @@
 #include "visualisation/VisualiserFactory.h"
 using namespace ITMLib;
 
+#include "visualisation/cpu/BlockOccupancyUpdater_CPU.h"
 #include "visualisation/cpu/DepthVisualiser_CPU.h"
+#include "visualisation/cpu/FeatureInspectionVisualiser_CPU.h"
+#include "visualisation/cpu/MultiOutputVisualiser_CPU.h"
+#include "visualisation/cpu/OccupancyGuidedVisualisationEngine_CPU.h"
 #include "visualisation/cpu/SemanticVisualiser_CPU.h"
+#include "visualisation/cpu/StereoRaycaster_CPU.h"
 
 #ifdef WITH_CUDA
+#include "visualisation/cuda/BlockOccupancyUpdater_CUDA.h"
 #include "visualisation/cuda/DepthVisualiser_CUDA.h"
+#include "visualisation/cuda/FeatureInspectionVisualiser_CUDA.h"
+#include "visualisation/cuda/MultiOutputVisualiser_CUDA.h"
+#include "visualisation/cuda/OccupancyGuidedVisualisationEngine_CUDA.h"
 #include "visualisation/cuda/SemanticVisualiser_CUDA.h"
+#include "visualisation/cuda/StereoRaycaster_CUDA.h"
 #endif
 
 namespace spaint {
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
+BlockOccupancyUpdater_CPtr VisualiserFactory::make_block_occupancy_updater(ITMLibSettings::DeviceType deviceType)
+{
+  BlockOccupancyUpdater_CPtr updater;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    updater.reset(new BlockOccupancyUpdater_CUDA);
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    updater.reset(new BlockOccupancyUpdater_CPU);
+  }
+
+  return updater;
+}
+
 DepthVisualiser_CPtr VisualiserFactory::make_depth_visualiser(ITMLibSettings::DeviceType deviceType)
 {
   DepthVisualiser_CPtr visualiser;
@@ -39,6 +70,69 @@ DepthVisualiser_CPtr VisualiserFactory::make_depth_visualiser(ITMLibSettings::De
   return visualiser;
 }
 
+FeatureInspectionVisualiser_CPtr VisualiserFactory::make_feature_inspection_visualiser(ITMLibSettings::DeviceType deviceType)
+{
+  FeatureInspectionVisualiser_CPtr visualiser;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    visualiser.reset(new FeatureInspectionVisualiser_CUDA);
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    visualiser.reset(new FeatureInspectionVisualiser_CPU);
+  }
+
+  return visualiser;
+}
+
+MultiOutputVisualiser_CPtr VisualiserFactory::make_multi_output_visualiser(size_t maxLabelCount, ITMLibSettings::DeviceType deviceType)
+{
+  MultiOutputVisualiser_CPtr visualiser;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    visualiser.reset(new MultiOutputVisualiser_CUDA(maxLabelCount));
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    visualiser.reset(new MultiOutputVisualiser_CPU(maxLabelCount));
+  }
+
+  return visualiser;
+}
+
+VisualiserFactory::VoxelVisualisationEngine_Ptr VisualiserFactory::make_occupancy_guided_visualisation_engine(ITMLibSettings::DeviceType deviceType)
+{
+  VoxelVisualisationEngine_Ptr visualisationEngine;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    visualisationEngine.reset(new OccupancyGuidedVisualisationEngine_CUDA);
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    visualisationEngine.reset(new OccupancyGuidedVisualisationEngine_CPU);
+  }
+
+  return visualisationEngine;
+}
+
 SemanticVisualiser_CPtr VisualiserFactory::make_semantic_visualiser(size_t maxLabelCount, ITMLibSettings::DeviceType deviceType)
 {
   SemanticVisualiser_CPtr visualiser;
@@ -60,4 +154,25 @@ SemanticVisualiser_CPtr VisualiserFactory::make_semantic_visualiser(size_t maxLa
   return visualiser;
 }
 
+StereoRaycaster_CPtr VisualiserFactory::make_stereo_raycaster(ITMLibSettings::DeviceType deviceType)
+{
+  StereoRaycaster_CPtr raycaster;
+
+  if(deviceType == ITMLibSettings::DEVICE_CUDA)
+  {
+#ifdef WITH_CUDA
+    raycaster.reset(new StereoRaycaster_CUDA);
+#else
+    // This should never happen as things stand - we set deviceType to DEVICE_CPU if CUDA support isn't available.
+    throw std::runtime_error("Error: CUDA support not currently available. Reconfigure in CMake with the WITH_CUDA option set to on.");
+#endif
+  }
+  else
+  {
+    raycaster.reset(new StereoRaycaster_CPU);
+  }
+
+  return raycaster;
+}
+
 }
@@ -0,0 +1,41 @@
+/**
+ * spaint: BlockOccupancyUpdater_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cpu/BlockOccupancyUpdater_CPU.h"
+
+#include "visualisation/shared/BlockOccupancy_Shared.h"
+
+namespace spaint {
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void BlockOccupancyUpdater_CPU::update_entries(const int *entryIDs, int entryCount, SpaintVoxelScene *scene) const
+{
+  const ITMHashEntry *hashTable = scene->index.GetEntries();
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  SpaintVoxelScene::BlockOccupancy *blockOccupancy = scene->get_block_occupancy_data();
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < entryCount; ++i)
+  {
+    const int entryID = entryIDs[i];
+    const ITMHashEntry& hashEntry = hashTable[entryID];
+    if(hashEntry.ptr < 0) continue;
+
+    // The block contains only empty space iff every one of its voxels does.
+    const SpaintVoxel *blockVoxels = voxelData + hashEntry.ptr * SDF_BLOCK_SIZE3;
+    bool empty = true;
+    for(int j = 0; j < SDF_BLOCK_SIZE3 && empty; ++j)
+    {
+      empty = is_empty_voxel(blockVoxels[j]);
+    }
+
+    write_block_occupancy(entryID, hashEntry, empty, blockOccupancy);
+  }
+}
+
+}
@@ -5,7 +5,8 @@
 
 #include "visualisation/cpu/DepthVisualiser_CPU.h"
 
-#include "visualisation/shared/DepthVisualiser_Shared.h"
+#include <algorithm>
+#include <cmath>
 
 namespace spaint {
 
@@ -14,17 +15,46 @@ namespace spaint {
 void DepthVisualiser_CPU::render_depth(DepthType depthType, const Vector3f& cameraPosition, const Vector3f& cameraLookVector, const ITMLib::ITMRenderState *renderState,
                                        float voxelSize, float invalidDepthValue, const ITMFloatImage_Ptr& outputImage) const
 {
-  int imgSize = outputImage->noDims.x * outputImage->noDims.y;
+  const int imgSize = outputImage->noDims.x * outputImage->noDims.y;
   float *outRendering = outputImage->GetData(MEMORYDEVICE_CPU);
   const Vector4f *pointsRay = renderState->raycastResult->GetData(MEMORYDEVICE_CPU);
 
+  // Note: Unlike the semantic visualiser, shading a pixel here does not require any voxel lookups, so there is nothing
+  //       to gain from tiling. Instead, we hoist the depth type switch and the per-image constants out of the pixel
+  //       loops, so that each loop is a straight-line computation over the raycast result that can be vectorised.
+  if(depthType == DT_EUCLIDEAN)
+  {
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+    #pragma omp parallel for
 #endif
-  for(int locId = 0; locId < imgSize; ++locId)
+    for(int locId = 0; locId < imgSize; ++locId)
+    {
+      const Vector4f ptRay = pointsRay[locId];
+      const float dx = ptRay.x * voxelSize - cameraPosition.x, dy = ptRay.y * voxelSize - cameraPosition.y, dz = ptRay.z * voxelSize - cameraPosition.z;
+      const float depth = sqrt(dx * dx + dy * dy + dz * dz);
+      outRendering[locId] = ptRay.w > 0 ? depth : invalidDepthValue;
+    }
+  }
+  else if(depthType == DT_ORTHOGRAPHIC)
+  {
+    // Note: The orthographic depth of a point p is (p - c) . l = (voxelSize * v) . l - c . l, where v is the point in voxel coordinates.
+    const Vector3f scaledLookVector = cameraLookVector * voxelSize;
+    const float cameraOffset = ORUtils::dot(cameraPosition, cameraLookVector);
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int locId = 0; locId < imgSize; ++locId)
+    {
+      const Vector4f ptRay = pointsRay[locId];
+      const float depth = ptRay.x * scaledLookVector.x + ptRay.y * scaledLookVector.y + ptRay.z * scaledLookVector.z - cameraOffset;
+      outRendering[locId] = ptRay.w > 0 ? depth : invalidDepthValue;
+    }
+  }
+  else
   {
-    Vector4f ptRay = pointsRay[locId];
-    shade_pixel_depth(outRendering[locId], ptRay.toVector3() * voxelSize, ptRay.w > 0, cameraPosition, cameraLookVector, voxelSize, invalidDepthValue, depthType);
+    // Any other depth type produces invalid depths everywhere (as in shade_pixel_depth).
+    std::fill(outRendering, outRendering + imgSize, invalidDepthValue);
   }
 }
 
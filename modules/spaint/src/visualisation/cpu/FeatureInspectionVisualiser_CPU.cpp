@@ -0,0 +1,26 @@
+/**
+ * spaint: FeatureInspectionVisualiser_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cpu/FeatureInspectionVisualiser_CPU.h"
+
+#include "visualisation/shared/FeatureInspectionVisualiser_Shared.h"
+
+namespace spaint {
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void FeatureInspectionVisualiser_CPU::render_patch(const ORUtils::MemoryBlock<float>& featuresMB, const ITMUChar4Image_Ptr& outputImage) const
+{
+  const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  Vector4u *outRendering = outputImage->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = outputImage->noDims.x * outputImage->noDims.y;
+
+  for(int pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex)
+  {
+    write_feature_inspection_pixel(pixelIndex, features, outRendering);
+  }
+}
+
+}
@@ -0,0 +1,77 @@
+/**
+ * spaint: MultiOutputVisualiser_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cpu/MultiOutputVisualiser_CPU.h"
+
+#include <algorithm>
+
+#include "visualisation/shared/MultiOutputVisualiser_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+MultiOutputVisualiser_CPU::MultiOutputVisualiser_CPU(size_t maxLabelCount)
+: MultiOutputVisualiser(maxLabelCount)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MultiOutputVisualiser_CPU::render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState, LightingType lightingType,
+                                                float labelAlpha, DepthVisualiser::DepthType depthType, float invalidDepthValue, const Outputs& outputs) const
+{
+  // Calculate the camera, light and viewer positions and the camera look vector. Note that the light and viewer positions
+  // are in voxel coordinates (the same coordinate space as the raycast results), whereas the camera position is in world space.
+  const float voxelSize = scene->sceneParams->voxelSize;
+  const Matrix4f invM = pose->GetInvM();
+  const Vector3f cameraPosition(invM.getColumn(3));
+  const Vector3f cameraLookVector(invM.getColumn(2));
+  const Vector3f lightPos = Vector3f(0.0f, -10.0f, -10.0f) / voxelSize;
+  const Vector3f viewerPos = cameraPosition / voxelSize;
+  const float maxW = static_cast<float>(scene->sceneParams->maxW);
+
+  const int width = renderState->raycastResult->noDims.x, height = renderState->raycastResult->noDims.y;
+  const Vector4f *pointsRay = renderState->raycastResult->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const ITMVoxelIndex::IndexData *voxelIndex = scene->index.getIndexData();
+  const Vector3u *labelColours = m_labelColoursMB->GetData(MEMORYDEVICE_CPU);
+
+  float *confidences = outputs.confidence ? outputs.confidence->GetData(MEMORYDEVICE_CPU) : NULL;
+  float *depths = outputs.depth ? outputs.depth->GetData(MEMORYDEVICE_CPU) : NULL;
+  SpaintVoxel::Label *labels = outputs.labels ? outputs.labels->GetData(MEMORYDEVICE_CPU) : NULL;
+  Vector4f *normals = outputs.normals ? outputs.normals->GetData(MEMORYDEVICE_CPU) : NULL;
+  Vector4u *semanticColours = outputs.semanticColour ? outputs.semanticColour->GetData(MEMORYDEVICE_CPU) : NULL;
+
+  // Shade the image in square tiles, sharing an index cache within each tile (see SemanticVisualiser_CPU).
+  const int tileSize = 16;
+  const int tilesX = (width + tileSize - 1) / tileSize, tilesY = (height + tileSize - 1) / tileSize;
+  const int tileCount = tilesX * tilesY;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+  {
+    const int xBegin = (tileIdx % tilesX) * tileSize, xEnd = std::min(xBegin + tileSize, width);
+    const int yBegin = (tileIdx / tilesX) * tileSize, yEnd = std::min(yBegin + tileSize, height);
+
+    ITMVoxelIndex::IndexCache cache;
+    for(int y = yBegin; y < yEnd; ++y)
+    {
+      for(int x = xBegin; x < xEnd; ++x)
+      {
+        const int locId = y * width + x;
+        shade_pixel_multi(
+          locId, pointsRay[locId], voxelData, labelData, voxelIndex, labelColours, viewerPos, lightPos, lightingType, labelAlpha,
+          cameraPosition, cameraLookVector, voxelSize, invalidDepthValue, depthType, maxW,
+          confidences, depths, labels, normals, semanticColours, cache
+        );
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,79 @@
+/**
+ * spaint: OccupancyGuidedVisualisationEngine_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cpu/OccupancyGuidedVisualisationEngine_CPU.h"
+using namespace ITMLib;
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+
+#include "visualisation/shared/BlockOccupancy_Shared.h"
+#include "visualisation/shared/RaycastRegion_Shared.h"
+
+namespace spaint {
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void OccupancyGuidedVisualisationEngine_CPU::CreateExpectedDepths(const ITMScene<SpaintVoxel,ITMVoxelIndex> *scene, const ORUtils::SE3Pose *pose,
+                                                                  const ITMIntrinsics *intrinsics, ITMRenderState *renderState) const
+{
+  // Note: All of the voxel scenes in spaint are SpaintVoxelScenes, so the downcast is safe.
+  const SpaintVoxelScene *spaintScene = static_cast<const SpaintVoxelScene*>(scene);
+  const SpaintVoxelScene::BlockOccupancy *blockOccupancy = spaintScene->get_block_occupancy_data();
+  const ITMRenderState_VH *renderStateVH = dynamic_cast<const ITMRenderState_VH*>(renderState);
+  const Vector2i imgSize = renderState->renderingRangeImage->noDims;
+  Vector2f *ranges = renderState->renderingRangeImage->GetData(MEMORYDEVICE_CPU);
+
+  // If the scene is recording its block occupancy, use it to compute the depth ranges. If not, fall back to InfiniTAM's implementation.
+  if(blockOccupancy && renderStateVH)
+  {
+    // Initialise the depth ranges to be empty.
+    for(int i = 0, pixelCount = imgSize.x * imgSize.y; i < pixelCount; ++i)
+    {
+      ranges[i] = Vector2f(FAR_AWAY, VERY_CLOSE);
+    }
+
+    // Project each visible voxel block that is not known to be empty into the range image, and expand the depth ranges it covers to include its own.
+    const ITMHashEntry *hashTable = scene->index.GetEntries();
+    const Matrix4f M = pose->GetM();
+    const Vector4f projParams = intrinsics->projectionParamsSimple.all;
+    const int *visibleEntryIDs = renderStateVH->GetVisibleEntityIDs();
+    const float voxelSize = scene->sceneParams->voxelSize;
+
+    for(int i = 0; i < renderStateVH->noVisibleEntities; ++i)
+    {
+      Vector2i upperLeft, lowerRight;
+      Vector2f zRange;
+      if(!project_occupied_block(visibleEntryIDs[i], hashTable, blockOccupancy, M, projParams, imgSize, voxelSize, upperLeft, lowerRight, zRange)) continue;
+
+      for(int y = upperLeft.y; y <= lowerRight.y; ++y)
+      {
+        for(int x = upperLeft.x; x <= lowerRight.x; ++x)
+        {
+          Vector2f& range = ranges[y * imgSize.x + x];
+          if(zRange.x < range.x) range.x = zRange.x;
+          if(zRange.y > range.y) range.y = zRange.y;
+        }
+      }
+    }
+  }
+  else Base::CreateExpectedDepths(scene, pose, intrinsics, renderState);
+
+  // If the raycasts into this render state are limited to a region, empty the depth ranges of the pixels outside it,
+  // so that no rays are marched for them.
+  const boost::optional<Vector4i> region = spaintScene->get_raycast_region(renderState);
+  if(region)
+  {
+    const Vector4i rangeRegion = scale_region_to_range_image(*region, renderState->raycastResult->noDims, imgSize);
+    for(int y = 0; y < imgSize.y; ++y)
+    {
+      for(int x = 0; x < imgSize.x; ++x)
+      {
+        clear_range_outside_region(x, y, rangeRegion, imgSize, ranges);
+      }
+    }
+  }
+}
+
+}
@@ -5,6 +5,8 @@
 
 #include "visualisation/cpu/SemanticVisualiser_CPU.h"
 
+#include <algorithm>
+
 #include "visualisation/shared/SemanticVisualiser_Shared.h"
 
 namespace spaint {
@@ -17,6 +19,49 @@ SemanticVisualiser_CPU::SemanticVisualiser_CPU(size_t maxLabelCount)
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+void SemanticVisualiser_CPU::render_compact_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState,
+                                                     LightingType lightingType, ITMUShortImage *outputImage) const
+{
+  // Calculate the light and viewer positions in voxel coordinates (the same coordinate space as the raycast results).
+  const float voxelSize = scene->sceneParams->voxelSize;
+  Vector3f lightPos = Vector3f(0.0f, -10.0f, -10.0f) / voxelSize;
+  Vector3f viewerPos = Vector3f(pose->GetInvM().getColumn(3)) / voxelSize;
+
+  // Shade all of the pixels in the image, sharing an index cache within each square tile (see render_internal).
+  const int width = outputImage->noDims.x, height = outputImage->noDims.y;
+  ushort *outRendering = outputImage->GetData(MEMORYDEVICE_CPU);
+  const Vector4f *pointsRay = renderState->raycastResult->GetData(MEMORYDEVICE_CPU);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
+  const ITMVoxelIndex::IndexData *voxelIndex = scene->index.getIndexData();
+
+  const int tileSize = 16;
+  const int tilesX = (width + tileSize - 1) / tileSize, tilesY = (height + tileSize - 1) / tileSize;
+  const int tileCount = tilesX * tilesY;
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+  {
+    const int xBegin = (tileIdx % tilesX) * tileSize, xEnd = std::min(xBegin + tileSize, width);
+    const int yBegin = (tileIdx / tilesX) * tileSize, yEnd = std::min(yBegin + tileSize, height);
+
+    ITMVoxelIndex::IndexCache cache;
+    for(int y = yBegin; y < yEnd; ++y)
+    {
+      for(int x = xBegin; x < xEnd; ++x)
+      {
+        const int locId = y * width + x;
+        const Vector4f ptRay = pointsRay[locId];
+        shade_pixel_semantic_compact(
+          outRendering[locId], ptRay.toVector3(), ptRay.w > 0, voxelData, labelData, voxelIndex, viewerPos, lightPos, lightingType, cache
+        );
+      }
+    }
+  }
+}
+
 void SemanticVisualiser_CPU::render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMIntrinsics *intrinsics, const ITMLib::ITMRenderState *renderState,
                                              LightingType lightingType, float labelAlpha, ITMUChar4Image *outputImage) const
 {
@@ -25,21 +70,41 @@ void SemanticVisualiser_CPU::render_internal(const SpaintVoxelScene *scene, cons
   Vector3f lightPos = Vector3f(0.0f, -10.0f, -10.0f) / voxelSize;
   Vector3f viewerPos = Vector3f(pose->GetInvM().getColumn(3)) / voxelSize;
 
-  // Shade all of the pixels in the image.
-  int imgSize = outputImage->noDims.x * outputImage->noDims.y;
+  // Shade all of the pixels in the image. To avoid repeating the hash table lookups for neighbouring pixels, which
+  // generally hit the same voxel blocks, we divide the image into square tiles and share an index cache within each tile.
+  const int width = outputImage->noDims.x, height = outputImage->noDims.y;
   Vector4u *outRendering = outputImage->GetData(MEMORYDEVICE_CPU);
   const Vector4f *pointsRay = renderState->raycastResult->GetData(MEMORYDEVICE_CPU);
   const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const SpaintVoxel::PackedLabel *labelData = scene->get_label_data();
   const ITMVoxelIndex::IndexData *voxelIndex = scene->index.getIndexData();
   const Vector3u *labelColours = m_labelColoursMB->GetData(MEMORYDEVICE_CPU);
 
+  const int tileSize = 16;
+  const int tilesX = (width + tileSize - 1) / tileSize, tilesY = (height + tileSize - 1) / tileSize;
+  const int tileCount = tilesX * tilesY;
+
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(dynamic)
 #endif
-  for (int locId = 0; locId < imgSize; ++locId)
+  for(int tileIdx = 0; tileIdx < tileCount; ++tileIdx)
   {
-    Vector4f ptRay = pointsRay[locId];
-    shade_pixel_semantic(outRendering[locId], ptRay.toVector3(), ptRay.w > 0, voxelData, voxelIndex, labelColours, viewerPos, lightPos, lightingType, labelAlpha);
+    const int xBegin = (tileIdx % tilesX) * tileSize, xEnd = std::min(xBegin + tileSize, width);
+    const int yBegin = (tileIdx / tilesX) * tileSize, yEnd = std::min(yBegin + tileSize, height);
+
+    ITMVoxelIndex::IndexCache cache;
+    for(int y = yBegin; y < yEnd; ++y)
+    {
+      for(int x = xBegin; x < xEnd; ++x)
+      {
+        const int locId = y * width + x;
+        const Vector4f ptRay = pointsRay[locId];
+        shade_pixel_semantic(
+          outRendering[locId], ptRay.toVector3(), ptRay.w > 0, voxelData, labelData, voxelIndex,
+          labelColours, viewerPos, lightPos, lightingType, labelAlpha, cache
+        );
+      }
+    }
   }
 }
 
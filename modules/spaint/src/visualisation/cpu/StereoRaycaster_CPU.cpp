@@ -0,0 +1,45 @@
+/**
+ * spaint: StereoRaycaster_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cpu/StereoRaycaster_CPU.h"
+
+#include "visualisation/shared/StereoRaycaster_Shared.h"
+
+namespace spaint {
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void StereoRaycaster_CPU::raycast(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *leftPose, const ORUtils::SE3Pose *rightPose, const ITMLib::ITMIntrinsics *intrinsics,
+                                  ITMLib::ITMRenderState *leftRenderState, ITMLib::ITMRenderState *rightRenderState) const
+{
+  const Vector2i imgSize = leftRenderState->raycastResult->noDims;
+  const int rangeWidth = leftRenderState->renderingRangeImage->noDims.x;
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const Matrix4f leftInvM = leftPose->GetInvM(), rightInvM = rightPose->GetInvM();
+  const Vector4f invProjParams = InvertProjectionParams(intrinsics->projectionParamsSimple.all);
+  const float oneOverVoxelSize = 1.0f / scene->sceneParams->voxelSize;
+  const float mu = scene->sceneParams->mu;
+  const Vector2f *leftRanges = leftRenderState->renderingRangeImage->GetData(MEMORYDEVICE_CPU);
+  const Vector2f *rightRanges = rightRenderState->renderingRangeImage->GetData(MEMORYDEVICE_CPU);
+  Vector4f *leftPtsRay = leftRenderState->raycastResult->GetData(MEMORYDEVICE_CPU);
+  Vector4f *rightPtsRay = rightRenderState->raycastResult->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = 0; y < imgSize.y; ++y)
+  {
+    for(int x = 0; x < imgSize.x; ++x)
+    {
+      raycast_stereo_pixel(
+        x, y, imgSize.x, rangeWidth, voxelData, indexData, leftInvM, rightInvM, invProjParams,
+        oneOverVoxelSize, mu, leftRanges, rightRanges, leftPtsRay, rightPtsRay
+      );
+    }
+  }
+}
+
+}
@@ -0,0 +1,49 @@
+/**
+ * spaint: BlockOccupancyUpdater_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cuda/BlockOccupancyUpdater_CUDA.h"
+
+#include "visualisation/shared/BlockOccupancy_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_update_block_occupancy(const int *entryIDs, const ITMHashEntry *hashTable, const SpaintVoxel *voxelData, SpaintVoxelScene::BlockOccupancy *blockOccupancy)
+{
+  __shared__ bool empty;
+
+  // Note: Each thread block examines a single voxel block, so this early out is taken either by all of its threads or by none of them.
+  const int entryID = entryIDs[blockIdx.x];
+  const ITMHashEntry& hashEntry = hashTable[entryID];
+  if(hashEntry.ptr < 0) return;
+
+  const int linearIdx = threadIdx.x + (threadIdx.y + threadIdx.z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+  if(linearIdx == 0) empty = true;
+  __syncthreads();
+
+  // The block contains only empty space iff every one of its voxels does.
+  if(!is_empty_voxel(voxelData[hashEntry.ptr * SDF_BLOCK_SIZE3 + linearIdx])) empty = false;
+  __syncthreads();
+
+  if(linearIdx == 0) write_block_occupancy(entryID, hashEntry, empty, blockOccupancy);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void BlockOccupancyUpdater_CUDA::update_entries(const int *entryIDs, int entryCount, SpaintVoxelScene *scene) const
+{
+  dim3 cudaBlockSize(SDF_BLOCK_SIZE, SDF_BLOCK_SIZE, SDF_BLOCK_SIZE);
+  dim3 gridSize(entryCount);
+
+  ck_update_block_occupancy<<<gridSize,cudaBlockSize>>>(
+    entryIDs,
+    scene->index.GetEntries(),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_block_occupancy_data()
+  );
+}
+
+}
@@ -0,0 +1,35 @@
+/**
+ * spaint: FeatureInspectionVisualiser_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cuda/FeatureInspectionVisualiser_CUDA.h"
+
+#include "visualisation/shared/FeatureInspectionVisualiser_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_render_patch(const float *features, int pixelCount, Vector4u *outRendering)
+{
+  int pixelIndex = blockIdx.x * blockDim.x + threadIdx.x;
+  if(pixelIndex < pixelCount) write_feature_inspection_pixel(pixelIndex, features, outRendering);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void FeatureInspectionVisualiser_CUDA::render_patch(const ORUtils::MemoryBlock<float>& featuresMB, const ITMUChar4Image_Ptr& outputImage) const
+{
+  const int pixelCount = outputImage->noDims.x * outputImage->noDims.y;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+  ck_render_patch<<<numBlocks,threadsPerBlock>>>(
+    featuresMB.GetData(MEMORYDEVICE_CUDA),
+    pixelCount,
+    outputImage->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,82 @@
+/**
+ * spaint: MultiOutputVisualiser_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cuda/MultiOutputVisualiser_CUDA.h"
+
+#include "visualisation/shared/MultiOutputVisualiser_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_render_multi(const Vector4f *ptsRay, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData, const ITMVoxelIndex::IndexData *voxelIndex,
+                                Vector2i imgSize, const Vector3u *labelColours, Vector3f viewerPos, Vector3f lightPos, LightingType lightingType, float labelAlpha,
+                                Vector3f cameraPosition, Vector3f cameraLookVector, float voxelSize, float invalidDepthValue, DepthVisualiser::DepthType depthType,
+                                float maxW, float *confidences, float *depths, SpaintVoxel::Label *labels, Vector4f *normals, Vector4u *semanticColours)
+{
+  int x = blockIdx.x * blockDim.x + threadIdx.x, y = blockIdx.y * blockDim.y + threadIdx.y;
+  if(x >= imgSize.x || y >= imgSize.y) return;
+
+  int locId = y * imgSize.x + x;
+  ITMVoxelIndex::IndexCache cache;
+  shade_pixel_multi(
+    locId, ptsRay[locId], voxelData, labelData, voxelIndex, labelColours, viewerPos, lightPos, lightingType, labelAlpha,
+    cameraPosition, cameraLookVector, voxelSize, invalidDepthValue, depthType, maxW,
+    confidences, depths, labels, normals, semanticColours, cache
+  );
+}
+
+//#################### CONSTRUCTORS ####################
+
+MultiOutputVisualiser_CUDA::MultiOutputVisualiser_CUDA(size_t maxLabelCount)
+: MultiOutputVisualiser(maxLabelCount)
+{}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MultiOutputVisualiser_CUDA::render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState, LightingType lightingType,
+                                                 float labelAlpha, DepthVisualiser::DepthType depthType, float invalidDepthValue, const Outputs& outputs) const
+{
+  // Calculate the camera, light and viewer positions and the camera look vector. Note that the light and viewer positions
+  // are in voxel coordinates (the same coordinate space as the raycast results), whereas the camera position is in world space.
+  const float voxelSize = scene->sceneParams->voxelSize;
+  const Matrix4f invM = pose->GetInvM();
+  const Vector3f cameraPosition(invM.getColumn(3));
+  const Vector3f cameraLookVector(invM.getColumn(2));
+  const Vector3f lightPos = Vector3f(0.0f, -10.0f, -10.0f) / voxelSize;
+  const Vector3f viewerPos = cameraPosition / voxelSize;
+
+  // Shade all of the pixels in the image, writing all of the requested outputs at once.
+  Vector2i imgSize = renderState->raycastResult->noDims;
+
+  dim3 cudaBlockSize(8, 8);
+  dim3 gridSize((int)ceil((float)imgSize.x / (float)cudaBlockSize.x), (int)ceil((float)imgSize.y / (float)cudaBlockSize.y));
+
+  ck_render_multi<<<gridSize,cudaBlockSize>>>(
+    renderState->raycastResult->GetData(MEMORYDEVICE_CUDA),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->index.getIndexData(),
+    imgSize,
+    m_labelColoursMB->GetData(MEMORYDEVICE_CUDA),
+    viewerPos,
+    lightPos,
+    lightingType,
+    labelAlpha,
+    cameraPosition,
+    cameraLookVector,
+    voxelSize,
+    invalidDepthValue,
+    depthType,
+    static_cast<float>(scene->sceneParams->maxW),
+    outputs.confidence ? outputs.confidence->GetData(MEMORYDEVICE_CUDA) : NULL,
+    outputs.depth ? outputs.depth->GetData(MEMORYDEVICE_CUDA) : NULL,
+    outputs.labels ? outputs.labels->GetData(MEMORYDEVICE_CUDA) : NULL,
+    outputs.normals ? outputs.normals->GetData(MEMORYDEVICE_CUDA) : NULL,
+    outputs.semanticColour ? outputs.semanticColour->GetData(MEMORYDEVICE_CUDA) : NULL
+  );
+}
+
+}
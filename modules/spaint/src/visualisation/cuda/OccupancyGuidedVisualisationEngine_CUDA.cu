@@ -0,0 +1,189 @@
+/**
+ * spaint: OccupancyGuidedVisualisationEngine_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cuda/OccupancyGuidedVisualisationEngine_CUDA.h"
+using namespace ITMLib;
+
+#include <algorithm>
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+#include "visualisation/shared/BlockOccupancy_Shared.h"
+#include "visualisation/shared/RaycastRegion_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA DEVICE FUNCTIONS ####################
+
+__device__ void atomic_max_float(float *address, float value)
+{
+  int *intAddress = reinterpret_cast<int*>(address);
+  int old = *intAddress, assumed;
+  while(__int_as_float(old) < value)
+  {
+    assumed = old;
+    old = atomicCAS(intAddress, assumed, __float_as_int(value));
+    if(old == assumed) break;
+  }
+}
+
+__device__ void atomic_min_float(float *address, float value)
+{
+  int *intAddress = reinterpret_cast<int*>(address);
+  int old = *intAddress, assumed;
+  while(__int_as_float(old) > value)
+  {
+    assumed = old;
+    old = atomicCAS(intAddress, assumed, __float_as_int(value));
+    if(old == assumed) break;
+  }
+}
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_clear_ranges_outside_region(Vector4i region, Vector2i imgSize, Vector2f *ranges)
+{
+  int x = threadIdx.x + blockIdx.x * blockDim.x, y = threadIdx.y + blockIdx.y * blockDim.y;
+  if(x < imgSize.x && y < imgSize.y) clear_range_outside_region(x, y, region, imgSize, ranges);
+}
+
+__global__ void ck_fill_ranges(unsigned int renderingBlockCount, const RenderingBlock *renderingBlocks, Vector2i imgSize, Vector2f *ranges)
+{
+  // Note: Each thread block handles a single rendering block, with one thread per pixel.
+  const unsigned int blockIdx1D = blockIdx.x * gridDim.y + blockIdx.y;
+  if(blockIdx1D >= renderingBlockCount) return;
+
+  const RenderingBlock& b = renderingBlocks[blockIdx1D];
+  const int x = b.upperLeft.x + threadIdx.x, y = b.upperLeft.y + threadIdx.y;
+  if(x > b.lowerRight.x || y > b.lowerRight.y) return;
+
+  Vector2f& range = ranges[y * imgSize.x + x];
+  atomic_min_float(&range.x, b.zRange.x);
+  atomic_max_float(&range.y, b.zRange.y);
+}
+
+__global__ void ck_initialise_ranges(int pixelCount, Vector2f *ranges)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i < pixelCount) ranges[i] = Vector2f(FAR_AWAY, VERY_CLOSE);
+}
+
+__global__ void ck_project_occupied_blocks(const int *visibleEntryIDs, int visibleEntryCount, const ITMHashEntry *hashTable,
+                                           const SpaintVoxelScene::BlockOccupancy *blockOccupancy, Matrix4f M, Vector4f projParams,
+                                           Vector2i imgSize, float voxelSize, RenderingBlock *renderingBlocks, unsigned int *renderingBlockCount)
+{
+  int i = threadIdx.x + blockDim.x * blockIdx.x;
+  if(i >= visibleEntryCount) return;
+
+  Vector2i upperLeft, lowerRight;
+  Vector2f zRange;
+  if(!project_occupied_block(visibleEntryIDs[i], hashTable, blockOccupancy, M, projParams, imgSize, voxelSize, upperLeft, lowerRight, zRange)) return;
+
+  // Split the block's bounding box into rendering blocks, dropping it if there is no more space for them (as InfiniTAM does).
+  const unsigned int requiredRenderingBlockCount = ((lowerRight.x - upperLeft.x + renderingBlockSizeX) / renderingBlockSizeX) *
+                                                   ((lowerRight.y - upperLeft.y + renderingBlockSizeY) / renderingBlockSizeY);
+  const unsigned int offset = atomicAdd(renderingBlockCount, requiredRenderingBlockCount);
+  if(offset + requiredRenderingBlockCount > static_cast<unsigned int>(MAX_RENDERING_BLOCKS))
+  {
+    // Make sure that any slots we reserved at the end of the list are ignored when the depth ranges are filled in.
+    for(unsigned int j = offset; j < static_cast<unsigned int>(MAX_RENDERING_BLOCKS); ++j)
+    {
+      renderingBlocks[j].upperLeft = Vector2s(1, 1);
+      renderingBlocks[j].lowerRight = Vector2s(0, 0);
+    }
+    return;
+  }
+
+  CreateRenderingBlocks(renderingBlocks, offset, upperLeft, lowerRight, zRange);
+}
+
+//#################### CONSTRUCTORS ####################
+
+OccupancyGuidedVisualisationEngine_CUDA::OccupancyGuidedVisualisationEngine_CUDA()
+{
+  MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  m_renderingBlockCountMB = mbf.make_block<unsigned int>(1, "OccupancyGuidedVisualisationEngine");
+  m_renderingBlocksMB = mbf.make_block<RenderingBlock>(MAX_RENDERING_BLOCKS, "OccupancyGuidedVisualisationEngine");
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void OccupancyGuidedVisualisationEngine_CUDA::CreateExpectedDepths(const ITMScene<SpaintVoxel,ITMVoxelIndex> *scene, const ORUtils::SE3Pose *pose,
+                                                                   const ITMIntrinsics *intrinsics, ITMRenderState *renderState) const
+{
+  // Note: All of the voxel scenes in spaint are SpaintVoxelScenes, so the downcast is safe.
+  const SpaintVoxelScene *spaintScene = static_cast<const SpaintVoxelScene*>(scene);
+  const SpaintVoxelScene::BlockOccupancy *blockOccupancy = spaintScene->get_block_occupancy_data();
+  const ITMRenderState_VH *renderStateVH = dynamic_cast<const ITMRenderState_VH*>(renderState);
+  const Vector2i imgSize = renderState->renderingRangeImage->noDims;
+  Vector2f *ranges = renderState->renderingRangeImage->GetData(MEMORYDEVICE_CUDA);
+
+  // If the scene is recording its block occupancy, use it to compute the depth ranges. If not, fall back to InfiniTAM's implementation.
+  if(blockOccupancy && renderStateVH) create_occupancy_guided_depths(scene, blockOccupancy, pose, intrinsics, renderStateVH, ranges);
+  else Base::CreateExpectedDepths(scene, pose, intrinsics, renderState);
+
+  // If the raycasts into this render state are limited to a region, empty the depth ranges of the pixels outside it,
+  // so that no rays are marched for them.
+  const boost::optional<Vector4i> region = spaintScene->get_raycast_region(renderState);
+  if(region)
+  {
+    const Vector4i rangeRegion = scale_region_to_range_image(*region, renderState->raycastResult->noDims, imgSize);
+    dim3 cudaBlockSize(16, 16);
+    dim3 gridSize((imgSize.x + cudaBlockSize.x - 1) / cudaBlockSize.x, (imgSize.y + cudaBlockSize.y - 1) / cudaBlockSize.y);
+    ck_clear_ranges_outside_region<<<gridSize,cudaBlockSize>>>(rangeRegion, imgSize, ranges);
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void OccupancyGuidedVisualisationEngine_CUDA::create_occupancy_guided_depths(const ITMScene<SpaintVoxel,ITMVoxelIndex> *scene,
+                                                                             const SpaintVoxelScene::BlockOccupancy *blockOccupancy,
+                                                                             const ORUtils::SE3Pose *pose, const ITMIntrinsics *intrinsics,
+                                                                             const ITMRenderState_VH *renderState, Vector2f *ranges) const
+{
+  // Initialise the depth ranges to be empty.
+  const Vector2i imgSize = renderState->renderingRangeImage->noDims;
+  const int pixelCount = imgSize.x * imgSize.y;
+
+  int threadsPerBlock = 256;
+  int numBlocks = (pixelCount + threadsPerBlock - 1) / threadsPerBlock;
+  ck_initialise_ranges<<<numBlocks,threadsPerBlock>>>(pixelCount, ranges);
+
+  // If no voxel blocks are visible, early out.
+  const int visibleEntryCount = renderState->noVisibleEntities;
+  if(visibleEntryCount == 0) return;
+
+  // Project each visible voxel block that is not known to be empty into the range image, and split its bounding box into rendering blocks.
+  m_renderingBlockCountMB->Clear();
+
+  numBlocks = (visibleEntryCount + threadsPerBlock - 1) / threadsPerBlock;
+  ck_project_occupied_blocks<<<numBlocks,threadsPerBlock>>>(
+    renderState->GetVisibleEntityIDs(),
+    visibleEntryCount,
+    scene->index.GetEntries(),
+    blockOccupancy,
+    pose->GetM(),
+    intrinsics->projectionParamsSimple.all,
+    imgSize,
+    scene->sceneParams->voxelSize,
+    m_renderingBlocksMB->GetData(MEMORYDEVICE_CUDA),
+    m_renderingBlockCountMB->GetData(MEMORYDEVICE_CUDA)
+  );
+
+  m_renderingBlockCountMB->UpdateHostFromDevice();
+  const unsigned int renderingBlockCount = std::min(*m_renderingBlockCountMB->GetData(MEMORYDEVICE_CPU), static_cast<unsigned int>(MAX_RENDERING_BLOCKS));
+  if(renderingBlockCount == 0) return;
+
+  // Expand the depth ranges of the pixels covered by each rendering block to include the block's own. (As in InfiniTAM,
+  // the thread blocks are arranged in a 2D grid, since the number of rendering blocks can exceed the maximum grid width.)
+  dim3 cudaBlockSize(renderingBlockSizeX, renderingBlockSizeY);
+  dim3 gridSize((renderingBlockCount + 3) / 4, 4);
+  ck_fill_ranges<<<gridSize,cudaBlockSize>>>(renderingBlockCount, m_renderingBlocksMB->GetData(MEMORYDEVICE_CUDA), imgSize, ranges);
+}
+
+}
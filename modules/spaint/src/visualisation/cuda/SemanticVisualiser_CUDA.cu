@@ -11,15 +11,26 @@ namespace spaint {
 
 //#################### CUDA KERNELS ####################
 
-__global__ void ck_render_semantic(Vector4u *outRendering, const Vector4f *ptsRay, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *voxelIndex,
-                                   Vector2i imgSize, Vector3u *labelColours, Vector3f viewerPos, Vector3f lightPos, LightingType lightingType, float labelAlpha)
+__global__ void ck_render_semantic(Vector4u *outRendering, const Vector4f *ptsRay, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                   const ITMVoxelIndex::IndexData *voxelIndex, Vector2i imgSize, Vector3u *labelColours, Vector3f viewerPos, Vector3f lightPos, LightingType lightingType, float labelAlpha)
 {
   int x = blockIdx.x * blockDim.x + threadIdx.x, y = blockIdx.y * blockDim.y + threadIdx.y;
   if (x >= imgSize.x || y >= imgSize.y) return;
 
   int locId = y * imgSize.x + x;
   Vector4f ptRay = ptsRay[locId];
-  shade_pixel_semantic(outRendering[locId], ptRay.toVector3(), ptRay.w > 0, voxelData, voxelIndex, labelColours, viewerPos, lightPos, lightingType, labelAlpha);
+  shade_pixel_semantic(outRendering[locId], ptRay.toVector3(), ptRay.w > 0, voxelData, labelData, voxelIndex, labelColours, viewerPos, lightPos, lightingType, labelAlpha);
+}
+
+__global__ void ck_render_semantic_compact(ushort *outRendering, const Vector4f *ptsRay, const SpaintVoxel *voxelData, const SpaintVoxel::PackedLabel *labelData,
+                                           const ITMVoxelIndex::IndexData *voxelIndex, Vector2i imgSize, Vector3f viewerPos, Vector3f lightPos, LightingType lightingType)
+{
+  int x = blockIdx.x * blockDim.x + threadIdx.x, y = blockIdx.y * blockDim.y + threadIdx.y;
+  if (x >= imgSize.x || y >= imgSize.y) return;
+
+  int locId = y * imgSize.x + x;
+  Vector4f ptRay = ptsRay[locId];
+  shade_pixel_semantic_compact(outRendering[locId], ptRay.toVector3(), ptRay.w > 0, voxelData, labelData, voxelIndex, viewerPos, lightPos, lightingType);
 }
 
 //#################### CONSTRUCTORS ####################
@@ -30,6 +41,33 @@ SemanticVisualiser_CUDA::SemanticVisualiser_CUDA(size_t maxLabelCount)
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+void SemanticVisualiser_CUDA::render_compact_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState,
+                                                      LightingType lightingType, ITMUShortImage *outputImage) const
+{
+  // Calculate the light and viewer positions in voxel coordinates (the same coordinate space as the raycast results).
+  const float voxelSize = scene->sceneParams->voxelSize;
+  Vector3f lightPos = Vector3f(0.0f, -10.0f, -10.0f) / voxelSize;
+  Vector3f viewerPos = Vector3f(pose->GetInvM().getColumn(3)) / voxelSize;
+
+  // Shade all of the pixels in the image.
+  Vector2i imgSize = outputImage->noDims;
+
+  dim3 cudaBlockSize(8, 8);
+  dim3 gridSize((int)ceil((float)imgSize.x / (float)cudaBlockSize.x), (int)ceil((float)imgSize.y / (float)cudaBlockSize.y));
+
+  ck_render_semantic_compact<<<gridSize,cudaBlockSize>>>(
+    outputImage->GetData(MEMORYDEVICE_CUDA),
+    renderState->raycastResult->GetData(MEMORYDEVICE_CUDA),
+    scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
+    scene->index.getIndexData(),
+    imgSize,
+    viewerPos,
+    lightPos,
+    lightingType
+  );
+}
+
 void SemanticVisualiser_CUDA::render_internal(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMIntrinsics *intrinsics, const ITMLib::ITMRenderState *renderState,
                                               LightingType lightingType, float labelAlpha, ITMUChar4Image *outputImage) const
 {
@@ -48,6 +86,7 @@ void SemanticVisualiser_CUDA::render_internal(const SpaintVoxelScene *scene, con
     outputImage->GetData(MEMORYDEVICE_CUDA),
     renderState->raycastResult->GetData(MEMORYDEVICE_CUDA),
     scene->localVBA.GetVoxelBlocks(),
+    scene->get_label_data(),
     scene->index.getIndexData(),
     imgSize,
     m_labelColoursMB->GetData(MEMORYDEVICE_CUDA),
@@ -0,0 +1,54 @@
+/**
+ * spaint: StereoRaycaster_CUDA.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/cuda/StereoRaycaster_CUDA.h"
+
+#include "visualisation/shared/StereoRaycaster_Shared.h"
+
+namespace spaint {
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_raycast_stereo(Vector2i imgSize, int rangeWidth, const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                                  Matrix4f leftInvM, Matrix4f rightInvM, Vector4f invProjParams, float oneOverVoxelSize, float mu,
+                                  const Vector2f *leftRanges, const Vector2f *rightRanges, Vector4f *leftPtsRay, Vector4f *rightPtsRay)
+{
+  int x = blockIdx.x * blockDim.x + threadIdx.x, y = blockIdx.y * blockDim.y + threadIdx.y;
+  if(x >= imgSize.x || y >= imgSize.y) return;
+
+  raycast_stereo_pixel(
+    x, y, imgSize.x, rangeWidth, voxelData, indexData, leftInvM, rightInvM, invProjParams,
+    oneOverVoxelSize, mu, leftRanges, rightRanges, leftPtsRay, rightPtsRay
+  );
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void StereoRaycaster_CUDA::raycast(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *leftPose, const ORUtils::SE3Pose *rightPose, const ITMLib::ITMIntrinsics *intrinsics,
+                                   ITMLib::ITMRenderState *leftRenderState, ITMLib::ITMRenderState *rightRenderState) const
+{
+  const Vector2i imgSize = leftRenderState->raycastResult->noDims;
+
+  dim3 cudaBlockSize(8, 8);
+  dim3 gridSize((int)ceil((float)imgSize.x / (float)cudaBlockSize.x), (int)ceil((float)imgSize.y / (float)cudaBlockSize.y));
+
+  ck_raycast_stereo<<<gridSize,cudaBlockSize>>>(
+    imgSize,
+    leftRenderState->renderingRangeImage->noDims.x,
+    scene->localVBA.GetVoxelBlocks(),
+    scene->index.getIndexData(),
+    leftPose->GetInvM(),
+    rightPose->GetInvM(),
+    InvertProjectionParams(intrinsics->projectionParamsSimple.all),
+    1.0f / scene->sceneParams->voxelSize,
+    scene->sceneParams->mu,
+    leftRenderState->renderingRangeImage->GetData(MEMORYDEVICE_CUDA),
+    rightRenderState->renderingRangeImage->GetData(MEMORYDEVICE_CUDA),
+    leftRenderState->raycastResult->GetData(MEMORYDEVICE_CUDA),
+    rightRenderState->raycastResult->GetData(MEMORYDEVICE_CUDA)
+  );
+}
+
+}
@@ -0,0 +1,31 @@
+/**
+ * spaint: BlockOccupancyUpdater.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/interface/BlockOccupancyUpdater.h"
+using namespace ITMLib;
+
+#include <ITMLib/Objects/RenderStates/ITMRenderState_VH.h>
+
+namespace spaint {
+
+//#################### DESTRUCTOR ####################
+
+BlockOccupancyUpdater::~BlockOccupancyUpdater() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void BlockOccupancyUpdater::update_block_occupancy(SpaintVoxelScene *scene, const ITMRenderState *renderState) const
+{
+  // If the scene is not recording its block occupancy, early out.
+  if(!scene->get_block_occupancy_data()) return;
+
+  // Re-examine the voxel blocks that are currently visible (these are the only ones that fusion can have changed).
+  const ITMRenderState_VH *renderStateVH = dynamic_cast<const ITMRenderState_VH*>(renderState);
+  if(!renderStateVH || renderStateVH->noVisibleEntities == 0) return;
+
+  update_entries(renderStateVH->GetVisibleEntityIDs(), renderStateVH->noVisibleEntities, scene);
+}
+
+}
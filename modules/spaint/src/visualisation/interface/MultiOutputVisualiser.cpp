@@ -0,0 +1,51 @@
+/**
+ * spaint: MultiOutputVisualiser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "visualisation/interface/MultiOutputVisualiser.h"
+
+#include <itmx/base/MemoryBlockFactory.h>
+using itmx::MemoryBlockFactory;
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+MultiOutputVisualiser::MultiOutputVisualiser(size_t maxLabelCount)
+: m_labelColoursMB(MemoryBlockFactory::instance().make_block<Vector3u>(maxLabelCount, "MultiOutputVisualiser"))
+{}
+
+//#################### DESTRUCTOR ####################
+
+MultiOutputVisualiser::~MultiOutputVisualiser() {}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void MultiOutputVisualiser::render(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState, const std::vector<Vector3u>& labelColours,
+                                   LightingType lightingType, float labelAlpha, DepthVisualiser::DepthType depthType, float invalidDepthValue, const Outputs& outputs) const
+{
+  // If the semantic visualisation has been requested, update the label colours in the memory block.
+  if(outputs.semanticColour)
+  {
+    Vector3u *labelColoursData = m_labelColoursMB->GetData(MEMORYDEVICE_CPU);
+    for(size_t i = 0, size = std::min(m_labelColoursMB->dataSize, labelColours.size()); i < size; ++i)
+    {
+      labelColoursData[i] = labelColours[i];
+    }
+    m_labelColoursMB->UpdateDeviceFromHost();
+  }
+
+  // Make sure that all of the requested outputs are the same size as the raycast.
+  const Vector2i imgSize = renderState->raycastResult->noDims;
+  if(outputs.confidence) outputs.confidence->ChangeDims(imgSize);
+  if(outputs.depth) outputs.depth->ChangeDims(imgSize);
+  if(outputs.labels) outputs.labels->ChangeDims(imgSize);
+  if(outputs.normals) outputs.normals->ChangeDims(imgSize);
+  if(outputs.semanticColour) outputs.semanticColour->ChangeDims(imgSize);
+
+  // Render the requested outputs.
+  render_internal(scene, pose, renderState, lightingType, labelAlpha, depthType, invalidDepthValue, outputs);
+}
+
+}
@@ -13,7 +13,7 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 SemanticVisualiser::SemanticVisualiser(size_t maxLabelCount)
-: m_labelColoursMB(MemoryBlockFactory::instance().make_block<Vector3u>(maxLabelCount))
+: m_labelColoursMB(MemoryBlockFactory::instance().make_block<Vector3u>(maxLabelCount, "SemanticVisualiser"))
 {}
 
 //#################### DESTRUCTOR ####################
@@ -37,4 +37,12 @@ void SemanticVisualiser::render(const SpaintVoxelScene *scene, const ORUtils::SE
   render_internal(scene, pose, intrinsics, renderState, lightingType, labelAlpha, outputImage);
 }
 
+void SemanticVisualiser::render_compact(const SpaintVoxelScene *scene, const ORUtils::SE3Pose *pose, const ITMLib::ITMRenderState *renderState,
+                                        LightingType lightingType, ITMUShortImage *outputImage) const
+{
+  // Note: The label colours are not needed, since the compact view contains the labels themselves.
+  outputImage->ChangeDims(renderState->raycastResult->noDims);
+  render_compact_internal(scene, pose, renderState, lightingType, outputImage);
+}
+
 }
@@ -0,0 +1,170 @@
+/**
+ * tvgplot: LivePlotWindow.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGPLOT_LIVEPLOTWINDOW
+#define H_TVGPLOT_LIVEPLOTWINDOW
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/circular_buffer.hpp>
+
+#include <opencv2/core/core.hpp>
+
+namespace tvgplot {
+
+/**
+ * \brief An instance of this class represents a window that shows a scrolling plot of several series of values over time
+ *        (e.g. the per-frame timings of the stages of a pipeline).
+ *
+ * A new column of samples (one per series) is added each time add_samples is called, and the most recent samples of each
+ * series are kept in a fixed-size ring buffer. The plot is drawn incrementally: adding a column scrolls the existing plot
+ * to the left and draws just the newest segment of each series, so the cost per column does not depend on the amount of
+ * history shown. The whole plot is only redrawn from the ring buffers when the vertical scale has to change, which is
+ * rare, since the scale grows in powers of two and is only shrunk (at most once per window of samples) if every sample
+ * in the window would still fit.
+ */
+class LivePlotWindow
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a series of values shown in the plot.
+   */
+  struct Series
+  {
+    /** The colour with which to draw the series (in BGR format). */
+    cv::Scalar colour;
+
+    /** The name of the series. */
+    std::string name;
+
+    /** The most recent values of the series (NaN for any column in which the series had no sample). */
+    boost::circular_buffer<float> values;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of columns that have been added since the vertical scale was last checked to see whether it can shrink. */
+  size_t m_columnsSinceScaleCheck;
+
+  /** The width (in pixels) of each column of samples. */
+  int m_columnWidth;
+
+  /** The canvas showing the legend (which is only redrawn when a series is added or the scale changes). */
+  cv::Mat m_legend;
+
+  /** The canvas showing the plot. */
+  cv::Mat m_plot;
+
+  /** A canvas of the same size as the plot, into which it is scrolled each time a column is added. */
+  cv::Mat m_scratch;
+
+  /** A map from the names of the series to their indices in the series list. */
+  std::map<std::string,size_t> m_seriesIndices;
+
+  /** The series shown in the plot, in the order in which they were first added. */
+  std::vector<Series> m_series;
+
+  /** The units of the values (used to label the scale). */
+  std::string m_units;
+
+  /** The value shown at the top of the plot. */
+  float m_valueScale;
+
+  /** The canvas that is shown in the window (the plot, with the legend to its right). */
+  mutable cv::Mat m_window;
+
+  /** The name to display in the window. */
+  std::string m_windowName;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a window that shows a scrolling plot of several series of values over time.
+   *
+   * \param windowName              The name to display in the window.
+   * \param units                   The units of the values (used to label the scale).
+   * \param plotWidth               The width of the plot (in pixels).
+   * \param plotHeight              The height of the plot (in pixels).
+   * \param columnWidth             The width (in pixels) of each column of samples.
+   * \param legendWidth             The width (in pixels) of the legend shown to the right of the plot.
+   * \throws std::invalid_argument  If any of the sizes is not positive, or the column width exceeds the plot width.
+   */
+  explicit LivePlotWindow(const std::string& windowName, const std::string& units = "", int plotWidth = 600, int plotHeight = 300,
+                          int columnWidth = 2, int legendWidth = 240);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds a column of samples to the plot.
+   *
+   * Any series that does not have a sample in the column is left with a gap. A series whose name has not been seen before is added.
+   *
+   * \param samples The samples, as series name/value pairs.
+   */
+  void add_samples(const std::vector<std::pair<std::string,double> >& samples);
+
+  /**
+   * \brief Shows the current state of the plot in the window.
+   */
+  void refresh() const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets the x coordinate in the plot of the column with the specified index in the ring buffers.
+   *
+   * \param column  The index of the column in the ring buffers.
+   * \return        The x coordinate of the column in the plot.
+   */
+  int column_to_x(size_t column) const;
+
+  /**
+   * \brief Draws the horizontal grid lines and the segments of each series that end in the columns from the specified one onwards.
+   *
+   * \param firstColumn The index (in the ring buffers) of the first column whose segments should be drawn.
+   */
+  void draw_columns(size_t firstColumn);
+
+  /**
+   * \brief Redraws the legend.
+   */
+  void draw_legend();
+
+  /**
+   * \brief Gets the index of the series with the specified name in the series list, adding the series if necessary.
+   *
+   * \param name  The name of the series.
+   * \return      The index of the series in the series list.
+   */
+  size_t lookup_series(const std::string& name);
+
+  /**
+   * \brief Gets the largest value currently held in any of the ring buffers.
+   *
+   * \return  The largest value currently held in any of the ring buffers (or 0, if there are none).
+   */
+  float max_value() const;
+
+  /**
+   * \brief Redraws the whole plot from the ring buffers.
+   */
+  void redraw();
+
+  /**
+   * \brief Converts a value to a y coordinate in the plot.
+   *
+   * \param value The value.
+   * \return      The corresponding y coordinate in the plot.
+   */
+  int value_to_y(float value) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+/**
+ * tvgplot: LivePlotWindow.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "LivePlotWindow.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "PaletteGenerator.h"
+
+namespace tvgplot {
+
+//#################### LOCAL CONSTANTS ####################
+
+/** The colour of the grid lines (in BGR format). */
+static const cv::Scalar GRID_COLOUR(64, 64, 64);
+
+/** The number of horizontal grid lines (excluding the one at the bottom of the plot). */
+static const int GRID_LINE_COUNT = 4;
+
+/** The height (in pixels) of each row of the legend. */
+static const int LEGEND_ROW_HEIGHT = 14;
+
+//#################### CONSTRUCTORS ####################
+
+LivePlotWindow::LivePlotWindow(const std::string& windowName, const std::string& units, int plotWidth, int plotHeight, int columnWidth, int legendWidth)
+: m_columnsSinceScaleCheck(0),
+  m_columnWidth(columnWidth),
+  m_units(units),
+  m_valueScale(1.0f),
+  m_windowName(windowName)
+{
+  if(plotWidth <= 0 || plotHeight <= 0 || columnWidth <= 0 || legendWidth <= 0 || columnWidth > plotWidth)
+  {
+    throw std::invalid_argument("Error: Invalid live plot window dimensions");
+  }
+
+  m_legend = cv::Mat::zeros(plotHeight, legendWidth, CV_8UC3);
+  m_plot = cv::Mat::zeros(plotHeight, plotWidth, CV_8UC3);
+  m_scratch = cv::Mat::zeros(plotHeight, plotWidth, CV_8UC3);
+  m_window = cv::Mat::zeros(plotHeight, plotWidth + legendWidth, CV_8UC3);
+
+  redraw();
+
+  cv::namedWindow(m_windowName, cv::WINDOW_AUTOSIZE);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void LivePlotWindow::add_samples(const std::vector<std::pair<std::string,double> >& samples)
+{
+  // Look up the series to which the samples belong (adding any new ones), and assemble the new column.
+  const size_t oldSeriesCount = m_series.size();
+  std::vector<float> column;
+  float columnMax = 0.0f;
+  for(size_t i = 0, size = samples.size(); i < size; ++i)
+  {
+    const size_t seriesIndex = lookup_series(samples[i].first);
+    if(column.size() < m_series.size()) column.resize(m_series.size(), std::numeric_limits<float>::quiet_NaN());
+
+    const float value = static_cast<float>(samples[i].second);
+    column[seriesIndex] = value;
+    if(value > columnMax) columnMax = value;
+  }
+  column.resize(m_series.size(), std::numeric_limits<float>::quiet_NaN());
+  if(m_series.empty()) return;
+
+  // Append the column to the ring buffers.
+  for(size_t i = 0, size = m_series.size(); i < size; ++i)
+  {
+    m_series[i].values.push_back(column[i]);
+  }
+
+  // If any of the new samples would go off the top of the plot, grow the scale (in powers of two, so that this
+  // rarely needs to happen again). Otherwise, once per window of samples, check whether the scale can shrink.
+  const float oldValueScale = m_valueScale;
+  while(columnMax > m_valueScale) m_valueScale *= 2.0f;
+
+  if(m_valueScale == oldValueScale && ++m_columnsSinceScaleCheck >= m_series[0].values.capacity())
+  {
+    m_columnsSinceScaleCheck = 0;
+    const float maxValue = max_value();
+    while(maxValue > 0.0f && maxValue <= m_valueScale / 2.0f) m_valueScale /= 2.0f;
+  }
+
+  // If the scale has changed, redraw the whole plot. Otherwise, scroll the plot to the left and draw just the new column.
+  if(m_valueScale != oldValueScale)
+  {
+    m_columnsSinceScaleCheck = 0;
+    redraw();
+    return;
+  }
+
+  const int plotWidth = m_plot.cols, plotHeight = m_plot.rows;
+  m_plot(cv::Rect(m_columnWidth, 0, plotWidth - m_columnWidth, plotHeight)).copyTo(m_scratch(cv::Rect(0, 0, plotWidth - m_columnWidth, plotHeight)));
+  m_scratch(cv::Rect(plotWidth - m_columnWidth, 0, m_columnWidth, plotHeight)).setTo(cv::Scalar::all(0));
+  std::swap(m_plot, m_scratch);
+
+  draw_columns(m_series[0].values.size() - 1);
+  if(m_series.size() != oldSeriesCount) draw_legend();
+}
+
+void LivePlotWindow::refresh() const
+{
+  m_plot.copyTo(m_window(cv::Rect(0, 0, m_plot.cols, m_plot.rows)));
+  m_legend.copyTo(m_window(cv::Rect(m_plot.cols, 0, m_legend.cols, m_legend.rows)));
+  cv::imshow(m_windowName, m_window);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int LivePlotWindow::column_to_x(size_t column) const
+{
+  // Note: The newest column is drawn at the right-hand edge of the plot.
+  const int columnCount = static_cast<int>(m_series[0].values.size());
+  return m_plot.cols - 1 - (columnCount - 1 - static_cast<int>(column)) * m_columnWidth;
+}
+
+void LivePlotWindow::draw_columns(size_t firstColumn)
+{
+  // Draw the grid lines across the part of the plot that covers the columns.
+  const int x0 = firstColumn > 0 ? column_to_x(firstColumn - 1) : 0, x1 = m_plot.cols - 1;
+  for(int i = 1; i <= GRID_LINE_COUNT; ++i)
+  {
+    const int y = value_to_y(m_valueScale * i / GRID_LINE_COUNT);
+    cv::line(m_plot, cv::Point(x0, y), cv::Point(x1, y), GRID_COLOUR);
+  }
+
+  // Draw the segments of each series that end in the columns (skipping any that start or end in a gap).
+  for(size_t i = 0, seriesCount = m_series.size(); i < seriesCount; ++i)
+  {
+    const Series& series = m_series[i];
+    for(size_t c = std::max<size_t>(firstColumn, 1), columnCount = series.values.size(); c < columnCount; ++c)
+    {
+      const float v0 = series.values[c - 1], v1 = series.values[c];
+      if(boost::math::isnan(v0) || boost::math::isnan(v1)) continue;
+      cv::line(m_plot, cv::Point(column_to_x(c - 1), value_to_y(v0)), cv::Point(column_to_x(c), value_to_y(v1)), series.colour);
+    }
+  }
+}
+
+void LivePlotWindow::draw_legend()
+{
+  m_legend.setTo(cv::Scalar::all(0));
+
+  // Label the scale.
+  std::ostringstream oss;
+  oss << "max " << m_valueScale << ' ' << m_units;
+  cv::putText(m_legend, oss.str(), cv::Point(4, LEGEND_ROW_HEIGHT - 3), cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar::all(255));
+
+  // List the series, each with a swatch of its colour.
+  for(size_t i = 0, size = m_series.size(); i < size; ++i)
+  {
+    const int y = static_cast<int>(i + 2) * LEGEND_ROW_HEIGHT;
+    if(y > m_legend.rows) break;
+
+    cv::rectangle(m_legend, cv::Rect(4, y - LEGEND_ROW_HEIGHT + 4, 10, LEGEND_ROW_HEIGHT - 6), m_series[i].colour, -1);
+    cv::putText(m_legend, m_series[i].name, cv::Point(18, y - 3), cv::FONT_HERSHEY_SIMPLEX, 0.4, m_series[i].colour);
+  }
+}
+
+size_t LivePlotWindow::lookup_series(const std::string& name)
+{
+  std::map<std::string,size_t>::const_iterator it = m_seriesIndices.find(name);
+  if(it != m_seriesIndices.end()) return it->second;
+
+  // Cycle through the brighter colours of the basic palette, which show up well against the black background.
+  static const char *colourNames[] = { "Red", "Lime", "Yellow", "Cyan", "Magenta", "White", "Silver", "Olive", "Teal", "Purple", "Blue", "Green" };
+  static const size_t colourCount = sizeof(colourNames) / sizeof(const char*);
+  static const std::map<std::string,cv::Scalar> palette = PaletteGenerator::generate_basic_rgba_palette();
+  const cv::Scalar& rgba = palette.find(colourNames[m_series.size() % colourCount])->second;
+
+  // Give the new series a ring buffer that covers the width of the plot, and fill in the columns it missed with gaps.
+  Series series;
+  series.colour = cv::Scalar(rgba.val[2], rgba.val[1], rgba.val[0]);
+  series.name = name;
+  series.values.set_capacity(m_plot.cols / m_columnWidth + 1);
+  if(!m_series.empty()) series.values.assign(m_series[0].values.size(), std::numeric_limits<float>::quiet_NaN());
+
+  const size_t index = m_series.size();
+  m_series.push_back(series);
+  m_seriesIndices.insert(std::make_pair(name, index));
+  return index;
+}
+
+float LivePlotWindow::max_value() const
+{
+  float result = 0.0f;
+  for(size_t i = 0, seriesCount = m_series.size(); i < seriesCount; ++i)
+  {
+    const boost::circular_buffer<float>& values = m_series[i].values;
+    for(size_t c = 0, columnCount = values.size(); c < columnCount; ++c)
+    {
+      // Note: Comparisons with NaN are false, so gaps are skipped.
+      if(values[c] > result) result = values[c];
+    }
+  }
+  return result;
+}
+
+void LivePlotWindow::redraw()
+{
+  m_plot.setTo(cv::Scalar::all(0));
+  draw_columns(0);
+  draw_legend();
+}
+
+int LivePlotWindow::value_to_y(float value) const
+{
+  const int maxY = m_plot.rows - 1;
+  return maxY - cvRound(maxY * std::min(std::max(value / m_valueScale, 0.0f), 1.0f));
+}
+
+}
@@ -6,14 +6,124 @@
 #ifndef H_TVGUTIL_PRIORITYQUEUE
 #define H_TVGUTIL_PRIORITYQUEUE
 
+#include <algorithm>
 #include <map>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include <boost/serialization/map.hpp>
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
 
 namespace tvgutil {
 
+/**
+ * \brief An instance of an instantiation of this class template maps the IDs of the elements in a priority queue to their
+ *        positions in its heap using a std::map. This works for any ID type that can be ordered.
+ */
+template <typename ID>
+class PriorityQueueMapDictionary
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The map from IDs to heap positions. */
+  std::map<ID,size_t> m_positions;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Removes all IDs from the dictionary. */
+  void clear()                      { m_positions.clear(); }
+
+  /** Returns whether or not the dictionary contains the specified ID. */
+  bool contains(const ID& id) const { return m_positions.find(id) != m_positions.end(); }
+
+  /** Returns whether or not the dictionary is empty. */
+  bool empty() const                { return m_positions.empty(); }
+
+  /** Removes the specified ID from the dictionary. */
+  void erase(const ID& id)          { m_positions.erase(id); }
+
+  /** Returns the heap position of the specified ID (inserting it if it is not already in the dictionary). */
+  size_t& operator[](const ID& id)  { return m_positions[id]; }
+
+  /** Returns the number of IDs in the dictionary. */
+  size_t size() const               { return m_positions.size(); }
+};
+
+/**
+ * \brief An instance of an instantiation of this class template maps the IDs of the elements in a priority queue to their
+ *        positions in its heap using a flat array indexed by ID. This requires the IDs to be small, non-negative integers
+ *        (e.g. node indices), but gives O(1) lookup.
+ */
+template <typename ID>
+class PriorityQueueDenseDictionary
+{
+  //#################### CONSTANTS ####################
+private:
+  /** The position used to denote an ID that is not in the dictionary. */
+  static size_t npos() { return static_cast<size_t>(-1); }
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The heap positions of the IDs (npos() for IDs that are not in the dictionary). */
+  std::vector<size_t> m_positions;
+
+  /** The number of IDs in the dictionary. */
+  size_t m_size;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /** Constructs an empty dictionary. */
+  PriorityQueueDenseDictionary() : m_size(0) {}
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Removes all IDs from the dictionary. */
+  void clear()
+  {
+    std::vector<size_t>().swap(m_positions);
+    m_size = 0;
+  }
+
+  /** Returns whether or not the dictionary contains the specified ID. */
+  bool contains(const ID& id) const
+  {
+    size_t i = static_cast<size_t>(id);
+    return i < m_positions.size() && m_positions[i] != npos();
+  }
+
+  /** Returns whether or not the dictionary is empty. */
+  bool empty() const { return m_size == 0; }
+
+  /** Removes the specified ID from the dictionary. */
+  void erase(const ID& id)
+  {
+    if(contains(id))
+    {
+      m_positions[static_cast<size_t>(id)] = npos();
+      --m_size;
+    }
+  }
+
+  /** Returns the heap position of the specified ID (inserting it if it is not already in the dictionary). */
+  size_t& operator[](const ID& id)
+  {
+    size_t i = static_cast<size_t>(id);
+    if(i >= m_positions.size()) m_positions.resize(std::max(i + 1, m_positions.size() * 2), npos());
+    if(m_positions[i] == npos())
+    {
+      m_positions[i] = 0;
+      ++m_size;
+    }
+    return m_positions[i];
+  }
+
+  /** Returns the number of IDs in the dictionary. */
+  size_t size() const { return m_size; }
+};
+
 /**
  * \brief This is an implementation of priority queues that allows the keys of queue elements to be updated in-place.
  *
@@ -30,8 +140,10 @@ namespace tvgutil {
  * \tparam Data The auxiliary data type (any information clients might wish to store with each element)
  * \tparam Comp A predicate specifying how the keys should be compared (the default predicate is std::less<Key>,
  *              which specifies that elements with smaller keys will be extracted first)
+ * \tparam Dict The type of dictionary to use to map element IDs to their positions in the heap (the default is a
+ *              std::map-based dictionary, but PriorityQueueDenseDictionary can be used for small integer IDs)
  */
-template <typename ID, typename Key, typename Data, typename Comp = std::less<Key> >
+template <typename ID, typename Key, typename Data, typename Comp = std::less<Key>, typename Dict = PriorityQueueMapDictionary<ID> >
 class PriorityQueue
 {
   //#################### NESTED CLASSES ####################
@@ -73,7 +185,7 @@ public:
 
   //#################### TYPEDEFS ####################
 private:
-  typedef std::map<ID,size_t> Dictionary; // maps IDs to their current position in the heap
+  typedef Dict Dictionary; // maps IDs to their current position in the heap
   typedef std::vector<Element> Heap;
 
   //#################### PRIVATE VARIABLES ####################
@@ -103,7 +215,7 @@ public:
    */
   bool contains(ID id) const
   {
-    return m_dictionary.find(id) != m_dictionary.end();
+    return m_dictionary.contains(id);
   }
 
   /**
@@ -232,6 +344,46 @@ public:
     ensure_invariant();
   }
 
+  /**
+   * \brief Updates the keys of several elements at once.
+   *
+   * If only a few of the elements are being updated, this is equivalent to calling update_key() for each of them.
+   * If a large proportion of the elements are being updated, the new keys are instead all written into the heap,
+   * which is then rebuilt in a single linear-time pass.
+   *
+   * \param[in] updates The IDs of the elements whose keys are to be updated, together with their new key values
+   * \pre
+   *   - contains(id) for each ID
+   */
+  void update_keys(const std::vector<std::pair<ID,Key> >& updates)
+  {
+    // Rebuilding the heap takes O(n) time, whereas updating k keys individually takes O(k log n) time.
+    size_t n = m_heap.size(), logN = 1;
+    while((static_cast<size_t>(1) << logN) < n) ++logN;
+
+    if(updates.size() * logN < n)
+    {
+      for(typename std::vector<std::pair<ID,Key> >::const_iterator it = updates.begin(), iend = updates.end(); it != iend; ++it)
+      {
+        update_key_at(m_dictionary[it->first], it->second);
+      }
+    }
+    else
+    {
+      for(typename std::vector<std::pair<ID,Key> >::const_iterator it = updates.begin(), iend = updates.end(); it != iend; ++it)
+      {
+        m_heap[m_dictionary[it->first]].m_key = it->second;
+      }
+
+      for(size_t i = n / 2; i > 0; --i)
+      {
+        heapify(i - 1);
+      }
+    }
+
+    ensure_invariant();
+  }
+
   //#################### PRIVATE METHODS ####################
 private:
   void ensure_invariant()
@@ -301,18 +453,51 @@ private:
   //#################### SERIALIZATION #################### 
 private:
   /**
-   * \brief Serializes the priority queue to/from an archive.
+   * \brief Loads the priority queue from an archive.
+   *
+   * \param ar      The archive.
+   * \param version The file format version number.
+   */
+  template <typename Archive>
+  void load(Archive& ar, const unsigned int version)
+  {
+    // Note: The dictionary is always archived as a std::map (this keeps the archive format independent of the dictionary
+    //       type, and compatible with archives written before the dictionary type was configurable). On loading, it is
+    //       rebuilt from the heap.
+    std::map<ID,size_t> positions;
+    ar & positions;
+    ar & m_heap;
+
+    m_dictionary.clear();
+    for(size_t i = 0, size = m_heap.size(); i < size; ++i)
+    {
+      m_dictionary[m_heap[i].id()] = i;
+    }
+
+    ensure_invariant();
+  }
+
+  /**
+   * \brief Saves the priority queue to an archive.
    *
    * \param ar      The archive.
    * \param version The file format version number.
    */
   template <typename Archive>
-  void serialize(Archive& ar, const unsigned int version)
+  void save(Archive& ar, const unsigned int version) const
   {
-    ar & m_dictionary;
+    std::map<ID,size_t> positions;
+    for(size_t i = 0, size = m_heap.size(); i < size; ++i)
+    {
+      positions.insert(std::make_pair(m_heap[i].id(), i));
+    }
+
+    ar & positions;
     ar & m_heap;
   }
 
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+
   friend class boost::serialization::access;
 };
 
@@ -0,0 +1,176 @@
+/**
+ * tvgutil: RunLengthSequence.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_RUNLENGTHSEQUENCE
+#define H_TVGUTIL_RUNLENGTHSEQUENCE
+
+#include <utility>
+#include <vector>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of an instantiation of this class template represents a sequence of values that is stored
+ *        in run-length encoded form, i.e. as a list of (value, run length) pairs.
+ *
+ * This is useful for storing long sequences with few distinct runs (e.g. the old labels of a set of voxels that
+ * have just been marked) compactly on the host.
+ */
+template <typename T>
+class RunLengthSequence
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef std::pair<T,unsigned int> Run;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The runs in the sequence. */
+  std::vector<Run> m_runs;
+
+  /** The number of values in the sequence. */
+  size_t m_size;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an empty run-length sequence.
+   */
+  RunLengthSequence()
+  : m_size(0)
+  {}
+
+  /**
+   * \brief Constructs a run-length sequence from the values in the specified range.
+   *
+   * \param begin An iterator pointing to the start of the range.
+   * \param end   An iterator pointing to the end of the range.
+   */
+  template <typename InputIterator>
+  RunLengthSequence(InputIterator begin, InputIterator end)
+  : m_size(0)
+  {
+    append(begin, end);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Appends the values in the specified range to the sequence.
+   *
+   * \param begin An iterator pointing to the start of the range.
+   * \param end   An iterator pointing to the end of the range.
+   */
+  template <typename InputIterator>
+  void append(InputIterator begin, InputIterator end)
+  {
+    for(InputIterator it = begin; it != end; ++it)
+    {
+      push_back(*it);
+    }
+  }
+
+  /**
+   * \brief Gets the number of bytes used to store the runs in the sequence.
+   *
+   * \return  The number of bytes used to store the runs in the sequence.
+   */
+  size_t byte_size() const
+  {
+    return m_runs.capacity() * sizeof(Run);
+  }
+
+  /**
+   * \brief Clears the sequence.
+   */
+  void clear()
+  {
+    m_runs.clear();
+    m_size = 0;
+  }
+
+  /**
+   * \brief Decodes the sequence, writing its values to the specified output iterator.
+   *
+   * \param out An iterator pointing to the place to which to write the first value.
+   * \return    An iterator pointing just past the last value written.
+   */
+  template <typename OutputIterator>
+  OutputIterator decode(OutputIterator out) const
+  {
+    for(typename std::vector<Run>::const_iterator it = m_runs.begin(), iend = m_runs.end(); it != iend; ++it)
+    {
+      for(unsigned int i = 0; i < it->second; ++i)
+      {
+        *out++ = it->first;
+      }
+    }
+    return out;
+  }
+
+  /**
+   * \brief Gets whether or not the sequence is empty.
+   *
+   * \return  true, if the sequence is empty, or false otherwise.
+   */
+  bool empty() const
+  {
+    return m_size == 0;
+  }
+
+  /**
+   * \brief Appends a value to the sequence.
+   *
+   * \param value The value to append.
+   */
+  void push_back(const T& value)
+  {
+    if(!m_runs.empty() && m_runs.back().first == value && m_runs.back().second < static_cast<unsigned int>(-1)) ++m_runs.back().second;
+    else m_runs.push_back(std::make_pair(value, 1U));
+    ++m_size;
+  }
+
+  /**
+   * \brief Gets the number of runs in the sequence.
+   *
+   * \return  The number of runs in the sequence.
+   */
+  size_t run_count() const
+  {
+    return m_runs.size();
+  }
+
+  /**
+   * \brief Gets the runs in the sequence.
+   *
+   * \return  The runs in the sequence.
+   */
+  const std::vector<Run>& runs() const
+  {
+    return m_runs;
+  }
+
+  /**
+   * \brief Releases any storage that is not needed to hold the current runs.
+   */
+  void shrink_to_fit()
+  {
+    std::vector<Run>(m_runs).swap(m_runs);
+  }
+
+  /**
+   * \brief Gets the number of values in the sequence.
+   *
+   * \return  The number of values in the sequence.
+   */
+  size_t size() const
+  {
+    return m_size;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+/**
+ * tvgutil: SPSCRingBuffer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_SPSCRINGBUFFER
+#define H_TVGUTIL_SPSCRINGBUFFER
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/atomic.hpp>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of an instantiation of this class template represents a fixed-capacity, lock-free ring buffer
+ *        that can be shared between a single producer thread and a single consumer thread.
+ *
+ * The slots in the ring buffer are allocated up-front and then reused. Rather than pushing a value into the buffer,
+ * the producer writes directly into the slot returned by back_slot() and then publishes it by calling push().
+ * Similarly, the consumer reads (or takes ownership of the contents of) the slot returned by front() and then
+ * releases it back to the producer by calling pop(). No locks are taken by any of these operations.
+ */
+template <typename T>
+class SPSCRingBuffer
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of elements that have been popped from the ring buffer (only written by the consumer). */
+  boost::atomic<size_t> m_popCount;
+
+  /** The number of elements that have been pushed into the ring buffer (only written by the producer). */
+  boost::atomic<size_t> m_pushCount;
+
+  /** The slots in the ring buffer. */
+  std::vector<T> m_slots;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a ring buffer.
+   *
+   * \param capacity      The maximum number of elements that can be stored in the ring buffer at any one time.
+   * \param initialValue  The value with which to initialise each of the slots in the ring buffer.
+   * \throws std::invalid_argument  If the capacity is zero.
+   */
+  explicit SPSCRingBuffer(size_t capacity, const T& initialValue = T())
+  : m_popCount(0), m_pushCount(0), m_slots(capacity, initialValue)
+  {
+    if(capacity == 0) throw std::invalid_argument("Error: Cannot construct a ring buffer with zero capacity");
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  SPSCRingBuffer(const SPSCRingBuffer&);
+  SPSCRingBuffer& operator=(const SPSCRingBuffer&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the slot into which the producer should write the next element.
+   *
+   * \note  This must only be called by the producer, and only when the ring buffer is not full.
+   *
+   * \return  The slot into which the producer should write the next element.
+   */
+  T& back_slot()
+  {
+    return m_slots[m_pushCount.load(boost::memory_order_relaxed) % m_slots.size()];
+  }
+
+  /**
+   * \brief Gets the maximum number of elements that can be stored in the ring buffer at any one time.
+   *
+   * \return  The maximum number of elements that can be stored in the ring buffer at any one time.
+   */
+  size_t capacity() const
+  {
+    return m_slots.size();
+  }
+
+  /**
+   * \brief Gets whether or not the ring buffer is empty.
+   *
+   * \return  true, if the ring buffer is empty, or false otherwise.
+   */
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  /**
+   * \brief Gets the element at the front of the ring buffer.
+   *
+   * \note  This must only be called by the consumer, and only when the ring buffer is not empty.
+   *
+   * \return  The element at the front of the ring buffer.
+   */
+  T& front()
+  {
+    return m_slots[m_popCount.load(boost::memory_order_relaxed) % m_slots.size()];
+  }
+
+  /**
+   * \brief Gets the element at the front of the ring buffer.
+   *
+   * \note  This must only be called by the consumer, and only when the ring buffer is not empty.
+   *
+   * \return  The element at the front of the ring buffer.
+   */
+  const T& front() const
+  {
+    return m_slots[m_popCount.load(boost::memory_order_relaxed) % m_slots.size()];
+  }
+
+  /**
+   * \brief Gets whether or not the ring buffer is full.
+   *
+   * \return  true, if the ring buffer is full, or false otherwise.
+   */
+  bool full() const
+  {
+    return size() == m_slots.size();
+  }
+
+  /**
+   * \brief Releases the slot at the front of the ring buffer back to the producer.
+   *
+   * \note  This must only be called by the consumer, and only when the ring buffer is not empty.
+   */
+  void pop()
+  {
+    m_popCount.store(m_popCount.load(boost::memory_order_relaxed) + 1, boost::memory_order_release);
+  }
+
+  /**
+   * \brief Publishes the element that the producer has written into the back slot to the consumer.
+   *
+   * \note  This must only be called by the producer, and only when the ring buffer is not full.
+   */
+  void push()
+  {
+    m_pushCount.store(m_pushCount.load(boost::memory_order_relaxed) + 1, boost::memory_order_release);
+  }
+
+  /**
+   * \brief Gets the specified slot of the ring buffer.
+   *
+   * \note  This is intended for setting up and tearing down the slots, and must only be called when no other thread is using the ring buffer.
+   *
+   * \param i The index of the slot (in [0,capacity())).
+   * \return  The specified slot.
+   * \throws std::out_of_range  If the index is out of range.
+   */
+  T& slot(size_t i)
+  {
+    if(i >= m_slots.size()) throw std::out_of_range("Error: Invalid ring buffer slot index");
+    return m_slots[i];
+  }
+
+  /**
+   * \brief Gets the number of elements currently stored in the ring buffer.
+   *
+   * \note  If called concurrently with push() or pop(), the result may already be out of date by the time it is returned.
+   *
+   * \return  The number of elements currently stored in the ring buffer.
+   */
+  size_t size() const
+  {
+    // Note: The counts only ever increase, so the subtraction is well-defined even if they wrap around.
+    const size_t popCount = m_popCount.load(boost::memory_order_acquire);
+    const size_t pushCount = m_pushCount.load(boost::memory_order_acquire);
+    return pushCount - popCount;
+  }
+};
+
+}
+
+#endif
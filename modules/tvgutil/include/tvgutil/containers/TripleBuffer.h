@@ -0,0 +1,182 @@
+/**
+ * tvgutil: TripleBuffer.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_TRIPLEBUFFER
+#define H_TVGUTIL_TRIPLEBUFFER
+
+#include <stdexcept>
+
+#include <boost/atomic.hpp>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of an instantiation of this class template represents a lock-free triple buffer that can be used
+ *        to hand the most recent of a stream of elements from a single producer thread to a single consumer thread.
+ *
+ * Unlike a ring buffer, a triple buffer never makes the producer wait: each element that is published replaces any
+ * previously published element that the consumer has not yet taken, which is thereby dropped. The consumer thus always
+ * receives the newest element available, at the cost of not receiving all of them.
+ *
+ * The three slots are allocated up-front and then reused. The producer writes directly into the slot returned by
+ * back_slot() and then publishes it by calling push(). The consumer calls take() to make the newest published element
+ * (if any) the front element, and then reads (or takes ownership of the contents of) the slot returned by front(),
+ * which the producer will not touch until the consumer next calls take(). No locks are taken by any of these operations.
+ */
+template <typename T>
+class TripleBuffer
+{
+  //#################### CONSTANTS ####################
+private:
+  /** A flag that is set in m_middle when its slot holds a published element that the consumer has not yet taken. */
+  static const unsigned int FRESH_FLAG = 4;
+
+  /** A mask that can be used to extract a slot index from m_middle. */
+  static const unsigned int INDEX_MASK = 3;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The index of the slot into which the producer is writing (only accessed by the producer). */
+  unsigned int m_back;
+
+  /** The index of the slot that the consumer most recently took (only accessed by the consumer). */
+  unsigned int m_front;
+
+  /** The index of the slot that is currently owned by neither thread, together with a flag indicating whether or not it holds a fresh element. */
+  boost::atomic<unsigned int> m_middle;
+
+  /** The slots in the triple buffer. */
+  T m_slots[3];
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a triple buffer.
+   *
+   * \param initialValue  The value with which to initialise each of the slots in the triple buffer.
+   */
+  explicit TripleBuffer(const T& initialValue = T())
+  : m_back(0), m_front(1), m_middle(2)
+  {
+    for(size_t i = 0; i < 3; ++i) m_slots[i] = initialValue;
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  TripleBuffer(const TripleBuffer&);
+  TripleBuffer& operator=(const TripleBuffer&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the slot into which the producer should write the next element.
+   *
+   * \note  This must only be called by the producer.
+   *
+   * \return  The slot into which the producer should write the next element.
+   */
+  T& back_slot()
+  {
+    return m_slots[m_back];
+  }
+
+  /**
+   * \brief Gets the element that the consumer most recently took.
+   *
+   * \note  This must only be called by the consumer, and only after take() has returned true at least once.
+   *
+   * \return  The element that the consumer most recently took.
+   */
+  T& front()
+  {
+    return m_slots[m_front];
+  }
+
+  /**
+   * \brief Gets the element that the consumer most recently took.
+   *
+   * \note  This must only be called by the consumer, and only after take() has returned true at least once.
+   *
+   * \return  The element that the consumer most recently took.
+   */
+  const T& front() const
+  {
+    return m_slots[m_front];
+  }
+
+  /**
+   * \brief Gets whether or not there is a published element that the consumer has not yet taken.
+   *
+   * \note  If called concurrently with push() or take(), the result may already be out of date by the time it is returned.
+   *
+   * \return  true, if there is a published element that the consumer has not yet taken, or false otherwise.
+   */
+  bool has_fresh() const
+  {
+    return (m_middle.load(boost::memory_order_acquire) & FRESH_FLAG) != 0;
+  }
+
+  /**
+   * \brief Publishes the element that the producer has written into the back slot to the consumer.
+   *
+   * \note  This must only be called by the producer.
+   *
+   * \return  true, if publishing the element dropped a previously published element that the consumer had not yet taken, or false otherwise.
+   */
+  bool push()
+  {
+    const unsigned int previousMiddle = m_middle.exchange(m_back | FRESH_FLAG, boost::memory_order_acq_rel);
+    m_back = previousMiddle & INDEX_MASK;
+    return (previousMiddle & FRESH_FLAG) != 0;
+  }
+
+  /**
+   * \brief Gets the specified slot of the triple buffer.
+   *
+   * \note  This is intended for setting up and tearing down the slots, and must only be called when no other thread is using the triple buffer.
+   *
+   * \param i The index of the slot (in [0,slot_count())).
+   * \return  The specified slot.
+   * \throws std::out_of_range  If the index is out of range.
+   */
+  T& slot(size_t i)
+  {
+    if(i >= slot_count()) throw std::out_of_range("Error: Invalid triple buffer slot index");
+    return m_slots[i];
+  }
+
+  /**
+   * \brief Gets the number of slots in the triple buffer.
+   *
+   * \return  The number of slots in the triple buffer (always 3).
+   */
+  size_t slot_count() const
+  {
+    return 3;
+  }
+
+  /**
+   * \brief Makes the newest published element (if any) that the consumer has not yet taken the front element.
+   *
+   * If there is no such element, the front element is left unchanged.
+   *
+   * \note  This must only be called by the consumer.
+   *
+   * \return  true, if a fresh element was taken, or false otherwise.
+   */
+  bool take()
+  {
+    if(!has_fresh()) return false;
+
+    const unsigned int previousMiddle = m_middle.exchange(m_front, boost::memory_order_acq_rel);
+    m_front = previousMiddle & INDEX_MASK;
+    return true;
+  }
+};
+
+}
+
+#endif
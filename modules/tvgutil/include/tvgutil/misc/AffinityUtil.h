@@ -0,0 +1,57 @@
+/**
+ * tvgutil: AffinityUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_AFFINITYUTIL
+#define H_TVGUTIL_AFFINITYUTIL
+
+#include <string>
+#include <vector>
+
+namespace tvgutil {
+
+/**
+ * \brief This struct provides utility functions for restricting threads to particular sets of CPUs.
+ *
+ * On machines with several NUMA nodes, keeping each thread on the CPUs of a single node (and allocating the memory it uses
+ * from there) avoids cross-node memory traffic. CPU sets are specified in the same format as the Linux cpulist format
+ * (e.g. "0-7,16-23"). Note that a thread inherits the CPU set of the thread that created it, unless it sets its own.
+ */
+struct AffinityUtil
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Gets the number of threads to use for a pool, based on the hardware concurrency.
+   *
+   * \param cpus  The CPUs on which the pool's threads will run (if non-empty, there is no point in using more threads than this).
+   * \return      The number of threads to use (always at least 1).
+   */
+  static size_t get_default_thread_count(const std::vector<int>& cpus = std::vector<int>());
+
+  /**
+   * \brief Parses a CPU set specified as a comma-separated list of CPU indices and ranges (e.g. "0-7,16-23").
+   *
+   * \param cpuList                 The CPU list (an empty string denotes an empty set, i.e. no restriction).
+   * \return                        The indices of the CPUs in the set, in ascending order and without duplicates.
+   * \throws std::invalid_argument  If the CPU list is malformed.
+   */
+  static std::vector<int> parse_cpu_list(const std::string& cpuList);
+
+  /**
+   * \brief Restricts the calling thread to run on the specified CPUs.
+   *
+   * This is a no-op if the CPU set is empty. If the affinity cannot be set (e.g. on an unsupported platform, or because
+   * none of the CPUs are available to the process), a warning is output and the thread's affinity is left unchanged.
+   *
+   * \param cpus      The CPUs on which the thread may run.
+   * \param roleName  The name of the thread's role (used in any warning).
+   * \return          true, if the CPU set was empty or the affinity was successfully set, or false otherwise.
+   */
+  static bool set_current_thread_affinity(const std::vector<int>& cpus, const std::string& roleName);
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * tvgutil: ParallelUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_PARALLELUTIL
+#define H_TVGUTIL_PARALLELUTIL
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "TaskGroup.h"
+
+namespace tvgutil {
+
+/**
+ * \brief This class provides utility functions for running loops in parallel on a task scheduler.
+ */
+class ParallelUtil
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Calls the specified body for each index in the range [begin,end), in parallel.
+   *
+   * The range is divided into chunks of at least grainSize indices, which are executed as tasks on the scheduler (the calling
+   * thread executes the first chunk itself). The body must be safe to call concurrently for different indices. Since this uses
+   * the scheduler's threads rather than creating new ones, it can safely be called from within the body of another parallel loop.
+   *
+   * \param begin     The first index in the range.
+   * \param end       One past the last index in the range.
+   * \param body      The body to call for each index.
+   * \param grainSize The minimum number of indices to process in each task.
+   * \param scheduler The scheduler on which to execute the tasks.
+   * \throws std::exception   If the body throws for any index (failures on other threads are rethrown as std::runtime_error).
+   */
+  template <typename Body>
+  static void parallel_for(int begin, int end, const Body& body, int grainSize = 1, TaskScheduler& scheduler = TaskScheduler::instance())
+  {
+    if(end <= begin) return;
+
+    // Divide the range into a few chunks per thread, so that the load can be balanced by stealing.
+    const int size = end - begin;
+    const int concurrency = static_cast<int>(scheduler.get_concurrency());
+    const int chunkSize = std::max(std::max(grainSize, 1), (size + 4 * concurrency - 1) / (4 * concurrency));
+
+    // If there is only one chunk, there is no point in involving the scheduler.
+    if(concurrency == 1 || chunkSize >= size)
+    {
+      run_chunk(begin, end, body);
+      return;
+    }
+
+    TaskGroup group(scheduler);
+    for(int chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize)
+    {
+      const int chunkEnd = std::min(chunkBegin + chunkSize, end);
+      group.run(boost::bind(&ParallelUtil::run_chunk<Body>, chunkBegin, chunkEnd, boost::cref(body)));
+    }
+
+    // Note: If the calling thread's chunk throws, the group's destructor waits for the other chunks to finish before the exception propagates.
+    run_chunk(begin, begin + chunkSize, body);
+    group.wait();
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Calls the specified body for each index in the range [begin,end), in order.
+   *
+   * \param begin The first index in the range.
+   * \param end   One past the last index in the range.
+   * \param body  The body to call for each index.
+   */
+  template <typename Body>
+  static void run_chunk(int begin, int end, const Body& body)
+  {
+    for(int i = begin; i < end; ++i) body(i);
+  }
+};
+
+}
+
+#endif
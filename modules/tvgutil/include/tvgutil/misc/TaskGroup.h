@@ -0,0 +1,109 @@
+/**
+ * tvgutil: TaskGroup.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_TASKGROUP
+#define H_TVGUTIL_TASKGROUP
+
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "TaskScheduler.h"
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class represents a group of tasks that are executed by a task scheduler and can be waited for together.
+ *
+ * Whilst waiting, the calling thread executes pending tasks itself, so groups can safely be nested (e.g. a task in one group
+ * can create and wait for a group of its own) without tying up extra threads. If any task in the group throws, wait rethrows
+ * the first failure as a std::runtime_error once all of the tasks have finished.
+ */
+class TaskGroup
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The message of the first exception (if any) thrown by a task in the group. */
+  std::string m_errorMessage;
+
+  /** The mutex used to protect the error state. */
+  boost::mutex m_errorMutex;
+
+  /** Whether or not any task in the group has thrown an exception. */
+  bool m_failed;
+
+  /** The number of tasks in the group that have not yet finished. */
+  boost::atomic<size_t> m_outstandingTaskCount;
+
+  /** The scheduler that executes the tasks. */
+  TaskScheduler& m_scheduler;
+
+  /** A condition variable that is signalled whenever a task in the group finishes. */
+  boost::condition_variable m_taskFinished;
+
+  /** The mutex used to synchronise the finishing of tasks with any thread that is waiting for them. */
+  boost::mutex m_taskMutex;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a task group.
+   *
+   * \param scheduler The scheduler that should execute the tasks.
+   */
+  explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::instance());
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the task group.
+   *
+   * \note  This blocks until all of the tasks in the group have finished (any failures are discarded).
+   */
+  ~TaskGroup();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  TaskGroup(const TaskGroup&);
+  TaskGroup& operator=(const TaskGroup&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds a task to the group and submits it for execution.
+   *
+   * \param task  The task to execute.
+   */
+  void run(const boost::function<void()>& task);
+
+  /**
+   * \brief Waits for all of the tasks in the group to finish, executing pending tasks on the calling thread in the meantime.
+   *
+   * \throws std::runtime_error If any task in the group threw an exception.
+   */
+  void wait();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Executes a task in the group, recording any exception that it throws.
+   *
+   * \param task  The task to execute.
+   */
+  void execute(const boost::function<void()>& task);
+
+  /**
+   * \brief Waits for all of the tasks in the group to finish, without checking whether any of them failed.
+   */
+  void wait_for_tasks();
+};
+
+}
+
+#endif
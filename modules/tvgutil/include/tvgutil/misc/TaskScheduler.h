@@ -0,0 +1,199 @@
+/**
+ * tvgutil: TaskScheduler.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_TASKSCHEDULER
+#define H_TVGUTIL_TASKSCHEDULER
+
+#include <deque>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class represents a work-stealing scheduler that can be used to execute fine-grained parallel computations.
+ *
+ * The scheduler owns a fixed number of worker threads, each of which has its own queue of tasks. A worker pushes the tasks it
+ * spawns onto the back of its own queue and pops them from there, which keeps nested computations cache-friendly, whilst idle
+ * workers steal the oldest tasks from the fronts of the other queues. Threads that wait for tasks to complete (see TaskGroup)
+ * execute pending tasks in the meantime rather than blocking. As a result, nested parallel loops (e.g. split evaluation inside
+ * tree training) share the same fixed set of threads, and the total number of busy threads never exceeds the scheduler's
+ * concurrency, however deeply the parallelism is nested.
+ *
+ * Most code should use the global instance, whose concurrency is the single, process-wide limit on CPU parallelism.
+ * The worker threads can optionally be restricted to a set of CPUs (e.g. those of a single NUMA node).
+ */
+class TaskScheduler
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef boost::function<void()> Task;
+
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a queue of tasks that are waiting to be executed.
+   */
+  struct TaskQueue
+  {
+    /** The mutex used to protect the tasks. */
+    boost::mutex mutex;
+
+    /** The tasks. */
+    std::deque<Task> tasks;
+  };
+
+  typedef boost::shared_ptr<TaskQueue> TaskQueue_Ptr;
+
+  //#################### PRIVATE STATIC VARIABLES ####################
+private:
+  /** The CPUs to which to restrict the worker threads of the global instance (empty means no restriction). */
+  static std::vector<int> s_defaultAffinity;
+
+  /** The concurrency with which to construct the global instance (0 means use the hardware concurrency). */
+  static size_t s_defaultConcurrency;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The maximum number of threads that can be executing tasks at any one time (the workers, plus one waiting thread). */
+  size_t m_concurrency;
+
+  /** The CPUs to which the worker threads are restricted (empty means no restriction). */
+  std::vector<int> m_cpus;
+
+  /** The number of tasks that are waiting in the queues. */
+  boost::atomic<size_t> m_pendingTaskCount;
+
+  /** The task queues (one per worker, followed by one for tasks submitted by threads that are not workers). */
+  std::vector<TaskQueue_Ptr> m_queues;
+
+  /** The mutex used in conjunction with the condition variable on which idle workers sleep. */
+  boost::mutex m_sleepMutex;
+
+  /** The worker threads. */
+  boost::thread_group m_threads;
+
+  /** A condition variable used to wake idle workers when tasks are submitted. */
+  boost::condition_variable m_workAvailable;
+
+  /** The index of the calling thread's queue (only set for the worker threads). */
+  boost::thread_specific_ptr<size_t> m_workerIndex;
+
+  /** A flag set in the destructor to indicate that the workers should terminate. */
+  boost::atomic<bool> m_workersShouldTerminate;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a task scheduler.
+   *
+   * \param concurrency The maximum number of threads that should execute tasks at any one time (0 means use the hardware concurrency,
+   *                    or the number of CPUs if specified).
+   * \param cpus        The CPUs to which to restrict the worker threads (empty means no restriction).
+   */
+  explicit TaskScheduler(size_t concurrency = 0, const std::vector<int>& cpus = std::vector<int>());
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the task scheduler.
+   *
+   * \note  All tasks must have completed before the scheduler is destroyed.
+   */
+  ~TaskScheduler();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  TaskScheduler(const TaskScheduler&);
+  TaskScheduler& operator=(const TaskScheduler&);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the global instance of the task scheduler.
+   *
+   * \return  The global instance of the task scheduler.
+   */
+  static TaskScheduler& instance();
+
+  /**
+   * \brief Sets the CPUs to which the worker threads of the global instance of the task scheduler will be restricted.
+   *
+   * This must be called before the global instance is first used (e.g. at the start of main) to have any effect.
+   *
+   * \param cpus  The CPUs to which to restrict the worker threads (empty means no restriction).
+   */
+  static void set_default_affinity(const std::vector<int>& cpus);
+
+  /**
+   * \brief Sets the concurrency with which the global instance of the task scheduler will be constructed.
+   *
+   * This must be called before the global instance is first used (e.g. at the start of main) to have any effect.
+   *
+   * \param concurrency The maximum number of threads that should execute tasks at any one time (0 means use the hardware concurrency).
+   */
+  static void set_default_concurrency(size_t concurrency);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the maximum number of threads that can execute tasks at any one time.
+   *
+   * \return  The maximum number of threads that can execute tasks at any one time.
+   */
+  size_t get_concurrency() const;
+
+  /**
+   * \brief Submits a task for execution.
+   *
+   * Exceptions thrown by the task are caught and reported on std::cerr (use a TaskGroup to propagate them instead).
+   *
+   * \param task  The task to execute.
+   */
+  void submit(const Task& task);
+
+  /**
+   * \brief Executes a single pending task (if any) on the calling thread.
+   *
+   * \return  true, if a task was executed, or false if there were no pending tasks.
+   */
+  bool try_run_one();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Executes a task, reporting any exception that it throws.
+   *
+   * \param task  The task to execute.
+   */
+  static void run_task(const Task& task);
+
+  /**
+   * \brief Runs the specified worker thread.
+   *
+   * \param workerIndex The index of the worker.
+   */
+  void run_worker(size_t workerIndex);
+
+  /**
+   * \brief Attempts to take a pending task from the queues.
+   *
+   * The calling thread's own queue (if it is a worker) is tried first, followed by the queue for tasks submitted by
+   * non-workers, followed by the other workers' queues (from which the oldest tasks are stolen).
+   *
+   * \param task  A location into which to write the task (if one is found).
+   * \return      true, if a task was found, or false otherwise.
+   */
+  bool try_take_task(Task& task);
+};
+
+}
+
+#endif
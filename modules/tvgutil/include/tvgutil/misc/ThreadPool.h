@@ -6,56 +6,171 @@
 #ifndef H_TVGUTIL_THREADPOOL
 #define H_TVGUTIL_THREADPOOL
 
-#include <string>
+#include <deque>
+#include <ostream>
+#include <vector>
 
-#ifdef _MSC_VER
-  // Suppress some VC++ warnings that are produced by boost/asio.hpp.
-  #pragma warning(disable:4267 4996)
-#endif
-
-#include <boost/asio.hpp>
-
-#ifdef _MSC_VER
-  // Re-enable the VC++ warnings for the rest of the code.
-  #pragma warning(default:4267 4996)
-#endif
-
-#include <boost/shared_ptr.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/function.hpp>
 #include <boost/thread.hpp>
 
 namespace tvgutil {
 
 /**
  * \brief An instance of this class represents a pool of threads that can be used to asynchronously execute arbitrary tasks.
+ *
+ * Tasks wait in one of several priority lanes, and higher-priority tasks are always started before lower-priority ones.
+ * The total number of waiting tasks can optionally be bounded: if a task is posted when the queue is full, the pool
+ * either blocks the caller until there is space (applying backpressure) or drops a task, depending on its overflow policy.
+ * The threads can optionally be restricted to a set of CPUs (e.g. those of a single NUMA node).
  */
 class ThreadPool
 {
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the ways in which a bounded pool can respond to a task being posted when its queue is full.
+   */
+  enum OverflowPolicy
+  {
+    /** Block the caller until there is space in the queue. */
+    OP_BLOCK,
+
+    /** Drop the most recently posted task with the lowest priority (which may be the new task itself). */
+    OP_DROP
+  };
+
+  /**
+   * \brief The values of this enumeration denote the priorities that can be given to tasks.
+   */
+  enum TaskPriority
+  {
+    TP_HIGH,
+    TP_NORMAL,
+    TP_LOW,
+    TP_COUNT
+  };
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains statistics about the tasks that have been executed by a thread pool.
+   */
+  struct Stats
+  {
+    /** The number of tasks that have finished executing. */
+    size_t completedTaskCount;
+
+    /** The number of tasks that have been dropped because the queue was full. */
+    size_t droppedTaskCount;
+
+    /** The mean time (in milliseconds) that the completed tasks took to execute. */
+    double meanExecutionTimeMs;
+
+    /** The mean time (in milliseconds) for which the completed tasks waited in the queue before starting. */
+    double meanLatencyMs;
+
+    /** The greatest number of tasks that have been waiting in the queue at any one time. */
+    size_t peakQueueDepth;
+
+    /** The number of tasks that are currently waiting in the queue. */
+    size_t queueDepth;
+
+    /** The number of tasks that have finished executing per second since the pool was constructed. */
+    double throughput;
+  };
+
+private:
+  typedef boost::chrono::steady_clock Clock;
+
+  /**
+   * \brief An instance of this struct represents a task that is waiting in the queue.
+   */
+  struct QueuedTask
+  {
+    /** The time at which the task was posted. */
+    Clock::time_point postTime;
+
+    /** The task itself. */
+    boost::function<void()> task;
+  };
+
+  //#################### PRIVATE STATIC VARIABLES ####################
+private:
+  /** The CPUs to which to restrict the threads of the global instance (empty means no restriction). */
+  static std::vector<int> s_defaultAffinity;
+
+  /** The number of threads with which to construct the global instance (0 means derive it from the hardware concurrency). */
+  static size_t s_defaultThreadCount;
+
   //#################### PRIVATE MEMBER VARIABLES ####################
 private:
-  /** An I/O service used to schedule work for the threads. */
-  boost::asio::io_service m_scheduler;
+  /** The time at which the pool was constructed. */
+  Clock::time_point m_creationTime;
+
+  /** The number of tasks that have finished executing. */
+  size_t m_completedTaskCount;
+
+  /** The CPUs to which the threads are restricted (empty means no restriction). */
+  std::vector<int> m_cpus;
+
+  /** The number of tasks that have been dropped because the queue was full. */
+  size_t m_droppedTaskCount;
+
+  /** The maximum number of tasks that can be waiting in the queue (0 means unbounded). */
+  size_t m_maxQueueSize;
+
+  /** The mutex used to protect the queue, the statistics and the termination flag. */
+  mutable boost::mutex m_mutex;
+
+  /** The policy to apply when a task is posted whilst the queue is full. */
+  OverflowPolicy m_overflowPolicy;
+
+  /** The greatest number of tasks that have been waiting in the queue at any one time. */
+  size_t m_peakQueueDepth;
+
+  /** The lanes of waiting tasks, one per priority. */
+  std::deque<QueuedTask> m_queues[TP_COUNT];
+
+  /** The number of tasks that are currently waiting in the queue. */
+  size_t m_queueDepth;
+
+  /** A condition variable used to wake a blocked caller when space becomes available in the queue. */
+  boost::condition_variable m_spaceAvailable;
 
   /** The threads in the pool. */
   boost::thread_group m_threads;
 
-  /** A worker variable used to keep the scheduler running until we want it to stop. */
-  boost::shared_ptr<boost::asio::io_service::work> m_worker;
+  /** The total time (in milliseconds) that the completed tasks took to execute. */
+  double m_totalExecutionTimeMs;
+
+  /** The total time (in milliseconds) for which the completed tasks waited in the queue before starting. */
+  double m_totalLatencyMs;
+
+  /** A condition variable used to wake the threads when a task becomes available. */
+  boost::condition_variable m_workAvailable;
+
+  /** A flag set in the destructor to indicate that the threads should terminate once the queue is empty. */
+  bool m_workersShouldTerminate;
 
   //#################### CONSTRUCTORS ####################
 public:
   /**
    * \brief Constructs a thread pool.
    *
-   * \param numThreads  The number of threads that should be in the pool.
+   * \param numThreads      The number of threads that should be in the pool (0 means derive it from the hardware concurrency, or from the number of CPUs if specified).
+   * \param maxQueueSize    The maximum number of tasks that can be waiting in the queue (0 means unbounded).
+   * \param overflowPolicy  The policy to apply when a task is posted whilst the queue is full.
+   * \param cpus            The CPUs to which to restrict the threads (empty means no restriction).
    */
-  explicit ThreadPool(size_t numThreads = 20);
+  explicit ThreadPool(size_t numThreads = 0, size_t maxQueueSize = 0, OverflowPolicy overflowPolicy = OP_BLOCK, const std::vector<int>& cpus = std::vector<int>());
 
   //#################### DESTRUCTOR ####################
 public:
   /**
    * \brief Destroys the thread pool.
    *
-   * \note  Since all threads in the pool are joined, this can block.
+   * \note  Any tasks that are still waiting in the queue are executed first, and all threads in the pool are joined, so this can block.
    */
   ~ThreadPool();
 
@@ -68,28 +183,96 @@ private:
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
   /**
-   * \brief Gets a global instance of the thread pool that has been constructed with default parameters.
+   * \brief Gets a global instance of the thread pool.
    *
-   * This can be used when there is no need to control the lifecycle of the thread pool.
+   * This can be used when there is no need to control the lifecycle of the thread pool. Its queue is bounded
+   * (at 256 tasks), and callers are blocked when it is full, so that a backlog of work cannot exhaust memory.
+   * Its size and CPU affinity can be specified using set_default_thread_count and set_default_affinity.
    *
-   * \return The default global instance of the thread pool.
+   * \return The global instance of the thread pool.
    */
   static ThreadPool& instance();
 
+  /**
+   * \brief Sets the CPUs to which the threads of the global instance of the thread pool will be restricted.
+   *
+   * This must be called before the global instance is first used (e.g. at the start of main) to have any effect.
+   *
+   * \param cpus  The CPUs to which to restrict the threads (empty means no restriction).
+   */
+  static void set_default_affinity(const std::vector<int>& cpus);
+
+  /**
+   * \brief Sets the number of threads with which the global instance of the thread pool will be constructed.
+   *
+   * This must be called before the global instance is first used (e.g. at the start of main) to have any effect.
+   *
+   * \param numThreads  The number of threads (0 means derive it from the hardware concurrency, or from the number of CPUs if specified).
+   */
+  static void set_default_thread_count(size_t numThreads);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Gets statistics about the tasks that have been executed by the thread pool.
+   *
+   * \return  The statistics.
+   */
+  Stats get_stats() const;
+
+  /**
+   * \brief Gets the number of threads in the pool.
+   *
+   * \return  The number of threads in the pool.
+   */
+  size_t get_thread_count() const;
+
   /**
    * \brief Posts a task to be executed by the thread pool.
    *
-   * \param task  The task to execute.
+   * If the queue is full, this either blocks until there is space, or drops a task, depending on the pool's overflow policy.
+   * Any exception thrown by the task is caught and reported on std::cerr, since there is no caller to which to propagate it.
+   *
+   * \param task      The task to execute.
+   * \param priority  The priority of the task.
+   * \return          true, if the task was queued, or false if it was dropped.
    */
   template <typename Task>
-  void post_task(Task task)
+  bool post_task(Task task, TaskPriority priority = TP_NORMAL)
   {
-    m_scheduler.post(task);
+    return post_task_sub(boost::function<void()>(task), priority);
   }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Posts a type-erased task to be executed by the thread pool.
+   *
+   * \param task      The task to execute.
+   * \param priority  The priority of the task.
+   * \return          true, if the task was queued, or false if it was dropped.
+   */
+  bool post_task_sub(const boost::function<void()>& task, TaskPriority priority);
+
+  /**
+   * \brief Runs one of the threads in the pool.
+   *
+   * \param workerIndex The index of the thread in the pool (used to identify it in any profiling trace).
+   */
+  void run_worker(size_t workerIndex);
 };
 
+//#################### STREAM OPERATORS ####################
+
+/**
+ * \brief Outputs the specified thread pool statistics to a stream.
+ *
+ * \param os    The stream to which to output the statistics.
+ * \param stats The statistics to output.
+ * \return      The stream.
+ */
+std::ostream& operator<<(std::ostream& os, const ThreadPool::Stats& stats);
+
 }
 
 #endif
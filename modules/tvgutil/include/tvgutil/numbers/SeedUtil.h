@@ -0,0 +1,61 @@
+/**
+ * tvgutil: SeedUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_SEEDUTIL
+#define H_TVGUTIL_SEEDUTIL
+
+#include <string>
+
+#include <boost/optional.hpp>
+
+#include "../misc/SettingsContainer.h"
+
+namespace tvgutil {
+
+/**
+ * \brief This struct provides utility functions for deriving the seeds of random number generators from a single root seed.
+ *
+ * In deterministic mode (enabled via the "deterministic" setting), every stochastic component derives its seed from the
+ * root seed (the "seed" setting) and a string describing what the seed is for. This ensures that the components use
+ * independent random streams, and that two runs with the same root seed perform identical work, even if components
+ * are added, removed or constructed in a different order.
+ */
+struct SeedUtil
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Derives a seed for a particular purpose from a root seed.
+   *
+   * The derivation depends only on its arguments (not on the platform or the order of any previous calls), so a given
+   * root seed and purpose always yield the same seed.
+   *
+   * \param rootSeed  The root seed.
+   * \param purpose   A string describing what the seed is for (e.g. "SemanticSegmentationComponent.trainingSampler").
+   * \return          The derived seed.
+   */
+  static unsigned int derive_seed(unsigned int rootSeed, const std::string& purpose);
+
+  /**
+   * \brief Gets the seed to use for a particular purpose if deterministic mode is enabled.
+   *
+   * \param settings  The settings.
+   * \param purpose   A string describing what the seed is for.
+   * \return          The seed derived from the root seed for the specified purpose, if deterministic mode is enabled, or boost::none otherwise.
+   */
+  static boost::optional<unsigned int> get_deterministic_seed(const SettingsContainer& settings, const std::string& purpose);
+
+  /**
+   * \brief Determines whether or not deterministic mode is enabled.
+   *
+   * \param settings  The settings.
+   * \return          true, if deterministic mode is enabled, or false otherwise.
+   */
+  static bool is_deterministic(const SettingsContainer& settings);
+};
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * tvgutil: BinaryBufferUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_BINARYBUFFERUTIL
+#define H_TVGUTIL_BINARYBUFFERUTIL
+
+#include <cstring>
+#include <vector>
+
+namespace tvgutil {
+
+/**
+ * \brief This struct provides utility functions for writing/reading arrays of plain values to/from in-memory binary buffers.
+ *
+ * The values are written in native byte order, so the buffers are only intended to be read back on the same kind of machine.
+ */
+struct BinaryBufferUtil
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Appends an array of values to a buffer.
+   *
+   * \param values  The values (may be NULL if count is 0).
+   * \param count   The number of values.
+   * \param out     The buffer.
+   */
+  template <typename T>
+  static inline void append_values(const T *values, size_t count, std::vector<unsigned char>& out)
+  {
+    if(count == 0) return;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(values);
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+  }
+
+  /**
+   * \brief Attempts to read an array of values from a buffer, advancing the read pointer past them.
+   *
+   * \param p       The read pointer.
+   * \param end     A pointer to the end of the buffer.
+   * \param values  The array into which to read the values (may be NULL if count is 0).
+   * \param count   The number of values.
+   * \return        true, if the values were successfully read, or false if there was not enough data left in the buffer.
+   */
+  template <typename T>
+  static inline bool read_values(const unsigned char *& p, const unsigned char *end, T *values, size_t count)
+  {
+    if(static_cast<size_t>(end - p) / sizeof(T) < count) return false;
+    if(count > 0) memcpy(values, p, count * sizeof(T));
+    p += count * sizeof(T);
+    return true;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * tvgutil: JSONUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_JSONUTIL
+#define H_TVGUTIL_JSONUTIL
+
+#include <string>
+
+namespace tvgutil {
+
+/**
+ * \brief This struct provides utility functions for writing JSON.
+ */
+struct JSONUtil
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Escapes any characters in a string that cannot appear unescaped in a JSON string.
+   *
+   * Quotes and backslashes are preceded by a backslash, and control characters (those below 0x20) are replaced
+   * by their short escape sequences (e.g. \n) where JSON has one, or by a \u00XX escape sequence otherwise.
+   *
+   * \param s The string.
+   * \return  The escaped string.
+   */
+  static std::string escape_string(const std::string& s);
+};
+
+}
+
+#endif
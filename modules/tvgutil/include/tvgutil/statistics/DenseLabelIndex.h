@@ -0,0 +1,156 @@
+/**
+ * tvgutil: DenseLabelIndex.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_DENSELABELINDEX
+#define H_TVGUTIL_DENSELABELINDEX
+
+#include <algorithm>
+#include <map>
+
+namespace tvgutil {
+
+/**
+ * \brief An instantiation of this struct template specifies whether or not a label type is small enough for labels of that type
+ *        to be indexed densely (i.e. using a fixed-size array with an entry for every possible label).
+ */
+template <typename Label>
+struct DenseLabelTraits
+{
+  /** Whether or not labels of this type can be indexed densely. */
+  static const bool IS_DENSE = false;
+
+  /** The number of possible labels of this type (only meaningful if IS_DENSE is true). */
+  static const size_t LABEL_COUNT = 0;
+};
+
+#define TVGUTIL_DENSE_LABEL_TYPE(Label, labelCount) \
+  template <> \
+  struct DenseLabelTraits<Label> \
+  { \
+    static const bool IS_DENSE = true; \
+    static const size_t LABEL_COUNT = labelCount; \
+  };
+
+TVGUTIL_DENSE_LABEL_TYPE(bool, 2)
+TVGUTIL_DENSE_LABEL_TYPE(char, 256)
+TVGUTIL_DENSE_LABEL_TYPE(signed char, 256)
+TVGUTIL_DENSE_LABEL_TYPE(unsigned char, 256)
+
+#undef TVGUTIL_DENSE_LABEL_TYPE
+
+/**
+ * \brief An instance of an instantiation of this class template provides fast lookup of the values in a map keyed by label.
+ *
+ * For most label types, this simply forwards to the map itself. For small label types (see the specialisation below),
+ * it maintains an array of pointers to the values in the map, so that lookups are O(1) rather than O(log n).
+ *
+ * Note that the index refers to the values of one specific map. If the map is copied, the copy's index must be rebuilt.
+ */
+template <typename Label, typename Value, bool Dense = DenseLabelTraits<Label>::IS_DENSE>
+class DenseLabelIndex
+{
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Looks up the value (if any) for the specified label.
+   *
+   * \param map   The map being indexed.
+   * \param label The label.
+   * \return      A pointer to the value for the label, if it is in the map, or NULL otherwise.
+   */
+  const Value *find(const std::map<Label,Value>& map, const Label& label) const
+  {
+    typename std::map<Label,Value>::const_iterator it = map.find(label);
+    return it != map.end() ? &it->second : NULL;
+  }
+
+  /**
+   * \brief Looks up the value for the specified label, inserting a default-constructed value into the map if necessary.
+   *
+   * \param map   The map being indexed.
+   * \param label The label.
+   * \return      The value for the label.
+   */
+  Value& lookup_or_insert(std::map<Label,Value>& map, const Label& label)
+  {
+    return map[label];
+  }
+
+  /**
+   * \brief Rebuilds the index for the specified map.
+   *
+   * \param map The map to index.
+   */
+  void rebuild(std::map<Label,Value>& map) {}
+};
+
+/**
+ * \brief An instance of an instantiation of this class template provides O(1) lookup of the values in a map keyed by a small label type.
+ */
+template <typename Label, typename Value>
+class DenseLabelIndex<Label,Value,true>
+{
+  //#################### CONSTANTS ####################
+private:
+  static const size_t LABEL_COUNT = DenseLabelTraits<Label>::LABEL_COUNT;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** Pointers to the values in the map for each possible label (NULL for labels that are not in the map). */
+  Value *m_values[LABEL_COUNT];
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an index for an empty map.
+   */
+  DenseLabelIndex()
+  {
+    std::fill(m_values, m_values + LABEL_COUNT, static_cast<Value*>(NULL));
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** See the primary template. */
+  const Value *find(const std::map<Label,Value>& map, const Label& label) const
+  {
+    return m_values[index_of(label)];
+  }
+
+  /** See the primary template. */
+  Value& lookup_or_insert(std::map<Label,Value>& map, const Label& label)
+  {
+    Value *& value = m_values[index_of(label)];
+    if(!value) value = &map[label];
+    return *value;
+  }
+
+  /** See the primary template. */
+  void rebuild(std::map<Label,Value>& map)
+  {
+    std::fill(m_values, m_values + LABEL_COUNT, static_cast<Value*>(NULL));
+    for(typename std::map<Label,Value>::iterator it = map.begin(), iend = map.end(); it != iend; ++it)
+    {
+      m_values[index_of(it->first)] = &it->second;
+    }
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets the index in the array of the specified label.
+   *
+   * \param label The label.
+   * \return      The index of the label in the array.
+   */
+  static size_t index_of(const Label& label)
+  {
+    return static_cast<unsigned char>(label);
+  }
+};
+
+}
+
+#endif
@@ -6,17 +6,23 @@
 #ifndef H_TVGUTIL_HISTOGRAM
 #define H_TVGUTIL_HISTOGRAM
 
+#include <algorithm>
 #include <map>
 #include <stdexcept>
 
 #include <boost/serialization/serialization.hpp>
 
+#include "DenseLabelIndex.h"
 #include "../containers/LimitedContainer.h"
 
 namespace tvgutil {
 
 /**
  * \brief An instance of an instantiation of this class template represents a histogram over the specified label type.
+ *
+ * For small label types (e.g. unsigned char), the bins are additionally indexed by a dense array, so that adding
+ * an instance of a label, or looking up the size of a bin, takes constant time rather than time logarithmic in
+ * the number of bins.
  */
 template <typename Label>
 class Histogram
@@ -29,6 +35,9 @@ private:
   /** The total number of instances that are in the histogram. */
   size_t m_count;
 
+  /** An index that provides fast lookup of the bins for small label types. */
+  DenseLabelIndex<Label,size_t> m_index;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -38,6 +47,33 @@ public:
   : m_count(0)
   {}
 
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+public:
+  /**
+   * \brief Constructs a copy of the specified histogram.
+   *
+   * \param rhs The histogram to copy.
+   */
+  Histogram(const Histogram& rhs)
+  : m_bins(rhs.m_bins), m_count(rhs.m_count)
+  {
+    m_index.rebuild(m_bins);
+  }
+
+  /**
+   * \brief Assigns the specified histogram to this one.
+   *
+   * \param rhs The histogram to assign.
+   * \return    This histogram.
+   */
+  Histogram& operator=(const Histogram& rhs)
+  {
+    m_bins = rhs.m_bins;
+    m_count = rhs.m_count;
+    m_index.rebuild(m_bins);
+    return *this;
+  }
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -47,10 +83,20 @@ public:
    */
   void add(const Label& label)
   {
-    ++m_bins[label];
+    ++m_index.lookup_or_insert(m_bins, label);
     ++m_count;
   }
 
+  /**
+   * \brief Removes all of the instances from the histogram.
+   */
+  void clear()
+  {
+    m_bins.clear();
+    m_count = 0;
+    m_index.rebuild(m_bins);
+  }
+
   /**
    * \brief Gets whether or not this is an empty histogram.
    *
@@ -61,6 +107,18 @@ public:
     return get_count() == 0;
   }
 
+  /**
+   * \brief Gets the number of instances of the specified label that are in the histogram.
+   *
+   * \param label The label.
+   * \return      The number of instances of the label that are in the histogram.
+   */
+  size_t get_bin_count(const Label& label) const
+  {
+    const size_t *binCount = m_index.find(m_bins, label);
+    return binCount ? *binCount : 0;
+  }
+
   /**
    * \brief Gets the bins that record the number of instances of each label that have been seen.
    *
@@ -81,6 +139,19 @@ public:
     return m_count;
   }
 
+  /**
+   * \brief Swaps the contents of this histogram with those of another one.
+   *
+   * \param rhs The histogram with which to swap contents.
+   */
+  void swap(Histogram& rhs)
+  {
+    m_bins.swap(rhs.m_bins);
+    std::swap(m_count, rhs.m_count);
+    m_index.rebuild(m_bins);
+    rhs.m_index.rebuild(rhs.m_bins);
+  }
+
   //#################### SERIALIZATION #################### 
 private:
   /**
@@ -94,6 +165,7 @@ private:
   {
     ar & m_bins;
     ar & m_count;
+    m_index.rebuild(m_bins);
   }
 
   friend class boost::serialization::access;
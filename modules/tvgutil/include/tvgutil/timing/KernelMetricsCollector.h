@@ -0,0 +1,228 @@
+/**
+ * tvgutil: KernelMetricsCollector.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_KERNELMETRICSCOLLECTOR
+#define H_TVGUTIL_KERNELMETRICSCOLLECTOR
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class can be used to collect hardware metrics for the CUDA kernels launched by a program, using CUPTI.
+ *
+ * Whilst the collector is running, it counts every kernel launch, and attributes it to the range that was innermost on the launching
+ * thread at the time. Ranges are pushed and popped by profiling scopes (see ProfilingScope), so they match the names of the stages
+ * timed by the profiler (e.g. "SLAM.Fusion"). In addition, every so often (once every sampleInterval launches of a given kernel in
+ * a given range), the collector measures one of a small set of metrics for the launch: the achieved occupancy and the DRAM read and
+ * write throughputs. The metrics are measured in rotation, one per sampled launch, since each of them can be collected in a single
+ * pass without replaying the kernel.
+ *
+ * Measuring a metric requires the device to be synchronised before and after the kernel, and the launches of any other threads to
+ * be held back whilst it runs, so sampling perturbs the timings of the stages concerned. The sample interval should thus be chosen
+ * to keep the perturbation acceptable (the timings of the unsampled launches are unaffected). Only the first CUDA context in which a
+ * kernel is launched is sampled, although launches in other contexts are still counted.
+ *
+ * If tvgutil was built without CUPTI support, the collector cannot be started, but ranges can still be pushed and popped.
+ */
+class KernelMetricsCollector
+{
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the metrics that can be measured for a kernel launch.
+   */
+  enum Metric
+  {
+    METRIC_ACHIEVED_OCCUPANCY,
+    METRIC_DRAM_READ_THROUGHPUT,
+    METRIC_DRAM_WRITE_THROUGHPUT,
+    METRIC_COUNT
+  };
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains the metrics collected for a kernel in a range.
+   */
+  struct KernelStats
+  {
+    /** The name of the kernel. */
+    std::string kernelName;
+
+    /** The number of times the kernel was launched in the range. */
+    size_t launchCount;
+
+    /** The mean values of the metrics over the launches for which they were measured (negative for any metric that was never measured). */
+    double meanValues[METRIC_COUNT];
+
+    /** The name of the range (empty for kernels that were launched outside any range). */
+    std::string rangeName;
+
+    /** The number of launches for which each metric was measured. */
+    size_t sampleCounts[METRIC_COUNT];
+  };
+
+private:
+  /**
+   * \brief An instance of this struct accumulates the metrics collected for a kernel in a range.
+   */
+  struct KernelRecord
+  {
+    /** The number of times the kernel has been launched in the range. */
+    size_t launchCount;
+
+    /** The number of launches for which each metric has been measured. */
+    size_t sampleCounts[METRIC_COUNT];
+
+    /** The sums of the values measured for each metric. */
+    double valueSums[METRIC_COUNT];
+
+    /**
+     * \brief Constructs an empty kernel record.
+     */
+    KernelRecord();
+  };
+
+  /** The state needed to interact with CUPTI, together with the CUPTI callback (defined in the source file, so as not to expose CUPTI here). */
+  struct CUPTIState;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The state needed to interact with CUPTI (if the collector is running). */
+  boost::scoped_ptr<CUPTIState> m_cuptiState;
+
+  /** A flag indicating whether or not the collector is running. */
+  boost::atomic<bool> m_enabled;
+
+  /** The records of the kernels that have been launched, keyed by (range name, kernel name). */
+  std::map<std::pair<std::string,std::string>,KernelRecord> m_kernelRecords;
+
+  /** The mutex used to protect the kernel records. */
+  mutable boost::mutex m_mutex;
+
+  /** The stack of ranges on each thread (innermost last). */
+  boost::thread_specific_ptr<std::vector<const char*> > m_rangeStacks;
+
+  /** The number of launches of each kernel in each range between successive measurements of a metric. */
+  size_t m_sampleInterval;
+
+  /** The mutex held whilst a launch is being sampled, to hold back the launches of other threads. */
+  boost::mutex m_samplingMutex;
+
+  //#################### SINGLETON IMPLEMENTATION ####################
+private:
+  /**
+   * \brief Constructs the kernel metrics collector.
+   */
+  KernelMetricsCollector();
+
+  /**
+   * \brief Destroys the kernel metrics collector.
+   */
+  ~KernelMetricsCollector();
+
+  // Deliberately private and unimplemented.
+  KernelMetricsCollector(const KernelMetricsCollector&);
+  KernelMetricsCollector& operator=(const KernelMetricsCollector&);
+
+public:
+  /**
+   * \brief Gets the singleton instance of the kernel metrics collector.
+   *
+   * \return  The singleton instance of the kernel metrics collector.
+   */
+  static KernelMetricsCollector& instance();
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the name of the specified metric.
+   *
+   * \param metric  The metric.
+   * \return        The name of the metric (as used in the CSV output).
+   */
+  static const char *get_metric_name(Metric metric);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Writes the metrics collected so far to a CSV file (one row per kernel per range).
+   *
+   * The throughputs are written in GB/s, and any metric that was never measured for a kernel is left empty.
+   *
+   * \param path                The path to the file.
+   * \throws std::runtime_error If the file cannot be written.
+   */
+  void export_csv(const std::string& path) const;
+
+  /**
+   * \brief Gets the metrics collected so far, ordered by range name and then kernel name.
+   *
+   * \return  The metrics collected so far.
+   */
+  std::vector<KernelStats> get_kernel_stats() const;
+
+  /**
+   * \brief Gets whether or not the collector is running.
+   *
+   * \return  true, if the collector is running, or false otherwise.
+   */
+  bool is_enabled() const;
+
+  /**
+   * \brief Pops the innermost range from the current thread's stack of ranges.
+   *
+   * \note  This does nothing if the current thread's stack of ranges is empty.
+   */
+  void pop_range();
+
+  /**
+   * \brief Pushes a range onto the current thread's stack of ranges.
+   *
+   * \param rangeName The name of the range (this must outlive the range, and is normally a string literal).
+   */
+  void push_range(const char *rangeName);
+
+  /**
+   * \brief Clears all of the metrics that have been collected so far.
+   */
+  void reset();
+
+  /**
+   * \brief Starts collecting metrics for the kernels that are launched from now on.
+   *
+   * \param sampleInterval          The number of launches of each kernel in each range between successive measurements of a metric.
+   * \throws std::invalid_argument  If the sample interval is zero.
+   * \throws std::runtime_error     If tvgutil was built without CUPTI support, or if CUPTI cannot be initialised.
+   */
+  void start(size_t sampleInterval);
+
+  /**
+   * \brief Stops collecting metrics (the metrics collected so far are kept until the collector is reset).
+   */
+  void stop();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets the name of the innermost range on the current thread.
+   *
+   * \return  The name of the innermost range on the current thread, or the empty string if there is none.
+   */
+  std::string get_current_range_name() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * tvgutil: PerformanceBaseline.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_PERFORMANCEBASELINE
+#define H_TVGUTIL_PERFORMANCEBASELINE
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class holds a set of baseline timings against which new measurements can be compared,
+ *        so that performance regressions can be detected.
+ *
+ * Each timing is identified by a key (e.g. the name of a kernel, together with the device and input on which it was run).
+ * Since timings are only comparable on the same machine, baselines are intended to be stored per machine: see
+ * get_machine_baseline_path. A measurement is classified as slower (or faster) than its baseline if it differs from
+ * it by more than the specified tolerance, which should be chosen to exceed the run-to-run noise of the measurements.
+ *
+ * Baselines are stored as text, one timing per line, in the form "<milliseconds> <key>".
+ */
+class PerformanceBaseline
+{
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the possible outcomes of comparing a measurement with its baseline.
+   */
+  enum Verdict
+  {
+    /** The measurement is faster than its baseline by more than the tolerance. */
+    VERDICT_FASTER,
+
+    /** There is no baseline for the measurement. */
+    VERDICT_NEW,
+
+    /** The measurement is slower than its baseline by more than the tolerance. */
+    VERDICT_SLOWER,
+
+    /** The measurement is within the tolerance of its baseline. */
+    VERDICT_UNCHANGED
+  };
+
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents the result of comparing a measurement with its baseline.
+   */
+  struct Comparison
+  {
+    /** The baseline timing (in milliseconds), if any. */
+    boost::optional<double> baselineMs;
+
+    /** The key identifying the timing. */
+    std::string key;
+
+    /** The measured timing (in milliseconds). */
+    double measuredMs;
+
+    /** The outcome of the comparison. */
+    Verdict verdict;
+  };
+
+  /**
+   * \brief An instance of this struct represents a single timing measurement.
+   */
+  struct Measurement
+  {
+    /** The key identifying the timing. */
+    std::string key;
+
+    /** The measured timing (in milliseconds). */
+    double measuredMs;
+
+    Measurement(const std::string& key_, double measuredMs_)
+    : key(key_), measuredMs(measuredMs_)
+    {}
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The baseline timings (in milliseconds), indexed by key. */
+  std::map<std::string,double> m_baselineMs;
+
+  /** The fraction by which a measurement must differ from its baseline for it to be classified as faster or slower. */
+  double m_tolerance;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an empty performance baseline.
+   *
+   * \param tolerance              The fraction by which a measurement must differ from its baseline to be classified as faster or slower.
+   * \throws std::invalid_argument  If the tolerance is negative.
+   */
+  explicit PerformanceBaseline(double tolerance = 0.15);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the path of the file in the specified directory in which the baselines for the current machine are stored.
+   *
+   * The machine is identified by the SPAINT_PERF_MACHINE environment variable, if it is set, or by its host name otherwise.
+   *
+   * \param dir The directory.
+   * \return    The path of the file in which the baselines for the current machine are stored.
+   */
+  static std::string get_machine_baseline_path(const std::string& dir);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Compares a set of measurements with their baselines, and outputs a report of the comparisons to a stream.
+   *
+   * \param measurements  The measurements.
+   * \param os            The stream.
+   * \return              true, if none of the measurements is slower than its baseline, or false otherwise.
+   */
+  bool check(const std::vector<Measurement>& measurements, std::ostream& os) const;
+
+  /**
+   * \brief Compares a measurement with its baseline.
+   *
+   * \param key         The key identifying the timing.
+   * \param measuredMs  The measured timing (in milliseconds).
+   * \return            The result of the comparison.
+   */
+  Comparison compare(const std::string& key, double measuredMs) const;
+
+  /**
+   * \brief Gets the baseline timing with the specified key (if any).
+   *
+   * \param key The key identifying the timing.
+   * \return    The baseline timing (in milliseconds), if any, or boost::none otherwise.
+   */
+  boost::optional<double> get_baseline_ms(const std::string& key) const;
+
+  /**
+   * \brief Loads baseline timings from a file, replacing any existing baselines with the same keys.
+   *
+   * \param filename            The name of the file.
+   * \return                    true, if the file existed and was loaded, or false if it did not exist.
+   * \throws std::runtime_error If the file exists, but is not a valid baseline file.
+   */
+  bool load(const std::string& filename);
+
+  /**
+   * \brief Saves the baseline timings to a file.
+   *
+   * \param filename            The name of the file.
+   * \throws std::runtime_error If the file cannot be written.
+   */
+  void save(const std::string& filename) const;
+
+  /**
+   * \brief Sets the baseline timing with the specified key.
+   *
+   * \param key                    The key identifying the timing.
+   * \param baselineMs             The baseline timing (in milliseconds).
+   * \throws std::invalid_argument If the key is empty, starts with whitespace or contains a newline, or the baseline timing is negative.
+   */
+  void set_baseline_ms(const std::string& key, double baselineMs);
+};
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * tvgutil: PlacementController.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_PLACEMENTCONTROLLER
+#define H_TVGUTIL_PLACEMENTCONTROLLER
+
+#include <stdexcept>
+#include <vector>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class can be used to choose where (e.g. on the CPU or the GPU) to run a piece of work each frame, based on its measured cost.
+ *
+ * Each way of doing the work (an "alternative") has a cost estimate, which is an exponentially-smoothed average of the
+ * costs measured for it so far. Each time it is asked, the controller chooses the alternative with the lowest estimate.
+ * Since the relative costs of the alternatives can change over time (e.g. as the load on the GPU changes), every so often
+ * the controller instead chooses whichever other alternative was measured least recently, so as to keep its estimate fresh.
+ * Any alternative that has not yet been measured is chosen before all of the others.
+ */
+class PlacementController
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of choices made so far. */
+  size_t m_choiceCount;
+
+  /** The estimated cost of each alternative (only meaningful for alternatives that have been measured). */
+  std::vector<double> m_estimatedCosts;
+
+  /** The number of choices that had been made when each alternative was last measured (or zero if it has never been measured). */
+  std::vector<size_t> m_lastMeasured;
+
+  /** Whether or not each alternative has been measured. */
+  std::vector<bool> m_measured;
+
+  /** The number of choices between successive probes of the alternatives that are not currently the cheapest. */
+  size_t m_probeInterval;
+
+  /** The weight given to each new measurement when updating the cost estimate of an alternative (in (0,1]). */
+  double m_smoothingFactor;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a placement controller.
+   *
+   * \param alternativeCount        The number of alternatives from which to choose.
+   * \param probeInterval           The number of choices between successive probes of the alternatives that are not currently the cheapest.
+   * \param smoothingFactor         The weight to give each new measurement when updating the cost estimate of an alternative.
+   * \throws std::invalid_argument  If there are no alternatives, the probe interval is zero or the smoothing factor is not in (0,1].
+   */
+  PlacementController(size_t alternativeCount, size_t probeInterval, double smoothingFactor = 0.25)
+  : m_choiceCount(0),
+    m_estimatedCosts(alternativeCount, 0.0),
+    m_lastMeasured(alternativeCount, 0),
+    m_measured(alternativeCount, false),
+    m_probeInterval(probeInterval),
+    m_smoothingFactor(smoothingFactor)
+  {
+    if(alternativeCount == 0) throw std::invalid_argument("Error: A placement controller must have at least one alternative");
+    if(probeInterval == 0) throw std::invalid_argument("Error: The probe interval of a placement controller must be positive");
+    if(smoothingFactor <= 0.0 || smoothingFactor > 1.0) throw std::invalid_argument("Error: The smoothing factor of a placement controller must be in (0,1]");
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Chooses the alternative to use for the next piece of work.
+   *
+   * This should be called exactly once per piece of work, and followed by a call to update with the measured cost.
+   *
+   * \return  The index of the chosen alternative.
+   */
+  size_t choose()
+  {
+    ++m_choiceCount;
+
+    // If any alternative has not yet been measured, choose it.
+    for(size_t i = 0, size = m_measured.size(); i < size; ++i)
+    {
+      if(!m_measured[i]) return i;
+    }
+
+    // Otherwise, find the cheapest alternative.
+    const size_t cheapest = get_cheapest_alternative();
+
+    // If it's time to probe, choose the other alternative that was measured least recently, else choose the cheapest one.
+    if(m_measured.size() == 1 || m_choiceCount % m_probeInterval != 0) return cheapest;
+
+    size_t stalest = cheapest == 0 ? 1 : 0;
+    for(size_t i = 0, size = m_measured.size(); i < size; ++i)
+    {
+      if(i != cheapest && m_lastMeasured[i] < m_lastMeasured[stalest]) stalest = i;
+    }
+
+    return stalest;
+  }
+
+  /**
+   * \brief Gets the alternative that currently has the lowest estimated cost.
+   *
+   * \return  The index of the alternative that currently has the lowest estimated cost (unmeasured alternatives are ignored,
+   *          unless none of the alternatives have been measured, in which case the first alternative is returned).
+   */
+  size_t get_cheapest_alternative() const
+  {
+    size_t cheapest = 0;
+    for(size_t i = 0, size = m_measured.size(); i < size; ++i)
+    {
+      if(m_measured[i] && (!m_measured[cheapest] || m_estimatedCosts[i] < m_estimatedCosts[cheapest])) cheapest = i;
+    }
+    return cheapest;
+  }
+
+  /**
+   * \brief Gets the estimated cost of the specified alternative.
+   *
+   * \param alternative The index of the alternative.
+   * \return            The estimated cost of the alternative, or a negative value if it has not yet been measured.
+   */
+  double get_estimated_cost(size_t alternative) const
+  {
+    return m_measured[alternative] ? m_estimatedCosts[alternative] : -1.0;
+  }
+
+  /**
+   * \brief Updates the cost estimate of an alternative based on a measurement of the cost of using it.
+   *
+   * \param alternative The index of the alternative that was used.
+   * \param cost        The measured cost of using it.
+   */
+  void update(size_t alternative, double cost)
+  {
+    m_estimatedCosts[alternative] = m_measured[alternative] ? m_estimatedCosts[alternative] + m_smoothingFactor * (cost - m_estimatedCosts[alternative]) : cost;
+    m_lastMeasured[alternative] = m_choiceCount;
+    m_measured[alternative] = true;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,425 @@
+/**
+ * tvgutil: Profiler.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_PROFILER
+#define H_TVGUTIL_PROFILER
+
+#include <deque>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/thread.hpp>
+
+#ifdef WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class can be used to collect timings for the named stages of a program.
+ *
+ * Stages are normally timed using a ProfilingScope. CPU timings are recorded as soon as a stage finishes. GPU timings
+ * are recorded using pairs of CUDA events on the default stream, and are only resolved (without any synchronisation)
+ * when update is called, once the GPU has actually reached the end of the stage. For each stage, the profiler keeps
+ * a rolling window of recent durations from which it computes percentiles. It also keeps a bounded trace of recent
+ * samples, which can be exported to a CSV file, or to a JSON file that can be viewed in Chrome's trace viewer.
+ *
+ * The profiler is disabled by default, in which case timing a stage costs no more than checking a flag.
+ * CPU stages can be timed on any thread, and threads can be given names so that they can be identified in the
+ * trace (e.g. the main thread, image grabbers and thread pool workers). GPU stages can be timed on any stream
+ * of the current device, and each stream is shown separately in the trace, so that overlap can be seen.
+ *
+ * In addition to timings, the profiler can hold the current values of named gauges (e.g. the work budgets chosen by adaptive
+ * components), so that they can be shown alongside the timings. Gauges are always recorded, even if the profiler is disabled.
+ */
+class Profiler
+{
+  //#################### ENUMERATIONS ####################
+public:
+  /**
+   * \brief The values of this enumeration denote the devices on which stages can be timed.
+   */
+  enum Device
+  {
+    DEVICE_CPU,
+    DEVICE_GPU
+  };
+
+  //#################### NESTED TYPES ####################
+public:
+  typedef boost::chrono::steady_clock Clock;
+
+  /**
+   * \brief An instance of this struct contains statistics about the recent durations of a stage.
+   */
+  struct StageStats
+  {
+    /** The number of times the stage has been timed since the profiler was last reset. */
+    size_t count;
+
+    /** The device on which the stage was timed. */
+    Device device;
+
+    /** The duration (in milliseconds) of the most recent run of the stage. */
+    double lastMs;
+
+    /** The mean duration (in milliseconds) of the runs of the stage in the rolling window. */
+    double meanMs;
+
+    /** The name of the stage. */
+    std::string name;
+
+    /** The median duration (in milliseconds) of the runs of the stage in the rolling window. */
+    double p50Ms;
+
+    /** The 90th percentile duration (in milliseconds) of the runs of the stage in the rolling window. */
+    double p90Ms;
+
+    /** The 95th percentile duration (in milliseconds) of the runs of the stage in the rolling window. */
+    double p95Ms;
+
+    /** The 99th percentile duration (in milliseconds) of the runs of the stage in the rolling window. */
+    double p99Ms;
+  };
+
+private:
+  /**
+   * \brief An instance of this struct represents a single timed run of a stage.
+   */
+  struct Sample
+  {
+    /** The duration of the run (in milliseconds). */
+    double durationMs;
+
+    /** The index of the stage in the stage list. */
+    size_t stageIndex;
+
+    /** The time at which the run started (in milliseconds since the profiler's epoch). */
+    double startMs;
+
+    /** The index of the thread (for a CPU stage) or stream (for a GPU stage) on which the run occurred. */
+    int threadIndex;
+  };
+
+  /**
+   * \brief An instance of this struct contains the timing information for a stage.
+   */
+  struct Stage
+  {
+    /** The number of times the stage has been timed since the profiler was last reset. */
+    size_t count;
+
+    /** The device on which the stage was timed. */
+    Device device;
+
+    /** The durations (in milliseconds) of the most recent runs of the stage. */
+    std::deque<double> durationsMs;
+
+    /** The name of the stage. */
+    std::string name;
+  };
+
+#ifdef WITH_CUDA
+  /**
+   * \brief An instance of this struct represents a GPU stage whose timing has not yet been resolved.
+   */
+  struct PendingGPUStage
+  {
+    /** The index of the stage in the stage list. */
+    size_t stageIndex;
+
+    /** The event recorded at the start of the stage. */
+    cudaEvent_t startEvent;
+
+    /** The event recorded at the end of the stage. */
+    cudaEvent_t stopEvent;
+
+    /** The index of the stream on which the stage ran. */
+    int streamIndex;
+  };
+#endif
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A flag indicating whether or not the profiler is enabled. */
+  boost::atomic<bool> m_enabled;
+
+  /** The time relative to which the start times of the samples are recorded. */
+  Clock::time_point m_epoch;
+
+  /** A map from gauge names to the indices of the corresponding gauges in the gauge list. */
+  std::map<std::string,size_t> m_gaugeIndices;
+
+  /** The gauges that have been set (as name/value pairs), in the order in which they were first set. */
+  std::vector<std::pair<std::string,double> > m_gauges;
+
+#ifdef WITH_CUDA
+  /** An event recorded (and synchronised) at a known CPU time, relative to which the start times of GPU stages are computed. */
+  cudaEvent_t m_gpuEpochEvent;
+
+  /** The CPU time (in milliseconds since the profiler's epoch) at which the GPU epoch event completed (negative if it has never been recorded). */
+  double m_gpuEpochMs;
+
+  /** Events that have been created and are available for reuse. */
+  std::vector<cudaEvent_t> m_freeEvents;
+
+  /** The GPU stages whose timings have not yet been resolved, in the order in which they were recorded. */
+  std::deque<PendingGPUStage> m_pendingGPUStages;
+
+  /** A map from CUDA streams to the small indices used to identify them in the trace (the default stream has index 0). */
+  std::map<cudaStream_t,int> m_streamIndices;
+#endif
+
+  /** The maximum number of samples to keep in the trace. */
+  size_t m_maxTraceSize;
+
+  /** The mutex used to protect the profiler's state (other than the enabled flag). */
+  mutable boost::mutex m_mutex;
+
+  /** Maps (one per device) from stage names to the indices of the corresponding stages in the stage list. */
+  std::map<std::string,size_t> m_stageIndices[2];
+
+  /** The stages that have been timed. */
+  std::vector<Stage> m_stages;
+
+  /** A map from thread IDs to the small indices used to identify the threads in the trace. */
+  std::map<boost::thread::id,int> m_threadIndices;
+
+  /** A map from thread indices to the names (if any) that have been given to the corresponding threads. */
+  std::map<int,std::string> m_threadNames;
+
+  /** The most recent samples (in the order in which they were recorded). */
+  std::deque<Sample> m_trace;
+
+  /** The number of recent runs of each stage from which to compute percentiles. */
+  size_t m_windowSize;
+
+  //#################### SINGLETON IMPLEMENTATION ####################
+private:
+  /**
+   * \brief Constructs the profiler.
+   */
+  Profiler();
+
+  /**
+   * \brief Destroys the profiler.
+   */
+  ~Profiler();
+
+  // Deliberately private and unimplemented.
+  Profiler(const Profiler&);
+  Profiler& operator=(const Profiler&);
+
+public:
+  /**
+   * \brief Gets the singleton instance of the profiler.
+   *
+   * \return  The singleton instance of the profiler.
+   */
+  static Profiler& instance();
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Writes the samples in the trace to a JSON file in the Chrome trace event format.
+   *
+   * \param path                The path to the file.
+   * \throws std::runtime_error If the file cannot be written.
+   */
+  void export_chrome_trace(const std::string& path) const;
+
+  /**
+   * \brief Writes the samples in the trace to a CSV file (one row per sample).
+   *
+   * \param path                The path to the file.
+   * \throws std::runtime_error If the file cannot be written.
+   */
+  void export_csv(const std::string& path) const;
+
+  /**
+   * \brief Gets the current values of all of the gauges that have been set, in the order in which they were first set.
+   *
+   * \return  The gauges, as name/value pairs.
+   */
+  std::vector<std::pair<std::string,double> > get_gauges() const;
+
+  /**
+   * \brief Gets statistics about the recent durations of all of the stages that have been timed, in the order in which they were first timed.
+   *
+   * \return  The statistics.
+   */
+  std::vector<StageStats> get_stage_stats() const;
+
+  /**
+   * \brief Gets whether or not the profiler is enabled.
+   *
+   * \return  true, if the profiler is enabled, or false otherwise.
+   */
+  bool is_enabled() const;
+
+  /**
+   * \brief Records a run of a stage on the CPU.
+   *
+   * \param stageName The name of the stage.
+   * \param t0        The time at which the run started.
+   * \param t1        The time at which the run finished.
+   */
+  void record_cpu_stage(const char *stageName, const Clock::time_point& t0, const Clock::time_point& t1);
+
+  /**
+   * \brief Clears all of the timings that have been recorded so far.
+   *
+   * \note  Gauges are not cleared, since they represent current values rather than history.
+   */
+  void reset();
+
+  /**
+   * \brief Enables or disables the profiler.
+   *
+   * \param enabled Whether or not the profiler should be enabled.
+   */
+  void set_enabled(bool enabled);
+
+  /**
+   * \brief Sets the current value of the specified gauge (creating the gauge if necessary).
+   *
+   * \param name  The name of the gauge.
+   * \param value The value of the gauge.
+   */
+  void set_gauge(const std::string& name, double value);
+
+  /**
+   * \brief Sets the maximum number of samples to keep in the trace.
+   *
+   * \param maxTraceSize  The maximum number of samples to keep in the trace.
+   */
+  void set_max_trace_size(size_t maxTraceSize);
+
+  /**
+   * \brief Sets the name with which to identify the current thread in the trace.
+   *
+   * \param name  The name with which to identify the current thread in the trace.
+   */
+  void set_thread_name(const std::string& name);
+
+  /**
+   * \brief Sets the number of recent runs of each stage from which to compute percentiles.
+   *
+   * \param windowSize              The number of recent runs of each stage from which to compute percentiles.
+   * \throws std::invalid_argument  If the window size is zero.
+   */
+  void set_window_size(size_t windowSize);
+
+  /**
+   * \brief Resolves the timings of any GPU stages that the GPU has finished executing.
+   *
+   * This never waits for the GPU, and should be called periodically (e.g. once per frame).
+   */
+  void update();
+
+#ifdef WITH_CUDA
+  /**
+   * \brief Records an event on the specified stream to mark the start of a GPU stage.
+   *
+   * \param stream  The stream on which the stage will run.
+   * \return        The event.
+   */
+  cudaEvent_t start_gpu_stage(cudaStream_t stream = 0);
+
+  /**
+   * \brief Records an event on the specified stream to mark the end of a GPU stage, and queues the stage for resolution.
+   *
+   * \param stageName   The name of the stage.
+   * \param startEvent  The event that was recorded to mark the start of the stage.
+   * \param stream      The stream on which the stage ran (this must be the one on which the start event was recorded).
+   */
+  void stop_gpu_stage(const char *stageName, cudaEvent_t startEvent, cudaStream_t stream = 0);
+#endif
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+#ifdef WITH_CUDA
+  /**
+   * \brief Gets an event that can be recorded, reusing an existing one if possible.
+   *
+   * \note  The caller must hold the mutex.
+   *
+   * \return  The event.
+   */
+  cudaEvent_t acquire_event();
+#endif
+
+  /**
+   * \brief Gets the index of the specified stage in the stage list, adding it if necessary.
+   *
+   * \note  The caller must hold the mutex.
+   *
+   * \param stageName The name of the stage.
+   * \param device    The device on which the stage is timed.
+   * \return          The index of the stage in the stage list.
+   */
+  size_t lookup_stage(const std::string& stageName, Device device);
+
+#ifdef WITH_CUDA
+  /**
+   * \brief Gets the index used to identify the specified stream in the trace, allocating a new one if necessary.
+   *
+   * \note  The caller must hold the mutex.
+   *
+   * \param stream  The stream.
+   * \return        The index used to identify the stream in the trace.
+   */
+  int lookup_stream(cudaStream_t stream);
+#endif
+
+  /**
+   * \brief Gets the index used to identify the current thread in the trace, allocating a new one if necessary.
+   *
+   * \note  The caller must hold the mutex.
+   *
+   * \return  The index used to identify the current thread in the trace.
+   */
+  int lookup_thread();
+
+  /**
+   * \brief Records a sample.
+   *
+   * \note  The caller must hold the mutex.
+   *
+   * \param stageIndex  The index of the stage in the stage list.
+   * \param startMs     The time at which the run started (in milliseconds since the profiler's epoch).
+   * \param durationMs  The duration of the run (in milliseconds).
+   * \param threadIndex The index of the thread (for a CPU stage) or stream (for a GPU stage) on which the run occurred.
+   */
+  void record_sample(size_t stageIndex, double startMs, double durationMs, int threadIndex);
+
+  /**
+   * \brief Converts a time point to the number of milliseconds since the profiler's epoch.
+   *
+   * \param t The time point.
+   * \return  The number of milliseconds since the profiler's epoch.
+   */
+  double to_ms(const Clock::time_point& t) const;
+};
+
+//#################### STREAM OPERATORS ####################
+
+/**
+ * \brief Outputs the specified stage statistics to a stream.
+ *
+ * \param os    The stream to which to output the statistics.
+ * \param stats The statistics to output.
+ * \return      The stream.
+ */
+std::ostream& operator<<(std::ostream& os, const Profiler::StageStats& stats);
+
+}
+
+#endif
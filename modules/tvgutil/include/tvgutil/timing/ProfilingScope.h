@@ -0,0 +1,105 @@
+/**
+ * tvgutil: ProfilingScope.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_PROFILINGSCOPE
+#define H_TVGUTIL_PROFILINGSCOPE
+
+#include "KernelMetricsCollector.h"
+#include "Profiler.h"
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class can be used to time a stage of a program for the profiler, from the point at which
+ *        it is constructed to the point at which it goes out of scope.
+ *
+ * If the profiler is disabled when the scope is constructed, nothing is timed. If the stage is to be timed on the GPU as well,
+ * its GPU time is measured using CUDA events, which means that it covers the GPU work issued (on the default stream) whilst
+ * the scope was active. Its CPU time in that case only covers the time taken to issue the work, unless there are other syncs.
+ * If the kernel metrics collector is running, the stage is also pushed as a range, so that the kernels launched during it are
+ * attributed to it.
+ */
+class ProfilingScope
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** Whether or not the stage is being timed (i.e. whether or not the profiler was enabled when the scope was constructed). */
+  bool m_active;
+
+#ifdef WITH_CUDA
+  /** The event recorded at the start of the stage, if it is being timed on the GPU (NULL otherwise). */
+  cudaEvent_t m_gpuStartEvent;
+#endif
+
+  /** Whether or not the stage was pushed as a range onto the kernel metrics collector. */
+  bool m_rangePushed;
+
+  /** The name of the stage (this must outlive the scope, and is normally a string literal). */
+  const char *m_stageName;
+
+  /** The time at which the stage started. */
+  Profiler::Clock::time_point m_t0;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a profiling scope, and starts timing the specified stage if the profiler is enabled.
+   *
+   * \param stageName The name of the stage (this must outlive the scope, and is normally a string literal).
+   * \param timeGPU   Whether or not to also time the GPU work issued during the stage (this is ignored if CUDA support is unavailable).
+   */
+  explicit ProfilingScope(const char *stageName, bool timeGPU = false)
+  : m_active(Profiler::instance().is_enabled()),
+#ifdef WITH_CUDA
+    m_gpuStartEvent(NULL),
+#endif
+    m_rangePushed(false),
+    m_stageName(stageName)
+  {
+    if(!m_active) return;
+
+    KernelMetricsCollector& collector = KernelMetricsCollector::instance();
+    if(collector.is_enabled())
+    {
+      collector.push_range(stageName);
+      m_rangePushed = true;
+    }
+
+#ifdef WITH_CUDA
+    if(timeGPU) m_gpuStartEvent = Profiler::instance().start_gpu_stage();
+#endif
+
+    m_t0 = Profiler::Clock::now();
+  }
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the profiling scope, recording the time taken by the stage if it was being timed.
+   */
+  ~ProfilingScope()
+  {
+    if(!m_active) return;
+
+    Profiler& profiler = Profiler::instance();
+    profiler.record_cpu_stage(m_stageName, m_t0, Profiler::Clock::now());
+
+#ifdef WITH_CUDA
+    if(m_gpuStartEvent) profiler.stop_gpu_stage(m_stageName, m_gpuStartEvent);
+#endif
+
+    if(m_rangePushed) KernelMetricsCollector::instance().pop_range();
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ProfilingScope(const ProfilingScope&);
+  ProfilingScope& operator=(const ProfilingScope&);
+};
+
+}
+
+#endif
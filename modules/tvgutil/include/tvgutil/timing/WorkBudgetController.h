@@ -0,0 +1,143 @@
+/**
+ * tvgutil: WorkBudgetController.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_WORKBUDGETCONTROLLER
+#define H_TVGUTIL_WORKBUDGETCONTROLLER
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class can be used to adapt the amount of work done by a component each frame so as to hold its cost near a target.
+ *
+ * The work is measured in arbitrary units (e.g. voxels, node splits or runs of a stage). After each piece of work, the
+ * controller is told how many units were done and how long they took. From this it estimates the current cost per
+ * unit, and moves the budget (the number of units to do next time) a fraction of the way towards the number of units
+ * that would exactly meet the target. The budget is always kept within a fixed range, since the underlying work will
+ * normally have hard limits (e.g. the sizes of pre-allocated buffers).
+ *
+ * The budget may be fractional. A budget of less than one unit per frame can be used to run an expensive stage on only
+ * some frames: see accrue, which accumulates the budget over successive frames and reports when a whole unit is due.
+ */
+class WorkBudgetController
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The current budget (in units of work). */
+  double m_budget;
+
+  /** The budget accumulated over the frames since a unit of work was last done (see accrue). */
+  double m_credit;
+
+  /** The maximum budget. */
+  double m_maxBudget;
+
+  /** The minimum budget. */
+  double m_minBudget;
+
+  /** The fraction of the way towards the ideal budget that the budget moves on each update (in (0,1]). */
+  double m_responsiveness;
+
+  /** The target cost (e.g. in milliseconds) of the work done each frame. */
+  double m_targetCost;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a work budget controller.
+   *
+   * \param targetCost              The target cost (e.g. in milliseconds) of the work done each frame.
+   * \param minBudget               The minimum budget.
+   * \param maxBudget               The maximum budget.
+   * \param initialBudget           The initial budget (this will be clamped to [minBudget,maxBudget]).
+   * \param responsiveness          The fraction of the way towards the ideal budget that the budget should move on each update.
+   * \throws std::invalid_argument  If the target cost is not positive, the budget range is empty or the responsiveness is not in (0,1].
+   */
+  WorkBudgetController(double targetCost, double minBudget, double maxBudget, double initialBudget, double responsiveness = 0.25)
+  : m_credit(0.0), m_maxBudget(maxBudget), m_minBudget(minBudget), m_responsiveness(responsiveness), m_targetCost(targetCost)
+  {
+    if(targetCost <= 0.0) throw std::invalid_argument("Error: The target cost of a work budget controller must be positive");
+    if(minBudget < 0.0 || minBudget > maxBudget) throw std::invalid_argument("Error: The budget range of a work budget controller must be non-empty and non-negative");
+    if(responsiveness <= 0.0 || responsiveness > 1.0) throw std::invalid_argument("Error: The responsiveness of a work budget controller must be in (0,1]");
+
+    m_budget = clamp(initialBudget);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds the current budget to the credit accumulated since a unit of work was last done, and determines whether or not a unit is now due.
+   *
+   * If a unit is due, the credit is reduced by one, so this should be called exactly once per frame.
+   *
+   * \return  true, if a unit of work is due this frame, or false otherwise.
+   */
+  bool accrue()
+  {
+    // Note: Capping the credit prevents a backlog from building up whilst the budget is above one unit per frame.
+    m_credit = std::min(m_credit + m_budget, std::max(m_budget, 1.0));
+    if(m_credit < 1.0) return false;
+
+    m_credit -= 1.0;
+    return true;
+  }
+
+  /**
+   * \brief Gets the current budget.
+   *
+   * \return  The current budget.
+   */
+  double get_budget() const
+  {
+    return m_budget;
+  }
+
+  /**
+   * \brief Gets the target cost of the work done each frame.
+   *
+   * \return  The target cost of the work done each frame.
+   */
+  double get_target_cost() const
+  {
+    return m_targetCost;
+  }
+
+  /**
+   * \brief Updates the budget based on a measurement of the cost of some work.
+   *
+   * \param workDone  The number of units of work that were done.
+   * \param cost      The cost of doing them.
+   */
+  void update(double workDone, double cost)
+  {
+    // If no work was done, we learn nothing about its cost.
+    if(workDone <= 0.0) return;
+
+    // If the work was effectively free, allow the budget to grow as far as possible.
+    const double unitCost = cost / workDone;
+    const double idealBudget = unitCost > 0.0 ? m_targetCost / unitCost : m_maxBudget;
+
+    m_budget = clamp(m_budget + m_responsiveness * (idealBudget - m_budget));
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Clamps the specified budget to the controller's budget range.
+   *
+   * \param budget  The budget.
+   * \return        The clamped budget.
+   */
+  double clamp(double budget) const
+  {
+    return std::max(m_minBudget, std::min(budget, m_maxBudget));
+  }
+};
+
+}
+
+#endif
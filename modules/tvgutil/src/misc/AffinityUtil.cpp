@@ -0,0 +1,109 @@
+/**
+ * tvgutil: AffinityUtil.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "misc/AffinityUtil.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#if defined(_WIN32)
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+namespace tvgutil {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+size_t AffinityUtil::get_default_thread_count(const std::vector<int>& cpus)
+{
+  if(!cpus.empty()) return cpus.size();
+
+  const size_t hardwareConcurrency = boost::thread::hardware_concurrency();
+  return hardwareConcurrency > 0 ? hardwareConcurrency : 1;
+}
+
+std::vector<int> AffinityUtil::parse_cpu_list(const std::string& cpuList)
+{
+  std::vector<int> cpus;
+  if(boost::algorithm::trim_copy(cpuList).empty()) return cpus;
+
+  size_t begin = 0;
+  for(;;)
+  {
+    // Extract the next comma-separated element of the list.
+    const size_t end = cpuList.find(',', begin);
+    const std::string element = boost::algorithm::trim_copy(cpuList.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+
+    // Parse the element as either a single CPU index or a range of CPU indices.
+    const size_t dash = element.find('-');
+    int first = 0, last = -1;
+    try
+    {
+      first = boost::lexical_cast<int>(boost::algorithm::trim_copy(element.substr(0, dash)));
+      last = dash == std::string::npos ? first : boost::lexical_cast<int>(boost::algorithm::trim_copy(element.substr(dash + 1)));
+    }
+    catch(boost::bad_lexical_cast&) {}
+
+    if(first < 0 || last < first)
+    {
+      throw std::invalid_argument("Error: Invalid element '" + element + "' in CPU list '" + cpuList + "'");
+    }
+
+    for(int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+
+    if(end == std::string::npos) break;
+    begin = end + 1;
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+bool AffinityUtil::set_current_thread_affinity(const std::vector<int>& cpus, const std::string& roleName)
+{
+  if(cpus.empty()) return true;
+
+  bool succeeded = false;
+
+#if defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for(size_t i = 0, size = cpus.size(); i < size; ++i)
+  {
+    if(cpus[i] < static_cast<int>(sizeof(DWORD_PTR) * 8)) mask |= static_cast<DWORD_PTR>(1) << cpus[i];
+  }
+  succeeded = mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  bool anyValid = false;
+  for(size_t i = 0, size = cpus.size(); i < size; ++i)
+  {
+    if(cpus[i] < CPU_SETSIZE)
+    {
+      CPU_SET(cpus[i], &cpuSet);
+      anyValid = true;
+    }
+  }
+  succeeded = anyValid && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#endif
+
+  if(!succeeded)
+  {
+    std::cerr << "Warning: Could not set the CPU affinity of the " << roleName << " thread; it will run on any CPU\n";
+  }
+
+  return succeeded;
+}
+
+}
@@ -0,0 +1,101 @@
+/**
+ * tvgutil: TaskGroup.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "misc/TaskGroup.h"
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace tvgutil {
+
+//#################### CONSTRUCTORS ####################
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler)
+: m_failed(false), m_outstandingTaskCount(0), m_scheduler(scheduler)
+{}
+
+//#################### DESTRUCTOR ####################
+
+TaskGroup::~TaskGroup()
+{
+  wait_for_tasks();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void TaskGroup::run(const boost::function<void()>& task)
+{
+  ++m_outstandingTaskCount;
+  m_scheduler.submit(boost::bind(&TaskGroup::execute, this, task));
+}
+
+void TaskGroup::wait()
+{
+  wait_for_tasks();
+
+  boost::lock_guard<boost::mutex> lock(m_errorMutex);
+  if(m_failed)
+  {
+    // Reset the error state so that the group can be reused.
+    const std::string message = m_errorMessage;
+    m_failed = false;
+    m_errorMessage.clear();
+    throw std::runtime_error(message);
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TaskGroup::execute(const boost::function<void()>& task)
+{
+  try
+  {
+    task();
+  }
+  catch(std::exception& e)
+  {
+    boost::lock_guard<boost::mutex> lock(m_errorMutex);
+    if(!m_failed)
+    {
+      m_failed = true;
+      m_errorMessage = e.what();
+    }
+  }
+  catch(...)
+  {
+    boost::lock_guard<boost::mutex> lock(m_errorMutex);
+    if(!m_failed)
+    {
+      m_failed = true;
+      m_errorMessage = "Error: A task threw an unknown exception";
+    }
+  }
+
+  // Note: The count is decremented and the waiting thread (if any) woken whilst holding the mutex, since the waiting thread
+  //       may destroy the group as soon as it sees the count reach zero, which it cannot do before we release the mutex.
+  boost::lock_guard<boost::mutex> lock(m_taskMutex);
+  --m_outstandingTaskCount;
+  m_taskFinished.notify_all();
+}
+
+void TaskGroup::wait_for_tasks()
+{
+  // Help to execute pending tasks (which may or may not belong to this group) until all of the group's tasks have finished.
+  // If there are no pending tasks, the group's remaining tasks are already running on other threads, so rather than spinning,
+  // we block until one of them finishes, and then check again.
+  while(m_outstandingTaskCount > 0)
+  {
+    if(m_scheduler.try_run_one()) continue;
+
+    boost::unique_lock<boost::mutex> lock(m_taskMutex);
+    if(m_outstandingTaskCount > 0) m_taskFinished.wait(lock);
+  }
+
+  // Make sure that the thread that finished the last task has released the mutex before the caller can destroy the group.
+  boost::lock_guard<boost::mutex> lock(m_taskMutex);
+}
+
+}
@@ -0,0 +1,179 @@
+/**
+ * tvgutil: TaskScheduler.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "misc/TaskScheduler.h"
+
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include "misc/AffinityUtil.h"
+
+namespace tvgutil {
+
+//#################### PRIVATE STATIC VARIABLES ####################
+
+std::vector<int> TaskScheduler::s_defaultAffinity;
+size_t TaskScheduler::s_defaultConcurrency = 0;
+
+//#################### CONSTRUCTORS ####################
+
+TaskScheduler::TaskScheduler(size_t concurrency, const std::vector<int>& cpus)
+: m_concurrency(concurrency), m_cpus(cpus), m_pendingTaskCount(0), m_workersShouldTerminate(false)
+{
+  if(m_concurrency == 0) m_concurrency = AffinityUtil::get_default_thread_count(cpus);
+
+  // Create one fewer worker than the concurrency, since the thread waiting for a computation to finish also executes tasks.
+  const size_t workerCount = m_concurrency - 1;
+  for(size_t i = 0; i <= workerCount; ++i)
+  {
+    m_queues.push_back(TaskQueue_Ptr(new TaskQueue));
+  }
+
+  for(size_t i = 0; i < workerCount; ++i)
+  {
+    m_threads.create_thread(boost::bind(&TaskScheduler::run_worker, this, i));
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+TaskScheduler::~TaskScheduler()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(m_sleepMutex);
+    m_workersShouldTerminate = true;
+  }
+  m_workAvailable.notify_all();
+
+  m_threads.join_all();
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+TaskScheduler& TaskScheduler::instance()
+{
+  static TaskScheduler s_instance(s_defaultConcurrency, s_defaultAffinity);
+  return s_instance;
+}
+
+void TaskScheduler::set_default_affinity(const std::vector<int>& cpus)
+{
+  s_defaultAffinity = cpus;
+}
+
+void TaskScheduler::set_default_concurrency(size_t concurrency)
+{
+  s_defaultConcurrency = concurrency;
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+size_t TaskScheduler::get_concurrency() const
+{
+  return m_concurrency;
+}
+
+void TaskScheduler::submit(const Task& task)
+{
+  // Workers push tasks onto their own queues; all other threads share the final queue.
+  const size_t *workerIndex = m_workerIndex.get();
+  TaskQueue& queue = *m_queues[workerIndex ? *workerIndex : m_queues.size() - 1];
+  {
+    boost::lock_guard<boost::mutex> lock(queue.mutex);
+    queue.tasks.push_back(task);
+  }
+
+  // Wake an idle worker (if any). The sleep mutex must be acquired, however briefly, since otherwise
+  // a worker that has just found the pending count to be zero could miss the notification.
+  ++m_pendingTaskCount;
+  {
+    boost::lock_guard<boost::mutex> lock(m_sleepMutex);
+  }
+  m_workAvailable.notify_one();
+}
+
+bool TaskScheduler::try_run_one()
+{
+  Task task;
+  if(!try_take_task(task)) return false;
+  run_task(task);
+  return true;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void TaskScheduler::run_task(const Task& task)
+{
+  try
+  {
+    task();
+  }
+  catch(std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+  }
+}
+
+void TaskScheduler::run_worker(size_t workerIndex)
+{
+  m_workerIndex.reset(new size_t(workerIndex));
+  AffinityUtil::set_current_thread_affinity(m_cpus, "task scheduler worker");
+
+  for(;;)
+  {
+    if(try_run_one()) continue;
+
+    // If there are no tasks available, sleep until one is submitted or termination is requested.
+    boost::unique_lock<boost::mutex> lock(m_sleepMutex);
+    while(m_pendingTaskCount == 0 && !m_workersShouldTerminate) m_workAvailable.wait(lock);
+    if(m_workersShouldTerminate) return;
+  }
+}
+
+bool TaskScheduler::try_take_task(Task& task)
+{
+  if(m_pendingTaskCount == 0) return false;
+
+  const size_t queueCount = m_queues.size();
+  const size_t *workerIndex = m_workerIndex.get();
+
+  // If the calling thread is a worker, first try to take the most recently submitted task from its own queue.
+  if(workerIndex)
+  {
+    TaskQueue& ownQueue = *m_queues[*workerIndex];
+    boost::lock_guard<boost::mutex> lock(ownQueue.mutex);
+    if(!ownQueue.tasks.empty())
+    {
+      task = ownQueue.tasks.back();
+      ownQueue.tasks.pop_back();
+      --m_pendingTaskCount;
+      return true;
+    }
+  }
+
+  // Otherwise, try to take the oldest task from the non-worker queue, and then to steal the oldest task from another worker.
+  const size_t start = workerIndex ? *workerIndex + 1 : 0;
+  for(size_t i = 0; i < queueCount; ++i)
+  {
+    const size_t queueIndex = (queueCount - 1 + start + i) % queueCount;
+    if(workerIndex && queueIndex == *workerIndex) continue;
+
+    TaskQueue& queue = *m_queues[queueIndex];
+    boost::lock_guard<boost::mutex> lock(queue.mutex);
+    if(!queue.tasks.empty())
+    {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      --m_pendingTaskCount;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}
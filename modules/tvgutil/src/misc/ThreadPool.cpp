@@ -5,18 +5,44 @@
 
 #include "misc/ThreadPool.h"
 
+#include <iostream>
+#include <stdexcept>
+
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "misc/AffinityUtil.h"
+#include "timing/Profiler.h"
 
 namespace tvgutil {
 
+//#################### PRIVATE STATIC VARIABLES ####################
+
+std::vector<int> ThreadPool::s_defaultAffinity;
+size_t ThreadPool::s_defaultThreadCount = 0;
+
 //#################### CONSTRUCTORS ####################
 
-ThreadPool::ThreadPool(size_t numThreads)
-: m_worker(new boost::asio::io_service::work(m_scheduler))
+ThreadPool::ThreadPool(size_t numThreads, size_t maxQueueSize, OverflowPolicy overflowPolicy, const std::vector<int>& cpus)
+: m_creationTime(Clock::now()),
+  m_completedTaskCount(0),
+  m_cpus(cpus),
+  m_droppedTaskCount(0),
+  m_maxQueueSize(maxQueueSize),
+  m_overflowPolicy(overflowPolicy),
+  m_peakQueueDepth(0),
+  m_queueDepth(0),
+  m_totalExecutionTimeMs(0.0),
+  m_totalLatencyMs(0.0),
+  m_workersShouldTerminate(false)
 {
+  // Make sure that the profiler is constructed before (and thus destroyed after) the pool, since the workers use it.
+  Profiler::instance();
+
+  if(numThreads == 0) numThreads = AffinityUtil::get_default_thread_count(cpus);
   for(size_t i = 0; i < numThreads; ++i)
   {
-    m_threads.create_thread(boost::bind(&boost::asio::io_service::run, &m_scheduler));
+    m_threads.create_thread(boost::bind(&ThreadPool::run_worker, this, i));
   }
 }
 
@@ -24,22 +50,163 @@ ThreadPool::ThreadPool(size_t numThreads)
 
 ThreadPool::~ThreadPool()
 {
-  // Stop executing the scheduler's run function, but allow running and queued tasks to finish cleanly.
-  m_worker.reset();
+  // Ask the threads to terminate, but allow running and queued tasks to finish cleanly.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_workersShouldTerminate = true;
+  }
+  m_workAvailable.notify_all();
 
   // Wait for all threads to terminate.
   m_threads.join_all();
-
-  // Cleanly stop the scheduler.
-  m_scheduler.stop();
 }
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
 ThreadPool& ThreadPool::instance()
 {
-  static ThreadPool s_instance;
+  static ThreadPool s_instance(s_defaultThreadCount, 256, OP_BLOCK, s_defaultAffinity);
   return s_instance;
 }
 
+void ThreadPool::set_default_affinity(const std::vector<int>& cpus)
+{
+  s_defaultAffinity = cpus;
+}
+
+void ThreadPool::set_default_thread_count(size_t numThreads)
+{
+  s_defaultThreadCount = numThreads;
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ThreadPool::Stats ThreadPool::get_stats() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  Stats stats;
+  stats.completedTaskCount = m_completedTaskCount;
+  stats.droppedTaskCount = m_droppedTaskCount;
+  stats.meanExecutionTimeMs = m_completedTaskCount > 0 ? m_totalExecutionTimeMs / m_completedTaskCount : 0.0;
+  stats.meanLatencyMs = m_completedTaskCount > 0 ? m_totalLatencyMs / m_completedTaskCount : 0.0;
+  stats.peakQueueDepth = m_peakQueueDepth;
+  stats.queueDepth = m_queueDepth;
+
+  const double elapsedSeconds = boost::chrono::duration<double>(Clock::now() - m_creationTime).count();
+  stats.throughput = elapsedSeconds > 0.0 ? m_completedTaskCount / elapsedSeconds : 0.0;
+
+  return stats;
+}
+
+size_t ThreadPool::get_thread_count() const
+{
+  return m_threads.size();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+bool ThreadPool::post_task_sub(const boost::function<void()>& task, TaskPriority priority)
+{
+  if(priority < 0 || priority >= TP_COUNT) throw std::invalid_argument("Error: Invalid task priority");
+
+  QueuedTask queuedTask;
+  queuedTask.postTime = Clock::now();
+  queuedTask.task = task;
+
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    if(m_maxQueueSize > 0 && m_queueDepth >= m_maxQueueSize)
+    {
+      if(m_overflowPolicy == OP_BLOCK)
+      {
+        // Wait until one of the threads has taken a task from the queue.
+        while(m_queueDepth >= m_maxQueueSize) m_spaceAvailable.wait(lock);
+      }
+      else
+      {
+        // Find the lowest-priority lane that contains any tasks. If its priority is no lower than that of the new task,
+        // drop the new task; otherwise, drop the most recently posted task in that lane to make room for the new one.
+        int lowestLane = TP_COUNT - 1;
+        while(m_queues[lowestLane].empty()) --lowestLane;
+
+        ++m_droppedTaskCount;
+        if(lowestLane <= priority) return false;
+
+        m_queues[lowestLane].pop_back();
+        --m_queueDepth;
+      }
+    }
+
+    m_queues[priority].push_back(queuedTask);
+    ++m_queueDepth;
+    if(m_queueDepth > m_peakQueueDepth) m_peakQueueDepth = m_queueDepth;
+  }
+
+  m_workAvailable.notify_one();
+  return true;
+}
+
+void ThreadPool::run_worker(size_t workerIndex)
+{
+  Profiler& profiler = Profiler::instance();
+  profiler.set_thread_name("ThreadPool worker " + boost::lexical_cast<std::string>(workerIndex));
+  AffinityUtil::set_current_thread_affinity(m_cpus, "thread pool worker");
+
+  for(;;)
+  {
+    // Wait until there is a task to execute, or termination is requested.
+    QueuedTask queuedTask;
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(m_queueDepth == 0 && !m_workersShouldTerminate) m_workAvailable.wait(lock);
+
+      // If the queue has been drained and we were asked to terminate, do so.
+      if(m_queueDepth == 0) return;
+
+      // Take the oldest task from the highest-priority lane that contains any tasks.
+      int lane = 0;
+      while(m_queues[lane].empty()) ++lane;
+      queuedTask = m_queues[lane].front();
+      m_queues[lane].pop_front();
+      --m_queueDepth;
+    }
+
+    // Let any caller that is waiting for space in the queue proceed.
+    m_spaceAvailable.notify_one();
+
+    // Execute the task, timing it for the statistics.
+    const Clock::time_point startTime = Clock::now();
+    try
+    {
+      queuedTask.task();
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+    }
+    const Clock::time_point endTime = Clock::now();
+
+    // If the profiler is enabled, also record the task in its trace, so that it can be seen on the worker's timeline.
+    if(profiler.is_enabled()) profiler.record_cpu_stage("ThreadPool.Task", startTime, endTime);
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    ++m_completedTaskCount;
+    m_totalExecutionTimeMs += boost::chrono::duration<double,boost::milli>(endTime - startTime).count();
+    m_totalLatencyMs += boost::chrono::duration<double,boost::milli>(startTime - queuedTask.postTime).count();
+  }
+}
+
+//#################### STREAM OPERATORS ####################
+
+std::ostream& operator<<(std::ostream& os, const ThreadPool::Stats& stats)
+{
+  os << "queue depth " << stats.queueDepth << " (peak " << stats.peakQueueDepth << "), "
+     << stats.completedTaskCount << " completed, " << stats.droppedTaskCount << " dropped, "
+     << "mean latency " << stats.meanLatencyMs << "ms, mean execution time " << stats.meanExecutionTimeMs << "ms, "
+     << stats.throughput << " tasks/s";
+  return os;
+}
+
 }
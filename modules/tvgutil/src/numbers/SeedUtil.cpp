@@ -0,0 +1,45 @@
+/**
+ * tvgutil: SeedUtil.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "numbers/SeedUtil.h"
+
+#include <boost/cstdint.hpp>
+
+namespace tvgutil {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+unsigned int SeedUtil::derive_seed(unsigned int rootSeed, const std::string& purpose)
+{
+  // Hash the purpose using 64-bit FNV-1a (we avoid boost::hash, whose values are not guaranteed to be stable).
+  boost::uint64_t h = 14695981039346656037ULL;
+  for(size_t i = 0, size = purpose.size(); i < size; ++i)
+  {
+    h ^= static_cast<unsigned char>(purpose[i]);
+    h *= 1099511628211ULL;
+  }
+
+  // Combine the hash with the root seed, and then mix the result using the SplitMix64 finaliser, so that similar
+  // root seeds or purposes yield unrelated seeds.
+  h ^= static_cast<boost::uint64_t>(rootSeed) + 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+
+  return static_cast<unsigned int>(h);
+}
+
+boost::optional<unsigned int> SeedUtil::get_deterministic_seed(const SettingsContainer& settings, const std::string& purpose)
+{
+  if(!is_deterministic(settings)) return boost::none;
+  return derive_seed(settings.get_first_value<unsigned int>("seed", 12345), purpose);
+}
+
+bool SeedUtil::is_deterministic(const SettingsContainer& settings)
+{
+  return settings.get_first_value<bool>("deterministic", false);
+}
+
+}
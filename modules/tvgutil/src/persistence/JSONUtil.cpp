@@ -0,0 +1,48 @@
+/**
+ * tvgutil: JSONUtil.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "persistence/JSONUtil.h"
+
+namespace tvgutil {
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+std::string JSONUtil::escape_string(const std::string& s)
+{
+  static const char *hexDigits = "0123456789abcdef";
+
+  std::string result;
+  result.reserve(s.size());
+
+  for(size_t i = 0, size = s.size(); i < size; ++i)
+  {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    switch(c)
+    {
+      case '"':  result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\b': result += "\\b"; break;
+      case '\f': result += "\\f"; break;
+      case '\n': result += "\\n"; break;
+      case '\r': result += "\\r"; break;
+      case '\t': result += "\\t"; break;
+      default:
+      {
+        if(c < 0x20)
+        {
+          result += "\\u00";
+          result += hexDigits[c >> 4];
+          result += hexDigits[c & 0xf];
+        }
+        else result += s[i];
+        break;
+      }
+    }
+  }
+
+  return result;
+}
+
+}
@@ -0,0 +1,582 @@
+/**
+ * tvgutil: KernelMetricsCollector.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "timing/KernelMetricsCollector.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#ifdef WITH_CUPTI
+#include <boost/chrono/chrono.hpp>
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include <cupti.h>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+#endif
+
+namespace {
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Quotes a string so that it can be written as a field of a CSV file.
+ *
+ * \param s The string.
+ * \return  The quoted string.
+ */
+std::string quote_csv(const std::string& s)
+{
+  std::string result = "\"";
+  for(size_t i = 0, size = s.size(); i < size; ++i)
+  {
+    if(s[i] == '"') result += '"';
+    result += s[i];
+  }
+  result += '"';
+  return result;
+}
+
+}
+
+namespace tvgutil {
+
+//#################### NESTED TYPES ####################
+
+#ifdef WITH_CUPTI
+/**
+ * \brief An instance of this struct contains the state needed to interact with CUPTI.
+ */
+struct KernelMetricsCollector::CUPTIState
+{
+  //~~~~~~~~~~~~~~~~~~~~ TYPEDEFS ~~~~~~~~~~~~~~~~~~~~
+
+  typedef boost::chrono::steady_clock Clock;
+
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC VARIABLES ~~~~~~~~~~~~~~~~~~~~
+
+  /** The collector that owns this state. */
+  KernelMetricsCollector *collector;
+
+  /** The context in which launches are sampled (NULL until the first launch). */
+  CUcontext context;
+
+  /** The device to which the sampled context belongs. */
+  CUdevice device;
+
+  /** The event group sets needed to measure each metric (NULL for any metric that cannot be measured in a single pass). */
+  CUpti_EventGroupSets *eventGroupSets[METRIC_COUNT];
+
+  /** The CUPTI IDs of the metrics. */
+  CUpti_MetricID metricIDs[METRIC_COUNT];
+
+  /** The metric being measured for the launch that is currently being sampled. */
+  Metric sampledMetric;
+
+  /** The record of the kernel whose launch is currently being sampled. */
+  KernelRecord *sampledRecord;
+
+  /** The time at which the kernel whose launch is currently being sampled started. */
+  Clock::time_point sampleStart;
+
+  /** The handle of the CUPTI subscription. */
+  CUpti_SubscriberHandle subscriber;
+
+  //~~~~~~~~~~~~~~~~~~~~ CONSTRUCTORS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Constructs the CUPTI state for a collector.
+   *
+   * \param collector_  The collector that owns the state.
+   */
+  explicit CUPTIState(KernelMetricsCollector *collector_)
+  : collector(collector_), context(NULL), device(0), sampledMetric(METRIC_COUNT), sampledRecord(NULL), subscriber(NULL)
+  {
+    for(int i = 0; i < METRIC_COUNT; ++i) eventGroupSets[i] = NULL;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~ DESTRUCTOR ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Destroys the CUPTI state, unsubscribing from CUPTI and destroying the event group sets.
+   */
+  ~CUPTIState()
+  {
+    if(subscriber) cuptiUnsubscribe(subscriber);
+    for(int i = 0; i < METRIC_COUNT; ++i)
+    {
+      if(eventGroupSets[i]) cuptiEventGroupSetsDestroy(eventGroupSets[i]);
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC STATIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Gets the name of the specified kernel in a readable form.
+   *
+   * \param symbolName  The (possibly mangled) name of the kernel, as supplied by CUPTI.
+   * \return            The demangled name of the kernel, if possible, or its name as supplied by CUPTI otherwise.
+   */
+  static std::string demangle(const char *symbolName)
+  {
+    if(!symbolName) return "(unknown)";
+
+#ifdef __GNUC__
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(symbolName, NULL, NULL, &status);
+    if(status == 0 && demangled)
+    {
+      std::string result(demangled);
+      free(demangled);
+      return result;
+    }
+#endif
+
+    return symbolName;
+  }
+
+  /**
+   * \brief The function that CUPTI calls on entry to and exit from every kernel launch whilst the collector is running.
+   */
+  static void CUPTIAPI launch_callback(void *userdata, CUpti_CallbackDomain domain, CUpti_CallbackId cbid, const void *cbdata)
+  {
+    if(domain != CUPTI_CB_DOMAIN_RUNTIME_API) return;
+    if(cbid != CUPTI_RUNTIME_TRACE_CBID_cudaLaunch_v3020 && cbid != CUPTI_RUNTIME_TRACE_CBID_cudaLaunchKernel_v7000) return;
+    static_cast<CUPTIState*>(userdata)->handle_launch(static_cast<const CUpti_CallbackData*>(cbdata));
+  }
+
+  /**
+   * \brief Converts a metric value to a double.
+   *
+   * \param metricID  The CUPTI ID of the metric.
+   * \param value     The value of the metric.
+   * \return          The value of the metric, as a double.
+   */
+  static double to_double(CUpti_MetricID metricID, const CUpti_MetricValue& value)
+  {
+    CUpti_MetricValueKind valueKind;
+    size_t size = sizeof(valueKind);
+    if(cuptiMetricGetAttribute(metricID, CUPTI_METRIC_ATTR_VALUE_KIND, &size, &valueKind) != CUPTI_SUCCESS) return -1.0;
+
+    switch(valueKind)
+    {
+      case CUPTI_METRIC_VALUE_KIND_DOUBLE:
+        return value.metricValueDouble;
+      case CUPTI_METRIC_VALUE_KIND_UINT64:
+        return static_cast<double>(value.metricValueUint64);
+      case CUPTI_METRIC_VALUE_KIND_INT64:
+        return static_cast<double>(value.metricValueInt64);
+      case CUPTI_METRIC_VALUE_KIND_PERCENT:
+        return value.metricValuePercent;
+      case CUPTI_METRIC_VALUE_KIND_THROUGHPUT:
+        return static_cast<double>(value.metricValueThroughput);
+      case CUPTI_METRIC_VALUE_KIND_UTILIZATION_LEVEL:
+        return static_cast<double>(value.metricValueUtilizationLevel);
+      default:
+        return -1.0;
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~ PUBLIC MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Handles a CUPTI callback for a kernel launch.
+   *
+   * \param cbInfo  The CUPTI callback data.
+   */
+  void handle_launch(const CUpti_CallbackData *cbInfo)
+  {
+    if(cbInfo->callbackSite == CUPTI_API_ENTER)
+    {
+      // Wait for any launch that another thread is sampling to finish. If this launch is not sampled, the mutex is released again straight away.
+      collector->m_samplingMutex.lock();
+
+      // Count the launch, and decide whether or not to sample it.
+      Metric metric = METRIC_COUNT;
+      KernelRecord *record;
+      {
+        boost::lock_guard<boost::mutex> lock(collector->m_mutex);
+        record = &collector->m_kernelRecords[std::make_pair(collector->get_current_range_name(), demangle(cbInfo->symbolName))];
+        if(record->launchCount % collector->m_sampleInterval == 0)
+        {
+          // Note: The metrics are measured in rotation, so the first sampled launch of each kernel measures the first metric, and so on.
+          metric = static_cast<Metric>((record->launchCount / collector->m_sampleInterval) % METRIC_COUNT);
+        }
+        ++record->launchCount;
+      }
+
+      // Note: CUPTI preserves the correlation data between the entry and exit callbacks of a launch, so we use it to mark
+      //       the launch as sampled (launches on other threads may exit whilst this one is being sampled).
+      *cbInfo->correlationData = 0;
+      if(metric != METRIC_COUNT && prepare_sample(cbInfo->context, metric))
+      {
+        *cbInfo->correlationData = 1;
+        sampledMetric = metric;
+        sampledRecord = record;
+        sampleStart = Clock::now();
+      }
+      else collector->m_samplingMutex.unlock();
+    }
+    else if(*cbInfo->correlationData == 1)
+    {
+      // If this thread is sampling the launch, wait for the kernel to finish, read the metric and let the other threads continue.
+      cudaDeviceSynchronize();
+      const boost::chrono::nanoseconds duration = Clock::now() - sampleStart;
+
+      double value;
+      if(read_sample(static_cast<uint64_t>(duration.count()), value))
+      {
+        boost::lock_guard<boost::mutex> lock(collector->m_mutex);
+        ++sampledRecord->sampleCounts[sampledMetric];
+        sampledRecord->valueSums[sampledMetric] += value;
+      }
+
+      sampledMetric = METRIC_COUNT;
+      sampledRecord = NULL;
+      collector->m_samplingMutex.unlock();
+    }
+  }
+
+  /**
+   * \brief Prepares to measure a metric for the kernel that is about to be launched.
+   *
+   * \param launchContext The context in which the kernel is to be launched.
+   * \param metric        The metric to measure.
+   * \return              true, if the metric is now being collected, or false if it cannot be measured for the launch.
+   */
+  bool prepare_sample(CUcontext launchContext, Metric metric)
+  {
+    // Create the event group sets for the metrics the first time a kernel is launched, and ignore any launches in other contexts.
+    if(!context)
+    {
+      context = launchContext;
+      if(!create_event_group_sets()) return false;
+    }
+    else if(launchContext != context) return false;
+
+    if(!eventGroupSets[metric]) return false;
+
+    // Make sure that the events are only counted whilst the kernel being sampled is running.
+    cudaDeviceSynchronize();
+    if(cuptiSetEventCollectionMode(context, CUPTI_EVENT_COLLECTION_MODE_KERNEL) != CUPTI_SUCCESS) return false;
+
+    const CUpti_EventGroupSet& eventGroupSet = eventGroupSets[metric]->sets[0];
+    for(uint32_t i = 0; i < eventGroupSet.numEventGroups; ++i)
+    {
+      uint32_t profileAll = 1;
+      cuptiEventGroupSetAttribute(eventGroupSet.eventGroups[i], CUPTI_EVENT_GROUP_ATTR_PROFILE_ALL_DOMAIN_INSTANCES, sizeof(profileAll), &profileAll);
+      if(cuptiEventGroupEnable(eventGroupSet.eventGroups[i]) != CUPTI_SUCCESS)
+      {
+        for(uint32_t j = 0; j < i; ++j) cuptiEventGroupDisable(eventGroupSet.eventGroups[j]);
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~ PRIVATE MEMBER FUNCTIONS ~~~~~~~~~~~~~~~~~~~~
+
+  /**
+   * \brief Creates the event group sets needed to measure each metric in the sampled context.
+   *
+   * \return  true, if the device to which the sampled context belongs could be determined, or false otherwise.
+   */
+  bool create_event_group_sets()
+  {
+    if(cuCtxPushCurrent(context) != CUDA_SUCCESS) return false;
+    const bool deviceFound = cuCtxGetDevice(&device) == CUDA_SUCCESS;
+    cuCtxPopCurrent(NULL);
+    if(!deviceFound) return false;
+
+    for(int i = 0; i < METRIC_COUNT; ++i)
+    {
+      if(cuptiMetricGetIdFromName(device, get_metric_name(static_cast<Metric>(i)), &metricIDs[i]) != CUPTI_SUCCESS) continue;
+      if(cuptiMetricCreateEventGroupSets(context, sizeof(CUpti_MetricID), &metricIDs[i], &eventGroupSets[i]) != CUPTI_SUCCESS)
+      {
+        eventGroupSets[i] = NULL;
+        continue;
+      }
+
+      // Metrics that need more than one pass would require the kernel to be replayed, which we cannot do, so we don't measure them.
+      if(eventGroupSets[i]->numSets != 1)
+      {
+        cuptiEventGroupSetsDestroy(eventGroupSets[i]);
+        eventGroupSets[i] = NULL;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * \brief Reads the events collected for the launch that is being sampled, disables their collection, and computes the metric.
+   *
+   * \param durationNs  The duration of the kernel (in nanoseconds).
+   * \param value       A variable into which to store the value of the metric.
+   * \return            true, if the metric could be computed, or false otherwise.
+   */
+  bool read_sample(uint64_t durationNs, double& value)
+  {
+    std::vector<CUpti_EventID> eventIDs;
+    std::vector<uint64_t> eventValues;
+    bool ok = true;
+
+    const CUpti_EventGroupSet& eventGroupSet = eventGroupSets[sampledMetric]->sets[0];
+    for(uint32_t i = 0; i < eventGroupSet.numEventGroups; ++i)
+    {
+      CUpti_EventGroup eventGroup = eventGroupSet.eventGroups[i];
+
+      // Each event is counted separately by each instance of its domain, but the group may only be able to read some of the
+      // instances, so we sum the counts of the instances it can read and scale the sum up to cover all of them.
+      CUpti_EventDomainID domainID;
+      size_t size = sizeof(domainID);
+      ok = ok && cuptiEventGroupGetAttribute(eventGroup, CUPTI_EVENT_GROUP_ATTR_EVENT_DOMAIN_ID, &size, &domainID) == CUPTI_SUCCESS;
+
+      uint32_t totalInstanceCount = 0;
+      size = sizeof(totalInstanceCount);
+      ok = ok && cuptiDeviceGetEventDomainAttribute(device, domainID, CUPTI_EVENT_DOMAIN_ATTR_TOTAL_INSTANCE_COUNT, &size, &totalInstanceCount) == CUPTI_SUCCESS;
+
+      uint32_t instanceCount = 0;
+      size = sizeof(instanceCount);
+      ok = ok && cuptiEventGroupGetAttribute(eventGroup, CUPTI_EVENT_GROUP_ATTR_INSTANCE_COUNT, &size, &instanceCount) == CUPTI_SUCCESS;
+
+      uint32_t eventCount = 0;
+      size = sizeof(eventCount);
+      ok = ok && cuptiEventGroupGetAttribute(eventGroup, CUPTI_EVENT_GROUP_ATTR_NUM_EVENTS, &size, &eventCount) == CUPTI_SUCCESS;
+
+      if(ok && instanceCount > 0 && eventCount > 0)
+      {
+        std::vector<CUpti_EventID> groupEventIDs(eventCount);
+        size = eventCount * sizeof(CUpti_EventID);
+        ok = cuptiEventGroupGetAttribute(eventGroup, CUPTI_EVENT_GROUP_ATTR_EVENTS, &size, &groupEventIDs[0]) == CUPTI_SUCCESS;
+
+        std::vector<uint64_t> instanceValues(instanceCount);
+        for(uint32_t j = 0; ok && j < eventCount; ++j)
+        {
+          size_t bytesRead = instanceCount * sizeof(uint64_t);
+          ok = cuptiEventGroupReadEvent(eventGroup, CUPTI_EVENT_READ_FLAG_NONE, groupEventIDs[j], &bytesRead, &instanceValues[0]) == CUPTI_SUCCESS;
+
+          uint64_t sum = 0;
+          for(uint32_t k = 0; k < instanceCount; ++k) sum += instanceValues[k];
+
+          eventIDs.push_back(groupEventIDs[j]);
+          eventValues.push_back(sum * totalInstanceCount / instanceCount);
+        }
+      }
+
+      cuptiEventGroupDisable(eventGroup);
+    }
+
+    if(!ok || eventIDs.empty()) return false;
+
+    CUpti_MetricValue metricValue;
+    if(cuptiMetricGetValue(
+      device, metricIDs[sampledMetric], eventIDs.size() * sizeof(CUpti_EventID), &eventIDs[0],
+      eventValues.size() * sizeof(uint64_t), &eventValues[0], durationNs, &metricValue
+    ) != CUPTI_SUCCESS)
+    {
+      return false;
+    }
+
+    value = to_double(metricIDs[sampledMetric], metricValue);
+    return value >= 0.0;
+  }
+};
+#else
+/**
+ * \brief A placeholder for the state needed to interact with CUPTI (tvgutil was built without CUPTI support).
+ */
+struct KernelMetricsCollector::CUPTIState {};
+#endif
+
+KernelMetricsCollector::KernelRecord::KernelRecord()
+: launchCount(0)
+{
+  for(int i = 0; i < METRIC_COUNT; ++i)
+  {
+    sampleCounts[i] = 0;
+    valueSums[i] = 0.0;
+  }
+}
+
+//#################### SINGLETON IMPLEMENTATION ####################
+
+KernelMetricsCollector::KernelMetricsCollector()
+: m_enabled(false), m_rangeStacks(), m_sampleInterval(1)
+{}
+
+KernelMetricsCollector::~KernelMetricsCollector()
+{
+  stop();
+}
+
+KernelMetricsCollector& KernelMetricsCollector::instance()
+{
+  static KernelMetricsCollector s_instance;
+  return s_instance;
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+const char *KernelMetricsCollector::get_metric_name(Metric metric)
+{
+  // Note: These are the names by which CUPTI knows the metrics.
+  switch(metric)
+  {
+    case METRIC_ACHIEVED_OCCUPANCY:
+      return "achieved_occupancy";
+    case METRIC_DRAM_READ_THROUGHPUT:
+      return "dram_read_throughput";
+    case METRIC_DRAM_WRITE_THROUGHPUT:
+      return "dram_write_throughput";
+    default:
+      throw std::invalid_argument("Error: Unknown kernel metric");
+  }
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void KernelMetricsCollector::export_csv(const std::string& path) const
+{
+  std::ofstream fs(path.c_str());
+  if(!fs) throw std::runtime_error("Error: Could not open " + path + " for writing");
+
+  const std::vector<KernelStats> kernelStats = get_kernel_stats();
+
+  fs << "range,kernel,launches";
+  for(int i = 0; i < METRIC_COUNT; ++i)
+  {
+    const char *metricName = get_metric_name(static_cast<Metric>(i));
+    fs << ',' << metricName << ',' << metricName << "_samples";
+  }
+  fs << '\n';
+
+  fs << std::fixed << std::setprecision(3);
+  for(size_t i = 0, size = kernelStats.size(); i < size; ++i)
+  {
+    const KernelStats& stats = kernelStats[i];
+    fs << quote_csv(stats.rangeName) << ',' << quote_csv(stats.kernelName) << ',' << stats.launchCount;
+    for(int j = 0; j < METRIC_COUNT; ++j)
+    {
+      // Note: CUPTI reports throughputs in bytes per second, so we convert them to GB/s.
+      fs << ',';
+      if(stats.sampleCounts[j] > 0) fs << (j == METRIC_ACHIEVED_OCCUPANCY ? stats.meanValues[j] : stats.meanValues[j] / 1e9);
+      fs << ',' << stats.sampleCounts[j];
+    }
+    fs << '\n';
+  }
+
+  if(!fs) throw std::runtime_error("Error: Could not write kernel metrics to " + path);
+}
+
+std::vector<KernelMetricsCollector::KernelStats> KernelMetricsCollector::get_kernel_stats() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  std::vector<KernelStats> result;
+  result.reserve(m_kernelRecords.size());
+  for(std::map<std::pair<std::string,std::string>,KernelRecord>::const_iterator it = m_kernelRecords.begin(), iend = m_kernelRecords.end(); it != iend; ++it)
+  {
+    const KernelRecord& record = it->second;
+
+    KernelStats stats;
+    stats.kernelName = it->first.second;
+    stats.launchCount = record.launchCount;
+    stats.rangeName = it->first.first;
+    for(int i = 0; i < METRIC_COUNT; ++i)
+    {
+      stats.meanValues[i] = record.sampleCounts[i] > 0 ? record.valueSums[i] / record.sampleCounts[i] : -1.0;
+      stats.sampleCounts[i] = record.sampleCounts[i];
+    }
+
+    result.push_back(stats);
+  }
+
+  return result;
+}
+
+bool KernelMetricsCollector::is_enabled() const
+{
+  return m_enabled;
+}
+
+void KernelMetricsCollector::pop_range()
+{
+  std::vector<const char*> *rangeStack = m_rangeStacks.get();
+  if(rangeStack && !rangeStack->empty()) rangeStack->pop_back();
+}
+
+void KernelMetricsCollector::push_range(const char *rangeName)
+{
+  std::vector<const char*> *rangeStack = m_rangeStacks.get();
+  if(!rangeStack)
+  {
+    rangeStack = new std::vector<const char*>;
+    m_rangeStacks.reset(rangeStack);
+  }
+  rangeStack->push_back(rangeName);
+}
+
+void KernelMetricsCollector::reset()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_kernelRecords.clear();
+}
+
+void KernelMetricsCollector::start(size_t sampleInterval)
+{
+  if(sampleInterval == 0) throw std::invalid_argument("Error: The sample interval of a kernel metrics collector must be positive");
+
+#ifdef WITH_CUPTI
+  if(m_enabled) return;
+
+  // Note: The sample interval is only read by the callback, so it can safely be changed before subscribing.
+  m_sampleInterval = sampleInterval;
+
+  boost::scoped_ptr<CUPTIState> cuptiState(new CUPTIState(this));
+  if(cuptiSubscribe(&cuptiState->subscriber, (CUpti_CallbackFunc)&CUPTIState::launch_callback, cuptiState.get()) != CUPTI_SUCCESS)
+  {
+    cuptiState->subscriber = NULL;
+    throw std::runtime_error("Error: Could not subscribe to CUPTI callbacks (is another profiler attached?)");
+  }
+
+  if(cuptiEnableCallback(1, cuptiState->subscriber, CUPTI_CB_DOMAIN_RUNTIME_API, CUPTI_RUNTIME_TRACE_CBID_cudaLaunch_v3020) != CUPTI_SUCCESS ||
+     cuptiEnableCallback(1, cuptiState->subscriber, CUPTI_CB_DOMAIN_RUNTIME_API, CUPTI_RUNTIME_TRACE_CBID_cudaLaunchKernel_v7000) != CUPTI_SUCCESS)
+  {
+    throw std::runtime_error("Error: Could not enable the CUPTI callbacks for kernel launches");
+  }
+
+  m_cuptiState.swap(cuptiState);
+  m_enabled = true;
+#else
+  throw std::runtime_error("Error: CUPTI support not currently available. Reconfigure in CMake with the WITH_CUPTI option set to on.");
+#endif
+}
+
+void KernelMetricsCollector::stop()
+{
+  if(!m_enabled) return;
+
+  // Wait for any launch that is being sampled to finish, and then unsubscribe from CUPTI.
+  boost::lock_guard<boost::mutex> lock(m_samplingMutex);
+  m_cuptiState.reset();
+  m_enabled = false;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+std::string KernelMetricsCollector::get_current_range_name() const
+{
+  const std::vector<const char*> *rangeStack = m_rangeStacks.get();
+  return rangeStack && !rangeStack->empty() ? rangeStack->back() : "";
+}
+
+}
@@ -0,0 +1,158 @@
+/**
+ * tvgutil: PerformanceBaseline.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "timing/PerformanceBaseline.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#ifndef _WIN32
+  #include <unistd.h>
+#endif
+
+namespace bf = boost::filesystem;
+
+namespace tvgutil {
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Gets the name of the current machine.
+ *
+ * \return  The name of the current machine.
+ */
+static std::string get_machine_name()
+{
+  const char *overrideName = getenv("SPAINT_PERF_MACHINE");
+  if(overrideName != NULL && overrideName[0] != '\0') return overrideName;
+
+#ifdef _WIN32
+  const char *computerName = getenv("COMPUTERNAME");
+  if(computerName != NULL && computerName[0] != '\0') return computerName;
+#else
+  char hostName[256];
+  if(gethostname(hostName, sizeof(hostName)) == 0)
+  {
+    hostName[sizeof(hostName) - 1] = '\0';
+    return hostName;
+  }
+#endif
+
+  return "unknown";
+}
+
+//#################### CONSTRUCTORS ####################
+
+PerformanceBaseline::PerformanceBaseline(double tolerance)
+: m_tolerance(tolerance)
+{
+  if(tolerance < 0.0) throw std::invalid_argument("Error: The tolerance of a performance baseline must be non-negative");
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+std::string PerformanceBaseline::get_machine_baseline_path(const std::string& dir)
+{
+  return (bf::path(dir) / (get_machine_name() + ".txt")).string();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+bool PerformanceBaseline::check(const std::vector<Measurement>& measurements, std::ostream& os) const
+{
+  static const char *verdictNames[] = { "FASTER", "NEW", "SLOWER", "OK" };
+
+  bool result = true;
+  os << std::fixed << std::setprecision(3);
+  for(size_t i = 0, size = measurements.size(); i < size; ++i)
+  {
+    const Comparison c = compare(measurements[i].key, measurements[i].measuredMs);
+    os << std::left << std::setw(7) << verdictNames[c.verdict] << std::right << c.key << ": " << c.measuredMs << "ms";
+    if(c.baselineMs) os << " (baseline " << *c.baselineMs << "ms, " << std::showpos << (c.measuredMs / *c.baselineMs - 1.0) * 100.0 << std::noshowpos << "%)";
+    os << '\n';
+
+    if(c.verdict == VERDICT_SLOWER) result = false;
+  }
+
+  return result;
+}
+
+PerformanceBaseline::Comparison PerformanceBaseline::compare(const std::string& key, double measuredMs) const
+{
+  Comparison c;
+  c.baselineMs = get_baseline_ms(key);
+  c.key = key;
+  c.measuredMs = measuredMs;
+
+  if(!c.baselineMs) c.verdict = VERDICT_NEW;
+  else if(measuredMs > *c.baselineMs * (1.0 + m_tolerance)) c.verdict = VERDICT_SLOWER;
+  else if(measuredMs < *c.baselineMs * (1.0 - m_tolerance)) c.verdict = VERDICT_FASTER;
+  else c.verdict = VERDICT_UNCHANGED;
+
+  return c;
+}
+
+boost::optional<double> PerformanceBaseline::get_baseline_ms(const std::string& key) const
+{
+  std::map<std::string,double>::const_iterator it = m_baselineMs.find(key);
+  return it != m_baselineMs.end() ? boost::optional<double>(it->second) : boost::none;
+}
+
+bool PerformanceBaseline::load(const std::string& filename)
+{
+  std::ifstream fs(filename.c_str());
+  if(!fs) return false;
+
+  std::string line;
+  for(int lineNumber = 1; std::getline(fs, line); ++lineNumber)
+  {
+    if(line.empty()) continue;
+
+    std::istringstream ss(line);
+    double baselineMs;
+    std::string key;
+    if(!(ss >> baselineMs) || !std::getline(ss >> std::ws, key) || key.empty())
+    {
+      std::ostringstream oss;
+      oss << "Error: Invalid performance baseline on line " << lineNumber << " of " << filename;
+      throw std::runtime_error(oss.str());
+    }
+
+    m_baselineMs[key] = baselineMs;
+  }
+
+  return true;
+}
+
+void PerformanceBaseline::save(const std::string& filename) const
+{
+  std::ofstream fs(filename.c_str());
+  if(!fs) throw std::runtime_error("Error: Could not open " + filename + " for writing");
+
+  // Note: The timings are written with enough precision that they can be reloaded without changing their classifications.
+  fs << std::setprecision(9);
+  for(std::map<std::string,double>::const_iterator it = m_baselineMs.begin(), iend = m_baselineMs.end(); it != iend; ++it)
+  {
+    fs << it->second << ' ' << it->first << '\n';
+  }
+
+  if(!fs) throw std::runtime_error("Error: Could not write the performance baselines to " + filename);
+}
+
+void PerformanceBaseline::set_baseline_ms(const std::string& key, double baselineMs)
+{
+  if(key.empty() || isspace(static_cast<unsigned char>(key[0])) || key.find('\n') != std::string::npos) throw std::invalid_argument("Error: Invalid performance baseline key: '" + key + "'");
+  if(baselineMs < 0.0) throw std::invalid_argument("Error: A baseline timing must be non-negative");
+  m_baselineMs[key] = baselineMs;
+}
+
+}
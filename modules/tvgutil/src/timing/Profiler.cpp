@@ -0,0 +1,432 @@
+/**
+ * tvgutil: Profiler.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "timing/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+//#################### LOCAL FUNCTIONS ####################
+
+/**
+ * \brief Gets the name of the specified device.
+ *
+ * \param device  The device.
+ * \return        The name of the device.
+ */
+const char *device_name(tvgutil::Profiler::Device device)
+{
+  return device == tvgutil::Profiler::DEVICE_GPU ? "gpu" : "cpu";
+}
+
+/**
+ * \brief Escapes a string so that it can be written to a JSON file.
+ *
+ * \param s The string.
+ * \return  The escaped string.
+ */
+std::string escape_json(const std::string& s)
+{
+  std::string result;
+  for(size_t i = 0, size = s.size(); i < size; ++i)
+  {
+    if(s[i] == '"' || s[i] == '\\') result += '\\';
+    result += s[i];
+  }
+  return result;
+}
+
+/**
+ * \brief Computes the specified percentile of a sorted set of values using the nearest-rank method.
+ *
+ * \param sortedValues  The sorted values (must be non-empty).
+ * \param percentile    The percentile to compute (in the range [0,100]).
+ * \return              The specified percentile of the values.
+ */
+double nearest_rank_percentile(const std::vector<double>& sortedValues, double percentile)
+{
+  size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sortedValues.size()));
+  return sortedValues[std::max<size_t>(rank, 1) - 1];
+}
+
+}
+
+namespace tvgutil {
+
+//#################### SINGLETON IMPLEMENTATION ####################
+
+Profiler::Profiler()
+: m_enabled(false),
+  m_epoch(Clock::now()),
+#ifdef WITH_CUDA
+  m_gpuEpochEvent(NULL),
+  m_gpuEpochMs(-1.0),
+#endif
+  m_maxTraceSize(100000),
+  m_windowSize(300)
+{}
+
+Profiler::~Profiler()
+{
+#ifdef WITH_CUDA
+  // Note: The CUDA runtime may already have been shut down by the time this is called, so we deliberately ignore any errors.
+  if(m_gpuEpochEvent) cudaEventDestroy(m_gpuEpochEvent);
+  for(size_t i = 0, size = m_freeEvents.size(); i < size; ++i) cudaEventDestroy(m_freeEvents[i]);
+  for(size_t i = 0, size = m_pendingGPUStages.size(); i < size; ++i)
+  {
+    cudaEventDestroy(m_pendingGPUStages[i].startEvent);
+    cudaEventDestroy(m_pendingGPUStages[i].stopEvent);
+  }
+#endif
+}
+
+Profiler& Profiler::instance()
+{
+  static Profiler s_instance;
+  return s_instance;
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void Profiler::export_chrome_trace(const std::string& path) const
+{
+  std::ofstream fs(path.c_str());
+  if(!fs) throw std::runtime_error("Error: Could not open " + path + " for writing");
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  // Name the processes so that the CPU threads and the GPU streams are shown separately in the trace viewer.
+  fs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+     << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n"
+     << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+  // Name any threads that have been given names, and all of the streams.
+  for(std::map<int,std::string>::const_iterator it = m_threadNames.begin(), iend = m_threadNames.end(); it != iend; ++it)
+  {
+    fs << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << it->first << ",\"args\":{\"name\":\"" << escape_json(it->second) << "\"}}";
+  }
+
+#ifdef WITH_CUDA
+  for(std::map<cudaStream_t,int>::const_iterator it = m_streamIndices.begin(), iend = m_streamIndices.end(); it != iend; ++it)
+  {
+    std::ostringstream oss;
+    if(it->second == 0) oss << "Default stream";
+    else oss << "Stream " << it->second;
+    fs << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << it->second << ",\"args\":{\"name\":\"" << oss.str() << "\"}}";
+  }
+#endif
+
+  // Write a complete event (with times in microseconds) for each sample.
+  fs << std::fixed << std::setprecision(3);
+  for(std::deque<Sample>::const_iterator it = m_trace.begin(), iend = m_trace.end(); it != iend; ++it)
+  {
+    const Stage& stage = m_stages[it->stageIndex];
+    const bool onGPU = stage.device == DEVICE_GPU;
+    fs << ",\n{\"name\":\"" << escape_json(stage.name) << "\",\"cat\":\"" << device_name(stage.device) << "\",\"ph\":\"X\""
+       << ",\"pid\":" << (onGPU ? 1 : 0) << ",\"tid\":" << it->threadIndex
+       << ",\"ts\":" << it->startMs * 1000.0 << ",\"dur\":" << it->durationMs * 1000.0 << '}';
+  }
+
+  fs << "\n]}\n";
+  if(!fs) throw std::runtime_error("Error: Could not write a profiling trace to " + path);
+}
+
+void Profiler::export_csv(const std::string& path) const
+{
+  std::ofstream fs(path.c_str());
+  if(!fs) throw std::runtime_error("Error: Could not open " + path + " for writing");
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  fs << "stage,device,thread,start_ms,duration_ms\n";
+  fs << std::fixed << std::setprecision(3);
+  for(std::deque<Sample>::const_iterator it = m_trace.begin(), iend = m_trace.end(); it != iend; ++it)
+  {
+    const Stage& stage = m_stages[it->stageIndex];
+    fs << stage.name << ',' << device_name(stage.device) << ',' << it->threadIndex << ',' << it->startMs << ',' << it->durationMs << '\n';
+  }
+
+  if(!fs) throw std::runtime_error("Error: Could not write profiling results to " + path);
+}
+
+std::vector<std::pair<std::string,double> > Profiler::get_gauges() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_gauges;
+}
+
+std::vector<Profiler::StageStats> Profiler::get_stage_stats() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  std::vector<StageStats> result;
+  std::vector<double> sortedDurations;
+  for(size_t i = 0, stageCount = m_stages.size(); i < stageCount; ++i)
+  {
+    const Stage& stage = m_stages[i];
+    if(stage.durationsMs.empty()) continue;
+
+    sortedDurations.assign(stage.durationsMs.begin(), stage.durationsMs.end());
+    std::sort(sortedDurations.begin(), sortedDurations.end());
+
+    double totalMs = 0.0;
+    for(size_t j = 0, size = sortedDurations.size(); j < size; ++j) totalMs += sortedDurations[j];
+
+    StageStats stats;
+    stats.count = stage.count;
+    stats.device = stage.device;
+    stats.lastMs = stage.durationsMs.back();
+    stats.meanMs = totalMs / sortedDurations.size();
+    stats.name = stage.name;
+    stats.p50Ms = nearest_rank_percentile(sortedDurations, 50.0);
+    stats.p90Ms = nearest_rank_percentile(sortedDurations, 90.0);
+    stats.p95Ms = nearest_rank_percentile(sortedDurations, 95.0);
+    stats.p99Ms = nearest_rank_percentile(sortedDurations, 99.0);
+    result.push_back(stats);
+  }
+
+  return result;
+}
+
+bool Profiler::is_enabled() const
+{
+  return m_enabled.load(boost::memory_order_relaxed);
+}
+
+void Profiler::record_cpu_stage(const char *stageName, const Clock::time_point& t0, const Clock::time_point& t1)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  const double startMs = to_ms(t0);
+  record_sample(lookup_stage(stageName, DEVICE_CPU), startMs, to_ms(t1) - startMs, lookup_thread());
+}
+
+void Profiler::reset()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  // Note: We keep the stages themselves, since any GPU stages that are still pending refer to them by index.
+  for(size_t i = 0, stageCount = m_stages.size(); i < stageCount; ++i)
+  {
+    m_stages[i].count = 0;
+    m_stages[i].durationsMs.clear();
+  }
+
+  m_trace.clear();
+}
+
+void Profiler::set_enabled(bool enabled)
+{
+  m_enabled.store(enabled, boost::memory_order_relaxed);
+}
+
+void Profiler::set_gauge(const std::string& name, double value)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  std::map<std::string,size_t>::const_iterator it = m_gaugeIndices.find(name);
+  if(it != m_gaugeIndices.end())
+  {
+    m_gauges[it->second].second = value;
+  }
+  else
+  {
+    m_gaugeIndices.insert(std::make_pair(name, m_gauges.size()));
+    m_gauges.push_back(std::make_pair(name, value));
+  }
+}
+
+void Profiler::set_max_trace_size(size_t maxTraceSize)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_maxTraceSize = maxTraceSize;
+  while(m_trace.size() > m_maxTraceSize) m_trace.pop_front();
+}
+
+void Profiler::set_thread_name(const std::string& name)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_threadNames[lookup_thread()] = name;
+}
+
+void Profiler::set_window_size(size_t windowSize)
+{
+  if(windowSize == 0) throw std::invalid_argument("Error: The profiler's window size must be non-zero");
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_windowSize = windowSize;
+  for(size_t i = 0, stageCount = m_stages.size(); i < stageCount; ++i)
+  {
+    std::deque<double>& durationsMs = m_stages[i].durationsMs;
+    while(durationsMs.size() > m_windowSize) durationsMs.pop_front();
+  }
+}
+
+void Profiler::update()
+{
+#ifdef WITH_CUDA
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  // Note: Stages on different streams can finish in any order, so we check all of the pending stages, keeping those that are still running.
+  std::deque<PendingGPUStage> stillPending;
+  for(std::deque<PendingGPUStage>::const_iterator it = m_pendingGPUStages.begin(), iend = m_pendingGPUStages.end(); it != iend; ++it)
+  {
+    const cudaError_t status = cudaEventQuery(it->stopEvent);
+    if(status == cudaErrorNotReady)
+    {
+      stillPending.push_back(*it);
+      continue;
+    }
+
+    float durationMs = 0.0f, startMs = 0.0f;
+    if(status == cudaSuccess &&
+       cudaEventElapsedTime(&durationMs, it->startEvent, it->stopEvent) == cudaSuccess &&
+       cudaEventElapsedTime(&startMs, m_gpuEpochEvent, it->startEvent) == cudaSuccess)
+    {
+      record_sample(it->stageIndex, m_gpuEpochMs + startMs, durationMs, it->streamIndex);
+    }
+
+    m_freeEvents.push_back(it->startEvent);
+    m_freeEvents.push_back(it->stopEvent);
+  }
+  m_pendingGPUStages.swap(stillPending);
+#endif
+}
+
+#ifdef WITH_CUDA
+cudaEvent_t Profiler::start_gpu_stage(cudaStream_t stream)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  // If this is the first GPU stage, record an event and wait for it, so as to relate GPU times to CPU times. This is the only
+  // time the profiler ever synchronises with the GPU. Note that relative to this, the GPU times drift only with the GPU clock.
+  if(m_gpuEpochMs < 0.0)
+  {
+    m_gpuEpochEvent = acquire_event();
+    cudaEventRecord(m_gpuEpochEvent, 0);
+    cudaEventSynchronize(m_gpuEpochEvent);
+    m_gpuEpochMs = to_ms(Clock::now());
+  }
+
+  cudaEvent_t startEvent = acquire_event();
+  cudaEventRecord(startEvent, stream);
+  return startEvent;
+}
+
+void Profiler::stop_gpu_stage(const char *stageName, cudaEvent_t startEvent, cudaStream_t stream)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  PendingGPUStage pendingStage;
+  pendingStage.stageIndex = lookup_stage(stageName, DEVICE_GPU);
+  pendingStage.startEvent = startEvent;
+  pendingStage.stopEvent = acquire_event();
+  pendingStage.streamIndex = lookup_stream(stream);
+  cudaEventRecord(pendingStage.stopEvent, stream);
+  m_pendingGPUStages.push_back(pendingStage);
+}
+#endif
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+#ifdef WITH_CUDA
+cudaEvent_t Profiler::acquire_event()
+{
+  if(!m_freeEvents.empty())
+  {
+    cudaEvent_t event = m_freeEvents.back();
+    m_freeEvents.pop_back();
+    return event;
+  }
+
+  cudaEvent_t event;
+  if(cudaEventCreate(&event) != cudaSuccess)
+  {
+    throw std::runtime_error("Error: Could not create a CUDA event for profiling");
+  }
+
+  return event;
+}
+#endif
+
+size_t Profiler::lookup_stage(const std::string& stageName, Device device)
+{
+  std::map<std::string,size_t>& stageIndices = m_stageIndices[device];
+  std::map<std::string,size_t>::const_iterator it = stageIndices.find(stageName);
+  if(it != stageIndices.end()) return it->second;
+
+  Stage stage;
+  stage.count = 0;
+  stage.device = device;
+  stage.name = stageName;
+  m_stages.push_back(stage);
+
+  return stageIndices[stageName] = m_stages.size() - 1;
+}
+
+#ifdef WITH_CUDA
+int Profiler::lookup_stream(cudaStream_t stream)
+{
+  std::map<cudaStream_t,int>::const_iterator it = m_streamIndices.find(stream);
+  if(it != m_streamIndices.end()) return it->second;
+
+  // Note: The default stream is always given index 0, so any other streams are numbered from 1.
+  const int streamIndex = stream == 0 ? 0 : static_cast<int>(m_streamIndices.size() + (m_streamIndices.count(0) ? 0 : 1));
+  m_streamIndices.insert(std::make_pair(stream, streamIndex));
+  return streamIndex;
+}
+#endif
+
+int Profiler::lookup_thread()
+{
+  const boost::thread::id threadID = boost::this_thread::get_id();
+  std::map<boost::thread::id,int>::const_iterator it = m_threadIndices.find(threadID);
+  if(it != m_threadIndices.end()) return it->second;
+
+  const int threadIndex = static_cast<int>(m_threadIndices.size());
+  m_threadIndices.insert(std::make_pair(threadID, threadIndex));
+  return threadIndex;
+}
+
+void Profiler::record_sample(size_t stageIndex, double startMs, double durationMs, int threadIndex)
+{
+  Stage& stage = m_stages[stageIndex];
+  ++stage.count;
+  stage.durationsMs.push_back(durationMs);
+  if(stage.durationsMs.size() > m_windowSize) stage.durationsMs.pop_front();
+
+  if(m_maxTraceSize == 0) return;
+
+  Sample sample;
+  sample.durationMs = durationMs;
+  sample.stageIndex = stageIndex;
+  sample.startMs = startMs;
+  sample.threadIndex = threadIndex;
+  m_trace.push_back(sample);
+  if(m_trace.size() > m_maxTraceSize) m_trace.pop_front();
+}
+
+double Profiler::to_ms(const Clock::time_point& t) const
+{
+  return boost::chrono::duration_cast<boost::chrono::duration<double,boost::milli> >(t - m_epoch).count();
+}
+
+//#################### STREAM OPERATORS ####################
+
+std::ostream& operator<<(std::ostream& os, const Profiler::StageStats& stats)
+{
+  os << stats.name << " (" << device_name(stats.device) << "): "
+     << std::fixed << std::setprecision(2)
+     << stats.lastMs << "ms last, " << stats.meanMs << "ms mean, "
+     << stats.p50Ms << "/" << stats.p90Ms << "/" << stats.p99Ms << "ms p50/p90/p99";
+  return os;
+}
+
+}
@@ -0,0 +1,98 @@
+/**
+ * scratchtest_grove: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <boost/chrono/chrono_io.hpp>
+
+#include <grove/features/interface/RGBDPatchFeatureCalculator.h>
+#include <grove/forests/cpu/DecisionForest_CPU.tpp>
+#include <grove/forests/interface/DecisionForest.tpp>
+using namespace grove;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+#include <tvgutil/timing/AverageTimer.h>
+using namespace tvgutil;
+
+//#################### TYPEDEFS ####################
+
+typedef DecisionForest_CPU<RGBDPatchDescriptor,5> Forest;
+typedef AverageTimer<boost::chrono::microseconds> AverageTimerUs;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Benchmarks the leaf-finding throughput of the CPU decision forest for each of the available node layouts.
+ *
+ * All of the layouts are evaluated on the same forest and the same (random) descriptors, and are checked to produce identical leaves.
+ */
+int main(int argc, char *argv[])
+try
+{
+  if(argc < 2 || argc > 3)
+  {
+    std::cerr << "Usage: scratchtest_grove <forest file> [<number of runs>]\n";
+    return EXIT_FAILURE;
+  }
+
+  const int runCount = argc == 3 ? atoi(argv[2]) : 20;
+
+  // Generate a VGA-sized image of random descriptors, with values in a similar range to those seen in practice.
+  RandomNumberGenerator rng(12345);
+  Forest::DescriptorImage_Ptr descriptors(new Forest::DescriptorImage(Vector2i(640, 480), true, false));
+  RGBDPatchDescriptor *descriptorsPtr = descriptors->GetData(MEMORYDEVICE_CPU);
+  for(size_t i = 0; i < descriptors->dataSize; ++i)
+  {
+    for(int j = 0; j < RGBDPatchDescriptor::FEATURE_COUNT; ++j)
+    {
+      descriptorsPtr[i].data[j] = rng.generate_real_from_uniform(-1000.0f, 1000.0f);
+    }
+  }
+
+  const DecisionForestNodeLayout layouts[] = { INTERLEAVED_LAYOUT, BREADTH_FIRST_LAYOUT, BLOCKED_LAYOUT };
+  const char *layoutNames[] = { "interleaved", "breadth-first", "blocked" };
+  const int layoutCount = sizeof(layouts) / sizeof(DecisionForestNodeLayout);
+
+  Forest::LeafIndicesImage_Ptr referenceLeafIndices;
+  for(int i = 0; i < layoutCount; ++i)
+  {
+    Forest forest(argv[1], layouts[i]);
+    Forest::LeafIndicesImage_Ptr leafIndices(new Forest::LeafIndicesImage(descriptors->noDims, true, false));
+
+    // Warm up the caches, then time the leaf-finding.
+    forest.find_leaves(descriptors, leafIndices);
+
+    AverageTimerUs timer(layoutNames[i]);
+    for(int j = 0; j < runCount; ++j)
+    {
+      timer.start();
+      forest.find_leaves(descriptors, leafIndices);
+      timer.stop();
+    }
+
+    const double descriptorsPerSecond = descriptors->dataSize / (timer.average_duration().count() / 1000000.0);
+    std::cout << timer.name() << ": " << timer.average_duration() << " per image (" << descriptorsPerSecond << " descriptors/s)\n";
+
+    // Check that the layout produces the same leaves as the interleaved one.
+    if(!referenceLeafIndices)
+    {
+      referenceLeafIndices = leafIndices;
+    }
+    else if(memcmp(leafIndices->GetData(MEMORYDEVICE_CPU), referenceLeafIndices->GetData(MEMORYDEVICE_CPU), leafIndices->dataSize * sizeof(Forest::LeafIndices)) != 0)
+    {
+      std::cerr << "Error: The " << layoutNames[i] << " layout produced different leaves to the " << layoutNames[0] << " layout\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,56 @@
+/**
+ * scratchtest_groveatomics: contention.cu
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include "contention.h"
+
+#include <grove/util/WarpAggregatedAtomics.h>
+using namespace grove;
+
+//#################### CUDA KERNELS ####################
+
+__global__ void ck_increment_aggregated(const int *keys, int threadCount, int *counters, int *oldValues)
+{
+  const int tid = threadIdx.x + blockIdx.x * blockDim.x;
+  if(tid < threadCount)
+  {
+    const int key = keys[tid];
+    oldValues[tid] = warp_aggregated_increment(&counters[key], key);
+  }
+}
+
+__global__ void ck_increment_plain(const int *keys, int threadCount, int *counters, int *oldValues)
+{
+  const int tid = threadIdx.x + blockIdx.x * blockDim.x;
+  if(tid < threadCount)
+  {
+    oldValues[tid] = atomicAdd(&counters[keys[tid]], 1);
+  }
+}
+
+//#################### FUNCTIONS ####################
+
+float execute_increment_kernel(const int *keys, int threadCount, int *counters, int *oldValues, bool useAggregation)
+{
+  const int threadsPerBlock = 256;
+  const int numBlocks = (threadCount + threadsPerBlock - 1) / threadsPerBlock;
+
+  cudaEvent_t start, stop;
+  cudaEventCreate(&start);
+  cudaEventCreate(&stop);
+
+  cudaEventRecord(start);
+  if(useAggregation) ck_increment_aggregated<<<numBlocks,threadsPerBlock>>>(keys, threadCount, counters, oldValues);
+  else ck_increment_plain<<<numBlocks,threadsPerBlock>>>(keys, threadCount, counters, oldValues);
+  cudaEventRecord(stop);
+  cudaEventSynchronize(stop);
+
+  float milliseconds = 0.0f;
+  cudaEventElapsedTime(&milliseconds, start, stop);
+
+  cudaEventDestroy(start);
+  cudaEventDestroy(stop);
+
+  return milliseconds;
+}
@@ -0,0 +1,23 @@
+/**
+ * scratchtest_groveatomics: contention.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_CONTENTION
+#define H_CONTENTION
+
+//#################### FUNCTION DECLARATIONS ####################
+
+/**
+ * \brief Runs a kernel in which each thread increments the counter with index keys[tid] and records the old value it receives.
+ *
+ * \param keys            The (device) array of counter indices, one per thread.
+ * \param threadCount     The number of threads to run.
+ * \param counters        The (device) array of counters.
+ * \param oldValues       The (device) array into which to write the old value received by each thread.
+ * \param useAggregation  Whether to use warp-aggregated increments (true) or a plain atomicAdd per thread (false).
+ * \return                The time taken by the kernel, in milliseconds.
+ */
+float execute_increment_kernel(const int *keys, int threadCount, int *counters, int *oldValues, bool useAggregation);
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * scratchtest_groveatomics: main.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <cuda_runtime.h>
+
+#include "contention.h"
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Checks that the old values handed out for each counter are exactly 0, 1, ..., n-1 (in some order),
+ *        where n is the number of threads that incremented that counter.
+ */
+bool check_old_values(const std::vector<int>& keys, const std::vector<int>& oldValues, const std::vector<int>& counters)
+{
+  std::vector<std::vector<int> > valuesPerCounter(counters.size());
+  for(size_t i = 0, size = keys.size(); i < size; ++i)
+  {
+    valuesPerCounter[keys[i]].push_back(oldValues[i]);
+  }
+
+  for(size_t k = 0, size = counters.size(); k < size; ++k)
+  {
+    std::vector<int>& values = valuesPerCounter[k];
+    if(static_cast<int>(values.size()) != counters[k]) return false;
+
+    std::sort(values.begin(), values.end());
+    for(int i = 0, count = static_cast<int>(values.size()); i < count; ++i)
+    {
+      if(values[i] != i) return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * \brief Compares plain and warp-aggregated atomic increments on a VGA-sized set of threads, for a range of numbers of distinct counters.
+ *
+ * The case with a single counter simulates the worst case in add_example_to_reservoirs, in which every pixel falls into the same leaf.
+ */
+int main()
+{
+  const int threadCount = 640 * 480;
+  const int maxCounterCount = 65536;
+  const int counterCounts[] = { 1, 4, 32, 1024, maxCounterCount };
+  const int runCount = 20;
+
+  int *d_counters, *d_keys, *d_oldValues;
+  cudaMalloc((void**)&d_counters, maxCounterCount * sizeof(int));
+  cudaMalloc((void**)&d_keys, threadCount * sizeof(int));
+  cudaMalloc((void**)&d_oldValues, threadCount * sizeof(int));
+
+  for(size_t i = 0; i < sizeof(counterCounts) / sizeof(int); ++i)
+  {
+    // Assign the threads to the counters in contiguous runs, in the way that neighbouring pixels tend to fall into the same leaf.
+    const int counterCount = counterCounts[i];
+    std::vector<int> keys(threadCount);
+    for(int j = 0; j < threadCount; ++j)
+    {
+      keys[j] = static_cast<int>(static_cast<long long>(j) * counterCount / threadCount);
+    }
+    cudaMemcpy(d_keys, &keys[0], threadCount * sizeof(int), cudaMemcpyHostToDevice);
+
+    for(int useAggregation = 0; useAggregation < 2; ++useAggregation)
+    {
+      float totalMilliseconds = 0.0f;
+      for(int j = 0; j < runCount; ++j)
+      {
+        cudaMemset(d_counters, 0, counterCount * sizeof(int));
+        totalMilliseconds += execute_increment_kernel(d_keys, threadCount, d_counters, d_oldValues, useAggregation != 0);
+      }
+
+      cudaError_t err = cudaGetLastError();
+      if(err != cudaSuccess)
+      {
+        std::cerr << "Error: " << cudaGetErrorString(err) << '\n';
+        return EXIT_FAILURE;
+      }
+
+      // Check that the increments handed out the same set of old values as separate atomics would have done.
+      std::vector<int> counters(counterCount), oldValues(threadCount);
+      cudaMemcpy(&counters[0], d_counters, counterCount * sizeof(int), cudaMemcpyDeviceToHost);
+      cudaMemcpy(&oldValues[0], d_oldValues, threadCount * sizeof(int), cudaMemcpyDeviceToHost);
+      const bool valid = check_old_values(keys, oldValues, counters);
+
+      std::cout << counterCount << " counter(s), " << (useAggregation ? "aggregated" : "plain") << ": "
+                << totalMilliseconds / runCount << "ms" << (valid ? "" : " (INVALID RESULTS)") << '\n';
+
+      if(!valid) return EXIT_FAILURE;
+    }
+  }
+
+  cudaFree(d_oldValues);
+  cudaFree(d_keys);
+  cudaFree(d_counters);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+
+#include <ITMLib/Core/ITMDenseMapper.h>
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+using namespace ITMLib;
+
+#include <spaint/features/FeatureCalculatorFactory.h>
+#include <spaint/util/SpaintVoxelScene.h>
+using namespace spaint;
+
+#include <tvgutil/timing/Timer.h>
+
+// Benchmarks the CPU-based VOP feature calculator on a fixed set of voxels sampled from a synthetic, textured floor plane.
+// This is mainly useful for comparing builds with and without WITH_AVX2 (the features should be identical in both cases).
+
+const int VOXEL_COUNT = 512;
+const int ITERATION_COUNT = 50;
+
+void fill_plane(SpaintVoxelScene& scene)
+{
+  ITMHashEntry *hashTable = scene.index.GetEntries();
+  SpaintVoxel *voxelBlocks = scene.localVBA.GetVoxelBlocks();
+  int *allocationList = scene.localVBA.GetAllocationList();
+
+  // Allocate a 16x2x16 slab of voxel blocks straddling the plane y = 0 (skipping any blocks whose hash entries collide).
+  for(int bz = 0; bz < 16; ++bz)
+  {
+    for(int by = -1; by <= 0; ++by)
+    {
+      for(int bx = -8; bx < 8; ++bx)
+      {
+        Vector3s blockPos(bx, by, bz);
+        ITMHashEntry& entry = hashTable[hashIndex(blockPos)];
+        if(entry.ptr >= -1) continue;
+
+        entry.pos = blockPos;
+        entry.ptr = allocationList[scene.localVBA.lastFreeBlockId--];
+        entry.offset = 0;
+
+        // Fill in the voxels so that the surface lies at y = 0, and colour them with a checkerboard so that the patches have a dominant orientation.
+        SpaintVoxel *block = voxelBlocks + entry.ptr * SDF_BLOCK_SIZE3;
+        for(int z = 0; z < SDF_BLOCK_SIZE; ++z)
+        {
+          for(int y = 0; y < SDF_BLOCK_SIZE; ++y)
+          {
+            for(int x = 0; x < SDF_BLOCK_SIZE; ++x)
+            {
+              const int wx = bx * SDF_BLOCK_SIZE + x, wy = by * SDF_BLOCK_SIZE + y, wz = bz * SDF_BLOCK_SIZE + z;
+              SpaintVoxel& voxel = block[(z * SDF_BLOCK_SIZE + y) * SDF_BLOCK_SIZE + x];
+              voxel.sdf = SpaintVoxel::floatToValue(CLAMP(wy / 4.0f, -1.0f, 1.0f));
+              voxel.w_depth = 1;
+#ifndef USE_LOW_POWER_MODE
+              voxel.clr = (((wx + 64) / 3 + wz / 5) % 2) ? Vector3u(200, 80, 40) : Vector3u(30, 160, 220);
+              voxel.w_color = 1;
+#endif
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+int main()
+{
+  ITMLibSettings settings;
+  settings.deviceType = ITMLibSettings::DEVICE_CPU;
+
+  // Make a synthetic scene.
+  SpaintVoxelScene scene(&settings.sceneParams, false, MEMORYDEVICE_CPU);
+  ITMDenseMapper<SpaintVoxel,ITMVoxelIndex> mapper(&settings);
+  mapper.ResetScene(&scene);
+  fill_plane(scene);
+
+  // Choose a fixed set of voxels on the surface of the plane.
+  ORUtils::MemoryBlock<Vector3s> voxelLocationsMB(VOXEL_COUNT, true, false);
+  Vector3s *voxelLocations = voxelLocationsMB.GetData(MEMORYDEVICE_CPU);
+  for(int i = 0; i < VOXEL_COUNT; ++i)
+  {
+    voxelLocations[i] = Vector3s(static_cast<short>(i % 32 * 2 - 32), 0, static_cast<short>(i / 32 * 4 + 32));
+  }
+
+  // Repeatedly calculate the features for the voxels.
+  FeatureCalculator_CPtr featureCalculator = FeatureCalculatorFactory::make_vop_feature_calculator(VOXEL_COUNT, 13, 0.01f / settings.sceneParams.voxelSize, 36, ITMLibSettings::DEVICE_CPU);
+  ORUtils::MemoryBlock<float> featuresMB(VOXEL_COUNT * featureCalculator->get_feature_count(), true, false);
+
+  featureCalculator->calculate_features(voxelLocationsMB, &scene, featuresMB);
+
+  TIME(
+    for(int i = 0; i < ITERATION_COUNT; ++i) featureCalculator->calculate_features(voxelLocationsMB, &scene, featuresMB),
+    milliseconds, calculateFeatures
+  );
+
+  std::cout << calculateFeatures << " for " << ITERATION_COUNT << " iterations of " << VOXEL_COUNT << " voxels\n";
+
+  // Output a checksum of the features, so that the results of different builds can be compared.
+  const float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
+  double checksum = 0.0;
+  for(size_t i = 0, size = featuresMB.dataSize; i < size; ++i) checksum += features[i] * (i % 7 + 1);
+  std::cout << "Feature checksum: " << checksum << '\n';
+
+  return 0;
+}
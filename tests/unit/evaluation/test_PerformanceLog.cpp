@@ -0,0 +1,118 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/filesystem.hpp>
+using boost::assign::list_of;
+using boost::assign::map_list_of;
+namespace bf = boost::filesystem;
+
+#include <evaluation/core/PerformanceLog.h>
+using namespace evaluation;
+
+//#################### HELPER FUNCTIONS ####################
+
+bf::path make_temp_path()
+{
+  return bf::temp_directory_path() / bf::unique_path("test_PerformanceLog-%%%%-%%%%-%%%%.log");
+}
+
+PerformanceResult make_result(float accuracy)
+{
+  return map_list_of("Accuracy", PerformanceMeasure(5, accuracy, 0.125f));
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_PerformanceLog)
+
+BOOST_AUTO_TEST_CASE(record_and_reload_test)
+{
+  bf::path path = make_temp_path();
+  ParamSet foo = map_list_of("A", "1")("B", "");
+  ParamSet bar = map_list_of("A", "2")("B", "Bar Baz");
+
+  {
+    PerformanceLog log(path.string());
+    BOOST_CHECK(log.get_entries().empty());
+    log.record_performance(foo, make_result(0.3f));
+    log.record_performance(bar, make_result(0.7f));
+  }
+
+  // Reopening the log should load the entries that were recorded, including empty parameter values.
+  PerformanceLog log(path.string());
+  BOOST_CHECK_EQUAL(log.get_entries().size(), 2);
+
+  const PerformanceResult *result = log.find_result(bar);
+  BOOST_REQUIRE(result != NULL);
+  const PerformanceMeasure& measure = result->find("Accuracy")->second;
+  BOOST_CHECK_EQUAL(measure.get_mean(), 0.7f);
+  BOOST_CHECK_EQUAL(measure.get_sample_count(), 5);
+  BOOST_CHECK_EQUAL(measure.get_std_dev(), 0.125f);
+
+  BOOST_CHECK(log.find_result(foo) != NULL);
+  BOOST_CHECK(log.find_result(map_list_of("A", "3")("B", "")) == NULL);
+
+  bf::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(truncated_line_test)
+{
+  bf::path path = make_temp_path();
+  ParamSet foo = map_list_of("A", "1");
+  ParamSet bar = map_list_of("A", "2");
+
+  {
+    PerformanceLog log(path.string());
+    log.record_performance(foo, make_result(0.3f));
+  }
+
+  // Simulate a crash part-way through writing an entry.
+  {
+    std::ofstream fs(path.string().c_str(), std::ios::app);
+    fs << "1\tA\t2\t1\tAccu";
+  }
+
+  // The partial entry should be ignored, and it should be possible to append further entries.
+  {
+    PerformanceLog log(path.string());
+    BOOST_CHECK_EQUAL(log.get_entries().size(), 1);
+    log.record_performance(bar, make_result(0.7f));
+  }
+
+  BOOST_CHECK_EQUAL(PerformanceLog::load_entries(path.string()).size(), 2);
+
+  bf::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(merge_test)
+{
+  bf::path path1 = make_temp_path(), path2 = make_temp_path();
+  ParamSet foo = map_list_of("A", "1");
+  ParamSet bar = map_list_of("A", "2");
+
+  {
+    PerformanceLog log1(path1.string()), log2(path2.string());
+    log1.record_performance(foo, make_result(0.3f));
+    log2.record_performance(bar, make_result(0.7f));
+    log2.record_performance(foo, make_result(0.3f));
+  }
+
+  // The merged table should contain each parameter set exactly once.
+  PerformanceTable table = PerformanceLog::merge(list_of(path1.string())(path2.string()));
+  BOOST_CHECK(table.find_best_param_set("Accuracy") == bar);
+
+  std::ostringstream oss;
+  table.output(oss);
+  std::string output = oss.str();
+  BOOST_CHECK_EQUAL(std::count(output.begin(), output.end(), '\n'), 3);
+
+  bf::remove(path1);
+  bf::remove(path2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include <infermous/engines/DenseCRFInferenceEngine.h>
+using namespace infermous;
+
+//#################### HELPERS ####################
+
+typedef int Label;
+
+struct PPC : PairwisePotentialCalculator<Label>
+{
+  float calculate_potential(const Label& l1, const Label& l2) const
+  {
+    return l1 == l2 ? 0.0f : 1.0f;
+  }
+};
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_DenseCRFInferenceEngine)
+
+BOOST_AUTO_TEST_CASE(lattice_test)
+{
+  // Make a set of 2D points on a grid, and a set of values to filter.
+  const int size = 12;
+  const float stdDev = 2.0f;
+  std::vector<float> features, values;
+  for(int y = 0; y < size; ++y)
+  {
+    for(int x = 0; x < size; ++x)
+    {
+      features.push_back(x / stdDev);
+      features.push_back(y / stdDev);
+      values.push_back(x < size / 2 ? 1.0f : 0.0f);
+      values.push_back(1.0f);
+    }
+  }
+
+  PermutohedralLattice lattice(features, 2);
+  BOOST_CHECK_EQUAL(lattice.get_point_count(), size * size);
+
+  std::vector<float> filtered(values.size());
+  lattice.filter(&values[0], 2, &filtered[0]);
+
+  // Check that the normalised result of the filtering approximates exact Gaussian filtering of the values.
+  for(int i = 0; i < size * size; ++i)
+  {
+    float expected = 0.0f, norm = 0.0f;
+    for(int j = 0; j < size * size; ++j)
+    {
+      const float dx = features[2 * i] - features[2 * j], dy = features[2 * i + 1] - features[2 * j + 1];
+      const float w = expf(-0.5f * (dx * dx + dy * dy));
+      expected += w * values[2 * j];
+      norm += w;
+    }
+
+    BOOST_CHECK_SMALL(filtered[2 * i] / filtered[2 * i + 1] - expected / norm, 0.1f);
+  }
+
+  // Check that features whose number is not a multiple of the feature dimension cause a throw.
+  BOOST_CHECK_THROW(PermutohedralLattice(std::vector<float>(5), 2), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(update_crf_test)
+{
+  // Make an image whose left half is dark and whose right half is bright, and unaries that mostly (but not always) agree with it.
+  const int width = 16, height = 8;
+  std::vector<Eigen::Vector3f> colours;
+  ProbabilitiesGrid_Ptr<Label> unaries(new ProbabilitiesGrid<Label>(height, width));
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const Label trueLabel = x < width / 2 ? 0 : 1;
+      colours.push_back(trueLabel == 0 ? Eigen::Vector3f(20.0f, 20.0f, 20.0f) : Eigen::Vector3f(230.0f, 230.0f, 230.0f));
+
+      const bool noisy = (x * 5 + y * 3) % 7 == 0;
+      const Label label = noisy ? 1 - trueLabel : trueLabel;
+      (*unaries)(y, x)[label] = 0.6f;
+      (*unaries)(y, x)[1 - label] = 0.4f;
+    }
+  }
+
+  CRF2D_Ptr<Label> crf(new CRF2D<Label>(unaries, boost::shared_ptr<PPC>(new PPC)));
+  BOOST_CHECK_THROW(DenseCRFInferenceEngine<Label>(crf, std::vector<Eigen::Vector3f>(3)), std::invalid_argument);
+
+  DenseCRFInferenceEngine<Label> engine(crf, colours);
+  engine.update_crf(5);
+
+  // Check that the marginals are still normalised, and that the noise has been removed.
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const std::map<Label,float>& Q_i = crf->get_marginals_at(Eigen::Vector2i(x, y));
+      BOOST_CHECK_SMALL(Q_i.find(0)->second + Q_i.find(1)->second - 1.0f, 1e-5f);
+      BOOST_CHECK_EQUAL(tvgutil::ArgUtil::argmax(Q_i), x < width / 2 ? 0 : 1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include <infermous/engines/MeanFieldInferenceEngine.h>
+using namespace infermous;
+
+//#################### HELPERS ####################
+
+typedef int Label;
+
+struct PPC : PairwisePotentialCalculator<Label>
+{
+  float calculate_potential(const Label& l1, const Label& l2) const
+  {
+    return l1 == l2 ? 0.0f : 0.5f + 0.1f * std::abs(l1 - l2);
+  }
+};
+
+/**
+ * \brief Makes a CRF whose pixels have different (and partially overlapping) sets of labels.
+ */
+CRF2D_Ptr<Label> make_crf(int width, int height)
+{
+  ProbabilitiesGrid_Ptr<Label> unaries(new ProbabilitiesGrid<Label>(height, width));
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      std::map<Label,float>& psi_i = (*unaries)(y, x);
+      const int labelCount = 2 + (x + y) % 3;
+      float total = 0.0f;
+      for(int k = 0; k < labelCount; ++k)
+      {
+        psi_i[(x + 2 * k) % 5] = 1.0f + ((x * 7 + y * 13 + k * 3) % 11);
+      }
+      for(std::map<Label,float>::const_iterator it = psi_i.begin(), iend = psi_i.end(); it != iend; ++it) total += it->second;
+      for(std::map<Label,float>::iterator it = psi_i.begin(), iend = psi_i.end(); it != iend; ++it) it->second /= total;
+    }
+  }
+
+  return CRF2D_Ptr<Label>(new CRF2D<Label>(unaries, boost::shared_ptr<PPC>(new PPC)));
+}
+
+/**
+ * \brief Runs a single iteration of the original (sparse) mean-field update on a grid of marginals.
+ */
+ProbabilitiesGrid<Label> run_reference_iteration(const CRF2D<Label>& crf, const ProbabilitiesGrid<Label>& marginals, const std::vector<Eigen::Vector2i>& neighbourOffsets)
+{
+  PairwisePotentialCalculator_CPtr<Label> ppc = crf.get_pairwise_potential_calculator();
+  ProbabilitiesGrid<Label> result(crf.get_height(), crf.get_width());
+  for(int y = 0; y < crf.get_height(); ++y)
+  {
+    for(int x = 0; x < crf.get_width(); ++x)
+    {
+      const Eigen::Vector2i i(x, y);
+      const std::map<Label,float>& psi_i = crf.get_unaries_at(i);
+      std::map<Label,float>& Q_i = result(y, x);
+      float Z_i = 0.0f;
+      for(std::map<Label,float>::const_iterator kt = psi_i.begin(), kend = psi_i.end(); kt != kend; ++kt)
+      {
+        float M_i_L = -logf(kt->second);
+        for(size_t n = 0; n < neighbourOffsets.size(); ++n)
+        {
+          Eigen::Vector2i j = i + neighbourOffsets[n];
+          if(!crf.within_bounds(j)) continue;
+          const std::map<Label,float>& Q_j = marginals(j.y(), j.x());
+          for(std::map<Label,float>::const_iterator lt = Q_j.begin(), lend = Q_j.end(); lt != lend; ++lt)
+          {
+            M_i_L += lt->second * ppc->calculate_potential(kt->first, lt->first);
+          }
+        }
+        Q_i[kt->first] = expf(-M_i_L);
+        Z_i += Q_i[kt->first];
+      }
+      for(std::map<Label,float>::iterator kt = Q_i.begin(), kend = Q_i.end(); kt != kend; ++kt) kt->second /= Z_i;
+    }
+  }
+  return result;
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_MeanFieldInferenceEngine)
+
+BOOST_AUTO_TEST_CASE(update_crf_test)
+{
+  const int width = 7, height = 5;
+  const std::vector<Eigen::Vector2i> neighbourOffsets = CRFUtil::make_circular_neighbour_offsets(2);
+  CRF2D_Ptr<Label> crf = make_crf(width, height);
+
+  // Compute the expected marginals using the original sparse formulation.
+  ProbabilitiesGrid<Label> expectedMarginals = crf->get_marginals();
+  for(int k = 0; k < 3; ++k) expectedMarginals = run_reference_iteration(*crf, expectedMarginals, neighbourOffsets);
+
+  // Run the same number of iterations using the engine (split across two calls to check that the state carries over).
+  MeanFieldInferenceEngine<Label> mfie(crf, neighbourOffsets);
+  mfie.update_crf(2);
+  mfie.update_crf(1);
+
+  // Check that each pixel has marginals for exactly the labels in its unaries, and that they match the expected values.
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const std::map<Label,float>& Q_i = crf->get_marginals_at(Eigen::Vector2i(x, y));
+      const std::map<Label,float>& expectedQ_i = expectedMarginals(y, x);
+      BOOST_REQUIRE_EQUAL(Q_i.size(), expectedQ_i.size());
+      for(std::map<Label,float>::const_iterator it = expectedQ_i.begin(), iend = expectedQ_i.end(); it != iend; ++it)
+      {
+        std::map<Label,float>::const_iterator jt = Q_i.find(it->first);
+        BOOST_REQUIRE(jt != Q_i.end());
+        BOOST_CHECK_SMALL(jt->second - it->second, 1e-5f);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dense_grid_test)
+{
+  CRF2D_Ptr<Label> crf = make_crf(4, 3);
+  DenseProbabilitiesGrid<Label> grid(crf->get_unaries());
+
+  // Check that the labels are stored in ascending order, and that absent labels have zero probability.
+  BOOST_CHECK_EQUAL(grid.get_label_count(), 5);
+  BOOST_CHECK_EQUAL(grid.find_label_index(3), 3);
+  BOOST_CHECK_EQUAL(grid.find_label_index(7), -1);
+
+  const std::map<Label,float>& psi = crf->get_unaries_at(Eigen::Vector2i(1, 2));
+  for(int k = 0; k < grid.get_label_count(); ++k)
+  {
+    std::map<Label,float>::const_iterator it = psi.find(grid.get_labels()[k]);
+    BOOST_CHECK_EQUAL(grid(2, 1)[k], it != psi.end() ? it->second : 0.0f);
+  }
+
+  // Check that loading a grid of the wrong size causes a throw.
+  BOOST_CHECK_THROW(grid.load(ProbabilitiesGrid<Label>(2, 2)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+namespace bf = boost::filesystem;
+
+#include <itmx/persistence/PosePersister.h>
+using namespace itmx;
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Makes a pose that rotates by the specified angle about the specified (unit) axis, and then translates by the specified vector.
+ *
+ * \param axis        The axis of rotation.
+ * \param angle       The angle of rotation (in radians).
+ * \param translation The translation.
+ * \return            The pose.
+ */
+static Matrix4f make_pose(const Vector3f& axis, float angle, const Vector3f& translation)
+{
+  const float c = cos(angle), s = sin(angle);
+  const float cross[3][3] = {
+    { 0.0f, -axis.z, axis.y },
+    { axis.z, 0.0f, -axis.x },
+    { -axis.y, axis.x, 0.0f }
+  };
+
+  // Note that pose(x, y) is the element in column x and row y of the matrix.
+  Matrix4f pose;
+  pose.setIdentity();
+  for(int y = 0; y < 3; ++y)
+  {
+    for(int x = 0; x < 3; ++x)
+    {
+      pose(x, y) = (x == y ? c : 0.0f) + (1 - c) * axis[y] * axis[x] + s * cross[y][x];
+    }
+  }
+
+  pose(3, 0) = translation.x;
+  pose(3, 1) = translation.y;
+  pose(3, 2) = translation.z;
+  return pose;
+}
+
+/**
+ * \brief Determines whether or not two poses are approximately equal.
+ *
+ * \param lhs The first pose.
+ * \param rhs The second pose.
+ * \return    true, if the two poses are approximately equal, or false otherwise.
+ */
+static bool poses_close(const Matrix4f& lhs, const Matrix4f& rhs)
+{
+  for(int y = 0; y < 4; ++y)
+  {
+    for(int x = 0; x < 4; ++x)
+    {
+      if(fabs(lhs(x, y) - rhs(x, y)) > 1e-5f) return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * \brief Makes a unique path for a temporary trajectory file.
+ *
+ * \return  The path.
+ */
+static bf::path make_temporary_path()
+{
+  return bf::temp_directory_path() / bf::unique_path("test_PosePersister-%%%%-%%%%.txt");
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_PosePersister)
+
+BOOST_AUTO_TEST_CASE(test_trajectory_round_trip)
+{
+  // Make some poses that between them exercise every branch of the rotation -> quaternion conversion.
+  const float pi = static_cast<float>(M_PI);
+  const float invSqrt3 = 1.0f / sqrt(3.0f);
+  std::vector<PosePersister::TimestampedPose> trajectory;
+  trajectory.push_back(std::make_pair(0.0, make_pose(Vector3f(0.0f, 0.0f, 1.0f), 0.0f, Vector3f(0.0f, 0.0f, 0.0f))));
+  trajectory.push_back(std::make_pair(1.5, make_pose(Vector3f(0.0f, 0.0f, 1.0f), pi / 3, Vector3f(1.0f, -2.0f, 3.0f))));
+  trajectory.push_back(std::make_pair(2.0, make_pose(Vector3f(1.0f, 0.0f, 0.0f), pi, Vector3f(-0.25f, 0.5f, 0.125f))));
+  trajectory.push_back(std::make_pair(3.0, make_pose(Vector3f(0.0f, 1.0f, 0.0f), pi, Vector3f(10.0f, 20.0f, 30.0f))));
+  trajectory.push_back(std::make_pair(4.0, make_pose(Vector3f(0.0f, 0.0f, 1.0f), pi, Vector3f(0.0f, 0.0f, -1.0f))));
+  trajectory.push_back(std::make_pair(1234.000001, make_pose(Vector3f(invSqrt3, -invSqrt3, invSqrt3), 2.5f, Vector3f(0.1f, 0.2f, 0.3f))));
+
+  // Write the poses to a trajectory file, and then read them back in.
+  const bf::path path = make_temporary_path();
+  {
+    std::ofstream fs(path.string().c_str());
+    fs << "# timestamp tx ty tz qx qy qz qw\n";
+    for(size_t i = 0, size = trajectory.size(); i < size; ++i)
+    {
+      PosePersister::write_trajectory_entry(fs, trajectory[i].first, trajectory[i].second);
+    }
+  }
+
+  const std::vector<PosePersister::TimestampedPose> loadedTrajectory = PosePersister::load_trajectory(path);
+  bf::remove(path);
+
+  // Check that the poses that were read back in match the poses that were written out.
+  BOOST_REQUIRE_EQUAL(loadedTrajectory.size(), trajectory.size());
+  for(size_t i = 0, size = trajectory.size(); i < size; ++i)
+  {
+    BOOST_CHECK_CLOSE(loadedTrajectory[i].first, trajectory[i].first, 1e-9);
+    BOOST_CHECK(poses_close(loadedTrajectory[i].second, trajectory[i].second));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_load_trajectory_skips_blank_lines_and_comments)
+{
+  const bf::path path = make_temporary_path();
+  {
+    std::ofstream fs(path.string().c_str());
+    fs << "# A comment\n\n  \t\n1.0 1 2 3 0 0 0 1\n  # An indented comment\n2.0 4 5 6 0 0 0 2\n";
+  }
+
+  const std::vector<PosePersister::TimestampedPose> trajectory = PosePersister::load_trajectory(path);
+  bf::remove(path);
+
+  // Note that the second quaternion is not normalised, so this also checks that it is normalised when it is loaded.
+  BOOST_REQUIRE_EQUAL(trajectory.size(), static_cast<size_t>(2));
+  BOOST_CHECK(poses_close(trajectory[0].second, make_pose(Vector3f(0.0f, 0.0f, 1.0f), 0.0f, Vector3f(1.0f, 2.0f, 3.0f))));
+  BOOST_CHECK(poses_close(trajectory[1].second, make_pose(Vector3f(0.0f, 0.0f, 1.0f), 0.0f, Vector3f(4.0f, 5.0f, 6.0f))));
+}
+
+BOOST_AUTO_TEST_CASE(test_load_trajectory_rejects_invalid_lines)
+{
+  const bf::path path = make_temporary_path();
+
+  {
+    std::ofstream fs(path.string().c_str());
+    fs << "1.0 1 2 3 0 0 0 1\n2.0 4 5 6\n";
+  }
+  BOOST_CHECK_THROW(PosePersister::load_trajectory(path), std::runtime_error);
+
+  {
+    std::ofstream fs(path.string().c_str());
+    fs << "1.0 1 2 3 0 0 0 0\n";
+  }
+  BOOST_CHECK_THROW(PosePersister::load_trajectory(path), std::runtime_error);
+
+  bf::remove(path);
+  BOOST_CHECK_THROW(PosePersister::load_trajectory(path), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
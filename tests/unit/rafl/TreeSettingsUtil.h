@@ -0,0 +1,49 @@
+/**
+ * unit/rafl: TreeSettingsUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_UNIT_RAFL_TREESETTINGSUTIL
+#define H_UNIT_RAFL_TREESETTINGSUTIL
+
+#include <rafl/core/DecisionTree.h>
+#include <rafl/decisionfunctions/FeatureThresholdingDecisionFunctionGenerator.h>
+
+/**
+ * \brief Makes the settings for the small decision trees that the rafl tests train on unit circle examples.
+ *
+ * \param generator The generator to use to generate candidate decision functions.
+ * \param seed      The seed for the tree's random number generator.
+ * \return          The settings.
+ */
+template <typename Label>
+typename rafl::DecisionTree<Label>::Settings make_tree_settings(const typename rafl::DecisionTree<Label>::DecisionFunctionGenerator_CPtr& generator, unsigned int seed)
+{
+  typename rafl::DecisionTree<Label>::Settings settings;
+  settings.candidateCount = 64;
+  settings.decisionFunctionGenerator = generator;
+  settings.gainThreshold = 0.0f;
+  settings.maxClassSize = 1000;
+  settings.maxTreeHeight = 10;
+  settings.randomNumberGenerator.reset(new tvgutil::RandomNumberGenerator(seed));
+  settings.seenExamplesThreshold = 20;
+  settings.splittabilityThreshold = 0.5f;
+  settings.usePMFReweighting = false;
+  return settings;
+}
+
+/**
+ * \brief Makes the settings for the small decision trees that the rafl tests train on unit circle examples,
+ *        using feature thresholding to generate the candidate decision functions.
+ *
+ * \param seed  The seed for the tree's random number generator.
+ * \return      The settings.
+ */
+template <typename Label>
+typename rafl::DecisionTree<Label>::Settings make_tree_settings(unsigned int seed)
+{
+  typedef typename rafl::DecisionTree<Label>::DecisionFunctionGenerator_CPtr DecisionFunctionGenerator_CPtr;
+  return make_tree_settings<Label>(DecisionFunctionGenerator_CPtr(new rafl::FeatureThresholdingDecisionFunctionGenerator<Label>), seed);
+}
+
+#endif
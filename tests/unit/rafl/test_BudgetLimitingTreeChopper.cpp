@@ -0,0 +1,53 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+using boost::assign::list_of;
+
+#include <rafl/choppers/BudgetLimitingTreeChopper.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+using namespace rafl;
+
+#include "TreeSettingsUtil.h"
+
+typedef int Label;
+typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+typedef DecisionTree<Label> DT;
+typedef RandomForest<Label> RF;
+
+BOOST_AUTO_TEST_SUITE(test_BudgetLimitingTreeChopper)
+
+BOOST_AUTO_TEST_CASE(choose_tree_to_chop_test)
+{
+  const std::set<Label> classLabels = list_of(1)(2)(3);
+  UnitCircleExampleGenerator<Label> exampleGenerator(classLabels, 1234);
+  boost::shared_ptr<RF> forest(new RF(3, make_tree_settings<Label>(12345)));
+  forest->add_examples(exampleGenerator.generate_examples(classLabels, 100));
+  forest->train(64);
+
+  // The forest's node count and memory usage should be the sums of those of its trees.
+  size_t nodeCount = 0, memoryUsage = 0;
+  for(size_t i = 0, count = forest->get_tree_count(); i < count; ++i)
+  {
+    nodeCount += forest->get_tree(i)->get_node_count();
+    memoryUsage += forest->get_tree(i)->get_memory_usage();
+  }
+  BOOST_CHECK_EQUAL(forest->get_node_count(), nodeCount);
+  BOOST_CHECK_EQUAL(forest->get_memory_usage(), memoryUsage);
+  BOOST_CHECK_GT(memoryUsage, 0);
+
+  // A chopper whose budget is not exceeded should leave the forest unchanged.
+  BudgetLimitingTreeChopper<Label> generousChopper(memoryUsage, nodeCount);
+  BOOST_CHECK(!generousChopper.choose_tree_to_chop(forest));
+
+  // A chopper whose budget is exceeded should choose a tree to chop, and chopping it should reduce the size of the forest.
+  BudgetLimitingTreeChopper<Label> strictChopper(memoryUsage, nodeCount - 1);
+  strictChopper.set_validation_examples(exampleGenerator.generate_examples(classLabels, 50));
+  boost::optional<size_t> treeToChop = strictChopper.choose_tree_to_chop(forest);
+  BOOST_REQUIRE(treeToChop);
+
+  strictChopper.chop_tree_if_necessary(forest);
+  BOOST_CHECK_LT(forest->get_node_count(), nodeCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+namespace bf = boost::filesystem;
+
+#include <rafl/examples/ChunkedExampleReader.h>
+#include <rafl/examples/ChunkedExampleWriter.h>
+using namespace rafl;
+
+typedef int Label;
+
+BOOST_AUTO_TEST_SUITE(test_ChunkedExampleFile)
+
+BOOST_AUTO_TEST_CASE(round_trip_test)
+{
+  const size_t featureCount = 2, exampleCount = 7, chunkSize = 3;
+  const float features[exampleCount * featureCount] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f };
+  const Label labels[exampleCount] = { 1, 3, 5, 7, 3, 1, 5 };
+
+  // Write the examples to a chunked example file.
+  bf::path path = bf::temp_directory_path() / bf::unique_path("test_ChunkedExampleFile-%%%%-%%%%.rce");
+  {
+    ChunkedExampleWriter<Label> writer(path.string(), featureCount, chunkSize);
+    for(size_t i = 0; i < exampleCount; ++i)
+    {
+      writer.add_example(features + i * featureCount, featureCount, labels[i]);
+    }
+
+    BOOST_CHECK_THROW(writer.add_example(features, featureCount + 1, labels[0]), std::invalid_argument);
+    writer.close();
+  }
+
+  BOOST_CHECK(ChunkedExampleFile::is_chunked_example_file(path.string()));
+
+  // Read the examples back in, and check that they are the same and arrive in chunks of the right sizes.
+  {
+    ChunkedExampleReader<Label> reader(path.string());
+    BOOST_CHECK_EQUAL(reader.get_feature_count(), featureCount);
+
+    ExampleMatrix<Label> chunk;
+    std::vector<size_t> chunkSizes;
+    size_t i = 0;
+    while(reader.read_chunk(chunk))
+    {
+      chunkSizes.push_back(chunk.size());
+      for(size_t j = 0, size = chunk.size(); j < size; ++j, ++i)
+      {
+        BOOST_CHECK_EQUAL(chunk.get_label(j), labels[i]);
+        BOOST_CHECK_EQUAL(chunk.get_features(j)[0], features[i * featureCount]);
+        BOOST_CHECK_EQUAL(chunk.get_features(j)[1], features[i * featureCount + 1]);
+      }
+    }
+
+    BOOST_CHECK_EQUAL(i, exampleCount);
+    BOOST_REQUIRE_EQUAL(chunkSizes.size(), 3);
+    BOOST_CHECK_EQUAL(chunkSizes[0], 3);
+    BOOST_CHECK_EQUAL(chunkSizes[1], 3);
+    BOOST_CHECK_EQUAL(chunkSizes[2], 1);
+    BOOST_CHECK(chunk.empty());
+  }
+
+  // Check that truncated files are rejected.
+  bf::resize_file(path, bf::file_size(path) - 4);
+  {
+    ChunkedExampleReader<Label> reader(path.string());
+    ExampleMatrix<Label> chunk;
+    BOOST_CHECK(reader.read_chunk(chunk));
+    BOOST_CHECK(reader.read_chunk(chunk));
+    BOOST_CHECK_THROW(reader.read_chunk(chunk), std::runtime_error);
+  }
+
+  bf::remove(path);
+  BOOST_CHECK(!ChunkedExampleFile::is_chunked_example_file(path.string()));
+  BOOST_CHECK_THROW(ChunkedExampleReader<Label> reader(path.string()), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,117 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/filesystem.hpp>
+using boost::assign::list_of;
+namespace bf = boost::filesystem;
+
+#include <rafl/core/CompiledRandomForest.h>
+#include <rafl/decisionfunctions/FeatureThresholdingDecisionFunctionGenerator.h>
+#include <rafl/decisionfunctions/PairwiseOpAndThresholdDecisionFunctionGenerator.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+using namespace rafl;
+
+#include "TreeSettingsUtil.h"
+
+typedef int Label;
+typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+typedef DecisionTree<Label> DT;
+typedef RandomForest<Label> RF;
+
+/**
+ * \brief Checks that a compiled forest predicts the same labels as the forest from which it was compiled.
+ *
+ * \param generator The generator to use to generate candidate decision functions when training the forest.
+ */
+void check_predictions(const DT::DecisionFunctionGenerator_CPtr& generator)
+{
+  // Train a small forest on examples drawn from around the unit circle.
+  const std::set<Label> classLabels = list_of(1)(2)(3)(4);
+  UnitCircleExampleGenerator<Label> exampleGenerator(classLabels, 1234);
+  RF forest(4, make_tree_settings<Label>(generator, 12345));
+  forest.add_examples(exampleGenerator.generate_examples(classLabels, 200));
+  forest.train(256);
+
+  // Generate some test descriptors, and store their features contiguously in the way that the compiled forest expects.
+  std::vector<Example_CPtr> testExamples = exampleGenerator.generate_examples(classLabels, 100);
+  const size_t descriptorSize = 2, descriptorCount = testExamples.size();
+  std::vector<float> features;
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    const Descriptor& descriptor = *testExamples[i]->get_descriptor();
+    features.insert(features.end(), descriptor.begin(), descriptor.end());
+  }
+
+  // Check that the compiled forest predicts the same labels as the original forest.
+  CompiledRandomForest<Label> compiledForest(forest);
+  std::vector<Label> labels(descriptorCount);
+  compiledForest.predict_batch(&features[0], descriptorSize, descriptorCount, &labels[0]);
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    BOOST_CHECK_EQUAL(labels[i], forest.predict(testExamples[i]->get_descriptor()));
+  }
+
+  // Check that trying to predict labels for descriptors that are too small causes a throw.
+  BOOST_CHECK_THROW(compiledForest.predict_batch(&features[0], compiledForest.get_min_descriptor_size() - 1, descriptorCount, &labels[0]), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE(test_CompiledRandomForest)
+
+BOOST_AUTO_TEST_CASE(predict_batch_test)
+{
+  check_predictions(DT::DecisionFunctionGenerator_CPtr(new FeatureThresholdingDecisionFunctionGenerator<Label>));
+  check_predictions(DT::DecisionFunctionGenerator_CPtr(new PairwiseOpAndThresholdDecisionFunctionGenerator<Label>));
+}
+
+BOOST_AUTO_TEST_CASE(save_load_test)
+{
+  // Train and compile a small forest.
+  const std::set<Label> classLabels = list_of(1)(2)(3);
+  UnitCircleExampleGenerator<Label> exampleGenerator(classLabels, 1234);
+  RF forest(3, make_tree_settings<Label>(DT::DecisionFunctionGenerator_CPtr(new PairwiseOpAndThresholdDecisionFunctionGenerator<Label>), 12345));
+  forest.add_examples(exampleGenerator.generate_examples(classLabels, 200));
+  forest.train(128);
+  CompiledRandomForest<Label> compiledForest(forest);
+
+  // Save the compiled forest and load it back in.
+  bf::path path = bf::temp_directory_path() / bf::unique_path("test_CompiledRandomForest-%%%%-%%%%.crf");
+  compiledForest.save(path.string());
+  BOOST_CHECK(CompiledRandomForest<Label>::is_compiled_forest_file(path.string()));
+  boost::shared_ptr<CompiledRandomForest<Label> > loadedForest = CompiledRandomForest<Label>::load(path.string());
+
+  // Check that the loaded forest is the same as the original one, and predicts the same labels.
+  BOOST_CHECK_EQUAL(loadedForest->get_label_count(), compiledForest.get_label_count());
+  BOOST_CHECK_EQUAL(loadedForest->get_min_descriptor_size(), compiledForest.get_min_descriptor_size());
+  BOOST_CHECK_EQUAL(loadedForest->get_nodes().size(), compiledForest.get_nodes().size());
+  BOOST_CHECK(loadedForest->get_root_indices() == compiledForest.get_root_indices());
+  BOOST_CHECK(loadedForest->get_leaf_masses() == compiledForest.get_leaf_masses());
+
+  std::vector<Example_CPtr> testExamples = exampleGenerator.generate_examples(classLabels, 50);
+  for(size_t i = 0, size = testExamples.size(); i < size; ++i)
+  {
+    const float *descriptor = &(*testExamples[i]->get_descriptor())[0];
+    BOOST_CHECK_EQUAL(loadedForest->predict(descriptor), compiledForest.predict(descriptor));
+  }
+
+  // Check that truncated files are rejected.
+  bf::resize_file(path, bf::file_size(path) - 4);
+  BOOST_CHECK_THROW(CompiledRandomForest<Label>::load(path.string()), std::runtime_error);
+
+  bf::remove(path);
+  BOOST_CHECK(!CompiledRandomForest<Label>::is_compiled_forest_file(path.string()));
+}
+
+BOOST_AUTO_TEST_CASE(label_range_test)
+{
+  // Check that trying to compile a forest with negative labels causes a throw.
+  const std::set<Label> classLabels = list_of(-1)(1);
+  UnitCircleExampleGenerator<Label> exampleGenerator(classLabels, 1234);
+  RF forest(1, make_tree_settings<Label>(DT::DecisionFunctionGenerator_CPtr(new FeatureThresholdingDecisionFunctionGenerator<Label>), 12345));
+  forest.add_examples(exampleGenerator.generate_examples(classLabels, 50));
+  forest.train(16);
+
+  BOOST_CHECK_THROW(CompiledRandomForest<Label> compiledForest(forest), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
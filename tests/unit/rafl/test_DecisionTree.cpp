@@ -0,0 +1,123 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/filesystem.hpp>
+using boost::assign::list_of;
+namespace bf = boost::filesystem;
+
+#include <rafl/core/RandomForest.h>
+#include <rafl/decisionfunctions/PairwiseOpAndThresholdDecisionFunctionGenerator.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+using namespace rafl;
+
+#include <tvgutil/persistence/SerializationUtil.h>
+using namespace tvgutil;
+
+typedef int Label;
+typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+typedef DecisionTree<Label> DT;
+
+/**
+ * \brief Makes the property map from which to load the settings for a decision tree.
+ *
+ * \return  The property map.
+ */
+std::map<std::string,std::string> make_properties()
+{
+  // Note: Registering the makers more than once is harmless.
+  DecisionFunctionGeneratorFactory<Label>::instance().register_rafl_makers();
+
+  return list_of<std::pair<std::string,std::string> >
+    ("candidateCount", "256")
+    ("decisionFunctionGeneratorParams", "")
+    ("decisionFunctionGeneratorType", "PairwiseOpAndThreshold")
+    ("gainThreshold", "0")
+    ("maxClassSize", "1000")
+    ("maxTreeHeight", "10")
+    ("randomSeed", "12345")
+    ("seenExamplesThreshold", "20")
+    ("splittabilityThreshold", "0.5")
+    ("usePMFReweighting", "0");
+}
+
+/**
+ * \brief Calculates the fraction of the specified examples whose labels are correctly predicted by a decision tree.
+ *
+ * \param tree      The decision tree.
+ * \param examples  The examples.
+ * \return          The fraction of the examples whose labels are correctly predicted by the tree.
+ */
+float calculate_accuracy(const DT& tree, const std::vector<Example_CPtr>& examples)
+{
+  size_t correctCount = 0;
+  for(size_t i = 0, size = examples.size(); i < size; ++i)
+  {
+    if(tree.predict(examples[i]->get_descriptor()) == examples[i]->get_label()) ++correctCount;
+  }
+  return static_cast<float>(correctCount) / examples.size();
+}
+
+BOOST_AUTO_TEST_SUITE(test_DecisionTree)
+
+BOOST_AUTO_TEST_CASE(racing_settings_test)
+{
+  std::map<std::string,std::string> properties = make_properties();
+
+  // Check that racing is disabled when the racing settings are omitted.
+  DT::Settings settings(properties);
+  BOOST_CHECK(!settings.useRacing);
+
+  // Check that the racing settings are loaded if present.
+  properties["racingConfidence"] = "0.9";
+  properties["racingInitialSampleCount"] = "32";
+  properties["useRacing"] = "1";
+  settings = DT::Settings(properties);
+  BOOST_CHECK(settings.useRacing);
+  BOOST_CHECK_EQUAL(settings.racingConfidence, 0.9f);
+  BOOST_CHECK_EQUAL(settings.racingInitialSampleCount, 32);
+
+  // Check that an invalid racing confidence causes a throw.
+  properties["racingConfidence"] = "1";
+  BOOST_CHECK_THROW(DT::Settings invalidSettings(properties), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(racing_test)
+{
+  const std::set<Label> classLabels = list_of(1)(2)(3)(4);
+  UnitCircleExampleGenerator<Label> exampleGenerator(classLabels, 1234);
+  std::vector<Example_CPtr> trainingExamples = exampleGenerator.generate_examples(classLabels, 500);
+  std::vector<Example_CPtr> testExamples = exampleGenerator.generate_examples(classLabels, 100);
+
+  // Train one tree without racing and one with it.
+  std::map<std::string,std::string> properties = make_properties();
+  DT tree((DT::Settings(properties)));
+  tree.add_examples(trainingExamples);
+  tree.train(64);
+
+  properties["racingInitialSampleCount"] = "64";
+  properties["useRacing"] = "1";
+  DT racingTree((DT::Settings(properties)));
+  racingTree.add_examples(trainingExamples);
+  racingTree.train(64);
+
+  // Check that racing does not noticeably reduce the accuracy of the tree.
+  BOOST_CHECK(racingTree.get_node_count() > 1);
+  BOOST_CHECK_GE(calculate_accuracy(racingTree, testExamples), calculate_accuracy(tree, testExamples) - 0.05f);
+
+  // Check that the tree survives a round trip through an archive.
+  bf::path path = bf::temp_directory_path() / bf::unique_path("test_DecisionTree-%%%%-%%%%.txt");
+  SerializationUtil::save_text(path.string(), racingTree);
+  boost::shared_ptr<DT> loadedTree = SerializationUtil::load_text(path.string(), loadedTree);
+  bf::remove(path);
+
+  std::ostringstream originalOutput, loadedOutput;
+  racingTree.output(originalOutput);
+  loadedTree->output(loadedOutput);
+  BOOST_CHECK_EQUAL(loadedOutput.str(), originalOutput.str());
+  BOOST_CHECK_EQUAL(calculate_accuracy(*loadedTree, testExamples), calculate_accuracy(racingTree, testExamples));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+using boost::assign::list_of;
+
+#include <rafl/core/RandomForest.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+using namespace rafl;
+
+#include "TreeSettingsUtil.h"
+
+typedef int Label;
+typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+typedef DecisionTree<Label> DT;
+typedef RandomForest<Label> RF;
+
+BOOST_AUTO_TEST_SUITE(test_ExampleMatrix)
+
+BOOST_AUTO_TEST_CASE(add_examples_test)
+{
+  const float features[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+  const Label labels[] = { 7, 8 };
+
+  ExampleMatrix<Label> examples;
+  BOOST_CHECK(examples.empty());
+
+  // Check that adding a block of examples stores them row by row.
+  examples.add_examples(features, 3, labels, 2);
+  BOOST_CHECK_EQUAL(examples.size(), 2);
+  BOOST_CHECK_EQUAL(examples.get_feature_count(), 3);
+  BOOST_CHECK_EQUAL(examples.get_features(1)[0], 4.0f);
+  BOOST_CHECK_EQUAL(examples.get_label(1), 8);
+
+  // Check that replacing an example overwrites its row.
+  examples.set_example(0, features + 3, 3, 9);
+  BOOST_CHECK_EQUAL(examples.get_features(0)[2], 6.0f);
+  BOOST_CHECK_EQUAL(examples.get_label(0), 9);
+
+  // Check that a standalone copy of an example has the right descriptor and label.
+  Example_CPtr example = examples.make_example(1);
+  BOOST_CHECK_EQUAL(example->get_descriptor()->size(), 3);
+  BOOST_CHECK_EQUAL((*example->get_descriptor())[2], 6.0f);
+  BOOST_CHECK_EQUAL(example->get_label(), 8);
+
+  // Check that trying to add an example with a different number of features causes a throw.
+  BOOST_CHECK_THROW(examples.add_example(features, 2, 7), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(forest_test)
+{
+  // Check that training a forest on an example matrix gives the same results as training it on the equivalent examples.
+  const std::set<Label> classLabels = list_of(1)(2)(3);
+  UnitCircleExampleGenerator<Label> exampleGenerator(classLabels, 1234);
+  std::vector<Example_CPtr> trainingExamples = exampleGenerator.generate_examples(classLabels, 100);
+
+  RF forestA(2, make_tree_settings<Label>(12345)), forestB(2, make_tree_settings<Label>(12345));
+  forestA.add_examples(trainingExamples);
+  forestB.add_examples(ExampleMatrix<Label>(trainingExamples));
+  forestA.train(64);
+  forestB.train(64);
+
+  std::vector<Example_CPtr> testExamples = exampleGenerator.generate_examples(classLabels, 50);
+  for(size_t i = 0, size = testExamples.size(); i < size; ++i)
+  {
+    BOOST_CHECK_EQUAL(forestA.predict(testExamples[i]->get_descriptor()), forestB.predict(testExamples[i]->get_descriptor()));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
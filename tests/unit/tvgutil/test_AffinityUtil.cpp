@@ -0,0 +1,45 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include <tvgutil/misc/AffinityUtil.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_AffinityUtil)
+
+BOOST_AUTO_TEST_CASE(get_default_thread_count_test)
+{
+  BOOST_CHECK_GE(AffinityUtil::get_default_thread_count(), 1);
+
+  std::vector<int> cpus;
+  cpus.push_back(0);
+  cpus.push_back(2);
+  BOOST_CHECK_EQUAL(AffinityUtil::get_default_thread_count(cpus), 2);
+}
+
+BOOST_AUTO_TEST_CASE(parse_cpu_list_test)
+{
+  BOOST_CHECK(AffinityUtil::parse_cpu_list("").empty());
+  BOOST_CHECK(AffinityUtil::parse_cpu_list("  ").empty());
+
+  std::vector<int> cpus = AffinityUtil::parse_cpu_list("5, 0-2,1 , 7-7");
+  int expected[] = { 0, 1, 2, 5, 7 };
+  BOOST_CHECK_EQUAL_COLLECTIONS(cpus.begin(), cpus.end(), expected, expected + sizeof(expected) / sizeof(int));
+
+  BOOST_CHECK_THROW(AffinityUtil::parse_cpu_list("0,"), std::invalid_argument);
+  BOOST_CHECK_THROW(AffinityUtil::parse_cpu_list("3-1"), std::invalid_argument);
+  BOOST_CHECK_THROW(AffinityUtil::parse_cpu_list("-1"), std::invalid_argument);
+  BOOST_CHECK_THROW(AffinityUtil::parse_cpu_list("a-b"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(set_current_thread_affinity_test)
+{
+  // An empty CPU set means no restriction, so should always succeed.
+  BOOST_CHECK(AffinityUtil::set_current_thread_affinity(std::vector<int>(), "test"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <tvgutil/statistics/Histogram.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+template <typename Label>
+void check_histogram()
+{
+  Histogram<Label> histogram;
+  BOOST_CHECK(histogram.empty());
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(3)), 0);
+
+  histogram.add(Label(3));
+  histogram.add(Label(7));
+  histogram.add(Label(3));
+
+  BOOST_CHECK_EQUAL(histogram.get_count(), 3);
+  BOOST_CHECK_EQUAL(histogram.get_bins().size(), 2);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(3)), 2);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(7)), 1);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(5)), 0);
+
+  // Adding to a copy of the histogram should not affect the original.
+  Histogram<Label> copy = histogram;
+  copy.add(Label(3));
+  copy.add(Label(5));
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(3)), 3);
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(5)), 1);
+  BOOST_CHECK_EQUAL(copy.get_bins().find(Label(3))->second, 3);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(3)), 2);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(5)), 0);
+  BOOST_CHECK_EQUAL(histogram.get_bins().find(Label(3))->second, 2);
+
+  // Likewise for assignment.
+  copy = histogram;
+  copy.add(Label(7));
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(7)), 2);
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(5)), 0);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(7)), 1);
+
+  // Swapping should exchange the contents of the histograms, and leave both of them usable.
+  copy.swap(histogram);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(7)), 2);
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(7)), 1);
+  copy.add(Label(7));
+  histogram.add(Label(5));
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(7)), 2);
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(5)), 0);
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(5)), 1);
+  BOOST_CHECK_EQUAL(histogram.get_count(), 5);
+
+  // Clearing a histogram should make it empty, but leave it usable.
+  histogram.clear();
+  BOOST_CHECK(histogram.empty());
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(3)), 0);
+  histogram.add(Label(3));
+  BOOST_CHECK_EQUAL(histogram.get_bin_count(Label(3)), 1);
+  BOOST_CHECK_EQUAL(copy.get_bin_count(Label(3)), 2);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_Histogram)
+
+BOOST_AUTO_TEST_CASE(dense_test)
+{
+  BOOST_CHECK(DenseLabelTraits<unsigned char>::IS_DENSE);
+  check_histogram<unsigned char>();
+}
+
+BOOST_AUTO_TEST_CASE(sparse_test)
+{
+  BOOST_CHECK(!DenseLabelTraits<int>::IS_DENSE);
+  check_histogram<int>();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,29 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <tvgutil/persistence/JSONUtil.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_JSONUtil)
+
+BOOST_AUTO_TEST_CASE(escape_string_test)
+{
+  // Ordinary characters (including non-ASCII bytes) should be left alone.
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string(""), "");
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string("sequences/7scenes/chess"), "sequences/7scenes/chess");
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string("caf\xc3\xa9"), "caf\xc3\xa9");
+
+  // Quotes and backslashes should be preceded by a backslash.
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string("a\"b"), "a\\\"b");
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string("C:\\data"), "C:\\\\data");
+
+  // Control characters should be replaced by their short escape sequences where they have one, and by \u00XX otherwise.
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string("a\nb\tc\rd\be\ff"), "a\\nb\\tc\\rd\\be\\ff");
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string(std::string("\0", 1)), "\\u0000");
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string("\x01\x1f"), "\\u0001\\u001f");
+  BOOST_CHECK_EQUAL(JSONUtil::escape_string("\x7f"), "\x7f");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+namespace bf = boost::filesystem;
+
+#include <tvgutil/timing/KernelMetricsCollector.h>
+using namespace tvgutil;
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_KernelMetricsCollector)
+
+BOOST_AUTO_TEST_CASE(export_csv_test)
+{
+  KernelMetricsCollector& collector = KernelMetricsCollector::instance();
+  collector.reset();
+
+  const bf::path path = bf::temp_directory_path() / bf::unique_path("kernelmetrics-%%%%-%%%%.csv");
+  collector.export_csv(path.string());
+
+  // With no kernels recorded, only the header should be written.
+  std::ifstream fs(path.string().c_str());
+  std::ostringstream oss;
+  oss << fs.rdbuf();
+  fs.close();
+  bf::remove(path);
+
+  BOOST_CHECK_EQUAL(oss.str(), "range,kernel,launches,achieved_occupancy,achieved_occupancy_samples,dram_read_throughput,dram_read_throughput_samples,"
+                               "dram_write_throughput,dram_write_throughput_samples\n");
+}
+
+BOOST_AUTO_TEST_CASE(ranges_test)
+{
+  KernelMetricsCollector& collector = KernelMetricsCollector::instance();
+  collector.reset();
+
+  // Popping an empty stack of ranges should be harmless, as should pushing and popping ranges whilst the collector is stopped.
+  collector.pop_range();
+  collector.push_range("outer");
+  collector.push_range("inner");
+  collector.pop_range();
+  collector.pop_range();
+  collector.pop_range();
+
+  BOOST_CHECK(!collector.is_enabled());
+  BOOST_CHECK(collector.get_kernel_stats().empty());
+}
+
+BOOST_AUTO_TEST_CASE(start_test)
+{
+  KernelMetricsCollector& collector = KernelMetricsCollector::instance();
+  BOOST_CHECK_THROW(collector.start(0), std::invalid_argument);
+
+#ifndef WITH_CUPTI
+  BOOST_CHECK_THROW(collector.start(10), std::runtime_error);
+  BOOST_CHECK(!collector.is_enabled());
+#endif
+
+  collector.stop();
+  BOOST_CHECK(!collector.is_enabled());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,71 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+namespace bf = boost::filesystem;
+
+#include <tvgutil/timing/PerformanceBaseline.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_PerformanceBaseline)
+
+BOOST_AUTO_TEST_CASE(compare_test)
+{
+  BOOST_CHECK_THROW(PerformanceBaseline(-0.1), std::invalid_argument);
+
+  PerformanceBaseline baseline(0.1);
+  baseline.set_baseline_ms("find_leaves,cuda", 10.0);
+
+  BOOST_CHECK_EQUAL(baseline.compare("find_leaves,cpu", 10.0).verdict, PerformanceBaseline::VERDICT_NEW);
+  BOOST_CHECK_EQUAL(baseline.compare("find_leaves,cuda", 10.5).verdict, PerformanceBaseline::VERDICT_UNCHANGED);
+  BOOST_CHECK_EQUAL(baseline.compare("find_leaves,cuda", 9.5).verdict, PerformanceBaseline::VERDICT_UNCHANGED);
+  BOOST_CHECK_EQUAL(baseline.compare("find_leaves,cuda", 11.5).verdict, PerformanceBaseline::VERDICT_SLOWER);
+  BOOST_CHECK_EQUAL(baseline.compare("find_leaves,cuda", 8.5).verdict, PerformanceBaseline::VERDICT_FASTER);
+
+  // A set of measurements should only fail the check if at least one of them is slower than its baseline.
+  std::ostringstream os;
+  std::vector<PerformanceBaseline::Measurement> measurements;
+  measurements.push_back(PerformanceBaseline::Measurement("find_leaves,cpu", 100.0));
+  measurements.push_back(PerformanceBaseline::Measurement("find_leaves,cuda", 8.5));
+  BOOST_CHECK(baseline.check(measurements, os));
+
+  measurements.push_back(PerformanceBaseline::Measurement("find_leaves,cuda", 11.5));
+  BOOST_CHECK(!baseline.check(measurements, os));
+}
+
+BOOST_AUTO_TEST_CASE(persistence_test)
+{
+  PerformanceBaseline baseline;
+  BOOST_CHECK_THROW(baseline.set_baseline_ms("", 1.0), std::invalid_argument);
+  BOOST_CHECK_THROW(baseline.set_baseline_ms(" leading space", 1.0), std::invalid_argument);
+  BOOST_CHECK_THROW(baseline.set_baseline_ms("vop_features", -1.0), std::invalid_argument);
+
+  // Keys may contain spaces, so check that they survive a round trip through a file.
+  baseline.set_baseline_ms("compute_keypoints_and_features (quantised),cpu,synthetic@640x480", 12.345678);
+  baseline.set_baseline_ms("vop_features,cuda", 0.5);
+
+  const bf::path path = bf::temp_directory_path() / bf::unique_path("test_PerformanceBaseline-%%%%-%%%%.txt");
+  baseline.save(path.string());
+
+  PerformanceBaseline loadedBaseline;
+  BOOST_CHECK(loadedBaseline.load(path.string()));
+  BOOST_CHECK_CLOSE(*loadedBaseline.get_baseline_ms("compute_keypoints_and_features (quantised),cpu,synthetic@640x480"), 12.345678, 1e-6);
+  BOOST_CHECK_CLOSE(*loadedBaseline.get_baseline_ms("vop_features,cuda"), 0.5, 1e-6);
+  BOOST_CHECK(!loadedBaseline.get_baseline_ms("vop_features,cpu"));
+
+  // A file that is not a valid baseline file should be rejected.
+  {
+    std::ofstream fs(path.string().c_str());
+    fs << "not-a-number vop_features,cuda\n";
+  }
+  BOOST_CHECK_THROW(loadedBaseline.load(path.string()), std::runtime_error);
+
+  // A missing file should simply result in no baselines being loaded.
+  bf::remove(path);
+  BOOST_CHECK(!PerformanceBaseline().load(path.string()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
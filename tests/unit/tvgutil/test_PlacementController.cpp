@@ -0,0 +1,57 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <tvgutil/timing/PlacementController.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_PlacementController)
+
+BOOST_AUTO_TEST_CASE(constructor_test)
+{
+  BOOST_CHECK_THROW(PlacementController(0, 10), std::invalid_argument);
+  BOOST_CHECK_THROW(PlacementController(2, 0), std::invalid_argument);
+  BOOST_CHECK_THROW(PlacementController(2, 10, 0.0), std::invalid_argument);
+  BOOST_CHECK_THROW(PlacementController(2, 10, 1.5), std::invalid_argument);
+
+  // Initially, none of the alternatives should have been measured.
+  PlacementController controller(2, 10);
+  BOOST_CHECK_LT(controller.get_estimated_cost(0), 0.0);
+  BOOST_CHECK_LT(controller.get_estimated_cost(1), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(choose_test)
+{
+  PlacementController controller(2, 4, 1.0);
+
+  // Each alternative should be tried once before any of them is chosen on the basis of its cost.
+  BOOST_CHECK_EQUAL(controller.choose(), 0U);
+  controller.update(0, 10.0);
+  BOOST_CHECK_EQUAL(controller.choose(), 1U);
+  controller.update(1, 5.0);
+
+  // After that, the cheapest alternative should be chosen, except on every fourth choice, when the other one should be probed.
+  BOOST_CHECK_EQUAL(controller.choose(), 1U);
+  controller.update(1, 5.0);
+  BOOST_CHECK_EQUAL(controller.choose(), 0U);
+  controller.update(0, 10.0);
+  BOOST_CHECK_EQUAL(controller.choose(), 1U);
+  controller.update(1, 5.0);
+
+  // If the cheapest alternative becomes more expensive, the controller should switch to the other one.
+  controller.update(1, 20.0);
+  BOOST_CHECK_EQUAL(controller.get_cheapest_alternative(), 0U);
+  BOOST_CHECK_EQUAL(controller.choose(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(update_test)
+{
+  // The first measurement of an alternative should replace its estimate, and later ones should be smoothed.
+  PlacementController controller(2, 10, 0.5);
+  controller.update(0, 10.0);
+  BOOST_CHECK_CLOSE(controller.get_estimated_cost(0), 10.0, 1e-6);
+  controller.update(0, 20.0);
+  BOOST_CHECK_CLOSE(controller.get_estimated_cost(0), 15.0, 1e-6);
+  BOOST_CHECK_LT(controller.get_estimated_cost(1), 0.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
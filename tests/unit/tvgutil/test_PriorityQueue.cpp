@@ -5,6 +5,7 @@
 using namespace tvgutil;
 
 typedef PriorityQueue<std::string, double, int, std::greater<double> > PQ;
+typedef PriorityQueue<int, double, int, std::greater<double>, PriorityQueueDenseDictionary<int> > DensePQ;
 
 BOOST_AUTO_TEST_SUITE(test_PriorityQueue)
 
@@ -42,6 +43,28 @@ BOOST_AUTO_TEST_CASE(element_test)
 
 // Note: empty() has been tested in other test cases
 
+BOOST_AUTO_TEST_CASE(dense_dictionary_test)
+{
+  DensePQ pq;
+  pq.insert(3, 1.0, 23);
+  pq.insert(0, 0.9, 13);
+  pq.insert(17, 1.1, 7);
+    BOOST_CHECK_EQUAL(pq.size(), 3);
+    BOOST_CHECK_EQUAL(pq.contains(3), true);
+    BOOST_CHECK_EQUAL(pq.contains(5), false);
+    BOOST_CHECK_EQUAL(pq.contains(100), false);
+    BOOST_CHECK_EQUAL(pq.element(3).data(), 23);
+    BOOST_CHECK_EQUAL(pq.top().id(), 17);
+  pq.erase(17);
+    BOOST_CHECK_EQUAL(pq.contains(17), false);
+    BOOST_CHECK_EQUAL(pq.top().id(), 3);
+  pq.update_key(0, 1.2);
+    BOOST_CHECK_EQUAL(pq.top().id(), 0);
+  pq.pop();
+  pq.pop();
+    BOOST_CHECK_EQUAL(pq.empty(), true);
+}
+
 BOOST_AUTO_TEST_CASE(erase_test)
 {
   PQ pq;
@@ -121,4 +144,35 @@ BOOST_AUTO_TEST_CASE(update_key_test)
     BOOST_CHECK_EQUAL(pq.empty(), true);
 }
 
+BOOST_AUTO_TEST_CASE(update_keys_test)
+{
+  const int n = 100;
+
+  // Check both a small batch of updates (applied individually) and a large one (applied by rebuilding the heap).
+  for(int batchSize = 1; batchSize <= n; batchSize *= 10)
+  {
+    DensePQ pq;
+    for(int i = 0; i < n; ++i) pq.insert(i, i, 0);
+
+    std::vector<std::pair<int,double> > updates;
+    for(int i = 0; i < batchSize; ++i) updates.push_back(std::make_pair(i, 2.0 * n - i));
+    pq.update_keys(updates);
+
+    // The updated elements should now be extracted first (in ascending ID order), followed by the remaining elements (in descending ID order).
+    for(int i = 0; i < batchSize; ++i)
+    {
+      BOOST_CHECK_EQUAL(pq.top().id(), i);
+      pq.pop();
+    }
+
+    for(int i = n - 1; i >= batchSize; --i)
+    {
+      BOOST_CHECK_EQUAL(pq.top().id(), i);
+      pq.pop();
+    }
+
+    BOOST_CHECK_EQUAL(pq.empty(), true);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
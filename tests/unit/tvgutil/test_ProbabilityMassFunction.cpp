@@ -0,0 +1,51 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+using boost::assign::map_list_of;
+
+#include <tvgutil/statistics/ProbabilityMassFunction.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+template <typename Label>
+void check_entropy()
+{
+  Histogram<Label> histogram;
+  for(int i = 0; i < 10; ++i) histogram.add(Label(1));
+  for(int i = 0; i < 5; ++i) histogram.add(Label(4));
+  for(int i = 0; i < 2; ++i) histogram.add(Label(9));
+
+  // The entropy calculated directly from the histogram should be identical to that of the corresponding PMF.
+  BOOST_CHECK_EQUAL(ProbabilityMassFunction<Label>::calculate_entropy(histogram), ProbabilityMassFunction<Label>(histogram).calculate_entropy());
+
+  // This should also be the case when multipliers are supplied (including multipliers for labels that are not in the histogram).
+  std::map<Label,float> multipliers = map_list_of(Label(0),3.0f)(Label(4),2.0f)(Label(9),0.5f)(Label(12),4.0f);
+  BOOST_CHECK_EQUAL(ProbabilityMassFunction<Label>::calculate_entropy(histogram, multipliers), ProbabilityMassFunction<Label>(histogram, multipliers).calculate_entropy());
+
+  // The multipliers should actually have been applied.
+  const std::map<Label,float>& masses = ProbabilityMassFunction<Label>(histogram, multipliers).get_masses();
+  const float TOL = 1e-4f;
+  BOOST_CHECK_CLOSE(masses.find(Label(1))->second, 10.0f / 21.0f, TOL);
+  BOOST_CHECK_CLOSE(masses.find(Label(4))->second, 10.0f / 21.0f, TOL);
+  BOOST_CHECK_CLOSE(masses.find(Label(9))->second, 1.0f / 21.0f, TOL);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_ProbabilityMassFunction)
+
+BOOST_AUTO_TEST_CASE(calculate_entropy_test)
+{
+  check_entropy<int>();
+  check_entropy<unsigned char>();
+}
+
+BOOST_AUTO_TEST_CASE(empty_histogram_test)
+{
+  Histogram<int> histogram;
+  BOOST_CHECK_THROW(ProbabilityMassFunction<int>::calculate_entropy(histogram), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,216 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+namespace bf = boost::filesystem;
+
+#include <tvgutil/timing/ProfilingScope.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+Profiler::Clock::time_point ms_after_epoch(const Profiler::Clock::time_point& epoch, int ms)
+{
+  return epoch + boost::chrono::milliseconds(ms);
+}
+
+const Profiler::StageStats *find_stats(const std::vector<Profiler::StageStats>& stats, const std::string& name)
+{
+  for(size_t i = 0, size = stats.size(); i < size; ++i)
+  {
+    if(stats[i].name == name) return &stats[i];
+  }
+  return NULL;
+}
+
+std::string read_file(const bf::path& path)
+{
+  std::ifstream fs(path.string().c_str());
+  std::ostringstream oss;
+  oss << fs.rdbuf();
+  return oss.str();
+}
+
+//#################### FIXTURES ####################
+
+struct ProfilerFixture
+{
+  ProfilerFixture()
+  {
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+    profiler.set_enabled(true);
+    profiler.set_max_trace_size(100000);
+    profiler.set_window_size(300);
+  }
+
+  ~ProfilerFixture()
+  {
+    Profiler& profiler = Profiler::instance();
+    profiler.set_enabled(false);
+    profiler.reset();
+  }
+};
+
+//#################### TESTS ####################
+
+BOOST_FIXTURE_TEST_SUITE(test_Profiler, ProfilerFixture)
+
+BOOST_AUTO_TEST_CASE(disabled_test)
+{
+  Profiler& profiler = Profiler::instance();
+  profiler.set_enabled(false);
+  {
+    ProfilingScope scope("disabled_test");
+  }
+  BOOST_CHECK(find_stats(profiler.get_stage_stats(), "disabled_test") == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(gauges_test)
+{
+  Profiler& profiler = Profiler::instance();
+  profiler.set_gauge("gauges_test_a", 1.0);
+  profiler.set_gauge("gauges_test_b", 2.0);
+  profiler.set_gauge("gauges_test_a", 3.0);
+
+  // Gauges should be listed in the order in which they were first set, and should hold their most recent values.
+  std::vector<std::pair<std::string,double> > gauges = profiler.get_gauges();
+  std::vector<std::pair<std::string,double> >::const_iterator a = gauges.end(), b = gauges.end();
+  for(std::vector<std::pair<std::string,double> >::const_iterator it = gauges.begin(), iend = gauges.end(); it != iend; ++it)
+  {
+    if(it->first == "gauges_test_a") a = it;
+    else if(it->first == "gauges_test_b") b = it;
+  }
+  BOOST_REQUIRE(a != gauges.end() && b != gauges.end());
+    BOOST_CHECK(a < b);
+    BOOST_CHECK_CLOSE(a->second, 3.0, 1e-6);
+    BOOST_CHECK_CLOSE(b->second, 2.0, 1e-6);
+
+  // Gauges should survive both resetting and disabling the profiler.
+  profiler.reset();
+  profiler.set_enabled(false);
+  profiler.set_gauge("gauges_test_b", 4.0);
+  gauges = profiler.get_gauges();
+  bool found = false;
+  for(size_t i = 0, size = gauges.size(); i < size; ++i)
+  {
+    if(gauges[i].first == "gauges_test_b") { found = true; BOOST_CHECK_CLOSE(gauges[i].second, 4.0, 1e-6); }
+  }
+  BOOST_CHECK(found);
+}
+
+BOOST_AUTO_TEST_CASE(percentiles_test)
+{
+  Profiler& profiler = Profiler::instance();
+  const Profiler::Clock::time_point t0 = Profiler::Clock::now();
+  for(int i = 1; i <= 100; ++i)
+  {
+    profiler.record_cpu_stage("percentiles_test", t0, ms_after_epoch(t0, i));
+  }
+
+  const std::vector<Profiler::StageStats> allStats = profiler.get_stage_stats();
+  const Profiler::StageStats *stats = find_stats(allStats, "percentiles_test");
+  BOOST_REQUIRE(stats != NULL);
+    BOOST_CHECK_EQUAL(stats->count, 100);
+    BOOST_CHECK_EQUAL(stats->device, Profiler::DEVICE_CPU);
+    BOOST_CHECK_CLOSE(stats->lastMs, 100.0, 1e-6);
+    BOOST_CHECK_CLOSE(stats->meanMs, 50.5, 1e-6);
+    BOOST_CHECK_CLOSE(stats->p50Ms, 50.0, 1e-6);
+    BOOST_CHECK_CLOSE(stats->p90Ms, 90.0, 1e-6);
+    BOOST_CHECK_CLOSE(stats->p95Ms, 95.0, 1e-6);
+    BOOST_CHECK_CLOSE(stats->p99Ms, 99.0, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(rolling_window_test)
+{
+  Profiler& profiler = Profiler::instance();
+  BOOST_CHECK_THROW(profiler.set_window_size(0), std::invalid_argument);
+
+  // Only the durations of the most recent runs should contribute to the statistics.
+  profiler.set_window_size(2);
+  const Profiler::Clock::time_point t0 = Profiler::Clock::now();
+  profiler.record_cpu_stage("rolling_window_test", t0, ms_after_epoch(t0, 100));
+  profiler.record_cpu_stage("rolling_window_test", t0, ms_after_epoch(t0, 2));
+  profiler.record_cpu_stage("rolling_window_test", t0, ms_after_epoch(t0, 4));
+
+  const std::vector<Profiler::StageStats> allStats = profiler.get_stage_stats();
+  const Profiler::StageStats *stats = find_stats(allStats, "rolling_window_test");
+  BOOST_REQUIRE(stats != NULL);
+    BOOST_CHECK_EQUAL(stats->count, 3);
+    BOOST_CHECK_CLOSE(stats->meanMs, 3.0, 1e-6);
+    BOOST_CHECK_CLOSE(stats->p99Ms, 4.0, 1e-6);
+
+  // Resetting the profiler should clear the statistics.
+  profiler.reset();
+  BOOST_CHECK(find_stats(profiler.get_stage_stats(), "rolling_window_test") == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(export_test)
+{
+  Profiler& profiler = Profiler::instance();
+  profiler.set_max_trace_size(2);
+  {
+    ProfilingScope scope1("export_test_a");
+    ProfilingScope scope2("export_test_b");
+  }
+  {
+    ProfilingScope scope("export_test_c");
+  }
+
+  const bf::path csvPath = bf::temp_directory_path() / bf::unique_path("profiler-%%%%-%%%%.csv");
+  const bf::path tracePath = bf::temp_directory_path() / bf::unique_path("profiler-%%%%-%%%%.json");
+  profiler.export_csv(csvPath.string());
+  profiler.export_chrome_trace(tracePath.string());
+
+  // Only the two most recent samples should have been kept in the trace.
+  const std::string csv = read_file(csvPath);
+    BOOST_CHECK_EQUAL(csv.find("stage,device,thread,start_ms,duration_ms\n"), 0);
+    BOOST_CHECK_EQUAL(csv.find("export_test_b,"), std::string::npos);
+    BOOST_CHECK(csv.find("export_test_a,cpu,") != std::string::npos);
+    BOOST_CHECK(csv.find("export_test_c,cpu,") != std::string::npos);
+
+  const std::string trace = read_file(tracePath);
+    BOOST_CHECK(trace.find("\"traceEvents\"") != std::string::npos);
+    BOOST_CHECK(trace.find("\"name\":\"export_test_c\",\"cat\":\"cpu\",\"ph\":\"X\"") != std::string::npos);
+
+  bf::remove(csvPath);
+  bf::remove(tracePath);
+
+  BOOST_CHECK_THROW(profiler.export_csv((bf::temp_directory_path() / "nonexistent" / "profiler.csv").string()), std::runtime_error);
+}
+
+void run_named_thread()
+{
+  Profiler::instance().set_thread_name("thread_names_test \"worker\"");
+  ProfilingScope scope("thread_names_test_worker");
+}
+
+BOOST_AUTO_TEST_CASE(thread_names_test)
+{
+  Profiler& profiler = Profiler::instance();
+  {
+    ProfilingScope scope("thread_names_test_main");
+  }
+  boost::thread worker(&run_named_thread);
+  worker.join();
+
+  const bf::path tracePath = bf::temp_directory_path() / bf::unique_path("profiler-%%%%-%%%%.json");
+  profiler.export_chrome_trace(tracePath.string());
+
+  // The named thread should be identified in the trace, and its samples should be on a different timeline from the main thread's.
+  const std::string trace = read_file(tracePath);
+    BOOST_CHECK(trace.find("\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,") != std::string::npos);
+    BOOST_CHECK(trace.find("\"args\":{\"name\":\"thread_names_test \\\"worker\\\"\"}") != std::string::npos);
+
+  const size_t mainPos = trace.find("\"name\":\"thread_names_test_main\"");
+  const size_t workerPos = trace.find("\"name\":\"thread_names_test_worker\"");
+    BOOST_REQUIRE(mainPos != std::string::npos && workerPos != std::string::npos);
+    BOOST_CHECK(trace.substr(trace.find("\"tid\":", mainPos), 10) != trace.substr(trace.find("\"tid\":", workerPos), 10));
+
+  bf::remove(tracePath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,56 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <vector>
+
+#include <tvgutil/containers/RunLengthSequence.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_RunLengthSequence)
+
+BOOST_AUTO_TEST_CASE(empty_test)
+{
+  RunLengthSequence<int> seq;
+  BOOST_CHECK(seq.empty());
+  BOOST_CHECK_EQUAL(seq.size(), 0);
+  BOOST_CHECK_EQUAL(seq.run_count(), 0);
+
+  std::vector<int> values;
+  seq.decode(std::back_inserter(values));
+  BOOST_CHECK(values.empty());
+}
+
+BOOST_AUTO_TEST_CASE(round_trip_test)
+{
+  const int arr[] = { 0, 0, 0, 3, 3, 1, 0, 0, 0, 0 };
+  const std::vector<int> values(arr, arr + sizeof(arr) / sizeof(int));
+
+  RunLengthSequence<int> seq(values.begin(), values.end());
+  BOOST_CHECK_EQUAL(seq.size(), values.size());
+  BOOST_CHECK_EQUAL(seq.run_count(), 4);
+  BOOST_CHECK_EQUAL(seq.runs()[0].first, 0);
+  BOOST_CHECK_EQUAL(seq.runs()[0].second, 3);
+  BOOST_CHECK_EQUAL(seq.runs()[3].second, 4);
+
+  std::vector<int> decoded(values.size());
+  std::vector<int>::iterator end = seq.decode(decoded.begin());
+  BOOST_CHECK(end == decoded.end());
+  BOOST_CHECK(decoded == values);
+
+  // Appending a value that continues the last run should extend it rather than starting a new one.
+  seq.push_back(0);
+  BOOST_CHECK_EQUAL(seq.run_count(), 4);
+  seq.push_back(7);
+  BOOST_CHECK_EQUAL(seq.run_count(), 5);
+  BOOST_CHECK_EQUAL(seq.size(), values.size() + 2);
+
+  seq.shrink_to_fit();
+  BOOST_CHECK_EQUAL(seq.byte_size(), 5 * sizeof(RunLengthSequence<int>::Run));
+
+  seq.clear();
+  BOOST_CHECK(seq.empty());
+  BOOST_CHECK_EQUAL(seq.run_count(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
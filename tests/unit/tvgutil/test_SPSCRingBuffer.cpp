@@ -0,0 +1,80 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <tvgutil/containers/SPSCRingBuffer.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+void produce(SPSCRingBuffer<int>& rb, int count)
+{
+  for(int i = 0; i < count; ++i)
+  {
+    while(rb.full()) boost::this_thread::yield();
+    rb.back_slot() = i;
+    rb.push();
+  }
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_SPSCRingBuffer)
+
+BOOST_AUTO_TEST_CASE(ctor_test)
+{
+  BOOST_CHECK_THROW(SPSCRingBuffer<int> rb(0), std::invalid_argument);
+
+  SPSCRingBuffer<int> rb(3, 7);
+    BOOST_CHECK_EQUAL(rb.capacity(), 3);
+    BOOST_CHECK_EQUAL(rb.empty(), true);
+    BOOST_CHECK_EQUAL(rb.full(), false);
+    BOOST_CHECK_EQUAL(rb.back_slot(), 7);
+    BOOST_CHECK_EQUAL(rb.slot(2), 7);
+    BOOST_CHECK_THROW(rb.slot(3), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(push_pop_test)
+{
+  SPSCRingBuffer<int> rb(2);
+  rb.back_slot() = 23;
+  rb.push();
+    BOOST_CHECK_EQUAL(rb.size(), 1);
+    BOOST_CHECK_EQUAL(rb.front(), 23);
+  rb.back_slot() = 9;
+  rb.push();
+    BOOST_CHECK_EQUAL(rb.full(), true);
+    BOOST_CHECK_EQUAL(rb.front(), 23);
+  rb.pop();
+    BOOST_CHECK_EQUAL(rb.size(), 1);
+    BOOST_CHECK_EQUAL(rb.front(), 9);
+  rb.back_slot() = 84;
+  rb.push();
+  rb.pop();
+    BOOST_CHECK_EQUAL(rb.front(), 84);
+  rb.pop();
+    BOOST_CHECK_EQUAL(rb.empty(), true);
+}
+
+BOOST_AUTO_TEST_CASE(threaded_test)
+{
+  const int count = 100000;
+  SPSCRingBuffer<int> rb(16);
+  boost::thread producer(boost::bind(&produce, boost::ref(rb), count));
+
+  bool inOrder = true;
+  for(int i = 0; i < count; ++i)
+  {
+    while(rb.empty()) boost::this_thread::yield();
+    if(rb.front() != i) inOrder = false;
+    rb.pop();
+  }
+
+  producer.join();
+    BOOST_CHECK_EQUAL(inOrder, true);
+    BOOST_CHECK_EQUAL(rb.empty(), true);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,31 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <tvgutil/numbers/SeedUtil.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_SeedUtil)
+
+BOOST_AUTO_TEST_CASE(derive_seed_test)
+{
+  // Derived seeds should be reproducible, and should differ between purposes and root seeds.
+  BOOST_CHECK_EQUAL(SeedUtil::derive_seed(12345, "forest"), SeedUtil::derive_seed(12345, "forest"));
+  BOOST_CHECK(SeedUtil::derive_seed(12345, "forest") != SeedUtil::derive_seed(12345, "ransac"));
+  BOOST_CHECK(SeedUtil::derive_seed(12345, "forest") != SeedUtil::derive_seed(12346, "forest"));
+}
+
+BOOST_AUTO_TEST_CASE(get_deterministic_seed_test)
+{
+  SettingsContainer settings;
+  BOOST_CHECK(!SeedUtil::is_deterministic(settings));
+  BOOST_CHECK(!SeedUtil::get_deterministic_seed(settings, "forest"));
+
+  settings.add_value("deterministic", "1");
+  BOOST_CHECK(SeedUtil::is_deterministic(settings));
+  BOOST_CHECK_EQUAL(*SeedUtil::get_deterministic_seed(settings, "forest"), SeedUtil::derive_seed(12345, "forest"));
+
+  settings.add_value("seed", "7");
+  BOOST_CHECK_EQUAL(*SeedUtil::get_deterministic_seed(settings, "forest"), SeedUtil::derive_seed(7, "forest"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
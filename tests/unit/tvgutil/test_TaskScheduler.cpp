@@ -0,0 +1,111 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+
+#include <tvgutil/misc/ParallelUtil.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+void fail_on(int i, int failIndex)
+{
+  if(i == failIndex) throw std::runtime_error("Error: Failed");
+}
+
+void increment(boost::atomic<int>& counter)
+{
+  ++counter;
+}
+
+void nested_sum(int i, int innerSize, std::vector<int>& sums, TaskScheduler& scheduler);
+
+void record(int i, std::vector<int>& values)
+{
+  values[i] += i;
+}
+
+void nested_sum(int i, int innerSize, std::vector<int>& sums, TaskScheduler& scheduler)
+{
+  std::vector<int> values(innerSize, 0);
+  ParallelUtil::parallel_for(0, innerSize, boost::bind(&record, _1, boost::ref(values)), 1, scheduler);
+
+  int sum = 0;
+  for(int j = 0; j < innerSize; ++j) sum += values[j];
+  sums[i] = sum;
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_TaskScheduler)
+
+BOOST_AUTO_TEST_CASE(parallel_for_test)
+{
+  TaskScheduler scheduler(4);
+
+  // Check that each index is visited exactly once, for a range of sizes and grain sizes.
+  const int sizes[] = { 0, 1, 7, 100, 1000 };
+  const int grainSizes[] = { 1, 3, 10000 };
+  for(size_t s = 0; s < sizeof(sizes) / sizeof(int); ++s)
+  {
+    for(size_t g = 0; g < sizeof(grainSizes) / sizeof(int); ++g)
+    {
+      std::vector<int> values(sizes[s], 0);
+      ParallelUtil::parallel_for(0, sizes[s], boost::bind(&record, _1, boost::ref(values)), grainSizes[g], scheduler);
+      for(int i = 0; i < sizes[s]; ++i) BOOST_CHECK_EQUAL(values[i], i);
+    }
+  }
+
+  // Check that nested loops complete and produce the right results without using more threads.
+  std::vector<int> sums(50, 0);
+  ParallelUtil::parallel_for(0, 50, boost::bind(&nested_sum, _1, 200, boost::ref(sums), boost::ref(scheduler)), 1, scheduler);
+  for(int i = 0; i < 50; ++i) BOOST_CHECK_EQUAL(sums[i], 199 * 200 / 2);
+
+  // Check that exceptions thrown on any index are propagated to the caller.
+  BOOST_CHECK_THROW(ParallelUtil::parallel_for(0, 100, boost::bind(&fail_on, _1, 0), 1, scheduler), std::runtime_error);
+  BOOST_CHECK_THROW(ParallelUtil::parallel_for(0, 100, boost::bind(&fail_on, _1, 99), 1, scheduler), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(serial_test)
+{
+  // A scheduler with a concurrency of one has no workers, so all tasks must be run by the waiting thread.
+  TaskScheduler scheduler(1);
+  BOOST_CHECK_EQUAL(scheduler.get_concurrency(), 1);
+
+  boost::atomic<int> counter(0);
+  {
+    TaskGroup group(scheduler);
+    for(int i = 0; i < 10; ++i) group.run(boost::bind(&increment, boost::ref(counter)));
+    group.wait();
+  }
+  BOOST_CHECK_EQUAL(counter, 10);
+
+  std::vector<int> values(100, 0);
+  ParallelUtil::parallel_for(0, 100, boost::bind(&record, _1, boost::ref(values)), 1, scheduler);
+  for(int i = 0; i < 100; ++i) BOOST_CHECK_EQUAL(values[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(task_group_test)
+{
+  TaskScheduler scheduler(4);
+  boost::atomic<int> counter(0);
+
+  TaskGroup group(scheduler);
+  for(int i = 0; i < 1000; ++i) group.run(boost::bind(&increment, boost::ref(counter)));
+  group.wait();
+  BOOST_CHECK_EQUAL(counter, 1000);
+
+  // Check that a failure is reported by wait, and that the group can then be reused.
+  group.run(boost::bind(&fail_on, 0, 0));
+  BOOST_CHECK_THROW(group.wait(), std::runtime_error);
+
+  group.run(boost::bind(&increment, boost::ref(counter)));
+  BOOST_CHECK_NO_THROW(group.wait());
+  BOOST_CHECK_EQUAL(counter, 1001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,179 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <tvgutil/misc/ThreadPool.h>
+using namespace tvgutil;
+
+//#################### HELPER TYPES ####################
+
+/**
+ * \brief An instance of this struct can be used to hold up a pool's thread until a test is ready for it to proceed.
+ */
+struct Gate
+{
+  boost::condition_variable cv;
+  boost::mutex mutex;
+  bool opened;
+  bool reached;
+
+  Gate() : opened(false), reached(false) {}
+
+  void open()
+  {
+    { boost::lock_guard<boost::mutex> lock(mutex); opened = true; }
+    cv.notify_all();
+  }
+
+  void pass()
+  {
+    boost::unique_lock<boost::mutex> lock(mutex);
+    reached = true;
+    cv.notify_all();
+    while(!opened) cv.wait(lock);
+  }
+
+  void wait_until_reached()
+  {
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while(!reached) cv.wait(lock);
+  }
+};
+
+//#################### HELPER FUNCTIONS ####################
+
+void record(boost::mutex& mutex, std::vector<int>& order, int value)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  order.push_back(value);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_ThreadPool)
+
+BOOST_AUTO_TEST_CASE(affinity_test)
+{
+  boost::mutex mutex;
+  std::vector<int> order;
+
+  // If the pool's threads are restricted to a set of CPUs, by default it should have one thread per CPU.
+  std::vector<int> cpus(1, 0);
+
+  {
+    ThreadPool pool(0, 0, ThreadPool::OP_BLOCK, cpus);
+    BOOST_CHECK_EQUAL(pool.get_thread_count(), 1);
+    pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 1));
+  }
+
+  BOOST_CHECK_EQUAL(order.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(block_test)
+{
+  Gate gate;
+  boost::mutex mutex;
+  std::vector<int> order;
+
+  {
+    ThreadPool pool(1, 1, ThreadPool::OP_BLOCK);
+    pool.post_task(boost::bind(&Gate::pass, &gate));
+    gate.wait_until_reached();
+
+    // The queue can hold one task, so posting a second should block until the gate is opened.
+    pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 1));
+    boost::thread poster(boost::bind(&ThreadPool::post_task<boost::function<void()> >, &pool,
+                                     boost::function<void()>(boost::bind(&record, boost::ref(mutex), boost::ref(order), 2)), ThreadPool::TP_NORMAL));
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+      BOOST_CHECK_EQUAL(pool.get_stats().queueDepth, 1);
+
+    gate.open();
+    poster.join();
+  }
+
+  BOOST_REQUIRE_EQUAL(order.size(), 2);
+    BOOST_CHECK_EQUAL(order[0], 1);
+    BOOST_CHECK_EQUAL(order[1], 2);
+}
+
+BOOST_AUTO_TEST_CASE(drop_test)
+{
+  Gate gate;
+  boost::mutex mutex;
+  std::vector<int> order;
+
+  {
+    ThreadPool pool(1, 2, ThreadPool::OP_DROP);
+    pool.post_task(boost::bind(&Gate::pass, &gate));
+    gate.wait_until_reached();
+
+    BOOST_CHECK(pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 1)));
+    BOOST_CHECK(pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 2)));
+
+    // The queue is full, so a new task of the same priority should be dropped...
+    BOOST_CHECK(!pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 3)));
+
+    // ...but a higher-priority task should displace the most recently posted lower-priority task.
+    BOOST_CHECK(pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 4), ThreadPool::TP_HIGH));
+      BOOST_CHECK_EQUAL(pool.get_stats().droppedTaskCount, 2);
+
+    gate.open();
+  }
+
+  BOOST_REQUIRE_EQUAL(order.size(), 2);
+    BOOST_CHECK_EQUAL(order[0], 4);
+    BOOST_CHECK_EQUAL(order[1], 1);
+}
+
+BOOST_AUTO_TEST_CASE(priority_test)
+{
+  Gate gate;
+  boost::mutex mutex;
+  std::vector<int> order;
+
+  {
+    ThreadPool pool(1);
+    pool.post_task(boost::bind(&Gate::pass, &gate));
+    gate.wait_until_reached();
+
+    pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 3), ThreadPool::TP_LOW);
+    pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 2), ThreadPool::TP_NORMAL);
+    pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 1), ThreadPool::TP_HIGH);
+    pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), 4), ThreadPool::TP_LOW);
+
+    gate.open();
+  }
+
+  BOOST_REQUIRE_EQUAL(order.size(), 4);
+    BOOST_CHECK_EQUAL(order[0], 1);
+    BOOST_CHECK_EQUAL(order[1], 2);
+    BOOST_CHECK_EQUAL(order[2], 3);
+    BOOST_CHECK_EQUAL(order[3], 4);
+}
+
+BOOST_AUTO_TEST_CASE(stats_test)
+{
+  boost::mutex mutex;
+  std::vector<int> order;
+
+  ThreadPool pool(4);
+  for(int i = 0; i < 100; ++i) pool.post_task(boost::bind(&record, boost::ref(mutex), boost::ref(order), i));
+
+  // Wait for all of the tasks to complete.
+  while(pool.get_stats().completedTaskCount < 100) boost::this_thread::yield();
+
+  ThreadPool::Stats stats = pool.get_stats();
+    BOOST_CHECK_EQUAL(stats.completedTaskCount, 100);
+    BOOST_CHECK_EQUAL(stats.droppedTaskCount, 0);
+    BOOST_CHECK_EQUAL(stats.queueDepth, 0);
+    BOOST_CHECK(stats.peakQueueDepth >= 1 && stats.peakQueueDepth <= 100);
+    BOOST_CHECK(stats.meanLatencyMs >= 0.0);
+    BOOST_CHECK(stats.throughput > 0.0);
+  BOOST_CHECK_EQUAL(order.size(), 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
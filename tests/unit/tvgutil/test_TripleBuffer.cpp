@@ -0,0 +1,83 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <tvgutil/containers/TripleBuffer.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+void produce(TripleBuffer<int>& tb, int count, boost::atomic<int>& droppedCount)
+{
+  for(int i = 0; i < count; ++i)
+  {
+    tb.back_slot() = i;
+    if(tb.push()) ++droppedCount;
+  }
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_TripleBuffer)
+
+BOOST_AUTO_TEST_CASE(ctor_test)
+{
+  TripleBuffer<int> tb(7);
+    BOOST_CHECK_EQUAL(tb.slot_count(), 3);
+    BOOST_CHECK_EQUAL(tb.has_fresh(), false);
+    BOOST_CHECK_EQUAL(tb.take(), false);
+    BOOST_CHECK_EQUAL(tb.back_slot(), 7);
+    BOOST_CHECK_THROW(tb.slot(3), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(push_take_test)
+{
+  TripleBuffer<int> tb;
+  tb.back_slot() = 23;
+    BOOST_CHECK_EQUAL(tb.push(), false);
+    BOOST_CHECK_EQUAL(tb.has_fresh(), true);
+    BOOST_CHECK_EQUAL(tb.take(), true);
+    BOOST_CHECK_EQUAL(tb.front(), 23);
+    BOOST_CHECK_EQUAL(tb.has_fresh(), false);
+
+  // Taking when nothing new has been published should leave the front element unchanged.
+    BOOST_CHECK_EQUAL(tb.take(), false);
+    BOOST_CHECK_EQUAL(tb.front(), 23);
+
+  // Publishing twice without a take should drop the older element.
+  tb.back_slot() = 9;
+    BOOST_CHECK_EQUAL(tb.push(), false);
+  tb.back_slot() = 84;
+    BOOST_CHECK_EQUAL(tb.push(), true);
+    BOOST_CHECK_EQUAL(tb.front(), 23);
+    BOOST_CHECK_EQUAL(tb.take(), true);
+    BOOST_CHECK_EQUAL(tb.front(), 84);
+}
+
+BOOST_AUTO_TEST_CASE(threaded_test)
+{
+  const int count = 100000;
+  TripleBuffer<int> tb(-1);
+  boost::atomic<int> droppedCount(0);
+  boost::thread producer(boost::bind(&produce, boost::ref(tb), count, boost::ref(droppedCount)));
+
+  // The consumer should only ever see increasing values, and every value it doesn't see should have been dropped.
+  bool increasing = true;
+  int lastValue = -1, takenCount = 0;
+  while(lastValue != count - 1)
+  {
+    if(!tb.take()) { boost::this_thread::yield(); continue; }
+    if(tb.front() <= lastValue) increasing = false;
+    lastValue = tb.front();
+    ++takenCount;
+  }
+
+  producer.join();
+    BOOST_CHECK_EQUAL(increasing, true);
+    BOOST_CHECK_EQUAL(takenCount + droppedCount, count);
+    BOOST_CHECK_EQUAL(tb.has_fresh(), false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,62 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <tvgutil/timing/WorkBudgetController.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_WorkBudgetController)
+
+BOOST_AUTO_TEST_CASE(constructor_test)
+{
+  BOOST_CHECK_THROW(WorkBudgetController(0.0, 1.0, 10.0, 5.0), std::invalid_argument);
+  BOOST_CHECK_THROW(WorkBudgetController(1.0, 10.0, 1.0, 5.0), std::invalid_argument);
+  BOOST_CHECK_THROW(WorkBudgetController(1.0, 1.0, 10.0, 5.0, 0.0), std::invalid_argument);
+  BOOST_CHECK_THROW(WorkBudgetController(1.0, 1.0, 10.0, 5.0, 1.5), std::invalid_argument);
+
+  // The initial budget should be clamped to the budget range.
+  BOOST_CHECK_CLOSE(WorkBudgetController(1.0, 1.0, 10.0, 20.0).get_budget(), 10.0, 1e-6);
+  BOOST_CHECK_CLOSE(WorkBudgetController(1.0, 1.0, 10.0, 0.5).get_budget(), 1.0, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(update_test)
+{
+  // With full responsiveness, the budget should jump straight to the number of units that would meet the target.
+  WorkBudgetController controller(10.0, 1.0, 1000.0, 100.0, 1.0);
+  controller.update(100.0, 20.0);
+  BOOST_CHECK_CLOSE(controller.get_budget(), 50.0, 1e-6);
+  controller.update(50.0, 2.5);
+  BOOST_CHECK_CLOSE(controller.get_budget(), 200.0, 1e-6);
+
+  // The budget should stay within its range.
+  controller.update(200.0, 1e6);
+  BOOST_CHECK_CLOSE(controller.get_budget(), 1.0, 1e-6);
+  controller.update(1.0, 0.0);
+  BOOST_CHECK_CLOSE(controller.get_budget(), 1000.0, 1e-6);
+
+  // If no work was done, the budget should not change.
+  controller.update(0.0, 5.0);
+  BOOST_CHECK_CLOSE(controller.get_budget(), 1000.0, 1e-6);
+
+  // With partial responsiveness, the budget should move part of the way towards the ideal budget.
+  WorkBudgetController smoothController(10.0, 1.0, 1000.0, 100.0, 0.5);
+  smoothController.update(100.0, 20.0);
+  BOOST_CHECK_CLOSE(smoothController.get_budget(), 75.0, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(accrue_test)
+{
+  // A budget of a quarter of a unit per frame should make a unit of work due on every fourth frame.
+  WorkBudgetController controller(1.0, 0.1, 1.0, 0.25);
+  int dueCount = 0;
+  for(int i = 0; i < 16; ++i)
+  {
+    if(controller.accrue()) ++dueCount;
+  }
+  BOOST_CHECK_EQUAL(dueCount, 4);
+
+  // A budget of at least one unit per frame should make a unit of work due on every frame.
+  WorkBudgetController fullController(1.0, 0.1, 2.0, 2.0);
+  for(int i = 0; i < 4; ++i) BOOST_CHECK(fullController.accrue());
+}
+
+BOOST_AUTO_TEST_SUITE_END()